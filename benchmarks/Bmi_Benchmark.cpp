@@ -0,0 +1,366 @@
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <boost/property_tree/ptree.hpp>
+#include "benchmark/benchmark.h"
+#include "FileChecker.h"
+#include "StreamHandler.hpp"
+#include "CsvPerFeatureForcingProvider.hpp"
+#include "Bmi_Formulation.hpp"
+#include "Bmi_Cpp_Adapter.hpp"
+#include "Bmi_Cpp_Formulation.hpp"
+#ifdef NGEN_BMI_C_LIB_ACTIVE
+#include "Bmi_C_Adapter.hpp"
+#include "Bmi_C_Formulation.hpp"
+#endif
+#ifdef NGEN_BMI_FORTRAN_ACTIVE
+#include "Bmi_Fortran_Adapter.hpp"
+#include "Bmi_Fortran_Formulation.hpp"
+#endif
+#ifdef ACTIVATE_PYTHON
+#include "python/InterpreterUtil.hpp"
+#include "Bmi_Py_Adapter.hpp"
+#include "Bmi_Py_Formulation.hpp"
+#endif
+
+/*
+ * Microbenchmarks of the cost of calling models through the BMI adapters, using the test BMI modules, which do next to
+ * no work of their own, so what is timed is the framework's overhead on each call.
+ *
+ * Each adapter is benchmarked for the calls a formulation makes every time step: Update, GetValue, SetValue and
+ * GetValuePtr, and the metadata queries of variables.  The get_response benchmarks time the whole path of a
+ * formulation's time step, from reading its forcings to getting its main output, for as many time steps as their
+ * argument.  As for the other benchmarks, the test modules and their configs are looked for the same way the unit
+ * tests do, so run them from the project root or the build directory, with the test modules built.
+ */
+
+namespace {
+
+    const int DT_SECONDS = 3600;
+
+    /** Report the time per call of a benchmark that makes @p calls calls per iteration. */
+    void set_per_call(benchmark::State& state, int64_t calls) {
+        state.SetItemsProcessed(state.iterations() * calls);
+        state.counters["per_call"] = benchmark::Counter(
+                static_cast<double>(calls), benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+    }
+
+    std::string find_data_file(const std::string& path) {
+        return utils::FileChecker::find_first_readable({path, "../" + path, "../../" + path});
+    }
+
+    std::string forcing_file() {
+        return find_data_file("data/forcing/cat-27_2015-12-01 00_00_00_2015-12-30 23_00_00.csv");
+    }
+
+    std::shared_ptr<data_access::GenericDataProvider> make_forcing() {
+        forcing_params params(forcing_file(), "CsvPerFeature", "2015-12-01 00:00:00", "2015-12-30 23:00:00");
+        return std::make_shared<CsvPerFeatureForcingProvider>(params);
+    }
+
+    /** The formulation config of a test module, less what is particular to its language. */
+    boost::property_tree::ptree module_config(const std::string& model_type_name, const std::string& init_config) {
+        boost::property_tree::ptree config;
+        config.put(BMI_REALIZATION_CFG_PARAM_REQ__MODEL_TYPE, model_type_name);
+        config.put(BMI_REALIZATION_CFG_PARAM_REQ__INIT_CONFIG, init_config);
+        config.put(BMI_REALIZATION_CFG_PARAM_REQ__MAIN_OUT_VAR, "OUTPUT_VAR_1");
+        config.put(BMI_REALIZATION_CFG_PARAM_REQ__USES_FORCINGS, false);
+        config.put(BMI_REALIZATION_CFG_PARAM_OPT__FORCING_FILE, forcing_file());
+        boost::property_tree::ptree names;
+        names.put("INPUT_VAR_1", AORC_FIELD_NAME_PRECIP_RATE);
+        names.put("INPUT_VAR_2", NGEN_STD_NAME_POTENTIAL_ET_FOR_TIME_STEP);
+        config.add_child(BMI_REALIZATION_CFG_PARAM_OPT__VAR_STD_NAMES, names);
+        return config;
+    }
+
+    /** The test C++ module, which reads the configs of the test C module. */
+    struct Cpp_Module {
+        typedef models::bmi::Bmi_Cpp_Adapter adapter_t;
+
+        static std::string library() {
+            #ifdef __APPLE__
+            return find_data_file("extern/test_bmi_cpp/cmake_build/libtestbmicppmodel.dylib");
+            #else
+            return find_data_file("extern/test_bmi_cpp/cmake_build/libtestbmicppmodel.so");
+            #endif
+        }
+
+        static std::string init_config() {
+            return find_data_file("test/data/bmi/test_bmi_c/test_bmi_c_config_0.txt");
+        }
+
+        static std::unique_ptr<adapter_t> make_adapter() {
+            return std::unique_ptr<adapter_t>(new adapter_t(
+                    "test_bmi_cpp", library(), init_config(), forcing_file(), false, true,
+                    BMI_REALIZATION_CFG_PARAM_OPT__CPP_CREATE_FUNC_DEFAULT,
+                    BMI_REALIZATION_CFG_PARAM_OPT__CPP_DESTROY_FUNC_DEFAULT, utils::StreamHandler()));
+        }
+
+        static std::unique_ptr<realization::Catchment_Formulation> make_formulation() {
+            boost::property_tree::ptree config = module_config("test_bmi_cpp", init_config());
+            config.put(BMI_REALIZATION_CFG_PARAM_OPT__LIB_FILE, library());
+            std::unique_ptr<realization::Catchment_Formulation> formulation(
+                    new realization::Bmi_Cpp_Formulation("cat-27", make_forcing(), utils::StreamHandler()));
+            formulation->create_formulation(config);
+            return formulation;
+        }
+    };
+
+    #ifdef NGEN_BMI_C_LIB_ACTIVE
+    struct C_Module {
+        typedef models::bmi::Bmi_C_Adapter adapter_t;
+
+        static std::string library() {
+            #ifdef __APPLE__
+            return find_data_file("extern/test_bmi_c/cmake_build/libtestbmicmodel.dylib");
+            #else
+            return find_data_file("extern/test_bmi_c/cmake_build/libtestbmicmodel.so");
+            #endif
+        }
+
+        static std::string init_config() {
+            return find_data_file("test/data/bmi/test_bmi_c/test_bmi_c_config_0.txt");
+        }
+
+        static std::unique_ptr<adapter_t> make_adapter() {
+            return std::unique_ptr<adapter_t>(new adapter_t(
+                    "test_bmi_c", library(), init_config(), forcing_file(), false, true, "register_bmi",
+                    utils::StreamHandler()));
+        }
+
+        static std::unique_ptr<realization::Catchment_Formulation> make_formulation() {
+            boost::property_tree::ptree config = module_config("test_bmi_c", init_config());
+            config.put(BMI_REALIZATION_CFG_PARAM_OPT__LIB_FILE, library());
+            config.put(BMI_REALIZATION_CFG_PARAM_OPT__REGISTRATION_FUNC, "register_bmi");
+            std::unique_ptr<realization::Catchment_Formulation> formulation(
+                    new realization::Bmi_C_Formulation("cat-27", make_forcing(), utils::StreamHandler()));
+            formulation->create_formulation(config);
+            return formulation;
+        }
+    };
+    #endif // NGEN_BMI_C_LIB_ACTIVE
+
+    #ifdef NGEN_BMI_FORTRAN_ACTIVE
+    struct Fortran_Module {
+        typedef models::bmi::Bmi_Fortran_Adapter adapter_t;
+
+        static std::string library() {
+            #ifdef __APPLE__
+            return find_data_file("extern/test_bmi_fortran/cmake_build/libtestbmifortranmodel.dylib");
+            #else
+            return find_data_file("extern/test_bmi_fortran/cmake_build/libtestbmifortranmodel.so");
+            #endif
+        }
+
+        static std::string init_config() {
+            return find_data_file("test/data/bmi/test_bmi_fortran/test_bmi_fortran_config_0.txt");
+        }
+
+        static std::unique_ptr<adapter_t> make_adapter() {
+            return std::unique_ptr<adapter_t>(new adapter_t(
+                    "test_bmi_fortran", library(), init_config(), forcing_file(), false, true, "register_bmi",
+                    utils::StreamHandler()));
+        }
+
+        static std::unique_ptr<realization::Catchment_Formulation> make_formulation() {
+            boost::property_tree::ptree config = module_config("test_bmi_fortran", init_config());
+            config.put(BMI_REALIZATION_CFG_PARAM_OPT__LIB_FILE, library());
+            config.put(BMI_REALIZATION_CFG_PARAM_OPT__REGISTRATION_FUNC, "register_bmi");
+            std::unique_ptr<realization::Catchment_Formulation> formulation(
+                    new realization::Bmi_Fortran_Formulation("cat-27", make_forcing(), utils::StreamHandler()));
+            formulation->create_formulation(config);
+            return formulation;
+        }
+    };
+    #endif // NGEN_BMI_FORTRAN_ACTIVE
+
+    #ifdef ACTIVATE_PYTHON
+    struct Py_Module {
+        typedef models::bmi::Bmi_Py_Adapter adapter_t;
+
+        static std::string init_config() {
+            return find_data_file("test/data/bmi/test_bmi_python/test_bmi_python_config_0.yml");
+        }
+
+        /** Start the interpreter, the first time, with the test module on its path. */
+        static void init_interpreter() {
+            static std::shared_ptr<utils::ngenPy::InterpreterUtil> interpreter = []() {
+                auto instance = utils::ngenPy::InterpreterUtil::getInstance();
+                std::string module_file = find_data_file("extern/test_bmi_py/bmi_model.py");
+                utils::ngenPy::InterpreterUtil::addToPyPath(
+                        module_file.substr(0, module_file.size() - std::string("test_bmi_py/bmi_model.py").size()));
+                return instance;
+            }();
+        }
+
+        static std::unique_ptr<adapter_t> make_adapter() {
+            init_interpreter();
+            return std::unique_ptr<adapter_t>(new adapter_t(
+                    "test_bmi_py.bmi_model", init_config(), "test_bmi_py.bmi_model", false, true,
+                    utils::StreamHandler()));
+        }
+
+        static std::unique_ptr<realization::Catchment_Formulation> make_formulation() {
+            init_interpreter();
+            boost::property_tree::ptree config = module_config("test_bmi_py.bmi_model", init_config());
+            config.put(BMI_REALIZATION_CFG_PARAM_OPT__PYTHON_TYPE_NAME, "test_bmi_py.bmi_model");
+            std::unique_ptr<realization::Catchment_Formulation> formulation(
+                    new realization::Bmi_Py_Formulation("cat-27", make_forcing(), utils::StreamHandler()));
+            formulation->create_formulation(config);
+            return formulation;
+        }
+    };
+    #endif // ACTIVATE_PYTHON
+
+    /** An initialized adapter of @p Module, or nullptr, with the benchmark skipped, if it cannot be created. */
+    template <class Module>
+    std::unique_ptr<typename Module::adapter_t> start_adapter(benchmark::State& state) {
+        try {
+            std::unique_ptr<typename Module::adapter_t> adapter = Module::make_adapter();
+            adapter->Initialize();
+            return adapter;
+        }
+        catch (const std::exception& e) {
+            state.SkipWithError(e.what());
+            return nullptr;
+        }
+    }
+}
+
+/** Advancing a model one time step. */
+template <class Module>
+static void BM_Bmi_Update(benchmark::State& state) {
+    auto adapter = start_adapter<Module>(state);
+    if (!adapter) {
+        return;
+    }
+    for (auto _ : state) {
+        adapter->Update();
+    }
+    adapter->Finalize();
+    set_per_call(state, 1);
+}
+
+/** Copying out the value of an output variable. */
+template <class Module>
+static void BM_Bmi_GetValue(benchmark::State& state) {
+    auto adapter = start_adapter<Module>(state);
+    if (!adapter) {
+        return;
+    }
+    const std::string name = "OUTPUT_VAR_1";
+    double value = 0.0;
+    for (auto _ : state) {
+        adapter->GetValue(name, &value);
+        benchmark::DoNotOptimize(value);
+    }
+    adapter->Finalize();
+    set_per_call(state, 1);
+}
+
+/** Copying in the value of an input variable. */
+template <class Module>
+static void BM_Bmi_SetValue(benchmark::State& state) {
+    auto adapter = start_adapter<Module>(state);
+    if (!adapter) {
+        return;
+    }
+    const std::string name = "INPUT_VAR_1";
+    double value = 1.0;
+    for (auto _ : state) {
+        adapter->SetValue(name, &value);
+        benchmark::ClobberMemory();
+    }
+    adapter->Finalize();
+    set_per_call(state, 1);
+}
+
+/** Getting a pointer to the value of an output variable, which not every adapter supports. */
+template <class Module>
+static void BM_Bmi_GetValuePtr(benchmark::State& state) {
+    auto adapter = start_adapter<Module>(state);
+    if (!adapter) {
+        return;
+    }
+    const std::string name = "OUTPUT_VAR_1";
+    try {
+        adapter->GetValuePtr(name);
+    }
+    catch (const std::exception& e) {
+        state.SkipWithError(e.what());
+        adapter->Finalize();
+        return;
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(adapter->GetValuePtr(name));
+    }
+    adapter->Finalize();
+    set_per_call(state, 1);
+}
+
+/** The metadata queries a formulation makes of its variables and times, four per iteration. */
+template <class Module>
+static void BM_Bmi_metadata(benchmark::State& state) {
+    auto adapter = start_adapter<Module>(state);
+    if (!adapter) {
+        return;
+    }
+    const std::string name = "OUTPUT_VAR_1";
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(adapter->GetVarType(name));
+        benchmark::DoNotOptimize(adapter->GetVarUnits(name));
+        benchmark::DoNotOptimize(adapter->GetVarNbytes(name));
+        benchmark::DoNotOptimize(adapter->GetCurrentTime());
+    }
+    adapter->Finalize();
+    set_per_call(state, 4);
+}
+
+/**
+ * A formulation's time steps through get_response, as many as the argument, from a newly created formulation,
+ * whose creation is not timed.
+ */
+template <class Module>
+static void BM_Bmi_get_response(benchmark::State& state) {
+    const int64_t steps = state.range(0);
+    for (auto _ : state) {
+        state.PauseTiming();
+        std::unique_ptr<realization::Catchment_Formulation> formulation;
+        try {
+            formulation = Module::make_formulation();
+        }
+        catch (const std::exception& e) {
+            state.SkipWithError(e.what());
+            break;
+        }
+        state.ResumeTiming();
+        for (int64_t t = 0; t < steps; ++t) {
+            benchmark::DoNotOptimize(formulation->get_response(t, DT_SECONDS));
+        }
+        state.PauseTiming();
+        formulation.reset();
+        state.ResumeTiming();
+    }
+    set_per_call(state, steps);
+}
+
+/** Register every benchmark of the adapter and formulation of @p Module; the test modules run a month of hours. */
+#define BMI_BENCHMARKS(Module) \
+    BENCHMARK_TEMPLATE(BM_Bmi_Update, Module); \
+    BENCHMARK_TEMPLATE(BM_Bmi_GetValue, Module); \
+    BENCHMARK_TEMPLATE(BM_Bmi_SetValue, Module); \
+    BENCHMARK_TEMPLATE(BM_Bmi_GetValuePtr, Module); \
+    BENCHMARK_TEMPLATE(BM_Bmi_metadata, Module); \
+    BENCHMARK_TEMPLATE(BM_Bmi_get_response, Module)->Arg(24)->Arg(720)->Unit(benchmark::kMicrosecond)
+
+BMI_BENCHMARKS(Cpp_Module);
+#ifdef NGEN_BMI_C_LIB_ACTIVE
+BMI_BENCHMARKS(C_Module);
+#endif
+#ifdef NGEN_BMI_FORTRAN_ACTIVE
+BMI_BENCHMARKS(Fortran_Module);
+#endif
+#ifdef ACTIVATE_PYTHON
+BMI_BENCHMARKS(Py_Module);
+#endif
@@ -0,0 +1,517 @@
+#include <memory>
+#include <vector>
+#include "benchmark/benchmark.h"
+#include "reservoir/Reservoir.hpp"
+#include "reservoir/Reservoir_Inline.hpp"
+#include "tshirt/include/Tshirt.h"
+#include "tshirt/include/tshirt_batch.h"
+#include "tshirt/include/tshirt_c.h"
+#include "tshirt/include/tshirt_c_batch.h"
+#include "tshirt/include/tshirt_c_device_batch.h"
+#include "tshirt/include/tshirt_params.h"
+#include "hymod/include/Hymod.h"
+#include "hymod/include/hymod_batch.h"
+#include "kernels/Pdm03.h"
+#include "kernels/RunoffPartitioningBatch.hpp"
+#include "kernels/evapotranspiration/EtCalcProperty.hpp"
+#include "kernels/evapotranspiration/EtCombinationMethod.hpp"
+#include "kernels/evapotranspiration/EtBatch.hpp"
+#include "GIUH.hpp"
+
+/*
+ * Microbenchmarks of the model kernels run for each catchment every time step.
+ *
+ * Each benchmark runs one time step of the kernel for as many catchments as its argument, so a run reports the time
+ * per time step of that many catchments, and the "per_catchment" counter the time per catchment per time step.
+ */
+
+namespace {
+
+    const int DT_SECONDS = 3600;
+
+    /** Report the time per catchment of a benchmark that runs @p catchments catchments per iteration. */
+    void set_per_catchment(benchmark::State& state, int64_t catchments) {
+        state.SetItemsProcessed(state.iterations() * catchments);
+        state.counters["per_catchment"] = benchmark::Counter(
+                static_cast<double>(catchments), benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+    }
+
+    void catchment_counts(benchmark::internal::Benchmark* b) {
+        b->RangeMultiplier(10)->Range(1, 10000);
+    }
+
+    /** A small, repeating pattern of hourly input fluxes, in meters per second. */
+    double input_flux(int64_t i) {
+        return 1.0e-7 * ((i % 7) + 1);
+    }
+
+    /** The ET params of the soil of the Hymod benchmarks, a PDM storage tank of 1 m. */
+    pdm03_struct hymod_et_params() {
+        pdm03_struct et_params = pdm03_struct();
+        et_params.scaled_distribution_fn_shape_parameter = 1.3;
+        et_params.vegetation_adjustment = 0.99;
+        et_params.max_height_soil_moisture_storerage_tank = 1.0;
+        et_params.maximum_combined_contents = 1.0 / 2.3;
+        et_params.potential_et = 1.0e-04;
+        return et_params;
+    }
+
+    /** The soil params of the C-style Tshirt benchmarks. */
+    NWM_soil_parameters tshirt_c_soil_params() {
+        NWM_soil_parameters soil_params = NWM_soil_parameters();
+        soil_params.smcmax = 0.439;
+        soil_params.wltsmc = 0.066;
+        soil_params.satdk = 3.38e-06;
+        soil_params.satpsi = 0.355;
+        soil_params.bb = 4.05;
+        soil_params.mult = 1000.0;
+        soil_params.slop = 1.0;
+        soil_params.D = 2.0;
+        return soil_params;
+    }
+
+    /** The soil and groundwater reservoirs of the C-style Tshirt benchmarks, as Tshirt_C_Realization sets them up. */
+    void init_tshirt_c_reservoirs(const NWM_soil_parameters& soil_params, conceptual_reservoir& soil_reservoir,
+                                  conceptual_reservoir& gw_reservoir) {
+        soil_reservoir = conceptual_reservoir{FALSE, soil_params.smcmax * soil_params.D, 0.5,
+                                              soil_params.satdk * soil_params.slop * 3600.0, 1.0, 0.32, 0.32, 0.01,
+                                              1.0};
+        gw_reservoir = conceptual_reservoir{TRUE, 16.0, 0.5, 0.01, 6.0, 0.0, 0.0, 0.0, 1.0};
+    }
+}
+
+/** The response of a two outlet (lateral and base flow) nonlinear reservoir, as used by the lumped models. */
+static void BM_Reservoir_response_meters_per_second(benchmark::State& state) {
+    const int64_t n = state.range(0);
+    std::vector<Reservoir::Explicit_Time::Reservoir> reservoirs;
+    reservoirs.reserve(n);
+    for (int64_t i = 0; i < n; ++i) {
+        reservoirs.emplace_back(0.0, 8.0, 2.0, 0.1, 1.5, 0.0, 100.0);
+        reservoirs.back().add_outlet(0.05, 1.0, 4.0, 100.0);
+    }
+    int64_t step = 0;
+    for (auto _ : state) {
+        for (int64_t i = 0; i < n; ++i) {
+            double excess_water_meters;
+            double response = reservoirs[i].response_meters_per_second(input_flux(step + i), DT_SECONDS,
+                                                                         excess_water_meters);
+            benchmark::DoNotOptimize(response);
+        }
+        ++step;
+    }
+    set_per_catchment(state, n);
+}
+BENCHMARK(BM_Reservoir_response_meters_per_second)->Apply(catchment_counts);
+
+/** The same reservoirs as BM_Reservoir_response_meters_per_second, with inline outlets. */
+static void BM_Inline_Reservoir_response_meters_per_second(benchmark::State& state) {
+    using namespace Reservoir::Explicit_Time;
+    const int64_t n = state.range(0);
+    std::vector<Inline_Reservoir<Inline_Outlet, Inline_Outlet>> reservoirs;
+    reservoirs.reserve(n);
+    for (int64_t i = 0; i < n; ++i) {
+        reservoirs.emplace_back(0.0, 8.0, 2.0, Inline_Outlet(0.1, 1.5, 0.0, 100.0), Inline_Outlet(0.05, 1.0, 4.0, 100.0));
+    }
+    int64_t step = 0;
+    for (auto _ : state) {
+        for (int64_t i = 0; i < n; ++i) {
+            double excess_water_meters;
+            double response = reservoirs[i].response_meters_per_second(input_flux(step + i), DT_SECONDS,
+                                                                         excess_water_meters);
+            benchmark::DoNotOptimize(response);
+        }
+        ++step;
+    }
+    set_per_catchment(state, n);
+}
+BENCHMARK(BM_Inline_Reservoir_response_meters_per_second)->Apply(catchment_counts);
+
+/** One time step of the Tshirt model, including its ET and its Nash cascade of lateral flow reservoirs. */
+static void BM_tshirt_model_run(benchmark::State& state) {
+    const int64_t n = state.range(0);
+    tshirt::tshirt_params params{1000.0, 1.0, 10.0, 0.1, 0.01, 3, 1.0, 1.0, 1.0, 1.0, 8, 1.0, 1.0, 100.0};
+    std::vector<std::unique_ptr<tshirt::tshirt_model>> models;
+    std::vector<std::shared_ptr<pdm03_struct>> et_params;
+    models.reserve(n);
+    et_params.reserve(n);
+    for (int64_t i = 0; i < n; ++i) {
+        models.emplace_back(new tshirt::tshirt_model(params, std::make_shared<tshirt::tshirt_state>(1.0, 1.0)));
+        et_params.push_back(std::make_shared<pdm03_struct>(pdm03_struct()));
+    }
+    int64_t step = 0;
+    for (auto _ : state) {
+        for (int64_t i = 0; i < n; ++i) {
+            benchmark::DoNotOptimize(models[i]->run(DT_SECONDS, input_flux(step + i), et_params[i]));
+        }
+        ++step;
+    }
+    set_per_catchment(state, n);
+}
+BENCHMARK(BM_tshirt_model_run)->Apply(catchment_counts);
+
+/** The same time step as ``BM_tshirt_model_run``, for all the catchments at once in a ``tshirt_batch``. */
+static void BM_tshirt_batch_run(benchmark::State& state) {
+    const int64_t n = state.range(0);
+    tshirt::tshirt_params params{1000.0, 1.0, 10.0, 0.1, 0.01, 3, 1.0, 1.0, 1.0, 1.0, 8, 1.0, 1.0, 100.0};
+    tshirt::tshirt_batch batch;
+    std::vector<std::shared_ptr<pdm03_struct>> et_params;
+    et_params.reserve(n);
+    for (int64_t i = 0; i < n; ++i) {
+        batch.add_member(params, tshirt::tshirt_state(1.0, 1.0));
+        et_params.push_back(std::make_shared<pdm03_struct>(pdm03_struct()));
+    }
+    std::vector<double> input_storage_m(n);
+    int64_t step = 0;
+    for (auto _ : state) {
+        for (int64_t i = 0; i < n; ++i) {
+            input_storage_m[i] = input_flux(step + i);
+        }
+        benchmark::DoNotOptimize(batch.run(DT_SECONDS, input_storage_m, et_params));
+        ++step;
+    }
+    set_per_catchment(state, n);
+}
+BENCHMARK(BM_tshirt_batch_run)->Apply(catchment_counts);
+
+/** The same time step as ``BM_tshirt_batch_run``, with the batch's state and inputs in single precision. */
+static void BM_tshirt_batch_float_run(benchmark::State& state) {
+    const int64_t n = state.range(0);
+    tshirt::tshirt_params params{1000.0, 1.0, 10.0, 0.1, 0.01, 3, 1.0, 1.0, 1.0, 1.0, 8, 1.0, 1.0, 100.0};
+    tshirt::tshirt_batch_float batch;
+    std::vector<std::shared_ptr<pdm03_struct>> et_params;
+    et_params.reserve(n);
+    for (int64_t i = 0; i < n; ++i) {
+        batch.add_member(params, tshirt::tshirt_state(1.0, 1.0));
+        et_params.push_back(std::make_shared<pdm03_struct>(pdm03_struct()));
+    }
+    std::vector<float> input_storage_m(n);
+    int64_t step = 0;
+    for (auto _ : state) {
+        for (int64_t i = 0; i < n; ++i) {
+            input_storage_m[i] = (float) input_flux(step + i);
+        }
+        benchmark::DoNotOptimize(batch.run(DT_SECONDS, input_storage_m, et_params));
+        ++step;
+    }
+    set_per_catchment(state, n);
+}
+BENCHMARK(BM_tshirt_batch_float_run)->Apply(catchment_counts);
+
+/** One time step of the C-style Tshirt model of tshirt_c.h, run per catchment as Tshirt_C_Realization does. */
+static void BM_tshirt_c_run(benchmark::State& state) {
+    const int64_t n = state.range(0);
+    const NWM_soil_parameters soil_params = tshirt_c_soil_params();
+    std::vector<double> giuh_ordinates{0.06, 0.51, 0.28, 0.12, 0.03};
+    std::vector<conceptual_reservoir> soil_reservoirs(n), gw_reservoirs(n);
+    std::vector<std::vector<double>> runoff_queues(n, std::vector<double>(giuh_ordinates.size() + 1, 0.0));
+    std::vector<std::vector<double>> nash_storage(n, std::vector<double>(2, 0.0));
+    for (int64_t i = 0; i < n; ++i) {
+        init_tshirt_c_reservoirs(soil_params, soil_reservoirs[i], gw_reservoirs[i]);
+    }
+    int64_t step = 0;
+    for (auto _ : state) {
+        for (int64_t i = 0; i < n; ++i) {
+            NWM_soil_parameters catchment_soil_params = soil_params;
+            double rain_m[] = {input_flux(step + i) * DT_SECONDS};
+            aorc_forcing_data empty_forcing[1];
+            int num_added_fluxes = 0;
+            tshirt_c_result_fluxes fluxes;
+            run(catchment_soil_params, gw_reservoirs[i], soil_reservoirs[i], 1, giuh_ordinates.data(),
+                (int) giuh_ordinates.size(), runoff_queues[i].data(), 0.33, 0.01, 0.263, 0.01, 0.03, 2,
+                nash_storage[i].data(), FALSE, empty_forcing, rain_m, num_added_fluxes, &fluxes);
+            benchmark::DoNotOptimize(fluxes.Qout_m);
+        }
+        ++step;
+    }
+    set_per_catchment(state, n);
+}
+BENCHMARK(BM_tshirt_c_run)->Apply(catchment_counts);
+
+/** The same time step as ``BM_tshirt_c_run``, for all the catchments at once in a ``tshirt_c_batch``. */
+static void BM_tshirt_c_batch_run(benchmark::State& state) {
+    const int64_t n = state.range(0);
+    const NWM_soil_parameters soil_params = tshirt_c_soil_params();
+    std::vector<double> giuh_ordinates{0.06, 0.51, 0.28, 0.12, 0.03};
+    tshirt_c_batch batch;
+    for (int64_t i = 0; i < n; ++i) {
+        conceptual_reservoir soil_reservoir, gw_reservoir;
+        init_tshirt_c_reservoirs(soil_params, soil_reservoir, gw_reservoir);
+        batch.add_member(soil_params, gw_reservoir, soil_reservoir, giuh_ordinates, 0.263, 0.03, 2);
+    }
+    std::vector<double> rain_m(n);
+    int64_t step = 0;
+    for (auto _ : state) {
+        for (int64_t i = 0; i < n; ++i) {
+            rain_m[i] = input_flux(step + i) * DT_SECONDS;
+        }
+        batch.run(rain_m);
+        benchmark::DoNotOptimize(batch.get_fluxes(0).Qout_m);
+        ++step;
+    }
+    set_per_catchment(state, n);
+}
+BENCHMARK(BM_tshirt_c_batch_run)->Apply(catchment_counts);
+
+/**
+ * The same time step as ``BM_tshirt_c_batch_run``, on the OpenMP device where built to offload to one, with the
+ * forcing of a day of time steps moved to it at a time and the outflows of every step copied back.
+ */
+static void BM_tshirt_c_device_batch_run(benchmark::State& state) {
+    const int64_t n = state.range(0);
+    const NWM_soil_parameters soil_params = tshirt_c_soil_params();
+    std::vector<double> giuh_ordinates{0.06, 0.51, 0.28, 0.12, 0.03};
+    tshirt_c_batch batch;
+    for (int64_t i = 0; i < n; ++i) {
+        conceptual_reservoir soil_reservoir, gw_reservoir;
+        init_tshirt_c_reservoirs(soil_params, soil_reservoir, gw_reservoir);
+        batch.add_member(soil_params, gw_reservoir, soil_reservoir, giuh_ordinates, 0.263, 0.03, 2);
+    }
+    tshirt_c_device_batch device_batch(batch);
+    const int64_t forcing_steps = 24;
+    std::vector<double> rain_m(forcing_steps * n);
+    std::vector<double> Qout_m;
+    int64_t step = 0;
+    for (auto _ : state) {
+        if (step % forcing_steps == 0) {
+            for (int64_t s = 0; s < forcing_steps; ++s) {
+                for (int64_t i = 0; i < n; ++i) {
+                    rain_m[s * n + i] = input_flux(step + s + i) * DT_SECONDS;
+                }
+            }
+            device_batch.set_forcing(rain_m, forcing_steps);
+        }
+        device_batch.run(step % forcing_steps);
+        device_batch.get_Qout(Qout_m);
+        benchmark::DoNotOptimize(Qout_m.data());
+        ++step;
+    }
+    state.counters["offloaded"] = tshirt_c_device_batch::is_offloaded() ? 1 : 0;
+    set_per_catchment(state, n);
+}
+BENCHMARK(BM_tshirt_c_device_batch_run)->Apply(catchment_counts);
+
+/** One time step of Hymod, including its ET and its Nash cascade of quick flow reservoirs. */
+static void BM_hymod_kernel_run(benchmark::State& state) {
+    const int64_t n = state.range(0);
+    hymod_params params{0.0, 400.0, 1.0, 0.0, 0.0, 100.0, 1.0, 0.5, 0.2, 0.02, 0.5, 3};
+    std::vector<hymod_state> states;
+    std::vector<std::vector<double>> cascade_storage(n, std::vector<double>(params.n, 0.0));
+    std::vector<std::vector<double>> new_cascade_storage(n, std::vector<double>(params.n, 0.0));
+    std::vector<hymod_fluxes> fluxes(n);
+    std::vector<pdm03_struct> et_params(n, hymod_et_params());
+    states.reserve(n);
+    for (int64_t i = 0; i < n; ++i) {
+        states.emplace_back(0.5, 0.0, cascade_storage[i].data());
+    }
+    int64_t step = 0;
+    for (auto _ : state) {
+        for (int64_t i = 0; i < n; ++i) {
+            hymod_state new_state(0.0, 0.0, new_cascade_storage[i].data());
+            benchmark::DoNotOptimize(hymod_kernel::run(DT_SECONDS, params, states[i], new_state, fluxes[i],
+                                                       input_flux(step + i) * DT_SECONDS, &et_params[i]));
+            states[i].storage_meters = new_state.storage_meters;
+            states[i].groundwater_storage_meters = new_state.groundwater_storage_meters;
+            std::swap(cascade_storage[i], new_cascade_storage[i]);
+            states[i].Sr = cascade_storage[i].data();
+        }
+        ++step;
+    }
+    set_per_catchment(state, n);
+}
+BENCHMARK(BM_hymod_kernel_run)->Apply(catchment_counts);
+
+/** The same time step as ``BM_hymod_kernel_run``, for all the catchments at once in a ``hymod_batch``. */
+static void BM_hymod_batch_run(benchmark::State& state) {
+    const int64_t n = state.range(0);
+    hymod_params params{0.0, 400.0, 1.0, 0.0, 0.0, 100.0, 1.0, 0.5, 0.2, 0.02, 0.5, 3};
+    hymod_batch batch;
+    std::vector<std::shared_ptr<pdm03_struct>> et_params;
+    et_params.reserve(n);
+    for (int64_t i = 0; i < n; ++i) {
+        batch.add_member(params, hymod_state(0.5, 0.0));
+        et_params.push_back(std::make_shared<pdm03_struct>(hymod_et_params()));
+    }
+    std::vector<double> input_storage_m(n);
+    int64_t step = 0;
+    for (auto _ : state) {
+        for (int64_t i = 0; i < n; ++i) {
+            input_storage_m[i] = input_flux(step + i) * DT_SECONDS;
+        }
+        benchmark::DoNotOptimize(batch.run(DT_SECONDS, input_storage_m, et_params));
+        ++step;
+    }
+    set_per_catchment(state, n);
+}
+BENCHMARK(BM_hymod_batch_run)->Apply(catchment_counts);
+
+/** The PDM soil moisture accounting of Hymod. */
+static void BM_Pdm03(benchmark::State& state) {
+    const int64_t n = state.range(0);
+    const double huz = 400.0;
+    const double b = 1.3;
+    const double cpar = huz / (1.0 + b);
+    std::vector<double> heights(n, 100.0);
+    int64_t step = 0;
+    for (auto _ : state) {
+        for (int64_t i = 0; i < n; ++i) {
+            double effective_rainfall, actual_et, storage;
+            Pdm03(DT_SECONDS, cpar, b, &heights[i], huz, &effective_rainfall, &actual_et, &storage,
+                  input_flux(step + i) * 1000.0 * DT_SECONDS, 0.1, 0.99);
+            benchmark::DoNotOptimize(effective_rainfall);
+        }
+        ++step;
+    }
+    set_per_catchment(state, n);
+}
+BENCHMARK(BM_Pdm03)->Apply(catchment_counts);
+
+/** The same PDM as ``BM_Pdm03``, for all the catchments at once with ``runoff::batch::pdm03``. */
+static void BM_Pdm03_batch(benchmark::State& state) {
+    const int64_t n = state.range(0);
+    const double huz = 400.0;
+    const double b = 1.3;
+    runoff::batch::pdm03_arrays pdm(n);
+    for (int64_t i = 0; i < n; ++i) {
+        pdm.maximum_combined_contents[i] = huz / (1.0 + b);
+        pdm.scaled_distribution_fn_shape_parameter[i] = b;
+        pdm.final_height_reservoir[i] = 100.0;
+        pdm.max_height_soil_moisture_storerage_tank[i] = huz;
+        pdm.potential_et[i] = 0.1;
+        pdm.vegetation_adjustment[i] = 0.99;
+    }
+    int64_t step = 0;
+    for (auto _ : state) {
+        for (int64_t i = 0; i < n; ++i) {
+            pdm.precipitation[i] = input_flux(step + i) * 1000.0 * DT_SECONDS;
+        }
+        runoff::batch::pdm03(pdm);
+        benchmark::DoNotOptimize(pdm.total_effective_rainfall.data());
+        ++step;
+    }
+    set_per_catchment(state, n);
+}
+BENCHMARK(BM_Pdm03_batch)->Apply(catchment_counts);
+
+/**
+ * The ET calculation of BMI formulations: the net radiation, then the combination method, from AORC-like forcings
+ * (see ``Bmi_Module_Formulation::calc_et``).
+ */
+static void BM_et_combination_method(benchmark::State& state) {
+    const int64_t n = state.range(0);
+    struct et::evapotranspiration_options et_options;
+    et_options.yes_aorc = TRUE;
+    et_options.use_energy_balance_method = FALSE;
+    et_options.use_aerodynamic_method = FALSE;
+    et_options.use_combination_method = TRUE;
+    et_options.use_priestley_taylor_method = FALSE;
+    et_options.use_penman_monteith_method = FALSE;
+
+    struct et::evapotranspiration_params et_params;
+    et_params.vegetation_height_m = 0.12;
+    et_params.zero_plane_displacement_height_m = 0.0003;
+    et_params.momentum_transfer_roughness_length_m = 0.0;
+    et_params.heat_transfer_roughness_length_m = 0.0;
+    et_params.wind_speed_measurement_height_m = 2.0;
+    et_params.humidity_measurement_height_m = 2.0;
+
+    struct et::surface_radiation_params surf_rad_params;
+    surf_rad_params.surface_longwave_emissivity = 1.0;
+    surf_rad_params.surface_shortwave_albedo = 0.22;
+
+    const double specific_humidity_kg_per_kg = 0.006;
+    const double pressure_Pa = 101300.0;
+    int64_t step = 0;
+    for (auto _ : state) {
+        for (int64_t i = 0; i < n; ++i) {
+            struct et::evapotranspiration_forcing et_forcing;
+            et_forcing.air_temperature_C = 10.0 + ((step + i) % 11);
+            et_forcing.relative_humidity_percent = -99.9;
+            et_forcing.specific_humidity_2m_kg_per_kg = specific_humidity_kg_per_kg;
+            et_forcing.air_pressure_Pa = pressure_Pa;
+            et_forcing.wind_speed_m_per_s = 2.5;
+            et_forcing.canopy_resistance_sec_per_m = 50.0;
+            et_forcing.water_temperature_C = 15.5;
+            et_forcing.ground_heat_flux_W_per_sq_m = -10.0;
+
+            struct et::surface_radiation_forcing surf_rad_forcing;
+            surf_rad_forcing.incoming_shortwave_radiation_W_per_sq_m = 400.0;
+            surf_rad_forcing.incoming_longwave_radiation_W_per_sq_m = 300.0;
+            surf_rad_forcing.air_temperature_C = et_forcing.air_temperature_C;
+            double saturation_vapor_pressure_Pa = et::calc_air_saturation_vapor_pressure_Pa(et_forcing.air_temperature_C);
+            surf_rad_forcing.relative_humidity_percent =
+                    100.0 * (specific_humidity_kg_per_kg * pressure_Pa / 0.622) / saturation_vapor_pressure_Pa;
+            surf_rad_forcing.surface_skin_temperature_C = 12.0;
+            et_forcing.net_radiation_W_per_sq_m = et::calculate_net_radiation_W_per_sq_m(&et_options, &surf_rad_params,
+                                                                                         &surf_rad_forcing);
+            struct et::intermediate_vars inter_vars;
+            benchmark::DoNotOptimize(et::combined::evapotranspiration_combination_method(&et_options, &et_params,
+                                                                                         &et_forcing, &inter_vars));
+        }
+        ++step;
+    }
+    set_per_catchment(state, n);
+}
+BENCHMARK(BM_et_combination_method)->Apply(catchment_counts);
+
+/**
+ * The same combination method calculation as ``BM_et_combination_method``, for all the catchments at once with the
+ * batched kernels (the net radiation, done per catchment by both, is left out).
+ */
+static void BM_et_combination_method_batch(benchmark::State& state) {
+    const int64_t n = state.range(0);
+    et::batch::evapotranspiration_params_arrays et_params(n);
+    et::batch::evapotranspiration_forcing_arrays et_forcing(n);
+    for (int64_t i = 0; i < n; ++i) {
+        et_params.vegetation_height_m[i] = 0.12;
+        et_params.zero_plane_displacement_height_m[i] = 0.0003;
+        et_params.momentum_transfer_roughness_length_m[i] = 0.0;
+        et_params.heat_transfer_roughness_length_m[i] = 0.0;
+        et_params.wind_speed_measurement_height_m[i] = 2.0;
+        et_params.humidity_measurement_height_m[i] = 2.0;
+
+        et_forcing.net_radiation_W_per_sq_m[i] = 350.0;
+        et_forcing.relative_humidity_percent[i] = -99.9;
+        et_forcing.specific_humidity_2m_kg_per_kg[i] = 0.006;
+        et_forcing.air_pressure_Pa[i] = 101300.0;
+        et_forcing.wind_speed_m_per_s[i] = 2.5;
+        et_forcing.canopy_resistance_sec_per_m[i] = 50.0;
+        et_forcing.water_temperature_C[i] = 15.5;
+        et_forcing.ground_heat_flux_W_per_sq_m[i] = -10.0;
+    }
+
+    et::batch::intermediate_vars_arrays inter_vars(n);
+    std::vector<double> et_rate_m_per_s(n);
+    int64_t step = 0;
+    for (auto _ : state) {
+        for (int64_t i = 0; i < n; ++i) {
+            et_forcing.air_temperature_C[i] = 10.0 + ((step + i) % 11);
+        }
+        et::batch::calculate_intermediate_variables(et_params, et_forcing, inter_vars);
+        et::batch::evapotranspiration_combination_method(et_params, et_forcing, inter_vars, et_rate_m_per_s);
+        benchmark::DoNotOptimize(et_rate_m_per_s.data());
+        ++step;
+    }
+    set_per_catchment(state, n);
+}
+BENCHMARK(BM_et_combination_method_batch)->Apply(catchment_counts);
+
+/** The GIUH convolution of a direct runoff, with a CDF spanning 8 hours of 60 second ordinates. */
+static void BM_giuh_calc_giuh_output(benchmark::State& state) {
+    const int64_t n = state.range(0);
+    std::vector<double> cdf_times = {0.0, 3600.0, 7200.0, 10800.0, 14400.0, 18000.0, 21600.0, 25200.0, 28800.0};
+    std::vector<double> cdf_freqs = {0.0, 0.1, 0.35, 0.6, 0.75, 0.86, 0.93, 0.98, 1.0};
+    std::vector<std::unique_ptr<giuh::giuh_kernel_impl>> kernels;
+    kernels.reserve(n);
+    for (int64_t i = 0; i < n; ++i) {
+        kernels.emplace_back(new giuh::giuh_kernel_impl("cat-" + std::to_string(i), "0", cdf_times, cdf_freqs));
+    }
+    int64_t step = 0;
+    for (auto _ : state) {
+        for (int64_t i = 0; i < n; ++i) {
+            benchmark::DoNotOptimize(kernels[i]->calc_giuh_output(DT_SECONDS, input_flux(step + i) * DT_SECONDS));
+        }
+        ++step;
+    }
+    set_per_catchment(state, n);
+}
+BENCHMARK(BM_giuh_calc_giuh_output)->Apply(catchment_counts);
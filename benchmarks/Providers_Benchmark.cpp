@@ -0,0 +1,153 @@
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "benchmark/benchmark.h"
+#include "FileChecker.h"
+#include "FeatureBuilder.hpp"
+#include "CsvPerFeatureForcingProvider.hpp"
+#include "DataProviderSelectors.hpp"
+#include "UnitsHelper.hpp"
+#include "StreamHandler.hpp"
+#ifdef NETCDF_ACTIVE
+#include "NetCDFPerFeatureDataProvider.hpp"
+#endif
+
+/*
+ * Microbenchmarks of reading model inputs: hydrofabric, forcings, and the unit conversions of forcing values.
+ *
+ * As for the kernel benchmarks, each benchmark does the work for as many catchments as its argument, and the
+ * "per_catchment" counter reports the time per catchment.  Benchmarks of forcing files look for the test data the
+ * same way the unit tests do, so run them from the project root or the build directory.
+ */
+
+namespace {
+
+    void set_per_catchment(benchmark::State& state, int64_t catchments) {
+        state.SetItemsProcessed(state.iterations() * catchments);
+        state.counters["per_catchment"] = benchmark::Counter(
+                static_cast<double>(catchments), benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+    }
+
+    std::string find_data_file(const std::string& path) {
+        return utils::FileChecker::find_first_readable({path, "../" + path, "../../" + path});
+    }
+
+    /** Hydrofabric text of @p catchments square catchments, each with a few properties, laid out in a row. */
+    std::string make_catchments_geojson(int64_t catchments) {
+        std::ostringstream out;
+        out << "{\"type\": \"FeatureCollection\", \"features\": [";
+        for (int64_t i = 0; i < catchments; ++i) {
+            double x = 0.01 * i;
+            out << (i == 0 ? "" : ",")
+                << "{\"type\": \"Feature\", \"id\": \"cat-" << i << "\", \"properties\": {"
+                << "\"area_sqkm\": 12.5, \"toid\": \"nex-" << i + 1 << "\", \"divide_id\": \"cat-" << i << "\"},"
+                << "\"geometry\": {\"type\": \"Polygon\", \"coordinates\": [["
+                << "[" << x << ", 35.0], [" << x + 0.01 << ", 35.0], [" << x + 0.01 << ", 35.01], ["
+                << x << ", 35.01], [" << x << ", 35.0]]]}}";
+        }
+        out << "]}";
+        return out.str();
+    }
+}
+
+/** Parsing a hydrofabric of catchment polygons. */
+static void BM_geojson_read(benchmark::State& state) {
+    const int64_t n = state.range(0);
+    const std::string text = make_catchments_geojson(n);
+    for (auto _ : state) {
+        std::stringstream data(text);
+        geojson::GeoJSON collection = geojson::read(data);
+        benchmark::DoNotOptimize(collection->get_size());
+    }
+    set_per_catchment(state, n);
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_geojson_read)->RangeMultiplier(10)->Range(1, 10000)->Unit(benchmark::kMicrosecond);
+
+/** Loading a month of hourly forcings from a per catchment CSV file, once per catchment. */
+static void BM_CsvPerFeatureForcingProvider_load(benchmark::State& state) {
+    const int64_t n = state.range(0);
+    const std::string path = find_data_file("data/forcing/cat-27_2015-12-01 00_00_00_2015-12-30 23_00_00.csv");
+    forcing_params params(path, "CsvPerFeature", "2015-12-01 00:00:00", "2015-12-30 23:00:00");
+    for (auto _ : state) {
+        for (int64_t i = 0; i < n; ++i) {
+            CsvPerFeatureForcingProvider provider(params);
+            benchmark::DoNotOptimize(provider.get_data_stop_time());
+        }
+    }
+    set_per_catchment(state, n);
+}
+BENCHMARK(BM_CsvPerFeatureForcingProvider_load)->RangeMultiplier(10)->Range(1, 100)->Unit(benchmark::kMillisecond);
+
+/** Reading a time step's precipitation, in the units a model asks for, from loaded per catchment CSV forcings. */
+static void BM_CsvPerFeatureForcingProvider_get_value(benchmark::State& state) {
+    const int64_t n = state.range(0);
+    const std::string path = find_data_file("data/forcing/cat-27_2015-12-01 00_00_00_2015-12-30 23_00_00.csv");
+    forcing_params params(path, "CsvPerFeature", "2015-12-01 00:00:00", "2015-12-30 23:00:00");
+    CsvPerFeatureForcingProvider provider(params);
+    const time_t start = provider.get_data_start_time();
+    const long steps = (provider.get_data_stop_time() - start) / 3600;
+    long step = 0;
+    for (auto _ : state) {
+        CSVDataSelector selector(CSDMS_STD_NAME_LIQUID_EQ_PRECIP_RATE, start + step * 3600, 3600, "m s^-1");
+        for (int64_t i = 0; i < n; ++i) {
+            benchmark::DoNotOptimize(provider.get_value(selector, data_access::SUM));
+        }
+        step = (step + 1) % steps;
+    }
+    set_per_catchment(state, n);
+}
+BENCHMARK(BM_CsvPerFeatureForcingProvider_get_value)->RangeMultiplier(10)->Range(1, 10000);
+
+#ifdef NETCDF_ACTIVE
+/** Reading a time step's temperature of each catchment from a NetCDF forcing file of several catchments. */
+static void BM_NetCDFPerFeatureDataProvider_get_value(benchmark::State& state) {
+    const int64_t n = state.range(0);
+    const std::string path = find_data_file("data/forcing/cats-27_52_67-2015_12_01-2015_12_30.nc");
+    forcing_params params(path, "NetCDF", "2015-12-01 00:00:00", "2015-12-30 23:00:00");
+    data_access::NetCDFPerFeatureDataProvider provider(path, params.simulation_start_t, params.simulation_end_t,
+                                                       utils::getStdErr());
+    const std::vector<std::string> ids = provider.get_ids();
+    const time_t start = provider.get_data_start_time();
+    const long duration = provider.record_duration();
+    const long steps = (provider.get_data_stop_time() - start) / duration;
+    long step = 0;
+    for (auto _ : state) {
+        for (int64_t i = 0; i < n; ++i) {
+            NetCDFDataSelector selector(ids[i % ids.size()], CSDMS_STD_NAME_SURFACE_TEMP, start + step * duration,
+                                        duration, "K");
+            benchmark::DoNotOptimize(provider.get_value(selector, data_access::MEAN));
+        }
+        step = (step + 1) % steps;
+    }
+    set_per_catchment(state, n);
+}
+BENCHMARK(BM_NetCDFPerFeatureDataProvider_get_value)->RangeMultiplier(10)->Range(1, 10000);
+#endif
+
+/** Converting one forcing value per catchment between units, as forcing providers do for each value they serve. */
+static void BM_UnitsHelper_get_converted_value(benchmark::State& state) {
+    const int64_t n = state.range(0);
+    double value = 1.0e-4;
+    for (auto _ : state) {
+        for (int64_t i = 0; i < n; ++i) {
+            benchmark::DoNotOptimize(UnitsHelper::get_converted_value("m s^-1", value + i * 1.0e-9, "mm s^-1"));
+        }
+    }
+    set_per_catchment(state, n);
+}
+BENCHMARK(BM_UnitsHelper_get_converted_value)->RangeMultiplier(10)->Range(1, 10000);
+
+/** Converting a whole time step of values, one per catchment, in a single call. */
+static void BM_UnitsHelper_convert_values(benchmark::State& state) {
+    const int64_t n = state.range(0);
+    std::vector<double> values(n, 1.0e-4);
+    std::vector<double> converted(n);
+    for (auto _ : state) {
+        UnitsHelper::convert_values("m s^-1", values.data(), "mm s^-1", converted.data(), n);
+        benchmark::DoNotOptimize(converted.data());
+    }
+    set_per_catchment(state, n);
+}
+BENCHMARK(BM_UnitsHelper_convert_values)->RangeMultiplier(10)->Range(1, 10000);
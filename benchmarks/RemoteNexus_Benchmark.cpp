@@ -0,0 +1,283 @@
+#ifdef NGEN_MPI_ACTIVE
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <mpi.h>
+#include "HY_PointHydroNexusRemote.hpp"
+#include "RemoteNexusExchange.hpp"
+
+/*
+ * Benchmark of the time steps of remote nexus communication, over MPI, on synthetic partitions.
+ *
+ * Ranks are laid out in a chain, or a ring with --ring, and each rank shares --nexuses boundary nexuses with the next,
+ * each drained on this rank by one catchment and draining to one on the next.  Every time step, each rank adds the
+ * flows of its upstream catchments to the nexuses it sends from, optionally computes for --compute-us microseconds,
+ * and takes the downstream flows of the nexuses it receives at, through the same HY_PointHydroNexusRemote calls a run
+ * makes.  The flows are moved by the nexuses' own messages (--transport direct) or by a RemoteNexusExchange
+ * (neighbor_collective or one_sided), to compare the transports, which with --chunk-steps exchanges the flows of that
+ * many time steps at once, taking the downstream flows of all of them after each exchange.
+ *
+ * Rank 0 prints the communication time per time step, that is the step less its computation, as the smallest, mean
+ * and largest of any rank, and with --csv appends them as a line to a file, to collect the scaling over rank counts:
+ *
+ *     mpirun -n 4 ./benchmark_remote_nexus --nexuses 100 --steps 1000 --transport neighbor_collective --csv scaling.csv
+ */
+
+namespace {
+
+    enum class Transport { direct, neighbor_collective, one_sided };
+
+    struct Options {
+        int nexuses = 10;
+        long steps = 1000;
+        long warmup_steps = 10;
+        double compute_us = 0.0;
+        bool is_ring = false;
+        long chunk_steps = 1;
+        Transport transport = Transport::direct;
+        std::string transport_name = "direct";
+        std::string csv_path;
+    };
+
+    Options parse_options(int argc, char** argv) {
+        Options options;
+        for (int i = 1; i < argc; ++i) {
+            std::string name = argv[i];
+            if (name == "--ring") {
+                options.is_ring = true;
+                continue;
+            }
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("Missing the value of " + name);
+            }
+            std::string value = argv[++i];
+            if (name == "--nexuses") {
+                options.nexuses = std::stoi(value);
+            }
+            else if (name == "--steps") {
+                options.steps = std::stol(value);
+            }
+            else if (name == "--warmup-steps") {
+                options.warmup_steps = std::stol(value);
+            }
+            else if (name == "--chunk-steps") {
+                options.chunk_steps = std::stol(value);
+            }
+            else if (name == "--compute-us") {
+                options.compute_us = std::stod(value);
+            }
+            else if (name == "--transport") {
+                options.transport_name = value;
+                if (value == "direct") {
+                    options.transport = Transport::direct;
+                }
+                else if (value == "neighbor_collective") {
+                    options.transport = Transport::neighbor_collective;
+                }
+                else if (value == "one_sided") {
+                    options.transport = Transport::one_sided;
+                }
+                else {
+                    throw std::invalid_argument("Unknown transport " + value
+                                                + "; use direct, neighbor_collective or one_sided");
+                }
+            }
+            else if (name == "--csv") {
+                options.csv_path = value;
+            }
+            else {
+                throw std::invalid_argument("Unknown option " + name);
+            }
+        }
+        if (options.nexuses < 1 || options.steps < 1 || options.chunk_steps < 1 || options.warmup_steps < 0) {
+            throw std::invalid_argument("--nexuses, --steps and --chunk-steps must be positive, and --warmup-steps not "
+                                        "negative");
+        }
+        if (options.chunk_steps > 1 && options.transport == Transport::direct) {
+            throw std::invalid_argument("--chunk-steps needs a neighbor_collective or one_sided transport");
+        }
+        return options;
+    }
+
+    /** The catchment draining to boundary nexus @p id, on the rank before it, and the one draining from it, after. */
+    std::string upstream_catchment(long id) { return "cat-" + std::to_string(2 * id); }
+    std::string downstream_catchment(long id) { return "cat-" + std::to_string(2 * id + 1); }
+
+    void compute_for(double microseconds) {
+        if (microseconds <= 0.0) {
+            return;
+        }
+        auto end = std::chrono::steady_clock::now() + std::chrono::duration<double, std::micro>(microseconds);
+        while (std::chrono::steady_clock::now() < end) {
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    MPI_Init(&argc, &argv);
+    int rank = 0;
+    int ranks = 1;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &ranks);
+
+    Options options;
+    try {
+        options = parse_options(argc, argv);
+    }
+    catch (const std::exception& e) {
+        if (rank == 0) {
+            std::cerr << e.what() << std::endl;
+        }
+        MPI_Finalize();
+        return 1;
+    }
+    if (ranks < 2) {
+        if (rank == 0) {
+            std::cerr << "The remote nexus benchmark needs at least 2 ranks." << std::endl;
+        }
+        MPI_Finalize();
+        return 1;
+    }
+
+    //The boundary nexuses this rank sends from, to the next rank, and receives at, from the previous rank; the
+    //nexuses between rank r and r + 1 are numbered from r * nexuses
+    const bool is_sender = options.is_ring || rank + 1 < ranks;
+    const bool is_receiver = options.is_ring || rank > 0;
+    const int next_rank = (rank + 1) % ranks;
+    const int previous_rank = (rank + ranks - 1) % ranks;
+    std::vector<std::shared_ptr<HY_PointHydroNexusRemote>> sending, receiving;
+    for (int i = 0; i < options.nexuses; ++i) {
+        if (is_sender) {
+            long id = static_cast<long>(rank) * options.nexuses + i;
+            HY_PointHydroNexusRemote::catcment_location_map_t loc_map;
+            loc_map[downstream_catchment(id)] = next_rank;
+            sending.push_back(std::make_shared<HY_PointHydroNexusRemote>("nex-" + std::to_string(id),
+                    HY_PointHydroNexus::Catchments{downstream_catchment(id)},
+                    HY_PointHydroNexus::Catchments{upstream_catchment(id)}, loc_map));
+        }
+        if (is_receiver) {
+            long id = static_cast<long>(previous_rank) * options.nexuses + i;
+            HY_PointHydroNexusRemote::catcment_location_map_t loc_map;
+            loc_map[upstream_catchment(id)] = previous_rank;
+            receiving.push_back(std::make_shared<HY_PointHydroNexusRemote>("nex-" + std::to_string(id),
+                    HY_PointHydroNexus::Catchments{downstream_catchment(id)},
+                    HY_PointHydroNexus::Catchments{upstream_catchment(id)}, loc_map));
+        }
+    }
+    std::unique_ptr<RemoteNexusExchange> exchange;
+    if (options.transport != Transport::direct) {
+        std::vector<std::shared_ptr<HY_PointHydroNexusRemote>> nexuses(sending);
+        nexuses.insert(nexuses.end(), receiving.begin(), receiving.end());
+        exchange = std::unique_ptr<RemoteNexusExchange>(new RemoteNexusExchange(nexuses, MPI_COMM_WORLD,
+                options.transport == Transport::one_sided ? RemoteNexusExchange::Transport::one_sided
+                                                          : RemoteNexusExchange::Transport::neighbor_collective,
+                options.chunk_steps));
+    }
+
+    const long total_steps = options.warmup_steps + options.steps;
+    double communication_seconds = 0.0;
+    double worst_step_seconds = 0.0;
+    double checksum = 0.0;
+    long chunk_first = 0;
+    MPI_Barrier(MPI_COMM_WORLD);
+    for (long t = 0; t < total_steps; ++t) {
+        double start = MPI_Wtime();
+        for (std::size_t i = 0; i < sending.size(); ++i) {
+            long id = static_cast<long>(rank) * options.nexuses + i;
+            sending[i]->add_upstream_flow(1.0 + t + i, upstream_catchment(id), t);
+        }
+        double compute_start = MPI_Wtime();
+        compute_for(options.compute_us);
+        double compute_seconds = MPI_Wtime() - compute_start;
+        //The downstream flows of each time step of a chunk are taken once it is exchanged
+        if (t + 1 - chunk_first >= options.chunk_steps || t + 1 == total_steps) {
+            if (exchange) {
+                exchange->exchange_chunk(chunk_first, t + 1 - chunk_first, t + 1 < total_steps);
+            }
+            for (long step = chunk_first; step <= t; ++step) {
+                for (std::size_t i = 0; i < receiving.size(); ++i) {
+                    long id = static_cast<long>(previous_rank) * options.nexuses + i;
+                    checksum += receiving[i]->get_downstream_flow(downstream_catchment(id), step, 100.0);
+                }
+            }
+            chunk_first = t + 1;
+        }
+        double step_seconds = MPI_Wtime() - start - compute_seconds;
+        if (t >= options.warmup_steps) {
+            communication_seconds += step_seconds;
+            worst_step_seconds = std::max(worst_step_seconds, step_seconds);
+        }
+    }
+
+    //Complete the sends the direct transport leaves outstanding before the nexuses are destroyed
+    std::vector<HY_PointHydroNexusRemote*> all_nexuses;
+    for (const auto& nexus : sending) {
+        all_nexuses.push_back(nexus.get());
+    }
+    for (const auto& nexus : receiving) {
+        all_nexuses.push_back(nexus.get());
+    }
+    bool is_drained = HY_PointHydroNexusRemote::drain_communications(all_nexuses);
+
+    double step_seconds = communication_seconds / options.steps;
+    double min_step = 0.0, max_step = 0.0, sum_step = 0.0, worst_step = 0.0;
+    MPI_Reduce(&step_seconds, &min_step, 1, MPI_DOUBLE, MPI_MIN, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&step_seconds, &max_step, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&step_seconds, &sum_step, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&worst_step_seconds, &worst_step, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    int drained = is_drained ? 1 : 0;
+    int all_drained = 0;
+    MPI_Reduce(&drained, &all_drained, 1, MPI_INT, MPI_MIN, 0, MPI_COMM_WORLD);
+
+    if (rank == 0) {
+        const double us = 1.0e6;
+        std::cout << "Remote nexus exchange of " << options.nexuses << " nexuses per rank pair over " << ranks
+                  << " ranks in a " << (options.is_ring ? "ring" : "chain") << ", " << options.transport_name
+                  << " transport, " << options.steps << " time steps:" << std::endl
+                  << std::fixed << std::setprecision(2)
+                  << "  communication per time step (us): min " << min_step * us << ", mean " << sum_step / ranks * us
+                  << ", max " << max_step * us << ", slowest step " << worst_step * us << std::endl
+                  << "  per nexus (us): " << sum_step / ranks / options.nexuses * us << std::endl;
+        if (!all_drained) {
+            std::cerr << "WARNING: some remote nexus communications did not complete" << std::endl;
+        }
+        if (!options.csv_path.empty()) {
+            std::ofstream csv(options.csv_path, std::ios::app);
+            if (csv.tellp() == 0) {
+                csv << "ranks,nexuses,transport,ring,compute_us,steps,min_us,mean_us,max_us,slowest_step_us,chunk_steps\n";
+            }
+            csv << ranks << ',' << options.nexuses << ',' << options.transport_name << ','
+                << (options.is_ring ? 1 : 0) << ',' << options.compute_us << ',' << options.steps << ','
+                << min_step * us << ',' << sum_step / ranks * us << ',' << max_step * us << ',' << worst_step * us
+                << ',' << options.chunk_steps << '\n';
+        }
+    }
+    //Keep the checksum live, so the flows taken are not optimized away
+    if (checksum < 0.0) {
+        std::cerr << checksum << std::endl;
+    }
+
+    exchange.reset();
+    sending.clear();
+    receiving.clear();
+    MPI_Finalize();
+    return 0;
+}
+
+#else
+
+#include <iostream>
+
+int main() {
+    std::cerr << "The remote nexus benchmark needs MPI; build with -DMPI_ACTIVE=ON." << std::endl;
+    return 1;
+}
+
+#endif // NGEN_MPI_ACTIVE
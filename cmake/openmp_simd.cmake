@@ -0,0 +1,11 @@
+## Name : target_openmp_simd
+## Params: TARGET
+## Compile the sources of the given target with -fopenmp-simd, when the compiler supports it, so its `omp simd` loops
+## are vectorized without OpenMP threading (or linking the OpenMP runtime)
+include(CheckCXXCompilerFlag)
+function(target_openmp_simd TARGET)
+    check_cxx_compiler_flag(-fopenmp-simd NGEN_HAS_OPENMP_SIMD)
+    if(NGEN_HAS_OPENMP_SIMD)
+        target_compile_options(${TARGET} PRIVATE -fopenmp-simd)
+    endif()
+endfunction()
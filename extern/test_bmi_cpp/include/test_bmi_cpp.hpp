@@ -6,6 +6,7 @@
 #include <vector>
 #include <map>
 #include "bmi.hxx"
+#include "bmi_indexed.hpp"
 #include <numeric>
 #include <iostream>
 
@@ -25,7 +26,7 @@
 #define BMI_TYPE_NAME_SHORT "short"
 #define BMI_TYPE_NAME_LONG "long"
 
-class TestBmiCpp : public bmi::Bmi {
+class TestBmiCpp : public bmi::Bmi, public bmi::BmiIndexed {
     public:
         /**
         * Create a new model data struct instance, allocating memory for the struct itself but not any pointers within it.
@@ -76,6 +77,12 @@ class TestBmiCpp : public bmi::Bmi {
         virtual void SetValue(std::string name, void *src);
         virtual void SetValueAtIndices(std::string name, int *inds, int count, void *src);
 
+        // Variable access by handle
+        virtual int GetVarIndex(std::string name);
+        virtual void GetValueByIndex(int index, void *dest);
+        virtual void *GetValuePtrByIndex(int index);
+        virtual void SetValueByIndex(int index, void *src);
+
         // Grid information functions
         virtual int GetGridRank(const int grid);
         virtual int GetGridSize(const int grid);
@@ -101,6 +108,9 @@ class TestBmiCpp : public bmi::Bmi {
 
 
     private:
+        /** The name of the variable with a handle from GetVarIndex. */
+        std::string get_var_name(int index);
+
 
         inline void set_usage(bool input_array = false, bool output_array = false){
             use_input_array = input_array;
@@ -289,6 +289,55 @@ void TestBmiCpp::SetValue(std::string name, void* src){
   std::memcpy (dest, src, nbytes);
 }
 
+int TestBmiCpp::GetVarIndex(std::string name){
+  // Handles are positions among the input variables, then the output variables
+  for (size_t i = 0; i < this->input_var_names.size(); ++i) {
+    if (this->input_var_names[i] == name) {
+      return (int) i;
+    }
+  }
+  for (size_t i = 0; i < this->output_var_names.size(); ++i) {
+    if (this->output_var_names[i] == name) {
+      return (int) (this->input_var_names.size() + i);
+    }
+  }
+  return -1;
+}
+
+void TestBmiCpp::GetValueByIndex(int index, void* dest){
+  int nbytes = this->GetVarNbytes(this->get_var_name(index));
+  std::memcpy(dest, this->GetValuePtrByIndex(index), nbytes);
+}
+
+void* TestBmiCpp::GetValuePtrByIndex(int index){
+  double* inputs[] = { this->input_var_1.get(), this->input_var_2.get(), this->input_var_3.get() };
+  double* outputs[] = { this->output_var_1.get(), this->output_var_2.get(), this->output_var_3.get() };
+  int input_count = (int) this->input_var_names.size();
+  if (index >= 0 && index < input_count) {
+    return inputs[index];
+  }
+  if (index >= input_count && index < input_count + (int) this->output_var_names.size()) {
+    return outputs[index - input_count];
+  }
+  throw std::runtime_error("GetValuePtrByIndex called for unknown variable handle: " + std::to_string(index));
+}
+
+std::string TestBmiCpp::get_var_name(int index){
+  int input_count = (int) this->input_var_names.size();
+  if (index >= 0 && index < input_count) {
+    return this->input_var_names[index];
+  }
+  if (index >= input_count && index < input_count + (int) this->output_var_names.size()) {
+    return this->output_var_names[index - input_count];
+  }
+  throw std::runtime_error("Unknown variable handle: " + std::to_string(index));
+}
+
+void TestBmiCpp::SetValueByIndex(int index, void* src){
+  int nbytes = this->GetVarNbytes(this->get_var_name(index));
+  std::memcpy(this->GetValuePtrByIndex(index), src, nbytes);
+}
+
 void TestBmiCpp::Update(){
   this->UpdateUntil(this->current_model_time + this->time_step_size);
 }
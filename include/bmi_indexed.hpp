@@ -0,0 +1,49 @@
+// An optional extension of the Basic Model Interface (BMI) C++ specification in bmi.hpp, for
+// addressing a model's variables by integer handles rather than by name.
+//
+// This is not part of the CSDMS specification; a model that doesn't implement it is used through
+// bmi::Bmi alone.  It doesn't depend on bmi.hpp, so a model may include it alongside whichever copy
+// of the specification it is built with.
+
+#ifndef BMI_INDEXED_HPP
+#define BMI_INDEXED_HPP
+
+#include <string>
+
+namespace bmi {
+
+  /**
+   * Index-based access to the variables of a C++ BMI model.
+   *
+   * Each ``bmi::Bmi`` variable function takes the variable's name, which the model must then find, e.g. by hashing or
+   * comparing strings, on every call.  A model deriving from this class as well as from ``bmi::Bmi`` lets a framework
+   * resolve each name to a handle once, with ``GetVarIndex``, and then get, set and take pointers to the variable's
+   * values by that handle each time step:
+   *
+   * @code {.cpp}
+   * class Example_Model : public bmi::Bmi, public bmi::BmiIndexed { ... };
+   * @endcode
+   *
+   * The values passed by handle are as those passed by name to the analogous ``bmi::Bmi`` functions.  A handle stays
+   * valid for the life of the model, though a pointer from ``GetValuePtrByIndex`` may move as the model updates, as
+   * with ``GetValuePtr``.
+   */
+  class BmiIndexed {
+    public:
+      virtual ~BmiIndexed() {}
+
+      /**
+       * Get the handle of a variable.
+       *
+       * @param name The name of an input or output variable of the model.
+       * @return The handle, which is ``0`` or more, or ``-1`` if the model has no such variable.
+       */
+      virtual int GetVarIndex(std::string name) = 0;
+
+      virtual void GetValueByIndex(int index, void *dest) = 0;
+      virtual void *GetValuePtrByIndex(int index) = 0;
+      virtual void SetValueByIndex(int index, void *src) = 0;
+  };
+}
+
+#endif
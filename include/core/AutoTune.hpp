@@ -0,0 +1,358 @@
+#ifndef NGEN_AUTO_TUNE_HPP
+#define NGEN_AUTO_TUNE_HPP
+
+#include <cstddef>
+#include <ctime>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+namespace autotune {
+
+    /** The path of the realization config setting naming the tuning file a run loads, see @ref apply_tuning_file. */
+    const std::string TUNING_FILE_PATH = "execution.tuning_file";
+
+    /** The profiler region whose total time is what a tuning run minimizes: every time step of the run. */
+    const std::string TIMED_REGION = "main/time_step";
+
+    /**
+     * @brief A setting of a realization config to tune, and the values to try.
+     *
+     * The setting is named by its path in the config, with ``.`` separating the keys of nested objects, e.g.
+     * ``execution.time_block``.
+     */
+    struct Knob {
+        std::string path;
+        /** The value the config has, which a tuning run starts from. */
+        long initial;
+        std::vector<long> values;
+    };
+
+    /**
+     * @brief The settings of a realization config worth tuning on this host, and the values to try for each.
+     *
+     * These are the ``catchment_threads`` and ``time_block`` of the ``execution`` block, the ``cache_size_mb`` of
+     * global NetCDF forcing, and the ``nexus_buffer_steps`` and, for the binary and parquet catchment output
+     * formats, ``catchment_buffer_mb`` of the ``output`` block.  A setting that cannot make a difference, such as
+     * ``time_block`` with a ``lookahead``, is left out.
+     *
+     * @param config The realization config.
+     * @param cpus The number of CPUs the run may use.
+     * @param window_steps The number of time steps a tuning run times, which bounds the ``time_block``.
+     */
+    inline std::vector<Knob> default_knobs(const boost::property_tree::ptree& config, std::size_t cpus,
+                                           long window_steps)
+    {
+        std::vector<Knob> knobs;
+
+        if (cpus > 1) {
+            Knob threads{"execution.catchment_threads", config.get<long>("execution.catchment_threads", 1), {}};
+            //0 is every CPU the process may run on
+            if (threads.initial == 0) {
+                threads.initial = static_cast<long>(cpus);
+            }
+            for (long n = 1; n < static_cast<long>(cpus); n *= 2) {
+                threads.values.push_back(n);
+            }
+            threads.values.push_back(static_cast<long>(cpus));
+            knobs.push_back(std::move(threads));
+        }
+
+        if (config.get<long>("execution.lookahead", 0) == 0 && window_steps > 1) {
+            Knob time_block{"execution.time_block", config.get<long>("execution.time_block", 1), {}};
+            for (long k = 1; k <= 64 && k <= window_steps; k *= 2) {
+                time_block.values.push_back(k);
+            }
+            knobs.push_back(std::move(time_block));
+        }
+
+        const std::string provider = config.get<std::string>("global.forcing.provider", "");
+        if (provider == "NetCDF" || provider == "NetCDFGridded") {
+            Knob cache{"global.forcing.cache_size_mb", config.get<long>("global.forcing.cache_size_mb", 0),
+                       {64, 256, 1024, 4096}};
+            //0 is the providers' default budget
+            if (cache.initial == 0) {
+                cache.initial = 256;
+            }
+            knobs.push_back(std::move(cache));
+        }
+
+        knobs.push_back(Knob{"output.nexus_buffer_steps", config.get<long>("output.nexus_buffer_steps", 32),
+                             {8, 32, 128, 512}});
+
+        const std::string catchment_format = config.get<std::string>("output.catchment_format", "csv");
+        if (catchment_format == "binary" || catchment_format == "parquet") {
+            knobs.push_back(Knob{"output.catchment_buffer_mb", config.get<long>("output.catchment_buffer_mb", 8),
+                                 {1, 8, 32, 128}});
+        }
+        return knobs;
+    }
+
+    /**
+     * @brief Sweeps the values of each knob in turn, keeping the best of each before sweeping the next.
+     *
+     * The first candidate is the initial values of every knob.  Each knob is then tried at each of its other values,
+     * with the others at the best values found so far, so a sweep times one run per value of each knob rather than
+     * one per combination of values.  A candidate that could not be timed is recorded as such and never chosen.
+     *
+     * @code {.cpp}
+     * autotune::Coordinate_Sweep sweep(knobs);
+     * std::vector<long> values;
+     * while (sweep.next(values)) {
+     *     sweep.record(time_run(values));
+     * }
+     * @endcode
+     */
+    class Coordinate_Sweep {
+      public:
+
+        explicit Coordinate_Sweep(std::vector<Knob> knobs) : knobs(std::move(knobs))
+        {
+            for (const Knob& knob : this->knobs) {
+                best_values.push_back(knob.initial);
+            }
+        }
+
+        const std::vector<Knob>& get_knobs() const { return knobs; }
+
+        /**
+         * @brief The next candidate to time, which @ref record must be given the time of before asking for another.
+         *
+         * @param values Set to the value of each knob, in order, of the candidate.
+         * @return Whether there is a candidate left.
+         */
+        bool next(std::vector<long>& values)
+        {
+            if (is_pending) {
+                throw std::logic_error("The time of the last tuning candidate has not been recorded.");
+            }
+            if (runs > 0) {
+                //Skip the value of the current knob its sweep started from, which has already been timed
+                for (; knob_index < knobs.size(); ++knob_index, value_index = 0) {
+                    if (value_index == 0) {
+                        sweep_start_value = best_values[knob_index];
+                    }
+                    const std::vector<long>& knob_values = knobs[knob_index].values;
+                    while (value_index < knob_values.size() && knob_values[value_index] == sweep_start_value) {
+                        ++value_index;
+                    }
+                    if (value_index < knob_values.size()) {
+                        break;
+                    }
+                }
+                if (knob_index == knobs.size()) {
+                    return false;
+                }
+            }
+            candidate = best_values;
+            if (runs > 0) {
+                candidate[knob_index] = knobs[knob_index].values[value_index++];
+            }
+            values = candidate;
+            is_pending = true;
+            return true;
+        }
+
+        /**
+         * @brief Record the time of the last candidate.
+         *
+         * @param seconds The time, or a negative number if the candidate's run failed.
+         */
+        void record(double seconds)
+        {
+            if (!is_pending) {
+                throw std::logic_error("There is no tuning candidate to record the time of.");
+            }
+            is_pending = false;
+            ++runs;
+            if (seconds >= 0 && seconds < best) {
+                best = seconds;
+                best_values = candidate;
+            }
+        }
+
+        /** @return The values of the fastest candidate so far, or the initial values if none has been timed. */
+        const std::vector<long>& get_best_values() const { return best_values; }
+
+        /** @return The time of the fastest candidate so far, or infinity if none has been timed. */
+        double get_best_seconds() const { return best; }
+
+        /** @return The number of candidates recorded. */
+        std::size_t get_runs() const { return runs; }
+
+      private:
+
+        std::vector<Knob> knobs;
+        std::vector<long> best_values;
+        std::vector<long> candidate;
+        double best = std::numeric_limits<double>::infinity();
+        std::size_t runs = 0;
+        std::size_t knob_index = 0;
+        std::size_t value_index = 0;
+        long sweep_start_value = 0;
+        bool is_pending = false;
+    };
+
+    /**
+     * @brief The realization config of a tuning run of a candidate.
+     *
+     * The run covers the first time steps of the config, and writes its outputs and its profile into a directory of
+     * its own.  Whatever would make one run affect another or outlive it is turned off: checkpoints, rebalancing,
+     * response caching, metrics and loading a tuning file; a stream catchment output is written as a binary file, so
+     * no subscriber is waited for.
+     *
+     * @param config The realization config.
+     * @param knobs The knobs.
+     * @param values The value of each knob, in order.
+     * @param window_steps The number of time steps to run.
+     * @param directory The directory of the run's outputs, ending with a ``/``.
+     * @throws std::runtime_error If the config has no ``time``.
+     */
+    inline boost::property_tree::ptree trial_config(const boost::property_tree::ptree& config,
+                                                    const std::vector<Knob>& knobs, const std::vector<long>& values,
+                                                    long window_steps, const std::string& directory)
+    {
+        boost::property_tree::ptree trial = config;
+        for (std::size_t k = 0; k < knobs.size(); ++k) {
+            trial.put(knobs[k].path, values[k]);
+        }
+
+        auto time = trial.get_child_optional("time");
+        if (!time || !time->get_optional<std::string>("start_time") || !time->get_optional<long>("output_interval")) {
+            throw std::runtime_error("A realization config to tune needs a time start_time and output_interval.");
+        }
+        //As parsed by simulation_time_params, in UTC
+        const char* date_format = "%Y-%m-%d %H:%M:%S";
+        struct tm start_tm = {};
+        strptime(time->get<std::string>("start_time").c_str(), date_format, &start_tm);
+        const time_t window_end = timegm(&start_tm) + window_steps * time->get<long>("output_interval");
+        const time_t config_end = [&]() {
+            struct tm end_tm = {};
+            strptime(time->get<std::string>("end_time", "").c_str(), date_format, &end_tm);
+            return timegm(&end_tm);
+        }();
+        if (window_end < config_end) {
+            struct tm end_tm = {};
+            gmtime_r(&window_end, &end_tm);
+            char end_time[32];
+            std::strftime(end_time, sizeof(end_time), date_format, &end_tm);
+            time->put("end_time", end_time);
+        }
+
+        trial.put("output.nexus_path", directory);
+        trial.put("output.catchment_path", directory);
+        trial.put("output.status_path", directory);
+        trial.put("output.profile_path", directory);
+        trial.put("output.profile_trace", false);
+        trial.put("output.metrics_path", "");
+        if (trial.get<std::string>("output.catchment_format", "csv") == "stream") {
+            trial.put("output.catchment_format", "binary");
+        }
+        trial.put("execution.checkpoint_interval", 0);
+        trial.put("execution.rebalance_threshold", 0);
+        auto execution = trial.get_child_optional("execution");
+        execution->erase("response_cache");
+        execution->erase("tuning_file");
+        return trial;
+    }
+
+    /**
+     * @brief The total time of a region in a profile summary written by a run.
+     *
+     * @param summary_path The path of the run's ``profile_summary.json``.
+     * @param region The name of the region.
+     * @return The region's total seconds, over every thread and process.
+     * @throws std::runtime_error If the summary cannot be read or has no such region.
+     */
+    inline double read_region_seconds(const std::string& summary_path, const std::string& region)
+    {
+        boost::property_tree::ptree summary;
+        try {
+            boost::property_tree::json_parser::read_json(summary_path, summary);
+        }
+        catch (const boost::property_tree::json_parser_error& e) {
+            throw std::runtime_error("Cannot read profile summary " + summary_path + ": " + e.message());
+        }
+        for (const auto& entry : summary.get_child("regions", boost::property_tree::ptree())) {
+            if (entry.second.get<std::string>("name", "") == region) {
+                return entry.second.get<double>("total_seconds");
+            }
+        }
+        throw std::runtime_error("Profile summary " + summary_path + " has no region " + region);
+    }
+
+    /**
+     * @brief Write the values of the knobs as a tuning file, a JSON object laid out as the realization config.
+     *
+     * @throws std::runtime_error If the file cannot be written.
+     */
+    inline void write_tuning_file(const std::string& path, const std::vector<Knob>& knobs,
+                                  const std::vector<long>& values)
+    {
+        boost::property_tree::ptree tuning;
+        for (std::size_t k = 0; k < knobs.size(); ++k) {
+            tuning.put(knobs[k].path, values[k]);
+        }
+        try {
+            boost::property_tree::json_parser::write_json(path, tuning);
+        }
+        catch (const boost::property_tree::json_parser_error& e) {
+            throw std::runtime_error("Cannot write tuning file " + path + ": " + e.message());
+        }
+    }
+
+    /**
+     * @brief Set every value of a tuning file in a realization config, overriding what the config sets itself.
+     *
+     * @param config The realization config.
+     * @param path The path of the tuning file.
+     * @throws std::runtime_error If the file cannot be read.
+     */
+    inline void apply_tuning(boost::property_tree::ptree& config, const std::string& path)
+    {
+        boost::property_tree::ptree tuning;
+        try {
+            boost::property_tree::json_parser::read_json(path, tuning);
+        }
+        catch (const boost::property_tree::json_parser_error& e) {
+            throw std::runtime_error("Cannot read tuning file " + path + ": " + e.message());
+        }
+        //Each value is a leaf, found by the keys of the objects holding it
+        std::vector<std::pair<std::string, const boost::property_tree::ptree*>> pending = {{"", &tuning}};
+        while (!pending.empty()) {
+            const std::string prefix = pending.back().first;
+            const boost::property_tree::ptree* node = pending.back().second;
+            pending.pop_back();
+            for (const auto& child : *node) {
+                const std::string child_path = prefix.empty() ? child.first : prefix + "." + child.first;
+                if (child.second.empty()) {
+                    config.put(child_path, child.second.data());
+                }
+                else {
+                    pending.emplace_back(child_path, &child.second);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Apply the tuning file a realization config names in its ``execution`` block, if any.
+     *
+     * @see apply_tuning
+     */
+    inline void apply_tuning_file(boost::property_tree::ptree& config)
+    {
+        auto path = config.get_optional<std::string>(TUNING_FILE_PATH);
+        if (path && !path->empty()) {
+            apply_tuning(config, *path);
+        }
+    }
+
+}
+
+#endif //NGEN_AUTO_TUNE_HPP
@@ -0,0 +1,283 @@
+#ifndef NGEN_CALIBRATION_RUN_HPP
+#define NGEN_CALIBRATION_RUN_HPP
+
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include "CSV_Reader.h"
+#include "Ensemble_Formulation.hpp"
+#include "Formulation_Manager.hpp"
+#include "FeatureCollection.hpp"
+#include "Pdm03.h"
+
+namespace calibration {
+
+    /**
+     * @brief Sets of values of the same parameters, one set per member of a calibration run.
+     *
+     * Parameter names are paths into the ``params`` of a formulation, with ``.`` separating the keys of nested objects,
+     * e.g. ``model_params.Kn``.
+     */
+    struct ParameterSets {
+        std::vector<std::string> names;
+        /** The values of each set, in the order of @ref names. */
+        std::vector<std::vector<double>> values;
+
+        std::size_t size() const { return values.size(); }
+    };
+
+    /**
+     * @brief Read parameter sets from a CSV file, with a header line of parameter names and a line per set.
+     *
+     * @throws std::runtime_error If the file cannot be read, has no sets, or a set does not have a value per name.
+     */
+    inline ParameterSets read_parameter_sets(const std::string& file_path)
+    {
+        std::vector<std::vector<std::string>> rows = CSVReader(file_path).getData();
+        ParameterSets sets;
+        for (std::size_t r = 0; r < rows.size(); ++r) {
+            for (std::string& cell : rows[r]) {
+                boost::algorithm::trim(cell);
+            }
+            //Blank lines are skipped
+            if (rows[r].size() == 1 && rows[r][0].empty()) {
+                continue;
+            }
+            if (sets.names.empty()) {
+                sets.names = rows[r];
+                continue;
+            }
+            if (rows[r].size() != sets.names.size()) {
+                throw std::runtime_error("Line " + std::to_string(r + 1) + " of parameter sets " + file_path + " has "
+                                         + std::to_string(rows[r].size()) + " values for its "
+                                         + std::to_string(sets.names.size()) + " parameters.");
+            }
+            std::vector<double> set;
+            set.reserve(rows[r].size());
+            for (const std::string& cell : rows[r]) {
+                try {
+                    set.push_back(std::stod(cell));
+                }
+                catch (const std::logic_error&) {
+                    throw std::runtime_error("Line " + std::to_string(r + 1) + " of parameter sets " + file_path
+                                             + " has a value '" + cell + "' that is not a number.");
+                }
+            }
+            sets.values.push_back(std::move(set));
+        }
+        if (sets.values.empty()) {
+            throw std::runtime_error("Parameter sets " + file_path + " has no sets.");
+        }
+        return sets;
+    }
+
+    /**
+     * @brief Replace every formulation of a realization config with an ``ensemble`` of it, with a member per set.
+     *
+     * Each member replaces the parameters of the formulation's ``params`` with those of its set; any ``time_step`` of
+     * the formulation is kept as that of the ensemble.
+     *
+     * @param config The realization config, whose ``global`` and ``catchments`` formulations are replaced.
+     * @param sets The parameter sets.
+     * @throws std::invalid_argument If there are no sets, or a formulation already is an ensemble.
+     */
+    inline void apply_parameter_sets(boost::property_tree::ptree& config, const ParameterSets& sets)
+    {
+        if (sets.size() == 0) {
+            throw std::invalid_argument("A calibration run needs at least one parameter set.");
+        }
+        boost::property_tree::ptree members;
+        for (const std::vector<double>& set : sets.values) {
+            boost::property_tree::ptree member;
+            for (std::size_t p = 0; p < sets.names.size(); ++p) {
+                member.put(sets.names[p], set[p]);
+            }
+            members.push_back(std::make_pair("", member));
+        }
+
+        auto wrap = [&](boost::property_tree::ptree& formulations) {
+            for (auto& formulation : formulations) {
+                boost::property_tree::ptree& tree = formulation.second;
+                if (tree.get<std::string>("name", "") == "ensemble") {
+                    throw std::invalid_argument("Formulations of a calibration run cannot already be ensembles.");
+                }
+                boost::property_tree::ptree ensemble;
+                ensemble.put("name", "ensemble");
+                boost::property_tree::ptree& member_formulation = ensemble.put_child("params.formulation",
+                                                                                    boost::property_tree::ptree());
+                member_formulation.put_child("name", tree.get_child("name"));
+                member_formulation.put_child("params", tree.get_child("params", boost::property_tree::ptree()));
+                ensemble.put_child("params.members", members);
+                if (tree.get_child_optional("time_step")) {
+                    ensemble.put_child("time_step", tree.get_child("time_step"));
+                }
+                tree = std::move(ensemble);
+            }
+        };
+
+        auto global_formulations = config.get_child_optional("global.formulations");
+        if (global_formulations) {
+            wrap(*global_formulations);
+        }
+        auto catchments = config.get_child_optional("catchments");
+        if (catchments) {
+            for (auto& catchment : *catchments) {
+                auto formulations = catchment.second.get_child_optional("formulations");
+                if (formulations) {
+                    wrap(*formulations);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief A run of many parameter sets of the formulations of some catchments at once, for calibrating them.
+     *
+     * Calibrating runs the same catchments over and over with new parameters, so running each set as its own
+     * simulation spends most of its time reading configs, hydrofabric and forcing, and initializing models.  This
+     * instead reads the config, hydrofabric and forcing once and runs every set as a member of an
+     * realization::Ensemble_Formulation of each catchment, keeping the flows of the gauges being calibrated against in
+     * memory for each set, rather than writing any outputs.
+     *
+     * @code {.cpp}
+     * boost::property_tree::ptree config;
+     * boost::property_tree::json_parser::read_json("realization.json", config);
+     * calibration::CalibrationRun run(config, geojson::read("gauge_catchments.geojson"),
+     *                                 calibration::read_parameter_sets("sets.csv"));
+     * auto flows = run.run({"nex-26"});
+     * // flows[0][s][t] is the flow of nex-26 with set s at output time t, in m^3/s
+     * @endcode
+     *
+     * Flows of a gauge are the sum of the flows of the catchments draining to it (by their ``toid``), in m^3/s, as
+     * received by the gauge's nexus; they are not routed.
+     */
+    class CalibrationRun {
+      public:
+
+        /** The flows of a gauge, for each parameter set then each output time step, in m^3/s. */
+        typedef std::vector<std::vector<double>> gauge_flows_t;
+
+        /**
+         * @brief Read the formulations of some catchments, with a member for each parameter set.
+         *
+         * @param config The realization config, which need not have any ensembles.
+         * @param catchments The catchments to run, which must have ``toid`` and ``areasqkm`` (or ``area_sqkm``)
+         *                   properties.
+         * @param sets The parameter sets.
+         * @param et_params ET parameters for the formulations, or null for none.
+         */
+        CalibrationRun(boost::property_tree::ptree config, geojson::GeoJSON catchments, const ParameterSets& sets,
+                       std::shared_ptr<pdm03_struct> et_params = nullptr)
+            : catchments(catchments), set_count(sets.size())
+        {
+            apply_parameter_sets(config, sets);
+            manager = std::make_shared<realization::Formulation_Manager>(config);
+            // Every set runs as a member of the ensembles, so none can be replayed
+            manager->disallow_response_cache();
+            manager->read(catchments, utils::StreamHandler());
+            if (et_params != nullptr) {
+                for (auto& formulation : *manager) {
+                    formulation.second->set_et_params(et_params);
+                }
+            }
+        }
+
+        /** @return The number of parameter sets, and so of members of each ensemble. */
+        std::size_t size() const { return set_count; }
+
+        /**
+         * @brief Run the whole simulation time of the config for every parameter set.
+         *
+         * Only the catchments draining to one of @p gauge_ids are run, and a run's formulations can only be run once.
+         *
+         * @param gauge_ids The nexuses whose flows to keep.
+         * @return The flows of each of @p gauge_ids, in the same order.
+         * @throws std::invalid_argument If no catchment drains to one of @p gauge_ids.
+         * @throws std::runtime_error If a formulation has a time step other than the output interval.
+         */
+        std::vector<gauge_flows_t> run(const std::vector<std::string>& gauge_ids)
+        {
+            std::unordered_map<std::string, std::size_t> gauge_index;
+            for (std::size_t g = 0; g < gauge_ids.size(); ++g) {
+                gauge_index.emplace(gauge_ids[g], g);
+            }
+
+            const int output_times = manager->Simulation_Time_Object->get_total_output_times();
+            const long interval = manager->Simulation_Time_Object->get_output_interval_seconds();
+
+            //The ensemble of each catchment draining to a gauge, its gauge, and the factor to m^3/s of its responses
+            std::vector<std::shared_ptr<realization::Ensemble_Formulation>> ensembles;
+            std::vector<std::size_t> gauges;
+            std::vector<double> flow_factors;
+            std::vector<bool> gauge_found(gauge_ids.size(), false);
+            for (const geojson::Feature& catchment : *catchments) {
+                if (!catchment->has_property("toid")) {
+                    continue;
+                }
+                auto gauge = gauge_index.find(catchment->get_property("toid").as_string());
+                if (gauge == gauge_index.end()) {
+                    continue;
+                }
+                auto ensemble = std::dynamic_pointer_cast<realization::Ensemble_Formulation>(
+                        manager->get_formulation(catchment->get_id()));
+                if (ensemble == nullptr) {
+                    throw std::runtime_error("Catchment " + catchment->get_id() + " has no formulation to calibrate.");
+                }
+                if (ensemble->get_time_step_seconds() != 0 && ensemble->get_time_step_seconds() != interval) {
+                    throw std::runtime_error("The formulation of " + catchment->get_id() + " has a time step other "
+                                             "than the output interval, which calibration runs do not support.");
+                }
+                ensembles.push_back(ensemble);
+                gauges.push_back(gauge->second);
+                flow_factors.push_back(area_m2(catchment) / interval);
+                gauge_found[gauge->second] = true;
+            }
+            for (std::size_t g = 0; g < gauge_ids.size(); ++g) {
+                if (!gauge_found[g]) {
+                    throw std::invalid_argument("No catchment of the calibration run drains to gauge " + gauge_ids[g]);
+                }
+            }
+
+            std::vector<gauge_flows_t> flows(gauge_ids.size(),
+                                             gauge_flows_t(set_count, std::vector<double>(output_times, 0.0)));
+            for (int t = 0; t < output_times; ++t) {
+                for (std::size_t c = 0; c < ensembles.size(); ++c) {
+                    ensembles[c]->get_response(t, interval);
+                    const std::vector<double>& responses = ensembles[c]->get_member_responses();
+                    gauge_flows_t& gauge_flows = flows[gauges[c]];
+                    for (std::size_t s = 0; s < set_count; ++s) {
+                        gauge_flows[s][t] += responses[s] * flow_factors[c];
+                    }
+                }
+            }
+            return flows;
+        }
+
+      private:
+
+        static double area_m2(const geojson::Feature& catchment)
+        {
+            for (const char* name : {"areasqkm", "area_sqkm"}) {
+                if (catchment->has_property(name)) {
+                    return catchment->get_property(name).as_real_number() * 1000000;
+                }
+            }
+            throw std::runtime_error("Catchment " + catchment->get_id() + " has no areasqkm or area_sqkm property, so "
+                                     "its flow cannot be converted to m^3/s.");
+        }
+
+        geojson::GeoJSON catchments;
+        std::size_t set_count;
+        std::shared_ptr<realization::Formulation_Manager> manager;
+    };
+}
+
+#endif // NGEN_CALIBRATION_RUN_HPP
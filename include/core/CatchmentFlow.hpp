@@ -0,0 +1,48 @@
+#ifndef NGEN_CATCHMENT_FLOW_HPP
+#define NGEN_CATCHMENT_FLOW_HPP
+
+#include <stdexcept>
+#include <string>
+
+#include <features/Features.hpp>
+
+namespace ngen {
+
+    /**
+     * The area of a catchment in m^2, from its ``areasqkm`` property, or its ``area_sqkm`` property in hydrofabrics
+     * that spell it that way.
+     *
+     * @throws std::runtime_error If the catchment has neither.
+     */
+    inline double catchment_area_m2(const geojson::Feature& catchment, const std::string& id)
+    {
+        if(catchment != nullptr) {
+            for(const char* name : {"areasqkm", "area_sqkm"}) {
+                if(catchment->has_property(name)) {
+                    return catchment->get_property(name).as_real_number() * 1000000;
+                }
+            }
+        }
+        throw std::runtime_error("Catchment " + id + " has no areasqkm or area_sqkm property, so its flow cannot be "
+                                 "converted to m^3/s.");
+    }
+
+    /**
+     * The factor taking a catchment's response, summed over a formulation time step, to m^3/s, resolved once per
+     * catchment rather than every time step.
+     *
+     * An implicit assumption is that a module's get_response returns m/timestep, and the responses are summed over the
+     * output intervals the formulation ran for, so m^3 over those intervals / (intervals * seconds per interval) is
+     * m^3/s.
+     *
+     * @param area_m2 The area of the catchment, e.g., from @ref catchment_area_m2.
+     * @param step_multiple The output intervals of a time step of the catchment's formulation.
+     * @param output_interval_seconds The seconds of an output interval.
+     */
+    inline double catchment_flow_factor(double area_m2, long step_multiple, long output_interval_seconds)
+    {
+        return area_m2 / static_cast<double>(step_multiple * output_interval_seconds);
+    }
+}
+
+#endif //NGEN_CATCHMENT_FLOW_HPP
@@ -0,0 +1,131 @@
+#ifndef NGEN_CHANNEL_ROUTING_HPP
+#define NGEN_CHANNEL_ROUTING_HPP
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "network.hpp"
+#include "channel/MuskingumCunge.hpp"
+#include "ThreadPool.hpp"
+#include "Checkpoint.hpp"
+
+namespace network {
+
+    /**
+     * @brief Muskingum-Cunge channel routing of the flowpath of every catchment in a network::Network.
+     *
+     * Each catchment's flowpath is a reach, which takes its catchment's runoff as lateral inflow, and the routed
+     * outflows of the reaches of the catchments upstream of it (those contributing to its origination nexuses) as
+     * inflow; the routed flow of a nexus is the sum of the outflows of its contributing reaches.
+     *
+     * Reaches are kept in blocks of topological levels: a reach's level is one more than the highest level of the
+     * reaches upstream of it, so the reaches of a level only depend on reaches of earlier levels.  Each (sub)step
+     * routes the levels in order, and within a level every reach independently, from contiguous per reach arrays,
+     * optionally spreading large levels over a thread pool.
+     *
+     * @code {.cpp}
+     * network::ChannelRouting routing(network, [](const std::string& id) { return params_of(id); }, 12);
+     * std::vector<double> lateral(routing.catchment_ids().size());
+     * // each time step, fill lateral with each catchment's runoff in m^3/s, then:
+     * routing.route(lateral, 3600.0);
+     * double flow = routing.nexus_flow(routing.nexus_index("nex-1"));
+     * @endcode
+     */
+    class ChannelRouting {
+      public:
+
+        typedef std::function<muskingum_cunge::channel_params(const std::string&)> params_source_t;
+
+        /**
+         * @brief Construct routing for the catchments and nexuses of @p network, with all flows and storage starting at 0.
+         *
+         * @param network The (already linked) network to route.
+         * @param params_of The channel parameters of the flowpath of a catchment, given the catchment's id.
+         * @param substeps The number of routing steps to take per time step.
+         * @throws std::invalid_argument If @p substeps is not positive, or the catchments of @p network form a cycle.
+         */
+        ChannelRouting(Network& network, const params_source_t& params_of, int substeps = 1);
+
+        virtual ~ChannelRouting(){}
+
+        /** @return The ids of the routed catchments, in routing order, which indexes every per reach value. */
+        const std::vector<std::string>& catchment_ids() const { return reach_ids; }
+
+        /** @return The ids of the nexuses routed flows are given for. */
+        const std::vector<std::string>& nexus_ids() const { return nexus_id_list; }
+
+        /**
+         * @return The routing order index of the reach of catchment @p catchment_id.
+         * @throws std::invalid_argument If @p catchment_id is not routed.
+         */
+        std::size_t reach_index(const std::string& catchment_id) const;
+
+        /**
+         * @return The index of @p nexus_id in @ref nexus_ids.
+         * @throws std::invalid_argument If @p nexus_id is not in the network.
+         */
+        std::size_t nexus_index(const std::string& nexus_id) const;
+
+        /** @return The number of topological levels of the reaches, i.e., the length of the longest flow path. */
+        std::size_t num_levels() const { return level_offsets.size() - 1; }
+
+        /**
+         * @brief Route a time step of flow through every reach.
+         *
+         * @param lateral_inflows The lateral inflow of each reach, in routing order, in m^3/s.
+         * @param dt_seconds The length of the time step, which is divided into the configured substeps.
+         * @param pool Pool to route the reaches of large levels on, or null to route on the calling thread.
+         * @throws std::invalid_argument If there is not one lateral inflow per reach.
+         */
+        void route(const std::vector<double>& lateral_inflows, double dt_seconds, utils::ThreadPool* pool = nullptr);
+
+        /** @return The outflow, in m^3/s, of a reach at the end of the last routed step. */
+        double outflow(std::size_t reach) const { return outflows[reach]; }
+
+        /** @return The routed flow, in m^3/s, of a nexus at the end of the last routed step. */
+        double nexus_flow(std::size_t nexus) const;
+
+        /**
+         * @brief Save the flows and storage of every reach, for @ref load_state to restore.
+         */
+        void save_state(utils::StateWriter& out) const;
+
+        /**
+         * @brief Restore the flows and storage saved by @ref save_state.
+         *
+         * @throws std::runtime_error If the state is not of the same number of reaches.
+         */
+        void load_state(utils::StateReader& in);
+
+      private:
+
+        /** The routing of a range of reaches of one level. */
+        void route_reaches(std::size_t begin, std::size_t end, const std::vector<double>& lateral_inflows,
+                           double dt_seconds);
+
+        int substeps;
+        std::vector<std::string> reach_ids;
+        std::vector<std::string> nexus_id_list;
+        std::unordered_map<std::string, std::size_t> reach_lookup;
+        std::unordered_map<std::string, std::size_t> nexus_lookup;
+        /** The reaches of level ``l`` are ``[level_offsets[l], level_offsets[l + 1])``. */
+        std::vector<std::size_t> level_offsets;
+        /** The reaches upstream of reach ``r`` are ``upstream_reaches[upstream_offsets[r] .. upstream_offsets[r + 1])``. */
+        std::vector<std::size_t> upstream_offsets;
+        std::vector<std::size_t> upstream_reaches;
+        /** The reaches contributing to nexus ``n``, laid out as for #upstream_reaches. */
+        std::vector<std::size_t> nexus_offsets;
+        std::vector<std::size_t> nexus_reaches;
+        std::vector<muskingum_cunge::channel_params> params;
+        /** The inflow from upstream of each reach at the end of the last routed step. */
+        std::vector<double> inflows;
+        /** The outflow of each reach at the end of the last routed step. */
+        std::vector<double> outflows;
+        /** The water stored in each reach, in m^3, at the end of the last routed step. */
+        std::vector<double> storages;
+    };
+}
+
+#endif //NGEN_CHANNEL_ROUTING_HPP
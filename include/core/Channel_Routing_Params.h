@@ -0,0 +1,66 @@
+#ifndef NGEN_CHANNEL_ROUTING_PARAMS_H
+#define NGEN_CHANNEL_ROUTING_PARAMS_H
+
+#include <string>
+
+/**
+ * @brief channel_routing_params providing configuration information for the built-in channel routing.
+ *
+ * These correspond to the optional ``channel_routing`` block of a realization config, e.g.:
+ *
+ * @code {.json}
+ * "channel_routing": {
+ *     "flowpath_data": "./data/flowpath_data.geojson",
+ *     "substeps": 12,
+ *     "mannings_n": 0.05,
+ *     "bottom_width_m": 5.0,
+ *     "side_slope": 2.0
+ * }
+ * @endcode
+ *
+ * When given, the flowpath of every catchment is routed with Muskingum-Cunge (see network::ChannelRouting) each
+ * time step, from the catchment flows of that step, and the routed nexus flows are written alongside the unrouted
+ * nexus output.
+ */
+struct channel_routing_params
+{
+    /**
+     * Whether the config has a ``channel_routing`` block, i.e., whether to route channels at all.
+     */
+    bool enabled;
+
+    /**
+     * GeoJSON of flowpaths, each with its ``realized_catchment`` and optionally its ``length_km``, ``slope_percent``,
+     * ``n``, ``BtmWdth`` and ``ChSlp``; anything not given, for any catchment, falls back to the defaults below.
+     * Empty (the default) uses the defaults for every catchment.
+     */
+    std::string flowpath_data;
+
+    /**
+     * Number of routing steps taken per output time step.
+     */
+    int substeps;
+
+    /** Default reach length, in m. */
+    double length_m;
+
+    /** Default bed slope, in m/m. */
+    double slope;
+
+    /** Default Manning's roughness coefficient. */
+    double mannings_n;
+
+    /** Default width of the channel bed, in m. */
+    double bottom_width_m;
+
+    /** Default horizontal run of each bank per unit of rise. */
+    double side_slope;
+
+    /**
+     * Default constructor, with channel routing disabled.
+     */
+    channel_routing_params() : enabled(false), flowpath_data(""), substeps(1), length_m(1000.0), slope(0.001),
+                               mannings_n(0.05), bottom_width_m(5.0), side_slope(2.0) {}
+};
+
+#endif // NGEN_CHANNEL_ROUTING_PARAMS_H
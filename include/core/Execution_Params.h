@@ -0,0 +1,249 @@
+#ifndef NGEN_EXECUTION_PARAMS_H
+#define NGEN_EXECUTION_PARAMS_H
+
+#include <string>
+
+/**
+ * @brief execution_params providing configuration information for how the simulation driver executes features.
+ *
+ * These correspond to the optional ``execution`` block of a realization config, e.g.:
+ *
+ * @code {.json}
+ * "execution": {
+ *     "catchment_threads": 8,
+ *     "lookahead": 4,
+ *     "time_block": 24,
+ *     "init_threads": 8,
+ *     "forcing_preload_threads": 16,
+ *     "checkpoint_interval": 720,
+ *     "checkpoint_path": "./ngen.ckpt",
+ *     "checkpoint_incremental": true,
+ *     "rebalance_threshold": 1.2,
+ *     "remote_transport": "one_sided",
+ *     "reduce_scatter_steps": 24,
+ *     "remote_chunk_steps": 24,
+ *     "response_cache": "./ngen.responses",
+ *     "page_block": 10000,
+ *     "page_dir": "/tmp",
+ *     "exact_flow_sums": true,
+ *     "device_overlap": true
+ * }
+ * @endcode
+ */
+struct execution_params
+{
+    /**
+     * Number of threads used to run independent catchment formulations within a time step.
+     *
+     * The default of ``1`` runs catchments serially on the main thread.  A value of ``0`` selects the number of CPUs the
+     * process may run on.  Values other than ``1`` require all configured formulations to be safe to run
+     * concurrently with each other (e.g., they must not share a non-thread-safe forcing provider or model library
+     * state).
+     */
+    int catchment_threads;
+
+    /**
+     * Whether to pin each of the ``catchment_threads`` to its own one of the CPUs the process may run on.
+     *
+     * The default of ``false`` leaves thread placement to the operating system.  Pinning keeps each thread's
+     * formulations in its own caches and, with one MPI rank bound to each NUMA domain, in the domain's local memory.
+     * It only has an effect on Linux.
+     */
+    bool pin_threads;
+
+    /**
+     * Number of time steps a feature may run ahead of the slowest feature in the network.
+     *
+     * The default of ``0`` advances all features together, one time step at a time.  Values greater than ``0`` use
+     * dependency driven (wavefront) scheduling, where each catchment or nexus runs a time step as soon as its upstream
+     * features have finished it, allowing headwaters to run ahead of downstream features by up to this many steps.
+     */
+    long lookahead;
+
+    /**
+     * Number of consecutive time steps each catchment runs before the nexuses take the flows of any of them.
+     *
+     * The default of ``1`` runs every catchment for one time step, then the nexuses, before the next time step.  Since
+     * catchment formulations depend only on their forcings, never on nexus flows, larger values instead run each
+     * catchment through a block of this many time steps at once, keeping the flows of the block until the nexuses take
+     * them one time step at a time.  Each formulation's model state then stays in cache across the steps of the block.
+     * Blocks end at checkpoints, and this has no effect with a ``lookahead`` greater than ``0``.
+     */
+    long time_block;
+
+    /**
+     * Number of threads used to construct and initialize catchment formulations while reading the realization config,
+     * and then to construct the features of the hydrofabric that bind them.
+     *
+     * The default of ``1`` constructs formulations serially.  A value of ``0`` selects the number of CPUs the process may
+     * run on.  Values other than ``1`` require the BMI ``Initialize`` of every configured model to be safe to run
+     * concurrently with that of other instances.
+     */
+    int init_threads;
+
+    /**
+     * Number of threads reading the CSV forcing files of the catchments using the global forcing config, while their
+     * formulations are constructed.
+     *
+     * The default of ``0`` leaves each formulation to read its own forcing file as it is constructed, in turn on each
+     * of the ``init_threads``.  Otherwise, the forcing files of every such catchment are found first, then read by this
+     * many threads, in the order the formulations are constructed, while they are; each formulation takes its forcing
+     * once it has been read, or reads it itself if it gets there first.  With many small files on a parallel
+     * filesystem, reading is bound by the latency of each file, so values of e.g. ``16`` or more read them faster.
+     */
+    int forcing_preload_threads;
+
+    /**
+     * Number of time steps between checkpoints of the simulation state.
+     *
+     * The default of ``0`` writes no checkpoints.  Otherwise, the state of every catchment formulation is written to
+     * @ref checkpoint_path after every this many time steps, from which a run can be restarted.  Checkpoints require
+     * a ``lookahead`` of ``0``, so that every feature is at the same time step.
+     */
+    long checkpoint_interval;
+
+    /**
+     * Path of the checkpoint file, to which ``.<rank>`` is appended under MPI; each checkpoint replaces the last.
+     */
+    std::string checkpoint_path;
+
+    /**
+     * Whether checkpoints after the first only add the states that changed since the last one.
+     *
+     * With the default of ``false``, each checkpoint rewrites @ref checkpoint_path in full.  Otherwise, the states that
+     * changed are appended to a journal beside it, with ``.inc`` appended to its path, until the journal grows as large
+     * as the file, when the next checkpoint rewrites it; a restart reads both.  Either way, checkpoints are written by a
+     * background thread while the run continues, and the run only stops to save the states.
+     */
+    bool checkpoint_incremental;
+
+    /**
+     * How much heavier than the mean the load of the heaviest MPI rank may get before the run is rebalanced.
+     *
+     * The default of ``0`` never rebalances.  Otherwise, at each checkpoint the wall time the catchment formulations of
+     * each rank took since the last one is compared, and if the heaviest rank's is more than this many times the mean,
+     * the run ends at the checkpoint and writes the measured cost of each catchment to @ref checkpoint_path with
+     * ``.costs`` appended, to repartition by before restarting.
+     */
+    double rebalance_threshold;
+
+    /**
+     * How MPI ranks exchange the flows of the nexuses they share, each time step.
+     *
+     * The default of ``"neighbor_collective"`` exchanges every rank's flows with its neighbors in one neighborhood
+     * collective.  ``"one_sided"`` instead has each rank put its flows directly into memory exposed by the ranks
+     * downstream of it, without matching sends to receives, which may be cheaper with many small connections.
+     * ``"reduce_scatter"`` exchanges no flows between neighbors: the catchments of a nexus may be on any ranks, each
+     * rank sums the flows of its own catchments into its copy of the nexus, and those partial flows are summed onto the
+     * rank owning each nexus with one ``MPI_Reduce_scatter`` every @ref reduce_scatter_steps time steps, so partitions
+     * need only balance the catchments.  It requires that catchments take no flow from upstream, so it is not used
+     * with routing.  The setting has no effect without MPI.
+     */
+    std::string remote_transport;
+
+    /**
+     * Number of time steps of flows summed by each reduction of the ``"reduce_scatter"`` @ref remote_transport.
+     *
+     * The default is ``24``.  Every rank holds the flows of every nexus of the domain for this many time steps, so
+     * fewer steps take less memory, and more take fewer, larger reductions.
+     */
+    long reduce_scatter_steps;
+
+    /**
+     * Number of time steps of flows each exchange of the ``"neighbor_collective"`` or ``"one_sided"``
+     * @ref remote_transport moves between ranks.
+     *
+     * The default of ``1`` exchanges the flows of each time step before the next one runs.  Flows only go downstream,
+     * and ranks only need the flows of other ranks for their nexus output, so otherwise ranks run this many time steps
+     * without waiting on each other, and then exchange the flows of all of them at once, in one message per neighbor,
+     * paying the latency of an exchange once per chunk.  The output of nexuses is written once the flows of each chunk
+     * are exchanged, and each nexus holds the flows of a whole chunk until then.  Chunks end early at checkpoints.
+     */
+    long remote_chunk_steps;
+
+    /**
+     * Directory of the responses of catchment formulations kept from earlier runs, to replay in reruns.
+     *
+     * The default of ``""`` keeps no responses.  Otherwise, the responses and outputs of every catchment are written to
+     * this directory at the end of a run, with a signature of the catchment's formulation config and forcing, and a
+     * rerun replays those of each catchment whose signature is unchanged rather than construct and run its formulation.
+     * Responses are not kept by runs that restart, cycle or rebalance, nor for formulations with a time step other
+     * than the output interval.
+     */
+    std::string response_cache;
+
+    /**
+     * Number of worker processes hosting the models of ``bmi_python`` formulations, each with its own interpreter.
+     *
+     * The default of ``0`` hosts Python models in this process, where every one of them takes its one GIL, so they run
+     * one at a time however many ``catchment_threads`` there are.  Otherwise, each model is hosted by one of this many
+     * workers, and its inputs, updates and outputs pass through shared memory, so models in different workers run
+     * concurrently.
+     */
+    int python_workers;
+
+    /**
+     * Number of catchments whose models are kept in memory at once, for domains whose models do not all fit.
+     *
+     * The default of ``0`` keeps every model in memory.  Otherwise, catchments run through each ``time_block`` a block
+     * of this many at a time, in their run order, and the models of the other blocks are paged out to a file in
+     * @ref page_dir: their states are saved and the models freed, then constructed again and their states restored
+     * when their block runs next.  The states of the next block are read while the current one runs.  Only models that
+     * can be checkpointed are paged, so their ``checkpoint_variables`` must be configured; other formulations stay in
+     * memory.  As on a restart, checks against a paged model's end time are relative to when it was last paged in.
+     * Paging requires a ``lookahead`` of ``0``.
+     */
+    long page_block;
+
+    /**
+     * Directory of the file the states of paged out models are kept in, which should be on a local disk.
+     */
+    std::string page_dir;
+
+    /**
+     * Whether the flows into each nexus are summed exactly, so they do not depend on the order they are added in.
+     *
+     * The default of ``false`` sums the flows of a nexus in the order they are contributed, which is the catchment
+     * order on a single process, but under MPI depends on the order the flows of other ranks arrive in.  Exact sums
+     * are rounded once, to the nearest double, so runs are then bitwise reproducible whatever that order.  Under MPI, a nexus whose catchments are split between
+     * ranks sums the exact sum each rank sends, so its flows may still differ in the last bit between partitions.
+     */
+    bool exact_flow_sums;
+
+    /**
+     * Whether groups of formulations computed on an accelerator run each time step concurrently with those computed on
+     * the host.
+     *
+     * The default of ``false`` computes every formulation in turn, within ``catchment_threads``, so a batch of models
+     * on a GPU holds up the host formulations while it runs.  Otherwise, each time step (or ``time_block``) of every
+     * such group, e.g. batched ``lstm`` catchments on a GPU, is started on a thread of its own before the host
+     * formulations run, and the group's catchments, run after them, take its results; the nexuses sum the flows once
+     * both have finished.  As with ``catchment_threads`` other than ``1``, formulations must then be safe to run
+     * concurrently with each other.  It has no effect with a ``lookahead`` greater than ``0``, nor with a
+     * ``page_block``.
+     */
+    bool device_overlap;
+
+    /**
+     * Default constructor, using serial execution.
+     */
+    execution_params() : catchment_threads(1), pin_threads(false), lookahead(0), time_block(1), init_threads(1),
+                         forcing_preload_threads(0), checkpoint_interval(0), checkpoint_path("./ngen.ckpt"),
+                         checkpoint_incremental(false), rebalance_threshold(0.0), remote_transport("neighbor_collective"), reduce_scatter_steps(24), remote_chunk_steps(1), response_cache(), python_workers(0),
+                         page_block(0), page_dir("."), exact_flow_sums(false), device_overlap(false) {}
+
+    /*
+     * @brief Constructor for execution_params
+     *
+     * @param catchment_threads
+     * @param lookahead
+     * @param init_threads
+     */
+    execution_params(int catchment_threads, long lookahead = 0, int init_threads = 1)
+        : catchment_threads(catchment_threads), pin_threads(false), lookahead(lookahead), time_block(1), init_threads(init_threads),
+          forcing_preload_threads(0), checkpoint_interval(0), checkpoint_path("./ngen.ckpt"), checkpoint_incremental(false),
+          rebalance_threshold(0.0), remote_transport("neighbor_collective"), reduce_scatter_steps(24), remote_chunk_steps(1), response_cache(), python_workers(0),
+          page_block(0), page_dir("."), exact_flow_sums(false), device_overlap(false) {}
+};
+
+#endif // NGEN_EXECUTION_PARAMS_H
@@ -1,7 +1,10 @@
 #ifndef HY_FEATURES_H
 #define HY_FEATURES_H
 
+#include <stdexcept>
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 #include <HY_Catchment.hpp>
 #include <HY_HydroNexus.hpp>
@@ -27,8 +30,7 @@ namespace hy_features {
      * hy_features::HY_Features features = hy_features::HY_Features(catchment_collection, manager);
      * int time_index = 0;
      * for(const auto& id : features.catchments()) {
-     *     auto r = features.catchment_at(id);
-     *     auto r_c = dynamic_pointer_cast<realization::Catchment_Formulation>(r);
+     *     auto r_c = features.formulation_at(features.handle_of(id));
      *     double response = r_c->get_response(time_index, 3600.0);
      *     std::string output = std::to_string(time_index)+", examlpe_time_stamp,"+
      *                          r_c->get_output_line_for_timestep(time_index)+"\n";
@@ -39,6 +41,12 @@ namespace hy_features {
     class HY_Features {
       using Formulation_Manager = realization::Formulation_Manager;
       public:
+        /**
+         * @brief Dense integer handle of a feature, as assigned by the network::Network this object indexes
+         * 
+         */
+        using handle_t = network::IdTable::handle_t;
+
         /**
          * @brief Construct a new, default HY_Features object
          * 
@@ -60,7 +68,12 @@ namespace hy_features {
          * @brief Construct a new HY_Features object from a Network and a set of formulations.
          * 
          * Constructs the HY_Catchment objects for each catchment feature in the network, and attaches tha formaulation
-         * associated with the catchment found in the Formulation_Manager.  Also constucts each nexus as a HY_PointHydroNexus.
+         * associated with the catchment found in the Formulation_Manager.  Also constucts each nexus as a HY_DendriticNexus,
+         * or as a HY_PointHydroNexus if it has more than one receiving catchment or flows are summed exactly.
+         * 
+         * Features are constructed, and their formulations' csv output files opened, concurrently on the execution
+         * config's ``init_threads`` threads, each taking blocks of consecutive feature handles, and each catchment's
+         * downstream connections are checked for validate_dendridic at the same time.
          * 
          * @param network 
          * @param formulations 
@@ -87,13 +100,54 @@ namespace hy_features {
          * @param id 
          * @return std::shared_ptr<HY_CatchmentRealization> 
          */
-        std::shared_ptr<HY_CatchmentRealization> catchment_at(std::string id)
+        std::shared_ptr<HY_CatchmentRealization> catchment_at(const std::string& id)
+        {
+          return catchment_at(handle_of(id));
+        }
+
+        /**
+         * @brief Get the HY_CatchmentRealization pointer of the feature with handle @p handle
+         * 
+         * If no realization exists for @p handle, a nullptr is returned.
+         * 
+         * @param handle 
+         * @return std::shared_ptr<HY_CatchmentRealization> 
+         */
+        std::shared_ptr<HY_CatchmentRealization> catchment_at(handle_t handle)
         {
-          if( _catchments.find(id) != _catchments.end() )
-            return _catchments[id]->realization;
+          if( handle < _catchments.size() && _catchments[handle] )
+            return _catchments[handle]->realization;
           return nullptr;
         }
 
+        /**
+         * @brief Get the formulation of the catchment with handle @p handle
+         * 
+         * Formulations are resolved when this object is constructed, so this does no casts or reference counting,
+         * for use in per time step loops.  If @p handle is not a catchment, a nullptr is returned.
+         * 
+         * @param handle 
+         * @return realization::Catchment_Formulation* 
+         */
+        inline realization::Catchment_Formulation* formulation_at(handle_t handle) const
+        {
+          return handle < _formulations.size() ? _formulations[handle] : nullptr;
+        }
+
+        /**
+         * @brief Bind the ET parameters of every catchment formulation, once, rather than at each time step
+         * 
+         * @param params 
+         */
+        void set_et_params(const std::shared_ptr<pdm03_struct>& params)
+        {
+          for(auto formulation : _formulations) {
+            if( formulation ) {
+              formulation->set_et_params(params);
+            }
+          }
+        }
+
         /**
          * @brief Get the HY_HydroNexus pointer identifed by @p id
          * 
@@ -102,26 +156,57 @@ namespace hy_features {
          * @param id 
          * @return std::shared_ptr<HY_HydroNexus> 
          */
-        std::shared_ptr<HY_HydroNexus> nexus_at(std::string id)
+        std::shared_ptr<HY_HydroNexus> nexus_at(const std::string& id)
         {
-          if( _nexuses.find(id) != _nexuses.end() )
-            return _nexuses[id];
+          return nexus_at(handle_of(id));
+        }
+
+        /**
+         * @brief Get the HY_HydroNexus pointer of the feature with handle @p handle
+         * 
+         * If no nexus exists for @p handle, a nullptr is returned.
+         * 
+         * @param handle 
+         * @return std::shared_ptr<HY_HydroNexus> 
+         */
+        std::shared_ptr<HY_HydroNexus> nexus_at(handle_t handle)
+        {
+          if( handle < _nexuses.size() )
+            return _nexuses[handle];
           return nullptr;
         }
 
         /**
-         * @brief An iterator of only the catchment feature ids
+         * @brief Get the dense integer handle of the feature identified by @p id
+         * 
+         * Handles index the features of the underlying network::Network, see network::Network::get_handle, so they
+         * can be resolved once and then used for the handle based lookups of this class in per time step loops.
+         * 
+         * @param id 
+         * @return handle_t The handle, or network::IdTable::npos if @p id is not a known feature
+         */
+        inline handle_t handle_of(const std::string& id) const {return network.get_handle(id);}
+
+        /**
+         * @brief The catchment feature ids, in topological order
          * 
-         * @return auto 
+         * @return const std::vector<std::string>& 
          */
-        inline auto catchments(){return network.filter("cat");}
+        inline const std::vector<std::string>& catchments(){return network.filter("cat");}
 
         /**
-         * @brief An iterator of only the nexus feature ids
+         * @brief The nexus feature ids, in topological order
          * 
-         * @return auto 
+         * @return const std::vector<std::string>& 
          */
-        inline auto nexuses(){return network.filter("nex");}
+        inline const std::vector<std::string>& nexuses(){return network.filter("nex");}
+
+        /**
+         * @brief The network::Network graph of feature identities this object indexes.
+         * 
+         * @return network::Network& 
+         */
+        inline network::Network& get_network(){return network;}
 
         /**
          * @brief Get a vector of destination (downstream) nexus pointers.
@@ -131,47 +216,71 @@ namespace hy_features {
          * @param id 
          * @return std::vector<std::shared_ptr<HY_HydroNexus>> 
          */
-        inline std::vector<std::shared_ptr<HY_HydroNexus>> destination_nexuses(std::string  id)
+        inline std::vector<std::shared_ptr<HY_HydroNexus>> destination_nexuses(const std::string& id)
         {
-          std::vector<std::shared_ptr<HY_HydroNexus>> downstream;
-          if( _catchments.find(id) != _catchments.end())
-          {
-            for(const auto& nex_id : _catchments[id]->get_outflow_nexuses())
-            {
-              downstream.push_back(_nexuses[nex_id]);
-            }
-          }
-          return downstream;
+          return destination_nexuses(handle_of(id));
+        }
+
+        /**
+         * @brief Get the destination (downstream) nexus pointers of the catchment with handle @p handle.
+         * 
+         * The nexuses are resolved when this object is constructed, so this does no lookups.  If @p handle is not
+         * a catchment, then an empty vector is returned.
+         * 
+         * @param handle 
+         * @return const std::vector<std::shared_ptr<HY_HydroNexus>>& 
+         */
+        inline const std::vector<std::shared_ptr<HY_HydroNexus>>& destination_nexuses(handle_t handle) const
+        {
+          static const std::vector<std::shared_ptr<HY_HydroNexus>> none;
+          return handle < _destinations.size() ? _destinations[handle] : none;
         }
 
         /**
          * @brief Validates that the feature topology is dendridic.
          * 
+         * The catchments were checked as they were constructed, so this only reports what was found, every catchment
+         * that does not have exactly one downstream connection at once.
+         * 
+         * @throws std::runtime_error If any catchment does not have exactly one downstream connection.
          */
         void validate_dendridic()
         {
-          for(const auto& id : catchments())
+          if( !dendritic_errors.empty() )
           {
-              auto downstream = network.get_destination_ids(id);
-              if(downstream.size() > 1)
-              {
-                std::cerr << "Catchment " << id << " has more than one downstream connection." << std::endl;
-                std::cerr << "Downstreams are: ";
-                for(const auto& id : downstream){
-                  std::cerr <<id<<" ";
-                }
-                std::cerr << std::endl;
-                assert( false );
-              }
-              else if (downstream.size() == 0)
-              {
-                std::cerr << "Catchment " << id << " has 0 downstream connections, must have 1." << std::endl;
-                assert( false );
-              }
+            std::string message = "Catchment topology is not dendridic:";
+            for(const auto& error : dendritic_errors){
+              message += "\n  " + error;
+            }
+            throw std::runtime_error(message);
           }
           std::cout<<"Catchment topology is dendridic."<<std::endl;
         }
 
+        /**
+         * @brief Describe what makes a catchment's downstream connections not dendridic, i.e., not exactly one.
+         * 
+         * @param id The id of the catchment.
+         * @param downstream The ids of its downstream features.
+         * @return The error, or an empty string if the catchment has exactly one downstream connection.
+         */
+        static std::string dendritic_error(const std::string& id, const std::vector<std::string>& downstream)
+        {
+          if(downstream.size() > 1)
+          {
+            std::string error = "Catchment " + id + " has more than one downstream connection. Downstreams are:";
+            for(const auto& downstream_id : downstream){
+              error += " " + downstream_id;
+            }
+            return error;
+          }
+          else if (downstream.size() == 0)
+          {
+            return "Catchment " + id + " has 0 downstream connections, must have 1.";
+          }
+          return std::string();
+        }
+
         /**
          * @brief Destroy the hy features object
          * 
@@ -181,16 +290,29 @@ namespace hy_features {
       private:
 
         /**
-         * @brief Internal mapping of catchment id -> HY_Catchment pointer.
+         * @brief Internal mapping of feature handle -> HY_Catchment pointer, null for features that are not catchments.
          * 
          */
-        std::unordered_map<std::string, std::shared_ptr<HY_Catchment>> _catchments;
+        std::vector<std::shared_ptr<HY_Catchment>> _catchments;
 
         /**
-         * @brief Internal mapping of nexus id -> HY_HydroNexus pointer.
+         * @brief Internal mapping of feature handle -> formulation of the catchment, null for features that are not
+         * catchments, owned by the HY_Catchment objects.
          * 
          */
-        std::unordered_map<std::string, std::shared_ptr<HY_HydroNexus>> _nexuses;
+        std::vector<realization::Catchment_Formulation*> _formulations;
+
+        /**
+         * @brief Internal mapping of feature handle -> HY_HydroNexus pointer, null for features that are not nexuses.
+         * 
+         */
+        std::vector<std::shared_ptr<HY_HydroNexus>> _nexuses;
+
+        /**
+         * @brief Internal mapping of catchment handle -> destination nexus pointers.
+         * 
+         */
+        std::vector<std::vector<std::shared_ptr<HY_HydroNexus>>> _destinations;
 
         /**
          * @brief network::Network graph of identities.
@@ -204,6 +326,20 @@ namespace hy_features {
          */
         std::shared_ptr<Formulation_Manager> formulations;
 
+        /**
+         * @brief The topology errors found while constructing the catchments, in handle order, reported by
+         * validate_dendridic.
+         * 
+         */
+        std::vector<std::string> dendritic_errors;
+
+        /**
+         * @brief The number of consecutive feature handles each task constructs when the features are constructed
+         * concurrently.
+         * 
+         */
+        static constexpr std::size_t CONSTRUCTION_BLOCK_SIZE = 1024;
+
     };
 }
 
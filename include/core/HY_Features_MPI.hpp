@@ -3,10 +3,15 @@
 //Only need this unit when using MPI.  It won't compile without other MPI dependent code.
 #ifdef NGEN_MPI_ACTIVE
 
+#include <chrono>
+#include <ostream>
+#include <stdexcept>
+#include <string>
 #include <unordered_map>
 
 #include <HY_Catchment.hpp>
 #include <HY_PointHydroNexusRemote.hpp>
+#include <RemoteNexusExchange.hpp>
 #include <network.hpp>
 #include <Formulation_Manager.hpp>
 #include <Partition_Parser.hpp>
@@ -17,68 +22,205 @@ namespace hy_features {
       public:
       
       using Formulation_Manager = realization::Formulation_Manager;
+      using handle_t = network::IdTable::handle_t;
       
         HY_Features_MPI(PartitionData partition_data, geojson::GeoJSON linked_hydro_fabric,
                         std::shared_ptr<Formulation_Manager> formulations, int mpi_rank, int mpi_num_procs);
 
-        std::shared_ptr<HY_CatchmentRealization> catchment_at(std::string id) {
-            return (_catchments.find(id) != _catchments.end()) ? _catchments[id]->realization : nullptr;
+        std::shared_ptr<HY_CatchmentRealization> catchment_at(const std::string& id) {
+            return catchment_at(handle_of(id));
         }
 
-        inline auto catchments() {
-            return network.filter("cat");
+        std::shared_ptr<HY_CatchmentRealization> catchment_at(handle_t handle) {
+            return (handle < _catchments.size() && _catchments[handle]) ? _catchments[handle]->realization : nullptr;
         }
 
-        inline bool is_remote_sender_nexus(std::string id) {
-            return _nexuses.find(id) != _nexuses.end() && _nexuses[id]->is_remote_sender();
+        /**
+         * @brief Get the formulation of the catchment with handle @p handle, see HY_Features::formulation_at
+         */
+        inline realization::Catchment_Formulation* formulation_at(handle_t handle) const {
+            return handle < _formulations.size() ? _formulations[handle] : nullptr;
         }
 
-        inline std::vector<std::shared_ptr<HY_HydroNexus>> destination_nexuses(std::string id) {
-            std::vector<std::shared_ptr<HY_HydroNexus>> downstream;
-            if (_catchments.find(id) != _catchments.end()) {
-                for(const auto& nex_id : _catchments[id]->get_outflow_nexuses()) {
-                    downstream.push_back(_nexuses[nex_id]);
+        /**
+         * @brief Bind the ET parameters of every catchment formulation once, see HY_Features::set_et_params
+         */
+        void set_et_params(const std::shared_ptr<pdm03_struct>& params) {
+            for(auto formulation : _formulations) {
+                if( formulation ) {
+                    formulation->set_et_params(params);
                 }
             }
-            return downstream;
         }
 
-        std::shared_ptr<HY_HydroNexus> nexus_at(std::string id) {
-            return (_nexuses.find(id) != _nexuses.end()) ? _nexuses[id] : nullptr;
+        inline const std::vector<std::string>& catchments() {
+            return network.filter("cat");
+        }
+
+        inline bool is_remote_sender_nexus(const std::string& id) {
+            return is_remote_sender_nexus(handle_of(id));
+        }
+
+        inline bool is_remote_sender_nexus(handle_t handle) {
+            return handle < _nexuses.size() && _nexuses[handle] && _nexuses[handle]->is_remote_sender();
+        }
+
+        inline std::vector<std::shared_ptr<HY_HydroNexus>> destination_nexuses(const std::string& id) {
+            return destination_nexuses(handle_of(id));
+        }
+
+        inline const std::vector<std::shared_ptr<HY_HydroNexus>>& destination_nexuses(handle_t handle) const {
+            static const std::vector<std::shared_ptr<HY_HydroNexus>> none;
+            return handle < _destinations.size() ? _destinations[handle] : none;
+        }
+
+        std::shared_ptr<HY_HydroNexus> nexus_at(const std::string& id) {
+            return nexus_at(handle_of(id));
+        }
+
+        std::shared_ptr<HY_HydroNexus> nexus_at(handle_t handle) {
+            return handle < _nexuses.size() ? _nexuses[handle] : nullptr;
+        }
+
+        /**
+         * @brief Get the dense integer handle of the feature identified by @p id, see HY_Features::handle_of
+         */
+        inline handle_t handle_of(const std::string& id) const {
+            return network.get_handle(id);
         }
 
-        inline auto nexuses() {
+        inline const std::vector<std::string>& nexuses() {
             return network.filter("nex");
         }
 
+        /**
+         * @brief Validates that the feature topology is dendridic, see HY_Features::validate_dendridic
+         */
         void validate_dendridic() {
-            for(const auto& id : catchments()) {
-                auto downstream = network.get_destination_ids(id);
-                if(downstream.size() > 1) {
-                    std::cerr << "Catchment " << id << " has more than one downstream connection." << std::endl;
-                    std::cerr << "Downstreams are: ";
-                    for(const auto& id : downstream){
-                        std::cerr <<id<<" ";
-                    }
-                    std::cerr << std::endl;
-                    assert( false );
-                }
-                else if (downstream.size() == 0) {
-                    std::cerr << "Catchment " << id << " has 0 downstream connections, must have 1." << std::endl;
-                    assert( false );
+            if( !dendritic_errors.empty() ) {
+                std::string message = "Catchment topology is not dendridic:";
+                for(const auto& error : dendritic_errors){
+                    message += "\n  " + error;
                 }
+                throw std::runtime_error(message);
             }
             std::cout<<"Catchment topology is dendridic."<<std::endl;
         }
 
+        /**
+         * @brief Exchange the flows of all remote nexuses with the neighboring ranks for a time step.
+         *
+         * Every rank must call this once per time step, after all local catchments have contributed their flows for
+         * @p t, and before the downstream flow of any nexus is taken for @p t.
+         *
+         * @param t The time step to exchange.
+         * @param post_next Whether to post the receives of the next time step right away, so its flows can arrive
+         *                  while this rank computes; not for the last time step of the run.
+         */
+        void exchange_remote_flows(long t, bool post_next = false) {
+            remote_exchange->exchange(t, post_next);
+        }
+
+        /**
+         * @brief Exchange the boundary flows of a chunk of time steps with the neighboring ranks, as
+         * @ref exchange_remote_flows does those of one (see RemoteNexusExchange::exchange_chunk).
+         *
+         * @param first The first time step of the chunk.
+         * @param count The number of time steps of the chunk, at most the execution ``remote_chunk_steps``.
+         * @param post_next Whether to post the receives of the next chunk right away; not for the last chunk of the run.
+         */
+        void exchange_remote_chunk(long first, long count, bool post_next = false) {
+            remote_exchange->exchange_chunk(first, count, post_next);
+        }
+
+        /**
+         * @brief Complete the outstanding communications of every remote nexus, before the run ends.
+         *
+         * Every rank must call this at the end of the run, before MPI_Finalize, so that no nexus is left to wait on
+         * its communications as it is destroyed.
+         *
+         * @param timeout How long to wait for the communications to complete.
+         * @return Whether they all completed; if not, each stuck nexus has been reported.
+         */
+        bool drain_remote_communications(std::chrono::milliseconds timeout = std::chrono::milliseconds(120000)) {
+            std::vector<HY_PointHydroNexusRemote*> remote_nexuses;
+            for(const auto& nexus : _nexuses){
+              if( nexus ) {
+                remote_nexuses.push_back(nexus.get());
+              }
+            }
+            return HY_PointHydroNexusRemote::drain_communications(remote_nexuses, timeout);
+        }
+
+        /**
+         * @brief Describe the state of this rank's remote communication, for a report of a run that seems stuck: the
+         * remote nexus exchange, and each remote nexus with communications outstanding, with the ranks it exchanges
+         * flows with.
+         */
+        void write_remote_status(std::ostream& out) const {
+            if( remote_exchange ) {
+              remote_exchange->write_status(out);
+            }
+            std::size_t pending_nexuses = 0;
+            for(const auto& nexus : _nexuses){
+              if( !nexus || (nexus->get_pending_receive_count() == 0 && nexus->get_pending_send_count() == 0) ) {
+                continue;
+              }
+              ++pending_nexuses;
+              out << "pending_nexus " << nexus->get_id() << " receives " << nexus->get_pending_receive_count()
+                  << " from";
+              for(int rank : nexus->get_upstream_ranks()) {
+                out << " " << rank;
+              }
+              out << " sends " << nexus->get_pending_send_count() << " to";
+              for(int rank : nexus->get_downstream_ranks()) {
+                out << " " << rank;
+              }
+              out << "\n";
+            }
+            out << "pending_nexuses " << pending_nexuses << "\n";
+        }
+
+        inline network::Network& get_network(){return network;}
+
+        /** @return An estimate of the bytes held by the buffers of the remote nexus exchange (see utils::MemoryReport). */
+        std::size_t get_remote_exchange_memory_bytes() const {
+            return remote_exchange ? remote_exchange->get_memory_bytes() : 0;
+        }
+
       private:
       
-      std::unordered_map<std::string, std::shared_ptr<HY_Catchment>> _catchments;
-      std::unordered_map<std::string, std::shared_ptr<HY_PointHydroNexusRemote>> _nexuses;
+      //Indexed by feature handle, null for features of the other type
+      std::vector<std::shared_ptr<HY_Catchment>> _catchments;
+      //The formulations of the catchments, owned by them
+      std::vector<realization::Catchment_Formulation*> _formulations;
+      std::vector<std::shared_ptr<HY_PointHydroNexusRemote>> _nexuses;
+      //Indexed by catchment handle
+      std::vector<std::vector<std::shared_ptr<HY_HydroNexus>>> _destinations;
       network::Network network;
       std::shared_ptr<Formulation_Manager> formulations;
       int mpi_rank;
       int mpi_num_procs;
+      std::unique_ptr<RemoteNexusExchange> remote_exchange;
+      //The topology errors found while constructing the catchments, in handle order
+      std::vector<std::string> dendritic_errors;
+      //The number of consecutive feature handles each task constructs, see HY_Features
+      static constexpr std::size_t CONSTRUCTION_BLOCK_SIZE = 1024;
+
+      //See HY_Features::dendritic_error
+      static std::string dendritic_error(const std::string& id, const std::vector<std::string>& downstream) {
+          if(downstream.size() > 1) {
+              std::string error = "Catchment " + id + " has more than one downstream connection. Downstreams are:";
+              for(const auto& downstream_id : downstream){
+                  error += " " + downstream_id;
+              }
+              return error;
+          }
+          else if (downstream.size() == 0) {
+              return "Catchment " + id + " has 0 downstream connections, must have 1.";
+          }
+          return std::string();
+      }
 
     };
 } 
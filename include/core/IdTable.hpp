@@ -0,0 +1,108 @@
+#ifndef NGEN_ID_TABLE_HPP
+#define NGEN_ID_TABLE_HPP
+
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace network {
+
+    /**
+     * @brief Interning table of feature identities, mapping each distinct string id to a dense integer handle.
+     *
+     * Handles are assigned in the order ids are first interned, starting at 0, so collections of per feature data
+     * can be kept in vectors indexed by handle.  String ids are then only needed to resolve a handle once, e.g. when
+     * reading inputs or writing outputs, and per time step lookups are array indexing.
+     *
+     * @code {.cpp}
+     * IdTable ids;
+     * IdTable::handle_t cat = ids.intern("cat-27");
+     * std::vector<double> area(ids.size());
+     * area[cat] = 4.5;
+     * assert(ids.find("cat-27") == cat && ids.id(cat) == "cat-27");
+     * @endcode
+     */
+    class IdTable {
+      public:
+        using handle_t = std::size_t;
+
+        /**
+         * @brief The handle returned by @ref find for ids not in the table
+         */
+        static constexpr handle_t npos = std::numeric_limits<handle_t>::max();
+
+        /**
+         * @brief Get the handle of @p id, adding @p id to the table if it is not already in it
+         */
+        handle_t intern(const std::string& id)
+        {
+          auto found = handles.find(id);
+          if( found != handles.end() ) {
+            return found->second;
+          }
+          handle_t handle = ids.size();
+          ids.push_back(id);
+          handles.emplace(id, handle);
+          return handle;
+        }
+
+        /**
+         * @brief Get the handle of @p id, or @ref npos if @p id is not in the table
+         */
+        handle_t find(const std::string& id) const
+        {
+          auto found = handles.find(id);
+          return found != handles.end() ? found->second : npos;
+        }
+
+        /**
+         * @brief Whether @p id is in the table
+         */
+        bool contains(const std::string& id) const
+        {
+          return handles.count(id) > 0;
+        }
+
+        /**
+         * @brief Get the string id of @p handle
+         *
+         * @throw std::out_of_range if @p handle was not assigned by this table
+         */
+        const std::string& id(handle_t handle) const
+        {
+          if( handle >= ids.size() ) {
+            throw std::out_of_range("IdTable::id: No handle "+std::to_string(handle)+" in table.");
+          }
+          return ids[handle];
+        }
+
+        /**
+         * @brief The number of ids in the table, which is also one past the largest handle
+         */
+        std::size_t size() const { return ids.size(); }
+
+        /**
+         * @brief An estimate of the bytes the table holds, for its ids and the index of their handles
+         */
+        std::size_t get_memory_bytes() const
+        {
+            std::size_t bytes = ids.capacity() * sizeof(std::string) + handles.bucket_count() * sizeof(void*)
+                              + handles.size() * (sizeof(std::pair<const std::string, handle_t>) + 2 * sizeof(void*));
+            for (const std::string& id : ids) {
+                // Each id is held by both the list and the index
+                bytes += 2 * (id.capacity() > std::string().capacity() ? id.capacity() + 1 : 0);
+            }
+            return bytes;
+        }
+
+      private:
+        std::vector<std::string> ids;
+        std::unordered_map<std::string, handle_t> handles;
+    };
+
+}
+
+#endif //NGEN_ID_TABLE_HPP
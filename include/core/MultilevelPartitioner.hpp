@@ -0,0 +1,224 @@
+#ifndef NGEN_MULTILEVEL_PARTITIONER_HPP
+#define NGEN_MULTILEVEL_PARTITIONER_HPP
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "network.hpp"
+
+namespace network {
+
+    /**
+     * @brief Weighted, graph aware k-way partitioning of the catchments of a network::Network.
+     *
+     * Catchments are the vertices of an undirected graph, weighted by their (relative) computational cost.  Two
+     * catchments are connected whenever they share a nexus, with one unit of edge weight per shared nexus, so the
+     * edge cut of a partitioning is a close proxy for the number of nexuses that end up as remote nexuses.
+     *
+     * The graph is partitioned with a multilevel scheme:
+     *
+     *  - the graph is repeatedly coarsened by collapsing heavy edge matchings;
+     *  - the coarsest graph is partitioned by recursive bisection, growing each half breadth first;
+     *  - the partitioning is projected back through each level, rebalanced, and refined by greedily moving boundary
+     *    catchments to the neighboring partition that most reduces the edge cut without exceeding the balance limit.
+     *
+     * If ngen is built with METIS support (``NGEN_METIS_ACTIVE``), METIS may be used for the partitioning instead.
+     *
+     * @code {.cpp}
+     * network::MultilevelPartitioner partitioner(network, network::read_catchment_weights("weights.csv"));
+     * std::vector<int> parts = partitioner.partition(num_partitions);
+     * // parts[i] is the partition of partitioner.catchment_ids()[i]
+     * @endcode
+     */
+    class MultilevelPartitioner {
+      public:
+
+        /**
+         * @brief An undirected graph in compressed sparse row form.
+         *
+         * The neighbors of vertex @c v are @c adjncy[xadj[v]] through @c adjncy[xadj[v+1]-1], connected by edges of
+         * weight @c adjwgt[i].  Every edge appears once in the adjacency of each of its two vertices.
+         */
+        struct Graph {
+            std::vector<std::size_t> xadj;
+            std::vector<std::size_t> adjncy;
+            std::vector<double> adjwgt;
+            std::vector<double> vwgt;
+
+            std::size_t size() const { return vwgt.size(); }
+        };
+
+        /**
+         * @brief Build the catchment graph of @p network.
+         *
+         * @param network The network whose catchments are partitioned.
+         * @param weights The cost weight of catchments, by id.  Catchments without a weight use @p default_weight.
+         * @param default_weight The cost weight of any catchment missing from @p weights.
+         * @throws std::invalid_argument If any weight is not positive.
+         */
+        MultilevelPartitioner(Network& network, const std::unordered_map<std::string, double>& weights = {},
+                              double default_weight = 1.0);
+
+        /**
+         * @brief Partition the catchments.
+         *
+         * @param num_partitions The number of partitions.
+         * @param imbalance The allowed fraction by which a partition's total weight may exceed the average.
+         * @param use_metis Whether to partition with METIS rather than the built in partitioner.
+         * @return The partition of each catchment, in the order of @ref catchment_ids.
+         * @throws std::invalid_argument If @p num_partitions is not between 1 and the number of catchments, or METIS
+         *         is requested but not available.
+         */
+        std::vector<int> partition(int num_partitions, double imbalance = 0.03, bool use_metis = false) const;
+
+        /**
+         * @brief Partition the catchments in two levels, into nodes and then into the partitions of each node.
+         *
+         * The catchments are first partitioned into @p num_nodes node subdomains, minimizing the nexuses between
+         * nodes, and each node's catchments are then partitioned into @p parts_per_node partitions, so the nexuses
+         * between a node's partitions can be exchanged within the node.  The partitions of node @c k are numbered
+         * <tt>k*parts_per_node</tt> onwards, which are the ranks MPI launchers place on it by default.  Each level is
+         * balanced to within @p imbalance, so partitions may exceed the average by about twice that.
+         *
+         * @param num_nodes The number of nodes.
+         * @param parts_per_node The number of partitions of each node.
+         * @param imbalance The allowed fraction by which a node's, or a partition's, total weight may exceed the
+         *                  average.
+         * @param use_metis Whether to partition with METIS rather than the built in partitioner.
+         * @return The partition of each catchment, in the order of @ref catchment_ids.
+         * @throws std::invalid_argument If either count is less than 1, or more than the catchments to partition, or
+         *         METIS is requested but not available.
+         */
+        std::vector<int> partition_hierarchical(int num_nodes, int parts_per_node, double imbalance = 0.03,
+                                                bool use_metis = false) const;
+
+        /**
+         * @return The ids of the partitioned catchments, which are the vertices of @ref get_graph, in order.
+         */
+        const std::vector<std::string>& catchment_ids() const { return catchment_id_list; }
+
+        /**
+         * @return The catchment graph.
+         */
+        const Graph& get_graph() const { return graph; }
+
+        /**
+         * @brief Count the nexuses that connect catchments in more than one partition.
+         *
+         * These are the nexuses that need remote communication under the given partitioning.
+         *
+         * @param parts The partition of each catchment, in the order of @ref catchment_ids.
+         */
+        std::size_t count_boundary_nexuses(const std::vector<int>& parts) const;
+
+        /**
+         * @brief Also connect the catchments that are next to each other in a storage order, e.g. of a forcing file.
+         *
+         * Each pair of partitioned catchments that are consecutive in @p order, once catchments that are not
+         * partitioned are skipped, gets an edge of @p weight (added to any edge they already share).  Cutting these
+         * edges then counts against a partitioning, so each partition's catchments tend to form a few contiguous runs
+         * of the order, which a process can read as a few ranges of the file.
+         *
+         * @param order Catchment ids in storage order.
+         * @param weight The weight of each added edge, relative to the unit weight of a shared nexus.
+         * @throws std::invalid_argument If @p weight is not positive.
+         */
+        void add_order_edges(const std::vector<std::string>& order, double weight = 0.5);
+
+        /**
+         * @brief Count the contiguous runs of each partition's catchments in a storage order, over all partitions.
+         *
+         * Catchments that are not partitioned are skipped, so this is the number of ranges of the storage all the
+         * processes read together; the least possible is the number of partitions.
+         *
+         * @param parts The partition of each catchment, in the order of @ref catchment_ids.
+         * @param order Catchment ids in storage order.
+         */
+        std::size_t count_order_runs(const std::vector<int>& parts, const std::vector<std::string>& order) const;
+
+        /**
+         * @brief Partition an arbitrary graph with the built in multilevel partitioner.
+         *
+         * @param graph The graph to partition.
+         * @param num_partitions The number of partitions.
+         * @param imbalance The allowed fraction by which a partition's total weight may exceed the average.
+         * @return The partition of each vertex.
+         * @throws std::invalid_argument If @p num_partitions is not between 1 and the number of vertices.
+         */
+        static std::vector<int> partition_graph(const Graph& graph, int num_partitions, double imbalance = 0.03);
+
+        /**
+         * @brief The total vertex weight of each partition.
+         */
+        static std::vector<double> partition_weights(const Graph& graph, const std::vector<int>& parts,
+                                                     int num_partitions);
+
+        /**
+         * @brief The total weight of the edges connecting vertices in different partitions.
+         */
+        static double edge_cut(const Graph& graph, const std::vector<int>& parts);
+
+        /**
+         * @brief Number partitions so those that exchange the most remote nexus flows share a node.
+         *
+         * MPI launchers place ranks on nodes in blocks by default, so ranks @c 0 through <tt>ranks_per_node-1</tt>
+         * share the first node, and so on.  Partitions are grouped into nodes of that many greedily, each node seeded
+         * with the unplaced partition of the most traffic and filled with those most connected to it, and the groups
+         * refined by swapping partitions between nodes while that lowers the traffic between nodes.  Within a node,
+         * partitions keep their relative order.
+         *
+         * @param num_partitions The number of partitions.
+         * @param links A pair of partitions for each remote connection between them; a pair may be repeated, adding
+         *              to its traffic.
+         * @param ranks_per_node The number of ranks on each node.
+         * @return The new number, or rank, of each partition.
+         * @throws std::invalid_argument If @p ranks_per_node is 0, or a link is not between two of the partitions.
+         */
+        static std::vector<int> place_on_nodes(std::size_t num_partitions,
+                                               std::vector<std::pair<std::size_t, std::size_t>> links,
+                                               std::size_t ranks_per_node);
+
+      private:
+
+        /** Partition a graph with METIS or the built in partitioner. */
+        static std::vector<int> partition_graph_with(const Graph& graph, int num_partitions, double imbalance,
+                                                     bool use_metis);
+
+#ifdef NGEN_METIS_ACTIVE
+        static std::vector<int> partition_graph_metis(const Graph& graph, int num_partitions, double imbalance);
+#endif
+
+        Graph graph;
+        std::vector<std::string> catchment_id_list;
+        /** For each nexus, the indices of all catchments it connects. */
+        std::vector<std::vector<std::size_t>> nexus_catchments;
+    };
+
+    /**
+     * @brief Read per catchment cost weights from a text file.
+     *
+     * Each non-empty line holds a catchment id and its weight, separated by a comma or whitespace, e.g.
+     * ``cat-27,4.5``.  Lines starting with ``#`` and lines whose weight is not a number (e.g. a header) are skipped.
+     *
+     * @param path The path of the weights file.
+     * @return The weight of each listed catchment, by id.
+     * @throws std::runtime_error If the file cannot be read.
+     */
+    std::unordered_map<std::string, double> read_catchment_weights(const std::string& path);
+
+    /**
+     * @brief Read a storage order of catchments from a text file.
+     *
+     * Each non-empty line holds a catchment id, in order, optionally followed by other fields after a comma or
+     * whitespace.  Lines starting with ``#`` are skipped.
+     *
+     * @param path The path of the order file.
+     * @return The catchment ids, in order.
+     * @throws std::runtime_error If the file cannot be read.
+     */
+    std::vector<std::string> read_catchment_order(const std::string& path);
+}
+
+#endif // NGEN_MULTILEVEL_PARTITIONER_HPP
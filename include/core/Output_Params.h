@@ -0,0 +1,206 @@
+#ifndef NGEN_OUTPUT_PARAMS_H
+#define NGEN_OUTPUT_PARAMS_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief output_params providing configuration information for how simulation outputs are written.
+ *
+ * These correspond to the optional ``output`` block of a realization config, e.g.:
+ *
+ * @code {.json}
+ * "output": {
+ *     "nexus_format": "netcdf",
+ *     "nexus_path": "./output/",
+ *     "nexus_buffer_steps": 48,
+ *     "csv_compression": "zstd",
+ *     "csv_compression_level": 3,
+ *     "csv_buffer_mb": 64,
+ *     "catchment_queue_size": 65536,
+ *     "catchment_format": "binary",
+ *     "catchment_path": "./output/",
+ *     "catchment_aggregation_steps": 24,
+ *     "catchment_variables": { "Q_OUT": "mean", "RAIN_RATE": "sum" },
+ *     "catchment_selection": ["cat-27", "cat-1*"],
+ *     "nexus_selection": "./gauged_nexuses.txt",
+ *     "terminal_nexuses_only": false,
+ *     "stream_subscribers": 0,
+ *     "profile_path": "./output/",
+ *     "progress_interval": 100,
+ *     "metrics_path": "./output/ngen.prom",
+ *     "status_path": "./output/"
+ * }
+ * @endcode
+ */
+struct output_params
+{
+    /**
+     * The format of nexus outputs: ``csv`` (the default, one ``<id>_output.csv`` file per nexus), ``binary`` (one
+     * flat binary file of all nexuses), ``stream`` (the layout of ``binary``, published on a Unix domain socket to
+     * the processes connected to it while the run goes on), ``mapped`` (one memory mapped file of all nexuses, with a
+     * row of every time step of the run for each), ``netcdf`` (one NetCDF file of all nexuses, if NetCDF
+     * support is built), ``parquet`` (one Parquet file of all nexuses, if Arrow and Parquet support are built), or
+     * ``netcdf_parallel`` (one NetCDF file of the nexuses of every MPI rank, written collectively, if parallel NetCDF
+     * and MPI support are built).
+     */
+    std::string nexus_format;
+
+    /**
+     * Directory prefix nexus output files (or the ``stream`` socket) are created under; defaults to ``./``.
+     */
+    std::string nexus_path;
+
+    /**
+     * Number of complete time steps of nexus flows held in memory by the ``binary``, ``stream``, ``netcdf``,
+     * ``parquet`` and ``netcdf_parallel`` formats before they are written in bulk.
+     */
+    int nexus_buffer_steps;
+
+    /**
+     * How the ``csv`` nexus and catchment output files are compressed: ``none`` (the default), ``gzip`` (if zlib
+     * support is built) or ``zstd`` (if zstd support is built), adding ``.gz`` or ``.zst`` to their names.
+     */
+    std::string csv_compression;
+
+    /**
+     * The level of ``csv_compression``, or ``-1`` (the default) for the library's default level.
+     */
+    int csv_compression_level;
+
+    /**
+     * Megabytes the uncompressed ``csv`` nexus output files of a process share for buffering their rows, and the
+     * catchment output files the same again; each file gets its share, of at least 8 KB and at most 4 MB.
+     */
+    int csv_buffer_mb;
+
+    /**
+     * Capacity, in rows, of the queue handing catchment output to the background output thread.  ``0`` writes
+     * catchment output synchronously from the threads running the formulations.
+     */
+    int catchment_queue_size;
+
+    /**
+     * The format of catchment outputs: ``csv`` (the default, one ``<id>.csv`` file per catchment), ``binary`` (one
+     * flat binary file of the output of all the catchments of a process, documented in
+     * ``CatchmentOutputWriter.hpp``), ``stream`` (the layout of ``binary``, published on a Unix domain socket), or
+     * ``parquet`` (one Parquet file of the output of all the catchments of a process, with a row per value, if Arrow
+     * and Parquet support are built).
+     */
+    std::string catchment_format;
+
+    /**
+     * Directory prefix the ``binary`` or ``parquet`` catchment output file (or the ``stream`` socket) is created
+     * under; defaults to ``./``.
+     */
+    std::string catchment_path;
+
+    /**
+     * Megabytes of catchment output rows the ``binary``, ``stream`` and ``parquet`` formats hold in memory before
+     * writing them in bulk.
+     */
+    int catchment_buffer_mb;
+
+    /**
+     * Number of subscribers the ``stream`` formats wait to connect to each of their sockets before the run starts, so
+     * that they are sent all of its output; defaults to ``0``.
+     */
+    int stream_subscribers;
+
+    /**
+     * Number of output time steps each written catchment output row aggregates; defaults to ``1``.
+     */
+    int catchment_aggregation_steps;
+
+    /**
+     * The catchment output variables to write, in order, each with how it is aggregated over
+     * ``catchment_aggregation_steps``: ``instantaneous``, ``sum``, ``mean``, ``min`` or ``max``.  Empty (the default)
+     * writes every variable, with the mean of each.
+     */
+    std::vector<std::pair<std::string, std::string>> catchment_variables;
+
+    /**
+     * The ids of the catchments whose output is written, and shell wildcard patterns of them (e.g. ``cat-1*``); empty
+     * (the default) writes the output of every catchment.  Other catchments create no output file and have none of
+     * their output formatted.
+     */
+    std::vector<std::string> catchment_selection;
+
+    /**
+     * The ids, and patterns of the ids, of the nexuses whose flows are written, as for ``catchment_selection``.
+     */
+    std::vector<std::string> nexus_selection;
+
+    /**
+     * Whether only the flows of terminal nexuses, those without a downstream catchment, are written, of those
+     * ``nexus_selection`` selects.
+     */
+    bool terminal_nexuses_only;
+
+    /**
+     * Path prefix of the timing profile written at the end of the run: a ``profile_summary.txt`` table of the time
+     * spent in the main loop's hot paths, and a ``profile_trace.json`` timeline in the Chrome trace event format, each
+     * rank's suffixed with its rank under MPI.  Empty (the default) disables profiling.
+     */
+    std::string profile_path;
+
+    /**
+     * Whether to also record the ``profile_trace.json`` timeline, which keeps an event for every timed interval.
+     */
+    bool profile_trace;
+
+    /**
+     * Whether the profile also counts the hardware events of each timed region, where Linux ``perf_event`` allows:
+     * cycles, instructions, cache references and misses, and mispredicted branches.
+     */
+    bool profile_counters;
+
+    /**
+     * Number of time steps between the progress reports printed while the run goes on: the rate and estimated time
+     * to completion, the share of time in computing, communication and output, and, under MPI, the ranks that
+     * computed longest.  ``0`` disables them; defaults to ``100``.
+     */
+    int progress_interval;
+
+    /**
+     * Path of a file rewritten with each progress report, of the run's progress and each rank's time in each phase
+     * as metrics in the Prometheus text format.  Empty (the default) writes none.
+     */
+    std::string metrics_path;
+
+    /**
+     * Path prefix of the ``ngen_status.txt`` report of where the run is, written, each rank's suffixed with its rank
+     * under MPI, on the next time step after the process is sent ``SIGUSR1``; defaults to ``./``.
+     */
+    std::string status_path;
+
+    /**
+     * Default constructor, using per nexus CSV files in the working directory.
+     */
+    output_params() : nexus_format("csv"), nexus_path("./"), nexus_buffer_steps(32), csv_compression("none"),
+                      csv_compression_level(-1), csv_buffer_mb(64), catchment_queue_size(65536), catchment_format("csv"),
+                      catchment_path("./"), catchment_buffer_mb(8), stream_subscribers(0),
+                      catchment_aggregation_steps(1), terminal_nexuses_only(false), profile_path(""),
+                      profile_trace(false), profile_counters(false), progress_interval(100), metrics_path(""),
+                      status_path("./") {}
+
+    /*
+     * @brief Constructor for output_params
+     *
+     * @param nexus_format
+     * @param nexus_path
+     * @param nexus_buffer_steps
+     * @param catchment_queue_size
+     */
+    output_params(std::string nexus_format, std::string nexus_path, int nexus_buffer_steps,
+                  int catchment_queue_size = 65536)
+        : nexus_format(nexus_format), nexus_path(nexus_path), nexus_buffer_steps(nexus_buffer_steps),
+          csv_compression("none"), csv_compression_level(-1), csv_buffer_mb(64),
+          catchment_queue_size(catchment_queue_size),
+          catchment_format("csv"), catchment_path("./"), catchment_buffer_mb(8), stream_subscribers(0),
+          catchment_aggregation_steps(1), terminal_nexuses_only(false), profile_path(""), profile_trace(false),
+          profile_counters(false), progress_interval(100), metrics_path(""), status_path("./") {}
+};
+
+#endif // NGEN_OUTPUT_PARAMS_H
@@ -0,0 +1,98 @@
+#ifdef NGEN_PARQUET_ACTIVE
+#ifndef NGEN_PARQUET_OUTPUT_FILE_HPP
+#define NGEN_PARQUET_OUTPUT_FILE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace output
+{
+    /**
+     * @brief A Parquet file of output values in long form, with one row per value, written a row group at a time.
+     *
+     * The file has the columns:
+     *
+     *  - ``id``, the id of the feature, dictionary encoded;
+     *  - ``time_index``, the output time step index, as ``int64``;
+     *  - ``time``, the time of the step, as a UTC ``timestamp`` in seconds;
+     *  - ``variable``, the name of the output variable, dictionary encoded;
+     *  - ``value``, as ``double``.
+     *
+     * The dictionaries are the ids and variables the file is constructed with, and rows refer to them by index, so
+     * neither ids nor values are ever formatted as text.  The Arrow schema is stored in the file, so Arrow readers
+     * (e.g. ``pandas.read_parquet``) read ``id`` and ``variable`` back as categoricals.
+     *
+     * Arrow is only used by the implementation, since it needs C++17, and is available in builds with
+     * ``NGEN_PARQUET_ACTIVE``.  Not safe for concurrent use.
+     */
+    class ParquetOutputFile
+    {
+      public:
+
+        /**
+         * @param path The path of the file.
+         * @param ids The feature ids rows may refer to.
+         * @param variables The variable names rows may refer to.
+         * @throws std::runtime_error If the file cannot be created.
+         */
+        ParquetOutputFile(const std::string& path, const std::vector<std::string>& ids,
+                          const std::vector<std::string>& variables);
+
+        /** Writes any rows not yet written, and closes the file. */
+        ~ParquetOutputFile();
+
+        ParquetOutputFile(const ParquetOutputFile&) = delete;
+        ParquetOutputFile& operator=(const ParquetOutputFile&) = delete;
+
+        /**
+         * @brief Add a row, to be written with the next row group.
+         *
+         * @param id The index of the feature id.
+         * @param time_index The output time step index.
+         * @param time The time of @p time_index, in seconds since the epoch.
+         * @param variable The index of the variable name.
+         * @param value The value.
+         */
+        void add(uint32_t id, int64_t time_index, int64_t time, uint32_t variable, double value)
+        {
+            id_column.push_back(id);
+            time_index_column.push_back(time_index);
+            time_column.push_back(time);
+            variable_column.push_back(variable);
+            value_column.push_back(value);
+        }
+
+        /** @return The number of rows added since the last row group was written. */
+        std::size_t pending_rows() const { return value_column.size(); }
+
+        /**
+         * @brief Write the rows added since the last row group as a new row group, if there are any.
+         *
+         * @throws std::runtime_error If the rows cannot be written.
+         */
+        void write_row_group();
+
+        /**
+         * @brief Write any rows not yet written, and finish the file; nothing more can be added.
+         *
+         * @throws std::runtime_error If the file cannot be finished.
+         */
+        void close();
+
+      private:
+
+        class Impl;
+
+        std::unique_ptr<Impl> impl;
+        std::vector<int32_t> id_column;
+        std::vector<int64_t> time_index_column;
+        std::vector<int64_t> time_column;
+        std::vector<int32_t> variable_column;
+        std::vector<double> value_column;
+    };
+}
+
+#endif //NGEN_PARQUET_OUTPUT_FILE_HPP
+#endif //NGEN_PARQUET_ACTIVE
@@ -0,0 +1,232 @@
+#ifndef NGEN_PARTITION_BINARY_HPP
+#define NGEN_PARTITION_BINARY_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * Reading and writing partition configs in an indexed binary format, from which each rank reads just its own partition.
+ *
+ * The file starts with the 8 bytes ``NGENPART``, a ``uint32`` format version and a ``uint32`` number of partitions,
+ * followed by a table of one more ``uint64`` file offsets than there are partitions: the start of each partition's
+ * record, then the end of the last one.  A record is the ``int32`` partition id, the catchment ids, the nexus ids and
+ * the remote connections, each list a ``uint32`` count of its elements.  A remote connection is an ``int32`` MPI rank
+ * followed by its nexus id, catchment id and direction.  Strings are a ``uint32`` length followed by their bytes.
+ * Numbers are in the byte order of the machine that wrote the file.
+ */
+namespace partition_binary
+{
+    /** A remote connection of a partition: (MPI rank, nexus id, catchment id, catchment direction). */
+    using RemoteConnection = std::tuple<int, std::string, std::string, std::string>;
+
+    static const char MAGIC[8] = {'N', 'G', 'E', 'N', 'P', 'A', 'R', 'T'};
+    static const std::uint32_t VERSION = 1;
+    static const std::size_t HEADER_SIZE = sizeof(MAGIC) + 2 * sizeof(std::uint32_t);
+
+    template<typename T>
+    inline void put(std::string& buffer, T value)
+    {
+        buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    inline void put_string(std::string& buffer, const std::string& value)
+    {
+        put<std::uint32_t>(buffer, value.size());
+        buffer.append(value);
+    }
+
+    /**
+     * Reads the values of a partition record, checking each stays within it.
+     */
+    class RecordReader
+    {
+        public:
+        RecordReader(const std::string& record) : record(record), position(0) {}
+
+        template<typename T>
+        T get()
+        {
+            T value;
+            require(sizeof(T));
+            std::memcpy(&value, record.data() + position, sizeof(T));
+            position += sizeof(T);
+            return value;
+        }
+
+        std::string get_string()
+        {
+            std::uint32_t length = get<std::uint32_t>();
+            require(length);
+            std::string value = record.substr(position, length);
+            position += length;
+            return value;
+        }
+
+        private:
+        void require(std::size_t size)
+        {
+            if (record.size() - position < size) {
+                throw std::runtime_error("Binary partition config record ends unexpectedly");
+            }
+        }
+
+        const std::string& record;
+        std::size_t position;
+    };
+
+    /**
+     * @brief Whether a file is a binary partition config, by whether it starts with the format's magic bytes.
+     *
+     * @param file_path The path of the partition config.
+     */
+    inline bool is_binary_partition_file(const std::string& file_path)
+    {
+        std::ifstream file(file_path, std::ios::binary);
+        char magic[sizeof(MAGIC)];
+        return file.read(magic, sizeof(MAGIC)) && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+    }
+
+    /**
+     * @brief Write partitions as a binary partition config.
+     *
+     * @param catchment_part The catchment ids of each partition.
+     * @param nexus_part The nexus ids of each partition.
+     * @param remote_connections The remote connections of each partition.
+     * @param file_path The path to write the config to.
+     */
+    inline void write_partitions(const std::vector<std::unordered_set<std::string>>& catchment_part,
+                                 const std::vector<std::unordered_set<std::string>>& nexus_part,
+                                 const std::vector<std::vector<RemoteConnection>>& remote_connections,
+                                 const std::string& file_path)
+    {
+        std::uint32_t count = catchment_part.size();
+        std::vector<std::string> records(count);
+        for (std::uint32_t i = 0; i < count; ++i) {
+            std::string& record = records[i];
+            put<std::int32_t>(record, i);
+            put<std::uint32_t>(record, catchment_part[i].size());
+            for (const std::string& id : catchment_part[i]) {
+                put_string(record, id);
+            }
+            put<std::uint32_t>(record, nexus_part[i].size());
+            for (const std::string& id : nexus_part[i]) {
+                put_string(record, id);
+            }
+            put<std::uint32_t>(record, remote_connections[i].size());
+            for (const RemoteConnection& remote : remote_connections[i]) {
+                put<std::int32_t>(record, std::get<0>(remote));
+                put_string(record, std::get<1>(remote));
+                put_string(record, std::get<2>(remote));
+                put_string(record, std::get<3>(remote));
+            }
+        }
+
+        std::string header(MAGIC, sizeof(MAGIC));
+        put<std::uint32_t>(header, VERSION);
+        put<std::uint32_t>(header, count);
+        std::uint64_t offset = HEADER_SIZE + (count + 1) * sizeof(std::uint64_t);
+        for (const std::string& record : records) {
+            put<std::uint64_t>(header, offset);
+            offset += record.size();
+        }
+        put<std::uint64_t>(header, offset);
+
+        std::ofstream file(file_path, std::ios::binary | std::ios::trunc);
+        file.write(header.data(), header.size());
+        for (const std::string& record : records) {
+            file.write(record.data(), record.size());
+        }
+        if (!file) {
+            throw std::runtime_error("Unable to write binary partition config " + file_path);
+        }
+    }
+
+    /**
+     * @brief Open a binary partition config and read the number of partitions in it.
+     *
+     * @param file_path The path of the partition config.
+     * @param file Opened on the config.
+     * @return The number of partitions.
+     */
+    inline std::uint32_t open_partitions(const std::string& file_path, std::ifstream& file)
+    {
+        file.open(file_path, std::ios::binary);
+        char magic[sizeof(MAGIC)];
+        std::uint32_t version, count;
+        if (!file.read(magic, sizeof(MAGIC)) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0
+            || !file.read(reinterpret_cast<char*>(&version), sizeof(version))
+            || !file.read(reinterpret_cast<char*>(&count), sizeof(count))) {
+            throw std::runtime_error("Unable to read binary partition config " + file_path);
+        }
+        if (version != VERSION) {
+            throw std::runtime_error("Binary partition config " + file_path + " has unsupported format version "
+                                     + std::to_string(version));
+        }
+        return count;
+    }
+
+    /**
+     * @brief Read one partition of a binary partition config, without reading any of the others.
+     *
+     * @param file The config, as opened by @ref open_partitions.
+     * @param count The number of partitions in the config.
+     * @param index The position of the partition in the config.
+     * @param id Receives the partition id.
+     * @param catchment_ids Receives the catchment ids of the partition.
+     * @param nexus_ids Receives the nexus ids of the partition.
+     * @param remote_connections Receives the remote connections of the partition.
+     */
+    inline void read_partition(std::ifstream& file, std::uint32_t count, std::uint32_t index, int& id,
+                               std::unordered_set<std::string>& catchment_ids,
+                               std::unordered_set<std::string>& nexus_ids,
+                               std::vector<RemoteConnection>& remote_connections)
+    {
+        if (index >= count) {
+            throw std::out_of_range("Binary partition config has no partition " + std::to_string(index)
+                                    + " of its " + std::to_string(count));
+        }
+        std::uint64_t range[2];
+        file.seekg(HEADER_SIZE + index * sizeof(std::uint64_t));
+        if (!file.read(reinterpret_cast<char*>(range), sizeof(range)) || range[1] < range[0]) {
+            throw std::runtime_error("Unable to read the offset table of binary partition config");
+        }
+        std::string record(range[1] - range[0], '\0');
+        file.seekg(range[0]);
+        if (!file.read(&record[0], record.size())) {
+            throw std::runtime_error("Unable to read partition " + std::to_string(index) + " of binary partition config");
+        }
+
+        RecordReader reader(record);
+        id = reader.get<std::int32_t>();
+        std::uint32_t size = reader.get<std::uint32_t>();
+        catchment_ids.clear();
+        catchment_ids.reserve(size);
+        for (std::uint32_t i = 0; i < size; ++i) {
+            catchment_ids.emplace(reader.get_string());
+        }
+        size = reader.get<std::uint32_t>();
+        nexus_ids.clear();
+        nexus_ids.reserve(size);
+        for (std::uint32_t i = 0; i < size; ++i) {
+            nexus_ids.emplace(reader.get_string());
+        }
+        size = reader.get<std::uint32_t>();
+        remote_connections.clear();
+        remote_connections.reserve(size);
+        for (std::uint32_t i = 0; i < size; ++i) {
+            int rank = reader.get<std::int32_t>();
+            std::string nexus_id = reader.get_string();
+            std::string catchment_id = reader.get_string();
+            std::string direction = reader.get_string();
+            remote_connections.emplace_back(rank, std::move(nexus_id), std::move(catchment_id), std::move(direction));
+        }
+    }
+}
+
+#endif // NGEN_PARTITION_BINARY_HPP
@@ -5,7 +5,10 @@
 
 //#include <mpi.h>
 
+#include <fstream>
+#include <iterator>
 #include <memory>
+#include <stdexcept>
 #include <sstream>
 #include <tuple>
 #include <functional>
@@ -20,6 +23,8 @@
 #include "features/Features.hpp"
 #include <FeatureCollection.hpp>
 #include "JSONProperty.hpp"
+#include "Partition_Binary.hpp"
+#include "Logger.hpp"
 
 using Tuple = std::tuple<int, std::string, std::string, std::string>;
 
@@ -37,77 +42,70 @@ class Partitions_Parser {
 
     public:
         //Constructor that takes an input json file path and points to the root of the tree in json file
-        Partitions_Parser(const std::string &file_path) {
+        //A binary partition file (see Partition_Binary.hpp) is only opened, so single partitions can be read from it
+        Partitions_Parser(const std::string &file_path) : is_binary(partition_binary::is_binary_partition_file(file_path)) {
+            if (is_binary) {
+                num_partitions = partition_binary::open_partitions(file_path, binary_file);
+                NGEN_LOG_DEBUG("Opened binary partition file " << file_path);
+                return;
+            }
             boost::property_tree::ptree loaded_tree;
             boost::property_tree::json_parser::read_json(file_path, loaded_tree);
-            std::cout << "file read success" << std::endl;
             this->tree = loaded_tree;
-            std::cout << "file_path: " << file_path << std::endl;
+            num_partitions = tree.get_child("partitions").size();
+            NGEN_LOG_DEBUG("Read partition file " << file_path);
         };
 
+        Partitions_Parser(Partitions_Parser &&) = default;
+
         virtual ~Partitions_Parser(){};
 
         //The function that parses the json file and build a unordered set and vector of structs for each line in the json list
         void parse_partition_file() {
-            std::cout << "\nroot_tree: " << tree.size() << std::endl;
-
-            //Declare two partition_data type structs
-            PartitionData part_data;
+            if (is_binary) {
+                for (int i = 0; i < num_partitions; ++i) {
+                    partition_ranks.push_back(parse_partition(i));
+                }
+                return;
+            }
+            NGEN_LOG_DEBUG("Partition file root has " << tree.size() << " members");
 
             //The outter loop iterating through the list of partitions
-            int remote_mpi_rank;
-            std::string remote_nex_id;
-            std::string remote_cat_id;
-            std::string direction;
-            Tuple tmp_tuple;
-            std::vector<Tuple> remote_conn_vec;
-            int part_counter = 0;
             for(auto &partition: tree.get_child("partitions"))  {
-                //Get partition id
-                std::string part_id = (partition.second).get<std::string>("id");
-
-                //Get mpi_world_rank and set the corresponding part_data struct member
-                int mpi_rank = std::stoi(part_id);
-                part_data.mpi_world_rank = mpi_rank;
-
-                geojson::JSONProperty part = geojson::JSONProperty(part_id, partition.second);
-
-                //Get cat_ids list and insert the elements into the unordered_set catchment_ids in part_data struct
-                for (auto &cat_id : part.at("cat-ids").as_list())
-                {
-                    //cat_ids.push_back(remote.as_string());
-                    catchment_ids.emplace(cat_id.as_string());
-                }
-                part_data.catchment_ids = catchment_ids;
-                catchment_ids.clear();
-
-                //Get nex_ids list and insert the elements into the unordered_set nexus_ids in part_data struct
-                for (auto &nex_id: part.at("nex-ids").as_list())
-                {
-                    //nex_ids.push_back(nex_id.as_string());
-                    nexus_ids.emplace(nex_id.as_string());
-                }
-                part_data.nexus_ids = nexus_ids;
-                nexus_ids.clear();
-
-                //Get remote-connections and set the corresponding part_data struct member
-                for (auto &remote_conn : part.at("remote-connections").as_list())
-                {
-                    remote_mpi_rank = remote_conn.at("mpi-rank").as_natural_number();
-                    remote_nex_id = remote_conn.at("nex-id").as_string();
-                    remote_cat_id = remote_conn.at("cat-id").as_string();
-                    direction = remote_conn.at("cat-direction").as_string();
-                    tmp_tuple = std::make_tuple(remote_mpi_rank, remote_nex_id, remote_cat_id, direction);
-                    remote_conn_vec.push_back(tmp_tuple);
-                }
-                part_data.remote_connections = remote_conn_vec;
-                remote_conn_vec.clear();
-
                 //Push part_data struct the vector
-                partition_ranks.push_back(part_data);
+                partition_ranks.push_back(parse_partition_tree(partition.second));
+            }
+        };
 
-                part_counter++;       
+        /**
+         * Parse just one partition, e.g. that of the current rank, without keeping it in @ref partition_ranks.
+         *
+         * From a binary partition file only this partition is read, so the time taken is proportional to its size
+         * rather than to that of the whole file.
+         *
+         * @param part_id The position of the partition in the file, which is also its MPI rank.
+         * @return The partition.
+         */
+        PartitionData parse_partition(int part_id) {
+            if (part_id < 0 || part_id >= num_partitions) {
+                throw std::out_of_range("Partition config has no partition " + std::to_string(part_id) + " of its "
+                                        + std::to_string(num_partitions));
+            }
+            PartitionData part_data;
+            if (is_binary) {
+                partition_binary::read_partition(binary_file, num_partitions, part_id, part_data.mpi_world_rank,
+                                                 part_data.catchment_ids, part_data.nexus_ids,
+                                                 part_data.remote_connections);
+                return part_data;
             }
+            auto partition = tree.get_child("partitions").begin();
+            std::advance(partition, part_id);
+            return parse_partition_tree(partition->second);
+        };
+
+        //The number of partitions in the file
+        int get_num_partitions() const {
+            return num_partitions;
         };
 
         //The function retrieve an arbitrary struct based on the part_id passed to it
@@ -159,7 +157,7 @@ class Partitions_Parser {
             part_data = partition_ranks[part_id];
             int mpi_world_rank = part_data.mpi_world_rank;
 
-            std::cout << "mpi_world_rank: " << mpi_world_rank << std::endl;
+            NGEN_LOG_DEBUG("mpi_world_rank: " << mpi_world_rank);
             return mpi_world_rank;
         };
 
@@ -167,6 +165,46 @@ class Partitions_Parser {
         std::vector<PartitionData> partition_ranks;
 
     private:
+        //Parse the property tree of one partition of a json file
+        PartitionData parse_partition_tree(const boost::property_tree::ptree &partition) {
+            PartitionData part_data;
+
+            //Get partition id
+            std::string part_id = partition.get<std::string>("id");
+
+            //Get mpi_world_rank and set the corresponding part_data struct member
+            part_data.mpi_world_rank = std::stoi(part_id);
+
+            geojson::JSONProperty part = geojson::JSONProperty(part_id, partition);
+
+            //Get cat_ids list and insert the elements into the unordered_set catchment_ids in part_data struct
+            for (auto &cat_id : part.at("cat-ids").as_list())
+            {
+                part_data.catchment_ids.emplace(cat_id.as_string());
+            }
+
+            //Get nex_ids list and insert the elements into the unordered_set nexus_ids in part_data struct
+            for (auto &nex_id: part.at("nex-ids").as_list())
+            {
+                part_data.nexus_ids.emplace(nex_id.as_string());
+            }
+
+            //Get remote-connections and set the corresponding part_data struct member
+            for (auto &remote_conn : part.at("remote-connections").as_list())
+            {
+                int remote_mpi_rank = remote_conn.at("mpi-rank").as_natural_number();
+                std::string remote_nex_id = remote_conn.at("nex-id").as_string();
+                std::string remote_cat_id = remote_conn.at("cat-id").as_string();
+                std::string direction = remote_conn.at("cat-direction").as_string();
+                part_data.remote_connections.push_back(std::make_tuple(remote_mpi_rank, remote_nex_id, remote_cat_id, direction));
+            }
+            return part_data;
+        };
+
+        bool is_binary;
+        int num_partitions;
+        std::ifstream binary_file;
+
         int mpi_world_rank;
         std::unordered_set<std::string> catchment_ids;
         std::unordered_set<std::string> nexus_ids;
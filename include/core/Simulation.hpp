@@ -0,0 +1,312 @@
+#ifndef NGEN_SIMULATION_HPP
+#define NGEN_SIMULATION_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include "FeatureBuilder.hpp"
+#include "Formulation_Constructors.hpp"
+#include "Formulation_Manager.hpp"
+#include "HY_Features.hpp"
+#include "Pdm03.h"
+#include "ThreadPool.hpp"
+
+namespace ngen {
+
+    /**
+     * @brief A read only view of the flows of some time steps, for each of a list of features, without copying them.
+     *
+     * The flows are step major: the flow of feature ``f`` at the ``s``-th step of the view is ``data[s * features + f]``,
+     * in the order of the simulation's ids of those features.  A view is valid until the simulation next steps or is
+     * finalized.
+     */
+    struct FlowView {
+        const double* data = nullptr;
+        std::size_t steps = 0;
+        std::size_t features = 0;
+
+        double at(std::size_t step, std::size_t feature) const { return data[step * features + feature]; }
+    };
+
+    /**
+     * @brief A simulation of catchments and their nexuses run in the calling process, a number of time steps at a time.
+     *
+     * The ``ngen`` executable reads its config, hydrofabric and forcing, runs every output time step, and writes its
+     * flows to files.  A driver running many simulations, e.g. a calibration or forecast, instead builds one of these
+     * once and advances it with @ref step, reading the flows of the steps it ran straight from memory with
+     * @ref nexus_flows and @ref catchment_flows, rather than starting a process and parsing its outputs.
+     *
+     * @code {.cpp}
+     * std::unique_ptr<ngen::Simulation> simulation = ngen::Simulation::from_files("catchments.geojson", "realization.json");
+     * while (simulation->step(24) > 0) {
+     *     ngen::FlowView flows = simulation->nexus_flows();
+     *     // flows.at(s, n) is the flow of simulation->get_nexus_ids()[n] at the s-th step just run, in m^3/s
+     * }
+     * simulation->finalize();
+     * @endcode
+     *
+     * As with ``ngen`` run without MPI, catchments drain to nexuses by their ``toid``, and nexuses take the whole of
+     * their flows; they are not routed, and nothing is written to the outputs of the config.  Catchments of a step are
+     * run on @p threads threads, which should be ``1`` for Python formulations, as they take the GIL for each step.
+     */
+    class Simulation {
+      public:
+
+        /**
+         * @brief Read the formulations of some catchments, and link them to the nexuses they drain to.
+         *
+         * @param config The realization config.
+         * @param catchments The catchments to run, which must have ``toid`` and ``areasqkm`` (or ``area_sqkm``)
+         *                   properties.
+         * @param threads The number of threads to run catchments on, or ``0`` for one per CPU.
+         * @param et_params ET parameters for the formulations, or null for those ``ngen`` uses.
+         * @throws std::runtime_error If the time step of a formulation is neither a multiple nor a divisor of the output
+         *                            interval.
+         */
+        Simulation(boost::property_tree::ptree config, geojson::GeoJSON catchments, std::size_t threads = 1,
+                   std::shared_ptr<pdm03_struct> et_params = nullptr)
+            : catchment_collection(catchments), pool(threads)
+        {
+            // Only CSV catchment outputs are opened as features are built; the others are written by ngen's main alone
+            config.put("output.catchment_format", "stream");
+            manager = std::make_shared<realization::Formulation_Manager>(config);
+            // Cached responses only cover the steps of a whole run, which a caller may not make
+            manager->disallow_response_cache();
+            manager->read(catchments, utils::StreamHandler());
+            std::string link_key = "toid";
+            features = std::unique_ptr<hy_features::HY_Features>(
+                new hy_features::HY_Features(catchments, &link_key, manager));
+            features->set_et_params(et_params != nullptr ? et_params : default_et_params());
+
+            total_steps = manager->Simulation_Time_Object->get_total_output_times();
+            output_interval = manager->Simulation_Time_Object->get_output_interval_seconds();
+            resolve_catchments();
+            resolve_nexuses();
+        }
+
+        /**
+         * @brief Build a simulation from a hydrofabric file of catchments and a realization config file.
+         *
+         * @see Simulation(boost::property_tree::ptree, geojson::GeoJSON, std::size_t, std::shared_ptr<pdm03_struct>)
+         */
+        static std::unique_ptr<Simulation> from_files(const std::string& catchment_path,
+                                                      const std::string& realization_path, std::size_t threads = 1)
+        {
+            boost::property_tree::ptree config;
+            boost::property_tree::json_parser::read_json(realization_path, config);
+            return std::unique_ptr<Simulation>(new Simulation(config, geojson::read(catchment_path), threads));
+        }
+
+        /**
+         * @brief Run the next time steps, replacing the flows of the last steps run with theirs.
+         *
+         * @param steps The number of output time steps to run, fewer being run if the simulation ends first.
+         * @return The number of steps run, ``0`` once the simulation has ended.
+         * @throws std::logic_error If the simulation was finalized.
+         */
+        int step(int steps)
+        {
+            if (features == nullptr) {
+                throw std::logic_error("A simulation cannot be stepped once it is finalized.");
+            }
+            const int count = std::max(0, std::min(steps, total_steps - time_index));
+            catchment_flow_values.assign(static_cast<std::size_t>(count) * catchment_ids.size(), 0.0);
+            nexus_flow_values.assign(static_cast<std::size_t>(count) * nexus_ids.size(), 0.0);
+            first_step_index = time_index;
+            for (int s = 0; s < count; ++s, ++time_index) {
+                double* catchment_row = catchment_flow_values.data() + s * catchment_ids.size();
+                pool.parallel_for(catchments.size(), [&](std::size_t i) {
+                    catchment_row[i] = run_catchment(catchments[i], time_index);
+                });
+                // Contributions are in network order, so nexus sums are the same with any number of threads
+                for (std::size_t i = 0; i < catchments.size(); ++i) {
+                    if (catchments[i].destination != nullptr) {
+                        catchments[i].destination->add_upstream_flow(catchment_row[i], catchment_ids[i], time_index);
+                    }
+                }
+                double* nexus_row = nexus_flow_values.data() + s * nexus_ids.size();
+                for (std::size_t n = 0; n < nexuses.size(); ++n) {
+                    nexus_row[n] = nexuses[n].nexus->get_downstream_flow(nexuses[n].cat_id, time_index, 100.0);
+                }
+            }
+            steps_run = count;
+            return count;
+        }
+
+        /** @return The flows, in m^3/s, each nexus received at each of the steps last run, by @ref get_nexus_ids. */
+        FlowView nexus_flows() const { return view(nexus_flow_values, nexus_ids.size()); }
+
+        /** @return The flows, in m^3/s, each catchment contributed at each of the steps last run, by @ref get_catchment_ids. */
+        FlowView catchment_flows() const { return view(catchment_flow_values, catchment_ids.size()); }
+
+        const std::vector<std::string>& get_nexus_ids() const { return nexus_ids; }
+
+        const std::vector<std::string>& get_catchment_ids() const { return catchment_ids; }
+
+        /** @return The output time index of the next step to run, which is also the number of steps run so far. */
+        int get_time_index() const { return time_index; }
+
+        /** @return The output time index of the first of the steps last run. */
+        int get_first_step_index() const { return first_step_index; }
+
+        int get_total_steps() const { return total_steps; }
+
+        long get_output_interval_seconds() const { return output_interval; }
+
+        /** @return The timestamp of an output time index, as in the outputs of ``ngen``. */
+        std::string get_timestamp(int time_index) const
+        {
+            return manager->Simulation_Time_Object->get_timestamp(time_index);
+        }
+
+        /**
+         * @brief Release the formulations, finalizing their models, and the features.
+         *
+         * The flows of the last steps run stay readable.  A simulation is finalized as it is destroyed, if not before.
+         */
+        void finalize()
+        {
+            catchments.clear();
+            nexuses.clear();
+            features.reset();
+            manager.reset();
+            catchment_collection.reset();
+        }
+
+      private:
+
+        /** A catchment resolved once, so steps index it rather than looking it up by id. */
+        struct CatchmentRun {
+            realization::Catchment_Formulation* formulation = nullptr;
+            int tag = 0;
+            int step_multiple = 1;
+            int substeps = 1;
+            double flow_factor = 0.0;
+            // The flow of the formulation's last step, held for each output time step it spans
+            double held_flow = 0.0;
+            std::shared_ptr<HY_HydroNexus> destination;
+        };
+
+        struct NexusRun {
+            std::shared_ptr<HY_HydroNexus> nexus;
+            // The "requesting" id for downstream_flow
+            std::string cat_id;
+        };
+
+        static std::shared_ptr<pdm03_struct> default_et_params()
+        {
+            auto params = std::make_shared<pdm03_struct>();
+            params->scaled_distribution_fn_shape_parameter = 1.3;
+            params->vegetation_adjustment = 0.99;
+            params->model_time_step = 0.0;
+            params->max_height_soil_moisture_storerage_tank = 400.0;
+            params->maximum_combined_contents = params->max_height_soil_moisture_storerage_tank
+                                                / (1.0 + params->scaled_distribution_fn_shape_parameter);
+            return params;
+        }
+
+        static double area_m2(const geojson::Feature& catchment, const std::string& id)
+        {
+            if (catchment != nullptr) {
+                for (const char* name : {"areasqkm", "area_sqkm"}) {
+                    if (catchment->has_property(name)) {
+                        return catchment->get_property(name).as_real_number() * 1000000;
+                    }
+                }
+            }
+            throw std::runtime_error("Catchment " + id + " has no areasqkm or area_sqkm property, so its flow cannot be "
+                                     "converted to m^3/s.");
+        }
+
+        void resolve_catchments()
+        {
+            for (const auto& id : features->catchments()) {
+                auto handle = features->handle_of(id);
+                CatchmentRun run;
+                run.formulation = features->formulation_at(handle);
+                if (run.formulation == nullptr) {
+                    continue;
+                }
+                run.tag = realization::get_native_formulation_tag(*run.formulation);
+                const long time_step = run.formulation->get_time_step_seconds();
+                if (time_step > output_interval && time_step % output_interval == 0) {
+                    run.step_multiple = static_cast<int>(time_step / output_interval);
+                }
+                else if (time_step > 0 && time_step < output_interval && output_interval % time_step == 0) {
+                    run.substeps = static_cast<int>(output_interval / time_step);
+                }
+                else if (time_step != 0 && time_step != output_interval) {
+                    throw std::runtime_error("The time step of " + std::to_string(time_step) + " seconds of the "
+                                             "formulation of " + id + " is neither a multiple nor a divisor of the "
+                                             "output interval of " + std::to_string(output_interval) + " seconds.");
+                }
+                run.flow_factor = area_m2(catchment_collection->get_feature(id), id)
+                                  / static_cast<double>(run.step_multiple * output_interval);
+                // Only the first destination, as the network is dendritic
+                const auto& destinations = features->destination_nexuses(handle);
+                run.destination = destinations.empty() ? nullptr : destinations[0];
+                catchment_ids.push_back(id);
+                catchments.push_back(run);
+            }
+        }
+
+        void resolve_nexuses()
+        {
+            for (const auto& id : features->nexuses()) {
+                NexusRun run;
+                run.nexus = features->nexus_at(features->handle_of(id));
+                const auto& cat_ids = run.nexus->get_receiving_catchments();
+                run.cat_id = cat_ids.empty() ? "terminal" : cat_ids[0];
+                nexus_ids.push_back(id);
+                nexuses.push_back(run);
+            }
+        }
+
+        /** Run a catchment for an output time step, as ``ngen`` does, returning its flow in m^3/s. */
+        double run_catchment(CatchmentRun& run, int output_time_index)
+        {
+            if (output_time_index % run.step_multiple != 0) {
+                return run.held_flow;
+            }
+            const long time_step = output_interval * run.step_multiple / run.substeps;
+            const int first_index = output_time_index / run.step_multiple * run.substeps;
+            run.held_flow = realization::run_formulation_steps(run.tag, *run.formulation, first_index, run.substeps,
+                                                               time_step) * run.flow_factor;
+            return run.held_flow;
+        }
+
+        FlowView view(const std::vector<double>& values, std::size_t feature_count) const
+        {
+            FlowView flows;
+            flows.data = values.data();
+            flows.steps = static_cast<std::size_t>(steps_run);
+            flows.features = feature_count;
+            return flows;
+        }
+
+        geojson::GeoJSON catchment_collection;
+        std::shared_ptr<realization::Formulation_Manager> manager;
+        std::unique_ptr<hy_features::HY_Features> features;
+        utils::ThreadPool pool;
+        int total_steps = 0;
+        long output_interval = 0;
+        int time_index = 0;
+        int first_step_index = 0;
+        int steps_run = 0;
+        std::vector<std::string> catchment_ids;
+        std::vector<CatchmentRun> catchments;
+        std::vector<std::string> nexus_ids;
+        std::vector<NexusRun> nexuses;
+        std::vector<double> catchment_flow_values;
+        std::vector<double> nexus_flow_values;
+    };
+}
+
+#endif // NGEN_SIMULATION_HPP
@@ -0,0 +1,148 @@
+#ifndef NGEN_SPIN_UP_HPP
+#define NGEN_SPIN_UP_HPP
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include <sys/stat.h>
+
+#include "Cached_Response_Formulation.hpp"
+#include "Checkpoint.hpp"
+#include "Formulation_Manager.hpp"
+#include "Pdm03.h"
+#include "ThreadPool.hpp"
+
+namespace spinup {
+
+    /**
+     * @return The path of the cached end state of the spin-up of a catchment, whose config has @p signature.
+     */
+    inline std::string state_path(const std::string& directory, const std::string& catchment_id, std::uint64_t signature)
+    {
+        char hex[17];
+        std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(signature));
+        return directory + "/" + catchment_id + "." + hex + ".ckpt";
+    }
+
+    /**
+     * @brief Start every formulation of a run from the state its catchment ends the spin-up with.
+     *
+     * Catchment formulations depend only on their forcings, never on nexus flows, so each catchment is spun up on its
+     * own, by running the formulation of its spin-up through every time step of the spin-up, without outputs or
+     * nexuses.  The end state of each catchment is saved in its own checkpoint file of the spin-up cache, keyed by
+     * the signature of the catchment's config for the spin-up, i.e., of its formulation config, its forcing and the
+     * spin-up window; a catchment whose state is cached under its signature is not spun up again.
+     *
+     * @code {.cpp}
+     * std::shared_ptr<realization::Formulation_Manager> spinup_manager = manager->make_spinup_manager();
+     * spinup_manager->read(catchment_collection, utils::getStdOut());
+     * spinup::spin_up(*manager, *spinup_manager, et_params, pool);
+     * @endcode
+     *
+     * @param manager The formulations of the run, which are yet to run any time step.
+     * @param spinup_manager The formulations of the spin-up, read from @ref realization::Formulation_Manager::make_spinup_manager
+     *                       of @p manager.
+     * @param et_params ET parameters for the spin-up formulations, or null for none.
+     * @param pool The threads to spin catchments up with.
+     * @return The number of catchments whose end state was cached.
+     * @throws std::runtime_error If the cache directory cannot be created, a catchment has no signature (e.g., it is
+     *                            part of a batch), or its time step does not divide the spin-up.
+     */
+    inline std::size_t spin_up(realization::Formulation_Manager& manager,
+                               realization::Formulation_Manager& spinup_manager,
+                               std::shared_ptr<pdm03_struct> et_params, utils::ThreadPool& pool)
+    {
+        const std::string& directory = manager.get_spinup_params().cache_path;
+        if (mkdir(directory.c_str(), 0777) != 0 && errno != EEXIST) {
+            throw std::runtime_error("Unable to create spin-up cache directory " + directory + ": "
+                                     + std::strerror(errno));
+        }
+
+        // Replayed responses need no state
+        std::vector<std::pair<std::string, std::shared_ptr<realization::Catchment_Formulation>>> formulations;
+        for (const auto& formulation : manager) {
+            if (std::dynamic_pointer_cast<realization::Cached_Response_Formulation>(formulation.second) == nullptr) {
+                formulations.push_back(formulation);
+            }
+        }
+
+        // With paging, each catchment's models are in memory only while it is spun up
+        realization::Catchment_State_Pager* pager = manager.get_state_pager().get();
+        realization::Catchment_State_Pager* spinup_pager = spinup_manager.get_state_pager().get();
+
+        const long spinup_seconds = static_cast<long>(spinup_manager.Simulation_Time_Object->get_total_output_times())
+                                    * spinup_manager.Simulation_Time_Object->get_output_interval_seconds();
+        std::atomic<std::size_t> cached_count(0);
+        pool.parallel_for(formulations.size(), [&](std::size_t i) {
+            const std::string& id = formulations[i].first;
+            std::uint64_t signature;
+            try {
+                signature = spinup_manager.get_signature(id);
+            }
+            catch (const std::out_of_range&) {
+                throw std::runtime_error("Catchment " + id + " has no signature to cache its spin-up by; batched "
+                                         "formulations cannot be spun up.");
+            }
+            const std::string path = state_path(directory, id, signature);
+
+            std::vector<char> state;
+            struct stat info;
+            if (stat(path.c_str(), &info) == 0) {
+                utils::CheckpointFile::states_t states;
+                utils::CheckpointFile::read(path, states);
+                auto saved = states.find(id);
+                if (saved != states.end()) {
+                    state = std::move(saved->second);
+                    ++cached_count;
+                }
+            }
+            if (state.empty()) {
+                std::shared_ptr<realization::Catchment_Formulation> spinup_formulation = spinup_manager.get_formulation(id);
+                long time_step_seconds = spinup_formulation->get_time_step_seconds();
+                if (time_step_seconds == 0) {
+                    time_step_seconds = spinup_manager.Simulation_Time_Object->get_output_interval_seconds();
+                }
+                if (spinup_seconds % time_step_seconds != 0) {
+                    throw std::runtime_error("The time step of the formulation of " + id + " does not divide the "
+                                             "spin-up into whole time steps.");
+                }
+                if (spinup_pager != nullptr) {
+                    spinup_pager->page_in(*spinup_formulation);
+                }
+                if (et_params != nullptr) {
+                    spinup_formulation->set_et_params(et_params);
+                }
+                const long steps = spinup_seconds / time_step_seconds;
+                for (long t = 0; t < steps; ++t) {
+                    spinup_formulation->get_response(t, time_step_seconds);
+                }
+                utils::StateWriter out;
+                spinup_formulation->save_state(out);
+                state = out.get_bytes();
+                utils::CheckpointFile::write(path, steps, {{id, state}});
+                if (spinup_pager != nullptr && spinup_formulation->can_release_model()) {
+                    // Not run again, so the model need not be paged out
+                    spinup_formulation->release_model();
+                }
+            }
+            if (pager != nullptr) {
+                pager->page_in(*formulations[i].second);
+            }
+            utils::StateReader in(state);
+            formulations[i].second->load_initial_state(in);
+            if (pager != nullptr) {
+                pager->page_out(*formulations[i].second);
+            }
+        });
+        return cached_count;
+    }
+}
+
+#endif // NGEN_SPIN_UP_HPP
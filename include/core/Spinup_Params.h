@@ -0,0 +1,43 @@
+#ifndef NGEN_SPINUP_PARAMS_H
+#define NGEN_SPINUP_PARAMS_H
+
+#include <string>
+
+/**
+ * @brief spinup_params providing configuration information for spinning up catchment formulations before a run.
+ *
+ * These correspond to the optional ``spinup`` block of a realization config, e.g.:
+ *
+ * @code {.json}
+ * "spinup": {
+ *     "start_time": "2014-10-01 00:00:00",
+ *     "cache": "./ngen.spinup"
+ * }
+ * @endcode
+ *
+ * When given, every catchment formulation is first run from the spin-up start time up to the start time of the run,
+ * and the run starts from the states the formulations end the spin-up with.  The end state of each catchment is
+ * cached, keyed by a hash of its formulation config and forcing over the spin-up, so later runs with the same
+ * catchment config and spin-up load the state rather than spin up again (see spinup::spin_up).
+ */
+struct spinup_params
+{
+    /**
+     * Whether the config has a ``spinup`` block, i.e., whether to spin up at all.
+     */
+    bool enabled;
+
+    /**
+     * The time the spin-up starts at, formatted like the times of the ``time`` block; it ends at their start time.
+     */
+    std::string start_time;
+
+    /**
+     * Directory of the cached end states of the spin-up of each catchment, created if it does not exist.
+     */
+    std::string cache_path;
+
+    spinup_params() : enabled(false), start_time(), cache_path("./ngen.spinup") {}
+};
+
+#endif // NGEN_SPINUP_PARAMS_H
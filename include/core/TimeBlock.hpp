@@ -0,0 +1,91 @@
+#ifndef NGEN_TIME_BLOCK_HPP
+#define NGEN_TIME_BLOCK_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace ngen {
+
+    /**
+     * @brief The flows of every catchment through a block of time steps, for running each catchment through several
+     * time steps at once, while its model state is in cache, before the nexuses take the flows of the first of them.
+     *
+     * Catchments depend only on their forcings, so their flows of a block of time steps may be computed before any
+     * reaches a nexus, and handed to the nexuses one time step at a time as if each had just been computed.  A block
+     * ends at the end of the run, and at a checkpoint, so the state saved there is that of its time step.
+     *
+     * @code {.cpp}
+     * ngen::TimeBlock block(catchment_count, time_block, checkpoint_interval, first);
+     * for (int t = first; t < last; ++t) {
+     *     if (block.is_due(t)) {
+     *         block.start(t, last);
+     *         for (std::size_t i = 0; i < catchment_count; ++i)
+     *             for (int s = block.get_start(); s < block.get_end(); ++s)
+     *                 block.flow(i, s) = run_catchment(i, s);
+     *     }
+     *     for (std::size_t i = 0; i < catchment_count; ++i)
+     *         add_to_nexus(i, block.flow(i, t), t);
+     * }
+     * @endcode
+     */
+    class TimeBlock {
+      public:
+
+        /**
+         * @param catchments The number of catchments.
+         * @param steps The number of time steps of a full block.
+         * @param checkpoint_interval The time steps between checkpoints, at which blocks end, or 0 if there are none.
+         * @param first The first time step run.
+         */
+        TimeBlock(std::size_t catchments, long steps, long checkpoint_interval = 0, int first = 0)
+            : steps(std::max(steps, 1L)), checkpoint_interval(checkpoint_interval), flows(catchments * this->steps, 0.0)
+        {
+            reset(first);
+        }
+
+        /** Start over from time step @p first, e.g., for another run, before any block of it is started. */
+        void reset(int first)
+        {
+            block_start = first;
+            block_end = first;
+        }
+
+        /** @return Whether time step @p t is past the current block, so the next must be started at it. */
+        bool is_due(int t) const { return t == block_end; }
+
+        /**
+         * @brief Start the block at time step @p t, ending at a full block, the next checkpoint, or @p last if sooner.
+         *
+         * The flows of the previous block are then no longer kept.
+         */
+        void start(int t, int last)
+        {
+            block_start = t;
+            block_end = static_cast<int>(std::min<long>(last, static_cast<long>(t) + steps));
+            if(checkpoint_interval > 0) {
+                block_end = static_cast<int>(std::min<long>(block_end, (t / checkpoint_interval + 1) * checkpoint_interval));
+            }
+        }
+
+        /** @return The first time step of the current block. */
+        int get_start() const { return block_start; }
+
+        /** @return One past the last time step of the current block. */
+        int get_end() const { return block_end; }
+
+        /** @return The flow of catchment @p i at time step @p t, of the current block. */
+        double& flow(std::size_t i, int t) { return flows[i * steps + (t - block_start)]; }
+
+      private:
+
+        long steps;
+        long checkpoint_interval;
+        /** The flows of each catchment, each through the time steps of a full block. */
+        std::vector<double> flows;
+        int block_start;
+        int block_end;
+    };
+}
+
+#endif //NGEN_TIME_BLOCK_HPP
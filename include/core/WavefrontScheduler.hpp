@@ -0,0 +1,237 @@
+#ifndef NGEN_WAVEFRONT_SCHEDULER_HPP
+#define NGEN_WAVEFRONT_SCHEDULER_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <vector>
+
+#include "network.hpp"
+
+namespace network {
+
+    /**
+     * @brief Dependency driven scheduler of (feature, time step) work items over a network::Network.
+     *
+     * Instead of a global barrier at the end of every time step, the scheduler releases work for each feature as soon
+     * as the features it depends on have finished the same time step:
+     *
+     *  - a catchment may run time step @c t once it has finished @c t-1 and every catchment immediately upstream of
+     *    it (i.e., contributing to one of its origination nexuses) has finished @c t;
+     *  - a nexus may run time step @c t once it has finished @c t-1 and all of its contributing catchments have
+     *    finished @c t.
+     *
+     * Headwater catchments can therefore move on to later time steps while downstream catchments are still working
+     * on earlier ones.  How far ahead any feature may run is bounded by a lookahead window: no work for time step
+     * @c t is released until every feature in the network has finished time step @c t-lookahead-1.  The window bounds
+     * the number of time steps of buffered flows at any nexus, and keeps outputs from getting far out of step.
+     *
+     * Work may also depend on inputs outside the network, e.g. forcing read asynchronously: with a readiness check
+     * (see @ref set_readiness_check), a released task whose inputs are not ready is set aside while they are read, and
+     * the threads take other ready work meanwhile, so reading overlaps computing without a barrier between them.
+     *
+     * The scheduler itself only tracks dependencies; callers execute the work.  It is safe for any number of threads
+     * to concurrently @ref acquire and @ref complete work items.
+     *
+     * @code {.cpp}
+     * network::WavefrontScheduler scheduler(network, total_steps, lookahead);
+     * network::WavefrontScheduler::Task task;
+     * while (scheduler.acquire(task)) {
+     *     if (task.kind == network::WavefrontScheduler::CATCHMENT) {
+     *         run_catchment(scheduler.catchment_ids()[task.index], task.time_step);
+     *     }
+     *     else {
+     *         run_nexus(scheduler.nexus_ids()[task.index], task.time_step);
+     *     }
+     *     scheduler.complete(task);
+     * }
+     * @endcode
+     */
+    class WavefrontScheduler {
+      public:
+
+        enum TaskKind {
+            CATCHMENT,
+            NEXUS
+        };
+
+        /**
+         * @brief A unit of work: one feature for one time step.
+         *
+         * @var Task::kind Whether @ref index refers to @ref catchment_ids or @ref nexus_ids.
+         * @var Task::index Index of the feature within its kind's id list.
+         * @var Task::time_step The time step index to execute.
+         */
+        struct Task {
+            TaskKind kind;
+            std::size_t index;
+            long time_step;
+        };
+
+        /**
+         * @brief Construct a scheduler for the catchments and nexuses of @p network.
+         *
+         * @param network The (already linked) network to schedule.
+         * @param total_steps The number of time steps every feature must execute.
+         * @param lookahead The number of time steps any feature may run ahead of the slowest feature in the network.
+         */
+        WavefrontScheduler(Network& network, long total_steps, long lookahead);
+
+        virtual ~WavefrontScheduler(){}
+
+        /**
+         * @brief Whether the inputs of a task outside the network are ready, e.g. its forcing has been read; when they
+         * are not, it should request them, so they are read in the background while other tasks run.
+         */
+        using ReadinessCheck = std::function<bool(const Task&)>;
+
+        /**
+         * @brief Only hand out tasks whose inputs are ready, by @p check.
+         *
+         * Tasks are checked as they are acquired, outside the scheduler's lock.  One that is not ready is set aside,
+         * and checked again, by one thread at a time, every @p poll_interval while no other task is ready.  A task set
+         * aside for longer than @p max_wait is handed out anyway, since a task can always get its inputs itself (e.g.
+         * a forcing provider reads what is not cached as it is asked for it), so inputs that never become ready only
+         * delay the schedule.  Must be set before any task is acquired.
+         *
+         * @param check The check, which may be called from any thread acquiring work, but never twice at once for
+         *              the same task.
+         * @param poll_interval How often tasks that were not ready are checked again.
+         * @param max_wait How long a task may be set aside.
+         */
+        void set_readiness_check(ReadinessCheck check,
+                                 std::chrono::microseconds poll_interval = std::chrono::microseconds(500),
+                                 std::chrono::microseconds max_wait = std::chrono::microseconds(1000000));
+
+        /**
+         * @brief Block until a work item is available, or all work is finished.
+         *
+         * @param task Set to the acquired work item when returning @c true.
+         * @return @c true if a task was acquired, @c false if there is no more work (or the schedule was aborted).
+         */
+        bool acquire(Task& task);
+
+        /**
+         * @brief Mark a previously acquired work item finished, releasing any work that depended on it.
+         *
+         * @param task The completed work item.
+         */
+        void complete(const Task& task);
+
+        /**
+         * @brief Stop releasing work, and wake all threads blocked in @ref acquire.
+         *
+         * Used when executing a work item fails and the remaining schedule should be abandoned.
+         */
+        void abort();
+
+        /**
+         * @return The catchment ids, in the network's topological order, that @ref Task::index refers to.
+         */
+        const std::vector<std::string>& catchment_ids() const { return catchment_id_list; }
+
+        /**
+         * @return The nexus ids, in the network's topological order, that @ref Task::index refers to.
+         */
+        const std::vector<std::string>& nexus_ids() const { return nexus_id_list; }
+
+        /**
+         * @return The contributing catchment indices of the nexus at @p nexus_index, in a fixed order.
+         */
+        const std::vector<std::size_t>& nexus_contributors(std::size_t nexus_index) const {
+            return nexus_upstream_catchments[nexus_index];
+        }
+
+        /**
+         * @return The index of the nexus receiving flow from the catchment at @p catchment_index, or -1 if none.
+         */
+        long catchment_destination(std::size_t catchment_index) const {
+            return catchment_downstream_nexus[catchment_index];
+        }
+
+        /**
+         * @return The lookahead window the schedule was created with.
+         */
+        long get_lookahead() const { return lookahead; }
+
+      private:
+
+        /** Check if the catchment's next time step may run, and if so queue it; lock must be held. */
+        void try_release_catchment(std::size_t c);
+
+        /** Check if the nexus's next time step may run, and if so queue it; lock must be held. */
+        void try_release_nexus(std::size_t n);
+
+        /** Advance the time step every feature has finished, releasing anything held by the window; lock must be held. */
+        void advance_floor();
+
+        /**
+         * Check again the tasks set aside as not ready, outside the lock, which must be held on entering and is held on
+         * return; the first that is now ready (or has waited too long) is taken, and any others returned to the queue.
+         */
+        bool poll_waiting(std::unique_lock<std::mutex>& lock, Task& task);
+
+        /** A released task whose inputs were not ready. */
+        struct WaitingTask {
+            Task task;
+            std::chrono::steady_clock::time_point since;
+        };
+
+        struct TaskOrder {
+            bool operator()(const Task& a, const Task& b) const {
+                // Lowest time step first, and catchments before nexuses within a step
+                if (a.time_step != b.time_step) {
+                    return a.time_step > b.time_step;
+                }
+                return a.kind > b.kind;
+            }
+        };
+
+        std::vector<std::string> catchment_id_list;
+        std::vector<std::string> nexus_id_list;
+
+        /** For each catchment, the catchments feeding its origination nexuses. */
+        std::vector<std::vector<std::size_t>> catchment_upstream_catchments;
+        /** For each catchment, the catchments it feeds through its destination nexus. */
+        std::vector<std::vector<std::size_t>> catchment_downstream_catchments;
+        /** For each catchment, the (first) destination nexus index, or -1. */
+        std::vector<long> catchment_downstream_nexus;
+        /** For each nexus, its contributing catchments. */
+        std::vector<std::vector<std::size_t>> nexus_upstream_catchments;
+
+        /** Next time step to be run for each catchment/nexus; includes in-progress work. */
+        std::vector<long> catchment_next_step;
+        std::vector<long> nexus_next_step;
+        /** Number of time steps finished for each catchment/nexus. */
+        std::vector<long> catchment_done_steps;
+        std::vector<long> nexus_done_steps;
+        /** Whether a catchment/nexus currently has queued or in-progress work. */
+        std::vector<bool> catchment_busy;
+        std::vector<bool> nexus_busy;
+
+        /** Count of unfinished work items for each time step. */
+        std::vector<std::size_t> pending_per_step;
+        /** All time steps before this have been finished by every feature. */
+        long floor_step;
+
+        long total_steps;
+        long lookahead;
+        std::size_t remaining_tasks;
+        bool aborted;
+
+        std::priority_queue<Task, std::vector<Task>, TaskOrder> ready;
+        /** The tasks released but set aside as not ready, and whether a thread is checking them again. */
+        std::vector<WaitingTask> waiting;
+        bool is_polling = false;
+        ReadinessCheck readiness;
+        std::chrono::microseconds poll_interval;
+        std::chrono::microseconds max_wait;
+        std::mutex mutex;
+        std::condition_variable work_available;
+    };
+}
+
+#endif //NGEN_WAVEFRONT_SCHEDULER_HPP
@@ -0,0 +1,284 @@
+#ifndef NGEN_CATCHMENT_OUTPUT_AGGREGATOR_HPP
+#define NGEN_CATCHMENT_OUTPUT_AGGREGATOR_HPP
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace catchment_output
+{
+    /**
+     * @brief Selection of catchment output variables, and their aggregation over periods of output time steps, before
+     * catchment output is written.
+     *
+     * Each selected variable is aggregated with its own method over each period of a fixed number of output time
+     * steps, and one row of the aggregated values is written for the period, at the period's first time step.  The
+     * selection holds, in order, each selected variable that a catchment outputs; selected variables a catchment does
+     * not output are left out of its rows.  With no variables selected, every variable of each catchment is kept.
+     *
+     * The rows of each catchment must be added in time order, but the rows of different catchments may be added
+     * concurrently, since each catchment's accumulated values are its own.
+     */
+    class CatchmentOutputAggregator
+    {
+      public:
+
+        /** How a variable's values are aggregated over a period. */
+        enum method {
+            /** The value of the last row of the period. */
+            INSTANTANEOUS,
+            SUM,
+            MEAN,
+            MIN,
+            MAX
+        };
+
+        /** Each selected variable's name and aggregation method, as configured, in output order. */
+        typedef std::vector<std::pair<std::string, std::string>> variables_t;
+
+        /**
+         * @param method_name A method name: ``instantaneous``, ``sum``, ``mean``, ``min`` or ``max``.
+         * @return The method.
+         * @throws std::invalid_argument If the name is not of a method.
+         */
+        static method parse_method(const std::string& method_name)
+        {
+            if (method_name == "instantaneous") return INSTANTANEOUS;
+            if (method_name == "sum") return SUM;
+            if (method_name == "mean") return MEAN;
+            if (method_name == "min") return MIN;
+            if (method_name == "max") return MAX;
+            throw std::invalid_argument("Unknown catchment output aggregation '" + method_name
+                                        + "'; expected instantaneous, sum, mean, min or max.");
+        }
+
+        /**
+         * @brief The header line of the selected variables of a catchment.
+         *
+         * @param variables The selected variables, or none to keep every variable.
+         * @param header_line The delimited names of all of the catchment's output variables.
+         * @param delimiter The delimiter between names.
+         * @return The delimited names of the catchment's selected variables.
+         */
+        static std::string select_header(const variables_t& variables, const std::string& header_line,
+                                         const std::string& delimiter = ",")
+        {
+            std::vector<std::string> names = split_names(header_line, delimiter);
+            std::string header;
+            for (std::size_t v : select(variables, names)) {
+                header.append(header.empty() ? "" : delimiter).append(names[v]);
+            }
+            return header;
+        }
+
+        /**
+         * @brief Split a header line into the names of its variables.
+         *
+         * @param header_line The delimited names of variables.
+         * @param delimiter The delimiter between names.
+         * @return The names.
+         */
+        static std::vector<std::string> split_names(const std::string& header_line, const std::string& delimiter = ",")
+        {
+            std::vector<std::string> names;
+            std::size_t begin = 0;
+            std::size_t end;
+            while ((end = header_line.find(delimiter, begin)) != std::string::npos) {
+                names.push_back(header_line.substr(begin, end - begin));
+                begin = end + delimiter.size();
+            }
+            names.push_back(header_line.substr(begin));
+            return names;
+        }
+
+        /**
+         * @param catchment_ids The ids of every catchment rows will be added for.
+         * @param variable_names The names of all the output variables of each catchment, in the order of its values.
+         * @param row_spacings The output time steps between the rows of each catchment, e.g., more than one for a
+         *                     formulation with a time step longer than the output interval.
+         * @param variables The selected variables, or none to keep every variable.
+         * @param period_steps The number of output time steps of each period.
+         * @param default_method The method of every variable when none are selected.
+         * @throws std::invalid_argument If a method is unknown, or a period or a row spacing is not positive.
+         */
+        CatchmentOutputAggregator(const std::vector<std::string>& catchment_ids,
+                                  const std::vector<std::vector<std::string>>& variable_names,
+                                  const std::vector<int>& row_spacings, const variables_t& variables,
+                                  long period_steps, const std::string& default_method = "mean")
+            : period_steps(period_steps)
+        {
+            if (period_steps <= 0) {
+                throw std::invalid_argument("Catchment output must be aggregated over a positive number of time steps.");
+            }
+            if (variable_names.size() != catchment_ids.size() || row_spacings.size() != catchment_ids.size()) {
+                throw std::invalid_argument("CatchmentOutputAggregator: variable names and row spacings are needed for every catchment");
+            }
+            std::vector<method> methods;
+            for (const auto& variable : variables) {
+                methods.push_back(parse_method(variable.second));
+            }
+            method default_all = parse_method(default_method);
+
+            catchments.resize(catchment_ids.size());
+            for (std::size_t c = 0; c < catchment_ids.size(); ++c) {
+                if (row_spacings[c] <= 0) {
+                    throw std::invalid_argument("CatchmentOutputAggregator: the rows of catchment " + catchment_ids[c]
+                                                + " must be a positive number of time steps apart");
+                }
+                catchment_index.emplace(catchment_ids[c], c);
+                aggregation& catchment = catchments[c];
+                catchment.row_spacing = row_spacings[c];
+                for (std::size_t v : select(variables, variable_names[c])) {
+                    catchment.value_indices.push_back(v);
+                    catchment.names.push_back(variable_names[c][v]);
+                    catchment.methods.push_back(variables.empty() ? default_all : methods[selected_position(variables, variable_names[c][v])]);
+                }
+                catchment.values.resize(catchment.value_indices.size());
+            }
+        }
+
+        /**
+         * @param catchment_id The catchment.
+         * @return The names of the catchment's selected variables, in the order of its aggregated values.
+         */
+        const std::vector<std::string>& get_variable_names(const std::string& catchment_id) const
+        {
+            return catchments[index_of(catchment_id)].names;
+        }
+
+        /**
+         * @brief Add the output values of a catchment at a time step, getting the aggregated values of the period if
+         * this completes it.
+         *
+         * @param catchment_id The catchment.
+         * @param time_index The output time step index of the row, after that of the catchment's last row.
+         * @param values All of the catchment's output values at the time step.
+         * @param period_time_index Set to the first time step index of the period, if it is complete.
+         * @param period_values Set to the aggregated values of the period, if it is complete.
+         * @return Whether the row completes a period, so it is to be written.
+         */
+        bool add(const std::string& catchment_id, long time_index, const std::vector<double>& values,
+                 long& period_time_index, std::vector<double>& period_values)
+        {
+            aggregation& catchment = catchments[index_of(catchment_id)];
+            long period = time_index / period_steps;
+            // A row of a later period means the rows ending the last one never came, so start over
+            if (catchment.rows > 0 && period != catchment.period) {
+                catchment.rows = 0;
+            }
+            catchment.period = period;
+            for (std::size_t i = 0; i < catchment.value_indices.size(); ++i) {
+                double value = catchment.value_indices[i] < values.size() ? values[catchment.value_indices[i]]
+                                                                          : std::numeric_limits<double>::quiet_NaN();
+                double& aggregate = catchment.values[i];
+                if (catchment.rows == 0) {
+                    aggregate = value;
+                    continue;
+                }
+                switch (catchment.methods[i]) {
+                    case INSTANTANEOUS: aggregate = value; break;
+                    case SUM:
+                    case MEAN: aggregate += value; break;
+                    case MIN: aggregate = std::min(aggregate, value); break;
+                    case MAX: aggregate = std::max(aggregate, value); break;
+                }
+            }
+            ++catchment.rows;
+            if (time_index + catchment.row_spacing < (period + 1) * period_steps) {
+                return false;
+            }
+            return take_period(catchment, period_time_index, period_values);
+        }
+
+        /**
+         * @brief Get the aggregated values of a catchment's incomplete period, e.g., at the end of the run.
+         *
+         * @param catchment_id The catchment.
+         * @param period_time_index Set to the first time step index of the period, if it has any rows.
+         * @param period_values Set to the aggregated values of the period's rows, if it has any.
+         * @return Whether the period has any rows, so it is to be written.
+         */
+        bool flush(const std::string& catchment_id, long& period_time_index, std::vector<double>& period_values)
+        {
+            aggregation& catchment = catchments[index_of(catchment_id)];
+            if (catchment.rows == 0) {
+                return false;
+            }
+            return take_period(catchment, period_time_index, period_values);
+        }
+
+      private:
+
+        /** The selection of a catchment's variables, and their values accumulated over the current period. */
+        struct aggregation {
+            std::vector<std::size_t> value_indices;
+            std::vector<std::string> names;
+            std::vector<method> methods;
+            std::vector<double> values;
+            int row_spacing = 1;
+            long period = 0;
+            long rows = 0;
+        };
+
+        /** The positions in @p names of the selected variables, in selection order, or of all of them if none are. */
+        static std::vector<std::size_t> select(const variables_t& variables, const std::vector<std::string>& names)
+        {
+            std::vector<std::size_t> selected;
+            if (variables.empty()) {
+                for (std::size_t v = 0; v < names.size(); ++v) {
+                    selected.push_back(v);
+                }
+                return selected;
+            }
+            for (const auto& variable : variables) {
+                auto it = std::find(names.begin(), names.end(), variable.first);
+                if (it != names.end()) {
+                    selected.push_back(it - names.begin());
+                }
+            }
+            return selected;
+        }
+
+        static std::size_t selected_position(const variables_t& variables, const std::string& name)
+        {
+            for (std::size_t i = 0; i < variables.size(); ++i) {
+                if (variables[i].first == name) {
+                    return i;
+                }
+            }
+            return variables.size();
+        }
+
+        std::size_t index_of(const std::string& catchment_id) const
+        {
+            auto it = catchment_index.find(catchment_id);
+            if (it == catchment_index.end()) {
+                throw std::invalid_argument("CatchmentOutputAggregator: no output configured for catchment " + catchment_id);
+            }
+            return it->second;
+        }
+
+        bool take_period(aggregation& catchment, long& period_time_index, std::vector<double>& period_values)
+        {
+            period_time_index = catchment.period * period_steps;
+            period_values = catchment.values;
+            for (std::size_t i = 0; i < period_values.size(); ++i) {
+                if (catchment.methods[i] == MEAN) {
+                    period_values[i] /= catchment.rows;
+                }
+            }
+            catchment.rows = 0;
+            return true;
+        }
+
+        long period_steps;
+        std::vector<aggregation> catchments;
+        std::unordered_map<std::string, std::size_t> catchment_index;
+    };
+}
+
+#endif //NGEN_CATCHMENT_OUTPUT_AGGREGATOR_HPP
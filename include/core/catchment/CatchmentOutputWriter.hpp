@@ -0,0 +1,284 @@
+#ifndef NGEN_CATCHMENT_OUTPUT_WRITER_HPP
+#define NGEN_CATCHMENT_OUTPUT_WRITER_HPP
+
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "FramePublisher.hpp"
+
+namespace catchment_output
+{
+    /**
+     * @brief Sink for the output rows of the catchments of a process, for formats other than per catchment CSV files.
+     *
+     * Implementations must allow concurrent calls to @ref write, for the same or different catchments.
+     */
+    class CatchmentOutputWriter
+    {
+      public:
+
+        virtual ~CatchmentOutputWriter() {}
+
+        /**
+         * @brief Record the output values of a catchment at a time step.
+         *
+         * @param catchment_id The catchment, which must be one of the ids the writer was constructed with.
+         * @param time_index The output time step index.
+         * @param time The time of @p time_index, in seconds since the epoch.
+         * @param values The catchment's output values, in the order of its output variable names.
+         * @throws std::invalid_argument If the writer was not constructed with @p catchment_id.
+         */
+        virtual void write(const std::string& catchment_id, long time_index, time_t time,
+                           const std::vector<double>& values) = 0;
+
+        /**
+         * @brief Write out anything that is buffered.
+         */
+        virtual void flush() = 0;
+    };
+
+    /**
+     * @brief Writes the output variables of every catchment of a process to a single flat binary file.
+     *
+     * This replaces the default of one ``<id>.csv`` file per catchment, which keeps a file open for each catchment for
+     * the whole run.  Rows are gathered in a memory buffer of the configured size and written to the file in bulk.
+     * Rows of different catchments may be written concurrently, and in any order.
+     *
+     * All values are in the host's native byte order.  The file begins with a header of:
+     *
+     *  - the 8 characters ``NGENCAT1``;
+     *  - the number of catchments, as a ``uint64_t``;
+     *  - for each catchment, its id, then its output variable names as a ``uint32_t`` count followed by each name,
+     *    with every string written as a ``uint32_t`` length followed by its characters.
+     *
+     * followed by one record per output row of:
+     *
+     *  - the index of the catchment in the header, as a ``uint32_t``;
+     *  - the time step index, as an ``int64_t``;
+     *  - the time, as ``int64_t`` seconds since the epoch;
+     *  - the number of values, as a ``uint32_t``;
+     *  - the values, as ``double`` values.
+     *
+     * Records are not necessarily in time order, e.g., with execution lookahead, and a formulation with a time step
+     * longer than the output interval only has a record for each of its own time steps.
+     */
+    class BinaryCatchmentOutputWriter : public CatchmentOutputWriter
+    {
+      public:
+
+        /**
+         * @param catchment_ids The ids of every catchment this writer will receive output for.
+         * @param variable_names The output variable names of each catchment, in the order of @p catchment_ids.
+         * @param path The path of the output file.
+         * @param buffer_bytes The size of the memory buffer rows are gathered in before being written.
+         */
+        BinaryCatchmentOutputWriter(const std::vector<std::string>& catchment_ids,
+                                    const std::vector<std::vector<std::string>>& variable_names,
+                                    const std::string& path, std::size_t buffer_bytes)
+            : BinaryCatchmentOutputWriter(catchment_ids, variable_names, buffer_bytes)
+        {
+            outfile.open(path, std::ios::trunc | std::ios::binary);
+            if (!outfile.is_open()) {
+                throw std::runtime_error("BinaryCatchmentOutputWriter: unable to open output file " + path);
+            }
+            write_buffer();
+            outfile.flush();
+        }
+
+        virtual ~BinaryCatchmentOutputWriter()
+        {
+            flush();
+        }
+
+        /**
+         * @brief Record the output values of a catchment at a time step.
+         *
+         * @param catchment_id The catchment, which must be one of the ids the writer was constructed with.
+         * @param time_index The output time step index.
+         * @param time The time of @p time_index, in seconds since the epoch.
+         * @param values The catchment's output values.
+         * @throws std::invalid_argument If the writer was not constructed with @p catchment_id.
+         */
+        void write(const std::string& catchment_id, long time_index, time_t time,
+                   const std::vector<double>& values) override
+        {
+            auto it = catchment_index.find(catchment_id);
+            if (it == catchment_index.end()) {
+                throw std::invalid_argument("BinaryCatchmentOutputWriter: no output configured for catchment " + catchment_id);
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            append_value<uint32_t>(it->second);
+            append_value<int64_t>(time_index);
+            append_value<int64_t>(time);
+            append_value<uint32_t>(values.size());
+            append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(double));
+            if (buffer.size() >= buffer_bytes) {
+                write_buffer();
+            }
+        }
+
+        /**
+         * @brief Write out anything that is buffered.
+         */
+        void flush() override
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            write_buffer();
+            outfile.flush();
+        }
+
+        /**
+         * @brief Parse the values of a delimited output line, for formulations that only format their output as text.
+         *
+         * @param line The output line.
+         * @param delimiter The delimiter between values.
+         * @return The values, with any that are not numbers parsed as NaN.
+         */
+        static std::vector<double> parse_values(const std::string& line, char delimiter = ',')
+        {
+            std::vector<double> values;
+            std::size_t begin = 0;
+            while (begin <= line.size()) {
+                std::size_t end = line.find(delimiter, begin);
+                if (end == std::string::npos) {
+                    end = line.size();
+                }
+                std::string field = line.substr(begin, end - begin);
+                char* parsed_end = nullptr;
+                double value = std::strtod(field.c_str(), &parsed_end);
+                values.push_back(parsed_end == field.c_str() ? std::numeric_limits<double>::quiet_NaN() : value);
+                begin = end + 1;
+            }
+            return values;
+        }
+
+      protected:
+
+        /**
+         * @brief Gather the header of the format in the buffer, for a writer that sends its bytes somewhere other
+         * than a file.
+         */
+        BinaryCatchmentOutputWriter(const std::vector<std::string>& catchment_ids,
+                                    const std::vector<std::vector<std::string>>& variable_names,
+                                    std::size_t buffer_bytes)
+            : buffer_bytes(buffer_bytes)
+        {
+            if (variable_names.size() != catchment_ids.size()) {
+                throw std::invalid_argument("BinaryCatchmentOutputWriter: variable names are needed for every catchment");
+            }
+            buffer.reserve(buffer_bytes);
+            append("NGENCAT1", 8);
+            append_value<uint64_t>(catchment_ids.size());
+            for (std::size_t i = 0; i < catchment_ids.size(); ++i) {
+                catchment_index.emplace(catchment_ids[i], i);
+                append_string(catchment_ids[i]);
+                append_value<uint32_t>(variable_names[i].size());
+                for (const auto& name : variable_names[i]) {
+                    append_string(name);
+                }
+            }
+        }
+
+        /**
+         * @brief Send the bytes of the buffer on, with the writer's lock held.
+         */
+        virtual void write_bytes(const std::vector<char>& bytes)
+        {
+            outfile.write(bytes.data(), bytes.size());
+        }
+
+        /** @return The bytes gathered and not yet written, e.g. the header when a derived writer is constructed. */
+        std::vector<char>& get_buffer() { return buffer; }
+
+      private:
+
+        void append(const char* data, std::size_t size)
+        {
+            buffer.insert(buffer.end(), data, data + size);
+        }
+
+        template<typename T>
+        void append_value(T value)
+        {
+            append(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        void append_string(const std::string& value)
+        {
+            append_value<uint32_t>(value.size());
+            append(value.data(), value.size());
+        }
+
+        void write_buffer()
+        {
+            if (!buffer.empty()) {
+                write_bytes(buffer);
+            }
+            buffer.clear();
+        }
+
+        std::size_t buffer_bytes;
+        std::vector<char> buffer;
+        std::unordered_map<std::string, std::size_t> catchment_index;
+        std::ofstream outfile;
+        std::mutex mutex;
+    };
+
+    /**
+     * @brief Publishes the output of every catchment of a process as it is computed, to every process connected to a
+     * socket.
+     *
+     * Output is sent in the layout of @ref BinaryCatchmentOutputWriter, cut into frames of a
+     * @ref utils::FramePublisher: the greeting frame is the header, and each later frame holds a buffer of records.
+     */
+    class StreamCatchmentOutputWriter : public BinaryCatchmentOutputWriter
+    {
+      public:
+
+        /**
+         * @param catchment_ids The ids of every catchment this writer will receive output for.
+         * @param variable_names The output variable names of each catchment, in the order of @p catchment_ids.
+         * @param socket_path The path of the Unix domain socket to publish on.
+         * @param buffer_bytes The size of the memory buffer rows are gathered in before each frame is sent.
+         * @param subscribers The number of subscribers to wait for before returning, so they receive every frame.
+         */
+        StreamCatchmentOutputWriter(const std::vector<std::string>& catchment_ids,
+                                    const std::vector<std::vector<std::string>>& variable_names,
+                                    const std::string& socket_path, std::size_t buffer_bytes,
+                                    std::size_t subscribers = 0)
+            : BinaryCatchmentOutputWriter(catchment_ids, variable_names, buffer_bytes),
+              publisher(new utils::FramePublisher(socket_path, std::string(get_buffer().begin(), get_buffer().end())))
+        {
+            get_buffer().clear();
+            publisher->wait_for_subscribers(subscribers);
+        }
+
+        ~StreamCatchmentOutputWriter() override
+        {
+            // while the publisher still exists, rather than once the base writer flushes to its file
+            flush();
+        }
+
+      protected:
+
+        void write_bytes(const std::vector<char>& bytes) override
+        {
+            publisher->publish(std::string(bytes.begin(), bytes.end()));
+        }
+
+      private:
+
+        std::unique_ptr<utils::FramePublisher> publisher;
+    };
+}
+
+#endif //NGEN_CATCHMENT_OUTPUT_WRITER_HPP
@@ -17,8 +17,12 @@ class HY_CatchmentArea : public HY_CatchmentRealization, public GM_Object
     HY_CatchmentArea();
     HY_CatchmentArea(std::shared_ptr<data_access::GenericDataProvider> forcing, utils::StreamHandler output_stream);
     //HY_CatchmentArea(forcing_params forcing_config, utils::StreamHandler output_stream); //TODO not sure I like this pattern
-    void set_output_stream(std::string file_path){output = utils::FileStreamHandler(file_path.c_str());}
-    void write_output(std::string out){ output<<out; }
+    void set_output_stream(std::string file_path, utils::Compression compression = utils::Compression::none,
+                           int compression_level = -1, std::size_t buffer_bytes = 0)
+    {
+        output = utils::FileStreamHandler(file_path.c_str(), compression, compression_level, buffer_bytes);
+    }
+    void write_output(const std::string& out){ output<<out; }
     virtual ~HY_CatchmentArea();
 
     protected:
@@ -40,6 +40,14 @@ class HY_CatchmentRealization
      */
     virtual double get_response(time_step_t t_index, time_step_t t_delta) = 0;
 
+    /**
+     * @return The provider of this realization's forcing data, which may be null.
+     */
+    const std::shared_ptr<data_access::GenericDataProvider>& get_forcing_provider() const
+    {
+        return forcing;
+    }
+
     protected:
 
     shared_ptr<HY_Catchment> realized_catchment;
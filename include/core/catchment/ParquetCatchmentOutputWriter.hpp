@@ -0,0 +1,122 @@
+#ifdef NGEN_PARQUET_ACTIVE
+#ifndef NGEN_PARQUET_CATCHMENT_OUTPUT_WRITER_HPP
+#define NGEN_PARQUET_CATCHMENT_OUTPUT_WRITER_HPP
+
+#include "CatchmentOutputWriter.hpp"
+#include "ParquetOutputFile.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace catchment_output
+{
+    /**
+     * @brief Writes the output variables of every catchment of a process to a single Parquet file.
+     *
+     * Rows are in the long form of @ref output::ParquetOutputFile, with a row for each value of each catchment output
+     * row, so catchments with different output variables share the one file.  The ``variable`` dictionary holds every
+     * variable name of any catchment, in order of first appearance.  Rows are gathered in memory and written as a row
+     * group whenever they add up to the configured buffer size; like @ref BinaryCatchmentOutputWriter, they are not
+     * necessarily in time order.
+     */
+    class ParquetCatchmentOutputWriter : public CatchmentOutputWriter
+    {
+      public:
+
+        /** The bytes of memory each buffered row takes up, which fixes the rows of each row group. */
+        static constexpr std::size_t ROW_BYTES = 2 * sizeof(int32_t) + 2 * sizeof(int64_t) + sizeof(double);
+
+        /**
+         * @param catchment_ids The ids of every catchment this writer will receive output for.
+         * @param variable_names The output variable names of each catchment, in the order of @p catchment_ids.
+         * @param path The path of the output file.
+         * @param buffer_bytes The size of the memory buffer rows are gathered in before each row group is written.
+         */
+        ParquetCatchmentOutputWriter(const std::vector<std::string>& catchment_ids,
+                                     const std::vector<std::vector<std::string>>& variable_names,
+                                     const std::string& path, std::size_t buffer_bytes)
+            : rows_per_group(std::max<std::size_t>(1, buffer_bytes / ROW_BYTES)),
+              file(path, catchment_ids, all_variables(catchment_ids, variable_names))
+        {
+            std::unordered_map<std::string, uint32_t> variable_index;
+            for (const auto& name : all_variables(catchment_ids, variable_names)) {
+                variable_index.emplace(name, variable_index.size());
+            }
+            catchment_variables.resize(catchment_ids.size());
+            for (std::size_t i = 0; i < catchment_ids.size(); ++i) {
+                catchment_index.emplace(catchment_ids[i], i);
+                for (const auto& name : variable_names[i]) {
+                    catchment_variables[i].push_back(variable_index.at(name));
+                }
+            }
+        }
+
+        virtual ~ParquetCatchmentOutputWriter()
+        {
+            flush();
+            file.close();
+        }
+
+        /**
+         * @copydoc CatchmentOutputWriter::write
+         *
+         * Values beyond the catchment's variable names, which have no variable to be written as, are left out.
+         */
+        void write(const std::string& catchment_id, long time_index, time_t time,
+                   const std::vector<double>& values) override
+        {
+            auto it = catchment_index.find(catchment_id);
+            if (it == catchment_index.end()) {
+                throw std::invalid_argument("ParquetCatchmentOutputWriter: no output configured for catchment " + catchment_id);
+            }
+            const std::vector<uint32_t>& variables = catchment_variables[it->second];
+            std::size_t count = std::min(values.size(), variables.size());
+            std::lock_guard<std::mutex> lock(mutex);
+            for (std::size_t v = 0; v < count; ++v) {
+                file.add(it->second, time_index, time, variables[v], values[v]);
+            }
+            if (file.pending_rows() >= rows_per_group) {
+                file.write_row_group();
+            }
+        }
+
+        void flush() override
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            file.write_row_group();
+        }
+
+      private:
+
+        /** @return Every variable name of any catchment, once each, in order of first appearance. */
+        static std::vector<std::string> all_variables(const std::vector<std::string>& catchment_ids,
+                                                      const std::vector<std::vector<std::string>>& variable_names)
+        {
+            if (variable_names.size() != catchment_ids.size()) {
+                throw std::invalid_argument("ParquetCatchmentOutputWriter: variable names are needed for every catchment");
+            }
+            std::vector<std::string> variables;
+            for (const auto& names : variable_names) {
+                for (const auto& name : names) {
+                    if (std::find(variables.begin(), variables.end(), name) == variables.end()) {
+                        variables.push_back(name);
+                    }
+                }
+            }
+            return variables;
+        }
+
+        std::size_t rows_per_group;
+        output::ParquetOutputFile file;
+        std::unordered_map<std::string, std::size_t> catchment_index;
+        std::vector<std::vector<uint32_t>> catchment_variables;
+        std::mutex mutex;
+    };
+}
+
+#endif //NGEN_PARQUET_CATCHMENT_OUTPUT_WRITER_HPP
+#endif //NGEN_PARQUET_ACTIVE
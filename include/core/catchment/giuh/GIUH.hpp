@@ -1,7 +1,9 @@
 #ifndef NGEN_GIUH_H
 #define NGEN_GIUH_H
 
+#include "giuh_convolution.hpp"
 #include "giuh_kernel.hpp"
+#include "giuh_ordinate_table.hpp"
 #include <string>
 #include <utility>
 #include <vector>
@@ -9,19 +11,6 @@
 
 namespace giuh {
 
-    struct giuh_carry_over {
-        /** The amount of the original runoff input. */
-        double original_input_amount;
-        /** Index of the last 'interpolated_ordinate_times_seconds' used to calculate and output contribution. */
-        unsigned long last_outputted_cdf_index;
-        /** A pointer to a "next" giuh_carry_over struct value, allowing these to self-assemble into a simple list. */
-        std::shared_ptr<giuh_carry_over> next;
-
-        giuh_carry_over(double original_runoff, unsigned long last_cdf_index) : original_input_amount(original_runoff),
-                                                                                last_outputted_cdf_index(last_cdf_index),
-                                                                                next(nullptr){}
-    };
-
     /**
      * A concrete implementation of a GIUH calculation kernel.
      */
@@ -80,6 +69,9 @@ namespace giuh {
          * these, interpolated regularized values will be inferred.  These will be set during object construction,
          * although they can potentially be changed by later changing the interpolation regularity interval value.
          *
+         * Both the base data and the regularized values are shared, through the @ref giuh_ordinate_table, with every
+         * other kernel of the same CDF, so catchments with identical GIUH shapes hold one copy of them.
+         *
          * @param catchment_id
          * @param comid
          * @param cdf_times A vector of base CDF time values, which may or may not be spaced in regular intervals.
@@ -95,9 +87,8 @@ namespace giuh {
                 std::vector<double> cdf_cumulative_freqs,
                 unsigned int interpolation_regularity_seconds
         ) : giuh_kernel(std::move(catchment_id), std::move(comid), interpolation_regularity_seconds),
-            cdf_times(std::move(cdf_times)), cdf_cumulative_freqs(std::move(cdf_cumulative_freqs)) {
-            carry_overs_list_head = nullptr;
-
+            cdf_cumulative_freqs(giuh_ordinate_table::intern(std::move(cdf_cumulative_freqs))),
+            cdf_times(giuh_ordinate_table::intern(std::move(cdf_times))) {
             // TODO: have this be called by constructor, but consider later handling this concurrently
             interpolate_regularized_cdf();
         }
@@ -147,6 +138,14 @@ namespace giuh {
 
         std::vector<double> get_interpolated_regularized_cdf() const override;
 
+        /**
+         * Get the interpolated incremental runoff values after the first (which is always ``0``), as the ordinates of
+         * a convolution with one ordinate per regularized interval, e.g. that of the Tshirt C model.
+         *
+         * @return The shared, immutable ordinates.
+         */
+        std::shared_ptr<const std::vector<double>> get_convolution_ordinates() const;
+
         /**
          * Set the object's interpolation regularity value, also triggering recalculation of the interpolated,
          * regularized CDF ordinates IFF the new regularity value is different from the previous.
@@ -159,42 +158,41 @@ namespace giuh {
     private:
         /**
          * The cumulative frequency (or rank order) of each ``i``-th cell in the travel time cumulative distribution
-         * function, as originally supplied to the object.
+         * function, as originally supplied to the object, interned in the @ref giuh_ordinate_table.
          *
          * For all values in the collection, where the collection is of size ``s``, the ``i``-th value is equal to:
          *      ``i / (s - 1)``
          */
-        const std::vector<double> cdf_cumulative_freqs;
+        const std::shared_ptr<const std::vector<double>> cdf_cumulative_freqs;
         /**
          * The travel time in seconds for each i-th cell in the cumulative distribution function, as originally supplied
-         * to the object.
+         * to the object, interned in the @ref giuh_ordinate_table.
          */
-        const std::vector<double> cdf_times;
+        const std::shared_ptr<const std::vector<double>> cdf_times;
         /**
-         * Regular time values (in seconds) for interpolated CDF ordinates, regularized according to the value of
-         * ``interpolation_regularity_seconds``.
+         * The ordinates interpolated from the original CDF data at the current ``interpolation_regularity_seconds``,
+         * shared with every kernel of the same CDF and regularity:
          *
-         * This a collection of size ``s``, where the values can be defined by a function ``t(i)``, where:
+         * Its ``regularized_times_s`` are regular time values (in seconds) for interpolated CDF ordinates.  This a
+         * collection of size ``s``, where the values can be defined by a function ``t(i)``, where:
          *      ``t(0) = 0``
          *      ``t(i) == t(i-1) + interpolation_regularity_seconds`` for all ``0 < i < s``
-         *
          * E.g., for regularity of 60 seconds, something like ``0, 60, 120, 180, 240 ...``.
+         *
+         * Its ``interpolated_regularized_cdf`` are the regularized CDF values interpolated from ``cdf_cumulative_freqs``
+         * at those times, and its ``interpolated_incremental_runoff`` the incremental increase at each index ``i`` of
+         * them from index ``i-1``.
          */
-        std::vector<int> regularized_times_s;
-        /**
-         * The regularized CDF values interpolated from the original CDF data from ``cdf_cumulative_freqs`` when using
-         * the regularized times in ``regularized_times_s``.
-         */
-        std::vector<double> interpolated_regularized_cdf;
+        std::shared_ptr<const giuh_regularized_ordinates> regularized;
         /**
-         * The incremental increase at each index ``i`` of ``interpolated_regularized_cdf`` from index ``i-1``.
+         * The amounts of previous inputs, which didn't all flow out at their time step, still to be output in each
+         * regularized interval from now on; i.e., the convolution of the inputs with the incremental runoff values
+         * after the first (at index ``0``, which is always ``0``).
          */
-        std::vector<double> interpolated_incremental_runoff;
-        /** List to hold carry-over amounts from previous inputs, which didn't all flow out at that time step. */
-        std::shared_ptr<giuh_carry_over> carry_overs_list_head;
+        giuh_convolution carry_overs;
 
         /**
-         * Perform the interpolation of regularized CDF ordinates.
+         * Perform the interpolation of regularized CDF ordinates, also discarding any carry-over amounts.
          */
         void interpolate_regularized_cdf();
 
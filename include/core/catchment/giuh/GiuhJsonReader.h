@@ -7,10 +7,11 @@
 #include <boost/property_tree/json_parser.hpp>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
-#include <map>
 
 namespace giuh {
 
@@ -19,6 +20,20 @@ namespace giuh {
     class GiuhJsonReader {
 
     public:
+
+        /**
+         * Get a reader for the given GIUH data and id mapping files, shared with any other callers for the same files.
+         *
+         * Since reading the files and indexing their data is proportional to the size of the files, realizations for
+         * each of many catchments should share one reader, rather than each constructing their own.
+         *
+         * @param data_file_path The path to the JSON file containing GIUH data.
+         * @param id_map_path The path to the JSON file containing map of catchment ids to COMIDs.
+         * @return The shared reader for the given files.
+         */
+        static std::shared_ptr<GiuhJsonReader> get_shared_reader(const std::string &data_file_path,
+                                                                 const std::string &id_map_path);
+
         GiuhJsonReader(std::string data_file_path, std::string id_map_path)
             : data_json_file_path(std::move(data_file_path)), id_map_json_file_path(std::move(id_map_path))
         {
@@ -26,9 +41,9 @@ namespace giuh {
             if (FILE *file = fopen(data_json_file_path.c_str(), "r")) {
                 fclose(file);
                 data_json_file_readable = true;
-                ptree tree;
-                boost::property_tree::json_parser::read_json(data_json_file_path, tree);
-                data_json_tree = std::make_unique<ptree>(tree);
+                data_json_tree = std::make_unique<ptree>();
+                boost::property_tree::json_parser::read_json(data_json_file_path, *data_json_tree);
+                index_data_nodes();
             } else {
                 data_json_file_readable = false;
                 data_json_tree = nullptr;
@@ -60,7 +75,7 @@ namespace giuh {
          * @param catchment_data_node
          * @return
          */
-        std::vector<double> extract_cumulative_frequency_ordinates(ptree catchment_data_node);
+        std::vector<double> extract_cumulative_frequency_ordinates(const ptree &catchment_data_node);
 
         /**
          * Extract the ordinate values, getting the appropriate JSON node via lookup
@@ -107,15 +122,32 @@ namespace giuh {
         //std::unique_ptr<ptree> id_map_json_tree;
 
         std::unique_ptr<std::map<std::string, std::string>> id_map;
+        /**
+         * The data node of each COMID within `data_json_tree`, so nodes are found without traversing the tree.
+         *
+         * As when traversing the tree, a COMID with more than one node maps to the first.
+         */
+        std::unordered_map<std::string, const ptree *> data_node_index;
 
+        /** Build `data_node_index`, in a single pass over `data_json_tree`. */
+        void index_data_nodes();
 
-
-        std::unique_ptr<ptree> find_data_node_for_comid(std::string comid);
+        /**
+         * Find the data node for a COMID.
+         *
+         * @param comid
+         * @return The node within `data_json_tree`, or ``nullptr`` if there is none for the COMID.
+         */
+        const ptree *find_data_node_for_comid(const std::string &comid) const;
 
         std::string get_mapped_comid(std::string catchment_id);
 
         std::shared_ptr<giuh_kernel_impl> build_giuh_kernel(std::string catchment_id, std::string comid,
-                                                            ptree catchment_data_node);
+                                                            const ptree &catchment_data_node);
+
+        /** The readers shared through `get_shared_reader`, by their data and id mapping file paths. */
+        static std::map<std::pair<std::string, std::string>, std::shared_ptr<GiuhJsonReader>> shared_readers;
+        static std::mutex shared_readers_mutex;
 
     };
 
@@ -0,0 +1,89 @@
+#ifndef NGEN_GIUH_CONVOLUTION_HPP
+#define NGEN_GIUH_CONVOLUTION_HPP
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace giuh {
+
+    /**
+     * Convolution of runoff inputs with a set of unit hydrograph ordinates.
+     *
+     * Rather than tracking each past input, this keeps a fixed-length circular buffer with, for each ordinate interval
+     * from now on, the total amount of all the past inputs still to be output in that interval.  Adding an input adds
+     * its share to each interval, and releasing some number of intervals outputs (and clears) the amounts of the next
+     * that many intervals.  Both are proportional only to the number of ordinates, and neither allocates.
+     *
+     * For example, the convolution of ``convolution_integral`` in the Tshirt C model, that outputs each input over
+     * one ordinate per time step, adds each time step's input from the first ordinate and then releases one interval.
+     */
+    class giuh_convolution {
+
+    public:
+
+        /**
+         * Initialize, with the given ordinates and nothing yet to output.
+         *
+         * @param ordinates The proportion of an input that is output in each consecutive interval.
+         */
+        explicit giuh_convolution(std::vector<double> ordinates = std::vector<double>());
+
+        /**
+         * Initialize, with the given shared ordinates (e.g., those of a @ref giuh_ordinate_table) and nothing yet to
+         * output.
+         *
+         * @param ordinates The proportion of an input that is output in each consecutive interval.
+         */
+        explicit giuh_convolution(std::shared_ptr<const std::vector<double>> ordinates);
+
+        /**
+         * Add an input to be output over the ordinates from ``first_ordinate_index`` on, with the amount for that
+         * ordinate being output in the next interval released.
+         *
+         * @param input The amount of the input.
+         * @param first_ordinate_index The index of the first ordinate to output the input over; i.e., the number of
+         *                             ordinates of the input that have already been output separately.
+         */
+        void add(double input, std::size_t first_ordinate_index);
+
+        /** @return The total amount still to be output, over all the intervals. */
+        double get_pending_total() const;
+
+        /**
+         * Output the amounts of the next intervals, removing them from the buffer.
+         *
+         * @param intervals The number of intervals to output, which may be more than the number of ordinates.
+         * @return The total amount output over those intervals.
+         */
+        double release(std::size_t intervals);
+
+        /**
+         * Replace the ordinates, also discarding anything still to be output.
+         *
+         * @param ordinates The proportion of an input that is output in each consecutive interval.
+         */
+        void set_ordinates(std::vector<double> ordinates);
+
+        /**
+         * Replace the ordinates with shared ones, also discarding anything still to be output.
+         *
+         * @param ordinates The proportion of an input that is output in each consecutive interval.
+         */
+        void set_ordinates(std::shared_ptr<const std::vector<double>> ordinates);
+
+        /** @return The number of ordinates, and so of intervals in the buffer. */
+        std::size_t size() const;
+
+    private:
+
+        /** The ordinates, which are immutable, so convolutions with the same ordinates may share them. */
+        std::shared_ptr<const std::vector<double>> ordinates;
+        /** The amount to be output in each interval, with the next interval at ``head``. */
+        std::vector<double> pending;
+        std::size_t head;
+
+    };
+}
+
+#endif //NGEN_GIUH_CONVOLUTION_HPP
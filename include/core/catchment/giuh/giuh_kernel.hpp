@@ -1,9 +1,9 @@
 #ifndef NGEN_GIUH_KERNEL_HPP
 #define NGEN_GIUH_KERNEL_HPP
 
-#include <iostream>
 #include <vector>
 #include <string>
+#include "Logger.hpp"
 
 namespace giuh {
 
@@ -30,9 +30,8 @@ namespace giuh {
          * @return The calculated output for this time step.
          */
         virtual double calc_giuh_output(double dt, double direct_runoff) {
-            // TODO: perhaps log this more effectively?
-            std::cerr << "Pass-through kernel being used for GIUH calculations; raw input value `" << direct_runoff
-                      << "` being passed through and immediately returned as output." << std::endl;
+            NGEN_LOG_WARNING("Pass-through kernel being used for GIUH calculations; raw input value `" << direct_runoff
+                             << "` being passed through and immediately returned as output.");
             return direct_runoff;
         }
 
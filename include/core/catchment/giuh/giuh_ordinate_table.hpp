@@ -0,0 +1,96 @@
+#ifndef NGEN_GIUH_ORDINATE_TABLE_HPP
+#define NGEN_GIUH_ORDINATE_TABLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace giuh {
+
+    /**
+     * The regularized ordinates a GIUH kernel interpolates from its CDF, shared by all the kernels with the same CDF
+     * and interpolation regularity.
+     */
+    struct giuh_regularized_ordinates {
+        /** The CDF times the ordinates were interpolated from, kept so they outlive the ordinates. */
+        std::shared_ptr<const std::vector<double>> cdf_times;
+        /** The CDF cumulative frequencies the ordinates were interpolated from, likewise. */
+        std::shared_ptr<const std::vector<double>> cdf_cumulative_freqs;
+        std::vector<int> regularized_times_s;
+        std::vector<double> interpolated_regularized_cdf;
+        std::vector<double> interpolated_incremental_runoff;
+        /** The incremental runoff after the first (which is always ``0``), as the ordinates of a convolution. */
+        std::shared_ptr<const std::vector<double>> convolution_ordinates;
+    };
+
+    /**
+     * A process-wide table of immutable GIUH ordinate vectors, interned by their content, so that the many catchments
+     * whose GIUH shapes are identical each reference one copy of their ordinates, rather than each holding its own.
+     *
+     * Vectors are found by a hash of their bytes, and then compared, so interning a vector costs a pass over it and
+     * only equal vectors are ever shared.  Likewise, the regularized ordinates interpolated from a CDF are kept per
+     * interned CDF and regularity, so they are only interpolated once for all the kernels sharing them.
+     *
+     * Entries are held weakly: one is freed once nothing references it, and expired entries are dropped as the table
+     * grows.  The table may be used from several threads at once, e.g. while formulations are constructed
+     * concurrently.
+     */
+    class giuh_ordinate_table {
+
+    public:
+
+        typedef std::shared_ptr<const std::vector<double>> ordinates_ptr;
+
+        /**
+         * Get the interned copy of a vector of ordinates.
+         *
+         * @param values The ordinates.
+         * @return The one shared, immutable vector with these values, which is @p values itself if it is new.
+         */
+        static ordinates_ptr intern(std::vector<double> values);
+
+        /**
+         * Get the regularized ordinates of an interned CDF at an interpolation regularity, interpolating them if they
+         * are not already.
+         *
+         * @param cdf_times The interned CDF times.
+         * @param cdf_cumulative_freqs The interned CDF cumulative frequencies.
+         * @param regularity_seconds The interpolation regularity.
+         * @param interpolate Interpolates the regularized ordinates, which it needn't intern.
+         * @return The shared regularized ordinates.
+         */
+        static std::shared_ptr<const giuh_regularized_ordinates> get_regularized(
+                const ordinates_ptr &cdf_times,
+                const ordinates_ptr &cdf_cumulative_freqs,
+                unsigned int regularity_seconds,
+                const std::function<giuh_regularized_ordinates()> &interpolate);
+
+        /** @return The number of distinct ordinate vectors in the table that are still referenced. */
+        static std::size_t size();
+
+    private:
+
+        static std::uint64_t hash(const std::vector<double> &values);
+
+        /** Drop the expired entries, once the table has doubled in size since it was last swept. */
+        static void sweep_if_grown();
+
+        static std::mutex table_mutex;
+        static std::unordered_multimap<std::uint64_t, std::weak_ptr<const std::vector<double>>> vectors;
+        /**
+         * The regularized ordinates of each CDF, by the addresses of its interned times and frequencies, which can't
+         * be reused while the ordinates keep them.
+         */
+        static std::map<std::tuple<const void *, const void *, unsigned int>,
+                        std::weak_ptr<const giuh_regularized_ordinates>> regularized;
+        static std::size_t sweep_size;
+    };
+}
+
+#endif //NGEN_GIUH_ORDINATE_TABLE_HPP
@@ -1,7 +1,9 @@
 #include <udunits2.h>
+#include <cstring>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <string>
 #include "all.h"
 
 #ifndef NGEN_UNITSHELPER_H
@@ -11,6 +13,62 @@ class UnitsHelper {
 
     public:
 
+    /**
+     * @brief A conversion between two units, resolved once so each use is a plain call, without locking or lookups.
+     *
+     * Converters are cheap to copy and may be used from several threads at once.  A default constructed converter, like
+     * one between identical units, leaves values unchanged.
+     *
+     * @code {.cpp}
+     * UnitsHelper::Converter to_mm = UnitsHelper::get_units_converter("m", "mm");
+     * double depth_mm = to_mm.convert(depth_m);
+     * @endcode
+     */
+    class Converter {
+        public:
+
+        Converter() = default;
+
+        /** Whether values are left unchanged, so callers may skip the conversion, e.g. read a value in place. */
+        bool is_identity() const { return converter == nullptr; }
+
+        double convert(double value) const
+        {
+            return converter == nullptr ? value : cv_convert_double(converter.get(), value);
+        }
+
+        /**
+         * @brief Convert @p count values, which may be converted in place by passing the same buffer twice.
+         *
+         * @return @p out_values
+         */
+        double* convert(const double* in_values, double* out_values, size_t count) const
+        {
+            if(converter != nullptr){
+                return cv_convert_doubles(converter.get(), in_values, count, out_values);
+            }
+            if(in_values != out_values){
+                std::memcpy(out_values, in_values, sizeof(double)*count);
+            }
+            return out_values;
+        }
+
+        private:
+
+        friend class UnitsHelper;
+
+        explicit Converter(std::shared_ptr<cv_converter> converter) : converter(std::move(converter)) {}
+
+        std::shared_ptr<cv_converter> converter;
+    };
+
+    /**
+     * @brief Resolve the conversion from @p in_units to @p out_units, e.g. once while setting up a formulation.
+     *
+     * @throws std::runtime_error If either units can't be parsed, or they can't be converted to each other.
+     */
+    static Converter get_units_converter(const std::string &in_units, const std::string &out_units);
+
     static double get_converted_value(const std::string &in_units, const double &value, const std::string &out_units);
 
     static double* convert_values(const std::string &in_units, double* values, const std::string &out_units, double* out_values, const size_t & count);
@@ -39,6 +97,9 @@ class UnitsHelper {
         #endif
     }
 
+    // Converters recently used by get_converted_value and convert_values on the calling thread
+    static const Converter& get_recent_converter(const std::string& in_units, const std::string& out_units);
+
     static std::shared_ptr<cv_converter> get_converter(const std::string& in_units, const std::string& out_units, utEncoding in_encoding = UT_UTF8, utEncoding out_encoding = UT_UTF8 );
 
 };
@@ -1,6 +1,8 @@
 #ifndef NETWORK_H
 #define NETWORK_H
 
+#include <map>
+#include <mutex>
 #include <unordered_map>
 
 #include <boost/graph/adjacency_list.hpp>
@@ -16,6 +18,7 @@
 
 #include <features/Features.hpp>
 #include <FeatureBuilder.hpp>
+#include <IdTable.hpp>
 
 namespace network {
   /**
@@ -182,7 +185,7 @@ namespace network {
         NetworkIndexT::const_reverse_iterator end();
         
         /**
-         * @brief Provides a boost transform_iterator, filtered by @p type , to the topologically ordered graph vertex string id's
+         * @brief The topologically ordered string id's of the graph vertices of type @p type
          * 
          * This function is useful when only interested in a single type of feature.
          * It returns the a topologically ordered set of feature ids.  For example, to print all catchments
@@ -193,25 +196,31 @@ namespace network {
          * }
          * @endcode
          * 
-         * @param type The type of feature to filter for, i.e. 'cat', 'nex'
+         * The ids of each type and order are listed once and then kept, the catchment and nexus ids in topological
+         * order when the network is constructed, so iterating them repeatedly (e.g. every time step) is a plain
+         * vector walk.  It may be called from several threads at once; the lists kept are never changed or moved.
+         * 
+         * @param type The type of feature to filter for, i.e. 'cat', 'nex' (which includes 'tnx')
          * @param order What order to return results in
-         * @return auto 
+         * @return const std::vector<std::string>& The ids, empty if no feature has the prefix @p type
          */
-        auto filter(std::string type, SortOrder order = SortOrder::Topological)
+        const std::vector<std::string>& filter(const std::string& type, SortOrder order = SortOrder::Topological)
         {
-          //todo need to worry about validating input???
-          //if type isn't found as a prefix, this iterator range should be empty,
-          //which is a reasonable semantic
-          return get_sorted_index(order) | boost::adaptors::reversed
-                        | boost::adaptors::transformed([this](int const& i) { return get_id(i); })
-                        | boost::adaptors::filtered([type](std::string const& s) { 
-                          if(type == "nex"){
-                            return s.substr(0,3) == type || s.substr(0,3) == "tnx";
-                          }
-                          return s.substr(0,3) == type; 
-                        });
+          return get_typed_index(type, order).ids;
+        }
 
+        /**
+         * @brief The handles (graph vertex descriptors) of the features @ref filter lists, in the same order
+         * 
+         * @param type The type of feature to filter for, i.e. 'cat', 'nex'
+         * @param order What order to return results in
+         * @return const NetworkIndexT& 
+         */
+        const NetworkIndexT& filter_handles(const std::string& type, SortOrder order = SortOrder::Topological)
+        {
+          return get_typed_index(type, order).handles;
         }
+
         /**
          * @brief Get the string id of a given graph vertex_descriptor @p idx
          * 
@@ -222,6 +231,40 @@ namespace network {
          */
         std::string get_id( Graph::vertex_descriptor idx);
 
+        /**
+         * @brief Get the handle of the feature identified by @p id
+         *
+         * A feature's handle is its graph vertex descriptor, so handles are dense, in the range [0, size()), and can
+         * index vectors of per feature data.
+         *
+         * @param id
+         * @return Graph::vertex_descriptor The handle, or IdTable::npos if @p id is not in the network
+         */
+        Graph::vertex_descriptor get_handle(const std::string& id) const { return ids.find(id); }
+
+        /**
+         * @brief The interning table of the network's feature ids, whose handles are the graph vertex descriptors
+         *
+         * @return const IdTable&
+         */
+        const IdTable& id_table() const { return ids; }
+
+        /**
+         * @brief Get the handles of the origination (upstream) neighbors of the feature with handle @p handle
+         *
+         * @param handle
+         * @return NetworkIndexT
+         */
+        NetworkIndexT get_origination_handles(Graph::vertex_descriptor handle) const;
+
+        /**
+         * @brief Get the handles of the destination (downstream) neighbors of the feature with handle @p handle
+         *
+         * @param handle
+         * @return NetworkIndexT
+         */
+        NetworkIndexT get_destination_handles(Graph::vertex_descriptor handle) const;
+
         /**
          * @brief Get the origination (upstream) ids (immediate neighbors) of all vertices with an edge connecting to @p id
          * 
@@ -230,6 +273,17 @@ namespace network {
          */
         std::vector<std::string> get_origination_ids(std::string id);
 
+        /**
+         * @brief Get the ids of @p ids and of every feature upstream of any of them, i.e. their upstream closure
+         *
+         * The ids are in the order they are reached, walking upstream from @p ids through the origination features
+         * of each; ids not in the network are left out.
+         *
+         * @param ids
+         * @return std::vector<std::string>
+         */
+        std::vector<std::string> get_upstream_ids(const std::vector<std::string>& ids);
+
         /**
          * @brief Get the destination (downstream) ids (immediate neighbors) of all vertices with an edge from @p id
          * 
@@ -245,6 +299,14 @@ namespace network {
          */
         std::size_t size();
 
+        /**
+         * @brief An estimate of the bytes the network holds: its graph, its orders and indices of the features, and
+         * their ids
+         * 
+         * @return std::size_t 
+         */
+        std::size_t get_memory_bytes() const;
+
         /**
          * @brief An iterator pair (begin, end) of the network headwater features
          * 
@@ -259,6 +321,26 @@ namespace network {
          */
         IndexPair tailwaters();
 
+        /**
+         * @brief The maximal unbranched chains of features, e.g. cat -> nex -> cat paths without confluences, as reach groups
+         *
+         * Each group lists its features upstream first.  Each feature but the last flows only to the next one, and each
+         * feature but the first receives flow only from the one before it, so a group can be processed as one unit of
+         * work.  Every feature is in exactly one group, and the groups are in topological order of their first
+         * features, so a group only takes flow from groups before it.
+         *
+         * @return const std::vector<NetworkIndexT>&
+         */
+        const std::vector<NetworkIndexT>& reach_groups() const { return reach_groups_idx; }
+
+        /**
+         * @brief The index in @ref reach_groups of the group of the feature with handle @p handle
+         *
+         * @param handle
+         * @return std::size_t
+         */
+        std::size_t reach_group_of(Graph::vertex_descriptor handle) const { return reach_group_of_idx[handle]; }
+
         /**
          * @brief Print a graphviz (text) representation of the network
          * 
@@ -279,6 +361,11 @@ namespace network {
          */
         void init_indicies();
 
+        /**
+         * @brief Finds the reach groups of the graph, after the topological order is set
+         */
+        void init_reach_groups();
+
         /**
          * @brief Vector of topologically sorted features
          * 
@@ -305,6 +392,13 @@ namespace network {
         //TODO Distributary network??? Has topological "wildcard"
         //Diffusive routing can assume DAG, Dynamic routing cannot
 
+        /**
+         * @brief The features of each reach group, and the reach group of each feature by handle
+         * 
+         */
+        std::vector<NetworkIndexT> reach_groups_idx;
+        std::vector<std::size_t> reach_group_of_idx;
+
         /**
          * @brief The underlying boost::Graph 
          * 
@@ -315,7 +409,49 @@ namespace network {
          * @brief Mapping of identity to graph vertex descriptor
          * 
          */
-        std::unordered_map<std::string, Graph::vertex_descriptor> descriptor_map;
+        IdTable ids;
+
+        /**
+         * @brief The features of one type, in one sort order
+         * 
+         */
+        struct TypedIndex {
+          NetworkIndexT handles;
+          std::vector<std::string> ids;
+        };
+
+        /**
+         * @brief Typed feature lists, by type prefix and sort order, built as they are first requested
+         * 
+         */
+        std::map<std::pair<std::string, SortOrder>, TypedIndex> typed_indices;
+
+        /**
+         * @brief A mutex of a network, which a copy of the network does not share
+         * 
+         */
+        struct IndexMutex {
+          IndexMutex() = default;
+          IndexMutex(const IndexMutex&) {}
+          IndexMutex& operator=(const IndexMutex&) { return *this; }
+          std::mutex mutex;
+        };
+
+        /**
+         * @brief Guards typed_indices, and the orders they are built from, as lists are added by concurrent requests
+         * 
+         */
+        mutable IndexMutex typed_indices_mutex;
+
+        /**
+         * @brief Get the list of the features of type @p type in order @p order, building it if needed
+         */
+        const TypedIndex& get_typed_index(const std::string& type, SortOrder order);
+
+        /**
+         * @brief Get the vertex of @p id, adding it to the graph if it is not already in it
+         */
+        Graph::vertex_descriptor vertex_for(const std::string& id);
         
         /**
          * @brief Get an index of the graph in a particular order.
@@ -0,0 +1,64 @@
+#ifndef HY_DENDRITICNEXUS_H
+#define HY_DENDRITICNEXUS_H
+
+#include <HY_HydroNexus.hpp>
+#include <TimeStepRing.hpp>
+
+#include <mutex>
+#include <vector>
+
+/**
+ * A nexus with at most one receiving catchment, as every nexus of a dendritic network (or a terminal nexus) has.
+ *
+ * It releases the same flows as HY_PointHydroNexus does when its flows are not summed exactly, but without recording
+ * which catchment contributed or requested each of them: each time step in progress only holds the running sum of its
+ * contributions and the percentage of it requested so far, so a time step's flow is a handful of arithmetic operations
+ * and no strings are copied.  HY_Features constructs one for each nexus with at most one receiver unless flows are
+ * summed exactly.
+ */
+class HY_DendriticNexus : public HY_HydroNexus
+{
+    public:
+        HY_DendriticNexus(std::string nexus_id, Catchments receiving_catchments);
+        virtual ~HY_DendriticNexus();
+
+        /** get the request percentage of downstream flow through this nexus at timestep t. */
+        double get_downstream_flow(std::string catchment_id, time_step_t t, double percent_flow) override;
+
+        /** add flow to this nexus for timestep t. */
+        void add_upstream_flow(double val, std::string catchment_id, time_step_t t) override;
+
+        /** inspect a nexus to see what flows are recorded at a time step. */
+        std::pair<double, int> inspect_upstream_flows(time_step_t t) override;
+
+        /** inspect a nexus to see what requests are recorded at a time step. */
+        std::pair<double, int> inspect_downstream_requests(time_step_t t) override;
+
+        /** get the units that flows are represented in. */
+        std::string get_flow_units() override;
+
+        void set_mintime(time_step_t t) override;
+
+        std::size_t get_memory_bytes() override;
+
+    private:
+
+    /** The flow of a single time step in progress. */
+    struct TimeStepFlows {
+        double summed_flow{0.0};
+        int num_upstream{0};
+        double total_request{0.0};
+        int num_requests{0};
+
+        void reset() { *this = TimeStepFlows(); }
+    };
+    using TimeStepSlot = TimeStepRing<TimeStepFlows>::Slot;
+
+    /** The flows of the time steps in progress. */
+    TimeStepRing<TimeStepFlows> slots;
+
+    /** Guards the flows so contributing catchments may add them from concurrent threads. */
+    std::mutex bookkeeping_mutex;
+};
+
+#endif // HY_DENDRITICNEXUS_H
@@ -40,6 +40,13 @@ class HY_HydroNexus
 
     /** get the units that the flows are described in */
     virtual std::string get_flow_units()=0;
+
+    /** Note that no flows will be added or requested before timestep t, e.g., in a run restarted at t, so the
+        bookkeeping of earlier time steps need not be kept. */
+    virtual void set_mintime(time_step_t t) {}
+
+    /** @return An estimate of the bytes held by this nexus's flow bookkeeping (see utils::MemoryReport). */
+    virtual std::size_t get_memory_bytes() = 0;
     
     const Catchments& get_receiving_catchments() {
         return receiving_catchments;
@@ -2,9 +2,11 @@
 #define HY_POINTHYDRONEXUS_H
 
 #include <HY_HydroNexus.hpp>
+#include <ExactSum.hpp>
+#include <TimeStepRing.hpp>
 
-#include <unordered_map>
-#include <unordered_set>
+#include <mutex>
+#include <vector>
 
 class HY_PointHydroNexus : public HY_HydroNexus
 {
@@ -28,20 +30,64 @@ class HY_PointHydroNexus : public HY_HydroNexus
         /** get the units that flows are represented in. */
         std::string get_flow_units();
 
-        void set_mintime(time_step_t);
+        void set_mintime(time_step_t t) override;
+
+        /**
+         * Set whether the flows of each time step are summed exactly, and so to the same value whatever order they
+         * were added in, e.g., by concurrent threads or as remote flows arrive, rather than in the order they were
+         * added.  The default is to sum them in the order they were added.
+         */
+        void set_exact_summation(bool is_exact);
+
+        std::size_t get_memory_bytes() override;
 
     protected:
     using flows = std::pair<std::string, double>;
     using flow_vector = std::vector< flows >;
 
-    /** The current downstream flow through this Point Nexus.*/
-    std::unordered_map<time_step_t, flow_vector > upstream_flows;
-    std::unordered_map<time_step_t, flow_vector > downstream_requests;
-    std::unordered_map<time_step_t, double> summed_flows;
-    std::unordered_map<time_step_t, double> total_requests;
+    /**
+     * The flow bookkeeping of a single time step.
+     *
+     * Contributions and requests are counted into vectors that are kept, with their capacity, when the slot is
+     * reused for a later time step, so the bookkeeping of a nexus does no allocation once its slots are warm.
+     */
+    struct TimeStepFlows {
+        /** The first num_upstream entries are the contributions for the time step. */
+        flow_vector upstream;
+        std::size_t num_upstream{0};
+        /** The first num_requests entries are the downstream requests for the time step. */
+        flow_vector requests;
+        std::size_t num_requests{0};
+        bool summed{false};
+        double summed_flow{0.0};
+        double total_request{0.0};
+
+        void reset()
+        {
+            num_upstream = 0;
+            num_requests = 0;
+            summed = false;
+            summed_flow = 0.0;
+            total_request = 0.0;
+        }
+    };
+    using TimeStepSlot = TimeStepRing<TimeStepFlows>::Slot;
+
+    /** Sum the contributions of a slot, exactly if set to. Callers must hold bookkeeping_mutex. */
+    double sum_upstream_flows(const TimeStepSlot& slot);
+
+    /** Whether flows for time step t have been added by each of catchment_ids. */
+    bool has_upstream_flows_from(const Catchments& catchment_ids, time_step_t t);
+
+    /** The bookkeeping of the time steps in progress. */
+    TimeStepRing<TimeStepFlows> slots;
+
+    /** Guards the flow bookkeeping so contributing catchments may add flows from concurrent threads. */
+    std::mutex bookkeeping_mutex;
 
-    time_step_t min_timestep{0};
-    std::unordered_set<time_step_t> completed;
+    /** Whether flows are summed exactly (see set_exact_summation), with exact_sum, which keeps its memory. */
+    bool is_exact_summation{false};
+    utils::ExactSum exact_sum;
 
 };
 
@@ -4,10 +4,14 @@
 #ifdef NGEN_MPI_ACTIVE
 
 #include <HY_PointHydroNexus.hpp>
+#include <RemoteNexusExchange.hpp>
+#include <RemoteLocationIndex.hpp>
 #include <mpi.h>
+#include <chrono>
 #include <vector>
 
 #include <unordered_map>
+#include <unordered_set>
 #include <string>
 
 
@@ -26,18 +30,51 @@ class HY_PointHydroNexusRemote : public HY_PointHydroNexus
 
         typedef std::unordered_map <std::string, long> catcment_location_map_t;
 
-        HY_PointHydroNexusRemote(std::string nexus_id, Catchments receiving_catchments, catcment_location_map_t loc_map);
-        HY_PointHydroNexusRemote(std::string nexus_id, Catchments receiving_catchments, Catchments contributing_catchments, catcment_location_map_t loc_map);
+        /** The shared index of the ranks of remote catchments, which one partition's remote nexuses all reference */
+        typedef std::shared_ptr<const RemoteLocationIndex> location_index_t;
+
+        HY_PointHydroNexusRemote(std::string nexus_id, Catchments receiving_catchments, location_index_t loc_index);
+        HY_PointHydroNexusRemote(std::string nexus_id, Catchments receiving_catchments, Catchments contributing_catchments, location_index_t loc_index);
+
+        /** Construct a nexus with an index of its own, made from @p loc_map */
+        HY_PointHydroNexusRemote(std::string nexus_id, Catchments receiving_catchments, const catcment_location_map_t& loc_map);
+        HY_PointHydroNexusRemote(std::string nexus_id, Catchments receiving_catchments, Catchments contributing_catchments, const catcment_location_map_t& loc_map);
 
         virtual ~HY_PointHydroNexusRemote();
 
         /** get the request percentage of downstream flow through this nexus at timestep t. If the indicated catchment is not local a async send will be
-            created. Will attempt to process all async recieves currently queued before processing flows*/
+            created. Will attempt to process all async recieves currently queued before processing flows.
+            When attached to a RemoteNexusExchange, remote flows must instead have been received by its exchange for timestep t*/
         double get_downstream_flow(std::string catchment_id, time_step_t t, double percent_flow);
 
-        /** add flow to this nexus for timestep t. If the indicated catchment is not local an async receive will be started*/
+        /** add flow to this nexus for timestep t. If the indicated catchment is not local an async receive will be started.
+            When attached to a RemoteNexusExchange, flows to send downstream are staged with it rather than sent*/
         void add_upstream_flow(double val, std::string catchment_id, time_step_t t);
 
+        /** Use a RemoteNexusExchange to batch the communication of this nexus with other ranks, instead of messaging directly */
+        void set_exchange(RemoteNexusExchange* exchange) { this->exchange = exchange; }
+
+        /** add a flow received from a remote contributer of this nexus for timestep t, e.g. by a RemoteNexusExchange */
+        void add_remote_flow(double val, time_step_t t) { HY_PointHydroNexus::add_upstream_flow(val, id, t); }
+
+        /** Complete the outstanding communications of all the given nexuses together, e.g. at the end of a run before
+            they are destroyed. Requests of every nexus are tested as one set until they have all completed, received
+            flows are added as usual, and if some remain after timeout each stuck nexus, with its rank and the ranks it
+            is waiting on, is reported to std::cerr. Every rank should drain its nexuses before MPI_Finalize.
+            Returns whether every communication completed. */
+        static bool drain_communications(const std::vector<HY_PointHydroNexusRemote*>& nexuses,
+                                         std::chrono::milliseconds timeout = std::chrono::milliseconds(120000));
+
+        /** the ranks this nexus sends flow to */
+        const std::unordered_set<int>& get_downstream_ranks() const { return downstream_ranks; }
+
+        /** the ranks this nexus receives flow from */
+        const std::unordered_set<int>& get_upstream_ranks() const { return upstream_ranks; }
+
+        /** the number of receives and sends this nexus has posted that have not yet been seen to complete */
+        std::size_t get_pending_receive_count() const { return stored_recieves.size(); }
+        std::size_t get_pending_send_count() const { return stored_sends.size(); }
+
         /** extract a numeric id from the catchment id for use as a mpi tag */
         static long extract(std::string s) {  return std::stoi(s.substr(4)); }
         
@@ -74,11 +111,11 @@ class HY_PointHydroNexusRemote : public HY_PointHydroNexus
 
         long time_step;
 
-        catcment_location_map_t catchment_id_to_mpi_rank;
+        /** The ranks of the remote catchments, shared with the other remote nexuses of this rank */
+        location_index_t catchment_id_to_mpi_rank;
 
-        // Create the datatype
-        MPI_Datatype time_step_and_flow_type;
-        MPI_Datatype time_step_and_flow_precent_type;
+        /** The datatype of a time_step_and_flow_t message, committed once for all nexuses */
+        static MPI_Datatype get_time_step_and_flow_type();
 
         struct time_step_and_flow_t
         {
@@ -95,6 +132,8 @@ class HY_PointHydroNexusRemote : public HY_PointHydroNexus
 
         std::list<async_request> stored_recieves;
         std::list<async_request> stored_sends;
+        /** Whether a drain gave up on this nexus's communications, so destroying it should not wait on them again */
+        bool drain_timed_out = false;
 
         std::string nexus_prefix = "cat-";
         
@@ -102,6 +141,10 @@ class HY_PointHydroNexusRemote : public HY_PointHydroNexus
          *
          */
         communication_type type;
+        /** The exchange batching this nexus's communication, if any
+         *
+         */
+        RemoteNexusExchange* exchange = nullptr;
         /** List of ranks we expect to send data to (downstream).
          *
          *  Note that in a dendridic network, downstream_ranks.size() == 1 (only one downstream receiver on a single rank)
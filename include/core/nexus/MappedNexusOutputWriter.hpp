@@ -0,0 +1,198 @@
+#ifndef NGEN_MAPPED_NEXUS_OUTPUT_WRITER_HPP
+#define NGEN_MAPPED_NEXUS_OUTPUT_WRITER_HPP
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "NexusOutputWriter.hpp"
+
+namespace nexus_output
+{
+    /**
+     * @brief Keeps the flows of all nexuses in a memory mapped file, laid out along the simulation's output times.
+     *
+     * The file has a row of every output time step of the run for each nexus, so the flow of nexus ``n`` at time
+     * step index ``t`` is at ``get_flows()[n * get_row_stride() + t]``, and writing a flow is a store into the
+     * mapping.  Nothing is buffered in the process: the kernel writes the dirty pages back and may drop those of
+     * steps long past, so a long run of many nexuses needs no more memory than the pages it is writing.  In-process
+     * consumers such as routing read the flows in place, without copying.
+     *
+     * All values are in the host's native byte order.  The file begins with a header of:
+     *
+     *  - the 8 characters ``NGENMAP1``;
+     *  - the number of nexuses, as a ``uint64_t``;
+     *  - the number of time steps of each row, as a ``uint64_t``;
+     *  - the number of time steps completed so far, as a ``uint64_t``;
+     *  - the byte offset of the flows, a whole number of pages, as a ``uint64_t``;
+     *  - each nexus id, as a ``uint32_t`` length followed by its characters.
+     *
+     * followed, at the offset, by the flows as ``double`` values, nexus major.  Flows of steps not yet completed are
+     * 0.  Since every step has a fixed place, a run restarted from a checkpoint can keep the file of the run it
+     * restarts, along with the flows of the steps before the checkpoint, and write the rest of the steps into it.
+     */
+    class MappedNexusOutputWriter : public NexusOutputWriter
+    {
+      public:
+
+        /**
+         * @param nexus_ids The ids of the nexuses to write flows for.
+         * @param path The path of the output file.
+         * @param total_steps The number of output time steps of the run.
+         * @param keep_existing Whether to keep the flows of a file already at @p path, if it has the same nexuses
+         *                      and time steps; otherwise it is replaced.
+         * @throws std::runtime_error If the file cannot be created or mapped.
+         */
+        MappedNexusOutputWriter(const std::vector<std::string>& nexus_ids, const std::string& path,
+                                std::size_t total_steps, bool keep_existing = false)
+            : NexusOutputWriter(nexus_ids), num_steps(total_steps)
+        {
+            std::string header = encode_header(nexus_ids, total_steps);
+            std::size_t page_size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+            std::size_t data_offset = (header.size() + page_size - 1) / page_size * page_size;
+            std::memcpy(&header[DATA_OFFSET_POSITION], &data_offset, sizeof(uint64_t));
+            mapped_bytes = data_offset + nexus_ids.size() * total_steps * sizeof(double);
+
+            fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+            if (fd < 0) {
+                throw std::runtime_error("MappedNexusOutputWriter: unable to open " + path + ": " + std::strerror(errno));
+            }
+            reopened = keep_existing && has_header(header);
+            if (!reopened && (::ftruncate(fd, 0) != 0 || ::ftruncate(fd, static_cast<off_t>(mapped_bytes)) != 0
+                              || ::pwrite(fd, header.data(), header.size(), 0) != static_cast<ssize_t>(header.size()))) {
+                fail("unable to create " + path);
+            }
+            void* mapped = ::mmap(nullptr, mapped_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (mapped == MAP_FAILED) {
+                fail("unable to map " + path);
+            }
+            memory = static_cast<char*>(mapped);
+            flows = reinterpret_cast<double*>(memory + data_offset);
+        }
+
+        virtual ~MappedNexusOutputWriter()
+        {
+            ::munmap(memory, mapped_bytes);
+            ::close(fd);
+        }
+
+        MappedNexusOutputWriter(const MappedNexusOutputWriter&) = delete;
+        MappedNexusOutputWriter& operator=(const MappedNexusOutputWriter&) = delete;
+
+        /**
+         * @throws std::out_of_range If @p time_index is not one of the run's output time steps.
+         */
+        void write(const std::string& nexus_id, long time_index, const std::string& timestamp, double flow) override
+        {
+            std::size_t index = index_of(nexus_id);
+            if (time_index < 0 || static_cast<std::size_t>(time_index) >= num_steps) {
+                throw std::out_of_range("MappedNexusOutputWriter: time step " + std::to_string(time_index)
+                                        + " is outside the " + std::to_string(num_steps) + " steps of the file");
+            }
+            flows[index * num_steps + time_index] = flow;
+        }
+
+        void complete_time_step(long time_index, const std::string& timestamp) override
+        {
+            uint64_t completed = static_cast<uint64_t>(time_index + 1);
+            std::memcpy(memory + COMPLETED_POSITION, &completed, sizeof(uint64_t));
+        }
+
+        /**
+         * @brief Write the file's dirty pages back, waiting for them, e.g., so it is complete up to a checkpoint.
+         *
+         * @throws std::runtime_error If writing back fails.
+         */
+        void flush() override
+        {
+            if (::msync(memory, mapped_bytes, MS_SYNC) != 0) {
+                throw std::runtime_error(std::string("MappedNexusOutputWriter: unable to write back the file: ")
+                                         + std::strerror(errno));
+            }
+        }
+
+        /** @return The flows of every nexus and time step, laid out as described for the class. */
+        const double* get_flows() const { return flows; }
+
+        /** @return The distance between the flows of consecutive nexuses in @ref get_flows, the run's time steps. */
+        std::size_t get_row_stride() const { return num_steps; }
+
+        /**
+         * @return One past the last time step completed, including those kept from the file of a restarted run.
+         */
+        std::size_t get_completed_steps() const
+        {
+            uint64_t completed;
+            std::memcpy(&completed, memory + COMPLETED_POSITION, sizeof(uint64_t));
+            return static_cast<std::size_t>(completed);
+        }
+
+        /** @return Whether the flows of an existing file were kept, rather than the file being replaced. */
+        bool was_reopened() const { return reopened; }
+
+        /** @return The header of the format, for @p nexus_ids and @p total_steps, with no steps completed. */
+        static std::string encode_header(const std::vector<std::string>& nexus_ids, std::size_t total_steps)
+        {
+            std::string bytes("NGENMAP1", 8);
+            append_value<uint64_t>(bytes, nexus_ids.size());
+            append_value<uint64_t>(bytes, total_steps);
+            append_value<uint64_t>(bytes, 0);
+            append_value<uint64_t>(bytes, 0);
+            for (const auto& id : nexus_ids) {
+                append_value<uint32_t>(bytes, id.size());
+                bytes.append(id);
+            }
+            return bytes;
+        }
+
+      private:
+
+        static constexpr std::size_t COMPLETED_POSITION = 24;
+        static constexpr std::size_t DATA_OFFSET_POSITION = 32;
+
+        template<typename T>
+        static void append_value(std::string& bytes, T value)
+        {
+            bytes.append(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        /** @return Whether the open file is of the size of the mapping and starts with @p header, but for its steps. */
+        bool has_header(const std::string& header) const
+        {
+            struct stat info;
+            if (::fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) != mapped_bytes) {
+                return false;
+            }
+            std::string existing(header.size(), '\0');
+            if (::pread(fd, &existing[0], existing.size(), 0) != static_cast<ssize_t>(existing.size())) {
+                return false;
+            }
+            existing.replace(COMPLETED_POSITION, sizeof(uint64_t), header, COMPLETED_POSITION, sizeof(uint64_t));
+            return existing == header;
+        }
+
+        [[noreturn]] void fail(const std::string& message)
+        {
+            std::string reason = std::strerror(errno);
+            ::close(fd);
+            throw std::runtime_error("MappedNexusOutputWriter: " + message + ": " + reason);
+        }
+
+        std::size_t num_steps;
+        std::size_t mapped_bytes;
+        int fd;
+        bool reopened;
+        char* memory = nullptr;
+        double* flows = nullptr;
+    };
+}
+
+#endif //NGEN_MAPPED_NEXUS_OUTPUT_WRITER_HPP
@@ -0,0 +1,104 @@
+#ifdef NETCDF_ACTIVE
+#ifndef NGEN_NETCDF_NEXUS_OUTPUT_WRITER_HPP
+#define NGEN_NETCDF_NEXUS_OUTPUT_WRITER_HPP
+
+#include "NexusOutputWriter.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <netcdf>
+
+namespace nexus_output
+{
+    /**
+     * @brief Writes the flows of all nexuses to a single chunked NetCDF-4 file.
+     *
+     * The file has a fixed ``nexus`` dimension and an unlimited ``time`` dimension, with variables:
+     *
+     *  - ``ids(nexus)``, the nexus id strings;
+     *  - ``time_index(time)`` and ``timestamp(time)``, identifying each output time step;
+     *  - ``flow(nexus, time)``, the downstream flow of each nexus in m^3/s.
+     *
+     * ``flow`` is chunked with the buffered number of time steps along ``time``, so each bulk write fills whole chunks.
+     */
+    class NetCDFNexusOutputWriter : public BufferedNexusOutputWriter
+    {
+      public:
+
+        /**
+         * @param nexus_ids The ids of the nexuses to write flows for.
+         * @param path The path of the output file.
+         * @param buffer_steps The number of complete time steps to gather before writing.
+         */
+        NetCDFNexusOutputWriter(const std::vector<std::string>& nexus_ids, const std::string& path,
+                                std::size_t buffer_steps)
+            : BufferedNexusOutputWriter(nexus_ids, buffer_steps),
+              file(path, netCDF::NcFile::replace, netCDF::NcFile::nc4),
+              written_steps(0)
+        {
+            netCDF::NcDim nexus_dim = file.addDim("nexus", nexus_ids.size());
+            netCDF::NcDim time_dim = file.addDim("time");
+
+            netCDF::NcVar id_var = file.addVar("ids", netCDF::ncString, nexus_dim);
+            for (std::size_t i = 0; i < nexus_ids.size(); ++i) {
+                id_var.putVar({i}, nexus_ids[i]);
+            }
+            time_index_var = file.addVar("time_index", netCDF::ncInt64, time_dim);
+            timestamp_var = file.addVar("timestamp", netCDF::ncString, time_dim);
+
+            flow_var = file.addVar("flow", netCDF::ncDouble, {nexus_dim, time_dim});
+            std::vector<size_t> chunks = {std::max<std::size_t>(1, std::min<std::size_t>(nexus_ids.size(), 4096)),
+                                          std::max<std::size_t>(1, buffer_steps)};
+            flow_var.setChunking(netCDF::NcVar::nc_CHUNKED, chunks);
+            flow_var.setFill(true, std::numeric_limits<double>::quiet_NaN());
+            flow_var.putAtt("units", "m3 s-1");
+        }
+
+        virtual ~NetCDFNexusOutputWriter()
+        {
+            flush();
+            file.close();
+        }
+
+      protected:
+
+        void write_block(const std::vector<long>& time_indices, const std::vector<std::string>& timestamps,
+                         const std::vector<double>& flows) override
+        {
+            std::size_t num_nexuses = nexus_ids.size();
+            std::size_t num_steps = time_indices.size();
+
+            for (std::size_t s = 0; s < num_steps; ++s) {
+                long long time_index = time_indices[s];
+                time_index_var.putVar({written_steps + s}, &time_index);
+                timestamp_var.putVar({written_steps + s}, timestamps[s]);
+            }
+
+            // The block is step major, and the variable is nexus major
+            std::vector<double> transposed(flows.size());
+            for (std::size_t s = 0; s < num_steps; ++s) {
+                for (std::size_t n = 0; n < num_nexuses; ++n) {
+                    transposed[n * num_steps + s] = flows[s * num_nexuses + n];
+                }
+            }
+            if (num_nexuses > 0) {
+                flow_var.putVar({0, written_steps}, {num_nexuses, num_steps}, transposed.data());
+            }
+            written_steps += num_steps;
+            file.sync();
+        }
+
+      private:
+        netCDF::NcFile file;
+        netCDF::NcVar time_index_var;
+        netCDF::NcVar timestamp_var;
+        netCDF::NcVar flow_var;
+        std::size_t written_steps;
+    };
+}
+
+#endif //NGEN_NETCDF_NEXUS_OUTPUT_WRITER_HPP
+#endif //NETCDF_ACTIVE
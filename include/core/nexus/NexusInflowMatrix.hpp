@@ -0,0 +1,116 @@
+#ifndef NGEN_NEXUS_INFLOW_MATRIX_HPP
+#define NGEN_NEXUS_INFLOW_MATRIX_HPP
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "ExactSum.hpp"
+
+namespace nexus_output
+{
+    /**
+     * @brief The incidence of catchments on the nexuses they drain to, as a compressed sparse row (CSR) matrix.
+     *
+     * Each row is a nexus and each column a catchment, so multiplying the matrix by the vector of catchment flows
+     * gives the inflow of every nexus in one pass over a flat index array, rather than a bookkeeping call for each
+     * contribution.  The columns of a row are kept in the order they were given, so each nexus sums its flows in
+     * that order, exactly as the same contributions added one at a time would be summed.  With
+     * @ref set_exact_summation, rows are instead summed exactly, to the same value however their columns are ordered.
+     */
+    class NexusInflowMatrix
+    {
+      public:
+
+        NexusInflowMatrix() : row_starts(1, 0) {}
+
+        /**
+         * @param column_rows For each column, in the order it is to be summed in, its row, or ``-1`` for none.
+         * @param row_count The number of rows.
+         * @throws std::out_of_range If a column's row is not below @p row_count.
+         */
+        NexusInflowMatrix(const std::vector<long>& column_rows, std::size_t row_count) : row_starts(row_count + 1, 0)
+        {
+            for (long row : column_rows) {
+                if (row >= static_cast<long>(row_count)) {
+                    throw std::out_of_range("NexusInflowMatrix: row " + std::to_string(row) + " is not below the "
+                                            + std::to_string(row_count) + " rows");
+                }
+                if (row >= 0) {
+                    ++row_starts[row + 1];
+                }
+            }
+            for (std::size_t r = 0; r < row_count; ++r) {
+                row_starts[r + 1] += row_starts[r];
+            }
+            columns.resize(row_starts.back());
+            std::vector<std::size_t> next(row_starts.begin(), row_starts.end() - 1);
+            for (std::size_t c = 0; c < column_rows.size(); ++c) {
+                if (column_rows[c] >= 0) {
+                    columns[next[column_rows[c]]++] = c;
+                }
+            }
+        }
+
+        /** @return The number of rows. */
+        std::size_t rows() const
+        {
+            return row_starts.size() - 1;
+        }
+
+        /** @return The columns of a row, from @ref row_begin up to @ref row_end, in summing order. */
+        const std::size_t* row_begin(std::size_t row) const
+        {
+            return columns.data() + row_starts[row];
+        }
+
+        const std::size_t* row_end(std::size_t row) const
+        {
+            return columns.data() + row_starts[row + 1];
+        }
+
+        /** Set whether rows are summed exactly (see utils::ExactSum), rather than in the order of their columns. */
+        void set_exact_summation(bool is_exact)
+        {
+            is_exact_summation = is_exact;
+        }
+
+        /**
+         * @brief Multiply rows of the matrix by a vector: ``y[r] = sum of x[c]`` over the columns ``c`` of each row.
+         *
+         * Rows are independent, so distinct ranges of them may be multiplied concurrently.
+         *
+         * @param x The value of each column.
+         * @param y Receives the value of each row in [first_row, last_row).
+         */
+        void multiply(const double* x, double* y, std::size_t first_row, std::size_t last_row) const
+        {
+            if (is_exact_summation) {
+                utils::ExactSum sum;
+                for (std::size_t r = first_row; r < last_row; ++r) {
+                    sum.clear();
+                    for (std::size_t k = row_starts[r]; k < row_starts[r + 1]; ++k) {
+                        sum.add(x[columns[k]]);
+                    }
+                    y[r] = sum.get_sum();
+                }
+                return;
+            }
+            for (std::size_t r = first_row; r < last_row; ++r) {
+                double sum {};
+                for (std::size_t k = row_starts[r]; k < row_starts[r + 1]; ++k) {
+                    sum += x[columns[k]];
+                }
+                y[r] = sum;
+            }
+        }
+
+      private:
+        std::vector<std::size_t> row_starts;
+        std::vector<std::size_t> columns;
+        bool is_exact_summation = false;
+    };
+}
+
+#endif // NGEN_NEXUS_INFLOW_MATRIX_HPP
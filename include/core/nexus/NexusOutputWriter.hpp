@@ -0,0 +1,526 @@
+#ifndef NGEN_NEXUS_OUTPUT_WRITER_HPP
+#define NGEN_NEXUS_OUTPUT_WRITER_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "CompressedOutputStream.hpp"
+#include "FramePublisher.hpp"
+#include "NumberFormat.hpp"
+
+namespace nexus_output
+{
+    /**
+     * @brief Sink for the per time step downstream flows of a fixed set of nexuses.
+     *
+     * Each nexus is expected to have exactly one flow written for each time step.  Implementations must allow
+     * concurrent calls to @ref write for different nexuses.
+     */
+    class NexusOutputWriter
+    {
+      public:
+
+        /**
+         * @param nexus_ids The ids of every nexus this writer will receive flows for, which fixes their output order.
+         */
+        NexusOutputWriter(const std::vector<std::string>& nexus_ids) : nexus_ids(nexus_ids)
+        {
+            for (std::size_t i = 0; i < nexus_ids.size(); ++i) {
+                nexus_index.emplace(nexus_ids[i], i);
+            }
+        }
+
+        virtual ~NexusOutputWriter(){}
+
+        /**
+         * @brief Record the downstream flow of a nexus at a time step.
+         *
+         * @param nexus_id The nexus, which must be one of the ids the writer was constructed with.
+         * @param time_index The output time step index.
+         * @param timestamp The formatted timestamp of @p time_index.
+         * @param flow The downstream flow of the nexus, in m^3/s.
+         */
+        virtual void write(const std::string& nexus_id, long time_index, const std::string& timestamp, double flow) = 0;
+
+        /**
+         * @brief Note that the flows of every nexus have been written for a time step.
+         *
+         * This is called once for each time step by the time step loop, where every feature runs the same time step,
+         * after the last @ref write of the step.  Writers that need no more than the writes themselves, which is all
+         * but those that coordinate their writes across MPI ranks, can ignore it.
+         *
+         * @param time_index The output time step index.
+         * @param timestamp The formatted timestamp of @p time_index.
+         */
+        virtual void complete_time_step(long time_index, const std::string& timestamp) {}
+
+        /**
+         * @brief Write out anything that is buffered.
+         */
+        virtual void flush() = 0;
+
+        /**
+         * @brief Write out anything that is buffered, at the end of the run, after which nothing more is written.
+         *
+         * Writers that coordinate their writes across MPI ranks close their output collectively here, rather than when
+         * destroyed, so every rank must call it; the others just flush.
+         */
+        virtual void close() { flush(); }
+
+        /**
+         * @return The nexus ids, in their output order.
+         */
+        const std::vector<std::string>& get_nexus_ids() const { return nexus_ids; }
+
+      protected:
+
+        /**
+         * @return The output position of @p nexus_id.
+         * @throws std::invalid_argument If the writer was not constructed with @p nexus_id.
+         */
+        std::size_t index_of(const std::string& nexus_id) const
+        {
+            auto it = nexus_index.find(nexus_id);
+            if (it == nexus_index.end()) {
+                throw std::invalid_argument("NexusOutputWriter: no output configured for nexus " + nexus_id);
+            }
+            return it->second;
+        }
+
+        std::vector<std::string> nexus_ids;
+        std::unordered_map<std::string, std::size_t> nexus_index;
+    };
+
+    /**
+     * @brief Writes each nexus's flows to its own ``<id>_output.csv`` file.
+     *
+     * Rows are ``time_index, timestamp, flow``, which is the layout expected by the routing integration.  Each file
+     * keeps its own stream, so writes for different nexuses never share state.  Uncompressed files can be given a
+     * buffer larger than a file stream's, so each is written in a few large writes of many time steps of rows.
+     */
+    class CsvPerNexusOutputWriter : public NexusOutputWriter
+    {
+      public:
+
+        /**
+         * @param nexus_ids The ids of the nexuses to create output files for.
+         * @param path_prefix Prefix (typically a directory ending with ``/``) of each output file name.
+         * @param compression How the files are compressed, if at all, which adds its suffix to their names.
+         * @param compression_level The level of @p compression, or a negative value for the library's default.
+         * @param buffer_bytes The buffer of each uncompressed file, or ``0`` for that of a file stream.
+         */
+        CsvPerNexusOutputWriter(const std::vector<std::string>& nexus_ids, const std::string& path_prefix,
+                                utils::Compression compression = utils::Compression::none, int compression_level = -1,
+                                std::size_t buffer_bytes = 0)
+            : NexusOutputWriter(nexus_ids), outfiles(nexus_ids.size())
+        {
+            for (std::size_t i = 0; i < nexus_ids.size(); ++i) {
+                outfiles[i] = utils::open_output_file(path_prefix + nexus_ids[i] + "_output.csv", compression,
+                                                      compression_level, buffer_bytes);
+                if (!*outfiles[i]) {
+                    throw std::runtime_error("CsvPerNexusOutputWriter: unable to open output file for nexus " + nexus_ids[i]);
+                }
+            }
+        }
+
+        virtual ~CsvPerNexusOutputWriter(){}
+
+        void write(const std::string& nexus_id, long time_index, const std::string& timestamp, double flow) override
+        {
+            // Formatted as the stream would, but without it, and then let the stream buffer rows, rather than flushing
+            // each one
+            std::string row = std::to_string(time_index);
+            row.append(", ").append(timestamp).append(", ");
+            utils::number_format::append_general(row, flow).push_back('\n');
+            outfiles[index_of(nexus_id)]->write(row.data(), row.size());
+        }
+
+        void flush() override
+        {
+            for (auto& outfile : outfiles) {
+                outfile->flush();
+            }
+        }
+
+      private:
+        /** The file of each nexus, which compressed files are only complete in once the writer is destroyed. */
+        std::vector<std::shared_ptr<std::ostream>> outfiles;
+    };
+
+    /**
+     * @brief Base for writers that gather all nexus flows for a number of time steps before writing them in bulk.
+     *
+     * Flows may arrive in any order, e.g., from several threads, or with some nexuses running ahead of others.  Once
+     * every nexus has a flow for a time step (and for all steps before it), the step is moved to the current block,
+     * and once the block holds the configured number of steps it is handed to @ref write_block.
+     */
+    class BufferedNexusOutputWriter : public NexusOutputWriter
+    {
+      public:
+
+        /**
+         * @param nexus_ids The ids of the nexuses to write flows for.
+         * @param buffer_steps The number of complete time steps to gather before each @ref write_block.
+         */
+        BufferedNexusOutputWriter(const std::vector<std::string>& nexus_ids, std::size_t buffer_steps)
+            : NexusOutputWriter(nexus_ids), buffer_steps(buffer_steps > 0 ? buffer_steps : 1), next_step(0)
+        { }
+
+        virtual ~BufferedNexusOutputWriter(){}
+
+        void write(const std::string& nexus_id, long time_index, const std::string& timestamp, double flow) override
+        {
+            std::size_t index = index_of(nexus_id);
+            std::lock_guard<std::mutex> lock(mutex);
+            if (time_index < next_step) {
+                throw std::runtime_error("BufferedNexusOutputWriter: flow for nexus " + nexus_id + " at time step "
+                                         + std::to_string(time_index) + " arrived after that step was written");
+            }
+            auto it = pending.find(time_index);
+            if (it == pending.end()) {
+                it = pending.emplace(time_index, PendingStep(timestamp, nexus_ids.size())).first;
+            }
+            it->second.flows[index] = flow;
+            it->second.received++;
+
+            // Move any run of completed steps into the block
+            while (!pending.empty() && pending.begin()->first == next_step
+                   && pending.begin()->second.received >= nexus_ids.size()) {
+                append_to_block(pending.begin()->first, pending.begin()->second);
+                pending.erase(pending.begin());
+                ++next_step;
+                if (block_time_indices.size() >= buffer_steps) {
+                    write_current_block();
+                }
+            }
+        }
+
+        /**
+         * @brief Write every buffered step, including incomplete ones, whose missing flows are written as NaN.
+         */
+        void flush() override
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (const auto& step : pending) {
+                append_to_block(step.first, step.second);
+                next_step = step.first + 1;
+            }
+            pending.clear();
+            if (!block_time_indices.empty()) {
+                write_current_block();
+            }
+        }
+
+      protected:
+
+        /**
+         * @brief Write a block of time steps to the underlying output.
+         *
+         * Called with the writer's lock held, so implementations need no synchronization of their own.
+         *
+         * @param time_indices The time step index of each step in the block, in increasing order.
+         * @param timestamps The timestamp of each step in the block.
+         * @param flows The flows of the block, step major, i.e., ``flows[step * nexus_ids.size() + nexus]``.
+         */
+        virtual void write_block(const std::vector<long>& time_indices, const std::vector<std::string>& timestamps,
+                                 const std::vector<double>& flows) = 0;
+
+      private:
+
+        struct PendingStep {
+            PendingStep(const std::string& timestamp, std::size_t num_nexuses)
+                : timestamp(timestamp), flows(num_nexuses, std::numeric_limits<double>::quiet_NaN()), received(0) {}
+            std::string timestamp;
+            std::vector<double> flows;
+            std::size_t received;
+        };
+
+        void append_to_block(long time_index, const PendingStep& step)
+        {
+            block_time_indices.push_back(time_index);
+            block_timestamps.push_back(step.timestamp);
+            block_flows.insert(block_flows.end(), step.flows.begin(), step.flows.end());
+        }
+
+        void write_current_block()
+        {
+            write_block(block_time_indices, block_timestamps, block_flows);
+            block_time_indices.clear();
+            block_timestamps.clear();
+            block_flows.clear();
+        }
+
+        std::size_t buffer_steps;
+        /** The first time step that has not yet been moved to the block. */
+        long next_step;
+        std::map<long, PendingStep> pending;
+        std::vector<long> block_time_indices;
+        std::vector<std::string> block_timestamps;
+        std::vector<double> block_flows;
+        std::mutex mutex;
+    };
+
+    /**
+     * @brief Writes the flows of all nexuses to a single flat binary file.
+     *
+     * All values are in the host's native byte order.  The file begins with a header of:
+     *
+     *  - the 8 characters ``NGENNEX1``;
+     *  - the number of nexuses, as a ``uint64_t``;
+     *  - each nexus id, as a ``uint32_t`` length followed by its characters.
+     *
+     * followed by one record per time step of:
+     *
+     *  - the time step index, as an ``int64_t``;
+     *  - the timestamp, as a ``uint32_t`` length followed by its characters;
+     *  - the flow of each nexus, in header order, as ``double`` values.
+     */
+    class BinaryNexusOutputWriter : public BufferedNexusOutputWriter
+    {
+      public:
+
+        /**
+         * @param nexus_ids The ids of the nexuses to write flows for.
+         * @param path The path of the output file.
+         * @param buffer_steps The number of complete time steps to gather before writing.
+         */
+        BinaryNexusOutputWriter(const std::vector<std::string>& nexus_ids, const std::string& path,
+                                std::size_t buffer_steps)
+            : BufferedNexusOutputWriter(nexus_ids, buffer_steps)
+        {
+            outfile.open(path, std::ios::trunc | std::ios::binary);
+            if (!outfile.is_open()) {
+                throw std::runtime_error("BinaryNexusOutputWriter: unable to open output file " + path);
+            }
+            std::string header = encode_header(nexus_ids);
+            outfile.write(header.data(), header.size());
+        }
+
+        virtual ~BinaryNexusOutputWriter()
+        {
+            flush();
+        }
+
+        /** @return The header of the format, for @p nexus_ids. */
+        static std::string encode_header(const std::vector<std::string>& nexus_ids)
+        {
+            std::string bytes("NGENNEX1", 8);
+            append_value<uint64_t>(bytes, nexus_ids.size());
+            for (const auto& id : nexus_ids) {
+                append_string(bytes, id);
+            }
+            return bytes;
+        }
+
+        /** @return The records of the format for a block of time steps, as given to @ref write_block. */
+        static std::string encode_records(std::size_t num_nexuses, const std::vector<long>& time_indices,
+                                          const std::vector<std::string>& timestamps, const std::vector<double>& flows)
+        {
+            std::string bytes;
+            for (std::size_t s = 0; s < time_indices.size(); ++s) {
+                append_value<int64_t>(bytes, time_indices[s]);
+                append_string(bytes, timestamps[s]);
+                bytes.append(reinterpret_cast<const char*>(flows.data() + s * num_nexuses), num_nexuses * sizeof(double));
+            }
+            return bytes;
+        }
+
+      protected:
+
+        void write_block(const std::vector<long>& time_indices, const std::vector<std::string>& timestamps,
+                         const std::vector<double>& flows) override
+        {
+            std::string records = encode_records(nexus_ids.size(), time_indices, timestamps, flows);
+            outfile.write(records.data(), records.size());
+            outfile.flush();
+        }
+
+      private:
+
+        template<typename T>
+        static void append_value(std::string& bytes, T value)
+        {
+            bytes.append(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        static void append_string(std::string& bytes, const std::string& value)
+        {
+            append_value<uint32_t>(bytes, value.size());
+            bytes.append(value);
+        }
+
+        std::ofstream outfile;
+    };
+
+    /**
+     * @brief Publishes the flows of all nexuses as they are computed, to every process connected to a socket.
+     *
+     * Flows are sent in the layout of @ref BinaryNexusOutputWriter, cut into frames of a @ref utils::FramePublisher:
+     * the greeting frame is the header, and each later frame holds the records of a block of time steps.  Consumers
+     * such as routing or visualization can then work on each block while the next is computed, rather than wait for
+     * the run to end and parse its output files.
+     */
+    class StreamNexusOutputWriter : public BufferedNexusOutputWriter
+    {
+      public:
+
+        /**
+         * @param nexus_ids The ids of the nexuses to publish flows for.
+         * @param socket_path The path of the Unix domain socket to publish on.
+         * @param buffer_steps The number of complete time steps of each frame.
+         * @param subscribers The number of subscribers to wait for before returning, so they receive every frame.
+         */
+        StreamNexusOutputWriter(const std::vector<std::string>& nexus_ids, const std::string& socket_path,
+                                std::size_t buffer_steps, std::size_t subscribers = 0)
+            : BufferedNexusOutputWriter(nexus_ids, buffer_steps),
+              publisher(socket_path, BinaryNexusOutputWriter::encode_header(nexus_ids))
+        {
+            publisher.wait_for_subscribers(subscribers);
+        }
+
+        virtual ~StreamNexusOutputWriter()
+        {
+            flush();
+        }
+
+      protected:
+
+        void write_block(const std::vector<long>& time_indices, const std::vector<std::string>& timestamps,
+                         const std::vector<double>& flows) override
+        {
+            publisher.publish(BinaryNexusOutputWriter::encode_records(nexus_ids.size(), time_indices, timestamps, flows));
+        }
+
+      private:
+
+        utils::FramePublisher publisher;
+    };
+
+    /**
+     * @brief Keeps the flows of all nexuses in memory, for handing to an in-process consumer such as routing.
+     *
+     * Flows are kept nexus major in one contiguous buffer, so the flows of nexus ``n`` at the ``s``-th kept step are
+     * at ``get_flows()[n * get_row_stride() + s]``, and the whole buffer can be viewed as a ``nexus x time`` array
+     * without copying.  With a chunk size, every time that many complete steps are kept (and on @ref flush, for any
+     * fewer) the chunk handler is called with the writer's lock held, after which the kept steps are discarded.
+     * Without one, steps are kept until @ref clear is called.
+     */
+    class MemoryNexusOutputWriter : public BufferedNexusOutputWriter
+    {
+      public:
+
+        typedef std::function<void(const MemoryNexusOutputWriter&)> chunk_handler_t;
+
+        /**
+         * @param nexus_ids The ids of the nexuses to keep flows for.
+         * @param chunk_steps The number of steps of each chunk given to @p chunk_handler, or 0 to keep every step.
+         * @param chunk_handler Called with each chunk of steps; may be empty if @p chunk_steps is 0.
+         * @param reserve_steps The number of steps to allocate room for up front.
+         */
+        MemoryNexusOutputWriter(const std::vector<std::string>& nexus_ids, std::size_t chunk_steps = 0,
+                                chunk_handler_t chunk_handler = chunk_handler_t(), std::size_t reserve_steps = 0)
+            : BufferedNexusOutputWriter(nexus_ids, 1), chunk_steps(chunk_steps), chunk_handler(chunk_handler),
+              row_stride(chunk_steps > 0 ? chunk_steps : reserve_steps)
+        {
+            if (chunk_steps > 0 && !chunk_handler) {
+                throw std::invalid_argument("MemoryNexusOutputWriter: a chunk size requires a chunk handler");
+            }
+            flows.resize(nexus_ids.size() * row_stride);
+        }
+
+        virtual ~MemoryNexusOutputWriter(){}
+
+        /**
+         * @brief Move every buffered step in, as for other buffered writers, then hand any partial chunk over.
+         */
+        void flush() override
+        {
+            BufferedNexusOutputWriter::flush();
+            if (chunk_steps > 0 && !time_indices.empty()) {
+                hand_over_chunk();
+            }
+        }
+
+        /**
+         * @brief Discard the kept steps.  Not synchronized with concurrent writes.
+         */
+        void clear()
+        {
+            time_indices.clear();
+            timestamps.clear();
+        }
+
+        /** @return The flows of the kept steps, laid out as described for the class. */
+        const double* get_flows() const { return flows.data(); }
+
+        /** @return The distance between the flows of consecutive nexuses in @ref get_flows. */
+        std::size_t get_row_stride() const { return row_stride; }
+
+        /** @return The time step index of each kept step. */
+        const std::vector<long>& get_time_indices() const { return time_indices; }
+
+        /** @return The timestamp of each kept step. */
+        const std::vector<std::string>& get_timestamps() const { return timestamps; }
+
+      protected:
+
+        void write_block(const std::vector<long>& block_time_indices, const std::vector<std::string>& block_timestamps,
+                         const std::vector<double>& block_flows) override
+        {
+            std::size_t num_nexuses = nexus_ids.size();
+            for (std::size_t s = 0; s < block_time_indices.size(); ++s) {
+                std::size_t step = time_indices.size();
+                if (step == row_stride) {
+                    grow(row_stride > 0 ? 2 * row_stride : 64);
+                }
+                for (std::size_t n = 0; n < num_nexuses; ++n) {
+                    flows[n * row_stride + step] = block_flows[s * num_nexuses + n];
+                }
+                time_indices.push_back(block_time_indices[s]);
+                timestamps.push_back(block_timestamps[s]);
+                if (chunk_steps > 0 && time_indices.size() == chunk_steps) {
+                    hand_over_chunk();
+                }
+            }
+        }
+
+      private:
+
+        /** Lengthen each nexus's row to @p new_stride steps, keeping its flows. */
+        void grow(std::size_t new_stride)
+        {
+            std::vector<double> grown(nexus_ids.size() * new_stride);
+            for (std::size_t n = 0; n < nexus_ids.size(); ++n) {
+                std::copy(flows.begin() + n * row_stride, flows.begin() + n * row_stride + time_indices.size(),
+                          grown.begin() + n * new_stride);
+            }
+            flows.swap(grown);
+            row_stride = new_stride;
+        }
+
+        void hand_over_chunk()
+        {
+            chunk_handler(*this);
+            clear();
+        }
+
+        std::size_t chunk_steps;
+        chunk_handler_t chunk_handler;
+        std::size_t row_stride;
+        std::vector<double> flows;
+        std::vector<long> time_indices;
+        std::vector<std::string> timestamps;
+    };
+}
+
+#endif //NGEN_NEXUS_OUTPUT_WRITER_HPP
@@ -0,0 +1,89 @@
+#ifndef NGEN_NEXUS_OUTPUT_WRITER_FACTORY_HPP
+#define NGEN_NEXUS_OUTPUT_WRITER_FACTORY_HPP
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Output_Params.h"
+#include "NexusOutputWriter.hpp"
+#include "MappedNexusOutputWriter.hpp"
+#include "NetCDFNexusOutputWriter.hpp"
+#include "ParallelNetCDFNexusOutputWriter.hpp"
+#include "ParquetNexusOutputWriter.hpp"
+
+namespace nexus_output
+{
+    /**
+     * @brief Create the nexus output writer selected by an ``output`` configuration.
+     *
+     * @param params The output configuration.
+     * @param nexus_ids The ids of the nexuses to write flows for.
+     * @param file_tag Tag added to the name of formats writing a single file, e.g., to keep MPI ranks separate; not
+     *                 used by ``netcdf_parallel``, whose one file is shared by every rank.
+     * @param total_steps The number of output time steps of the run, which the ``mapped`` format requires.
+     * @param is_restart Whether the run restarts from a checkpoint, so the ``mapped`` format keeps the flows already
+     *                   in its file.
+     * @return The writer.
+     * @throws std::runtime_error If the configured format is unknown, or not supported by this build.
+     */
+    inline std::unique_ptr<NexusOutputWriter> make_nexus_output_writer(const output_params& params,
+                                                                       const std::vector<std::string>& nexus_ids,
+                                                                       const std::string& file_tag = "",
+                                                                       std::size_t total_steps = 0,
+                                                                       bool is_restart = false)
+    {
+        if (params.nexus_format == "csv") {
+            return std::unique_ptr<NexusOutputWriter>(new CsvPerNexusOutputWriter(
+                nexus_ids, params.nexus_path, utils::parse_compression(params.csv_compression),
+                params.csv_compression_level,
+                utils::file_buffer_share(static_cast<std::size_t>(params.csv_buffer_mb) * 1024 * 1024,
+                                         nexus_ids.size())));
+        }
+        if (params.nexus_format == "binary") {
+            return std::unique_ptr<NexusOutputWriter>(new BinaryNexusOutputWriter(
+                nexus_ids, params.nexus_path + "nexus_output" + file_tag + ".bin", params.nexus_buffer_steps));
+        }
+        if (params.nexus_format == "stream") {
+            return std::unique_ptr<NexusOutputWriter>(new StreamNexusOutputWriter(
+                nexus_ids, params.nexus_path + "nexus_output" + file_tag + ".sock", params.nexus_buffer_steps,
+                params.stream_subscribers));
+        }
+        if (params.nexus_format == "mapped") {
+            if (total_steps == 0) {
+                throw std::runtime_error("Nexus output format 'mapped' requires the number of time steps of the run.");
+            }
+            return std::unique_ptr<NexusOutputWriter>(new MappedNexusOutputWriter(
+                nexus_ids, params.nexus_path + "nexus_output" + file_tag + ".flows", total_steps, is_restart));
+        }
+        if (params.nexus_format == "netcdf") {
+        #ifdef NETCDF_ACTIVE
+            return std::unique_ptr<NexusOutputWriter>(new NetCDFNexusOutputWriter(
+                nexus_ids, params.nexus_path + "nexus_output" + file_tag + ".nc", params.nexus_buffer_steps));
+        #else
+            throw std::runtime_error("Nexus output format 'netcdf' requires NetCDF support, which is not enabled in this build.");
+        #endif
+        }
+        if (params.nexus_format == "parquet") {
+        #ifdef NGEN_PARQUET_ACTIVE
+            return std::unique_ptr<NexusOutputWriter>(new ParquetNexusOutputWriter(
+                nexus_ids, params.nexus_path + "nexus_output" + file_tag + ".parquet", params.nexus_buffer_steps));
+        #else
+            throw std::runtime_error("Nexus output format 'parquet' requires Arrow and Parquet support, which is not enabled in this build.");
+        #endif
+        }
+        if (params.nexus_format == "netcdf_parallel") {
+        #ifdef NETCDF_PARALLEL_ACTIVE
+            return std::unique_ptr<NexusOutputWriter>(new ParallelNetCDFNexusOutputWriter(
+                nexus_ids, params.nexus_path + "nexus_output.nc", params.nexus_buffer_steps));
+        #else
+            throw std::runtime_error("Nexus output format 'netcdf_parallel' requires parallel NetCDF and MPI support, which are not enabled in this build.");
+        #endif
+        }
+        throw std::runtime_error("Unknown nexus output format '" + params.nexus_format
+                                 + "'; expected csv, binary, stream, mapped, netcdf, parquet, or netcdf_parallel.");
+    }
+}
+
+#endif //NGEN_NEXUS_OUTPUT_WRITER_FACTORY_HPP
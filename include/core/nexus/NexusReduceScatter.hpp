@@ -0,0 +1,113 @@
+#ifndef NGEN_NEXUS_REDUCE_SCATTER_HPP
+#define NGEN_NEXUS_REDUCE_SCATTER_HPP
+
+#ifdef NGEN_MPI_ACTIVE
+
+#include <mpi.h>
+
+#include <MemoryReport.hpp>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Sum of the flows each MPI rank adds to its nexuses, onto the rank that owns each nexus, a chunk of time steps
+ * at a time.
+ *
+ * Without inline routing, catchments depend only on their forcings, and a nexus's flow is just the sum of what its
+ * upstream catchments contribute, so catchments may be partitioned for balance alone, with those of a nexus spread over
+ * any number of ranks.  Each rank then holds its own copy of every nexus its catchments drain to, which sums only the
+ * flows of that rank's catchments.  Rather than exchange those partial flows nexus by nexus, every rank adds them to
+ * a dense array indexed by the nexus's place among all the nexuses of every rank, and once per chunk of time steps the
+ * arrays of all ranks are summed with one ``MPI_Reduce_scatter``, which leaves each rank with the total flows of the
+ * block of nexuses it owns.  The nexuses, in id order, are owned in equal contiguous blocks, in rank order.
+ *
+ * The array holds every nexus for each time step of a chunk, so it takes ``chunk_steps`` times the number of nexuses
+ * of the whole domain in doubles, on every rank.
+ *
+ * Every rank that constructs one must call @ref reduce the same number of times, after adding the flows of the same
+ * time steps.
+ */
+class NexusReduceScatter
+{
+    public:
+
+        /**
+         * @brief Set up the reduction of the given nexuses, which is collective over @p comm.
+         *
+         * @param local_nexus_ids The nexuses this rank adds flows to, in the order of the indexes @ref add takes.
+         * @param chunk_steps The number of time steps summed by each @ref reduce.
+         * @param comm The communicator of the ranks the catchments are partitioned over.
+         * @throws std::invalid_argument If @p chunk_steps is less than 1.
+         */
+        NexusReduceScatter(const std::vector<std::string>& local_nexus_ids, std::size_t chunk_steps,
+                           MPI_Comm comm = MPI_COMM_WORLD);
+
+        virtual ~NexusReduceScatter();
+
+        NexusReduceScatter(const NexusReduceScatter&) = delete;
+        NexusReduceScatter& operator=(const NexusReduceScatter&) = delete;
+
+        /**
+         * @brief Add flow to a nexus for a time step of the current chunk.
+         *
+         * @param local_index The index of the nexus in the ids the reduction was constructed with.
+         * @param step The time step, counted from the first of the chunk, which must be less than @ref chunk_steps.
+         * @param flow The flow this rank contributes to the nexus.
+         */
+        void add(std::size_t local_index, std::size_t step, double flow) {
+            send_buffer[local_bases[local_index] + step * local_strides[local_index]] += flow;
+        }
+
+        /**
+         * @brief Sum the flows every rank added for the current chunk onto the owners of the nexuses, and start the
+         * next chunk with no flows.
+         */
+        void reduce();
+
+        /** @return The number of time steps of each chunk. */
+        std::size_t chunk_steps() const {
+            return steps;
+        }
+
+        /** @return The ids of the nexuses this rank owns, in id order. */
+        const std::vector<std::string>& owned_nexus_ids() const {
+            return owned_ids;
+        }
+
+        /**
+         * @return The total flows of the owned nexuses, in the order of @ref owned_nexus_ids, for a time step of the
+         *         chunk last reduced, counted from its first.
+         */
+        const double* owned_flows(std::size_t step) const {
+            return recv_buffer.data() + step * owned_ids.size();
+        }
+
+        /**
+         * @return An estimate of the bytes held by the reduction's buffers and indexes (see utils::MemoryReport), not
+         *         counting what the MPI library holds for its communicator.
+         */
+        std::size_t get_memory_bytes() const {
+            using utils::MemoryReport;
+            return sizeof(*this) + MemoryReport::bytes_of(send_buffer) + MemoryReport::bytes_of(recv_buffer)
+                + MemoryReport::bytes_of(recv_counts) + MemoryReport::bytes_of(local_bases)
+                + MemoryReport::bytes_of(local_strides) + MemoryReport::bytes_of(owned_ids);
+        }
+
+    private:
+
+        MPI_Comm comm;
+        std::size_t steps;
+        std::vector<std::string> owned_ids;
+        /** For each rank, the block of the send buffer it owns: each of its nexuses for every step, by step */
+        std::vector<double> send_buffer;
+        std::vector<double> recv_buffer;
+        std::vector<int> recv_counts;
+        /** Where each local nexus's flow at the first step of a chunk is in the send buffer, and how far apart its steps are */
+        std::vector<std::size_t> local_bases;
+        std::vector<std::size_t> local_strides;
+};
+
+#endif // NGEN_MPI_ACTIVE
+#endif // NGEN_NEXUS_REDUCE_SCATTER_HPP
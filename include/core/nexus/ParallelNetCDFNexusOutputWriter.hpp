@@ -0,0 +1,240 @@
+#ifdef NETCDF_PARALLEL_ACTIVE
+#ifndef NGEN_PARALLEL_NETCDF_NEXUS_OUTPUT_WRITER_HPP
+#define NGEN_PARALLEL_NETCDF_NEXUS_OUTPUT_WRITER_HPP
+
+#include "NexusOutputWriter.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <mpi.h>
+#include <netcdf.h>
+#include <netcdf_par.h>
+
+namespace nexus_output
+{
+    /**
+     * @brief Writes the flows of the nexuses of every MPI rank to a single NetCDF-4 file, with collective parallel
+     * writes, so the output of a distributed run needs no merging.
+     *
+     * The file has the same contents as that of @ref NetCDFNexusOutputWriter, other than storing strings as fixed
+     * length character arrays, since variable length strings cannot be written in parallel:
+     *
+     *  - ``ids(nexus, id_length)``, the nexus id strings;
+     *  - ``time_index(time)`` and ``timestamp(time, timestamp_length)``, identifying each output time step;
+     *  - ``flow(nexus, time)``, the downstream flow of each nexus in m^3/s.
+     *
+     * Each rank's nexuses are one contiguous range of the ``nexus`` dimension, after those of the ranks before it, and
+     * each rank writes only its range.  Every rank must construct its writer, make its calls to
+     * @ref complete_time_step, @ref flush and @ref close together, since each of these is collective; any rank may
+     * have no nexuses.  The file must be closed before the writer is destroyed: destroying it makes no collective
+     * call, so a rank unwinding from an error doesn't leave the others waiting on it, and leaves the file unfinished.
+     */
+    class ParallelNetCDFNexusOutputWriter : public NexusOutputWriter
+    {
+      public:
+
+        /**
+         * @param nexus_ids The ids of the nexuses this rank writes the flows of.
+         * @param path The path of the output file, which is the same for every rank.
+         * @param buffer_steps The number of time steps to gather before each collective write.
+         * @param comm The communicator of the ranks writing the file.
+         */
+        ParallelNetCDFNexusOutputWriter(const std::vector<std::string>& nexus_ids, const std::string& path,
+                                        std::size_t buffer_steps, MPI_Comm comm = MPI_COMM_WORLD)
+            : NexusOutputWriter(nexus_ids), path(path), buffer_steps(std::max<std::size_t>(1, buffer_steps)),
+              block_steps(0), written_steps(0)
+        {
+            MPI_Comm_rank(comm, &rank);
+
+            // This rank's range of the nexus dimension, and the id length that fits the ids of every rank
+            unsigned long long local_count = nexus_ids.size();
+            unsigned long long offset = 0;
+            unsigned long long total_count = 0;
+            MPI_Exscan(&local_count, &offset, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, comm);
+            if (rank == 0) {
+                // The result of an exclusive scan is undefined on the first rank
+                offset = 0;
+            }
+            MPI_Allreduce(&local_count, &total_count, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, comm);
+            unsigned long long local_id_length = 1;
+            for (const auto& id : nexus_ids) {
+                local_id_length = std::max<unsigned long long>(local_id_length, id.size());
+            }
+            MPI_Allreduce(&local_id_length, &id_length, 1, MPI_UNSIGNED_LONG_LONG, MPI_MAX, comm);
+            nexus_offset = offset;
+
+            check(nc_create_par(path.c_str(), NC_NETCDF4 | NC_CLOBBER, comm, MPI_INFO_NULL, &ncid), path);
+            int nexus_dim, id_length_dim, time_dim, timestamp_length_dim;
+            check(nc_def_dim(ncid, "nexus", total_count, &nexus_dim), path);
+            check(nc_def_dim(ncid, "id_length", id_length, &id_length_dim), path);
+            check(nc_def_dim(ncid, "time", NC_UNLIMITED, &time_dim), path);
+            check(nc_def_dim(ncid, "timestamp_length", timestamp_length, &timestamp_length_dim), path);
+
+            int id_dims[2] = {nexus_dim, id_length_dim};
+            check(nc_def_var(ncid, "ids", NC_CHAR, 2, id_dims, &id_var), path);
+            check(nc_def_var(ncid, "time_index", NC_INT64, 1, &time_dim, &time_index_var), path);
+            int timestamp_dims[2] = {time_dim, timestamp_length_dim};
+            check(nc_def_var(ncid, "timestamp", NC_CHAR, 2, timestamp_dims, &timestamp_var), path);
+
+            int flow_dims[2] = {nexus_dim, time_dim};
+            check(nc_def_var(ncid, "flow", NC_DOUBLE, 2, flow_dims, &flow_var), path);
+            size_t chunks[2] = {static_cast<size_t>(std::max<unsigned long long>(1, std::min<unsigned long long>(total_count, 4096))),
+                                this->buffer_steps};
+            check(nc_def_var_chunking(ncid, flow_var, NC_CHUNKED, chunks), path);
+            double fill = std::numeric_limits<double>::quiet_NaN();
+            check(nc_def_var_fill(ncid, flow_var, NC_FILL, &fill), path);
+            check(nc_put_att_text(ncid, flow_var, "units", 6, "m3 s-1"), path);
+            check(nc_enddef(ncid), path);
+
+            // Writes extending the unlimited time dimension must be collective, so every variable's are
+            check(nc_var_par_access(ncid, NC_GLOBAL, NC_COLLECTIVE), path);
+
+            std::vector<char> ids(nexus_ids.size() * id_length, '\0');
+            for (std::size_t n = 0; n < nexus_ids.size(); ++n) {
+                std::memcpy(ids.data() + n * id_length, nexus_ids[n].data(), nexus_ids[n].size());
+            }
+            size_t id_start[2] = {nexus_offset, 0};
+            size_t id_count[2] = {nexus_ids.size(), id_length};
+            check(nc_put_vara_text(ncid, id_var, id_start, id_count, ids.data()), path);
+
+            block_flows.assign(this->buffer_steps * nexus_ids.size(), std::numeric_limits<double>::quiet_NaN());
+            block_time_indices.resize(this->buffer_steps);
+            block_timestamps.assign(this->buffer_steps * timestamp_length, '\0');
+        }
+
+        virtual ~ParallelNetCDFNexusOutputWriter()
+        {
+            // Closing the file is collective, so it is left to close(), which every rank makes together
+            if (!closed) {
+                try {
+                    std::cerr << "WARN: ParallelNetCDFNexusOutputWriter: " << path << " was not closed, so its time "
+                              << "steps after the last flush are not written" << std::endl;
+                }
+                catch (...) {
+                }
+            }
+        }
+
+        void write(const std::string& nexus_id, long time_index, const std::string& timestamp, double flow) override
+        {
+            std::size_t index = index_of(nexus_id);
+            std::lock_guard<std::mutex> lock(mutex);
+            block_flows[block_steps * nexus_ids.size() + index] = flow;
+        }
+
+        /**
+         * @brief Move on to the next time step, collectively writing the gathered steps once there are enough.
+         */
+        void complete_time_step(long time_index, const std::string& timestamp) override
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (closed) {
+                throw std::runtime_error("ParallelNetCDFNexusOutputWriter: " + path + " is already closed");
+            }
+            block_time_indices[block_steps] = time_index;
+            std::memcpy(block_timestamps.data() + block_steps * timestamp_length, timestamp.data(),
+                        timestamp.size() < timestamp_length ? timestamp.size() : timestamp_length);
+            ++block_steps;
+            if (block_steps == buffer_steps) {
+                write_block();
+            }
+        }
+
+        /**
+         * @brief Collectively write the completed time steps gathered so far.
+         */
+        void flush() override
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (closed) {
+                return;
+            }
+            if (block_steps > 0) {
+                write_block();
+            }
+            check(nc_sync(ncid), path);
+        }
+
+        /**
+         * @brief Collectively write the completed time steps gathered so far, and close the file.
+         */
+        void close() override
+        {
+            flush();
+            std::lock_guard<std::mutex> lock(mutex);
+            if (closed) {
+                return;
+            }
+            closed = true;
+            check(nc_close(ncid), path);
+        }
+
+      private:
+
+        static const std::size_t timestamp_length = 19;
+
+        static void check(int status, const std::string& path)
+        {
+            if (status != NC_NOERR) {
+                throw std::runtime_error("ParallelNetCDFNexusOutputWriter: " + path + ": " + nc_strerror(status));
+            }
+        }
+
+        void write_block()
+        {
+            std::size_t num_nexuses = nexus_ids.size();
+
+            // Only the first rank writes the time variables, but every rank takes part in the collective writes
+            size_t time_start[2] = {written_steps, 0};
+            size_t time_count[2] = {rank == 0 ? block_steps : 0, timestamp_length};
+            check(nc_put_vara_longlong(ncid, time_index_var, time_start, time_count, block_time_indices.data()),
+                  "time_index");
+            check(nc_put_vara_text(ncid, timestamp_var, time_start, time_count, block_timestamps.data()), "timestamp");
+
+            // The block is step major, and the variable is nexus major
+            std::vector<double> transposed(num_nexuses * block_steps);
+            for (std::size_t s = 0; s < block_steps; ++s) {
+                for (std::size_t n = 0; n < num_nexuses; ++n) {
+                    transposed[n * block_steps + s] = block_flows[s * num_nexuses + n];
+                }
+            }
+            size_t flow_start[2] = {nexus_offset, written_steps};
+            size_t flow_count[2] = {num_nexuses, block_steps};
+            check(nc_put_vara_double(ncid, flow_var, flow_start, flow_count, transposed.data()), "flow");
+
+            written_steps += block_steps;
+            block_steps = 0;
+            std::fill(block_flows.begin(), block_flows.end(), std::numeric_limits<double>::quiet_NaN());
+        }
+
+        std::string path;
+        int rank;
+        int ncid;
+        /** Whether the file was closed, after which nothing more is written. */
+        bool closed = false;
+        int id_var;
+        int time_index_var;
+        int timestamp_var;
+        int flow_var;
+        unsigned long long id_length;
+        std::size_t nexus_offset;
+        std::size_t buffer_steps;
+        /** The number of completed time steps gathered in the block. */
+        std::size_t block_steps;
+        std::size_t written_steps;
+        std::vector<double> block_flows;
+        std::vector<long long> block_time_indices;
+        std::vector<char> block_timestamps;
+        std::mutex mutex;
+    };
+}
+
+#endif //NGEN_PARALLEL_NETCDF_NEXUS_OUTPUT_WRITER_HPP
+#endif //NETCDF_PARALLEL_ACTIVE
@@ -0,0 +1,72 @@
+#ifdef NGEN_PARQUET_ACTIVE
+#ifndef NGEN_PARQUET_NEXUS_OUTPUT_WRITER_HPP
+#define NGEN_PARQUET_NEXUS_OUTPUT_WRITER_HPP
+
+#include "NexusOutputWriter.hpp"
+#include "ParquetOutputFile.hpp"
+
+#include <ctime>
+#include <string>
+#include <vector>
+
+namespace nexus_output
+{
+    /**
+     * @brief Writes the flows of all nexuses to a single Parquet file, with a row group for each buffered block of
+     * time steps.
+     *
+     * Rows are in the long form of @ref output::ParquetOutputFile, with the one variable ``flow``, the downstream flow
+     * of the nexus in m^3/s, and are ordered by time step and then by nexus.
+     */
+    class ParquetNexusOutputWriter : public BufferedNexusOutputWriter
+    {
+      public:
+
+        /**
+         * @param nexus_ids The ids of the nexuses to write flows for.
+         * @param path The path of the output file.
+         * @param buffer_steps The number of complete time steps of each row group.
+         */
+        ParquetNexusOutputWriter(const std::vector<std::string>& nexus_ids, const std::string& path,
+                                 std::size_t buffer_steps)
+            : BufferedNexusOutputWriter(nexus_ids, buffer_steps), file(path, nexus_ids, {"flow"}) {}
+
+        virtual ~ParquetNexusOutputWriter()
+        {
+            flush();
+            file.close();
+        }
+
+      protected:
+
+        void write_block(const std::vector<long>& time_indices, const std::vector<std::string>& timestamps,
+                         const std::vector<double>& flows) override
+        {
+            std::size_t num_nexuses = nexus_ids.size();
+            for (std::size_t s = 0; s < time_indices.size(); ++s) {
+                int64_t time = parse_timestamp(timestamps[s]);
+                for (std::size_t n = 0; n < num_nexuses; ++n) {
+                    file.add(n, time_indices[s], time, 0, flows[s * num_nexuses + n]);
+                }
+            }
+            file.write_row_group();
+        }
+
+      private:
+
+        /** The seconds since the epoch of a ``%Y-%m-%d %H:%M:%S`` UTC timestamp, or ``0`` if it is not one. */
+        static int64_t parse_timestamp(const std::string& timestamp)
+        {
+            std::tm tm = {};
+            if (strptime(timestamp.c_str(), "%Y-%m-%d %H:%M:%S", &tm) == nullptr) {
+                return 0;
+            }
+            return timegm(&tm);
+        }
+
+        output::ParquetOutputFile file;
+    };
+}
+
+#endif //NGEN_PARQUET_NEXUS_OUTPUT_WRITER_HPP
+#endif //NGEN_PARQUET_ACTIVE
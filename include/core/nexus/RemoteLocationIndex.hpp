@@ -0,0 +1,97 @@
+#ifndef NGEN_REMOTE_LOCATION_INDEX_HPP
+#define NGEN_REMOTE_LOCATION_INDEX_HPP
+
+#include <IdTable.hpp>
+
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Immutable index of the MPI ranks of the catchments a rank communicates with, keyed by integer handles.
+ *
+ * A partition's remote catchments are indexed once, each id interned to a dense handle with its rank kept per handle,
+ * and the one index is then shared, as a ``std::shared_ptr<const RemoteLocationIndex>``, by every remote nexus of the
+ * partition, rather than each nexus holding its own copy of the table.
+ *
+ * @code {.cpp}
+ * auto index = RemoteLocationIndex::make({{"cat-26", 1}, {"cat-27", 2}});
+ * RemoteLocationIndex::handle_t cat = index->find("cat-27");
+ * assert(cat != RemoteLocationIndex::npos && index->rank_at(cat) == 2);
+ * @endcode
+ */
+class RemoteLocationIndex {
+  public:
+    using handle_t = network::IdTable::handle_t;
+
+    /**
+     * @brief The handle returned by @ref find for catchments not in the index, i.e. those local to this rank
+     */
+    static constexpr handle_t npos = network::IdTable::npos;
+
+    /**
+     * @brief Index the ranks of catchments
+     *
+     * @param locations The rank of each remote catchment; should a catchment be listed more than once, its first
+     *                  rank is kept.
+     */
+    template <class Locations>
+    explicit RemoteLocationIndex(const Locations& locations)
+    {
+      for( const auto& location : locations ) {
+        if( ids.find(location.first) == npos ) {
+          ids.intern(location.first);
+          ranks.push_back(location.second);
+        }
+      }
+    }
+
+    /**
+     * @brief Make a shared index of the ranks of catchments, see @ref RemoteLocationIndex(const Locations&)
+     */
+    template <class Locations>
+    static std::shared_ptr<const RemoteLocationIndex> make(const Locations& locations)
+    {
+      return std::make_shared<const RemoteLocationIndex>(locations);
+    }
+
+    static std::shared_ptr<const RemoteLocationIndex> make(std::initializer_list<std::pair<std::string, long>> locations)
+    {
+      return std::make_shared<const RemoteLocationIndex>(locations);
+    }
+
+    /**
+     * @brief Get the handle of the catchment @p id, or @ref npos if it is not remote
+     */
+    handle_t find(const std::string& id) const { return ids.find(id); }
+
+    /**
+     * @brief Get the rank of the catchment with handle @p handle, as assigned by @ref find
+     */
+    long rank_at(handle_t handle) const { return ranks[handle]; }
+
+    /**
+     * @brief Get the string id of the catchment with handle @p handle
+     */
+    const std::string& id(handle_t handle) const { return ids.id(handle); }
+
+    /**
+     * @brief The number of catchments in the index, which is also one past the largest handle
+     */
+    std::size_t size() const { return ranks.size(); }
+
+    /**
+     * @brief An estimate of the bytes the index holds (see utils::MemoryReport)
+     */
+    std::size_t get_memory_bytes() const { return ids.get_memory_bytes() + ranks.capacity() * sizeof(long); }
+
+  private:
+    network::IdTable ids;
+    std::vector<long> ranks;
+};
+
+#endif //NGEN_REMOTE_LOCATION_INDEX_HPP
@@ -0,0 +1,248 @@
+#ifndef NGEN_REMOTE_NEXUS_EXCHANGE_HPP
+#define NGEN_REMOTE_NEXUS_EXCHANGE_HPP
+
+#ifdef NGEN_MPI_ACTIVE
+
+#include <mpi.h>
+
+#include <MemoryReport.hpp>
+
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class HY_PointHydroNexusRemote;
+
+/**
+ * @brief Batched exchange of the boundary flows of all remote nexuses of an MPI rank.
+ *
+ * Instead of each HY_PointHydroNexusRemote posting its own message (and waiting on it) every time step, remote nexuses
+ * attached to an exchange only stage their outgoing flows.  A single call to @ref exchange per time step then sends
+ * one block to each downstream neighbor rank, carrying the flows of every nexus shared with it, and receives one block
+ * from each upstream neighbor rank.
+ *
+ * The neighbors of every rank are fixed by the partitioning, so the exchange declares them once, as a distributed
+ * graph communicator (``MPI_Dist_graph_create_adjacent``) weighted by the number of nexuses shared along each edge,
+ * and each time step is one neighborhood collective (``MPI_Ineighbor_alltoallv``) over it, which the MPI library may
+ * schedule and route knowing the whole pattern.  Every block has a fixed size and layout (the time steps, then the
+ * nexuses in id order for each of them).  To overlap the exchange with computation, it starts as soon as the last flow this rank sends
+ * is staged, or for a rank that sends nothing, as soon as its receives are posted, so a rank can run the catchments
+ * that don't drain to other ranks while the flows are in flight.
+ *
+ * Alternatively, the flows can be moved one-sided (@ref Transport::one_sided): each rank exposes its receive buffer
+ * as an RMA window, and each upstream rank ``MPI_Put``s its blocks straight into the windows of its downstream
+ * neighbors, with no matching of sends to receives.  Each time step is one post-start-complete-wait epoch between
+ * neighbors only: a rank opens its window to its upstream neighbors when it posts its receives, puts its flows once
+ * they are all staged, and @ref exchange completes both.
+ *
+ * Flows only go downstream, so no rank needs anything back from the ranks it sends to, and every rank only needs the
+ * flows it receives for the output of its nexuses.  An exchange may then move the flows of a chunk of up to
+ * ``chunk_steps`` time steps at once (@ref exchange_chunk), each block carrying the chunk's first time step and length,
+ * then the flows of each of its steps in turn.  Within a chunk, ranks run without waiting on each other, so an
+ * upstream rank may get up to a chunk ahead of those downstream of it, and the latency of each exchange is paid once
+ * per chunk rather than once per time step.
+ *
+ * Every rank that constructs an exchange must exchange every time step, in order and in the same chunks, even if it
+ * has no remote nexuses, and every rank must use the same transport and chunk length.
+ */
+class RemoteNexusExchange
+{
+    public:
+
+        /** How the flows are moved between ranks. */
+        enum class Transport {
+            /** One ``MPI_Ineighbor_alltoallv`` per time step */
+            neighbor_collective,
+            /** ``MPI_Put`` into the windows of downstream neighbors, synchronized by post-start-complete-wait */
+            one_sided
+        };
+
+        /**
+         * @brief Set up the exchange for the given nexuses, and attach each of them to it.
+         *
+         * This is collective over @p comm, from which the exchange's own graph communicator is created.  Ranks keep
+         * their numbers in it, since each was already given the partition of its rank.
+         *
+         * @param nexuses All the remote nexuses of this rank.
+         * @param comm The communicator of the ranks the nexuses are partitioned over.
+         * @param transport How the flows are moved between ranks.
+         * @param chunk_steps The most time steps each exchange moves the flows of.
+         * @throws std::invalid_argument If @p chunk_steps is less than 1.
+         */
+        RemoteNexusExchange(const std::vector<std::shared_ptr<HY_PointHydroNexusRemote>>& nexuses,
+                            MPI_Comm comm = MPI_COMM_WORLD, Transport transport = Transport::neighbor_collective,
+                            std::size_t chunk_steps = 1);
+
+        virtual ~RemoteNexusExchange();
+
+        RemoteNexusExchange(const RemoteNexusExchange&) = delete;
+        RemoteNexusExchange& operator=(const RemoteNexusExchange&) = delete;
+
+        /**
+         * @brief Stage the outgoing flow of a sending nexus for the next exchange.
+         *
+         * The flows of each nexus are staged in time step order, from the first of the chunk, which is the time step
+         * receives were last posted for or, if they were not, the time step of the first flow staged since the last
+         * exchange.  Once every flow this rank sends is staged for all ``chunk_steps`` time steps of the chunk, its
+         * exchange is started.
+         *
+         * @param nexus_id The id of the sending nexus.
+         * @param t The time step of the flow.
+         * @param flow The flow to send downstream.
+         * @throws std::runtime_error If @p t is not in the chunk, or the exchange of the chunk has started.
+         */
+        void stage_flow(const std::string& nexus_id, long t, double flow);
+
+        /**
+         * @brief Post the receives of all incoming flows for the chunk starting at time step @p t, if they are not
+         * already.
+         *
+         * With the neighbor collective transport, the receives are posted as part of the exchange of the chunk, so this
+         * starts it if this rank sends no flows, and otherwise leaves it to start once they are all staged.  With the
+         * one-sided transport, this opens the window of this rank to the puts of its upstream neighbors for the chunk.
+         *
+         * @param t The first time step of the chunk to receive.
+         */
+        void post_receives(long t);
+
+        /**
+         * @brief Send all staged flows for time step @p t, and receive all incoming flows for it.
+         *
+         * Received flows are added to their receiving nexuses before this returns.
+         *
+         * @param t The time step to exchange.
+         * @param post_next Whether to post the receives for the time step after @p t before returning, which every
+         *                  rank may do independently, but must not for the last time step it exchanges.
+         * @throws std::runtime_error If a sending nexus has no staged flow for @p t, or a neighbor sent another step.
+         */
+        void exchange(long t, bool post_next = false) {
+            exchange_chunk(t, 1, post_next);
+        }
+
+        /**
+         * @brief Send all staged flows for the chunk of @p count time steps from @p first, and receive all incoming
+         * flows for it.
+         *
+         * Received flows are added to their receiving nexuses, for each time step in turn, before this returns.
+         *
+         * @param first The first time step of the chunk.
+         * @param count The number of time steps of the chunk, from 1 to ``chunk_steps``; a chunk that is started as
+         *              soon as its flows are staged has ``chunk_steps``.
+         * @param post_next Whether to post the receives for the chunk after this one before returning, which every
+         *                  rank may do independently, but must not for the last chunk it exchanges.
+         * @throws std::invalid_argument If @p count is out of range.
+         * @throws std::runtime_error If flows were staged for another chunk, a sending nexus has no staged flow for
+         *                            every time step of the chunk, or a neighbor sent another chunk.
+         */
+        void exchange_chunk(long first, long count, bool post_next = false);
+
+        /** @return The most time steps each exchange moves the flows of. */
+        std::size_t get_chunk_steps() const {
+            return chunk_steps;
+        }
+
+        /**
+         * @return The number of ranks this rank sends flows to and receives flows from, respectively.
+         */
+        std::pair<std::size_t, std::size_t> get_neighbor_counts() const {
+            return std::make_pair(send_channels.size(), recv_channels.size());
+        }
+
+        /**
+         * @brief Describe where the exchange is, e.g. for a report of a run that seems stuck: the first time steps of
+         * the chunks it last started, posted receives for and completed sends of, whether its request is outstanding,
+         * and its neighbors.
+         */
+        void write_status(std::ostream& out) const {
+            out << "exchange_chunk_steps " << chunk_steps << "\n"
+                << "exchange_started_step " << started_step << "\n"
+                << "exchange_posted_step " << posted_step << "\n"
+                << "exchange_completing_step " << completing_step << " (" << complete_nexuses << " of "
+                << send_slots.size() << " sending nexuses complete)\n"
+                << "exchange_request_outstanding " << (request != MPI_REQUEST_NULL ? "true" : "false") << "\n";
+            for (const auto* channels : {&send_channels, &recv_channels}) {
+                out << (channels == &send_channels ? "exchange_send_ranks" : "exchange_receive_ranks");
+                for (const Channel& channel : *channels) {
+                    out << " " << channel.rank;
+                }
+                out << "\n";
+            }
+        }
+
+        /**
+         * @return An estimate of the bytes held by the exchange's buffers and channels (see utils::MemoryReport), not
+         *         counting what the MPI library holds for its communicator and window.
+         */
+        std::size_t get_memory_bytes() const {
+            using utils::MemoryReport;
+            std::size_t bytes = sizeof(*this) + MemoryReport::bytes_of(send_buffer) + MemoryReport::bytes_of(recv_buffer)
+                + MemoryReport::bytes_of(send_counts) + MemoryReport::bytes_of(send_offsets)
+                + MemoryReport::bytes_of(recv_counts) + MemoryReport::bytes_of(recv_offsets)
+                + MemoryReport::bytes_of(target_offsets) + MemoryReport::bytes_of(send_slots)
+                + MemoryReport::bytes_of(send_channels) + MemoryReport::bytes_of(recv_channels);
+            for (const auto& slot : send_slots) {
+                bytes += MemoryReport::bytes_of(slot.first);
+            }
+            for (const auto* channels : {&send_channels, &recv_channels}) {
+                for (const Channel& channel : *channels) {
+                    bytes += MemoryReport::bytes_of(channel.nexus_ids) + MemoryReport::bytes_of(channel.nexuses)
+                        + MemoryReport::bytes_of(channel.staged_steps);
+                }
+            }
+            return bytes;
+        }
+
+    private:
+
+        /** The flows going to, or coming from, one neighbor rank, as a block of the send or receive buffer. */
+        struct Channel {
+            int rank;
+            std::vector<std::string> nexus_ids;
+            std::vector<HY_PointHydroNexusRemote*> nexuses;
+            /** Where the block starts in its buffer; the block holds the first time step and length of the chunk, then
+                for each time step of the chunk, the flow of each nexus */
+            int offset = 0;
+            /** The last time step each nexus staged a flow for */
+            std::vector<long> staged_steps;
+        };
+
+        /** Start sending the flows of the chunk of @p count time steps from @p first, if they are not already. */
+        void start(long first, long count);
+
+        /** Set up the window, and the groups of neighbors, of the one-sided transport. */
+        void init_one_sided();
+
+        Transport transport;
+        std::size_t chunk_steps;
+        MPI_Comm comm;
+        std::vector<Channel> send_channels;
+        std::vector<Channel> recv_channels;
+        /** Sending nexus id -> (send channel index, slot) */
+        std::unordered_map<std::string, std::pair<std::size_t, std::size_t>> send_slots;
+        /** The blocks of every channel, with their sizes and offsets, in the neighbor order of the communicator */
+        std::vector<double> send_buffer;
+        std::vector<double> recv_buffer;
+        std::vector<int> send_counts, send_offsets;
+        std::vector<int> recv_counts, recv_offsets;
+        /** The first time step of the chunk being staged or exchanged, or -1 between chunks */
+        long chunk_first = -1;
+        /** The chunk sending nexuses are being completed for, and how many have staged its last time step */
+        long completing_step = -1;
+        std::size_t complete_nexuses = 0;
+        MPI_Request request = MPI_REQUEST_NULL;
+        /** The chunk the exchange was last started for, and the receives last posted for */
+        long started_step = -1;
+        long posted_step = -1;
+        /** For the one-sided transport, the receive buffer as a window, where each send channel's block goes in the
+            window of its rank, and the groups of upstream and downstream neighbors */
+        MPI_Win window = MPI_WIN_NULL;
+        std::vector<MPI_Aint> target_offsets;
+        MPI_Group source_group = MPI_GROUP_NULL;
+        MPI_Group destination_group = MPI_GROUP_NULL;
+};
+
+#endif // NGEN_MPI_ACTIVE
+#endif // NGEN_REMOTE_NEXUS_EXCHANGE_HPP
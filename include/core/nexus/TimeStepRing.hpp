@@ -0,0 +1,175 @@
+#ifndef NGEN_TIME_STEP_RING_HPP
+#define NGEN_TIME_STEP_RING_HPP
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Ring of the per time step bookkeeping of a nexus, holding only the time steps in progress.
+ *
+ * Time step ``t`` is kept in slot ``t mod size()``.  A slot is reused once its time step is before the minimum time
+ * step, or completed and no later than the watermark, through which every time step from the minimum on has
+ * completed; when the slot of a new time step still holds one that is needed, the ring grows until every time step
+ * in progress has a slot of its own.  So the ring stays as small as the window of time steps the nexus is used in,
+ * as long as the minimum is the first time step used (see @ref set_mintime).
+ *
+ * Each slot is a @p Payload, which must have a ``reset()`` member, called when the slot is claimed for a new time
+ * step, that clears what it records while keeping any capacity it has.  The ring is not synchronized.
+ *
+ * @tparam Payload The bookkeeping of a single time step.
+ */
+template<typename Payload>
+class TimeStepRing
+{
+  public:
+
+    typedef long time_step_t;
+
+    /** A slot of the ring: the bookkeeping of time step ``t``. */
+    struct Slot : Payload {
+        enum State { FREE, OPEN, COMPLETED };
+
+        time_step_t t{0};
+        State state{FREE};
+    };
+
+    /**
+     * @param initial_slots The slots of the new ring; enough for the time steps in progress at once when running one
+     *                      step at a time.
+     * @param prototype The payload each slot starts with, e.g., with room for a known number of contributions.
+     */
+    explicit TimeStepRing(std::size_t initial_slots = 4, const Payload& prototype = Payload())
+    {
+        Slot slot;
+        static_cast<Payload&>(slot) = prototype;
+        slots.assign(initial_slots > 0 ? initial_slots : 1, slot);
+    }
+
+    /** @return The slot of time step @p t, or nullptr if @p t has no bookkeeping. */
+    Slot* find(time_step_t t)
+    {
+        Slot& slot = slots[index_of(t, slots.size())];
+        return ( slot.state != Slot::FREE && slot.t == t ) ? &slot : nullptr;
+    }
+
+    /** @return The slot of time step @p t, claiming one (and growing the ring to make room, if needed) if it has none. */
+    Slot& claim(time_step_t t)
+    {
+        while ( true )
+        {
+            Slot& slot = slots[index_of(t, slots.size())];
+            if ( slot.state != Slot::FREE && slot.t == t ) return slot;
+            if ( is_reusable(slot) )
+            {
+                slot.reset();
+                slot.t = t;
+                slot.state = Slot::OPEN;
+                return slot;
+            }
+            grow();
+        }
+    }
+
+    /** @return Whether time step @p t has completed. */
+    bool is_completed(time_step_t t)
+    {
+        if ( t <= completed_through ) return true;
+        Slot* slot = find(t);
+        return slot != nullptr && slot->state == Slot::COMPLETED;
+    }
+
+    /** Mark the time step of @p slot completed, and free it and any later ones completed before it. */
+    void complete(Slot& slot)
+    {
+        slot.state = Slot::COMPLETED;
+        while ( true )
+        {
+            Slot* next = find(completed_through + 1);
+            if ( next == nullptr || next->state != Slot::COMPLETED ) break;
+            ++completed_through;
+            next->state = Slot::FREE;
+        }
+    }
+
+    /**
+     * @brief Set the first time step that may be used, expiring the bookkeeping of earlier ones.
+     *
+     * The watermark starts just before time step 0, so a nexus first used at a later time step, e.g., in a run
+     * restarted from a checkpoint, must be given it here, or no completed slot is ever reused.
+     */
+    void set_mintime(time_step_t t)
+    {
+        min_timestep = t;
+        if ( completed_through < min_timestep - 1 )
+        {
+            completed_through = min_timestep - 1;
+        }
+        for ( auto& slot : slots )
+        {
+            if ( slot.state != Slot::FREE && slot.t < min_timestep )
+            {
+                slot.state = Slot::FREE;
+            }
+        }
+    }
+
+    /** @return The first time step that may be used. */
+    time_step_t get_mintime() const { return min_timestep; }
+
+    /** @return The slots, e.g., to estimate the memory they hold. */
+    const std::vector<Slot>& get_slots() const { return slots; }
+
+  private:
+
+    static std::size_t index_of(time_step_t t, std::size_t size)
+    {
+        return ((t % (time_step_t)size) + size) % size;
+    }
+
+    bool is_reusable(const Slot& slot) const
+    {
+        return slot.state == Slot::FREE
+            || slot.t < min_timestep
+            || ( slot.state == Slot::COMPLETED && slot.t <= completed_through );
+    }
+
+    /** Double the ring until the time steps still needed each have a slot of their own, keeping their bookkeeping. */
+    void grow()
+    {
+        std::vector<Slot> live;
+        for ( auto& old : slots )
+        {
+            if ( !is_reusable(old) ) live.push_back(std::move(old));
+        }
+        std::size_t size = slots.size() * 2;
+        std::vector<bool> taken;
+        for ( bool collides = true; collides; size *= 2 )
+        {
+            collides = false;
+            taken.assign(size, false);
+            for ( const auto& old : live )
+            {
+                std::size_t index = index_of(old.t, size);
+                collides = collides || taken[index];
+                taken[index] = true;
+            }
+            if ( !collides ) break;
+        }
+        slots.clear();
+        slots.resize(size);
+        for ( auto& old : live )
+        {
+            slots[index_of(old.t, size)] = std::move(old);
+        }
+    }
+
+    std::vector<Slot> slots;
+
+    time_step_t min_timestep{0};
+
+    /** Every time step from min_timestep through completed_through is completed; later ones may be too. */
+    time_step_t completed_through{-1};
+};
+
+#endif //NGEN_TIME_STEP_RING_HPP
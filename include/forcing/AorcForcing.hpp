@@ -13,6 +13,15 @@
 #define CSDMS_STD_NAME_WIND_U_X "land_surface_wind__x_component_of_velocity"
 #define CSDMS_STD_NAME_WIND_V_Y "land_surface_wind__y_component_of_velocity"
 #define NGEN_STD_NAME_SPECIFIC_HUMIDITY "atmosphere_air_water~vapor__relative_saturation" // This is not present in standard names, use this for now... may change!
+#define NGEN_STD_NAME_WIND_SPEED "land_surface_wind__speed" // Derived from the velocity components; see DerivedForcingDataProvider.hpp
+
+// Supported Standard Names for BMI variables
+// This is needed to provide a calculated potential ET value back to a BMI model
+#define NGEN_STD_NAME_POTENTIAL_ET_FOR_TIME_STEP "potential_evapotranspiration"
+
+// Taken from the CSDMS Standard Names list
+// TODO: need to add these in for anything BMI model input or output variables we need to know how to recognize
+#define CSDMS_STD_NAME_POTENTIAL_ET "water_potential_evaporation_flux"
 
 // Recognized Forcing Value Names (in particular for use when configuring BMI input variables)
 // TODO: perhaps create way to configure a mapping of these to something different
@@ -27,9 +36,16 @@
 #define AORC_FIELD_NAME_SPEC_HUMID_2M_AG "SPFH_2maboveground"
 
 #include <map>
+#include <memory>
+#include <string>
+#include <vector>
 
 //using namespace std// causes build error on gcc-12 with boost::geometry
 
+namespace geojson {
+    class FeatureCollection;
+}
+
 /**
  * @brief forcing_params providing configuration information for forcing time period and source.
  */
@@ -42,6 +58,23 @@ struct forcing_params
   std::string provider;
   time_t simulation_start_t;
   time_t simulation_end_t;
+  /// Memory budget, in megabytes, for the values a provider caches from the forcing file; 0 selects its default
+  size_t cache_size_mb = 0;
+  /// Number of blocks of time steps a provider reads ahead of their use in the background; 0 only reads on demand
+  size_t prefetch_blocks = 1;
+  /// Number of time steps of a CSV forcing file a provider keeps in memory, refilled with the next ones in one pass
+  /// through the file as the simulation reaches them; 0 keeps the whole simulation period
+  size_t stream_window_steps = 0;
+  /// Names of forcing properties derived from the raw forcing, e.g. potential ET, computed once per time step for
+  /// every catchment sharing the forcing and provided as any other property; empty derives none
+  std::vector<std::string> derived_variables;
+  /// Ids of every catchment of this process, so a provider sharing a file with other processes (e.g., MPI ranks)
+  /// may read only their part of it; null for every catchment in the file
+  std::shared_ptr<const std::vector<std::string>> feature_ids;
+  /// File the weights of the cells of gridded forcing in each catchment are kept in; empty computes them every run
+  std::string weights_path;
+  /// The catchments of this process, whose polygons gridded forcing is aggregated over; null if not known
+  std::shared_ptr<geojson::FeatureCollection> fabric;
   /*
     Constructor for forcing_params
   */
@@ -5,14 +5,24 @@
 
 namespace data_access
 {
-    template <class data_type, class selection_type> class AsyncDataProvider : public DataProvider<data_type, selection_type>
+    /**
+     * A data provider that can read data ahead of its use.
+     *
+     * Requesting a value schedules the data it depends on to be read in the background, so a later @ref get_value
+     * for the same selection does not wait on the read.
+     *
+     * @tparam base_type The provider interface extended, which lets e.g. a @ref GenericDataProvider be asynchronous.
+     */
+    template <class data_type, class selection_type, class base_type = DataProvider<data_type, selection_type>> class AsyncDataProvider : public base_type
     {
-        virtual bool value_ready(selection_type selector, const std::string &variable_name, const time_t &init_time, const long &duration_s,
-                                 const std::string &output_units, ReSampleMethod m=SUM) = 0;
+        public:
 
-        virtual void request_value(selection_type selector, const std::string &variable_name, const time_t &init_time, const long &duration_s,
-                                 const std::string &output_units, ReSampleMethod m=SUM) = 0;
+        /** Whether the data of a selection has been read, so @ref get_value will not wait on a read. */
+        virtual bool value_ready(const selection_type& selector) = 0;
+
+        /** Schedule the data of a selection to be read in the background, returning without waiting for it. */
+        virtual void request_value(const selection_type& selector) = 0;
     };
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,82 @@
+#ifndef NGEN_CSV_FORCING_PRELOADER_HPP
+#define NGEN_CSV_FORCING_PRELOADER_HPP
+
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <vector>
+
+#include "CsvPerFeatureForcingProvider.hpp"
+#include "ThreadPool.hpp"
+
+/**
+ * @brief Reads CSV forcing files into the shared providers of @ref CsvPerFeatureForcingProvider in the background, so
+ * formulations constructed meanwhile find their forcing already parsed.
+ *
+ * The files are read in the given order by a pool of threads of its own, started on construction, which claim them in
+ * turn; a formulation getting to its file first simply reads it itself, and the pool then finds it read.  Files that
+ * fail to read are skipped, so the error is raised by the formulation using the file, as without preloading.
+ *
+ * @code {.cpp}
+ * CsvForcingPreloader preloader(forcing_configs, 16);
+ * // ... construct the formulations, each calling CsvPerFeatureForcingProvider::get_shared_provider
+ * preloader.wait();
+ * @endcode
+ */
+class CsvForcingPreloader
+{
+    public:
+
+    /**
+     * @param forcing_configs The forcing configs of the files to read, in the order to read them.
+     * @param threads The number of threads reading the files; ``0`` selects the number of CPUs the process may run
+     *                on.
+     */
+    CsvForcingPreloader(std::vector<forcing_params> forcing_configs, std::size_t threads)
+        : configs(std::move(forcing_configs))
+    {
+        if (configs.empty()) {
+            return;
+        }
+        loader = std::thread([this, threads]() {
+            utils::ThreadPool pool(threads);
+            pool.parallel_for(configs.size(), [this](std::size_t i) {
+                if (is_stopped.load(std::memory_order_relaxed)) {
+                    return;
+                }
+                try {
+                    CsvPerFeatureForcingProvider::get_shared_provider(configs[i]);
+                }
+                catch (const std::exception&) {
+                    // Left for the formulation using the file to report
+                }
+            });
+        });
+    }
+
+    CsvForcingPreloader(const CsvForcingPreloader&) = delete;
+    CsvForcingPreloader& operator=(const CsvForcingPreloader&) = delete;
+
+    /** Stop reading the files not yet started, e.g. when construction failed, and wait for those being read. */
+    ~CsvForcingPreloader()
+    {
+        is_stopped = true;
+        wait();
+    }
+
+    /** Wait until every file has been read, or skipped. */
+    void wait()
+    {
+        if (loader.joinable()) {
+            loader.join();
+        }
+    }
+
+    private:
+
+    std::vector<forcing_params> configs;
+    std::atomic<bool> is_stopped{false};
+    std::thread loader;
+};
+
+#endif // NGEN_CSV_FORCING_PRELOADER_HPP
@@ -9,17 +9,23 @@
 #include <fstream>
 #include <iostream>
 #include <unordered_map>
+#include <map>
+#include <mutex>
+#include <tuple>
 #include <boost/algorithm/string.hpp>
 #include <boost/lexical_cast.hpp>
-#include "CSV_Reader.h"
+#include "MappedCsvReader.hpp"
 #include <ctime>
 #include <time.h>
 #include <memory>
+#include <limits>
 #include "AorcForcing.hpp"
 #include "GenericDataProvider.hpp"
+#include "ResampleWindow.hpp"
 #include "DataProviderSelectors.hpp"
 #include <exception>
 #include <UnitsHelper.hpp>
+#include <Logger.hpp>
 
 /**
  * @brief Forcing class providing time-series precipiation forcing data to the model.
@@ -30,15 +36,68 @@ class CsvPerFeatureForcingProvider : public data_access::GenericDataProvider
 
     typedef struct tm time_type;
 
+    /**
+     * @brief Factory method that creates or returns an existing provider for the path and simulation time window of
+     * the provided config, so a forcing file is parsed once however many formulations and nested modules use it.
+     *
+     * Files are parsed outside the lock of the shared providers, so those of different files are parsed concurrently
+     * when called from several threads; a caller wanting a file another thread is parsing waits for it.  A file that
+     * fails to parse is not kept, so the next caller for it parses it, and fails, again.
+     *
+     * @param forcing_config The forcing config, with the path to a CSV forcing file.
+     */
+    static std::shared_ptr<CsvPerFeatureForcingProvider> get_shared_provider(const forcing_params& forcing_config)
+    {
+        std::shared_ptr<shared_provider> shared;
+        {
+            const std::lock_guard<std::mutex> lock(shared_providers_mutex);
+            auto key = std::make_tuple(forcing_config.path, forcing_config.simulation_start_t, forcing_config.simulation_end_t);
+            std::shared_ptr<shared_provider>& entry = shared_providers[key];
+            if(entry == nullptr){
+                entry = std::make_shared<shared_provider>();
+            }
+            shared = entry;
+        }
+        const std::lock_guard<std::mutex> lock(shared->mutex);
+        if(shared->provider == nullptr){
+            shared->provider = std::make_shared<CsvPerFeatureForcingProvider>(forcing_config);
+        }
+        return shared->provider;
+    }
+
 
     CsvPerFeatureForcingProvider(forcing_params forcing_config):start_date_time_epoch(forcing_config.simulation_start_t),
                                            end_date_time_epoch(forcing_config.simulation_end_t),
                                            current_date_time_epoch(forcing_config.simulation_start_t),
-                                           forcing_vector_index(-1)
+                                           forcing_vector_index(-1),
+                                           forcing_file_name(forcing_config.path),
+                                           // a window of at least two time steps, for the record duration
+                                           window_steps(forcing_config.stream_window_steps == 0 ? 0 : std::max<size_t>(forcing_config.stream_window_steps, 2))
     {
         read_csv(forcing_config.path);
     }
 
+    /**
+     * Read the forcing file again, for data up to the new end time, since the file may have been appended to.
+     *
+     * A provider shared by several formulations is extended by each of them, so the file is not read again for an
+     * end time it was already read for.
+     */
+    void extend_to(time_t end_time) override
+    {
+        const std::lock_guard<std::mutex> lock(window_mutex);
+        if (end_time == end_date_time_epoch && !time_epoch_vector.empty()) {
+            return;
+        }
+        end_date_time_epoch = end_time;
+        time_epoch_vector.clear();
+        forcing_vectors.clear();
+        available_forcings.clear();
+        available_forcings_units.clear();
+        forcing_vector_index = -1;
+        read_csv(forcing_file_name);
+    }
+
     // BEGIN DataProvider interface methods
 
     /**
@@ -47,8 +106,8 @@ class CsvPerFeatureForcingProvider : public data_access::GenericDataProvider
      * @return The inclusive beginning of the period of time over which this instance can provide this data.
      */
     long get_data_start_time() override {
-        //FIXME: Trace this back and you will find that it is the simulation start time, not having anything to do with the forcing at all.
-        // Apparently this "worked", but at a minimum the description above is false.
+        //Only the rows of the simulation period are loaded, so this is the simulation start time, which formulations
+        //rely on as the epoch of their model time; other providers report it likewise (see SimulationPeriod)
         return start_date_time_epoch;
     }
 
@@ -67,7 +126,7 @@ class CsvPerFeatureForcingProvider : public data_access::GenericDataProvider
      * @return The duration of one record of this forcing source
      */
     long record_duration() override {
-        return time_epoch_vector[1] - time_epoch_vector[0];
+        return time_step_s;
     }
 
     /**
@@ -83,27 +142,19 @@ class CsvPerFeatureForcingProvider : public data_access::GenericDataProvider
         if (epoch_time < start_date_time_epoch) {
             throw std::out_of_range("Forcing had bad pre-start time for index query: " + std::to_string(epoch_time));
         }
-        size_t i = 0;
-        // 1 hour
-        time_t seconds_in_time_step = 3600;
-        time_t time = start_date_time_epoch;
-        while (epoch_time >= time + seconds_in_time_step && time < end_date_time_epoch) {
-           i++;
-           time += seconds_in_time_step;
-        }
-        // The end_date_time_epoch is the epoch value of the BEGINNING of the last time step, not its end.
-        // I.e., to make sure we cover it, we have to go another time step beyond.
-        if (time >= end_date_time_epoch + 3600) {
-            throw std::out_of_range("Forcing had bad beyond-end time for index query: " + std::to_string(epoch_time));
-        }
-        else {
-            return i;
-        }
+        // The end_date_time_epoch is the epoch value of the BEGINNING of the last time step, not its end, so times
+        // after it are in the last time step.
+        return std::min(size_t((epoch_time - start_date_time_epoch) / time_step_s), get_num_time_steps() - 1);
     }
 
     /**
      * Get the value of a forcing property for an arbitrary time period, converting units if needed.
      *
+     * The value is resampled from the forcing time steps overlapping the period, whatever their length, without
+     * allocating; variables that are sums over a time step are summed over the period (in proportion to how much of
+     * each time step is in it), and others averaged over it.  Time steps of the period past the end of a forcing file
+     * that ends before the model end time take the value of its last time step.
+     *
      * An @ref std::out_of_range exception should be thrown if the data for the time period is not available.
      *
      * @param selector Object storing information about the data to be queried
@@ -114,10 +165,15 @@ class CsvPerFeatureForcingProvider : public data_access::GenericDataProvider
     double get_value(const CatchmentAggrDataSelector& selector, data_access::ReSampleMethod m) override
     {
         size_t current_index;
-        long time_remaining = selector.get_duration_secs();
+        const long duration = selector.get_duration_secs();
         auto init_time = selector.get_init_time();
-        auto output_name = selector.get_variable_name();
-        auto output_units = selector.get_output_units();
+        const std::string& output_name = selector.get_variable_name();
+
+        // a streaming provider may move its window to the time steps of the period
+        std::unique_lock<std::mutex> window_lock(window_mutex, std::defer_lock);
+        if (window_steps > 0) {
+            window_lock.lock();
+        }
 
         try {
             current_index = get_ts_index_for_time(init_time);
@@ -126,46 +182,35 @@ class CsvPerFeatureForcingProvider : public data_access::GenericDataProvider
             throw std::out_of_range("Forcing had bad init_time " + std::to_string(init_time) + " for value request");
         }
 
-        std::vector<double> involved_time_step_values;
-
-        std::vector<long> involved_time_step_seconds;
-        long ts_involved_s;
-
-        time_t first_time_step_start_epoch = start_date_time_epoch + (current_index * 3600);
-        // Handle the first time step differently, since we need to do more to figure out how many seconds came from it
-        // Total time step size minus the offset of the beginning, before the init time
-        ts_involved_s = 3600 - (init_time - first_time_step_start_epoch);
-
-        involved_time_step_seconds.push_back(ts_involved_s);
-        involved_time_step_values.push_back(get_value_for_param_name(output_name, current_index));
-        time_remaining -= ts_involved_s;
-        current_index++;
-
-        while (time_remaining > 0) {
-            if(current_index >= time_epoch_vector.size())
-                return involved_time_step_values[involved_time_step_values.size()-1]; //TODO: Is this the right answer? Is returning any value off the end of the range valid?
-            ts_involved_s = time_remaining > 3600 ? 3600 : time_remaining;
-            involved_time_step_seconds.push_back(ts_involved_s);
-            involved_time_step_values.push_back(get_value_for_param_name(output_name, current_index));
-            time_remaining -= ts_involved_s;
-            current_index++;
-
+        const VariableHandle& variable = get_variable_handle(output_name);
+        data_access::ResampleWindow window;
+        if (!window.set(start_date_time_epoch, time_step_s, get_num_time_steps(), init_time, duration)) {
+            // a period starting past the last time step gets the value of the last time step
+            return get_value_for_time_step(variable, output_name, current_index);
         }
+
         double value = 0;
-        for (size_t i = 0; i < involved_time_step_values.size(); ++i) {
-            if (is_param_sum_over_time_step(output_name))
-                value += involved_time_step_values[i] * ((double)involved_time_step_seconds[i] / 3600.0);
-            else
-                value += involved_time_step_values[i] * ((double)involved_time_step_seconds[i] / (double)selector.get_duration_secs());
+        // the time step whose value is used; if the file ends within the period, its last time step holds for the rest
+        // of it, as it does for a period starting past the last time step
+        size_t data_index = window.first_index;
+        bool has_more_data = true;
+        for (size_t index = window.first_index; index <= window.last_index; ++index) {
+            if (index > window.first_index && has_more_data) {
+                has_more_data = load_time_step(index);
+                data_index = has_more_data ? index : data_index;
+            }
+            double overlap = window.overlap(index);
+            double weight = variable.is_sum ? overlap : overlap * time_step_s / (double)duration;
+            value += get_value_for_time_step(variable, output_name, data_index) * weight;
         }
 
         // Convert units
         try {
-            return UnitsHelper::get_converted_value(available_forcings_units[output_name], value, output_units);
+            return UnitsHelper::get_converted_value(variable.units, value, selector.get_output_units());
         }
         catch (const std::runtime_error& e){
             #ifndef UDUNITS_QUIET
-            std::cerr<<"WARN: Unit conversion unsuccessful - Returning unconverted value! (\""<<e.what()<<"\")"<<std::endl;
+            NGEN_LOG_WARNING("Unit conversion unsuccessful - Returning unconverted value! (\"" << e.what() << "\")");
             #endif
             return value;
         }
@@ -226,8 +271,26 @@ class CsvPerFeatureForcingProvider : public data_access::GenericDataProvider
         return available_forcings;
     }
 
+    /** @return The bytes of the forcing vectors and their times, read for the simulation period or window. */
+    size_t get_memory_bytes() override {
+        size_t bytes = time_epoch_vector.capacity() * sizeof(time_t);
+        for (const auto& forcing_vector : forcing_vectors) {
+            bytes += forcing_vector.second.capacity() * sizeof(double);
+        }
+        return bytes;
+    }
+
     private:
 
+    /** A shared provider, and the lock held while it is parsed. */
+    struct shared_provider {
+        std::mutex mutex;
+        std::shared_ptr<CsvPerFeatureForcingProvider> provider;
+    };
+
+    static std::mutex shared_providers_mutex;
+    static std::map<std::tuple<std::string, time_t, time_t>, std::shared_ptr<shared_provider>> shared_providers;
+
     /**
      * @brief Checks forcing vector index bounds and adjusts index if out of vector bounds
      * /// \todo: Bounds checking is based on precipitation vector. Consider potential for vectors of different sizes and indices.
@@ -239,7 +302,7 @@ class CsvPerFeatureForcingProvider : public data_access::GenericDataProvider
         {
             forcing_vector_index = 0;
             /// \todo: Return appropriate warning
-            std::cout << "WARNING: Forcing vector index is less than zero. Therefore, setting index to zero." << std::endl;
+            NGEN_LOG_WARNING("Forcing vector index is less than zero. Therefore, setting index to zero.");
         }
 
         //Check if forcing index is greater than or equal to the size of the size of the time vector and if so, set to zero.
@@ -247,62 +310,119 @@ class CsvPerFeatureForcingProvider : public data_access::GenericDataProvider
         {
             forcing_vector_index = time_epoch_vector.size() - 1;
             /// \todo: Return appropriate warning
-            std::cout << "WARNING: Reached beyond the size of the forcing vector. Therefore, setting index to last value of the vector." << std::endl;
+            NGEN_LOG_WARNING("Reached beyond the size of the forcing vector. Therefore, setting index to last value of the vector.");
         }
 
         return;
     }
 
     /**
-     * Get the current value of a forcing param identified by its name.
+     * The values, units and kind of a forcing param, looked up by any of its names once rather than on each request.
+     */
+    struct VariableHandle
+    {
+        const std::vector<double>* values;      // in forcing_vectors, so stable as the window moves
+        bool is_sum;                            // whether values are sums over a time step
+        std::string units;
+    };
+
+    /**
+     * Get the handle of a forcing param identified by its name.
      *
-     * @param name The name of the forcing param for which the current value is desired.
-     * @param index The index of the desired forcing time step from which to obtain the value.
-     * @return The particular param's value at the given forcing time step.
+     * @param name The name of the forcing param.
+     * @return The handle of the param.
+     * @throws std::runtime_error If there is no param with the name.
      */
-    inline double get_value_for_param_name(const std::string& name, int index) {
-        if (index >= time_epoch_vector.size() ) {
-            throw std::out_of_range("Forcing had bad index " + std::to_string(index) + " for value lookup of " + name);
+    const VariableHandle& get_variable_handle(const std::string& name) const {
+        auto found = variable_handles.find(name);
+        if (found == variable_handles.end()) {
+            throw std::runtime_error("Cannot get forcing value for unrecognized parameter name '" + name + "'.");
         }
+        return found->second;
+    }
 
-        std::string can_name = name;
-        if(data_access::WellKnownFields.count(can_name) > 0){
-            auto t = data_access::WellKnownFields.find(can_name)->second;
-            can_name = std::get<0>(t);
+    /** Set up the handles of the forcing params under every name they may be requested by. */
+    void set_variable_handles()
+    {
+        variable_handles.clear();
+        auto add_handle = [this](const std::string& name, const std::string& can_name) {
+            auto values = forcing_vectors.find(can_name);
+            if (values == forcing_vectors.end()) {
+                return;
+            }
+            auto units = available_forcings_units.find(name);
+            VariableHandle handle{&values->second, is_param_sum_over_time_step(name),
+                                  units == available_forcings_units.end() ? "" : units->second};
+            variable_handles.emplace(name, std::move(handle));
+        };
+        for (const auto& field : data_access::WellKnownFields) {
+            add_handle(field.first, std::get<0>(field.second));
         }
-
-        if (forcing_vectors.count(can_name) > 0) {
-            return forcing_vectors[can_name].at(index);
+        for (const auto& name : available_forcings) {
+            add_handle(name, name);
         }
-        else {
-            throw std::runtime_error("Cannot get forcing value for unrecognized parameter name '" + name + "'.");
+    }
+
+    /**
+     * Get the value of a forcing param at a forcing time step.
+     *
+     * @param variable The handle of the forcing param.
+     * @param name The name of the forcing param, for error messages.
+     * @param index The index of the desired forcing time step from which to obtain the value.
+     * @return The particular param's value at the given forcing time step.
+     */
+    inline double get_value_for_time_step(const VariableHandle& variable, const std::string& name, size_t index) {
+        if (!load_time_step(index)) {
+            throw std::out_of_range("Forcing had bad index " + std::to_string(index) + " for value lookup of " + name);
         }
+        return variable.values->at(index - window_start);
+    }
+
+    /** The number of forcing time steps from the start date-time through the end date-time. */
+    size_t get_num_time_steps() const {
+        return (end_date_time_epoch - start_date_time_epoch + time_step_s - 1) / time_step_s + 1;
     }
 
     /**
      * @brief Read Forcing Data from CSV
-     * Reads only data within the specified model start and end date-times.
+     * Reads only data within the specified model start and end date-times; when streaming, only the first window of
+     * it, with the rest read by @ref load_time_step as it is needed.
      * @param file_name Forcing file name
      */
     void read_csv(std::string file_name)
     {
-        int time_col_index = 0;
-        //std::map<std::string, int> col_indices;
-        std::vector<std::vector<double>*> local_valvec_index = {};
-
-        //Call CSVReader constuctor
-        CSVReader reader(file_name);
+        open_csv(file_name);
+        read_csv_rows(window_steps == 0 ? std::numeric_limits<size_t>::max() : window_steps);
+    }
 
-        //Get the data from CSV File
-        std::vector<std::vector<std::string> > data_list = reader.getData();
+    /**
+     * @brief Open the forcing CSV and read its header (first) row, setting up the forcing vectors of its columns if
+     * they are not already.
+     * @param file_name Forcing file name
+     */
+    void open_csv(const std::string& file_name)
+    {
+        // Parse the memory mapped file in place, without copying rows or fields into strings
+        csv_reader = std::unique_ptr<utils::MappedCsvReader>(new utils::MappedCsvReader(file_name));
+        csv_row_number = 0;
+        window_start = 0;
 
         // Process the header (first) row..
+        if (!csv_reader->next_row(csv_row)) {
+            throw std::runtime_error("Error: Forcing data " + file_name + " is empty.");
+        }
+        if (!available_forcings.empty()) {
+            return;
+        }
+        time_col_index = 0;
+        column_vectors.clear();
         int col_num = 0;
-        for (const auto& col_head : data_list[0]){
+        for (const auto& col_head_field : csv_row){
+            std::string col_head = col_head_field.str();
             //std::cerr << s << std::endl;
             if(col_head == "Time" || col_head == "time"){
                 time_col_index = col_num;
-                local_valvec_index.push_back(nullptr); // make sure the column indices line up!
+                column_vectors.push_back(nullptr); // make sure the column indices line up!
             } else {
                 std::string var_name = col_head;
                 std::string units = "";
@@ -318,64 +438,122 @@ class CsvPerFeatureForcingProvider : public data_access::GenericDataProvider
                 }
 
                 forcing_vectors[var_name] = {};
-                local_valvec_index.push_back(&(forcing_vectors[var_name]));
+                column_vectors.push_back(&(forcing_vectors[var_name]));
                 available_forcings.push_back(var_name);
                 available_forcings_units[var_name] = units;
             }
             col_num++;
         }
+        set_variable_handles();
+    }
 
+    /**
+     * @brief Read the next rows of the open forcing CSV within the model start and end date-times, until the forcing
+     * vectors hold @p max_steps time steps, closing the file once all of it has been read.
+     * @param max_steps The number of time steps to fill the forcing vectors to.
+     */
+    void read_csv_rows(size_t max_steps)
+    {
         time_t current_row_date_time_epoch;
         //Iterate through CSV starting on the second row
-        int i = 1;
-        for (i = 1; i < data_list.size(); i++)
+        while (time_epoch_vector.size() < max_steps)
         {
-            //Row vector
-            std::vector<std::string>& vec = data_list[i];
+            if (!csv_reader->next_row(csv_row)) {
+                if (csv_row_number == 0 || last_row_date_time_epoch < end_date_time_epoch)
+                {
+                    /// \todo TODO: Return appropriate error
+                    NGEN_LOG_WARNING("Forcing data ends before the model end time.");
+                    //throw std::runtime_error("Error: Forcing data ends before the model end time.");
+                }
+                csv_reader.reset();
+                return;
+            }
+            csv_row_number++;
+            const auto& row = csv_row;
 
-            struct tm current_row_date_time_utc = tm();
-            std::string time_str = vec[time_col_index];
             //TODO: Support more time string formats? This is basically ISO8601 but not complete, support TZ?
-            strptime(time_str.c_str(), "%Y-%m-%d %H:%M:%S", &current_row_date_time_utc);
-
-            //Convert current row date-time UTC to epoch time
-            current_row_date_time_epoch = timegm(&current_row_date_time_utc);
+            if (time_col_index >= row.size() || !utils::MappedCsvReader::parse_datetime(row[time_col_index], current_row_date_time_epoch)) {
+                // fall back to the more lenient strptime for anything but the exact expected format
+                struct tm current_row_date_time_utc = tm();
+                std::string time_str = time_col_index < row.size() ? row[time_col_index].str() : "";
+                strptime(time_str.c_str(), "%Y-%m-%d %H:%M:%S", &current_row_date_time_utc);
+
+                //Convert current row date-time UTC to epoch time
+                current_row_date_time_epoch = timegm(&current_row_date_time_utc);
+            }
+            last_row_date_time_epoch = current_row_date_time_epoch;
 
             //TODO: I am not sure this is a concern of this object. If forcing is retrieved that doesn't cover the
             //needed time period, isn't that the requester's concern? (Methods exist to check this...)
             //Ensure that forcing data covers the entire model period. Otherwise, throw an error.
-            if (i == 1 && start_date_time_epoch < current_row_date_time_epoch)
+            if (csv_row_number == 1 && start_date_time_epoch < current_row_date_time_epoch)
             {
                 struct tm start_date_tm;
                 gmtime_r(&start_date_time_epoch, &start_date_tm);
                 
                 char tm_buff[128];
                 strftime(tm_buff, 128, "%Y-%m-%d %H:%M:%S", &start_date_tm);
-                throw std::runtime_error("Error: Forcing data " + file_name + " begins after the model start time:" + std::string(tm_buff) + " < " + time_str);
+                throw std::runtime_error("Error: Forcing data " + forcing_file_name + " begins after the model start time:" + std::string(tm_buff) + " < " + (time_col_index < row.size() ? row[time_col_index].str() : ""));
             }
 
             
             if (start_date_time_epoch <= current_row_date_time_epoch && current_row_date_time_epoch <= end_date_time_epoch)
             {
                 time_epoch_vector.push_back(current_row_date_time_epoch);
+                if (time_epoch_vector.size() == 2) {
+                    // the native forcing interval, from the first two time steps of the window loaded
+                    time_step_s = std::max<time_t>(time_epoch_vector[1] - time_epoch_vector[0], 1);
+                }
 
-                int c = -1;
-                for (auto& s : vec){
-                    c++;
+                size_t columns = std::min(row.size(), column_vectors.size());
+                for (size_t c = 0; c < columns; c++){
                     if(c == time_col_index)
                         continue;
-                    boost::algorithm::trim(s);
-                    local_valvec_index[c]->push_back(boost::lexical_cast<double>(s)); // This is supposed to update the vector in the map...
+                    try {
+                        column_vectors[c]->push_back(utils::MappedCsvReader::parse_double(row[c])); // This is supposed to update the vector in the map...
+                    }
+                    catch (const std::invalid_argument& e) {
+                        throw std::runtime_error("Error: Forcing data " + forcing_file_name + " has an invalid value in row " + std::to_string(csv_row_number) + ": " + e.what());
+                    }
                 }
 
             }
 
         }
-        if (i <= 1 || current_row_date_time_epoch < end_date_time_epoch)
-        {
-            /// \todo TODO: Return appropriate error
-            std::cout << "WARNING: Forcing data ends before the model end time." << std::endl;
-            //throw std::runtime_error("Error: Forcing data ends before the model end time.");
+        csv_reader->release_read();
+    }
+
+    /**
+     * @brief Make sure a forcing time step is in the forcing vectors, moving the window of a streaming provider to
+     * start at it (reading the file again from its beginning for a time step before the window) if it is not.
+     * @param index The index of the forcing time step, from the model start time.
+     * @return Whether the forcing has the time step.
+     */
+    bool load_time_step(size_t index)
+    {
+        if (index < window_start) {
+            clear_time_steps(time_epoch_vector.size());
+            open_csv(forcing_file_name);
+        }
+        while (index >= window_start + time_epoch_vector.size()) {
+            if (csv_reader == nullptr) {
+                return false;
+            }
+            size_t passed = std::min(index - window_start, time_epoch_vector.size());
+            clear_time_steps(passed);
+            window_start += passed;
+            read_csv_rows(window_steps);
+        }
+        return true;
+    }
+
+    /** @brief Drop the first @p steps time steps of the forcing vectors. */
+    void clear_time_steps(size_t steps)
+    {
+        time_epoch_vector.erase(time_epoch_vector.begin(), time_epoch_vector.begin() + steps);
+        for (auto& forcing_vector : forcing_vectors) {
+            std::vector<double>& values = forcing_vector.second;
+            values.erase(values.begin(), values.begin() + std::min(steps, values.size()));
         }
     }
 
@@ -387,6 +565,17 @@ class CsvPerFeatureForcingProvider : public data_access::GenericDataProvider
 
     /// \todo: Consider making epoch time the iterator
     std::vector<time_t> time_epoch_vector;     
+    size_t window_start = 0;                  // the index of the first time step in the forcing vectors
+    size_t window_steps = 0;                  // the time steps a streaming provider keeps, or 0 to keep them all
+    std::mutex window_mutex;                  // guards the window of a streaming provider, which get_value moves
+    std::unique_ptr<utils::MappedCsvReader> csv_reader; // the forcing file while it has rows not yet read
+    std::vector<utils::MappedCsvReader::Field> csv_row;
+    std::vector<std::vector<double>*> column_vectors; // the forcing vector of each column, or null for the time
+    int time_col_index = 0;
+    int csv_row_number = 0;                   // the number of rows read after the header
+    time_t time_step_s = 3600;                // the length of each forcing time step
+    std::unordered_map<std::string, VariableHandle> variable_handles; // by every name a param may be requested by
+    time_t last_row_date_time_epoch = 0;
     int forcing_vector_index;
 
     /// \todo: Are these used?
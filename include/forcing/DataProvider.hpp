@@ -87,6 +87,12 @@ namespace data_access
 
         virtual bool is_property_sum_over_time_step(const std::string& name) {return false; }
 
+        /**
+         * @return An estimate of the bytes this provider holds in memory for the values it has read or computed,
+         *         e.g. its caches; the default is none.
+         */
+        virtual size_t get_memory_bytes() { return 0; }
+
         private:
     };
 
@@ -47,7 +47,7 @@ class CatchmentAggrDataSelector
      * 
      * @return std::string 
      */
-    std::string get_variable_name() const { return variable_name; }
+    const std::string& get_variable_name() const { return variable_name; }
 
     /**
      * @brief Get the initial time for this selector
@@ -68,7 +68,7 @@ class CatchmentAggrDataSelector
      * 
      * @return std::string 
      */
-    std::string get_output_units() const { return output_units; }
+    const std::string& get_output_units() const { return output_units; }
 
     /**
      * @brief Set the variable name for this selector
@@ -0,0 +1,73 @@
+#ifndef NGEN_DATA_VALUE_TYPE_HPP
+#define NGEN_DATA_VALUE_TYPE_HPP
+
+#include <cstddef>
+#include <cstring>
+
+namespace data_access
+{
+    /**
+     * The C++ types data values may be written as, so a destination's type can be chosen once, when it is set up,
+     * rather than by type name each time values are written.
+     */
+    enum class ValueType {
+        DOUBLE, FLOAT, SHORT, UNSIGNED_SHORT, INT, UNSIGNED_INT, LONG, UNSIGNED_LONG, LONG_LONG, UNSIGNED_LONG_LONG
+    };
+
+    /**
+     * @param type A value type.
+     * @return The size in bytes of a value of the type.
+     */
+    inline std::size_t value_type_size(ValueType type)
+    {
+        switch (type) {
+            case ValueType::DOUBLE: return sizeof(double);
+            case ValueType::FLOAT: return sizeof(float);
+            case ValueType::SHORT: return sizeof(short);
+            case ValueType::UNSIGNED_SHORT: return sizeof(unsigned short);
+            case ValueType::INT: return sizeof(int);
+            case ValueType::UNSIGNED_INT: return sizeof(unsigned int);
+            case ValueType::LONG: return sizeof(long);
+            case ValueType::UNSIGNED_LONG: return sizeof(unsigned long);
+            case ValueType::LONG_LONG: return sizeof(long long);
+            case ValueType::UNSIGNED_LONG_LONG: return sizeof(unsigned long long);
+        }
+        return sizeof(double);
+    }
+
+    template<typename T>
+    inline void cast_values(const double* values, std::size_t count, void* buffer)
+    {
+        T* typed = static_cast<T*>(buffer);
+        for (std::size_t i = 0; i < count; ++i) {
+            //Be safe and cast the input to the desired type
+            typed[i] = static_cast<T>(values[i]);
+        }
+    }
+
+    /**
+     * Store values in a buffer as values of the given type.
+     *
+     * @param type The type of the buffer's values.
+     * @param values The values to store.
+     * @param count The number of values to store.
+     * @param buffer Storage for at least @p count values of @p type.
+     */
+    inline void store_values(ValueType type, const double* values, std::size_t count, void* buffer)
+    {
+        switch (type) {
+            case ValueType::DOUBLE: std::memcpy(buffer, values, count * sizeof(double)); break;
+            case ValueType::FLOAT: cast_values<float>(values, count, buffer); break;
+            case ValueType::SHORT: cast_values<short>(values, count, buffer); break;
+            case ValueType::UNSIGNED_SHORT: cast_values<unsigned short>(values, count, buffer); break;
+            case ValueType::INT: cast_values<int>(values, count, buffer); break;
+            case ValueType::UNSIGNED_INT: cast_values<unsigned int>(values, count, buffer); break;
+            case ValueType::LONG: cast_values<long>(values, count, buffer); break;
+            case ValueType::UNSIGNED_LONG: cast_values<unsigned long>(values, count, buffer); break;
+            case ValueType::LONG_LONG: cast_values<long long>(values, count, buffer); break;
+            case ValueType::UNSIGNED_LONG_LONG: cast_values<unsigned long long>(values, count, buffer); break;
+        }
+    }
+}
+
+#endif //NGEN_DATA_VALUE_TYPE_HPP
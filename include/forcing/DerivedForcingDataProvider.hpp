@@ -0,0 +1,429 @@
+#ifndef NGEN_DERIVEDFORCINGDATAPROVIDER_HPP
+#define NGEN_DERIVEDFORCINGDATAPROVIDER_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "GenericDataProvider.hpp"
+#include "AorcForcing.hpp"
+#include <UnitsHelper.hpp>
+
+#include "EtCalcProperty.hpp"
+#include "EtBatch.hpp"
+
+namespace data_access {
+
+    /**
+     * A provider adding forcing properties derived from those of another provider, e.g. potential ET, to the ones it
+     * provides, so formulations and their modules request them as any other forcing rather than each deriving them.
+     *
+     * Which properties are derived is configured on construction (from the forcing's ``derived_variables``).  Each
+     * time step, the derived properties are computed once, from the raw forcing of every catchment of the instance at
+     * once: the raw values are gathered with @ref GenericDataProvider::get_values_for_ids, and the ET kernels run over
+     * all the catchments by the batched methods of ``et::batch``.  The values are then served to any formulation of
+     * those catchments asking for them for the same time period.  Other properties are passed through to the backing
+     * provider.
+     *
+     * Potential ET is computed by the combination method, with the same made-up land surface parameters, and from the
+     * same (AORC) forcings, as ``Bmi_Module_Formulation::calc_et``, except that radiation is resampled by its mean
+     * rather than summed, as it is a rate.  Wind speed is the magnitude of the mean wind velocity at 10 m.
+     *
+     * Instances serving the catchments of a shared provider are themselves shared, through @ref get_shared_provider,
+     * and synchronized, as the formulations of their catchments may run on several threads.
+     */
+    class DerivedForcingDataProvider : public GenericDataProvider {
+
+    public:
+
+        /**
+         * Get the instance deriving the given properties from a (shared) provider, creating it if needed.
+         *
+         * @param provider The backing provider.
+         * @param derived_variables The names of the properties to derive.
+         * @param catchment_ids The ids of the catchments whose properties are derived at once, or null to derive them
+         *                      for each catchment as it asks for them (e.g., for a provider of a single catchment).
+         * @return The shared instance.
+         * @throws std::invalid_argument If a property can't be derived.
+         */
+        static std::shared_ptr<DerivedForcingDataProvider> get_shared_provider(
+                std::shared_ptr<GenericDataProvider> provider, const std::vector<std::string>& derived_variables,
+                std::shared_ptr<const std::vector<std::string>> catchment_ids = nullptr)
+        {
+            const std::lock_guard<std::mutex> lock(shared_providers_mutex);
+            auto key = std::make_tuple(provider.get(), derived_variables, catchment_ids.get());
+            std::shared_ptr<DerivedForcingDataProvider>& p = shared_providers[key];
+            if (p == nullptr) {
+                p = std::make_shared<DerivedForcingDataProvider>(std::move(provider), derived_variables,
+                                                                 std::move(catchment_ids));
+            }
+            return p;
+        }
+
+        /**
+         * @param provider The backing provider.
+         * @param derived_variables The names of the properties to derive.
+         * @param catchment_ids The ids of the catchments whose properties are derived at once, or null to derive them
+         *                      for each catchment as it asks for them.
+         * @throws std::invalid_argument If a property can't be derived.
+         */
+        DerivedForcingDataProvider(std::shared_ptr<GenericDataProvider> provider,
+                                   const std::vector<std::string>& derived_variables,
+                                   std::shared_ptr<const std::vector<std::string>> catchment_ids = nullptr)
+            : backing_provider(std::move(provider))
+        {
+            for (const std::string& name : derived_variables) {
+                if (name == NGEN_STD_NAME_WIND_SPEED) {
+                    derive_wind_speed = true;
+                }
+                else if (name == NGEN_STD_NAME_POTENTIAL_ET_FOR_TIME_STEP || name == CSDMS_STD_NAME_POTENTIAL_ET) {
+                    derive_potential_et = true;
+                }
+                else {
+                    throw std::invalid_argument("Forcing property '" + name + "' can't be derived");
+                }
+            }
+            if (catchment_ids != nullptr) {
+                frame_ids = *catchment_ids;
+                for (size_t i = 0; i < frame_ids.size(); ++i) {
+                    frame_index[frame_ids[i]] = i;
+                }
+            }
+        }
+
+        /** @return Whether a forcing property can be derived by instances. */
+        static bool is_derivable(const std::string& name)
+        {
+            return name == NGEN_STD_NAME_WIND_SPEED || name == NGEN_STD_NAME_POTENTIAL_ET_FOR_TIME_STEP
+                   || name == CSDMS_STD_NAME_POTENTIAL_ET;
+        }
+
+        const std::vector<std::string>& get_avaliable_variable_names() override
+        {
+            const std::lock_guard<std::mutex> lock(frame_mutex);
+            variable_names = backing_provider->get_avaliable_variable_names();
+            if (derive_wind_speed) {
+                variable_names.emplace_back(NGEN_STD_NAME_WIND_SPEED);
+            }
+            if (derive_potential_et) {
+                variable_names.emplace_back(NGEN_STD_NAME_POTENTIAL_ET_FOR_TIME_STEP);
+                variable_names.emplace_back(CSDMS_STD_NAME_POTENTIAL_ET);
+            }
+            return variable_names;
+        }
+
+        long get_data_start_time() override
+        {
+            return backing_provider->get_data_start_time();
+        }
+
+        long get_data_stop_time() override
+        {
+            return backing_provider->get_data_stop_time();
+        }
+
+        long record_duration() override
+        {
+            return backing_provider->record_duration();
+        }
+
+        size_t get_ts_index_for_time(const time_t &epoch_time) override
+        {
+            return backing_provider->get_ts_index_for_time(epoch_time);
+        }
+
+        void extend_to(time_t end_time) override
+        {
+            backing_provider->extend_to(end_time);
+        }
+
+        /**
+         * Get the value of a forcing property for a time period, converting units if needed.
+         *
+         * Derived properties are computed for every catchment of the instance the first time one of them is asked
+         * for the period; the method is ignored for them, as they are always the mean over the period.
+         *
+         * @param selector The catchment, variable, time period and units of the value.
+         * @param m How data is to be resampled if there is a mismatch in data alignment or repeat rate
+         * @return The value of the forcing property for the described time period, with units converted if needed.
+         * @throws std::out_of_range If data for the time period is not available.
+         */
+        double get_value(const CatchmentAggrDataSelector& selector, ReSampleMethod m) override
+        {
+            const std::vector<double>* derived = get_derived_values(selector.get_variable_name());
+            if (derived == nullptr) {
+                return backing_provider->get_value(selector, m);
+            }
+            const std::lock_guard<std::mutex> lock(frame_mutex);
+            size_t index = get_frame_index(selector.get_id(), selector.get_init_time(), selector.get_duration_secs());
+            return UnitsHelper::get_converted_value(DERIVED_UNITS, (*derived)[index], selector.get_output_units());
+        }
+
+        std::vector<double> get_values(const CatchmentAggrDataSelector& selector, ReSampleMethod m) override
+        {
+            if (get_derived_values(selector.get_variable_name()) == nullptr) {
+                return backing_provider->get_values(selector, m);
+            }
+            // One value per record time step in the period
+            std::vector<double> values;
+            const time_t end_time = selector.get_init_time() + selector.get_duration_secs();
+            const long step = std::max(record_duration(), 1L);
+            for (time_t t = selector.get_init_time(); t < end_time; t += step) {
+                values.push_back(get_value(CatchmentAggrDataSelector(selector.get_id(), selector.get_variable_name(), t,
+                                                                     (long) std::min<time_t>(step, end_time - t),
+                                                                     selector.get_output_units()), m));
+            }
+            return values;
+        }
+
+        void get_values_for_ids(const std::vector<std::string>& ids, const CatchmentAggrDataSelector& selector, ReSampleMethod m, double* values) override
+        {
+            const std::vector<double>* derived = get_derived_values(selector.get_variable_name());
+            if (derived == nullptr) {
+                backing_provider->get_values_for_ids(ids, selector, m, values);
+                return;
+            }
+            const std::lock_guard<std::mutex> lock(frame_mutex);
+            for (size_t i = 0; i < ids.size(); ++i) {
+                size_t index = get_frame_index(ids[i], selector.get_init_time(), selector.get_duration_secs());
+                values[i] = (*derived)[index];
+            }
+            UnitsHelper::convert_values(DERIVED_UNITS, values, selector.get_output_units(), values, ids.size());
+        }
+
+        bool is_property_sum_over_time_step(const std::string& name) override
+        {
+            return get_derived_values(name) == nullptr && backing_provider->is_property_sum_over_time_step(name);
+        }
+
+        /** @return The bytes of the frame of derived values and its buffers, and those of the backing provider. */
+        size_t get_memory_bytes() override
+        {
+            size_t bytes = backing_provider->get_memory_bytes();
+            const std::lock_guard<std::mutex> lock(frame_mutex);
+            for (const std::vector<double>* buffer : {&wind_speed, &potential_et, &wind_u, &wind_v, &air_temperature_K,
+                                                       &specific_humidity, &air_pressure_Pa, &shortwave_W_per_sq_m,
+                                                       &longwave_W_per_sq_m, &et_rates}) {
+                bytes += buffer->capacity() * sizeof(double);
+            }
+            return bytes + frame_ids.capacity() * sizeof(std::string)
+                   + frame_index.size() * (sizeof(std::pair<const std::string, size_t>) + 2 * sizeof(void*));
+        }
+
+    private:
+
+        /** The units of every derived property. */
+        static constexpr const char* DERIVED_UNITS = "m s^-1";
+
+        /**
+         * Get the frame values of a derived property, or null if the property is not derived by this instance.
+         *
+         * The values are only those of the current frame after @ref get_frame_index is called for the period.
+         */
+        const std::vector<double>* get_derived_values(const std::string& name) const
+        {
+            if (derive_wind_speed && name == NGEN_STD_NAME_WIND_SPEED) {
+                return &wind_speed;
+            }
+            if (derive_potential_et && (name == NGEN_STD_NAME_POTENTIAL_ET_FOR_TIME_STEP || name == CSDMS_STD_NAME_POTENTIAL_ET)) {
+                return &potential_et;
+            }
+            return nullptr;
+        }
+
+        /**
+         * Get the index in the frame of a catchment for a time period, first computing the frame of the period if it
+         * is not the current one, and the values of the catchment if not yet in it.
+         *
+         * Must be called with the frame mutex held.
+         */
+        size_t get_frame_index(const std::string& id, time_t init_time, long duration_s)
+        {
+            if (init_time != frame_init_time || duration_s != frame_duration) {
+                frame_init_time = init_time;
+                frame_duration = duration_s;
+                frame_size = 0;
+            }
+            auto it = frame_index.find(id);
+            if (it == frame_index.end()) {
+                // a catchment not among those of the instance, computed on its own now and with the others from the
+                // next period on
+                it = frame_index.emplace(id, frame_ids.size()).first;
+                frame_ids.push_back(id);
+            }
+            if (it->second >= frame_size) {
+                try {
+                    compute_frame(frame_ids.size());
+                }
+                catch (...) {
+                    frame_duration = -1;
+                    throw;
+                }
+            }
+            return it->second;
+        }
+
+        /**
+         * Compute the derived properties of the catchments of the frame past those already computed, up to @p end.
+         */
+        void compute_frame(size_t end)
+        {
+            if (end <= frame_size) {
+                return;
+            }
+            const size_t n = end - frame_size;
+            std::vector<std::string> ids(frame_ids.begin() + frame_size, frame_ids.begin() + end);
+            wind_speed.resize(end);
+            potential_et.resize(end);
+
+            CatchmentAggrDataSelector selector(ids.front(), CSDMS_STD_NAME_WIND_U_X, frame_init_time, frame_duration, "m s^-1");
+            get_inputs(ids, selector, CSDMS_STD_NAME_WIND_U_X, "m s^-1", wind_u);
+            get_inputs(ids, selector, CSDMS_STD_NAME_WIND_V_Y, "m s^-1", wind_v);
+            for (size_t i = 0; i < n; ++i) {
+                wind_speed[frame_size + i] = std::hypot(wind_u[i], wind_v[i]);
+            }
+            if (derive_potential_et) {
+                compute_potential_et(ids, selector);
+            }
+            frame_size = end;
+        }
+
+        /** Get the mean values of a raw forcing property of some catchments over the period of the frame. */
+        void get_inputs(const std::vector<std::string>& ids, const CatchmentAggrDataSelector& selector,
+                        const char* variable_name, const char* units, std::vector<double>& values)
+        {
+            values.resize(ids.size());
+            backing_provider->get_values_for_ids(ids, CatchmentAggrDataSelector(selector.get_id(), variable_name,
+                                                                                selector.get_init_time(),
+                                                                                selector.get_duration_secs(), units),
+                                                 MEAN, values.data());
+        }
+
+        /**
+         * Compute the potential ET of some catchments of the frame, after their (10 m) wind speeds.
+         *
+         * This follows ``Bmi_Module_Formulation::calc_et``, with the combination method run for all the catchments at
+         * once, and only the net radiation computed per catchment.
+         */
+        void compute_potential_et(const std::vector<std::string>& ids, const CatchmentAggrDataSelector& selector)
+        {
+            // TODO: as in Bmi_Module_Formulation::calc_et, these are made-up values taken from EtSetParams.hpp, to be
+            //  replaced by land cover and model parameters of each catchment
+            const double canopy_resistance_sec_per_m = 50.0;
+            const double water_temperature_C = 15.5;
+            const double ground_heat_flux_W_per_sq_m = -10.0;
+            const double vegetation_height_m = 0.12;
+            const double zero_plane_displacement_height_m = 0.0003;
+            const double surface_longwave_emissivity = 1.0;
+            const double surface_shortwave_albedo = 0.22;
+            const double surface_skin_temperature_C = 12.0;
+
+            get_inputs(ids, selector, CSDMS_STD_NAME_SURFACE_TEMP, "K", air_temperature_K);
+            get_inputs(ids, selector, NGEN_STD_NAME_SPECIFIC_HUMIDITY, "kg/kg", specific_humidity);
+            get_inputs(ids, selector, CSDMS_STD_NAME_SURFACE_AIR_PRESSURE, "Pa", air_pressure_Pa);
+            get_inputs(ids, selector, CSDMS_STD_NAME_SOLAR_SHORTWAVE, "W m^-2", shortwave_W_per_sq_m);
+            get_inputs(ids, selector, CSDMS_STD_NAME_SOLAR_LONGWAVE, "W m^-2", longwave_W_per_sq_m);
+
+            const size_t n = ids.size();
+            et_forcing.resize(n);
+            et_params.resize(n);
+
+            struct et::evapotranspiration_options et_options;
+            et_options.yes_aorc = TRUE;
+            et_options.shortwave_radiation_provided = TRUE;
+            et_options.use_energy_balance_method = FALSE;
+            et_options.use_aerodynamic_method = FALSE;
+            et_options.use_combination_method = TRUE;
+            et_options.use_priestley_taylor_method = FALSE;
+            et_options.use_penman_monteith_method = FALSE;
+            struct et::surface_radiation_params surf_rad_params;
+            surf_rad_params.surface_longwave_emissivity = surface_longwave_emissivity;
+            surf_rad_params.surface_shortwave_albedo = surface_shortwave_albedo;
+            struct et::surface_radiation_forcing surf_rad_forcing;
+            surf_rad_forcing.surface_skin_temperature_C = surface_skin_temperature_C;
+
+            // AORC wind speeds are at 10 m, and the methods expect them at 2 m
+            const double wind_speed_2m_ratio = std::log(2.0 / zero_plane_displacement_height_m)
+                                               / std::log(10.0 / zero_plane_displacement_height_m);
+            for (size_t i = 0; i < n; ++i) {
+                const double air_temperature_C = air_temperature_K[i] - TK;
+                et_forcing.air_temperature_C[i] = air_temperature_C;
+                et_forcing.relative_humidity_percent[i] = -99.9;  // use specific humidity
+                et_forcing.specific_humidity_2m_kg_per_kg[i] = specific_humidity[i];
+                et_forcing.air_pressure_Pa[i] = air_pressure_Pa[i];
+                et_forcing.wind_speed_m_per_s[i] = wind_speed[frame_size + i] * wind_speed_2m_ratio;
+                et_forcing.canopy_resistance_sec_per_m[i] = canopy_resistance_sec_per_m;
+                et_forcing.water_temperature_C[i] = water_temperature_C;
+                et_forcing.ground_heat_flux_W_per_sq_m[i] = ground_heat_flux_W_per_sq_m;
+
+                et_params.wind_speed_measurement_height_m[i] = 2.0;
+                et_params.humidity_measurement_height_m[i] = 2.0;
+                et_params.vegetation_height_m[i] = vegetation_height_m;
+                et_params.zero_plane_displacement_height_m[i] = zero_plane_displacement_height_m;
+                et_params.momentum_transfer_roughness_length_m[i] = 0.0;  // zero uses the default
+                et_params.heat_transfer_roughness_length_m[i] = 0.0;
+
+                surf_rad_forcing.incoming_shortwave_radiation_W_per_sq_m = shortwave_W_per_sq_m[i];
+                surf_rad_forcing.incoming_longwave_radiation_W_per_sq_m = longwave_W_per_sq_m[i];
+                surf_rad_forcing.air_temperature_C = air_temperature_C;
+                // relative humidity from specific humidity; air may be supersaturated, but not past 100%
+                double actual_vapor_pressure_Pa = specific_humidity[i] * air_pressure_Pa[i] / 0.622;
+                surf_rad_forcing.relative_humidity_percent =
+                        100.0 * actual_vapor_pressure_Pa / et::calc_air_saturation_vapor_pressure_Pa(air_temperature_C);
+                if (100.0 < surf_rad_forcing.relative_humidity_percent) {
+                    surf_rad_forcing.relative_humidity_percent = 99.0;
+                }
+                et_forcing.net_radiation_W_per_sq_m[i] =
+                        et::calculate_net_radiation_W_per_sq_m(&et_options, &surf_rad_params, &surf_rad_forcing);
+            }
+
+            et::batch::calculate_intermediate_variables(et_params, et_forcing, et_inter_vars);
+            et::batch::evapotranspiration_combination_method(et_params, et_forcing, et_inter_vars, et_rates);
+            std::copy(et_rates.begin(), et_rates.begin() + n, potential_et.begin() + frame_size);
+        }
+
+        std::shared_ptr<GenericDataProvider> backing_provider;
+        bool derive_wind_speed = false;
+        bool derive_potential_et = false;
+        std::vector<std::string> variable_names;
+
+        // The frame: the derived properties of each catchment of frame_ids for the current period, of which the first
+        // frame_size are computed
+        std::mutex frame_mutex;
+        time_t frame_init_time = 0;
+        long frame_duration = -1;                       // no period yet
+        std::vector<std::string> frame_ids;
+        std::unordered_map<std::string, size_t> frame_index;
+        size_t frame_size = 0;
+        std::vector<double> wind_speed;
+        std::vector<double> potential_et;
+
+        // Buffers of the raw forcing and ET kernels, reused from one frame to the next
+        std::vector<double> wind_u;
+        std::vector<double> wind_v;
+        std::vector<double> air_temperature_K;
+        std::vector<double> specific_humidity;
+        std::vector<double> air_pressure_Pa;
+        std::vector<double> shortwave_W_per_sq_m;
+        std::vector<double> longwave_W_per_sq_m;
+        et::batch::evapotranspiration_forcing_arrays et_forcing;
+        et::batch::evapotranspiration_params_arrays et_params;
+        et::batch::intermediate_vars_arrays et_inter_vars;
+        std::vector<double> et_rates;
+
+        static std::mutex shared_providers_mutex;
+        static std::map<std::tuple<GenericDataProvider*, std::vector<std::string>, const std::vector<std::string>*>,
+                        std::shared_ptr<DerivedForcingDataProvider>> shared_providers;
+
+    };
+}
+
+#endif //NGEN_DERIVEDFORCINGDATAPROVIDER_HPP
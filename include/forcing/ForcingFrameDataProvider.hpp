@@ -0,0 +1,92 @@
+#ifndef NGEN_FORCINGFRAMEDATAPROVIDER_HPP
+#define NGEN_FORCINGFRAMEDATAPROVIDER_HPP
+
+#include <string>
+#include <vector>
+#include "WrappedDataProvider.hpp"
+
+namespace data_access {
+
+    /**
+     * A wrapped provider keeping the forcing frame of one catchment: every value it has served for the current time
+     * period, so each raw forcing value is fetched, resampled and converted once per time step however many consumers
+     * (e.g., the nested modules of a multi-BMI formulation) request it.
+     *
+     * Values are kept by variable name, resampling method and output units, and the frame is emptied when a value for
+     * another time period is requested.  The entries of the frame, and their strings, are reused from one time step
+     * to the next, so a warm frame serves its values without allocating.
+     *
+     * As with @ref WrappedDataProvider, the backing provider must outlive instances.  Instances are not synchronized,
+     * as each serves the consumers of a single catchment, which request their values in turn.
+     */
+    class ForcingFrameDataProvider : public WrappedDataProvider {
+
+    public:
+
+        /**
+         * @param provider Simple pointer to the provider of the catchment's forcing for the new instance to wrap.
+         */
+        explicit ForcingFrameDataProvider(GenericDataProvider* provider) : WrappedDataProvider(provider) { }
+
+        /**
+         * Get the value of a forcing property for a time period, from the frame if it was already requested for the
+         * period, converting units if needed.
+         *
+         * @param selector The variable, time period and units of the value.
+         * @param m How data is to be resampled if there is a mismatch in data alignment or repeat rate
+         * @return The value of the forcing property for the described time period, with units converted if needed.
+         * @throws std::out_of_range If data for the time period is not available.
+         */
+        double get_value(const CatchmentAggrDataSelector& selector, ReSampleMethod m) override
+        {
+            if( selector.get_init_time() != frame_init_time || selector.get_duration_secs() != frame_duration ) {
+                frame_init_time = selector.get_init_time();
+                frame_duration = selector.get_duration_secs();
+                frame_size = 0;
+            }
+            for( size_t i = 0; i < frame_size; ++i ) {
+                const FrameEntry& entry = frame[i];
+                if( entry.m == m && entry.variable_name == selector.get_variable_name()
+                    && entry.output_units == selector.get_output_units() ) {
+                    return entry.value;
+                }
+            }
+
+            double value = wrapped_provider->get_value(selector, m);
+            if( frame_size == frame.size() ) {
+                frame.emplace_back();
+            }
+            FrameEntry& entry = frame[frame_size++];
+            entry.variable_name = selector.get_variable_name();
+            entry.output_units = selector.get_output_units();
+            entry.m = m;
+            entry.value = value;
+            return value;
+        }
+
+        /** @return The number of values in the frame of the current time period. */
+        size_t get_frame_size() const
+        {
+            return frame_size;
+        }
+
+    private:
+
+        /** A value of the frame. */
+        struct FrameEntry
+        {
+            std::string variable_name;
+            std::string output_units;
+            ReSampleMethod m = SUM;
+            double value = 0.0;
+        };
+
+        time_t frame_init_time = 0;
+        long frame_duration = -1;                       // no period yet
+        std::vector<FrameEntry> frame;                  // holds the values of the period in its first frame_size entries
+        size_t frame_size = 0;
+
+    };
+}
+
+#endif //NGEN_FORCINGFRAMEDATAPROVIDER_HPP
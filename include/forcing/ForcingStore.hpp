@@ -0,0 +1,221 @@
+#ifndef NGEN_FORCING_STORE_HPP
+#define NGEN_FORCING_STORE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace data_access
+{
+    class RemoteObject;
+
+    /**
+     * @brief Read only, memory mapped access to a forcing store file, holding the forcing of many catchments.
+     *
+     * A forcing store keeps every value of a time step together, so reading all catchments of a rank one time step
+     * at a time touches one contiguous range of the file per variable.  The file is laid out as
+     *
+     * - a fixed size header (see @ref Header), in the byte order of the machine that wrote it;
+     * - the catchment ids, then the name and units of each variable, each as a 32 bit length followed by its bytes;
+     * - padding up to the next page boundary;
+     * - the values, as doubles indexed ``[time][variable][catchment]``.
+     *
+     * Catchments are stored in the order given when the file was written, so a converter can place the catchments
+     * of each partition next to each other.
+     *
+     * A store in object storage (see @ref is_remote_path) is read a few time steps at a time as they are first used,
+     * through the node's @ref BlockCache, into memory of the process; only the time steps near those last read are
+     * kept, so the forcing of a long simulation need not fit in memory.
+     *
+     * @code {.cpp}
+     * data_access::ForcingStore store("forcing.ngenf");
+     * const double* precip = store.record(t, store.get_variable_index("APCP_surface"));
+     * double value = precip[store.get_id_index("cat-27")];
+     * @endcode
+     */
+    class ForcingStore
+    {
+        public:
+
+        /** The first bytes of every forcing store file. */
+        static constexpr char MAGIC[8] = {'N', 'G', 'E', 'N', 'F', 'R', 'C', '\0'};
+
+        /** The version of the layout written by @ref ForcingStoreWriter. */
+        static constexpr std::uint32_t VERSION = 1;
+
+        /** Written natively, to detect files from a machine of different byte order. */
+        static constexpr std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+        struct Header
+        {
+            char magic[8];
+            std::uint32_t byte_order;
+            std::uint32_t version;
+            std::uint64_t num_ids;
+            std::uint64_t num_variables;
+            std::uint64_t num_times;
+            std::int64_t start_time;            // epoch time, in seconds, of the beginning of the first time step
+            std::int64_t time_step;             // length of every time step, in seconds
+            std::uint64_t data_offset;          // offset of the first value from the beginning of the file
+        };
+
+        /**
+         * @param path The forcing store file.
+         * @throws std::runtime_error If the file cannot be mapped or is not a forcing store this build can read.
+         */
+        explicit ForcingStore(const std::string& path);
+
+        /**
+         * @param object A forcing store in object storage.
+         * @throws std::runtime_error If the object cannot be read or is not a forcing store this build can read.
+         */
+        explicit ForcingStore(std::shared_ptr<RemoteObject> object);
+
+        ForcingStore(const ForcingStore&) = delete;
+        ForcingStore& operator=(const ForcingStore&) = delete;
+
+        ~ForcingStore();
+
+        const std::vector<std::string>& get_ids() const { return ids; }
+
+        const std::vector<std::string>& get_variable_names() const { return variable_names; }
+
+        const std::vector<std::string>& get_variable_units() const { return variable_units; }
+
+        std::size_t get_num_times() const { return header.num_times; }
+
+        time_t get_start_time() const { return header.start_time; }
+
+        long get_time_step() const { return header.time_step; }
+
+        /**
+         * @brief The index of a catchment in every record.
+         *
+         * @throws std::out_of_range If the store has no such catchment.
+         */
+        std::size_t get_id_index(const std::string& id) const;
+
+        /**
+         * @brief The index of a variable.
+         *
+         * @throws std::out_of_range If the store has no such variable.
+         */
+        std::size_t get_variable_index(const std::string& name) const;
+
+        /**
+         * @brief The values of a variable for every catchment over a time step, indexed by catchment index.
+         *
+         * The values are in the mapping, and valid for the lifetime of the store; those of a remote store are fetched
+         * first if need be, and valid while the time steps read are near @p t.
+         */
+        const double* record(std::size_t t, std::size_t variable) const
+        {
+            if( remote ) {
+                fetch(t);
+            }
+            return values + (t * header.num_variables + variable) * header.num_ids;
+        }
+
+        /**
+         * @brief Hint that the records of a time step will be read soon, so the pages holding them are read ahead.
+         *
+         * The records of a remote store are fetched in the background.
+         */
+        void will_need(std::size_t t) const;
+
+        private:
+
+        class Remote;
+
+        Header header;
+        std::vector<std::string> ids;
+        std::vector<std::string> variable_names;
+        std::vector<std::string> variable_units;
+        std::unordered_map<std::string, std::size_t> id_index;
+        std::unordered_map<std::string, std::size_t> variable_index;
+        const char* data = nullptr;
+        std::size_t size = 0;
+        const double* values = nullptr;
+        std::unique_ptr<Remote> remote;
+
+        void check_header(const std::string& path) const;
+
+        void read_names(const char* c, const char* names_end, const std::string& path);
+
+        void open_remote(std::shared_ptr<RemoteObject> object, const std::string& path);
+
+        /** Fetch the records of the group of time steps of @p t from a remote store, unless they are in memory. */
+        void fetch(std::size_t t) const;
+    };
+
+    /**
+     * @brief Writes a forcing store file, a catchment at a time or in batches of consecutive catchments.
+     *
+     * The file is sized when it is created; values not written read as 0.
+     */
+    class ForcingStoreWriter
+    {
+        public:
+
+        /**
+         * @param path The file to create, replacing any existing file.
+         * @param ids The catchment ids, in the order they are to be stored.
+         * @param variables The name and units of each variable.
+         * @param start_time The epoch time, in seconds, of the beginning of the first time step.
+         * @param time_step The length of every time step, in seconds.
+         * @param num_times The number of time steps.
+         * @throws std::runtime_error If the file cannot be created.
+         */
+        ForcingStoreWriter(const std::string& path, const std::vector<std::string>& ids,
+                           const std::vector<std::pair<std::string, std::string>>& variables,
+                           time_t start_time, long time_step, std::size_t num_times);
+
+        ForcingStoreWriter(const ForcingStoreWriter&) = delete;
+        ForcingStoreWriter& operator=(const ForcingStoreWriter&) = delete;
+
+        ~ForcingStoreWriter();
+
+        /**
+         * @brief Write the values of consecutive catchments.
+         *
+         * @param first_id The index of the first catchment.
+         * @param count The number of catchments.
+         * @param batch The values, indexed ``[time][variable][catchment - first_id]``.
+         * @throws std::runtime_error If the values cannot be written.
+         */
+        void write_catchments(std::size_t first_id, std::size_t count, const double* batch);
+
+        /** Flush and close the file. */
+        void close();
+
+        private:
+
+        std::string path;
+        int fd = -1;
+        std::size_t num_ids;
+        std::size_t num_variables;
+        std::size_t num_times;
+        std::uint64_t data_offset;
+    };
+
+    /**
+     * @brief Convert per catchment CSV forcing files, as read by @ref CsvPerFeatureForcingProvider, to a forcing store.
+     *
+     * Every file must have the same columns and times, the times evenly spaced.  Catchments are read in batches
+     * sized to @p memory_mb, so stores larger than memory can be written.
+     *
+     * @param id_files The catchment id and CSV file of each catchment, in the order they are to be stored.
+     * @param path The forcing store file to write.
+     * @param memory_mb The memory budget, in megabytes, of each batch of catchments.
+     * @throws std::runtime_error If a file cannot be read, or does not match the first file.
+     */
+    void convert_csv_forcing(const std::vector<std::pair<std::string, std::string>>& id_files, const std::string& path,
+                             std::size_t memory_mb = 1024);
+}
+
+#endif // NGEN_FORCING_STORE_HPP
@@ -0,0 +1,259 @@
+#ifndef NGEN_FORCING_STORE_DATA_PROVIDER_HPP
+#define NGEN_FORCING_STORE_DATA_PROVIDER_HPP
+
+#include "GenericDataProvider.hpp"
+#include "DataProviderSelectors.hpp"
+#include "ForcingStore.hpp"
+#include "AorcForcing.hpp"
+#include "SimulationPeriod.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <UnitsHelper.hpp>
+#include <Logger.hpp>
+#include <StepArena.hpp>
+
+namespace data_access
+{
+    /**
+     * @brief Provides the forcing of many catchments from a single forcing store file (see @ref ForcingStore).
+     *
+     * Values are read in place from the mapping of the file, so there is no cache to size; while a time step is in
+     * use, the pages of the next one are read ahead.
+     */
+    class ForcingStoreDataProvider : public GenericDataProvider
+    {
+        public:
+
+        /**
+         * @brief Factory method that creates or returns an existing provider for the provided path.
+         * @param input_path The path to a forcing store file.
+         */
+        static std::shared_ptr<ForcingStoreDataProvider> get_shared_provider(std::string input_path, time_t sim_start, time_t sim_end)
+        {
+            const std::lock_guard<std::mutex> lock(shared_providers_mutex);
+            std::shared_ptr<ForcingStoreDataProvider> p;
+            if(shared_providers.count(input_path) > 0){
+                p = shared_providers[input_path];
+            } else {
+                p = std::make_shared<data_access::ForcingStoreDataProvider>(input_path, sim_start, sim_end);
+                shared_providers[input_path] = p;
+            }
+            return p;
+        }
+
+        /**
+         * @param input_path The path to a forcing store file.
+         * @param sim_start The epoch time of the start of the simulation.
+         * @param sim_end The epoch time of the end of the simulation.
+         */
+        ForcingStoreDataProvider(std::string input_path, time_t sim_start, time_t sim_end) : store(input_path),
+            simulation_period(sim_start, sim_end)
+        {
+            const auto& names = store.get_variable_names();
+            const auto& units = store.get_variable_units();
+            for( size_t i = 0; i < names.size(); ++i ) {
+                variable_names.push_back(names[i]);
+                var_index[names[i]] = i;
+                var_units.push_back(units[i]);
+
+                auto wkf = data_access::WellKnownFields.find(names[i]);
+                if(wkf != data_access::WellKnownFields.end()){
+                    std::string can_name = std::get<0>(wkf->second); // the CSDMS name
+                    variable_names.push_back(can_name);
+                    var_index[can_name] = i;
+                    if( var_units[i].empty() ) {
+                        var_units[i] = std::get<1>(wkf->second);
+                    }
+                }
+            }
+
+            start_time = store.get_start_time();
+            time_stride = store.get_time_step();
+            stop_time = start_time + time_stride * store.get_num_times();
+        }
+
+        const std::vector<std::string>& get_avaliable_variable_names() override
+        {
+            return variable_names;
+        }
+
+        /** return a list of ids in the current file */
+        const std::vector<std::string>& get_ids() const
+        {
+            return store.get_ids();
+        }
+
+        /** @return The start of the simulation, rather than of the data (see @ref SimulationPeriod). */
+        long get_data_start_time() override
+        {
+            return simulation_period.get_data_start_time();
+        }
+
+        /** @return The end of the simulation, rather than of the data (see @ref SimulationPeriod). */
+        long get_data_stop_time() override
+        {
+            return simulation_period.get_data_stop_time();
+        }
+
+        long record_duration() override
+        {
+            return time_stride;
+        }
+
+        /** The store is read in place, so it must already hold the data of the extended period. */
+        void extend_to(time_t end_time) override
+        {
+            simulation_period.extend_to(end_time);
+        }
+
+        /**
+         * Get the index of the data time step that contains the given point in time.
+         *
+         * @param epoch_time The point in time, as a seconds-based epoch time.
+         * @return The index of the forcing time step that contains the given point in time.
+         * @throws std::out_of_range If the given point is not in any time step.
+         */
+        size_t get_ts_index_for_time(const time_t &epoch_time) override
+        {
+            if (start_time <= epoch_time && epoch_time < stop_time)
+            {
+                return size_t((epoch_time - start_time) / time_stride);
+            }
+            std::stringstream ss;
+            ss << "The value " << (long)epoch_time << " was not in the range [" << (long)start_time << "," << (long)stop_time << ")";
+            throw std::out_of_range(ss.str());
+        }
+
+        /**
+         * Get the value of a forcing property for an arbitrary time period, converting units if needed.
+         *
+         * @param selector Data required to establish what subset of the stored data should be accessed
+         * @param m How data is to be resampled if there is a mismatch in data alignment or repeat rate
+         * @return The value of the forcing property for the described time period, with units converted if needed.
+         * @throws std::out_of_range If data for the time period is not available.
+         */
+        double get_value(const CatchmentAggrDataSelector& selector, ReSampleMethod m) override
+        {
+            size_t pos = store.get_id_index(selector.get_id());
+            double value;
+            get_values_for_positions(get_var_index(selector.get_variable_name()), &pos, 1, selector, m, &value);
+            return value;
+        }
+
+        /**
+         * Get the values of a forcing property for several catchments over the time period of a selector, converting
+         * units if needed.
+         *
+         * Catchments stored next to each other are read from the same pages of each record.
+         *
+         * @param ids The ids of the catchments; the id of @p selector is ignored.
+         * @param selector The variable, time period and units of the values.
+         * @param m How data is to be resampled if there is a mismatch in data alignment or repeat rate
+         * @param values Storage for ``ids.size()`` values, written in the order of @p ids.
+         * @throws std::out_of_range If data for the time period, or any of the ids, is not available.
+         */
+        void get_values_for_ids(const std::vector<std::string>& ids, const CatchmentAggrDataSelector& selector, ReSampleMethod m, double* values) override
+        {
+            size_t var_idx = get_var_index(selector.get_variable_name());
+            utils::arena_vector<size_t> positions(ids.size());
+            std::transform(ids.begin(), ids.end(), positions.begin(), [this](const std::string& id){ return store.get_id_index(id); });
+            get_values_for_positions(var_idx, positions.data(), positions.size(), selector, m, values);
+        }
+
+        std::vector<double> get_values(const CatchmentAggrDataSelector& selector, data_access::ReSampleMethod m) override
+        {
+            return std::vector<double>(1, get_value(selector, m));
+        }
+
+        private:
+
+        static std::mutex shared_providers_mutex;
+        static std::map<std::string, std::shared_ptr<ForcingStoreDataProvider>> shared_providers;
+
+        ForcingStore store;
+        SimulationPeriod simulation_period;
+        time_t start_time;                              // the begining of the first time step stored
+        time_t stop_time;                               // the end of the last time step stored
+        long time_stride;                               // the length of each time step stored
+        std::vector<std::string> variable_names;
+        std::unordered_map<std::string, size_t> var_index; // store variable index of each variable name and CSDMS alias
+        std::vector<std::string> var_units;             // native units of each store variable
+        std::atomic<size_t> read_ahead_through{0};      // the last time step whose pages have been read ahead
+
+        size_t get_var_index(const std::string& name) const
+        {
+            auto found = var_index.find(name);
+            if( found == var_index.end() ) {
+                throw std::runtime_error("Cannot get forcing value for unrecognized parameter name '" + name + "'.");
+            }
+            return found->second;
+        }
+
+        /**
+         * Get the values of a variable for catchments at several positions in the store over the time period of a
+         * selector, converting units if needed.
+         *
+         * Each data time step is weighted by the part of it inside the period; for @ref MEAN, the weighted sum is
+         * scaled by the length of a time step over the length of the period.
+         */
+        void get_values_for_positions(size_t var_idx, const size_t* positions, size_t count, const CatchmentAggrDataSelector& selector, ReSampleMethod m, double* values)
+        {
+            const time_t init_time = selector.get_init_time();
+            const time_t end_time = init_time + selector.get_duration_secs();
+            const size_t idx1 = get_ts_index_for_time(init_time);
+            size_t idx2 = idx1;
+            if( end_time > init_time ) {
+                // to the edge of the data if the period runs past it
+                idx2 = end_time - 1 < stop_time ? get_ts_index_for_time(end_time - 1) : store.get_num_times() - 1;
+            }
+
+            std::fill(values, values + count, 0.0);
+            for( size_t t = idx1; t <= idx2; ++t ) {
+                const time_t t_start = start_time + time_t(t) * time_stride;
+                double weight = 1.0;
+                if( end_time > init_time ) {
+                    weight = double(std::min(t_start + time_stride, end_time) - std::max(t_start, init_time)) / time_stride;
+                    if( m == MEAN ) {
+                        weight *= double(time_stride) / (end_time - init_time);
+                    }
+                }
+                const double* record = store.record(t, var_idx);
+                for( size_t i = 0; i < count; ++i ) {
+                    values[i] += weight * record[positions[i]];
+                }
+            }
+
+            // while the models use these values, have the next time step's pages read in
+            size_t advised = read_ahead_through.load(std::memory_order_relaxed);
+            while( advised < idx2 + 1 ) {
+                if( read_ahead_through.compare_exchange_weak(advised, idx2 + 1, std::memory_order_relaxed) ) {
+                    store.will_need(idx2 + 1);
+                    break;
+                }
+            }
+
+            try
+            {
+                UnitsHelper::convert_values(var_units[var_idx], values, selector.get_output_units(), values, count);
+            }
+            catch (const std::runtime_error& e)
+            {
+                #ifndef UDUNITS_QUIET
+                NGEN_LOG_WARNING("Unit conversion unsuccessful - Returning unconverted value! (\"" << e.what() << "\")");
+                #endif
+            }
+        }
+    };
+}
+
+#endif // NGEN_FORCING_STORE_DATA_PROVIDER_HPP
@@ -3,6 +3,9 @@
 
 #include "DataProvider.hpp"
 #include "DataProviderSelectors.hpp"
+#include "DataValueType.hpp"
+
+#include <algorithm>
 
 namespace data_access
 {
@@ -10,8 +13,66 @@ namespace data_access
     {
         public:
 
+        /**
+         * Get the values of a forcing property for several catchments over the time period of a selector, converting
+         * units if needed.
+         *
+         * Providers holding data for many catchments should override this to look up the time period, variable and
+         * unit conversion once for all of them; by default, @ref get_value is called for each catchment.
+         *
+         * @param ids The ids of the catchments; the id of @p selector is ignored.
+         * @param selector The variable, time period and units of the values.
+         * @param m How data is to be resampled if there is a mismatch in data alignment or repeat rate
+         * @param values Storage for ``ids.size()`` values, written in the order of @p ids.
+         * @throws std::out_of_range If data for the time period is not available.
+         */
+        virtual void get_values_for_ids(const std::vector<std::string>& ids, const CatchmentAggrDataSelector& selector, ReSampleMethod m, double* values)
+        {
+            // One selector for every id, so its variable name and units are only copied once
+            CatchmentAggrDataSelector id_selector(selector);
+            for( size_t i = 0; i < ids.size(); ++i ) {
+                id_selector.set_id(ids[i]);
+                values[i] = get_value(id_selector, m);
+            }
+        }
+
+        /**
+         * Get the values of a forcing property over the time period of a selector, written straight into storage of
+         * the given type, converting units if needed.
+         *
+         * Providers that can read values without first gathering them in a vector should override this; by default,
+         * @ref get_values is called and its values are stored as @p type.
+         *
+         * @param selector The variable, time period and units of the values.
+         * @param m How data is to be resampled if there is a mismatch in data alignment or repeat rate
+         * @param type The type of the values of @p values.
+         * @param values Storage for up to @p count values of @p type.
+         * @param count The number of values @p values has room for.
+         * @return The number of values written, which is at most @p count; any values past it are left as they were.
+         * @throws std::out_of_range If data for the time period is not available.
+         */
+        virtual size_t get_values_into(const CatchmentAggrDataSelector& selector, ReSampleMethod m, ValueType type, void* values, size_t count)
+        {
+            std::vector<double> all_values = get_values(selector, m);
+            size_t written = std::min(all_values.size(), count);
+            store_values(type, all_values.data(), written, values);
+            return written;
+        }
+
+        /**
+         * Make data available up to a later simulation end time, between the cycles of a warm-started run.
+         *
+         * Providers that read their whole source up front should read it again, as it may have grown since.  By
+         * default, nothing is done.
+         *
+         * @param end_time The epoch time of the new end of the simulation.
+         */
+        virtual void extend_to(time_t end_time)
+        {
+        }
+
         private:
     };
 }
 
-#endif
\ No newline at end of file
+#endif
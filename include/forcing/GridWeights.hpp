@@ -0,0 +1,194 @@
+#ifndef NGEN_GRID_WEIGHTS_HPP
+#define NGEN_GRID_WEIGHTS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <boost/geometry/geometries/multi_polygon.hpp>
+#include <boost/geometry/geometries/point_xy.hpp>
+#include <boost/geometry/geometries/polygon.hpp>
+
+namespace data_access
+{
+    /**
+     * @brief A regular grid of cells, as the x and y coordinates of the centers of its columns and rows.
+     *
+     * Cell ``(row, column)`` is centered at ``(x_first + column * dx, y_first + row * dy)``; either spacing may be
+     * negative, e.g. for rows stored from north to south.
+     */
+    struct GridSpec
+    {
+        double x_first = 0.0;
+        double y_first = 0.0;
+        double dx = 1.0;
+        double dy = 1.0;
+        std::size_t nx = 0;
+        std::size_t ny = 0;
+
+        bool operator==(const GridSpec& other) const
+        {
+            return x_first == other.x_first && y_first == other.y_first && dx == other.dx && dy == other.dy
+                   && nx == other.nx && ny == other.ny;
+        }
+    };
+
+    /**
+     * @brief The weights of the grid cells in the value of each catchment, as a sparse matrix of catchments by cells.
+     *
+     * The weight of a cell in a catchment is the area of the catchment inside the cell over the area of the catchment
+     * inside the grid, so a catchment's value is the area weighted mean of the cells it overlaps.  Weights are
+     * computed once, from the catchment polygons, and kept in compressed sparse rows over the smallest window of the
+     * grid holding every cell with a weight, so only that window need be read from gridded forcing at each time step.
+     *
+     * Weights can be written to a file and read back by later runs, which then need no catchment geometries.
+     *
+     * @code {.cpp}
+     * data_access::GridWeights weights = data_access::GridWeights::compute(grid, catchments);
+     * // window holds the values of the cells of weights.get_window_*(), row after row
+     * weights.apply(window.data(), values.data());
+     * @endcode
+     */
+    class GridWeights
+    {
+        public:
+
+        typedef boost::geometry::model::d2::point_xy<double> point_t;
+        typedef boost::geometry::model::polygon<point_t> polygon_t;
+        typedef boost::geometry::model::multi_polygon<polygon_t> multipolygon_t;
+
+        /** The first bytes of every weights file. */
+        static constexpr char MAGIC[8] = {'N', 'G', 'E', 'N', 'G', 'R', 'D', 'W'};
+
+        /** The version of the layout written by @ref write. */
+        static constexpr std::uint32_t VERSION = 1;
+
+        GridWeights() = default;
+
+        /**
+         * @brief Compute the weights of the cells of a grid in each of some catchments.
+         *
+         * The candidate cells of a catchment follow from its bounding box and the regular spacing of the grid; each
+         * is then weighted by its intersection with the catchment, skipping the intersection for cells entirely
+         * inside it.  Polygons must be in the coordinates of the grid.
+         *
+         * @param grid The grid.
+         * @param catchments The id and polygons of each catchment.  Catchments that do not overlap the grid have no
+         *                   weights.
+         */
+        static GridWeights compute(const GridSpec& grid, const std::vector<std::pair<std::string, multipolygon_t>>& catchments);
+
+        /**
+         * @brief Get the weights of some of the catchments, over the smallest window holding their cells.
+         *
+         * @param subset_ids The catchments, which must all be of these weights.
+         * @throws std::out_of_range If one of @p subset_ids is not of these weights.
+         */
+        GridWeights subset(const std::vector<std::string>& subset_ids) const;
+
+        /**
+         * @brief Read weights written by @ref write.
+         *
+         * @throws std::runtime_error If the file cannot be read or is not a weights file this build can read.
+         */
+        static GridWeights read(const std::string& path);
+
+        /**
+         * @brief Write the weights to a file, which replaces any file of the same path once it is complete.
+         *
+         * @throws std::runtime_error If the file cannot be written.
+         */
+        void write(const std::string& path) const;
+
+        const GridSpec& get_grid() const { return grid; }
+
+        const std::vector<std::string>& get_ids() const { return ids; }
+
+        /** The number of catchments, i.e. rows of the matrix. */
+        std::size_t size() const { return ids.size(); }
+
+        /** The number of cells with a weight, i.e. the non zeros of the matrix. */
+        std::size_t nonzeros() const { return cells.size(); }
+
+        /**
+         * @return The row of a catchment, or ``size()`` if it is not one of the catchments.
+         */
+        std::size_t get_index(const std::string& id) const
+        {
+            auto found = index.find(id);
+            return found == index.end() ? ids.size() : found->second;
+        }
+
+        /** Whether a catchment overlaps the grid, and so has a value. */
+        bool has_cells(std::size_t row) const { return row_start[row + 1] > row_start[row]; }
+
+        std::size_t get_window_row() const { return window_row; }
+
+        std::size_t get_window_column() const { return window_column; }
+
+        std::size_t get_window_rows() const { return window_rows; }
+
+        std::size_t get_window_columns() const { return window_columns; }
+
+        /**
+         * @brief Get the value of every catchment from the values of the cells of the window.
+         *
+         * Cells whose value is missing (NaN) are left out, and the weights of the others scaled to make up for them;
+         * a catchment with no value in any of its cells is NaN, as is one with no cells.
+         *
+         * @param window The values of the cells of the window, ``get_window_rows() * get_window_columns()`` of them,
+         *               row after row.
+         * @param values Storage for ``size()`` values, one for each catchment.
+         */
+        void apply(const double* window, double* values) const
+        {
+            const std::uint32_t* __restrict c = cells.data();
+            const double* __restrict w = weights.data();
+            for( std::size_t row = 0; row < ids.size(); ++row ) {
+                double sum = 0.0;
+                double weight = 0.0;
+                for( std::uint64_t k = row_start[row]; k < row_start[row + 1]; ++k ) {
+                    const double value = window[c[k]];
+                    // selects rather than branches, so the loop vectorizes into gathers and blends
+                    const bool present = value == value;
+                    sum += present ? w[k] * value : 0.0;
+                    weight += present ? w[k] : 0.0;
+                }
+                values[row] = weight > 0.0 ? sum / weight : std::numeric_limits<double>::quiet_NaN();
+            }
+        }
+
+        private:
+
+        GridSpec grid;
+        std::size_t window_row = 0;
+        std::size_t window_column = 0;
+        std::size_t window_rows = 0;
+        std::size_t window_columns = 0;
+        std::vector<std::string> ids;
+        std::unordered_map<std::string, std::size_t> index;
+        std::vector<std::uint64_t> row_start{0};       // first non zero of each row, then the number of non zeros
+        std::vector<std::uint32_t> cells;               // window cell of each non zero, row after row of the window
+        std::vector<double> weights;                    // weight of each non zero
+
+        void index_ids();
+
+      public:
+
+        /** The bytes of the weights, their cells and the ids of their rows. */
+        std::size_t get_memory_bytes() const
+        {
+            std::size_t bytes = ids.capacity() * sizeof(std::string) + row_start.capacity() * sizeof(std::uint64_t)
+                              + cells.capacity() * sizeof(std::uint32_t) + weights.capacity() * sizeof(double)
+                              + index.bucket_count() * sizeof(void*)
+                              + index.size() * (sizeof(std::pair<const std::string, std::size_t>) + 2 * sizeof(void*));
+            return bytes;
+        }
+    };
+}
+
+#endif // NGEN_GRID_WEIGHTS_HPP
@@ -0,0 +1,609 @@
+#ifdef NETCDF_ACTIVE
+#ifndef NGEN_NETCDF_GRIDDED_DATAPROVIDER_HPP
+#define NGEN_NETCDF_GRIDDED_DATAPROVIDER_HPP
+
+#include "GenericDataProvider.hpp"
+#include "DataProviderSelectors.hpp"
+#include "GridWeights.hpp"
+#include "RemoteObject.hpp"
+#include "SlabCache.hpp"
+#include "AorcForcing.hpp"
+#include "SimulationPeriod.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include <UnitsHelper.hpp>
+#include <StreamHandler.hpp>
+#include <Logger.hpp>
+#include <StepArena.hpp>
+
+#include <netcdf>
+
+namespace data_access
+{
+    /**
+     * @brief Provides the forcing of catchments from a NetCDF file of gridded forcing, such as AORC or NWM forcing.
+     *
+     * Forcing variables are those with ``(time, y, x)`` dimensions, on a regular grid given by the coordinate
+     * variables of the ``y`` and ``x`` dimensions, with the times of a ``time`` variable in CF ``<units> since
+     * <date>`` form.  Packed values are unpacked with their ``scale_factor`` and ``add_offset``, and cells of the
+     * ``_FillValue`` or ``missing_value`` are left out of the catchments they are in.
+     *
+     * The value of a catchment is the area weighted mean of the grid cells it overlaps, with the weights of every
+     * catchment computed from their polygons once, into a @ref GridWeights sparse matrix.  The weights can be kept in a
+     * file, which later runs read instead of computing them again, so they need no catchment geometries.  Each read
+     * takes a block of time steps of only the window of the grid overlapped by the catchments, and turns it into the
+     * values of every catchment at once, which are then cached.
+     *
+     * Catchment polygons must be in the coordinates of the grid.
+     */
+    class NetCDFGriddedDataProvider : public GenericDataProvider
+    {
+        public:
+
+        /** The id and polygons of each catchment values may be requested for. */
+        typedef std::vector<std::pair<std::string, GridWeights::multipolygon_t>> catchment_polygons_t;
+
+        /** Get the polygons of the catchments, only called if the weights have to be computed. */
+        typedef std::function<catchment_polygons_t()> polygon_source_t;
+
+        /**
+         * Memory budget, in megabytes, of the grid windows read and the catchment values cached, when none is
+         * configured.
+         */
+        static constexpr size_t DEFAULT_CACHE_SIZE_MB = 256;
+
+        /** The largest number of time steps read at once. */
+        static constexpr size_t DEFAULT_CACHE_TIME_BLOCK = 24;
+
+        /**
+         * @brief Factory method that creates or returns an existing provider for the provided path.
+         *
+         * If a provider object for the given path already exists, every argument but the path is ignored.
+         *
+         * @see NetCDFGriddedDataProvider
+         */
+        static std::shared_ptr<NetCDFGriddedDataProvider> get_shared_provider(std::string input_path, time_t sim_start, time_t sim_end, utils::StreamHandler log_s, std::string weights_path, polygon_source_t polygons, size_t cache_size_mb = 0, std::shared_ptr<const std::vector<std::string>> feature_ids = nullptr)
+        {
+            const std::lock_guard<std::mutex> lock(shared_providers_mutex);
+            std::shared_ptr<NetCDFGriddedDataProvider> p;
+            if(shared_providers.count(input_path) > 0){
+                p = shared_providers[input_path];
+            } else {
+                p = std::make_shared<data_access::NetCDFGriddedDataProvider>(input_path, sim_start, sim_end, log_s, weights_path, polygons, cache_size_mb, feature_ids);
+                shared_providers[input_path] = p;
+            }
+            return p;
+        }
+
+        /**
+         * @param input_path The path to a NetCDF file of gridded forcing.
+         * @param sim_start The epoch time of the start of the simulation.
+         * @param sim_end The epoch time of the end of the simulation.
+         * @param log_s An output log stream for messages.
+         * @param weights_path The file the weights of the grid cells in each catchment are kept in, or empty to
+         * compute them for this run only.  Weights in the file are used if they are of the file's grid and hold every
+         * one of @p feature_ids, keeping only those catchments; otherwise they are computed and the file replaced.
+         * @param polygons The source of the catchment polygons to compute the weights from.
+         * @param cache_size_mb The memory budget of the windows read and values cached, in megabytes, or 0 for
+         * @ref DEFAULT_CACHE_SIZE_MB.
+         * @param feature_ids The ids of the catchments values may be requested for, or null to trust the weights in
+         * @p weights_path to hold them.
+         * @throws std::runtime_error If the file has no gridded variables, its grid is not regular, or the weights are
+         * to be computed without any catchment polygons.
+         */
+        NetCDFGriddedDataProvider(std::string input_path, time_t sim_start, time_t sim_end, utils::StreamHandler log_s, std::string weights_path, polygon_source_t polygons, size_t cache_size_mb = 0, std::shared_ptr<const std::vector<std::string>> feature_ids = nullptr) : log_stream(log_s),
+            simulation_period(sim_start, sim_end),
+            value_cache(1)
+        {
+            nc_file = std::make_shared<netCDF::NcFile>(netcdf_path(input_path), netCDF::NcFile::read);
+
+            read_times(input_path);
+            read_variables(input_path);
+            read_grid(input_path);
+            load_weights(weights_path, polygons, feature_ids.get());
+            init_value_cache(cache_size_mb == 0 ? DEFAULT_CACHE_SIZE_MB : cache_size_mb);
+        }
+
+        NetCDFGriddedDataProvider(const NetCDFGriddedDataProvider&) = delete;
+        NetCDFGriddedDataProvider& operator=(const NetCDFGriddedDataProvider&) = delete;
+
+        const std::vector<std::string>& get_avaliable_variable_names() override
+        {
+            return variable_names;
+        }
+
+        /** The weights of the grid cells in each catchment. */
+        const GridWeights& get_weights() const
+        {
+            return weights;
+        }
+
+        /** @return The start of the simulation, rather than of the data (see @ref SimulationPeriod). */
+        long get_data_start_time() override
+        {
+            return simulation_period.get_data_start_time();
+        }
+
+        /** @return The end of the simulation, rather than of the data (see @ref SimulationPeriod). */
+        long get_data_stop_time() override
+        {
+            return simulation_period.get_data_stop_time();
+        }
+
+        long record_duration() override
+        {
+            return time_stride;
+        }
+
+        /** Values are read from the file on demand, so it must already hold the data of the extended period. */
+        void extend_to(time_t end_time) override
+        {
+            simulation_period.extend_to(end_time);
+        }
+
+        /**
+         * Get the index of the data time step that contains the given point in time.
+         *
+         * @param epoch_time The point in time, as a seconds-based epoch time.
+         * @return The index of the forcing time step that contains the given point in time.
+         * @throws std::out_of_range If the given point is not in any time step.
+         */
+        size_t get_ts_index_for_time(const time_t &epoch_time) override
+        {
+            if (start_time <= epoch_time && epoch_time < stop_time)
+            {
+                return size_t((epoch_time - start_time) / time_stride);
+            }
+            std::stringstream ss;
+            ss << "The value " << (long)epoch_time << " was not in the range [" << (long)start_time << "," << (long)stop_time << ")";
+            throw std::out_of_range(ss.str());
+        }
+
+        /**
+         * Get the value of a forcing property for an arbitrary time period, converting units if needed.
+         *
+         * @param selector Data required to establish what subset of the stored data should be accessed
+         * @param m How data is to be resampled if there is a mismatch in data alignment or repeat rate
+         * @return The value of the forcing property for the described time period, with units converted if needed.
+         * @throws std::out_of_range If data for the time period is not available, or the catchment does not
+         * overlap the grid.
+         */
+        double get_value(const CatchmentAggrDataSelector& selector, ReSampleMethod m) override
+        {
+            size_t row = get_row(selector.get_id());
+            double value;
+            get_values_for_rows(get_var_index(selector.get_variable_name()), &row, 1, selector, m, &value);
+            return value;
+        }
+
+        /**
+         * Get the values of a forcing property for several catchments over the time period of a selector, converting
+         * units if needed.
+         *
+         * @param ids The ids of the catchments; the id of @p selector is ignored.
+         * @param selector The variable, time period and units of the values.
+         * @param m How data is to be resampled if there is a mismatch in data alignment or repeat rate
+         * @param values Storage for ``ids.size()`` values, written in the order of @p ids.
+         * @throws std::out_of_range If data for the time period is not available, or any of the catchments does not
+         * overlap the grid.
+         */
+        void get_values_for_ids(const std::vector<std::string>& ids, const CatchmentAggrDataSelector& selector, ReSampleMethod m, double* values) override
+        {
+            size_t var_idx = get_var_index(selector.get_variable_name());
+            utils::arena_vector<size_t> rows(ids.size());
+            std::transform(ids.begin(), ids.end(), rows.begin(), [this](const std::string& id){ return get_row(id); });
+            get_values_for_rows(var_idx, rows.data(), rows.size(), selector, m, values);
+        }
+
+        std::vector<double> get_values(const CatchmentAggrDataSelector& selector, data_access::ReSampleMethod m) override
+        {
+            return std::vector<double>(1, get_value(selector, m));
+        }
+
+        /** @return The bytes of the cached slabs of catchment values, the grid window read and the weights. */
+        size_t get_memory_bytes() override
+        {
+            const std::lock_guard<std::mutex> lock(value_cache_mutex);
+            return value_cache.get_memory_bytes() + window.capacity() * sizeof(double) + weights.get_memory_bytes();
+        }
+
+        private:
+
+        /** How the stored values of a variable are unpacked. */
+        struct Packing
+        {
+            double scale_factor = 1.0;
+            double add_offset = 0.0;
+            bool has_fill = false;
+            double fill_value = 0.0;
+        };
+
+        static std::mutex shared_providers_mutex;
+        static std::map<std::string, std::shared_ptr<NetCDFGriddedDataProvider>> shared_providers;
+
+        utils::StreamHandler log_stream;
+        std::shared_ptr<netCDF::NcFile> nc_file;
+        SimulationPeriod simulation_period;
+        time_t start_time;                              // the begining of the first time step stored
+        time_t stop_time;                               // the end of the last time step stored
+        long time_stride;                               // the length of each time step stored
+        size_t num_times;
+        std::string time_dim_name;
+        std::string y_dim_name;
+        std::string x_dim_name;
+
+        std::vector<std::string> variable_names;
+        std::unordered_map<std::string, size_t> var_index; // variable index of each variable name and CSDMS alias
+        std::vector<netCDF::NcVar> grid_vars;           // the gridded variables, by variable index
+        std::vector<std::string> var_units;             // native units of each gridded variable
+        std::vector<Packing> var_packing;               // packing of each gridded variable
+
+        GridSpec grid;
+        GridWeights weights;
+
+        std::mutex value_cache_mutex;                   // guards value_cache and window, and serializes reads of the file
+        SlabCache value_cache;                          // catchment values over time blocks, ``[time][catchment]``, keyed by variable index
+        size_t t_block = 1;                             // the number of time steps of each slab
+        std::vector<double> window;                     // the grid window of a time block, as read
+
+        /** Read the times of the ``time`` variable, which must be evenly spaced. */
+        void read_times(const std::string& input_path)
+        {
+            netCDF::NcVar time_var = nc_file->getVar("time");
+            if( time_var.isNull() || time_var.getDimCount() != 1 ) {
+                throw std::runtime_error("Gridded forcing file " + input_path + " has no one dimensional \"time\" variable.");
+            }
+            time_dim_name = time_var.getDim(0).getName();
+            num_times = time_var.getDim(0).getSize();
+            if( num_times == 0 ) {
+                throw std::runtime_error("Gridded forcing file " + input_path + " has no time steps.");
+            }
+            std::vector<double> raw_time(num_times);
+            time_var.getVar(raw_time.data());
+
+            std::string units;
+            get_string_att(time_var, "units", units);
+            double scale;
+            time_t epoch;
+            parse_time_units(units, scale, epoch, input_path);
+
+            start_time = epoch + static_cast<time_t>(std::llround(raw_time[0] * scale));
+            time_stride = num_times > 1 ? std::lround((raw_time[1] - raw_time[0]) * scale) : 3600;
+            if( time_stride <= 0 ) {
+                throw std::runtime_error("Times in gridded forcing file " + input_path + " are not increasing.");
+            }
+            for( size_t i = 1; i < num_times; ++i ) {
+                if( std::lround((raw_time[i] - raw_time[0]) * scale) != static_cast<long>(i) * time_stride ) {
+                    log_stream << "Error: Time intervals are not constant in forcing file\n";
+                    throw std::runtime_error("Time intervals in forcing file are not constant");
+                }
+            }
+            stop_time = start_time + time_stride * static_cast<time_t>(num_times);
+        }
+
+        /** Find the ``(time, y, x)`` variables, which must all be on the same dimensions. */
+        void read_variables(const std::string& input_path)
+        {
+            for( const auto& element : nc_file->getVars() ) {
+                const netCDF::NcVar& ncvar = element.second;
+                if( ncvar.getDimCount() != 3 || ncvar.getDim(0).getName() != time_dim_name ) {
+                    continue;
+                }
+                if( grid_vars.empty() ) {
+                    y_dim_name = ncvar.getDim(1).getName();
+                    x_dim_name = ncvar.getDim(2).getName();
+                }
+                else if( ncvar.getDim(1).getName() != y_dim_name || ncvar.getDim(2).getName() != x_dim_name ) {
+                    log_stream << "Warning: gridded forcing variable " << element.first << " is not on the grid of the others; it is left out\n";
+                    continue;
+                }
+
+                const size_t idx = grid_vars.size();
+                grid_vars.push_back(ncvar);
+                variable_names.push_back(element.first);
+                var_index[element.first] = idx;
+
+                std::string native_units;
+                get_string_att(ncvar, "units", native_units);
+                Packing packing;
+                get_double_att(ncvar, "scale_factor", packing.scale_factor);
+                get_double_att(ncvar, "add_offset", packing.add_offset);
+                packing.has_fill = get_double_att(ncvar, "_FillValue", packing.fill_value)
+                                   || get_double_att(ncvar, "missing_value", packing.fill_value);
+                var_packing.push_back(packing);
+
+                auto wkf = data_access::WellKnownFields.find(element.first);
+                if(wkf != data_access::WellKnownFields.end()){
+                    native_units = native_units.empty() ? std::get<1>(wkf->second) : native_units;
+                    std::string can_name = std::get<0>(wkf->second); // the CSDMS name
+                    variable_names.push_back(can_name);
+                    var_index[can_name] = idx;
+                }
+                var_units.push_back(native_units);
+            }
+            if( grid_vars.empty() ) {
+                throw std::runtime_error("Gridded forcing file " + input_path + " has no variables with (time, y, x) dimensions.");
+            }
+        }
+
+        /** Read the grid from the coordinate variables of the x and y dimensions, which must be evenly spaced. */
+        void read_grid(const std::string& input_path)
+        {
+            read_axis(x_dim_name, grid.x_first, grid.dx, grid.nx, input_path);
+            read_axis(y_dim_name, grid.y_first, grid.dy, grid.ny, input_path);
+        }
+
+        void read_axis(const std::string& dim_name, double& first, double& spacing, size_t& count, const std::string& input_path)
+        {
+            netCDF::NcVar coordinates = nc_file->getVar(dim_name);
+            if( coordinates.isNull() || coordinates.getDimCount() != 1 ) {
+                throw std::runtime_error("Gridded forcing file " + input_path + " has no coordinate variable of dimension " + dim_name);
+            }
+            count = coordinates.getDim(0).getSize();
+            std::vector<double> values(count);
+            coordinates.getVar(values.data());
+            first = count > 0 ? values[0] : 0.0;
+            spacing = count > 1 ? (values[count - 1] - values[0]) / (count - 1) : 1.0;
+            for( size_t i = 1; i < count; ++i ) {
+                if( std::abs(values[i] - (first + i * spacing)) > 1e-6 * std::abs(spacing) ) {
+                    throw std::runtime_error("The " + dim_name + " coordinates of gridded forcing file " + input_path + " are not evenly spaced.");
+                }
+            }
+        }
+
+        /** Use the weights of @p weights_path, if they are current, or else compute them and keep them there. */
+        void load_weights(const std::string& weights_path, const polygon_source_t& polygons, const std::vector<std::string>* feature_ids)
+        {
+            struct stat info;
+            if( !weights_path.empty() && stat(weights_path.c_str(), &info) == 0 ) {
+                try {
+                    GridWeights stored = GridWeights::read(weights_path);
+                    bool current = stored.get_grid() == grid;
+                    if( current && feature_ids != nullptr ) {
+                        for( const std::string& id : *feature_ids ) {
+                            if( stored.get_index(id) == stored.size() ) {
+                                current = false;
+                                break;
+                            }
+                        }
+                    }
+                    if( current ) {
+                        // e.g. weights of the whole hydrofabric, of which this process only runs a partition
+                        weights = feature_ids != nullptr && feature_ids->size() < stored.size() ? stored.subset(*feature_ids) : std::move(stored);
+                        return;
+                    }
+                    log_stream << "Grid weights " << weights_path << " are not of this grid and these catchments; computing them again\n";
+                }
+                catch( const std::runtime_error& e ) {
+                    log_stream << "Warning: " << e.what() << "; computing the grid weights again\n";
+                }
+            }
+
+            catchment_polygons_t catchments;
+            if( polygons ) {
+                catchments = polygons();
+            }
+            if( catchments.empty() ) {
+                throw std::runtime_error("The weights of gridded forcing need the polygons of the catchments, but none were given"
+                                         + (weights_path.empty() ? std::string() : " and " + weights_path + " does not hold them"));
+            }
+            weights = GridWeights::compute(grid, catchments);
+            if( !weights_path.empty() ) {
+                weights.write(weights_path);
+            }
+        }
+
+        /**
+         * Size the time blocks read so the window of a block fits in the budget, and the cache to hold as many slabs
+         * of catchment values as the rest of the budget allows, up to a few per variable.
+         */
+        void init_value_cache(size_t cache_size_mb)
+        {
+            const size_t budget = cache_size_mb * 1024 * 1024;
+            const size_t window_step_bytes = std::max<size_t>(1, weights.get_window_rows() * weights.get_window_columns() * sizeof(double));
+            t_block = std::max<size_t>(1, std::min({DEFAULT_CACHE_TIME_BLOCK, num_times, budget / 2 / window_step_bytes}));
+            const size_t slab_bytes = std::max<size_t>(1, t_block * weights.size() * sizeof(double));
+            const size_t slabs = std::max<size_t>(1, std::min(budget / 2 / slab_bytes, 4 * grid_vars.size()));
+            value_cache = SlabCache(slabs);
+        }
+
+        size_t get_var_index(const std::string& name) const
+        {
+            auto found = var_index.find(name);
+            if( found == var_index.end() ) {
+                throw std::runtime_error("Cannot get forcing value for unrecognized parameter name '" + name + "'.");
+            }
+            return found->second;
+        }
+
+        size_t get_row(const std::string& id) const
+        {
+            const size_t row = weights.get_index(id);
+            if( row == weights.size() || !weights.has_cells(row) ) {
+                throw std::out_of_range("No forcing values for id " + id + " in gridded NetCDF file; it does not overlap the grid.");
+            }
+            return row;
+        }
+
+        /** The number of time steps in a time block, which is shorter for the last block. */
+        size_t get_block_len(size_t block) const
+        {
+            return std::min(t_block, num_times - block * t_block);
+        }
+
+        /**
+         * Get the values of a variable for catchments at several rows of the weights over the time period of a
+         * selector, converting units if needed.
+         *
+         * Each data time step is weighted by the part of it inside the period; for @ref MEAN, the weighted sum is
+         * scaled by the length of a time step over the length of the period.
+         */
+        void get_values_for_rows(size_t var_idx, const size_t* rows, size_t count, const CatchmentAggrDataSelector& selector, ReSampleMethod m, double* values)
+        {
+            const time_t init_time = selector.get_init_time();
+            const time_t end_time = init_time + selector.get_duration_secs();
+            const size_t idx1 = get_ts_index_for_time(init_time);
+            size_t idx2 = idx1;
+            if( end_time > init_time ) {
+                // to the edge of the data if the period runs past it
+                idx2 = end_time - 1 < stop_time ? get_ts_index_for_time(end_time - 1) : num_times - 1;
+            }
+
+            std::fill(values, values + count, 0.0);
+            const size_t num_catchments = weights.size();
+            {
+                const std::lock_guard<std::mutex> lock(value_cache_mutex);
+                for( size_t t = idx1; t <= idx2; ++t ) {
+                    const time_t t_start = start_time + time_t(t) * time_stride;
+                    double weight = 1.0;
+                    if( end_time > init_time ) {
+                        weight = double(std::min(t_start + time_stride, end_time) - std::max(t_start, init_time)) / time_stride;
+                        if( m == MEAN ) {
+                            weight *= double(time_stride) / (end_time - init_time);
+                        }
+                    }
+                    const size_t block = t / t_block;
+                    const std::vector<double>& slab = value_cache.get(var_idx, block, get_block_len(block) * num_catchments, [&](double* slab_values)
+                    {
+                        read_block(var_idx, block, slab_values);
+                    });
+                    const double* step_values = &slab[(t - block * t_block) * num_catchments];
+                    for( size_t i = 0; i < count; ++i ) {
+                        values[i] += weight * step_values[rows[i]];
+                    }
+                }
+            }
+
+            try
+            {
+                UnitsHelper::convert_values(var_units[var_idx], values, selector.get_output_units(), values, count);
+            }
+            catch (const std::runtime_error& e)
+            {
+                #ifndef UDUNITS_QUIET
+                NGEN_LOG_WARNING("Unit conversion unsuccessful - Returning unconverted value! (\"" << e.what() << "\")");
+                #endif
+            }
+        }
+
+        /**
+         * Read the window of a time block of a variable from the file, and aggregate each of its time steps into the
+         * values of every catchment; needs value_cache_mutex.
+         */
+        void read_block(size_t var_idx, size_t block, double* values)
+        {
+            const size_t block_len = get_block_len(block);
+            const size_t step_cells = weights.get_window_rows() * weights.get_window_columns();
+            window.resize(block_len * step_cells);
+            if( step_cells > 0 ) {
+                std::vector<size_t> start = {block * t_block, weights.get_window_row(), weights.get_window_column()};
+                std::vector<size_t> count = {block_len, weights.get_window_rows(), weights.get_window_columns()};
+                grid_vars[var_idx].getVar(start, count, window.data());
+            }
+
+            const Packing& packing = var_packing[var_idx];
+            for( double& value : window ) {
+                value = packing.has_fill && value == packing.fill_value ? std::numeric_limits<double>::quiet_NaN()
+                                                                        : value * packing.scale_factor + packing.add_offset;
+            }
+            for( size_t t = 0; t < block_len; ++t ) {
+                weights.apply(&window[t * step_cells], &values[t * weights.size()]);
+            }
+        }
+
+        static bool get_string_att(const netCDF::NcVar& ncvar, const std::string& name, std::string& value)
+        {
+            try {
+                auto atts = ncvar.getAtts();
+                auto found = atts.find(name);
+                if( found == atts.end() ) {
+                    return false;
+                }
+                found->second.getValues(value);
+                return true;
+            }
+            catch(const netCDF::exceptions::NcException& e) {
+                return false;
+            }
+        }
+
+        static bool get_double_att(const netCDF::NcVar& ncvar, const std::string& name, double& value)
+        {
+            try {
+                auto atts = ncvar.getAtts();
+                auto found = atts.find(name);
+                if( found == atts.end() ) {
+                    return false;
+                }
+                found->second.getValues(&value);
+                return true;
+            }
+            catch(const netCDF::exceptions::NcException& e) {
+                return false;
+            }
+        }
+
+        /**
+         * Parse CF time units, ``<units> since <date>``, into the seconds of each unit and the epoch time of the date.
+         *
+         * Units without a date are taken as since the Unix epoch.
+         */
+        static void parse_time_units(const std::string& units, double& scale, time_t& epoch, const std::string& input_path)
+        {
+            std::istringstream in(units);
+            std::string unit, since;
+            in >> unit >> since;
+            if( unit == "days" || unit == "day" || unit == "d" ) {
+                scale = 86400;
+            }
+            else if( unit == "hours" || unit == "hour" || unit == "h" ) {
+                scale = 3600;
+            }
+            else if( unit == "minutes" || unit == "minute" || unit == "min" || unit == "m" ) {
+                scale = 60;
+            }
+            else if( unit == "seconds" || unit == "second" || unit == "s" || unit.empty() ) {
+                scale = 1;
+            }
+            else {
+                throw std::runtime_error("Gridded forcing file " + input_path + " has times in unknown units \"" + units + "\"");
+            }
+
+            epoch = 0;
+            if( since == "since" ) {
+                std::string date;
+                std::getline(in, date);
+                std::replace(date.begin(), date.end(), 'T', ' ');
+                struct tm tm = {};
+                const char* parsed = strptime(date.c_str(), " %Y-%m-%d %H:%M:%S", &tm);
+                if( parsed == nullptr ) {
+                    tm = {};
+                    parsed = strptime(date.c_str(), " %Y-%m-%d", &tm);
+                }
+                if( parsed == nullptr ) {
+                    throw std::runtime_error("Gridded forcing file " + input_path + " has times since an unknown date \"" + units + "\"");
+                }
+                epoch = timegm(&tm);
+            }
+        }
+    };
+}
+
+#endif // NGEN_NETCDF_GRIDDED_DATAPROVIDER_HPP
+#endif
@@ -3,37 +3,63 @@
 #define NGEN_NETCDF_PER_FEATURE_DATAPROVIDER_HPP
 
 #include "GenericDataProvider.hpp"
+#include "AsyncDataProvider.hpp"
 #include "DataProviderSelectors.hpp"
+#include "RemoteObject.hpp"
 
 #include <string>
 #include <algorithm>
 #include <map>
+#include <tuple>
+#include <limits>
+#include <unordered_map>
 #include <memory>
 #include <string>
 #include <sstream>
 #include <exception>
 #include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <thread>
 #include "assert.h"
 #include <iomanip>
-#include <boost/compute/detail/lru_cache.hpp>
 
 #include <UnitsHelper.hpp>
 #include <StreamHandler.hpp>
+#include <Logger.hpp>
+#include <StepArena.hpp>
 
 #include <netcdf>
 
 #include "AorcForcing.hpp"
+#include "SlabCache.hpp"
+#include "ResampleWindow.hpp"
 
 using namespace netCDF;
 using namespace netCDF::exceptions;
 
 namespace data_access
 {
-    class NetCDFPerFeatureDataProvider : public GenericDataProvider
+    class NetCDFPerFeatureDataProvider : public AsyncDataProvider<double, CatchmentAggrDataSelector, GenericDataProvider>
     {
         
         public:
 
+        /**
+         * Memory budget, in megabytes, of the cached slabs of forcing values when none is configured.
+         */
+        static constexpr size_t DEFAULT_CACHE_SIZE_MB = 256;
+
+        /**
+         * Number of time steps read at once from variables that are not chunked along time.
+         */
+        static constexpr size_t DEFAULT_CACHE_TIME_BLOCK = 24;
+
+        /**
+         * Number of time blocks of every variable read ahead of the latest requested one when none is configured.
+         */
+        static constexpr size_t DEFAULT_PREFETCH_BLOCKS = 1;
+
         enum TimeUnit
         {
             TIME_HOURS,
@@ -49,34 +75,48 @@ namespace data_access
          * @param input_path The path to a NetCDF file with lumped catchment forcing values.
          * @param log_s An output log stream for messages from the underlying library. If a provider object for
          * the given path already exists, this argument will be ignored.
+         * @param cache_size_mb The memory budget of the provider's cache of forcing values, in megabytes, or 0 for
+         * @ref DEFAULT_CACHE_SIZE_MB. If a provider object for the given path already exists, this argument will be
+         * ignored.
+         * @param prefetch_blocks The number of time blocks to read ahead in the background, or 0 to only read on
+         * demand. If a provider object for the given path already exists, this argument will be ignored.
+         * @param feature_ids The ids of the catchments values may be requested for, or null for every catchment in
+         * the file. If a provider object for the given path already exists, this argument will be ignored.
          */
-        static std::shared_ptr<NetCDFPerFeatureDataProvider> get_shared_provider(std::string input_path, time_t sim_start, time_t sim_end, utils::StreamHandler log_s)
+        static std::shared_ptr<NetCDFPerFeatureDataProvider> get_shared_provider(std::string input_path, time_t sim_start, time_t sim_end, utils::StreamHandler log_s, size_t cache_size_mb = 0, size_t prefetch_blocks = DEFAULT_PREFETCH_BLOCKS, std::shared_ptr<const std::vector<std::string>> feature_ids = nullptr)
         {
             const std::lock_guard<std::mutex> lock(shared_providers_mutex);
             std::shared_ptr<NetCDFPerFeatureDataProvider> p;
             if(shared_providers.count(input_path) > 0){
                 p = shared_providers[input_path];
             } else {
-                p = std::make_shared<data_access::NetCDFPerFeatureDataProvider>(input_path, sim_start, sim_end, log_s);
+                p = std::make_shared<data_access::NetCDFPerFeatureDataProvider>(input_path, sim_start, sim_end, log_s, cache_size_mb, prefetch_blocks, feature_ids);
                 shared_providers[input_path] = p;
             }
             return p;
         }
 
-        NetCDFPerFeatureDataProvider(std::string input_path, time_t sim_start, time_t sim_end,  utils::StreamHandler log_s) : log_stream(log_s), value_cache(20),
+        /**
+         * @param input_path The path to a NetCDF file with lumped catchment forcing values.
+         * @param sim_start The epoch time of the start of the simulation.
+         * @param sim_end The epoch time of the end of the simulation.
+         * @param log_s An output log stream for messages from the underlying library.
+         * @param cache_size_mb The memory budget of the cache of forcing values, in megabytes, or 0 for
+         * @ref DEFAULT_CACHE_SIZE_MB.
+         * @param prefetch_blocks The number of time blocks of every variable to read ahead on a background thread
+         * while the current ones are in use, or 0 to only read on demand.
+         * @param feature_ids The ids of the catchments values may be requested for, e.g., those of this process's
+         * partition, or null for every catchment in the file. Only the rows of the file from the first through the
+         * last of these catchments are read and cached, so processes sharing a file each read their own part of it.
+         */
+        NetCDFPerFeatureDataProvider(std::string input_path, time_t sim_start, time_t sim_end,  utils::StreamHandler log_s, size_t cache_size_mb = 0, size_t prefetch_blocks = DEFAULT_PREFETCH_BLOCKS, std::shared_ptr<const std::vector<std::string>> feature_ids = nullptr) : log_stream(log_s), value_cache(1),
+            prefetch_blocks(prefetch_blocks),
             sim_start_date_time_epoch(sim_start),
             sim_end_date_time_epoch(sim_end)
 
         {
-            //size_t sizep = 1073741824, nelemsp = 202481;
-            //float preemptionp = 0.75;
-            //nc_set_chunk_cache(sizep, nelemsp, preemptionp);
-
             //open the file
-            nc_file = std::make_shared<NcFile>(input_path, NcFile::read);
-            
-            //nc_get_chunk_cache(&sizep, &nelemsp, &preemptionp);
-            //std::cout << "Chunk cache parameters: "<<sizep<<", "<<nelemsp<<", "<<preemptionp<<std::endl;
+            nc_file = std::make_shared<NcFile>(netcdf_path(input_path), NcFile::read);
 
             //get the listing of all variables
             auto var_set = nc_file->getVars();
@@ -138,9 +178,6 @@ namespace data_access
 
             auto num_ids = id_dim.getSize();
 
-            //TODO: split into smaller slices if num_ids is large.
-            cache_slice_c_size = num_ids;
-
             // allocate an array of character pointers 
             std::vector< char* > string_buffers(num_ids);
 
@@ -158,6 +195,8 @@ namespace data_access
             // correct string release
             ids.freeString(num_ids,&string_buffers[0]);
 
+            select_rows(feature_ids.get());
+
             // now get the size of the time dimension
             auto num_times = nc_file->getDim("time").getSize();
 
@@ -232,7 +271,7 @@ namespace data_access
                 }
             }
             catch(const netCDF::exceptions::NcException& e){
-                std::cerr<<e.what()<<std::endl;
+                NGEN_LOG_WARNING(e.what());
                 log_stream << "Warning using defualt time units\n";
             }
             assert(time_scale_factor != 0); // This should not happen.
@@ -252,7 +291,7 @@ namespace data_access
                 }
             }
             catch(const netCDF::exceptions::NcException& e) {
-                std::cerr<<e.what()<<std::endl;
+                NGEN_LOG_WARNING(e.what());
                 log_stream << "Warning using defualt epoc string\n";
             }
             
@@ -294,6 +333,31 @@ namespace data_access
             stop_time = time_vals.back() + time_stride;
 
             sim_to_data_time_offset = sim_start_date_time_epoch - start_time;
+
+            init_value_cache(cache_size_mb == 0 ? DEFAULT_CACHE_SIZE_MB : cache_size_mb);
+
+            if ( this->prefetch_blocks > 0 && !cache_vars.empty() )
+            {
+                prefetch_next.assign(cache_vars.size(), 0);
+                prefetch_thread = std::thread(&NetCDFPerFeatureDataProvider::prefetch, this);
+            }
+        }
+
+        NetCDFPerFeatureDataProvider(const NetCDFPerFeatureDataProvider&) = delete;
+        NetCDFPerFeatureDataProvider& operator=(const NetCDFPerFeatureDataProvider&) = delete;
+
+        /** Stop reading ahead, waiting for a read in progress to finish. */
+        ~NetCDFPerFeatureDataProvider() override
+        {
+            if ( prefetch_thread.joinable() )
+            {
+                {
+                    const std::lock_guard<std::mutex> lock(prefetch_mutex);
+                    prefetch_stopping = true;
+                }
+                prefetch_ready.notify_one();
+                prefetch_thread.join();
+            }
         }
 
         /*
@@ -311,7 +375,7 @@ namespace data_access
             return variable_names;
         }
 
-        /** return a list of ids in the current file */
+        /** return a list of ids in the current file, including any whose rows are not read */
         const std::vector<std::string>& get_ids() const
         {
             return loc_ids;
@@ -340,6 +404,12 @@ namespace data_access
             return time_stride;
         }
 
+        /** Values are read from the file on demand, so it must already hold the data of the extended period. */
+        void extend_to(time_t end_time) override
+        {
+            sim_end_date_time_epoch = end_time;
+        }
+
         /**
          * Get the index of the data time step that contains the given point in time.
          *
@@ -377,82 +447,315 @@ namespace data_access
          */
         double get_value(const CatchmentAggrDataSelector& selector, ReSampleMethod m) override
         {
-            auto init_time = selector.get_init_time();
-            auto stop_time = init_time + selector.get_duration_secs(); // scope hiding! BAD JUJU!
-            
-            size_t idx1 = get_ts_index_for_time(init_time);
-            size_t idx2;
-            try {
-                idx2 = get_ts_index_for_time(stop_time-1); // Don't include next timestep when duration % timestep = 0
+            size_t var_idx = get_cache_var_index(selector.get_variable_name());
+            size_t cat_pos = get_id_pos(selector.get_id());
+            const time_t init_time = selector.get_init_time();
+            const long duration = selector.get_duration_secs();
+            const std::string output_units = selector.get_output_units();
+
+            // Serve the value from the batch of every catchment requested so far, computing the batch for a time
+            // period once, on the first request for it; each variable's batch has its own lock, so catchments
+            // reading different variables don't wait on each other
+            size_t slot;
+            {
+                const std::lock_guard<std::mutex> lock(batch_mutex);
+                size_t& found = batch_slots[cat_pos];
+                if( found == NO_BATCH_SLOT ) {
+                    found = batch_positions.size();
+                    batch_positions.push_back(cat_pos);
+                }
+                slot = found;
+            }
+            ValueBatch& batch = batches[var_idx];
+            const std::lock_guard<std::mutex> lock(batch.mutex);
+            bool same_period = batch.valid && batch.init_time == init_time && batch.duration == duration && batch.m == m
+                               && batch.output_units == output_units;
+            if( !same_period && (!batch.valid || init_time > batch.init_time) ) {
+                batch.values.clear();
+                batch.init_time = init_time;
+                batch.duration = duration;
+                batch.m = m;
+                batch.output_units = output_units;
+                batch.valid = true;
+                same_period = true;
+            }
+            if( !same_period ) {
+                // an earlier or differently sampled period than the batch; not worth a batch of its own
+                double value;
+                get_values_for_positions(var_idx, &cat_pos, 1, selector, m, &value);
+                return value;
             }
-            catch(const std::out_of_range &e){
-                idx2 = get_ts_index_for_time(this->stop_time-1); //to the edge
+            if( slot >= batch.values.size() ) {
+                // catchments first requested after the batch was computed are added for this and later periods
+                size_t computed = batch.values.size();
+                utils::arena_vector<size_t> added;
+                {
+                    const std::lock_guard<std::mutex> positions_lock(batch_mutex);
+                    added.assign(batch_positions.begin() + computed, batch_positions.end());
+                }
+                batch.values.resize(computed + added.size());
+                get_values_for_positions(var_idx, added.data(), added.size(), selector, m, &batch.values[computed]);
             }
+            return batch.values[slot];
+        }
 
-            auto stride = idx2 - idx1;
+        /**
+         * Get the values of a forcing property for several catchments over the time period of a selector, converting
+         * units if needed.
+         *
+         * The time steps overlapping the period, the variable and the unit conversion are looked up once for all of
+         * the catchments, and each cached slab is read once.
+         *
+         * @param ids The ids of the catchments; the id of @p selector is ignored.
+         * @param selector The variable, time period and units of the values.
+         * @param m How data is to be resampled if there is a mismatch in data alignment or repeat rate
+         * @param values Storage for ``ids.size()`` values, written in the order of @p ids.
+         * @throws std::out_of_range If data for the time period, or any of the ids, is not available.
+         */
+        void get_values_for_ids(const std::vector<std::string>& ids, const CatchmentAggrDataSelector& selector, ReSampleMethod m, double* values) override
+        {
+            size_t var_idx = get_cache_var_index(selector.get_variable_name());
+            utils::arena_vector<size_t> positions(ids.size());
+            std::transform(ids.begin(), ids.end(), positions.begin(), [this](const std::string& id){ return get_id_pos(id); });
+            get_values_for_positions(var_idx, positions.data(), positions.size(), selector, m, values);
+        }
 
-            std::vector<std::size_t> start, count;
+        virtual std::vector<double> get_values(const CatchmentAggrDataSelector& selector, data_access::ReSampleMethod m) override
+        {
+            return std::vector<double>(1, get_value(selector, m));
+        }
 
-            auto cat_pos = id_pos[selector.get_id()];
+        /** Whether every time block of the selection is cached, so @ref get_value will not read the file. */
+        bool value_ready(const CatchmentAggrDataSelector& selector) override
+        {
+            size_t var_idx = get_cache_var_index(selector.get_variable_name());
+            const size_t t_block = cache_var_t_blocks[var_idx];
+            ResampleWindow window;
+            get_resample_window(selector, window);
+            const size_t idx1 = window.first_index, idx2 = window.last_index;
+
+            const std::lock_guard<std::mutex> lock(value_cache_mutex);
+            for( size_t block = idx1 / t_block; block <= idx2 / t_block; ++block ) {
+                if( !value_cache.contains(var_idx, block) ) {
+                    return false;
+                }
+            }
+            return true;
+        }
 
+        /**
+         * Schedule the time blocks of the selection to be read on the background thread.
+         *
+         * Without read ahead (a ``prefetch_blocks`` of 0), the blocks are read before returning.
+         */
+        void request_value(const CatchmentAggrDataSelector& selector) override
+        {
+            size_t var_idx = get_cache_var_index(selector.get_variable_name());
+            const size_t t_block = cache_var_t_blocks[var_idx];
+            ResampleWindow window;
+            get_resample_window(selector, window);
+            const size_t idx1 = window.first_index, idx2 = window.last_index;
 
+            if ( !prefetch_thread.joinable() )
+            {
+                accumulate_values(var_idx, nullptr, 0, idx1, idx2, nullptr, nullptr);
+                return;
+            }
 
-            double t1 = time_vals[idx1];
-            double t2 = time_vals[idx2];
+            {
+                const std::lock_guard<std::mutex> lock(prefetch_mutex);
+                for( size_t block = idx1 / t_block; block <= idx2 / t_block; ++block ) {
+                    prefetch_queue.emplace_back(var_idx, block);
+                }
+            }
+            prefetch_ready.notify_one();
+        }
 
-            double rvalue = 0.0;
-            
-            auto ncvar = get_ncvar(selector.get_variable_name());
+        /** @return The bytes of the cached slabs of values, and of the times of the file. */
+        size_t get_memory_bytes() override
+        {
+            const std::lock_guard<std::mutex> lock(value_cache_mutex);
+            return value_cache.get_memory_bytes() + time_vals.capacity() * sizeof(double);
+        }
 
-            std::string native_units = get_ncvar_units(selector.get_variable_name());
 
-            auto read_len = idx2 - idx1 + 1;
+        private:
 
-            std::vector<double> raw_values;
-            raw_values.resize(read_len);
+        time_t sim_start_date_time_epoch;
+        time_t sim_end_date_time_epoch;
+        time_t sim_to_data_time_offset; // Deliberately signed--sim should never start before data, yes?
 
-            //TODO: Currently assuming a whole variable cache slice across all catchments for a single timestep...but some stuff here to support otherwise.
-            size_t cache_slices_t_n = read_len / cache_slice_t_size; // Integer division!
-            // For reference: https://stackoverflow.com/a/72030286
-            for( size_t i = 0; i < cache_slices_t_n; i++ ) {
-                std::shared_ptr<std::vector<double>> cached;
-                int cache_t_idx = (idx1 - (idx1 % cache_slice_t_size) + i);
-                std::string key = ncvar.getName() + "|" + std::to_string(cache_t_idx);
-                if(value_cache.contains(key)){
-                    cached = value_cache.get(key).get();
-                } else {
-                    cached = std::make_shared<std::vector<double>>(cache_slice_c_size * cache_slice_t_size);
-                    start.clear();
-                    start.push_back(0); // only always 0 when cache_slice_c_size = numids!
-                    start.push_back(cache_t_idx * cache_slice_t_size);
-                    count.clear();
-                    count.push_back(cache_slice_c_size);
-                    count.push_back(cache_slice_t_size); // Must be 1 for now!...probably...
-                    ncvar.getVar(start,count,&(*cached)[0]);
-                    value_cache.insert(key, cached);
-                }
-                for( size_t j = 0; j < cache_slice_t_size; j++){
-                    raw_values[i+j] = cached->at((j*cache_slice_t_size) + cat_pos);
-                }
+        static std::mutex shared_providers_mutex;
+        static std::map<std::string, std::shared_ptr<NetCDFPerFeatureDataProvider>> shared_providers;
+
+        std::vector<std::string> variable_names;
+        std::vector<std::string> loc_ids;
+        std::vector<double> time_vals;
+        std::unordered_map<std::string, std::size_t> id_pos;   // position of each readable id in the rows read
+        std::vector<std::pair<size_t, size_t>> row_runs; // (first row, number of rows) of each run of file rows read
+        double start_time;                              // the begining of the first time for which data is stored
+        double stop_time;                               // the end of the last time for which data is stored
+        TimeUnit time_unit;                             // the unit that time was stored as in the file
+        double time_stride;                             // the amount of time between stored time values
+        utils::StreamHandler log_stream;
+
+
+        std::shared_ptr<NcFile> nc_file;
+
+        std::map<std::string,netCDF::NcVar> ncvar_cache = {};
+        std::map<std::string,std::string> units_cache = {};
+        std::mutex value_cache_mutex;                   // guards value_cache and loading_slabs; never held while reading the file
+        std::mutex file_mutex;                          // serializes reads of the file, as the NetCDF library is not thread safe
+        SlabCache value_cache;                          // slabs of all catchments over time blocks, keyed by variable index
+        std::vector<std::pair<size_t, size_t>> loading_slabs; // (variable index, time block) of the slabs being read
+        std::condition_variable slab_loaded;            // notified when a slab being read is cached, or its read fails
+        std::vector<netCDF::NcVar> cache_vars;          // the cacheable (id, time) variables, by variable index
+        std::vector<size_t> cache_var_t_blocks;         // the number of time steps in each variable's slabs
+        std::unordered_map<std::string, size_t> cache_var_index; // variable index of each variable name and CSDMS alias
+
+        /** The values of a variable for the catchments requested so far, over one time period. */
+        struct ValueBatch
+        {
+            std::mutex mutex;                           // guards the batch; may be taken before the locks other than batch_mutex
+            bool valid = false;
+            time_t init_time = 0;
+            long duration = 0;
+            ReSampleMethod m = SUM;
+            std::string output_units;
+            std::vector<double> values;                 // by slot in batch_positions
+        };
+
+        /** The time steps and weights of the value of a variable for one time period and resampling method. */
+        struct WindowPlan
+        {
+            size_t idx1;
+            size_t idx2;
+            std::vector<double> weights;                // of each time step from idx1 through idx2
+        };
+
+        static constexpr size_t NO_BATCH_SLOT = std::numeric_limits<size_t>::max();
+        std::mutex batch_mutex;                         // guards batch_positions and batch_slots; may be taken while holding a batch's mutex
+        std::vector<size_t> batch_positions;            // file positions of the catchments requested, in request order
+        std::vector<size_t> batch_slots;                // slot in batch_positions of each file position, or NO_BATCH_SLOT
+        std::vector<ValueBatch> batches;                // by variable index
+        std::mutex window_plans_mutex;                  // guards window_plans and latest_plan_time
+        std::map<std::tuple<time_t, long, ReSampleMethod>, std::shared_ptr<const WindowPlan>> window_plans; // by (init time, duration, method)
+        time_t latest_plan_time = 0;
+        size_t cache_slice_c_size = 1;
+
+        size_t prefetch_blocks;                         // the number of time blocks of each variable read ahead
+        std::vector<size_t> prefetch_next;              // the first time block of each variable not yet scheduled
+        std::deque<std::pair<size_t, size_t>> prefetch_queue; // (variable index, time block) pairs waiting to be read
+        bool prefetch_stopping = false;
+        std::mutex prefetch_mutex;                      // guards prefetch_next, prefetch_queue and prefetch_stopping
+        std::condition_variable prefetch_ready;
+        std::thread prefetch_thread;
+
+        /**
+         * Get the data time steps overlapping the time period of a selection.
+         *
+         * A period running past the last time step ends at it.
+         *
+         * @throws std::out_of_range If the period does not start in any time step.
+         */
+        void get_resample_window(const CatchmentAggrDataSelector& selector, ResampleWindow& window)
+        {
+            if( !window.set(start_time, time_stride, time_vals.size(), selector.get_init_time(), selector.get_duration_secs()) ) {
+                std::stringstream ss;
+                ss << "The value " << (int)selector.get_init_time() << " was not in the range [" << (int)start_time << "," << (int)stop_time << ")\n" << SOURCE_LOC;
+                throw std::out_of_range(ss.str().c_str());
             }
+        }
 
-            
-            rvalue = 0.0;
+        /**
+         * Get the plan of the values for the time period of a selector, resampled with @p m, computing it on the first
+         * request for the period, as every catchment and variable asks for the same ones each time step.
+         *
+         * Plans are kept for the latest period start requested, and for any earlier ones requested since it.
+         *
+         * @throws std::out_of_range If the period does not start in any time step.
+         */
+        std::shared_ptr<const WindowPlan> get_window_plan(const CatchmentAggrDataSelector& selector, ReSampleMethod m)
+        {
+            const time_t init_time = selector.get_init_time();
+            const auto key = std::make_tuple(init_time, selector.get_duration_secs(), m);
 
-            double a , b = 0.0;
-            
-            a = 1.0 - ( (t1 - init_time) / time_stride );
-            rvalue += (a * raw_values[0]);
+            const std::lock_guard<std::mutex> lock(window_plans_mutex);
+            auto found = window_plans.find(key);
+            if( found != window_plans.end() ) {
+                return found->second;
+            }
+
+            auto plan = std::make_shared<WindowPlan>();
+            ResampleWindow window;
+            get_resample_window(selector, window);
+            plan->idx1 = window.first_index;
+            plan->idx2 = window.last_index;
+            get_window_weights(selector, m, window, plan->weights);
+            if( window_plans.empty() || init_time > latest_plan_time ) {
+                window_plans.clear();
+                latest_plan_time = init_time;
+            }
+            window_plans.emplace(key, plan);
+            return plan;
+        }
+
+        /** The number of time steps in a time block of a variable, which is shorter for the last block. */
+        size_t get_block_len(size_t var_idx, size_t block) const
+        {
+            const size_t t_block = cache_var_t_blocks[var_idx];
+            return std::min(t_block, time_vals.size() - block * t_block);
+        }
+
+        /**
+         * Get the values of a variable for catchments at several positions in the file over the time period of a
+         * selector, converting units if needed.
+         */
+        void get_values_for_positions(size_t var_idx, const size_t* positions, size_t count, const CatchmentAggrDataSelector& selector, ReSampleMethod m, double* values)
+        {
+            const std::shared_ptr<const WindowPlan> plan = get_window_plan(selector, m);
 
-            for( size_t i = 1; i < raw_values.size() -1; ++i )
+            std::fill(values, values + count, 0.0);
+            accumulate_values(var_idx, positions, count, plan->idx1, plan->idx2, plan->weights.data(), values);
+
+            // while the models use these values, read the blocks after them
+            if ( prefetch_thread.joinable() )
             {
-                rvalue += raw_values[i];
+                schedule_prefetch(plan->idx2);
             }
 
-            if (  raw_values.size() > 1) // likewise the last data value may not be fully in the window
+            try 
+            {
+                UnitsHelper::convert_values(get_ncvar_units(selector.get_variable_name()), values, selector.get_output_units(), values, count);
+            }
+            catch (const std::runtime_error& e)
             {
-                b = (stop_time - t2) / time_stride;
-                rvalue += (b * raw_values.back() );
+                #ifndef UDUNITS_QUIET
+                NGEN_LOG_WARNING("Unit conversion unsuccessful - Returning unconverted value! (\"" << e.what() << "\")");
+                #endif
+            }
+        }
+
+        /**
+         * Get the weight of each data time step of a window in the value for the time period of a selector, resampled
+         * with @p m.
+         *
+         * The first and last data values may only partly overlap the period and are weighted by their overlap; for
+         * @ref MEAN, all weights are then scaled to give the length weighted mean.
+         */
+        void get_window_weights(const CatchmentAggrDataSelector& selector, ReSampleMethod m, const ResampleWindow& window, std::vector<double>& weights)
+        {
+            weights.assign(window.last_index - window.first_index + 1, 1.0);
+
+            double a , b = 0.0;
+            
+            a = window.overlap(window.first_index);
+            weights.front() = a;
+
+            if (  weights.size() > 1) // likewise the last data value may not be fully in the window
+            {
+                b = window.overlap(window.last_index);
+                weights.back() = b;
             }
 
             // account for the resampling methods
@@ -469,62 +772,352 @@ namespace data_access
                     // so we just need to do a final scale to account for the differnce between time_stride and duration_s
 
                     double scale_factor = (selector.get_duration_secs() > time_stride ) ? (time_stride / selector.get_duration_secs()) : (1.0 / (a + b));
-                    rvalue *= scale_factor;
+                    for( auto& weight : weights ) {
+                        weight *= scale_factor;
+                    }
                 }
                 break;
 
                 default:
                     ;
             }
+        }
 
-            try 
-            {
-                return UnitsHelper::get_converted_value(native_units, rvalue, selector.get_output_units());
+        /**
+         * Add the weighted values of catchments at several positions in the file over a range of time steps, out of
+         * the cached slabs of a variable, reading slabs that are not cached from the file.
+         *
+         * @param weights The weight of each time step from @p idx1 through @p idx2; unused when @p count is 0.
+         * @param values The sums for each of the @p count positions, which are added to.
+         */
+        void accumulate_values(size_t var_idx, const size_t* positions, size_t count, size_t idx1, size_t idx2, const double* weights, double* values)
+        {
+            const size_t t_block = cache_var_t_blocks[var_idx];
+            std::unique_lock<std::mutex> cache_lock(value_cache_mutex);
+            for( size_t block = idx1 / t_block; block <= idx2 / t_block; ++block ) {
+                size_t block_start = block * t_block;
+                size_t block_len = get_block_len(var_idx, block);
+                size_t first = std::max(block_start, idx1);
+                size_t end = std::min(block_start + block_len, idx2 + 1);
+
+                const std::vector<double>& cached = load_slab(var_idx, block, cache_lock);
+                for( size_t i = 0; i < count; ++i ) {
+                    const double* row = &cached[positions[i] * block_len];
+                    double sum = 0.0;
+                    for( size_t t = first; t < end; ++t ) {
+                        sum += weights[t - idx1] * row[t - block_start];
+                    }
+                    values[i] += sum;
+                }
             }
-            catch (const std::runtime_error& e)
+        }
+
+        /**
+         * Get the slab of a time block of a variable from the cache, reading it into the cache first if needed.
+         *
+         * A slab is read once however many threads want it: the first claims it in @ref loading_slabs and reads it
+         * holding only file_mutex, so other threads are served the slabs already cached meanwhile, and those wanting
+         * the same slab wait for that read alone.  If the read fails, a waiting thread tries it again itself.
+         *
+         * @param cache_lock The held lock of value_cache_mutex, which is released while the file is read.
+         * @return The values of the slab, valid while @p cache_lock stays held.
+         */
+        const std::vector<double>& load_slab(size_t var_idx, size_t block, std::unique_lock<std::mutex>& cache_lock)
+        {
+            const std::pair<size_t, size_t> key(var_idx, block);
+            while( true ) {
+                const std::vector<double>* cached = value_cache.find(var_idx, block);
+                if( cached != nullptr ) {
+                    return *cached;
+                }
+                if( std::find(loading_slabs.begin(), loading_slabs.end(), key) != loading_slabs.end() ) {
+                    slab_loaded.wait(cache_lock);
+                    continue;
+                }
+                loading_slabs.push_back(key);
+                cache_lock.unlock();
+                std::vector<double> slab;
+                try {
+                    slab.resize(cache_slice_c_size * get_block_len(var_idx, block));
+                    const std::lock_guard<std::mutex> file_lock(file_mutex);
+                    read_slab(var_idx, block, slab.data());
+                }
+                catch(...) {
+                    cache_lock.lock();
+                    finish_loading(key);
+                    throw;
+                }
+                cache_lock.lock();
+                value_cache.put(var_idx, block, slab);
+                finish_loading(key);
+            }
+        }
+
+        /** Release the claim of a slab being read, waking the threads waiting on it; needs value_cache_mutex. */
+        void finish_loading(const std::pair<size_t, size_t>& key)
+        {
+            loading_slabs.erase(std::find(loading_slabs.begin(), loading_slabs.end(), key));
+            slab_loaded.notify_all();
+        }
+
+        /**
+         * Read the slab of the catchments read over a time block of a variable from the file, one run of rows at a
+         * time; needs file_mutex.
+         */
+        void read_slab(size_t var_idx, size_t block, double* values)
+        {
+            const size_t block_len = get_block_len(var_idx, block);
+            std::vector<size_t> start = {0, block * cache_var_t_blocks[var_idx]};
+            std::vector<size_t> count = {0, block_len};
+            for( const auto& run : row_runs ) {
+                start[0] = run.first;
+                count[0] = run.second;
+                cache_vars[var_idx].getVar(start, count, values);
+                values += run.second * block_len;
+            }
+        }
+
+        /**
+         * Schedule the next @ref prefetch_blocks time blocks of every variable after the one holding a time step, that
+         * have not been scheduled already.
+         */
+        void schedule_prefetch(size_t t_idx)
+        {
+            bool scheduled = false;
             {
-                #ifndef UDUNITS_QUIET
-                std::cerr<<"WARN: Unit conversion unsuccessful - Returning unconverted value! (\""<<e.what()<<"\")"<<std::endl;
-                #endif
-                return rvalue;
+                const std::lock_guard<std::mutex> lock(prefetch_mutex);
+                for( size_t var_idx = 0; var_idx < cache_vars.size(); ++var_idx ) {
+                    const size_t t_block = cache_var_t_blocks[var_idx];
+                    const size_t num_blocks = (time_vals.size() + t_block - 1) / t_block;
+                    const size_t current = t_idx / t_block;
+                    const size_t last = std::min(current + prefetch_blocks, num_blocks - 1);
+                    size_t& next = prefetch_next[var_idx];
+                    next = std::max(next, current + 1);
+                    for( ; next <= last; ++next ) {
+                        prefetch_queue.emplace_back(var_idx, next);
+                        scheduled = true;
+                    }
+                }
+            }
+            if( scheduled ) {
+                prefetch_ready.notify_one();
+            }
+        }
+
+        /**
+         * Body of the background thread, reading the scheduled time blocks that are not cached yet into the cache.
+         *
+         * Failed reads are dropped; the block is then read, and the failure raised, when it is requested.
+         */
+        void prefetch()
+        {
+            std::vector<double> slab;
+            while( true ) {
+                std::pair<size_t, size_t> key;
+                {
+                    std::unique_lock<std::mutex> lock(prefetch_mutex);
+                    prefetch_ready.wait(lock, [this]{ return prefetch_stopping || !prefetch_queue.empty(); });
+                    if( prefetch_stopping ) {
+                        return;
+                    }
+                    key = prefetch_queue.front();
+                    prefetch_queue.pop_front();
+                }
+
+                {
+                    // a slab being read on demand is left to that read
+                    const std::lock_guard<std::mutex> cache_lock(value_cache_mutex);
+                    if( value_cache.contains(key.first, key.second)
+                        || std::find(loading_slabs.begin(), loading_slabs.end(), key) != loading_slabs.end() ) {
+                        continue;
+                    }
+                    loading_slabs.push_back(key);
+                }
+                bool is_read = true;
+                try {
+                    slab.resize(cache_slice_c_size * get_block_len(key.first, key.second));
+                    const std::lock_guard<std::mutex> file_lock(file_mutex);
+                    read_slab(key.first, key.second, slab.data());
+                }
+                catch(const std::exception& e) {
+                    is_read = false;
+                }
+                const std::lock_guard<std::mutex> cache_lock(value_cache_mutex);
+                if( is_read ) {
+                    value_cache.put(key.first, key.second, slab);
+                }
+                finish_loading(key);
             }
+        }
 
-            return rvalue;
+        /**
+         * Limit the rows read from the file to those of the given catchments, leaving only those catchments readable,
+         * at their positions among the rows read.
+         *
+         * The rows are grouped into runs of consecutive rows, each read with one call, so catchments that are
+         * neighbors in the file, as those of one partition usually are, cost no more to read than a single range.
+         */
+        void select_rows(const std::vector<std::string>* feature_ids)
+        {
+            row_runs.clear();
+            if( feature_ids == nullptr ) {
+                cache_slice_c_size = loc_ids.size();
+                if( cache_slice_c_size > 0 ) {
+                    row_runs.emplace_back(0, cache_slice_c_size);
+                }
+                return;
+            }
+            std::vector<size_t> rows;
+            for( const auto& id : *feature_ids ) {
+                auto found = id_pos.find(id);
+                if( found != id_pos.end() ) {
+                    rows.push_back(found->second);
+                }
+            }
+            std::sort(rows.begin(), rows.end());
+            rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+            id_pos.clear();
+            for( size_t i = 0; i < rows.size(); ++i ) {
+                if( row_runs.empty() || row_runs.back().first + row_runs.back().second != rows[i] ) {
+                    row_runs.emplace_back(rows[i], 0);
+                }
+                ++row_runs.back().second;
+                id_pos[loc_ids[rows[i]]] = i;
+            }
+            cache_slice_c_size = rows.size();
         }
 
-        virtual std::vector<double> get_values(const CatchmentAggrDataSelector& selector, data_access::ReSampleMethod m) override
+        /**
+         * Size the library's chunk cache of a variable to hold every chunk overlapping one of its slabs.
+         *
+         * Slabs shorter than a chunk of time steps come out of the same chunks as the next slab, which are then
+         * still cached instead of being read and decompressed again.  The cache is never made smaller than the
+         * library's default, nor larger than @p max_bytes.
+         */
+        void size_chunk_cache(netCDF::NcVar& ncvar, size_t t_block, size_t max_bytes)
         {
-            return std::vector<double>(1, get_value(selector, m));
+            netCDF::NcVar::ChunkMode mode;
+            std::vector<size_t> chunk_sizes;
+            try {
+                ncvar.getChunkingParameters(mode, chunk_sizes);
+            }
+            catch(const netCDF::exceptions::NcException& e) {
+                return;
+            }
+            if( mode != netCDF::NcVar::nc_CHUNKED || chunk_sizes.size() != 2 || chunk_sizes[0] == 0 || chunk_sizes[1] == 0
+                || cache_slice_c_size == 0 ) {
+                return;
+            }
+            // the chunks along the ids overlapped by the runs, counting those shared by neighboring runs once
+            size_t id_chunks = 0;
+            size_t next_chunk = 0;
+            for( const auto& run : row_runs ) {
+                const size_t first_chunk = std::max(next_chunk, run.first / chunk_sizes[0]);
+                const size_t last_chunk = (run.first + run.second - 1) / chunk_sizes[0];
+                if( last_chunk >= first_chunk ) {
+                    id_chunks += last_chunk - first_chunk + 1;
+                    next_chunk = last_chunk + 1;
+                }
+            }
+            // an unaligned block may overlap one more chunk of time steps
+            const size_t time_chunks = (t_block + chunk_sizes[1] - 1) / chunk_sizes[1] + 1;
+            const size_t chunks = id_chunks * time_chunks;
+            const size_t bytes = chunks * chunk_sizes[0] * chunk_sizes[1] * ncvar.getType().getSize();
+
+            size_t default_bytes, default_chunks;
+            float preemption;
+            ncvar.getChunkCache(default_bytes, default_chunks, preemption);
+            if( bytes <= default_bytes ) {
+                return;
+            }
+            // the chunks of a slab are all read together, so none of them are preferred for eviction
+            ncvar.setChunkCache(std::min(bytes, std::max(default_bytes, max_bytes)), std::max(default_chunks, chunks), 0.0f);
         }
 
+        /**
+         * Choose the time block of each (id, time) variable and size the slab cache to a memory budget.
+         *
+         * Variables chunked along time use slabs of one chunk of time steps, so each read decompresses whole chunks;
+         * others use @ref DEFAULT_CACHE_TIME_BLOCK time steps.  Blocks are shrunk if needed so the slabs of every
+         * variable in use and read ahead fit in the budget together, and the cache then holds as many slabs as the
+         * budget allows.  The library's chunk cache of each variable is sized to the chunks of its slabs.
+         */
+        void init_value_cache(size_t cache_size_mb)
+        {
+            const size_t budget = cache_size_mb * 1024 * 1024;
+            const size_t num_times = time_vals.size();
+
+            std::map<std::string, size_t> index_by_var;
+            for( const auto& element : ncvar_cache ) {
+                const netCDF::NcVar& ncvar = element.second;
+                if( ncvar.getDimCount() != 2 || ncvar.getName() == "Time" ) {
+                    continue;
+                }
+                auto found = index_by_var.find(ncvar.getName());
+                if( found == index_by_var.end() ) {
+                    found = index_by_var.emplace(ncvar.getName(), cache_vars.size()).first;
+                    cache_vars.push_back(ncvar);
+                    cache_var_t_blocks.push_back(get_chunk_time_steps(ncvar));
+                }
+                cache_var_index[element.first] = found->second;
+            }
 
-        private:
+            const size_t step_bytes = std::max<size_t>(1, cache_slice_c_size * sizeof(double));
+            const size_t slabs_per_var = 1 + prefetch_blocks;
+            const size_t max_block = std::max<size_t>(1, budget / (step_bytes * slabs_per_var * std::max<size_t>(1, cache_vars.size())));
+            size_t max_slab_bytes = step_bytes;
+            for( size_t var_idx = 0; var_idx < cache_vars.size(); ++var_idx ) {
+                size_t& t_block = cache_var_t_blocks[var_idx];
+                t_block = std::max<size_t>(1, std::min({t_block, max_block, num_times}));
+                max_slab_bytes = std::max(max_slab_bytes, t_block * step_bytes);
+                size_chunk_cache(cache_vars[var_idx], t_block, budget / std::max<size_t>(1, cache_vars.size()));
+            }
+            value_cache = SlabCache(std::max<size_t>(1, budget / max_slab_bytes));
 
-        time_t sim_start_date_time_epoch;
-        time_t sim_end_date_time_epoch;
-        time_t sim_to_data_time_offset; // Deliberately signed--sim should never start before data, yes?
+            batch_slots.assign(cache_slice_c_size, NO_BATCH_SLOT);
+            batches = std::vector<ValueBatch>(cache_vars.size());
+        }
 
-        static std::mutex shared_providers_mutex;
-        static std::map<std::string, std::shared_ptr<NetCDFPerFeatureDataProvider>> shared_providers;
+        /**
+         * Get the number of time steps in the storage chunks of an (id, time) variable, or
+         * @ref DEFAULT_CACHE_TIME_BLOCK if it is not chunked.
+         */
+        static size_t get_chunk_time_steps(const netCDF::NcVar& ncvar)
+        {
+            netCDF::NcVar::ChunkMode mode;
+            std::vector<size_t> chunk_sizes;
+            try {
+                ncvar.getChunkingParameters(mode, chunk_sizes);
+            }
+            catch(const netCDF::exceptions::NcException& e) {
+                return DEFAULT_CACHE_TIME_BLOCK;
+            }
+            if( mode == netCDF::NcVar::nc_CHUNKED && chunk_sizes.size() == 2 && chunk_sizes[1] > 0 ) {
+                return chunk_sizes[1];
+            }
+            return DEFAULT_CACHE_TIME_BLOCK;
+        }
 
-        std::vector<std::string> variable_names;
-        std::vector<std::string> loc_ids;
-        std::vector<double> time_vals;
-        std::map<std::string, std::size_t> id_pos;
-        double start_time;                              // the begining of the first time for which data is stored
-        double stop_time;                               // the end of the last time for which data is stored
-        TimeUnit time_unit;                             // the unit that time was stored as in the file
-        double time_stride;                             // the amount of time between stored time values
-        utils::StreamHandler log_stream;
+        size_t get_id_pos(const std::string& id) const {
+            auto found = id_pos.find(id);
+            if(found != id_pos.end()){
+                return found->second;
+            }
 
+            throw std::out_of_range("No forcing values for id " + id + " in NetCDF file." + SOURCE_LOC);
+        }
 
-        std::shared_ptr<NcFile> nc_file;
+        size_t get_cache_var_index(const std::string& name){
+            auto cache_hit = cache_var_index.find(name);
+            if(cache_hit != cache_var_index.end()){
+                return cache_hit->second;
+            }
 
-        std::map<std::string,netCDF::NcVar> ncvar_cache = {};
-        std::map<std::string,std::string> units_cache = {};
-        boost::compute::detail::lru_cache<std::string, std::shared_ptr<std::vector<double>>> value_cache;
-        size_t cache_slice_t_size = 1;
-        size_t cache_slice_c_size = 1;
+            // distinguish unknown variables from known ones that do not hold per catchment forcing values
+            get_ncvar(name);
+            throw std::runtime_error("Got request for variable " + name + " but it does not have (id, time) dimensions." + SOURCE_LOC);
+        }
 
         const netCDF::NcVar& get_ncvar(const std::string& name){
             auto cache_hit = ncvar_cache.find(name);
@@ -173,15 +173,19 @@ namespace data_access {
         {
             defaultValues = move(provider_to_move.defaultValues);
             defaultUsageWaits = move(provider_to_move.defaultUsageWaits);
+            suppliedByWrapped = move(provider_to_move.suppliedByWrapped);
+            forwarding = provider_to_move.forwarding;
             wrapped_provider = provider_to_move.wrapped_provider;
             provider_to_move.wrapped_provider = nullptr;
+            provider_to_move.forwarding = false;
         }
 
         /**
          * Get the value of a forcing property for an arbitrary time period, converting units if needed.
          *
          * This implementation can supply a default value in certain cases.  Otherwise, it defers to the wrapped,
-         * backing object.
+         * backing object.  Once the wrapped provider supplies every output and no default usage waits remain, no
+         * default can be used again, so values are forwarded straight from the wrapped provider.
          *
          * An @ref out_of_range exception should be thrown if the data for the time period is not available.
          *
@@ -194,15 +198,16 @@ namespace data_access {
          */
         double get_value(const CatchmentAggrDataSelector& selector, data_access::ReSampleMethod m) override
         {
-            string output_name = selector.get_variable_name();
-            time_t init_time = selector.get_init_time();
-            const long duration_s = selector.get_duration_secs();
-            const string output_units = selector.get_output_units();
-            
+            const string output_name = selector.get_variable_name();
+
             // Balk if not in this instance's collection of outputs
-            if (find(providedOutputs.begin(), providedOutputs.end(), output_name) == providedOutputs.end()) {
+            auto name_it = find(providedOutputs.begin(), providedOutputs.end(), output_name);
+            if (name_it == providedOutputs.end()) {
                 throw runtime_error("Unknown output " + output_name + " requested from wrapped provider");
             }
+            if (forwarding) {
+                return wrapped_provider->get_value(selector, m);
+            }
             // Balk if this instance is not ready
             if (!isReadyToProvideData()) {
                 throw runtime_error("Cannot get value for " + output_name
@@ -218,6 +223,7 @@ namespace data_access {
             if (!isSuppliedByWrappedProvider(output_name) || isDefaultOverride(output_name)) {
                 // Take note if/how often default gets used in case that information is needed later
                 recordUsingDefault(output_name);
+                updateForwarding();
                 return defaultValues.at(output_name);
             }
             // Otherwise (i.e., available from wrapped provider and no override), get from backing wrapped provider
@@ -323,9 +329,12 @@ namespace data_access {
 
             // Check this provides everything needed, accounting for defaults (and also tallying the outputs provided)
             unsigned short providedByProviderCount = 0;
-            for (const string &requiredName : providedOutputs) {
+            vector<char> supplied(providedOutputs.size(), 0);
+            for (size_t i = 0; i < providedOutputs.size(); ++i) {
+                const string &requiredName = providedOutputs[i];
                 // If supplied by the provider, increment our count and continue to the next required output name
                 if (isSuppliedByProvider(requiredName, provider)) {
+                    supplied[i] = 1;
                     ++providedByProviderCount;
                     continue;
                 }
@@ -344,6 +353,8 @@ namespace data_access {
 
             // If this is good, set things and return true
             wrapped_provider = provider;
+            suppliedByWrapped = move(supplied);
+            updateForwarding();
             setMessage.clear();
             return true;
         }
@@ -397,6 +408,14 @@ namespace data_access {
          * reduced to zero should instead be removed.
          */
         map<string, int> defaultUsageWaits;
+        /**
+         * Whether each of @ref providedOutputs is supplied by the wrapped provider, found when the provider is set.
+         */
+        vector<char> suppliedByWrapped;
+        /**
+         * Whether every output is now always proxied from the wrapped provider, so defaults no longer need checking.
+         */
+        bool forwarding = false;
 
         static bool isSuppliedByProvider(const string &outputName, GenericDataProvider *provider) {
             const vector<string> &available = provider->get_avaliable_variable_names();
@@ -404,7 +423,23 @@ namespace data_access {
         }
 
         inline bool isSuppliedByWrappedProvider(const string &outputName) {
-            return wrapped_provider != nullptr && isSuppliedByProvider(outputName, wrapped_provider);
+            if (wrapped_provider == nullptr) {
+                return false;
+            }
+            auto name_it = find(providedOutputs.begin(), providedOutputs.end(), outputName);
+            if (name_it == providedOutputs.end() || suppliedByWrapped.size() != providedOutputs.size()) {
+                return isSuppliedByProvider(outputName, wrapped_provider);
+            }
+            return suppliedByWrapped[name_it - providedOutputs.begin()] != 0;
+        }
+
+        /**
+         * Switch to forwarding once the wrapped provider supplies every output and no default usage waits remain.
+         */
+        void updateForwarding() {
+            forwarding = wrapped_provider != nullptr && defaultUsageWaits.empty()
+                         && suppliedByWrapped.size() == providedOutputs.size()
+                         && find(suppliedByWrapped.begin(), suppliedByWrapped.end(), 0) == suppliedByWrapped.end();
         }
 
     };
@@ -0,0 +1,385 @@
+#ifndef NGEN_PUSHED_FORCING_DATA_PROVIDER_HPP
+#define NGEN_PUSHED_FORCING_DATA_PROVIDER_HPP
+
+#include "GenericDataProvider.hpp"
+#include "DataProviderSelectors.hpp"
+#include "AorcForcing.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <UnitsHelper.hpp>
+#include <Logger.hpp>
+#include <StepArena.hpp>
+
+namespace data_access
+{
+    /**
+     * @brief Provides forcing pushed into memory a time step at a time, by the program running ngen, rather than read
+     * from files.
+     *
+     * A model ngen is coupled to, e.g. an atmospheric model or a forecast service, creates the provider with @ref create
+     * under a name, before the formulations are built, and the realization config selects it for their forcing with
+     * ``"provider": "Pushed"`` and that name as the ``path``.  The coupled model then calls @ref push with the values of
+     * each time step, an array of a row per catchment and a value per variable, as the simulation reaches it.
+     *
+     * The provider holds two time steps: formulations read the latest ones pushed while the next is written into the
+     * other, so a push never waits on the formulations still reading a step, and the values are never copied more
+     * than once.  A step can be pushed once the step two before it is no longer read, that is once a formulation has
+     * read the step before it, since ngen runs every catchment of a time step before any of the next.  Only one thread
+     * should push, and formulations should step at the time step of the forcing: one reading over two time steps at a
+     * time holds both, so the next cannot be pushed until it reads the second one on its own.
+     *
+     * @code {.cpp}
+     * auto forcing = data_access::PushedForcingDataProvider::create("atmosphere", {"cat-1", "cat-2"},
+     *                                                                {{"APCP_surface", "kg/m^2"}}, start_time, 3600);
+     * for (size_t t = 0; t < steps; ++t) {
+     *     std::vector<double> values = atmosphere.step();  // one value per catchment, per variable
+     *     forcing->push(t, values.data());
+     *     simulation.step(1);
+     * }
+     * @endcode
+     */
+    class PushedForcingDataProvider : public GenericDataProvider
+    {
+        public:
+
+        /** A forcing variable and its units. */
+        typedef std::pair<std::string, std::string> variable_t;
+
+        /**
+         * @brief Create a provider, and make it the one of its name.
+         *
+         * @param name The name the realization config gives as the ``path`` of its forcing.
+         * @param ids The ids of the catchments, in the order of the rows of the values pushed.
+         * @param variables The names and units of the variables, in the order of the values of each row.
+         * @param start_time The epoch time of the start of the first time step.
+         * @param time_step The length, in seconds, of each time step.
+         * @param wait_seconds How long a read may wait for its time step to be pushed, or a push for the formulations
+         *                     to be done with the step it replaces, before failing; ``0`` fails at once.
+         */
+        static std::shared_ptr<PushedForcingDataProvider> create(const std::string& name, std::vector<std::string> ids,
+                                                                 const std::vector<variable_t>& variables,
+                                                                 time_t start_time, long time_step,
+                                                                 double wait_seconds = 0)
+        {
+            auto p = std::make_shared<PushedForcingDataProvider>(std::move(ids), variables, start_time, time_step,
+                                                                 wait_seconds);
+            const std::lock_guard<std::mutex> lock(shared_providers_mutex);
+            shared_providers[name] = p;
+            return p;
+        }
+
+        /**
+         * @brief Get the provider of a name, for the forcing of a formulation.
+         *
+         * @throws std::runtime_error If no provider of the name was created.
+         */
+        static std::shared_ptr<PushedForcingDataProvider> get_shared_provider(const std::string& name)
+        {
+            const std::lock_guard<std::mutex> lock(shared_providers_mutex);
+            auto found = shared_providers.find(name);
+            if( found == shared_providers.end() ) {
+                throw std::runtime_error("No pushed forcing named '" + name + "' was created for the formulations to "
+                                         "read.");
+            }
+            return found->second;
+        }
+
+        /** Forget the provider of a name, which is freed once no formulation holds it. */
+        static void release(const std::string& name)
+        {
+            const std::lock_guard<std::mutex> lock(shared_providers_mutex);
+            shared_providers.erase(name);
+        }
+
+        /** @see create */
+        PushedForcingDataProvider(std::vector<std::string> ids, const std::vector<variable_t>& variables,
+                                  time_t start_time, long time_step, double wait_seconds = 0)
+            : ids(std::move(ids)), start_time(start_time), time_stride(time_step), wait_seconds(wait_seconds)
+        {
+            if( time_step <= 0 ) {
+                throw std::invalid_argument("The time step of pushed forcing must be positive.");
+            }
+            for( size_t i = 0; i < this->ids.size(); ++i ) {
+                id_index[this->ids[i]] = i;
+            }
+            for( size_t i = 0; i < variables.size(); ++i ) {
+                variable_names.push_back(variables[i].first);
+                var_index[variables[i].first] = i;
+                var_units.push_back(variables[i].second);
+
+                auto wkf = data_access::WellKnownFields.find(variables[i].first);
+                if(wkf != data_access::WellKnownFields.end()){
+                    std::string can_name = std::get<0>(wkf->second); // the CSDMS name
+                    variable_names.push_back(can_name);
+                    var_index[can_name] = i;
+                    if( var_units[i].empty() ) {
+                        var_units[i] = std::get<1>(wkf->second);
+                    }
+                }
+            }
+            const size_t record_size = this->ids.size() * variables.size();
+            for( auto& buffer : buffers ) {
+                buffer.assign(record_size, 0.0);
+            }
+        }
+
+        /**
+         * @brief Push the values of the next time step.
+         *
+         * @param time_index The index of the time step, which must be one past the last pushed, starting from ``0``.
+         * @param values The values of every variable of every catchment, ``values[c * variables + v]`` being that of
+         *               variable ``v`` of catchment ``c``, in the orders the provider was created with.
+         * @throws std::invalid_argument If @p time_index is not the next time step.
+         * @throws std::runtime_error If the formulations are still reading the step before the last pushed.
+         */
+        void push(size_t time_index, const double* values)
+        {
+            const long index = static_cast<long>(time_index);
+            {
+                std::unique_lock<std::mutex> lock(state_mutex);
+                if( index != pushed_through + 1 ) {
+                    throw std::invalid_argument("Pushed forcing is of time step " + std::to_string(pushed_through + 1)
+                                                + " next, not " + std::to_string(time_index) + ".");
+                }
+                // The buffer written was last of the step two before, which is done with once the one before is read
+                auto is_writable = [&]() { return index < 2 || read_through.load() >= index - 1; };
+                if( !wait(lock, is_writable) ) {
+                    throw std::runtime_error("Pushed forcing of time step " + std::to_string(time_index) + " would "
+                                             "replace that of step " + std::to_string(index - 2) + ", which is still "
+                                             "being read.");
+                }
+            }
+            std::vector<double>& buffer = buffers[time_index % 2];
+            std::copy(values, values + buffer.size(), buffer.begin());
+            {
+                const std::lock_guard<std::mutex> lock(state_mutex);
+                pushed_through = index;
+            }
+            state_changed.notify_all();
+        }
+
+        /** @return The number of time steps pushed so far. */
+        size_t get_pushed_count()
+        {
+            const std::lock_guard<std::mutex> lock(state_mutex);
+            return static_cast<size_t>(pushed_through + 1);
+        }
+
+        const std::vector<std::string>& get_avaliable_variable_names() override
+        {
+            return variable_names;
+        }
+
+        /** return the ids of the catchments, in the order of the rows of the values pushed */
+        const std::vector<std::string>& get_ids() const
+        {
+            return ids;
+        }
+
+        /** return the number of variables, and so of the values of each row pushed */
+        size_t get_variable_count() const
+        {
+            return var_units.size();
+        }
+
+        long get_data_start_time() override
+        {
+            return start_time;
+        }
+
+        /** More time steps may always be pushed, so there is no end to the data. */
+        long get_data_stop_time() override
+        {
+            return std::numeric_limits<long>::max();
+        }
+
+        long record_duration() override
+        {
+            return time_stride;
+        }
+
+        size_t get_ts_index_for_time(const time_t &epoch_time) override
+        {
+            if (start_time <= epoch_time)
+            {
+                return size_t((epoch_time - start_time) / time_stride);
+            }
+            std::stringstream ss;
+            ss << "The value " << (long)epoch_time << " is before the start " << (long)start_time << " of pushed forcing";
+            throw std::out_of_range(ss.str());
+        }
+
+        double get_value(const CatchmentAggrDataSelector& selector, ReSampleMethod m) override
+        {
+            size_t pos = get_id_index(selector.get_id());
+            double value;
+            get_values_for_positions(get_var_index(selector.get_variable_name()), &pos, 1, selector, m, &value);
+            return value;
+        }
+
+        /**
+         * Get the values of a forcing property for several catchments over the time period of a selector, converting
+         * units if needed.
+         *
+         * @param ids The ids of the catchments; the id of @p selector is ignored.
+         * @param selector The variable, time period and units of the values.
+         * @param m How data is to be resampled if there is a mismatch in data alignment or repeat rate
+         * @param values Storage for ``ids.size()`` values, written in the order of @p ids.
+         * @throws std::out_of_range If the time period is not of the time steps held, or any of the ids is unknown.
+         */
+        void get_values_for_ids(const std::vector<std::string>& ids, const CatchmentAggrDataSelector& selector, ReSampleMethod m, double* values) override
+        {
+            size_t var_idx = get_var_index(selector.get_variable_name());
+            utils::arena_vector<size_t> positions(ids.size());
+            std::transform(ids.begin(), ids.end(), positions.begin(), [this](const std::string& id){ return get_id_index(id); });
+            get_values_for_positions(var_idx, positions.data(), positions.size(), selector, m, values);
+        }
+
+        std::vector<double> get_values(const CatchmentAggrDataSelector& selector, data_access::ReSampleMethod m) override
+        {
+            return std::vector<double>(1, get_value(selector, m));
+        }
+
+        private:
+
+        static std::mutex shared_providers_mutex;
+        static std::map<std::string, std::shared_ptr<PushedForcingDataProvider>> shared_providers;
+
+        std::vector<std::string> ids;
+        std::unordered_map<std::string, size_t> id_index;
+        time_t start_time;                              // the begining of the first time step
+        long time_stride;                               // the length of each time step
+        double wait_seconds;
+        std::vector<std::string> variable_names;
+        std::unordered_map<std::string, size_t> var_index; // variable index of each variable name and CSDMS alias
+        std::vector<std::string> var_units;             // native units of each variable
+        std::vector<double> buffers[2];                 // the values of the even and odd time steps
+
+        std::mutex state_mutex;
+        std::condition_variable state_changed;
+        long pushed_through = -1;                       // the last time step pushed, guarded by state_mutex
+        std::atomic<long> read_through{-1};             // the latest first time step of a read
+
+        size_t get_var_index(const std::string& name) const
+        {
+            auto found = var_index.find(name);
+            if( found == var_index.end() ) {
+                throw std::runtime_error("Cannot get forcing value for unrecognized parameter name '" + name + "'.");
+            }
+            return found->second;
+        }
+
+        size_t get_id_index(const std::string& id) const
+        {
+            auto found = id_index.find(id);
+            if( found == id_index.end() ) {
+                throw std::out_of_range("No forcing is pushed for catchment '" + id + "'.");
+            }
+            return found->second;
+        }
+
+        /** Wait, for at most @ref wait_seconds, for @p ready to hold; @return Whether it does. */
+        template <class Predicate>
+        bool wait(std::unique_lock<std::mutex>& lock, Predicate ready)
+        {
+            if( ready() ) {
+                return true;
+            }
+            if( wait_seconds <= 0 ) {
+                return false;
+            }
+            return state_changed.wait_for(lock, std::chrono::duration<double>(wait_seconds), ready);
+        }
+
+        /**
+         * Note the reading of a time step, waiting for it to be pushed if it has not been yet.
+         *
+         * @throws std::out_of_range If the step is no longer held, or was not pushed in time.
+         */
+        void begin_read(long first, long last)
+        {
+            long pushed;
+            {
+                std::unique_lock<std::mutex> lock(state_mutex);
+                wait(lock, [&]() { return pushed_through >= last; });
+                pushed = pushed_through;
+            }
+            if( last > pushed || first < pushed - 1 ) {
+                std::stringstream ss;
+                ss << "Pushed forcing of time steps " << first << " to " << last << " is not held; the last time "
+                   << "step pushed is " << pushed << ", and the one before it is the only other held";
+                throw std::out_of_range(ss.str());
+            }
+            // Once a step is read, every step before it is done with, so its buffer may be pushed into
+            long read = read_through.load(std::memory_order_relaxed);
+            while( read < first ) {
+                if( read_through.compare_exchange_weak(read, first) ) {
+                    // A push may be waiting for the buffer
+                    std::lock_guard<std::mutex> lock(state_mutex);
+                    state_changed.notify_all();
+                    break;
+                }
+            }
+        }
+
+        /**
+         * Get the values of a variable for catchments at several positions over the time period of a selector,
+         * converting units if needed.
+         *
+         * Each time step is weighted by the part of it inside the period; for @ref MEAN, the weighted sum is scaled by
+         * the length of a time step over the length of the period.
+         */
+        void get_values_for_positions(size_t var_idx, const size_t* positions, size_t count, const CatchmentAggrDataSelector& selector, ReSampleMethod m, double* values)
+        {
+            const time_t init_time = selector.get_init_time();
+            const time_t end_time = init_time + selector.get_duration_secs();
+            const size_t idx1 = get_ts_index_for_time(init_time);
+            const size_t idx2 = end_time > init_time ? get_ts_index_for_time(end_time - 1) : idx1;
+            begin_read(static_cast<long>(idx1), static_cast<long>(idx2));
+
+            const size_t stride = var_units.size();
+            std::fill(values, values + count, 0.0);
+            for( size_t t = idx1; t <= idx2; ++t ) {
+                const time_t t_start = start_time + time_t(t) * time_stride;
+                double weight = 1.0;
+                if( end_time > init_time ) {
+                    weight = double(std::min(t_start + time_stride, end_time) - std::max(t_start, init_time)) / time_stride;
+                    if( m == MEAN ) {
+                        weight *= double(time_stride) / (end_time - init_time);
+                    }
+                }
+                const double* record = buffers[t % 2].data() + var_idx;
+                for( size_t i = 0; i < count; ++i ) {
+                    values[i] += weight * record[positions[i] * stride];
+                }
+            }
+
+            try
+            {
+                UnitsHelper::convert_values(var_units[var_idx], values, selector.get_output_units(), values, count);
+            }
+            catch (const std::runtime_error& e)
+            {
+                #ifndef UDUNITS_QUIET
+                NGEN_LOG_WARNING("Unit conversion unsuccessful - Returning unconverted value! (\"" << e.what() << "\")");
+                #endif
+            }
+        }
+    };
+}
+
+#endif // NGEN_PUSHED_FORCING_DATA_PROVIDER_HPP
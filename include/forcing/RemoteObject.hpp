@@ -0,0 +1,182 @@
+#ifndef NGEN_REMOTE_OBJECT_HPP
+#define NGEN_REMOTE_OBJECT_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace data_access
+{
+    /**
+     * @brief Whether a path names an object in object storage rather than a local file, by an ``http://``,
+     * ``https://`` or ``s3://`` scheme.
+     */
+    bool is_remote_path(const std::string& path);
+
+    /**
+     * @brief The HTTP URL of a remote path.
+     *
+     * ``s3://bucket/key`` is read from ``$AWS_ENDPOINT_URL/bucket/key`` if that variable is set, and otherwise from
+     * ``https://bucket.s3.amazonaws.com/key``; requests are not signed, so S3 objects must be public.
+     */
+    std::string remote_url(const std::string& path);
+
+    /**
+     * @brief The path by which the NetCDF library opens a file.
+     *
+     * A remote file is read by the library itself, by HTTP range requests (``#mode=bytes``), rather than through a
+     * @ref BlockCache, unless the path already names a mode, as for Zarr (e.g. ``s3://bucket/forcing.zarr#mode=zarr,s3``).
+     */
+    std::string netcdf_path(const std::string& path);
+
+    /**
+     * @brief A cache of fixed size blocks of remote objects, in a directory on disk, bounded by least recent use.
+     *
+     * Blocks are files, written whole under a temporary name and then renamed, so any number of processes can share
+     * one directory: all the ranks of a node read through the same cache, and only the first to want a block fetches
+     * it.  Reading a block updates its modification time, and whenever the blocks written by a process add up to a
+     * part of the capacity, it removes the least recently read until the directory is within the capacity.
+     */
+    class BlockCache
+    {
+        public:
+
+        static constexpr std::uint64_t DEFAULT_CAPACITY_MB = 4096;
+
+        /**
+         * @param directory The directory of the blocks; it is created if needed.
+         * @param capacity_bytes The total size of the blocks to keep, ``0`` for no limit.
+         * @throws std::runtime_error If the directory cannot be created.
+         */
+        BlockCache(std::string directory, std::uint64_t capacity_bytes);
+
+        /**
+         * @brief The cache of every remote object of the process.
+         *
+         * Its directory is ``$NGEN_BLOCK_CACHE_DIR``, by default ``ngen-block-cache`` in ``$TMPDIR`` or ``/tmp``, and
+         * its capacity ``$NGEN_BLOCK_CACHE_MB`` (or @ref DEFAULT_CAPACITY_MB) megabytes.
+         */
+        static std::shared_ptr<BlockCache> get_default();
+
+        /**
+         * @brief Get a block, if it is in the cache.
+         *
+         * @return Whether the block was found.
+         */
+        bool get(const std::string& key, std::string& block) const;
+
+        /**
+         * @brief Add a block, making room for it if the cache is full.
+         *
+         * Failing to write a block is not an error: the block is simply not kept.
+         */
+        void put(const std::string& key, const std::string& block);
+
+        const std::string& get_directory() const { return directory; }
+
+        private:
+
+        std::string directory;
+        std::uint64_t capacity;
+        std::atomic<std::uint64_t> written{0};      // bytes written since the last eviction
+        std::mutex eviction_mutex;
+
+        std::string block_path(const std::string& key) const;
+
+        void evict();
+    };
+
+    /**
+     * @brief Random access to an object in object storage, by HTTP range requests through a @ref BlockCache.
+     *
+     * Reads are split into blocks of the cache; the blocks not yet cached are fetched concurrently, so a read of
+     * many blocks takes about as long as the slowest of them rather than their sum.  Blocks are named after the URL
+     * and the size and entity tag of the object, so a changed object is never read from blocks of its old content.
+     *
+     * @code {.cpp}
+     * data_access::RemoteObject object("s3://bucket/forcing.ngenf");
+     * std::vector<char> header(64);
+     * object.read(0, header.size(), header.data());
+     * @endcode
+     */
+    class RemoteObject
+    {
+        public:
+
+        static constexpr std::size_t DEFAULT_BLOCK_SIZE = 8 << 20;
+        static constexpr std::size_t DEFAULT_CONCURRENCY = 8;
+
+        /** What is known of an object before reading it. */
+        struct Info
+        {
+            std::uint64_t size = 0;
+            std::string etag;                   // changes with the content of the object, if known
+        };
+
+        /** How objects are fetched, so tests and other stores can stand in for HTTP. */
+        struct Fetcher
+        {
+            std::function<Info(const std::string& url)> stat;
+            std::function<std::string(const std::string& url, std::uint64_t offset, std::uint64_t length)> range;
+        };
+
+        /**
+         * @brief Fetching by HTTP, with libcurl.
+         *
+         * @throws std::runtime_error When used in a build without libcurl (without ``NGEN_CURL_ACTIVE``).
+         */
+        static Fetcher http_fetcher();
+
+        /**
+         * @param path The remote path of the object (see @ref remote_url).
+         * @param fetcher How to fetch the object.
+         * @param cache The cache of its blocks, or ``nullptr`` to fetch every read.
+         * @param block_size The size of the blocks fetched and cached.
+         * @param concurrency The most blocks fetched at once.
+         * @throws std::runtime_error If the object cannot be found.
+         */
+        explicit RemoteObject(const std::string& path, Fetcher fetcher = http_fetcher(),
+                              std::shared_ptr<BlockCache> cache = BlockCache::get_default(),
+                              std::size_t block_size = DEFAULT_BLOCK_SIZE, std::size_t concurrency = DEFAULT_CONCURRENCY);
+
+        ~RemoteObject();
+
+        RemoteObject(const RemoteObject&) = delete;
+        RemoteObject& operator=(const RemoteObject&) = delete;
+
+        std::uint64_t size() const { return info.size; }
+
+        const std::string& get_url() const { return url; }
+
+        /**
+         * @brief Read a range of the object.  Safe to call from several threads at once.
+         *
+         * @throws std::out_of_range If the range runs past the end of the object.
+         * @throws std::runtime_error If a block cannot be fetched.
+         */
+        void read(std::uint64_t offset, std::size_t length, char* out) const;
+
+        /** The whole object. */
+        std::string read_all() const;
+
+        private:
+
+        class Pool;
+
+        std::string url;
+        Fetcher fetcher;
+        std::shared_ptr<BlockCache> cache;
+        std::size_t block_size;
+        std::unique_ptr<Pool> pool;
+        Info info;
+        std::string key_prefix;
+
+        std::string block(std::uint64_t index) const;
+    };
+}
+
+#endif // NGEN_REMOTE_OBJECT_HPP
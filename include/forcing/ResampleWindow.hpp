@@ -0,0 +1,62 @@
+#ifndef NGEN_RESAMPLE_WINDOW_HPP
+#define NGEN_RESAMPLE_WINDOW_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <ctime>
+
+namespace data_access
+{
+    /**
+     * @brief The time steps of regularly spaced forcing data that overlap a time period, and how much of each is in it.
+     *
+     * Forcing providers resample their native time steps to the period of a request from this, whatever the length of
+     * their steps, without allocating.  A step's overlap is the fraction of the step within the period, so it is 1 for
+     * every step but (possibly) the first and last.
+     */
+    struct ResampleWindow
+    {
+        double data_start = 0.0;                        // the beginning of the first time step of the data
+        double time_step = 0.0;                         // the length of each time step, in seconds
+        double period_start = 0.0;
+        double period_end = 0.0;
+        std::size_t first_index = 0;                    // the first time step overlapping the period
+        std::size_t last_index = 0;                     // the last one, or the last of the data for a period past it
+
+        /**
+         * @brief Set the window to the time steps overlapping a period.
+         *
+         * @param data_start The beginning of the first time step of the data, as a seconds-based epoch time.
+         * @param time_step The length of each time step, in seconds.
+         * @param num_steps The number of time steps of the data.
+         * @param init_time The beginning of the period, as a seconds-based epoch time.
+         * @param duration_s The length of the period, in seconds.
+         * @return Whether the period begins in a time step; the window is left unchanged if not.
+         */
+        bool set(double data_start, double time_step, std::size_t num_steps, time_t init_time, long duration_s)
+        {
+            if( num_steps == 0 || init_time < data_start || init_time >= data_start + num_steps * time_step ) {
+                return false;
+            }
+            this->data_start = data_start;
+            this->time_step = time_step;
+            period_start = init_time;
+            period_end = init_time + duration_s;
+            first_index = std::size_t((init_time - data_start) / time_step);
+            // Don't include next timestep when duration % timestep = 0
+            const double last_time = period_end - 1;
+            last_index = last_time < data_start ? first_index : std::size_t((last_time - data_start) / time_step);
+            last_index = std::max(first_index, std::min(last_index, num_steps - 1));
+            return true;
+        }
+
+        /** @return The fraction of time step @p index within the period. */
+        double overlap(std::size_t index) const
+        {
+            const double step_start = data_start + index * time_step;
+            return (std::min(step_start + time_step, period_end) - std::max(step_start, period_start)) / time_step;
+        }
+    };
+}
+
+#endif // NGEN_RESAMPLE_WINDOW_HPP
@@ -0,0 +1,42 @@
+#ifndef NGEN_SIMULATION_PERIOD_HPP
+#define NGEN_SIMULATION_PERIOD_HPP
+
+#include <ctime>
+
+namespace data_access
+{
+    /**
+     * @brief The period of the simulation, which forcing providers report as the period of their data.
+     *
+     * ``get_data_start_time`` and ``get_data_stop_time`` are described as the period a provider has data for, but
+     * BMI formulations take the start as the epoch of their model time (see
+     * ``Bmi_Module_Formulation::determine_model_time_offset``), and the nested modules of a multi-BMI formulation as
+     * the time of their first step.  The CSV provider only loads the rows of the simulation period, so for it the two
+     * are the same.  Providers reading files that may hold data from before the simulation start report this period
+     * too, rather than that of their data, so their models' times line up with those forced from CSV files.
+     *
+     * FIXME: The data period and the model time epoch should be separate queries, so providers can report the former.
+     */
+    struct SimulationPeriod
+    {
+        /**
+         * @param start The epoch time of the start of the simulation.
+         * @param end The epoch time of the end of the simulation.
+         */
+        SimulationPeriod(time_t start, time_t end) : start(start), end(end) {}
+
+        /** @return The start of the simulation, as ``get_data_start_time`` is to give it. */
+        long get_data_start_time() const { return start; }
+
+        /** @return The end of the simulation, as ``get_data_stop_time`` is to give it. */
+        long get_data_stop_time() const { return end; }
+
+        /** Extend the simulation to @p end_time, as for ``extend_to``. */
+        void extend_to(time_t end_time) { end = end_time; }
+
+        time_t start;
+        time_t end;
+    };
+}
+
+#endif //NGEN_SIMULATION_PERIOD_HPP
@@ -0,0 +1,183 @@
+#ifndef NGEN_SLAB_CACHE_HPP
+#define NGEN_SLAB_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace data_access
+{
+    /**
+     * @brief A least recently used cache of slabs of forcing values, keyed by variable index and time block index.
+     *
+     * The cache holds a fixed number of slabs, each a buffer of values read from a file for all locations over a block
+     * of consecutive time steps.  Lookups compare integer keys without allocating, and evicted slabs hand their
+     * buffers to the slabs replacing them, so a warm cache reads into memory it already owns.
+     *
+     * The cache is not synchronized; callers sharing it between threads must lock around every call, and around their
+     * use of the slabs it returns.
+     */
+    class SlabCache
+    {
+        public:
+
+        /**
+         * @param capacity The maximum number of slabs held at once; at least one slab is always held.
+         */
+        explicit SlabCache(std::size_t capacity) : entries(capacity > 0 ? capacity : 1) {}
+
+        /**
+         * @brief Get the slab of a variable's time block, loading it if it is not in the cache.
+         *
+         * On a miss the least recently used slab is evicted, its buffer resized to @p size values and passed to
+         * @p load, which must fill it.  If @p load throws, the slab is left out of the cache.
+         *
+         * The returned reference is valid until the next call to @ref get.
+         *
+         * @param var The index of the variable.
+         * @param block The index of the time block.
+         * @param size The number of values in the slab.
+         * @param load Callable taking a ``double*`` to @p size values, used to fill the slab on a miss.
+         * @return The values of the slab.
+         */
+        template<class Load>
+        const std::vector<double>& get(std::size_t var, std::size_t block, std::size_t size, Load&& load)
+        {
+            ++clock;
+            Entry* victim = &entries[0];
+            for ( auto& entry : entries )
+            {
+                if ( entry.valid && entry.var == var && entry.block == block )
+                {
+                    entry.last_use = clock;
+                    ++hit_count;
+                    return entry.values;
+                }
+                if ( !entry.valid || (victim->valid && entry.last_use < victim->last_use) )
+                {
+                    victim = &entry;
+                }
+            }
+
+            ++miss_count;
+            victim->valid = false;
+            victim->values.resize(size);
+            load(victim->values.data());
+            victim->var = var;
+            victim->block = block;
+            victim->last_use = clock;
+            victim->valid = true;
+            return victim->values;
+        }
+
+        /**
+         * @brief Get the slab of a variable's time block if it is in the cache, without loading it.
+         *
+         * The returned pointer is valid until the next call to @ref get or @ref put.
+         *
+         * @return The values of the slab, or ``nullptr`` if it is not cached.
+         */
+        const std::vector<double>* find(std::size_t var, std::size_t block)
+        {
+            for ( auto& entry : entries )
+            {
+                if ( entry.valid && entry.var == var && entry.block == block )
+                {
+                    entry.last_use = ++clock;
+                    ++hit_count;
+                    return &entry.values;
+                }
+            }
+            return nullptr;
+        }
+
+        /**
+         * @brief Whether the slab of a variable's time block is in the cache, without counting as a use of it.
+         */
+        bool contains(std::size_t var, std::size_t block) const
+        {
+            for ( const auto& entry : entries )
+            {
+                if ( entry.valid && entry.var == var && entry.block == block ) return true;
+            }
+            return false;
+        }
+
+        /**
+         * @brief Store an already loaded slab, e.g. one read ahead of its use by a background thread.
+         *
+         * The slab replaces any cached slab with the same key, or else the least recently used slab.  The values are
+         * swapped into the cache, and @p values is left holding the replaced slab's buffer, so a caller reading
+         * slabs in a loop can reuse it.
+         */
+        void put(std::size_t var, std::size_t block, std::vector<double>& values)
+        {
+            ++clock;
+            Entry* victim = &entries[0];
+            for ( auto& entry : entries )
+            {
+                if ( entry.valid && entry.var == var && entry.block == block )
+                {
+                    victim = &entry;
+                    break;
+                }
+                if ( !entry.valid || (victim->valid && entry.last_use < victim->last_use) )
+                {
+                    victim = &entry;
+                }
+            }
+            victim->values.swap(values);
+            victim->var = var;
+            victim->block = block;
+            victim->last_use = clock;
+            victim->valid = true;
+        }
+
+        /** Drop every slab, keeping the buffers for reuse. */
+        void clear()
+        {
+            for ( auto& entry : entries )
+            {
+                entry.valid = false;
+            }
+        }
+
+        /** The maximum number of slabs held at once. */
+        std::size_t capacity() const { return entries.size(); }
+
+        /** The number of @ref get and @ref find calls answered from the cache. */
+        std::size_t hits() const { return hit_count; }
+
+        /** The number of @ref get calls that had to load their slab. */
+        std::size_t misses() const { return miss_count; }
+
+        /** The bytes of the slabs' buffers, including those of evicted slabs, kept for reuse. */
+        std::size_t get_memory_bytes() const
+        {
+            std::size_t bytes = entries.capacity() * sizeof(Entry);
+            for ( const auto& entry : entries )
+            {
+                bytes += entry.values.capacity() * sizeof(double);
+            }
+            return bytes;
+        }
+
+        private:
+
+        struct Entry
+        {
+            std::size_t var = 0;
+            std::size_t block = 0;
+            std::uint64_t last_use = 0;
+            bool valid = false;
+            std::vector<double> values;
+        };
+
+        std::vector<Entry> entries;
+        std::uint64_t clock = 0;
+        std::size_t hit_count = 0;
+        std::size_t miss_count = 0;
+    };
+}
+
+#endif // NGEN_SLAB_CACHE_HPP
@@ -112,6 +112,11 @@ namespace data_access {
             return wrapped_provider->get_values(selector, m);
         }
 
+        size_t get_values_into(const CatchmentAggrDataSelector& selector, ReSampleMethod m, ValueType type, void* values, size_t count) override
+        {
+            return wrapped_provider->get_values_into(selector, m, type, values, count);
+        }
+
         /**
          * Get whether a property's per-time-step values are each an aggregate sum over the entire time step.
          *
@@ -0,0 +1,253 @@
+#ifndef GEOJSON_COMPACTPROPERTYMAP_H
+#define GEOJSON_COMPACTPROPERTYMAP_H
+
+#include "JSONProperty.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace geojson {
+    /**
+     * @brief Intern a property key, so that every feature with a property of the same name shares one copy of it
+     *
+     * Interned keys live for the rest of the process, so they may be compared and held by their addresses.
+     *
+     * @param key The name of a property
+     * @return The one shared copy of the name
+     */
+    inline const std::string* intern_property_key(const std::string& key) {
+        static std::unordered_set<std::string> keys;
+        static std::mutex keys_mutex;
+        std::lock_guard<std::mutex> lock(keys_mutex);
+        return &*keys.insert(key).first;
+    }
+
+    /**
+     * @brief A read only mapping of properties, stored flat to keep the many features of a hydrofabric small
+     *
+     * A \ref PropertyMap holds a heap node, a copy of the key and a full \ref JSONProperty for every property. This
+     * instead holds a vector entry of an interned key and the scalar value for each property, sorted by key, with the
+     * characters of every string value packed into one buffer. Only lists and nested objects are kept as whole
+     * properties. Properties are rebuilt as \ref JSONProperty objects as they are asked for, so they are the same as the
+     * ones the mapping was built from.
+     */
+    class CompactPropertyMap {
+        public:
+            CompactPropertyMap() = default;
+
+            /**
+             * @param properties The properties to store
+             */
+            explicit CompactPropertyMap(const PropertyMap& properties) {
+                entries.reserve(properties.size());
+                std::size_t text_size = 0;
+                for (const auto& pair : properties) {
+                    if (pair.second.get_type() == PropertyType::String) {
+                        text_size += pair.second.as_string().size();
+                    }
+                }
+                text.reserve(text_size);
+
+                for (const auto& pair : properties) {
+                    const JSONProperty& property = pair.second;
+                    Entry entry;
+                    entry.key = intern_property_key(pair.first);
+                    entry.type = property.get_type();
+
+                    if (property.get_key() != pair.first) {
+                        // Only a whole property can keep a key of its own
+                        entry.nested.reset(new JSONProperty(property));
+                    }
+                    else {
+                        switch (entry.type) {
+                            case PropertyType::Natural:
+                                entry.natural = property.as_natural_number();
+                                break;
+                            case PropertyType::Real:
+                                entry.real = property.as_real_number();
+                                break;
+                            case PropertyType::Boolean:
+                                entry.boolean = property.as_boolean();
+                                break;
+                            case PropertyType::String: {
+                                std::string value = property.as_string();
+                                entry.span.offset = static_cast<std::uint32_t>(text.size());
+                                entry.span.length = static_cast<std::uint32_t>(value.size());
+                                text.append(value);
+                                break;
+                            }
+                            default:
+                                entry.nested.reset(new JSONProperty(property));
+                        }
+                    }
+                    entries.push_back(std::move(entry));
+                }
+
+                // A PropertyMap is already ordered by key, but keep the order explicit for the binary searches
+                std::sort(entries.begin(), entries.end(), [](const Entry& first, const Entry& second) {
+                    return *first.key < *second.key;
+                });
+            }
+
+            CompactPropertyMap(const CompactPropertyMap& other) : entries(other.entries.size()), text(other.text) {
+                for (std::size_t i = 0; i < other.entries.size(); ++i) {
+                    entries[i].copy(other.entries[i]);
+                }
+            }
+
+            CompactPropertyMap(CompactPropertyMap&&) = default;
+
+            CompactPropertyMap& operator=(CompactPropertyMap other) {
+                entries.swap(other.entries);
+                text.swap(other.text);
+                return *this;
+            }
+
+            /**
+             * @param key The name of a property
+             * @return Whether there is a property by that name
+             */
+            bool contains(const std::string& key) const {
+                return find(key) != entries.end();
+            }
+
+            /**
+             * @param key The name of a property
+             * @return The property by that name
+             * @throws std::out_of_range If there is no property by that name
+             */
+            JSONProperty at(const std::string& key) const {
+                auto entry = find(key);
+                if (entry == entries.end()) {
+                    throw std::out_of_range("There is no property named '" + key + "'");
+                }
+                return to_property(*entry);
+            }
+
+            /**
+             * @return The names of every property, in order
+             */
+            std::vector<std::string> keys() const {
+                std::vector<std::string> names;
+                names.reserve(entries.size());
+                for (const auto& entry : entries) {
+                    names.push_back(*entry.key);
+                }
+                return names;
+            }
+
+            /**
+             * @return Every property, as a \ref PropertyMap
+             */
+            PropertyMap to_map() const {
+                PropertyMap properties;
+                for (const auto& entry : entries) {
+                    properties.emplace_hint(properties.end(), *entry.key, to_property(entry));
+                }
+                return properties;
+            }
+
+            std::size_t size() const {
+                return entries.size();
+            }
+
+            bool empty() const {
+                return entries.empty();
+            }
+
+            /**
+             * An estimate of the bytes this map allocates for its entries and their text, counting only the
+             * JSONProperty object of each nested property and not what it allocates itself.
+             */
+            std::size_t get_memory_bytes() const {
+                std::size_t bytes = entries.capacity() * sizeof(Entry);
+                if (text.capacity() > std::string().capacity()) {
+                    bytes += text.capacity() + 1;
+                }
+                for (const Entry& entry : entries) {
+                    if (entry.nested) {
+                        bytes += sizeof(JSONProperty);
+                    }
+                }
+                return bytes;
+            }
+
+        private:
+            struct Entry {
+                const std::string* key = nullptr;
+                /** The whole property, for lists, objects and properties keyed differently than their entry */
+                std::unique_ptr<JSONProperty> nested;
+                /** Where a string value's characters are in the shared text */
+                struct Span {
+                    std::uint32_t offset;
+                    std::uint32_t length;
+                };
+                union {
+                    long natural;
+                    double real;
+                    bool boolean;
+                    Span span;
+                };
+                PropertyType type = PropertyType::Natural;
+
+                Entry() : natural(0) {}
+
+                Entry(Entry&&) = default;
+
+                Entry& operator=(Entry&&) = default;
+
+                void copy(const Entry& other) {
+                    key = other.key;
+                    type = other.type;
+                    // Copy whichever scalar is held, without reading an inactive member of the union
+                    switch (type) {
+                        case PropertyType::Natural: natural = other.natural; break;
+                        case PropertyType::Real: real = other.real; break;
+                        case PropertyType::Boolean: boolean = other.boolean; break;
+                        default: span = other.span;
+                    }
+                    if (other.nested) {
+                        nested.reset(new JSONProperty(*other.nested));
+                    }
+                }
+            };
+
+            std::vector<Entry>::const_iterator find(const std::string& key) const {
+                auto entry = std::lower_bound(entries.begin(), entries.end(), key, [](const Entry& candidate, const std::string& name) {
+                    return *candidate.key < name;
+                });
+                if (entry != entries.end() && *entry->key == key) {
+                    return entry;
+                }
+                return entries.end();
+            }
+
+            JSONProperty to_property(const Entry& entry) const {
+                if (entry.nested) {
+                    return *entry.nested;
+                }
+                switch (entry.type) {
+                    case PropertyType::Natural:
+                        return JSONProperty(*entry.key, entry.natural);
+                    case PropertyType::Real:
+                        return JSONProperty(*entry.key, entry.real);
+                    case PropertyType::Boolean:
+                        return JSONProperty(*entry.key, entry.boolean);
+                    default:
+                        // Not the std::string constructor, which would re-infer the type from the text
+                        return JSONProperty(*entry.key, text.substr(entry.span.offset, entry.span.length).c_str());
+                }
+            }
+
+            std::vector<Entry> entries;
+            /** The characters of every string value, one after another */
+            std::string text;
+    };
+}
+
+#endif // GEOJSON_COMPACTPROPERTYMAP_H
@@ -4,13 +4,20 @@
 #include <features/Features.hpp>
 #include <FeatureCollection.hpp>
 #include <JSONGeometry.hpp>
+#include <JSONStreamScanner.hpp>
+#include <ThreadPool.hpp>
 
+#include <fstream>
 #include <iostream>
 #include <memory>
 #include <ostream>
 #include <exception>
 #include <string>
 #include <algorithm>
+#include <sstream>
+#include <iterator>
+#include <unordered_set>
+#include <vector>
 
 #include <boost/property_tree/ptree.hpp>
 
@@ -224,74 +231,121 @@ namespace geojson {
         throw std::invalid_argument("tree");
     }
 
-    static Feature build_feature(boost::property_tree::ptree &tree) {
-        bool has_geometry_collection = false;
-        bool has_geometry = false;
+    /**
+     * @brief Settings that let a reader drop the parts of features a caller does not need.
+     *
+     * The defaults keep everything, as read always has.
+     */
+    struct FeatureLoadOptions {
+        /**
+         * Whether to keep feature geometries.  Without them, each feature holds an empty geometry of its type, and
+         * a feature without a bounding box is given the bounds of the geometry it was read with.
+         */
+        bool include_geometry = true;
+
+        /**
+         * The names of the properties to keep; all properties are kept when empty.  The ``id`` property is always
+         * kept, since features without a top level id take theirs from it.
+         */
+        std::vector<std::string> properties;
+
+        /**
+         * The number of threads to build features on while a collection is read; ``0`` selects the number of CPUs the
+         * process may run on.  Features are built in the order of the document either way.
+         */
+        std::size_t threads = 1;
+    };
 
-        geometry geometry_object;
-        std::vector<geometry> geometry_collection;
-        FeatureType type = FeatureType::None;
-        std::string id = "";
-        std::vector<double> bounding_box;
-        PropertyMap properties;
-        PropertyMap foreign_members;
+    /**
+     * @brief An empty geometry of the alternative a feature of the given type holds
+     */
+    static geometry empty_geometry(FeatureType type) {
+        switch (type) {
+            case FeatureType::LineString: return linestring_t();
+            case FeatureType::Polygon: return polygon_t();
+            case FeatureType::MultiPoint: return multipoint_t();
+            case FeatureType::MultiLineString: return multilinestring_t();
+            case FeatureType::MultiPolygon: return multipolygon_t();
+            default: return coordinate_t(0.0, 0.0);
+        }
+    }
 
-        for (auto& child : tree) {
-            if (child.first == "geometry") {
-                const std::string& geometry_type = child.second.get<std::string>("type");
-                geometry_object = build_geometry(child.second);
-                has_geometry = true;
+    /**
+     * Visitor widening a GeoJSON style bounding box, {min x, min y, max x, max y}, to the points of a geometry
+     */
+    class BoundsVisitor : public boost::static_visitor<void> {
+        public:
+            explicit BoundsVisitor(std::vector<double>& bounds) : bounds(bounds) {}
+
+            template <typename Geometry>
+            void operator()(const Geometry& geom) const {
+                boost::geometry::for_each_point(geom, [this](const coordinate_t& point) {
+                    double x = point.get<0>();
+                    double y = point.get<1>();
+                    if (bounds.empty()) {
+                        bounds = {x, y, x, y};
+                        return;
+                    }
+                    bounds[0] = std::min(bounds[0], x);
+                    bounds[1] = std::min(bounds[1], y);
+                    bounds[2] = std::max(bounds[2], x);
+                    bounds[3] = std::max(bounds[3], y);
+                });
+            }
 
-                if (geometry_type == "Point") {
-                    type = FeatureType::Point;
-                }
-                else if (geometry_type == "LineString") {
-                    type = FeatureType::LineString;
-                }
-                else if (geometry_type == "Polygon") {
-                    type = FeatureType::Polygon;
-                }
-                else if (geometry_type == "MultiPoint") {
-                    type = FeatureType::MultiPoint;
-                }
-                else if (geometry_type == "MultiLineString") {
-                    type = FeatureType::MultiLineString;
+        private:
+            std::vector<double>& bounds;
+    };
+
+    /**
+     * @brief Strip the parts of a feature not wanted by @p options before the feature is built from them
+     */
+    static void apply_load_options(const FeatureLoadOptions& options, FeatureType type, geometry& geometry_object,
+                                   std::vector<geometry>& geometry_collection, PropertyMap& properties,
+                                   std::vector<double>& bounding_box) {
+        if (!options.include_geometry) {
+            if (bounding_box.empty()) {
+                BoundsVisitor visitor(bounding_box);
+                if (type == FeatureType::GeometryCollection || type == FeatureType::None) {
+                    for (const auto& geom : geometry_collection) {
+                        boost::apply_visitor(visitor, geom);
+                    }
                 }
-                else if (geometry_type == "MultiPolygon") {
-                    type = FeatureType::MultiPolygon;
+                else {
+                    boost::apply_visitor(visitor, geometry_object);
                 }
             }
-            else if (child.first == "geometries") {
-                // Since the feature can have a number of different types of geometries and the
-                // type of the feature comes from the geometry, we simply set this as a collection
-                type = FeatureType::GeometryCollection;
-                has_geometry_collection = true;
+            geometry_object = empty_geometry(type);
+            geometry_collection.clear();
+        }
 
-                // Loop through the underlying collection of geometric json definitions and use
-                // those to create geometric objects
-                for (auto &geom : child.second) {
-                    geometry_collection.push_back(build_geometry(geom.second));
-                }
-            }
-            else if (child.first == "id") {
-                id = std::move(child.second.data());
-            }
-            else if (child.first == "bbox") {
-                for (auto &value : tree.get_child("bbox")) {
-                    bounding_box.push_back(std::stod(value.second.data()));
+        if (!options.properties.empty()) {
+            for (auto it = properties.begin(); it != properties.end(); ) {
+                if (it->first != "id"
+                    && std::find(options.properties.begin(), options.properties.end(), it->first) == options.properties.end()) {
+                    it = properties.erase(it);
                 }
-            }
-            else if (child.first == "properties") {
-                for (auto& property : child.second) {
-                    properties.emplace(property.first, std::move(JSONProperty(property.first, property.second)));
+                else {
+                    ++it;
                 }
             }
-            else {
-                foreign_members.emplace(child.first, std::move(JSONProperty(child.first, child.second)));
-            }
         }
+    }
 
-        
+    /**
+     * @brief Create a feature of the given type from its already built parts
+     *
+     * @param type The type of feature; FeatureType::GeometryCollection and FeatureType::None create a CollectionFeature
+     * @param geometry_object The geometry of the feature, whose alternative must match @p type (unused for collections)
+     * @param geometry_collection The geometries of a collection feature
+     * @param id
+     * @param properties
+     * @param bounding_box
+     * @param foreign_members
+     */
+    static Feature build_feature(FeatureType type, geometry geometry_object, std::vector<geometry> geometry_collection,
+                                 std::string id, PropertyMap properties, std::vector<double> bounding_box,
+                                 PropertyMap foreign_members) {
         switch (type) {
             case FeatureType::Point:
                 return std::make_shared<PointFeature>(PointFeature(
@@ -366,12 +420,109 @@ namespace geojson {
         }
     }
 
+    /**
+     * @brief Create a feature from the property tree of a GeoJSON Feature
+     *
+     * @param tree The parsed feature
+     * @param options Which parts of the feature to keep
+     */
+    static Feature build_feature(boost::property_tree::ptree &tree, const FeatureLoadOptions &options = FeatureLoadOptions()) {
+        bool has_geometry_collection = false;
+        bool has_geometry = false;
+
+        geometry geometry_object;
+        std::vector<geometry> geometry_collection;
+        FeatureType type = FeatureType::None;
+        std::string id = "";
+        std::vector<double> bounding_box;
+        PropertyMap properties;
+        PropertyMap foreign_members;
+
+        for (auto& child : tree) {
+            if (child.first == "geometry") {
+                const std::string& geometry_type = child.second.get<std::string>("type");
+                geometry_object = build_geometry(child.second);
+                has_geometry = true;
+
+                if (geometry_type == "Point") {
+                    type = FeatureType::Point;
+                }
+                else if (geometry_type == "LineString") {
+                    type = FeatureType::LineString;
+                }
+                else if (geometry_type == "Polygon") {
+                    type = FeatureType::Polygon;
+                }
+                else if (geometry_type == "MultiPoint") {
+                    type = FeatureType::MultiPoint;
+                }
+                else if (geometry_type == "MultiLineString") {
+                    type = FeatureType::MultiLineString;
+                }
+                else if (geometry_type == "MultiPolygon") {
+                    type = FeatureType::MultiPolygon;
+                }
+            }
+            else if (child.first == "geometries") {
+                // Since the feature can have a number of different types of geometries and the
+                // type of the feature comes from the geometry, we simply set this as a collection
+                type = FeatureType::GeometryCollection;
+                has_geometry_collection = true;
+
+                // Loop through the underlying collection of geometric json definitions and use
+                // those to create geometric objects
+                for (auto &geom : child.second) {
+                    geometry_collection.push_back(build_geometry(geom.second));
+                }
+            }
+            else if (child.first == "id") {
+                id = std::move(child.second.data());
+            }
+            else if (child.first == "bbox") {
+                for (auto &value : tree.get_child("bbox")) {
+                    bounding_box.push_back(std::stod(value.second.data()));
+                }
+            }
+            else if (child.first == "properties") {
+                for (auto& property : child.second) {
+                    properties.emplace(property.first, std::move(JSONProperty(property.first, property.second)));
+                }
+            }
+            else {
+                foreign_members.emplace(child.first, std::move(JSONProperty(child.first, child.second)));
+            }
+        }
+
+        apply_load_options(options, type, geometry_object, geometry_collection, properties, bounding_box);
+        return build_feature(type, std::move(geometry_object), std::move(geometry_collection), std::move(id),
+                             std::move(properties), std::move(bounding_box), std::move(foreign_members));
+    }
+
+    /**
+     * @brief Find the identity of a feature from its property tree, without building the feature.
+     *
+     * As when features are built, this is the feature's ``id``, or else the ``id`` of its properties.
+     *
+     * @param tree The property tree of the feature
+     * @param id Receives the identity, or an empty string if the feature has none
+     */
+    static void find_tree_feature_id(const boost::property_tree::ptree &tree, std::string &id) {
+        auto own_id = tree.get_child_optional("id");
+        if (own_id && own_id->data() != "") {
+            id = own_id->data();
+            return;
+        }
+        auto property_id = tree.get_child_optional("properties.id");
+        id = property_id ? property_id->data() : "";
+    }
+
     /**
      * @brief helper function to build a GeoJSON FeatureCollection from a property tree
      * @param tree boost::property_tree::ptree holding the parsed GeoJSON
      * @param ids optional subset of string feature ids, only features in tree with these ids will be in the collection
      */
     static GeoJSON build_collection(const boost::property_tree::ptree& tree, const std::vector<std::string>& ids={}) {
+        const std::unordered_set<std::string> subset(ids.begin(), ids.end());
         std::vector<double> bbox_values;
         std::vector<Feature> features;
         PropertyMap foreign_members;
@@ -392,8 +543,17 @@ namespace geojson {
                 boost::optional<const boost::property_tree::ptree&> e = tree.get_child_optional("features");
 
                 if (e) {
-                    for(auto feature_tree : *e) {
-                        Feature feature = build_feature(feature_tree.second);
+                    for(const auto& feature_tree : *e) {
+                        if( !subset.empty() ) {
+                          //find the identity the same way as below, but without building the feature
+                          find_tree_feature_id(feature_tree.second, tmp_id);
+                          if( subset.find(tmp_id) == subset.end() ) {
+                            continue;
+                          }
+                        }
+                        //building moves values out of the tree it is given, so build from a copy of just the kept ones
+                        boost::property_tree::ptree kept_tree = feature_tree.second;
+                        Feature feature = build_feature(kept_tree);
                         tmp_id = feature->get_id();
                         //TODO feature identity isn't 100% spec compliant.  GeoJSON allows for a feature to have an
                         //optional id, but the input files set id under the 'property' key, so when a feature is constructed
@@ -410,14 +570,10 @@ namespace geojson {
                           }
                         }
                         
-                        if( ids.empty() || std::find(ids.begin(), ids.end(), tmp_id) != ids.end() ) {
-                          //ids is empty, meaning we want all features,
-                          //or feature id was found in the provided ids vector
-                          //so hold the feature to add to collection later
-
-                          features.push_back(std::move(feature));
-                        }
-                        feature_tree.second.erase("child"); //we are done with this feature, drop it from the ptree.  Not convinced this releases any resources, though =(
+                        //ids is empty, meaning we want all features,
+                        //or feature id was found in the provided ids
+                        //so hold the feature to add to collection later
+                        features.push_back(std::move(feature));
                     }
                 }
                 else {
@@ -441,18 +597,381 @@ namespace geojson {
         return collection;
     }
 
-    static GeoJSON read(const std::string &file_path, const std::vector<std::string> &ids = {}) {
-        boost::property_tree::ptree tree;
-        boost::property_tree::json_parser::read_json(file_path, tree);
-        return build_collection(tree, ids);
+    /**
+     * @brief Find the identity of a feature from its raw JSON text, without building the feature.
+     *
+     * As when features are built, this is the feature's ``id``, or else the ``id`` of its properties.
+     *
+     * @param raw The JSON text of the feature
+     * @param id Receives the identity, or an empty string if the feature has none
+     */
+    static void find_raw_feature_id(const std::string &raw, std::string &id) {
+        static const std::vector<std::string> id_path = {"id"};
+        static const std::vector<std::string> property_id_path = {"properties", "id"};
+        if (!JSONStreamScanner::find_member(raw, id_path, id) || id == "") {
+            if (!JSONStreamScanner::find_member(raw, property_id_path, id)) {
+                id = "";
+            }
+        }
     }
 
-    static GeoJSON read(std::stringstream &data, const std::vector<std::string> &ids = {}) {
-        boost::property_tree::ptree tree;
-        boost::property_tree::json_parser::read_json(data, tree);
-        return build_collection(tree, ids);
+    /**
+     * @brief Build a feature from its raw JSON text, as @ref read does.
+     *
+     * @param raw The JSON text of the feature
+     * @param options which parts of the feature to keep
+     */
+    static Feature build_raw_feature(const std::string &raw, const FeatureLoadOptions &options) {
+        boost::property_tree::ptree feature_tree;
+        std::istringstream feature_stream(raw);
+        boost::property_tree::json_parser::read_json(feature_stream, feature_tree);
+        Feature feature = build_feature(feature_tree, options);
+        //See build_collection; the input files set id under the 'properties' key
+        if (feature->get_id() == "") {
+            try {
+                feature->set_id(feature->get_property("id").as_string());
+            }
+            catch (const std::out_of_range& error) {
+            }
+        }
+        return feature;
+    }
+
+    /**
+     * @brief Read a GeoJSON FeatureCollection from a stream, one feature at a time.
+     *
+     * Rather than parsing the whole document into a property tree, the stream is scanned incrementally: each member
+     * of the "features" array is copied out and, if it is in @p ids, built into a feature from a property tree of
+     * just that feature.  Features not in @p ids are skipped without being parsed, so peak memory is bounded by the
+     * resulting collection rather than by the size of the document.
+     *
+     * With more than one of @p options ``threads``, the kept features are copied out in batches, and the features of
+     * each batch are then parsed and built concurrently, each into its own place in the batch, so the collection
+     * holds them in the order of the document, as it would if read on one thread.
+     *
+     * @param stream The GeoJSON text
+     * @param ids optional subset of string feature ids, only features with these ids will be in the collection
+     * @param source name of the stream's source, for error messages
+     * @param options which parts of the features to keep
+     */
+    static GeoJSON read(std::istream &stream, const std::vector<std::string> &ids = {}, const std::string &source = "",
+                        const FeatureLoadOptions &options = FeatureLoadOptions()) {
+        const std::unordered_set<std::string> subset(ids.begin(), ids.end());
+
+        std::vector<double> bbox_values;
+        std::vector<Feature> features;
+        std::string raw;    //the text of the current feature
+        std::string tmp_id; //a temporary string to hold feature identities
+
+        //With several threads, the kept features' texts wait in a batch until there are enough for every thread
+        utils::ThreadPool pool(options.threads);
+        const std::size_t batch_capacity = 256 * pool.size();
+        std::vector<std::string> batch;
+        std::vector<Feature> built;
+        auto build_batch = [&]() {
+            built.resize(batch.size());
+            pool.parallel_for(batch.size(), [&](std::size_t i) {
+                built[i] = build_raw_feature(batch[i], options);
+            });
+            std::move(built.begin(), built.end(), std::back_inserter(features));
+            built.clear();
+            batch.clear();
+        };
+
+        JSONStreamScanner scanner(stream, source);
+        scanner.expect('{');
+        if (!scanner.consume_if('}')) {
+            do {
+                std::string key = scanner.read_string();
+                scanner.expect(':');
+                if (key == "bbox") {
+                    scanner.expect('[');
+                    if (!scanner.consume_if(']')) {
+                        do {
+                            scanner.read_value(raw);
+                            bbox_values.push_back(std::stod(raw));
+                        } while (scanner.consume_if(','));
+                        scanner.expect(']');
+                    }
+                }
+                else if (key == "features") {
+                    scanner.expect('[');
+                    if (scanner.consume_if(']')) {
+                        continue;
+                    }
+                    do {
+                        scanner.read_value(raw);
+                        if (!subset.empty()) {
+                            //find the identity the same way as build_raw_feature, but without building the feature
+                            find_raw_feature_id(raw, tmp_id);
+                            if (subset.find(tmp_id) == subset.end()) {
+                                continue;
+                            }
+                        }
+
+                        if (pool.size() == 1) {
+                            features.push_back(build_raw_feature(raw, options));
+                            continue;
+                        }
+                        batch.push_back(std::move(raw));
+                        if (batch.size() == batch_capacity) {
+                            build_batch();
+                        }
+                    } while (scanner.consume_if(','));
+                    scanner.expect(']');
+                    build_batch();
+                }
+                else {
+                    //foreign members of the collection are not kept
+                    scanner.skip_value();
+                }
+            } while (scanner.consume_if(','));
+            scanner.expect('}');
+        }
+
+        GeoJSON collection = std::make_shared<FeatureCollection>(FeatureCollection(std::move(features), std::move(bbox_values)));
+
+        for (Feature feature : features) {
+            if (feature->get_id() != "") {
+                collection->add_feature_id(feature->get_id(), feature);
+            }
+        }
+
+        return collection;
+    }
+
+    /**
+     * @brief Copy the features with the given ids of a GeoJSON FeatureCollection from one stream to another.
+     *
+     * The input is scanned as by @ref read, but nothing is parsed beyond the feature ids: the text of each kept
+     * feature, and of each other member of the collection (e.g. ``crs``), is copied out verbatim.  This makes a
+     * smaller file of a subset, e.g. of a partition, that reads back the same as reading the subset of the input.
+     *
+     * @param in The GeoJSON text
+     * @param out The stream to write the GeoJSON text of the subset to
+     * @param ids The string ids of the features to copy
+     * @param source name of the input's source, for error messages
+     * @return The number of features copied
+     */
+    static std::size_t write_subset(std::istream &in, std::ostream &out, const std::unordered_set<std::string> &ids,
+                                    const std::string &source = "") {
+        std::size_t copied = 0;
+        std::string raw;    //the text of the current member
+        std::string tmp_id; //a temporary string to hold feature identities
+
+        JSONStreamScanner scanner(in, source);
+        scanner.expect('{');
+        out << "{";
+        bool first_member = true;
+        if (!scanner.consume_if('}')) {
+            do {
+                //keys are copied raw, so they are written back with their escapes as they were
+                std::string key;
+                scanner.read_value(key);
+                scanner.expect(':');
+                out << (first_member ? "" : ",") << "\n" << key << ": ";
+                first_member = false;
+                if (key != "\"features\"") {
+                    scanner.read_value(raw);
+                    out << raw;
+                    continue;
+                }
+                out << "[";
+                scanner.expect('[');
+                if (!scanner.consume_if(']')) {
+                    do {
+                        scanner.read_value(raw);
+                        find_raw_feature_id(raw, tmp_id);
+                        if (ids.find(tmp_id) == ids.end()) {
+                            continue;
+                        }
+                        out << (copied == 0 ? "\n" : ",\n") << raw;
+                        ++copied;
+                    } while (scanner.consume_if(','));
+                    scanner.expect(']');
+                }
+                out << "\n]";
+            } while (scanner.consume_if(','));
+            scanner.expect('}');
+        }
+        out << "\n}\n";
+        return copied;
+    }
+
+    /**
+     * @brief Build a feature of an edge list: just an id and, unless it is empty, the ``toid`` it links to.
+     *
+     * The feature has no geometry, and carries both as properties, as features read from GeoJSON do.
+     */
+    static Feature build_edge_feature(const std::string &id, const std::string &toid) {
+        PropertyMap properties;
+        properties.emplace("id", JSONProperty("id", id));
+        if (toid != "") {
+            properties.emplace("toid", JSONProperty("toid", toid));
+        }
+        return build_feature(FeatureType::Point, empty_geometry(FeatureType::Point), std::vector<geometry>(), id,
+                             std::move(properties), std::vector<double>(), PropertyMap());
+    }
+
+    /**
+     * @brief Add an edge list feature to @p features, unless it is not in a nonempty @p subset.
+     */
+    static void add_edge_feature(std::vector<Feature> &features, const std::unordered_set<std::string> &subset,
+                                 const std::string &id, const std::string &toid) {
+        if (subset.empty() || subset.find(id) != subset.end()) {
+            features.push_back(build_edge_feature(id, toid));
+        }
+    }
+
+    static GeoJSON make_edge_collection(std::vector<Feature> features) {
+        GeoJSON collection = std::make_shared<FeatureCollection>(FeatureCollection(std::move(features), std::vector<double>()));
+        for (const Feature& feature : *collection) {
+            collection->add_feature_id(feature->get_id(), feature);
+        }
+        return collection;
     }
 
+    /**
+     * @brief Read the topology of a hydrofabric from a JSON edge list, without any geometries or other properties.
+     *
+     * The edge list is an array of objects with an ``id`` and the ``toid`` it links to, as in
+     * data/catchment_edge_list.json; a missing, empty or null ``toid`` links to nothing.
+     *
+     * @param stream The JSON text
+     * @param ids optional subset of string feature ids, only features with these ids will be in the collection
+     * @param source name of the stream's source, for error messages
+     */
+    static GeoJSON read_edge_list(std::istream &stream, const std::vector<std::string> &ids = {},
+                                  const std::string &source = "") {
+        static const std::vector<std::string> id_path = {"id"};
+        static const std::vector<std::string> toid_path = {"toid"};
+        const std::unordered_set<std::string> subset(ids.begin(), ids.end());
+        std::vector<Feature> features;
+        std::string raw, id, toid;
+
+        JSONStreamScanner scanner(stream, source);
+        scanner.expect('[');
+        if (!scanner.consume_if(']')) {
+            do {
+                scanner.read_value(raw);
+                if (!JSONStreamScanner::find_member(raw, id_path, id) || id == "") {
+                    throw std::runtime_error("Edge list " + source + " has an edge without an id");
+                }
+                if (!JSONStreamScanner::find_member(raw, toid_path, toid) || toid == "null") {
+                    toid = "";
+                }
+                add_edge_feature(features, subset, id, toid);
+            } while (scanner.consume_if(','));
+            scanner.expect(']');
+        }
+        return make_edge_collection(std::move(features));
+    }
+
+    /**
+     * @brief Read the topology of a hydrofabric from a CSV edge list, without any geometries or other properties.
+     *
+     * The first line names the columns, of which the ``id`` and ``toid`` ones are used, e.g. ``id,toid``; an empty
+     * ``toid`` links to nothing.  Values may be double quoted, but may not contain commas.
+     *
+     * @param stream The CSV text
+     * @param ids optional subset of string feature ids, only features with these ids will be in the collection
+     * @param source name of the stream's source, for error messages
+     */
+    static GeoJSON read_edge_list_csv(std::istream &stream, const std::vector<std::string> &ids = {},
+                                      const std::string &source = "") {
+        const std::unordered_set<std::string> subset(ids.begin(), ids.end());
+        std::vector<Feature> features;
+        std::string line;
+        std::vector<std::string> values;
+
+        //split a line into its values, dropping any line ending and quotes around values
+        auto split = [&values](const std::string &text) {
+            values.clear();
+            std::size_t start = 0;
+            while (true) {
+                std::size_t comma = text.find(',', start);
+                std::string value = text.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+                if (!value.empty() && value.back() == '\r') {
+                    value.pop_back();
+                }
+                if (value.size() >= 2 && value.front() == '"' && value.back() == '"') {
+                    value = value.substr(1, value.size() - 2);
+                }
+                values.push_back(std::move(value));
+                if (comma == std::string::npos) {
+                    return;
+                }
+                start = comma + 1;
+            }
+        };
+
+        if (!std::getline(stream, line)) {
+            throw std::runtime_error("Edge list " + source + " is empty");
+        }
+        split(line);
+        auto id_column = std::find(values.begin(), values.end(), "id");
+        auto toid_column = std::find(values.begin(), values.end(), "toid");
+        if (id_column == values.end() || toid_column == values.end()) {
+            throw std::runtime_error("Edge list " + source + " needs an id and a toid column");
+        }
+        const std::size_t id_index = id_column - values.begin();
+        const std::size_t toid_index = toid_column - values.begin();
+
+        while (std::getline(stream, line)) {
+            if (line.empty() || line == "\r") {
+                continue;
+            }
+            split(line);
+            if (values.size() <= id_index || values[id_index] == "") {
+                throw std::runtime_error("Edge list " + source + " has an edge without an id: " + line);
+            }
+            add_edge_feature(features, subset, values[id_index], values.size() > toid_index ? values[toid_index] : "");
+        }
+        return make_edge_collection(std::move(features));
+    }
+
+    /**
+     * @brief Read the features of the contents of a hydrofabric file, with the given ids.
+     *
+     * As with the file itself (see the @ref read of a file path), the contents are GeoJSON or an edge list.
+     *
+     * @param stream the contents of the file
+     * @param file_path the path of the file, by which a CSV edge list is recognized
+     */
+    static GeoJSON read_hydrofabric(std::istream &stream, const std::string &file_path,
+                                    const std::vector<std::string> &ids = {},
+                                    const FeatureLoadOptions &options = FeatureLoadOptions()) {
+        const std::string csv_extension = ".csv";
+        if (file_path.size() > csv_extension.size()
+            && file_path.compare(file_path.size() - csv_extension.size(), csv_extension.size(), csv_extension) == 0) {
+            return read_edge_list_csv(stream, ids, file_path);
+        }
+        //GeoJSON is an object, while a JSON edge list is an array
+        if ((stream >> std::ws).peek() == '[') {
+            return read_edge_list(stream, ids, file_path);
+        }
+        return read(stream, ids, file_path, options);
+    }
+
+    /**
+     * @brief Read the features of a hydrofabric file, with the given ids.
+     *
+     * Besides GeoJSON, the file may be an edge list of just the features' topology, which is much smaller and faster
+     * to read: a JSON array (see @ref read_edge_list), or a CSV file, by a ``.csv`` extension
+     * (see @ref read_edge_list_csv).
+     */
+    static GeoJSON read(const std::string &file_path, const std::vector<std::string> &ids = {},
+                        const FeatureLoadOptions &options = FeatureLoadOptions()) {
+        std::ifstream file(file_path, std::ios::binary);
+        if (!file) {
+            throw boost::property_tree::json_parser_error("cannot open file", file_path, 0);
+        }
+        return read_hydrofabric(file, file_path, ids, options);
+    }
+
+    static GeoJSON read(std::stringstream &data, const std::vector<std::string> &ids = {}) {
+        return read(static_cast<std::istream&>(data), ids);
+    }
 
 }
 
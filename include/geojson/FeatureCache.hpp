@@ -0,0 +1,122 @@
+#ifndef GEOJSON_FEATURE_CACHE_H
+#define GEOJSON_FEATURE_CACHE_H
+
+#include <FeatureBuilder.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace geojson {
+    /**
+     * File name suffix of the binary cache of a GeoJSON file, which is kept next to the GeoJSON file itself.
+     */
+    const std::string FEATURE_CACHE_EXTENSION = ".ngencache";
+
+    /**
+     * @brief The size and content hash of a source GeoJSON file, identifying the version a cache was built from.
+     */
+    struct SourceDigest {
+        std::uint64_t size = 0;
+        std::uint64_t hash = 0;
+
+        bool operator==(const SourceDigest& other) const {
+            return size == other.size && hash == other.hash;
+        }
+    };
+
+    /**
+     * @brief Compute the digest of the contents of a file.
+     *
+     * @throws std::runtime_error If the file cannot be read.
+     */
+    SourceDigest digest_file(const std::string& file_path);
+
+    /**
+     * @brief Write a compact binary serialization of a feature collection.
+     *
+     * The cache holds every feature's type, id, bounding box, properties, foreign members and, optionally, geometry,
+     * followed by an index of feature ids so subsets can be loaded without decoding the other features.  Links
+     * between features are not stored; as with GeoJSON, they are re-created from the ``toid`` properties.
+     *
+     * The file is written under a temporary name and renamed into place, so concurrent readers never see a partial
+     * cache.
+     *
+     * @param collection The collection to write.
+     * @param source The digest of the GeoJSON file @p collection was read from.
+     * @param cache_path The path of the cache file.
+     * @param include_geometry Whether to store feature geometries; if not, features are loaded with empty geometries.
+     */
+    void write_feature_cache(const FeatureCollection& collection, const SourceDigest& source,
+                             const std::string& cache_path, bool include_geometry = true);
+
+    /**
+     * @brief Serialize a feature collection to memory, in the format of a cache file (see @ref write_feature_cache).
+     *
+     * This is the compact binary form in which to move features between processes, e.g. from one MPI rank that parsed
+     * a hydrofabric to the others.  It records no source file.
+     *
+     * @param collection The collection to serialize.
+     * @param include_geometry Whether to keep feature geometries; if not, features are loaded with empty geometries.
+     * @return The serialized collection.
+     */
+    std::string serialize_features(const FeatureCollection& collection, bool include_geometry = true);
+
+    /**
+     * @brief Load a feature collection from its serialization in memory (see @ref serialize_features).
+     *
+     * @param data The serialized collection, which need only outlive the call.
+     * @param size The size of @p data, in bytes.
+     * @param ids optional subset of string feature ids, only features with these ids will be in the collection
+     * @param options which parts of the features to keep
+     * @throws std::runtime_error If the data is malformed.
+     */
+    GeoJSON deserialize_features(const char* data, std::size_t size, const std::vector<std::string>& ids = {},
+                                 const FeatureLoadOptions& options = FeatureLoadOptions());
+
+    /**
+     * @brief Check whether a cache file exists and was built from the given source.
+     */
+    bool feature_cache_matches(const std::string& cache_path, const SourceDigest& source);
+
+    /**
+     * @brief Load a feature collection from a memory mapped cache file.
+     *
+     * @param cache_path The path of the cache file.
+     * @param ids optional subset of string feature ids, only features with these ids will be in the collection
+     * @param options which parts of the features to keep
+     * @throws std::runtime_error If the cache cannot be read or is malformed.
+     */
+    GeoJSON read_feature_cache(const std::string& cache_path, const std::vector<std::string>& ids = {},
+                               const FeatureLoadOptions& options = FeatureLoadOptions());
+
+    /**
+     * @brief Make sure the cache of a GeoJSON file is current, rebuilding it from the GeoJSON if needed.
+     *
+     * @param file_path The GeoJSON file.
+     * @param include_geometry Whether the cache must store feature geometries; a cache without them is rebuilt.
+     * @return Whether the cache had to be rebuilt.
+     */
+    bool update_feature_cache(const std::string& file_path, bool include_geometry = true);
+
+    /**
+     * @brief Read a GeoJSON file through its binary cache.
+     *
+     * If the cache next to @p file_path (see @ref FEATURE_CACHE_EXTENSION) was built from the current contents of
+     * the file, the collection is loaded from the cache; otherwise the GeoJSON is parsed and the cache (re)built for
+     * the next run.
+     *
+     * @param file_path The GeoJSON file.
+     * @param ids optional subset of string feature ids, only features with these ids will be in the collection
+     * @param verify Whether to check the cache against a hash of the file's contents.  Only pass false if the cache
+     *               is known to be current, e.g. because another process just called @ref update_feature_cache; the
+     *               cache is then only checked against the file's size.
+     * @param options Which parts of the features to keep.  A cache built without geometries is rebuilt when
+     *                geometries are wanted; a rebuilt cache stores geometries only if they are wanted.
+     */
+    GeoJSON read_cached(const std::string& file_path, const std::vector<std::string>& ids = {}, bool verify = true,
+                        const FeatureLoadOptions& options = FeatureLoadOptions());
+}
+
+#endif // GEOJSON_FEATURE_CACHE_H
@@ -10,6 +10,7 @@
 #include <exception>
 #include <memory>
 #include <algorithm>
+#include <unordered_map>
 #include <unordered_set>
 
 #include <boost/property_tree/ptree.hpp>
@@ -89,6 +90,12 @@ namespace geojson {
              */
             int get_size();
 
+            /**
+             * An estimate of the bytes this collection holds: its features, as FeatureBase::get_memory_bytes estimates
+             * them, and its index of them by id.  Features shared with another collection are counted by both.
+             */
+            std::size_t get_memory_bytes() const;
+
             /**
              * @return Whether or not the collection is empty
              */
@@ -184,6 +191,13 @@ namespace geojson {
 
             void update_ids();
 
+            /**
+             * Link each feature to the features named by its properties, in one pass over the features
+             *
+             * @param from_property The property naming the feature each feature originates from, if any
+             * @param to_property The property naming the feature each feature flows to, if any
+             * @return The number of links made
+             */
             int link_features_from_property(std::string* from_property = nullptr, std::string* to_property = nullptr);
 
             int link_features_from_attribute(std::string* from_attribute = nullptr, std::string* to_attribute = nullptr);
@@ -214,7 +228,7 @@ namespace geojson {
         private:
             FeatureList features;
             std::vector<double> bounding_box;
-            std::map<std::string, Feature> feature_by_id;
+            std::unordered_map<std::string, Feature> feature_by_id;
             std::map<std::string, JSONProperty> foreign_members;
     };
 }
@@ -510,6 +510,8 @@ namespace geojson {
                         }
                     }
 
+                    // The members are all equal, which their Object variants, pointing to each one's own, can't tell
+                    return true;
                 }
 
                 return this->data == other.data;
@@ -582,5 +584,15 @@ namespace geojson {
                 std::vector<T>& vec;
             };
     };
+
+    /**
+     * @brief Hashes the content of a @ref PropertyMap, so that maps equal by ``==`` hash alike, e.g. to share one
+     * copy of formulation parameters configured alike in a @ref utils::SharedBlock.
+     */
+    struct PropertyMapHash {
+        std::size_t operator()(const PropertyMap& properties) const;
+
+        std::size_t operator()(const JSONProperty& property) const;
+    };
 }
 #endif // GEOJSON_JSONPROPERTY_H
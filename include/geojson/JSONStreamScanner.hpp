@@ -0,0 +1,350 @@
+#ifndef GEOJSON_JSON_STREAM_SCANNER_H
+#define GEOJSON_JSON_STREAM_SCANNER_H
+
+#include <istream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/property_tree/json_parser.hpp>
+
+namespace geojson {
+    /**
+     * @brief Incremental, forward only tokenizer over a JSON text stream.
+     *
+     * The scanner reads its stream through a fixed size buffer, so arbitrarily large documents can be walked one
+     * value at a time: callers step through the structure they care about (e.g. the members of the top level object
+     * of a GeoJSON FeatureCollection) and either skip, or copy out the raw text of, each value they encounter.
+     *
+     * Malformed input raises a boost::property_tree::json_parser_error, as boost::property_tree's own JSON parser
+     * would, reporting the line where the scanner stopped.
+     *
+     * @code {.cpp}
+     * JSONStreamScanner scanner(stream);
+     * scanner.expect('{');
+     * if (!scanner.consume_if('}')) {
+     *     do {
+     *         std::string key = scanner.read_string();
+     *         scanner.expect(':');
+     *         scanner.skip_value();
+     *     } while (scanner.consume_if(','));
+     *     scanner.expect('}');
+     * }
+     * @endcode
+     */
+    class JSONStreamScanner {
+        public:
+            /**
+             * @param stream The stream to scan.
+             * @param source Name of the stream's source (e.g. a file path) for error messages.
+             */
+            explicit JSONStreamScanner(std::istream& stream, std::string source = "")
+                : stream(stream), source(std::move(source)), buffer(BUFFER_SIZE) {}
+
+            /**
+             * @brief Skip whitespace and return the next character without consuming it.
+             *
+             * @return The next character, or std::char_traits<char>::eof() at the end of the stream.
+             */
+            int peek() {
+                skip_whitespace();
+                return raw_peek();
+            }
+
+            /**
+             * @brief Skip whitespace and consume the next character, which must be @p c.
+             */
+            void expect(char c) {
+                if (peek() != c) {
+                    fail(std::string("expected '") + c + "'");
+                }
+                get();
+            }
+
+            /**
+             * @brief Skip whitespace and consume the next character if it is @p c.
+             *
+             * @return Whether @p c was consumed.
+             */
+            bool consume_if(char c) {
+                if (peek() == c) {
+                    get();
+                    return true;
+                }
+                return false;
+            }
+
+            /**
+             * @brief Read the next value, which must be a string, and return it with its escapes decoded.
+             */
+            std::string read_string() {
+                if (peek() != '"') {
+                    fail("expected string");
+                }
+                get();
+                std::string value;
+                while (true) {
+                    int c = get();
+                    if (c == '"') {
+                        return value;
+                    }
+                    if (c == '\\') {
+                        decode_escape(value);
+                    }
+                    else {
+                        value.push_back((char)c);
+                    }
+                }
+            }
+
+            /**
+             * @brief Copy the raw JSON text of the next value (of any type) into @p raw, replacing its contents.
+             */
+            void read_value(std::string& raw) {
+                raw.clear();
+                Append sink{raw};
+                scan_value(sink);
+            }
+
+            /**
+             * @brief Skip over the next value, of any type.
+             */
+            void skip_value() {
+                Discard sink;
+                scan_value(sink);
+            }
+
+            /**
+             * @brief Find a scalar member of a JSON object held in a string, without parsing the rest of it.
+             *
+             * @param json The text of a JSON object.
+             * @param path The keys to follow from the outer object, e.g. ``{"properties", "id"}``.
+             * @param value Receives the member's value: the decoded string for string values, otherwise the raw
+             *              literal (e.g. ``27`` or ``true``).
+             * @return Whether the member exists and is not an object or array.
+             */
+            static bool find_member(const std::string& json, const std::vector<std::string>& path, std::string& value) {
+                std::istringstream stream(json);
+                JSONStreamScanner scanner(stream);
+                return !path.empty() && scanner.find_member(path, 0, value);
+            }
+
+        private:
+            static const std::size_t BUFFER_SIZE = 1 << 16;
+
+            struct Discard {
+                void put(char) {}
+            };
+
+            struct Append {
+                std::string& text;
+                void put(char c) { text.push_back(c); }
+            };
+
+            int raw_peek() {
+                if (position == end && !fill()) {
+                    return std::char_traits<char>::eof();
+                }
+                return (unsigned char)buffer[position];
+            }
+
+            int get() {
+                int c = raw_peek();
+                if (c == std::char_traits<char>::eof()) {
+                    fail("unexpected end of data");
+                }
+                ++position;
+                if (c == '\n') {
+                    ++line;
+                }
+                return c;
+            }
+
+            bool fill() {
+                stream.read(buffer.data(), buffer.size());
+                position = 0;
+                end = stream.gcount();
+                return end > 0;
+            }
+
+            void skip_whitespace() {
+                int c = raw_peek();
+                while (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+                    get();
+                    c = raw_peek();
+                }
+            }
+
+            [[noreturn]] void fail(const std::string& message) {
+                throw boost::property_tree::json_parser_error(message, source, line);
+            }
+
+            /**
+             * Decode the escape sequence following a backslash, appending UTF-8 to @p value.
+             */
+            void decode_escape(std::string& value) {
+                int c = get();
+                switch (c) {
+                    case '"': value.push_back('"'); break;
+                    case '\\': value.push_back('\\'); break;
+                    case '/': value.push_back('/'); break;
+                    case 'b': value.push_back('\b'); break;
+                    case 'f': value.push_back('\f'); break;
+                    case 'n': value.push_back('\n'); break;
+                    case 'r': value.push_back('\r'); break;
+                    case 't': value.push_back('\t'); break;
+                    case 'u': {
+                        unsigned long code = read_hex4();
+                        if (code >= 0xD800 && code <= 0xDBFF) {
+                            // High surrogate, which must be followed by an escaped low surrogate
+                            if (get() != '\\' || get() != 'u') {
+                                fail("invalid surrogate pair in string");
+                            }
+                            unsigned long low = read_hex4();
+                            if (low < 0xDC00 || low > 0xDFFF) {
+                                fail("invalid surrogate pair in string");
+                            }
+                            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                        }
+                        append_utf8(value, code);
+                        break;
+                    }
+                    default:
+                        fail("invalid escape sequence in string");
+                }
+            }
+
+            unsigned long read_hex4() {
+                unsigned long code = 0;
+                for (int i = 0; i < 4; ++i) {
+                    int c = get();
+                    code <<= 4;
+                    if (c >= '0' && c <= '9') code |= c - '0';
+                    else if (c >= 'a' && c <= 'f') code |= c - 'a' + 10;
+                    else if (c >= 'A' && c <= 'F') code |= c - 'A' + 10;
+                    else fail("invalid unicode escape in string");
+                }
+                return code;
+            }
+
+            static void append_utf8(std::string& value, unsigned long code) {
+                if (code < 0x80) {
+                    value.push_back((char)code);
+                }
+                else if (code < 0x800) {
+                    value.push_back((char)(0xC0 | (code >> 6)));
+                    value.push_back((char)(0x80 | (code & 0x3F)));
+                }
+                else if (code < 0x10000) {
+                    value.push_back((char)(0xE0 | (code >> 12)));
+                    value.push_back((char)(0x80 | ((code >> 6) & 0x3F)));
+                    value.push_back((char)(0x80 | (code & 0x3F)));
+                }
+                else {
+                    value.push_back((char)(0xF0 | (code >> 18)));
+                    value.push_back((char)(0x80 | ((code >> 12) & 0x3F)));
+                    value.push_back((char)(0x80 | ((code >> 6) & 0x3F)));
+                    value.push_back((char)(0x80 | (code & 0x3F)));
+                }
+            }
+
+            /**
+             * Pass the raw text of the next value to @p sink, checking only that brackets and strings are balanced.
+             */
+            template <typename Sink>
+            void scan_value(Sink& sink) {
+                int c = peek();
+                if (c == '"') {
+                    scan_string(sink);
+                }
+                else if (c == '{' || c == '[') {
+                    std::vector<char> closers;
+                    do {
+                        c = raw_peek();
+                        if (c == '"') {
+                            scan_string(sink);
+                            continue;
+                        }
+                        get();
+                        sink.put((char)c);
+                        if (c == '{') {
+                            closers.push_back('}');
+                        }
+                        else if (c == '[') {
+                            closers.push_back(']');
+                        }
+                        else if (c == '}' || c == ']') {
+                            if (c != closers.back()) {
+                                fail("mismatched brackets");
+                            }
+                            closers.pop_back();
+                        }
+                    } while (!closers.empty());
+                }
+                else if (c == ',' || c == ':' || c == '}' || c == ']' || c == std::char_traits<char>::eof()) {
+                    fail("expected value");
+                }
+                else {
+                    // Number or literal
+                    while (c != ',' && c != '}' && c != ']' && c != ' ' && c != '\t' && c != '\n' && c != '\r'
+                           && c != std::char_traits<char>::eof()) {
+                        sink.put((char)get());
+                        c = raw_peek();
+                    }
+                }
+            }
+
+            template <typename Sink>
+            void scan_string(Sink& sink) {
+                sink.put((char)get());
+                while (true) {
+                    int c = get();
+                    sink.put((char)c);
+                    if (c == '"') {
+                        return;
+                    }
+                    if (c == '\\') {
+                        sink.put((char)get());
+                    }
+                }
+            }
+
+            bool find_member(const std::vector<std::string>& path, std::size_t depth, std::string& value) {
+                expect('{');
+                if (consume_if('}')) {
+                    return false;
+                }
+                do {
+                    std::string key = read_string();
+                    expect(':');
+                    if (key == path[depth]) {
+                        int c = peek();
+                        if (depth + 1 < path.size()) {
+                            return c == '{' && find_member(path, depth + 1, value);
+                        }
+                        if (c == '"') {
+                            value = read_string();
+                            return true;
+                        }
+                        if (c == '{' || c == '[') {
+                            return false;
+                        }
+                        read_value(value);
+                        return true;
+                    }
+                    skip_value();
+                } while (consume_if(','));
+                expect('}');
+                return false;
+            }
+
+            std::istream& stream;
+            std::string source;
+            std::vector<char> buffer;
+            std::size_t position = 0;
+            std::size_t end = 0;
+            unsigned long line = 1;
+    };
+}
+
+#endif // GEOJSON_JSON_STREAM_SCANNER_H
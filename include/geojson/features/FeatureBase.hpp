@@ -3,6 +3,7 @@
 
 #include "JSONGeometry.hpp"
 #include "JSONProperty.hpp"
+#include "CompactPropertyMap.hpp"
 #include "FeatureVisitor.hpp"
 
 #include <memory>
@@ -88,7 +89,7 @@ namespace geojson {
                 
                 foreign_members = std::move(members);
                 bounding_box = std::move(new_bounding_box);
-                properties = std::move(new_properties);
+                properties = CompactPropertyMap(new_properties);
             }
 
         public:
@@ -97,7 +98,7 @@ namespace geojson {
              */
             FeatureBase(const FeatureBase &feature) {
                 this->id = feature.get_id();
-                this->properties = feature.get_properties();
+                this->properties = feature.properties;
                 
                 for(std::string key : feature.keys()) {
                     this->set(key, feature.get(key));
@@ -210,7 +211,7 @@ namespace geojson {
              * @return The property identified by the key
              */
             virtual JSONProperty get_property(std::string key) const {
-                if (properties.find(key) == properties.end()) {
+                if (!properties.contains(key)) {
                     std::string error_message = "JSON Property '" + key + "' not found."; 
                     throw std::invalid_argument(error_message);
                 }
@@ -340,25 +341,11 @@ namespace geojson {
              * @returns A list of all the names of the properties for this feature
              */
             virtual std::vector<std::string> property_keys() const {
-                std::vector<std::string> property_keys;
-
-                for (auto& pair : properties) {
-                    property_keys.push_back(pair.first);
-                }
-
-                return property_keys;
+                return properties.keys();
             }
 
             virtual bool has_property(std::string property_name) const {
-                std::vector<std::string> all_properties = this->property_keys();
-
-                for (auto name : all_properties) {
-                    if (property_name == name) {
-                        return true;
-                    }
-                }
-
-                return false;
+                return properties.contains(property_name);
             }
 
             /**
@@ -385,13 +372,33 @@ namespace geojson {
             }
 
             PropertyMap get_properties() const {
-                return properties;
+                return properties.to_map();
             }
 
             std::string get_id() const {
                 return id;
             }
 
+            /**
+             * An estimate of the bytes this feature holds: itself, its properties, the points of its geometry and its
+             * links to other features, from the capacity of each and not the allocator's overhead.
+             */
+            std::size_t get_memory_bytes() const {
+                std::size_t bytes = sizeof(FeatureBase) + properties.get_memory_bytes()
+                                  + bounding_box.capacity() * sizeof(double)
+                                  + (origination.capacity() + destination.capacity() + neighbors.capacity()) * sizeof(FeatureBase*)
+                                  + geometry_collection.capacity() * sizeof(::geojson::geometry)
+                                  + foreign_members.size() * (sizeof(PropertyMap::value_type) + 4 * sizeof(void*));
+                if (id.capacity() > std::string().capacity()) {
+                    bytes += id.capacity() + 1;
+                }
+                bytes += boost::geometry::num_points(geom) * sizeof(coordinate_t);
+                for (const ::geojson::geometry& part : geometry_collection) {
+                    bytes += boost::geometry::num_points(part) * sizeof(coordinate_t);
+                }
+                return bytes;
+            }
+
             int get_number_of_destination_features() {
                 return destination.size();
             }
@@ -693,7 +700,7 @@ namespace geojson {
             ::geojson::geometry geom;
             std::vector<::geojson::geometry> geometry_collection;
 
-            PropertyMap properties;
+            CompactPropertyMap properties;
             std::vector<double> bounding_box;
             PropertyMap foreign_members;
             std::string id;
@@ -0,0 +1,106 @@
+/*
+ * A C interface to ngen::Simulation (see include/core/Simulation.hpp), for running a simulation in the calling process
+ * from C or from a language with a C foreign function interface, a number of time steps at a time.
+ *
+ * Functions that can fail return 0 on success and -1 on failure, with the reason from ngen_simulation_last_error.
+ * Flows are returned as pointers into the simulation's own memory, step major, and are valid until the simulation next
+ * steps or is destroyed.
+ */
+
+#ifndef NGEN_SIMULATION_H
+#define NGEN_SIMULATION_H
+
+#include <stddef.h>
+
+#if defined(__GNUC__)
+#define NGEN_SIMULATION_API __attribute__((visibility("default")))
+#else
+#define NGEN_SIMULATION_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct ngen_simulation ngen_simulation;
+
+/**
+ * Build a simulation from a hydrofabric file of catchments and a realization config file.
+ *
+ * @param threads The number of threads to run catchments on, or 0 for one per CPU.
+ * @return The simulation, or null on failure.
+ */
+NGEN_SIMULATION_API ngen_simulation* ngen_simulation_create(const char* catchment_path, const char* realization_path,
+                                                            size_t threads);
+
+/** Finalize and free a simulation; null is ignored. */
+NGEN_SIMULATION_API void ngen_simulation_destroy(ngen_simulation* simulation);
+
+/**
+ * Run the next time steps of a simulation.
+ *
+ * @param steps_run Set to the number of steps run, which is fewer than steps if the simulation ended first.
+ */
+NGEN_SIMULATION_API int ngen_simulation_step(ngen_simulation* simulation, int steps, int* steps_run);
+
+/** @return The output time index of the next step to run. */
+NGEN_SIMULATION_API int ngen_simulation_time_index(const ngen_simulation* simulation);
+
+NGEN_SIMULATION_API int ngen_simulation_total_steps(const ngen_simulation* simulation);
+
+NGEN_SIMULATION_API size_t ngen_simulation_nexus_count(const ngen_simulation* simulation);
+
+/** @return The id of a nexus, owned by the simulation, or null if there is no such nexus. */
+NGEN_SIMULATION_API const char* ngen_simulation_nexus_id(const ngen_simulation* simulation, size_t index);
+
+/**
+ * @param steps Set to the number of steps last run.
+ * @return The flows, in m^3/s, of each nexus at each step last run, where flows[s * nexus_count + n] is that of nexus n
+ *         at step s.
+ */
+NGEN_SIMULATION_API const double* ngen_simulation_nexus_flows(const ngen_simulation* simulation, size_t* steps);
+
+NGEN_SIMULATION_API size_t ngen_simulation_catchment_count(const ngen_simulation* simulation);
+
+/** @return The id of a catchment, owned by the simulation, or null if there is no such catchment. */
+NGEN_SIMULATION_API const char* ngen_simulation_catchment_id(const ngen_simulation* simulation, size_t index);
+
+/** As ngen_simulation_nexus_flows, for the flows each catchment contributed. */
+NGEN_SIMULATION_API const double* ngen_simulation_catchment_flows(const ngen_simulation* simulation, size_t* steps);
+
+/**
+ * Create forcing that is pushed into memory a time step at a time, for the formulations of simulations created after
+ * it whose realization config has "provider": "Pushed" and the name as the path of their forcing.
+ *
+ * @param ids The ids of the catchments, in the order of the rows of the values pushed.
+ * @param variables The names of the variables, in the order of the values of each row.
+ * @param units The units of each variable.
+ * @param start_time The epoch time of the start of the first time step.
+ * @param time_step The length, in seconds, of each time step.
+ * @param wait_seconds How long a formulation may wait for its time step to be pushed, or a push for the step it
+ *                     replaces to be read, before failing; 0 fails at once.
+ */
+NGEN_SIMULATION_API int ngen_forcing_create(const char* name, const char* const* ids, size_t id_count,
+                                            const char* const* variables, const char* const* units,
+                                            size_t variable_count, long start_time, long time_step,
+                                            double wait_seconds);
+
+/**
+ * Push the values of the next time step of the forcing of a name.
+ *
+ * @param values The values of every variable of every catchment, where values[c * variable_count + v] is that of
+ *               variable v of catchment c.
+ */
+NGEN_SIMULATION_API int ngen_forcing_push(const char* name, size_t time_index, const double* values);
+
+/** Forget the forcing of a name, which is freed once no simulation reads it. */
+NGEN_SIMULATION_API void ngen_forcing_release(const char* name);
+
+/** @return The reason the last call on this thread failed, or an empty string. */
+NGEN_SIMULATION_API const char* ngen_simulation_last_error(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NGEN_SIMULATION_H */
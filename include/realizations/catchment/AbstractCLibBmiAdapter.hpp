@@ -2,6 +2,10 @@
 #define NGEN_ABSTRACTCLIBBMIADAPTER_HPP
 
 #include <dlfcn.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 #include "Bmi_Adapter.hpp"
 #include "ExternalIntegrationException.hpp"
 #include "State_Exception.hpp"
@@ -9,6 +13,112 @@
 namespace models {
     namespace bmi {
 
+        /**
+         * A shared library opened once per process, along with the symbols resolved from it so far.
+         *
+         * Adapters for the same library file share a single instance, so the library is opened and each of its
+         * symbols is looked up only once, however many catchments use it.  The library is closed once no adapter holds
+         * the instance anymore.
+         */
+        class Loaded_Shared_Library {
+
+        public:
+
+            /**
+             * Get the already opened library at the given path, if any.
+             *
+             * @param path The path of the library file.
+             * @return The opened library, or ``nullptr`` if it is not currently open.
+             */
+            static std::shared_ptr<Loaded_Shared_Library> get_loaded(const std::string &path) {
+                std::lock_guard<std::mutex> lock(get_cache_mutex());
+                auto it = get_cache().find(path);
+                return it == get_cache().end() ? nullptr : it->second.lock();
+            }
+
+            /**
+             * Get the library at the given path, opening it if it is not already open.
+             *
+             * @param path The path of the library file.
+             * @param err_message Set to the ``dlerror`` message, if any, when the library cannot be opened.
+             * @return The opened library, or ``nullptr`` if it cannot be opened.
+             */
+            static std::shared_ptr<Loaded_Shared_Library> load(const std::string &path, std::string &err_message) {
+                std::lock_guard<std::mutex> lock(get_cache_mutex());
+                std::shared_ptr<Loaded_Shared_Library> library = get_cache()[path].lock();
+                if (library != nullptr) {
+                    return library;
+                }
+                // Call first to ensure any previous error is cleared before trying to load the library
+                dlerror();
+                void *handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+                // Now call again to see if there was an error (if there was, this will not be null)
+                char *err = dlerror();
+                if (handle == nullptr) {
+                    err_message = err == nullptr ? "" : std::string(err);
+                    get_cache().erase(path);
+                    return nullptr;
+                }
+                library = std::shared_ptr<Loaded_Shared_Library>(new Loaded_Shared_Library(handle));
+                get_cache()[path] = library;
+                return library;
+            }
+
+            Loaded_Shared_Library(const Loaded_Shared_Library &) = delete;
+            Loaded_Shared_Library &operator=(const Loaded_Shared_Library &) = delete;
+
+            ~Loaded_Shared_Library() {
+                dlclose(handle);
+            }
+
+            inline void *get_handle() const {
+                return handle;
+            }
+
+            /**
+             * Get a symbol of the library, looking it up on the first request for it.
+             *
+             * @param symbol_name The name of the symbol.
+             * @param err_message Set to the ``dlerror`` message, if any, from looking up the symbol.
+             * @return The address of the symbol, which may be null.
+             */
+            void *find_symbol(const std::string &symbol_name, std::string &err_message) {
+                std::lock_guard<std::mutex> lock(symbols_mutex);
+                auto it = symbols.find(symbol_name);
+                if (it == symbols.end()) {
+                    // Call first to ensure any previous error is cleared before trying to load the symbol
+                    dlerror();
+                    void *symbol = dlsym(handle, symbol_name.c_str());
+                    // Now call again to see if there was an error (if there was, this will not be null)
+                    char *err = dlerror();
+                    it = symbols.emplace(symbol_name, std::make_pair(symbol, err == nullptr ? "" : std::string(err))).first;
+                }
+                err_message = it->second.second;
+                return it->second.first;
+            }
+
+        private:
+
+            explicit Loaded_Shared_Library(void *handle) : handle(handle) { }
+
+            /** The libraries opened in this process, by path; entries expire once no adapter uses the library. */
+            static std::map<std::string, std::weak_ptr<Loaded_Shared_Library>> &get_cache() {
+                static std::map<std::string, std::weak_ptr<Loaded_Shared_Library>> cache;
+                return cache;
+            }
+
+            static std::mutex &get_cache_mutex() {
+                static std::mutex cache_mutex;
+                return cache_mutex;
+            }
+
+            void *handle;
+            /** Symbols looked up so far, with any error message from looking them up, by name. */
+            std::map<std::string, std::pair<void *, std::string>> symbols;
+            std::mutex symbols_mutex;
+
+        };
+
         template <class C>
         class AbstractCLibBmiAdapter : public Bmi_Adapter<C> {
 
@@ -38,11 +148,8 @@ namespace models {
                     Bmi_Adapter<C>(std::move(adapter)),
                     bmi_lib_file(std::move(adapter.bmi_lib_file)),
                     bmi_registration_function(adapter.bmi_registration_function),
-                    dyn_lib_handle(adapter.dyn_lib_handle)
-            {
-                // Have to make sure to do this after "moving" so the original does not close the dynamically loaded library handle
-                adapter.dyn_lib_handle = nullptr;
-            }
+                    dyn_lib(std::move(adapter.dyn_lib)),
+                    variable_metadata(std::move(adapter.variable_metadata)) { }
 
             /**
              * Class destructor.
@@ -74,6 +181,81 @@ namespace models {
 
         protected:
 
+            /**
+             * The metadata of a variable of the backing model, as the model reported it just after initialization.
+             *
+             * Anything the model failed to report is not recorded, and is instead asked of the model whenever it is
+             * requested, so the failure surfaces as it would have without the table.
+             */
+            struct Variable_Metadata {
+                /** The variable's position in the model's input variable names, or else its output variable names. */
+                int index = -1;
+                std::string type;
+                std::string units;
+                int itemsize = 0;
+                int nbytes = 0;
+                int grid = 0;
+                bool has_type = false;
+                bool has_units = false;
+                bool has_itemsize = false;
+                bool has_nbytes = false;
+                bool has_grid = false;
+            };
+
+            /**
+             * Get the recorded metadata of a variable, if any.
+             *
+             * @param name The name of the variable.
+             * @return The variable's recorded metadata, or ``nullptr`` if there is none.
+             */
+            inline const Variable_Metadata *find_variable_metadata(const std::string &name) const {
+                auto it = variable_metadata.find(name);
+                return it == variable_metadata.end() ? nullptr : &it->second;
+            }
+
+            /**
+             * Record the metadata of every input and output variable of the newly initialized backing model.
+             *
+             * The framework asks for a variable's type, size and units on every time step, each of which would otherwise
+             * be a call into the library.  Recording them once assumes, as grids in BMI are, that variables keep their
+             * sizes once the model is initialized.
+             */
+            void snapshot_variable_metadata() {
+                variable_metadata.clear();
+                std::vector<std::string> input_names, output_names;
+                try {
+                    input_names = this->GetInputVarNames();
+                    output_names = this->GetOutputVarNames();
+                }
+                catch (const std::exception &) {
+                    // Without the names nothing can be recorded, and every metadata request goes to the model
+                    return;
+                }
+                auto record = [this](const std::vector<std::string> &names) {
+                    for (int i = 0; i < (int) names.size(); ++i) {
+                        if (variable_metadata.find(names[i]) != variable_metadata.end()) {
+                            continue;
+                        }
+                        // Not yet in the table, so each of these queries goes to the model
+                        Variable_Metadata recorded;
+                        recorded.index = i;
+                        try { recorded.type = this->GetVarType(names[i]); recorded.has_type = true; }
+                        catch (const std::exception &) { }
+                        try { recorded.units = this->GetVarUnits(names[i]); recorded.has_units = true; }
+                        catch (const std::exception &) { }
+                        try { recorded.itemsize = this->GetVarItemsize(names[i]); recorded.has_itemsize = true; }
+                        catch (const std::exception &) { }
+                        try { recorded.nbytes = this->GetVarNbytes(names[i]); recorded.has_nbytes = true; }
+                        catch (const std::exception &) { }
+                        try { recorded.grid = this->GetVarGrid(names[i]); recorded.has_grid = true; }
+                        catch (const std::exception &) { }
+                        variable_metadata.emplace(names[i], recorded);
+                    }
+                };
+                record(input_names);
+                record(output_names);
+            }
+
             /**
              * Dynamically load and obtain this instance's handle to the shared library.
              */
@@ -83,11 +265,16 @@ namespace models {
                             "Can't init " + this->model_name + "; empty name given for library's registration function.";
                     throw std::runtime_error(this->init_exception_msg);
                 }
-                if (dyn_lib_handle != nullptr) {
+                if (dyn_lib != nullptr) {
                     this->output.put("WARNING: ignoring attempt to reload dynamic shared library '" + bmi_lib_file +
                     "' for " + this->model_name);
                     return;
                 }
+                // Reuse the library if another adapter in this process already opened it
+                dyn_lib = Loaded_Shared_Library::get_loaded(bmi_lib_file);
+                if (dyn_lib != nullptr) {
+                    return;
+                }
                 if (!utils::FileChecker::file_is_readable(bmi_lib_file)) {
                     //Try alternative extension...
                     size_t idx = bmi_lib_file.rfind(".");
@@ -117,16 +304,13 @@ namespace models {
 
                 }
 
-                // Call first to ensure any previous error is cleared before trying to load the symbol
-                dlerror();
                 // Load up the necessary library dynamically
-                dyn_lib_handle = dlopen(bmi_lib_file.c_str(), RTLD_NOW | RTLD_LOCAL);
-                // Now call again to see if there was an error (if there was, this will not be null)
-                char *err_message = dlerror();
-                if (dyn_lib_handle == nullptr && err_message != nullptr) {
+                std::string err_message;
+                dyn_lib = Loaded_Shared_Library::load(bmi_lib_file, err_message);
+                if (dyn_lib == nullptr) {
                     this->init_exception_msg = "Cannot load shared lib '" + bmi_lib_file + "' for model " + this->model_name;
-                    if (err_message != nullptr) {
-                        this->init_exception_msg += " (" + std::string(err_message) + ")";
+                    if (!err_message.empty()) {
+                        this->init_exception_msg += " (" + err_message + ")";
                     }
                     throw ::external::ExternalIntegrationException(this->init_exception_msg);
                 }
@@ -145,7 +329,7 @@ namespace models {
              * ``is_null_valid`` parameter.  When ``true``, a null symbol will be returned by the function.
              *
              * Typically, a call to @see dynamic_library_load must happen (though not necessarily have completed) before
-             * a call to this function to ensure @see dyn_lib_handle is set.  If it is not set, an exception is thrown.
+             * a call to this function to ensure @see dyn_lib is set.  If it is not set, an exception is thrown.
              *
              * @param symbol_name The name of the symbol to load.
              * @param is_null_valid Whether a null address for the symbol is valid, as opposed to implying there was
@@ -155,18 +339,15 @@ namespace models {
              * @throws ``::external::ExternalIntegrationException`` If symbol could not be found for the shared library.
              */
             inline void *dynamic_load_symbol(const std::string &symbol_name, bool is_null_valid) {
-                if (dyn_lib_handle == nullptr) {
+                if (dyn_lib == nullptr) {
                     throw std::runtime_error("Cannot load symbol " + symbol_name + " without handle to shared library");
                 }
-                // Call first to ensure any previous error is cleared before trying to load the symbol
-                dlerror();
-                void *symbol = dlsym(dyn_lib_handle, symbol_name.c_str());
-                // Now call again to see if there was an error (if there was, this will not be null)
-                char *err_message = dlerror();
-                if (symbol == nullptr && (err_message != nullptr || !is_null_valid)) {
+                std::string err_message;
+                void *symbol = dyn_lib->find_symbol(symbol_name, err_message);
+                if (symbol == nullptr && (!err_message.empty() || !is_null_valid)) {
                     this->init_exception_msg = "Cannot load shared lib symbol '" + symbol_name + "' for model " + this->model_name;
-                    if (err_message != nullptr) {
-                        this->init_exception_msg += " (" + std::string(err_message) + ")";
+                    if (!err_message.empty()) {
+                        this->init_exception_msg += " (" + err_message + ")";
                     }
                     throw ::external::ExternalIntegrationException(this->init_exception_msg);
                 }
@@ -194,7 +375,7 @@ namespace models {
             }
 
             inline const void *get_dyn_lib_handle() {
-                return dyn_lib_handle;
+                return dyn_lib == nullptr ? nullptr : dyn_lib->get_handle();
             }
 
         private:
@@ -203,8 +384,10 @@ namespace models {
             std::string bmi_lib_file;
             /** Name of the function that registers BMI struct's function pointers to the right module functions. */
             const std::string bmi_registration_function;
-            /** Handle for dynamically loaded library file. */
-            void *dyn_lib_handle = nullptr;
+            /** Dynamically loaded library file, shared with any other adapters in the process using the same file. */
+            std::shared_ptr<Loaded_Shared_Library> dyn_lib;
+            /** The metadata of the backing model's variables, by name, recorded by @see snapshot_variable_metadata. */
+            std::unordered_map<std::string, Variable_Metadata> variable_metadata;
 
             /**
              * A non-virtual equivalent for the virtual @see Finalize.
@@ -216,10 +399,8 @@ namespace models {
              * non-virtual, and can therefore be called by a destructor.
              */
             void finalizeForLibAbstraction() {
-                //  close the dynamically loaded library
-                if (dyn_lib_handle != nullptr) {
-                    dlclose(dyn_lib_handle);
-                }
+                //  release the dynamically loaded library, which is closed once no other adapter uses it
+                dyn_lib.reset();
             }
         };
 
@@ -152,6 +152,46 @@ namespace models {
             virtual const std::string get_analogous_cxx_type(const std::string &external_type_name,
                                                              const size_t item_size) = 0;
 
+            /**
+             * Get the handle of a variable of the backing model, for getting and setting its values by handle rather
+             * than by name, where the backing model supports that.
+             *
+             * The default is for backing models without such support, so the variable has no handle.
+             *
+             * @param name The name of an input or output variable of the backing model.
+             * @return The handle of the variable, or ``-1`` if it has none, in which case its values are accessed by name.
+             */
+            virtual int GetVarIndex(const std::string &name) {
+                return -1;
+            }
+
+            /**
+             * Get value(s) for a variable by its handle from @ref GetVarIndex, as with ``GetValue``.
+             *
+             * @throws runtime_error If the backing model doesn't support access by handle.
+             */
+            virtual void GetValueByIndex(int index, void *dest) {
+                throw runtime_error(model_name + " has no variable handles to get values by");
+            }
+
+            /**
+             * Get a pointer to the values of a variable by its handle from @ref GetVarIndex, as with ``GetValuePtr``.
+             *
+             * @throws runtime_error If the backing model doesn't support access by handle.
+             */
+            virtual void *GetValuePtrByIndex(int index) {
+                throw runtime_error(model_name + " has no variable handles to get value pointers by");
+            }
+
+            /**
+             * Set value(s) for a variable by its handle from @ref GetVarIndex, as with ``SetValue``.
+             *
+             * @throws runtime_error If the backing model doesn't support access by handle.
+             */
+            virtual void SetValueByIndex(int index, void *src) {
+                throw runtime_error(model_name + " has no variable handles to set values by");
+            }
+
             /**
              * Initialize the wrapped BMI model functionality using the value from the `bmi_init_config` member variable
              * and the API's ``Initialize`` function.
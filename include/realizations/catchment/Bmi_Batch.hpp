@@ -0,0 +1,198 @@
+#ifndef NGEN_BMI_BATCH_HPP
+#define NGEN_BMI_BATCH_HPP
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Bmi_Formulation.hpp"
+#include "GenericDataProvider.hpp"
+
+namespace realization {
+
+    /**
+     * A single BMI model instance run for a batch of catchments, which are the cells of its 1-D unstructured grid.
+     *
+     * The backing formulation is updated once per time step for the whole batch, the first time any catchment of the
+     * batch needs that time step.  The response and output values of every catchment are then kept until all
+     * catchments of the batch have moved past that time step, so catchments may run a few time steps apart (e.g., with
+     * execution lookahead).
+     *
+     * Instances are safe to use from several threads at once; calls are serialized.
+     *
+     * @see Bmi_Batched_Formulation
+     */
+    class Bmi_Batch {
+
+    public:
+
+        /**
+         * Create a batch, putting the formulation into batched mode for the given catchments.
+         *
+         * @param formulation A created BMI formulation, whose model is initialized for all the catchments.
+         * @param catchment_ids The ids of the catchments of the batch, in the order of the model's grid cells.
+         * @param forcings The forcing provider of each catchment, in the same order.
+         */
+        Bmi_Batch(std::shared_ptr<Bmi_Formulation> formulation, std::vector<std::string> catchment_ids,
+                  const std::vector<std::shared_ptr<data_access::GenericDataProvider>> &forcings)
+            : formulation(std::move(formulation)), catchment_ids(std::move(catchment_ids)),
+              member_steps(this->catchment_ids.size(), -1)
+        {
+            this->formulation->set_batch_members(this->catchment_ids, forcings);
+        }
+
+        const std::shared_ptr<Bmi_Formulation> &get_formulation() const {
+            return formulation;
+        }
+
+        const std::vector<std::string> &get_catchment_ids() const {
+            return catchment_ids;
+        }
+
+        size_t size() const {
+            return catchment_ids.size();
+        }
+
+        /**
+         * Get the response of one catchment of the batch for a time step, updating the model if needed.
+         *
+         * @param member The index of the catchment in the batch.
+         * @param t_index The index of the time step.
+         * @param t_delta The duration, in seconds, of the time step.
+         * @return The value of the main output variable for the catchment.
+         * @throws std::invalid_argument If the time step was already released by every catchment of the batch.
+         */
+        double get_response(size_t member, Formulation::time_step_t t_index, Formulation::time_step_t t_delta) {
+            std::lock_guard<std::mutex> lock(mutex);
+            run_to(t_index, t_delta);
+            release_steps(member, t_index);
+            return get_step(t_index).responses[member];
+        }
+
+        /**
+         * Get the output variable values of one catchment of the batch for a processed time step.
+         *
+         * @param member The index of the catchment in the batch.
+         * @param t_index The index of the time step.
+         * @param values Set to the values, in the order of the formulation's output variables.
+         * @throws std::invalid_argument If the time step has not been processed, or was released.
+         */
+        void get_output_values(size_t member, Formulation::time_step_t t_index, std::vector<double> &values) {
+            std::lock_guard<std::mutex> lock(mutex);
+            const StepValues &step = get_step(t_index);
+            values.resize(step.outputs.size());
+            for (size_t i = 0; i < step.outputs.size(); ++i) {
+                values[i] = step.outputs[i][member];
+            }
+        }
+
+        /**
+         * Save the state of the batch's model for a checkpoint, along with the last processed time step.
+         *
+         * The kept values of processed time steps are not saved, as a checkpoint is only taken once every catchment
+         * has written its output for the last processed time step.
+         */
+        void save_state(utils::StateWriter &out) {
+            std::lock_guard<std::mutex> lock(mutex);
+            out.write<int64_t>(last_step);
+            formulation->save_state(out);
+        }
+
+        /** Restore state saved by @ref save_state, as if every catchment had processed the saved time step. */
+        void load_state(utils::StateReader &in) {
+            std::lock_guard<std::mutex> lock(mutex);
+            last_step = static_cast<Formulation::time_step_t>(in.read<int64_t>());
+            formulation->load_state(in);
+            steps.clear();
+            std::fill(member_steps.begin(), member_steps.end(), last_step);
+        }
+
+        /** Restore state saved by @ref save_state at the end of another run, as if no time step was processed. */
+        void load_initial_state(utils::StateReader &in) {
+            std::lock_guard<std::mutex> lock(mutex);
+            in.read<int64_t>();
+            formulation->load_initial_state(in);
+            last_step = -1;
+            steps.clear();
+            std::fill(member_steps.begin(), member_steps.end(), last_step);
+        }
+
+    private:
+
+        /** The values of every catchment of the batch for one processed time step. */
+        struct StepValues {
+            std::vector<double> responses;
+            /** Values of each formulation output variable, each indexed by catchment. */
+            std::vector<std::vector<double>> outputs;
+            /** How many catchments have since requested later time steps. */
+            size_t released = 0;
+        };
+
+        /** Update the model one time step at a time up to @p t_index, keeping the values of each time step. */
+        void run_to(Formulation::time_step_t t_index, Formulation::time_step_t t_delta) {
+            while (last_step < t_index) {
+                formulation->get_response(last_step + 1, t_delta);
+                StepValues &step = steps[++last_step];
+                formulation->get_var_values_as_double(formulation->get_bmi_main_output_var(), step.responses);
+                check_size(formulation->get_bmi_main_output_var(), step.responses);
+                const std::vector<std::string> &output_names = formulation->get_output_variable_names();
+                step.outputs.resize(output_names.size());
+                for (size_t i = 0; i < output_names.size(); ++i) {
+                    formulation->get_var_values_as_double(output_names[i], step.outputs[i]);
+                    check_size(output_names[i], step.outputs[i]);
+                }
+            }
+        }
+
+        /** Release the time steps that @p member has now moved past, dropping those every catchment has moved past. */
+        void release_steps(size_t member, Formulation::time_step_t t_index) {
+            Formulation::time_step_t &member_step = member_steps[member];
+            if (t_index <= member_step) {
+                return;
+            }
+            auto it = steps.lower_bound(member_step);
+            while (it != steps.end() && it->first < t_index) {
+                if (++it->second.released == catchment_ids.size()) {
+                    it = steps.erase(it);
+                }
+                else {
+                    ++it;
+                }
+            }
+            member_step = t_index;
+        }
+
+        const StepValues &get_step(Formulation::time_step_t t_index) const {
+            auto it = steps.find(t_index);
+            if (it == steps.end()) {
+                throw std::invalid_argument("Values of time step " + std::to_string(t_index) + " are not available from "
+                                            "the batch of " + formulation->get_model_type_name() + " starting with " +
+                                            catchment_ids[0] + ".");
+            }
+            return it->second;
+        }
+
+        void check_size(const std::string &var_name, const std::vector<double> &values) const {
+            if (values.size() != catchment_ids.size()) {
+                throw std::runtime_error(formulation->get_model_type_name() + " variable " + var_name + " has " +
+                                         std::to_string(values.size()) + " values, but its batch has " +
+                                         std::to_string(catchment_ids.size()) + " catchments.");
+            }
+        }
+
+        std::shared_ptr<Bmi_Formulation> formulation;
+        std::vector<std::string> catchment_ids;
+        /** The last time step each catchment requested. */
+        std::vector<Formulation::time_step_t> member_steps;
+        std::map<Formulation::time_step_t, StepValues> steps;
+        Formulation::time_step_t last_step = -1;
+        std::mutex mutex;
+
+    };
+}
+
+#endif //NGEN_BMI_BATCH_HPP
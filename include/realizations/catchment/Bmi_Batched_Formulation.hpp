@@ -0,0 +1,109 @@
+#ifndef NGEN_BMI_BATCHED_FORMULATION_HPP
+#define NGEN_BMI_BATCHED_FORMULATION_HPP
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Bmi_Batch.hpp"
+#include "Catchment_Formulation.hpp"
+#include "GenericDataProvider.hpp"
+
+namespace realization {
+
+    /**
+     * The formulation of one catchment of a @ref Bmi_Batch, which runs a single BMI model for all its catchments.
+     *
+     * Responses and output values are those of the catchment's cell in the batch's model.  Instances are created for
+     * an existing batch, rather than from config with ``create_formulation``.
+     */
+    class Bmi_Batched_Formulation : public Catchment_Formulation {
+
+    public:
+
+        Bmi_Batched_Formulation(std::string id, std::shared_ptr<data_access::GenericDataProvider> forcing,
+                                utils::StreamHandler output_stream, std::shared_ptr<Bmi_Batch> batch, size_t batch_index)
+            : Catchment_Formulation(std::move(id), std::move(forcing), output_stream), batch(std::move(batch)),
+              batch_index(batch_index) { }
+
+        std::string get_formulation_type() override {
+            return "bmi_batched";
+        }
+
+        const std::shared_ptr<Bmi_Batch> &get_batch() const {
+            return batch;
+        }
+
+        size_t get_batch_index() const {
+            return batch_index;
+        }
+
+        /** Any ET is calculated within the batch's model, for all its catchments. */
+        double calc_et() override {
+            return 0.0;
+        }
+
+        double get_response(time_step_t t_index, time_step_t t_delta) override {
+            return batch->get_response(batch_index, t_index, t_delta);
+        }
+
+        std::string get_output_header_line(std::string delimiter) override {
+            return batch->get_formulation()->get_output_header_line(delimiter);
+        }
+
+        std::string get_output_line_for_timestep(int timestep, std::string delimiter) override {
+            std::vector<double> values;
+            get_output_values_for_timestep(timestep, values);
+            return format_output_values(values, delimiter);
+        }
+
+        bool get_output_values_for_timestep(int timestep, std::vector<double> &values) override {
+            batch->get_output_values(batch_index, timestep, values);
+            return true;
+        }
+
+        OutputFormat get_output_format() const override {
+            return batch->get_formulation()->get_output_format();
+        }
+
+        const std::vector<std::string> &get_required_parameters() override {
+            return batch->get_formulation()->get_required_parameters();
+        }
+
+        /** The batch's state is saved once, with the state of its first catchment. */
+        void save_state(utils::StateWriter &out) override {
+            if (batch_index == 0) {
+                batch->save_state(out);
+            }
+        }
+
+        void load_state(utils::StateReader &in) override {
+            if (batch_index == 0) {
+                batch->load_state(in);
+            }
+        }
+
+        void load_initial_state(utils::StateReader &in) override {
+            if (batch_index == 0) {
+                batch->load_initial_state(in);
+            }
+        }
+
+        void create_formulation(boost::property_tree::ptree &config, geojson::PropertyMap *global = nullptr) override {
+            throw std::runtime_error("Batched BMI formulations are created for an existing batch, not from config.");
+        }
+
+        void create_formulation(geojson::PropertyMap properties) override {
+            throw std::runtime_error("Batched BMI formulations are created for an existing batch, not from config.");
+        }
+
+    private:
+
+        std::shared_ptr<Bmi_Batch> batch;
+        size_t batch_index;
+
+    };
+}
+
+#endif //NGEN_BMI_BATCHED_FORMULATION_HPP
@@ -6,6 +6,7 @@
 #include "AbstractCLibBmiAdapter.hpp"
 #include "bmi.h"
 #include "JSONProperty.hpp"
+#include "Static_Bmi_C_Modules.hpp"
 #include "StreamHandler.hpp"
 
 // Forward declaration to provide access to protected items in testing
@@ -463,6 +464,7 @@ namespace models {
              */
             void construct_and_init_backing_model() override {
                 construct_and_init_backing_model_for_type();
+                snapshot_variable_metadata();
             }
 
             /**
@@ -471,8 +473,18 @@ namespace models {
              * Integrated BMI module libraries are expected to provide an additional ``register_bmi`` function. This
              * essentially works like a constructor (or factory) for the model struct.  It accepts a pointer to a BMI C
              * struct and then sets the appropriate function pointer member values of the struct.
+             *
+             * A module linked into the executable is registered directly, without loading its library.
+             *
+             * @see find_static_bmi_c_module
              */
             inline void execModuleRegistration() {
+                Bmi_C_Registration_Function static_register_bmi =
+                        find_static_bmi_c_module(get_bmi_registration_function());
+                if (static_register_bmi != nullptr) {
+                    static_register_bmi(bmi_model.get());
+                    return;
+                }
                 if (get_dyn_lib_handle() == nullptr) {
                     dynamic_library_load();
                 }
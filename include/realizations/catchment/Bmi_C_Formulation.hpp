@@ -52,6 +52,17 @@ namespace realization {
          */
         std::string get_output_line_for_timestep(int timestep, std::string delimiter) override;
 
+        /**
+         * Get the output variable values for the given time step, in the order of @ref get_output_line_for_timestep.
+         *
+         * As with @ref get_output_line_for_timestep, only the last processed time step is accessible.
+         *
+         * @param timestep The time step for which data is desired.
+         * @param values Set to the output variable values for the given time step.
+         * @return ``true``, as this type always provides numeric output.
+         */
+        bool get_output_values_for_timestep(int timestep, std::vector<double> &values) override;
+
         /**
          * Get the model response for a time step.
          *
@@ -92,6 +103,20 @@ namespace realization {
 
         bool is_bmi_output_variable(const std::string &var_name) override;
 
+        /** Save the model's configured state variables and the index of the next time step to process. */
+        void save_state(utils::StateWriter &out) override {
+            save_bmi_state(out, next_time_step_index);
+        }
+
+        void load_state(utils::StateReader &in) override {
+            next_time_step_index = load_bmi_state(in);
+        }
+
+        void load_initial_state(utils::StateReader &in) override {
+            load_bmi_state(in);
+            next_time_step_index = 0;
+        }
+
     protected:
 
         /**
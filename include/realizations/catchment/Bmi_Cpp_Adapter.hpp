@@ -5,6 +5,7 @@
 #include <string>
 #include "AbstractCLibBmiAdapter.hpp"
 #include "bmi.hpp"
+#include "bmi_indexed.hpp"
 #include "JSONProperty.hpp"
 #include "StreamHandler.hpp"
 
@@ -250,6 +251,33 @@ namespace models {
                 return bmi_model->GetValuePtr(name);
             }
 
+            /**
+             * Get the handle of a variable, when the backing model implements ``bmi::BmiIndexed``.
+             *
+             * @param name The name of an input or output variable of the backing model.
+             * @return The handle of the variable, or ``-1`` if the model has no handles or no such variable.
+             */
+            int GetVarIndex(const std::string &name) override {
+                return indexed_model == nullptr ? -1 : indexed_model->GetVarIndex(name);
+            }
+
+            void GetValueByIndex(int index, void *dest) override {
+                indexed_model->GetValueByIndex(index, dest);
+            }
+
+            void *GetValuePtrByIndex(int index) override {
+                return indexed_model->GetValuePtrByIndex(index);
+            }
+
+            void SetValueByIndex(int index, void *src) override {
+                indexed_model->SetValueByIndex(index, src);
+            }
+
+            /** @return Whether the backing model implements ``bmi::BmiIndexed``, so its variables have handles. */
+            bool is_indexed() const {
+                return indexed_model != nullptr;
+            }
+
             int GetVarItemsize(std::string name) override;
 
             int GetVarNbytes(std::string name) override;
@@ -379,6 +407,8 @@ namespace models {
                              */
                         }
                     );
+                    // Models may also let variables be accessed by handle, which is then preferred to their names
+                    indexed_model = dynamic_cast<::bmi::BmiIndexed*>(bmi_model.get());
                 }
                 catch (const ::external::ExternalIntegrationException &e) {
                     // "Override" the default message in this case
@@ -425,6 +455,8 @@ namespace models {
 
             std::string model_create_fname;
             std::string model_destroy_fname;
+            /** The backing model, as a ``bmi::BmiIndexed`` if it implements that, else ``nullptr``. */
+            ::bmi::BmiIndexed *indexed_model = nullptr;
 
             /**
              * Construct the backing BMI model object, then call its BMI-native ``Initialize()`` function.
@@ -465,6 +497,7 @@ namespace models {
                     ModelDestroyer dynamic_destroyer;
                     void* symbol = dynamic_load_symbol(model_destroy_fname);
                     dynamic_destroyer = (ModelDestroyer) symbol;
+                    indexed_model = nullptr;
                     dynamic_destroyer(this->bmi_model.get());
                 }
            }
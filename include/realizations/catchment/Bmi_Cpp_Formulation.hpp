@@ -22,12 +22,36 @@ namespace realization {
 
         std::string get_output_line_for_timestep(int timestep, std::string delimiter) override;
 
+        bool get_output_values_for_timestep(int timestep, std::vector<double> &values) override;
+
+        OutputFormat get_output_format() const override;
+
         double get_response(time_step_t t_index, time_step_t t_delta) override;
 
         bool is_bmi_input_variable(const std::string &var_name) override;
 
         bool is_bmi_output_variable(const std::string &var_name) override;
 
+        /** Save the model's configured state variables and the index of the next time step to process. */
+        void save_state(utils::StateWriter &out) override {
+            save_bmi_state(out, next_time_step_index);
+        }
+
+        void load_state(utils::StateReader &in) override {
+            next_time_step_index = load_bmi_state(in);
+        }
+
+        void load_initial_state(utils::StateReader &in) override {
+            load_bmi_state(in);
+            next_time_step_index = 0;
+        }
+
+        /** Free the model, along with the variables resolved against it. */
+        void release_model() override {
+            var_readers.clear();
+            Bmi_Module_Formulation<models::bmi::Bmi_Cpp_Adapter>::release_model();
+        }
+
     protected:
 
         std::shared_ptr<models::bmi::Bmi_Cpp_Adapter> construct_model(const geojson::PropertyMap& properties) override;
@@ -58,7 +82,21 @@ namespace realization {
 
     private:
 
+        /** How a variable of the model is read as a double, resolved on the first read of it. */
+        struct VarReader {
+            /** The variable's handle, where the model implements ``bmi::BmiIndexed``, else ``-1``. */
+            int var_index = -1;
+            bool is_long_double = false;
+            /** The variable's type, unless it is ``long double``. */
+            InputValueType type = InputValueType::DOUBLE;
+        };
+
+        /** Get the reader of a variable, resolving it on the first read of it. */
+        const VarReader &get_var_reader(const std::string &var_name);
+
         int next_time_step_index = 0;
+        /** How each variable read as a double is read, by name. */
+        std::unordered_map<std::string, VarReader> var_readers;
 
     };
 
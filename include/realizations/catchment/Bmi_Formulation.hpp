@@ -8,6 +8,9 @@
 #include <memory>
 #include "Catchment_Formulation.hpp"
 #include "GenericDataProvider.hpp"
+#include "AorcForcing.hpp"
+#include <NumberFormat.hpp>
+#include <SharedBlock.hpp>
 
 // Define the configuration parameter names used in the realization/formulation config JSON file
 // First the required:
@@ -26,6 +29,12 @@
 #define BMI_REALIZATION_CFG_PARAM_OPT__ALLOW_EXCEED_END "allow_exceed_end_time"
 #define BMI_REALIZATION_CFG_PARAM_OPT__FIXED_TIME_STEP "fixed_time_step"
 #define BMI_REALIZATION_CFG_PARAM_OPT__LIB_FILE "library_file"
+#define BMI_REALIZATION_CFG_PARAM_OPT__BATCH_SIZE "batch_size"
+#define BMI_REALIZATION_CFG_PARAM_OPT__CHECKPOINT_VARS "checkpoint_variables"
+#define BMI_REALIZATION_CFG_PARAM_OPT__INPUTS_IN_PLACE "set_inputs_in_place"
+#define BMI_REALIZATION_CFG_PARAM_OPT__PARAMS_TABLE "model_params_table"
+#define BMI_REALIZATION_CFG_PARAM_OPT__INIT_CONFIG_TEMPLATE "init_config_template"
+#define BMI_REALIZATION_CFG_PARAM_OPT__INIT_CONFIG_DIR "init_config_dir"
 #define BMI_REALIZATION_CFG_PARAM_OPT__PYTHON_TYPE_NAME "python_type"
 #define BMI_REALIZATION_CFG_PARAM_OPT__PYTHON_MODULE_PATH "module_path"
 #define BMI_REALIZATION_CFG_PARAM_OPT__REGISTRATION_FUNC "registration_function"
@@ -34,14 +43,7 @@
 #define BMI_REALIZATION_CFG_PARAM_OPT__CPP_CREATE_FUNC_DEFAULT "bmi_model_create"
 #define BMI_REALIZATION_CFG_PARAM_OPT__CPP_DESTROY_FUNC_DEFAULT "bmi_model_destroy"
 
-// Supported Standard Names for BMI variables
-// This is needed to provide a calculated potential ET value back to a BMI model
-#define NGEN_STD_NAME_POTENTIAL_ET_FOR_TIME_STEP "potential_evapotranspiration"
-
-// Taken from the CSDMS Standard Names list
-// TODO: need to add these in for anything BMI model input or output variables we need to know how to recognize
-#define CSDMS_STD_NAME_POTENTIAL_ET "water_potential_evaporation_flux"
-/* *************** See also the Forcing.h file for several CSDMS Standard Names definitions *************** */
+/* *************** See the AorcForcing.hpp file for the potential ET and several CSDMS Standard Names *************** */
 
 // Forward declaration to provide access to protected items in testing
 class Bmi_Formulation_Test;
@@ -49,6 +51,10 @@ class Bmi_C_Formulation_Test;
 class Bmi_C_Cfe_IT;
 class Bmi_C_Pet_IT;
 
+namespace bmi {
+    class Bmi;
+}
+
 using namespace std;
 
 namespace realization {
@@ -117,6 +123,50 @@ namespace realization {
 
         virtual const vector<string> get_bmi_output_variables() = 0;
 
+        /**
+         * Get the backing model whose BMI output variable holds the given provided output, if it can be read directly.
+         *
+         * This lets another formulation read the output's values in place, rather than through ``get_values``.
+         *
+         * @param output_name The name, or config mapped alias, of the output as provided by this instance.
+         * @param bmi_var_name Set to the name of the backing model's BMI output variable, when there is one.
+         * @param cxx_type Set to the name of the C++ type analogous to the type of that variable, when there is one.
+         * @return The backing model holding the output, or ``nullptr`` if it cannot be read directly.
+         */
+        virtual ::bmi::Bmi *get_bmi_output_source(const std::string &output_name, std::string &bmi_var_name,
+                                                  std::string &cxx_type) {
+            return nullptr;
+        }
+
+        /**
+         * Get all values of a BMI variable of the backing model, as doubles.
+         *
+         * For a model run in batched mode (see @ref set_batch_members), these are the values for each catchment of the
+         * batch, in the order of the batch's catchments.
+         *
+         * @param var_name The name of the BMI variable, or a config mapped alias of it.
+         * @param values Set to the values of the variable.
+         * @throws std::runtime_error If the type does not support this.
+         */
+        virtual void get_var_values_as_double(const std::string &var_name, std::vector<double> &values) {
+            throw std::runtime_error(get_formulation_type() + " does not support getting all values of a variable.");
+        }
+
+        /**
+         * Run the backing model for a batch of catchments, treating them as the cells of a 1-D unstructured grid.
+         *
+         * Each input variable of the model is then expected to hold one value for each catchment, in the given order,
+         * which are read from each catchment's forcing provider before every update.
+         *
+         * @param catchment_ids The ids of the catchments of the batch, in the order of the model's grid cells.
+         * @param forcings The forcing provider of each catchment, in the same order.
+         * @throws std::runtime_error If the type does not support batched execution.
+         */
+        virtual void set_batch_members(const std::vector<std::string> &catchment_ids,
+                                       const std::vector<std::shared_ptr<data_access::GenericDataProvider>> &forcings) {
+            throw std::runtime_error(get_formulation_type() + " does not support batched execution.");
+        }
+
         /**
          * When possible, translate a variable name for a BMI model to an internally recognized name.
          *
@@ -156,7 +206,7 @@ namespace realization {
          * @return The values making up the header line from get_output_header_line() organized as a vector.
          */
         const vector<std::string> &get_output_header_fields() const {
-            return output_header_fields;
+            return *output_header_fields;
         }
 
         /**
@@ -181,10 +231,16 @@ namespace realization {
          */
         // TODO: rename this function to make it more clear it is FORMULATION output contents, not simply BMI variables
         const vector<string> &get_output_variable_names() const {
-            return output_variable_names;
+            return *output_variable_names;
         }
 
         const vector<std::string> &get_required_parameters() override {
+            static const std::vector<std::string> REQUIRED_PARAMETERS = {
+                    BMI_REALIZATION_CFG_PARAM_REQ__INIT_CONFIG,
+                    BMI_REALIZATION_CFG_PARAM_REQ__MAIN_OUT_VAR,
+                    BMI_REALIZATION_CFG_PARAM_REQ__MODEL_TYPE,
+                    BMI_REALIZATION_CFG_PARAM_REQ__USES_FORCINGS
+            };
             return REQUIRED_PARAMETERS;
         }
 
@@ -220,20 +276,37 @@ namespace realization {
          */
         void set_output_precision(int precision) {
             output_precision = precision;
-            output_text_stream = std::make_shared<std::ostringstream>();
-            *output_text_stream << std::fixed;
-            *output_text_stream << std::setprecision(output_precision);
         }
 
-    protected:
+        /**
+         * @return The format of output values, with the fixed number of decimal places of @ref set_output_precision.
+         */
+        OutputFormat get_output_format() const override {
+            OutputFormat format;
+            format.precision = output_precision;
+            return format;
+        }
 
-        /** Object to help with converting numeric output values to text. */
-        std::shared_ptr<std::ostringstream> output_text_stream;
+    protected:
 
         int get_output_precision() {
             return output_precision;
         }
 
+        /**
+         * Copy what a formulation of the same type took from its configuration properties, sharing its blocks of
+         * configuration.
+         *
+         * @param prototype The formulation.
+         */
+        void copy_configuration(const Bmi_Formulation &prototype) {
+            bmi_main_output_var = prototype.bmi_main_output_var;
+            model_type_name = prototype.model_type_name;
+            output_header_fields = prototype.output_header_fields;
+            output_variable_names = prototype.output_variable_names;
+            output_precision = prototype.output_precision;
+        }
+
         void set_bmi_main_output_var(const string &main_output_var) {
             bmi_main_output_var = main_output_var;
         }
@@ -269,33 +342,17 @@ namespace realization {
         std::string model_type_name;
         /**
          * Output header field strings corresponding to the variables output by the realization, as defined in
-         * `output_variable_names`.
+         * `output_variable_names`, shared with the formulations configured alike.
          */
-        std::vector<std::string> output_header_fields;
+        utils::SharedBlock<std::vector<std::string>> output_header_fields;
         /**
          * Names of the variables to include in the output from this formulation, which will be some ordered subset of
-         * the BMI module output variables accessible to the instance.
+         * the BMI module output variables accessible to the instance, shared with the formulations configured alike.
          */
-        std::vector<std::string> output_variable_names;
+        utils::SharedBlock<std::vector<std::string>> output_variable_names;
         /** The degree of precision in output values when converting to text. */
         int output_precision;
 
-        std::vector<std::string> OPTIONAL_PARAMETERS = {
-                BMI_REALIZATION_CFG_PARAM_OPT__FORCING_FILE,
-                BMI_REALIZATION_CFG_PARAM_OPT__VAR_STD_NAMES,
-                BMI_REALIZATION_CFG_PARAM_OPT__OUT_VARS,
-                BMI_REALIZATION_CFG_PARAM_OPT__OUT_HEADER_FIELDS,
-                BMI_REALIZATION_CFG_PARAM_OPT__ALLOW_EXCEED_END,
-                BMI_REALIZATION_CFG_PARAM_OPT__FIXED_TIME_STEP,
-                BMI_REALIZATION_CFG_PARAM_OPT__LIB_FILE
-        };
-        std::vector<std::string> REQUIRED_PARAMETERS = {
-                BMI_REALIZATION_CFG_PARAM_REQ__INIT_CONFIG,
-                BMI_REALIZATION_CFG_PARAM_REQ__MAIN_OUT_VAR,
-                BMI_REALIZATION_CFG_PARAM_REQ__MODEL_TYPE,
-                BMI_REALIZATION_CFG_PARAM_REQ__USES_FORCINGS
-        };
-
         // Unit test access
         friend class ::Bmi_Formulation_Test;
         friend class ::Bmi_C_Formulation_Test;
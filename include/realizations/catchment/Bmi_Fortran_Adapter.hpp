@@ -7,6 +7,10 @@
 #include "Bmi_Fortran_Common.h"
 #include "bmi.h"
 
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
 // Forward declaration to provide access to protected items in testing
 class Bmi_Fortran_Adapter_Test;
 
@@ -49,6 +53,7 @@ namespace models {
                     // Make sure this is set to 'true' after this function call finishes
                     model_initialized = true;
                     acquire_time_conversion_factor(bmi_model_time_convert_factor);
+                    snapshot_variable_metadata();
                 }
                     // Record the exception message before re-throwing to handle subsequent function calls properly
                 catch( models::external::State_Exception& e)
@@ -408,6 +413,58 @@ namespace models {
                 SetValueAtIndices(name, inds.data(), inds.size(), static_cast<void *>(src.data()));
             }
 
+            /**
+             * Get all the values of a variable, as values of the given type, in a single bulk transfer.
+             *
+             * When the variable's Fortran type matches @p T, the destination is passed straight to the module's typed
+             * getter.  Otherwise the values are received in their Fortran type and converted in one pass.
+             *
+             * @tparam T The type to get the values as.
+             * @param name The name of the variable.
+             * @param dest The destination for the values.
+             * @param count The number of values the destination holds, which must be the variable's number of values.
+             */
+            template<class T>
+            void get_values_as(const std::string &name, T *dest, size_t count) {
+                switch (inner_get_value_kind(name, count)) {
+                    case Fortran_Value_Kind::INT:
+                        inner_get_values_as<int>(name, dest, count, &Bmi_Fortran_Adapter::inner_get_value_int);
+                        break;
+                    case Fortran_Value_Kind::FLOAT:
+                        inner_get_values_as<float>(name, dest, count, &Bmi_Fortran_Adapter::inner_get_value_float);
+                        break;
+                    case Fortran_Value_Kind::DOUBLE:
+                        inner_get_values_as<double>(name, dest, count, &Bmi_Fortran_Adapter::inner_get_value_double);
+                        break;
+                }
+            }
+
+            /**
+             * Set all the values of a variable, from values of the given type, in a single bulk transfer.
+             *
+             * When the variable's Fortran type matches @p T, the source is passed straight to the module's typed
+             * setter.  Otherwise the values are converted to the Fortran type in one pass first.
+             *
+             * @tparam T The type of the source values.
+             * @param name The name of the variable.
+             * @param src The source values.
+             * @param count The number of source values, which must be the variable's number of values.
+             */
+            template<class T>
+            void set_values_from(const std::string &name, const T *src, size_t count) {
+                switch (inner_get_value_kind(name, count)) {
+                    case Fortran_Value_Kind::INT:
+                        inner_set_values_from<int>(name, src, count, &Bmi_Fortran_Adapter::inner_set_value_int);
+                        break;
+                    case Fortran_Value_Kind::FLOAT:
+                        inner_set_values_from<float>(name, src, count, &Bmi_Fortran_Adapter::inner_set_value_float);
+                        break;
+                    case Fortran_Value_Kind::DOUBLE:
+                        inner_set_values_from<double>(name, src, count, &Bmi_Fortran_Adapter::inner_set_value_double);
+                        break;
+                }
+            }
+
             /**
              * Have the backing model update to next time step.
              *
@@ -443,6 +500,7 @@ namespace models {
              */
             void construct_and_init_backing_model() override {
                 construct_and_init_backing_model_for_fortran();
+                snapshot_variable_metadata();
             }
 
             /**
@@ -563,21 +621,97 @@ namespace models {
              * @param dest A float pointer in which to return the values.
              */
             inline void inner_get_value(const std::string& name, void *dest) {
-                std::string varType = inner_get_var_type(name);
+                switch (inner_get_value_kind(name)) {
+                    case Fortran_Value_Kind::INT:
+                        inner_get_value_int(name, (int *)dest);
+                        break;
+                    case Fortran_Value_Kind::FLOAT:
+                        inner_get_value_float(name, (float *)dest);
+                        break;
+                    case Fortran_Value_Kind::DOUBLE:
+                        inner_get_value_double(name, (double *)dest);
+                        break;
+                }
+            }
+
+            /** The kinds of values the Fortran module has separate getters and setters for. */
+            enum class Fortran_Value_Kind { INT, FLOAT, DOUBLE };
+
+            /**
+             * Get which of the Fortran module's getters and setters are for the given variable.
+             *
+             * The variable's type is taken from its recorded metadata where there is any, so that a transfer needs no
+             * more calls into the module than the transfer itself.
+             *
+             * @param name The name of the variable.
+             * @return The kind of the variable's values.
+             * @throws ExternalIntegrationException If the variable is of a type without getters and setters.
+             */
+            inline Fortran_Value_Kind inner_get_value_kind(const std::string& name) {
+                const Variable_Metadata *metadata = find_variable_metadata(name);
+                std::string varType = metadata != nullptr && metadata->has_type ? metadata->type : inner_get_var_type(name);
                 //Can use the C type or the fortran type, e.g. int or integer
                 if (varType == "int" || varType == "integer") {
-                    inner_get_value_int(name, (int *)dest);
+                    return Fortran_Value_Kind::INT;
                 }
-                else if (varType == "float" || varType == "real") {
-                    inner_get_value_float(name, (float *)dest);
+                if (varType == "float" || varType == "real") {
+                    return Fortran_Value_Kind::FLOAT;
                 }
-                else if (varType == "double" || varType == "double precision") {
-                    inner_get_value_double(name, (double *)dest);
+                if (varType == "double" || varType == "double precision") {
+                    return Fortran_Value_Kind::DOUBLE;
                 }
-                else {
-                    throw ::external::ExternalIntegrationException(
-                            "Can't get model " + model_name + " variable " + name + " of type '" + varType + ".");
+                throw ::external::ExternalIntegrationException(
+                        "Can't get model " + model_name + " variable " + name + " of type '" + varType + ".");
+            }
+
+            /**
+             * Get the kind of a variable's values, also making sure a bulk transfer has room for all of them.
+             *
+             * @param name The name of the variable.
+             * @param count The number of values being transferred.
+             * @return The kind of the variable's values.
+             */
+            Fortran_Value_Kind inner_get_value_kind(const std::string& name, size_t count) {
+                int item_size = GetVarItemsize(name);
+                size_t item_count = item_size > 0 ? (size_t) (GetVarNbytes(name) / item_size) : 0;
+                if (count != item_count) {
+                    throw std::runtime_error("Cannot transfer " + std::to_string(count) + " values for the " +
+                                             std::to_string(item_count) + " values of " + name + " variable of " +
+                                             model_name);
+                }
+                return inner_get_value_kind(name);
+            }
+
+            /**
+             * Get the values of a variable of Fortran type @p N as values of type @p T, passing the destination
+             * straight to the getter when the types are the same.
+             */
+            template<class N, class T>
+            void inner_get_values_as(const std::string& name, T *dest, size_t count,
+                                     void (Bmi_Fortran_Adapter::*getter)(const std::string&, N *)) {
+                if (std::is_same<N, T>::value) {
+                    (this->*getter)(name, reinterpret_cast<N *>(dest));
+                    return;
                 }
+                std::vector<N> native(count);
+                (this->*getter)(name, native.data());
+                std::copy(native.begin(), native.end(), dest);
+            }
+
+            /**
+             * Set the values of a variable of Fortran type @p N from values of type @p T, passing the source straight
+             * to the setter when the types are the same.
+             */
+            template<class N, class T>
+            void inner_set_values_from(const std::string& name, const T *src, size_t count,
+                                       void (Bmi_Fortran_Adapter::*setter)(const std::string&, N *)) {
+                if (std::is_same<N, T>::value) {
+                    // The module's setters copy from, but do not modify, their source
+                    (this->*setter)(name, reinterpret_cast<N *>(const_cast<T *>(src)));
+                    return;
+                }
+                std::vector<N> native(src, src + count);
+                (this->*setter)(name, native.data());
             }
 
             /**
@@ -718,20 +852,16 @@ namespace models {
              * @param dest A pointer that should be passed to the analogous BMI setter of the Fortran module.
              */
             inline void inner_set_value(const std::string& name, void *src) {
-                std::string varType = inner_get_var_type(name);
-                //Can use the C type or the fortran type, e.g. int or integer
-                if (varType == "int" || varType == "integer") {
-                    inner_set_value_int(name, (int *)src);
-                }
-                else if (varType == "float" || varType == "real") {
-                    inner_set_value_float(name, (float *)src);
-                }
-                else if (varType == "double" || varType == "double precision") {
-                    inner_set_value_double(name, (double *)src);
-                }
-                else {
-                    throw ::external::ExternalIntegrationException(
-                            "Can't get model " + model_name + " variable " + name + " of type '" + varType + ".");
+                switch (inner_get_value_kind(name)) {
+                    case Fortran_Value_Kind::INT:
+                        inner_set_value_int(name, (int *)src);
+                        break;
+                    case Fortran_Value_Kind::FLOAT:
+                        inner_set_value_float(name, (float *)src);
+                        break;
+                    case Fortran_Value_Kind::DOUBLE:
+                        inner_set_value_double(name, (double *)src);
+                        break;
                 }
             }
 
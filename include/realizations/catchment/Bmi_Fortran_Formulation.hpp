@@ -48,6 +48,17 @@ namespace realization {
          */
         string get_output_line_for_timestep(int timestep, std::string delimiter) override;
 
+        /**
+         * Get the output variable values for the given time step, in the order of @ref get_output_line_for_timestep.
+         *
+         * As with @ref get_output_line_for_timestep, only the last processed time step is accessible.
+         *
+         * @param timestep The time step for which data is desired.
+         * @param values Set to the output variable values for the given time step.
+         * @return ``true``, as this type always provides numeric output.
+         */
+        bool get_output_values_for_timestep(int timestep, std::vector<double> &values) override;
+
         /**
          * Get the model response for a time step.
          *
@@ -82,6 +93,23 @@ namespace realization {
          */
         double get_response(::time_step_t index, ::time_step_t t_delta) override;
 
+        /** Save the model's configured state variables and the index of the next time step to process. */
+        void save_state(utils::StateWriter &out) override {
+            save_bmi_state(out, next_time_step_index);
+        }
+
+        void load_state(utils::StateReader &in) override {
+            next_time_step_index = load_bmi_state(in);
+        }
+
+        void load_initial_state(utils::StateReader &in) override {
+            load_bmi_state(in);
+            next_time_step_index = 0;
+        }
+
+        /** Get all the values of a variable in one bulk transfer from the module, converting only if not doubles. */
+        void get_var_values_as_double(const std::string &var_name, std::vector<double> &values) override;
+
     protected:
 
         /**
@@ -1,8 +1,15 @@
 #ifndef NGEN_BMI_MODULE_FORMULATION_H
 #define NGEN_BMI_MODULE_FORMULATION_H
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <typeinfo>
 #include <utility>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 #include "Bmi_Formulation.hpp"
 #include "EtCalcProperty.hpp"
 #include "EtCombinationMethod.hpp"
@@ -11,7 +18,13 @@
 #include <AorcForcing.hpp>
 #include <DataProvider.hpp>
 #include <UnitsHelper.hpp>
+#include <Profiler.hpp>
+#include <Logger.hpp>
+#include <AlignedAllocator.hpp>
 #include "bmi_utilities.hpp"
+#include "Init_Config_Template.hpp"
+#include "Parameter_Table.hpp"
+#include <SharedBlock.hpp>
 
 using data_access::MEAN;
 using data_access::SUM;
@@ -230,6 +243,34 @@ namespace realization {
             inner_create_formulation(properties, true);
         }
 
+        bool configure_prototype(const geojson::PropertyMap &properties) override {
+            validate_parameters(properties);
+            configure_formulation(properties);
+            set_model_properties(properties);
+            return true;
+        }
+
+        bool create_from_prototype(const Catchment_Formulation &prototype,
+                                   const geojson::PropertyMap &properties) override {
+            if (typeid(prototype) != typeid(*this)) {
+                return false;
+            }
+            const Bmi_Module_Formulation<M> &configured = static_cast<const Bmi_Module_Formulation<M> &>(prototype);
+            copy_configuration(configured);
+            allow_model_exceed_end_time = configured.allow_model_exceed_end_time;
+            bmi_model_time_step_fixed = configured.bmi_model_time_step_fixed;
+            inputs_in_place = configured.inputs_in_place;
+            bmi_var_names_map = configured.bmi_var_names_map;
+            bmi_using_forcing_file = configured.bmi_using_forcing_file;
+            forcing_file_path = configured.forcing_file_path;
+            checkpoint_variable_names = configured.checkpoint_variable_names;
+            checkpoint_variables_configured = configured.checkpoint_variables_configured;
+            model_properties = configured.model_properties;
+            set_model_property_overrides(properties);
+            initialize_formulation(properties);
+            return true;
+        }
+
         /**
          * Get the collection of forcing output property names this instance can provide.
          *
@@ -248,8 +289,9 @@ namespace realization {
             if (is_model_initialized() && available_forcings.empty()) {
                 for (const std::string &output_var_name : get_bmi_model()->GetOutputVarNames()) {
                     available_forcings.push_back(output_var_name);
-                    if (bmi_var_names_map.find(output_var_name) != bmi_var_names_map.end())
-                        available_forcings.push_back(bmi_var_names_map[output_var_name]);
+                    auto mapped = bmi_var_names_map->find(output_var_name);
+                    if (mapped != bmi_var_names_map->end())
+                        available_forcings.push_back(mapped->second);
                 }
                 available_forcings.emplace_back(NGEN_STD_NAME_POTENTIAL_ET_FOR_TIME_STEP);
                 available_forcings.emplace_back(CSDMS_STD_NAME_POTENTIAL_ET);
@@ -332,6 +374,12 @@ namespace realization {
         }
 
         const vector<std::string> &get_required_parameters() override {
+            static const std::vector<std::string> REQUIRED_PARAMETERS = {
+                    BMI_REALIZATION_CFG_PARAM_REQ__INIT_CONFIG,
+                    BMI_REALIZATION_CFG_PARAM_REQ__MAIN_OUT_VAR,
+                    BMI_REALIZATION_CFG_PARAM_REQ__MODEL_TYPE,
+                    BMI_REALIZATION_CFG_PARAM_REQ__USES_FORCINGS
+            };
             return REQUIRED_PARAMETERS;
         }
 
@@ -351,8 +399,9 @@ namespace realization {
          */
         const std::string &get_config_mapped_variable_name(const std::string &model_var_name) override {
             // TODO: need to introduce validation elsewhere that all mapped names are valid AORC field constants.
-            if (bmi_var_names_map.find(model_var_name) != bmi_var_names_map.end())
-                return bmi_var_names_map[model_var_name];
+            auto mapped = bmi_var_names_map->find(model_var_name);
+            if (mapped != bmi_var_names_map->end())
+                return mapped->second;
             else
                 return model_var_name;
         }
@@ -388,17 +437,13 @@ namespace realization {
          */
         std::vector<double> get_values(const CatchmentAggrDataSelector& selector, data_access::ReSampleMethod m=SUM) override
         {
-            std::string output_name = selector.get_variable_name();
+            const std::string& output_name = selector.get_variable_name();
             time_t init_time = selector.get_init_time();
             long duration_s = selector.get_duration_secs();
-            std::string output_units = selector.get_output_units();
+            const std::string& output_units = selector.get_output_units();
 
-            // First make sure this is an available output
-            //const std::vector<std::string> forcing_outputs = get_available_forcing_outputs();
-            const std::vector<std::string> forcing_outputs = get_avaliable_variable_names();
-            if (std::find(forcing_outputs.begin(), forcing_outputs.end(), output_name) == forcing_outputs.end()) {
-                throw runtime_error(get_formulation_type() + " received invalid output forcing name " + output_name);
-            }
+            // First make sure this is an available output, which the output's reader already has
+            OutputReader &reader = get_output_reader(output_name, output_units);
             // TODO: do this, or something better, later; right now, just assume anything using this as a provider is
             //  consistent with times
             /*
@@ -409,35 +454,65 @@ namespace realization {
             */
 
             // check if output is available from BMI
-            std::string bmi_var_name;
-            get_bmi_output_var_name(output_name, bmi_var_name);
-
-            if( !bmi_var_name.empty() )
+            if( !reader.bmi_var_name.empty() )
             {
-                auto model = get_bmi_model().get();
-                //Get vector of double values for variable
-                //The return type of the vector here dependent on what
-                //needs to use it.  For other BMI moudles, that is runtime dependent
-                //on the type of the requesting module 
-                auto values = models::bmi::GetValue<double>(*model, bmi_var_name);
+                std::vector<double> values;
+                if (reader.is_direct) {
+                    // Read the values in place, rather than having the model copy them out
+                    const void *ptr = get_output_values_ptr(reader);
+                    values.resize(reader.count);
+                    for (size_t i = 0; i < reader.count; ++i) {
+                        values[i] = read_value_as_double(reader.type, ptr, i);
+                    }
+                }
+                else {
+                    //Get vector of double values for variable
+                    //The return type of the vector here dependent on what
+                    //needs to use it.  For other BMI moudles, that is runtime dependent
+                    //on the type of the requesting module
+                    values = models::bmi::GetValue<double>(*get_bmi_model(), reader.bmi_var_name);
+                }
 
                 // Convert units
-                std::string native_units = get_bmi_model()->GetVarUnits(bmi_var_name);
-                try {
-                    UnitsHelper::convert_values(native_units, values.data(), output_units, values.data(), values.size());
-                    return values;
-                }
-                catch (const std::runtime_error& e){
-                    #ifndef UDUNITS_QUIET
-                    std::cerr<<"WARN: Unit conversion unsuccessful - Returning unconverted value! (\""<<e.what()<<"\")"<<std::endl;
-                    #endif
+                if (warn_output_unconverted(reader)) {
                     return values;
                 }
+                reader.converter.convert(values.data(), values.data(), values.size());
+                return values;
             }
             //Fall back to any internal providers as a last resort.
             return check_internal_providers<double>(output_name);
         }
 
+        /**
+         * Get the values of a forcing property, written straight into storage of the given type.
+         *
+         * Output values the model holds in the requested units, as doubles or as the requested type, are read in place
+         * and stored without first being gathered in a vector, those of the requested type with one bulk copy; anything
+         * else goes through @ref get_values.
+         *
+         * @see GenericDataProvider::get_values_into
+         */
+        size_t get_values_into(const CatchmentAggrDataSelector& selector, data_access::ReSampleMethod m,
+                               data_access::ValueType type, void* values, size_t count) override
+        {
+            OutputReader &reader = get_output_reader(selector.get_variable_name(), selector.get_output_units());
+            if (reader.is_direct && reader.conversion_error.empty() && reader.converter.is_identity()) {
+                size_t written = std::min(reader.count, count);
+                if (reader.type == type) {
+                    // The whole array is copied at once, as the receiver holds values of the same type
+                    std::memcpy(values, get_output_values_ptr(reader), written * data_access::value_type_size(type));
+                    return written;
+                }
+                if (reader.type == InputValueType::DOUBLE) {
+                    data_access::store_values(type, static_cast<const double *>(get_output_values_ptr(reader)),
+                                              written, values);
+                    return written;
+                }
+            }
+            return Bmi_Formulation::get_values_into(selector, m, type, values, count);
+        }
+
         /**
          * Get the value of a forcing property for an arbitrary time period, converting units if needed.
          *
@@ -457,17 +532,13 @@ namespace realization {
          */
         double get_value(const CatchmentAggrDataSelector& selector, data_access::ReSampleMethod m) override
         {
-            std::string output_name = selector.get_variable_name();
+            const std::string& output_name = selector.get_variable_name();
             time_t init_time = selector.get_init_time();
             long duration_s = selector.get_duration_secs();
-            std::string output_units = selector.get_output_units();
+            const std::string& output_units = selector.get_output_units();
 
-            // First make sure this is an available output
-            //const std::vector<std::string> forcing_outputs = get_available_forcing_outputs();
-            const std::vector<std::string> forcing_outputs = get_avaliable_variable_names();
-            if (std::find(forcing_outputs.begin(), forcing_outputs.end(), output_name) == forcing_outputs.end()) {
-                throw runtime_error(get_formulation_type() + " received invalid output forcing name " + output_name);
-            }
+            // First make sure this is an available output, which the output's reader already has
+            OutputReader &reader = get_output_reader(output_name, output_units);
             // TODO: do this, or something better, later; right now, just assume anything using this as a provider is
             //  consistent with times
             /*
@@ -478,25 +549,17 @@ namespace realization {
             */
 
             // check if output is available from BMI
-            std::string bmi_var_name;
-            get_bmi_output_var_name(output_name, bmi_var_name);
-            
-            if( !bmi_var_name.empty() )
+            if( !reader.bmi_var_name.empty() )
             {
-                //Get forcing value from BMI variable
-                double value = get_var_value_as_double(bmi_var_name);
+                //Get forcing value from BMI variable, in place if possible
+                double value = reader.is_direct ? read_value_as_double(reader.type, get_output_values_ptr(reader), 0)
+                                                : get_var_value_as_double(reader.bmi_var_name);
 
                 // Convert units
-                std::string native_units = get_bmi_model()->GetVarUnits(bmi_var_name);
-                try {
-                    return UnitsHelper::get_converted_value(native_units, value, output_units);
-                }
-                catch (const std::runtime_error& e){
-                    #ifndef UDUNITS_QUIET
-                    std::cerr<<"WARN: Unit conversion unsuccessful - Returning unconverted value! (\""<<e.what()<<"\")"<<std::endl;
-                    #endif
+                if (warn_output_unconverted(reader)) {
                     return value;
                 }
+                return reader.converter.convert(value);
             }
             //Fall back to any internal providers as a last resort.
             return check_internal_providers<double>(output_name)[0];
@@ -545,8 +608,105 @@ namespace realization {
             return get_bmi_model()->GetOutputVarNames();
         }
 
+        ::bmi::Bmi *get_bmi_output_source(const std::string &output_name, std::string &bmi_var_name,
+                                          std::string &cxx_type) override {
+            bmi_var_name.clear();
+            get_bmi_output_var_name(output_name, bmi_var_name);
+            if (bmi_var_name.empty()) {
+                return nullptr;
+            }
+            std::shared_ptr<M> model = get_bmi_model();
+            cxx_type = model->get_analogous_cxx_type(model->GetVarType(bmi_var_name), model->GetVarItemsize(bmi_var_name));
+            return model.get();
+        }
+
+        void get_var_values_as_double(const std::string &var_name, std::vector<double> &values) override {
+            std::string bmi_var_name;
+            get_bmi_output_var_name(var_name, bmi_var_name);
+            values = models::bmi::GetValue<double>(*get_bmi_model(), bmi_var_name.empty() ? var_name : bmi_var_name);
+        }
+
+        void set_batch_members(const std::vector<std::string> &catchment_ids,
+                               const std::vector<std::shared_ptr<data_access::GenericDataProvider>> &forcings) override {
+            if (catchment_ids.size() != forcings.size()) {
+                throw std::runtime_error(get_formulation_type() + " needs one forcing provider for each batched catchment.");
+            }
+            batch_catchment_ids = catchment_ids;
+            batch_forcings = forcings;
+            // Providers shared by every catchment (e.g., NetCDF) are queried for the whole batch at once
+            batch_shared_forcing = forcings.empty() ? nullptr : forcings[0].get();
+            for (const std::shared_ptr<data_access::GenericDataProvider> &provider : forcings) {
+                if (provider.get() != batch_shared_forcing) {
+                    batch_shared_forcing = nullptr;
+                    break;
+                }
+            }
+            input_bindings_resolved = false;
+        }
+
+        /** The model can be released if its state can be saved, unless it is run for a batch of catchments. */
+        bool can_release_model() const override {
+            return checkpoint_variables_configured && batch_catchment_ids.empty();
+        }
+
+        /** Free the model, finalizing it, along with everything resolved against it. */
+        void release_model() override {
+            set_bmi_model(nullptr);
+            input_bindings.clear();
+            input_bindings_resolved = false;
+            output_readers.clear();
+            model_initialized = false;
+        }
+
+        /** Construct and initialize the model again from the properties the formulation was created with. */
+        void reload_model() override {
+            geojson::PropertyMap properties = get_model_properties();
+            set_bmi_model(construct_initialized_model(properties));
+            set_initial_bmi_parameters(properties);
+            determine_model_time_offset();
+            model_initialized = get_bmi_model()->is_model_initialized();
+        }
+
     protected:
 
+        /** @return The properties the formulation was created with, its overrides joined to what it shares. */
+        geojson::PropertyMap get_model_properties() const {
+            geojson::PropertyMap properties = *model_properties;
+            for (const auto &entry : model_property_overrides) {
+                properties.emplace(entry.first, entry.second);
+            }
+            return properties;
+        }
+
+        /**
+         * Keep the properties the formulation was created with, sharing all but those particular to its catchment
+         * with the formulations configured alike.
+         *
+         * @param properties The properties.
+         */
+        void set_model_properties(geojson::PropertyMap properties) {
+            set_model_property_overrides(properties);
+            for (const auto &entry : model_property_overrides) {
+                properties.erase(entry.first);
+            }
+            model_properties = std::move(properties);
+        }
+
+        /**
+         * Keep the properties the formulation was created with that are particular to its catchment.
+         *
+         * @param properties The properties.
+         */
+        void set_model_property_overrides(const geojson::PropertyMap &properties) {
+            model_property_overrides.clear();
+            for (const char *key : {BMI_REALIZATION_CFG_PARAM_REQ__INIT_CONFIG, BMI_REALIZATION_CFG_PARAM_OPT__FORCING_FILE}) {
+                auto found = properties.find(key);
+                if (found != properties.end()) {
+                    model_property_overrides.insert(*found);
+                }
+            }
+        }
+
         /**
          * @brief Get correct BMI variable name, which may be the output or something mapped to this output.
          *
@@ -564,7 +724,7 @@ namespace realization {
             {
                 //check mapped names
                 std::string mapped_name;
-                for (auto & iter : bmi_var_names_map) {
+                for (auto & iter : *bmi_var_names_map) {
                     if (iter.second == name) {
                         mapped_name = iter.first;
                         break;
@@ -711,8 +871,21 @@ namespace realization {
             if (needs_param_validation) {
                 validate_parameters(properties);
             }
+            configure_formulation(properties);
+            set_model_properties(properties);
+            initialize_formulation(properties);
+        }
+
+        /**
+         * Set what the formulation takes from its configuration properties alone, which is the same for every
+         * formulation created from the same properties.
+         *
+         * What is particular to the catchment, such as its init config, is left to @ref initialize_formulation.
+         *
+         * @param properties
+         */
+        void configure_formulation(const geojson::PropertyMap &properties) {
             // Required parameters first
-            set_bmi_init_config(properties.at(BMI_REALIZATION_CFG_PARAM_REQ__INIT_CONFIG).as_string());
             set_bmi_main_output_var(properties.at(BMI_REALIZATION_CFG_PARAM_REQ__MAIN_OUT_VAR).as_string());
             set_model_type_name(properties.at(BMI_REALIZATION_CFG_PARAM_REQ__MODEL_TYPE).as_string());
             set_bmi_using_forcing_file(properties.at(BMI_REALIZATION_CFG_PARAM_REQ__USES_FORCINGS).as_boolean());
@@ -733,29 +906,22 @@ namespace realization {
                 set_bmi_model_time_step_fixed(
                         properties.at(BMI_REALIZATION_CFG_PARAM_OPT__FIXED_TIME_STEP).as_boolean());
             }
+            if (properties.find(BMI_REALIZATION_CFG_PARAM_OPT__INPUTS_IN_PLACE) != properties.end()) {
+                inputs_in_place = properties.at(BMI_REALIZATION_CFG_PARAM_OPT__INPUTS_IN_PLACE).as_boolean();
+            }
 
             auto std_names_it = properties.find(BMI_REALIZATION_CFG_PARAM_OPT__VAR_STD_NAMES);
             if (std_names_it != properties.end()) {
                 geojson::PropertyMap names_map = std_names_it->second.get_values();
+                std::map<std::string, std::string> var_names_map;
                 for (auto& names_it : names_map) {
-                    bmi_var_names_map.insert(
+                    var_names_map.insert(
                             std::pair<std::string, std::string>(names_it.first, names_it.second.as_string()));
                 }
+                bmi_var_names_map = std::move(var_names_map);
             }
 
-            // Do this next, since after checking whether other input variables are present in the properties, we can
-            // now construct the adapter and init the model
-            set_bmi_model(construct_model(properties));
-            
-            //Check if any parameter values need to be set on the BMI model,
-            //and set them before it is run
-            set_initial_bmi_parameters(properties);
-            
-            // Make sure that this is able to interpret model time and convert to real time, since BMI model time is
-            // usually starting at 0 and just counting up
-            determine_model_time_offset();
-
-            // Output variable subset and order, if present
+            // Output variable subset and order, if present; otherwise the model's, once it is constructed
             auto out_var_it = properties.find(BMI_REALIZATION_CFG_PARAM_OPT__OUT_VARS);
             if (out_var_it != properties.end()) {
                 std::vector<geojson::JSONProperty> out_vars_json_list = out_var_it->second.as_list();
@@ -765,12 +931,8 @@ namespace realization {
                 }
                 set_output_variable_names(out_vars);
             }
-                // Otherwise, just take what literally is provided by the model
-            else {
-                set_output_variable_names(get_bmi_model()->GetOutputVarNames());
-            }
 
-            // Output header fields, if present
+            // Output header fields, if present; otherwise the output variable names
             auto out_headers_it = properties.find(BMI_REALIZATION_CFG_PARAM_OPT__OUT_HEADER_FIELDS);
             if (out_headers_it != properties.end()) {
                 std::vector<geojson::JSONProperty> out_headers_json_list = out_var_it->second.as_list();
@@ -780,13 +942,6 @@ namespace realization {
                 }
                 set_output_header_fields(out_headers);
             }
-            else {
-                set_output_header_fields(get_output_variable_names());
-            }
-            // Create a reference to this for ET by using a WrappedDataProvider
-            std::shared_ptr<data_access::GenericDataProvider> self = std::make_shared<data_access::WrappedDataProvider>(this);
-            input_forcing_providers[NGEN_STD_NAME_POTENTIAL_ET_FOR_TIME_STEP] = self;
-            input_forcing_providers[CSDMS_STD_NAME_POTENTIAL_ET] = self;
 
             // Output precision, if present
             auto out_precision_it = properties.find(BMI_REALIZATION_CFG_PARAM_OPT__OUTPUT_PRECISION);
@@ -794,6 +949,66 @@ namespace realization {
                 set_output_precision(properties.at(BMI_REALIZATION_CFG_PARAM_OPT__OUTPUT_PRECISION).as_natural_number());
             }
 
+            // State variables to checkpoint, if present
+            auto checkpoint_vars_it = properties.find(BMI_REALIZATION_CFG_PARAM_OPT__CHECKPOINT_VARS);
+            if (checkpoint_vars_it != properties.end()) {
+                std::vector<geojson::JSONProperty> checkpoint_vars_json_list = checkpoint_vars_it->second.as_list();
+                checkpoint_variable_names.resize(checkpoint_vars_json_list.size());
+                for (int i = 0; i < checkpoint_vars_json_list.size(); ++i) {
+                    checkpoint_variable_names[i] = checkpoint_vars_json_list[i].as_string();
+                }
+                checkpoint_variables_configured = true;
+            }
+        }
+
+        /**
+         * Construct and initialize the model of a configured formulation, with what is particular to its catchment.
+         *
+         * @param properties The configuration properties, as given to @ref configure_formulation but for what is
+         *                   particular to the catchment.
+         */
+        void initialize_formulation(const geojson::PropertyMap &properties) {
+            set_bmi_init_config(properties.at(BMI_REALIZATION_CFG_PARAM_REQ__INIT_CONFIG).as_string());
+            auto template_it = properties.find(BMI_REALIZATION_CFG_PARAM_OPT__INIT_CONFIG_TEMPLATE);
+            if (template_it != properties.end() && template_it->second.as_boolean()) {
+                init_config_template = Init_Config_Template::get_shared(get_bmi_init_config());
+                auto dir_it = properties.find(BMI_REALIZATION_CFG_PARAM_OPT__INIT_CONFIG_DIR);
+                init_config_dir = dir_it == properties.end() ? Init_Config_Template::default_directory()
+                                                             : dir_it->second.as_string();
+            }
+
+            // Now that the other properties have been checked, we can construct the adapter and init the model
+            set_bmi_model(construct_initialized_model(properties));
+            
+            //Check if any parameter values need to be set on the BMI model,
+            //and set them before it is run
+            set_initial_bmi_parameters(properties);
+            
+            // Make sure that this is able to interpret model time and convert to real time, since BMI model time is
+            // usually starting at 0 and just counting up
+            determine_model_time_offset();
+
+            // Otherwise, just take what literally is provided by the model
+            if (properties.find(BMI_REALIZATION_CFG_PARAM_OPT__OUT_VARS) == properties.end()) {
+                set_output_variable_names(get_bmi_model()->GetOutputVarNames());
+            }
+            if (properties.find(BMI_REALIZATION_CFG_PARAM_OPT__OUT_HEADER_FIELDS) == properties.end()) {
+                set_output_header_fields(get_output_variable_names());
+            }
+            // Create a reference to this for ET by using a WrappedDataProvider, unless the forcing derives potential ET
+            // itself (see DerivedForcingDataProvider), computed once for all catchments rather than per formulation
+            bool forcing_derives_et = false;
+            if (forcing != nullptr) {
+                const std::vector<std::string> &forcing_names = forcing->get_avaliable_variable_names();
+                forcing_derives_et = std::find(forcing_names.begin(), forcing_names.end(),
+                                               NGEN_STD_NAME_POTENTIAL_ET_FOR_TIME_STEP) != forcing_names.end();
+            }
+            if (!forcing_derives_et) {
+                std::shared_ptr<data_access::GenericDataProvider> self = std::make_shared<data_access::WrappedDataProvider>(this);
+                input_forcing_providers[NGEN_STD_NAME_POTENTIAL_ET_FOR_TIME_STEP] = self;
+                input_forcing_providers[CSDMS_STD_NAME_POTENTIAL_ET] = self;
+            }
+
             // Finally, make sure this is set
             model_initialized = get_bmi_model()->is_model_initialized();
         }
@@ -805,6 +1020,10 @@ namespace realization {
          * it will attempt to call `SetValue` using the property's key as the BMI variable
          * and the property's value as the value to set.
          * 
+         * Parameters bound to the columns of a `model_params_table` are set the same way, with the values of the
+         * catchment's row (see @ref add_table_parameters), unless `model_params` sets them too.  Parameters filling
+         * placeholders of a templated init config have been passed to the model through its config, so are not set.
+         *
          * This function should only be called once @p bmi_model is properly constructed.
          * If @p bmi_model is a nullptr, this function becomes a no-op.
          * 
@@ -813,11 +1032,15 @@ namespace realization {
             auto model = get_bmi_model();
             if( model == nullptr ) return;
             //Now that the model is ready, we can set some intial parameters passed in the config
-            auto model_params = properties.find("model_params");
-            
-            if (model_params != properties.end() ){
+            geojson::PropertyMap params = get_initial_bmi_parameters(properties);
+            if (init_config_template != nullptr) {
+                for (const std::string &name : init_config_template->get_parameter_names()) {
+                    params.erase(name);
+                }
+            }
+
+            if (!params.empty() ){
                 
-                geojson::PropertyMap params = model_params->second.get_values();
                 //Declare/init the possible vectors here
                 //reuse them for each loop iteration, make sure to clear them
                 std::vector<long> long_vec;
@@ -842,16 +1065,12 @@ namespace realization {
                         case geojson::PropertyType::Natural:
                             param.second.as_vector(long_vec);
                             value_ptr = get_values_as_type(type, long_vec.begin(), long_vec.end());
-                            #ifndef NGEN_QUIET
-                            std::cout<<"NAT VALUE: "<<long_vec[0]<<std::endl;
-                            #endif
+                            NGEN_LOG_DEBUG("NAT VALUE: " << long_vec[0]);
                             break;
                         case geojson::PropertyType::Real:
                             param.second.as_vector(double_vec);
                             value_ptr = get_values_as_type(type, double_vec.begin(), double_vec.end());
-                            #ifndef NGEN_QUIET
-                            std::cout<<"REAL VALUE: "<<double_vec[0]<<std::endl;
-                            #endif
+                            NGEN_LOG_DEBUG("REAL VALUE: " << double_vec[0]);
                             break;
                         /* Not currently supporting string parameter values
                         case geojson::PropertyType::String:
@@ -869,13 +1088,13 @@ namespace realization {
                             //TODO consider some additional introspection/optimization for this?
                             param.second.as_vector(double_vec);
                             if(double_vec.size() == 0){
-                                std::cout<<"Cannot pass non-numeric lists as a BMI parameter, skipping "<<param.first<<std::endl;
+                                NGEN_LOG_WARNING("Cannot pass non-numeric lists as a BMI parameter, skipping " << param.first);
                                 continue;
                             }
                             value_ptr = get_values_as_type(type, double_vec.begin(), double_vec.end());
                             break;
                         default:
-                            std::cout<<"Cannot pass parameter of type "<<geojson::get_propertytype_name(param.second.get_type())<<" as a BMI parameter, skipping "<<param.first<<std::endl;
+                            NGEN_LOG_WARNING("Cannot pass parameter of type " << geojson::get_propertytype_name(param.second.get_type()) << " as a BMI parameter, skipping " << param.first);
                             continue;
                     }
                     try{
@@ -885,13 +1104,11 @@ namespace realization {
                     }
                     catch (const std::exception &e)
                     {
-                        std::cout<<"Exception setting parameter value: "<< e.what()<<std::endl;
-                        std::cout<<"Skipping parameter: "<<param.first<<std::endl;
+                        NGEN_LOG_WARNING("Exception setting parameter value: " << e.what() << "; skipping parameter: " << param.first);
                     }
                     catch (...)
                     {
-                        std::cout<<"Unknown Exception setting parameter value: "<<std::endl;
-                        std::cout<<"Skipping parameter: "<<param.first<<std::endl;
+                        NGEN_LOG_WARNING("Unknown Exception setting parameter value; skipping parameter: " << param.first);
                     }
                     long_vec.clear();
                     double_vec.clear();
@@ -906,6 +1123,125 @@ namespace realization {
             //ensure proper type is prepared before setting value
         }
 
+        /**
+         * @brief The parameters to set in the model, from `model_params` and `model_params_table` in the config
+         * properties.
+         *
+         * @param properties The config properties of the formulation.
+         * @return The parameters, by BMI variable name.
+         */
+        geojson::PropertyMap get_initial_bmi_parameters(const geojson::PropertyMap &properties) {
+            geojson::PropertyMap params;
+            auto model_params = properties.find("model_params");
+            if (model_params != properties.end()) {
+                params = model_params->second.get_values();
+            }
+            add_table_parameters(properties, params);
+            return params;
+        }
+
+        /**
+         * @brief Construct and initialize the model, from its own rendering of the init config if it is templated.
+         *
+         * The rendered config (see @ref Init_Config_Template) is written to @ref init_config_dir for the model's
+         * `Initialize`, which every adapter calls as it is constructed, and removed again once the model is
+         * initialized, leaving the formulation's init config the template's path.
+         *
+         * @param properties The config properties of the formulation.
+         * @return The initialized model.
+         */
+        std::shared_ptr<M> construct_initialized_model(const geojson::PropertyMap &properties) {
+            if (init_config_template == nullptr) {
+                return construct_model(properties);
+            }
+            const std::string template_path = get_bmi_init_config();
+            const std::string rendered_path = init_config_template->write_rendered(
+                    init_config_dir, get_catchment_id(), get_initial_bmi_parameters(properties));
+            set_bmi_init_config(rendered_path);
+            std::shared_ptr<M> model;
+            try {
+                model = construct_model(properties);
+            }
+            catch (...) {
+                std::remove(rendered_path.c_str());
+                set_bmi_init_config(template_path);
+                throw;
+            }
+            std::remove(rendered_path.c_str());
+            set_bmi_init_config(template_path);
+            return model;
+        }
+
+        /**
+         * @brief Add the parameters bound to the columns of the `model_params_table` in the config properties, if any,
+         * with the values of this formulation's catchment, to those to set in the model.
+         *
+         * The table config has the `path` of the table file (see @ref Parameter_Table for the formats), the name of
+         * its `id_column` (`id` by default), and `params`, which binds each BMI parameter to the name of a column, or
+         * to a list of column names for an array parameter.  Parameters already in @p params are kept, and those with
+         * a missing value in any of their columns are left at the model's own value.  The table is read once and
+         * shared by the formulations of every catchment.
+         *
+         * @param properties The config properties of the formulation.
+         * @param params The parameters to set, by BMI variable name.
+         * @throws std::runtime_error If the table cannot be read, or has no row for the catchment.
+         */
+        void add_table_parameters(const geojson::PropertyMap &properties, geojson::PropertyMap &params) {
+            auto table_config_it = properties.find(BMI_REALIZATION_CFG_PARAM_OPT__PARAMS_TABLE);
+            if (table_config_it == properties.end()) {
+                return;
+            }
+            geojson::PropertyMap table_config = table_config_it->second.get_values();
+            auto id_column_it = table_config.find("id_column");
+            const std::string id_column = id_column_it == table_config.end() ? "id" : id_column_it->second.as_string();
+
+            std::vector<std::pair<std::string, std::vector<std::string>>> bindings;
+            std::vector<std::string> columns;
+            for (auto &binding : table_config.at("params").get_values()) {
+                std::vector<std::string> names;
+                if (binding.second.get_type() == geojson::PropertyType::List) {
+                    for (const geojson::JSONProperty &name : binding.second.as_list()) {
+                        names.push_back(name.as_string());
+                    }
+                }
+                else {
+                    names.push_back(binding.second.as_string());
+                }
+                columns.insert(columns.end(), names.begin(), names.end());
+                bindings.emplace_back(binding.first, std::move(names));
+            }
+
+            std::shared_ptr<const Parameter_Table> table = Parameter_Table::get_shared(
+                    table_config.at("path").as_string(), id_column, columns);
+            const long row = table->row_index(get_catchment_id());
+            if (row < 0) {
+                throw std::runtime_error("Parameter table " + table->get_path() + " has no row for catchment "
+                                         + get_catchment_id());
+            }
+            for (const auto &binding : bindings) {
+                if (params.count(binding.first) != 0) {
+                    continue;
+                }
+                std::vector<geojson::JSONProperty> values;
+                for (const std::string &column : binding.second) {
+                    const double value = table->get_value(table->column_index(column), row);
+                    if (std::isnan(value)) {
+                        NGEN_LOG_DEBUG("No " << column << " in parameter table for " << get_catchment_id()
+                                       << "; leaving parameter " << binding.first << " unset");
+                        values.clear();
+                        break;
+                    }
+                    values.emplace_back(binding.first, value);
+                }
+                if (values.size() == 1 && binding.second.size() == 1) {
+                    params.emplace(binding.first, values[0]);
+                }
+                else if (!values.empty()) {
+                    params.emplace(binding.first, geojson::JSONProperty(binding.first, values));
+                }
+            }
+        }
+
         /**
          * Test whether backing model has fixed time step size.
          *
@@ -1058,56 +1394,365 @@ namespace realization {
                 " : no logic for converting values to variable's type.");
         }
 
-        // TODO: need to modify this to support arrays properly, since in general that's what BMI modules deal with
-        template<typename T>
-        std::shared_ptr<void> get_value_as_type(std::string type, T value)
+        /** The C++ types BMI values may be set and read as, resolved from a variable's analogous C++ type name. */
+        typedef data_access::ValueType InputValueType;
+
+        InputValueType get_input_value_type(const std::string &type)
         {
             if (type == "double" || type == "double precision")
-                return std::make_shared<double>( static_cast<double>(value) );
+                return InputValueType::DOUBLE;
 
             if (type == "float" || type == "real")
-                return std::make_shared<float>( static_cast<float>(value) );
+                return InputValueType::FLOAT;
 
             if (type == "short" || type == "short int" || type == "signed short" || type == "signed short int")
-                return std::make_shared<short>( static_cast<short>(value) );
+                return InputValueType::SHORT;
 
             if (type == "unsigned short" || type == "unsigned short int")
-                return std::make_shared<unsigned short>( static_cast<unsigned short>(value) );
+                return InputValueType::UNSIGNED_SHORT;
 
             if (type == "int" || type == "signed" || type == "signed int" || type == "integer")
-                return std::make_shared<int>( static_cast<int>(value) );
+                return InputValueType::INT;
 
             if (type == "unsigned" || type == "unsigned int")
-                return std::make_shared<unsigned int>( static_cast<unsigned int>(value) );
+                return InputValueType::UNSIGNED_INT;
 
             if (type == "long" || type == "long int" || type == "signed long" || type == "signed long int")
-                return std::make_shared<long>( static_cast<long>(value) );
+                return InputValueType::LONG;
 
             if (type == "unsigned long" || type == "unsigned long int")
-                return std::make_shared<unsigned long>( static_cast<unsigned long>(value) );
+                return InputValueType::UNSIGNED_LONG;
 
             if (type == "long long" || type == "long long int" || type == "signed long long" || type == "signed long long int")
-                return std::make_shared<long long>( static_cast<long long>(value) );
+                return InputValueType::LONG_LONG;
 
             if (type == "unsigned long long" || type == "unsigned long long int")
-                return std::make_shared<unsigned long long>( static_cast<unsigned long long>(value) );
+                return InputValueType::UNSIGNED_LONG_LONG;
 
             throw std::runtime_error("Unable to get value of variable as type" + type + " from " + get_model_type_name() +
                 " : no logic for converting value to variable's type.");
         }
 
+        /** The grid of a BMI variable, as the model describes it, looked up once when the variable is bound. */
+        struct VarGrid {
+            /** The model's identifier of the grid, or ``-1`` if the model does not describe it. */
+            int id = -1;
+            int rank = 0;
+            /** The number of elements of the grid, or ``0`` if the model does not describe it. */
+            int size = 0;
+            /** The number of elements of each dimension, slowest varying first, for structured grids. */
+            std::vector<int> shape;
+
+            bool is_known() const { return id >= 0 && size > 0; }
+
+            bool operator==(const VarGrid &other) const {
+                return size == other.size && rank == other.rank && shape == other.shape;
+            }
+
+            bool operator!=(const VarGrid &other) const { return !(*this == other); }
+
+            /** @return The shape, e.g. ``[3, 4]``, or the size for grids without one, e.g. ``12``. */
+            std::string describe() const {
+                if (shape.empty()) {
+                    return std::to_string(size);
+                }
+                std::string description = "[";
+                for (size_t i = 0; i < shape.size(); ++i) {
+                    description += (i == 0 ? "" : ", ") + std::to_string(shape[i]);
+                }
+                return description + "]";
+            }
+        };
+
         /**
-         * Set BMI input variable values for the model appropriately prior to calling its `BMI `update()``.
+         * Look up the grid of a variable from a model.
          *
-         * @param model_initial_time The model's time prior to the update, in its internal units and representation.
-         * @param t_delta The size of the time step over which the formulation is going to update the model, which might
-         *                be different than the model's internal time step.
+         * Not every model or adapter implements the grid functions of BMI, and unstructured grids have no shape, so
+         * what can't be found is left unknown rather than failing.
+         *
+         * @param model The model of the variable.
+         * @param var_name The name of the variable.
+         * @return The grid, which is unknown if the model does not describe it.
          */
-        void set_model_inputs_prior_to_update(const double &model_init_time, time_step_t t_delta) {
-            std::vector<std::string> in_var_names = get_bmi_model()->GetInputVarNames();
-            time_t model_epoch_time = convert_model_time(model_init_time) + get_bmi_model_start_time_forcing_offset_s();
+        static VarGrid get_var_grid(::bmi::Bmi &model, const std::string &var_name) {
+            VarGrid grid;
+            try {
+                int id = model.GetVarGrid(var_name);
+                int size = model.GetGridSize(id);
+                if (id < 0 || size <= 0) {
+                    return grid;
+                }
+                grid.id = id;
+                grid.size = size;
+                grid.rank = model.GetGridRank(id);
+            }
+            catch (const std::exception &e) {
+                return grid;
+            }
+            try {
+                std::string grid_type = model.GetGridType(grid.id);
+                if (grid.rank > 0 && (grid_type == "rectilinear" || grid_type == "uniform_rectilinear"
+                                      || grid_type == "structured_quadrilateral")) {
+                    grid.shape.assign(grid.rank, 0);
+                    model.GetGridShape(grid.id, grid.shape.data());
+                }
+            }
+            catch (const std::exception &e) {
+                // The shape is only descriptive, so without it the grid is just its size
+                grid.shape.clear();
+            }
+            return grid;
+        }
 
-            for (std::string & var_name : in_var_names) {
+        /**
+         * Everything needed to set one BMI input variable each time step, looked up once from the model and the
+         * configuration.
+         */
+        struct InputBinding {
+            std::string var_name;
+            /** The variable's handle, where the model's adapter supports access by handle, else ``-1``. */
+            int var_index = -1;
+            data_access::GenericDataProvider *provider;
+            /** Selects the variable's value from its provider, by config mapped name and in the variable's units. */
+            CatchmentAggrDataSelector selector;
+            InputValueType type;
+            /** Whether the variable holds more than one value, which are then read from the provider as an array. */
+            bool is_array;
+            size_t count;
+            /** The grid the variable's values are on. */
+            VarGrid grid;
+            /**
+             * Whether the values are written straight into the model's variable, through ``GetValuePtr``, rather than
+             * into ``buffer`` and then passed to ``SetValue``.
+             */
+            bool is_in_place = false;
+            /** Storage for the values passed to ``SetValue``, of ``count`` values of ``type``. */
+            utils::aligned_vector<char> buffer;
+            /**
+             * The model of a nested module whose output variable ``source_var_name`` has the same type, size and units as this
+             * variable, so the value is passed straight from its ``GetValuePtr`` to ``SetValue``; otherwise ``nullptr``.
+             */
+            ::bmi::Bmi *source_model = nullptr;
+            std::string source_var_name;
+            /** Whether the values are read from the forcing of each batched catchment, into ``batch_values``. */
+            bool is_batched = false;
+            utils::aligned_vector<double> batch_values;
+        };
+
+        /**
+         * Everything needed to read one output, in some units, for @ref get_value and @ref get_values, looked up once
+         * from the model.
+         */
+        struct OutputReader {
+            /** The BMI output variable, or empty if the output comes from an internal provider. */
+            std::string bmi_var_name;
+            /** The variable's handle, where the model's adapter supports access by handle, else ``-1``. */
+            int var_index = -1;
+            /** Whether values are read in place through ``GetValuePtr``, as ``count`` values of ``type``. */
+            bool is_direct = false;
+            InputValueType type = InputValueType::DOUBLE;
+            size_t count = 1;
+            /** The grid the output's values are on. */
+            VarGrid grid;
+            /** The last pointer from ``GetValuePtr``, which is taken again once the model has updated. */
+            const void *values = nullptr;
+            unsigned long values_generation = 0;
+            UnitsHelper::Converter converter;
+            /** Why the units can't be converted, if they can't, in which case values are returned unconverted. */
+            std::string conversion_error;
+        };
+
+        /**
+         * Get the reader of an output in the given units, resolving it on the first request for them.
+         *
+         * @throws std::runtime_error If the output is not one of the available outputs of this formulation.
+         */
+        OutputReader &get_output_reader(const std::string &output_name, const std::string &output_units) {
+            // Built in a buffer kept by the thread, since this is looked up for every output read
+            static thread_local std::string key;
+            key.assign(output_name).push_back('\0');
+            key.append(output_units);
+            auto it = output_readers.find(key);
+            if (it != output_readers.end()) {
+                return it->second;
+            }
+            // Resolving may read outputs of other formulations on this thread, so keep the key
+            std::string new_key = key;
+            const std::vector<std::string> forcing_outputs = get_avaliable_variable_names();
+            if (std::find(forcing_outputs.begin(), forcing_outputs.end(), output_name) == forcing_outputs.end()) {
+                throw runtime_error(get_formulation_type() + " received invalid output forcing name " + output_name);
+            }
+            OutputReader reader;
+            get_bmi_output_var_name(output_name, reader.bmi_var_name);
+            if (!reader.bmi_var_name.empty()) {
+                std::shared_ptr<M> model = get_bmi_model();
+                try {
+                    int item_size = model->GetVarItemsize(reader.bmi_var_name);
+                    int nbytes = model->GetVarNbytes(reader.bmi_var_name);
+                    reader.type = get_input_value_type(model->get_analogous_cxx_type(
+                            model->GetVarType(reader.bmi_var_name), item_size));
+                    reader.count = item_size > 0 ? nbytes / item_size : 1;
+                    reader.grid = get_var_grid(*model, reader.bmi_var_name);
+                    reader.var_index = model->GetVarIndex(reader.bmi_var_name);
+                    reader.values = get_model_values_ptr(reader.var_index, reader.bmi_var_name);
+                    reader.values_generation = output_values_generation;
+                    reader.is_direct = reader.values != nullptr && reader.count > 0
+                                       && (size_t) item_size == data_access::value_type_size(reader.type);
+                }
+                catch (const std::exception &e) {
+                    // E.g., an adapter without GetValuePtr support, or a type without a reader, so copy values out
+                    reader.is_direct = false;
+                }
+                try {
+                    reader.converter = UnitsHelper::get_units_converter(model->GetVarUnits(reader.bmi_var_name),
+                                                                        output_units);
+                }
+                catch (const std::runtime_error &e) {
+                    reader.conversion_error = e.what();
+                }
+            }
+            return output_readers.emplace(std::move(new_key), std::move(reader)).first->second;
+        }
+
+        /** Get the current location of an output's values, taking it again if the model has updated since. */
+        const void *get_output_values_ptr(OutputReader &reader) {
+            if (reader.values_generation != output_values_generation) {
+                reader.values = get_model_values_ptr(reader.var_index, reader.bmi_var_name);
+                reader.values_generation = output_values_generation;
+            }
+            return reader.values;
+        }
+
+        /** Whether an output's units can't be converted, warning that its values are returned unconverted if so. */
+        static bool warn_output_unconverted(const OutputReader &reader) {
+            if (reader.conversion_error.empty()) {
+                return false;
+            }
+            #ifndef UDUNITS_QUIET
+            NGEN_LOG_WARNING("Unit conversion unsuccessful - Returning unconverted value! (\"" << reader.conversion_error << "\")");
+            #endif
+            return true;
+        }
+
+        /**
+         * Get a pointer to the values of a variable of the model, by its handle if it has one, else by its name.
+         *
+         * @param var_index The variable's handle, or ``-1``.
+         * @param var_name The variable's name.
+         */
+        void *get_model_values_ptr(int var_index, const std::string &var_name) {
+            return var_index >= 0 ? get_bmi_model()->GetValuePtrByIndex(var_index)
+                                  : get_bmi_model()->GetValuePtr(var_name);
+        }
+
+        /** Set the values of a variable of the model, by its handle if it has one, else by its name. */
+        void set_model_values(int var_index, const std::string &var_name, void *values) {
+            if (var_index >= 0) {
+                get_bmi_model()->SetValueByIndex(var_index, values);
+            }
+            else {
+                get_bmi_model()->SetValue(var_name, values);
+            }
+        }
+
+        /** Read the value at @p index of an array of values of @p type, as a double. */
+        static double read_value_as_double(InputValueType type, const void *values, size_t index) {
+            switch (type) {
+                case InputValueType::DOUBLE: return static_cast<const double *>(values)[index];
+                case InputValueType::FLOAT: return static_cast<const float *>(values)[index];
+                case InputValueType::SHORT: return static_cast<const short *>(values)[index];
+                case InputValueType::UNSIGNED_SHORT: return static_cast<const unsigned short *>(values)[index];
+                case InputValueType::INT: return static_cast<const int *>(values)[index];
+                case InputValueType::UNSIGNED_INT: return static_cast<const unsigned int *>(values)[index];
+                case InputValueType::LONG: return (double) static_cast<const long *>(values)[index];
+                case InputValueType::UNSIGNED_LONG: return (double) static_cast<const unsigned long *>(values)[index];
+                case InputValueType::LONG_LONG: return (double) static_cast<const long long *>(values)[index];
+                case InputValueType::UNSIGNED_LONG_LONG: return (double) static_cast<const unsigned long long *>(values)[index];
+            }
+            return static_cast<const double *>(values)[index];
+        }
+
+        /**
+         * Note that the model has updated, or had its state restored, so pointers to its output values are taken again.
+         *
+         * Formulations must call this after each ``Update`` or ``UpdateUntil`` of the model.
+         */
+        inline void mark_outputs_updated() {
+            ++output_values_generation;
+        }
+
+        /**
+         * Bind the input variable directly to the output of a provider that is itself a nested module, when possible.
+         *
+         * This is possible when the output variable has the same type, size and units as the input, is on a grid of the
+         * same shape where both models describe their grids, and the providing module's adapter supports
+         * ``GetValuePtr``.  Otherwise the binding is left to go through the provider.
+         *
+         * @param binding The binding of the input variable, with its provider, selector, type and grid already resolved.
+         * @param var_type The analogous C++ type of the input variable.
+         * @param var_nbytes The total size of the input variable.
+         */
+        void resolve_direct_input_source(InputBinding &binding, const std::string &var_type, int var_nbytes) {
+            auto *source = dynamic_cast<Bmi_Formulation *>(binding.provider);
+            if (source == nullptr) {
+                return;
+            }
+            std::string source_var_name;
+            ::bmi::Bmi *source_model;
+            try {
+                std::string source_type;
+                source_model = source->get_bmi_output_source(binding.selector.get_variable_name(), source_var_name,
+                                                             source_type);
+                if (source_model == nullptr
+                    || source_model->GetVarNbytes(source_var_name) != var_nbytes
+                    || source_type != var_type
+                    || !UnitsHelper::get_units_converter(source_model->GetVarUnits(source_var_name),
+                                                         binding.selector.get_output_units()).is_identity()
+                    || source_model->GetValuePtr(source_var_name) == nullptr) {
+                    return;
+                }
+                VarGrid source_grid = get_var_grid(*source_model, source_var_name);
+                if (binding.grid.is_known() && source_grid.is_known() && source_grid != binding.grid) {
+                    return;
+                }
+            }
+            catch (const std::exception &e) {
+                // E.g., unrecognised units or an adapter without GetValuePtr support, so use the provider
+                return;
+            }
+            binding.source_model = source_model;
+            binding.source_var_name = source_var_name;
+        }
+
+        /**
+         * Have the values of an input variable written straight into the model's variable, when possible.
+         *
+         * This is possible when the model's adapter supports ``GetValuePtr`` for the variable, and the values it holds
+         * are of the size of its type.  Otherwise the values are still passed to ``SetValue``.
+         *
+         * @param binding The binding of the input variable, with its type and size already resolved.
+         * @param var_item_size The size of each of the variable's values.
+         */
+        void resolve_in_place_input(InputBinding &binding, int var_item_size) {
+            try {
+                binding.is_in_place = (size_t) var_item_size == data_access::value_type_size(binding.type)
+                                      && get_model_values_ptr(binding.var_index, binding.var_name) != nullptr;
+            }
+            catch (const std::exception &e) {
+                // E.g., an adapter without GetValuePtr support, so use SetValue
+                binding.is_in_place = false;
+            }
+        }
+
+        /**
+         * Resolve the provider, type, size and units of every BMI input variable of the model.
+         *
+         * This happens before the first update, when the model is initialized and every provider has been assigned,
+         * and the bindings are then reused each time step.
+         */
+        void resolve_input_bindings() {
+            input_bindings.clear();
+            for (const std::string & var_name : get_bmi_model()->GetInputVarNames()) {
                 data_access::GenericDataProvider *provider;
                 std::string var_map_alias = get_config_mapped_variable_name(var_name);
                 if (input_forcing_providers.find(var_map_alias) != input_forcing_providers.end()) {
@@ -1121,28 +1766,195 @@ namespace realization {
                 }
                 // TODO: probably need to actually allow this by default and warn, but have config option to activate
                 //  this type of behavior
-                // TODO: account for arrays later
                 int varItemSize = get_bmi_model()->GetVarItemsize(var_name);
-                std::shared_ptr<void> value_ptr;
-                // Finally, use the value obtained to set the model input
+                int varNbytes = get_bmi_model()->GetVarNbytes(var_name);
+                InputBinding binding;
+                binding.var_name = var_name;
+                binding.var_index = get_bmi_model()->GetVarIndex(var_name);
+                binding.provider = provider;
+                binding.selector = CatchmentAggrDataSelector(this->get_catchment_id(), var_map_alias, 0, 0,
+                                                             get_bmi_model()->GetVarUnits(var_name));
                 std::string type = get_bmi_model()->get_analogous_cxx_type(get_bmi_model()->GetVarType(var_name),
                                                                            varItemSize);
-                if (varItemSize != get_bmi_model()->GetVarNbytes(var_name)) {
-                    //more than a single value needed for var_name
-                    auto values = provider->get_values(CatchmentAggrDataSelector(this->get_catchment_id(),var_map_alias, model_epoch_time, t_delta,
-                                                   get_bmi_model()->GetVarUnits(var_name)));
-                    //need to marshal data types to the reciever as well
-                    //this could be done a little more elegantly if the provider interface were
-                    //"type aware", but for now, this will do (but requires yet another copy)
-                    value_ptr = get_values_as_type( type, values.begin(), values.end() );
+                binding.type = get_input_value_type(type);
+                //more than a single value needed for var_name
+                binding.is_array = varItemSize != varNbytes;
+                binding.count = binding.is_array && varItemSize > 0 ? varNbytes / varItemSize : 1;
+                binding.grid = get_var_grid(*get_bmi_model(), var_name);
+                if (binding.is_array && binding.grid.is_known() && binding.count % binding.grid.size != 0) {
+                    NGEN_LOG_WARNING(get_model_type_name() << " input variable " << var_name << " has "
+                                     << binding.count << " values, which is not a multiple of the "
+                                     << binding.grid.size << " elements of its grid " << binding.grid.describe()
+                                     << "; its values are set as an array of " << binding.count << ".");
+                }
+                binding.buffer.assign(binding.count * data_access::value_type_size(binding.type), 0);
+                if (!batch_catchment_ids.empty() && provider == forcing.get()) {
+                    if (binding.count != batch_catchment_ids.size()) {
+                        throw std::runtime_error(get_model_type_name() + " input variable " + var_name + " has " +
+                                                 std::to_string(binding.count) + " values" +
+                                                 (binding.grid.is_known() ? " on grid " + binding.grid.describe() : "") +
+                                                 ", but its batch has " + std::to_string(batch_catchment_ids.size()) +
+                                                 " catchments.");
+                    }
+                    binding.is_batched = true;
+                    binding.batch_values.resize(binding.count);
+                }
+                else {
+                    resolve_direct_input_source(binding, type, varNbytes);
+                }
+                if (inputs_in_place) {
+                    resolve_in_place_input(binding, varItemSize);
+                }
+                input_bindings.push_back(std::move(binding));
+            }
+            input_bindings_resolved = true;
+        }
+
+        /**
+         * Save the model's state for a checkpoint, along with the formulation's time step index.
+         *
+         * BMI has no notion of model state, so the state is taken to be the values of the configured
+         * ``checkpoint_variables``, read with `GetValuePtr` where the model supports it and `GetValue` otherwise.  The
+         * model's current time, as the epoch time of the forcing it corresponds to, is saved too, since BMI can't set
+         * it; see @ref load_bmi_state.
+         *
+         * @param out The writer to save the state with.
+         * @param next_time_step_index The index of the next time step the formulation will process.
+         * @throws std::runtime_error If no ``checkpoint_variables`` were configured.
+         */
+        void save_bmi_state(utils::StateWriter &out, int next_time_step_index) {
+            if (!checkpoint_variables_configured) {
+                throw std::runtime_error("Cannot checkpoint " + get_model_type_name() + " formulation of " + get_id() +
+                                         ": its state variables must be listed in the '" +
+                                         BMI_REALIZATION_CFG_PARAM_OPT__CHECKPOINT_VARS + "' config parameter.");
+            }
+            std::shared_ptr<M> model = get_bmi_model();
+            out.write<int32_t>(next_time_step_index);
+            out.write<int64_t>(convert_model_time(model->GetCurrentTime()) + get_bmi_model_start_time_forcing_offset_s());
+            out.write<uint64_t>(checkpoint_variable_names.size());
+            std::vector<char> buffer;
+            for (const std::string &var_name : checkpoint_variable_names) {
+                int nbytes = model->GetVarNbytes(var_name);
+                out.write(var_name);
+                out.write<int64_t>(nbytes);
+                void *ptr = nullptr;
+                try {
+                    ptr = model->GetValuePtr(var_name);
+                }
+                catch (const std::exception &) {
+                    // Not all adapters support pointers; the values are copied below instead
+                }
+                if (ptr == nullptr) {
+                    buffer.resize(nbytes);
+                    model->GetValue(var_name, buffer.data());
+                    ptr = buffer.data();
+                }
+                out.write_bytes(ptr, nbytes);
+            }
+        }
 
+        /**
+         * Restore model state saved by @ref save_bmi_state, setting each saved variable with `SetValue`.
+         *
+         * The model's clock can't be set through BMI, so it stays at its initial time.  To keep reading the forcing of
+         * the right times, the offset from model time to forcing time is set so the model's current time corresponds
+         * to the saved forcing time.  Model time values, and checks against the model's end time, are thus relative to
+         * the restart.
+         *
+         * @param in The reader of the saved state.
+         * @return The saved index of the next time step the formulation will process.
+         * @throws std::runtime_error If a saved variable isn't one of the configured ``checkpoint_variables`` or no
+         *                            longer has the same size.
+         */
+        int load_bmi_state(utils::StateReader &in) {
+            std::shared_ptr<M> model = get_bmi_model();
+            int next_time_step_index = in.read<int32_t>();
+            time_t saved_forcing_time = static_cast<time_t>(in.read<int64_t>());
+            uint64_t count = in.read<uint64_t>();
+            std::vector<char> buffer;
+            for (uint64_t i = 0; i < count; ++i) {
+                std::string var_name = in.read_string();
+                int64_t nbytes = in.read<int64_t>();
+                if (std::find(checkpoint_variable_names.begin(), checkpoint_variable_names.end(), var_name) ==
+                    checkpoint_variable_names.end()) {
+                    throw std::runtime_error("Cannot restore " + get_model_type_name() + " formulation of " + get_id() +
+                                             ": saved variable " + var_name + " is not one of its '" +
+                                             BMI_REALIZATION_CFG_PARAM_OPT__CHECKPOINT_VARS + "'.");
+                }
+                if (nbytes != model->GetVarNbytes(var_name)) {
+                    throw std::runtime_error("Cannot restore " + get_model_type_name() + " formulation of " + get_id() +
+                                             ": saved variable " + var_name + " has " + std::to_string(nbytes) +
+                                             " bytes, but the model's has " +
+                                             std::to_string(model->GetVarNbytes(var_name)) + ".");
+                }
+                buffer.resize(nbytes);
+                in.read_bytes(buffer.data(), nbytes);
+                model->SetValue(var_name, buffer.data());
+            }
+            set_bmi_model_start_time_forcing_offset_s(saved_forcing_time - convert_model_time(model->GetCurrentTime()));
+            mark_outputs_updated();
+            return next_time_step_index;
+        }
+
+        /**
+         * Set BMI input variable values for the model appropriately prior to calling its `BMI `update()``.
+         *
+         * @param model_initial_time The model's time prior to the update, in its internal units and representation.
+         * @param t_delta The size of the time step over which the formulation is going to update the model, which might
+         *                be different than the model's internal time step.
+         */
+        void set_model_inputs_prior_to_update(const double &model_init_time, time_step_t t_delta) {
+            NGEN_PROFILE_SCOPE("forcing/set_model_inputs");
+            if (!input_bindings_resolved) {
+                resolve_input_bindings();
+            }
+            time_t model_epoch_time = convert_model_time(model_init_time) + get_bmi_model_start_time_forcing_offset_s();
+
+            for (InputBinding & binding : input_bindings) {
+                if (binding.source_model != nullptr) {
+                    // Values already match this variable, so they are copied once, straight from the source
+                    void *source_values = binding.source_model->GetValuePtr(binding.source_var_name);
+                    void *values = binding.is_in_place ? get_model_values_ptr(binding.var_index, binding.var_name) : nullptr;
+                    if (values != nullptr) {
+                        std::memcpy(values, source_values, binding.buffer.size());
+                    }
+                    else {
+                        set_model_values(binding.var_index, binding.var_name, source_values);
+                    }
+                    continue;
+                }
+                binding.selector.set_init_time(model_epoch_time);
+                binding.selector.set_duration_secs(t_delta);
+                // Values in place are written where the model holds them now, which may move as it updates
+                void *values = binding.is_in_place ? get_model_values_ptr(binding.var_index, binding.var_name) : nullptr;
+                if (values == nullptr) {
+                    values = binding.buffer.data();
+                }
+                if (binding.is_batched) {
+                    if (batch_shared_forcing != nullptr) {
+                        batch_shared_forcing->get_values_for_ids(batch_catchment_ids, binding.selector, SUM,
+                                                                 binding.batch_values.data());
+                    }
+                    else {
+                        for (size_t i = 0; i < batch_catchment_ids.size(); ++i) {
+                            binding.selector.set_id(batch_catchment_ids[i]);
+                            binding.batch_values[i] = batch_forcings[i]->get_value(binding.selector);
+                        }
+                    }
+                    data_access::store_values(binding.type, binding.batch_values.data(), binding.count, values);
+                }
+                else if (binding.is_array) {
+                    //the provider marshals data types to the reciever as well; values past the variable's size are
+                    //dropped, and a short array leaves the remaining values as they were
+                    binding.provider->get_values_into(binding.selector, SUM, binding.type, values, binding.count);
                 } else {
                     //scalar value
-                    double value = provider->get_value(CatchmentAggrDataSelector(this->get_catchment_id(),var_map_alias, model_epoch_time, t_delta,
-                                                   get_bmi_model()->GetVarUnits(var_name)));
-                    value_ptr = get_value_as_type(type, value);      
+                    double value = binding.provider->get_value(binding.selector);
+                    data_access::store_values(binding.type, &value, 1, values);
+                }
+                if (values == binding.buffer.data()) {
+                    set_model_values(binding.var_index, binding.var_name, values);
                 }
-                get_bmi_model()->SetValue(var_name, value_ptr.get());
             }
         }
 
@@ -1151,6 +1963,18 @@ namespace realization {
         /** The epoch time of the model at the beginning of its last update. */
         time_t last_model_response_start_time = 0;
         std::map<std::string, std::shared_ptr<data_access::GenericDataProvider>> input_forcing_providers;
+        /** How each output is read, by output name and units, resolved on the first request for it. */
+        std::unordered_map<std::string, OutputReader> output_readers;
+        /** Counts model updates, so readers know when to take their output's values pointer again. */
+        unsigned long output_values_generation = 0;
+        /** How each BMI input variable is set before an update, resolved on the first update. */
+        std::vector<InputBinding> input_bindings;
+        bool input_bindings_resolved = false;
+        /** The catchments the model is run for in batched mode, in the order of its grid cells; otherwise empty. */
+        std::vector<std::string> batch_catchment_ids;
+        std::vector<std::shared_ptr<data_access::GenericDataProvider>> batch_forcings;
+        /** The forcing provider of every batched catchment, if they all share one, or else ``nullptr``. */
+        data_access::GenericDataProvider *batch_shared_forcing = nullptr;
 
         // Access for multi-BMI
         friend class Bmi_Multi_Formulation;
@@ -1171,37 +1995,43 @@ namespace realization {
         /** The set of available "forcings" (output variables, plus their mapped aliases) that the model can provide. */
         std::vector<std::string> available_forcings;
         std::string bmi_init_config;
+        /** The template of the init config, when it is templated, which is then rendered for each model. */
+        std::shared_ptr<const Init_Config_Template> init_config_template;
+        /** The directory the init configs rendered from @ref init_config_template are written to. */
+        std::string init_config_dir;
         std::shared_ptr<M> bmi_model;
         /** Whether backing model has fixed time step size. */
         bool bmi_model_time_step_fixed = true;
+        /** Whether input values are written straight into the model's variables, through ``GetValuePtr``. */
+        bool inputs_in_place = false;
         /**
          * The offset, converted to seconds, from the model's start time to the start time of the initial forcing time
          * step.
          */
         time_t bmi_model_start_time_forcing_offset_s;
-        /** A configured mapping of BMI model variable names to standard names for use inside the framework. */
-        std::map<std::string, std::string> bmi_var_names_map;
+        /**
+         * A configured mapping of BMI model variable names to standard names for use inside the framework, shared with
+         * the formulations configured alike.
+         */
+        utils::SharedBlock<std::map<std::string, std::string>> bmi_var_names_map;
         /** Whether the backing model uses/reads the forcing file directly for getting input data. */
         bool bmi_using_forcing_file;
         std::string forcing_file_path;
         bool model_initialized = false;
-
-        std::vector<std::string> OPTIONAL_PARAMETERS = {
-                BMI_REALIZATION_CFG_PARAM_OPT__FORCING_FILE,
-                BMI_REALIZATION_CFG_PARAM_OPT__VAR_STD_NAMES,
-                BMI_REALIZATION_CFG_PARAM_OPT__OUT_VARS,
-                BMI_REALIZATION_CFG_PARAM_OPT__OUT_HEADER_FIELDS,
-                BMI_REALIZATION_CFG_PARAM_OPT__OUTPUT_PRECISION,
-                BMI_REALIZATION_CFG_PARAM_OPT__ALLOW_EXCEED_END,
-                BMI_REALIZATION_CFG_PARAM_OPT__FIXED_TIME_STEP,
-                BMI_REALIZATION_CFG_PARAM_OPT__LIB_FILE
-        };
-        std::vector<std::string> REQUIRED_PARAMETERS = {
-                BMI_REALIZATION_CFG_PARAM_REQ__INIT_CONFIG,
-                BMI_REALIZATION_CFG_PARAM_REQ__MAIN_OUT_VAR,
-                BMI_REALIZATION_CFG_PARAM_REQ__MODEL_TYPE,
-                BMI_REALIZATION_CFG_PARAM_REQ__USES_FORCINGS
-        };
+        /** Names of the BMI variables that hold the model's state, which are saved and restored for checkpoints. */
+        std::vector<std::string> checkpoint_variable_names;
+        /** Whether the state variables were configured, possibly as none for a model without state. */
+        bool checkpoint_variables_configured = false;
+        /**
+         * The properties the formulation was created with, to construct the model again after releasing it, less the
+         * @ref model_property_overrides; shared with the formulations configured alike, e.g. by a global formulation.
+         */
+        utils::SharedBlock<geojson::PropertyMap, geojson::PropertyMapHash> model_properties;
+        /**
+         * The properties the formulation was created with that are usually particular to its catchment, such as its
+         * init config, so they're kept apart from the @ref model_properties it can share.
+         */
+        geojson::PropertyMap model_property_overrides;
 
     };
 /*
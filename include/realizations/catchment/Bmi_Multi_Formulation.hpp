@@ -435,8 +435,59 @@ namespace realization {
 
         string get_output_line_for_timestep(int timestep, std::string delimiter) override;
 
+        bool get_output_values_for_timestep(int timestep, std::vector<double> &values) override;
+
+        /**
+         * Get the format of output values, that of the last nested module when its output is used directly.
+         */
+        OutputFormat get_output_format() const override;
+
         double get_response(time_step_t t_index, time_step_t t_delta) override;
 
+        /** Save the index of the next time step to process and the state of each nested module, in order. */
+        void save_state(utils::StateWriter &out) override {
+            out.write<int32_t>(next_time_step_index);
+            out.write<uint64_t>(modules.size());
+            for (nested_module_ptr &module : modules) {
+                utils::StateWriter module_out;
+                module->save_state(module_out);
+                out.write(module_out.get_bytes());
+            }
+        }
+
+        void load_state(utils::StateReader &in) override {
+            next_time_step_index = in.read<int32_t>();
+            load_module_states(in, false);
+        }
+
+        void load_initial_state(utils::StateReader &in) override {
+            in.read<int32_t>();
+            load_module_states(in, true);
+            next_time_step_index = 0;
+        }
+
+        /** The nested modules' models can be released if every module's can. */
+        bool can_release_model() const override {
+            for (const nested_module_ptr &module : modules) {
+                if (!module->can_release_model()) {
+                    return false;
+                }
+            }
+            return !modules.empty();
+        }
+
+        void release_model() override {
+            for (nested_module_ptr &module : modules) {
+                module->release_model();
+            }
+        }
+
+        void reload_model() override {
+            for (nested_module_ptr &module : modules) {
+                module->reload_model();
+            }
+        }
+
         /**
          * Get the index of the forcing time step that contains the given point in time.
          *
@@ -503,6 +554,19 @@ namespace realization {
             return availableData[output_name]->get_values(CatchmentAggrDataSelector(this->get_catchment_id(),output_name, init_time, duration_s, output_units), m);
         }
 
+        size_t get_values_into(const CatchmentAggrDataSelector& selector, data_access::ReSampleMethod m,
+                               data_access::ValueType type, void* values, size_t count) override
+        {
+            std::string output_name = selector.get_variable_name();
+            if (availableData.empty() || availableData.find(output_name) == availableData.end()) {
+                throw runtime_error(get_formulation_type() + " cannot get output values for unknown " + output_name + SOURCE_LOC);
+            }
+            return availableData[output_name]->get_values_into(
+                    CatchmentAggrDataSelector(this->get_catchment_id(), output_name, selector.get_init_time(),
+                                              selector.get_duration_secs(), selector.get_output_units()),
+                    m, type, values, count);
+        }
+
         bool is_bmi_input_variable(const string &var_name) override;
 
         /**
@@ -773,6 +837,26 @@ namespace realization {
 
     private:
 
+        /** Restore the saved state of each nested module, as the initial state if @p is_initial. */
+        void load_module_states(utils::StateReader &in, bool is_initial) {
+            uint64_t count = in.read<uint64_t>();
+            if (count != modules.size()) {
+                throw std::runtime_error("Cannot restore multi-module formulation of " + get_id() + ": saved state has " +
+                                         std::to_string(count) + " modules, but it has " +
+                                         std::to_string(modules.size()) + ".");
+            }
+            for (nested_module_ptr &module : modules) {
+                std::vector<char> module_state = in.read_vector<char>();
+                utils::StateReader module_in(module_state);
+                if (is_initial) {
+                    module->load_initial_state(module_in);
+                }
+                else {
+                    module->load_state(module_in);
+                }
+            }
+        }
+
         /**
          * Setup a deferred provider for a nested module, tracking the class as needed.
          *
@@ -5,6 +5,7 @@
 
 #include <cstring>
 #include <exception>
+#include <map>
 #include <memory>
 #include <string>
 #include "pybind11/pybind11.h"
@@ -30,6 +31,14 @@ namespace models {
         /**
          * An adapter class to serve as a C++ interface to the aspects of external models written in the Python
          * language that implement the BMI.
+         *
+         * Every call into Python takes the GIL, so instances may be used from threads other than the one that started
+         * the interpreter, as long as that thread has released it.  Taking the GIL again while holding it is cheap, so
+         * callers performing a sequence of calls (e.g., setting inputs, updating and getting outputs) should hold it for
+         * the whole sequence.
+         *
+         * The bound methods of the backing model used each time step, and the type and size of each variable, are
+         * looked up once, rather than on each call.
          */
         class Bmi_Py_Adapter : public Bmi_Adapter<py::object> {
 
@@ -53,7 +62,8 @@ namespace models {
             template <typename T>
             void copy_to_array(const string& name, T *dest)
             {
-                py::array_t<T> backing_array = bmi_model->attr("get_value_ptr")(name);
+                py::gil_scoped_acquire gil;
+                py::array_t<T> backing_array = py_get_value_ptr(get_var_info(name).py_name);
                 auto uncheck_proxy = backing_array.template unchecked<1>();
                 for (ssize_t i = 0; i < backing_array.size(); ++i) {
                     dest[i] = uncheck_proxy(i);
@@ -70,7 +80,8 @@ namespace models {
             template <typename T>
             std::vector<T> copy_to_vector(const string& name)
             {
-                py::array_t<T> backing_array = bmi_model->attr("get_value_ptr")(name);
+                py::gil_scoped_acquire gil;
+                py::array_t<T> backing_array = py_get_value_ptr(get_var_info(name).py_name);
                 std::vector<T> dest(backing_array.size());
                 auto uncheck_proxy = backing_array.template unchecked<1>();
                 for (ssize_t i = 0; i < backing_array.size(); ++i) {
@@ -80,6 +91,7 @@ namespace models {
             }
 
             void Finalize() override {
+                py::gil_scoped_acquire gil;
                 bmi_model->attr("finalize")();
             }
 
@@ -98,6 +110,7 @@ namespace models {
             vector<std::string> GetOutputVarNames() override;
 
             int GetGridEdgeCount(const int grid) override {
+                py::gil_scoped_acquire gil;
                 return py::int_(bmi_model->attr("get_grid_edge_count")(grid));
             }
 
@@ -109,6 +122,7 @@ namespace models {
             }
 
             int GetGridFaceCount(const int grid) override {
+                py::gil_scoped_acquire gil;
                 return py::int_(bmi_model->attr("get_grid_face_count")(grid));
             }
 
@@ -125,6 +139,7 @@ namespace models {
             }
 
             int GetGridNodeCount(const int grid) override {
+                py::gil_scoped_acquire gil;
                 return py::int_(bmi_model->attr("get_grid_node_count")(grid));
             }
 
@@ -138,6 +153,7 @@ namespace models {
             }
 
             int GetGridRank(const int grid) override {
+                py::gil_scoped_acquire gil;
                 return py::int_(bmi_model->attr("get_grid_rank")(grid));
             }
 
@@ -146,6 +162,7 @@ namespace models {
             }
 
             int GetGridSize(const int grid) override {
+                py::gil_scoped_acquire gil;
                 return py::int_(bmi_model->attr("get_grid_size")(grid));
             }
 
@@ -154,34 +171,57 @@ namespace models {
             }
 
             string GetGridType(const int grid) override {
+                py::gil_scoped_acquire gil;
                 return py::str(bmi_model->attr("get_grid_type")(grid));
             }
 
             void GetGridX(const int grid, double *x) override {
-                // From the BMI docs:
-                //   "The length of the resulting one-dimensional array depends on the grid type. (It will have either
-                //   get_grid_rank or get_grid_size elements.) See Model grids for more information."
-                // Leaving this not implemented for now, since it is probably not yet needed, to make sure a proper
-                // solution to determining the array length is used.
-                throw runtime_error("GetGridX not yet implemented for Python BMI adapter");
+                get_and_copy_grid_array<double>("get_grid_x", grid, x, get_grid_coordinate_count(grid, 0), "float");
             }
 
             void GetGridY(const int grid, double *y) override {
-                // From the BMI docs:
-                //   "The length of the resulting one-dimensional array depends on the grid type. (It will have either
-                //   get_grid_rank or get_grid_size elements.) See Model grids for more information."
-                // Leaving this not implemented for now, since it is probably not yet needed, to make sure a proper
-                // solution to determining the array length is used.
-                throw runtime_error("GetGridY not yet implemented for Python BMI adapter");
+                get_and_copy_grid_array<double>("get_grid_y", grid, y, get_grid_coordinate_count(grid, 1), "float");
             }
 
             void GetGridZ(const int grid, double *z) override {
-                // From the BMI docs:
-                //   "The length of the resulting one-dimensional array depends on the grid type. (It will have either
-                //   get_grid_rank or get_grid_size elements.) See Model grids for more information."
-                // Leaving this not implemented for now, since it is probably not yet needed, to make sure a proper
-                // solution to determining the array length is used.
-                throw runtime_error("GetGridZ not yet implemented for Python BMI adapter");
+                get_and_copy_grid_array<double>("get_grid_z", grid, z, get_grid_coordinate_count(grid, 2), "float");
+            }
+
+            /**
+             * Get the length of the array of coordinates ``GetGridX``, ``GetGridY`` or ``GetGridZ`` fill for a grid.
+             *
+             * From the BMI docs, the length "depends on the grid type. (It will have either get_grid_rank or
+             * get_grid_size elements.)"  That is, a rectilinear grid has a coordinate for each of its rows along the
+             * dimension, which is the extent of the dimension in ``GetGridShape`` (whose last is that of x); a
+             * structured quadrilateral, unstructured or points grid has one for each of its nodes.  Uniform
+             * rectilinear and scalar grids have no coordinate arrays, being described by ``GetGridOrigin`` and
+             * ``GetGridSpacing`` instead.
+             *
+             * @param grid The model grid identifier.
+             * @param dimension The dimension of the coordinates: 0 for x, 1 for y and 2 for z.
+             * @return The number of coordinates.
+             * @throws std::runtime_error If the grid has no coordinates of the dimension.
+             */
+            int get_grid_coordinate_count(const int grid, const int dimension) {
+                const std::string grid_type = GetGridType(grid);
+                const int rank = GetGridRank(grid);
+                if (dimension >= rank) {
+                    throw runtime_error("Grid " + std::to_string(grid) + " of rank " + std::to_string(rank)
+                                        + " has no coordinates of dimension " + std::to_string(dimension));
+                }
+                if (grid_type == "rectilinear") {
+                    std::vector<int> shape(rank);
+                    GetGridShape(grid, shape.data());
+                    return shape[rank - 1 - dimension];
+                }
+                if (grid_type == "structured_quadrilateral" || grid_type == "points") {
+                    return GetGridSize(grid);
+                }
+                if (grid_type == "unstructured") {
+                    return GetGridNodeCount(grid);
+                }
+                throw runtime_error("Grid " + std::to_string(grid) + " of type '" + grid_type
+                                    + "' has no coordinate arrays; use its origin and spacing");
             }
 
             double GetStartTime() override;
@@ -219,6 +259,15 @@ namespace models {
              * @return The name string for the C++ type analogous to the described type in the Python backing model.
              */
             const std::string get_analogous_cxx_type(const std::string &py_type_name, const size_t item_size) override {
+                return get_analogous_cxx_type_for(py_type_name, item_size);
+            }
+
+            /**
+             * Get the name string for the C++ type analogous to a Python type, as @ref get_analogous_cxx_type does.
+             *
+             * This needs no model instance, e.g. for adapters of Python models hosted by another process.
+             */
+            static std::string get_analogous_cxx_type_for(const std::string &py_type_name, const size_t item_size) {
                 /*
                  * Note that an implementation using a "switch" statement would be problematic.  It could be done by
                  * rewriting to separate the integer and non-integer type, then having cases based on size.  However,
@@ -342,6 +391,7 @@ namespace models {
             void get_and_copy_grid_array(const char* grid_func_name, const int grid, T* dest, int dest_length,
                                          const char* np_dtype)
             {
+                py::gil_scoped_acquire gil;
                 py::array_t<T> np_array = np.attr("zeros")(dest_length, "dtype"_a = np_dtype);
                 bmi_model->attr(grid_func_name)(grid, np_array);
                 auto np_array_direct = np_array.template unchecked<1>();
@@ -404,9 +454,9 @@ namespace models {
              *                       which there is not support for mapping to a native type in the framework.
              */
             void get_value_at_indices(const string& name, void *dest, int *inds, int count, bool is_all_indices) {
+                py::gil_scoped_acquire gil;
                 string val_type = GetVarType(name);
                 size_t val_item_size = (size_t)GetVarItemsize(name);
-                vector<string> in_v = GetInputVarNames();
 
                 // The available types and how they are handled here should match what is in SetValueAtIndices
                 if (val_type == "int" && val_item_size == sizeof(short))
@@ -457,13 +507,19 @@ namespace models {
             py::array_t<T> get_via_numpy_array(const string& name, void *dest, const int *indices, int item_count,
                                                size_t item_size, bool is_all_indices)
             {
-                string val_type = GetVarType(name);
-                py::array_t<T, py::array::c_style> dest_array
-                    = np.attr("zeros")(item_count, "dtype"_a = val_type, "order"_a = "C");
+                py::gil_scoped_acquire gil;
+                VarInfo &info = get_var_info(name);
+                py::array_t<T, py::array::c_style> dest_array;
                 if (is_all_indices) {
-                    bmi_model->attr("get_value")(name, dest_array);
+                    // All values are read into the same array each time
+                    if (!info.get_value_array) {
+                        info.get_value_array = np.attr("zeros")(item_count, "dtype"_a = info.py_type, "order"_a = "C");
+                    }
+                    dest_array = py::reinterpret_borrow<py::array_t<T, py::array::c_style>>(info.get_value_array);
+                    py_get_value(info.py_name, dest_array);
                 }
                 else {
+                    dest_array = np.attr("zeros")(item_count, "dtype"_a = info.py_type, "order"_a = "C");
                     py::array_t<int, py::array::c_style> indices_np_array
                             = np.attr("zeros")(item_count, "dtype"_a = "int32", "order"_a = "C");
                     auto indices_mut_direct = indices_np_array.mutable_unchecked<1>();
@@ -475,7 +531,7 @@ namespace models {
                     for (int i = 0; i < item_count; ++i)
                         indices_np_arr_ptr[i] = indices[i];
                     */
-                    bmi_model->attr("get_value_at_indices")(name, dest_array, indices_np_array);
+                    bmi_model->attr("get_value_at_indices")(info.py_name, dest_array, indices_np_array);
                 }
 
                 auto direct_access = dest_array.template unchecked<1>();
@@ -499,24 +555,24 @@ namespace models {
             void UpdateUntil(double time) override;
 
             void SetValue(std::string name, void *src) override {
-                int itemSize = GetVarItemsize(name);
-                std::string py_type = GetVarType(name);
-                std::string cxx_type = get_analogous_cxx_type(py_type, (size_t) itemSize);
+                py::gil_scoped_acquire gil;
+                VarInfo &info = get_var_info(name);
+                const std::string &cxx_type = info.cxx_type;
 
                 if (cxx_type == "short") {
-                    set_value<short>(name, (short *) src);
+                    set_value<short>(info, (short *) src);
                 } else if (cxx_type == "int") {
-                    set_value<int>(name, (int *) src);
+                    set_value<int>(info, (int *) src);
                 } else if (cxx_type == "long") {
-                    set_value<long>(name, (long *) src);
+                    set_value<long>(info, (long *) src);
                 } else if (cxx_type == "long long") {
-                    set_value<long long>(name, (long long *) src);
+                    set_value<long long>(info, (long long *) src);
                 } else if (cxx_type == "float") {
-                    set_value<float>(name, (float *) src);
+                    set_value<float>(info, (float *) src);
                 } else if (cxx_type == "double") {
-                    set_value<double>(name, (double *) src);
+                    set_value<double>(info, (double *) src);
                 } else if (cxx_type == "long double") {
-                    set_value<long double>(name, (long double *) src);
+                    set_value<long double>(info, (long double *) src);
                 } else {
                     throw std::runtime_error("Bmi_Py_Adapter cannot set values for variable '" + name +
                                              "' that has unrecognized C++ type '" + cxx_type + "'");
@@ -533,6 +589,7 @@ namespace models {
              */
             template <typename T>
             void set_value(const std::string &name, std::vector<T> src) {
+                py::gil_scoped_acquire gil;
                 int nbytes = GetVarNbytes(name);
                 int itemSize = GetVarItemsize(name);
                 int length = nbytes / itemSize;
@@ -543,7 +600,7 @@ namespace models {
                             " expected but " + std::to_string(src.size()) + " received)");
                 }
 
-                py::array_t<T> model_var_array = bmi_model->attr("get_value_ptr")(name);
+                py::array_t<T> model_var_array = py_get_value_ptr(get_var_info(name).py_name);
                 auto mutable_unchecked_proxy = model_var_array.template mutable_unchecked<1>();
                 for (size_t i = 0; i < length; ++i) {
                     mutable_unchecked_proxy(i) = src[i];
@@ -592,6 +649,7 @@ namespace models {
             void set_value_at_indices(const string &name, const int *inds, int count, void* cxx_array,
                                       const string &np_type)
             {
+                py::gil_scoped_acquire gil;
                 py::array_t<int> index_array(py::buffer_info(inds, count));
                 py::array_t<T> src_array(py::buffer_info((T*)cxx_array, count));
                 bmi_model->attr("set_value_at_indices")(name, index_array, src_array);
@@ -623,6 +681,55 @@ namespace models {
             /** A pointer to a string with the simple name of the Python type referenced by ``py_bmi_type_ref``. */
             shared_ptr<string> bmi_type_py_class_name;
 
+            /** Bound methods of the backing model used each time step, looked up once after it is initialized. */
+            py::object py_update;
+            py::object py_update_until;
+            py::object py_get_value;
+            py::object py_get_value_ptr;
+            py::object py_set_value;
+
+            /**
+             * What is needed to pass the values of a BMI variable to or from the model, looked up on first use.
+             *
+             * Variable types and sizes are taken as fixed once the model is initialized, as BMI grids are.
+             */
+            struct VarInfo {
+                py::str py_name;
+                std::string py_type;
+                std::string cxx_type;
+                int item_size;
+                int nbytes;
+                /** Numpy array passed to ``set_value``, filled again each time the variable is set. */
+                py::object set_value_array;
+                /** Numpy array passed to ``get_value``, read into again each time all values are wanted. */
+                py::object get_value_array;
+            };
+            std::map<std::string, VarInfo> var_info;
+
+            /** Get the cached type and size of a variable, looking them up from the model the first time. */
+            VarInfo &get_var_info(const std::string &name) {
+                auto it = var_info.find(name);
+                if (it != var_info.end()) {
+                    return it->second;
+                }
+                VarInfo info;
+                info.py_name = py::str(name);
+                info.py_type = py::str(bmi_model->attr("get_var_type")(info.py_name));
+                info.item_size = py::int_(bmi_model->attr("get_var_itemsize")(info.py_name));
+                info.nbytes = py::int_(bmi_model->attr("get_var_nbytes")(info.py_name));
+                info.cxx_type = get_analogous_cxx_type(info.py_type, (size_t) info.item_size);
+                return var_info.emplace(name, std::move(info)).first->second;
+            }
+
+            /** Look up the bound methods of the backing model that are used each time step. */
+            inline void bind_time_step_methods() {
+                py_update = bmi_model->attr("update");
+                py_update_until = bmi_model->attr("update_until");
+                py_get_value = bmi_model->attr("get_value");
+                py_get_value_ptr = bmi_model->attr("get_value_ptr");
+                py_set_value = bmi_model->attr("set_value");
+            }
+
             /**
              * Construct the backing BMI model object, then call its BMI-native ``Initialize()`` function.
              *
@@ -644,6 +751,7 @@ namespace models {
                     // This is the actual backing model object
                     bmi_model = make_shared<py::object>(bmi_py_class());
                     bmi_model->attr("initialize")(bmi_init_config);
+                    bind_time_step_methods();
                 }
                 catch (std::runtime_error& e){ //Catch specific exception types so the type/message don't get erased
                     throw e;
@@ -701,17 +809,23 @@ namespace models {
             /**
              * Set the values of the given BMI variable based on a provided C++ array of values.
              *
+             * The values are copied into a numpy array kept for the variable, rather than a new one each time.
+             *
              * @tparam T The type of source values, assumed to be appropriate for the involved variable.
-             * @param name The name of the involved BMI model variable.
+             * @param info The cached details of the involved BMI model variable.
              * @param src An array of source values to apply to the BMI variable, assumed to be of the same size as the
              *            BMI model's current array for the involved variable.
              */
             template <typename T>
-            void set_value(const std::string &name, T *src) {
+            void set_value(VarInfo &info, T *src) {
                 // Because all BMI arrays are flattened, we can just use the size/length in the buffer info
-                int length = GetVarNbytes(name) / GetVarItemsize(name);
-                py::array_t<T> src_array(py::buffer_info(src, length));
-                bmi_model->attr("set_value")(name, src_array);
+                int length = info.nbytes / info.item_size;
+                if (!info.set_value_array) {
+                    info.set_value_array = py::array_t<T>(length);
+                }
+                py::array_t<T> src_array = py::reinterpret_borrow<py::array_t<T>>(info.set_value_array);
+                std::memcpy(src_array.mutable_data(), src, sizeof(T) * length);
+                py_set_value(info.py_name, src_array);
             }
 
             // For unit testing
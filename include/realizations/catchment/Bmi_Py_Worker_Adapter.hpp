@@ -0,0 +1,260 @@
+#ifndef NGEN_BMI_PY_WORKER_ADAPTER_HPP
+#define NGEN_BMI_PY_WORKER_ADAPTER_HPP
+
+#ifdef ACTIVATE_PYTHON
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Bmi_Adapter.hpp"
+#include "Bmi_Py_Adapter.hpp"
+#include "Python_Worker_Pool.hpp"
+#include "StreamHandler.hpp"
+
+namespace models {
+    namespace bmi {
+
+        /**
+         * An adapter for a Python BMI model hosted by a @ref Python_Worker, rather than by this process's interpreter.
+         *
+         * The model is a @ref Bmi_Py_Adapter in the worker, and each BMI call is passed on to it as a worker command.
+         * Calls that change the model (setting values, updating and finalizing) are queued without waiting for the
+         * worker, while the names, times and variable metadata, which BMI models do not change once initialized, are
+         * taken once and kept.  Getting the value of an output variable after the model has changed takes the current
+         * time and the values of every output variable with a single command, so a time step of a formulation waits on
+         * the worker once, however many inputs it sets and outputs it reads.
+         *
+         * There is no pointer to a model's values in this process, so ``GetValuePtr`` returns ``nullptr``, which
+         * formulations take to mean values must be copied instead.  Like @ref Bmi_Py_Adapter, instances are for use by
+         * one thread at a time, but the models of different instances run concurrently, in their own workers.
+         */
+        class Bmi_Py_Worker_Adapter : public Bmi_Adapter<Python_Worker> {
+
+        public:
+
+            /**
+             * Create the model in a worker of the @ref Python_Worker_Pool and initialize it.
+             *
+             * @param type_name The name of the model type, as for @ref Bmi_Py_Adapter.
+             * @param bmi_init_config The path of the model's BMI init config file.
+             * @param bmi_python_type The full name of the Python class of the model.
+             * @param python_module_path A directory for the worker to add to its Python path first, if not empty.
+             * @param allow_exceed_end Whether the model may be updated past its end time.
+             * @param has_fixed_time_step Whether the model's time step size is fixed.
+             * @param output The stream for messages to the user.
+             */
+            Bmi_Py_Worker_Adapter(const string &type_name, std::string bmi_init_config, const string &bmi_python_type,
+                                  std::string python_module_path, bool allow_exceed_end, bool has_fixed_time_step,
+                                  utils::StreamHandler output);
+
+            /** Destroy the model in its worker. */
+            virtual ~Bmi_Py_Worker_Adapter();
+
+            void Finalize() override;
+
+            string GetComponentName() override {
+                return component_name;
+            }
+
+            double GetCurrentTime() override;
+
+            double GetEndTime() override {
+                return end_time;
+            }
+
+            int GetInputItemCount() override {
+                return (int) input_var_names->size();
+            }
+
+            vector<std::string> GetInputVarNames() override {
+                return *input_var_names;
+            }
+
+            int GetOutputItemCount() override {
+                return (int) output_var_names->size();
+            }
+
+            vector<std::string> GetOutputVarNames() override {
+                return *output_var_names;
+            }
+
+            double GetStartTime() override {
+                return start_time;
+            }
+
+            double GetTimeStep() override {
+                return time_step;
+            }
+
+            std::string GetTimeUnits() override {
+                return time_units;
+            }
+
+            void GetValue(std::string name, void *dest) override;
+
+            void GetValueAtIndices(std::string name, void *dest, int *inds, int count) override;
+
+            /** @return ``nullptr``, since the model's values are in the memory of its worker. */
+            void *GetValuePtr(std::string name) override {
+                return nullptr;
+            }
+
+            int GetVarGrid(std::string name) override;
+
+            int GetVarItemsize(std::string name) override {
+                return get_var_info(name).item_size;
+            }
+
+            std::string GetVarLocation(std::string name) override;
+
+            int GetVarNbytes(std::string name) override {
+                return get_var_info(name).nbytes;
+            }
+
+            std::string GetVarType(std::string name) override {
+                return get_var_info(name).type;
+            }
+
+            std::string GetVarUnits(std::string name) override {
+                return get_var_info(name).units;
+            }
+
+            void SetValue(std::string name, void *src) override;
+
+            void SetValueAtIndices(std::string name, int *inds, int count, void *src) override;
+
+            void Update() override;
+
+            void UpdateUntil(double time) override;
+
+            int GetGridEdgeCount(const int grid) override {
+                return get_grid_int(Python_Worker_Grid_Int::EDGE_COUNT, grid);
+            }
+
+            void GetGridEdgeNodes(const int grid, int *edge_nodes) override {
+                get_grid_array(Python_Worker_Grid_Array::EDGE_NODES, grid, edge_nodes);
+            }
+
+            int GetGridFaceCount(const int grid) override {
+                return get_grid_int(Python_Worker_Grid_Int::FACE_COUNT, grid);
+            }
+
+            void GetGridFaceEdges(const int grid, int *face_edges) override {
+                get_grid_array(Python_Worker_Grid_Array::FACE_EDGES, grid, face_edges);
+            }
+
+            void GetGridFaceNodes(const int grid, int *face_nodes) override {
+                get_grid_array(Python_Worker_Grid_Array::FACE_NODES, grid, face_nodes);
+            }
+
+            int GetGridNodeCount(const int grid) override {
+                return get_grid_int(Python_Worker_Grid_Int::NODE_COUNT, grid);
+            }
+
+            void GetGridNodesPerFace(const int grid, int *nodes_per_face) override {
+                get_grid_array(Python_Worker_Grid_Array::NODES_PER_FACE, grid, nodes_per_face);
+            }
+
+            void GetGridOrigin(const int grid, double *origin) override {
+                get_grid_array(Python_Worker_Grid_Array::ORIGIN, grid, origin);
+            }
+
+            int GetGridRank(const int grid) override {
+                return get_grid_int(Python_Worker_Grid_Int::RANK, grid);
+            }
+
+            void GetGridShape(const int grid, int *shape) override {
+                get_grid_array(Python_Worker_Grid_Array::SHAPE, grid, shape);
+            }
+
+            int GetGridSize(const int grid) override {
+                return get_grid_int(Python_Worker_Grid_Int::SIZE, grid);
+            }
+
+            void GetGridSpacing(const int grid, double *spacing) override {
+                get_grid_array(Python_Worker_Grid_Array::SPACING, grid, spacing);
+            }
+
+            std::string GetGridType(const int grid) override;
+
+            void GetGridX(const int grid, double *x) override {
+                get_grid_array(Python_Worker_Grid_Array::X, grid, x);
+            }
+
+            void GetGridY(const int grid, double *y) override {
+                get_grid_array(Python_Worker_Grid_Array::Y, grid, y);
+            }
+
+            void GetGridZ(const int grid, double *z) override {
+                get_grid_array(Python_Worker_Grid_Array::Z, grid, z);
+            }
+
+            /** @copydoc Bmi_Py_Adapter::get_analogous_cxx_type */
+            const std::string get_analogous_cxx_type(const std::string &py_type_name, const size_t item_size) override {
+                return Bmi_Py_Adapter::get_analogous_cxx_type_for(py_type_name, item_size);
+            }
+
+            inline bool is_model_initialized() {
+                return model_initialized;
+            }
+
+        protected:
+
+            /** Create the model in its worker, taking the model's names and times from the reply. */
+            void construct_and_init_backing_model() override;
+
+        private:
+
+            /** The metadata of a variable, as kept from the worker. */
+            struct Var_Info {
+                std::string type;
+                std::string units;
+                int item_size;
+                int nbytes;
+                /** The location, or why the model could not give it. */
+                std::string location;
+                bool has_location;
+                /** The grid, or why the model could not give it. */
+                int grid;
+                std::string grid_error;
+            };
+
+            /** Start a command for this adapter's model. */
+            utils::StateWriter command(Python_Worker_Command command_type) const;
+
+            /** Get the metadata of a variable, from the worker the first time. */
+            const Var_Info &get_var_info(const std::string &name);
+
+            /** Make sure @ref output_values are those of the model's current state. */
+            void fetch_outputs();
+
+            /** Forget the current time and output values, after a command that changes the model. */
+            void model_changed(bool time_changed);
+
+            int get_grid_int(Python_Worker_Grid_Int function, int grid);
+
+            void get_grid_array(Python_Worker_Grid_Array function, int grid, void *dest);
+
+            std::string bmi_python_type;
+            std::string python_module_path;
+            int32_t handle = -1;
+            std::string component_name;
+            std::string time_units;
+            double start_time = 0.0;
+            double end_time = 0.0;
+            double time_step = 0.0;
+            std::map<std::string, Var_Info> var_info;
+            /** The current time of the model, if it is known. */
+            double current_time = 0.0;
+            bool is_current_time_known = false;
+            /** The values of every output variable, if they are those of the model's current state. */
+            std::map<std::string, std::vector<char>> output_values;
+            bool are_output_values_current = false;
+        };
+    }
+}
+
+#endif //ACTIVATE_PYTHON
+
+#endif //NGEN_BMI_PY_WORKER_ADAPTER_HPP
@@ -0,0 +1,95 @@
+#ifndef NGEN_BMI_PY_WORKER_FORMULATION_HPP
+#define NGEN_BMI_PY_WORKER_FORMULATION_HPP
+
+#ifdef ACTIVATE_PYTHON
+
+#include <memory>
+#include <string>
+#include "Bmi_Module_Formulation.hpp"
+#include "Bmi_Py_Worker_Adapter.hpp"
+#include "GenericDataProvider.hpp"
+
+namespace realization {
+
+    /**
+     * A ``bmi_python`` formulation whose model is hosted by a Python BMI worker process, rather than by the
+     * interpreter of this process.
+     *
+     * Formulations of this type are constructed for ``bmi_python`` in place of @ref Bmi_Py_Formulation when the
+     * execution config sets ``python_workers``, and behave the same, except that they never take this process's GIL,
+     * so the models of a rank step concurrently, each in its own worker, on the ``catchment_threads``.
+     *
+     * @see models::bmi::Python_Worker_Pool
+     */
+    class Bmi_Py_Worker_Formulation : public Bmi_Module_Formulation<models::bmi::Bmi_Py_Worker_Adapter> {
+
+    public:
+
+        Bmi_Py_Worker_Formulation(std::string id, std::shared_ptr<data_access::GenericDataProvider> forcing,
+                                  utils::StreamHandler output_stream);
+
+        const vector<string> get_bmi_input_variables() override;
+
+        const vector<string> get_bmi_output_variables() override;
+
+        /** @return ``bmi_py``, as for formulations of models hosted in this process. */
+        std::string get_formulation_type() override;
+
+        /** @copydoc Bmi_Py_Formulation::get_output_line_for_timestep */
+        string get_output_line_for_timestep(int timestep, std::string delimiter) override;
+
+        /** @copydoc Bmi_Py_Formulation::get_output_values_for_timestep */
+        bool get_output_values_for_timestep(int timestep, std::vector<double> &values) override;
+
+        /** @copydoc Bmi_Py_Formulation::get_response */
+        double get_response(time_step_t t_index, time_step_t t_delta) override;
+
+        bool is_bmi_input_variable(const string &var_name) override;
+
+        bool is_bmi_output_variable(const string &var_name) override;
+
+        /** Save the model's configured state variables and the index of the next time step to process. */
+        void save_state(utils::StateWriter &out) override {
+            save_bmi_state(out, next_time_step_index);
+        }
+
+        void load_state(utils::StateReader &in) override {
+            next_time_step_index = load_bmi_state(in);
+        }
+
+        void load_initial_state(utils::StateReader &in) override {
+            load_bmi_state(in);
+            next_time_step_index = 0;
+        }
+
+        /** Models in workers are not released, since they are constructed and finalized by the worker pool. */
+        bool can_release_model() const override {
+            return false;
+        }
+
+    protected:
+
+        shared_ptr<models::bmi::Bmi_Py_Worker_Adapter> construct_model(const geojson::PropertyMap &properties) override;
+
+        time_t convert_model_time(const double &model_time) override;
+
+        double get_var_value_as_double(const string &var_name) override;
+
+        double get_var_value_as_double(const int &index, const string &var_name) override;
+
+        bool is_model_initialized() override;
+
+        friend class Bmi_Multi_Formulation;
+
+    private:
+
+        /** Index of the time step that will be processed by the next update of the model, as for @ref Bmi_Py_Formulation. */
+        int next_time_step_index = 0;
+
+    };
+
+}
+
+#endif //ACTIVATE_PYTHON
+
+#endif //NGEN_BMI_PY_WORKER_FORMULATION_HPP
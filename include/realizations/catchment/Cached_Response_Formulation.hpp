@@ -0,0 +1,92 @@
+#ifndef NGEN_CACHED_RESPONSE_FORMULATION_HPP
+#define NGEN_CACHED_RESPONSE_FORMULATION_HPP
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "Catchment_Formulation.hpp"
+#include "Response_Cache.hpp"
+
+namespace realization {
+
+    /**
+     * A formulation replaying the responses and outputs a catchment's formulation had in an earlier run, from a
+     * Response_Cache entry computed under the catchment's current formulation config and forcing.
+     *
+     * It reads no forcing and runs no model; its state is only the time step it is asked for, so checkpoints of it are
+     * empty.
+     */
+    class Cached_Response_Formulation : public Catchment_Formulation {
+
+    public:
+
+        Cached_Response_Formulation(std::string id, std::shared_ptr<const Response_Cache::Entry> entry)
+            : Catchment_Formulation(std::move(id)), entry(std::move(entry)) { }
+
+        std::string get_formulation_type() override {
+            return "cached_response";
+        }
+
+        double calc_et() override {
+            return 0.0;
+        }
+
+        /** @throws std::out_of_range If the earlier run had no time step @p t_index. */
+        double get_response(time_step_t t_index, time_step_t t_delta) override {
+            if (t_index < 0 || t_index >= static_cast<time_step_t>(entry->size())) {
+                throw std::out_of_range("The cached responses of " + get_id() + " have no time step "
+                                        + std::to_string(t_index));
+            }
+            return entry->responses[t_index];
+        }
+
+        std::string get_output_header_line(std::string delimiter) override {
+            std::string header;
+            for (std::size_t v = 0; v < entry->output_names.size(); ++v) {
+                header += (v == 0 ? "" : delimiter) + entry->output_names[v];
+            }
+            return header;
+        }
+
+        std::string get_output_line_for_timestep(int timestep, std::string delimiter) override {
+            std::vector<double> values;
+            if (!get_output_values_for_timestep(timestep, values)) {
+                return "";
+            }
+            return format_output_values(values, delimiter);
+        }
+
+        bool get_output_values_for_timestep(int timestep, std::vector<double> &values) override {
+            if (timestep < 0 || timestep >= static_cast<int>(entry->size())) {
+                return false;
+            }
+            const std::size_t width = entry->output_names.size();
+            values.assign(entry->output_values.begin() + timestep * width,
+                          entry->output_values.begin() + (timestep + 1) * width);
+            return true;
+        }
+
+        const std::vector<std::string> &get_required_parameters() override {
+            static const std::vector<std::string> required;
+            return required;
+        }
+
+        void create_formulation(boost::property_tree::ptree &config, geojson::PropertyMap *global = nullptr) override { }
+
+        void create_formulation(geojson::PropertyMap properties) override { }
+
+        void save_state(utils::StateWriter &out) override { }
+
+        void load_state(utils::StateReader &in) override { }
+
+        void load_initial_state(utils::StateReader &in) override { }
+
+    private:
+
+        std::shared_ptr<const Response_Cache::Entry> entry;
+
+    };
+}
+
+#endif //NGEN_CACHED_RESPONSE_FORMULATION_HPP
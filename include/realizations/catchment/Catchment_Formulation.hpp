@@ -2,11 +2,13 @@
 #define CATCHMENT_FORMULATION_H
 
 #include <memory>
+#include <stdexcept>
 #include <vector>
 #include "Formulation.hpp"
 #include "Et_Accountable.hpp"
 #include <HY_CatchmentArea.hpp>
 #include "GenericDataProvider.hpp"
+#include "Checkpoint.hpp"
 
 namespace realization {
 
@@ -44,17 +46,21 @@ namespace realization {
                 return;
             }
 
-            std::string value = it->second.as_string();
+            const std::string &value = it->second.as_string();
             size_t id_index = value.find(pattern);
 
             if (id_index != std::string::npos) {
+                // Build the substituted value in one pass, rather than searching it again after each replacement
+                std::string substituted;
+                size_t begin = 0;
                 do {
-                    value = value.replace(id_index, sizeof(pattern.c_str()) - 2, replacement);
-                    id_index = value.find(pattern);
+                    substituted.append(value, begin, id_index - begin).append(replacement);
+                    begin = id_index + pattern.size();
+                    id_index = value.find(pattern, begin);
                 } while (id_index != std::string::npos);
+                substituted.append(value, begin, std::string::npos);
 
-                properties.erase(key);
-                properties.emplace(key, geojson::JSONProperty(key, value));
+                it->second = geojson::JSONProperty(key, substituted);
             }
         }
 
@@ -90,6 +96,164 @@ namespace realization {
 
             void create_formulation(boost::property_tree::ptree &config, geojson::PropertyMap *global = nullptr) override = 0;
             void create_formulation(geojson::PropertyMap properties) override = 0;
+
+            /**
+             * Configure this formulation from validated properties as a prototype for the formulations of many
+             * catchments configured alike, e.g. by a global formulation, without creating anything particular to a
+             * catchment, such as its model.
+             *
+             * The default implementation does nothing, for types that can't be created from a prototype.
+             *
+             * @param properties The properties, as for @ref create_formulation.
+             * @return Whether this type can be created from prototypes, and so this is now one.
+             * @throws std::runtime_error If the properties are not valid for the type.
+             */
+            virtual bool configure_prototype(const geojson::PropertyMap &properties) {
+                return false;
+            }
+
+            /**
+             * Create this formulation like a prototype of the same type (see @ref configure_prototype), copying what
+             * the prototype took from its properties, so only what is particular to this catchment, such as its init
+             * config, is read from its own.
+             *
+             * The default implementation does nothing, for types that can't be created from a prototype.
+             *
+             * @param prototype The prototype.
+             * @param properties The properties of this formulation, which differ from the prototype's in nothing but
+             *                   what is particular to the catchment.
+             * @return Whether this formulation was created; if not, @ref create_formulation is needed.
+             */
+            virtual bool create_from_prototype(const Catchment_Formulation &prototype,
+                                               const geojson::PropertyMap &properties) {
+                return false;
+            }
+
+            /**
+             * Save the state needed to resume running from the next time step, for a checkpoint.
+             *
+             * This is called between time steps, after the last processed time step's output has been written.  The
+             * default implementation throws, for formulations that can't save their state.
+             *
+             * @param out The writer to save the state with.
+             * @throws std::runtime_error If the formulation can't save its state.
+             */
+            virtual void save_state(utils::StateWriter &out) {
+                throw std::runtime_error("Formulation type " + get_formulation_type() + " of " + get_id() +
+                                         " does not support checkpointing its state.");
+            }
+
+            /**
+             * Restore state saved by @ref save_state, so the next call to @ref get_response resumes from the time step
+             * after the one the state was saved at.
+             *
+             * This is called on a newly created formulation, before any time step is processed.
+             *
+             * @param in The reader of the saved state.
+             * @throws std::runtime_error If the formulation can't restore its state, or the state doesn't match it.
+             */
+            virtual void load_state(utils::StateReader &in) {
+                throw std::runtime_error("Formulation type " + get_formulation_type() + " of " + get_id() +
+                                         " does not support restoring its state from a checkpoint.");
+            }
+
+            /**
+             * Restore state saved by @ref save_state at the end of another run that ends where this one starts, e.g. a
+             * spin-up, as the state before this run's first time step.
+             *
+             * Unlike @ref load_state, the next call to @ref get_response is for this run's first time step, whatever
+             * time step the state was saved at.  This is called on a newly created formulation, before any time step
+             * is processed.
+             *
+             * @param in The reader of the saved state.
+             * @throws std::runtime_error If the formulation can't restore its state, or the state doesn't match it.
+             */
+            virtual void load_initial_state(utils::StateReader &in) {
+                throw std::runtime_error("Formulation type " + get_formulation_type() + " of " + get_id() +
+                                         " does not support restoring its initial state from a spin-up.");
+            }
+
+            /**
+             * Whether this formulation can free its model with @ref release_model and construct it again with
+             * @ref reload_model, so its model can be paged out of memory between time steps.
+             *
+             * The default implementation returns ``false``.
+             *
+             * @return Whether this formulation can release its model.
+             */
+            virtual bool can_release_model() const {
+                return false;
+            }
+
+            /**
+             * Free this formulation's model, after its state has been saved with @ref save_state.
+             *
+             * Until @ref reload_model is called, the formulation must not be run, nor its state saved or restored.
+             */
+            virtual void release_model() { }
+
+            /**
+             * Construct this formulation's model again, after @ref release_model, as newly created from its config.
+             *
+             * The state saved before the model was released is then restored with @ref load_state.
+             */
+            virtual void reload_model() { }
+
+            /**
+             * The group of formulations this one computes its time steps with on an accelerator, e.g. a GPU, if any.
+             *
+             * The formulations of a group compute each time step together, in one pass for all of them, which
+             * @ref run_device_step runs ahead of their @ref get_response calls, so the framework can overlap it with
+             * the formulations computed on the host.  The default implementation returns ``nullptr``, for
+             * formulations each computed on the host by its own @ref get_response.
+             *
+             * @return A key for the group, the same for every formulation of it, or ``nullptr``.
+             */
+            virtual const void* get_device_group() const {
+                return nullptr;
+            }
+
+            /**
+             * Compute a time step of every formulation of this one's @ref get_device_group, if it has not been yet,
+             * so that their @ref get_response calls for it only take the results.
+             *
+             * This is called on another thread than the formulations' @ref get_response calls, which therefore must
+             * wait for a pass of the group in progress.  The default implementation does nothing.
+             *
+             * @param t_index The index of the time step.
+             * @param t_delta The duration, in seconds, of the time step.
+             */
+            virtual void run_device_step(time_step_t t_index, time_step_t t_delta) { }
+
+            /**
+             * Get the duration of this formulation's own time steps, if it steps at other than the simulation output
+             * interval.
+             *
+             * The framework runs a formulation with a longer time step only once every so many output intervals, and
+             * a formulation with a shorter time step that many times each output interval, so the time step must be
+             * either a whole multiple or a whole divisor of the output interval.
+             *
+             * @return The duration, in seconds, of this formulation's time steps, or ``0`` to step at the output
+             *         interval.
+             */
+            long get_time_step_seconds() const {
+                return time_step_seconds;
+            }
+
+            /**
+             * Set the duration of this formulation's own time steps.
+             *
+             * @param seconds The duration, in seconds, of this formulation's time steps, or ``0`` to step at the
+             *                output interval.
+             * @see get_time_step_seconds
+             */
+            void set_time_step_seconds(long seconds) {
+                if (seconds < 0) {
+                    throw std::invalid_argument("Time step of formulation " + get_id() + " cannot be negative.");
+                }
+                time_step_seconds = seconds;
+            }
+
             virtual ~Catchment_Formulation(){};
 
     protected:
@@ -103,6 +267,7 @@ namespace realization {
 
     private:
         std::string cat_id;
+        long time_step_seconds = 0;
     };
 }
 #endif // CATCHMENT_FORMULATION_H
@@ -0,0 +1,184 @@
+#ifndef NGEN_CATCHMENT_STATE_PAGER_HPP
+#define NGEN_CATCHMENT_STATE_PAGER_HPP
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Catchment_Formulation.hpp"
+#include "Checkpoint.hpp"
+#include "StateStore.hpp"
+
+namespace realization {
+
+    /**
+     * @brief Pages the models of catchment formulations out of memory, to a utils::StateStore on disk, and back in,
+     * so a domain whose models do not all fit in memory at once can be run a block of catchments at a time (see the
+     * execution ``page_block``).
+     *
+     * Paging a formulation out saves its state, as for a checkpoint, and then frees its model with
+     * Catchment_Formulation::release_model; only formulations that @ref Catchment_Formulation::can_release_model "can"
+     * are paged, and the rest stay in memory.  Paging it in constructs its model again and restores the saved state.
+     * The formulation objects themselves, which hold no more than the config of the model and its providers, stay in
+     * memory throughout.
+     *
+     * Distinct formulations may be paged in and out from several threads at once.
+     */
+    class Catchment_State_Pager {
+    public:
+
+        /**
+         * @param directory The directory of the store of the paged out states, which should be on a local disk.
+         * @param block_size The number of catchments run with their models in memory at once.
+         */
+        Catchment_State_Pager(const std::string &directory, long block_size)
+            : block_size(block_size), store(directory) { }
+
+        /** @return The number of catchments run with their models in memory at once. */
+        long get_block_size() const {
+            return block_size;
+        }
+
+        /**
+         * Page a formulation's model out, if the formulation can release it and it is in memory.
+         *
+         * @return Whether the model is paged out.
+         */
+        bool page_out(Catchment_Formulation &formulation) {
+            if (!formulation.can_release_model()) {
+                return false;
+            }
+            std::size_t slot;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                Page &page = get_page(formulation);
+                if (page.is_paged) {
+                    return true;
+                }
+                slot = page.slot;
+            }
+            utils::StateWriter out;
+            formulation.save_state(out);
+            formulation.release_model();
+            store.put(slot, out.get_bytes());
+            std::lock_guard<std::mutex> lock(mutex);
+            pages.at(&formulation).is_paged = true;
+            return true;
+        }
+
+        /** Page a formulation's model back in, if it is paged out. */
+        void page_in(Catchment_Formulation &formulation) {
+            std::size_t slot;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto page = pages.find(&formulation);
+                if (page == pages.end() || !page->second.is_paged) {
+                    return;
+                }
+                slot = page->second.slot;
+            }
+            std::vector<char> state;
+            store.get(slot, state);
+            formulation.reload_model();
+            utils::StateReader in(state);
+            formulation.load_state(in);
+            std::lock_guard<std::mutex> lock(mutex);
+            pages.at(&formulation).is_paged = false;
+        }
+
+        /** Start reading the saved state of a formulation that is paged out, ahead of paging it in. */
+        void prefetch(const Catchment_Formulation &formulation) {
+            std::size_t slot;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto page = pages.find(&formulation);
+                if (page == pages.end() || !page->second.is_paged) {
+                    return;
+                }
+                slot = page->second.slot;
+            }
+            store.prefetch(slot);
+        }
+
+        /** @return Whether a formulation's model is paged out. */
+        bool is_paged(const Catchment_Formulation &formulation) const {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto page = pages.find(&formulation);
+            return page != pages.end() && page->second.is_paged;
+        }
+
+        /**
+         * Save a formulation's state as Catchment_Formulation::save_state does, from the store if it is paged out.
+         */
+        void save_state(Catchment_Formulation &formulation, utils::StateWriter &out) {
+            std::size_t slot;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto page = pages.find(&formulation);
+                if (page == pages.end() || !page->second.is_paged) {
+                    formulation.save_state(out);
+                    return;
+                }
+                slot = page->second.slot;
+            }
+            std::vector<char> state;
+            store.get(slot, state);
+            out.write_bytes(state.data(), state.size());
+        }
+
+        /**
+         * Restore a formulation's state as Catchment_Formulation::load_state does, into the store if it is paged out,
+         * to be restored when it is paged in.
+         */
+        void load_state(Catchment_Formulation &formulation, const std::vector<char> &state) {
+            std::size_t slot;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto page = pages.find(&formulation);
+                if (page == pages.end() || !page->second.is_paged) {
+                    utils::StateReader in(state);
+                    formulation.load_state(in);
+                    return;
+                }
+                slot = page->second.slot;
+            }
+            store.put(slot, state);
+        }
+
+        /** @return The number of formulations whose models are paged out. */
+        std::size_t get_paged_count() const {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::size_t count = 0;
+            for (const auto &page : pages) {
+                count += page.second.is_paged ? 1 : 0;
+            }
+            return count;
+        }
+
+    private:
+
+        struct Page {
+            std::size_t slot;
+            bool is_paged;
+        };
+
+        /** Get the page of a formulation, giving it the next slot of the store the first time. */
+        Page &get_page(const Catchment_Formulation &formulation) {
+            auto page = pages.find(&formulation);
+            if (page == pages.end()) {
+                page = pages.emplace(&formulation, Page{pages.size(), false}).first;
+            }
+            return page->second;
+        }
+
+        const long block_size;
+        utils::StateStore store;
+        std::unordered_map<const Catchment_Formulation *, Page> pages;
+        mutable std::mutex mutex;
+    };
+
+}
+
+#endif // NGEN_CATCHMENT_STATE_PAGER_HPP
@@ -0,0 +1,243 @@
+#ifndef NGEN_ENSEMBLE_FORMULATION_HPP
+#define NGEN_ENSEMBLE_FORMULATION_HPP
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Catchment_Formulation.hpp"
+#include "GenericDataProvider.hpp"
+
+namespace realization {
+
+    /**
+     * An ensemble of members of one formulation for a catchment, each with its own parameters and model state.
+     *
+     * Every member is created from the same formulation config, with the parameters given for the member replacing
+     * those of the config, so one process runs the whole ensemble over the hydrofabric, configuration and forcing it
+     * reads once: the members all take their forcings from the catchment's one forcing provider.  For example:
+     *
+     * @code{.json}
+     * {
+     *     "name": "ensemble",
+     *     "params": {
+     *         "formulation": { "name": "bmi_c", "params": { ... } },
+     *         "members": [ {}, { "model_params": { "Kn": 0.05 } }, { "model_params": { "Kn": 0.1 } } ]
+     *     }
+     * }
+     * @endcode
+     *
+     * Member parameters that are objects, like ``model_params``, are merged into those of the config, rather than
+     * replacing them.  The response of the ensemble, around the network, is the mean of the member responses, and its
+     * output is that mean followed by the response of each member.
+     */
+    class Ensemble_Formulation : public Catchment_Formulation {
+
+    public:
+
+        /** The constructor of a member formulation, as registered for its formulation type. */
+        typedef std::shared_ptr<Catchment_Formulation> (*member_constructor)(
+                std::string, std::shared_ptr<data_access::GenericDataProvider>, utils::StreamHandler);
+
+        /** Look up the constructor of members of a formulation type, throwing if there is none. */
+        typedef member_constructor (*member_constructor_lookup)(const std::string &formulation_type);
+
+        Ensemble_Formulation(std::string id, std::shared_ptr<data_access::GenericDataProvider> forcing,
+                             utils::StreamHandler output_stream, member_constructor_lookup lookup)
+            : Catchment_Formulation(std::move(id), std::move(forcing), output_stream), lookup(lookup) { }
+
+        std::string get_formulation_type() override {
+            return "ensemble";
+        }
+
+        const std::vector<std::shared_ptr<Catchment_Formulation>> &get_members() const {
+            return members;
+        }
+
+        /** The response of each member for the last time step run, in the order of the members. */
+        const std::vector<double> &get_member_responses() const {
+            return member_responses;
+        }
+
+        /** Set the ET params of the ensemble and of every member. */
+        void set_et_params(std::shared_ptr<pdm03_struct> params) override {
+            Catchment_Formulation::set_et_params(params);
+            for (const auto &member : members) {
+                member->set_et_params(params);
+            }
+        }
+
+        /** The mean ET of the members. */
+        double calc_et() override {
+            double sum = 0.0;
+            for (const auto &member : members) {
+                sum += member->calc_et();
+            }
+            return sum / members.size();
+        }
+
+        /** Run every member for the time step, returning the mean of their responses. */
+        double get_response(time_step_t t_index, time_step_t t_delta) override {
+            double sum = 0.0;
+            for (std::size_t m = 0; m < members.size(); ++m) {
+                member_responses[m] = members[m]->get_response(t_index, t_delta);
+                sum += member_responses[m];
+            }
+            response_step = t_index;
+            return sum / members.size();
+        }
+
+        std::string get_output_header_line(std::string delimiter) override {
+            std::string header = "ensemble_mean";
+            for (std::size_t m = 0; m < members.size(); ++m) {
+                header += delimiter + "member_" + std::to_string(m);
+            }
+            return header;
+        }
+
+        std::string get_output_line_for_timestep(int timestep, std::string delimiter) override {
+            std::vector<double> values;
+            if (!get_output_values_for_timestep(timestep, values)) {
+                return "";
+            }
+            return format_output_values(values, delimiter);
+        }
+
+        /** Values are only available for the last time step run. */
+        bool get_output_values_for_timestep(int timestep, std::vector<double> &values) override {
+            if (timestep != response_step) {
+                return false;
+            }
+            values.resize(members.size() + 1);
+            double sum = 0.0;
+            for (std::size_t m = 0; m < members.size(); ++m) {
+                values[m + 1] = member_responses[m];
+                sum += member_responses[m];
+            }
+            values[0] = sum / members.size();
+            return true;
+        }
+
+        const std::vector<std::string> &get_required_parameters() override {
+            static const std::vector<std::string> required = {"formulation", "members"};
+            return required;
+        }
+
+        /** The states of the members, one after another. */
+        void save_state(utils::StateWriter &out) override {
+            for (const auto &member : members) {
+                member->save_state(out);
+            }
+        }
+
+        void load_state(utils::StateReader &in) override {
+            for (const auto &member : members) {
+                member->load_state(in);
+            }
+        }
+
+        void load_initial_state(utils::StateReader &in) override {
+            for (const auto &member : members) {
+                member->load_initial_state(in);
+            }
+        }
+
+        void create_formulation(boost::property_tree::ptree &config, geojson::PropertyMap *global = nullptr) override {
+            create_formulation(interpret_parameters(config, global));
+        }
+
+        /**
+         * Create a member for each entry of ``members``, from the ``name`` and ``params`` of ``formulation``.
+         *
+         * @throws std::runtime_error If there are no members, or the member formulation is itself an ensemble.
+         */
+        void create_formulation(geojson::PropertyMap properties) override {
+            validate_parameters(properties);
+            const geojson::JSONProperty &formulation = properties.at("formulation");
+            const std::vector<geojson::JSONProperty> member_configs = properties.at("members").as_list();
+            std::vector<geojson::PropertyMap> member_overrides(member_configs.size());
+            for (std::size_t m = 0; m < member_configs.size(); ++m) {
+                // An empty member object, ``{}``, reads from the config as an empty string
+                if (member_configs[m].get_type() == geojson::PropertyType::Object) {
+                    member_overrides[m] = member_configs[m].get_values();
+                }
+                else if (member_configs[m].get_type() != geojson::PropertyType::String
+                         || !member_configs[m].as_string().empty()) {
+                    throw std::runtime_error("Member " + std::to_string(m) + " of ensemble " + get_id()
+                                             + " is not an object of parameters.");
+                }
+            }
+            create_members(formulation.at("name").as_string(), formulation.at("params").get_values(), member_overrides);
+        }
+
+        /**
+         * Create a member of a formulation type for each set of parameters replacing its default parameters.
+         *
+         * @param member_type The formulation type of the members.
+         * @param member_defaults The parameters of every member, unless replaced.
+         * @param member_overrides The parameters replacing those of @p member_defaults for each member.
+         * @throws std::runtime_error If there are no members, or the member formulation is itself an ensemble.
+         */
+        void create_members(const std::string &member_type, const geojson::PropertyMap &member_defaults,
+                            const std::vector<geojson::PropertyMap> &member_overrides) {
+            if (member_type == get_formulation_type()) {
+                throw std::runtime_error("The members of ensemble " + get_id() + " cannot themselves be ensembles.");
+            }
+            if (member_overrides.empty()) {
+                throw std::runtime_error("Ensemble " + get_id() + " has no members.");
+            }
+            member_constructor construct = lookup(member_type);
+            members.clear();
+            for (std::size_t m = 0; m < member_overrides.size(); ++m) {
+                geojson::PropertyMap member_params = member_defaults;
+                merge_parameters(member_params, member_overrides[m]);
+                // As for a formulation of the catchment itself, e.g. for a BMI init_config of each catchment
+                config_pattern_substitution(member_params, "init_config", "{{id}}", get_catchment_id());
+
+                std::shared_ptr<Catchment_Formulation> member =
+                        construct(get_id() + ".member_" + std::to_string(m), get_forcing_provider(), output);
+                member->create_formulation(member_params);
+                if (is_et_params_set()) {
+                    member->set_et_params(get_et_params_ptr());
+                }
+                members.push_back(member);
+            }
+            member_responses.assign(members.size(), 0.0);
+        }
+
+    private:
+
+        /**
+         * Replace parameters with those of @p overrides, merging the members of parameters that are objects.
+         *
+         * Replaced properties are erased and emplaced anew, since assigning a JSONProperty would leave a nested object
+         * or list pointing into the property it was assigned from.
+         */
+        static void merge_parameters(geojson::PropertyMap &params, const geojson::PropertyMap &overrides) {
+            for (const auto &entry : overrides) {
+                auto it = params.find(entry.first);
+                if (it != params.end() && it->second.get_type() == geojson::PropertyType::Object
+                    && entry.second.get_type() == geojson::PropertyType::Object) {
+                    geojson::PropertyMap merged = it->second.get_values();
+                    merge_parameters(merged, entry.second.get_values());
+                    params.erase(it);
+                    params.emplace(entry.first, geojson::JSONProperty(entry.first, merged));
+                    continue;
+                }
+                if (it != params.end()) {
+                    params.erase(it);
+                }
+                params.emplace(entry.first, entry.second);
+            }
+        }
+
+        member_constructor_lookup lookup;
+        std::vector<std::shared_ptr<Catchment_Formulation>> members;
+        std::vector<double> member_responses;
+        time_step_t response_step = -1;
+
+    };
+}
+
+#endif //NGEN_ENSEMBLE_FORMULATION_HPP
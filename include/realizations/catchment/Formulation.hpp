@@ -5,10 +5,12 @@
 #include <string>
 #include <map>
 #include <exception>
+#include <sstream>
 #include <vector>
 
 #include "Et_Accountable.hpp"
 #include "JSONProperty.hpp"
+#include "NumberFormat.hpp"
 #include "Pdm03.h"
 
 #include <boost/property_tree/ptree.hpp>
@@ -93,6 +95,87 @@ namespace realization {
              */
             virtual std::string get_output_line_for_timestep(int timestep,
                                                              std::string delimiter = DEFAULT_FORMULATION_OUTPUT_DELIMITER) = 0;
+
+            /**
+             * Get the output values for the given time step as numbers, rather than as a formatted line.
+             *
+             * The values are those of ``get_output_line_for_timestep``, in the same order, which lets output sinks
+             * take raw values and only build text if it is actually written as text (see ``format_output_values``).
+             * The values are written into @p values, which is resized as needed, so callers may reuse one buffer.
+             *
+             * The default implementation supports no numeric output, and returns ``false``; callers then need to use
+             * ``get_output_line_for_timestep``.
+             *
+             * @param timestep The time step for which data is desired.
+             * @param values Set to the output variable values for the given time step.
+             * @return Whether @p values was set; ``false`` if the formulation does not provide numeric output.
+             */
+            virtual bool get_output_values_for_timestep(int timestep, std::vector<double> &values) {
+                return false;
+            }
+
+            /**
+             * How output values from ``get_output_values_for_timestep`` are formatted as text.
+             *
+             * A format is a plain value, so it may be taken along with the values of a time step, and the values
+             * formatted on a thread other than the one running the formulation, e.g., one dedicated to writing output,
+             * without reading any state of the formulation there.
+             */
+            struct OutputFormat {
+                //! A negative number formats values as a stream would by default; otherwise, the fixed decimal places.
+                int precision = -1;
+
+                /**
+                 * @param values Output values, as set by ``get_output_values_for_timestep``.
+                 * @param delimiter The value delimiter for the string.
+                 * @return A delimited string of the values.
+                 */
+                std::string format(const std::vector<double> &values,
+                                   const std::string &delimiter = DEFAULT_FORMULATION_OUTPUT_DELIMITER) const {
+                    if (precision < 0) {
+                        std::ostringstream stream;
+                        for (std::size_t i = 0; i < values.size(); ++i) {
+                            if (i > 0) {
+                                stream << delimiter;
+                            }
+                            stream << values[i];
+                        }
+                        return stream.str();
+                    }
+                    std::string line;
+                    line.reserve(values.size() * (precision + 8));
+                    for (std::size_t i = 0; i < values.size(); ++i) {
+                        if (i > 0) {
+                            line.append(delimiter);
+                        }
+                        utils::number_format::append_fixed(line, values[i], precision);
+                    }
+                    return line;
+                }
+            };
+
+            /**
+             * Get how output values are formatted as ``get_output_line_for_timestep`` formats them.
+             *
+             * This is to be called on the thread running the formulation, e.g., when taking its numeric output.
+             *
+             * @return The format of the formulation's output values.
+             */
+            virtual OutputFormat get_output_format() const {
+                return OutputFormat();
+            }
+
+            /**
+             * Format output values from ``get_output_values_for_timestep`` as ``get_output_line_for_timestep`` would.
+             *
+             * @param values Output values, as set by ``get_output_values_for_timestep``.
+             * @param delimiter The value delimiter for the string.
+             * @return A delimited string of the values.
+             */
+            std::string format_output_values(const std::vector<double> &values,
+                                             std::string delimiter = DEFAULT_FORMULATION_OUTPUT_DELIMITER) const {
+                return get_output_format().format(values, delimiter);
+            }
             
             virtual void create_formulation(boost::property_tree::ptree &config, geojson::PropertyMap *global = nullptr) = 0;
             virtual void create_formulation(geojson::PropertyMap properties) = 0;
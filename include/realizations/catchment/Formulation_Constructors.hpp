@@ -4,6 +4,7 @@
 #include "Formulation.hpp"
 #include <JSONProperty.hpp>
 #include <exception>
+#include <typeinfo>
 
 #include <boost/property_tree/ptree.hpp>
 #include <boost/optional.hpp>
@@ -17,10 +18,18 @@
 #include "Bmi_Fortran_Formulation.hpp"
 #include "Bmi_Multi_Formulation.hpp"
 #include "Bmi_Py_Formulation.hpp"
+#include "Bmi_Py_Worker_Formulation.hpp"
+#include "Bmi_Batched_Formulation.hpp"
+#include "Ensemble_Formulation.hpp"
 #include <GenericDataProvider.hpp>
 #include "CsvPerFeatureForcingProvider.hpp"
+#include "ForcingStoreDataProvider.hpp"
+#include "PushedForcingDataProvider.hpp"
+#include "DerivedForcingDataProvider.hpp"
 #ifdef NETCDF_ACTIVE
     #include "NetCDFPerFeatureDataProvider.hpp"
+    #include "NetCDFGriddedDataProvider.hpp"
+    #include <FeatureCollection.hpp>
 #endif
 
 #ifdef NGEN_LSTM_TORCH_LIB_ACTIVE
@@ -46,8 +55,24 @@ namespace realization {
         {"bmi_fortran", create_formulation_constructor<Bmi_Fortran_Formulation>()},
 #endif // NGEN_BMI_FORTRAN_ACTIVE
         {"bmi_multi", create_formulation_constructor<Bmi_Multi_Formulation>()},
+        {"ensemble", [](std::string id, std::shared_ptr<data_access::GenericDataProvider> forcing_provider, utils::StreamHandler output_stream) -> std::shared_ptr<Catchment_Formulation>{
+            // Members are constructed as any other formulation of their type
+            return std::make_shared<Ensemble_Formulation>(id, forcing_provider, output_stream, [](const std::string &formulation_type) -> Ensemble_Formulation::member_constructor {
+                auto it = formulations.find(formulation_type);
+                if (it == formulations.end()) {
+                    throw std::runtime_error("Unknown ensemble member formulation type " + formulation_type);
+                }
+                return it->second;
+            });
+        }},
 #ifdef ACTIVATE_PYTHON
-        {"bmi_python", create_formulation_constructor<Bmi_Py_Formulation>()},
+        {"bmi_python", [](std::string id, std::shared_ptr<data_access::GenericDataProvider> forcing_provider, utils::StreamHandler output_stream) -> std::shared_ptr<Catchment_Formulation>{
+            // With python_workers, models are hosted by worker processes rather than this process's interpreter
+            if (models::bmi::Python_Worker_Pool::get_instance().is_enabled()) {
+                return std::make_shared<Bmi_Py_Worker_Formulation>(id, forcing_provider, output_stream);
+            }
+            return std::make_shared<Bmi_Py_Formulation>(id, forcing_provider, output_stream);
+        }},
 #endif // ACTIVATE_PYTHON
         {"tshirt", create_formulation_constructor<Tshirt_Realization>()},
         {"tshirt_c", create_formulation_constructor<Tshirt_C_Realization>()},
@@ -58,24 +83,172 @@ namespace realization {
 #endif
     };
 
+    /**
+     * A list of formulation types, for dispatching on the concrete type of a formulation at compile time.
+     */
+    template<class... T>
+    struct formulation_list {
+        enum { size = sizeof...(T) };
+    };
+
+    /**
+     * The native C++ formulations, whose time steps are run through non-virtual calls of their own ``get_response``.
+     *
+     * The position of a type in the list is the dispatch tag of formulations of exactly that type; see
+     * @ref get_native_formulation_tag.
+     */
+    typedef formulation_list<
+            Tshirt_Realization,
+            Tshirt_C_Realization,
+            Simple_Lumped_Model_Realization,
+            Bmi_Cpp_Formulation
+#ifdef NGEN_LSTM_TORCH_LIB_ACTIVE
+            ,
+            LSTM_Realization
+#endif
+    > native_formulations;
+
+    template<class List>
+    struct native_formulation_dispatch;
+
+    template<>
+    struct native_formulation_dispatch<formulation_list<>> {
+        static int tag_of(const std::type_info &type, int tag) {
+            return tag;
+        }
+
+        static double run_steps(int tag, Catchment_Formulation &formulation, time_step_t first_index, int steps,
+                                time_step_t t_delta) {
+            double response = 0.0;
+            for (int step = 0; step < steps; ++step) {
+                response += formulation.get_response(first_index + step, t_delta);
+            }
+            return response;
+        }
+    };
+
+    template<class T, class... Rest>
+    struct native_formulation_dispatch<formulation_list<T, Rest...>> {
+        static int tag_of(const std::type_info &type, int tag) {
+            return type == typeid(T) ? tag : native_formulation_dispatch<formulation_list<Rest...>>::tag_of(type, tag + 1);
+        }
+
+        static double run_steps(int tag, Catchment_Formulation &formulation, time_step_t first_index, int steps,
+                                time_step_t t_delta) {
+            if (tag != 0) {
+                return native_formulation_dispatch<formulation_list<Rest...>>::run_steps(tag - 1, formulation,
+                                                                                        first_index, steps, t_delta);
+            }
+            // The tag is only that of formulations of exactly this type, so the call needn't be virtual
+            T &typed = static_cast<T &>(formulation);
+            double response = 0.0;
+            for (int step = 0; step < steps; ++step) {
+                response += typed.T::get_response(first_index + step, t_delta);
+            }
+            return response;
+        }
+    };
+
+    /**
+     * Get the dispatch tag of a formulation, to be found once, when catchments are set up.
+     *
+     * @param formulation A formulation.
+     * @return The position in @ref native_formulations of the formulation's exact type, or the number of native
+     *         formulations if it is of none of them, e.g., a BMI formulation of a module in another language.
+     */
+    static int get_native_formulation_tag(const Catchment_Formulation &formulation) {
+        return native_formulation_dispatch<native_formulations>::tag_of(typeid(formulation), 0);
+    }
+
+    /**
+     * Run consecutive time steps of a formulation, calling the ``get_response`` of a native formulation directly.
+     *
+     * @param tag The formulation's tag, from @ref get_native_formulation_tag.
+     * @param formulation The formulation.
+     * @param first_index The index of the first time step to run.
+     * @param steps The number of time steps to run.
+     * @param t_delta The duration, in seconds, of each time step.
+     * @return The sum of the responses of the time steps.
+     */
+    static double run_formulation_steps(int tag, Catchment_Formulation &formulation, time_step_t first_index,
+                                        int steps, time_step_t t_delta) {
+        return native_formulation_dispatch<native_formulations>::run_steps(tag, formulation, first_index, steps,
+                                                                          t_delta);
+    }
+
     static bool formulation_exists(std::string formulation_type) {
         return formulations.count(formulation_type) > 0;
     }
 
-    static std::shared_ptr<Catchment_Formulation> construct_formulation(
+#ifdef NETCDF_ACTIVE
+    /**
+     * Get the polygons of the catchments of a hydrofabric, in its coordinates, for aggregating gridded forcing.
+     *
+     * Catchments without polygon geometries, e.g. of a hydrofabric read without them, are left out.
+     */
+    static data_access::NetCDFGriddedDataProvider::catchment_polygons_t get_catchment_polygons(
+        const geojson::FeatureCollection &fabric
+    ) {
+        typedef data_access::GridWeights::point_t point_t;
+        auto to_grid_polygon = [](const geojson::polygon_t &polygon) {
+            data_access::GridWeights::polygon_t converted;
+            for (const auto &point : polygon.outer()) {
+                converted.outer().push_back(point_t(bg::get<0>(point), bg::get<1>(point)));
+            }
+            for (const auto &inner : polygon.inners()) {
+                converted.inners().emplace_back();
+                for (const auto &point : inner) {
+                    converted.inners().back().push_back(point_t(bg::get<0>(point), bg::get<1>(point)));
+                }
+            }
+            return converted;
+        };
+
+        data_access::NetCDFGriddedDataProvider::catchment_polygons_t catchments;
+        for (const geojson::Feature &feature : fabric) {
+            data_access::GridWeights::multipolygon_t shape;
+            if (feature->get_type() == geojson::FeatureType::Polygon) {
+                shape.push_back(to_grid_polygon(feature->geometry<geojson::polygon_t>()));
+            }
+            else if (feature->get_type() == geojson::FeatureType::MultiPolygon) {
+                for (const geojson::polygon_t &polygon : feature->geometry<geojson::multipolygon_t>()) {
+                    shape.push_back(to_grid_polygon(polygon));
+                }
+            }
+            if (!shape.empty() && !shape.front().outer().empty()) {
+                catchments.emplace_back(feature->get_id(), std::move(shape));
+            }
+        }
+        return catchments;
+    }
+#endif
+
+    static std::shared_ptr<data_access::GenericDataProvider> construct_forcing_provider(
         std::string formulation_type,
         std::string identifier,
         forcing_params &forcing_config,
         utils::StreamHandler output_stream
     ) {
-        constructor formulation_constructor = formulations.at(formulation_type);
         std::shared_ptr<data_access::GenericDataProvider> fp;
         if (forcing_config.provider == "CsvPerFeature" || forcing_config.provider == ""){
-            fp = std::make_shared<CsvPerFeatureForcingProvider>(forcing_config);
+            fp = CsvPerFeatureForcingProvider::get_shared_provider(forcing_config);
+        }
+        else if (forcing_config.provider == "ForcingStore"){
+            fp = data_access::ForcingStoreDataProvider::get_shared_provider(forcing_config.path, forcing_config.simulation_start_t, forcing_config.simulation_end_t);
+        }
+        else if (forcing_config.provider == "Pushed"){
+            // The path names forcing the program running ngen pushes into memory
+            fp = data_access::PushedForcingDataProvider::get_shared_provider(forcing_config.path);
         }
 #ifdef NETCDF_ACTIVE
         else if (forcing_config.provider == "NetCDF"){
-            fp = data_access::NetCDFPerFeatureDataProvider::get_shared_provider(forcing_config.path, forcing_config.simulation_start_t, forcing_config.simulation_end_t, output_stream);
+            fp = data_access::NetCDFPerFeatureDataProvider::get_shared_provider(forcing_config.path, forcing_config.simulation_start_t, forcing_config.simulation_end_t, output_stream, forcing_config.cache_size_mb, forcing_config.prefetch_blocks, forcing_config.feature_ids);
+        }
+        else if (forcing_config.provider == "NetCDFGridded"){
+            std::shared_ptr<geojson::FeatureCollection> fabric = forcing_config.fabric;
+            fp = data_access::NetCDFGriddedDataProvider::get_shared_provider(forcing_config.path, forcing_config.simulation_start_t, forcing_config.simulation_end_t, output_stream, forcing_config.weights_path, [fabric]() {
+                return fabric == nullptr ? data_access::NetCDFGriddedDataProvider::catchment_polygons_t() : get_catchment_polygons(*fabric);
+            }, forcing_config.cache_size_mb, forcing_config.feature_ids);
         }
 #endif
         else { // Some unknown string in the provider field?
@@ -84,9 +257,49 @@ namespace realization {
                     "\", formulation_type: \"" + formulation_type +
                     "\", provider: \"" + forcing_config.provider + "\"");
         }
+        if (!forcing_config.derived_variables.empty()) {
+            // Every catchment of the process is derived at once from providers of many catchments, but a CSV file
+            // holds the forcing of only one
+            bool is_per_catchment_file = forcing_config.provider == "CsvPerFeature" || forcing_config.provider == "";
+            fp = data_access::DerivedForcingDataProvider::get_shared_provider(fp, forcing_config.derived_variables,
+                                                                              is_per_catchment_file ? nullptr : forcing_config.feature_ids);
+        }
+        return fp;
+    };
+
+    static std::shared_ptr<Catchment_Formulation> construct_formulation(
+        std::string formulation_type,
+        std::string identifier,
+        forcing_params &forcing_config,
+        utils::StreamHandler output_stream
+    ) {
+        constructor formulation_constructor = formulations.at(formulation_type);
+        std::shared_ptr<data_access::GenericDataProvider> fp = construct_forcing_provider(formulation_type, identifier,
+                                                                                         forcing_config, output_stream);
         return formulation_constructor(identifier, fp, output_stream);
     };
 
+    /**
+     * A formulation of a type configured from properties as a prototype, to create the formulations of the catchments
+     * configured alike from (see Catchment_Formulation::create_from_prototype).
+     *
+     * @param formulation_type The type of formulation.
+     * @param properties The properties, which are validated.
+     * @return The prototype, or null if formulations of the type cannot be created from one.
+     * @throws std::runtime_error If the properties are not valid for the type.
+     */
+    static std::shared_ptr<Catchment_Formulation> construct_prototype_formulation(
+        const std::string &formulation_type,
+        const geojson::PropertyMap &properties
+    ) {
+        auto found = formulations.find(formulation_type);
+        if (found == formulations.end()) {
+            return nullptr;
+        }
+        std::shared_ptr<Catchment_Formulation> prototype = found->second("prototype", nullptr, utils::StreamHandler());
+        return prototype->configure_prototype(properties) ? prototype : nullptr;
+    };
+
     static std::string get_formulation_key(const boost::property_tree::ptree &tree) {
         /*for (auto &node : tree) {
             if (formulation_exists(node.first)) {
@@ -100,6 +313,23 @@ namespace realization {
 
         throw std::runtime_error("No valid formulation for " + *key + " was described in the passed in tree.");
     }
+
+    /**
+     * Get the optional ``time_step`` of a formulation config, alongside its ``name`` and ``params``.
+     *
+     * @param tree The formulation config.
+     * @return The duration, in seconds, of the formulation's own time steps, or ``0`` if it steps at the output
+     *         interval.
+     * @see Catchment_Formulation::get_time_step_seconds
+     */
+    static long get_formulation_time_step(const boost::property_tree::ptree &tree) {
+        boost::optional<long> time_step = tree.get_optional<long>("time_step");
+        if (time_step && *time_step <= 0) {
+            throw std::runtime_error("The time_step of formulation " + tree.get<std::string>("name", "") +
+                                     " must be a positive number of seconds.");
+        }
+        return time_step ? *time_step : 0;
+    }
 }
 
 #endif // NGEN_FORMULATION_CONSTRUCTORS_H
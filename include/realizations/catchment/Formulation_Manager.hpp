@@ -1,23 +1,50 @@
 #ifndef NGEN_FORMULATION_MANAGER_H
 #define NGEN_FORMULATION_MANAGER_H
 
+#include <algorithm>
+#include <fstream>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <tuple>
 #include <functional>
+#include <unordered_map>
+#include <unordered_set>
 #include <dirent.h>
 #include <regex>
+#include <sys/stat.h>
 
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/json_parser.hpp>
 #include <FeatureBuilder.hpp>
 #include "features/Features.hpp"
 #include <FeatureCollection.hpp>
+#include <FeatureCache.hpp>
 #include "Formulation_Constructors.hpp"
+#include "Cached_Response_Formulation.hpp"
+#include "CsvForcingPreloader.hpp"
+#include "Catchment_State_Pager.hpp"
+#include "Response_Cache.hpp"
 #include "Simulation_Time.h"
 #include "GIUH.hpp"
 #include "GiuhJsonReader.h"
 #include "routing/Routing_Params.h"
+#include "core/Execution_Params.h"
+#include "core/Output_Params.h"
+#include "core/catchment/CatchmentOutputAggregator.hpp"
+#include "core/Channel_Routing_Params.h"
+#include "core/Spinup_Params.h"
+#include "core/AutoTune.hpp"
+#include "Logger.hpp"
+#include "StartupProfile.hpp"
+#include "JsonMemberFilter.hpp"
+#include "CompressedOutputStream.hpp"
+#include "IdSelector.hpp"
+#include "ThreadPool.hpp"
+
+#ifdef ACTIVATE_PYTHON
+#include <pybind11/pybind11.h>
+#endif // ACTIVATE_PYTHON
 
 namespace realization {
 
@@ -32,16 +59,53 @@ namespace realization {
                 boost::property_tree::ptree loaded_tree;
                 boost::property_tree::json_parser::read_json(data, loaded_tree);
                 this->tree = loaded_tree;
+                autotune::apply_tuning_file(this->tree);
             }
 
             Formulation_Manager(const std::string &file_path) {
                 boost::property_tree::ptree loaded_tree;
                 boost::property_tree::json_parser::read_json(file_path, loaded_tree);
                 this->tree = loaded_tree;
+                autotune::apply_tuning_file(this->tree);
+            }
+
+            /**
+             * Load a realization config file, keeping only the ``catchments`` entries of the given catchments.
+             *
+             * This is meant for when only a partition of the hydrofabric is run (e.g., by one MPI rank): the entries
+             * of other catchments are dropped while the file is read, so they are never parsed or held in memory.
+             *
+             * @param file_path The path of the realization config file.
+             * @param catchment_ids The ids of the catchments whose own config is needed.
+             */
+            Formulation_Manager(const std::string &file_path, const std::unordered_set<std::string> &catchment_ids) {
+                boost::property_tree::ptree loaded_tree;
+                std::ifstream file(file_path);
+                std::string kept;
+                utils::JsonMemberFilter filter("catchments", [&catchment_ids](const std::string &id) {
+                    return catchment_ids.count(id) > 0;
+                });
+                bool is_filtered = file && filter.filter(file, kept);
+                if (is_filtered) {
+                    std::stringstream data(kept);
+                    try {
+                        boost::property_tree::json_parser::read_json(data, loaded_tree);
+                    }
+                    catch (const boost::property_tree::json_parser_error &e) {
+                        is_filtered = false;
+                    }
+                }
+                if (!is_filtered) {
+                    // Let the whole file be parsed, so any error is reported against it
+                    boost::property_tree::json_parser::read_json(file_path, loaded_tree);
+                }
+                this->tree = loaded_tree;
+                autotune::apply_tuning_file(this->tree);
             }
 
             Formulation_Manager(boost::property_tree::ptree &loaded_tree) {
                 this->tree = loaded_tree;
+                autotune::apply_tuning_file(this->tree);
             }
 
             virtual ~Formulation_Manager(){};
@@ -52,6 +116,13 @@ namespace realization {
                 //which has to iterate the entire hydrofabric.
                 auto possible_global_config = tree.get_child_optional("global");
 
+                std::shared_ptr<std::vector<std::string>> fabric_ids = std::make_shared<std::vector<std::string>>();
+                for (geojson::Feature location : *fabric) {
+                    fabric_ids->push_back(location->get_id());
+                }
+                this->feature_ids = fabric_ids;
+                this->fabric = fabric;
+
                 if (possible_global_config) {
                     this->global_formulation_tree = *possible_global_config;
 
@@ -73,51 +144,7 @@ namespace realization {
                     }
                 }
 
-                /**
-                 * Read simulation time from configuration file
-                 * /// \todo TODO: Separate input_interval from output_interval
-                 */            
-                auto possible_simulation_time = tree.get_child_optional("time");
-
-                if (!possible_simulation_time) {
-                    throw std::runtime_error("ERROR: No simulation time period defined.");
-                }
-
-                geojson::JSONProperty simulation_time_parameters("time", *possible_simulation_time);
-
-                std::vector<std::string> missing_simulation_time_parameters;
-
-                if (!simulation_time_parameters.has_key("start_time")) {
-                    missing_simulation_time_parameters.push_back("start_time");
-                }
-
-                if (!simulation_time_parameters.has_key("end_time")) {
-                    missing_simulation_time_parameters.push_back("end_time");
-                }
-
-                if (!simulation_time_parameters.has_key("output_interval")) {
-                    missing_simulation_time_parameters.push_back("output_interval");
-                }
-
-                if (missing_simulation_time_parameters.size() > 0) {
-                    std::string message = "ERROR: A simulation time parameter cannot be created; the following parameters are missing: ";
-
-                    for (int missing_parameter_index = 0; missing_parameter_index < missing_simulation_time_parameters.size(); missing_parameter_index++) {
-                        message += missing_simulation_time_parameters[missing_parameter_index];
-
-                        if (missing_parameter_index < missing_simulation_time_parameters.size() - 1) {
-                            message += ", ";
-                        }
-                    }
-                    
-                    throw std::runtime_error(message);
-                }
-
-                simulation_time_params simulation_time_config(
-                    simulation_time_parameters.at("start_time").as_string(),
-                    simulation_time_parameters.at("end_time").as_string(),
-                    simulation_time_parameters.at("output_interval").as_natural_number()
-                );
+                simulation_time_params simulation_time_config = this->get_simulation_time_config();
 
                 /**
                  * Call constructor to construct a Simulation_Time object
@@ -138,27 +165,375 @@ namespace realization {
                     this->routing_config = std::make_shared<routing_params>(
                         routing_parameters.at("t_route_config_file_with_path").as_string()
                     );
+                    if (routing_parameters.has_key("in_memory_flows")) {
+                        this->routing_config->in_memory_flows = routing_parameters.at("in_memory_flows").as_boolean();
+                        this->routing_config->in_memory_flows_given = true;
+                    }
+                    if (routing_parameters.has_key("flow_chunk_steps")) {
+                        this->routing_config->flow_chunk_steps = routing_parameters.at("flow_chunk_steps").as_natural_number();
+                    }
+                    if (routing_parameters.has_key("pipelined")) {
+                        this->routing_config->pipelined = routing_parameters.at("pipelined").as_boolean();
+                    }
+                    if (this->routing_config->pipelined) {
+                        // Chunks are handed over in memory, so pipelining implies in memory flows
+                        if (this->routing_config->in_memory_flows_given && !this->routing_config->in_memory_flows) {
+                            throw std::runtime_error("Pipelined routing requires in_memory_flows.");
+                        }
+                        if (this->routing_config->flow_chunk_steps <= 0) {
+                            throw std::runtime_error("Pipelined routing requires a positive flow_chunk_steps.");
+                        }
+                        this->routing_config->in_memory_flows = true;
+                        this->routing_config->in_memory_flows_given = true;
+                    }
                     using_routing = true;
                 #else
                     using_routing = false;
-                    std::cerr<<"WARNING: Formulation Manager found routing configuration"
-                             <<", but routing support isn't enabled. No routing will occur."<<std::endl;
+                    NGEN_LOG_WARNING("Formulation Manager found routing configuration"
+                                     << ", but routing support isn't enabled. No routing will occur.");
                 #endif //NGEN_ROUTING_ACTIVE
                  }
 
+                /**
+                 * Read optional execution configurations from configuration file
+                 */
+                auto possible_execution_configs = tree.get_child_optional("execution");
+
+                if (possible_execution_configs) {
+                    geojson::JSONProperty execution_parameters("execution", *possible_execution_configs);
+
+                    if (execution_parameters.has_key("catchment_threads")) {
+                        this->execution_config.catchment_threads = execution_parameters.at("catchment_threads").as_natural_number();
+                    }
+
+                    if (execution_parameters.has_key("pin_threads")) {
+                        this->execution_config.pin_threads = execution_parameters.at("pin_threads").as_boolean();
+                    }
+
+                    if (execution_parameters.has_key("lookahead")) {
+                        this->execution_config.lookahead = execution_parameters.at("lookahead").as_natural_number();
+                    }
+
+                    if (execution_parameters.has_key("time_block")) {
+                        this->execution_config.time_block = execution_parameters.at("time_block").as_natural_number();
+                        if (this->execution_config.time_block < 1) {
+                            throw std::runtime_error("The execution time_block must be at least 1.");
+                        }
+                    }
+
+                    if (execution_parameters.has_key("init_threads")) {
+                        this->execution_config.init_threads = execution_parameters.at("init_threads").as_natural_number();
+                    }
+
+                    if (execution_parameters.has_key("forcing_preload_threads")) {
+                        this->execution_config.forcing_preload_threads = execution_parameters.at("forcing_preload_threads").as_natural_number();
+                    }
+
+                    if (execution_parameters.has_key("checkpoint_interval")) {
+                        this->execution_config.checkpoint_interval = execution_parameters.at("checkpoint_interval").as_natural_number();
+                    }
+
+                    if (execution_parameters.has_key("checkpoint_path")) {
+                        this->execution_config.checkpoint_path = execution_parameters.at("checkpoint_path").as_string();
+                    }
+
+                    if (execution_parameters.has_key("checkpoint_incremental")) {
+                        this->execution_config.checkpoint_incremental = execution_parameters.at("checkpoint_incremental").as_boolean();
+                    }
+
+                    if (execution_parameters.has_key("rebalance_threshold")) {
+                        this->execution_config.rebalance_threshold = execution_parameters.at("rebalance_threshold").as_real_number();
+                    }
+
+                    if (execution_parameters.has_key("remote_transport")) {
+                        this->execution_config.remote_transport = execution_parameters.at("remote_transport").as_string();
+                        if (this->execution_config.remote_transport != "neighbor_collective"
+                            && this->execution_config.remote_transport != "one_sided"
+                            && this->execution_config.remote_transport != "reduce_scatter") {
+                            throw std::runtime_error("Unknown execution remote_transport '"
+                                                     + this->execution_config.remote_transport
+                                                     + "'; use neighbor_collective, one_sided or reduce_scatter.");
+                        }
+                    }
+
+                    if (execution_parameters.has_key("reduce_scatter_steps")) {
+                        this->execution_config.reduce_scatter_steps = execution_parameters.at("reduce_scatter_steps").as_natural_number();
+                        if (this->execution_config.reduce_scatter_steps < 1) {
+                            throw std::runtime_error("The execution reduce_scatter_steps must be at least 1.");
+                        }
+                    }
+
+                    if (execution_parameters.has_key("remote_chunk_steps")) {
+                        this->execution_config.remote_chunk_steps = execution_parameters.at("remote_chunk_steps").as_natural_number();
+                        if (this->execution_config.remote_chunk_steps < 1) {
+                            throw std::runtime_error("The execution remote_chunk_steps must be at least 1.");
+                        }
+                    }
+
+                    if (execution_parameters.has_key("response_cache")) {
+                        this->execution_config.response_cache = execution_parameters.at("response_cache").as_string();
+                    }
+
+                    if (execution_parameters.has_key("python_workers")) {
+                        this->execution_config.python_workers = execution_parameters.at("python_workers").as_natural_number();
+                    }
+
+                    if (execution_parameters.has_key("page_block")) {
+                        this->execution_config.page_block = execution_parameters.at("page_block").as_natural_number();
+                    }
+
+                    if (execution_parameters.has_key("page_dir")) {
+                        this->execution_config.page_dir = execution_parameters.at("page_dir").as_string();
+                    }
+
+                    if (execution_parameters.has_key("exact_flow_sums")) {
+                        this->execution_config.exact_flow_sums = execution_parameters.at("exact_flow_sums").as_boolean();
+                    }
+
+                    if (execution_parameters.has_key("device_overlap")) {
+                        this->execution_config.device_overlap = execution_parameters.at("device_overlap").as_boolean();
+                    }
+                }
+
+                #ifdef ACTIVATE_PYTHON
+                //Python formulations are constructed for the workers, if any, from here on
+                models::bmi::Python_Worker_Pool::get_instance().set_size(this->execution_config.python_workers);
+                #else
+                if (this->execution_config.python_workers > 0) {
+                    NGEN_LOG_WARNING("python_workers has no effect in builds without Python support");
+                }
+                #endif // ACTIVATE_PYTHON
+
+                if (!this->execution_config.response_cache.empty()) {
+                    if (this->is_response_cache_allowed) {
+                        this->response_cache = std::make_shared<Response_Cache>(this->execution_config.response_cache);
+                    }
+                    else {
+                        NGEN_LOG_WARNING("the execution response_cache is not used by restarted or cycled runs");
+                    }
+                }
+
+                if (this->execution_config.page_block > 0) {
+                    this->state_pager = std::make_shared<Catchment_State_Pager>(this->execution_config.page_dir,
+                                                                                this->execution_config.page_block);
+                }
+
+                /**
+                 * Read optional output configurations from configuration file
+                 */
+                auto possible_output_configs = tree.get_child_optional("output");
+
+                if (possible_output_configs) {
+                    geojson::JSONProperty output_parameters("output", *possible_output_configs);
+
+                    if (output_parameters.has_key("nexus_format")) {
+                        this->output_config.nexus_format = output_parameters.at("nexus_format").as_string();
+                    }
+
+                    if (output_parameters.has_key("nexus_path")) {
+                        this->output_config.nexus_path = output_parameters.at("nexus_path").as_string();
+                    }
+
+                    if (output_parameters.has_key("nexus_buffer_steps")) {
+                        this->output_config.nexus_buffer_steps = output_parameters.at("nexus_buffer_steps").as_natural_number();
+                    }
+
+                    if (output_parameters.has_key("csv_compression")) {
+                        this->output_config.csv_compression = output_parameters.at("csv_compression").as_string();
+                        // Fail on an unknown compression, or one not built in, now rather than once outputs are opened
+                        utils::parse_compression(this->output_config.csv_compression);
+                    }
+
+                    if (output_parameters.has_key("csv_compression_level")) {
+                        this->output_config.csv_compression_level = output_parameters.at("csv_compression_level").as_natural_number();
+                    }
+
+                    if (output_parameters.has_key("csv_buffer_mb")) {
+                        this->output_config.csv_buffer_mb = output_parameters.at("csv_buffer_mb").as_natural_number();
+                    }
+
+                    if (output_parameters.has_key("catchment_queue_size")) {
+                        this->output_config.catchment_queue_size = output_parameters.at("catchment_queue_size").as_natural_number();
+                    }
+
+                    if (output_parameters.has_key("catchment_format")) {
+                        this->output_config.catchment_format = output_parameters.at("catchment_format").as_string();
+                        if (this->output_config.catchment_format != "csv" && this->output_config.catchment_format != "binary"
+                            && this->output_config.catchment_format != "stream" && this->output_config.catchment_format != "parquet") {
+                            throw std::runtime_error("Unknown catchment output format '" + this->output_config.catchment_format
+                                                     + "'; expected csv, binary, stream or parquet.");
+                        }
+                    }
+
+                    if (output_parameters.has_key("catchment_path")) {
+                        this->output_config.catchment_path = output_parameters.at("catchment_path").as_string();
+                    }
+
+                    if (output_parameters.has_key("catchment_buffer_mb")) {
+                        this->output_config.catchment_buffer_mb = output_parameters.at("catchment_buffer_mb").as_natural_number();
+                    }
+
+                    if (output_parameters.has_key("stream_subscribers")) {
+                        this->output_config.stream_subscribers = output_parameters.at("stream_subscribers").as_natural_number();
+                    }
+
+                    if (output_parameters.has_key("catchment_aggregation_steps")) {
+                        this->output_config.catchment_aggregation_steps = output_parameters.at("catchment_aggregation_steps").as_natural_number();
+                    }
+
+                    auto possible_catchment_variables = possible_output_configs->get_child_optional("catchment_variables");
+                    if (possible_catchment_variables) {
+                        for (const auto& variable : *possible_catchment_variables) {
+                            std::string method = variable.second.get_value<std::string>();
+                            // Fail on an unknown method now, rather than once the catchments are running
+                            catchment_output::CatchmentOutputAggregator::parse_method(method);
+                            this->output_config.catchment_variables.emplace_back(variable.first, method);
+                        }
+                    }
+
+                    // Each selection is a list of ids and patterns, or the path of a file of them, one per line
+                    for (const auto& selection : {std::make_pair("catchment_selection", &this->output_config.catchment_selection),
+                                                  std::make_pair("nexus_selection", &this->output_config.nexus_selection)}) {
+                        auto possible_selection = possible_output_configs->get_child_optional(selection.first);
+                        if (!possible_selection) {
+                            continue;
+                        }
+                        if (possible_selection->empty()) {
+                            // An empty list has no value either, and selects everything
+                            std::string path = possible_selection->get_value<std::string>();
+                            if (!path.empty()) {
+                                *selection.second = utils::IdSelector::read_entries(path);
+                            }
+                        }
+                        else {
+                            for (const auto& entry : *possible_selection) {
+                                selection.second->push_back(entry.second.get_value<std::string>());
+                            }
+                        }
+                    }
+
+                    if (output_parameters.has_key("terminal_nexuses_only")) {
+                        this->output_config.terminal_nexuses_only = output_parameters.at("terminal_nexuses_only").as_boolean();
+                    }
+
+                    if (output_parameters.has_key("profile_path")) {
+                        this->output_config.profile_path = output_parameters.at("profile_path").as_string();
+                    }
+
+                    if (output_parameters.has_key("profile_trace")) {
+                        this->output_config.profile_trace = output_parameters.at("profile_trace").as_boolean();
+                    }
+
+                    if (output_parameters.has_key("profile_counters")) {
+                        this->output_config.profile_counters = output_parameters.at("profile_counters").as_boolean();
+                    }
+
+                    if (output_parameters.has_key("progress_interval")) {
+                        this->output_config.progress_interval = output_parameters.at("progress_interval").as_natural_number();
+                    }
+
+                    if (output_parameters.has_key("metrics_path")) {
+                        this->output_config.metrics_path = output_parameters.at("metrics_path").as_string();
+                    }
+
+                    if (output_parameters.has_key("status_path")) {
+                        this->output_config.status_path = output_parameters.at("status_path").as_string();
+                    }
+                }
+
+                /**
+                 * Read optional built-in channel routing configurations from configuration file
+                 */
+                auto possible_channel_routing_configs = tree.get_child_optional("channel_routing");
+
+                if (possible_channel_routing_configs) {
+                    geojson::JSONProperty channel_routing_parameters("channel_routing", *possible_channel_routing_configs);
+                    this->channel_routing_config.enabled = true;
+
+                    if (channel_routing_parameters.has_key("flowpath_data")) {
+                        this->channel_routing_config.flowpath_data = channel_routing_parameters.at("flowpath_data").as_string();
+                    }
+
+                    if (channel_routing_parameters.has_key("substeps")) {
+                        this->channel_routing_config.substeps = channel_routing_parameters.at("substeps").as_natural_number();
+                    }
+
+                    if (channel_routing_parameters.has_key("length_m")) {
+                        this->channel_routing_config.length_m = channel_routing_parameters.at("length_m").as_real_number();
+                    }
+
+                    if (channel_routing_parameters.has_key("slope")) {
+                        this->channel_routing_config.slope = channel_routing_parameters.at("slope").as_real_number();
+                    }
+
+                    if (channel_routing_parameters.has_key("mannings_n")) {
+                        this->channel_routing_config.mannings_n = channel_routing_parameters.at("mannings_n").as_real_number();
+                    }
+
+                    if (channel_routing_parameters.has_key("bottom_width_m")) {
+                        this->channel_routing_config.bottom_width_m = channel_routing_parameters.at("bottom_width_m").as_real_number();
+                    }
+
+                    if (channel_routing_parameters.has_key("side_slope")) {
+                        this->channel_routing_config.side_slope = channel_routing_parameters.at("side_slope").as_real_number();
+                    }
+                }
+
+                /**
+                 * Read optional spin-up configurations from configuration file
+                 */
+                auto possible_spinup_configs = tree.get_child_optional("spinup");
+
+                if (possible_spinup_configs) {
+                    geojson::JSONProperty spinup_parameters("spinup", *possible_spinup_configs);
+                    this->spinup_config.enabled = true;
+
+                    if (!spinup_parameters.has_key("start_time")) {
+                        throw std::runtime_error("ERROR: The spinup configuration has no start_time.");
+                    }
+                    this->spinup_config.start_time = spinup_parameters.at("start_time").as_string();
+
+                    if (spinup_parameters.has_key("cache")) {
+                        this->spinup_config.cache_path = spinup_parameters.at("cache").as_string();
+                    }
+                }
+
+                //Signatures of catchments start from those of the configs every catchment may depend on
+                if (this->response_cache != nullptr || this->is_signature_recorded) {
+                    std::stringstream shared_json;
+                    boost::property_tree::json_parser::write_json(shared_json, this->global_formulation_tree, false);
+                    if (possible_spinup_configs) {
+                        boost::property_tree::json_parser::write_json(shared_json, *possible_spinup_configs, false);
+                    }
+                    this->global_config_signature = Response_Cache::hash(shared_json.str());
+                }
+
+                //Formulations are independent of each other, so they may be constructed (and their models initialized)
+                //concurrently
+                utils::ThreadPool construction_pool(this->execution_config.init_threads);
+                this->is_construction_sequential = construction_pool.size() <= 1;
+                #ifdef ACTIVATE_PYTHON
+                //Python formulations take the GIL to construct their models, so this thread must not hold it meanwhile
+                std::unique_ptr<pybind11::gil_scoped_release> python_gil_release;
+                if (construction_pool.size() > 1 && Py_IsInitialized() && PyGILState_Check()) {
+                    python_gil_release = std::unique_ptr<pybind11::gil_scoped_release>(new pybind11::gil_scoped_release());
+                }
+                #endif // ACTIVATE_PYTHON
+
                 /**
                  * Read catchment configurations from configuration file
                  */      
                 auto possible_catchment_configs = tree.get_child_optional("catchments");
 
                 if (possible_catchment_configs) {
-                    for (std::pair<std::string, boost::property_tree::ptree> catchment_config : *possible_catchment_configs) {
+                    std::vector<std::pair<const std::string*, boost::property_tree::ptree*>> catchment_configs;
+                    for (auto &catchment_config : *possible_catchment_configs) {
                       if( fabric->find(catchment_config.first) == -1 )
                       {
                         #ifndef NGEN_QUIET
-                        std::cerr<<"WARNING Formulation_Manager::read: Cannot create formulation for catchment "
-                                 <<catchment_config.first
-                                 <<" that isn't identified in the hydrofabric or requested subset"<<std::endl;
+                        NGEN_LOG_WARNING("Formulation_Manager::read: Cannot create formulation for catchment "
+                                         << catchment_config.first
+                                         << " that isn't identified in the hydrofabric or requested subset");
                         #endif
                         continue;
                       }
@@ -167,33 +542,78 @@ namespace realization {
                         throw std::runtime_error("ERROR: No formulations defined for "+catchment_config.first+".");
                       }
 
-                      for (const auto &formulation: *formulations) {
-                          this->add_formulation(
-                              this->construct_formulation_from_tree(
-                                  simulation_time_config,
-                                  catchment_config.first,
-                                  catchment_config.second,
-                                  formulation.second,
-                                  output_stream
-                              )
-                          );
-                          break; //only construct one for now FIXME
-                        } //end for formulaitons
+                      catchment_configs.emplace_back(&catchment_config.first, &catchment_config.second);
                       }//end for catchments
 
+                    construction_pool.parallel_for(catchment_configs.size(), [&](size_t i) {
+                        const std::string &identifier = *catchment_configs[i].first;
+                        boost::property_tree::ptree &catchment_tree = *catchment_configs[i].second;
+                        for (const auto &formulation: catchment_tree.get_child("formulations")) {
+                            this->add_formulation(
+                                this->construct_formulation_from_tree(
+                                    simulation_time_config,
+                                    identifier,
+                                    catchment_tree,
+                                    formulation.second,
+                                    output_stream
+                                )
+                            );
+                            break; //only construct one for now FIXME
+                        } //end for formulaitons
+                    });
 
                 }//end if possible_catchment_configs
 
+                std::vector<std::string> missing_ids;
                 for (geojson::Feature location : *fabric) {
                     if (not this->contains(location->get_id())) {
+                        missing_ids.push_back(location->get_id());
+                    }
+                }
+
+                if (!missing_ids.empty()) {
+                    this->compile_global_template();
+                }
+                std::unique_ptr<CsvForcingPreloader> forcing_preloader = this->preload_global_forcing(missing_ids, simulation_time_config);
+
+                long batch_size = 1;
+                if (global_formulation_parameters.count(BMI_REALIZATION_CFG_PARAM_OPT__BATCH_SIZE) != 0) {
+                    batch_size = global_formulation_parameters.at(BMI_REALIZATION_CFG_PARAM_OPT__BATCH_SIZE).as_natural_number();
+                }
+                if (batch_size > 1) {
+                    size_t batch_count = (missing_ids.size() + batch_size - 1) / batch_size;
+                    construction_pool.parallel_for(batch_count, [&](size_t b) {
+                        size_t begin = b * batch_size;
+                        size_t end = std::min(missing_ids.size(), begin + (size_t)batch_size);
+                        this->construct_missing_formulation_batch(
+                          std::vector<std::string>(missing_ids.begin() + begin, missing_ids.begin() + end),
+                          output_stream, simulation_time_config);
+                    });
+                }
+                else {
+                    construction_pool.parallel_for(missing_ids.size(), [&](size_t i) {
                         std::shared_ptr<Catchment_Formulation> missing_formulation = this->construct_missing_formulation(
-                          location->get_id(), output_stream, simulation_time_config);
+                          missing_ids[i], output_stream, simulation_time_config);
                         this->add_formulation(missing_formulation);
-                    }
+                    });
+                }
+                if (forcing_preloader != nullptr) {
+                    forcing_preloader->wait();
                 }
             }
 
+            /**
+             * Add a formulation to the collection.
+             *
+             * This is safe to call from several threads at once, e.g., while formulations are constructed concurrently.
+             * With a @ref get_state_pager "state pager", the formulation's model is paged out right away, so no more
+             * than a block of models need ever be in memory at once.
+             */
             virtual void add_formulation(std::shared_ptr<Catchment_Formulation> formulation) {
+                if (this->state_pager != nullptr) {
+                    this->state_pager->page_out(*formulation);
+                }
+                const std::lock_guard<std::mutex> lock(*this->formulations_mutex);
                 this->formulations.emplace(formulation->get_id(), formulation);
             }
 
@@ -245,6 +665,192 @@ namespace realization {
                     return "";
             }
 
+            /**
+             * Read the simulation time of the config, which @ref read also does.
+             *
+             * @throws std::runtime_error If the config has no ``time``, or it lacks a parameter.
+             * /// \todo TODO: Separate input_interval from output_interval
+             */
+            simulation_time_params get_simulation_time_config() const {
+                auto possible_simulation_time = tree.get_child_optional("time");
+
+                if (!possible_simulation_time) {
+                    throw std::runtime_error("ERROR: No simulation time period defined.");
+                }
+
+                geojson::JSONProperty simulation_time_parameters("time", *possible_simulation_time);
+
+                std::vector<std::string> missing_simulation_time_parameters;
+
+                if (!simulation_time_parameters.has_key("start_time")) {
+                    missing_simulation_time_parameters.push_back("start_time");
+                }
+
+                if (!simulation_time_parameters.has_key("end_time")) {
+                    missing_simulation_time_parameters.push_back("end_time");
+                }
+
+                if (!simulation_time_parameters.has_key("output_interval")) {
+                    missing_simulation_time_parameters.push_back("output_interval");
+                }
+
+                if (missing_simulation_time_parameters.size() > 0) {
+                    std::string message = "ERROR: A simulation time parameter cannot be created; the following parameters are missing: ";
+
+                    for (int missing_parameter_index = 0; missing_parameter_index < missing_simulation_time_parameters.size(); missing_parameter_index++) {
+                        message += missing_simulation_time_parameters[missing_parameter_index];
+
+                        if (missing_parameter_index < missing_simulation_time_parameters.size() - 1) {
+                            message += ", ";
+                        }
+                    }
+                    
+                    throw std::runtime_error(message);
+                }
+
+                return simulation_time_params(
+                    simulation_time_parameters.at("start_time").as_string(),
+                    simulation_time_parameters.at("end_time").as_string(),
+                    simulation_time_parameters.at("output_interval").as_natural_number()
+                );
+            }
+
+            /**
+             * Get the formulation type of a catchment, e.g. ``bmi_c``, from the config alone, without reading it or
+             * constructing the formulation; as @ref read does, this is that of the catchment's own first formulation,
+             * or of the global one.
+             *
+             * @param identifier The id of the catchment.
+             * @return The type, or an empty string if the config has no formulation for the catchment.
+             */
+            std::string get_formulation_type(const std::string &identifier) const {
+                auto possible_catchment_configs = tree.get_child_optional("catchments");
+                if (possible_catchment_configs) {
+                    auto catchment_config = possible_catchment_configs->find(identifier);
+                    if (catchment_config != possible_catchment_configs->not_found()) {
+                        auto formulations = catchment_config->second.get_child_optional("formulations");
+                        if (formulations && !formulations->empty()) {
+                            return formulations->front().second.get<std::string>("name", "");
+                        }
+                    }
+                }
+                return tree.get<std::string>("global.formulations..name", "");
+            }
+
+            /**
+             * @return The ``catchment_threads`` of the execution config, as @ref read gives it, without reading the
+             *         config
+             */
+            int get_catchment_threads_config() const {
+                return tree.get<int>("execution.catchment_threads", execution_params().catchment_threads);
+            }
+
+            /**
+             * @return The routing configuration, which uses defaults if routing isn't configured
+             */
+            routing_params get_routing_params() {
+                return this->routing_config != nullptr ? *this->routing_config : routing_params();
+            }
+
+            /**
+             * @return The execution configuration, which uses defaults for anything not in the config
+             */
+            const execution_params& get_execution_params() const {
+                return this->execution_config;
+            }
+
+            /**
+             * Keep formulations from replaying cached responses, even if the config has a ``response_cache``.
+             *
+             * This must be called before @ref read, e.g. for a run continuing a simulation beyond the time steps
+             * responses were cached for.
+             */
+            void disallow_response_cache() {
+                this->is_response_cache_allowed = false;
+            }
+
+            /**
+             * @return The cache of the responses of catchment formulations, or null if the run keeps none
+             */
+            const std::shared_ptr<Response_Cache>& get_response_cache() const {
+                return this->response_cache;
+            }
+
+            /**
+             * @return The pager of the models of catchment formulations, or null if the run keeps them all in memory
+             */
+            const std::shared_ptr<Catchment_State_Pager>& get_state_pager() const {
+                return this->state_pager;
+            }
+
+            /**
+             * @return The output configuration, which uses defaults for anything not in the config
+             */
+            const output_params& get_output_params() const {
+                return this->output_config;
+            }
+
+            /**
+             * @return The built-in channel routing configuration, which is disabled if not in the config
+             */
+            const channel_routing_params& get_channel_routing_params() const {
+                return this->channel_routing_config;
+            }
+
+            /**
+             * @return The spin-up configuration, which is disabled if not in the config
+             */
+            const spinup_params& get_spinup_params() const {
+                return this->spinup_config;
+            }
+
+            /**
+             * @return The signature of the config of a catchment, as of when its formulation was constructed
+             * @throws std::out_of_range If signatures are not recorded, or the catchment has none (e.g., it is part
+             *                           of a batch)
+             */
+            std::uint64_t get_signature(const std::string &identifier) const {
+                const std::lock_guard<std::mutex> lock(*this->signatures_mutex);
+                return this->signatures.at(identifier);
+            }
+
+            /**
+             * Make a manager of the formulations of the spin-up of this one, once it is read.
+             *
+             * The spin-up manager has the same config, but runs from the spin-up start time up to the start time of
+             * this one, records the signatures of its catchments, and replays no cached responses.
+             *
+             * @throws std::runtime_error If the config has no spin-up, or the spin-up starts after the run.
+             */
+            std::shared_ptr<Formulation_Manager> make_spinup_manager() const {
+                if (!this->spinup_config.enabled || this->Simulation_Time_Object == nullptr) {
+                    throw std::runtime_error("Cannot spin up a realization config without a spinup that is not read.");
+                }
+                simulation_time_params spinup_time(this->spinup_config.start_time, this->spinup_config.start_time, 1);
+                // The spin-up ends with the output interval before the run's first
+                time_t spinup_end = this->Simulation_Time_Object->get_start_time()
+                                    - this->Simulation_Time_Object->get_output_interval_seconds();
+                if (spinup_time.start_t > spinup_end) {
+                    throw std::runtime_error("The spinup start_time " + this->spinup_config.start_time
+                                             + " is not before the start of the run.");
+                }
+                struct tm end_tm;
+                gmtime_r(&spinup_end, &end_tm);
+                char end_time[32];
+                std::strftime(end_time, sizeof(end_time), spinup_time.date_format.c_str(), &end_tm);
+
+                boost::property_tree::ptree spinup_tree = this->tree;
+                spinup_tree.erase("spinup");
+                spinup_tree.put("time.start_time", this->spinup_config.start_time);
+                spinup_tree.put("time.end_time", std::string(end_time));
+                auto execution = spinup_tree.get_child_optional("execution");
+                if (execution) {
+                    execution->erase("response_cache");
+                }
+                std::shared_ptr<Formulation_Manager> spinup_manager = std::make_shared<Formulation_Manager>(spinup_tree);
+                spinup_manager->is_signature_recorded = true;
+                return spinup_manager;
+            }
 
         protected:
             std::shared_ptr<Catchment_Formulation> construct_formulation_from_tree(
@@ -305,61 +911,532 @@ namespace realization {
                     simulation_time_config.start_time,
                     simulation_time_config.end_time
                 );
+                forcing_config.feature_ids = this->feature_ids;
+                forcing_config.fabric = this->fabric;
+                if(forcing_parameters.has_key("weights_path")){
+                    forcing_config.weights_path = forcing_parameters.at("weights_path").as_string();
+                } else if(this->global_forcing.count("weights_path") != 0){
+                    forcing_config.weights_path = global_forcing.at("weights_path").as_string();
+                }
+                if(forcing_parameters.has_key("cache_size_mb")){
+                    forcing_config.cache_size_mb = forcing_parameters.at("cache_size_mb").as_natural_number();
+                } else if(this->global_forcing.count("cache_size_mb") != 0){
+                    forcing_config.cache_size_mb = global_forcing.at("cache_size_mb").as_natural_number();
+                }
+                if(forcing_parameters.has_key("prefetch_blocks")){
+                    forcing_config.prefetch_blocks = forcing_parameters.at("prefetch_blocks").as_natural_number();
+                } else if(this->global_forcing.count("prefetch_blocks") != 0){
+                    forcing_config.prefetch_blocks = global_forcing.at("prefetch_blocks").as_natural_number();
+                }
+                if(forcing_parameters.has_key("stream_window_steps")){
+                    forcing_config.stream_window_steps = forcing_parameters.at("stream_window_steps").as_natural_number();
+                } else if(this->global_forcing.count("stream_window_steps") != 0){
+                    forcing_config.stream_window_steps = global_forcing.at("stream_window_steps").as_natural_number();
+                }
+                if(forcing_parameters.has_key("derived_variables")){
+                    for (const geojson::JSONProperty &name : forcing_parameters.at("derived_variables").as_list()) {
+                        forcing_config.derived_variables.push_back(name.as_string());
+                    }
+                } else if(this->global_forcing.count("derived_variables") != 0){
+                    for (const geojson::JSONProperty &name : global_forcing.at("derived_variables").as_list()) {
+                        forcing_config.derived_variables.push_back(name.as_string());
+                    }
+                }
+
+                if (this->response_cache != nullptr || this->is_signature_recorded) {
+                    std::stringstream formulation_json;
+                    boost::property_tree::json_parser::write_json(formulation_json, formulation, false);
+                    std::string init_config = formulation_config.get<std::string>(BMI_REALIZATION_CFG_PARAM_REQ__INIT_CONFIG, "");
+                    std::vector<std::string> parts = split_id_pattern(init_config, false);
+                    init_config = parts[0];
+                    for (size_t i = 1; i < parts.size(); ++i) {
+                        init_config += identifier + parts[i];
+                    }
+                    std::shared_ptr<Catchment_Formulation> cached = this->note_signature(
+                            identifier, formulation_json.str(), forcing_config, init_config, simulation_time_config);
+                    if (cached != nullptr) {
+                        return cached;
+                    }
+                }
 
+                //Formulations may be constructed concurrently, in which case only their time is profiled, not their memory
+                utils::StartupTimer startup("formulations/" + formulation_type_key + "/forcing", this->is_construction_sequential);
                 std::shared_ptr<Catchment_Formulation> constructed_formulation = construct_formulation(formulation_type_key, identifier, forcing_config, output_stream);
                 //, geometry);
+                startup.next("formulations/" + formulation_type_key + "/initialize");
                 constructed_formulation->create_formulation(formulation_config, &global_formulation_parameters);
+                startup.stop();
+                constructed_formulation->set_time_step_seconds(get_formulation_time_step(formulation));
                 return constructed_formulation;
             }
 
+            /**
+             * The global formulation and forcing config, compiled once for instantiating them for each catchment.
+             *
+             * The ``{{id}}`` patterns of the config are split out up front, so instantiating a catchment's config only
+             * joins the parts around its id.
+             */
+            struct global_config_template {
+                std::string formulation_type_key;
+                /** The global formulation's own time step, in seconds, or ``0`` to step at the output interval. */
+                long time_step_seconds = 0;
+                /** The global formulation params, less the init config if it has an ``{{id}}`` pattern. */
+                geojson::PropertyMap formulation_params;
+                /**
+                 * The global formulation, configured and validated once, which each catchment's is created like, or
+                 * null if its type cannot be created from a prototype.
+                 */
+                std::shared_ptr<Catchment_Formulation> prototype;
+                /** The parts of the init config around each ``{{id}}`` pattern, or empty if it has none. */
+                std::vector<std::string> init_config_parts;
+                /** The forcing data directory, ending with ``/``, when forcing files are found by ``file_pattern``. */
+                std::string forcing_dir;
+                /** The parts of ``file_pattern`` before and after its ``{{id}}``, or empty if it has none. */
+                std::vector<std::string> file_pattern_parts;
+                /** The forcing file matching ``file_pattern`` for every catchment, when it has no ``{{id}}``. */
+                std::string shared_forcing_file;
+                /** The forcing file matching ``file_pattern`` for each catchment found, by id (see @ref index_forcing_files). */
+                std::unordered_map<std::string, std::string> forcing_files_by_id;
+            };
+
+            /**
+             * Compile the global formulation and forcing config into @ref global_template.
+             */
+            void compile_global_template() {
+                global_config_template compiled;
+                compiled.formulation_type_key = get_formulation_key(global_formulation_tree.get_child("formulations.."));
+                compiled.time_step_seconds = get_formulation_time_step(global_formulation_tree.get_child("formulations.."));
+
+                compiled.formulation_params = global_formulation_parameters;
+                compiled.prototype = construct_prototype_formulation(compiled.formulation_type_key,
+                                                                     global_formulation_parameters);
+                auto init_config = compiled.formulation_params.find(BMI_REALIZATION_CFG_PARAM_REQ__INIT_CONFIG);
+                if (init_config != compiled.formulation_params.end()
+                    && init_config->second.get_type() == geojson::PropertyType::String) {
+                    std::vector<std::string> parts = split_id_pattern(init_config->second.as_string(), false);
+                    if (parts.size() > 1) {
+                        compiled.init_config_parts = std::move(parts);
+                        compiled.formulation_params.erase(init_config);
+                    }
+                }
+
+                if (this->global_forcing.count("file_pattern") != 0) {
+                    compiled.forcing_dir = this->global_forcing.at("path").as_string();
+                    if (compiled.forcing_dir.compare(compiled.forcing_dir.size() - 1, 1, "/") != 0) {
+                        compiled.forcing_dir += "/";
+                    }
+                    std::vector<std::string> parts = split_id_pattern(this->global_forcing.at("file_pattern").as_string(), true);
+                    if (parts.size() > 1) {
+                        compiled.file_pattern_parts = std::move(parts);
+                        this->index_forcing_files(compiled);
+                    }
+                    else {
+                        // Every catchment uses the same file, so only look for it once
+                        std::regex pattern(parts[0]);
+                        for (const std::string &file_name : this->get_forcing_dir_files(compiled.forcing_dir)) {
+                            if (std::regex_match(file_name, pattern)) {
+                                compiled.shared_forcing_file = file_name;
+                                break;
+                            }
+                        }
+                    }
+                }
+
+                this->global_template = std::move(compiled);
+                this->global_template_compiled = true;
+            }
+
+            /**
+             * Find the forcing file of every catchment of the hydrofabric with one pass over the forcing directory.
+             *
+             * A file name matches ``file_pattern`` for an id when the text before the id in the name matches the part of
+             * the pattern before ``{{id}}``, and the text after it the part after, so each name is only matched at the
+             * places one of the hydrofabric's ids appears in it.  As when catchments are matched one at a time, each gets
+             * the first matching file in directory order.  Nothing is indexed when the parts of the pattern are not
+             * regular expressions of their own (e.g. a group or alternation spans the ``{{id}}``), and ids with regular
+             * expression special characters are left out; those catchments are matched one at a time instead.
+             *
+             * @param compiled The compiled template, with its forcing directory and file pattern parts set.
+             */
+            void index_forcing_files(global_config_template &compiled) {
+                const std::vector<std::string> &parts = compiled.file_pattern_parts;
+                if (feature_ids == nullptr || parts[0].find('|') != std::string::npos
+                    || parts[1].find('|') != std::string::npos) {
+                    return;
+                }
+                std::regex before, after;
+                try {
+                    before = std::regex(parts[0]);
+                    after = std::regex(parts[1]);
+                }
+                catch (const std::regex_error &) {
+                    return;
+                }
+
+                std::unordered_set<std::string> ids;
+                std::vector<size_t> id_lengths;
+                for (const std::string &id : *feature_ids) {
+                    if (!id.empty() && id.find_first_of(".[]{}()\\*+?^$|") == std::string::npos) {
+                        ids.insert(id);
+                        id_lengths.push_back(id.size());
+                    }
+                }
+                std::sort(id_lengths.begin(), id_lengths.end());
+                id_lengths.erase(std::unique(id_lengths.begin(), id_lengths.end()), id_lengths.end());
+
+                std::string candidate;
+                for (const std::string &file_name : this->get_forcing_dir_files(compiled.forcing_dir)) {
+                    for (size_t begin = 0; begin < file_name.size(); ++begin) {
+                        for (size_t length : id_lengths) {
+                            if (begin + length > file_name.size()) {
+                                break;
+                            }
+                            candidate.assign(file_name, begin, length);
+                            if (ids.count(candidate) == 0 || compiled.forcing_files_by_id.count(candidate) != 0) {
+                                continue;
+                            }
+                            if (std::regex_match(file_name.begin(), file_name.begin() + begin, before)
+                                && std::regex_match(file_name.begin() + begin + length, file_name.end(), after)) {
+                                compiled.forcing_files_by_id.emplace(candidate, file_name);
+                            }
+                        }
+                    }
+                }
+            }
+
+            /**
+             * Split a config value at its ``{{id}}`` patterns.
+             *
+             * @param value The config value.
+             * @param first_only Whether to only split at the first pattern.
+             * @return The parts of the value around the patterns, which is just the value if it has none.
+             */
+            static std::vector<std::string> split_id_pattern(const std::string &value, bool first_only) {
+                static const std::string id_pattern = "{{id}}";
+                std::vector<std::string> parts;
+                size_t begin = 0;
+                size_t id_index = value.find(id_pattern);
+                while (id_index != std::string::npos) {
+                    parts.push_back(value.substr(begin, id_index - begin));
+                    begin = id_index + id_pattern.size();
+                    id_index = first_only ? std::string::npos : value.find(id_pattern, begin);
+                }
+                parts.push_back(value.substr(begin));
+                return parts;
+            }
+
+            /**
+             * Get the global formulation params for a catchment, from the compiled @ref global_template.
+             *
+             * @param identifier The id of the catchment.
+             * @return The params, with any ``{{id}}`` pattern in the init config replaced by the id.
+             */
+            geojson::PropertyMap instantiate_global_formulation_params(const std::string &identifier) const {
+                geojson::PropertyMap properties = global_template.formulation_params;
+                const std::vector<std::string> &parts = global_template.init_config_parts;
+                if (!parts.empty()) {
+                    std::string init_config = parts[0];
+                    for (size_t i = 1; i < parts.size(); ++i) {
+                        init_config += identifier;
+                        init_config += parts[i];
+                    }
+                    properties.emplace(BMI_REALIZATION_CFG_PARAM_REQ__INIT_CONFIG,
+                                       geojson::JSONProperty(BMI_REALIZATION_CFG_PARAM_REQ__INIT_CONFIG, init_config));
+                }
+                return properties;
+            }
+
             std::shared_ptr<Catchment_Formulation> construct_missing_formulation(std::string identifier, utils::StreamHandler output_stream, simulation_time_params &simulation_time_config){
-                std::string formulation_type_key = get_formulation_key(global_formulation_tree.get_child("formulations.."));
+                if (!global_template_compiled) {
+                    this->compile_global_template();
+                }
 
                 forcing_params forcing_config = this->get_global_forcing_params(identifier, simulation_time_config);
+                geojson::PropertyMap formulation_params = this->instantiate_global_formulation_params(identifier);
+
+                if (this->response_cache != nullptr || this->is_signature_recorded) {
+                    auto init_config = formulation_params.find(BMI_REALIZATION_CFG_PARAM_REQ__INIT_CONFIG);
+                    std::shared_ptr<Catchment_Formulation> cached = this->note_signature(
+                            identifier, "global", forcing_config,
+                            init_config != formulation_params.end()
+                                && init_config->second.get_type() == geojson::PropertyType::String
+                                ? init_config->second.as_string() : "",
+                            simulation_time_config);
+                    if (cached != nullptr) {
+                        return cached;
+                    }
+                }
 
+                const std::string &formulation_type_key = global_template.formulation_type_key;
+                utils::StartupTimer startup("formulations/" + formulation_type_key + "/forcing", this->is_construction_sequential);
                 std::shared_ptr<Catchment_Formulation> missing_formulation = construct_formulation(formulation_type_key, identifier, forcing_config, output_stream);
-                // Need to work with a copy, since it is altered in-place
-                geojson::PropertyMap global_properties_copy = global_formulation_parameters;
-                Catchment_Formulation::config_pattern_substitution(global_properties_copy,
-                                                                   BMI_REALIZATION_CFG_PARAM_REQ__INIT_CONFIG, "{{id}}",
-                                                                   identifier);
-                missing_formulation->create_formulation(global_properties_copy);
+                startup.next("formulations/" + formulation_type_key + "/initialize");
+                if (global_template.prototype == nullptr
+                    || !missing_formulation->create_from_prototype(*global_template.prototype, formulation_params)) {
+                    missing_formulation->create_formulation(formulation_params);
+                }
+                startup.stop();
+                missing_formulation->set_time_step_seconds(global_template.time_step_seconds);
                 return missing_formulation;
             }
 
+            /**
+             * Note the signature of a catchment's config, and find the cached responses of the catchment under it, from
+             * a run under the same config and forcing, when the run has a @ref response_cache.
+             *
+             * The signature of a catchment covers its formulation config, the global formulation and spin-up configs
+             * it may depend on, its forcing config, the simulation time and the contents of its forcing file and init
+             * config file.  It is kept for @ref get_signature if signatures are recorded.  When there are no cached
+             * responses of the catchment under its signature, the signature is noted in the cache, so the responses
+             * of the formulation constructed instead can be cached.
+             *
+             * @param identifier The id of the catchment.
+             * @param formulation_config The formulation config of the catchment, as text.
+             * @param forcing_config The forcing config of the catchment.
+             * @param init_config The path of the init config file of the catchment's formulation, if any.
+             * @param simulation_time_config The simulation time.
+             * @return A formulation replaying the cached responses, or null if there are none.
+             */
+            std::shared_ptr<Catchment_Formulation> note_signature(const std::string &identifier,
+                                                                  const std::string &formulation_config,
+                                                                  const forcing_params &forcing_config,
+                                                                  const std::string &init_config,
+                                                                  const simulation_time_params &simulation_time_config) {
+                std::uint64_t signature = this->global_config_signature;
+                for (const std::string &part : {identifier, formulation_config, forcing_config.path,
+                                                forcing_config.provider, simulation_time_config.start_time,
+                                                simulation_time_config.end_time,
+                                                std::to_string(simulation_time_config.output_interval),
+                                                this->describe_file(forcing_config.path), init_config,
+                                                init_config.empty() ? "" : this->describe_file(init_config)}) {
+                    // A separator between parts, so moving text from one part to the next changes the signature
+                    signature = Response_Cache::hash(part + '\n', signature);
+                }
+                if (this->is_signature_recorded) {
+                    const std::lock_guard<std::mutex> lock(*this->signatures_mutex);
+                    this->signatures[identifier] = signature;
+                }
+                if (this->response_cache == nullptr) {
+                    return nullptr;
+                }
+                std::shared_ptr<const Response_Cache::Entry> entry = this->response_cache->find(identifier, signature);
+                if (entry == nullptr) {
+                    this->response_cache->set_signature(identifier, signature);
+                    return nullptr;
+                }
+                return std::make_shared<Cached_Response_Formulation>(identifier, entry);
+            }
+
+            /**
+             * A description of the contents of a file, for a signature to depend on, or ``missing`` if it cannot be
+             * read.
+             *
+             * Digests are computed once per file, however many catchments share the file.
+             */
+            std::string describe_file(const std::string &file_path) {
+                {
+                    const std::lock_guard<std::mutex> lock(*this->signatures_mutex);
+                    auto described = this->file_descriptions.find(file_path);
+                    if (described != this->file_descriptions.end()) {
+                        return described->second;
+                    }
+                }
+                std::string description = "missing";
+                struct stat info;
+                if (stat(file_path.c_str(), &info) == 0 && S_ISREG(info.st_mode)) {
+                    try {
+                        geojson::SourceDigest digest = geojson::digest_file(file_path);
+                        description = std::to_string(digest.size) + ":" + std::to_string(digest.hash);
+                    }
+                    catch (const std::runtime_error &) {
+                    }
+                }
+                const std::lock_guard<std::mutex> lock(*this->signatures_mutex);
+                this->file_descriptions[file_path] = description;
+                return description;
+            }
+
+            /**
+             * Construct and add the formulations of a batch of catchments using the global formulation, which all share
+             * a single BMI model instance (see @ref Bmi_Batch).
+             *
+             * The model is created like that of the first catchment of the batch, so any ``{{id}}`` pattern in its
+             * init config is replaced with that catchment's id.  The model's input and output variables are then
+             * expected to hold one value for each catchment of the batch, in the given order.
+             *
+             * @param identifiers The ids of the catchments of the batch, in the order of the model's grid cells.
+             * @param output_stream
+             * @param simulation_time_config
+             */
+            void construct_missing_formulation_batch(const std::vector<std::string> &identifiers,
+                                                     utils::StreamHandler output_stream,
+                                                     simulation_time_params &simulation_time_config) {
+                if (!global_template_compiled) {
+                    this->compile_global_template();
+                }
+                const std::string &formulation_type_key = global_template.formulation_type_key;
+
+                utils::StartupTimer startup("formulations/" + formulation_type_key + "/forcing", this->is_construction_sequential);
+                std::vector<std::shared_ptr<data_access::GenericDataProvider>> forcings;
+                forcings.reserve(identifiers.size());
+                for (const std::string &identifier : identifiers) {
+                    forcing_params forcing_config = this->get_global_forcing_params(identifier, simulation_time_config);
+                    forcings.push_back(construct_forcing_provider(formulation_type_key, identifier, forcing_config, output_stream));
+                }
+
+                std::shared_ptr<Catchment_Formulation> batch_formulation =
+                        realization::formulations.at(formulation_type_key)(identifiers[0], forcings[0], output_stream);
+                startup.next("formulations/" + formulation_type_key + "/initialize");
+                batch_formulation->create_formulation(this->instantiate_global_formulation_params(identifiers[0]));
+                startup.stop();
+
+                std::shared_ptr<Bmi_Formulation> bmi_formulation = std::dynamic_pointer_cast<Bmi_Formulation>(batch_formulation);
+                if (bmi_formulation == nullptr) {
+                    throw std::runtime_error("Formulation " + formulation_type_key + " cannot be run in batches; "
+                                             BMI_REALIZATION_CFG_PARAM_OPT__BATCH_SIZE " is only supported for BMI formulations.");
+                }
+                std::shared_ptr<Bmi_Batch> batch = std::make_shared<Bmi_Batch>(bmi_formulation, identifiers, forcings);
+                for (size_t i = 0; i < identifiers.size(); ++i) {
+                    std::shared_ptr<Bmi_Batched_Formulation> batched_formulation =
+                            std::make_shared<Bmi_Batched_Formulation>(identifiers[i], forcings[i], output_stream, batch, i);
+                    batched_formulation->set_time_step_seconds(global_template.time_step_seconds);
+                    this->add_formulation(batched_formulation);
+                }
+            }
+
+            /**
+             * Start reading the CSV forcing files of catchments using the global forcing config in the background, when
+             * the execution config has ``forcing_preload_threads``, so their formulations find them read.
+             *
+             * Nothing is preloaded with a response cache, since the catchments it replays never read their forcing.
+             * Catchments whose forcing file isn't found are left out, for their formulations to report.
+             *
+             * @param identifiers The ids of the catchments, in the order their formulations are constructed.
+             * @param simulation_time_config The simulation time.
+             * @return The preloader, which must outlive the construction of the formulations, or null if nothing is
+             *         preloaded.
+             */
+            std::unique_ptr<CsvForcingPreloader> preload_global_forcing(const std::vector<std::string> &identifiers,
+                                                                        simulation_time_params &simulation_time_config) {
+                if (this->execution_config.forcing_preload_threads <= 0 || identifiers.empty()
+                    || this->response_cache != nullptr) {
+                    return nullptr;
+                }
+                std::string provider = this->global_forcing.count("provider") != 0
+                                       ? this->global_forcing.at("provider").as_string() : "";
+                if (provider != "" && provider != "CsvPerFeature") {
+                    return nullptr;
+                }
+                std::vector<forcing_params> forcing_configs;
+                forcing_configs.reserve(identifiers.size());
+                for (const std::string &identifier : identifiers) {
+                    try {
+                        forcing_configs.push_back(this->get_global_forcing_params(identifier, simulation_time_config));
+                    }
+                    catch (const std::runtime_error&) {
+                        // Reported when the catchment's formulation is constructed
+                    }
+                }
+                return std::unique_ptr<CsvForcingPreloader>(
+                    new CsvForcingPreloader(std::move(forcing_configs), this->execution_config.forcing_preload_threads));
+            }
+
             forcing_params get_global_forcing_params(std::string identifier, simulation_time_params &simulation_time_config) {
                 std::string path = this->global_forcing.at("path").as_string();
                 std::string provider = "";
                 if(this->global_forcing.count("provider") != 0){
                     provider = global_forcing.at("provider").as_string();
                 }
-                if (this->global_forcing.count("file_pattern") == 0) {
-                    return forcing_params(
-                        path,
+                auto make_forcing_params = [&](const std::string& forcing_path) {
+                    forcing_params params(
+                        forcing_path,
                         provider,
                         simulation_time_config.start_time,
                         simulation_time_config.end_time
                     );
+                    params.feature_ids = this->feature_ids;
+                    params.fabric = this->fabric;
+                    if(this->global_forcing.count("weights_path") != 0){
+                        params.weights_path = global_forcing.at("weights_path").as_string();
+                    }
+                    if(this->global_forcing.count("cache_size_mb") != 0){
+                        params.cache_size_mb = global_forcing.at("cache_size_mb").as_natural_number();
+                    }
+                    if(this->global_forcing.count("prefetch_blocks") != 0){
+                        params.prefetch_blocks = global_forcing.at("prefetch_blocks").as_natural_number();
+                    }
+                    if(this->global_forcing.count("stream_window_steps") != 0){
+                        params.stream_window_steps = global_forcing.at("stream_window_steps").as_natural_number();
+                    }
+                    if(this->global_forcing.count("derived_variables") != 0){
+                        for (const geojson::JSONProperty &name : global_forcing.at("derived_variables").as_list()) {
+                            params.derived_variables.push_back(name.as_string());
+                        }
+                    }
+                    return params;
+                };
+                if (this->global_forcing.count("file_pattern") == 0) {
+                    return make_forcing_params(path);
                 }
 
                 // Since we are given a pattern, we need to identify the directory and pull out anything that matches the pattern
-                if (path.compare(path.size() - 1, 1, "/") != 0) {
-                    path += "/";
+                if (!global_template_compiled) {
+                    this->compile_global_template();
                 }
+                const std::string &dir = global_template.forcing_dir;
+                const std::vector<std::string> &parts = global_template.file_pattern_parts;
 
-                std::string filepattern = this->global_forcing.at("file_pattern").as_string();
+                // Without an '{{id}}', every catchment uses the same file, which was found while compiling the pattern
+                if (parts.empty()) {
+                    if (global_template.shared_forcing_file.empty()) {
+                        throw std::runtime_error("Forcing data could not be found for '" + identifier + "'");
+                    }
+                    return make_forcing_params(dir + global_template.shared_forcing_file);
+                }
 
-                int id_index = filepattern.find("{{id}}");
+                auto indexed = global_template.forcing_files_by_id.find(identifier);
+                if (indexed != global_template.forcing_files_by_id.end()) {
+                    return make_forcing_params(dir + indexed->second);
+                }
 
-                // If an index for '{{id}}' was found, we can count on that being where the id for this realization can be found.
+                // Otherwise we can count on the '{{id}}' being where the id for this realization can be found.
                 //     For instance, if we have a pattern of '.*{{id}}_14_15.csv' and this is named 'cat-87',
                 //     this will match on 'stuff_example_cat-87_14_15.csv'
-                if (id_index != std::string::npos) {
-                    filepattern = filepattern.replace(id_index, sizeof("{{id}}") - 1, identifier);
+                // Unless the id itself has regex special characters, a matching file name must contain the id, so the
+                //     regular expression is only created and matched for files that do
+                bool id_is_literal = identifier.find_first_of(".[]{}()\\*+?^$|") == std::string::npos;
+                std::unique_ptr<std::regex> pattern;
+                for (const std::string &file_name : this->get_forcing_dir_files(dir)) {
+                    if (id_is_literal && file_name.find(identifier) == std::string::npos) {
+                        continue;
+                    }
+                    if (pattern == nullptr) {
+                        pattern = std::unique_ptr<std::regex>(new std::regex(parts[0] + identifier + parts[1]));
+                    }
+                    if (std::regex_match(file_name, *pattern)) {
+                        return make_forcing_params(dir + file_name);
+                    }
                 }
 
-                // Create a regular expression used to identify proper file names
-                std::regex pattern(filepattern);
+                throw std::runtime_error("Forcing data could not be found for '" + identifier + "'");
+            }
+
+            /**
+             * Get the names of the regular files and symlinks in a forcing data directory, in directory order.
+             *
+             * The directory is read the first time it is requested, and its listing is then shared by later requests
+             * (e.g., for other catchments, possibly on other threads).
+             *
+             * @param path The path of the directory, ending with ``/``.
+             * @return The names of the files in the directory that may be forcing data.
+             * @throws std::runtime_error If the directory cannot be opened.
+             */
+            const std::vector<std::string> &get_forcing_dir_files(const std::string &path) {
+                const std::lock_guard<std::mutex> lock(*this->forcing_dir_files_mutex);
+                auto cached = this->forcing_dir_files.find(path);
+                if (cached != this->forcing_dir_files.end()) {
+                    return cached->second;
+                }
 
                 // A stream providing the functions necessary for evaluating a directory:
                 //    https://www.gnu.org/software/libc/manual/html_node/Opening-a-Directory.html#Opening-a-Directory
@@ -409,28 +1486,23 @@ namespace realization {
                 }
 
                 // If the directory could be found and opened, we can go ahead and iterate
-                if (directory != nullptr) {
-                    while ((entry = readdir(directory))) {
-                        // If the entry is a regular file or symlink AND the name matches the pattern, 
-                        //    we can consider this ready to be interpretted as valid forcing data (even if it isn't)
-                        if ((entry->d_type == DT_REG or entry->d_type == DT_LNK) and std::regex_match(entry->d_name, pattern)) {
-                            return forcing_params(
-                                path + entry->d_name,
-                                provider,
-                                simulation_time_config.start_time,
-                                simulation_time_config.end_time
-                            );
-                        }
-                    }
-                }
-                else {
+                if (directory == nullptr) {
                     // The directory wasn't found or otherwise couldn't be opened; forcing data cannot be retrieved
                     throw std::runtime_error("Error opening forcing data dir '" + path + "' after " + std::to_string(attemptCount) + " attempts: " + errMsg);
                 }
 
+                std::vector<std::string> &files = this->forcing_dir_files[path];
+                while ((entry = readdir(directory))) {
+                    // If the entry is a regular file or symlink, AND later the name matches the pattern,
+                    //    we can consider this ready to be interpretted as valid forcing data (even if it isn't)
+                    if (entry->d_type == DT_REG or entry->d_type == DT_LNK) {
+                        files.push_back(entry->d_name);
+                    }
+                }
+
                 closedir(directory);
 
-                throw std::runtime_error("Forcing data could not be found for '" + identifier + "'");
+                return files;
             }
 
             boost::property_tree::ptree tree;
@@ -441,11 +1513,64 @@ namespace realization {
 
             geojson::PropertyMap global_forcing;
 
+            /** The global config compiled for the catchments without their own config (see @ref compile_global_template). */
+            global_config_template global_template;
+
+            bool global_template_compiled = false;
+
+            /** The ids of the catchments of the hydrofabric read, which are all that forcing is read for. */
+            std::shared_ptr<const std::vector<std::string>> feature_ids;
+
+            /** The hydrofabric read, whose catchment polygons gridded forcing is aggregated over. */
+            geojson::GeoJSON fabric;
+
             std::map<std::string, std::shared_ptr<Catchment_Formulation>> formulations;
 
+            /** Guards @ref formulations while formulations are constructed concurrently. */
+            std::shared_ptr<std::mutex> formulations_mutex = std::make_shared<std::mutex>();
+
+            /** Listings of forcing data directories, by path (see @ref get_forcing_dir_files). */
+            std::map<std::string, std::vector<std::string>> forcing_dir_files;
+
+            std::shared_ptr<std::mutex> forcing_dir_files_mutex = std::make_shared<std::mutex>();
+
             std::shared_ptr<routing_params> routing_config;
 
             bool using_routing = false;
+
+            execution_params execution_config;
+
+            /** The cache of the responses of catchment formulations, if the config has a ``response_cache``. */
+            std::shared_ptr<Response_Cache> response_cache;
+
+            bool is_response_cache_allowed = true;
+
+            /** The pager of the models of catchment formulations, if the execution config has a ``page_block``. */
+            std::shared_ptr<Catchment_State_Pager> state_pager;
+
+            /** Whether to keep the signature of each catchment for @ref get_signature. */
+            bool is_signature_recorded = false;
+
+            /** The signature of each catchment's config, if recorded (see @ref note_signature). */
+            std::unordered_map<std::string, std::uint64_t> signatures;
+
+            /** Descriptions of the files signatures depend on, by path (see @ref describe_file). */
+            std::unordered_map<std::string, std::string> file_descriptions;
+
+            /** Guards @ref signatures and @ref file_descriptions while formulations are constructed concurrently. */
+            std::shared_ptr<std::mutex> signatures_mutex = std::make_shared<std::mutex>();
+
+            spinup_params spinup_config;
+
+            /** The hash of the global formulation config, which catchment response signatures start from. */
+            std::uint64_t global_config_signature = 0;
+
+            /** Whether formulations are constructed one at a time, so the memory each type takes can be profiled. */
+            bool is_construction_sequential = true;
+
+            output_params output_config;
+
+            channel_routing_params channel_routing_config;
     };
 }
 #endif // NGEN_FORMULATION_MANAGER_H
@@ -0,0 +1,91 @@
+#ifndef NGEN_INIT_CONFIG_TEMPLATE_HPP
+#define NGEN_INIT_CONFIG_TEMPLATE_HPP
+
+#include "JSONProperty.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace realization {
+
+    /**
+     * @brief A BMI init config shared by the formulations of many catchments, with placeholders for what differs
+     * between them.
+     *
+     * A placeholder is a name in double braces: ``{{id}}`` is replaced with the catchment id, and any other name with
+     * the value of the BMI parameter of that name, from the formulation's ``model_params`` or ``model_params_table``.
+     * The template file is read and split at its placeholders once, however many formulations use it, and each model
+     * is initialized from its rendered config, written to node-local storage just long enough for the model's
+     * ``Initialize`` to read it, so a run needs no init config file per catchment on a shared filesystem.
+     */
+    class Init_Config_Template {
+
+    public:
+
+        /**
+         * @brief The template of a file, shared by every formulation using it, read on first use.
+         *
+         * @param path The path of the template file.
+         * @return The shared template.
+         * @throws std::runtime_error If the file cannot be read.
+         */
+        static std::shared_ptr<const Init_Config_Template> get_shared(const std::string &path);
+
+        /**
+         * @brief The directory rendered configs are written to by default: ``/dev/shm`` if it is a writable
+         * directory, as it is memory backed on Linux, or else ``$TMPDIR`` or ``/tmp``.
+         */
+        static std::string default_directory();
+
+        /**
+         * @param path The path of the template file.
+         * @throws std::runtime_error If the file cannot be read, or has an unterminated placeholder.
+         */
+        explicit Init_Config_Template(const std::string &path);
+
+        /** @return The names of the placeholders of the template other than ``id``, each once, in order. */
+        const std::vector<std::string> &get_parameter_names() const {
+            return parameter_names;
+        }
+
+        /**
+         * @brief The config of a catchment.
+         *
+         * Numbers are written with as few digits as read back to the same value, and lists as their values separated
+         * by commas.
+         *
+         * @param id The catchment id.
+         * @param params The BMI parameters of the catchment, by name.
+         * @return The template with its placeholders replaced.
+         * @throws std::runtime_error If a placeholder has no value among the parameters.
+         */
+        std::string render(const std::string &id, const geojson::PropertyMap &params) const;
+
+        /**
+         * @brief Write the config of a catchment to a new file in a directory, for a model to initialize from.
+         *
+         * The file is named after the template and this process, and is for the caller to remove.
+         *
+         * @param directory The directory.
+         * @param id The catchment id.
+         * @param params The BMI parameters of the catchment, by name.
+         * @return The path of the file.
+         * @throws std::runtime_error If a placeholder has no value, or the file cannot be written.
+         */
+        std::string write_rendered(const std::string &directory, const std::string &id,
+                                   const geojson::PropertyMap &params) const;
+
+    private:
+
+        std::string path;
+        /** The text between placeholders, one more than there are placeholders. */
+        std::vector<std::string> literals;
+        /** The name of each placeholder, in order. */
+        std::vector<std::string> placeholders;
+        std::vector<std::string> parameter_names;
+    };
+
+}
+
+#endif //NGEN_INIT_CONFIG_TEMPLATE_HPP
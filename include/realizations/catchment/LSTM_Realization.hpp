@@ -8,6 +8,7 @@
 #include "lstm/include/LSTM.h"
 #include "lstm/include/lstm_params.h"
 #include "lstm/include/lstm_config.h"
+#include "lstm/include/lstm_batch.h"
 #include <memory>
 
 namespace realization {
@@ -105,24 +106,48 @@ namespace realization {
             void create_formulation(geojson::PropertyMap properties) override;
 
             const std::vector<std::string>& get_required_parameters() override {
+                static const std::vector<std::string> REQUIRED_PARAMETERS = {
+                    "pytorch_model_path",
+                    "normalization_path",
+                    "initial_state_path",
+                    "latitude",
+                    "longitude",
+                    "area_square_km"
+                };
                 return REQUIRED_PARAMETERS;
             }
 
+            /** Batched catchments run on a GPU are computed by their batch, in one forward pass per time step. */
+            const void* get_device_group() const override {
+                return batch && batch->is_on_gpu() ? batch.get() : nullptr;
+            }
+
+            void run_device_step(time_step_t t_index, time_step_t t_delta_s) override {
+                if (batch) {
+                    batch->run_to_step(t_index, t_delta_s);
+                }
+            }
+
         private:
+            /**
+             * Read the forcings of a time step, in the order of lstm::lstm_model::run.
+             *
+             * @param t_index The index of the time step.
+             * @param t_delta_s The duration, in seconds, of the time step.
+             * @param forcings Set to the lstm::lstm_batch::NUM_FORCINGS forcing values.
+             */
+            void read_forcings(time_step_t t_index, time_step_t t_delta_s, double* forcings);
+
             std::string catchment_id;
             lstm::lstm_params params;
             lstm::lstm_config config;
             std::unique_ptr<lstm::lstm_model> model;
 
-            std::vector<std::string> REQUIRED_PARAMETERS = {
-                 "pytorch_model_path",
-                 "normalization_path",
-                 "initial_state_path",
-                 "latitude",
-                 "longitude",
-                 "area_square_km",
-            };
-
+            /** The batch this catchment is run in, if it is batched, rather than by its own model. */
+            std::shared_ptr<lstm::lstm_batch> batch;
+            std::size_t batch_member = 0;
+            /** The flow of the last time step run in the batch. */
+            double batch_flow = 0.0;
     };
 
 }
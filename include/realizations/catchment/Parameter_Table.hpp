@@ -0,0 +1,124 @@
+#ifndef NGEN_PARAMETER_TABLE_HPP
+#define NGEN_PARAMETER_TABLE_HPP
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace realization {
+
+    /**
+     * @brief Numeric columns of a hydrofabric attribute table, with a row per catchment, read once and kept in memory.
+     *
+     * Formulations configured with a ``model_params_table`` take per-catchment BMI parameters from a table like this,
+     * rather than from per-catchment entries of the realization config or per-catchment init config files, so the
+     * attributes of every catchment are parsed in one pass over one file.  Only the columns asked for are read, each
+     * into a vector of doubles, which holds integer attributes exactly up to 2^53; missing values are NaN.
+     *
+     * The table format is chosen by the file's extension:
+     *
+     *  - ``.csv``: a header row of column names, then a row per catchment;
+     *  - ``.nc``: an ``ids`` string variable, like that of lumped NetCDF forcing, and a variable per column along its
+     *    dimension, in builds with ``NETCDF_ACTIVE``;
+     *  - ``.parquet``: a column per attribute, with string or integer ids, in builds with ``NGEN_PARQUET_ACTIVE``.
+     */
+    class Parameter_Table {
+
+    public:
+
+        /**
+         * @brief The table of a file shared by every formulation that binds parameters to it, read on first use.
+         *
+         * A table already read for the same path and id column is returned if it has every column asked for;
+         * otherwise the file is read again with its columns and these, and that table is shared from then on.
+         *
+         * @param path The path of the table file.
+         * @param id_column The name of the column of catchment ids.
+         * @param columns The names of the columns needed.
+         * @return The shared table.
+         * @throws std::runtime_error If the file cannot be read, or lacks the id column or a column asked for.
+         */
+        static std::shared_ptr<const Parameter_Table> get_shared(const std::string &path,
+                                                                 const std::string &id_column,
+                                                                 const std::vector<std::string> &columns);
+
+        /**
+         * @brief Read the given columns of a table file.
+         *
+         * @param path The path of the table file.
+         * @param id_column The name of the column of catchment ids.
+         * @param columns The names of the columns to read.
+         * @throws std::runtime_error If the file cannot be read, has an unsupported extension, or lacks the id column
+         * or a column asked for.
+         */
+        Parameter_Table(const std::string &path, const std::string &id_column, std::vector<std::string> columns);
+
+        /** @return The path of the table file. */
+        const std::string &get_path() const {
+            return path;
+        }
+
+        /** @return The number of catchments in the table. */
+        std::size_t size() const {
+            return row_indexes.size();
+        }
+
+        /**
+         * @param name A column name.
+         * @return The index of the column, or -1 if it was not read.
+         */
+        long column_index(const std::string &name) const {
+            for (std::size_t i = 0; i < column_names.size(); ++i) {
+                if (column_names[i] == name) {
+                    return static_cast<long>(i);
+                }
+            }
+            return -1;
+        }
+
+        /**
+         * @param id A catchment id.
+         * @return The row of the catchment, or -1 if it is not in the table.
+         */
+        long row_index(const std::string &id) const {
+            auto found = row_indexes.find(id);
+            return found == row_indexes.end() ? -1 : static_cast<long>(found->second);
+        }
+
+        /**
+         * @param column The index of a column.
+         * @param row The row of a catchment.
+         * @return The value, which is NaN if it is missing from the table.
+         */
+        double get_value(std::size_t column, std::size_t row) const {
+            return columns[column][row];
+        }
+
+    private:
+
+        void read_csv(const std::string &id_column);
+
+#ifdef NETCDF_ACTIVE
+        void read_netcdf(const std::string &id_column);
+#endif
+
+#ifdef NGEN_PARQUET_ACTIVE
+        /** Implemented apart from the rest, as Arrow needs C++17. */
+        void read_parquet(const std::string &id_column);
+#endif
+
+        /** Record the id of the next row, failing if the table already has a row for it. */
+        void add_row(const std::string &id);
+
+        std::string path;
+        std::vector<std::string> column_names;
+        /** The values of each column, by row. */
+        std::vector<std::vector<double>> columns;
+        std::unordered_map<std::string, std::size_t> row_indexes;
+    };
+
+}
+
+#endif //NGEN_PARAMETER_TABLE_HPP
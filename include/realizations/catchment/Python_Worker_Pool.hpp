@@ -0,0 +1,200 @@
+#ifndef NGEN_PYTHON_WORKER_POOL_HPP
+#define NGEN_PYTHON_WORKER_POOL_HPP
+
+#ifdef ACTIVATE_PYTHON
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+
+#include "Checkpoint.hpp"
+#include "SharedMemoryRing.hpp"
+
+/**
+ * The command line option with which ngen runs as a Python BMI worker, rather than a simulation, followed by the
+ * descriptor and size of the shared memory it talks to the ngen process through.
+ */
+#define PYTHON_BMI_WORKER_CLI_OPTION "--python-bmi-worker"
+
+namespace models {
+    namespace bmi {
+
+        /**
+         * The commands an ngen process sends the Python BMI workers hosting its models.
+         *
+         * Each command is followed by the handle of the model it is for, other than @ref SHUTDOWN, and then its
+         * arguments.  Commands up to @ref FINALIZE are queued: they have no reply, and a failure of one is instead
+         * reported by the next command for the same model that has a reply.
+         */
+        enum class Python_Worker_Command : int32_t {
+            SET_VALUE,
+            SET_VALUE_AT_INDICES,
+            UPDATE,
+            UPDATE_UNTIL,
+            DESTROY,
+            FINALIZE,
+            CREATE,
+            GET_OUTPUTS,
+            GET_VALUE,
+            GET_VALUE_AT_INDICES,
+            GET_VAR_INFO,
+            GET_CURRENT_TIME,
+            GET_GRID_INT,
+            GET_GRID_TYPE,
+            GET_GRID_ARRAY,
+            SHUTDOWN
+        };
+
+        /** The BMI grid functions that return an ``int``, for @ref Python_Worker_Command::GET_GRID_INT. */
+        enum class Python_Worker_Grid_Int : int32_t {
+            RANK, SIZE, NODE_COUNT, EDGE_COUNT, FACE_COUNT
+        };
+
+        /** The BMI grid functions that fill an array, for @ref Python_Worker_Command::GET_GRID_ARRAY. */
+        enum class Python_Worker_Grid_Array : int32_t {
+            SHAPE, SPACING, ORIGIN, EDGE_NODES, FACE_EDGES, FACE_NODES, NODES_PER_FACE, X, Y, Z
+        };
+
+        /**
+         * @brief A worker process hosting Python BMI models, with its own interpreter and so its own GIL.
+         *
+         * The worker is the ngen executable itself, run with @ref PYTHON_BMI_WORKER_CLI_OPTION, and talks to this process
+         * through two @ref utils::SharedMemoryRing, one for commands and one for their replies.  Each message is its
+         * length, a ``uint64_t``, followed by its bytes, in the layout of @ref utils::StateWriter.  A reply starts with
+         * an ``int32_t`` status, which is ``0`` if the command succeeded and is then followed by its results, or
+         * otherwise by a message saying why it failed.
+         *
+         * Queued commands are only written to the ring, so a step's inputs and update are sent without waiting, and the
+         * worker runs them while this process carries on; only commands with a reply wait for the worker.
+         *
+         * Instances are safe to use from several threads at once; each command, and each command and its reply, is
+         * sent as a whole.
+         */
+        class Python_Worker {
+
+        public:
+
+            /** The default bytes of each of the rings of a worker. */
+            static constexpr std::size_t DEFAULT_RING_BYTES = 4 << 20;
+
+            /**
+             * Start a worker process.
+             *
+             * @param executable The path of the ngen executable to run the worker with.
+             * @param ring_bytes The bytes of each of the rings to the worker.
+             * @throws std::runtime_error If the worker cannot be started.
+             */
+            explicit Python_Worker(const std::string &executable, std::size_t ring_bytes = DEFAULT_RING_BYTES);
+
+            /** Shut the worker down, waiting for it to exit. */
+            ~Python_Worker();
+
+            Python_Worker(const Python_Worker&) = delete;
+            Python_Worker& operator=(const Python_Worker&) = delete;
+
+            /** @return A handle for a new model of this worker, for its @ref Python_Worker_Command::CREATE. */
+            int32_t new_model_handle();
+
+            /** @return The number of models handles were given out for. */
+            std::size_t get_model_count();
+
+            /**
+             * Send a queued command, without waiting for the worker to run it.
+             *
+             * @throws std::runtime_error If the worker has exited.
+             */
+            void send(const utils::StateWriter &command);
+
+            /**
+             * Send a command and wait for its reply.
+             *
+             * @return The results of the command, after its status.
+             * @throws std::runtime_error If the command, or a queued command for the same model before it, failed, or
+             *                            if the worker has exited.
+             */
+            std::vector<char> call(const utils::StateWriter &command);
+
+        private:
+
+            /** Write a message to the command ring with the lock held. */
+            void write_message(const std::vector<char> &bytes);
+
+            /** @return Whether the worker process is still running. */
+            bool is_running();
+
+            pid_t pid = -1;
+            bool exited = false;
+            std::unique_ptr<utils::SharedMemoryRegion> region;
+            std::unique_ptr<utils::SharedMemoryRing> commands;
+            std::unique_ptr<utils::SharedMemoryRing> replies;
+            int32_t next_handle = 0;
+            std::mutex mutex;
+        };
+
+        /**
+         * @brief The Python BMI workers of this process, to which the models of ``bmi_python`` formulations are
+         * assigned when the execution config has ``python_workers``.
+         *
+         * Workers are started as models are assigned to them, up to the configured number, and each model is assigned
+         * to the worker hosting the fewest, so the models of a rank are spread evenly over its workers.  Each worker is
+         * shut down once neither the pool nor any adapter of one of its models is left, at the latest as ngen exits.
+         */
+        class Python_Worker_Pool {
+
+        public:
+
+            static Python_Worker_Pool &get_instance();
+
+            /**
+             * Set the number of workers, before any model is assigned to one.
+             *
+             * @param workers The number of workers, or ``0`` to host Python models in this process.
+             */
+            void set_size(unsigned workers) {
+                std::lock_guard<std::mutex> lock(mutex);
+                size = workers;
+            }
+
+            /** @return Whether Python models are hosted by workers rather than this process. */
+            bool is_enabled() {
+                std::lock_guard<std::mutex> lock(mutex);
+                return size > 0;
+            }
+
+            /**
+             * Get the worker the next model is to be hosted by, starting a new one while there are fewer than the
+             * configured number.
+             *
+             * @param handle Set to the handle of the model in the worker.
+             * @throws std::runtime_error If the pool is not enabled, or a worker cannot be started.
+             */
+            std::shared_ptr<Python_Worker> assign(int32_t &handle);
+
+        private:
+
+            Python_Worker_Pool() = default;
+
+            unsigned size = 0;
+            std::vector<std::shared_ptr<Python_Worker>> workers;
+            std::mutex mutex;
+        };
+
+        /**
+         * Run this process as a Python BMI worker, until the ngen process shuts it down or exits.
+         *
+         * @param fd The descriptor of the shared memory of the worker's rings.
+         * @param bytes The size of the shared memory.
+         * @return The exit status of the worker.
+         */
+        int run_python_bmi_worker(int fd, std::size_t bytes);
+
+    }
+}
+
+#endif //ACTIVATE_PYTHON
+
+#endif //NGEN_PYTHON_WORKER_POOL_HPP
@@ -0,0 +1,216 @@
+#ifndef NGEN_RESPONSE_CACHE_HPP
+#define NGEN_RESPONSE_CACHE_HPP
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <sys/stat.h>
+
+namespace realization {
+
+    /** Extension of the response cache file of each catchment. */
+    static const std::string RESPONSE_CACHE_EXTENSION = ".ngenresp";
+    static const char RESPONSE_CACHE_MAGIC[8] = {'N', 'G', 'E', 'N', 'R', 'E', 'S', 'P'};
+    static const std::uint32_t RESPONSE_CACHE_VERSION = 1;
+
+    /**
+     * @brief Responses of catchment formulations kept from earlier runs, keyed by a signature of what they depend on.
+     *
+     * A catchment's responses depend only on its formulation config and its forcing, never on other features, so a
+     * rerun with the same config and forcing for a catchment can replay its responses from the last run, rather than
+     * construct and run its formulation again.  Each catchment's responses are kept in their own file of the cache
+     * directory, ``<directory>/<catchment id>.ngenresp``, with the signature they were computed under; a file whose
+     * signature differs from that of the catchment's current config is stale, and is replaced at the end of the run.
+     *
+     * The manager of the formulations notes the signature of each catchment it constructs a formulation for with
+     * @ref set_signature, which is safe to call from several threads at once.
+     */
+    class Response_Cache {
+    public:
+
+        /**
+         * @brief The responses of a catchment's formulation for every one of its time steps, and its output values.
+         */
+        struct Entry {
+            std::uint64_t signature = 0;
+            /** The names of the output values, as in the formulation's output header. */
+            std::vector<std::string> output_names;
+            /** The response of each time step. */
+            std::vector<double> responses;
+            /** The output values of each time step, one after another. */
+            std::vector<double> output_values;
+            /** Whether every time step recorded so far was recorded in order, with an output value of each name. */
+            bool is_valid = true;
+
+            /** @return The number of time steps. */
+            std::size_t size() const { return responses.size(); }
+
+            /**
+             * @brief Add the response and output values of the next time step.
+             *
+             * A step recorded out of order, or without an output value for each name, makes the entry invalid.
+             */
+            void record(long time_index, double response, const std::vector<double> &values) {
+                if (!is_valid || time_index != static_cast<long>(responses.size())
+                    || values.size() != output_names.size()) {
+                    is_valid = false;
+                    return;
+                }
+                responses.push_back(response);
+                output_values.insert(output_values.end(), values.begin(), values.end());
+            }
+        };
+
+        /**
+         * @param directory The directory of the cache files, which is created if it does not exist.
+         * @throws std::runtime_error If the directory cannot be created.
+         */
+        explicit Response_Cache(std::string directory) : directory(std::move(directory)) {
+            if (mkdir(this->directory.c_str(), 0777) != 0 && errno != EEXIST) {
+                throw std::runtime_error("Unable to create response cache directory " + this->directory + ": "
+                                         + std::strerror(errno));
+            }
+        }
+
+        /** @return The cache directory. */
+        const std::string &get_directory() const { return directory; }
+
+        /** @return The FNV-1a hash of some text, continuing from @p hash. */
+        static std::uint64_t hash(const std::string &text, std::uint64_t hash = 14695981039346656037ULL) {
+            for (unsigned char c : text) {
+                hash = (hash ^ c) * 1099511628211ULL;
+            }
+            return hash;
+        }
+
+        /** Note the signature of the current config of a catchment whose formulation is run, to cache it under. */
+        void set_signature(const std::string &catchment_id, std::uint64_t signature) {
+            std::lock_guard<std::mutex> lock(mutex);
+            signatures[catchment_id] = signature;
+        }
+
+        /**
+         * @brief Start recording an entry for a catchment whose formulation is run.
+         *
+         * @return The empty entry, with the catchment's signature and @p output_names, or null if no signature was
+         *         noted for the catchment.
+         */
+        std::unique_ptr<Entry> start_entry(const std::string &catchment_id, std::vector<std::string> output_names) {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = signatures.find(catchment_id);
+            if (it == signatures.end()) {
+                return nullptr;
+            }
+            std::unique_ptr<Entry> entry(new Entry());
+            entry->signature = it->second;
+            entry->output_names = std::move(output_names);
+            return entry;
+        }
+
+        /**
+         * @brief Read the cached entry of a catchment, if it was computed under @p signature.
+         *
+         * @return The entry, or null if there is none, or it is stale or unreadable.
+         */
+        std::shared_ptr<const Entry> find(const std::string &catchment_id, std::uint64_t signature) const {
+            std::ifstream file(path_of(catchment_id), std::ios::binary);
+            char magic[sizeof(RESPONSE_CACHE_MAGIC)];
+            std::uint32_t version;
+            std::shared_ptr<Entry> entry = std::make_shared<Entry>();
+            if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, RESPONSE_CACHE_MAGIC, sizeof(magic)) != 0
+                || !get(file, version) || version != RESPONSE_CACHE_VERSION || !get(file, entry->signature)
+                || entry->signature != signature) {
+                return nullptr;
+            }
+            std::uint64_t steps;
+            std::uint32_t width;
+            if (!get(file, steps) || !get(file, width)) {
+                return nullptr;
+            }
+            entry->output_names.resize(width);
+            for (std::string &name : entry->output_names) {
+                std::uint32_t length;
+                if (!get(file, length)) {
+                    return nullptr;
+                }
+                name.resize(length);
+                if (!file.read(&name[0], length)) {
+                    return nullptr;
+                }
+            }
+            entry->responses.resize(steps);
+            entry->output_values.resize(steps * width);
+            if (!file.read(reinterpret_cast<char *>(entry->responses.data()), steps * sizeof(double))
+                || !file.read(reinterpret_cast<char *>(entry->output_values.data()), steps * width * sizeof(double))) {
+                return nullptr;
+            }
+            return entry;
+        }
+
+        /**
+         * @brief Write the entry of a catchment, replacing any it had.
+         *
+         * The file is written under a temporary name and renamed into place, so an interrupted run never leaves a
+         * partial entry.
+         *
+         * @throws std::runtime_error If the entry cannot be written.
+         */
+        void store(const std::string &catchment_id, const Entry &entry) const {
+            const std::string path = path_of(catchment_id);
+            const std::string temporary_path = path + ".tmp";
+            {
+                std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+                file.write(RESPONSE_CACHE_MAGIC, sizeof(RESPONSE_CACHE_MAGIC));
+                put(file, RESPONSE_CACHE_VERSION);
+                put(file, entry.signature);
+                put<std::uint64_t>(file, entry.responses.size());
+                put<std::uint32_t>(file, entry.output_names.size());
+                for (const std::string &name : entry.output_names) {
+                    put<std::uint32_t>(file, name.size());
+                    file.write(name.data(), name.size());
+                }
+                file.write(reinterpret_cast<const char *>(entry.responses.data()),
+                           entry.responses.size() * sizeof(double));
+                file.write(reinterpret_cast<const char *>(entry.output_values.data()),
+                           entry.output_values.size() * sizeof(double));
+                if (!file) {
+                    throw std::runtime_error("Unable to write response cache file " + temporary_path);
+                }
+            }
+            if (std::rename(temporary_path.c_str(), path.c_str()) != 0) {
+                throw std::runtime_error("Unable to replace response cache file " + path);
+            }
+        }
+
+    private:
+
+        template<typename T>
+        static void put(std::ostream &out, T value) {
+            out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+        }
+
+        template<typename T>
+        static bool get(std::istream &in, T &value) {
+            return static_cast<bool>(in.read(reinterpret_cast<char *>(&value), sizeof(T)));
+        }
+
+        std::string path_of(const std::string &catchment_id) const {
+            return directory + "/" + catchment_id + RESPONSE_CACHE_EXTENSION;
+        }
+
+        std::string directory;
+        std::mutex mutex;
+        std::unordered_map<std::string, std::uint64_t> signatures;
+    };
+
+}
+
+#endif //NGEN_RESPONSE_CACHE_HPP
@@ -98,23 +98,31 @@ class Simple_Lumped_Model_Realization
 
         void add_time(time_t t, double n) override;
 
+        void save_state(utils::StateWriter &out) override;
+
+        void load_state(utils::StateReader &in) override;
+
+        void load_initial_state(utils::StateReader &in) override;
+
     protected:
-        std::vector<std::string> REQUIRED_PARAMETERS = {
-            "sr",
-            "storage",
-            "gw_storage",
-            "gw_max_storage",
-            "nash_max_storage",
-            "smax",
-            "a",
-            "b",
-            "Ks",
-            "Kq",
-            "n",
-            "t"
-        };
+        /** Restore the saved state following its time step as the state of time step @p t. */
+        void restore_state(time_step_t t, utils::StateReader &in);
 
         const std::vector<std::string>& get_required_parameters() override {
+            static const std::vector<std::string> REQUIRED_PARAMETERS = {
+                "sr",
+                "storage",
+                "gw_storage",
+                "gw_max_storage",
+                "nash_max_storage",
+                "smax",
+                "a",
+                "b",
+                "Ks",
+                "Kq",
+                "n",
+                "t"
+            };
             return REQUIRED_PARAMETERS;
         }
 
@@ -124,8 +132,11 @@ class Simple_Lumped_Model_Realization
         std::unordered_map<time_step_t, hymod_fluxes> fluxes;
         std::unordered_map<time_step_t, std::vector<double> > cascade_backing_storage;
         hymod_params params;
-
-
+        /**
+         * The precipitation and soil storage, in meters, at or below which a time step only drains the reservoirs,
+         * from the optional ``quiescent_threshold`` parameter; negative, running every step in full, by default.
+         */
+        double quiescent_threshold_meters = -1.0;
 
 };
 
@@ -0,0 +1,51 @@
+#ifndef NGEN_STATIC_BMI_C_MODULES_HPP
+#define NGEN_STATIC_BMI_C_MODULES_HPP
+
+#include <cstring>
+#include <string>
+#include "bmi.h"
+
+namespace models {
+    namespace bmi {
+
+        /** The type of the registration function of a BMI C module, which sets up the function pointers of a model. */
+        typedef ::Bmi *(*Bmi_C_Registration_Function)(::Bmi *model);
+
+        /**
+         * A BMI C module linked into the ngen executable, rather than loaded from a shared library when it is used.
+         *
+         * The build links each module of the ``STATIC_BMI_C_MODULES`` CMake variable, and generates the table of them,
+         * @ref static_bmi_c_modules, so the adapters of their models call into them directly, and with link time
+         * optimization the compiler may inline the calls.
+         */
+        struct Static_Bmi_C_Module {
+            /** The name of the module's registration function, by which a formulation config selects the module. */
+            const char *registration_function_name;
+            Bmi_C_Registration_Function registration_function;
+        };
+
+        /**
+         * The BMI C modules linked into the executable, generated by the build, ending with an entry whose name is null.
+         */
+        extern const Static_Bmi_C_Module static_bmi_c_modules[];
+
+        /**
+         * Find the registration function of a BMI C module linked into the executable.
+         *
+         * @param registration_function_name The name of the module's registration function.
+         * @return The registration function, or ``nullptr`` if no module linked in has one of that name.
+         */
+        inline Bmi_C_Registration_Function find_static_bmi_c_module(const std::string &registration_function_name) {
+            for (const Static_Bmi_C_Module *module = static_bmi_c_modules; module->registration_function_name != nullptr;
+                 ++module) {
+                if (registration_function_name == module->registration_function_name) {
+                    return module->registration_function;
+                }
+            }
+            return nullptr;
+        }
+
+    }
+}
+
+#endif //NGEN_STATIC_BMI_C_MODULES_HPP
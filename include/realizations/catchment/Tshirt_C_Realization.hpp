@@ -273,8 +273,8 @@ namespace realization {
         /** Struct from C-style Tshirt formulation for holding soil parameter values. */
         NWM_soil_parameters c_soil_params;
 
-        /** Vector of GIUH CDF ordinates. */
-        std::vector<double> giuh_cdf_ordinates;
+        /** Vector of GIUH CDF ordinates, interned in the giuh::giuh_ordinate_table. */
+        std::shared_ptr<const std::vector<double>> giuh_cdf_ordinates;
         /** Vector to serve as runoff queue for GIUH convolution calculations. */
         std::vector<double> giuh_runoff_queue_per_timestep;
         std::vector<double> nash_storage;
@@ -306,26 +306,6 @@ namespace realization {
         };
 
         conceptual_reservoir soil_conceptual_reservoir;
-        std::vector<std::string> REQUIRED_PARAMETERS = {
-                "maxsmc",
-                "wltsmc",
-                "satdk",
-                "satpsi",
-                "slope",
-                "scaled_distribution_fn_shape_parameter",
-                "multiplier",
-                "alpha_fc",
-                "Klf",
-                "Kn",
-                "nash_n",
-                "Cgw",
-                "expon",
-                "max_groundwater_storage_meters",
-                "nash_storage",
-                "soil_storage_percentage",
-                "groundwater_storage_percentage",
-                "giuh"
-        };
 
         std::function<double(tshirt_c_result_fluxes)> get_output_var_flux_extraction_func(const std::string& var_name);
 
@@ -65,7 +65,8 @@ namespace realization {
 
             void set_giuh_kernel(std::shared_ptr<giuh::GiuhJsonReader> reader);
 
-            virtual ~Tshirt_Realization(){};
+            /** Check the mass balance of any time steps since the model's last mass check, warning if it fails. */
+            virtual ~Tshirt_Realization();
 
             double calc_et() override;
 
@@ -114,6 +115,27 @@ namespace realization {
             void create_formulation(geojson::PropertyMap properties) override;
 
             const std::vector<std::string>& get_required_parameters() override {
+                static const std::vector<std::string> REQUIRED_PARAMETERS = {
+                    "maxsmc",
+                    "wltsmc",
+                    "satdk",
+                    "satpsi",
+                    "slope",
+                    "scaled_distribution_fn_shape_parameter",
+                    "multiplier",
+                    "alpha_fc",
+                    "Klf",
+                    "Kn",
+                    "nash_n",
+                    "Cgw",
+                    "expon",
+                    "max_groundwater_storage_meters",
+                    "nash_storage",
+                    "soil_storage_percentage",
+                    "groundwater_storage_percentage",
+                    "timestep",
+                    "giuh"
+                };
                 return REQUIRED_PARAMETERS;
             }
 
@@ -128,29 +150,6 @@ namespace realization {
 
             //The delta time (dt) this instance is configured to use
             time_step_t dt;
-
-            std::vector<std::string> REQUIRED_PARAMETERS = {
-                "maxsmc",
-                "wltsmc",
-                "satdk",
-                "satpsi",
-                "slope",
-                "scaled_distribution_fn_shape_parameter",
-                "multiplier",
-                "alpha_fc",
-                "Klf",
-                "Kn",
-                "nash_n",
-                "Cgw",
-                "expon",
-                "max_groundwater_storage_meters",
-                "nash_storage",
-                "soil_storage_percentage",
-                "groundwater_storage_percentage",
-                "timestep",
-                "giuh"
-            };
-
     };
 
 }
@@ -9,19 +9,37 @@ using namespace std;
 struct routing_params
 {
     std::string t_route_config_file_with_path;
+    /** Whether nexus flows are handed to routing in memory, rather than through nexus output files. */
+    bool in_memory_flows;
+    /** Whether the config gave #in_memory_flows, rather than leaving it to its default. */
+    bool in_memory_flows_given;
+    /** With in memory flows, the number of time steps handed to routing at a time during the run, or 0 for all at the end. */
+    int flow_chunk_steps;
+    /**
+     * With in memory flows in chunks, whether each chunk is routed on a worker thread as soon as it is handed over,
+     * while the simulation computes the next, rather than all of them once the simulation is done.
+     */
+    bool pipelined;
 
     /**
-     * Default constructor, using empty strings for both member values
+     * Default constructor, using an empty config path and nexus output files
      */
-    routing_params() : t_route_config_file_with_path("") {}
+    routing_params() : t_route_config_file_with_path(""), in_memory_flows(false), in_memory_flows_given(false),
+        flow_chunk_steps(0), pipelined(false) {}
 
     /*
      * @brief Constructor for routing_params
      *
      * @param t_route_config_file_with_path
+     * @param in_memory_flows
+     * @param flow_chunk_steps
      */
-    routing_params(std::string t_route_config_file_with_path):
-        t_route_config_file_with_path(t_route_config_file_with_path)
+    routing_params(std::string t_route_config_file_with_path, bool in_memory_flows = false, int flow_chunk_steps = 0):
+        t_route_config_file_with_path(t_route_config_file_with_path),
+        in_memory_flows(in_memory_flows),
+        in_memory_flows_given(false),
+        flow_chunk_steps(flow_chunk_steps),
+        pipelined(false)
         {
         }
 
@@ -0,0 +1,186 @@
+#ifndef NGEN_ROUTING_PIPELINE_HPP
+#define NGEN_ROUTING_PIPELINE_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace routing_py_adapter {
+
+    /**
+     * @brief Routes consecutive chunks of nexus flows on a worker thread, while the simulation computes the next.
+     *
+     * Each chunk given to @ref submit is copied and then routed by the worker, in order, so routing chunk ``k``
+     * overlaps computing chunk ``k+1``, and a run takes about as long as the slower of the simulation and routing,
+     * rather than their sum.  At most one chunk waits while another is routed: @ref submit blocks while one already
+     * is, so the flows held are those of the chunk being routed, the chunk waiting, and the chunk being computed.
+     *
+     * Routing is expected to take the GIL itself, so the threads calling @ref submit and @ref finish must not hold it.
+     */
+    class Routing_Pipeline {
+
+    public:
+
+        /** Routes a chunk, with the arguments of @ref Routing_Py_Adapter::receive_flows. */
+        typedef std::function<void(const std::vector<std::string>& nexus_ids, const std::vector<std::string>& timestamps,
+                                   const double* flows, std::size_t row_stride)> route_function_t;
+
+        /**
+         * @param route How to route each chunk, on the worker thread.
+         */
+        explicit Routing_Pipeline(route_function_t route) : route(std::move(route))
+        {
+            worker = std::thread(&Routing_Pipeline::run, this);
+        }
+
+        Routing_Pipeline(const Routing_Pipeline&) = delete;
+        Routing_Pipeline& operator=(const Routing_Pipeline&) = delete;
+
+        /** Routes whatever was submitted, warning of any failure rather than throwing. */
+        ~Routing_Pipeline()
+        {
+            try {
+                finish();
+            }
+            catch (const std::exception& e) {
+                std::cerr << "WARNING: " << e.what() << std::endl;
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            changed.notify_all();
+            worker.join();
+        }
+
+        /**
+         * @brief Copy a chunk of flows, to be routed after the chunks submitted before it.
+         *
+         * @param nexus_ids The id of each row of @p flows.
+         * @param timestamps The timestamp of each column of @p flows.
+         * @param flows The flows of nexus ``n`` at step ``s`` at ``flows[n * row_stride + s]``.
+         * @param row_stride The distance between the flows of consecutive nexuses, at least ``timestamps.size()``.
+         * @throws std::runtime_error If routing an earlier chunk failed.
+         */
+        void submit(const std::vector<std::string>& nexus_ids, const std::vector<std::string>& timestamps,
+                    const double* flows, std::size_t row_stride)
+        {
+            std::unique_ptr<Chunk> chunk(new Chunk());
+            chunk->nexus_ids = nexus_ids;
+            chunk->timestamps = timestamps;
+            std::size_t steps = timestamps.size();
+            chunk->flows.resize(nexus_ids.size() * steps);
+            for (std::size_t n = 0; n < nexus_ids.size(); ++n) {
+                std::copy(flows + n * row_stride, flows + n * row_stride + steps, chunk->flows.begin() + n * steps);
+            }
+
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [this] { return !waiting || error; });
+            throw_error();
+            waiting = std::move(chunk);
+            changed.notify_all();
+        }
+
+        /**
+         * @brief Wait until every submitted chunk is routed.
+         *
+         * @throws std::runtime_error If routing a chunk failed.
+         */
+        void finish()
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [this] { return (!waiting && !busy) || error; });
+            throw_error();
+        }
+
+        /** @return The number of time steps routed so far. */
+        std::size_t get_routed_steps()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return routed_steps;
+        }
+
+        /** @return The number of submitted chunks not yet routed, including the one being routed. */
+        std::size_t get_pending_chunks()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return (waiting ? 1 : 0) + (busy ? 1 : 0);
+        }
+
+    private:
+
+        struct Chunk {
+            std::vector<std::string> nexus_ids;
+            std::vector<std::string> timestamps;
+            std::vector<double> flows;
+        };
+
+        /** Throw the failure of routing a chunk, if there was one, with the lock held. */
+        void throw_error()
+        {
+            if (error) {
+                try {
+                    std::rethrow_exception(error);
+                }
+                catch (const std::exception& e) {
+                    throw std::runtime_error(std::string("Routing a chunk of nexus flows failed: ") + e.what());
+                }
+            }
+        }
+
+        void run()
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (true) {
+                changed.wait(lock, [this] { return waiting || stopping; });
+                if (!waiting) {
+                    return;
+                }
+                std::unique_ptr<Chunk> chunk = std::move(waiting);
+                busy = true;
+                changed.notify_all();
+                lock.unlock();
+                std::exception_ptr failure;
+                try {
+                    route(chunk->nexus_ids, chunk->timestamps, chunk->flows.data(), chunk->timestamps.size());
+                }
+                catch (...) {
+                    failure = std::current_exception();
+                }
+                lock.lock();
+                busy = false;
+                if (failure) {
+                    // chunks after a failed one are not routed, since routing state would be missing a chunk
+                    error = failure;
+                    stopping = true;
+                    waiting.reset();
+                }
+                else {
+                    routed_steps += chunk->timestamps.size();
+                }
+                changed.notify_all();
+            }
+        }
+
+        route_function_t route;
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::unique_ptr<Chunk> waiting;
+        bool busy = false;
+        bool stopping = false;
+        std::exception_ptr error;
+        std::size_t routed_steps = 0;
+        std::thread worker;
+    };
+
+}
+
+#endif //NGEN_ROUTING_PIPELINE_HPP
@@ -6,6 +6,7 @@
 #include <exception>
 #include <memory>
 #include <string>
+#include <vector>
 #include "pybind11/pybind11.h"
 #include "pybind11/pytypes.h"
 #include "pybind11/numpy.h"
@@ -27,34 +28,52 @@ namespace routing_py_adapter {
         Routing_Py_Adapter(std::string t_route_config_file_with_path);
 
         /**
-         * Function to run @p number_of_timesteps of routing, extracting 
-         * lateral inflows from @p flow_vector
-         * 
-         * FIXME This is current unimplemented and will require some addtional
-         * work to properly map flows to the correct t-route network segments.
-         * This may not even be the correct concept to implement this type of
-         * "integrated" routing.  But the basic idea is that after a catchment 
-         * update occurs, it contributes some amount of lateral flow to the channel
-         * as represented by @p flow_vector and this flow should be routed down stream
-         * for @p number_of_timesteps .  Note though, that all lateral inflows are required
-         * for a single routing pass of the network, so this would probably end up being a
-         * flow map that we pass to a custom t-route function that extracts the lateral inflow
-         * vector for each identity and constructs the correct lateral inflow setup to make
-         * a full routing pass.
-         * 
-         * See NOTE in @ref route(int, int) route() about python module availablity.
+         * @return Whether the t-route module can receive nexus flows in memory, i.e., has a
+         * ``receive_flow_values`` function for @ref receive_flows to call.
+         */
+        bool supports_in_memory_flows();
+
+        /**
+         * Hand a block of nexus flows to routing in memory, instead of through the nexus output files.
          *
-         * @param number_of_timesteps
-         * @param delta_time
-         * @param flow_vector
+         * The flows are passed, without copying, as a read only ``float64`` numpy array of shape
+         * ``(len(nexus_ids), len(timestamps))`` to the ``receive_flow_values(nexus_ids, timestamps, flows)``
+         * function of the t-route module, which must copy anything it keeps, since the array is only valid for the
+         * duration of the call.  Blocks may cover a whole simulation, or consecutive chunks of it handed over during
+         * the run; a later @ref route(int, int) route() call then routes the received flows.
+         *
+         * Takes the GIL, so may be called from any thread.
+         *
+         * @param nexus_ids The id of each row of @p flows.
+         * @param timestamps The timestamp of each column of @p flows.
+         * @param flows The flows, in m^3/s, of nexus ``n`` at step ``s`` at ``flows[n * row_stride + s]``.
+         * @param row_stride The distance between the flows of consecutive nexuses, at least ``timestamps.size()``.
          */
-        void route(int number_of_timesteps, int delta_time,
-              const std::vector<double> &flow_vector);
+        void receive_flows(const std::vector<std::string> &nexus_ids, const std::vector<std::string> &timestamps,
+                           const double *flows, std::size_t row_stride);
 
+        /**
+         * @return Whether the t-route module can route flows chunk by chunk as it receives them, i.e., has a
+         * ``route_flow_values`` function for @ref route_received_flows to call.
+         */
+        bool supports_chunked_routing();
+
+        /**
+         * Route the flows received by @ref receive_flows since the last call, continuing from the state the
+         * last call left t-route in.
+         *
+         * Calls the ``route_flow_values(number_of_timesteps, delta_time)`` function of the t-route module, which
+         * keeps its own routing state between calls, so a run routed chunk by chunk routes as it would all at once.
+         * Takes the GIL, so may be called from any thread.
+         *
+         * @param number_of_timesteps The number of time steps of the received flows.
+         * @param delta_time The seconds between those time steps.
+         */
+        void route_received_flows(int number_of_timesteps, int delta_time);
 
         /**
          * Function to run a full set of routing computations using the nexus output files
-         * from an ngen simulation.
+         * from an ngen simulation, or the flows given to @ref receive_flows if any were.
          * 
          * Currently, these parameters are ignored and are read instead from the yaml configuration
          * file contained in #t_route_config_path
@@ -75,36 +94,6 @@ namespace routing_py_adapter {
         void route(int number_of_timesteps, int delta_time);
 
 
-        template <typename T>
-        void convert_vector_to_numpy_array(const std::vector<T> &flow_vector)
-        {
-            /**
-            * NOTE: Currently not using this function because current plan is to have routing read Nexus
-            * values from Nexus output files instead of passing in-memory values to t-route. If
-            * the ability to pass in-memory values to t-route is needed, then the following TODOs are
-            * needed.
-            * TODO: Retrieve and convert map of Nexus IDs with Nexus flow vectors to Python dictionary
-            *       of NumPy arrays
-            * TODO: Retrieve single time index vector for all Nexus flow values and convert to NumPy array
-            */
-
-            //Allocate py::array (to pass the result of the C++ function to Python)
-            auto result = py::array_t<T>(flow_vector.size());
-            auto result_buffer = result.request();
-            T *result_ptr = (T *) result_buffer.ptr;
-
-            //Copy std::vector -> py::array
-            std::memcpy(result_ptr, flow_vector.data(), flow_vector.size()*sizeof(T));
-
-            //Create object for receive_flow_values subroutine
-            py::object receive_flow_values = t_route_module.attr("receive_flow_values");
-
-            //Call receive_flow_values subroutine
-            receive_flow_values(result);
-
-        }
-
-
     private:
 
 
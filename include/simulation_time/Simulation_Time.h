@@ -2,7 +2,10 @@
 #define SIMULATION_TIME_H
 
 #include <ctime>
+#include <stdexcept>
+#include <string>
 #include <time.h>
+#include "Timestamp_Generator.h"
 
 using namespace std;
 
@@ -51,12 +54,10 @@ class Simulation_Time
      * @brief Constructor building a Simulation Time object
      * @param start_date_time_epoch
      * @param end_date_time_epoch
-     * @param current_date_time_epoch
      * @param output_interval_seconds
      */
     Simulation_Time(simulation_time_params simulation_time_config):start_date_time_epoch(simulation_time_config.start_t),
                                            end_date_time_epoch(simulation_time_config.end_t),
-                                           current_date_time_epoch(simulation_time_config.start_t),
                                            output_interval_seconds(simulation_time_config.output_interval)
     {
 
@@ -77,6 +78,32 @@ class Simulation_Time
         return total_output_times;
     }
 
+    /**
+     * @brief Move the end of the simulation to a later time, adding output times after the current ones.
+     * @param new_end_date_time_epoch The epoch time of the new end of the simulation.
+     * @return The total number of output times after the extension.
+     * @throws std::invalid_argument If the new end time is before the current one.
+     */
+    int extend_end_time(time_t new_end_date_time_epoch)
+    {
+        if (new_end_date_time_epoch < end_date_time_epoch) {
+            throw std::invalid_argument("Cannot move the simulation end time back before the current end time.");
+        }
+        end_date_time_epoch = new_end_date_time_epoch;
+        simulation_total_time_seconds = end_date_time_epoch - start_date_time_epoch;
+        total_output_times = simulation_total_time_seconds / output_interval_seconds + 1;
+        return total_output_times;
+    }
+
+    /**
+     * @brief Accessor to the end of the simulation
+     * @return end_date_time_epoch
+     */
+    time_t get_end_time()
+    {
+        return end_date_time_epoch;
+    }
+
     /**
      * @brief Accessor to the output_interval_seconds
      * @return output_interval_seconds
@@ -88,27 +115,29 @@ class Simulation_Time
 
     /**
      * @brief Accessor to the current timestamp string
+     *
+     * This depends on no shared state, so it is safe to call from several threads at once (for a series of
+     * timestamps, stepping a @ref Timestamp_Generator from @ref get_start_time is faster still).
+     *
      * @return current_timestamp
      */ 
-    std::string get_timestamp(int current_output_time_index)
+    std::string get_timestamp(int current_output_time_index) const
     {
-        current_date_time_epoch = start_date_time_epoch + current_output_time_index * output_interval_seconds;
-            
-        struct tm *temp_gmtime_struct;
-
-        temp_gmtime_struct = gmtime(&current_date_time_epoch);
-
-        char current_timestamp[20];
-        const char* time_format = "%Y-%m-%d %T";
-
-        if (strftime(current_timestamp, sizeof(current_timestamp), time_format, temp_gmtime_struct) == 0) { 
-            fprintf(stderr, "ERROR: strftime returned 0");
-            exit(EXIT_FAILURE); 
-        }
-
+        char current_timestamp[Timestamp_Generator::timestamp_length + 1];
+        Timestamp_Generator::format(start_date_time_epoch + current_output_time_index * output_interval_seconds,
+                                    current_timestamp);
         return current_timestamp;
     }
 
+    /**
+     * @brief Accessor to the start of the simulation
+     * @return start_date_time_epoch
+     */
+    time_t get_start_time() const
+    {
+        return start_date_time_epoch;
+    }
+
     private:
 
     int total_output_times;
@@ -117,7 +146,6 @@ class Simulation_Time
 
     time_t start_date_time_epoch;
     time_t end_date_time_epoch;
-    time_t current_date_time_epoch;
 };
 
 
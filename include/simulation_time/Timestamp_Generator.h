@@ -0,0 +1,181 @@
+#ifndef TIMESTAMP_GENERATOR_H
+#define TIMESTAMP_GENERATOR_H
+
+#include <cstddef>
+#include <ctime>
+#include <stdexcept>
+#include <string>
+
+/**
+ * @brief Generator of the UTC timestamps, in the form ``yyyy-mm-dd hh:mm:ss``, of a series of evenly spaced times.
+ *
+ * Rather than converting each time with ``gmtime`` and ``strftime``, this steps the epoch time and its calendar date
+ * and time of day forward one interval at a time, only working out the date again when a step crosses into a new day,
+ * and writes the timestamp into a fixed buffer that is reused for every step.  Nothing is shared between generators
+ * (unlike the result of ``gmtime``), so each thread may use its own.
+ */
+class Timestamp_Generator
+{
+    public:
+
+    /** The number of characters in a timestamp. */
+    static const std::size_t timestamp_length = 19;
+
+    /**
+     * @brief Constructor of a generator, at the first time of its series.
+     * @param epoch_time The first time of the series.
+     * @param interval_seconds The seconds between the times of the series.
+     * @throws std::invalid_argument If the interval is not positive.
+     */
+    Timestamp_Generator(time_t epoch_time, long interval_seconds) : interval_seconds(interval_seconds)
+    {
+        if (interval_seconds <= 0) {
+            throw std::invalid_argument("Cannot generate timestamps with an interval of less than one second.");
+        }
+        seek(epoch_time);
+    }
+
+    /**
+     * @brief Write the timestamp of a time into a buffer, without depending on any shared state.
+     * @param epoch_time The time.
+     * @param buffer The buffer to write the timestamp into, which must hold at least ``timestamp_length + 1``
+     *               characters, followed by a terminating null character.
+     */
+    static void format(time_t epoch_time, char *buffer)
+    {
+        long long days, seconds_of_day;
+        split_epoch_time(epoch_time, days, seconds_of_day);
+        write_date(days, buffer);
+        buffer[10] = ' ';
+        write_time_of_day(seconds_of_day, buffer);
+        buffer[timestamp_length] = '\0';
+    }
+
+    /**
+     * @brief Step forward to the next time of the series.
+     */
+    void advance()
+    {
+        epoch_time += interval_seconds;
+        seconds_of_day += interval_seconds;
+        if (seconds_of_day >= seconds_per_day) {
+            days += seconds_of_day / seconds_per_day;
+            seconds_of_day %= seconds_per_day;
+            write_date(days, buffer);
+        }
+        write_time_of_day(seconds_of_day, buffer);
+    }
+
+    /**
+     * @brief Move to a time, from which later steps continue.
+     * @param epoch_time The time.
+     */
+    void seek(time_t epoch_time)
+    {
+        this->epoch_time = epoch_time;
+        split_epoch_time(epoch_time, days, seconds_of_day);
+        format(epoch_time, buffer);
+    }
+
+    /**
+     * @brief Accessor to the current time
+     * @return epoch_time
+     */
+    time_t get_epoch_time() const
+    {
+        return epoch_time;
+    }
+
+    /**
+     * @brief Accessor to the timestamp of the current time, which is overwritten by the next step
+     * @return The null terminated timestamp.
+     */
+    const char *c_str() const
+    {
+        return buffer;
+    }
+
+    /**
+     * @brief Accessor to a copy of the timestamp of the current time
+     * @return The timestamp.
+     */
+    std::string str() const
+    {
+        return std::string(buffer, timestamp_length);
+    }
+
+    private:
+
+    static const long long seconds_per_day = 86400;
+
+    /**
+     * @brief Split an epoch time into whole days since the epoch and the seconds since the start of its day.
+     */
+    static void split_epoch_time(time_t epoch_time, long long &days, long long &seconds_of_day)
+    {
+        long long seconds = static_cast<long long>(epoch_time);
+        days = seconds / seconds_per_day;
+        seconds_of_day = seconds % seconds_per_day;
+        // Times before the epoch are still in the day that starts at or before them
+        if (seconds_of_day < 0) {
+            seconds_of_day += seconds_per_day;
+            --days;
+        }
+    }
+
+    /**
+     * @brief Write ``digits`` decimal digits of a value into a buffer, padded with leading zeros.
+     */
+    static void write_digits(long long value, int digits, char *buffer)
+    {
+        for (int i = digits - 1; i >= 0; --i) {
+            buffer[i] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        }
+    }
+
+    /**
+     * @brief Write the ``yyyy-mm-dd`` date of the day that is ``days`` since the epoch into the start of a buffer.
+     *
+     * The proleptic Gregorian calendar date is worked out directly from the day, as in the ``civil_from_days``
+     * algorithm of H. Hinnant, with years counted from March so leap days fall at the end of the year.
+     */
+    static void write_date(long long days, char *buffer)
+    {
+        days += 719468;
+        const long long era = (days >= 0 ? days : days - 146096) / 146097;
+        const long long day_of_era = days - era * 146097;
+        const long long year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+        const long long day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+        const long long month_from_march = (5 * day_of_year + 2) / 153;
+        const long long day = day_of_year - (153 * month_from_march + 2) / 5 + 1;
+        const long long month = month_from_march < 10 ? month_from_march + 3 : month_from_march - 9;
+        const long long year = year_of_era + era * 400 + (month <= 2 ? 1 : 0);
+
+        write_digits(year, 4, buffer);
+        buffer[4] = '-';
+        write_digits(month, 2, buffer + 5);
+        buffer[7] = '-';
+        write_digits(day, 2, buffer + 8);
+    }
+
+    /**
+     * @brief Write the ``hh:mm:ss`` time of day after the date and separating space in a buffer.
+     */
+    static void write_time_of_day(long long seconds_of_day, char *buffer)
+    {
+        write_digits(seconds_of_day / 3600, 2, buffer + 11);
+        buffer[13] = ':';
+        write_digits(seconds_of_day / 60 % 60, 2, buffer + 14);
+        buffer[16] = ':';
+        write_digits(seconds_of_day % 60, 2, buffer + 17);
+    }
+
+    long interval_seconds;
+    time_t epoch_time;
+    long long days;
+    long long seconds_of_day;
+    char buffer[timestamp_length + 1];
+};
+
+#endif // TIMESTAMP_GENERATOR_H
@@ -0,0 +1,81 @@
+#ifndef NGEN_ALIGNED_ALLOCATOR_HPP
+#define NGEN_ALIGNED_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <vector>
+
+namespace utils
+{
+    /**
+     * @brief An allocator whose allocations start on an @p Alignment byte boundary, e.g., a cache line, so arrays of
+     * values moved in bulk between models and providers can be copied and vectorized without split cache lines.
+     *
+     * Allocations are taken from the global allocator, with enough extra room to align them and to keep a pointer to
+     * the allocation ahead of the aligned storage, which @ref deallocate releases.
+     *
+     * @tparam T The type of the values allocated.
+     * @tparam Alignment The alignment of allocations, a power of two of at least that of ``T``.
+     */
+    template<typename T, std::size_t Alignment = 64>
+    class aligned_allocator
+    {
+        static_assert((Alignment & (Alignment - 1)) == 0, "Alignment must be a power of two");
+        static_assert(Alignment >= alignof(T), "Alignment must be at least that of the values' type");
+
+      public:
+
+        using value_type = T;
+
+        template<typename U>
+        struct rebind
+        {
+            using other = aligned_allocator<U, Alignment>;
+        };
+
+        aligned_allocator() noexcept = default;
+
+        template<typename U>
+        aligned_allocator(const aligned_allocator<U, Alignment>&) noexcept {}
+
+        T* allocate(std::size_t n)
+        {
+            const std::size_t extra = Alignment - 1 + sizeof(void*);
+            if (n > (std::numeric_limits<std::size_t>::max() - extra) / sizeof(T)) {
+                throw std::bad_alloc();
+            }
+            void* allocation = ::operator new(n * sizeof(T) + extra);
+            std::uintptr_t start = reinterpret_cast<std::uintptr_t>(allocation) + sizeof(void*);
+            std::uintptr_t aligned = (start + Alignment - 1) & ~static_cast<std::uintptr_t>(Alignment - 1);
+            reinterpret_cast<void**>(aligned)[-1] = allocation;
+            return reinterpret_cast<T*>(aligned);
+        }
+
+        void deallocate(T* p, std::size_t) noexcept
+        {
+            if (p != nullptr) {
+                ::operator delete(reinterpret_cast<void**>(p)[-1]);
+            }
+        }
+    };
+
+    template<typename T, typename U, std::size_t Alignment>
+    bool operator==(const aligned_allocator<T, Alignment>&, const aligned_allocator<U, Alignment>&) noexcept
+    {
+        return true;
+    }
+
+    template<typename T, typename U, std::size_t Alignment>
+    bool operator!=(const aligned_allocator<T, Alignment>&, const aligned_allocator<U, Alignment>&) noexcept
+    {
+        return false;
+    }
+
+    /** A vector whose values start on a cache line. */
+    template<typename T>
+    using aligned_vector = std::vector<T, aligned_allocator<T>>;
+}
+
+#endif //NGEN_ALIGNED_ALLOCATOR_HPP
@@ -0,0 +1,150 @@
+#ifndef NGEN_ASYNC_OUTPUT_WRITER_HPP
+#define NGEN_ASYNC_OUTPUT_WRITER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <thread>
+
+#include "BoundedQueue.hpp"
+
+namespace utils
+{
+    /**
+     * @brief Hands output records to a dedicated background thread, which formats and writes them.
+     *
+     * Producers (e.g., the threads running catchment formulations) only move a record into a lock free
+     * utils::BoundedQueue, so slow formatting or a slow filesystem does not hold up the computation.  If the queue is
+     * full, producers wait for room, which bounds the memory used by output that has not been written yet.
+     *
+     * Records are handed to the sink in the order they were pushed; in particular, records pushed by a single thread
+     * stay in that thread's order.  The sink only ever runs on the background thread.
+     *
+     * @tparam Record The queued record type, which must be default constructible and move assignable.
+     */
+    template<typename Record>
+    class AsyncOutputWriter
+    {
+      public:
+
+        /**
+         * @param capacity The maximum number of records waiting to be written.
+         * @param sink Function that formats and writes a record, invoked on the background thread.
+         */
+        AsyncOutputWriter(std::size_t capacity, std::function<void(Record&)> sink)
+            : queue(capacity), sink(sink), pushed(0), written(0), stopping(false), failed(false)
+        {
+            io_thread = std::thread(&AsyncOutputWriter::drain, this);
+        }
+
+        AsyncOutputWriter(const AsyncOutputWriter&) = delete;
+        AsyncOutputWriter& operator=(const AsyncOutputWriter&) = delete;
+
+        /**
+         * @brief Write everything still queued, then stop the background thread.
+         */
+        virtual ~AsyncOutputWriter()
+        {
+            stopping.store(true, std::memory_order_release);
+            io_thread.join();
+        }
+
+        /**
+         * @brief Queue a record to be written, waiting for room if the queue is full.
+         *
+         * Safe to call from any number of threads.
+         *
+         * @param record The record, which is moved from.
+         */
+        void push(Record& record)
+        {
+            while (!queue.try_push(record)) {
+                std::this_thread::yield();
+            }
+            pushed.fetch_add(1, std::memory_order_release);
+        }
+
+        /**
+         * @brief Queue a record to be written if there is room, without waiting.
+         *
+         * Safe to call from any number of threads.
+         *
+         * @param record The record, which is moved from if queued.
+         * @return Whether the record was queued.
+         */
+        bool try_push(Record& record)
+        {
+            if (!queue.try_push(record)) {
+                return false;
+            }
+            pushed.fetch_add(1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief Wait until every record pushed before the call has been written.
+         *
+         * @throws Rethrows the first exception raised by the sink, if any.
+         */
+        void flush()
+        {
+            std::size_t target = pushed.load(std::memory_order_acquire);
+            while (written.load(std::memory_order_acquire) < target && !failed.load(std::memory_order_acquire)) {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+            if (failed.load(std::memory_order_acquire)) {
+                std::rethrow_exception(failure);
+            }
+        }
+
+        /** @return The number of records queued but not yet written, which may change as soon as it is read. */
+        std::size_t get_queued_count() const
+        {
+            // A record is counted as pushed just after it is queued, so may already be counted as written
+            std::size_t written_count = written.load(std::memory_order_acquire);
+            std::size_t pushed_count = pushed.load(std::memory_order_acquire);
+            return pushed_count > written_count ? pushed_count - written_count : 0;
+        }
+
+      private:
+
+        void drain()
+        {
+            Record record;
+            for (;;) {
+                if (queue.try_pop(record)) {
+                    if (!failure) {
+                        try {
+                            sink(record);
+                        }
+                        catch (...) {
+                            failure = std::current_exception();
+                            failed.store(true, std::memory_order_release);
+                        }
+                    }
+                    written.fetch_add(1, std::memory_order_release);
+                }
+                else if (stopping.load(std::memory_order_acquire)
+                         && written.load(std::memory_order_relaxed) == pushed.load(std::memory_order_acquire)) {
+                    return;
+                }
+                else {
+                    std::this_thread::sleep_for(std::chrono::microseconds(50));
+                }
+            }
+        }
+
+        BoundedQueue<Record> queue;
+        std::function<void(Record&)> sink;
+        std::atomic<std::size_t> pushed;
+        std::atomic<std::size_t> written;
+        std::atomic<bool> stopping;
+        std::atomic<bool> failed;
+        /** First exception from the sink; only read by other threads once @ref failed is set. */
+        std::exception_ptr failure;
+        std::thread io_thread;
+    };
+}
+
+#endif //NGEN_ASYNC_OUTPUT_WRITER_HPP
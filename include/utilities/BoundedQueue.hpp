@@ -0,0 +1,141 @@
+#ifndef NGEN_BOUNDED_QUEUE_HPP
+#define NGEN_BOUNDED_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace utils
+{
+    /**
+     * @brief A fixed capacity, lock free, multiple producer multiple consumer FIFO queue.
+     *
+     * This is the array based queue design of Dmitry Vyukov: each slot carries a sequence number that tells producers
+     * and consumers whether the slot is free for the current lap around the ring, so claiming a slot takes a single
+     * compare and swap on the shared head or tail position.  Neither operation blocks; callers decide how to wait
+     * when the queue is full or empty.
+     *
+     * @tparam T The element type, which must be default constructible and move assignable.
+     */
+    template<typename T>
+    class BoundedQueue
+    {
+      public:
+
+        /**
+         * @param capacity The maximum number of queued elements, rounded up to the next power of two.
+         */
+        BoundedQueue(std::size_t capacity) : enqueue_pos(0), dequeue_pos(0)
+        {
+            if (capacity == 0) {
+                throw std::invalid_argument("BoundedQueue: capacity must be greater than zero.");
+            }
+            std::size_t size = 1;
+            while (size < capacity) {
+                size <<= 1;
+            }
+            mask = size - 1;
+            cells = std::vector<Cell>(size);
+            for (std::size_t i = 0; i < size; ++i) {
+                cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        BoundedQueue(const BoundedQueue&) = delete;
+        BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+        /**
+         * @return The number of elements the queue can hold.
+         */
+        std::size_t capacity() const { return mask + 1; }
+
+        /**
+         * @brief Add an element to the back of the queue, if there is room.
+         *
+         * @param value The element, which is moved from only if the push succeeds.
+         * @return Whether the element was queued.
+         */
+        bool try_push(T& value)
+        {
+            Cell* cell;
+            std::size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+            for (;;) {
+                cell = &cells[pos & mask];
+                std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+                std::ptrdiff_t diff = (std::ptrdiff_t)seq - (std::ptrdiff_t)pos;
+                if (diff == 0) {
+                    if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                }
+                else if (diff < 0) {
+                    // The slot still holds an element from the previous lap
+                    return false;
+                }
+                else {
+                    pos = enqueue_pos.load(std::memory_order_relaxed);
+                }
+            }
+            cell->data = std::move(value);
+            cell->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief Remove the element at the front of the queue, if there is one.
+         *
+         * @param value Set to the removed element when returning @c true.
+         * @return Whether an element was removed.
+         */
+        bool try_pop(T& value)
+        {
+            Cell* cell;
+            std::size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+            for (;;) {
+                cell = &cells[pos & mask];
+                std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+                std::ptrdiff_t diff = (std::ptrdiff_t)seq - (std::ptrdiff_t)(pos + 1);
+                if (diff == 0) {
+                    if (dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                }
+                else if (diff < 0) {
+                    // Nothing has been pushed to this slot yet
+                    return false;
+                }
+                else {
+                    pos = dequeue_pos.load(std::memory_order_relaxed);
+                }
+            }
+            value = std::move(cell->data);
+            cell->sequence.store(pos + mask + 1, std::memory_order_release);
+            return true;
+        }
+
+      private:
+
+        struct Cell {
+            Cell() : sequence(0) {}
+            Cell(Cell&& other) : sequence(other.sequence.load()), data(std::move(other.data)) {}
+            Cell& operator=(Cell&& other) {
+                sequence.store(other.sequence.load());
+                data = std::move(other.data);
+                return *this;
+            }
+            std::atomic<std::size_t> sequence;
+            T data;
+        };
+
+        std::vector<Cell> cells;
+        std::size_t mask;
+        // Pad the producer and consumer positions onto separate cache lines
+        char pad_enqueue[64];
+        std::atomic<std::size_t> enqueue_pos;
+        char pad_dequeue[64];
+        std::atomic<std::size_t> dequeue_pos;
+    };
+}
+
+#endif //NGEN_BOUNDED_QUEUE_HPP
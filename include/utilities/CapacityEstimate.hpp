@@ -0,0 +1,326 @@
+#ifndef NGEN_CAPACITY_ESTIMATE_HPP
+#define NGEN_CAPACITY_ESTIMATE_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace utils
+{
+    /**
+     * @brief Estimates what a run will take of a process, its compute time per output time step, the memory of its
+     * models and the flows it exchanges with other processes, from coefficients of the cost of each catchment, without
+     * constructing any formulation; for sizing jobs with a dry run.
+     *
+     * A catchment's time and memory are each those given for its id, else for its formulation type (e.g. ``bmi_c``),
+     * else the ``default`` ones, which start out as @ref DEFAULT_SECONDS_PER_STEP and @ref DEFAULT_BYTES.  They are
+     * read from ``key,seconds_per_step[,megabytes]`` lines, so the catchment cost files written with
+     * ``--catchment-costs`` give the time of each catchment, while its memory comes from a line for its type.
+     *
+     * @code {.cpp}
+     * utils::CapacityEstimate estimate;
+     * estimate.read_coefficients("costs.csv");
+     * estimate.add_catchment("cat-27", "bmi_c");
+     * estimate.add_remote_connection(1);
+     * double seconds = estimate.get_seconds_per_step(8);
+     * @endcode
+     */
+    class CapacityEstimate
+    {
+      public:
+
+        /** The cost of a catchment. */
+        struct Coefficients
+        {
+            /** The wall time its formulation takes per output time step */
+            double seconds_per_step = 0.0;
+            /** The memory of its formulation, including its model and forcing */
+            double bytes = 0.0;
+        };
+
+        /** Seconds per output time step of a catchment without coefficients. */
+        static constexpr double DEFAULT_SECONDS_PER_STEP = 1.0e-4;
+        /** Bytes of a catchment without coefficients. */
+        static constexpr double DEFAULT_BYTES = 1024.0 * 1024.0;
+        /** Bytes of a flow exchanged with another process per output time step, as sent through a remote nexus. */
+        static constexpr double BYTES_PER_REMOTE_FLOW = sizeof(double);
+        /** Bytes, beyond its flows, of the block exchanged with each other process per output time step: the first
+            time step and length of its chunk. */
+        static constexpr double BYTES_PER_NEIGHBOR = 2 * sizeof(double);
+
+        CapacityEstimate()
+        {
+            seconds_per_step["default"] = DEFAULT_SECONDS_PER_STEP;
+            bytes["default"] = DEFAULT_BYTES;
+        }
+
+        /**
+         * @brief Read coefficients from a file, one ``key,seconds_per_step[,megabytes]`` line per catchment id or
+         * formulation type, or ``default``; coefficients given later replace any given earlier.
+         *
+         * Blank lines and lines starting with ``#`` are skipped.  A line without megabytes gives only the time, leaving
+         * the memory of the key as it was.
+         *
+         * @param path The path of the file.
+         * @throws std::runtime_error If the file can't be read, or a line is malformed.
+         */
+        void read_coefficients(const std::string& path)
+        {
+            std::ifstream input(path);
+            if (!input) {
+                throw std::runtime_error("Unable to read the cost coefficients file " + path);
+            }
+            std::string line;
+            for (long number = 1; std::getline(input, line); ++number) {
+                std::size_t begin = line.find_first_not_of(" \t\r");
+                if (begin == std::string::npos || line[begin] == '#') {
+                    continue;
+                }
+                std::size_t first_comma = line.find(',', begin);
+                std::size_t second_comma = first_comma == std::string::npos ? first_comma : line.find(',', first_comma + 1);
+                try {
+                    if (first_comma == std::string::npos || first_comma == begin) {
+                        throw std::invalid_argument("no key");
+                    }
+                    std::string key = line.substr(begin, line.find_last_not_of(" \t", first_comma - 1) + 1 - begin);
+                    seconds_per_step[key] = std::stod(line.substr(first_comma + 1, second_comma - first_comma - 1));
+                    if (second_comma != std::string::npos) {
+                        bytes[key] = std::stod(line.substr(second_comma + 1)) * 1024.0 * 1024.0;
+                    }
+                }
+                catch (const std::logic_error&) {
+                    throw std::runtime_error("Malformed cost coefficients on line " + std::to_string(number) + " of "
+                                             + path + "; expected key,seconds_per_step[,megabytes]");
+                }
+            }
+        }
+
+        /** Set the coefficients of a catchment id, of a formulation type, or the ``default`` ones. */
+        void set_coefficients(const std::string& key, const Coefficients& value)
+        {
+            seconds_per_step[key] = value.seconds_per_step;
+            bytes[key] = value.bytes;
+        }
+
+        /**
+         * @brief Add a catchment the process runs.
+         *
+         * @param id The id of the catchment.
+         * @param formulation_type The type of its formulation, e.g. ``bmi_c``.
+         */
+        void add_catchment(const std::string& id, const std::string& formulation_type)
+        {
+            const auto* seconds = find_coefficient(seconds_per_step, id, formulation_type);
+            if (seconds == &seconds_per_step.at("default")) {
+                ++defaulted_catchments;
+            }
+            Coefficients cost;
+            cost.seconds_per_step = *seconds;
+            cost.bytes = *find_coefficient(bytes, id, formulation_type);
+            auto type = std::find_if(types.begin(), types.end(), [&formulation_type](const TypeTotals& entry) {
+                return entry.type == formulation_type;
+            });
+            if (type == types.end()) {
+                types.push_back({formulation_type});
+                type = types.end() - 1;
+            }
+            ++type->catchments;
+            type->seconds_per_step += cost.seconds_per_step;
+            type->bytes += cost.bytes;
+            total_seconds_per_step += cost.seconds_per_step;
+            max_catchment_seconds_per_step = std::max(max_catchment_seconds_per_step, cost.seconds_per_step);
+        }
+
+        /**
+         * @brief Add a flow the process exchanges with another process each output time step, i.e., a remote
+         * connection of its partition.
+         *
+         * @param rank The other process.
+         */
+        void add_remote_connection(int rank)
+        {
+            ++remote_connections;
+            neighbors.insert(rank);
+        }
+
+        /** @return The number of catchments added. */
+        long get_catchment_count() const
+        {
+            long count = 0;
+            for (const TypeTotals& type : types) {
+                count += type.catchments;
+            }
+            return count;
+        }
+
+        /** @return The number of catchments added whose time had to be the default one. */
+        long get_defaulted_catchment_count() const
+        {
+            return defaulted_catchments;
+        }
+
+        /**
+         * @brief Estimate the wall time of an output time step of the catchments, computed concurrently.
+         *
+         * This is their total time split evenly over the threads, but no less than that of the costliest one.
+         *
+         * @param threads The number of catchment threads.
+         * @return The seconds.
+         */
+        double get_seconds_per_step(int threads) const
+        {
+            return std::max(total_seconds_per_step / std::max(threads, 1), max_catchment_seconds_per_step);
+        }
+
+        /** @return The total time an output time step of the catchments takes, one catchment after another. */
+        double get_total_seconds_per_step() const
+        {
+            return total_seconds_per_step;
+        }
+
+        /** @return The time an output time step of the costliest catchment takes. */
+        double get_max_catchment_seconds_per_step() const
+        {
+            return max_catchment_seconds_per_step;
+        }
+
+        /**
+         * @return The memory of the formulations, in bytes, of each formulation type in the order first added;
+         *         @see utils::MemoryReport
+         */
+        std::vector<std::pair<std::string, double>> get_formulation_bytes() const
+        {
+            std::vector<std::pair<std::string, double>> type_bytes;
+            for (const TypeTotals& type : types) {
+                type_bytes.emplace_back(type.type, type.bytes);
+            }
+            return type_bytes;
+        }
+
+        /** @return The bytes exchanged with other processes, sent and received, each output time step. */
+        double get_boundary_bytes_per_step() const
+        {
+            return remote_connections * BYTES_PER_REMOTE_FLOW + neighbors.size() * BYTES_PER_NEIGHBOR;
+        }
+
+        /** @return The number of other processes flows are exchanged with. */
+        std::size_t get_neighbor_count() const
+        {
+            return neighbors.size();
+        }
+
+        /** The estimates of every process of a run, combined. */
+        struct Totals
+        {
+            int processes = 0;
+            int threads = 1;
+            long time_steps = 0;
+            /** The wall time of an output time step of the slowest process */
+            double max_seconds_per_step = 0.0;
+            /** The wall time of an output time step of each process, summed */
+            double total_seconds_per_step = 0.0;
+            /** The time of an output time step of every catchment, one after another */
+            double serial_seconds_per_step = 0.0;
+            /** The time of the costliest catchment of any process */
+            double max_catchment_seconds_per_step = 0.0;
+            double max_bytes = 0.0;
+            double max_boundary_bytes_per_step = 0.0;
+            double total_boundary_bytes_per_step = 0.0;
+        };
+
+        /**
+         * @brief Write the sizing a run needs, from the combined estimates of its processes.
+         *
+         * @param out The stream to write to.
+         * @param totals The estimates.
+         * @param memory_headroom The factor of the largest memory of a process to recommend, to allow for what the
+         *                        estimates leave out.
+         */
+        static void write_recommendation(std::ostream& out, const Totals& totals, double memory_headroom = 1.25)
+        {
+            std::ios_base::fmtflags flags = out.flags();
+            std::streamsize precision = out.precision();
+            const double mb = 1024.0 * 1024.0;
+            const int processes = std::max(totals.processes, 1);
+            const double mean_seconds = totals.total_seconds_per_step / processes;
+            out << "Estimated for " << processes << (processes > 1 ? " ranks" : " rank") << " of " << totals.threads
+                << (totals.threads > 1 ? " catchment threads" : " catchment thread") << " over " << totals.time_steps
+                << " output time steps:\n" << std::setprecision(3);
+            out << "  Compute per time step: " << totals.max_seconds_per_step << " s on the slowest rank";
+            if (processes > 1) {
+                out << ", " << mean_seconds << " s on average";
+            }
+            out << "\n  Run time: " << std::fixed << std::setprecision(2)
+                << totals.max_seconds_per_step * totals.time_steps / 3600.0
+                << " h of compute, not counting reading forcing, writing output or waiting on other ranks\n";
+            if (processes > 1) {
+                out << "  Boundary exchange per time step: " << totals.max_boundary_bytes_per_step / 1024.0
+                    << " KB on the busiest rank, " << totals.total_boundary_bytes_per_step / 1024.0 << " KB in all\n";
+            }
+            out << std::setprecision(0) << "  Memory per rank: " << totals.max_bytes / mb << " MB at most; request at least "
+                << std::ceil(totals.max_bytes * memory_headroom / mb) << " MB per rank\n";
+            out.flags(flags);
+            out.precision(precision);
+
+            // More ranks stop helping once the costliest catchment bounds the time step
+            const double serial_seconds = totals.serial_seconds_per_step;
+            if (totals.max_catchment_seconds_per_step > 0.0) {
+                long useful_ranks = static_cast<long>(std::ceil(
+                    serial_seconds / (totals.max_catchment_seconds_per_step * std::max(totals.threads, 1))));
+                out << "  Ranks: up to " << std::max(useful_ranks, 1L)
+                    << " before the costliest catchment bounds each time step\n";
+            }
+            if (processes > 1 && mean_seconds > 0.0 && totals.max_seconds_per_step / mean_seconds > 1.2) {
+                out << "  The slowest rank takes " << std::fixed << std::setprecision(2)
+                    << totals.max_seconds_per_step / mean_seconds
+                    << " times the average; repartition with the catchment costs as weights to balance them\n";
+                out.flags(flags);
+                out.precision(precision);
+            }
+        }
+
+      private:
+
+        /** The catchments of a formulation type, and their costs. */
+        struct TypeTotals
+        {
+            std::string type;
+            long catchments = 0;
+            double seconds_per_step = 0.0;
+            double bytes = 0.0;
+        };
+
+        /** @return The coefficient of the catchment's id, else of its type, else the default one. */
+        static const double* find_coefficient(const std::unordered_map<std::string, double>& values,
+                                              const std::string& id, const std::string& formulation_type)
+        {
+            auto found = values.find(id);
+            if (found == values.end()) {
+                found = values.find(formulation_type);
+            }
+            if (found == values.end()) {
+                found = values.find("default");
+            }
+            return &found->second;
+        }
+
+        std::unordered_map<std::string, double> seconds_per_step;
+        std::unordered_map<std::string, double> bytes;
+        std::vector<TypeTotals> types;
+        double total_seconds_per_step = 0.0;
+        double max_catchment_seconds_per_step = 0.0;
+        long defaulted_catchments = 0;
+        long remote_connections = 0;
+        std::set<int> neighbors;
+    };
+}
+
+#endif //NGEN_CAPACITY_ESTIMATE_HPP
@@ -0,0 +1,506 @@
+#ifndef NGEN_CHECKPOINT_HPP
+#define NGEN_CHECKPOINT_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace utils
+{
+    /**
+     * @brief Serializes saved model state into a byte buffer.
+     *
+     * Values are written in native byte order and layout, so a checkpoint can only be read back by a build for the same
+     * platform.
+     *
+     * @see StateReader
+     */
+    class StateWriter
+    {
+      public:
+
+        /** Append the bytes of a trivially copyable value. */
+        template<typename T>
+        void write(const T& value)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable values can be written");
+            write_bytes(&value, sizeof(T));
+        }
+
+        /** Append a string, preceded by its length. */
+        void write(const std::string& value)
+        {
+            write<uint64_t>(value.size());
+            write_bytes(value.data(), value.size());
+        }
+
+        /** Append a vector of trivially copyable values, preceded by its length. */
+        template<typename T>
+        void write(const std::vector<T>& values)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable values can be written");
+            write<uint64_t>(values.size());
+            write_bytes(values.data(), values.size() * sizeof(T));
+        }
+
+        /** Append raw bytes, without their length. */
+        void write_bytes(const void* data, size_t size)
+        {
+            const char* begin = static_cast<const char*>(data);
+            bytes.insert(bytes.end(), begin, begin + size);
+        }
+
+        const std::vector<char>& get_bytes() const
+        {
+            return bytes;
+        }
+
+      private:
+
+        std::vector<char> bytes;
+    };
+
+    /**
+     * @brief Reads back model state written by a @ref StateWriter, in the same order it was written.
+     *
+     * Reads past the end of the buffer throw ``std::runtime_error``, so a truncated or mismatched state is reported
+     * rather than read as garbage.
+     */
+    class StateReader
+    {
+      public:
+
+        explicit StateReader(const std::vector<char>& bytes) : bytes(bytes) {}
+
+        template<typename T>
+        T read()
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable values can be read");
+            T value;
+            read_bytes(&value, sizeof(T));
+            return value;
+        }
+
+        std::string read_string()
+        {
+            std::string value(read_size(1), '\0');
+            read_bytes(&value[0], value.size());
+            return value;
+        }
+
+        template<typename T>
+        std::vector<T> read_vector()
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable values can be read");
+            std::vector<T> values(read_size(sizeof(T)));
+            read_bytes(values.data(), values.size() * sizeof(T));
+            return values;
+        }
+
+        void read_bytes(void* data, size_t size)
+        {
+            if( size > bytes.size() - position ) {
+                throw std::runtime_error("Saved state ends before all of it was read.");
+            }
+            std::memcpy(data, bytes.data() + position, size);
+            position += size;
+        }
+
+        bool at_end() const
+        {
+            return position == bytes.size();
+        }
+
+      private:
+
+        /** Read a length prefix, checking that that many elements of @p element_size remain. */
+        size_t read_size(size_t element_size)
+        {
+            uint64_t size = read<uint64_t>();
+            if( size > (bytes.size() - position) / element_size ) {
+                throw std::runtime_error("Saved state ends before all of it was read.");
+            }
+            return static_cast<size_t>(size);
+        }
+
+        const std::vector<char>& bytes;
+        size_t position = 0;
+    };
+
+    /**
+     * @brief A checkpoint file, holding the saved state of each of a set of features at a time step boundary.
+     *
+     * Files start with a magic string and format version, followed by the index of the next time step to run and the
+     * state of each feature, keyed by feature id.  Under MPI, each rank writes and reads its own file; see
+     * @ref rank_path.
+     *
+     * A checkpoint may also be continued incrementally by a journal beside it (see @ref journal_path), to which later
+     * checkpoints append only the states that changed since; reading a checkpoint applies its journal.
+     */
+    class CheckpointFile
+    {
+      public:
+
+        /** The saved states, keyed by feature id. */
+        typedef std::map<std::string, std::vector<char>> states_t;
+
+        /**
+         * @brief Write a checkpoint file.
+         *
+         * The file is first written under a temporary name and then renamed, so an interrupted write never replaces
+         * an earlier checkpoint with a partial one.
+         *
+         * @param path The path of the file.
+         * @param next_time_step The index of the first time step a restarted run will run.
+         * @param states The saved states, keyed by feature id.
+         * @throws std::runtime_error If the file can't be written.
+         */
+        static void write(const std::string& path, long next_time_step, const states_t& states)
+        {
+            StateWriter out;
+            out.write_bytes(magic(), magic_size);
+            // Copied, as binding the constant itself to a reference would need a definition of it
+            uint32_t format_version = version;
+            out.write(format_version);
+            out.write<int64_t>(next_time_step);
+            out.write<uint64_t>(states.size());
+            for( const auto& state : states ) {
+                out.write(state.first);
+                out.write(state.second);
+            }
+
+            std::string temp_path = path + ".tmp";
+            {
+                std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+                file.write(out.get_bytes().data(), out.get_bytes().size());
+                file.close();
+                if( !file ) {
+                    throw std::runtime_error("Could not write checkpoint file " + temp_path + ".");
+                }
+            }
+            // The journal of the checkpoint replaced no longer applies; removed first, an interruption leaves the
+            // earlier checkpoint as it was before its journal, rather than the new one with the earlier journal
+            std::remove(journal_path(path).c_str());
+            if( std::rename(temp_path.c_str(), path.c_str()) != 0 ) {
+                throw std::runtime_error("Could not move checkpoint file " + temp_path + " to " + path + ".");
+            }
+        }
+
+        /**
+         * @brief Continue the checkpoint in a file with the states that changed since, as of a later time step.
+         *
+         * Each call appends a record to the checkpoint's journal, created if need be, and flushes it.  An interrupted
+         * append leaves a partial record, which @ref read ignores, so the checkpoint reads as of the last complete one.
+         *
+         * @param path The path of the checkpoint file, of which @p base_time_step is the next time step.
+         * @param base_time_step The next time step of the checkpoint file itself.
+         * @param next_time_step The index of the first time step a restarted run will run.
+         * @param changed The states that changed since the checkpoint or the journal's last record, keyed by feature id.
+         * @return The size of the journal, in bytes.
+         * @throws std::runtime_error If the journal can't be written.
+         */
+        static size_t append(const std::string& path, long base_time_step, long next_time_step, const states_t& changed)
+        {
+            std::string journal = journal_path(path);
+            StateWriter out;
+            std::ifstream existing(journal, std::ios::binary | std::ios::ate);
+            if( !existing || existing.tellg() <= 0 ) {
+                out.write_bytes(journal_magic(), magic_size);
+                uint32_t format_version = version;
+                out.write(format_version);
+                out.write<int64_t>(base_time_step);
+            }
+            existing.close();
+            StateWriter record;
+            record.write<int64_t>(next_time_step);
+            record.write<uint64_t>(changed.size());
+            for( const auto& state : changed ) {
+                record.write(state.first);
+                record.write(state.second);
+            }
+            out.write(record.get_bytes());
+
+            std::ofstream file(journal, std::ios::binary | std::ios::app);
+            file.write(out.get_bytes().data(), out.get_bytes().size());
+            file.flush();
+            size_t size = file ? static_cast<size_t>(file.tellp()) : 0;
+            file.close();
+            if( !file ) {
+                throw std::runtime_error("Could not write checkpoint journal " + journal + ".");
+            }
+            return size;
+        }
+
+        /**
+         * @brief Read a checkpoint file.
+         *
+         * @param path The path of the file.
+         * @param states Set to the saved states, keyed by feature id.
+         * @return The index of the first time step to run.
+         * @throws std::runtime_error If the file can't be read or isn't a checkpoint in this format.
+         */
+        static long read(const std::string& path, states_t& states)
+        {
+            std::ifstream file(path, std::ios::binary);
+            if( !file ) {
+                throw std::runtime_error("Could not open checkpoint file " + path + ".");
+            }
+            std::vector<char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+            StateReader in(bytes);
+            char file_magic[magic_size];
+            if( bytes.size() < magic_size + sizeof(uint32_t) ) {
+                throw std::runtime_error(path + " is not an ngen checkpoint file.");
+            }
+            in.read_bytes(file_magic, magic_size);
+            if( std::memcmp(file_magic, magic(), magic_size) != 0 ) {
+                throw std::runtime_error(path + " is not an ngen checkpoint file.");
+            }
+            uint32_t file_version = in.read<uint32_t>();
+            if( file_version != version ) {
+                throw std::runtime_error("Checkpoint file " + path + " has unsupported format version " +
+                                         std::to_string(file_version) + ".");
+            }
+            long next_time_step = static_cast<long>(in.read<int64_t>());
+            uint64_t count = in.read<uint64_t>();
+            states.clear();
+            for( uint64_t i = 0; i < count; ++i ) {
+                std::string id = in.read_string();
+                states[id] = in.read_vector<char>();
+            }
+            return read_journal(journal_path(path), next_time_step, states);
+        }
+
+        /** @return The path of the journal continuing the checkpoint file at @p path, which is @p path with ``.inc`` appended. */
+        static std::string journal_path(const std::string& path)
+        {
+            return path + ".inc";
+        }
+
+        /**
+         * @return The path of the checkpoint file of an MPI rank, which is @p path with ``.<rank>`` appended, or
+         *         @p path itself if not running with more than one rank.
+         */
+        static std::string rank_path(const std::string& path, int rank, int num_ranks)
+        {
+            return num_ranks > 1 ? path + "." + std::to_string(rank) : path;
+        }
+
+      private:
+
+        /**
+         * Apply the complete records of a checkpoint's journal, if it has one for that checkpoint, to its states.
+         *
+         * @return The next time step of the last record applied, or @p next_time_step if none was.
+         */
+        static long read_journal(const std::string& journal, long next_time_step, states_t& states)
+        {
+            std::ifstream file(journal, std::ios::binary);
+            if( !file ) {
+                return next_time_step;
+            }
+            std::vector<char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            StateReader in(bytes);
+            char file_magic[magic_size];
+            if( bytes.size() < magic_size + sizeof(uint32_t) + sizeof(int64_t) ) {
+                return next_time_step;
+            }
+            in.read_bytes(file_magic, magic_size);
+            if( std::memcmp(file_magic, journal_magic(), magic_size) != 0 ) {
+                throw std::runtime_error(journal + " is not an ngen checkpoint journal.");
+            }
+            uint32_t file_version = in.read<uint32_t>();
+            if( file_version != version ) {
+                throw std::runtime_error("Checkpoint journal " + journal + " has unsupported format version " +
+                                         std::to_string(file_version) + ".");
+            }
+            // Left over from an earlier checkpoint, if its replacement was interrupted
+            if( in.read<int64_t>() != next_time_step ) {
+                return next_time_step;
+            }
+            while( !in.at_end() ) {
+                std::vector<char> record_bytes;
+                try {
+                    record_bytes = in.read_vector<char>();
+                }
+                catch( const std::runtime_error& ) {
+                    // A record whose append was interrupted
+                    break;
+                }
+                StateReader record(record_bytes);
+                next_time_step = static_cast<long>(record.read<int64_t>());
+                uint64_t count = record.read<uint64_t>();
+                for( uint64_t i = 0; i < count; ++i ) {
+                    std::string id = record.read_string();
+                    states[id] = record.read_vector<char>();
+                }
+            }
+            return next_time_step;
+        }
+
+        /** The string every checkpoint file starts with, without its terminating null. */
+        static const char* magic()
+        {
+            return "NGENCKPT";
+        }
+
+        /** The string every checkpoint journal starts with, without its terminating null. */
+        static const char* journal_magic()
+        {
+            return "NGENCKPJ";
+        }
+
+        static constexpr size_t magic_size = 8;
+        static constexpr uint32_t version = 1;
+    };
+
+    /**
+     * @brief Writes the checkpoints of a run on a background thread, so the run only stops to save the states.
+     *
+     * Each checkpoint's states, already saved into byte buffers, are handed to a thread that writes them while the run
+     * continues; a checkpoint waits for the one before it to be written, so at most one is in flight, and any error
+     * writing it is thrown by the next @ref write or by @ref wait.
+     *
+     * Incrementally, each checkpoint after the first only appends the states whose bytes changed since the last one
+     * to the checkpoint's journal (see @ref CheckpointFile::append), which is hashed to tell; the checkpoint is
+     * written in full again once the journal grows as large as it, so restarts never read more than twice its size.
+     */
+    class CheckpointWriter
+    {
+      public:
+
+        /**
+         * @param path The path of the checkpoint file.
+         * @param is_incremental Whether checkpoints after the first only append the states that changed.
+         */
+        CheckpointWriter(std::string path, bool is_incremental) : path(std::move(path)), is_incremental(is_incremental) {}
+
+        CheckpointWriter(const CheckpointWriter&) = delete;
+        CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+        /** Wait for the checkpoint being written; call @ref wait first to see whether it was. */
+        ~CheckpointWriter()
+        {
+            if( writer.joinable() ) {
+                writer.join();
+            }
+        }
+
+        /**
+         * @brief Start writing a checkpoint, once the one before it has been written.
+         *
+         * @param next_time_step The index of the first time step a restarted run will run.
+         * @param states The saved states, keyed by feature id, which are moved from.
+         * @throws std::runtime_error If the checkpoint before couldn't be written.
+         */
+        void write(long next_time_step, CheckpointFile::states_t& states)
+        {
+            wait();
+            pending.swap(states);
+            states.clear();
+            writer = std::thread([this, next_time_step]() {
+                try {
+                    write_pending(next_time_step);
+                }
+                catch( ... ) {
+                    error = std::current_exception();
+                }
+            });
+        }
+
+        /**
+         * @brief Wait for the checkpoint being written, if any.
+         *
+         * @throws std::runtime_error If it couldn't be written.
+         */
+        void wait()
+        {
+            if( writer.joinable() ) {
+                writer.join();
+            }
+            if( error ) {
+                std::exception_ptr e = error;
+                error = nullptr;
+                std::rethrow_exception(e);
+            }
+        }
+
+      private:
+
+        void write_pending(long next_time_step)
+        {
+            std::map<std::string, uint64_t> hashes;
+            CheckpointFile::states_t changed;
+            size_t kept = 0;
+            for( const auto& state : pending ) {
+                uint64_t hash = fnv1a(state.second);
+                hashes[state.first] = hash;
+                auto written = written_hashes.find(state.first);
+                kept += written != written_hashes.end() ? 1 : 0;
+                if( written == written_hashes.end() || written->second != hash ) {
+                    changed.insert(state);
+                }
+            }
+            size_t changed_bytes = 0;
+            for( const auto& state : changed ) {
+                changed_bytes += state.first.size() + state.second.size();
+            }
+            // States are only ever replaced in the journal, so one no longer saved needs a full write to drop it
+            bool is_full = !is_incremental || base_bytes == 0 || kept != written_hashes.size()
+                           || journal_bytes + changed_bytes > base_bytes;
+            // A failed write leaves what the files hold unknown, so the next checkpoint is written in full
+            size_t written_base_bytes = base_bytes;
+            base_bytes = 0;
+            if( is_full ) {
+                CheckpointFile::write(path, next_time_step, pending);
+                base_time_step = next_time_step;
+                journal_bytes = 0;
+                written_base_bytes = 0;
+                for( const auto& state : pending ) {
+                    written_base_bytes += state.first.size() + state.second.size();
+                }
+            }
+            else {
+                journal_bytes = CheckpointFile::append(path, base_time_step, next_time_step, changed);
+            }
+            base_bytes = written_base_bytes;
+            written_hashes.swap(hashes);
+            pending.clear();
+        }
+
+        /** The 64 bit FNV-1a hash of a state. */
+        static uint64_t fnv1a(const std::vector<char>& bytes)
+        {
+            uint64_t hash = 14695981039346656037ULL;
+            for( char byte : bytes ) {
+                hash = (hash ^ static_cast<unsigned char>(byte)) * 1099511628211ULL;
+            }
+            return hash;
+        }
+
+        std::string path;
+        bool is_incremental;
+        /** The states of the checkpoint being written. */
+        CheckpointFile::states_t pending;
+        /** The hash of each state as of the last checkpoint written. */
+        std::map<std::string, uint64_t> written_hashes;
+        long base_time_step = 0;
+        /** The bytes of the states in the checkpoint file, or 0 if there is none to continue, and of its journal. */
+        size_t base_bytes = 0;
+        size_t journal_bytes = 0;
+        std::thread writer;
+        std::exception_ptr error;
+    };
+}
+
+#endif // NGEN_CHECKPOINT_HPP
@@ -0,0 +1,480 @@
+#ifndef NGEN_COMPRESSED_OUTPUT_STREAM_HPP
+#define NGEN_COMPRESSED_OUTPUT_STREAM_HPP
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#ifdef NGEN_ZLIB_ACTIVE
+#include <zlib.h>
+#endif
+#ifdef NGEN_ZSTD_ACTIVE
+#include <zstd.h>
+#endif
+
+namespace utils
+{
+    /** How a text output file is compressed. */
+    enum class Compression { none, gzip, zstd };
+
+    /**
+     * @brief Parse the name of a compression, as given in an ``output`` configuration.
+     *
+     * @param name ``none``, ``gzip`` or ``zstd``.
+     * @return The compression.
+     * @throws std::runtime_error If @p name is not one of these, or its library is not built in.
+     */
+    inline Compression parse_compression(const std::string& name)
+    {
+        if (name == "none") {
+            return Compression::none;
+        }
+        if (name == "gzip") {
+        #ifdef NGEN_ZLIB_ACTIVE
+            return Compression::gzip;
+        #else
+            throw std::runtime_error("Output compression 'gzip' requires zlib support, which is not enabled in this build.");
+        #endif
+        }
+        if (name == "zstd") {
+        #ifdef NGEN_ZSTD_ACTIVE
+            return Compression::zstd;
+        #else
+            throw std::runtime_error("Output compression 'zstd' requires zstd support, which is not enabled in this build.");
+        #endif
+        }
+        throw std::runtime_error("Unknown output compression '" + name + "'; expected none, gzip or zstd.");
+    }
+
+    /** @return The suffix added to the names of files written with a compression, e.g. ``.gz``. */
+    inline std::string compression_suffix(Compression compression)
+    {
+        switch (compression) {
+            case Compression::gzip: return ".gz";
+            case Compression::zstd: return ".zst";
+            default: return "";
+        }
+    }
+
+    /**
+     * @brief A stream buffer that compresses what is written to it into a file, in the gzip or zstd format.
+     *
+     * Text is gathered in a large buffer and compressed a buffer at a time, and the compressed bytes are written to
+     * the file as they fill a second buffer, so the file sees few, large writes however small the pieces of text.
+     * Flushing the stream (e.g. with ``std::endl``) neither compresses nor writes anything, since a compressed file
+     * is only complete once closed, and flushing line by line would defeat the buffering; everything is written once
+     * the stream is closed or destroyed.  The files are read back by ``gzip -d`` or ``zstd -d``, or e.g. by pandas
+     * from their suffix.
+     *
+     * Each open file holds its buffers and the compressor's state, some hundreds of kilobytes for gzip and a few
+     * megabytes for zstd at high levels, which adds up for outputs of a file per catchment or nexus.
+     */
+    class CompressedFileBuf : public std::streambuf
+    {
+      public:
+
+        /**
+         * @param path The path of the file to create, replacing any there.
+         * @param compression The compression; not ``none``.
+         * @param level The compression level, or a negative value for the library's default.
+         * @param buffer_bytes The size of the buffer of text; compressed bytes are gathered in a quarter of that.
+         * @throws std::runtime_error If the file can't be created, or the compression is not available.
+         */
+        CompressedFileBuf(const std::string& path, Compression compression, int level = -1,
+                          std::size_t buffer_bytes = 256 * 1024)
+            : compression(compression), text(buffer_bytes > 0 ? buffer_bytes : 1),
+              compressed(std::max<std::size_t>(buffer_bytes / 4, 4096))
+        {
+            file = std::fopen(path.c_str(), "wb");
+            if (file == nullptr) {
+                throw std::runtime_error("Unable to create compressed output file " + path);
+            }
+            if (compression == Compression::gzip) {
+            #ifdef NGEN_ZLIB_ACTIVE
+                // A window of 15 bits, plus 16 for the gzip header and trailer rather than zlib's
+                if (deflateInit2(&deflater, level < 0 ? Z_DEFAULT_COMPRESSION : level, Z_DEFLATED, 15 + 16, 8,
+                                 Z_DEFAULT_STRATEGY) != Z_OK) {
+                    std::fclose(file);
+                    throw std::runtime_error("Unable to start gzip compression of " + path);
+                }
+            #else
+                std::fclose(file);
+                throw std::runtime_error("Output compression 'gzip' requires zlib support, which is not enabled in this build.");
+            #endif
+            }
+            else if (compression == Compression::zstd) {
+            #ifdef NGEN_ZSTD_ACTIVE
+                compressor = ZSTD_createCCtx();
+                if (compressor == nullptr || ZSTD_isError(ZSTD_CCtx_setParameter(
+                        compressor, ZSTD_c_compressionLevel, level < 0 ? ZSTD_CLEVEL_DEFAULT : level))) {
+                    ZSTD_freeCCtx(compressor);
+                    std::fclose(file);
+                    throw std::runtime_error("Unable to start zstd compression of " + path);
+                }
+            #else
+                std::fclose(file);
+                throw std::runtime_error("Output compression 'zstd' requires zstd support, which is not enabled in this build.");
+            #endif
+            }
+            else {
+                std::fclose(file);
+                throw std::runtime_error("No compression given for compressed output file " + path);
+            }
+            setp(text.data(), text.data() + text.size());
+        }
+
+        CompressedFileBuf(const CompressedFileBuf&) = delete;
+        CompressedFileBuf& operator=(const CompressedFileBuf&) = delete;
+
+        ~CompressedFileBuf() override
+        {
+            try {
+                close();
+            }
+            catch (const std::exception&) {
+                // Nothing can be reported from a destructor; close explicitly to see failures
+            }
+        }
+
+        /** @return Whether the file is open, i.e., has not been closed. */
+        bool is_open() const
+        {
+            return file != nullptr;
+        }
+
+        /**
+         * @brief Compress what remains of the text, finish the compressed format and close the file.
+         *
+         * @throws std::runtime_error If compressing or writing fails.
+         */
+        void close()
+        {
+            if (file == nullptr) {
+                return;
+            }
+            bool is_complete = compress(true);
+            bool is_closed = std::fclose(file) == 0;
+            file = nullptr;
+        #ifdef NGEN_ZLIB_ACTIVE
+            if (compression == Compression::gzip) {
+                deflateEnd(&deflater);
+            }
+        #endif
+        #ifdef NGEN_ZSTD_ACTIVE
+            if (compression == Compression::zstd) {
+                ZSTD_freeCCtx(compressor);
+                compressor = nullptr;
+            }
+        #endif
+            if (!is_complete || !is_closed) {
+                throw std::runtime_error("Unable to write compressed output file");
+            }
+        }
+
+      protected:
+
+        int_type overflow(int_type ch) override
+        {
+            if (file == nullptr || !compress(false)) {
+                return traits_type::eof();
+            }
+            if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+                *pptr() = traits_type::to_char_type(ch);
+                pbump(1);
+            }
+            return traits_type::not_eof(ch);
+        }
+
+        int sync() override
+        {
+            return file != nullptr ? 0 : -1;
+        }
+
+      private:
+
+        /**
+         * @brief Compress the text in the buffer and write out the compressed bytes, leaving the buffer empty.
+         *
+         * @param is_end Whether this is the end of the text, so the compressed format is finished.
+         * @return Whether compressing and writing succeeded.
+         */
+        bool compress(bool is_end)
+        {
+            std::size_t length = pptr() - pbase();
+            setp(text.data(), text.data() + text.size());
+        #ifdef NGEN_ZLIB_ACTIVE
+            if (compression == Compression::gzip) {
+                deflater.next_in = reinterpret_cast<Bytef*>(text.data());
+                deflater.avail_in = static_cast<uInt>(length);
+                int status;
+                do {
+                    deflater.next_out = reinterpret_cast<Bytef*>(compressed.data());
+                    deflater.avail_out = static_cast<uInt>(compressed.size());
+                    status = deflate(&deflater, is_end ? Z_FINISH : Z_NO_FLUSH);
+                    if (status == Z_STREAM_ERROR || !write_compressed(compressed.size() - deflater.avail_out)) {
+                        return false;
+                    }
+                } while (deflater.avail_out == 0 || (is_end && status != Z_STREAM_END));
+                return true;
+            }
+        #endif
+        #ifdef NGEN_ZSTD_ACTIVE
+            if (compression == Compression::zstd) {
+                ZSTD_inBuffer in = {text.data(), length, 0};
+                std::size_t remaining;
+                do {
+                    ZSTD_outBuffer out = {compressed.data(), compressed.size(), 0};
+                    remaining = ZSTD_compressStream2(compressor, &out, &in, is_end ? ZSTD_e_end : ZSTD_e_continue);
+                    if (ZSTD_isError(remaining) || !write_compressed(out.pos)) {
+                        return false;
+                    }
+                } while (is_end ? remaining != 0 : in.pos < in.size);
+                return true;
+            }
+        #endif
+            return length == 0;
+        }
+
+        bool write_compressed(std::size_t length)
+        {
+            return length == 0 || std::fwrite(compressed.data(), 1, length, file) == length;
+        }
+
+        Compression compression;
+        std::FILE* file = nullptr;
+        /** The text not yet compressed, which is the stream's put area. */
+        std::vector<char> text;
+        /** The compressed bytes not yet written. */
+        std::vector<char> compressed;
+    #ifdef NGEN_ZLIB_ACTIVE
+        z_stream deflater = {};
+    #endif
+    #ifdef NGEN_ZSTD_ACTIVE
+        ZSTD_CCtx* compressor = nullptr;
+    #endif
+    };
+
+    /** An output stream writing a compressed file, through a @ref CompressedFileBuf. */
+    class CompressedOutputStream : public std::ostream
+    {
+      public:
+
+        /** @see CompressedFileBuf::CompressedFileBuf */
+        CompressedOutputStream(const std::string& path, Compression compression, int level = -1)
+            : std::ostream(nullptr), buffer(path, compression, level)
+        {
+            rdbuf(&buffer);
+        }
+
+        /** Finish the compressed file, setting the stream's ``badbit`` if that fails. */
+        void close()
+        {
+            try {
+                buffer.close();
+            }
+            catch (const std::exception&) {
+                setstate(std::ios::badbit);
+            }
+        }
+
+      private:
+        CompressedFileBuf buffer;
+    };
+
+    /**
+     * @brief A stream buffer that writes an uncompressed file through a buffer of a given size.
+     *
+     * Meant for outputs of a file per catchment or nexus, which add a short row to each of thousands of files every
+     * time step.  Each file gathers its rows in its own buffer, typically much larger than a file stream's, and only
+     * writes when it is full or the stream is flushed; text that doesn't fit is written along with what is buffered
+     * in one ``writev``, rather than copied in a piece at a time.  The buffer is only allocated by the first write,
+     * so files that are opened but never written hold none.
+     */
+    class BufferedFileBuf : public std::streambuf
+    {
+      public:
+
+        /**
+         * @param path The path of the file to create, replacing any there.
+         * @param buffer_bytes The size of the buffer.
+         */
+        BufferedFileBuf(const std::string& path, std::size_t buffer_bytes)
+            : capacity(buffer_bytes > 0 ? buffer_bytes : 1)
+        {
+            fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+        }
+
+        BufferedFileBuf(const BufferedFileBuf&) = delete;
+        BufferedFileBuf& operator=(const BufferedFileBuf&) = delete;
+
+        ~BufferedFileBuf() override
+        {
+            if (fd >= 0) {
+                write_out(nullptr, 0);
+                ::close(fd);
+            }
+        }
+
+        /** @return Whether the file was created. */
+        bool is_open() const
+        {
+            return fd >= 0;
+        }
+
+      protected:
+
+        int_type overflow(int_type ch) override
+        {
+            if (fd < 0 || (!buffer.empty() && !write_out(nullptr, 0))) {
+                return traits_type::eof();
+            }
+            if (buffer.empty()) {
+                buffer.resize(capacity);
+                setp(buffer.data(), buffer.data() + buffer.size());
+            }
+            if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+                *pptr() = traits_type::to_char_type(ch);
+                pbump(1);
+            }
+            return traits_type::not_eof(ch);
+        }
+
+        std::streamsize xsputn(const char* s, std::streamsize n) override
+        {
+            std::size_t length = static_cast<std::size_t>(n);
+            if (length <= static_cast<std::size_t>(epptr() - pptr())) {
+                std::memcpy(pptr(), s, length);
+                pbump(static_cast<int>(length));
+                return n;
+            }
+            if (buffer.empty() && length < capacity) {
+                if (overflow(traits_type::eof()) == traits_type::eof()) {
+                    return 0;
+                }
+                return xsputn(s, n);
+            }
+            return fd >= 0 && write_out(s, length) ? n : 0;
+        }
+
+        int sync() override
+        {
+            return fd >= 0 && write_out(nullptr, 0) ? 0 : -1;
+        }
+
+      private:
+
+        /**
+         * @brief Write what is buffered, followed by @p extra, leaving the buffer empty.
+         *
+         * @return Whether everything was written.
+         */
+        bool write_out(const char* extra, std::size_t extra_length)
+        {
+            iovec parts[2];
+            int count = 0;
+            if (pptr() > pbase()) {
+                parts[count++] = {pbase(), static_cast<std::size_t>(pptr() - pbase())};
+            }
+            if (extra_length > 0) {
+                parts[count++] = {const_cast<char*>(extra), extra_length};
+            }
+            setp(pbase(), epptr());
+            iovec* next = parts;
+            while (count > 0) {
+                ssize_t written = ::writev(fd, next, count);
+                if (written < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    return false;
+                }
+                // Skip what was written, which may have ended part way through either part
+                std::size_t remaining = static_cast<std::size_t>(written);
+                while (count > 0 && remaining >= next->iov_len) {
+                    remaining -= next->iov_len;
+                    ++next;
+                    --count;
+                }
+                if (count > 0) {
+                    next->iov_base = static_cast<char*>(next->iov_base) + remaining;
+                    next->iov_len -= remaining;
+                }
+            }
+            return true;
+        }
+
+        int fd = -1;
+        std::size_t capacity;
+        /** The text not yet written, which is the stream's put area once allocated. */
+        std::vector<char> buffer;
+    };
+
+    /** An output stream writing an uncompressed file, through a @ref BufferedFileBuf. */
+    class BufferedOutputStream : public std::ostream
+    {
+      public:
+
+        /** @see BufferedFileBuf::BufferedFileBuf */
+        BufferedOutputStream(const std::string& path, std::size_t buffer_bytes)
+            : std::ostream(nullptr), buffer(path, buffer_bytes)
+        {
+            rdbuf(&buffer);
+            if (!buffer.is_open()) {
+                setstate(std::ios::failbit);
+            }
+        }
+
+      private:
+        BufferedFileBuf buffer;
+    };
+
+    /**
+     * @brief The buffer size of each of a number of uncompressed output files sharing a total.
+     *
+     * @param total_bytes The bytes the files share.
+     * @param files The number of files.
+     * @return The share of each file, but at least 8 KB, the buffer of a file stream, and at most 4 MB.
+     */
+    inline std::size_t file_buffer_share(std::size_t total_bytes, std::size_t files)
+    {
+        std::size_t share = files > 0 ? total_bytes / files : total_bytes;
+        return std::min<std::size_t>(std::max<std::size_t>(share, 8 * 1024), 4 * 1024 * 1024);
+    }
+
+    /**
+     * @brief Create a text output file, compressed or not.
+     *
+     * @param path The path of the file, to which the compression's suffix (e.g. ``.gz``) is added.
+     * @param compression The compression, if any.
+     * @param level The compression level, or a negative value for the library's default.
+     * @param buffer_bytes The size of the buffer of an uncompressed file, written through a @ref BufferedFileBuf, or
+     *                     ``0`` for that of a plain file stream.
+     * @return The stream writing the file, which is finished when destroyed.
+     * @throws std::runtime_error If a compressed file can't be created.
+     */
+    inline std::shared_ptr<std::ostream> open_output_file(const std::string& path, Compression compression = Compression::none,
+                                                          int level = -1, std::size_t buffer_bytes = 0)
+    {
+        if (compression == Compression::none) {
+            if (buffer_bytes > 0) {
+                return std::make_shared<BufferedOutputStream>(path, buffer_bytes);
+            }
+            return std::make_shared<std::ofstream>(path, std::ios::trunc);
+        }
+        return std::make_shared<CompressedOutputStream>(path + compression_suffix(compression), compression, level);
+    }
+}
+
+#endif //NGEN_COMPRESSED_OUTPUT_STREAM_HPP
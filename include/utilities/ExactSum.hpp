@@ -0,0 +1,115 @@
+#ifndef NGEN_EXACT_SUM_HPP
+#define NGEN_EXACT_SUM_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace utils
+{
+    /**
+     * @brief A sum of doubles that is exact until it is rounded once, at the end, and so does not depend on the order
+     * its values are added in.
+     *
+     * The running sum is kept as a short list of non-overlapping partial sums (Shewchuk's algorithm, as in Python's
+     * ``math.fsum``), to which each value is added without error.  @ref get_sum rounds the partials to the double
+     * nearest the exact sum.  Adding a value costs a pass over the partials, which number no more than a few for
+     * values of similar magnitude, so summing the handful of flows into a nexus costs little more than an ordinary
+     * sum.
+     *
+     * Values that are not finite are summed separately, and take over the result, as they would an ordinary sum.
+     *
+     * @code {.cpp}
+     * utils::ExactSum sum;
+     * for (double flow : flows) {
+     *     sum.add(flow);
+     * }
+     * double total = sum.get_sum();
+     * @endcode
+     */
+    class ExactSum
+    {
+      public:
+
+        /** Add a value to the sum. */
+        void add(double x)
+        {
+            if (!std::isfinite(x)) {
+                special += x;
+                is_special = true;
+                return;
+            }
+            std::size_t kept = 0;
+            for (std::size_t i = 0; i < count; ++i) {
+                double y = partials[i];
+                if (std::fabs(x) < std::fabs(y)) {
+                    double t = x;
+                    x = y;
+                    y = t;
+                }
+                double hi = x + y;
+                double lo = y - (hi - x);
+                if (lo != 0.0) {
+                    partials[kept++] = lo;
+                }
+                x = hi;
+            }
+            if (kept < partials.size()) {
+                partials[kept] = x;
+            }
+            else {
+                partials.push_back(x);
+            }
+            count = kept + 1;
+        }
+
+        /** @return The double nearest the exact sum of the values added since the last @ref clear. */
+        double get_sum() const
+        {
+            if (is_special) {
+                return special;
+            }
+            std::size_t n = count;
+            if (n == 0) {
+                return 0.0;
+            }
+            double hi = partials[--n];
+            double lo = 0.0;
+            while (n > 0) {
+                double x = hi;
+                double y = partials[--n];
+                hi = x + y;
+                lo = y - (hi - x);
+                if (lo != 0.0) {
+                    break;
+                }
+            }
+            // Round half to even correctly, where the rest of the partials break the tie the last addition made
+            if (n > 0 && ((lo < 0.0 && partials[n - 1] < 0.0) || (lo > 0.0 && partials[n - 1] > 0.0))) {
+                double y = lo * 2.0;
+                double x = hi + y;
+                if (y == x - hi) {
+                    hi = x;
+                }
+            }
+            return hi;
+        }
+
+        /** Start a new sum, keeping the memory of the partials. */
+        void clear()
+        {
+            count = 0;
+            special = 0.0;
+            is_special = false;
+        }
+
+      private:
+        /** The first @ref count partials, in increasing magnitude, which sum exactly to the values added. */
+        std::vector<double> partials;
+        std::size_t count = 0;
+        double special = 0.0;
+        bool is_special = false;
+    };
+}
+
+#endif // NGEN_EXACT_SUM_HPP
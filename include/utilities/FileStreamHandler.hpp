@@ -2,17 +2,23 @@
 #define NGEN_FILE_STREAM_HANDLER_HPP
 
 #include "StreamHandler.hpp"
+#include "CompressedOutputStream.hpp"
 
 namespace utils
 {
     class FileStreamHandler : public StreamHandler
     {
       public:
-            FileStreamHandler(const char* path) : StreamHandler()
+            /**
+             * @param path The path of the file to write, to which the suffix of any @p compression is added.
+             * @param compression How the file is compressed, if at all.
+             * @param compression_level The level of @p compression, or a negative value for the library's default.
+             * @param buffer_bytes The buffer of an uncompressed file, or ``0`` for that of a file stream.
+             */
+            FileStreamHandler(const char* path, Compression compression = Compression::none,
+                              int compression_level = -1, std::size_t buffer_bytes = 0) : StreamHandler()
             {
-                auto stream = std::make_shared<std::ofstream>();
-                stream->open(path, std::ios::trunc);
-                output_stream = stream;
+                output_stream = open_output_file(path, compression, compression_level, buffer_bytes);
             }
             virtual ~FileStreamHandler(){}
     };
@@ -0,0 +1,297 @@
+#ifndef NGEN_FRAME_PUBLISHER_HPP
+#define NGEN_FRAME_PUBLISHER_HPP
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "Logger.hpp"
+
+namespace utils
+{
+    /**
+     * @brief Publishes binary frames to every process connected to a Unix domain socket, for consumers of output
+     * while it is produced.
+     *
+     * Each frame is sent as its length, a ``uint32_t`` in the host's byte order, followed by its bytes.  Every
+     * subscriber is first sent the publisher's greeting frame, describing the frames that follow (e.g. the ids of the
+     * features whose values they hold), and then each frame published after it connected, in order.
+     *
+     * Frames are sent by a background thread, so publishing never waits on subscribers.  Each subscriber has its own
+     * backlog of frames not yet sent; one that falls behind by more than the backlog limit is disconnected rather
+     * than hold up the run or grow its backlog without bound.  When the publisher is destroyed, subscribers are sent
+     * what remains of their backlogs, for up to @ref DRAIN_SECONDS, before their connections are closed.
+     */
+    class FramePublisher
+    {
+      public:
+
+        static constexpr std::size_t DEFAULT_BACKLOG_BYTES = 256 << 20;
+
+        /** How long the destructor waits for subscribers to take the rest of their frames. */
+        static constexpr int DRAIN_SECONDS = 30;
+
+        /**
+         * @param socket_path The path of the socket to listen on, replacing any socket already there.
+         * @param greeting The first frame sent to each subscriber.
+         * @param backlog_bytes The most bytes of frames a subscriber may fall behind by.
+         * @throws std::runtime_error If the socket cannot be created.
+         */
+        FramePublisher(const std::string& socket_path, std::string greeting,
+                       std::size_t backlog_bytes = DEFAULT_BACKLOG_BYTES)
+            : socket_path(socket_path), greeting(std::make_shared<const std::string>(framed(greeting))),
+              backlog_bytes(backlog_bytes)
+        {
+            sockaddr_un address;
+            if (socket_path.size() >= sizeof(address.sun_path)) {
+                throw std::runtime_error("FramePublisher: socket path " + socket_path + " is too long");
+            }
+            std::memset(&address, 0, sizeof(address));
+            address.sun_family = AF_UNIX;
+            std::strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+            ::unlink(socket_path.c_str());
+            listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+            if (listener < 0 || ::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+                || ::listen(listener, 16) != 0 || ::pipe(wake) != 0) {
+                std::string reason = std::strerror(errno);
+                if (listener >= 0) {
+                    ::close(listener);
+                }
+                throw std::runtime_error("FramePublisher: unable to listen on " + socket_path + ": " + reason);
+            }
+            set_nonblocking(listener);
+            set_nonblocking(wake[0]);
+            set_nonblocking(wake[1]);
+            io_thread = std::thread(&FramePublisher::run, this);
+        }
+
+        FramePublisher(const FramePublisher&) = delete;
+        FramePublisher& operator=(const FramePublisher&) = delete;
+
+        ~FramePublisher()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            notify();
+            io_thread.join();
+            ::close(listener);
+            ::close(wake[0]);
+            ::close(wake[1]);
+            ::unlink(socket_path.c_str());
+        }
+
+        /**
+         * @brief Publish a frame to every current subscriber.  Safe to call from any number of threads.
+         */
+        void publish(const std::string& frame)
+        {
+            std::shared_ptr<const std::string> shared = std::make_shared<const std::string>(framed(frame));
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                for (auto& subscriber : subscribers) {
+                    subscriber->frames.push_back(shared);
+                    subscriber->queued += shared->size();
+                }
+            }
+            notify();
+        }
+
+        /**
+         * @brief Wait until at least a number of subscribers have connected, e.g. so they see every frame.
+         */
+        void wait_for_subscribers(std::size_t count)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            connected.wait(lock, [this, count] { return subscribers.size() >= count; });
+        }
+
+        /** @return The number of subscribers now connected. */
+        std::size_t subscriber_count()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return subscribers.size();
+        }
+
+        const std::string& get_socket_path() const { return socket_path; }
+
+      private:
+
+        struct Subscriber
+        {
+            explicit Subscriber(int fd) : fd(fd) {}
+            int fd;
+            std::deque<std::shared_ptr<const std::string>> frames;
+            std::size_t sent = 0;       // bytes of the first frame already sent
+            std::size_t queued = 0;     // bytes of every frame not yet sent
+        };
+
+        static std::string framed(const std::string& frame)
+        {
+            if (frame.size() > UINT32_MAX) {
+                throw std::length_error("FramePublisher: frame too long");
+            }
+            std::uint32_t length = static_cast<std::uint32_t>(frame.size());
+            std::string bytes(reinterpret_cast<const char*>(&length), sizeof(length));
+            return bytes + frame;
+        }
+
+        static void set_nonblocking(int fd)
+        {
+            ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        }
+
+        void notify()
+        {
+            char byte = 0;
+            // a full pipe already holds a wake up
+            ssize_t ignored = ::write(wake[1], &byte, 1);
+            (void)ignored;
+        }
+
+        /** Send what a subscriber's socket takes of its frames; returns false if it must be disconnected. */
+        static bool send_frames(Subscriber& subscriber)
+        {
+            while (!subscriber.frames.empty()) {
+                const std::string& frame = *subscriber.frames.front();
+                ssize_t sent = ::send(subscriber.fd, frame.data() + subscriber.sent, frame.size() - subscriber.sent,
+                                      MSG_NOSIGNAL);
+                if (sent < 0) {
+                    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+                }
+                subscriber.sent += sent;
+                subscriber.queued -= sent;
+                if (subscriber.sent == frame.size()) {
+                    subscriber.frames.pop_front();
+                    subscriber.sent = 0;
+                }
+            }
+            return true;
+        }
+
+        void run()
+        {
+            auto deadline = std::chrono::steady_clock::time_point::max();
+            while (true) {
+                std::vector<pollfd> fds;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    // disconnect subscribers that fell too far behind or went away
+                    for (auto it = subscribers.begin(); it != subscribers.end();) {
+                        Subscriber& subscriber = **it;
+                        bool keep = send_frames(subscriber);
+                        if (keep && subscriber.queued > backlog_bytes) {
+                            NGEN_LOG_WARNING("FramePublisher: disconnecting a subscriber of " << socket_path
+                                             << " that fell behind by more than " << backlog_bytes << " bytes");
+                            keep = false;
+                        }
+                        if (!keep) {
+                            ::close(subscriber.fd);
+                            it = subscribers.erase(it);
+                        }
+                        else {
+                            ++it;
+                        }
+                    }
+                    bool backlogged = false;
+                    for (const auto& subscriber : subscribers) {
+                        backlogged = backlogged || !subscriber->frames.empty();
+                    }
+                    if (stopping) {
+                        if (deadline == std::chrono::steady_clock::time_point::max()) {
+                            deadline = std::chrono::steady_clock::now() + std::chrono::seconds(static_cast<long>(DRAIN_SECONDS));
+                        }
+                        if (!backlogged || std::chrono::steady_clock::now() >= deadline) {
+                            for (auto& subscriber : subscribers) {
+                                ::close(subscriber->fd);
+                            }
+                            subscribers.clear();
+                            return;
+                        }
+                    }
+                    fds.push_back({wake[0], POLLIN, 0});
+                    fds.push_back({listener, POLLIN, 0});
+                    for (const auto& subscriber : subscribers) {
+                        fds.push_back({subscriber->fd, static_cast<short>(subscriber->frames.empty() ? 0 : POLLOUT), 0});
+                    }
+                }
+
+                ::poll(fds.data(), fds.size(), stopping_now() ? 100 : -1);
+
+                if (fds[0].revents & POLLIN) {
+                    char bytes[256];
+                    while (::read(wake[0], bytes, sizeof(bytes)) > 0) {
+                    }
+                }
+                // a subscriber that hung up is reported even with nothing to send it
+                std::vector<int> hung_up;
+                for (std::size_t i = 2; i < fds.size(); ++i) {
+                    if (fds[i].revents & (POLLHUP | POLLERR | POLLNVAL)) {
+                        hung_up.push_back(fds[i].fd);
+                    }
+                }
+                if (!hung_up.empty()) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    for (auto it = subscribers.begin(); it != subscribers.end();) {
+                        if (std::find(hung_up.begin(), hung_up.end(), (*it)->fd) != hung_up.end()) {
+                            ::close((*it)->fd);
+                            it = subscribers.erase(it);
+                        }
+                        else {
+                            ++it;
+                        }
+                    }
+                }
+                if (fds[1].revents & POLLIN) {
+                    int fd;
+                    while ((fd = ::accept(listener, nullptr, nullptr)) >= 0) {
+                        set_nonblocking(fd);
+                        std::unique_ptr<Subscriber> subscriber(new Subscriber(fd));
+                        subscriber->frames.push_back(greeting);
+                        subscriber->queued = greeting->size();
+                        std::lock_guard<std::mutex> lock(mutex);
+                        subscribers.push_back(std::move(subscriber));
+                    }
+                    connected.notify_all();
+                }
+            }
+        }
+
+        bool stopping_now()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return stopping;
+        }
+
+        std::string socket_path;
+        std::shared_ptr<const std::string> greeting;
+        std::size_t backlog_bytes;
+        int listener = -1;
+        int wake[2] = {-1, -1};
+        std::vector<std::unique_ptr<Subscriber>> subscribers;
+        bool stopping = false;
+        std::mutex mutex;
+        std::condition_variable connected;
+        std::thread io_thread;
+    };
+}
+
+#endif //NGEN_FRAME_PUBLISHER_HPP
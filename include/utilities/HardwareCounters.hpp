@@ -0,0 +1,167 @@
+#ifndef NGEN_HARDWARE_COUNTERS_HPP
+#define NGEN_HARDWARE_COUNTERS_HPP
+
+#include <cstdint>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace utils
+{
+    /**
+     * @brief Reads the CPU's hardware performance counters for the calling thread, through Linux ``perf_event``.
+     *
+     * Each thread that reads counters opens its own group of them the first time it does, counting only its own user
+     * space execution, on whichever CPU it runs; the group is read with one system call, and the difference of two
+     * reads is what the thread executed between them.  Opening fails where the kernel doesn't allow it (e.g. a
+     * ``kernel.perf_event_paranoid`` above ``2``), in most containers and virtual machines without a virtual PMU, and
+     * on other platforms than Linux, in which case nothing is counted and @ref read returns ``false``.
+     *
+     * Only the kernel's generic events are counted, which name the same thing on every CPU; vector instruction counts,
+     * for example, are model specific raw events, so are not.  Should the CPU have too few counters for the group at
+     * once, the kernel takes turns with them, and counts are scaled up from the time the group was counting.
+     *
+     * @code {.cpp}
+     * utils::HardwareCounters::Values before, after;
+     * if (utils::HardwareCounters::read(before)) {
+     *     kernel();
+     *     utils::HardwareCounters::read(after);
+     *     uint64_t instructions = after.counts[utils::HardwareCounters::INSTRUCTIONS]
+     *                             - before.counts[utils::HardwareCounters::INSTRUCTIONS];
+     * }
+     * @endcode
+     */
+    class HardwareCounters
+    {
+      public:
+
+        /** The events counted, in the order of @ref Values. */
+        enum Counter { CYCLES, INSTRUCTIONS, CACHE_REFERENCES, CACHE_MISSES, BRANCH_MISSES, COUNTER_COUNT };
+
+        /** A count of each event, by @ref Counter; left uninitialized unless value initialized, e.g. ``Values{}``. */
+        struct Values
+        {
+            uint64_t counts[COUNTER_COUNT];
+        };
+
+        /** @return The name of an event, as in the profile's outputs. */
+        static const char* name(Counter counter)
+        {
+            static const char* const names[COUNTER_COUNT] = {
+                "cycles", "instructions", "cache_references", "cache_misses", "branch_misses"
+            };
+            return names[counter];
+        }
+
+        /**
+         * @brief Read the counts of the calling thread, since its counters were opened.
+         *
+         * @param values Set to the counts, or left as they were if the thread has no counters.
+         * @return Whether the thread has counters.
+         */
+        static bool read(Values& values)
+        {
+            #ifdef __linux__
+            ThreadCounters& counters = thread_counters();
+            if (counters.leader < 0) {
+                return false;
+            }
+            struct {
+                uint64_t count;
+                uint64_t time_enabled;
+                uint64_t time_running;
+                uint64_t values[COUNTER_COUNT];
+            } group;
+            if (::read(counters.leader, &group, sizeof(group)) != static_cast<ssize_t>(sizeof(group))
+                || group.count != COUNTER_COUNT) {
+                return false;
+            }
+            for (int i = 0; i < COUNTER_COUNT; ++i) {
+                values.counts[i] = group.values[i];
+                if (group.time_running > 0 && group.time_running < group.time_enabled) {
+                    values.counts[i] = static_cast<uint64_t>(
+                        static_cast<double>(group.values[i]) * group.time_enabled / group.time_running);
+                }
+            }
+            return true;
+            #else
+            return false;
+            #endif
+        }
+
+        /** @return Whether the calling thread can read counters, opening them if it has not yet. */
+        static bool is_available()
+        {
+            Values values;
+            return read(values);
+        }
+
+      private:
+
+        #ifdef __linux__
+        /** The group of counters of one thread, closed as the thread ends. */
+        struct ThreadCounters
+        {
+            int leader = -1;
+            int descriptors[COUNTER_COUNT];
+
+            ThreadCounters()
+            {
+                static const uint64_t configs[COUNTER_COUNT] = {
+                    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_REFERENCES,
+                    PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+                };
+                for (int i = 0; i < COUNTER_COUNT; ++i) {
+                    descriptors[i] = -1;
+                }
+                for (int i = 0; i < COUNTER_COUNT; ++i) {
+                    perf_event_attr attr;
+                    std::memset(&attr, 0, sizeof(attr));
+                    attr.size = sizeof(attr);
+                    attr.type = PERF_TYPE_HARDWARE;
+                    attr.config = configs[i];
+                    attr.exclude_kernel = 1;
+                    attr.exclude_hv = 1;
+                    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+                    // This thread, on any CPU, in the group of the first counter
+                    descriptors[i] = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1,
+                                                              i == 0 ? -1 : descriptors[0], 0));
+                    if (descriptors[i] < 0) {
+                        close_all();
+                        return;
+                    }
+                }
+                leader = descriptors[0];
+            }
+
+            ~ThreadCounters()
+            {
+                close_all();
+            }
+
+            void close_all()
+            {
+                for (int i = 0; i < COUNTER_COUNT; ++i) {
+                    if (descriptors[i] >= 0) {
+                        close(descriptors[i]);
+                        descriptors[i] = -1;
+                    }
+                }
+                leader = -1;
+            }
+        };
+
+        static ThreadCounters& thread_counters()
+        {
+            thread_local ThreadCounters counters;
+            return counters;
+        }
+        #endif // __linux__
+    };
+}
+
+#endif //NGEN_HARDWARE_COUNTERS_HPP
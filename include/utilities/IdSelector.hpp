@@ -0,0 +1,100 @@
+#ifndef NGEN_ID_SELECTOR_HPP
+#define NGEN_ID_SELECTOR_HPP
+
+#include <fnmatch.h>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace utils
+{
+    /**
+     * @brief Selects feature ids by a list of exact ids and shell wildcard patterns, e.g. the catchments and nexuses
+     * whose output is written.
+     *
+     * Entries with any of ``*``, ``?`` or ``[`` are patterns, matched as ``fnmatch`` does (e.g. ``cat-1*``); every
+     * other entry is an exact id, looked up in a hash set, so selections of many thousands of ids are cheap to test.
+     * An empty selection selects every id.
+     *
+     * @code {.cpp}
+     * utils::IdSelector selector({"nex-26", "nex-3?", "wb-*"});
+     * selector.matches("nex-31"); // true
+     * @endcode
+     */
+    class IdSelector
+    {
+      public:
+
+        /** A selector of every id. */
+        IdSelector() = default;
+
+        /** @param entries The ids and patterns to select; empty selects every id. */
+        explicit IdSelector(const std::vector<std::string>& entries)
+        {
+            for (const std::string& entry : entries) {
+                if (entry.find_first_of("*?[") != std::string::npos) {
+                    patterns.push_back(entry);
+                }
+                else {
+                    ids.insert(entry);
+                }
+            }
+        }
+
+        /** @return Whether every id is selected. */
+        bool is_all() const
+        {
+            return ids.empty() && patterns.empty();
+        }
+
+        /** @return Whether @p id is selected. */
+        bool matches(const std::string& id) const
+        {
+            if (is_all() || ids.count(id) > 0) {
+                return true;
+            }
+            for (const std::string& pattern : patterns) {
+                if (fnmatch(pattern.c_str(), id.c_str(), 0) == 0) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /**
+         * @brief Read the entries of a selection from a text file, one id or pattern per line.
+         *
+         * Leading and trailing whitespace is ignored, as are blank lines and lines starting with ``#``.
+         *
+         * @param path The path of the file.
+         * @return The entries.
+         * @throws std::runtime_error If the file can't be read.
+         */
+        static std::vector<std::string> read_entries(const std::string& path)
+        {
+            std::ifstream input(path);
+            if (!input) {
+                throw std::runtime_error("Unable to read the id selection file " + path);
+            }
+            std::vector<std::string> entries;
+            std::string line;
+            while (std::getline(input, line)) {
+                std::size_t begin = line.find_first_not_of(" \t\r");
+                if (begin == std::string::npos || line[begin] == '#') {
+                    continue;
+                }
+                std::size_t end = line.find_last_not_of(" \t\r");
+                entries.push_back(line.substr(begin, end - begin + 1));
+            }
+            return entries;
+        }
+
+      private:
+        std::unordered_set<std::string> ids;
+        std::vector<std::string> patterns;
+    };
+}
+
+#endif //NGEN_ID_SELECTOR_HPP
@@ -0,0 +1,269 @@
+#ifndef NGEN_JSON_MEMBER_FILTER_HPP
+#define NGEN_JSON_MEMBER_FILTER_HPP
+
+#include <cctype>
+#include <functional>
+#include <istream>
+#include <iterator>
+#include <string>
+#include <utility>
+
+namespace utils
+{
+    /**
+     * @brief Copies the text of a JSON object, dropping the unwanted members of one of its object members.
+     *
+     * This is meant for reading just the needed part of a large document, e.g. the entries of a realization config's
+     * ``catchments`` object for the catchments of one partition.  The text is scanned in a single pass as it is read
+     * from the stream, without building any document, so only the kept text is ever held in memory.  The kept text is
+     * copied verbatim, so it can then be parsed as usual.
+     *
+     * The scan only checks the structure it needs to; a malformed document may be reported as such or copied as is,
+     * and will then fail to parse.
+     *
+     * @code {.cpp}
+     * std::ifstream in("realization.json");
+     * std::string kept;
+     * utils::JsonMemberFilter filter("catchments", [&](const std::string& id) { return local_ids.count(id) > 0; });
+     * if( filter.filter(in, kept) ) {
+     *     std::stringstream data(kept);
+     *     boost::property_tree::json_parser::read_json(data, tree);
+     * }
+     * @endcode
+     */
+    class JsonMemberFilter
+    {
+      public:
+
+        /**
+         * @param object_key The key, within the top level object, of the object whose members are filtered.
+         * @param keep Whether to keep the member with the given key.  Keys are passed as they appear in the text,
+         *             without unescaping.
+         */
+        JsonMemberFilter(std::string object_key, std::function<bool(const std::string&)> keep)
+            : object_key(std::move(object_key)), keep(std::move(keep))
+        {}
+
+        /**
+         * @brief Copy the JSON object read from @p in to @p out, less the unwanted members of the filtered object.
+         *
+         * @param in The stream to read the JSON text of an object from.
+         * @param out Set to the kept text.
+         * @return Whether the text was an object that could be filtered; if not, @p out is unspecified.
+         */
+        bool filter(std::istream& in, std::string& out) const
+        {
+            Scanner scan(in);
+            out.clear();
+            scan.skip_ws(&out);
+            if( scan.peek() != '{' ) {
+                return false;
+            }
+            out.push_back(scan.next());
+            while( true ) {
+                scan.skip_ws(&out);
+                if( scan.peek() == '}' ) {
+                    out.push_back(scan.next());
+                    return true;
+                }
+                std::string key;
+                if( !scan.copy_string(&out, &key) || !scan.copy_colon(&out) ) {
+                    return false;
+                }
+                bool copied = key == object_key && scan.peek() == '{'
+                    ? filter_members(scan, out)
+                    : scan.copy_value(&out);
+                if( !copied ) {
+                    return false;
+                }
+                scan.skip_ws(&out);
+                char c = scan.next();
+                out.push_back(c);
+                if( c == '}' ) {
+                    return true;
+                }
+                if( c != ',' ) {
+                    return false;
+                }
+            }
+        }
+
+      private:
+
+        /**
+         * @brief Reads JSON text from a stream one character at a time, copying it where requested.
+         */
+        class Scanner
+        {
+          public:
+
+            explicit Scanner(std::istream& in) : it(in) {}
+
+            /** @return The next character, or ``'\0'`` at the end of the stream. */
+            char peek() const
+            {
+                return it == end ? '\0' : *it;
+            }
+
+            /** @return The next character, which is consumed, or ``'\0'`` at the end of the stream. */
+            char next()
+            {
+                if( it == end ) {
+                    return '\0';
+                }
+                char c = *it;
+                ++it;
+                return c;
+            }
+
+            /** Skip whitespace, appending it to @p out unless null. */
+            void skip_ws(std::string* out)
+            {
+                while( it != end && std::isspace(static_cast<unsigned char>(*it)) ) {
+                    char c = next();
+                    if( out != nullptr ) {
+                        out->push_back(c);
+                    }
+                }
+            }
+
+            /**
+             * Read a string, appending its text to @p out unless null.
+             *
+             * @param out The text to append to, or null.
+             * @param content Set to the characters between the quotes, unless null.
+             * @return Whether a whole string was read.
+             */
+            bool copy_string(std::string* out, std::string* content)
+            {
+                if( peek() != '"' ) {
+                    return false;
+                }
+                append(out, next());
+                while( it != end ) {
+                    char c = next();
+                    append(out, c);
+                    if( c == '"' ) {
+                        return true;
+                    }
+                    if( content != nullptr ) {
+                        content->push_back(c);
+                    }
+                    if( c == '\\' ) {
+                        c = next();
+                        append(out, c);
+                        if( content != nullptr ) {
+                            content->push_back(c);
+                        }
+                    }
+                }
+                return false;
+            }
+
+            /** Read the ``:`` after a member key and any whitespace around it, appending them to @p out unless null. */
+            bool copy_colon(std::string* out)
+            {
+                skip_ws(out);
+                if( peek() != ':' ) {
+                    return false;
+                }
+                append(out, next());
+                skip_ws(out);
+                return true;
+            }
+
+            /** Read a whole value, appending its text to @p out unless null. */
+            bool copy_value(std::string* out)
+            {
+                char c = peek();
+                if( c == '"' ) {
+                    return copy_string(out, nullptr);
+                }
+                if( c != '{' && c != '[' ) {
+                    // A number or literal, which runs up to the next delimiter
+                    bool any = false;
+                    while( it != end && !std::isspace(static_cast<unsigned char>(*it))
+                           && *it != ',' && *it != '}' && *it != ']' ) {
+                        append(out, next());
+                        any = true;
+                    }
+                    return any;
+                }
+                size_t depth = 0;
+                while( it != end ) {
+                    if( peek() == '"' ) {
+                        if( !copy_string(out, nullptr) ) {
+                            return false;
+                        }
+                        continue;
+                    }
+                    c = next();
+                    append(out, c);
+                    if( c == '{' || c == '[' ) {
+                        ++depth;
+                    }
+                    else if( (c == '}' || c == ']') && --depth == 0 ) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+          private:
+
+            static void append(std::string* out, char c)
+            {
+                if( out != nullptr ) {
+                    out->push_back(c);
+                }
+            }
+
+            std::istreambuf_iterator<char> it;
+            std::istreambuf_iterator<char> end;
+        };
+
+        /** Copy the filtered object, whose ``{`` is next, keeping only the wanted members. */
+        bool filter_members(Scanner& scan, std::string& out) const
+        {
+            out.push_back(scan.next());
+            bool any_kept = false;
+            while( true ) {
+                scan.skip_ws(nullptr);
+                if( scan.peek() == '}' ) {
+                    out.push_back(scan.next());
+                    return true;
+                }
+                std::string member;
+                std::string key;
+                if( !scan.copy_string(&member, &key) || !scan.copy_colon(&member) ) {
+                    return false;
+                }
+                bool kept = keep(key);
+                if( !scan.copy_value(kept ? &member : nullptr) ) {
+                    return false;
+                }
+                if( kept ) {
+                    if( any_kept ) {
+                        out.push_back(',');
+                    }
+                    out += member;
+                    any_kept = true;
+                }
+                scan.skip_ws(nullptr);
+                char c = scan.next();
+                if( c == '}' ) {
+                    out.push_back(c);
+                    return true;
+                }
+                if( c != ',' ) {
+                    return false;
+                }
+            }
+        }
+
+        std::string object_key;
+        std::function<bool(const std::string&)> keep;
+    };
+}
+
+#endif // NGEN_JSON_MEMBER_FILTER_HPP
@@ -0,0 +1,283 @@
+#ifndef NGEN_LOGGER_HPP
+#define NGEN_LOGGER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "AsyncOutputWriter.hpp"
+
+/**
+ * The least severe level of log messages compiled in; messages of less severe levels (see utils::LogLevel) are
+ * removed by the compiler, arguments and all.  Set by the ``NGEN_LOG_LEVEL`` CMake option.
+ */
+#ifndef NGEN_LOG_MIN_LEVEL
+#define NGEN_LOG_MIN_LEVEL 1
+#endif
+
+namespace utils
+{
+    /** The severity of a log message. */
+    enum LogLevel {
+        LOG_LEVEL_DEBUG = 0,
+        LOG_LEVEL_INFO = 1,
+        LOG_LEVEL_WARNING = 2,
+        LOG_LEVEL_ERROR = 3
+    };
+
+    /**
+     * @brief Writes the framework's diagnostic messages from a background thread, so that warnings raised while
+     * computing (e.g., by a forcing provider on each time step) do not hold up the computation on writes to stderr.
+     *
+     * Messages are logged through the @ref NGEN_LOG_WARNING (etc.) macros, which:
+     *  - compile to nothing for levels below @ref NGEN_LOG_MIN_LEVEL, and otherwise cost a relaxed atomic load when
+     *    below the level set with @ref set_level;
+     *  - log at most @ref set_site_limit messages from each call site, so a warning repeated every time step by every
+     *    catchment costs an atomic increment, without formatting its message, once the limit is reached; how many
+     *    were left out is written on @ref flush;
+     *  - format the message on the calling thread, then queue it to a utils::AsyncOutputWriter, dropping it if the
+     *    queue is full rather than waiting.
+     *
+     * By default, messages are written to ``std::cerr``, prefixed with their level.  Messages of any one thread are
+     * written in the order it logged them.  Everything queued is written when the program exits, or earlier by
+     * @ref flush.
+     *
+     * @code {.cpp}
+     * NGEN_LOG_WARNING("Unit conversion unsuccessful - Returning unconverted value! (\"" << e.what() << "\")");
+     * @endcode
+     */
+    class Logger
+    {
+      public:
+
+        /** A queued message. */
+        struct Record
+        {
+            LogLevel level = LOG_LEVEL_INFO;
+            std::string message;
+        };
+
+        /** Writes a message; called on the background thread only. */
+        typedef std::function<void(LogLevel, const std::string&)> sink_t;
+
+        /** The messages logged from one call site; see @ref NGEN_LOG. */
+        struct Site
+        {
+            Site(const char* file, int line) : file(file), line(line)
+            {
+                State& s = state();
+                std::lock_guard<std::mutex> lock(s.sites_mutex);
+                s.sites.push_back(this);
+            }
+
+            const char* file;
+            int line;
+            std::atomic<std::size_t> count{0};
+            /** How many messages were counted when those left out were last reported by @ref flush. */
+            std::size_t reported = 0;
+        };
+
+        /** @return Whether messages of a level are logged. */
+        static bool is_enabled(LogLevel level)
+        {
+            return level >= NGEN_LOG_MIN_LEVEL && level >= state().level.load(std::memory_order_relaxed);
+        }
+
+        /** Set the least severe level of messages logged; defaults to @ref LOG_LEVEL_INFO. */
+        static void set_level(LogLevel level)
+        {
+            state().level.store(level, std::memory_order_relaxed);
+        }
+
+        /** Set the most messages logged from each call site, or @c 0 for no limit; defaults to 10. */
+        static void set_site_limit(std::size_t limit)
+        {
+            state().site_limit.store(limit, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Set where messages are written, or restore the default (``std::cerr``) with a null sink.
+         *
+         * Messages already queued may be written to either.
+         */
+        static void set_sink(sink_t sink)
+        {
+            State& s = state();
+            std::lock_guard<std::mutex> lock(s.sink_mutex);
+            s.sink = sink ? std::move(sink) : sink_t(&write_to_stderr);
+        }
+
+        /**
+         * @brief Count a message of a call site, and get whether it is within the site's limit.
+         *
+         * The first message past the limit is let through with a note that later ones are left out.
+         */
+        static bool admit(Site& site, std::string& note)
+        {
+            State& s = state();
+            std::size_t count = site.count.fetch_add(1, std::memory_order_relaxed);
+            std::size_t limit = s.site_limit.load(std::memory_order_relaxed);
+            if (limit == 0 || count < limit) {
+                return true;
+            }
+            if (count == limit) {
+                std::lock_guard<std::mutex> lock(s.sites_mutex);
+                s.limited_sites.push_back(&site);
+                site.reported = limit + 1;
+                note = " (further messages from " + std::string(site.file) + ":" + std::to_string(site.line)
+                       + " are left out)";
+                return true;
+            }
+            return false;
+        }
+
+        /**
+         * @brief Queue a message to be written; dropped (and counted, see @ref get_dropped_count) if the queue is full.
+         *
+         * Safe to call from any number of threads.
+         */
+        static void log(LogLevel level, std::string message)
+        {
+            Record record;
+            record.level = level;
+            record.message = std::move(message);
+            if (!state().get_writer().try_push(record)) {
+                state().dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        /**
+         * @brief Wait until everything logged before the call has been written, after logging how many messages of
+         * each limited call site were left out since the last flush.
+         */
+        static void flush()
+        {
+            State& s = state();
+            {
+                std::lock_guard<std::mutex> lock(s.sites_mutex);
+                for (Site* site : s.limited_sites) {
+                    std::size_t count = site->count.load(std::memory_order_relaxed);
+                    if (count > site->reported) {
+                        log(LOG_LEVEL_INFO, std::to_string(count - site->reported) + " messages from "
+                                            + site->file + ":" + std::to_string(site->line) + " were left out");
+                        site->reported = count;
+                    }
+                }
+            }
+            std::lock_guard<std::mutex> lock(s.writer_mutex);
+            if (s.writer != nullptr) {
+                s.writer->flush();
+            }
+        }
+
+        /**
+         * @brief Forget the messages counted from every call site, and those dropped, so each site may log up to its
+         * limit again; for tests, after a @ref flush.
+         */
+        static void reset_counts()
+        {
+            State& s = state();
+            std::lock_guard<std::mutex> lock(s.sites_mutex);
+            for (Site* site : s.sites) {
+                site->count.store(0, std::memory_order_relaxed);
+                site->reported = 0;
+            }
+            s.limited_sites.clear();
+            s.dropped.store(0, std::memory_order_relaxed);
+        }
+
+        /** @return The number of messages dropped because the queue was full. */
+        static std::size_t get_dropped_count()
+        {
+            return state().dropped.load(std::memory_order_relaxed);
+        }
+
+        /** @return The prefix of messages of a level, as written by the default sink. */
+        static const char* get_prefix(LogLevel level)
+        {
+            switch (level) {
+                case LOG_LEVEL_DEBUG: return "DEBUG: ";
+                case LOG_LEVEL_INFO: return "INFO: ";
+                case LOG_LEVEL_WARNING: return "WARN: ";
+                default: return "ERROR: ";
+            }
+        }
+
+      private:
+
+        struct State
+        {
+            std::atomic<int> level{LOG_LEVEL_INFO};
+            std::atomic<std::size_t> site_limit{10};
+            std::atomic<std::size_t> dropped{0};
+            std::mutex sink_mutex;
+            sink_t sink{&write_to_stderr};
+            std::mutex sites_mutex;
+            /** Every call site that logged, and those that reached the limit. */
+            std::vector<Site*> sites;
+            std::vector<Site*> limited_sites;
+            std::mutex writer_mutex;
+            /** Started by the first message, so runs logging nothing have no background thread. */
+            std::unique_ptr<AsyncOutputWriter<Record>> writer;
+            std::atomic<AsyncOutputWriter<Record>*> started_writer{nullptr};
+
+            AsyncOutputWriter<Record>& get_writer()
+            {
+                AsyncOutputWriter<Record>* w = started_writer.load(std::memory_order_acquire);
+                if (w == nullptr) {
+                    std::lock_guard<std::mutex> lock(writer_mutex);
+                    if (writer == nullptr) {
+                        writer.reset(new AsyncOutputWriter<Record>(1 << 12, [this](Record& record) {
+                            std::lock_guard<std::mutex> sink_lock(sink_mutex);
+                            sink(record.level, record.message);
+                        }));
+                        started_writer.store(writer.get(), std::memory_order_release);
+                    }
+                    w = writer.get();
+                }
+                return *w;
+            }
+        };
+
+        static State& state()
+        {
+            static State s;
+            return s;
+        }
+
+        static void write_to_stderr(LogLevel level, const std::string& message)
+        {
+            std::cerr << get_prefix(level) << message << '\n';
+        }
+    };
+}
+
+/**
+ * Log a message of the given level, formatted from its stream insertions (e.g., ``"value " << value``), unless the
+ * level is filtered out or the call site has reached its limit; see utils::Logger.
+ */
+#define NGEN_LOG(level, message) \
+    do { \
+        if (utils::Logger::is_enabled(level)) { \
+            static utils::Logger::Site ngen_log_site(__FILE__, __LINE__); \
+            std::string ngen_log_note; \
+            if (utils::Logger::admit(ngen_log_site, ngen_log_note)) { \
+                std::ostringstream ngen_log_stream; \
+                ngen_log_stream << message << ngen_log_note; \
+                utils::Logger::log(level, ngen_log_stream.str()); \
+            } \
+        } \
+    } while (false)
+
+#define NGEN_LOG_DEBUG(message) NGEN_LOG(utils::LOG_LEVEL_DEBUG, message)
+#define NGEN_LOG_INFO(message) NGEN_LOG(utils::LOG_LEVEL_INFO, message)
+#define NGEN_LOG_WARNING(message) NGEN_LOG(utils::LOG_LEVEL_WARNING, message)
+#define NGEN_LOG_ERROR(message) NGEN_LOG(utils::LOG_LEVEL_ERROR, message)
+
+#endif // NGEN_LOGGER_HPP
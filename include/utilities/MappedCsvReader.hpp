@@ -0,0 +1,305 @@
+#ifndef NGEN_MAPPED_CSV_READER_HPP
+#define NGEN_MAPPED_CSV_READER_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace utils
+{
+    /**
+     * @brief Reads the rows of a delimited text file in place, from a read only memory mapping of the file.
+     *
+     * Fields are handed out as ranges of the mapped bytes, with surrounding whitespace (including the ``\r`` of
+     * CRLF line endings) trimmed, so no per row or per field strings are allocated.  Blank lines are skipped.
+     * Quoted fields are not supported.
+     *
+     * @code {.cpp}
+     * utils::MappedCsvReader reader("forcing.csv");
+     * std::vector<utils::MappedCsvReader::Field> row;
+     * while( reader.next_row(row) ) {
+     *     double value = utils::MappedCsvReader::parse_double(row[1]);
+     * }
+     * @endcode
+     */
+    class MappedCsvReader
+    {
+      public:
+
+        /**
+         * @brief A field of a row, as a range of the mapped file.
+         */
+        struct Field
+        {
+            const char* begin;
+            const char* end;
+
+            std::string str() const { return std::string(begin, end); }
+
+            bool operator==(const char* other) const
+            {
+                const char* c = begin;
+                for( ; c != end && *other != '\0'; ++c, ++other ) {
+                    if( *c != *other ) return false;
+                }
+                return c == end && *other == '\0';
+            }
+        };
+
+        /**
+         * @param file_name The file to read.
+         * @param delimiter The character separating the fields of a row.
+         * @throws std::runtime_error If the file cannot be opened or mapped.
+         */
+        explicit MappedCsvReader(const std::string& file_name, char delimiter = ',') : delimiter(delimiter)
+        {
+            int fd = ::open(file_name.c_str(), O_RDONLY);
+            if( fd < 0 ) {
+                throw std::runtime_error("Error: Input file " + file_name + " does not exist.");
+            }
+            struct stat st;
+            if( ::fstat(fd, &st) != 0 ) {
+                ::close(fd);
+                throw std::runtime_error("Error: Unable to read the size of input file " + file_name + ".");
+            }
+            size = static_cast<std::size_t>(st.st_size);
+            if( size > 0 ) {
+                void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if( mapped == MAP_FAILED ) {
+                    ::close(fd);
+                    throw std::runtime_error("Error: Unable to map input file " + file_name + " into memory.");
+                }
+                ::madvise(mapped, size, MADV_SEQUENTIAL);
+                data = static_cast<const char*>(mapped);
+            }
+            ::close(fd);
+            position = data;
+        }
+
+        MappedCsvReader(const MappedCsvReader&) = delete;
+        MappedCsvReader& operator=(const MappedCsvReader&) = delete;
+
+        ~MappedCsvReader()
+        {
+            if( data != nullptr ) {
+                ::munmap(const_cast<char*>(data), size);
+            }
+        }
+
+        /**
+         * @brief Read the fields of the next non-blank row.
+         *
+         * @param fields Set to the fields of the row; its capacity is reused between rows.
+         * @return Whether there was another row.
+         */
+        bool next_row(std::vector<Field>& fields)
+        {
+            const char* file_end = data + size;
+            fields.clear();
+            while( position != nullptr && position < file_end ) {
+                const char* line_end = position;
+                while( line_end != file_end && *line_end != '\n' ) ++line_end;
+
+                const char* field_begin = position;
+                for( const char* c = position; ; ++c ) {
+                    if( c == line_end || *c == delimiter ) {
+                        fields.push_back(trimmed(field_begin, c));
+                        if( c == line_end ) break;
+                        field_begin = c + 1;
+                    }
+                }
+                position = line_end == file_end ? file_end : line_end + 1;
+
+                if( fields.size() > 1 || fields[0].begin != fields[0].end ) {
+                    return true;
+                }
+                fields.clear();
+            }
+            return false;
+        }
+
+        /**
+         * @brief Release the memory of the whole pages of the mapping before the next row, which were already read.
+         *
+         * Fields of rows already read may still be used, as their pages are read from the file again if needed, but
+         * a reader kept open through a long file then only has the pages around the rows being read in memory.
+         */
+        void release_read()
+        {
+            static const std::size_t page_size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+            const std::size_t read_bytes = (position - data) / page_size * page_size;
+            if( read_bytes > 0 ) {
+                ::madvise(const_cast<char*>(data), read_bytes, MADV_DONTNEED);
+            }
+        }
+
+        /**
+         * @brief Parse a floating point number filling a whole field.
+         *
+         * Plain decimal numbers whose digits fit in the 53 bit significand of a double, with a power of ten of at most
+         * 22, are converted directly, which gives the same, correctly rounded, result as @c strtod; anything else is
+         * handed to @c strtod.
+         *
+         * @throws std::invalid_argument If the field is not a number.
+         */
+        static double parse_double(const Field& field)
+        {
+            const char* c = field.begin;
+            bool negative = false;
+            if( c != field.end && (*c == '-' || *c == '+') ) {
+                negative = *c == '-';
+                ++c;
+            }
+            std::uint64_t mantissa = 0;
+            int digits = 0;
+            int exponent = 0;
+            bool any_digits = false;
+            for( ; c != field.end && *c >= '0' && *c <= '9'; ++c ) {
+                any_digits = true;
+                if( mantissa != 0 || *c != '0' ) {
+                    mantissa = mantissa * 10 + (*c - '0');
+                    ++digits;
+                }
+            }
+            if( c != field.end && *c == '.' ) {
+                for( ++c; c != field.end && *c >= '0' && *c <= '9'; ++c ) {
+                    any_digits = true;
+                    if( mantissa != 0 || *c != '0' ) {
+                        mantissa = mantissa * 10 + (*c - '0');
+                        ++digits;
+                    }
+                    --exponent;
+                }
+            }
+            if( any_digits && c != field.end && (*c == 'e' || *c == 'E') ) {
+                const char* e = c + 1;
+                bool negative_exp = false;
+                if( e != field.end && (*e == '-' || *e == '+') ) {
+                    negative_exp = *e == '-';
+                    ++e;
+                }
+                int exp_value = 0;
+                bool exp_digits = false;
+                for( ; e != field.end && *e >= '0' && *e <= '9' && exp_value < 10000; ++e ) {
+                    exp_value = exp_value * 10 + (*e - '0');
+                    exp_digits = true;
+                }
+                if( exp_digits ) {
+                    exponent += negative_exp ? -exp_value : exp_value;
+                    c = e;
+                }
+            }
+
+            // Exact when the digits fit the significand and the power of ten is itself exact, as the one rounding
+            // of the multiplication or division is then the correct rounding of the decimal value.
+            static const double powers_of_ten[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                                   1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+            if( any_digits && c == field.end && digits <= 19 && mantissa <= (std::uint64_t(1) << 53)
+                && exponent >= -22 && exponent <= 22 ) {
+                double value = static_cast<double>(mantissa);
+                value = exponent < 0 ? value / powers_of_ten[-exponent] : value * powers_of_ten[exponent];
+                return negative ? -value : value;
+            }
+            return parse_double_slow(field);
+        }
+
+        /**
+         * @brief Parse a UTC date and time of the exact form ``YYYY-MM-DD hh:mm:ss`` filling a whole field.
+         *
+         * @param field The field.
+         * @param epoch_time Set to the epoch time, in seconds, if the field has that form.
+         * @return Whether the field has that form; callers may then fall back to a more lenient parser.
+         */
+        static bool parse_datetime(const Field& field, time_t& epoch_time)
+        {
+            const char* c = field.begin;
+            int year, month, day, hour, minute, second;
+            if( !(read_int(c, field.end, 4, year) && expect(c, field.end, '-') && read_int(c, field.end, 2, month)
+                  && expect(c, field.end, '-') && read_int(c, field.end, 2, day) && expect(c, field.end, ' ')
+                  && read_int(c, field.end, 2, hour) && expect(c, field.end, ':') && read_int(c, field.end, 2, minute)
+                  && expect(c, field.end, ':') && read_int(c, field.end, 2, second) && c == field.end)
+                || month < 1 || month > 12 || day < 1 || day > 31 ) {
+                return false;
+            }
+
+            // days since 1970-01-01 of the civil date (proleptic Gregorian)
+            const int y = year - (month <= 2 ? 1 : 0);
+            const int era = y / 400;
+            const int year_of_era = y - era * 400;
+            const int day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+            const int day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+            const long days = static_cast<long>(era) * 146097 + day_of_era - 719468;
+
+            epoch_time = static_cast<time_t>(days) * 86400 + hour * 3600 + minute * 60 + second;
+            return true;
+        }
+
+      private:
+
+        const char* data = nullptr;
+        std::size_t size = 0;
+        const char* position = nullptr;
+        char delimiter;
+
+        static bool is_space(char c)
+        {
+            return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+        }
+
+        static Field trimmed(const char* begin, const char* end)
+        {
+            while( begin != end && is_space(*begin) ) ++begin;
+            while( end != begin && is_space(*(end - 1)) ) --end;
+            return Field{begin, end};
+        }
+
+        static bool read_int(const char*& c, const char* end, int width, int& value)
+        {
+            value = 0;
+            for( int i = 0; i < width; ++i, ++c ) {
+                if( c == end || *c < '0' || *c > '9' ) return false;
+                value = value * 10 + (*c - '0');
+            }
+            return true;
+        }
+
+        static bool expect(const char*& c, const char* end, char expected)
+        {
+            if( c == end || *c != expected ) return false;
+            ++c;
+            return true;
+        }
+
+        static double parse_double_slow(const Field& field)
+        {
+            // strtod needs a terminated string, which fields in the mapping are not
+            const std::size_t length = field.end - field.begin;
+            char short_buffer[64];
+            std::string long_buffer;
+            char* buffer = short_buffer;
+            if( length >= sizeof(short_buffer) ) {
+                long_buffer = field.str();
+                buffer = &long_buffer[0];
+            }
+            std::copy(field.begin, field.end, buffer);
+            buffer[length] = '\0';
+            char* parsed_end = nullptr;
+            double value = std::strtod(buffer, &parsed_end);
+            if( length == 0 || parsed_end != buffer + length ) {
+                throw std::invalid_argument("Unable to parse number \"" + field.str() + "\"");
+            }
+            return value;
+        }
+    };
+}
+
+#endif // NGEN_MAPPED_CSV_READER_HPP
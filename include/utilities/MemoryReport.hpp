@@ -0,0 +1,191 @@
+#ifndef NGEN_MEMORY_REPORT_HPP
+#define NGEN_MEMORY_REPORT_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace utils
+{
+    /**
+     * @brief The bytes held by each of a run's major structures, e.g. the hydrofabric's features or the forcing
+     * caches, as estimated by their ``get_memory_bytes`` methods, combined over processes into the smallest, largest
+     * and mean of any one.
+     *
+     * Estimates count what a structure allocates for its own elements, from the capacity of its containers, and not
+     * the allocator's overhead, so they understate use somewhat; they are for comparing structures and sizing jobs,
+     * alongside the resident memory of the process.  The static helpers estimate common containers, for the
+     * ``get_memory_bytes`` methods of structures built from them.
+     *
+     * @code {.cpp}
+     * utils::MemoryReport report;
+     * report.add("network", features.get_network().get_memory_bytes());
+     * report.add("forcing", provider->get_memory_bytes());
+     * utils::MemoryReport::write_summary(std::cout, report.get_summary());
+     * @endcode
+     */
+    class MemoryReport
+    {
+      public:
+
+        /** The bytes of one structure, over the processes that have it. */
+        struct Stats
+        {
+            double min_bytes = 0.0;
+            double max_bytes = 0.0;
+            double total_bytes = 0.0;
+            int processes = 0;
+
+            /** Combine with the bytes of the same structure in another process. */
+            void merge_process(double bytes)
+            {
+                min_bytes = processes == 0 ? bytes : std::min(min_bytes, bytes);
+                max_bytes = processes == 0 ? bytes : std::max(max_bytes, bytes);
+                total_bytes += bytes;
+                ++processes;
+            }
+        };
+
+        /** Statistics of each structure, in the order they were first added. */
+        typedef std::vector<std::pair<std::string, Stats>> summary_t;
+
+        /** Add bytes to a structure of this process, which is added if new. */
+        void add(const std::string& name, double bytes)
+        {
+            auto it = std::find_if(summary.begin(), summary.end(), [&name](const summary_t::value_type& entry) {
+                return entry.first == name;
+            });
+            if (it == summary.end()) {
+                summary.emplace_back(name, Stats());
+                it = summary.end() - 1;
+                it->second.processes = 1;
+            }
+            it->second.total_bytes += bytes;
+            it->second.min_bytes = it->second.max_bytes = it->second.total_bytes;
+        }
+
+        /** @return The structures of this process. */
+        const summary_t& get_summary() const
+        {
+            return summary;
+        }
+
+        /** Serialize a summary as text, one structure per line, e.g. to send it to another process. */
+        static std::string serialize(const summary_t& summary)
+        {
+            std::ostringstream out;
+            out << std::setprecision(17);
+            for (const auto& entry : summary) {
+                out << entry.first << '\t' << entry.second.total_bytes << '\n';
+            }
+            return out.str();
+        }
+
+        /** Combine the summary serialized by another process with @p summary. */
+        static void merge_serialized(const std::string& text, summary_t& summary)
+        {
+            std::istringstream in(text);
+            std::string line;
+            while (std::getline(in, line)) {
+                size_t tab = line.find('\t');
+                if (tab == std::string::npos) {
+                    continue;
+                }
+                std::string name = line.substr(0, tab);
+                double bytes = std::stod(line.substr(tab + 1));
+                auto it = std::find_if(summary.begin(), summary.end(), [&name](const summary_t::value_type& entry) {
+                    return entry.first == name;
+                });
+                if (it == summary.end()) {
+                    summary.emplace_back(name, Stats());
+                    it = summary.end() - 1;
+                }
+                it->second.merge_process(bytes);
+            }
+        }
+
+        /**
+         * @brief Write a summary as a table, in MB.
+         *
+         * @param out The stream to write to.
+         * @param summary The statistics to write.
+         * @param processes The number of processes @p summary combines; a structure a process does not have counts
+         *                  as none of its bytes.
+         */
+        static void write_summary(std::ostream& out, const summary_t& summary, int processes = 1)
+        {
+            size_t name_width = 9;
+            for (const auto& entry : summary) {
+                name_width = std::max(name_width, entry.first.size());
+            }
+            std::ios_base::fmtflags flags = out.flags();
+            out << std::left << std::setw(name_width) << "Structure" << std::right;
+            if (processes > 1) {
+                out << std::setw(14) << "Min (MB)" << std::setw(14) << "Mean (MB)" << std::setw(14) << "Max (MB)";
+            }
+            else {
+                out << std::setw(14) << "Size (MB)";
+            }
+            out << '\n' << std::fixed << std::setprecision(1);
+            const double mb = 1024.0 * 1024.0;
+            for (const auto& entry : summary) {
+                const Stats& stats = entry.second;
+                out << std::left << std::setw(name_width) << entry.first << std::right;
+                if (processes > 1) {
+                    out << std::setw(14) << (stats.processes < processes ? 0.0 : stats.min_bytes) / mb
+                        << std::setw(14) << stats.total_bytes / processes / mb << std::setw(14) << stats.max_bytes / mb;
+                }
+                else {
+                    out << std::setw(14) << stats.total_bytes / mb;
+                }
+                out << '\n';
+            }
+            out.flags(flags);
+        }
+
+        /** @return The bytes a string allocates beyond itself, none for those short enough to be stored inline. */
+        static std::size_t bytes_of(const std::string& s)
+        {
+            return s.capacity() > std::string().capacity() ? s.capacity() + 1 : 0;
+        }
+
+        /** @return The bytes a vector allocates for its elements, not counting what they allocate themselves. */
+        template <typename T>
+        static std::size_t bytes_of(const std::vector<T>& v)
+        {
+            return v.capacity() * sizeof(T);
+        }
+
+        /** @return The bytes a vector of strings allocates, including the strings' own. */
+        static std::size_t bytes_of(const std::vector<std::string>& v)
+        {
+            std::size_t bytes = v.capacity() * sizeof(std::string);
+            for (const std::string& s : v) {
+                bytes += bytes_of(s);
+            }
+            return bytes;
+        }
+
+        /**
+         * @return The bytes a hash map allocates for its buckets and nodes, of a node holding a key and value and
+         *         the link to the next, not counting what the keys and values allocate themselves.
+         */
+        template <typename K, typename V, typename H, typename E, typename A>
+        static std::size_t bytes_of(const std::unordered_map<K, V, H, E, A>& m)
+        {
+            return m.bucket_count() * sizeof(void*) + m.size() * (sizeof(std::pair<const K, V>) + 2 * sizeof(void*));
+        }
+
+      private:
+
+        summary_t summary;
+    };
+}
+
+#endif // NGEN_MEMORY_REPORT_HPP
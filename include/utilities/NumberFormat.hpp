@@ -0,0 +1,255 @@
+#ifndef NGEN_NUMBER_FORMAT_HPP
+#define NGEN_NUMBER_FORMAT_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace utils
+{
+    /**
+     * @brief Fast conversion of numbers to the text of output files, appended straight into an output buffer.
+     *
+     * The functions here give exactly the text ``printf`` (and so ``std::to_string`` and ``std::ostream``, in the
+     * default "C" locale) gives for the same value and format, so outputs are unchanged, but without a format string
+     * to parse, a locale to consult, or a stream to go through.  A value's digits are found exactly, from the integer
+     * and binary exponent of the ``double``, with 128-bit integer arithmetic, and are rounded as ``printf`` rounds them
+     * (to nearest, ties to even).  The rare values this can't represent, such as those too large or small for their
+     * format to be exact in 128 bits, or infinities and NaNs, are formatted with ``snprintf``.
+     *
+     * @code {.cpp}
+     * std::string line;
+     * utils::number_format::append_fixed(line, 0.125, 2);      // As "%.2f", so "0.12"
+     * utils::number_format::append_general(line.append(","), 1.5e-05);  // As "%g", so "1.5e-05"
+     * @endcode
+     */
+    namespace number_format
+    {
+        namespace detail
+        {
+            #ifdef __SIZEOF_INT128__
+            typedef unsigned __int128 uint128_t;
+
+            /** @return ``10^exponent``, for an @p exponent from ``0`` to ``19``. */
+            inline uint128_t pow10(int exponent)
+            {
+                static const std::uint64_t powers[20] = {
+                    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL,
+                    1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+                    100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL,
+                    1000000000000000000ULL, 10000000000000000000ULL
+                };
+                return powers[exponent];
+            }
+
+            inline int bit_length(uint128_t value)
+            {
+                const std::uint64_t high = static_cast<std::uint64_t>(value >> 64);
+                const std::uint64_t low = static_cast<std::uint64_t>(value);
+                return high != 0 ? 128 - __builtin_clzll(high) : (low != 0 ? 64 - __builtin_clzll(low) : 0);
+            }
+
+            /**
+             * @brief Round ``|value| * 10^decimals`` to an integer, exactly, as ``printf`` would.
+             *
+             * @param magnitude A finite, non-negative value.
+             * @param decimals The power of ten to scale by, from ``-19`` to ``19``.
+             * @param rounded Set to the rounded value.
+             * @return Whether it could be found in 128 bits; if not, @p rounded is not set.
+             */
+            inline bool round_scaled(double magnitude, int decimals, uint128_t& rounded)
+            {
+                if (decimals < -19 || decimals > 19) {
+                    return false;
+                }
+                int binary_exponent;
+                double fraction = std::frexp(magnitude, &binary_exponent);
+                // The value as an integer times a power of two, which is exact for a double
+                uint128_t numerator = static_cast<uint128_t>(static_cast<std::uint64_t>(std::ldexp(fraction, 53)));
+                binary_exponent -= 53;
+                uint128_t denominator = 1;
+                if (decimals >= 0) {
+                    numerator *= pow10(decimals);
+                }
+                else {
+                    denominator = pow10(-decimals);
+                }
+                if (binary_exponent >= 0) {
+                    if (bit_length(numerator) + binary_exponent > 127) {
+                        return false;
+                    }
+                    numerator <<= binary_exponent;
+                }
+                else if (bit_length(denominator) - binary_exponent > 127) {
+                    // Too small to be scaled exactly; it still rounds to 0 while under a half
+                    if (decimals < 0 || bit_length(numerator) > -binary_exponent - 1) {
+                        return false;
+                    }
+                    rounded = 0;
+                    return true;
+                }
+                else {
+                    denominator <<= -binary_exponent;
+                }
+                rounded = numerator / denominator;
+                uint128_t twice_remainder = 2 * (numerator % denominator);
+                if (twice_remainder > denominator || (twice_remainder == denominator && (rounded & 1) != 0)) {
+                    ++rounded;
+                }
+                return true;
+            }
+
+            /** Append the decimal digits of @p value, at least @p min_digits of them, padded with leading zeros. */
+            inline void append_digits(std::string& out, uint128_t value, int min_digits)
+            {
+                char digits[48];
+                int count = 0;
+                while (value >= 10000000000000000000ULL) {
+                    digits[count++] = static_cast<char>('0' + static_cast<int>(value % 10));
+                    value /= 10;
+                }
+                std::uint64_t low = static_cast<std::uint64_t>(value);
+                do {
+                    digits[count++] = static_cast<char>('0' + static_cast<int>(low % 10));
+                    low /= 10;
+                } while (low != 0);
+                while (count < min_digits) {
+                    digits[count++] = '0';
+                }
+                while (count > 0) {
+                    out.push_back(digits[--count]);
+                }
+            }
+            #endif // __SIZEOF_INT128__
+
+            inline void append_printf(std::string& out, const char* format, int precision, double value)
+            {
+                char buffer[64];
+                int length = std::snprintf(buffer, sizeof(buffer), format, precision, value);
+                if (length < 0) {
+                    return;
+                }
+                if (static_cast<std::size_t>(length) < sizeof(buffer)) {
+                    out.append(buffer, length);
+                    return;
+                }
+                // Only a fixed format of a very large value is longer
+                std::string longer(length, '\0');
+                std::snprintf(&longer[0], length + 1, format, precision, value);
+                out.append(longer);
+            }
+        }
+
+        /**
+         * @brief Append @p value with @p precision decimal places, as ``printf("%.*f", precision, value)`` would.
+         *
+         * With the default @p precision, this is the text of ``std::to_string(value)``.
+         */
+        inline std::string& append_fixed(std::string& out, double value, int precision = 6)
+        {
+            #ifdef __SIZEOF_INT128__
+            detail::uint128_t scaled;
+            if (std::isfinite(value) && precision >= 0 && precision <= 18 && std::fabs(value) < 18446744073709551616.0
+                && detail::round_scaled(std::fabs(value), precision, scaled)) {
+                if (std::signbit(value)) {
+                    out.push_back('-');
+                }
+                const detail::uint128_t unit = detail::pow10(precision);
+                detail::append_digits(out, scaled / unit, 1);
+                if (precision > 0) {
+                    out.push_back('.');
+                    detail::append_digits(out, scaled % unit, precision);
+                }
+                return out;
+            }
+            #endif // __SIZEOF_INT128__
+            detail::append_printf(out, "%.*f", precision, value);
+            return out;
+        }
+
+        /**
+         * @brief Append @p value with @p precision significant digits, as ``printf("%.*g", precision, value)`` would.
+         *
+         * With the default @p precision, this is the text of ``std::ostream << value`` with the stream's default
+         * format and precision.
+         */
+        inline std::string& append_general(std::string& out, double value, int precision = 6)
+        {
+            #ifdef __SIZEOF_INT128__
+            const int digits = precision == 0 ? 1 : precision;
+            if (std::isfinite(value) && digits > 0 && digits <= 19) {
+                const double magnitude = std::fabs(value);
+                if (magnitude == 0) {
+                    out.append(std::signbit(value) ? "-0" : "0");
+                    return out;
+                }
+                // The decimal exponent of the value once rounded to its digits, first estimated and then corrected so
+                // that the rounded digits number exactly as many as are wanted
+                const detail::uint128_t lowest = detail::pow10(digits - 1);
+                const detail::uint128_t highest = lowest * 10;
+                int exponent = static_cast<int>(std::floor(std::log10(magnitude)));
+                detail::uint128_t scaled = 0;
+                bool exact = false;
+                for (int attempt = 0; attempt < 3; ++attempt) {
+                    if (!detail::round_scaled(magnitude, digits - 1 - exponent, scaled)) {
+                        break;
+                    }
+                    if (scaled >= highest) {
+                        ++exponent;
+                    }
+                    else if (scaled < lowest) {
+                        --exponent;
+                    }
+                    else {
+                        exact = true;
+                        break;
+                    }
+                }
+                if (exact) {
+                    if (std::signbit(value)) {
+                        out.push_back('-');
+                    }
+                    // Trailing zeros are dropped from the fraction, along with the point if nothing is left of it
+                    int decimals = exponent >= -4 && exponent < digits ? digits - 1 - exponent : digits - 1;
+                    while (decimals > 0 && scaled % 10 == 0) {
+                        scaled /= 10;
+                        --decimals;
+                    }
+                    const detail::uint128_t unit = detail::pow10(decimals);
+                    detail::append_digits(out, scaled / unit, 1);
+                    if (decimals > 0) {
+                        out.push_back('.');
+                        detail::append_digits(out, scaled % unit, decimals);
+                    }
+                    if (exponent < -4 || exponent >= digits) {
+                        out.push_back('e');
+                        out.push_back(exponent < 0 ? '-' : '+');
+                        detail::append_digits(out, static_cast<detail::uint128_t>(exponent < 0 ? -exponent : exponent), 2);
+                    }
+                    return out;
+                }
+            }
+            #endif // __SIZEOF_INT128__
+            detail::append_printf(out, "%.*g", precision, value);
+            return out;
+        }
+
+        /** @return @p value as text, as @ref append_fixed appends it, e.g. in place of ``std::to_string(value)``. */
+        inline std::string to_fixed(double value, int precision = 6)
+        {
+            std::string text;
+            return append_fixed(text, value, precision);
+        }
+
+        /** @return @p value as text, as @ref append_general appends it. */
+        inline std::string to_general(double value, int precision = 6)
+        {
+            std::string text;
+            return append_general(text, value, precision);
+        }
+    }
+}
+
+#endif //NGEN_NUMBER_FORMAT_HPP
@@ -0,0 +1,539 @@
+#ifndef NGEN_PROFILER_HPP
+#define NGEN_PROFILER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "HardwareCounters.hpp"
+
+namespace utils
+{
+    /**
+     * @brief Collects the time spent in named regions of the code, and how often they run.
+     *
+     * Profiling is off until @ref enable is called; until then, a @ref ScopedTimer costs a single relaxed atomic load.
+     * Once enabled, each thread accumulates its own statistics per region, so timing a region does not contend with
+     * other threads.  Optionally, each timed interval is also kept as an event of a timeline, which can be written in
+     * the Chrome trace event format (viewable with ``chrome://tracing`` or Perfetto).  With @ref enable_counters, each
+     * interval also counts the hardware events (see @ref HardwareCounters) its thread executed, e.g. to tell whether a
+     * region is bound by computation, by memory or by mispredicted branches.
+     *
+     * Regions are identified by small integers, see @ref region; use the @ref NGEN_PROFILE_SCOPE macro to time the
+     * rest of a block:
+     *
+     * @code {.cpp}
+     * double get_response(time_step_t t, time_step_t dt) {
+     *     NGEN_PROFILE_SCOPE("formulation/get_response");
+     *     ...
+     * }
+     * @endcode
+     */
+    class Profiler
+    {
+      public:
+
+        typedef std::chrono::steady_clock clock;
+
+        /** Statistics of the timed intervals of one region. */
+        struct RegionStats
+        {
+            uint64_t count = 0;
+            uint64_t total_ns = 0;
+            uint64_t min_ns = std::numeric_limits<uint64_t>::max();
+            uint64_t max_ns = 0;
+            /** The largest total of any one process, when combining the statistics of several processes. */
+            uint64_t max_process_total_ns = 0;
+            /** The hardware events counted over the intervals, by HardwareCounters::Counter, if any were. */
+            HardwareCounters::Values counters{};
+
+            void add(uint64_t ns)
+            {
+                ++count;
+                total_ns += ns;
+                min_ns = std::min(min_ns, ns);
+                max_ns = std::max(max_ns, ns);
+            }
+
+            /** Combine with the statistics of the same region from another thread of the same process. */
+            void merge(const RegionStats& other)
+            {
+                count += other.count;
+                total_ns += other.total_ns;
+                min_ns = std::min(min_ns, other.min_ns);
+                max_ns = std::max(max_ns, other.max_ns);
+                max_process_total_ns = total_ns;
+                add_counters(other.counters);
+            }
+
+            /** Add the hardware events counted over an interval. */
+            void add_counters(const HardwareCounters::Values& values)
+            {
+                for( int i = 0; i < HardwareCounters::COUNTER_COUNT; ++i ) {
+                    counters.counts[i] += values.counts[i];
+                }
+            }
+
+            /** @return Whether any hardware events were counted. */
+            bool has_counters() const
+            {
+                return counters.counts[HardwareCounters::CYCLES] > 0 || counters.counts[HardwareCounters::INSTRUCTIONS] > 0;
+            }
+
+            /** Combine with the statistics of the same region from another process. */
+            void merge_process(const RegionStats& other)
+            {
+                uint64_t max_total = std::max(max_process_total_ns, other.max_process_total_ns);
+                merge(other);
+                max_process_total_ns = max_total;
+            }
+        };
+
+        /** Statistics by region name. */
+        typedef std::map<std::string, RegionStats> summary_t;
+
+        /**
+         * @brief Start profiling.
+         *
+         * @param trace Whether to also keep a timeline of the timed intervals, for @ref write_trace.
+         * @param max_trace_events The most events each thread keeps for the timeline; later ones are dropped.
+         */
+        static void enable(bool trace = false, size_t max_trace_events = 1 << 20)
+        {
+            State& s = state();
+            s.epoch = clock::now();
+            s.max_trace_events = max_trace_events;
+            s.tracing.store(trace, std::memory_order_relaxed);
+            s.enabled.store(true, std::memory_order_release);
+        }
+
+        /**
+         * @brief Also count the hardware events of each timed interval, where the calling thread can count them.
+         *
+         * Reading the counters takes a system call at each end of an interval, so this adds about a microsecond to
+         * every interval timed.
+         *
+         * @return Whether the counters can be read; if not, intervals are timed only.
+         */
+        static bool enable_counters()
+        {
+            bool available = HardwareCounters::is_available();
+            state().counting.store(available, std::memory_order_relaxed);
+            return available;
+        }
+
+        /** Stop profiling, and counting; what was recorded until now is kept. */
+        static void disable()
+        {
+            state().enabled.store(false, std::memory_order_release);
+            state().counting.store(false, std::memory_order_relaxed);
+        }
+
+        static bool is_enabled()
+        {
+            return state().enabled.load(std::memory_order_relaxed);
+        }
+
+        static bool is_counting()
+        {
+            return state().counting.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Get the id of the region with the given name, registering it if new.
+         *
+         * This takes a lock, so call sites should look ids up once (as @ref NGEN_PROFILE_SCOPE does).
+         */
+        static int region(const std::string& name)
+        {
+            State& s = state();
+            std::lock_guard<std::mutex> lock(s.mutex);
+            auto it = s.region_ids.find(name);
+            if( it != s.region_ids.end() ) {
+                return it->second;
+            }
+            int id = static_cast<int>(s.region_names.size());
+            s.region_names.push_back(name);
+            s.region_ids[name] = id;
+            return id;
+        }
+
+        /**
+         * @brief Record an interval of a region, on this thread.
+         *
+         * @param counters The hardware events counted over the interval, if they were.
+         */
+        static void record(int region, clock::time_point start, clock::time_point end,
+                           const HardwareCounters::Values* counters = nullptr)
+        {
+            uint64_t ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+            ThreadData& data = thread_data();
+            State& s = state();
+            std::lock_guard<std::mutex> lock(data.mutex);
+            if( static_cast<size_t>(region) >= data.stats.size() ) {
+                data.stats.resize(region + 1);
+            }
+            data.stats[region].add(ns);
+            if( counters != nullptr ) {
+                data.stats[region].add_counters(*counters);
+            }
+            if( s.tracing.load(std::memory_order_relaxed) ) {
+                if( data.events.size() < s.max_trace_events ) {
+                    int64_t start_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(start - s.epoch).count();
+                    data.events.push_back(TraceEvent{region, start_ns, static_cast<int64_t>(ns)});
+                }
+                else {
+                    ++data.dropped_events;
+                }
+            }
+        }
+
+        /** Count @p n occurrences of a region, without timing them. */
+        static void count(int region, uint64_t n = 1)
+        {
+            if( !is_enabled() ) {
+                return;
+            }
+            ThreadData& data = thread_data();
+            std::lock_guard<std::mutex> lock(data.mutex);
+            if( static_cast<size_t>(region) >= data.stats.size() ) {
+                data.stats.resize(region + 1);
+            }
+            RegionStats& stats = data.stats[region];
+            stats.count += n;
+            stats.min_ns = 0;
+        }
+
+        /** @return The statistics of every region, combined over all threads that recorded any. */
+        static summary_t collect()
+        {
+            State& s = state();
+            std::vector<std::shared_ptr<ThreadData>> threads;
+            std::vector<std::string> names;
+            {
+                std::lock_guard<std::mutex> lock(s.mutex);
+                threads = s.threads;
+                names = s.region_names;
+            }
+            summary_t summary;
+            for( const auto& data : threads ) {
+                std::lock_guard<std::mutex> lock(data->mutex);
+                for( size_t i = 0; i < data->stats.size(); ++i ) {
+                    if( data->stats[i].count > 0 ) {
+                        summary[names[i]].merge(data->stats[i]);
+                    }
+                }
+            }
+            return summary;
+        }
+
+        /** Serialize a summary as text, one region per line, e.g. to send it to another process. */
+        static std::string serialize(const summary_t& summary)
+        {
+            std::ostringstream out;
+            for( const auto& entry : summary ) {
+                const RegionStats& stats = entry.second;
+                out << entry.first << '\t' << stats.count << '\t' << stats.total_ns << '\t' << stats.min_ns << '\t'
+                    << stats.max_ns << '\t' << stats.max_process_total_ns;
+                for( int i = 0; i < HardwareCounters::COUNTER_COUNT; ++i ) {
+                    out << '\t' << stats.counters.counts[i];
+                }
+                out << '\n';
+            }
+            return out.str();
+        }
+
+        /** Combine a summary serialized by another process with @p summary. */
+        static void merge_serialized(const std::string& text, summary_t& summary)
+        {
+            std::istringstream in(text);
+            std::string line;
+            while( std::getline(in, line) ) {
+                size_t tab = line.find('\t');
+                if( tab == std::string::npos ) {
+                    continue;
+                }
+                RegionStats stats;
+                std::istringstream fields(line.substr(tab + 1));
+                fields >> stats.count >> stats.total_ns >> stats.min_ns >> stats.max_ns >> stats.max_process_total_ns;
+                for( int i = 0; i < HardwareCounters::COUNTER_COUNT; ++i ) {
+                    fields >> stats.counters.counts[i];
+                }
+                summary[line.substr(0, tab)].merge_process(stats);
+            }
+        }
+
+        /**
+         * @brief Write a summary as a table, with the regions taking the most time first.
+         *
+         * @param out The stream to write to.
+         * @param summary The statistics to write.
+         * @param processes The number of processes @p summary combines, for the mean time per process.
+         */
+        static void write_summary(std::ostream& out, const summary_t& summary, int processes = 1)
+        {
+            std::vector<const summary_t::value_type*> entries;
+            size_t name_width = 6;
+            for( const auto& entry : summary ) {
+                entries.push_back(&entry);
+                name_width = std::max(name_width, entry.first.size());
+            }
+            std::sort(entries.begin(), entries.end(), [](const summary_t::value_type* a, const summary_t::value_type* b) {
+                return a->second.total_ns > b->second.total_ns;
+            });
+
+            std::ios_base::fmtflags flags = out.flags();
+            out << std::left << std::setw(name_width) << "Region" << std::right
+                << std::setw(14) << "Calls" << std::setw(14) << "Total (s)" << std::setw(14) << "Mean (us)"
+                << std::setw(14) << "Min (us)" << std::setw(14) << "Max (us)";
+            if( processes > 1 ) {
+                out << std::setw(16) << "Avg/rank (s)" << std::setw(16) << "Max rank (s)";
+            }
+            out << '\n';
+            out << std::fixed;
+            for( const auto* entry : entries ) {
+                const RegionStats& stats = entry->second;
+                bool timed = stats.total_ns > 0 || stats.max_ns > 0;
+                out << std::left << std::setw(name_width) << entry->first << std::right
+                    << std::setw(14) << stats.count;
+                if( timed ) {
+                    out << std::setprecision(3) << std::setw(14) << stats.total_ns * 1e-9
+                        << std::setw(14) << stats.total_ns * 1e-3 / stats.count
+                        << std::setw(14) << stats.min_ns * 1e-3 << std::setw(14) << stats.max_ns * 1e-3;
+                    if( processes > 1 ) {
+                        out << std::setw(16) << stats.total_ns * 1e-9 / processes
+                            << std::setw(16) << stats.max_process_total_ns * 1e-9;
+                    }
+                }
+                out << '\n';
+            }
+
+            // What bounds each region, for those whose hardware events were counted
+            bool counted = false;
+            for( const auto* entry : entries ) {
+                counted = counted || entry->second.has_counters();
+            }
+            if( counted ) {
+                out << '\n' << std::left << std::setw(name_width) << "Region" << std::right
+                    << std::setw(14) << "Gcycles" << std::setw(14) << "IPC" << std::setw(16) << "Cache miss (%)"
+                    << std::setw(18) << "Misses/kinstr" << std::setw(20) << "Branch miss/kinstr" << '\n';
+                for( const auto* entry : entries ) {
+                    const RegionStats& stats = entry->second;
+                    if( !stats.has_counters() ) {
+                        continue;
+                    }
+                    const uint64_t* counts = stats.counters.counts;
+                    double instructions = static_cast<double>(counts[HardwareCounters::INSTRUCTIONS]);
+                    double kilo_instructions = instructions > 0 ? instructions * 1e-3 : 1.0;
+                    out << std::left << std::setw(name_width) << entry->first << std::right << std::setprecision(3)
+                        << std::setw(14) << counts[HardwareCounters::CYCLES] * 1e-9
+                        << std::setw(14) << (counts[HardwareCounters::CYCLES] > 0 ? instructions / counts[HardwareCounters::CYCLES] : 0.0)
+                        << std::setw(16) << (counts[HardwareCounters::CACHE_REFERENCES] > 0
+                                             ? 100.0 * counts[HardwareCounters::CACHE_MISSES] / counts[HardwareCounters::CACHE_REFERENCES]
+                                             : 0.0)
+                        << std::setw(18) << counts[HardwareCounters::CACHE_MISSES] / kilo_instructions
+                        << std::setw(20) << counts[HardwareCounters::BRANCH_MISSES] / kilo_instructions << '\n';
+                }
+            }
+            out.flags(flags);
+        }
+
+        /**
+         * @brief Write a summary as JSON, the statistics of @ref write_summary by region, for tools comparing runs.
+         *
+         * @param out The stream to write to.
+         * @param summary The statistics to write.
+         * @param processes The number of processes @p summary combines, for the mean time per process.
+         */
+        static void write_summary_json(std::ostream& out, const summary_t& summary, int processes = 1)
+        {
+            std::ios_base::fmtflags flags = out.flags();
+            std::streamsize precision = out.precision();
+            out << "{\"processes\":" << processes << ",\"regions\":[";
+            out << std::setprecision(9);
+            bool first = true;
+            for( const auto& entry : summary ) {
+                const RegionStats& stats = entry.second;
+                bool timed = stats.total_ns > 0 || stats.max_ns > 0;
+                out << (first ? "\n" : ",\n") << "{\"name\":\"" << entry.first << "\",\"calls\":" << stats.count
+                    << ",\"total_seconds\":" << stats.total_ns * 1e-9
+                    << ",\"mean_us\":" << (timed ? stats.total_ns * 1e-3 / stats.count : 0.0)
+                    << ",\"min_us\":" << (timed ? stats.min_ns * 1e-3 : 0.0)
+                    << ",\"max_us\":" << stats.max_ns * 1e-3
+                    << ",\"rank_mean_seconds\":" << stats.total_ns * 1e-9 / processes
+                    << ",\"max_rank_seconds\":" << (processes > 1 ? stats.max_process_total_ns : stats.total_ns) * 1e-9;
+                if( stats.has_counters() ) {
+                    out << ",\"counters\":{";
+                    for( int i = 0; i < HardwareCounters::COUNTER_COUNT; ++i ) {
+                        out << (i > 0 ? "," : "") << "\"" << HardwareCounters::name(static_cast<HardwareCounters::Counter>(i))
+                            << "\":" << stats.counters.counts[i];
+                    }
+                    out << "}";
+                }
+                out << "}";
+                first = false;
+            }
+            out << "\n]}\n";
+            out.flags(flags);
+            out.precision(precision);
+        }
+
+        /**
+         * @brief Write the timeline of this process in the Chrome trace event format.
+         *
+         * @param path The path of the JSON file to write.
+         * @param process_id The id of this process in the timeline, e.g. its MPI rank.
+         * @return Whether the file could be written.
+         */
+        static bool write_trace(const std::string& path, int process_id = 0)
+        {
+            State& s = state();
+            std::vector<std::shared_ptr<ThreadData>> threads;
+            std::vector<std::string> names;
+            {
+                std::lock_guard<std::mutex> lock(s.mutex);
+                threads = s.threads;
+                names = s.region_names;
+            }
+            std::ofstream out(path, std::ios::trunc);
+            out << "{\"traceEvents\":[";
+            bool first = true;
+            uint64_t dropped = 0;
+            out << std::fixed << std::setprecision(3);
+            for( size_t t = 0; t < threads.size(); ++t ) {
+                std::lock_guard<std::mutex> lock(threads[t]->mutex);
+                dropped += threads[t]->dropped_events;
+                for( const TraceEvent& event : threads[t]->events ) {
+                    out << (first ? "\n" : ",\n") << "{\"name\":\"" << names[event.region]
+                        << "\",\"ph\":\"X\",\"pid\":" << process_id << ",\"tid\":" << t
+                        << ",\"ts\":" << event.start_ns * 1e-3 << ",\"dur\":" << event.duration_ns * 1e-3 << "}";
+                    first = false;
+                }
+            }
+            out << "\n],\"otherData\":{\"dropped_events\":" << dropped << "}}\n";
+            out.close();
+            return static_cast<bool>(out);
+        }
+
+      private:
+
+        struct TraceEvent
+        {
+            int region;
+            int64_t start_ns;
+            int64_t duration_ns;
+        };
+
+        /** What one thread has recorded; locked by the thread when recording, uncontended except by collection. */
+        struct ThreadData
+        {
+            std::mutex mutex;
+            std::vector<RegionStats> stats;
+            std::vector<TraceEvent> events;
+            uint64_t dropped_events = 0;
+        };
+
+        struct State
+        {
+            std::atomic<bool> enabled{false};
+            std::atomic<bool> tracing{false};
+            std::atomic<bool> counting{false};
+            clock::time_point epoch = clock::now();
+            size_t max_trace_events = 0;
+            std::mutex mutex;
+            std::vector<std::string> region_names;
+            std::unordered_map<std::string, int> region_ids;
+            /** Data of every thread that has recorded, kept after the threads end. */
+            std::vector<std::shared_ptr<ThreadData>> threads;
+        };
+
+        static State& state()
+        {
+            static State s;
+            return s;
+        }
+
+        static ThreadData& thread_data()
+        {
+            thread_local std::shared_ptr<ThreadData> data;
+            if( !data ) {
+                data = std::make_shared<ThreadData>();
+                State& s = state();
+                std::lock_guard<std::mutex> lock(s.mutex);
+                s.threads.push_back(data);
+            }
+            return *data;
+        }
+    };
+
+    /**
+     * @brief Times its own lifetime as an interval of a @ref Profiler region, if profiling is enabled, counting its
+     * hardware events too if the profiler is counting them.
+     */
+    class ScopedTimer
+    {
+      public:
+
+        explicit ScopedTimer(int region) : region(region), active(Profiler::is_enabled()), counting(false)
+        {
+            if( active ) {
+                counting = Profiler::is_counting() && HardwareCounters::read(start_counters);
+                start = Profiler::clock::now();
+            }
+        }
+
+        ~ScopedTimer()
+        {
+            if( !active ) {
+                return;
+            }
+            Profiler::clock::time_point end = Profiler::clock::now();
+            HardwareCounters::Values counters;
+            if( counting && HardwareCounters::read(counters) ) {
+                for( int i = 0; i < HardwareCounters::COUNTER_COUNT; ++i ) {
+                    counters.counts[i] -= std::min(counters.counts[i], start_counters.counts[i]);
+                }
+                Profiler::record(region, start, end, &counters);
+            }
+            else {
+                Profiler::record(region, start, end);
+            }
+        }
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+      private:
+
+        int region;
+        bool active;
+        bool counting;
+        Profiler::clock::time_point start;
+        HardwareCounters::Values start_counters;
+    };
+}
+
+#define NGEN_PROFILE_CONCAT_INNER(a, b) a##b
+#define NGEN_PROFILE_CONCAT(a, b) NGEN_PROFILE_CONCAT_INNER(a, b)
+
+/**
+ * Time the rest of the enclosing block as an interval of the named @ref utils::Profiler region.  The region's id is
+ * looked up once per call site.
+ */
+#define NGEN_PROFILE_SCOPE(name) \
+    static const int NGEN_PROFILE_CONCAT(ngen_profile_region_, __LINE__) = utils::Profiler::region(name); \
+    utils::ScopedTimer NGEN_PROFILE_CONCAT(ngen_profile_timer_, __LINE__)(NGEN_PROFILE_CONCAT(ngen_profile_region_, __LINE__))
+
+#endif // NGEN_PROFILER_HPP
@@ -0,0 +1,281 @@
+#ifndef NGEN_RUN_PROGRESS_HPP
+#define NGEN_RUN_PROGRESS_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace utils
+{
+    /**
+     * @brief Tracks how far a run has got and where its time goes, for periodic progress reports while it runs.
+     *
+     * The main loop attributes its wall time to phases with @ref lap: the time since the last lap is added to the
+     * given phase, so every second of the loop is counted in exactly one phase at the cost of one clock read per
+     * phase.  Every @ref get_interval time steps, @ref sample takes a fixed size vector of the process's progress,
+     * which processes can gather (under MPI, with a non-blocking gather) for one of them to @ref format_report and
+     * @ref write_metrics for all of them.
+     *
+     * @code {.cpp}
+     * utils::RunProgress progress(100);
+     * for (int t = 0; t < steps; ++t) {
+     *     run_catchments(t);
+     *     progress.lap(utils::RunProgress::COMPUTE);
+     *     write_outputs(t);
+     *     progress.lap(utils::RunProgress::OUTPUT);
+     *     if (progress.is_report_due(t)) {
+     *         std::vector<double> sample = progress.sample(t + 1);
+     *         std::cout << utils::RunProgress::format_report(sample, 1, steps) << std::endl;
+     *     }
+     * }
+     * @endcode
+     */
+    class RunProgress
+    {
+      public:
+
+        typedef std::chrono::steady_clock clock;
+
+        /** The phases the time of the main loop is attributed to. */
+        enum Phase { COMPUTE, COMMUNICATION, OUTPUT, PHASE_COUNT };
+
+        /** The values of a sample, in order; every sample has ``SAMPLE_SIZE`` of them. */
+        enum SampleValue {
+            /** The number of time steps completed. */
+            COMPLETED_STEPS,
+            /** The number of time steps completed since the last sample, and the seconds they took. */
+            INTERVAL_STEPS,
+            INTERVAL_SECONDS,
+            /** The seconds of each phase since the last sample. */
+            INTERVAL_COMPUTE,
+            INTERVAL_COMMUNICATION,
+            INTERVAL_OUTPUT,
+            /** The seconds since the progress started, and of each phase. */
+            TOTAL_SECONDS,
+            TOTAL_COMPUTE,
+            TOTAL_COMMUNICATION,
+            TOTAL_OUTPUT,
+            SAMPLE_SIZE
+        };
+
+        /**
+         * @param interval The number of time steps between reports, or ``0`` for none.
+         * @param first_completed_steps The number of time steps completed before this run, e.g., of a restart's
+         *                              checkpoint, which are not counted in its rate.
+         */
+        explicit RunProgress(int interval, int first_completed_steps = 0)
+            : interval(interval), last_completed_steps(first_completed_steps), start(clock::now()), last_lap(start),
+              last_sample(start), phase_seconds(PHASE_COUNT, 0.0), last_phase_seconds(PHASE_COUNT, 0.0)
+        {
+        }
+
+        /** @return The number of time steps between reports, or ``0`` for none. */
+        int get_interval() const
+        {
+            return interval;
+        }
+
+        /** @return The seconds since the progress started. */
+        double get_elapsed_seconds() const
+        {
+            return std::chrono::duration<double>(clock::now() - start).count();
+        }
+
+        /** @return The seconds attributed to a phase so far, up to the last lap. */
+        double get_phase_seconds(Phase phase) const
+        {
+            return phase_seconds[phase];
+        }
+
+        /** Add the time since the last lap, or since the progress started, to a phase. */
+        void lap(Phase phase)
+        {
+            clock::time_point now = clock::now();
+            phase_seconds[phase] += std::chrono::duration<double>(now - last_lap).count();
+            last_lap = now;
+        }
+
+        /** @return Whether a report is due once the time step of an index is completed. */
+        bool is_report_due(int time_index) const
+        {
+            return interval > 0 && (time_index + 1) % interval == 0;
+        }
+
+        /**
+         * @brief Take a sample of the progress, starting the interval of the next one.
+         *
+         * @param completed_steps The number of time steps completed.
+         * @return The ``SAMPLE_SIZE`` values of the sample, see @ref SampleValue.
+         */
+        std::vector<double> sample(int completed_steps)
+        {
+            clock::time_point now = clock::now();
+            std::vector<double> values(SAMPLE_SIZE, 0.0);
+            values[COMPLETED_STEPS] = completed_steps;
+            values[INTERVAL_STEPS] = completed_steps - last_completed_steps;
+            values[INTERVAL_SECONDS] = std::chrono::duration<double>(now - last_sample).count();
+            values[TOTAL_SECONDS] = std::chrono::duration<double>(now - start).count();
+            for (int p = 0; p < PHASE_COUNT; ++p) {
+                values[INTERVAL_COMPUTE + p] = phase_seconds[p] - last_phase_seconds[p];
+                values[TOTAL_COMPUTE + p] = phase_seconds[p];
+            }
+            last_completed_steps = completed_steps;
+            last_sample = now;
+            last_phase_seconds = phase_seconds;
+            return values;
+        }
+
+        /**
+         * @brief Describe the progress of a run in one line, from the samples of each of its processes.
+         *
+         * Processes run the time steps in lockstep, so the rate is that of the slowest of them, and the slowest are
+         * those that computed longest, while the others waited for them in communication.
+         *
+         * @param samples The samples of the processes, one after another.
+         * @param processes The number of processes.
+         * @param total_steps The number of time steps of the run.
+         */
+        static std::string format_report(const std::vector<double>& samples, int processes, int total_steps)
+        {
+            double completed = samples[COMPLETED_STEPS];
+            double seconds = 0.0;
+            double total_seconds = 0.0;
+            double phases[PHASE_COUNT] = {0.0, 0.0, 0.0};
+            for (int r = 0; r < processes; ++r) {
+                const double* sample = samples.data() + r * SAMPLE_SIZE;
+                completed = std::min(completed, sample[COMPLETED_STEPS]);
+                seconds = std::max(seconds, sample[INTERVAL_SECONDS]);
+                for (int p = 0; p < PHASE_COUNT; ++p) {
+                    phases[p] += sample[INTERVAL_COMPUTE + p];
+                }
+            }
+            total_seconds = std::accumulate(phases, phases + PHASE_COUNT, 0.0);
+            double rate = seconds > 0.0 ? samples[INTERVAL_STEPS] / seconds : 0.0;
+
+            std::ostringstream line;
+            line << std::fixed << std::setprecision(1) << "Completed " << static_cast<long>(completed) << " of "
+                 << total_steps << " timesteps (" << (total_steps > 0 ? 100.0 * completed / total_steps : 100.0)
+                 << "%): " << rate << " steps/s";
+            if (rate > 0.0 && completed < total_steps) {
+                line << ", ETA " << format_duration((total_steps - completed) / rate);
+            }
+            if (total_seconds > 0.0) {
+                line << std::setprecision(0) << "; compute " << 100.0 * phases[COMPUTE] / total_seconds
+                     << "%, communication " << 100.0 * phases[COMMUNICATION] / total_seconds << "%, output "
+                     << 100.0 * phases[OUTPUT] / total_seconds << "%";
+            }
+            if (processes > 1) {
+                std::vector<int> ranks(processes);
+                std::iota(ranks.begin(), ranks.end(), 0);
+                std::sort(ranks.begin(), ranks.end(), [&samples](int a, int b) {
+                    return samples[a * SAMPLE_SIZE + INTERVAL_COMPUTE] > samples[b * SAMPLE_SIZE + INTERVAL_COMPUTE];
+                });
+                double mean = phases[COMPUTE] / processes;
+                line << std::setprecision(2) << "; slowest ranks";
+                for (int k = 0; k < std::min(processes, 3); ++k) {
+                    double compute = samples[ranks[k] * SAMPLE_SIZE + INTERVAL_COMPUTE];
+                    line << (k == 0 ? " " : ", ") << ranks[k] << " (" << (mean > 0.0 ? compute / mean : 1.0)
+                         << "x mean compute)";
+                }
+            }
+            return line.str();
+        }
+
+        /**
+         * @brief Write the progress of a run as metrics in the Prometheus text format, e.g., for the textfile
+         * collector of a node exporter, from the samples of each of its processes.
+         *
+         * The file is written beside its path and renamed into place, so it is never read part way through.
+         *
+         * @return Whether the file was written.
+         */
+        static bool write_metrics(const std::string& path, const std::vector<double>& samples, int processes,
+                                  int total_steps)
+        {
+            static const char* const phase_names[PHASE_COUNT] = {"compute", "communication", "output"};
+            double completed = samples[COMPLETED_STEPS];
+            double seconds = 0.0;
+            for (int r = 0; r < processes; ++r) {
+                completed = std::min(completed, samples[r * SAMPLE_SIZE + COMPLETED_STEPS]);
+                seconds = std::max(seconds, samples[r * SAMPLE_SIZE + INTERVAL_SECONDS]);
+            }
+            double rate = seconds > 0.0 ? samples[INTERVAL_STEPS] / seconds : 0.0;
+
+            std::ostringstream text;
+            text << "# HELP ngen_time_steps_completed The time steps completed by every process of the run.\n"
+                 << "# TYPE ngen_time_steps_completed gauge\n"
+                 << "ngen_time_steps_completed " << static_cast<long>(completed) << "\n"
+                 << "# HELP ngen_time_steps The time steps of the run.\n"
+                 << "# TYPE ngen_time_steps gauge\n"
+                 << "ngen_time_steps " << total_steps << "\n"
+                 << "# HELP ngen_steps_per_second The time steps completed per second since the last report.\n"
+                 << "# TYPE ngen_steps_per_second gauge\n"
+                 << "ngen_steps_per_second " << rate << "\n"
+                 << "# HELP ngen_eta_seconds The estimated seconds until the run completes.\n"
+                 << "# TYPE ngen_eta_seconds gauge\n"
+                 << "ngen_eta_seconds " << (rate > 0.0 ? (total_steps - completed) / rate : 0.0) << "\n"
+                 << "# HELP ngen_phase_seconds_total The seconds each process spent in each phase of the main loop.\n"
+                 << "# TYPE ngen_phase_seconds_total counter\n";
+            for (int r = 0; r < processes; ++r) {
+                for (int p = 0; p < PHASE_COUNT; ++p) {
+                    text << "ngen_phase_seconds_total{rank=\"" << r << "\",phase=\"" << phase_names[p] << "\"} "
+                         << samples[r * SAMPLE_SIZE + TOTAL_COMPUTE + p] << "\n";
+                }
+            }
+            text << "# HELP ngen_interval_phase_seconds The seconds each process spent in each phase since the last "
+                    "report.\n"
+                 << "# TYPE ngen_interval_phase_seconds gauge\n";
+            for (int r = 0; r < processes; ++r) {
+                for (int p = 0; p < PHASE_COUNT; ++p) {
+                    text << "ngen_interval_phase_seconds{rank=\"" << r << "\",phase=\"" << phase_names[p] << "\"} "
+                         << samples[r * SAMPLE_SIZE + INTERVAL_COMPUTE + p] << "\n";
+                }
+            }
+
+            std::string temp_path = path + ".tmp";
+            {
+                std::ofstream file(temp_path, std::ios::trunc);
+                file << text.str();
+                if (!file) {
+                    return false;
+                }
+            }
+            return std::rename(temp_path.c_str(), path.c_str()) == 0;
+        }
+
+        /** @return A duration as hours, minutes and seconds, e.g. ``2h05m17s``. */
+        static std::string format_duration(double seconds)
+        {
+            long s = static_cast<long>(seconds + 0.5);
+            char text[32];
+            if (s >= 3600) {
+                std::snprintf(text, sizeof(text), "%ldh%02ldm%02lds", s / 3600, s / 60 % 60, s % 60);
+            }
+            else if (s >= 60) {
+                std::snprintf(text, sizeof(text), "%ldm%02lds", s / 60, s % 60);
+            }
+            else {
+                std::snprintf(text, sizeof(text), "%lds", s);
+            }
+            return text;
+        }
+
+      private:
+
+        const int interval;
+        int last_completed_steps;
+        const clock::time_point start;
+        clock::time_point last_lap;
+        clock::time_point last_sample;
+        std::vector<double> phase_seconds;
+        std::vector<double> last_phase_seconds;
+    };
+}
+
+#endif // NGEN_RUN_PROGRESS_HPP
@@ -0,0 +1,167 @@
+#ifndef NGEN_SHARED_BLOCK_HPP
+#define NGEN_SHARED_BLOCK_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace utils
+{
+    /** Combine a hash into another, as ``boost::hash_combine`` does. */
+    inline void hash_combine(std::size_t& seed, std::size_t hash)
+    {
+        seed ^= hash + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
+
+    /** Hashes the contents of the configuration blocks formulations commonly hold, for @ref SharedBlock. */
+    struct ContentHash
+    {
+        std::size_t operator()(const std::vector<std::string>& values) const
+        {
+            std::size_t seed = values.size();
+            for (const std::string& value : values) {
+                hash_combine(seed, std::hash<std::string>()(value));
+            }
+            return seed;
+        }
+
+        std::size_t operator()(const std::map<std::string, std::string>& values) const
+        {
+            std::size_t seed = values.size();
+            for (const auto& entry : values) {
+                hash_combine(seed, std::hash<std::string>()(entry.first));
+                hash_combine(seed, std::hash<std::string>()(entry.second));
+            }
+            return seed;
+        }
+    };
+
+    /**
+     * @brief A reference-counted, immutable block of configuration, interned by its content, so that the many
+     * formulations configured alike (e.g. by one global formulation) each reference one copy of it, rather than each
+     * holding their own.
+     *
+     * Blocks are found by their hash, and then compared, so only equal blocks are ever shared.  A block is copied on
+     * write: @ref modify changes a copy of it, which is interned in turn, so other holders never see the change.
+     * Interned blocks are held weakly, so one is freed once nothing references it, and the table of each type of
+     * block may be used from several threads at once, e.g. while formulations are constructed concurrently.
+     *
+     * @code {.cpp}
+     * utils::SharedBlock<std::vector<std::string>> names(std::vector<std::string>{"Q_OUT"});
+     * names.modify([](std::vector<std::string>& values) { values.push_back("ET"); });
+     * for (const std::string& name : *names) { ... }
+     * @endcode
+     *
+     * @tparam T The type of the block, which must be copyable and comparable with ``==``.
+     * @tparam Hash The hash of its content.
+     */
+    template <class T, class Hash = ContentHash>
+    class SharedBlock
+    {
+      public:
+
+        /** An empty block. */
+        SharedBlock() : block(intern(T())) {}
+
+        /** The interned copy of a block, which is @p value itself if it is new. */
+        SharedBlock(T value) : block(intern(std::move(value))) {}
+
+        const T& operator*() const
+        {
+            return *block;
+        }
+
+        const T* operator->() const
+        {
+            return block.get();
+        }
+
+        const T& get() const
+        {
+            return *block;
+        }
+
+        /** @return Whether this and @p other reference the same copy of their block. */
+        bool shares_with(const SharedBlock& other) const
+        {
+            return block == other.block;
+        }
+
+        /**
+         * @brief Change the block, by changing a copy of it that is then interned in its place.
+         *
+         * @param change Changes the ``T&`` it is given.
+         */
+        template <class Change>
+        void modify(Change change)
+        {
+            T copy(*block);
+            change(copy);
+            block = intern(std::move(copy));
+        }
+
+        /** @return The number of distinct blocks of this type that are still referenced. */
+        static std::size_t size()
+        {
+            Table& blocks = table();
+            std::lock_guard<std::mutex> lock(blocks.mutex);
+            return std::count_if(blocks.entries.begin(), blocks.entries.end(), [](const entry_t& entry) {
+                return !entry.second.expired();
+            });
+        }
+
+      private:
+
+        typedef std::pair<const std::size_t, std::weak_ptr<const T>> entry_t;
+
+        struct Table
+        {
+            std::mutex mutex;
+            std::unordered_multimap<std::size_t, std::weak_ptr<const T>> entries;
+            std::size_t sweep_size = 64;
+        };
+
+        static Table& table()
+        {
+            static Table instance;
+            return instance;
+        }
+
+        static std::shared_ptr<const T> intern(T value)
+        {
+            const std::size_t key = Hash()(value);
+            Table& blocks = table();
+            std::lock_guard<std::mutex> lock(blocks.mutex);
+            auto range = blocks.entries.equal_range(key);
+            for (auto it = range.first; it != range.second; ++it) {
+                std::shared_ptr<const T> existing = it->second.lock();
+                if (existing && *existing == value) {
+                    return existing;
+                }
+            }
+            auto interned = std::make_shared<const T>(std::move(value));
+            blocks.entries.emplace(key, interned);
+
+            // Drop the expired entries, once the table has doubled in size since it was last swept
+            if (blocks.entries.size() >= blocks.sweep_size) {
+                for (auto it = blocks.entries.begin(); it != blocks.entries.end(); ) {
+                    it = it->second.expired() ? blocks.entries.erase(it) : std::next(it);
+                }
+                blocks.sweep_size = std::max<std::size_t>(64, 2 * blocks.entries.size());
+            }
+            return interned;
+        }
+
+        std::shared_ptr<const T> block;
+    };
+}
+
+#endif //NGEN_SHARED_BLOCK_HPP
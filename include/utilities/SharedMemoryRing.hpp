@@ -0,0 +1,294 @@
+#ifndef NGEN_SHARED_MEMORY_RING_HPP
+#define NGEN_SHARED_MEMORY_RING_HPP
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace utils
+{
+    /**
+     * @brief Memory shared with child processes through a file descriptor, which they may inherit across ``exec``.
+     *
+     * The memory is backed by an unlinked temporary file, in ``/dev/shm`` where there is one, so it has no name for
+     * other processes to find and is released once every process using it has closed it.  The descriptor is
+     * close-on-exec, so a child is only given it by duplicating it to a descriptor of its own (e.g. with
+     * ``posix_spawn_file_actions_adddup2``).
+     */
+    class SharedMemoryRegion
+    {
+      public:
+
+        /**
+         * @brief Create a region of zeroed memory.
+         *
+         * @param bytes The size of the region.
+         * @throws std::runtime_error If the memory cannot be created.
+         */
+        explicit SharedMemoryRegion(std::size_t bytes) : bytes(bytes)
+        {
+            const char* dir = ::access("/dev/shm", W_OK) == 0 ? "/dev/shm" : std::getenv("TMPDIR");
+            std::string path = std::string(dir != nullptr ? dir : "/tmp") + "/ngen-shm-XXXXXX";
+            fd = ::mkstemp(&path[0]);
+            if (fd < 0) {
+                throw std::runtime_error("SharedMemoryRegion: unable to create " + path + ": " + std::strerror(errno));
+            }
+            ::unlink(path.c_str());
+            ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+            if (::ftruncate(fd, bytes) != 0) {
+                std::string reason = std::strerror(errno);
+                ::close(fd);
+                throw std::runtime_error("SharedMemoryRegion: unable to size shared memory: " + reason);
+            }
+            map();
+        }
+
+        /**
+         * @brief Map a region created by another process, from the descriptor it was given.
+         *
+         * @param fd The descriptor of the region, which is closed along with the region.
+         * @param bytes The size of the region.
+         * @throws std::runtime_error If the memory cannot be mapped.
+         */
+        SharedMemoryRegion(int fd, std::size_t bytes) : bytes(bytes), fd(fd)
+        {
+            map();
+        }
+
+        ~SharedMemoryRegion()
+        {
+            ::munmap(memory, bytes);
+            ::close(fd);
+        }
+
+        SharedMemoryRegion(const SharedMemoryRegion&) = delete;
+        SharedMemoryRegion& operator=(const SharedMemoryRegion&) = delete;
+
+        void* data() const { return memory; }
+
+        std::size_t size() const { return bytes; }
+
+        int get_fd() const { return fd; }
+
+      private:
+
+        void map()
+        {
+            memory = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (memory == MAP_FAILED) {
+                std::string reason = std::strerror(errno);
+                ::close(fd);
+                throw std::runtime_error("SharedMemoryRegion: unable to map shared memory: " + reason);
+            }
+        }
+
+        std::size_t bytes;
+        int fd = -1;
+        void* memory = nullptr;
+    };
+
+    /**
+     * @brief A byte stream from one process to another through a ring buffer in shared memory.
+     *
+     * One process writes and one reads.  Writes of more bytes than the ring holds are passed through it piece by piece
+     * as the reader takes them, so messages of any size can be sent; the stream has no message boundaries of its own.
+     * The ring is laid out in memory both processes map, by @ref create, and each attaches to it with its own instance.
+     *
+     * A process blocked on the ring checks the liveness function it was given a few times a second, and throws
+     * ``std::runtime_error`` once it reports that the other process has gone, as it does once the ring is closed, so
+     * neither process waits forever on the other.  The lock guarding the ring is robust, so a process dying with it
+     * held only closes the ring.
+     */
+    class SharedMemoryRing
+    {
+      public:
+
+        /** Reports whether the process at the other end of the ring is still running. */
+        typedef std::function<bool()> liveness_function_t;
+
+        /** How often a blocked process checks on the other, in milliseconds. */
+        static constexpr long LIVENESS_CHECK_MS = 200;
+
+        /** @return The bytes of shared memory a ring holding @p capacity bytes takes up. */
+        static std::size_t region_bytes(std::size_t capacity)
+        {
+            return sizeof(Header) + capacity;
+        }
+
+        /**
+         * @brief Lay out an empty ring in shared memory, before either process attaches to it.
+         *
+         * @param region Memory of at least ``region_bytes(capacity)`` bytes, suitably aligned for a ``pthread_mutex_t``.
+         * @param capacity The bytes the ring holds.
+         */
+        static void create(void* region, std::size_t capacity)
+        {
+            Header* header = new (region) Header();
+            header->capacity = capacity;
+            pthread_mutexattr_t mutex_attributes;
+            pthread_mutexattr_init(&mutex_attributes);
+            pthread_mutexattr_setpshared(&mutex_attributes, PTHREAD_PROCESS_SHARED);
+            pthread_mutexattr_setrobust(&mutex_attributes, PTHREAD_MUTEX_ROBUST);
+            pthread_mutex_init(&header->mutex, &mutex_attributes);
+            pthread_mutexattr_destroy(&mutex_attributes);
+            pthread_condattr_t cond_attributes;
+            pthread_condattr_init(&cond_attributes);
+            pthread_condattr_setpshared(&cond_attributes, PTHREAD_PROCESS_SHARED);
+            pthread_cond_init(&header->readable, &cond_attributes);
+            pthread_cond_init(&header->writable, &cond_attributes);
+            pthread_condattr_destroy(&cond_attributes);
+        }
+
+        /**
+         * @param region The memory of a ring laid out by @ref create.
+         * @param peer_alive Whether the process at the other end is still running, if there is a way to tell.
+         */
+        explicit SharedMemoryRing(void* region, liveness_function_t peer_alive = nullptr)
+            : header(static_cast<Header*>(region)), data(static_cast<char*>(region) + sizeof(Header)),
+              peer_alive(std::move(peer_alive)) {}
+
+        /**
+         * @brief Write bytes to the ring, waiting for the reader to make room for them as needed.
+         *
+         * @throws std::runtime_error If the ring is closed, or the reader has gone, before every byte is written.
+         */
+        void write(const void* bytes, std::size_t size)
+        {
+            const char* source = static_cast<const char*>(bytes);
+            Lock lock(header);
+            while (size > 0) {
+                while (!header->closed && header->head - header->tail == header->capacity) {
+                    wait(header->writable);
+                }
+                throw_if_closed();
+                std::size_t count = std::min<std::size_t>(size, header->capacity - (header->head - header->tail));
+                std::size_t offset = header->head % header->capacity;
+                std::size_t first = std::min<std::size_t>(count, header->capacity - offset);
+                std::memcpy(data + offset, source, first);
+                std::memcpy(data, source + first, count - first);
+                header->head += count;
+                source += count;
+                size -= count;
+                pthread_cond_signal(&header->readable);
+            }
+        }
+
+        /**
+         * @brief Read bytes from the ring, waiting for the writer to write them as needed.
+         *
+         * @throws std::runtime_error If the ring is closed, or the writer has gone, before every byte is read.
+         */
+        void read(void* bytes, std::size_t size)
+        {
+            char* destination = static_cast<char*>(bytes);
+            Lock lock(header);
+            while (size > 0) {
+                while (!header->closed && header->head == header->tail) {
+                    wait(header->readable);
+                }
+                if (header->head == header->tail) {
+                    throw_if_closed();
+                }
+                std::size_t count = std::min<std::size_t>(size, header->head - header->tail);
+                std::size_t offset = header->tail % header->capacity;
+                std::size_t first = std::min<std::size_t>(count, header->capacity - offset);
+                std::memcpy(destination, data + offset, first);
+                std::memcpy(destination + first, data, count - first);
+                header->tail += count;
+                destination += count;
+                size -= count;
+                pthread_cond_signal(&header->writable);
+            }
+        }
+
+        /** Close the ring, so that blocked and later writes fail, and reads fail once the bytes written are read. */
+        void close()
+        {
+            Lock lock(header);
+            header->closed = true;
+            pthread_cond_broadcast(&header->readable);
+            pthread_cond_broadcast(&header->writable);
+        }
+
+      private:
+
+        struct alignas(64) Header
+        {
+            pthread_mutex_t mutex;
+            pthread_cond_t readable;
+            pthread_cond_t writable;
+            /** The total bytes ever written and read; their difference is the bytes in the ring. */
+            uint64_t head = 0;
+            uint64_t tail = 0;
+            uint64_t capacity = 0;
+            bool closed = false;
+        };
+
+        /** Holds the ring's lock, closing the ring if its last holder died with it. */
+        class Lock
+        {
+          public:
+
+            explicit Lock(Header* header) : header(header)
+            {
+                if (pthread_mutex_lock(&header->mutex) == EOWNERDEAD) {
+                    recover(header);
+                }
+            }
+
+            ~Lock() { pthread_mutex_unlock(&header->mutex); }
+
+            static void recover(Header* header)
+            {
+                pthread_mutex_consistent(&header->mutex);
+                header->closed = true;
+            }
+
+          private:
+
+            Header* header;
+        };
+
+        /** Wait on a condition of the ring for up to @ref LIVENESS_CHECK_MS, closing it if the other process is gone. */
+        void wait(pthread_cond_t& condition)
+        {
+            timespec deadline;
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_nsec += LIVENESS_CHECK_MS * 1000000L;
+            deadline.tv_sec += deadline.tv_nsec / 1000000000L;
+            deadline.tv_nsec %= 1000000000L;
+            int result = pthread_cond_timedwait(&condition, &header->mutex, &deadline);
+            if (result == EOWNERDEAD) {
+                Lock::recover(header);
+            }
+            else if (result == ETIMEDOUT && peer_alive && !peer_alive()) {
+                header->closed = true;
+            }
+        }
+
+        void throw_if_closed() const
+        {
+            if (header->closed) {
+                throw std::runtime_error("SharedMemoryRing: the ring was closed, or the process at its other end exited");
+            }
+        }
+
+        Header* header;
+        char* data;
+        liveness_function_t peer_alive;
+    };
+}
+
+#endif //NGEN_SHARED_MEMORY_RING_HPP
@@ -0,0 +1,327 @@
+#ifndef NGEN_STARTUP_PROFILE_HPP
+#define NGEN_STARTUP_PROFILE_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <sys/resource.h>
+#include <unistd.h>
+
+namespace utils
+{
+    /**
+     * @brief Collects the wall time and memory growth of the phases of a run's startup, e.g. reading the hydrofabric,
+     * reading the realization config and initializing each type of formulation.
+     *
+     * Unlike the main loop's @ref Profiler, startup phases are always timed: there are only a few of them, or one per
+     * formulation, and each costs a clock read and a read of ``/proc/self/statm`` at most.  Phases are kept in the
+     * order they first started, so a phase nested in another follows it; a phase that runs several times, e.g. once
+     * per formulation constructed, is totalled.  Time a phase with a @ref StartupTimer:
+     *
+     * @code {.cpp}
+     * utils::StartupTimer startup("hydrofabric/read");
+     * read_hydrofabric();
+     * startup.next("realization/read");
+     * read_realization();
+     * startup.stop();
+     * utils::StartupProfile::write_summary(std::cout, utils::StartupProfile::collect());
+     * @endcode
+     */
+    class StartupProfile
+    {
+      public:
+
+        /** Statistics of the intervals of one phase. */
+        struct PhaseStats
+        {
+            uint64_t count = 0;
+            /** The total seconds of the phase, over its intervals, and over processes when combined. */
+            double seconds = 0.0;
+            /** The largest total seconds of any one process, and which process that was. */
+            double max_seconds = 0.0;
+            int max_process = 0;
+            /** The growth of resident memory over the phase, in MB, summed as for @ref seconds, if it was sampled. */
+            double memory_mb = 0.0;
+            double max_memory_mb = 0.0;
+            bool is_memory_sampled = false;
+
+            /** Combine with the statistics of the same phase from another process. */
+            void merge_process(const PhaseStats& other, int process)
+            {
+                if (other.seconds > max_seconds || count == 0) {
+                    max_seconds = other.seconds;
+                    max_process = process;
+                }
+                count += other.count;
+                seconds += other.seconds;
+                memory_mb += other.memory_mb;
+                max_memory_mb = std::max(max_memory_mb, other.max_memory_mb);
+                is_memory_sampled = is_memory_sampled || other.is_memory_sampled;
+            }
+        };
+
+        /** Statistics of each phase, in the order the phases first started. */
+        typedef std::vector<std::pair<std::string, PhaseStats>> summary_t;
+
+        /**
+         * @brief Record an interval of a phase; safe to call from several threads at once.
+         *
+         * @param name The name of the phase.
+         * @param seconds The wall time of the interval.
+         * @param memory_mb The growth of resident memory over the interval, in MB; ignored if not @p is_memory_sampled.
+         * @param is_memory_sampled Whether the memory growth was sampled, which is only meaningful for intervals that
+         *                          do not overlap others of the same process.
+         */
+        static void record(const std::string& name, double seconds, double memory_mb = 0.0,
+                           bool is_memory_sampled = false)
+        {
+            State& s = state();
+            std::lock_guard<std::mutex> lock(s.mutex);
+            PhaseStats& stats = find_or_add(s.phases, name);
+            ++stats.count;
+            stats.seconds += seconds;
+            stats.max_seconds = stats.seconds;
+            if (is_memory_sampled) {
+                stats.memory_mb += memory_mb;
+                stats.max_memory_mb = stats.memory_mb;
+                stats.is_memory_sampled = true;
+            }
+        }
+
+        /** Add a phase, if it is new, without recording an interval of it, to keep its place in the order. */
+        static void declare(const std::string& name)
+        {
+            State& s = state();
+            std::lock_guard<std::mutex> lock(s.mutex);
+            find_or_add(s.phases, name);
+        }
+
+        /** @return The statistics of every phase recorded by this process. */
+        static summary_t collect()
+        {
+            State& s = state();
+            std::lock_guard<std::mutex> lock(s.mutex);
+            return s.phases;
+        }
+
+        /** Serialize a summary as text, one phase per line, e.g. to send it to another process. */
+        static std::string serialize(const summary_t& summary)
+        {
+            std::ostringstream out;
+            out << std::setprecision(17);
+            for (const auto& entry : summary) {
+                const PhaseStats& stats = entry.second;
+                out << entry.first << '\t' << stats.count << '\t' << stats.seconds << '\t' << stats.memory_mb << '\t'
+                    << (stats.is_memory_sampled ? 1 : 0) << '\n';
+            }
+            return out.str();
+        }
+
+        /**
+         * @brief Combine a summary serialized by a process with @p summary.
+         *
+         * Phases new to @p summary are added after its own, so merging every process's summary in turn keeps the
+         * order of the first.
+         */
+        static void merge_serialized(const std::string& text, int process, summary_t& summary)
+        {
+            std::istringstream in(text);
+            std::string line;
+            while (std::getline(in, line)) {
+                size_t tab = line.find('\t');
+                if (tab == std::string::npos) {
+                    continue;
+                }
+                PhaseStats stats;
+                int is_memory_sampled = 0;
+                std::istringstream fields(line.substr(tab + 1));
+                fields >> stats.count >> stats.seconds >> stats.memory_mb >> is_memory_sampled;
+                stats.is_memory_sampled = is_memory_sampled != 0;
+                stats.max_memory_mb = stats.memory_mb;
+                find_or_add(summary, line.substr(0, tab)).merge_process(stats, process);
+            }
+        }
+
+        /**
+         * @brief Write a summary as a table, in the order of its phases.
+         *
+         * Phases that ran on several threads at once, such as formulation construction with ``init_threads``, are
+         * totalled over the threads, so their seconds may add up to more than the wall time of startup.
+         *
+         * @param out The stream to write to.
+         * @param summary The statistics to write.
+         * @param processes The number of processes @p summary combines, for the mean per process.
+         */
+        static void write_summary(std::ostream& out, const summary_t& summary, int processes = 1)
+        {
+            size_t name_width = 5;
+            for (const auto& entry : summary) {
+                name_width = std::max(name_width, entry.first.size());
+            }
+            std::ios_base::fmtflags flags = out.flags();
+            out << std::left << std::setw(name_width) << "Phase" << std::right << std::setw(10) << "Count";
+            if (processes > 1) {
+                out << std::setw(14) << "Avg/rank (s)" << std::setw(14) << "Max rank (s)" << std::setw(10) << "Rank"
+                    << std::setw(16) << "Avg/rank (MB)" << std::setw(16) << "Max rank (MB)";
+            }
+            else {
+                out << std::setw(14) << "Total (s)" << std::setw(14) << "Memory (MB)";
+            }
+            out << '\n' << std::fixed;
+            for (const auto& entry : summary) {
+                const PhaseStats& stats = entry.second;
+                out << std::left << std::setw(name_width) << entry.first << std::right << std::setw(10) << stats.count
+                    << std::setprecision(3) << std::setw(14) << stats.seconds / processes;
+                if (processes > 1) {
+                    out << std::setw(14) << stats.max_seconds << std::setw(10) << stats.max_process;
+                }
+                if (stats.is_memory_sampled) {
+                    out << std::setprecision(1) << std::setw(processes > 1 ? 16 : 14) << stats.memory_mb / processes;
+                    if (processes > 1) {
+                        out << std::setw(16) << stats.max_memory_mb;
+                    }
+                }
+                out << '\n';
+            }
+            out.flags(flags);
+        }
+
+        /** @return The resident memory of this process, in MB, or ``0`` where it cannot be read. */
+        static double get_resident_memory_mb()
+        {
+            long pages = 0;
+            long resident = 0;
+            std::FILE* statm = std::fopen("/proc/self/statm", "r");
+            if (statm == nullptr) {
+                return 0.0;
+            }
+            int read = std::fscanf(statm, "%ld %ld", &pages, &resident);
+            std::fclose(statm);
+            return read == 2 ? resident * static_cast<double>(sysconf(_SC_PAGESIZE)) / (1024.0 * 1024.0) : 0.0;
+        }
+
+        /** @return The largest resident memory of this process so far, in MB. */
+        static double get_peak_memory_mb()
+        {
+            struct rusage usage;
+            if (getrusage(RUSAGE_SELF, &usage) != 0) {
+                return 0.0;
+            }
+            #ifdef __APPLE__
+            return usage.ru_maxrss / (1024.0 * 1024.0);
+            #else
+            return usage.ru_maxrss / 1024.0;
+            #endif
+        }
+
+        /** Forget every phase recorded, e.g. between tests. */
+        static void clear()
+        {
+            State& s = state();
+            std::lock_guard<std::mutex> lock(s.mutex);
+            s.phases.clear();
+        }
+
+      private:
+
+        static PhaseStats& find_or_add(summary_t& summary, const std::string& name)
+        {
+            auto it = std::find_if(summary.begin(), summary.end(), [&name](const summary_t::value_type& phase) {
+                return phase.first == name;
+            });
+            if (it == summary.end()) {
+                summary.emplace_back(name, PhaseStats());
+                it = summary.end() - 1;
+            }
+            return it->second;
+        }
+
+        struct State
+        {
+            std::mutex mutex;
+            summary_t phases;
+        };
+
+        static State& state()
+        {
+            static State s;
+            return s;
+        }
+    };
+
+    /**
+     * @brief Times a @ref StartupProfile phase from its construction, or from the last @ref next, until @ref stop,
+     * @ref next or its destruction.
+     */
+    class StartupTimer
+    {
+      public:
+
+        typedef std::chrono::steady_clock clock;
+
+        /**
+         * @param name The name of the phase.
+         * @param is_memory_sampled Whether to record the growth of resident memory over the phase, which should be
+         *                          left off for phases that run on several threads at once.
+         */
+        explicit StartupTimer(std::string name, bool is_memory_sampled = true)
+            : is_memory_sampled(is_memory_sampled)
+        {
+            start(std::move(name));
+        }
+
+        ~StartupTimer()
+        {
+            stop();
+        }
+
+        StartupTimer(const StartupTimer&) = delete;
+        StartupTimer& operator=(const StartupTimer&) = delete;
+
+        /** End the current phase, if one is being timed, and start timing another. */
+        void next(std::string name)
+        {
+            stop();
+            start(std::move(name));
+        }
+
+        /** End the current phase, if one is being timed. */
+        void stop()
+        {
+            if (!is_running) {
+                return;
+            }
+            double seconds = std::chrono::duration<double>(clock::now() - start_time).count();
+            double memory_mb = is_memory_sampled ? StartupProfile::get_resident_memory_mb() - start_memory_mb : 0.0;
+            StartupProfile::record(name, seconds, memory_mb, is_memory_sampled);
+            is_running = false;
+        }
+
+      private:
+
+        void start(std::string name)
+        {
+            this->name = std::move(name);
+            StartupProfile::declare(this->name);
+            start_memory_mb = is_memory_sampled ? StartupProfile::get_resident_memory_mb() : 0.0;
+            start_time = clock::now();
+            is_running = true;
+        }
+
+        std::string name;
+        const bool is_memory_sampled;
+        bool is_running = false;
+        double start_memory_mb = 0.0;
+        clock::time_point start_time;
+    };
+}
+
+#endif // NGEN_STARTUP_PROFILE_HPP
@@ -0,0 +1,179 @@
+#ifndef NGEN_STATE_STORE_HPP
+#define NGEN_STATE_STORE_HPP
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace utils
+{
+    /**
+     * @brief Saved model states kept in a memory mapped file, rather than in memory, each in its own numbered slot.
+     *
+     * The file is an unlinked temporary file in the given directory, so it is removed once the store is destroyed,
+     * however the process ends.  Each slot starts on a page of its own and keeps room for the largest state put in it,
+     * so a state of the same size is rewritten in place.  Writing a state starts writing its pages back to the file,
+     * and reading one drops its pages from the mapping, so the kernel may reclaim the memory of states that are not
+     * being used.
+     *
+     * All functions are safe to call from several threads at once.
+     */
+    class StateStore
+    {
+      public:
+
+        /**
+         * @brief Create an empty store.
+         *
+         * @param directory The directory of the store's file, which should be on a local disk.
+         * @throws std::runtime_error If the file cannot be created.
+         */
+        explicit StateStore(const std::string& directory)
+            : page_size(static_cast<std::size_t>(::sysconf(_SC_PAGESIZE)))
+        {
+            std::string path = (directory.empty() ? std::string(".") : directory) + "/ngen-states-XXXXXX";
+            fd = ::mkstemp(&path[0]);
+            if (fd < 0) {
+                throw std::runtime_error("StateStore: unable to create " + path + ": " + std::strerror(errno));
+            }
+            ::unlink(path.c_str());
+        }
+
+        ~StateStore()
+        {
+            if (memory != nullptr) {
+                ::munmap(memory, mapped_bytes);
+            }
+            ::close(fd);
+        }
+
+        StateStore(const StateStore&) = delete;
+        StateStore& operator=(const StateStore&) = delete;
+
+        /**
+         * @brief Write a state to a slot, replacing any state it had.
+         *
+         * @throws std::runtime_error If the file cannot be extended.
+         */
+        void put(std::size_t slot, const std::vector<char>& bytes)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (slot >= slots.size()) {
+                slots.resize(slot + 1);
+            }
+            Slot& s = slots[slot];
+            if (bytes.size() > s.capacity) {
+                // Taken from the end of the file; the room of the slot's smaller state is not reused
+                s.capacity = (bytes.size() + page_size - 1) / page_size * page_size;
+                s.offset = file_bytes;
+                reserve(file_bytes + s.capacity);
+            }
+            s.size = bytes.size();
+            s.is_set = true;
+            if (s.size > 0) {
+                std::memcpy(memory + s.offset, bytes.data(), s.size);
+                ::msync(memory + s.offset, s.size, MS_ASYNC);
+            }
+        }
+
+        /**
+         * @brief Read the state of a slot.
+         *
+         * @throws std::out_of_range If the slot has no state.
+         */
+        void get(std::size_t slot, std::vector<char>& bytes)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            const Slot& s = get_slot(slot);
+            bytes.assign(memory + s.offset, memory + s.offset + s.size);
+            if (s.size > 0) {
+                ::madvise(memory + s.offset, s.capacity, MADV_DONTNEED);
+            }
+        }
+
+        /** Start reading the state of a slot from the file, if it has one, so a later @ref get need not wait for it. */
+        void prefetch(std::size_t slot)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (slot < slots.size() && slots[slot].is_set && slots[slot].size > 0) {
+                ::madvise(memory + slots[slot].offset, slots[slot].capacity, MADV_WILLNEED);
+            }
+        }
+
+        /** @return Whether a slot has a state. */
+        bool contains(std::size_t slot) const
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return slot < slots.size() && slots[slot].is_set;
+        }
+
+        /** @return The size of the store's file. */
+        std::size_t get_file_size() const
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return file_bytes;
+        }
+
+      private:
+
+        struct Slot
+        {
+            std::size_t offset = 0;
+            std::size_t size = 0;
+            std::size_t capacity = 0;
+            bool is_set = false;
+        };
+
+        const Slot& get_slot(std::size_t slot) const
+        {
+            if (slot >= slots.size() || !slots[slot].is_set) {
+                throw std::out_of_range("StateStore: slot " + std::to_string(slot) + " has no state");
+            }
+            return slots[slot];
+        }
+
+        /** Extend the file to a size, mapping it again, larger, if it has outgrown the mapping. */
+        void reserve(std::size_t bytes)
+        {
+            if (::ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+                throw std::runtime_error(std::string("StateStore: unable to extend the store's file: ")
+                                         + std::strerror(errno));
+            }
+            file_bytes = bytes;
+            if (bytes <= mapped_bytes) {
+                return;
+            }
+            std::size_t map_bytes = std::max(bytes, 2 * mapped_bytes);
+            void* mapped = ::mmap(nullptr, map_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (mapped == MAP_FAILED) {
+                throw std::runtime_error(std::string("StateStore: unable to map the store's file: ")
+                                         + std::strerror(errno));
+            }
+            if (memory != nullptr) {
+                ::munmap(memory, mapped_bytes);
+            }
+            memory = static_cast<char*>(mapped);
+            mapped_bytes = map_bytes;
+        }
+
+        const std::size_t page_size;
+        int fd = -1;
+        /** The mapping of the file, which may extend past its end, up to where the file grows next. */
+        char* memory = nullptr;
+        std::size_t mapped_bytes = 0;
+        std::size_t file_bytes = 0;
+        std::vector<Slot> slots;
+        mutable std::mutex mutex;
+    };
+}
+
+#endif // NGEN_STATE_STORE_HPP
@@ -0,0 +1,103 @@
+#ifndef NGEN_STATUS_DUMP_HPP
+#define NGEN_STATUS_DUMP_HPP
+
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <ostream>
+#include <string>
+
+namespace utils
+{
+    /**
+     * @brief Writes a report of where a running process is, when asked to with a signal, without stopping it.
+     *
+     * Once @ref install is called, sending the process ``SIGUSR1`` (e.g. ``kill -USR1 <pid>``, or a batch scheduler's
+     * signal to every task of a job) only sets a flag: nothing is written from the signal handler itself.  The run
+     * checks @ref take_request at its safe points, e.g. once per time step, and when it is set writes its state with
+     * @ref write, so a slow or stuck rank can be told apart from the others without attaching a debugger.
+     *
+     * @code {.cpp}
+     * utils::StatusDump::install();
+     * for (int t = 0; t < steps; ++t) {
+     *     run_time_step(t);
+     *     if (utils::StatusDump::take_request()) {
+     *         utils::StatusDump::write("./ngen_status.txt", [&](std::ostream& out) { out << "completed_steps " << t + 1; });
+     *     }
+     * }
+     * @endcode
+     */
+    class StatusDump
+    {
+      public:
+
+        /**
+         * @brief Handle ``SIGUSR1`` by requesting a report, where the platform has the signal.
+         *
+         * @return Whether the handler was installed.
+         */
+        static bool install()
+        {
+            #ifdef SIGUSR1
+            return std::signal(SIGUSR1, &StatusDump::handle) != SIG_ERR;
+            #else
+            return false;
+            #endif
+        }
+
+        /** @return Whether a report was requested since the last call, clearing the request. */
+        static bool take_request()
+        {
+            return requested().load(std::memory_order_relaxed) && requested().exchange(false);
+        }
+
+        /** Request a report, as the signal does. */
+        static void request()
+        {
+            requested().store(true);
+        }
+
+        /**
+         * @brief Write a report, replacing any earlier one at @p path only once it is complete.
+         *
+         * The report is written to a temporary file beside @p path that is then renamed to it, so a reader never sees
+         * one partly written.
+         *
+         * @param path The path of the report.
+         * @param body Writes the content of the report to the stream it is given.
+         * @return Whether the report was written.
+         */
+        static bool write(const std::string& path, const std::function<void(std::ostream&)>& body)
+        {
+            const std::string partial_path = path + ".tmp";
+            {
+                std::ofstream out(partial_path, std::ios::trunc);
+                body(out);
+                out.flush();
+                if (!out) {
+                    std::remove(partial_path.c_str());
+                    return false;
+                }
+            }
+            return std::rename(partial_path.c_str(), path.c_str()) == 0;
+        }
+
+      private:
+
+        static std::atomic<bool>& requested()
+        {
+            // A lock-free atomic, so it may be set from the signal handler
+            static std::atomic<bool> flag(false);
+            return flag;
+        }
+
+        static void handle(int)
+        {
+            requested().store(true);
+        }
+    };
+}
+
+#endif //NGEN_STATUS_DUMP_HPP
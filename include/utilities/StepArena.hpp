@@ -0,0 +1,215 @@
+#ifndef NGEN_STEP_ARENA_HPP
+#define NGEN_STEP_ARENA_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace utils
+{
+    /**
+     * @brief A per thread bump allocator for the transient allocations of a time step, e.g., the scratch arrays of a
+     * batched forcing read, which are all released at once when the step ends.
+     *
+     * Allocating is a pointer increment into a block the thread already holds, with no lock and no call into the
+     * global allocator, so threads running catchments do not contend on the heap however many transient buffers they
+     * use.  Memory is taken from the arena only while a @ref Scope is active on the thread (e.g., around running one
+     * catchment for a time step); the outermost scope then resets the arena when it ends, keeping its blocks for the
+     * next step.  Outside of any scope, @ref ArenaAllocator falls back to the heap, so containers using it are safe
+     * anywhere.
+     *
+     * Memory taken from the arena must not be used after its scope ends.  Containers using @ref ArenaAllocator should
+     * therefore be locals of the scope, never members or return values that outlive it.
+     *
+     * @code {.cpp}
+     * utils::StepArena::Scope step;
+     * utils::arena_vector<size_t> positions(ids.size());
+     * @endcode
+     */
+    class StepArena
+    {
+      public:
+
+        /** Takes allocations from the arena while it lives, and resets the arena when the outermost one ends. */
+        class Scope
+        {
+          public:
+            Scope() { ++state().depth; }
+            ~Scope()
+            {
+                if (--state().depth == 0) {
+                    reset();
+                }
+            }
+
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+        };
+
+        /** @return Whether a @ref Scope is active on this thread. */
+        static bool is_active()
+        {
+            return state().depth > 0;
+        }
+
+        /**
+         * @brief Allocate from this thread's arena, adding a block if the current ones are full.
+         *
+         * @param bytes The size of the allocation.
+         * @param alignment The alignment of the allocation, a power of two no greater than that of ``max_align_t``.
+         */
+        static void* allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t))
+        {
+            State& s = state();
+            while (s.current < s.blocks.size()) {
+                Block& block = s.blocks[s.current];
+                std::size_t offset = (s.offset + alignment - 1) & ~(alignment - 1);
+                if (offset + bytes <= block.size) {
+                    s.offset = offset + bytes;
+                    return block.data.get() + offset;
+                }
+                ++s.current;
+                s.offset = 0;
+            }
+            std::size_t size = std::max(bytes, s.blocks.empty() ? std::size_t(64 * 1024) : 2 * s.blocks.back().size);
+            s.blocks.push_back(Block{std::unique_ptr<char[]>(new char[size]), size});
+            s.offset = bytes;
+            return s.blocks.back().data.get();
+        }
+
+        /**
+         * @brief Release an allocation, which only reclaims its memory before the reset if it was the latest, as when a
+         * vector grows or a temporary is freed right away.
+         */
+        static void deallocate(void* p, std::size_t bytes)
+        {
+            State& s = state();
+            if (s.current < s.blocks.size()) {
+                char* top = s.blocks[s.current].data.get() + s.offset;
+                if (static_cast<char*>(p) + bytes == top) {
+                    s.offset -= bytes;
+                }
+            }
+        }
+
+        /** @return Whether memory was allocated from this thread's arena. */
+        static bool owns(const void* p)
+        {
+            const char* c = static_cast<const char*>(p);
+            for (const Block& block : state().blocks) {
+                if (c >= block.data.get() && c < block.data.get() + block.size) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /**
+         * @brief Release everything allocated from this thread's arena.
+         *
+         * A step that needed more than one block leaves a single block as large as all of them, so later steps
+         * allocate from contiguous memory.
+         */
+        static void reset()
+        {
+            State& s = state();
+            if (s.blocks.size() > 1) {
+                std::size_t size = 0;
+                for (const Block& block : s.blocks) {
+                    size += block.size;
+                }
+                s.blocks.clear();
+                s.blocks.push_back(Block{std::unique_ptr<char[]>(new char[size]), size});
+            }
+            s.current = 0;
+            s.offset = 0;
+        }
+
+        /** @return The bytes held by this thread's arena. */
+        static std::size_t get_capacity()
+        {
+            std::size_t size = 0;
+            for (const Block& block : state().blocks) {
+                size += block.size;
+            }
+            return size;
+        }
+
+      private:
+
+        struct Block
+        {
+            std::unique_ptr<char[]> data;
+            std::size_t size;
+        };
+
+        struct State
+        {
+            std::vector<Block> blocks;
+            /** The block allocated from, and the offset of its first free byte. */
+            std::size_t current = 0;
+            std::size_t offset = 0;
+            int depth = 0;
+        };
+
+        static State& state()
+        {
+            static thread_local State s;
+            return s;
+        }
+    };
+
+    /**
+     * @brief An allocator of the thread's utils::StepArena while a step scope is active, and of the heap otherwise.
+     *
+     * Instances are stateless and interchangeable: memory is released to wherever it came from.
+     */
+    template<typename T>
+    class ArenaAllocator
+    {
+      public:
+
+        typedef T value_type;
+
+        ArenaAllocator() = default;
+
+        template<typename U>
+        ArenaAllocator(const ArenaAllocator<U>&) { }
+
+        T* allocate(std::size_t n)
+        {
+            if (StepArena::is_active()) {
+                return static_cast<T*>(StepArena::allocate(n * sizeof(T), alignof(T)));
+            }
+            return static_cast<T*>(::operator new(n * sizeof(T)));
+        }
+
+        void deallocate(T* p, std::size_t n)
+        {
+            if (StepArena::owns(p)) {
+                StepArena::deallocate(p, n * sizeof(T));
+            }
+            else {
+                ::operator delete(p);
+            }
+        }
+
+        template<typename U>
+        bool operator==(const ArenaAllocator<U>&) const { return true; }
+
+        template<typename U>
+        bool operator!=(const ArenaAllocator<U>&) const { return false; }
+    };
+
+    /** A vector for the transient values of a step; see utils::StepArena. */
+    template<typename T>
+    using arena_vector = std::vector<T, ArenaAllocator<T>>;
+
+    /** A string for the transient text of a step; see utils::StepArena. */
+    typedef std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>> arena_string;
+}
+
+#endif // NGEN_STEP_ARENA_HPP
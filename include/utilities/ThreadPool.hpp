@@ -0,0 +1,225 @@
+#ifndef NGEN_THREAD_POOL_HPP
+#define NGEN_THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace utils
+{
+    /**
+     * @brief A small, fixed size pool of worker threads for data parallel loops.
+     *
+     * The pool is intended for executing many independent, similarly sized work items (e.g., the catchment
+     * formulations for a single time step).  Work is handed out dynamically through a shared atomic index, so threads
+     * that finish cheap items early simply claim the next available ones.
+     *
+     * A pool created with a single thread spawns no workers at all, and @ref parallel_for runs every item in order on
+     * the calling thread.  This keeps the default, serial execution path identical to a plain loop.
+     *
+     * On Linux, the threads of a pool may be pinned each to one of the CPUs the process is allowed to run on, e.g.
+     * those of the NUMA domain an MPI launcher bound the process's rank to, so they keep their caches and local memory.
+     */
+    class ThreadPool
+    {
+        public:
+
+            /**
+             * @brief Construct a pool.
+             *
+             * @param num_threads Total number of threads participating in work, including the calling thread.  A value
+             *                    of ``0`` selects the number of CPUs the process may run on.
+             * @param pin_threads Whether to pin each thread, including the calling thread, to its own one of those
+             *                    CPUs, in turn; this has no effect other than on Linux.
+             */
+            explicit ThreadPool(std::size_t num_threads = 1, bool pin_threads = false)
+            {
+                std::vector<int> cpus = available_cpus();
+                if (num_threads == 0) {
+                    num_threads = cpus.empty() ? std::thread::hardware_concurrency() : cpus.size();
+                }
+                if (num_threads == 0) {
+                    num_threads = 1;
+                }
+                pin_threads = pin_threads && !cpus.empty();
+                if (pin_threads) {
+                    pin_current_thread(cpus[0]);
+                }
+                // The calling thread also does work, so only spawn the remainder
+                for (std::size_t i = 1; i < num_threads; ++i) {
+                    workers.emplace_back(&ThreadPool::worker_loop, this, pin_threads ? cpus[i % cpus.size()] : -1);
+                }
+            }
+
+            /**
+             * @return The CPUs the process may run on, or none if they cannot be determined.
+             */
+            static std::vector<int> available_cpus()
+            {
+                std::vector<int> cpus;
+                #ifdef __linux__
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+                    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                        if (CPU_ISSET(cpu, &set)) {
+                            cpus.push_back(cpu);
+                        }
+                    }
+                }
+                #endif
+                return cpus;
+            }
+
+            ThreadPool(const ThreadPool&) = delete;
+            ThreadPool& operator=(const ThreadPool&) = delete;
+
+            ~ThreadPool()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    shutting_down = true;
+                }
+                work_available.notify_all();
+                for (auto& worker : workers) {
+                    worker.join();
+                }
+            }
+
+            /**
+             * @return The number of threads participating in a @ref parallel_for, including the calling thread.
+             */
+            std::size_t size() const
+            {
+                return workers.size() + 1;
+            }
+
+            /**
+             * @brief Execute ``body(i)`` for every ``i`` in ``[0, count)``, blocking until all items complete.
+             *
+             * Items may execute in any order and concurrently, so ``body`` must be safe to invoke concurrently for
+             * distinct indices.  If any invocation throws, remaining unclaimed items are skipped, and the first
+             * exception is rethrown on the calling thread after all in-flight items finish.
+             *
+             * @param count The number of work items.
+             * @param body The work function, receiving the item index.
+             */
+            void parallel_for(std::size_t count, const std::function<void(std::size_t)>& body)
+            {
+                if (workers.empty() || count < 2) {
+                    for (std::size_t i = 0; i < count; ++i) {
+                        body(i);
+                    }
+                    return;
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    current_body = &body;
+                    item_count = count;
+                    next_item.store(0);
+                    first_error = nullptr;
+                    busy_workers = workers.size();
+                    ++generation;
+                }
+                work_available.notify_all();
+
+                // The caller participates rather than idling
+                run_items();
+
+                std::unique_lock<std::mutex> lock(mutex);
+                work_done.wait(lock, [this] { return busy_workers == 0; });
+                current_body = nullptr;
+                if (first_error) {
+                    std::exception_ptr error = first_error;
+                    first_error = nullptr;
+                    std::rethrow_exception(error);
+                }
+            }
+
+        private:
+
+            static void pin_current_thread(int cpu)
+            {
+                #ifdef __linux__
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                CPU_SET(cpu, &set);
+                // Pinning is only a placement hint, so a thread that can't be pinned just runs unpinned
+                pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+                #endif
+            }
+
+            /** @param cpu The CPU to pin the worker to, or ``-1`` to leave it unpinned. */
+            void worker_loop(int cpu)
+            {
+                if (cpu >= 0) {
+                    pin_current_thread(cpu);
+                }
+                std::size_t seen_generation = 0;
+                while (true) {
+                    {
+                        std::unique_lock<std::mutex> lock(mutex);
+                        work_available.wait(lock, [this, seen_generation] {
+                            return shutting_down || generation != seen_generation;
+                        });
+                        if (shutting_down) {
+                            return;
+                        }
+                        seen_generation = generation;
+                    }
+
+                    run_items();
+
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        --busy_workers;
+                    }
+                    work_done.notify_one();
+                }
+            }
+
+            void run_items()
+            {
+                std::size_t i;
+                while ((i = next_item.fetch_add(1)) < item_count) {
+                    try {
+                        (*current_body)(i);
+                    }
+                    catch (...) {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        if (!first_error) {
+                            first_error = std::current_exception();
+                        }
+                        // Stop handing out further items
+                        next_item.store(item_count);
+                    }
+                }
+            }
+
+            std::vector<std::thread> workers;
+            std::mutex mutex;
+            std::condition_variable work_available;
+            std::condition_variable work_done;
+
+            const std::function<void(std::size_t)>* current_body = nullptr;
+            std::size_t item_count = 0;
+            std::atomic<std::size_t> next_item{0};
+            std::size_t busy_workers = 0;
+            std::size_t generation = 0;
+            bool shutting_down = false;
+            std::exception_ptr first_error;
+    };
+}
+
+#endif // NGEN_THREAD_POOL_HPP
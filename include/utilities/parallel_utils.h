@@ -19,13 +19,29 @@
 #define NGEN_MPI_PROTOCOL_TAG 101
 #endif
 
+#ifndef NGEN_MPI_FILE_CHUNK_BYTES
+#define NGEN_MPI_FILE_CHUNK_BYTES (4 * 1024 * 1024)
+#endif
+
+#ifndef NGEN_MPI_SCATTER_BLOCK_BYTES
+#define NGEN_MPI_SCATTER_BLOCK_BYTES 4096
+#endif
+
+#include <climits>
+#include <cstdio>
 #include <cstring>
+#include <fstream>
+#include <functional>
+#include <istream>
 #include <mpi.h>
+#include <stdexcept>
+#include <streambuf>
 #include <string>
 #include <set>
-#ifdef ACTIVATE_PYTHON
-#include "python/HydrofabricSubsetter.hpp"
-#endif // ACTIVATE_PYTHON
+#include <vector>
+#include <FeatureBuilder.hpp>
+#include <FeatureCache.hpp>
+#include "core/Partition_Parser.hpp"
 
 using namespace std;
 
@@ -95,6 +111,39 @@ namespace parallel {
         return mpiSyncStatusAnd(status, mpi_rank, mpi_num_procs, "");
     }
 
+    /**
+     * Gather the values of every rank to rank 0, one rank's after another in rank order.
+     *
+     * The number of values of each rank is gathered first, so rank 0 can size its buffer and place each rank's values.
+     * It is expected all ranks run this function at the same time.
+     *
+     * @param values The values of this rank.
+     * @param count The number of @p values.
+     * @param datatype The MPI datatype of the values.
+     * @param mpi_rank The current rank.
+     * @param mpi_num_procs The number of ranks.
+     * @param offsets Set, on rank 0, to the index of the first value of each rank followed by the total number of
+     *                values, so rank ``r`` has those from ``offsets[r]`` up to ``offsets[r + 1]``; emptied on the others.
+     * @return On rank 0, the values of every rank, and empty on the others.
+     */
+    template <typename T>
+    std::vector<T> gather_to_rank_zero(const T *values, int count, MPI_Datatype datatype, int mpi_rank,
+                                       int mpi_num_procs, std::vector<int> &offsets) {
+        std::vector<int> counts(mpi_rank == 0 ? mpi_num_procs : 0);
+        MPI_Gather(&count, 1, MPI_INT, counts.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
+        offsets.clear();
+        if (mpi_rank == 0) {
+            offsets.push_back(0);
+            for (int r = 0; r < mpi_num_procs; ++r) {
+                offsets.push_back(offsets.back() + counts[r]);
+            }
+        }
+        std::vector<T> gathered(offsets.empty() ? 0 : offsets.back());
+        MPI_Gatherv(values, count, datatype, gathered.data(), counts.data(), offsets.data(), datatype, 0,
+                    MPI_COMM_WORLD);
+        return gathered;
+    }
+
     /**
      * Check whether the parameter hydrofabric files have been subdivided into appropriate per partition files.
      *
@@ -231,27 +280,236 @@ namespace parallel {
     }
 
     /**
-     * Send the contents of a text file to another MPI rank.
+     * A read-only copy of the contents of a file, held in memory shared by the MPI ranks on each host.
+     *
+     * One leader rank per host reads the file into an MPI-3 shared memory window (``MPI_Win_allocate_shared``), which
+     * the other ranks on the host then read in place, so the file is read from storage, and held in memory, once per
+     * host rather than once per rank.  Ranks share memory with the ranks of the same host, as identified by
+     * ``MPI_Comm_split_type``, like the hosts of @ref get_hosts_array.
+     *
+     * Construction and destruction are collective over all ranks of the communicator.
+     */
+    class NodeSharedFile {
+    public:
+        /**
+         * @param fileName The file to read.
+         * @param comm The ranks reading the file.
+         * @throws std::runtime_error On every rank of a host, if the host's leader could not read the file.
+         */
+        NodeSharedFile(const std::string &fileName, MPI_Comm comm = MPI_COMM_WORLD) {
+            MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &node_comm);
+            int node_rank;
+            MPI_Comm_rank(node_comm, &node_rank);
+
+            // Only the leader opens the file, sharing its length, or -1 if it can't be opened
+            std::ifstream file;
+            long long length = -1;
+            if (node_rank == 0) {
+                file.open(fileName, std::ios::binary | std::ios::ate);
+                if (file) {
+                    length = file.tellg();
+                    file.seekg(0);
+                }
+            }
+            MPI_Bcast(&length, 1, MPI_LONG_LONG, 0, node_comm);
+            if (length < 0) {
+                MPI_Comm_free(&node_comm);
+                throw std::runtime_error("Unable to open " + fileName + " to share with the ranks of its host");
+            }
+
+            // All memory of the window belongs to the leader, while the other ranks allocate none of it
+            char *leader_base = nullptr;
+            MPI_Win_allocate_shared(node_rank == 0 ? (MPI_Aint) length : 0, 1, MPI_INFO_NULL, node_comm, &leader_base,
+                                    &window);
+            int readGood = 1;
+            if (node_rank == 0 && length > 0 && !file.read(leader_base, length)) {
+                readGood = 0;
+            }
+            // Completes only once the leader has filled the window
+            MPI_Bcast(&readGood, 1, MPI_INT, 0, node_comm);
+            if (!readGood) {
+                MPI_Win_free(&window);
+                MPI_Comm_free(&node_comm);
+                throw std::runtime_error("Unable to read " + fileName + " to share with the ranks of its host");
+            }
+
+            MPI_Aint segment_size;
+            int displacement_unit;
+            MPI_Win_shared_query(window, 0, &segment_size, &displacement_unit, &base);
+            file_size = length;
+        }
+
+        ~NodeSharedFile() {
+            MPI_Win_free(&window);
+            MPI_Comm_free(&node_comm);
+        }
+
+        NodeSharedFile(const NodeSharedFile &) = delete;
+        NodeSharedFile &operator=(const NodeSharedFile &) = delete;
+
+        /** @return The contents of the file, which must not be modified. */
+        const char *data() const {
+            return base;
+        }
+
+        /** @return The size of the file, in bytes. */
+        size_t size() const {
+            return file_size;
+        }
+
+        /** A stream of the contents of a @ref NodeSharedFile, which must outlive it. */
+        class Stream : public std::istream {
+        public:
+            explicit Stream(const NodeSharedFile &file) : std::istream(nullptr), contents(file.data(), file.size()) {
+                rdbuf(&contents);
+            }
+
+        private:
+            class ContentsBuffer : public std::streambuf {
+            public:
+                ContentsBuffer(const char *begin, size_t size) {
+                    char *start = const_cast<char *>(begin);
+                    setg(start, start, start + size);
+                }
+            };
+
+            ContentsBuffer contents;
+        };
+
+    private:
+        MPI_Comm node_comm;
+        MPI_Win window;
+        char *base = nullptr;
+        size_t file_size = 0;
+    };
+
+    /**
+     * Load the features of a hydrofabric file for the partition of every rank, parsing the file on only one rank.
      *
-     * Note that the file is read with ``fgets``.
+     * The root rank reads the whole file, with @p read, and scatters the features of each rank's partition to it
+     * (``MPI_Scatterv``) in the compact binary form of geojson::serialize_features, from which every rank, the root
+     * included, then loads its own.  The file is read from storage and parsed once, rather than once by every rank,
+     * for the cost of sending each rank its features.  The root holds the whole collection, and then the
+     * serialization of every partition, while it scatters them.
      *
-     * @param fileName The text file to read and send its contents.
+     * Partitions are sent in blocks of ``NGEN_MPI_SCATTER_BLOCK_BYTES`` bytes, so that they, and their total, may be
+     * larger than an ``int`` count of bytes can address.
+     *
+     * Collective over all ranks of the communicator.
+     *
+     * @param read Reads the whole file; only called on @p root.
+     * @param ids_of_rank The ids of the features of a rank's partition, where none stands for every feature, as for
+     *                    geojson::read; only called on @p root.
+     * @param include_geometry Whether to send the geometries of the features.
+     * @param fileName The file, for messages.
+     * @param root The rank that reads the file.
+     * @param comm The ranks loading the file.
+     * @return The features of this rank's partition.
+     * @throws std::runtime_error On every rank, if the root could not read the file, or a rank could not load its
+     *                            features.
+     */
+    geojson::GeoJSON scatter_hydrofabric_file(const std::function<geojson::GeoJSON()> &read,
+                                              const std::function<std::vector<std::string>(int)> &ids_of_rank,
+                                              bool include_geometry, const std::string &fileName, int root = 0,
+                                              MPI_Comm comm = MPI_COMM_WORLD) {
+        int rank, num_procs;
+        MPI_Comm_rank(comm, &rank);
+        MPI_Comm_size(comm, &num_procs);
+        const std::size_t block_bytes = NGEN_MPI_SCATTER_BLOCK_BYTES;
+
+        // The root serializes each partition in turn into its blocks of the one send buffer
+        std::vector<char> send_buffer;
+        std::vector<unsigned long long> byte_counts;
+        std::vector<int> block_counts;
+        std::vector<int> block_displacements;
+        std::string error;
+        if (rank == root) {
+            try {
+                byte_counts.resize(num_procs);
+                block_counts.resize(num_procs);
+                block_displacements.resize(num_procs);
+                geojson::GeoJSON whole = read();
+                std::size_t blocks = 0;
+                for (int i = 0; i < num_procs; ++i) {
+                    std::vector<std::string> ids = ids_of_rank(i);
+                    std::string features = ids.empty()
+                            ? geojson::serialize_features(*whole, include_geometry)
+                            : geojson::serialize_features(geojson::FeatureCollection(*whole, ids), include_geometry);
+                    std::size_t rank_blocks = (features.size() + block_bytes - 1) / block_bytes;
+                    if (blocks + rank_blocks > (std::size_t) INT_MAX) {
+                        throw std::runtime_error("The partitions of " + fileName + " are too large to scatter");
+                    }
+                    byte_counts[i] = features.size();
+                    block_counts[i] = (int) rank_blocks;
+                    block_displacements[i] = (int) blocks;
+                    send_buffer.resize((blocks + rank_blocks) * block_bytes);
+                    std::memcpy(send_buffer.data() + blocks * block_bytes, features.data(), features.size());
+                    blocks += rank_blocks;
+                }
+            }
+            catch (const std::exception &e) {
+                error = e.what();
+            }
+        }
+        int readGood = error.empty();
+        MPI_Bcast(&readGood, 1, MPI_INT, root, comm);
+        if (!readGood) {
+            throw std::runtime_error(rank == root ? error : "Rank " + std::to_string(root) + " was unable to read "
+                                                            + fileName + " to scatter its partitions");
+        }
+
+        unsigned long long rank_bytes = 0;
+        MPI_Scatter(byte_counts.data(), 1, MPI_UNSIGNED_LONG_LONG, &rank_bytes, 1, MPI_UNSIGNED_LONG_LONG, root, comm);
+        int rank_blocks = (int) ((rank_bytes + block_bytes - 1) / block_bytes);
+        std::vector<char> receive_buffer((std::size_t) rank_blocks * block_bytes);
+        MPI_Datatype block_type;
+        MPI_Type_contiguous((int) block_bytes, MPI_BYTE, &block_type);
+        MPI_Type_commit(&block_type);
+        MPI_Scatterv(send_buffer.data(), block_counts.data(), block_displacements.data(), block_type,
+                     receive_buffer.data(), rank_blocks, block_type, root, comm);
+        MPI_Type_free(&block_type);
+        std::vector<char>().swap(send_buffer);
+
+        geojson::GeoJSON features;
+        try {
+            features = geojson::deserialize_features(receive_buffer.data(), rank_bytes);
+        }
+        catch (const std::exception &e) {
+            error = e.what();
+        }
+        int loadGood = error.empty();
+        MPI_Allreduce(MPI_IN_PLACE, &loadGood, 1, MPI_INT, MPI_MIN, comm);
+        if (!loadGood) {
+            throw std::runtime_error(!error.empty() ? error : "Another rank was unable to load its partition of "
+                                                               + fileName);
+        }
+        return features;
+    }
+
+    /**
+     * Send the contents of a file to another MPI rank.
+     *
+     * After one handshake, in which the receiving rank confirms it could open its file, the contents are streamed in
+     * chunks of up to ``NGEN_MPI_FILE_CHUNK_BYTES`` bytes with no further round trips.  Two buffers are used, so the
+     * next chunk is read from the file while the last is still being sent.  Each chunk message holds exactly the bytes
+     * read, and the first chunk shorter than the buffer, which may be empty, ends the file.  The receiving rank then
+     * reports whether it wrote everything.
+     *
+     * @param fileName The file to read and send its contents.
      * @param mpi_rank The current MPI rank.
      * @param destRank The MPI rank to which the file data should be sent.
      * @return Whether sending was successful.
+     * @see mpi_recv_text_file
      */
     bool mpi_send_text_file(const char *fileName, const int mpi_rank, const int destRank) {
-        int bufSize = 4096;
-        char buf[bufSize];
+        int bufSize = NGEN_MPI_FILE_CHUNK_BYTES;
         int code;
-        // How much has been transferred so far
-        int totalNumTransferred = 0;
 
-        FILE *file = fopen(fileName, "r");
+        FILE *file = fopen(fileName, "rb");
 
         // Transmit error code instead of expected size and return false if file can't be opened
         if (file == NULL) {
-            // TODO: output error message
+            std::cerr << "Unable to open " << fileName << " to send to rank " << destRank << std::endl;
             code = -1;
             MPI_Send(&code, 1, MPI_INT, destRank, NGEN_MPI_PROTOCOL_TAG, MPI_COMM_WORLD);
             return false;
@@ -263,64 +521,66 @@ namespace parallel {
         // Then get back expected size to infer other side is good to go
         MPI_Recv(&code, 1, MPI_INT, destRank, NGEN_MPI_PROTOCOL_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
         if (code != bufSize) {
-            // TODO: output error message
             fclose(file);
             return false;
         }
-        int continueCode = 1;
-        // Then while there is more of the file to read and send, read the next batch and ...
-        while (fgets(buf, bufSize, file) != NULL) {
-            // Indicate we are ready to continue sending data
-            MPI_Send(&continueCode, 1, MPI_INT, destRank, NGEN_MPI_PROTOCOL_TAG, MPI_COMM_WORLD);
-
-            // Send this batch
-            MPI_Send(buf, bufSize, MPI_CHAR, destRank, NGEN_MPI_DATA_TAG, MPI_COMM_WORLD);
-
-            // Then get back a code, which will be -1 if bad and need to exit and otherwise good
-            MPI_Recv(&code, 1, MPI_INT, destRank, NGEN_MPI_PROTOCOL_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-            if (code < 0) {
-                // TODO: output error message
-                fclose(file);
-                return false;
+
+        std::vector<char> buffers[2] = {std::vector<char>(bufSize), std::vector<char>(bufSize)};
+        MPI_Request requests[2] = {MPI_REQUEST_NULL, MPI_REQUEST_NULL};
+        int current = 0;
+        size_t numRead;
+        bool readGood = true;
+        do {
+            // The buffer's last chunk must be sent before the buffer is refilled
+            MPI_Wait(&requests[current], MPI_STATUS_IGNORE);
+            numRead = fread(buffers[current].data(), 1, bufSize, file);
+            if (numRead < (size_t)bufSize && ferror(file)) {
+                // End the transfer early; the receiving side's copy is then incomplete, so this is a failure
+                std::cerr << "Unable to read " << fileName << " to send to rank " << destRank << std::endl;
+                readGood = false;
+                numRead = 0;
             }
-        }
-        // Once there is no more file to read and send, we should stop continuing
-        continueCode = 0;
-        MPI_Send(&continueCode, 1, MPI_INT, destRank, NGEN_MPI_PROTOCOL_TAG, MPI_COMM_WORLD);
-        // Expect to get back a code of 0
-        MPI_Recv(&code, 1, MPI_INT, destRank, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+            MPI_Isend(buffers[current].data(), (int)numRead, MPI_CHAR, destRank, NGEN_MPI_DATA_TAG, MPI_COMM_WORLD,
+                      &requests[current]);
+            current = 1 - current;
+        } while (numRead == (size_t)bufSize);
+        MPI_Waitall(2, requests, MPI_STATUSES_IGNORE);
         fclose(file);
-        return code == 0;
+
+        // Expect to get back a code of 0 once everything is written
+        MPI_Recv(&code, 1, MPI_INT, destRank, NGEN_MPI_PROTOCOL_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        return readGood && code == 0;
     }
 
     /**
-     * Receive text data from another MPI rank and write the contents to a text file.
+     * Receive the contents of a file from another MPI rank and write them to a file.
      *
      * Files are created if necessary and will be overwritten if they exist.
      *
-     * Note that the file is written with ``fputs``.
+     * The receive of the next chunk is posted before the last one is written, so writing overlaps the transfer.  If a
+     * write fails, the rest of the chunks are still received, so the sending rank can finish, but not written.
      *
-     * @param fileName The text file to which data should be written.
+     * @param fileName The file to which data should be written.
      * @param mpi_rank The current MPI rank.
-     * @param destRank The MPI rank to which the file data should be sent.
-     * @return Whether sending was successful.
+     * @param srcRank The MPI rank from which the file data is sent.
+     * @return Whether receiving was successful.
+     * @see mpi_send_text_file
      */
     bool mpi_recv_text_file(const char *fileName, const int mpi_rank, const int srcRank) {
-        int bufSize, writeCode;
+        int bufSize;
         // Receive expected buffer size to start
         MPI_Recv(&bufSize, 1, MPI_INT, srcRank, NGEN_MPI_PROTOCOL_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
 
         // If the sending side couldn't open the file, then immediately return false
-        if (bufSize == -1) {
-            // TODO: output error
+        if (bufSize <= 0) {
             return false;
         }
 
         // Try to open recv file ...
-        FILE *file = fopen(fileName, "w");
+        FILE *file = fopen(fileName, "wb");
         // ... and let sending size know whether this was successful by sending error code if not ...
         if (file == NULL) {
-            // TODO: output error message
+            std::cerr << "Unable to open " << fileName << " to receive from rank " << srcRank << std::endl;
             bufSize = -1;
             MPI_Send(&bufSize, 1, MPI_INT, srcRank, NGEN_MPI_PROTOCOL_TAG, MPI_COMM_WORLD);
             return false;
@@ -329,32 +589,39 @@ namespace parallel {
         // Send back the received buffer it if file opened, confirming things are good to go for transfer
         MPI_Send(&bufSize, 1, MPI_INT, srcRank, NGEN_MPI_PROTOCOL_TAG, MPI_COMM_WORLD);
 
-        // How much has been transferred so far
-        int totalNumTransferred = 0;
-        char buf[bufSize];
-
-        int continueCode;
-
+        std::vector<char> buffers[2] = {std::vector<char>(bufSize), std::vector<char>(bufSize)};
+        MPI_Request requests[2];
+        int current = 0;
+        int count;
+        bool writeGood = true;
+        MPI_Irecv(buffers[current].data(), bufSize, MPI_CHAR, srcRank, NGEN_MPI_DATA_TAG, MPI_COMM_WORLD,
+                  &requests[current]);
         while (true) {
-            // Make sure the other side wants to continue sending data
-            MPI_Recv(&continueCode, 1, MPI_INT, srcRank, NGEN_MPI_PROTOCOL_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-            if (continueCode <= 0)
+            MPI_Status status;
+            MPI_Wait(&requests[current], &status);
+            MPI_Get_count(&status, MPI_CHAR, &count);
+            // A chunk shorter than the buffer is the last one
+            bool isLast = count < bufSize;
+            if (!isLast) {
+                MPI_Irecv(buffers[1 - current].data(), bufSize, MPI_CHAR, srcRank, NGEN_MPI_DATA_TAG, MPI_COMM_WORLD,
+                          &requests[1 - current]);
+            }
+            if (writeGood && count > 0) {
+                writeGood = fwrite(buffers[current].data(), 1, count, file) == (size_t)count;
+            }
+            if (isLast) {
                 break;
-
-            MPI_Recv(buf, bufSize, MPI_CHAR, srcRank, NGEN_MPI_DATA_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-
-            writeCode = fputs(buf, file);
-            MPI_Send(&writeCode, 1, MPI_INT, srcRank, NGEN_MPI_PROTOCOL_TAG, MPI_COMM_WORLD);
-
-            if (writeCode < 0) {
-                fclose(file);
-                return false;
             }
+            current = 1 - current;
         }
 
-        fclose(file);
-        MPI_Send(&continueCode, 1, MPI_INT, srcRank, NGEN_MPI_PROTOCOL_TAG, MPI_COMM_WORLD);
-        return true;
+        writeGood = fclose(file) == 0 && writeGood;
+        if (!writeGood) {
+            std::cerr << "Unable to write " << fileName << " received from rank " << srcRank << std::endl;
+        }
+        int code = writeGood ? 0 : -1;
+        MPI_Send(&code, 1, MPI_INT, srcRank, NGEN_MPI_PROTOCOL_TAG, MPI_COMM_WORLD);
+        return writeGood;
     }
 
 
@@ -455,6 +722,44 @@ namespace parallel {
     }
 
 
+    /**
+     * Write the features of a hydrofabric file with the given ids to a file of their own.
+     *
+     * The file is written under a temporary name and then renamed, so an interrupted write never leaves a file that
+     * @ref is_hydrofabric_subdivided would take as complete.
+     *
+     * @param sourceFile The path of the whole hydrofabric file.
+     * @param subsetFile The path of the file to write.
+     * @param ids The ids of the features to write.
+     * @return Whether the file was written.
+     */
+    bool write_hydrofabric_subset(const std::string &sourceFile, const std::string &subsetFile,
+                                  const std::unordered_set<std::string> &ids)
+    {
+        std::string partialFile = subsetFile + ".partial";
+        try {
+            std::ifstream in(sourceFile, std::ios::binary);
+            std::ofstream out(partialFile, std::ios::binary | std::ios::trunc);
+            if (!in || !out) {
+                std::cerr << "Unable to open " << (in ? partialFile : sourceFile) << " to subdivide the hydrofabric" << std::endl;
+                return false;
+            }
+            geojson::write_subset(in, out, ids, sourceFile);
+            out.close();
+            if (!out) {
+                std::cerr << "Unable to write " << partialFile << std::endl;
+                std::remove(partialFile.c_str());
+                return false;
+            }
+        }
+        catch (const std::exception &e) {
+            std::cerr << e.what() << std::endl;
+            std::remove(partialFile.c_str());
+            return false;
+        }
+        return std::rename(partialFile.c_str(), subsetFile.c_str()) == 0;
+    }
+
     /**
      * Attempt to subdivide the passed hydrofabric files into a series of per-partition files.
      *
@@ -462,6 +767,11 @@ namespace parallel {
      * and associated files.  As a result, if there are any other subdivided hydrofabric files present having the same
      * names as the files the function will write, then those preexisting files are considered stale and overwritten.
      *
+     * Every rank writes the files of its own partition, in parallel with the others, from one streaming pass over
+     * each of the whole hydrofabric files, which the driver has already checked every rank can read.  Only the ids of
+     * the features are parsed; the text of each feature of the partition is copied out as is.  Since each rank writes
+     * just its own files where it will read them, no files are written for, or transferred to, other ranks.
+     *
      * @param mpi_rank The rank of the current process.
      * @param mpi_num_procs The total number of MPI processes.
      * @param catchmentDataFile The path to the catchment data file for the hydrofabric.
@@ -472,67 +782,33 @@ namespace parallel {
     bool subdivide_hydrofabric(int mpi_rank, int mpi_num_procs, const string &catchmentDataFile,
                                const string &nexusDataFile, const string &partitionConfigFile)
     {
-        // Track whether things are good, meaning ok to continue and, at the end, whether successful
-        // Start with a value of true
         bool isGood = true;
-
-        #ifndef ACTIVATE_PYTHON
-        // We can't be good to proceed with this, because Python is not active
-        isGood = false;
-        std::cerr << "Driver is unable to perform required hydrofabric subdividing when Python integration is not active." << std::endl;
-
-
-        // Sync with the rest of the ranks and bail if any aren't ready to proceed for any reason
-        if (!mpiSyncStatusAnd(isGood, mpi_rank, mpi_num_procs, "initializing hydrofabric subdivider")) {
-            return false;
-        }
-        #else // i.e., #ifdef ACTIVATE_PYTHON
-        // Have rank 0 handle the generation task for all files/partitions
-        std::unique_ptr<utils::ngenPy::HydrofabricSubsetter> subdivider;
-        // Have rank 0 handle the generation task for all files/partitions
-        if (mpi_rank == 0) {
-            try {
-                subdivider = std::make_unique<utils::ngenPy::HydrofabricSubsetter>(catchmentDataFile, nexusDataFile,
-                                                                                   partitionConfigFile);
-            }
-            catch (const std::exception &e) {
-                std::cerr << e.what() << std::endl;
-                // Set not good if the subdivider object couldn't be instantiated
+        PartitionData local_data;
+        try {
+            Partitions_Parser partition_parser(partitionConfigFile);
+            if (partition_parser.get_num_partitions() != mpi_num_procs) {
+                std::cerr << "Partition config " << partitionConfigFile << " has " << partition_parser.get_num_partitions()
+                          << " partitions, but there are " << mpi_num_procs << " processes" << std::endl;
                 isGood = false;
             }
-        }
-        // Sync ranks and bail if any aren't ready to proceed for any reason
-        if (!mpiSyncStatusAnd(isGood, mpi_rank, mpi_num_procs, "initializing hydrofabric subdivider")) {
-            return false;
-        }
-
-        if (mpi_rank == 0) {
-            // Try to perform the subdividing
-            try {
-                isGood = subdivider->execSubdivision();
-            }
-            catch (const std::exception &e) {
-                std::cerr << e.what() << std::endl;
-                // Set not good if the subdivider object couldn't be instantiated
-                isGood = false;
+            else {
+                local_data = partition_parser.parse_partition(mpi_rank);
             }
         }
-        // Sync ranks again here on whether subdividing was successful, having them all exit at this point if not
-        if (!mpiSyncStatusAnd(isGood, mpi_rank, mpi_num_procs, "executing hydrofabric subdivision")) {
+        catch (const std::exception &e) {
+            std::cerr << e.what() << std::endl;
+            isGood = false;
+        }
+        // Sync ranks and bail if any aren't ready to proceed for any reason
+        if (!mpiSyncStatusAnd(isGood, mpi_rank, mpi_num_procs, "reading partitions to subdivide hydrofabric")) {
             return false;
         }
-        // But if the subdividing went fine ...
-        else {
-            // ... figure out what ranks are on hosts with each other by getting an id for host of each rank
-            int hostIdForRank[mpi_num_procs];
-            get_hosts_array(mpi_rank, mpi_num_procs, hostIdForRank);
-
-            // ... then (when necessary) transferring files around
-            return distribute_subdivided_hydrofabric_files(catchmentDataFile, nexusDataFile, 0, mpi_rank,
-                                                           mpi_num_procs, hostIdForRank, true, true);
 
-        }
-        #endif // ACTIVATE_PYTHON
+        isGood = write_hydrofabric_subset(catchmentDataFile, catchmentDataFile + "." + std::to_string(mpi_rank),
+                                          local_data.catchment_ids)
+                 && write_hydrofabric_subset(nexusDataFile, nexusDataFile + "." + std::to_string(mpi_rank),
+                                             local_data.nexus_ids);
+        return mpiSyncStatusAnd(isGood, mpi_rank, mpi_num_procs, "executing hydrofabric subdivision");
     }
 }
 
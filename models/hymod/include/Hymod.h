@@ -4,7 +4,7 @@
 #include <cmath>
 #include <vector>
 #include "HymodErrorCodes.h"
-#include "reservoir/Reservoir.hpp"
+#include "reservoir/Reservoir_Inline.hpp"
 #include "Pdm03.h"
 #include "hymod_params.h"
 #include "hymod_state.h"
@@ -39,18 +39,11 @@ class hymod_kernel
         void* et_params)            //!< parameters for the et function
     {
 
-        // initalize the Nash cascade of reservoirs
-        std::vector<Reservoir::Explicit_Time::Reservoir> nash_cascade;
-
-        nash_cascade.resize(params.n);
-        for ( unsigned long i = 0; i < nash_cascade.size(); ++i )
-        {
-            //construct a single linear outlet reservoir
-            nash_cascade[i] = Reservoir::Explicit_Time::Reservoir(params.min_storage_meters, params.nash_max_storage_meters, state.Sr[i], params.Kq, params.activation_threshold_meters_nash_cascade_reservoir, params.reservoir_max_velocity_meters_per_second);
-        }
+        typedef Reservoir::Explicit_Time::Inline_Reservoir<Reservoir::Explicit_Time::Inline_Linear_Outlet> linear_reservoir;
 
         // initalize groundwater linear outlet reservoir
-        Reservoir::Explicit_Time::Reservoir groundwater(params.min_storage_meters, params.gw_max_storage_meters, state.groundwater_storage_meters, params.Ks, params.activation_threshold_meters_groundwater_reservoir, params.reservoir_max_velocity_meters_per_second);
+        linear_reservoir groundwater(params.min_storage_meters, params.gw_max_storage_meters, state.groundwater_storage_meters,
+                                     Reservoir::Explicit_Time::Inline_Linear_Outlet(params.Ks, params.activation_threshold_meters_groundwater_reservoir, params.reservoir_max_velocity_meters_per_second));
 
         // add flux to the current state
         state.storage_meters += input_flux_meters;
@@ -75,13 +68,19 @@ class hymod_kernel
         runoff_meters_per_second += groundwater_excess_meters / dt;
 
         // cycle through Quickflow Nash cascade of reservoirs
-        for(unsigned long int i = 0; i < nash_cascade.size(); ++i)
+        for(int i = 0; i < params.n; ++i)
         {
+            //construct a single linear outlet reservoir
+            linear_reservoir nash_reservoir(params.min_storage_meters, params.nash_max_storage_meters, state.Sr[i],
+                                            Reservoir::Explicit_Time::Inline_Linear_Outlet(params.Kq, params.activation_threshold_meters_nash_cascade_reservoir, params.reservoir_max_velocity_meters_per_second));
+
             // get response water velocity of reservoir
-            runoff_meters_per_second = nash_cascade[i].response_meters_per_second(runoff_meters_per_second, dt, excess_water_meters);
+            runoff_meters_per_second = nash_reservoir.response_meters_per_second(runoff_meters_per_second, dt, excess_water_meters);
             
             //TODO: Review issues with dt and internal timestep
             runoff_meters_per_second += excess_water_meters / dt;
+
+            new_state.Sr[i] = nash_reservoir.get_storage_height_meters();
         }
 
         // record all fluxs
@@ -92,13 +91,59 @@ class hymod_kernel
         // update new state
         new_state.storage_meters = soil_m - et_meters;
         new_state.groundwater_storage_meters = groundwater.get_storage_height_meters();
-        for ( unsigned long i = 0; i < nash_cascade.size(); ++i )
+
+        return mass_check(params, state, new_state, fluxes, dt);
+
+    }
+
+    //! run one time step of hymod through a dry period, as a recession of its reservoirs
+    /*!
+        A cheap step for when no more than a negligible amount of water is in the soil or entering it: the input is
+        kept in the soil storage, without partitioning it or computing et, and the groundwater reservoir and the Nash
+        cascade drain with no inflow, through the same linear outlets as run().  With an empty soil and no input this
+        gives the same new state and fluxes as run(); otherwise water is conserved, and that held in the soil goes on
+        to the reservoirs once run() is used again.
+    */
+    static int run_recession(
+        double dt,
+        hymod_params params,        //!< static parameters for hymod
+        hymod_state state,          //!< model state
+        hymod_state& new_state,     //!< model state struct to hold new model state
+        hymod_fluxes& fluxes,       //!< model flux object to hold calculated fluxes
+        double input_flux_meters)          //!< the amount water entering the system this time step
+    {
+        typedef Reservoir::Explicit_Time::Inline_Reservoir<Reservoir::Explicit_Time::Inline_Linear_Outlet> linear_reservoir;
+
+        linear_reservoir groundwater(params.min_storage_meters, params.gw_max_storage_meters, state.groundwater_storage_meters,
+                                     Reservoir::Explicit_Time::Inline_Linear_Outlet(params.Ks, params.activation_threshold_meters_groundwater_reservoir, params.reservoir_max_velocity_meters_per_second));
+
+        state.storage_meters += input_flux_meters;
+
+        double groundwater_excess_meters;
+        double excess_water_meters;
+
+        double slow_flow_meters_per_second = groundwater.response_meters_per_second(0.0, dt, groundwater_excess_meters);
+        double runoff_meters_per_second = groundwater_excess_meters / dt;
+
+        for(int i = 0; i < params.n; ++i)
         {
-            new_state.Sr[i] = nash_cascade[i].get_storage_height_meters();
+            linear_reservoir nash_reservoir(params.min_storage_meters, params.nash_max_storage_meters, state.Sr[i],
+                                            Reservoir::Explicit_Time::Inline_Linear_Outlet(params.Kq, params.activation_threshold_meters_nash_cascade_reservoir, params.reservoir_max_velocity_meters_per_second));
+
+            runoff_meters_per_second = nash_reservoir.response_meters_per_second(runoff_meters_per_second, dt, excess_water_meters);
+            runoff_meters_per_second += excess_water_meters / dt;
+
+            new_state.Sr[i] = nash_reservoir.get_storage_height_meters();
         }
 
-        return mass_check(params, state, new_state, fluxes, dt);
+        fluxes.slow_flow_meters_per_second = slow_flow_meters_per_second;
+        fluxes.runoff_meters_per_second = runoff_meters_per_second;
+        fluxes.et_loss_meters = 0.0;
+
+        new_state.storage_meters = state.storage_meters;
+        new_state.groundwater_storage_meters = groundwater.get_storage_height_meters();
 
+        return mass_check(params, state, new_state, fluxes, dt);
     }
 
     static int mass_check(const hymod_params& params, const hymod_state& current_state, const hymod_state& next_state, const hymod_fluxes& calculated_fluxes, double timestep_seconds)
@@ -0,0 +1,111 @@
+#ifndef NGEN_HYMOD_BATCH_H
+#define NGEN_HYMOD_BATCH_H
+
+#include "Pdm03.h"
+#include "hymod_params.h"
+#include "hymod_state.h"
+#include "hymod_fluxes.h"
+#include <memory>
+#include <vector>
+
+/**
+ * The Hymod hydrological model run for many catchments at once.
+ *
+ * This computes exactly what @ref hymod_kernel::run does for each member catchment, but with the parameters, states
+ * and fluxes of every member in contiguous arrays (one element per member), rather than in per-catchment structs with
+ * separately allocated Nash cascade storage.  Each time step, each stage of the model (the storage function, the
+ * groundwater reservoir, and each reservoir of the quick flow Nash cascades) is one loop over all the members, written
+ * to be vectorized, with the PDM of the ET losses run for every member at once by runoff::batch::pdm03, followed by a
+ * mass check of the whole batch.  Unlike the inline reservoirs of @ref hymod_kernel, the reservoirs of the batch do not
+ * warn of storage above their maximum or of outlet velocities above their maximum.
+ *
+ * Members with a Nash cascade shorter than the longest in the batch skip the reservoirs they do not have.
+ */
+class hymod_batch {
+
+public:
+
+    /**
+     * Add a member catchment to the batch.
+     *
+     * @param params The parameters of the catchment.
+     * @param initial_state The initial state of the catchment, whose ``Sr`` has the storage of each of the ``params.n``
+     *                      reservoirs of its Nash cascade, or is null for a cascade starting empty.
+     * @return The member's index in the batch.
+     * @throws std::invalid_argument If @p params has a negative Nash cascade size.
+     */
+    std::size_t add_member(const hymod_params& params, const hymod_state& initial_state = hymod_state());
+
+    /**
+     * Run every member of the batch to the next time step.
+     *
+     * @param dt The time step size in seconds.
+     * @param input_storage_m The amount of water entering each member's system this time step, in meters.
+     * @param et_params The ET parameters struct of each member, whose outputs are set as @ref hymod_kernel::calc_et
+     *                  would set them.
+     * @return The number of members whose mass check failed.
+     */
+    std::size_t run(double dt, const std::vector<double>& input_storage_m,
+                    const std::vector<std::shared_ptr<pdm03_struct>>& et_params);
+
+    /** @return The number of members of the batch. */
+    std::size_t size() const;
+
+    /**
+     * Get the state of a member after its last time step; i.e., the ``new_state`` of @ref hymod_kernel::run.
+     *
+     * @param member The index of the member.
+     * @param nash_storage_m Set to the storage of each reservoir of the member's Nash cascade, as the backing storage
+     *                       of the returned state's ``Sr``.
+     */
+    hymod_state get_state(std::size_t member, std::vector<double>& nash_storage_m) const;
+
+    /**
+     * Get the fluxes of a member for its last time step; i.e., the ``fluxes`` of @ref hymod_kernel::run.
+     *
+     * @param member The index of the member.
+     */
+    hymod_fluxes get_fluxes(std::size_t member) const;
+
+    /**
+     * Get the result of the mass check of a member for its last time step.
+     *
+     * @param member The index of the member.
+     * @return The appropriate code value indicating whether mass was conserved, as from @ref hymod_kernel::run.
+     */
+    int get_mass_check_result(std::size_t member) const;
+
+private:
+
+    /** The size of the error bound that is acceptable when performing mass check calculations, as in hymod_kernel. */
+    static constexpr double mass_check_error_bound = 0.000001;
+
+    // Per member parameters
+    std::vector<double> min_storage_m;
+    std::vector<double> gw_max_storage_m;
+    std::vector<double> nash_max_storage_m;
+    std::vector<double> nash_activation_threshold_m;
+    std::vector<double> gw_activation_threshold_m;
+    std::vector<double> max_velocity_m_per_s;
+    std::vector<double> smax;
+    std::vector<double> a;
+    std::vector<double> b;
+    std::vector<double> Ks;
+    std::vector<double> Kq;
+    std::vector<int> n;
+
+    // Per member state
+    std::vector<double> storage_m;
+    std::vector<double> groundwater_storage_m;
+    /** For each reservoir of the Nash cascades, its storage in each member, or 0.0 if the member does not have it. */
+    std::vector<std::vector<double>> nash_storage_m;
+
+    // Per member fluxes
+    std::vector<double> slow_flow_m_per_s;
+    std::vector<double> runoff_m_per_s;
+    std::vector<double> et_loss_m;
+
+    std::vector<int> mass_check_results;
+};
+
+#endif //NGEN_HYMOD_BATCH_H
@@ -1,6 +1,7 @@
 #ifndef PDM03_H_INCLUDED
 #define PDM03_H_INCLUDED
 
+#include <algorithm>
 #include <cstdlib>
 #include <cmath>
 
@@ -0,0 +1,186 @@
+#ifndef RUNOFF_PARTITIONING_BATCH_H
+#define RUNOFF_PARTITIONING_BATCH_H
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#include "Pdm03.h"
+
+namespace runoff {
+    /**
+     * Runoff partitioning kernels for a block of catchments at once.
+     *
+     * These compute exactly what the single catchment functions (Schaake_partitioning_scheme_cpp and Pdm03) do, but
+     * over arrays with one element per catchment, and selecting results rather than branching per catchment, so that
+     * the loop over catchments is vectorized where the including translation unit is compiled with ``-fopenmp-simd``.
+     * The ``exp`` and ``pow`` calls of the loops are then to the vector variants of the math library where it declares
+     * them (e.g. glibc's libmvec, with ``-ffast-math``), and otherwise leave the loops scalar.
+     */
+    namespace batch {
+
+        #pragma omp declare target
+        /**
+         * Partition the water input of one catchment into surface runoff and infiltration, as
+         * Schaake_partitioning_scheme_cpp does, selecting rather than branching so that it can be called in loops to
+         * vectorize, or run on an offload device.
+         *
+         * @param timestep_d The time step size in days.
+         * @param schaake_constant The Schaake adjusted magic constant by soil type of the catchment.
+         * @param column_total_soil_moisture_deficit_m The soil moisture deficit of the catchment.
+         * @param water_input_depth_m The water input of the catchment this time step.
+         * @param surface_runoff_depth_m Set to the surface runoff of the catchment.
+         * @param infiltration_depth_m Set to the infiltration of the catchment.
+         */
+        inline void schaake_partition(double timestep_d, double schaake_constant,
+                                      double column_total_soil_moisture_deficit_m, double water_input_depth_m,
+                                      double &surface_runoff_depth_m, double &infiltration_depth_m)
+        {
+            // A negative water input is partitioned as none, with the denominator below kept nonzero for a catchment
+            // with neither input nor deficit, so every result is finite; catchments with a negative deficit have
+            // theirs selected after
+            double px = (0.0 < water_input_depth_m) ? water_input_depth_m : 0.0;
+            double deficit_m = column_total_soil_moisture_deficit_m;
+            // Schaake et al. Eqns. 34, 2, and 24
+            double ic = deficit_m * (1.0 - exp(-schaake_constant * timestep_d));
+            double px_plus_ic = px + ic;
+            px_plus_ic = (0.0 != px_plus_ic) ? px_plus_ic : 1.0;
+            double infiltration = px * (ic / px_plus_ic);
+            double runoff = (0.0 < (px - infiltration)) ? px - infiltration : 0.0;
+
+            runoff = (0.0 > deficit_m) ? px : runoff;
+            surface_runoff_depth_m = runoff;
+            infiltration_depth_m = px - runoff;
+        }
+        #pragma omp end declare target
+
+        /**
+         * Partition the water input of every catchment into surface runoff and infiltration, as
+         * Schaake_partitioning_scheme_cpp does.
+         *
+         * @param n The number of catchments.
+         * @param timestep_s The time step size in seconds, which all the catchments share.
+         * @param schaake_constant The Schaake adjusted magic constant by soil type of each catchment.
+         * @param column_total_soil_moisture_deficit_m The soil moisture deficit of each catchment.
+         * @param water_input_depth_m The water input of each catchment this time step.
+         * @param surface_runoff_depth_m Set to the surface runoff of each catchment.
+         * @param infiltration_depth_m Set to the infiltration of each catchment.
+         */
+        inline void schaake_partitioning_scheme(std::size_t n, double timestep_s, const double *schaake_constant,
+                                                const double *column_total_soil_moisture_deficit_m,
+                                                const double *water_input_depth_m, double *surface_runoff_depth_m,
+                                                double *infiltration_depth_m)
+        {
+            const double timestep_d = timestep_s / 86400.0;
+            #pragma omp simd
+            for (std::size_t i = 0; i < n; ++i) {
+                schaake_partition(timestep_d, schaake_constant[i], column_total_soil_moisture_deficit_m[i],
+                                  water_input_depth_m[i], surface_runoff_depth_m[i], infiltration_depth_m[i]);
+            }
+        }
+
+        /**
+         * The inputs, state, and outputs of the PDM of a block of catchments; each of the fields of pdm03_struct the
+         * PDM uses, per catchment.
+         */
+        struct pdm03_arrays {
+            std::vector<double> maximum_combined_contents;
+            std::vector<double> scaled_distribution_fn_shape_parameter;
+            std::vector<double> final_height_reservoir;
+            std::vector<double> max_height_soil_moisture_storerage_tank;
+            std::vector<double> total_effective_rainfall;
+            std::vector<double> actual_et;
+            std::vector<double> final_storage_upper_zone;
+            std::vector<double> precipitation;
+            std::vector<double> potential_et;
+            std::vector<double> vegetation_adjustment;
+
+            explicit pdm03_arrays(std::size_t n = 0) { resize(n); }
+
+            void resize(std::size_t n)
+            {
+                maximum_combined_contents.resize(n);
+                scaled_distribution_fn_shape_parameter.resize(n);
+                final_height_reservoir.resize(n);
+                max_height_soil_moisture_storerage_tank.resize(n);
+                total_effective_rainfall.resize(n);
+                actual_et.resize(n);
+                final_storage_upper_zone.resize(n);
+                precipitation.resize(n);
+                potential_et.resize(n);
+                vegetation_adjustment.resize(n);
+            }
+
+            std::size_t size() const { return final_height_reservoir.size(); }
+
+            /** Set the fields of a catchment from its struct. */
+            void set(std::size_t i, const pdm03_struct &pdm)
+            {
+                maximum_combined_contents[i] = pdm.maximum_combined_contents;
+                scaled_distribution_fn_shape_parameter[i] = pdm.scaled_distribution_fn_shape_parameter;
+                final_height_reservoir[i] = pdm.final_height_reservoir;
+                max_height_soil_moisture_storerage_tank[i] = pdm.max_height_soil_moisture_storerage_tank;
+                total_effective_rainfall[i] = pdm.total_effective_rainfall;
+                actual_et[i] = pdm.actual_et;
+                final_storage_upper_zone[i] = pdm.final_storage_upper_zone;
+                precipitation[i] = pdm.precipitation;
+                potential_et[i] = pdm.potential_et;
+                vegetation_adjustment[i] = pdm.vegetation_adjustment;
+            }
+
+            /** Set the outputs in the struct of a catchment, as pdm03_wrapper would. */
+            void get_outputs(std::size_t i, pdm03_struct &pdm) const
+            {
+                pdm.final_height_reservoir = final_height_reservoir[i];
+                pdm.total_effective_rainfall = total_effective_rainfall[i];
+                pdm.actual_et = actual_et[i];
+                pdm.final_storage_upper_zone = final_storage_upper_zone[i];
+            }
+        };
+
+        /**
+         * Run the PDM soil moisture accounting of every catchment, as Pdm03 does, replacing the final height of each
+         * reservoir and setting the outputs.
+         *
+         * @param pdm The PDM arrays of the catchments.
+         */
+        inline void pdm03(pdm03_arrays &pdm)
+        {
+            const std::size_t n = pdm.size();
+            const double *cpar = pdm.maximum_combined_contents.data();
+            const double *b = pdm.scaled_distribution_fn_shape_parameter.data();
+            const double *huz = pdm.max_height_soil_moisture_storerage_tank.data();
+            const double *precipitation = pdm.precipitation.data();
+            const double *potential_et = pdm.potential_et.data();
+            const double *kv = pdm.vegetation_adjustment.data();
+            double *xhuz = pdm.final_height_reservoir.data();
+            double *ov = pdm.total_effective_rainfall.data();
+            double *ae = pdm.actual_et.data();
+            double *xcuz = pdm.final_storage_upper_zone.data();
+
+            // As in Pdm03, with max(a, b) and min(a, b) selecting as std::max and std::min do
+            #pragma omp simd
+            for (std::size_t i = 0; i < n; ++i) {
+                double cbeg = cpar[i] * (1.0 - pow(1.0 - (xhuz[i] / huz[i]), 1.0 + b[i]));
+                double ov2 = precipitation[i] + xhuz[i] - huz[i];
+                ov2 = (0.0 < ov2) ? ov2 : 0.0;
+                double ppinf = precipitation[i] - ov2;
+                double hint = xhuz[i] + ppinf;
+                hint = (hint < huz[i]) ? hint : huz[i];
+                double cint = cpar[i] * (1.0 - pow(1.0 - (hint / huz[i]), 1.0 + b[i]));
+                double ov1 = ppinf + cbeg - cint;
+                ov1 = (0.0 < ov1) ? ov1 : 0.0;
+                ov[i] = ov1 + ov2;
+
+                double et = (cint / cpar[i]) * potential_et[i] * kv[i];
+                et = (et < cint) ? et : cint;
+                ae[i] = et;
+                double storage = cint - et;
+                storage = (0.0 < storage) ? storage : 0.0;
+                xcuz[i] = storage;
+                xhuz[i] = huz[i] * (1.0 - pow(1.0 - (storage / cpar[i]), 1.0 / (1.0 + b[i])));
+            }
+        }
+    }
+}
+
+#endif // RUNOFF_PARTITIONING_BATCH_H
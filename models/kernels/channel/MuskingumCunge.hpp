@@ -0,0 +1,140 @@
+#ifndef NGEN_MUSKINGUM_CUNGE_HPP
+#define NGEN_MUSKINGUM_CUNGE_HPP
+
+#include <algorithm>
+#include <cmath>
+
+namespace muskingum_cunge {
+
+    /**
+     * @brief Geometry and roughness of a trapezoidal channel reach.
+     *
+     * @var channel_params::length_m The length of the reach.
+     * @var channel_params::slope The bed slope, in m/m.
+     * @var channel_params::mannings_n Manning's roughness coefficient.
+     * @var channel_params::bottom_width_m The width of the channel bed.
+     * @var channel_params::side_slope The horizontal run of each bank per unit of rise (0 for a rectangular channel).
+     */
+    struct channel_params {
+        double length_m;
+        double slope;
+        double mannings_n;
+        double bottom_width_m;
+        double side_slope;
+    };
+
+    /** The smallest slope used, so that flat reaches still have a finite, positive celerity. */
+    const double MIN_SLOPE = 1.0e-5;
+
+    /** The smallest reference flow in m^3/s used to compute routing parameters, so that dry reaches stay defined. */
+    const double MIN_REFERENCE_FLOW = 1.0e-6;
+
+    /**
+     * @brief The normal depth of a flow in a channel, from Manning's equation.
+     *
+     * Solved with Newton's method, from the depth of a wide rectangular channel.
+     *
+     * @param p The channel.
+     * @param flow The flow, in m^3/s.
+     * @return The depth of the flow, in m.
+     */
+    inline double normal_depth(const channel_params& p, double flow)
+    {
+        double slope = std::max(p.slope, MIN_SLOPE);
+        double k = std::sqrt(slope) / p.mannings_n;
+        double wetted_side = 2.0 * std::sqrt(1.0 + p.side_slope * p.side_slope);
+        double depth = std::pow(flow / (k * p.bottom_width_m), 0.6);
+        for (int i = 0; i < 30; ++i) {
+            double area = (p.bottom_width_m + p.side_slope * depth) * depth;
+            double perimeter = p.bottom_width_m + wetted_side * depth;
+            double top_width = p.bottom_width_m + 2.0 * p.side_slope * depth;
+            double q = k * std::pow(area, 5.0 / 3.0) / std::pow(perimeter, 2.0 / 3.0);
+            double dq = k * ((5.0 / 3.0) * std::pow(area / perimeter, 2.0 / 3.0) * top_width
+                             - (2.0 / 3.0) * std::pow(area / perimeter, 5.0 / 3.0) * wetted_side);
+            double step = (q - flow) / dq;
+            depth = std::max(depth - step, 0.5 * depth);
+            if (std::abs(step) < 1.0e-9 * depth) {
+                break;
+            }
+        }
+        return depth;
+    }
+
+    /**
+     * @brief The kinematic wave celerity, dQ/dA, of a flow in a channel at normal depth.
+     *
+     * @param p The channel.
+     * @param depth The normal depth of the flow, in m.
+     * @return The celerity, in m/s.
+     */
+    inline double celerity(const channel_params& p, double depth)
+    {
+        double slope = std::max(p.slope, MIN_SLOPE);
+        double k = std::sqrt(slope) / p.mannings_n;
+        double wetted_side = 2.0 * std::sqrt(1.0 + p.side_slope * p.side_slope);
+        double area = (p.bottom_width_m + p.side_slope * depth) * depth;
+        double perimeter = p.bottom_width_m + wetted_side * depth;
+        double top_width = p.bottom_width_m + 2.0 * p.side_slope * depth;
+        double dq = k * ((5.0 / 3.0) * std::pow(area / perimeter, 2.0 / 3.0) * top_width
+                         - (2.0 / 3.0) * std::pow(area / perimeter, 5.0 / 3.0) * wetted_side);
+        return dq / top_width;
+    }
+
+    /**
+     * @brief Route one time step of flow through a reach with the variable parameter Muskingum-Cunge method.
+     *
+     * The storage constant and weighting factor are recomputed each step from a reference flow, the mean of the
+     * reach's current inflows (from upstream and lateral) and previous outflow, at normal depth: ``K = L / c`` and
+     * ``X = (1 - Q / (T S c L)) / 2``, with ``X`` kept within ``[0, 0.5]``.
+     *
+     * Rather than the usual routing coefficients, which only conserve mass while ``K`` and ``X`` stay constant, the
+     * reach's storage is kept, and the outflow solves continuity, ``S2 = S1 + dt ((I1 + I2) / 2 + q - (O1 + O2) / 2)``,
+     * together with the Muskingum storage relation ``S2 = K (X I2 + (1 - X) O2)``.  With constant parameters this is
+     * the same as classic Muskingum-Cunge, and mass is conserved however the parameters vary.  Lateral inflow is
+     * taken to be spread along the reach, so a steady inflow ``I`` and lateral inflow ``q`` give an outflow of
+     * ``I + q``.  Neither outflows nor storage are ever negative.  Steps longer than ``2 K (1 - X)``, the bound on
+     * steps for which the classic coefficients are all positive, are taken in as many shorter steps as needed.
+     *
+     * @param p The reach.
+     * @param dt_seconds The time step.
+     * @param inflow_prev The inflow from upstream at the start of the step, in m^3/s.
+     * @param inflow The inflow from upstream at the end of the step, in m^3/s.
+     * @param outflow_prev The outflow at the start of the step, in m^3/s.
+     * @param lateral The lateral inflow over the step, in m^3/s.
+     * @param storage The water stored in the reach, in m^3, at the start of the step, updated to its end.
+     * @return The outflow at the end of the step, in m^3/s.
+     */
+    inline double route(const channel_params& p, double dt_seconds, double inflow_prev, double inflow,
+                        double outflow_prev, double lateral, double& storage)
+    {
+        double reference_flow = std::max(0.5 * (inflow + lateral + outflow_prev), MIN_REFERENCE_FLOW);
+        double depth = normal_depth(p, reference_flow);
+        double c = celerity(p, depth);
+        double top_width = p.bottom_width_m + 2.0 * p.side_slope * depth;
+        double slope = std::max(p.slope, MIN_SLOPE);
+
+        double k = p.length_m / c;
+        double x = 0.5 * (1.0 - reference_flow / (top_width * slope * c * p.length_m));
+        x = std::min(std::max(x, 0.0), 0.5);
+
+        // Steps longer than the reach's travel time would overdraw its storage, so take them in shorter steps, over
+        // which the inflow from upstream varies linearly
+        int steps = static_cast<int>(std::ceil(dt_seconds / (2.0 * k * (1.0 - x))));
+        steps = std::max(steps, 1);
+        double dt = dt_seconds / steps;
+        double outflow = outflow_prev;
+        for (int i = 0; i < steps; ++i) {
+            double start = inflow_prev + (inflow - inflow_prev) * i / steps;
+            double end = inflow_prev + (inflow - inflow_prev) * (i + 1) / steps;
+            // The storage at the end of the step, before taking out the outflow at its end
+            double filled = storage + dt * (0.5 * (start + end) + lateral - 0.5 * outflow);
+            double next = (filled - k * x * end) / (k * (1.0 - x) + 0.5 * dt);
+            // Never take out more water than there is, nor put any back
+            outflow = std::min(std::max(next, 0.0), std::max(filled, 0.0) / (0.5 * dt));
+            storage = std::max(filled - 0.5 * dt * outflow, 0.0);
+        }
+        return outflow;
+    }
+}
+
+#endif //NGEN_MUSKINGUM_CUNGE_HPP
@@ -0,0 +1,138 @@
+#ifndef ET_BATCH_H
+#define ET_BATCH_H
+
+#include <cstddef>
+#include <vector>
+
+/*
+ * The number of doubles per vector register of the instruction set this is compiled for, which the batched kernels
+ * below are vectorized over.  The instruction set itself is chosen by the compiler flags (e.g. ``-march=native``), so
+ * this only records it, for callers sizing blocks of catchments.
+ */
+#if defined(__AVX512F__)
+#define ET_BATCH_SIMD_LANES 8
+#elif defined(__AVX2__) || defined(__AVX__)
+#define ET_BATCH_SIMD_LANES 4
+#elif defined(__ARM_NEON) || defined(__SSE2__)
+#define ET_BATCH_SIMD_LANES 2
+#else
+#define ET_BATCH_SIMD_LANES 1
+#endif
+
+namespace et {
+    /**
+     * Evapotranspiration kernels for a block of catchments at once.
+     *
+     * These compute the same rates as the single catchment methods (e.g.
+     * et::combined::evapotranspiration_combination_method), but from a struct of arrays with one element per
+     * catchment, and without branching per catchment, so that the loop over catchments is vectorized.  Unlike the single
+     * catchment methods, they do not modify their inputs (defaulted values are only used locally), and do not warn of
+     * implausible inputs.
+     */
+    namespace batch {
+
+        /** @see ET_BATCH_SIMD_LANES */
+        const std::size_t simd_lanes = ET_BATCH_SIMD_LANES;
+
+        /** The forcings of a block of catchments; each of the fields of et::evapotranspiration_forcing, per catchment. */
+        struct evapotranspiration_forcing_arrays {
+            std::vector<double> net_radiation_W_per_sq_m;
+            std::vector<double> air_temperature_C;
+            std::vector<double> relative_humidity_percent;      // negative to use specific_humidity_2m_kg_per_kg
+            std::vector<double> specific_humidity_2m_kg_per_kg;
+            std::vector<double> air_pressure_Pa;
+            std::vector<double> wind_speed_m_per_s;
+            std::vector<double> canopy_resistance_sec_per_m;
+            std::vector<double> water_temperature_C;
+            std::vector<double> ground_heat_flux_W_per_sq_m;
+
+            explicit evapotranspiration_forcing_arrays(std::size_t n = 0) { resize(n); }
+
+            void resize(std::size_t n);
+
+            std::size_t size() const { return air_temperature_C.size(); }
+        };
+
+        /** The parameters of a block of catchments; those fields of et::evapotranspiration_params the methods use. */
+        struct evapotranspiration_params_arrays {
+            std::vector<double> wind_speed_measurement_height_m;
+            std::vector<double> humidity_measurement_height_m;
+            std::vector<double> vegetation_height_m;
+            std::vector<double> zero_plane_displacement_height_m;
+            std::vector<double> momentum_transfer_roughness_length_m;
+            std::vector<double> heat_transfer_roughness_length_m;
+
+            explicit evapotranspiration_params_arrays(std::size_t n = 0) { resize(n); }
+
+            void resize(std::size_t n);
+
+            std::size_t size() const { return zero_plane_displacement_height_m.size(); }
+        };
+
+        /** The intermediate variables of a block of catchments; each of the fields of et::intermediate_vars. */
+        struct intermediate_vars_arrays {
+            std::vector<double> liquid_water_density_kg_per_m3;
+            std::vector<double> water_latent_heat_of_vaporization_J_per_kg;
+            std::vector<double> air_saturation_vapor_pressure_Pa;
+            std::vector<double> air_actual_vapor_pressure_Pa;
+            std::vector<double> vapor_pressure_deficit_Pa;
+            std::vector<double> moist_air_gas_constant_J_per_kg_K;
+            std::vector<double> moist_air_density_kg_per_m3;
+            std::vector<double> slope_sat_vap_press_curve_Pa_s;
+            std::vector<double> psychrometric_constant_Pa_per_C;
+
+            explicit intermediate_vars_arrays(std::size_t n = 0) { resize(n); }
+
+            void resize(std::size_t n);
+        };
+
+        /**
+         * Calculate the intermediate variables of every catchment, as et::calculate_intermediate_variables does.
+         *
+         * @param params The parameters of the catchments.
+         * @param forcing The forcings of the catchments.
+         * @param inter_vars Set to the intermediate variables of the catchments, resized if needed.
+         */
+        void calculate_intermediate_variables(const evapotranspiration_params_arrays &params,
+                                              const evapotranspiration_forcing_arrays &forcing,
+                                              intermediate_vars_arrays &inter_vars);
+
+        /*
+         * Each of the methods below sets ``et_rate_m_per_s`` to the rate of every catchment, using the intermediate
+         * variables calculated for the same forcings and parameters, so that several methods may share them.
+         */
+
+        /** The energy balance (radiation) method, Chow, Maidment, and Mays eqn. 3.5.9. */
+        void evapotranspiration_energy_balance_method(const evapotranspiration_forcing_arrays &forcing,
+                                                      const intermediate_vars_arrays &inter_vars,
+                                                      std::vector<double> &et_rate_m_per_s);
+
+        /** The aerodynamic method. */
+        void evapotranspiration_aerodynamic_method(const evapotranspiration_params_arrays &params,
+                                                   const evapotranspiration_forcing_arrays &forcing,
+                                                   const intermediate_vars_arrays &inter_vars,
+                                                   std::vector<double> &et_rate_m_per_s);
+
+        /** The combination of the energy balance and aerodynamic methods, Chow, Maidment, and Mays eqn. 3.5.26. */
+        void evapotranspiration_combination_method(const evapotranspiration_params_arrays &params,
+                                                   const evapotranspiration_forcing_arrays &forcing,
+                                                   const intermediate_vars_arrays &inter_vars,
+                                                   std::vector<double> &et_rate_m_per_s);
+
+        /** The Priestley-Taylor method. */
+        void evapotranspiration_priestley_taylor_method(const evapotranspiration_forcing_arrays &forcing,
+                                                        const intermediate_vars_arrays &inter_vars,
+                                                        std::vector<double> &et_rate_m_per_s);
+
+        /**
+         * The Penman-Monteith FAO reference method, with the roughness of each catchment from its vegetation height
+         * (0.5 m where not given).
+         */
+        void evapotranspiration_penman_monteith_method(const evapotranspiration_params_arrays &params,
+                                                       const evapotranspiration_forcing_arrays &forcing,
+                                                       const intermediate_vars_arrays &inter_vars,
+                                                       std::vector<double> &et_rate_m_per_s);
+    }
+}
+
+#endif // ET_BATCH_H
@@ -0,0 +1,95 @@
+#ifndef NGEN_EXPONENTIAL_OUTLET_TABLE_HPP
+#define NGEN_EXPONENTIAL_OUTLET_TABLE_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace Reservoir{
+    namespace Explicit_Time{
+
+        /**
+         * @brief Table of the velocity of an exponential outlet over the storage range of its reservoir.
+         *
+         * The velocity, c * (exp(expon * S / S_max) - 1), is tabulated at evenly spaced storages from 0 to S_max and read
+         * by linear interpolation, which takes a load of a value and slope pair and a fused multiply-add in place of an
+         * exp call.  The spacing is chosen so the interpolation error, which is at most an eighth of the spacing squared
+         * times the largest second derivative of the velocity over the range, is within a tolerance.
+         */
+        class Exponential_Outlet_Table
+        {
+        public:
+
+            /** The most points a table is built with; a tolerance needing more leaves the table empty. */
+            static constexpr std::size_t max_points = 1 << 16;
+
+            /**
+             * @brief Build the table for an outlet, or leave it empty if the tolerance is not positive or needs more than
+             * max_points points.
+             *
+             * @param c outlet velocity calculation coefficient
+             * @param expon outlet velocity calculation exponential coefficient
+             * @param maximum_storage_meters the maximum storage of the outlet's reservoir
+             * @param tolerance_meters_per_second the largest acceptable error of an interpolated velocity
+             * @return Whether the table was built.
+             */
+            bool build(double c, double expon, double maximum_storage_meters, double tolerance_meters_per_second)
+            {
+                entries.clear();
+                if (!(tolerance_meters_per_second > 0.0) || !(maximum_storage_meters > 0.0)) {
+                    return false;
+                }
+
+                double rate = expon / maximum_storage_meters;
+                double max_second_derivative = std::fabs(c) * rate * rate * std::exp(std::max(expon, 0.0));
+                double intervals = 1.0;
+                if (max_second_derivative > 0.0) {
+                    double spacing = std::sqrt(8.0 * tolerance_meters_per_second / max_second_derivative);
+                    intervals = std::max(1.0, std::ceil(maximum_storage_meters / spacing));
+                }
+                if (!(intervals < static_cast<double>(max_points))) {
+                    return false;
+                }
+
+                std::size_t count = static_cast<std::size_t>(intervals);
+                double spacing = maximum_storage_meters / count;
+                entries.resize(2 * count);
+                double value = 0.0;
+                for (std::size_t i = 0; i < count; ++i) {
+                    double next = c * (std::exp(expon * ((i + 1) * spacing) / maximum_storage_meters) - 1);
+                    entries[2 * i] = value;
+                    entries[2 * i + 1] = next - value;
+                    value = next;
+                }
+                inverse_spacing = 1.0 / spacing;
+                max_storage_meters = maximum_storage_meters;
+                return true;
+            }
+
+            /** @return Whether the storage is in the range of a built table. */
+            bool covers(double storage_meters) const
+            {
+                return !entries.empty() && storage_meters >= 0.0 && storage_meters <= max_storage_meters;
+            }
+
+            /**
+             * @brief The interpolated velocity at a storage, which must be covered by the table.
+             */
+            double velocity_meters_per_second(double storage_meters) const
+            {
+                double position = storage_meters * inverse_spacing;
+                std::size_t i = std::min(static_cast<std::size_t>(position), entries.size() / 2 - 1);
+                return std::fma(position - i, entries[2 * i + 1], entries[2 * i]);
+            }
+
+        private:
+            /** The velocity at the start of each interval, followed by its increase over the interval. */
+            std::vector<double> entries;
+            double inverse_spacing = 0.0;
+            double max_storage_meters = 0.0;
+        };
+    }
+}
+
+#endif //NGEN_EXPONENTIAL_OUTLET_TABLE_HPP
@@ -95,6 +95,30 @@ namespace Reservoir{
             double response_meters_per_second(double in_flux_meters_per_second, int delta_time_seconds,
                                               double &excess_water_meters);
 
+            /**
+             * @brief Set how the reservoir solves for its storage over each time step of response_meters_per_second.
+             *
+             * With the adaptive solver, the response is that of sub-steps of whole seconds, each halved until the estimated
+             * error of its storage (the difference from two half sub-steps) is within the tolerance, and each grown again
+             * once it is well within it.  The returned velocity, and that of each outlet, is then the mean over the time
+             * step, and the excess water the total over the sub-steps.
+             *
+             * @param solver The solver to use.
+             * @param tolerance_meters For the adaptive solver, the largest acceptable estimated error of a sub-step's
+             *                         storage, in meters.
+             * @param max_substeps For the adaptive solver, the number of sub-steps of the smallest allowed sub-step.
+             */
+            void set_solver(reservoir_solver solver, double tolerance_meters = 1.0e-6, int max_substeps = 64);
+
+            /**
+             * @brief Set the largest acceptable error of the velocities that outlets able to tabulate them (exponential
+             * outlets) read from a table over the storage range, building the tables of the current outlets and those
+             * added later; 0 computes every velocity.
+             *
+             * @param tolerance_meters_per_second The largest acceptable velocity error, in meters per second.
+             */
+            void set_outlet_table_tolerance(double tolerance_meters_per_second);
+
             /**
              * @brief Adds a preconstructed outlet of any type to the reservoir
              * @param outlet single reservoir outlet
@@ -154,9 +178,28 @@ namespace Reservoir{
              */
 
             private:
+
+            /**
+             * @brief Update the storage and return the response over one explicit step.
+             * @see response_meters_per_second
+             */
+            double step_response_meters_per_second(double in_flux_meters_per_second, int delta_time_seconds,
+                                                   double &excess_water_meters);
+
+            /**
+             * @brief Update the storage and return the mean response over the time step, with adaptive sub-steps.
+             * @see set_solver
+             */
+            double adaptive_response_meters_per_second(double in_flux_meters_per_second, int delta_time_seconds,
+                                                       double &excess_water_meters);
+
             reservoir_parameters parameters;
             reservoir_state state;
             outlet_vector_type outlets;
+            /** Scratch space for the adaptive solver: the volume discharged through each outlet over the time step. */
+            std::vector<double> outlet_volumes_meters;
+            /** Scratch space for the adaptive solver: the velocity of each outlet over the first half of a sub-step. */
+            std::vector<double> half_substep_velocities_meters_per_second;
         };
     }
 }
@@ -0,0 +1,71 @@
+#ifndef NGEN_RESERVOIR_BATCH_HPP
+#define NGEN_RESERVOIR_BATCH_HPP
+
+namespace Reservoir {
+    namespace Explicit_Time {
+        /**
+         * The stages of a reservoir's response, for the batched models that run the same reservoir of every member
+         * catchment in one loop (e.g., tshirt::basic_tshirt_batch and hymod_batch).
+         *
+         * Together these compute exactly what Reservoir::response_meters_per_second (and Inline_Reservoir) do for a
+         * reservoir with linear outlets, but select results rather than branching, so the loops calling them are
+         * vectorized.  Unlike the reservoir objects, they do not warn of storage or outlet velocities above their
+         * maximum.
+         */
+        namespace batch {
+
+            /**
+             * Add an influx to a reservoir, as Reservoir::response_meters_per_second first does, keeping the water
+             * above the maximum storage as excess.
+             */
+            template <typename Real>
+            inline void fill_reservoir(Real in_flux_m_per_s, Real delta_time_s, Real max_storage_m, Real &storage_m,
+                                       Real &excess_m)
+            {
+                storage_m += in_flux_m_per_s * delta_time_s;
+                excess_m = (storage_m > max_storage_m) ? storage_m - max_storage_m : Real(0);
+                storage_m = (storage_m > max_storage_m) ? max_storage_m : storage_m;
+            }
+
+            /**
+             * Drain a reservoir through one of its outlets, as each iteration of the outlet loop of
+             * Reservoir::response_meters_per_second does: refill from any excess that now fits, and limit the outlet
+             * velocity to what drains the reservoir to its minimum storage.
+             *
+             * @return The outlet velocity, after any limit.
+             */
+            template <typename Real>
+            inline Real drain_reservoir(Real velocity_m_per_s, Real delta_time_s, Real min_storage_m,
+                                        Real max_storage_m, Real &storage_m, Real &excess_m)
+            {
+                storage_m -= velocity_m_per_s * delta_time_s;
+
+                Real room_m = max_storage_m - storage_m;
+                bool overflows = excess_m > 0 && excess_m > room_m;
+                bool refills = excess_m > 0 && !overflows;
+                storage_m = overflows ? max_storage_m : (refills ? storage_m + excess_m : storage_m);
+                excess_m = overflows ? excess_m - room_m : (refills ? Real(0) : excess_m);
+
+                bool emptied = storage_m < min_storage_m;
+                Real limited_velocity_m_per_s = ((storage_m + velocity_m_per_s * delta_time_s) - min_storage_m)
+                                                / delta_time_s;
+                excess_m = emptied ? Real(0) : excess_m;
+                storage_m = emptied ? min_storage_m : storage_m;
+                return emptied ? limited_velocity_m_per_s : velocity_m_per_s;
+            }
+
+            /** The velocity of a Reservoir_Linear_Outlet. */
+            template <typename Real>
+            inline Real linear_outlet_velocity(Real a, Real activation_threshold_m, Real max_velocity_m_per_s,
+                                               Real max_storage_m, Real storage_m)
+            {
+                Real velocity_m_per_s = a * (storage_m - activation_threshold_m)
+                                        / (max_storage_m - activation_threshold_m);
+                velocity_m_per_s = (velocity_m_per_s > max_velocity_m_per_s) ? max_velocity_m_per_s : velocity_m_per_s;
+                return (storage_m <= activation_threshold_m) ? Real(0) : velocity_m_per_s;
+            }
+        }
+    }
+}
+
+#endif //NGEN_RESERVOIR_BATCH_HPP
@@ -1,6 +1,7 @@
 #ifndef NGEN_RESERVOIR_EXPONENTIAL_OUTLET_H
 #define NGEN_RESERVOIR_EXPONENTIAL_OUTLET_H
 
+#include "Exponential_Outlet_Table.hpp"
 #include "Reservoir_Outlet.hpp"
 
 namespace Reservoir{
@@ -31,6 +32,14 @@ namespace Reservoir{
             Reservoir_Exponential_Outlet(double c, double expon, double activation_threshold_meters,
                                          double max_velocity_meters_per_second);
 
+            /**
+             * @brief Build the table of velocities over the reservoir's storage range if the parameters have an
+             * outlet_table_tolerance_meters_per_second, or drop it if not.
+             *
+             * @param parameters_struct reservoir parameters struct
+             */
+            void tabulate(const reservoir_parameters &parameters_struct) override;
+
         protected:
 
             /**
@@ -54,6 +63,7 @@ namespace Reservoir{
             private:
             double c;
             double expon;
+            Exponential_Outlet_Table table;
         };
     }
 }
@@ -0,0 +1,454 @@
+#ifndef NGEN_RESERVOIR_INLINE_HPP
+#define NGEN_RESERVOIR_INLINE_HPP
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <tuple>
+#include <utility>
+#include "Exponential_Outlet_Table.hpp"
+#include "reservoir_parameters.h"
+#include "reservoir_state.h"
+
+namespace Reservoir{
+    namespace Explicit_Time{
+
+        /**
+         * @brief Base of the reservoir outlets of an Inline_Reservoir.
+         *
+         * This holds the activation threshold, max velocity and last calculated velocity of an outlet, and calculates its
+         * velocity exactly as Reservoir_Outlet::velocity_meters_per_second does.  The outlet type itself (``Derived``)
+         * provides a non-virtual calc_velocity_meters_per_second_local, which the compiler can then inline.
+         *
+         * @tparam Derived The outlet type.
+         */
+        template<class Derived>
+        class Inline_Outlet_Base
+        {
+        public:
+
+            Inline_Outlet_Base(double activation_threshold_meters, double max_velocity_meters_per_second)
+                    : activation_threshold_meters(activation_threshold_meters),
+                      max_velocity_meters_per_second(max_velocity_meters_per_second), velocity_meters_per_second_local(0.0)
+            {
+
+            }
+
+            /**
+             * Set the locally maintained velocity state variable value.
+             *
+             * @param velocity_meters_per_second The velocity value to set, in meters per second.
+             */
+            void adjust_velocity(double velocity_meters_per_second)
+            {
+                velocity_meters_per_second_local = velocity_meters_per_second;
+            }
+
+            /**
+             * @brief Accessor to return activation_threshold_meters
+             * @return activation_threshold_meters meters from the bottom of the reservoir to the bottom of the outlet
+             */
+            double get_activation_threshold_meters() const
+            {
+                return activation_threshold_meters;
+            }
+
+            /**
+             * @brief Accessor to return velocity_meters_per_second_local that is previously calculated
+             * @return velocity_meters_per_second_local
+             */
+            double get_previously_calculated_velocity_meters_per_second() const
+            {
+                return velocity_meters_per_second_local;
+            }
+
+            /**
+             * @brief Prepare the outlet to calculate velocities with the given reservoir parameters.
+             *
+             * Outlets that can tabulate their velocity (see Inline_Exponential_Outlet) hide this to build their table.
+             */
+            void tabulate(const reservoir_parameters &parameters_struct)
+            {
+
+            }
+
+            /**
+             * @brief Function to update and return the velocity in meters per second of the discharge through the outlet.
+             *
+             * @param parameters_struct reservoir parameters struct
+             * @param storage_struct reservoir state storage struct
+             * @see Reservoir_Outlet::velocity_meters_per_second
+             */
+            double velocity_meters_per_second(const reservoir_parameters &parameters_struct,
+                                              const reservoir_state &storage_struct)
+            {
+                // Return velocity of 0.0 if the storage passed in is less than the activation threshold
+                if (storage_struct.current_storage_height_meters <= activation_threshold_meters) {
+                    velocity_meters_per_second_local = 0.0;
+                    return velocity_meters_per_second_local;
+                }
+
+                velocity_meters_per_second_local = static_cast<const Derived *>(this)->calc_velocity_meters_per_second_local(
+                        parameters_struct, storage_struct);
+
+                // If calculated outlet velocity is greater than max velocity, then set to max velocity and return a warning.
+                if (velocity_meters_per_second_local > max_velocity_meters_per_second) {
+                    velocity_meters_per_second_local = max_velocity_meters_per_second;
+
+                    //TODO: Return appropriate warning
+                    std::cout
+                            << "WARNING: Reservoir calculated an outlet velocity over max velocity, and therefore "
+                            << "set the outlet velocity to max velocity."
+                            << std::endl;
+                }
+
+                return velocity_meters_per_second_local;
+            }
+
+        protected:
+            double activation_threshold_meters;
+            double max_velocity_meters_per_second;
+            double velocity_meters_per_second_local;
+        };
+
+        /**
+         * @brief Inline equivalent of the standard nonlinear Reservoir_Outlet.
+         */
+        class Inline_Outlet : public Inline_Outlet_Base<Inline_Outlet>
+        {
+        public:
+
+            Inline_Outlet() : Inline_Outlet(0.0, 0.0, 0.0, 0.0)
+            {
+
+            }
+
+            /**
+             * @param a outlet velocity calculation coefficient
+             * @param b outlet velocity calculation exponent
+             * @param activation_threshold_meters meters from the bottom of the reservoir to the bottom of the outlet
+             * @param max_velocity_meters_per_second max outlet velocity in meters per second
+             */
+            Inline_Outlet(double a, double b, double activation_threshold_meters, double max_velocity_meters_per_second)
+                    : Inline_Outlet_Base(activation_threshold_meters, max_velocity_meters_per_second), a(a), b(b)
+            {
+
+            }
+
+            double calc_velocity_meters_per_second_local(const reservoir_parameters &parameters_struct,
+                                                         const reservoir_state &storage_struct) const
+            {
+                return a * std::pow(
+                        (
+                                (storage_struct.current_storage_height_meters - activation_threshold_meters)
+                                /
+                                (parameters_struct.maximum_storage_meters - activation_threshold_meters)
+                        ), b);
+            }
+
+        private:
+            double a;
+            double b;
+        };
+
+        /**
+         * @brief Inline equivalent of Reservoir_Linear_Outlet.
+         */
+        class Inline_Linear_Outlet : public Inline_Outlet_Base<Inline_Linear_Outlet>
+        {
+        public:
+
+            Inline_Linear_Outlet() : Inline_Linear_Outlet(0.0, 0.0, 0.0)
+            {
+
+            }
+
+            /**
+             * @param a outlet velocity calculation coefficient
+             * @param activation_threshold_meters meters from the bottom of the reservoir to the bottom of the outlet
+             * @param max_velocity_meters_per_second max outlet velocity in meters per second
+             */
+            Inline_Linear_Outlet(double a, double activation_threshold_meters, double max_velocity_meters_per_second)
+                    : Inline_Outlet_Base(activation_threshold_meters, max_velocity_meters_per_second), a(a)
+            {
+
+            }
+
+            double calc_velocity_meters_per_second_local(const reservoir_parameters &parameters_struct,
+                                                         const reservoir_state &storage_struct) const
+            {
+                return a * (storage_struct.current_storage_height_meters - activation_threshold_meters)
+                       /
+                       (parameters_struct.maximum_storage_meters - activation_threshold_meters);
+            }
+
+        private:
+            double a;
+        };
+
+        /**
+         * @brief Inline equivalent of Reservoir_Exponential_Outlet.
+         */
+        class Inline_Exponential_Outlet : public Inline_Outlet_Base<Inline_Exponential_Outlet>
+        {
+        public:
+
+            Inline_Exponential_Outlet() : Inline_Exponential_Outlet(0.0, 0.0, 0.0, 0.0)
+            {
+
+            }
+
+            /**
+             * @param c outlet velocity calculation coefficient
+             * @param expon outlet velocity calculation exponent
+             * @param activation_threshold_meters meters from the bottom of the reservoir to the bottom of the outlet
+             * @param max_velocity_meters_per_second max outlet velocity in meters per second
+             */
+            Inline_Exponential_Outlet(double c, double expon, double activation_threshold_meters,
+                                      double max_velocity_meters_per_second)
+                    : Inline_Outlet_Base(activation_threshold_meters, max_velocity_meters_per_second), c(c), expon(expon)
+            {
+
+            }
+
+            /**
+             * @brief Build the table of velocities over the reservoir's storage range if the parameters have an
+             * outlet_table_tolerance_meters_per_second, or drop it if not.
+             */
+            void tabulate(const reservoir_parameters &parameters_struct)
+            {
+                table.build(c, expon, parameters_struct.maximum_storage_meters,
+                            parameters_struct.outlet_table_tolerance_meters_per_second);
+            }
+
+            double calc_velocity_meters_per_second_local(const reservoir_parameters &parameters_struct,
+                                                         const reservoir_state &storage_struct) const
+            {
+                if (table.covers(storage_struct.current_storage_height_meters)) {
+                    return table.velocity_meters_per_second(storage_struct.current_storage_height_meters);
+                }
+                return c * (std::exp(expon * storage_struct.current_storage_height_meters /
+                                     parameters_struct.maximum_storage_meters) - 1);
+            }
+
+        private:
+            double c;
+            double expon;
+            Exponential_Outlet_Table table;
+        };
+
+        /**
+         * @brief Reservoir with a fixed set of outlets, whose types are known at compile time.
+         *
+         * This responds exactly as a Reservoir with the same outlets does, but the outlets are held by value (rather than
+         * through pointers to Reservoir_Outlet) and their velocities are not virtual calls, so the loop over the outlets
+         * is unrolled and inlined into response_meters_per_second.  It is meant for the models that build the same small
+         * reservoirs for every catchment, such as the Tshirt and Hymod soil, Nash cascade and groundwater reservoirs.
+         *
+         * Since the outlets are not sorted, they must be given from lowest to highest activation threshold, which is the
+         * order they are then cycled through and indexed by.
+         *
+         * @tparam Outlets The type of each outlet (e.g., Inline_Linear_Outlet), from lowest to highest activation threshold.
+         */
+        template<class... Outlets>
+        class Inline_Reservoir
+        {
+        public:
+
+            /**
+             * @brief Default Constructor building a reservoir with default constructed outlets.
+             */
+            Inline_Reservoir() : Inline_Reservoir(0.0, 1.0, 0.0, Outlets()...)
+            {
+
+            }
+
+            /**
+             * @brief Parameterized Constructor building a reservoir with the given outlets.
+             * @param minimum_storage_meters minimum storage in meters
+             * @param maximum_storage_meters maximum storage in meters
+             * @param current_storage_height_meters current storage height in meters
+             * @param outlets the reservoir outlets, from lowest to highest activation threshold
+             */
+            Inline_Reservoir(double minimum_storage_meters, double maximum_storage_meters,
+                             double current_storage_height_meters, Outlets... outlets)
+                    : outlets(std::move(outlets)...)
+            {
+                parameters.minimum_storage_meters = minimum_storage_meters;
+                parameters.maximum_storage_meters = maximum_storage_meters;
+                state.current_storage_height_meters = current_storage_height_meters;
+
+                check_outlets(std::index_sequence_for<Outlets...>());
+            }
+
+            /**
+             * @brief Function to update the reservoir storage in meters and return a response in meters per second to
+             * an influx and time step.
+             *
+             * @param in_flux_meters_per_second influx in meters per second
+             * @param delta_time_seconds delta time in seconds
+             * @param excess_water_meters Reference to an amount of excess water in meters, after considering input and max storage.
+             * @return sum_of_outlet_velocities_meters_per_second sum of the outlet velocities in meters per second
+             * @see Reservoir::response_meters_per_second
+             */
+            double response_meters_per_second(double in_flux_meters_per_second, int delta_time_seconds,
+                                              double &excess_water_meters)
+            {
+                excess_water_meters = 0;
+
+                //Update current storage from influx multiplied by delta time.
+                state.current_storage_height_meters += in_flux_meters_per_second * delta_time_seconds;
+
+                //If storage is greater than maximum storage, set to maximum storage and return excess water.
+                if (state.current_storage_height_meters > parameters.maximum_storage_meters)
+                {
+                    /// \todo TODO: Return appropriate warning
+                    std::cout << "WARNING: Reservoir calculated a storage above the maximum storage."  << std::endl;
+                    excess_water_meters = state.current_storage_height_meters - parameters.maximum_storage_meters;
+                    state.current_storage_height_meters = parameters.maximum_storage_meters;
+                }
+
+                double sum_of_outlet_velocities_meters_per_second = respond_through_outlets(
+                        delta_time_seconds, excess_water_meters, std::index_sequence_for<Outlets...>());
+
+                //Ensure that excess_water_meters is not negative
+                if (excess_water_meters < 0.0)
+                {
+                    /// \todo TODO: Return appropriate error
+                    std::cerr
+                        << "ERROR: excess_water_meters from the reservoir is calculated to be less than zero."
+                        << std::endl;
+                        exit(-1);
+                }
+
+                return sum_of_outlet_velocities_meters_per_second;
+            }
+
+            /**
+             * @brief Set the largest acceptable error of the velocities that outlets able to tabulate them read from a
+             * table over the storage range, building their tables; 0 computes every velocity.
+             *
+             * @param tolerance_meters_per_second The largest acceptable velocity error, in meters per second.
+             * @see reservoir_parameters::outlet_table_tolerance_meters_per_second
+             */
+            void set_outlet_table_tolerance(double tolerance_meters_per_second)
+            {
+                parameters.outlet_table_tolerance_meters_per_second = tolerance_meters_per_second;
+                tabulate_outlets(std::index_sequence_for<Outlets...>());
+            }
+
+            /**
+             * @brief Accessor to return storage
+             * @return state.current_storage_height_meters current storage height in meters
+             */
+            double get_storage_height_meters() const
+            {
+                return state.current_storage_height_meters;
+            }
+
+            /**
+             * @brief Return velocity in meters per second of discharge through the specified outlet, as of the last
+             * response.
+             * @tparam I The index of the desired outlet.
+             */
+            template<std::size_t I>
+            double velocity_meters_per_second_for_outlet() const
+            {
+                return std::get<I>(outlets).get_previously_calculated_velocity_meters_per_second();
+            }
+
+        private:
+
+            /**
+             * @brief Ensure the outlets are in order of activation threshold, and that the highest is below the maximum
+             * storage, as the Reservoir constructor taking a vector of outlets does.
+             */
+            template<std::size_t... I>
+            void check_outlets(std::index_sequence<I...>)
+            {
+                double thresholds[] = {0.0, std::get<I>(outlets).get_activation_threshold_meters()...};
+                double *last = thresholds + sizeof...(I);
+                for (double *t = thresholds + 1; t < last; ++t) {
+                    if (*t > *(t + 1)) {
+                        std::cerr << "ERROR: The outlets of an inline reservoir are not in order of activation threshold."
+                                  << std::endl;
+                        exit(-1);
+                    }
+                }
+                if (sizeof...(I) > 0 && *last > parameters.maximum_storage_meters) {
+                    std::cerr
+                        << "ERROR: The activation_threshold_meters is greater than the maximum_storage_meters of a "
+                        << "reservoir."
+                        << std::endl;
+                        exit(-1);
+                }
+            }
+
+            template<std::size_t... I>
+            void tabulate_outlets(std::index_sequence<I...>)
+            {
+                int expand[] = {0, (std::get<I>(outlets).tabulate(parameters), 0)...};
+                (void) expand;
+            }
+
+            /** Cycle through the outlets in order, returning the sum of their velocities. */
+            template<std::size_t... I>
+            double respond_through_outlets(int delta_time_seconds, double &excess_water_meters, std::index_sequence<I...>)
+            {
+                double sum_of_outlet_velocities_meters_per_second = 0;
+                // The braced list guarantees the outlets are evaluated (and summed) from first to last
+                int expand[] = {0, (sum_of_outlet_velocities_meters_per_second += respond_through_outlet(
+                        std::get<I>(outlets), delta_time_seconds, excess_water_meters), 0)...};
+                (void) expand;
+                return sum_of_outlet_velocities_meters_per_second;
+            }
+
+            /** Update the storage for the discharge through one outlet, returning the outlet's velocity. */
+            template<class Outlet>
+            double respond_through_outlet(Outlet &outlet, int delta_time_seconds, double &excess_water_meters)
+            {
+                //Calculate outlet velocity.
+                double outlet_velocity_meters_per_second = outlet.velocity_meters_per_second(parameters, state);
+
+                //Update storage from outlet velocity multiplied by delta time.
+                state.current_storage_height_meters -= outlet_velocity_meters_per_second * delta_time_seconds;
+
+                // If there was excess water from the influx that exceeded the max earlier but will now fit, then add it in
+                if (excess_water_meters > 0) {
+                    if (excess_water_meters > parameters.maximum_storage_meters - state.current_storage_height_meters) {
+                        excess_water_meters -= parameters.maximum_storage_meters - state.current_storage_height_meters;
+                        state.current_storage_height_meters = parameters.maximum_storage_meters;
+                    }
+                    else {
+                        state.current_storage_height_meters += excess_water_meters;
+                        excess_water_meters = 0;
+                    }
+                }
+
+                //If storage is less than minimum storage.
+                if (state.current_storage_height_meters < parameters.minimum_storage_meters)
+                {
+                    //Return to storage before falling below minimum storage.
+                    state.current_storage_height_meters += outlet_velocity_meters_per_second * delta_time_seconds;
+
+                    //Outlet velocity is set to drain the reservoir to the minimum storage.
+                    outlet_velocity_meters_per_second =
+                            (state.current_storage_height_meters - parameters.minimum_storage_meters) / delta_time_seconds;
+                    outlet.adjust_velocity(outlet_velocity_meters_per_second);
+                    //Set storage to minimum storage.
+                    state.current_storage_height_meters = parameters.minimum_storage_meters;
+
+                    excess_water_meters = 0.0;
+                }
+
+                return outlet_velocity_meters_per_second;
+            }
+
+            reservoir_parameters parameters;
+            reservoir_state state;
+            std::tuple<Outlets...> outlets;
+        };
+    }
+}
+
+#endif //NGEN_RESERVOIR_INLINE_HPP
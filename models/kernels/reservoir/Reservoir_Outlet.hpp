@@ -57,6 +57,16 @@ namespace Reservoir{
              */
             double get_previously_calculated_velocity_meters_per_second();
 
+            /**
+             * @brief Prepare the outlet to calculate velocities with the given reservoir parameters.
+             *
+             * This does nothing by default; outlets that can tabulate their velocity override it to build their table.
+             *
+             * @param parameters_struct reservoir parameters struct
+             * @see reservoir_parameters::outlet_table_tolerance_meters_per_second
+             */
+            virtual void tabulate(const reservoir_parameters &parameters_struct);
+
             /**
              * @brief Function to update and return the velocity in meters per second of the discharge through the outlet.
              *
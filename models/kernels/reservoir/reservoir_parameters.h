@@ -1,10 +1,32 @@
 #ifndef NGEN_RESERVOIR_PARAMETERS_H
 #define NGEN_RESERVOIR_PARAMETERS_H
 
+/** How a reservoir with a time step solves for its storage over each time step. */
+enum class reservoir_solver
+{
+    /** A single explicit step over the whole time step. */
+    fixed_step,
+    /**
+     * Explicit sub-steps, each halved until the storage from it agrees with that from two half sub-steps to within
+     * ``solver_tolerance_meters``, but no smaller than a ``solver_max_substeps``-th of the time step.
+     */
+    adaptive
+};
+
 struct reservoir_parameters
 {
     double minimum_storage_meters;
     double maximum_storage_meters;
+    reservoir_solver solver = reservoir_solver::fixed_step;
+    /** For the adaptive solver, the largest acceptable estimated error of a sub-step's storage, in meters. */
+    double solver_tolerance_meters = 1.0e-6;
+    /** For the adaptive solver, the number of sub-steps of the smallest allowed sub-step, which bounds its cost. */
+    int solver_max_substeps = 64;
+    /**
+     * The largest acceptable error, in meters per second, of an exponential outlet velocity read from a table built
+     * over the storage range in place of computing it; 0 computes every velocity.
+     */
+    double outlet_table_tolerance_meters_per_second = 0.0;
 };
 
 #endif //NGEN_RESERVOIR_PARAMETERS_H
@@ -8,16 +8,132 @@
 #include "lstm_params.h"
 #include "lstm_config.h"
 #include "lstm_state.h"
+#include <memory>
 #include <unordered_map>
 
 #include <torch/torch.h>
 
 typedef std::unordered_map< std::string, std::unordered_map< std::string, double> > ScaleParams;
 
+/**
+ * Read the mean and standard deviation of each input and output of an LSTM model from a CSV file.
+ *
+ * @param path The CSV file, with a header and rows of the variable name, mean, and standard deviation.
+ * @return The mean and standard deviation of each variable.
+ */
+ScaleParams read_scale_params(std::string path);
+
 using namespace std;
 
 namespace lstm {
 
+    /**
+     * Read the initial hidden and cell states of an LSTM model from a CSV file.
+     *
+     * @param initial_state_path The CSV file, with a header and two columns, of the hidden and the cell states.
+     * @param h Set to the hidden state.
+     * @param c Set to the cell state.
+     */
+    void read_initial_state(const std::string& initial_state_path, std::vector<double>& h, std::vector<double>& c);
+
+    /** The number of inputs of the model each time step: the eight forcings, then the area, latitude and longitude. */
+    const int NUM_INPUTS = 11;
+
+    /**
+     * The normalization of the inputs and the output of an LSTM model, looked up once from its scaling parameters so
+     * that time steps need no lookups by variable name.
+     */
+    struct lstm_scaling {
+        /** The mean of each input, in the model's input order. */
+        double input_means[NUM_INPUTS];
+        /** The standard deviation of each input, in the model's input order. */
+        double input_std_devs[NUM_INPUTS];
+        double output_mean;
+        double output_std_dev;
+
+        lstm_scaling();
+
+        explicit lstm_scaling(ScaleParams& scale);
+    };
+
+    /**
+     * Normalize the inputs of a time step of an LSTM model, in the model's input order.
+     *
+     * @param scaling The normalization of the model.
+     * @param forcings The eight forcings, in the order of the parameters of @ref lstm_model::run.
+     * @param params The catchment's parameters.
+     * @param inputs Set to the @ref NUM_INPUTS normalized inputs.
+     */
+    void normalize_inputs(const lstm_scaling& scaling, const double* forcings, const lstm_params& params, float* inputs);
+
+    /**
+     * @return A buffer of @p rows rows of model inputs on the host, pinned when @p device is a GPU, so that copies of it
+     *         to the device may be asynchronous.
+     */
+    torch::Tensor make_host_inputs(long rows, torch::Device device);
+
+    /**
+     * Load the TorchScript model of an LSTM configuration to a device, ready to run forward passes.
+     *
+     * The model is put in evaluation mode and, when @p config asks, frozen and optimized for inference (folding its
+     * parameters into constants and fusing its operations) by ``torch::jit::optimize_for_inference``.  Any thread pool
+     * sizes @p config gives are set, by @ref set_torch_threads.
+     *
+     * @param config The configuration of the model.
+     * @param device The device to load the model to.
+     * @return The loaded model.
+     */
+    torch::jit::script::Module load_model(const lstm_config& config, torch::Device device);
+
+    /**
+     * A loaded TorchScript model of an LSTM configuration, with the normalization of its inputs and output.
+     *
+     * Forward passes do not change the model, as the hidden and cell states are passed in and returned each time step,
+     * so one loaded model serves any number of catchments, from any threads.  Copies of @ref model share its
+     * parameters.
+     */
+    struct lstm_shared_model {
+        torch::jit::script::Module model;
+        ScaleParams scale;
+        lstm_scaling scaling;
+    };
+
+    /**
+     * Get the loaded model of an LSTM configuration on a device, shared by every LSTM model and batch of the process
+     * with the same model file, normalization file, device and inference optimization.
+     *
+     * The first request for a model loads it, by @ref load_model, and reads its normalization; later requests share
+     * it for as long as anything holds it, only setting the thread pool sizes @p config gives.
+     *
+     * @param config The configuration of the model.
+     * @param device The device the model runs on.
+     * @return The loaded model.
+     */
+    std::shared_ptr<const lstm_shared_model> shared_model(const lstm_config& config, torch::Device device);
+
+    /**
+     * Set the number of threads of LibTorch's intra-op and inter-op thread pools, which every LSTM model of the
+     * process shares.
+     *
+     * LibTorch only allows the inter-op pool to be sized once, before it first runs work, so later sizes of it are
+     * ignored, with a warning if they differ.
+     *
+     * @param intra_op_threads The number of intra-op threads, or ``0`` to leave it as it is.
+     * @param inter_op_threads The number of inter-op threads, or ``0`` to leave it as it is.
+     */
+    void set_torch_threads(int intra_op_threads, int inter_op_threads);
+
+    /**
+     * Size LibTorch's thread pools to match ngen's own threading, so that they do not oversubscribe the CPUs the
+     * process may run on (e.g., those an MPI launcher bound its rank to).
+     *
+     * Each pool not already sized by the config of a model gets an equal share of those CPUs per catchment thread, and
+     * at least one thread; by default, LibTorch would instead give each pool every CPU of the machine.
+     *
+     * @param catchment_threads The number of threads running catchments.
+     */
+    void match_torch_threads(std::size_t catchment_threads);
+
     class lstm_model {
 
     public:
@@ -107,8 +223,8 @@ namespace lstm {
          * performs three housekeeping tasks needed before running the next group of time step modeling operations:
          *
          *      * the initial maintained `current_state` is moved to `previous_state`
-         *      * a new `current_state` is created
-         *      * a new `fluxes` is created
+         *      * the state objects are swapped, so the last `previous_state` is reused for the new `current_state`
+         *      * `fluxes` is kept, and overwritten by the run
          */
         virtual void manage_state_before_next_time_step_run();
 
@@ -132,11 +248,18 @@ namespace lstm {
         /** Model fluxes */
         shared_ptr<lstm_fluxes> fluxes;
 
-        /** torch model */
+        /** The loaded model and normalization, shared with the other catchments using the same ones. */
+        std::shared_ptr<const lstm_shared_model> shared;
+
+        /** torch model, a handle of that of #shared */
         torch::jit::script::Module model;
 
-        /** Parameter scaling */
-        ScaleParams scale;
+        /** The normalization of #shared, for the inputs of each time step. */
+        lstm_scaling scaling;
+
+        /** The normalized inputs of a time step, reused each step, and their copy on the device if it is a GPU. */
+        torch::Tensor host_inputs;
+        torch::Tensor device_inputs;
     };
 }
 
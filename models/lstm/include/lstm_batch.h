@@ -0,0 +1,143 @@
+#ifndef NGEN_LSTM_BATCH_H
+#define NGEN_LSTM_BATCH_H
+
+#ifdef NGEN_LSTM_TORCH_LIB_ACTIVE
+
+#include "LSTM.h"
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <torch/script.h>
+
+namespace lstm {
+
+    /**
+     * One LSTM model run for many catchments at once, stacking them into a single batch per time step.
+     *
+     * Each member catchment keeps a row of the batch's input, hidden state and cell state tensors, which stay on the
+     * configured device between time steps.  The first member to ask for the flow of a time step reads the forcings
+     * of every member for that step, through the source each gave when it joined, and runs one forward pass for them
+     * all; the other members then take their flows from the kept results.  Results are kept until every member has
+     * taken them, so members may ask for steps in any order, e.g., from several threads or with execution lookahead.
+     *
+     * The model must accept a ``[N, 11]`` batch of normalized inputs with ``[1, N, H]`` hidden and cell states, as a
+     * ``torch.nn.LSTM`` based model does, and return ``N`` flows with the updated states.
+     */
+    class lstm_batch {
+
+    public:
+
+        /** The number of forcing values a member's source gives for each time step. */
+        static const int NUM_FORCINGS = 8;
+
+        /**
+         * Source of a member's forcings for a time step: the longwave radiation, surface pressure, specific humidity,
+         * precipitation rate, shortwave radiation, temperature, and U and V wind, in the order of
+         * @ref lstm_model::run, written to the given array of @ref NUM_FORCINGS values.
+         */
+        typedef std::function<void(long t_index, long t_delta_s, double* forcings)> forcing_source_t;
+
+        /**
+         * Get the batch shared by every catchment with the same model, normalization, device and inference optimization.
+         *
+         * A batch lasts as long as any of its members hold it, so a later catchment with a configuration of a batch
+         * that has already started running joins a new batch instead.
+         *
+         * @param config The configuration of the model.
+         * @return The batch for @p config.
+         */
+        static std::shared_ptr<lstm_batch> shared(const lstm_config& config);
+
+        /**
+         * Construct an empty batch, loading the model of @p config to its device.
+         *
+         * @param config The configuration of the model; its ``initial_state_path`` is that of each member instead.
+         */
+        explicit lstm_batch(const lstm_config& config);
+
+        /**
+         * Add a member catchment to the batch, before it first runs.
+         *
+         * @param params The parameters of the catchment.
+         * @param initial_state_path The CSV file of the catchment's initial hidden and cell states.
+         * @param source The source of the catchment's forcings.
+         * @return The member's index in the batch.
+         * @throws std::runtime_error If the batch has already run, or the initial state is not the size of those of
+         *                            the other members.
+         */
+        std::size_t add_member(const lstm_params& params, const std::string& initial_state_path,
+                               forcing_source_t source);
+
+        /**
+         * Get the flow of a member for a time step, running the batch up to that step if it has not yet.
+         *
+         * @param member The index of the member.
+         * @param t_index The index of the time step.
+         * @param t_delta_s The length of the time step, in seconds.
+         * @return The member's flow, in m^3/s.
+         * @throws std::runtime_error If the step is before the oldest kept step.
+         */
+        double get_flow(std::size_t member, long t_index, long t_delta_s);
+
+        /**
+         * Run the batch up to a time step, if it has not yet, so the members' @ref get_flow calls for it only take
+         * the kept flows; e.g. on another thread, while the members' callers compute on the host.
+         *
+         * @param t_index The index of the time step.
+         * @param t_delta_s The length of the time step, in seconds.
+         */
+        void run_to_step(long t_index, long t_delta_s);
+
+        /** @return Whether the batch runs on a GPU. */
+        bool is_on_gpu() const;
+
+        /** @return The number of members of the batch. */
+        std::size_t size();
+
+        /** @return Whether the batch has run, after which no members may be added. */
+        bool is_started();
+
+    private:
+
+        /** Move the members' initial states to the device, and start keeping flows from @p t_index, if not yet. */
+        void start(long t_index);
+
+        /** Run the forward pass of the step after the last run, for every member. */
+        void run_step(long t_index, long t_delta_s);
+
+        /** Drop the kept flows of steps every member has taken. */
+        void drop_taken_steps();
+
+        std::mutex mutex;
+        lstm_config config;
+        torch::Device device;
+        /** The loaded model, shared with the other catchments and batches using the same one, and a handle of it. */
+        std::shared_ptr<const lstm_shared_model> shared;
+        torch::jit::script::Module model;
+        lstm_scaling scaling;
+        /** The normalized inputs of every member for a time step, reused each step, and their copy on a GPU. */
+        torch::Tensor host_inputs;
+        torch::Tensor device_inputs;
+
+        std::vector<lstm_params> members;
+        std::vector<forcing_source_t> sources;
+        /** The initial hidden and cell states of every member, concatenated, until the first run. */
+        std::vector<double> initial_h;
+        std::vector<double> initial_c;
+        std::size_t hidden_size = 0;
+        torch::Tensor h_t;
+        torch::Tensor c_t;
+
+        /** The flows of every member for steps ``first_kept_step`` onward, oldest first. */
+        std::deque<std::vector<double>> kept_flows;
+        long first_kept_step = 0;
+        /** The last step each member has taken the flow of, or -1. */
+        std::vector<long> last_taken_steps;
+    };
+}
+
+#endif //NGEN_LSTM_TORCH_LIB_ACTIVE
+#endif //NGEN_LSTM_BATCH_H
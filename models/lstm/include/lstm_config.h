@@ -15,6 +15,15 @@ namespace lstm {
         std::string normalization_path;
         std::string initial_state_path;
         bool useGPU;
+        /** Whether to freeze the loaded model and optimize it for inference, with torch::jit::optimize_for_inference. */
+        bool optimize_for_inference = false;
+        /**
+         * The number of threads of LibTorch's intra-op thread pool, or ``0`` to share the CPUs among ngen's catchment
+         * threads (see @ref match_torch_threads).
+         */
+        int torch_threads = 0;
+        /** The number of threads of LibTorch's inter-op thread pool, or ``0`` to size it as ``torch_threads`` is. */
+        int torch_interop_threads = 0;
         /**
          * Constructor for instances, initializing members that correspond one-to-one with a parameter and deriving
          * @param pytorch_model_path string path to the pytorch .pt or .ptc trace file
@@ -36,8 +36,8 @@ namespace lstm {
 
     inline void to_device( lstm_state& state, torch::Device device )
     {
-      state.h_t.to(device);
-      state.c_t.to(device);
+      state.h_t = state.h_t.to(device);
+      state.c_t = state.c_t.to(device);
     }
 } //namespace lstm
 
@@ -5,6 +5,7 @@
 #include "schaake_partitioning.hpp"
 #include "Constants.h"
 #include "reservoir/Reservoir.hpp"
+#include "reservoir/Reservoir_Inline.hpp"
 #include "Pdm03.h"
 #include "GIUH.hpp"
 #include "reservoir/Reservoir_Exponential_Outlet.hpp"
@@ -40,6 +41,10 @@ namespace tshirt {
      * `get_mass_check_error_bound` function.  It is also possible to change the value of this (hard-coded in the
      * default implementation) with the protected `set_mass_check_error_bound` function.
      *
+     * Rather than each time step, mass balance can instead be checked once every so many time steps, or only at the end
+     * of a run, by setting a mass check interval with `set_mass_check_interval`.  The water of each time step is then
+     * added to running totals for the period since the last check, which `check_accumulated_mass_balance` checks.
+     *
      */
     class tshirt_model {
 
@@ -79,6 +84,14 @@ namespace tshirt {
          */
         double calc_soil_field_capacity_storage_threshold();
 
+        /**
+         * Calculate the soil field capacity storage threshold (i.e., "Sfc") of a model with the given parameters.
+         *
+         * @param model_params Model parameters tshirt_params struct.
+         * @return The calculated soil field capacity storage.
+         */
+        static double calc_soil_field_capacity_storage_threshold(const tshirt_params& model_params);
+
         /**
          * Return the smart pointer to the tshirt::tshirt_model struct for holding this object's current state.
          *
@@ -115,6 +128,41 @@ namespace tshirt {
          */
         int run(double dt, double input_storage_m, shared_ptr<pdm03_struct> et_params);
 
+        /**
+         * Set how many time steps each mass check covers, and start a new period of accounting from the current state.
+         *
+         * With an interval of ``1`` (the default), each call to `run` checks its own time step with `mass_check`.  With
+         * a larger interval, `run` instead adds the time step's input and outgoing fluxes to running totals, and every
+         * ``interval`` time steps returns the result of `check_accumulated_mass_balance`, returning
+         * ``TSHIRT_NO_ERROR`` for the time steps in between.  With an interval of ``0``, `run` never checks, leaving
+         * that to an explicit call to `check_accumulated_mass_balance`, e.g. at the end of the run.
+         *
+         * @param interval The number of time steps each mass check covers, or ``0`` to only check when asked.
+         */
+        void set_mass_check_interval(unsigned int interval);
+
+        unsigned int get_mass_check_interval();
+
+        /**
+         * Set the largest acceptable error of the groundwater outlet velocity, which is then read from a table over the
+         * groundwater storage range built now in place of calling ``exp`` each time step.
+         *
+         * @param tolerance_meters_per_second The largest acceptable velocity error, in meters per second, or ``0`` (the
+         *                                    default) to compute every velocity.
+         */
+        void set_groundwater_table_tolerance(double tolerance_meters_per_second);
+
+        /**
+         * Check that mass was conserved over the time steps since the last check, and start a new period of accounting.
+         *
+         * The storage at the start of the period plus the input of its time steps must be within the mass check error
+         * bound of the current storage plus the outgoing fluxes of its time steps; i.e., the same bound as checking a
+         * single time step, applied to the period as a whole.
+         *
+         * @return The appropriate code value indicating whether mass was conserved over the period.
+         */
+        int check_accumulated_mass_balance();
+
     protected:
 
         /**
@@ -148,20 +196,29 @@ namespace tshirt {
          * A collection of reservoirs for a Nash Cascade at the end of the lateral flow output from the subsurface soil
          * reservoir.
          */
-        vector<unique_ptr<Reservoir::Explicit_Time::Reservoir>> soil_lf_nash_res;
-        //FIXME reservoir construction sorts outlets by activation_threshold
-        //so the fixed index assumption is invalid.  However, in the current use case
-        //they both have the save activation_threshold (Sfc), but we do want percolation fluxes to happen first
+        vector<Reservoir::Explicit_Time::Inline_Reservoir<Reservoir::Explicit_Time::Inline_Linear_Outlet>> soil_lf_nash_res;
+        //Both soil outlets have the same activation_threshold (Sfc), but we do want percolation fluxes to happen first
         //so make it index 0
         /** The index of the subsurface lateral flow outlet in the soil reservoir. */
-        int lf_outlet_index = 1;
+        static constexpr std::size_t lf_outlet_index = 1;
         /** The index of the percolation flow outlet in the soil reservoir. */
-        int perc_outlet_index = 0;
-        Reservoir::Explicit_Time::Reservoir soil_reservoir;
-        Reservoir::Explicit_Time::Reservoir groundwater_reservoir;
+        static constexpr std::size_t perc_outlet_index = 0;
+        Reservoir::Explicit_Time::Inline_Reservoir<Reservoir::Explicit_Time::Inline_Linear_Outlet,
+                                                   Reservoir::Explicit_Time::Inline_Linear_Outlet> soil_reservoir;
+        Reservoir::Explicit_Time::Inline_Reservoir<Reservoir::Explicit_Time::Inline_Exponential_Outlet> groundwater_reservoir;
         shared_ptr<tshirt_fluxes> fluxes;
         /** The size of the error bound that is acceptable when performing mass check calculations. */
         double mass_check_error_bound;
+        /** The number of time steps each mass check covers, or ``0`` if checks are only made when asked. */
+        unsigned int mass_check_interval = 1;
+        /** The number of time steps run since the last mass check, when checks cover more than one time step. */
+        unsigned int steps_since_mass_check = 0;
+        /** The total storage at the start of the current mass check period. */
+        double mass_check_period_start_storage_m = 0.0;
+        /** The total input over the time steps of the current mass check period. */
+        double mass_check_period_input_m = 0.0;
+        /** The total of the fluxes leaving the system over the time steps of the current mass check period. */
+        double mass_check_period_outflow_m = 0.0;
         /** Soil field capacity storage threshold, or the level at which free drainage stops (i.e., "Sfc"). */
         double soil_field_capacity_storage_threshold;
 
@@ -176,26 +233,34 @@ namespace tshirt {
          */
         void check_valid();
 
+        /**
+         * Get the total storage of a state, across the soil, the groundwater and the Nash Cascade reservoirs.
+         *
+         * @param state The state for which to get the total storage.
+         * @return The total storage, in meters.
+         */
+        static double calc_total_storage_meters(const tshirt_state &state);
+
         /**
          * Initialize the subsurface groundwater reservoir for the model, in the `groundwater_reservoir` member field.
          *
-         * Initialize the subsurface groundwater reservoir for the model as a Reservoir object, creating the
-         * reservoir with a single outlet.  In particular, this is a Reservoir_Exponential_Outlet object, since the outlet
+         * Initialize the subsurface groundwater reservoir for the model as an Inline_Reservoir object, creating the
+         * reservoir with a single outlet.  In particular, this is an Inline_Exponential_Outlet object, since the outlet
          * requires the following be used to calculate discharge flow:
          *
          *      Cgw * ( exp(expon * S / S_max) - 1 );
          *
          * Note that this function should only be used during object construction.
          *
-         * @see Reservoir
-         * @see Reservoir_Exponential_Outlet
+         * @see Inline_Reservoir
+         * @see Inline_Exponential_Outlet
          */
         void initialize_groundwater_reservoir();
 
         /**
          * Initialize the subsurface soil reservoir for the model, in the `soil_reservoir` member field.
          *
-         * Initialize the subsurface soil reservoir for the model as a Reservoir object, creating the reservoir
+         * Initialize the subsurface soil reservoir for the model as an Inline_Reservoir object, creating the reservoir
          * with outlets for both the subsurface lateral flow and the percolation flow.  This should only be used during
          * object construction.
          *
@@ -204,14 +269,14 @@ namespace tshirt {
          * for the lateral flow and percolation flow outlets are maintained this class within the lf_outlet_index and
          * perc_outlet_index member variables respectively.
          *
-         * @see Reservoir
+         * @see Inline_Reservoir
          */
         void initialize_soil_reservoir();
 
         /**
          * Initialize the Nash Cascade reservoirs applied to the subsurface soil reservoir's lateral flow outlet.
          *
-         * Initialize the soil_lf_nash_res member, containing the collection of Reservoir objects used to create
+         * Initialize the soil_lf_nash_res member, containing the collection of Inline_Reservoir objects used to create
          * the Nash Cascade for soil_reservoir lateral flow outlet.  The analogous values for Nash Cascade storage from
          * previous_state are used for current storage of reservoirs at each given index.
          */
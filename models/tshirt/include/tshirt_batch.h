@@ -0,0 +1,185 @@
+#ifndef NGEN_TSHIRT_BATCH_H
+#define NGEN_TSHIRT_BATCH_H
+
+#include "Tshirt.h"
+#include "tshirt_fluxes.h"
+#include "tshirt_params.h"
+#include "tshirt_state.h"
+#include <memory>
+#include <vector>
+
+namespace tshirt {
+
+    /**
+     * The Tshirt hydrological model run for many catchments at once.
+     *
+     * This computes exactly what a @ref tshirt_model for each member catchment would, but with the parameters, states
+     * and fluxes of every member in contiguous arrays (one element per member), rather than in per-catchment state
+     * structs and reservoir objects.  Each time step, each stage of the model (the Schaake partitioning, the soil
+     * reservoir, each reservoir of the lateral flow Nash cascades, and the groundwater reservoir) is one loop over all
+     * the members, written to be vectorized, followed by a mass check of the whole batch.  Unlike the reservoir
+     * objects, the reservoirs of the batch do not warn of storage above their maximum.
+     *
+     * The Schaake partitioning and the PDM of the ET losses are run for every member at once by the kernels of
+     * runoff::batch, the PDM between the soil reservoir and the Nash cascades.
+     *
+     * Members with a Nash cascade shorter than the longest in the batch skip the reservoirs they do not have.
+     *
+     * As with @ref tshirt_model::set_mass_check_interval, the mass check can instead cover several time steps, in which
+     * case each time step only adds its water to per member running totals, in one more loop, and the whole batch is
+     * checked at the end of each period.
+     *
+     * The parameters, states, fluxes and inputs of the members are stored, and the stages of the model computed, in
+     * ``Real``, which is either ``double`` (@ref tshirt_batch) or ``float`` (@ref tshirt_batch_float).  In ``float``,
+     * each vector instruction covers twice the members and the arrays take half the memory bandwidth, while the results
+     * are no longer exactly those of @ref tshirt_model.  Either way, the Schaake partitioning and the ET losses are
+     * computed in ``double``, as are the storage totals and running totals of the mass checks, so they do not lose
+     * precision over a long run.
+     *
+     * @tparam Real The type the members' values are stored and computed in, ``double`` or ``float``.
+     */
+    template <typename Real>
+    class basic_tshirt_batch {
+
+    public:
+
+        /**
+         * Add a member catchment to the batch.
+         *
+         * As with @ref tshirt_model, an initial state with no Nash cascade storage starts with every reservoir of the
+         * cascade empty.
+         *
+         * @param model_params The parameters of the catchment.
+         * @param initial_state The initial state of the catchment.
+         * @return The member's index in the batch.
+         * @throws std::invalid_argument If the Nash cascade storage of @p initial_state is neither empty nor of size
+         *                               ``nash_n``.
+         */
+        std::size_t add_member(const tshirt_params& model_params, const tshirt_state& initial_state = tshirt_state());
+
+        /**
+         * Run every member of the batch to the next time step.
+         *
+         * @param dt The time step size in seconds.
+         * @param input_storage_m The amount of water entering each member's system this time step, in meters.
+         * @param et_params The ET parameters struct of each member.
+         * @return The number of members whose mass check failed, or ``0`` if this time step ends no mass check period.
+         */
+        std::size_t run(double dt, const std::vector<Real>& input_storage_m,
+                        const std::vector<std::shared_ptr<pdm03_struct>>& et_params);
+
+        /** @return The number of members of the batch. */
+        std::size_t size() const;
+
+        /**
+         * Get the state of a member after its last time step; i.e., what @ref tshirt_model::get_current_state would
+         * give.
+         *
+         * @param member The index of the member.
+         */
+        tshirt_state get_state(std::size_t member) const;
+
+        /**
+         * Get the fluxes of a member for its last time step; i.e., what @ref tshirt_model::get_fluxes would give.
+         *
+         * @param member The index of the member.
+         */
+        tshirt_fluxes get_fluxes(std::size_t member) const;
+
+        /**
+         * Get the result of the mass check of a member for its last time step.
+         *
+         * @param member The index of the member.
+         * @return The appropriate code value indicating whether mass was conserved, as from @ref tshirt_model::run.
+         */
+        int get_mass_check_result(std::size_t member) const;
+
+        double get_mass_check_error_bound() const;
+
+        /**
+         * Set how many time steps each mass check covers, and start a new period of accounting from the current states.
+         *
+         * @param interval The number of time steps each mass check covers, or ``0`` to only check when asked.
+         * @see tshirt_model::set_mass_check_interval
+         */
+        void set_mass_check_interval(unsigned int interval);
+
+        unsigned int get_mass_check_interval() const;
+
+        /**
+         * Check the mass balance of every member over the time steps since the last check, setting each member's mass
+         * check result, and start a new period of accounting.
+         *
+         * @return The number of members whose mass check failed.
+         * @see tshirt_model::check_accumulated_mass_balance
+         */
+        std::size_t check_accumulated_mass_balance();
+
+    private:
+
+        /** Set the mass check results, from the states before and after the step just run. */
+        std::size_t mass_check(double dt, const std::vector<Real>& input_storage_m);
+
+        /** @return The total storage of each member, across its soil, groundwater and Nash cascade reservoirs. */
+        std::vector<double> calc_total_storage_m() const;
+
+        /**
+         * The size of the error bound that is acceptable when performing mass check calculations; that of
+         * @ref tshirt_model in ``double``, and in ``float`` what rounding the members' storage to ``float`` allows.
+         */
+        double mass_check_error_bound = sizeof(Real) < sizeof(double) ? 0.00001 : 0.000001;
+
+        // Per member parameters
+        std::vector<double> schaake_constant;          //!< "Cschaake", in double as the partitioning is
+        std::vector<Real> max_soil_storage_m;          //!< "Ssmax"
+        std::vector<Real> soil_field_capacity_m;       //!< "Sfc", the activation threshold of both soil outlets
+        std::vector<Real> lateral_flow_coefficient;    //!< "Klf"
+        std::vector<Real> percolation_coefficient;     //!< satdk * slope
+        std::vector<Real> max_lateral_flow;
+        std::vector<Real> nash_coefficient;            //!< "Kn"
+        std::vector<int> nash_n;
+        std::vector<Real> groundwater_coefficient;     //!< "Cgw"
+        std::vector<Real> groundwater_expon;
+        std::vector<Real> max_groundwater_storage_m;   //!< "Sgwmax"
+
+        // Per member state
+        std::vector<Real> soil_storage_m;
+        /**
+         * The storage of each soil reservoir, which (as in @ref tshirt_model) does not have the ET loss taken out, so
+         * differs from ``soil_storage_m``.
+         */
+        std::vector<Real> soil_reservoir_storage_m;
+        std::vector<Real> groundwater_storage_m;
+        /** For each reservoir of the Nash cascades, its storage in each member, or 0.0 if the member does not have it. */
+        std::vector<std::vector<Real>> nash_storage_m;
+
+        // The total storage of each member before its last time step, for the mass check
+        std::vector<double> previous_storage_m;
+
+        // Per member fluxes
+        std::vector<Real> surface_runoff_m_per_s;
+        std::vector<Real> groundwater_flow_m_per_s;
+        std::vector<Real> percolation_flow_m_per_s;
+        std::vector<Real> lateral_flow_m_per_s;
+        std::vector<Real> et_loss_m;
+
+        std::vector<int> mass_check_results;
+
+        /** The number of time steps each mass check covers, or ``0`` if checks are only made when asked. */
+        unsigned int mass_check_interval = 1;
+        /** The number of time steps run since the last mass check, when checks cover more than one time step. */
+        unsigned int steps_since_mass_check = 0;
+        // Per member totals of the current mass check period, when checks cover more than one time step
+        std::vector<double> mass_check_period_start_storage_m;
+        std::vector<double> mass_check_period_input_m;
+        std::vector<double> mass_check_period_outflow_m;
+    };
+
+    /** The Tshirt model run for many catchments at once, computing exactly what a @ref tshirt_model for each would. */
+    typedef basic_tshirt_batch<double> tshirt_batch;
+
+    /** The Tshirt model run for many catchments at once, with the members' values stored in single precision. */
+    typedef basic_tshirt_batch<float> tshirt_batch_float;
+}
+
+#endif //NGEN_TSHIRT_BATCH_H
@@ -83,7 +83,7 @@ extern void conceptual_reservoir_flux_calc(struct conceptual_reservoir *da_reser
                                            double *primary_flux,double *secondary_flux);
 
 extern double convolution_integral(double runoff_m, int num_giuh_ordinates,
-                                   double *giuh_ordinates, double *runoff_queue_m_per_timestep);
+                                   const double *giuh_ordinates, double *runoff_queue_m_per_timestep);
 
 extern double nash_cascade(double flux_lat_m, int num_lateral_flow_nash_reservoirs,
                            double K_nash, double *nash_storage);
@@ -132,7 +132,7 @@ extern int run(NWM_soil_parameters& NWM_soil_params,
                conceptual_reservoir& gw_reservoir,
                conceptual_reservoir& soil_reservoir,
                int num_timesteps,
-               double* giuh_ordinates,
+               const double* giuh_ordinates,
                int num_giuh_ordinates,
                double *runoff_queue_m_per_timestep,
                double field_capacity_atm_press_fraction,
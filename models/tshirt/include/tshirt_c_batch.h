@@ -0,0 +1,126 @@
+#ifndef NGEN_TSHIRT_C_BATCH_H
+#define NGEN_TSHIRT_C_BATCH_H
+
+#include "tshirt_c.h"
+#include <cstddef>
+#include <vector>
+
+/**
+ * The C-style Tshirt (CFE) model of tshirt_c.h run for many catchments at once.
+ *
+ * This computes exactly what a one time step call to tshirt_c.h's ``run`` does for each member catchment, but with
+ * the parameters, states and fluxes of every member in contiguous arrays (one element per member), rather than in
+ * per-catchment reservoir structs, GIUH runoff queues and Nash cascade storage.  Each time step, each stage of the
+ * model (the Schaake partitioning, the soil reservoir, the groundwater reservoir, each ordinate of the GIUH
+ * convolution, and each reservoir of the lateral flow Nash cascades) is one loop over all the members, written to be
+ * vectorized, with the Schaake partitioning by runoff::batch::schaake_partitioning_scheme.
+ *
+ * The GIUH ordinates and runoff queues of all the members are in buffers shared by the batch, with one array per
+ * ordinate index.  Members with fewer ordinates than the most in the batch have zero ordinates (and so an always empty
+ * queue) past their own, and members with a Nash cascade shorter than the longest in the batch skip the reservoirs
+ * they do not have (so a member with no reservoirs passes its lateral flow straight through).
+ *
+ * As the ``Tshirt_C_Realization`` sets them up, the soil reservoir of each member must have two (non-exponential)
+ * outlets, and the groundwater reservoir an exponential one.
+ */
+class tshirt_c_batch {
+
+public:
+
+    /**
+     * Add a member catchment to the batch.
+     *
+     * @param NWM_soil_params The soil parameters of the catchment.
+     * @param gw_reservoir The (exponential) groundwater reservoir of the catchment, with its initial storage.
+     * @param soil_reservoir The (two outlet) soil reservoir of the catchment, with its initial storage.
+     * @param giuh_ordinates The GIUH ordinates of the catchment.
+     * @param Schaake_adjusted_magic_constant_by_soil_type Schaake magic constant for soil type
+     * @param K_nash Nash reservoir flow constant
+     * @param num_lateral_flow_nash_reservoirs The number of reservoirs in the cascade for the lateral flow
+     * @param nash_storage The initial storage of each reservoir of the cascade, or empty for a cascade starting empty.
+     * @return The member's index in the batch.
+     * @throws std::invalid_argument If the number of Nash cascade reservoirs is negative or greater than
+     *                               ``MAX_NUM_NASH_CASCADE``, @p nash_storage is neither empty nor of that size, or
+     *                               either reservoir is not of the kind described above.
+     */
+    std::size_t add_member(const NWM_soil_parameters& NWM_soil_params,
+                           const conceptual_reservoir& gw_reservoir,
+                           const conceptual_reservoir& soil_reservoir,
+                           const std::vector<double>& giuh_ordinates,
+                           double Schaake_adjusted_magic_constant_by_soil_type,
+                           double K_nash,
+                           int num_lateral_flow_nash_reservoirs,
+                           const std::vector<double>& nash_storage = std::vector<double>());
+
+    /**
+     * Run every member of the batch to the next (one hour) time step.
+     *
+     * @param rainfall_input_m The rainfall input of each member this time step, in meters.
+     * @throws std::invalid_argument If @p rainfall_input_m does not have a value for each member.
+     */
+    void run(const std::vector<double>& rainfall_input_m);
+
+    /** @return The number of members of the batch. */
+    std::size_t size() const;
+
+    /**
+     * Get the state of a member after its last time step; i.e., the state ``run`` leaves in its reservoir, GIUH queue
+     * and Nash cascade arguments.
+     *
+     * @param member The index of the member.
+     * @param gw_reservoir Set to the member's groundwater reservoir.
+     * @param soil_reservoir Set to the member's soil reservoir.
+     * @param nash_storage Set to the storage of each reservoir of the member's Nash cascade.
+     * @param giuh_runoff_queue_m Set to the member's GIUH runoff queue, of size one more than its number of ordinates.
+     */
+    void get_state(std::size_t member, conceptual_reservoir& gw_reservoir, conceptual_reservoir& soil_reservoir,
+                   std::vector<double>& nash_storage, std::vector<double>& giuh_runoff_queue_m) const;
+
+    /**
+     * Get the fluxes of a member for its last time step; i.e., what ``run`` records in its ``fluxes`` argument.
+     *
+     * @param member The index of the member.
+     */
+    tshirt_c_result_fluxes get_fluxes(std::size_t member) const;
+
+private:
+
+    friend class tshirt_c_device_batch;
+
+    // Per member parameters
+    std::vector<double> soil_water_capacity_m;          //!< smcmax * D
+    std::vector<double> schaake_constant;
+    std::vector<double> soil_storage_max_m;
+    std::vector<double> soil_coeff_primary;
+    std::vector<double> soil_exponent_primary;
+    std::vector<double> soil_storage_threshold_primary_m;
+    std::vector<double> soil_coeff_secondary;
+    std::vector<double> soil_exponent_secondary;
+    std::vector<double> soil_storage_threshold_secondary_m;
+    std::vector<double> gw_storage_max_m;
+    std::vector<double> gw_coeff_primary;
+    std::vector<double> gw_exponent_primary;
+    std::vector<double> K_nash;
+    std::vector<int> num_nash_reservoirs;
+    std::vector<int> num_giuh_ordinates;
+    /** For each GIUH ordinate index, the ordinate of each member, or 0.0 if the member has fewer ordinates. */
+    std::vector<std::vector<double>> giuh_ordinates;
+
+    // Per member state
+    std::vector<double> soil_storage_m;
+    std::vector<double> gw_storage_m;
+    /** For each GIUH ordinate index, the runoff queued in each member for that many time steps ahead. */
+    std::vector<std::vector<double>> giuh_runoff_queue_m;
+    /** For each reservoir of the Nash cascades, its storage in each member, or 0.0 if the member does not have it. */
+    std::vector<std::vector<double>> nash_storage_m;
+
+    // Per member fluxes
+    std::vector<double> timestep_rainfall_input_m;
+    std::vector<double> Schaake_output_runoff_m;
+    std::vector<double> giuh_runoff_m;
+    std::vector<double> nash_lateral_runoff_m;
+    std::vector<double> flux_from_deep_gw_to_chan_m;
+    std::vector<double> Qout_m;
+};
+
+#endif //NGEN_TSHIRT_C_BATCH_H
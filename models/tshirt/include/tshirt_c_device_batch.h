@@ -0,0 +1,135 @@
+#ifndef NGEN_TSHIRT_C_DEVICE_BATCH_H
+#define NGEN_TSHIRT_C_DEVICE_BATCH_H
+
+#include "tshirt_c_batch.h"
+#include <cstddef>
+#include <vector>
+
+/**
+ * The members of a tshirt_c_batch, run on an accelerator (e.g. a GPU) with OpenMP target offloading.
+ *
+ * This computes exactly what tshirt_c_batch::run does for each member, with the parameters, state and fluxes of the
+ * members moved to the device once, when constructed, and staying there across time steps.  The forcing of a block of
+ * time steps is moved with ``set_forcing``, each time step is then one kernel over the members, and only what is asked
+ * for is copied back: the outflows of a step with ``get_Qout``, or everything with ``copy_to``, e.g. to checkpoint.
+ *
+ * Each member's whole time step is one iteration of the kernel, rather than tshirt_c_batch's loop per stage, so that a
+ * time step is one launch; the GIUH runoff queues are circular, rather than shifted each step, so no copies are made.
+ *
+ * The kernel runs on the default device where models_tshirt is built with ``OPENMP_OFFLOAD_ACTIVE`` and a compiler
+ * offloading to it (see ``OPENMP_OFFLOAD_FLAGS``) and, otherwise, on the host, vectorized as tshirt_c_batch is.
+ */
+class tshirt_c_device_batch {
+
+public:
+
+    /**
+     * Move the members of a batch, with their state after its last time step, to the device.
+     *
+     * @param batch The batch of members to run.
+     */
+    explicit tshirt_c_device_batch(const tshirt_c_batch& batch);
+
+    tshirt_c_device_batch(const tshirt_c_device_batch&) = delete;
+
+    tshirt_c_device_batch& operator=(const tshirt_c_device_batch&) = delete;
+
+    /** Release the members and forcing held on the device. */
+    ~tshirt_c_device_batch();
+
+    /**
+     * Move the rainfall of a block of time steps to the device, replacing any set before.
+     *
+     * @param rainfall_input_m The rainfall input of each member, in meters, for each time step in turn; i.e., that of
+     *                         member ``m`` at step ``s`` is at ``s * size() + m``.
+     * @param steps The number of time steps.
+     * @throws std::invalid_argument If @p rainfall_input_m does not have a value for each member at each step.
+     */
+    void set_forcing(const std::vector<double>& rainfall_input_m, std::size_t steps);
+
+    /** @return The number of time steps of forcing set. */
+    std::size_t get_forcing_steps() const;
+
+    /**
+     * Run every member to the next (one hour) time step, on the device.
+     *
+     * @param step The time step, of those of the forcing set, whose rainfall to use.
+     * @throws std::out_of_range If @p step is not one of the forcing's.
+     */
+    void run(std::size_t step);
+
+    /**
+     * Copy the outflow of each member for its last time step from the device; i.e., the ``Qout_m`` of its fluxes.
+     *
+     * @param outflow_m Set to the outflow of each member.
+     */
+    void get_Qout(std::vector<double>& outflow_m) const;
+
+    /**
+     * Copy the state and fluxes of every member from the device into the batch it was constructed from, so that
+     * batch's ``get_state`` and ``get_fluxes`` are those after the last time step run here.
+     *
+     * @param batch The batch this was constructed from.
+     * @throws std::invalid_argument If @p batch does not have the members of this.
+     */
+    void copy_to(tshirt_c_batch& batch) const;
+
+    /** @return The number of members of the batch. */
+    std::size_t size() const;
+
+    /** @return Whether time steps run on an accelerator, rather than on the host. */
+    static bool is_offloaded();
+
+private:
+
+    /** The per member values in ``values``, each an array of one element per member. */
+    enum field {
+        soil_water_capacity_m,
+        schaake_constant,
+        soil_storage_max_m,
+        soil_coeff_primary,
+        soil_exponent_primary,
+        soil_storage_threshold_primary_m,
+        soil_coeff_secondary,
+        soil_exponent_secondary,
+        soil_storage_threshold_secondary_m,
+        gw_storage_max_m,
+        gw_coeff_primary,
+        gw_exponent_primary,
+        K_nash,
+        soil_storage_m,
+        gw_storage_m,
+        timestep_rainfall_input_m,
+        Schaake_output_runoff_m,
+        giuh_runoff_m,
+        nash_lateral_runoff_m,
+        flux_from_deep_gw_to_chan_m,
+        Qout_m,
+        num_fields
+    };
+
+    /** @return The offset in ``values`` of the array for a field. */
+    std::size_t offset(field f) const { return f * members; }
+
+    /** @return The offset in ``values`` of the array for the runoff queued @p i time steps ahead. */
+    std::size_t queue_offset(std::size_t i) const;
+
+    std::size_t members;
+    std::size_t num_ordinates;
+    std::size_t num_nash;
+    /** The queue array of the runoff for the coming time step, which then moves on by one. */
+    std::size_t queue_head = 0;
+    std::size_t forcing_steps = 0;
+
+    /**
+     * Every field, then each GIUH ordinate index's ordinates, its runoff queue, and each Nash cascade reservoir's
+     * storage, each an array of one element per member; these are mapped to the device for the life of this.
+     */
+    std::vector<double> values;
+    /** The number of Nash cascade reservoirs of each member. */
+    std::vector<int> num_nash_reservoirs;
+    /** The rainfall of each time step then member of the forcing set, mapped to the device until replaced. */
+    std::vector<double> forcing;
+};
+
+#endif //NGEN_TSHIRT_C_DEVICE_BATCH_H
@@ -1,34 +1,125 @@
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <string>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <future>
+#include <numeric>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "realizations/catchment/Formulation_Manager.hpp"
 #include <Catchment_Formulation.hpp>
 #include <HY_Features.hpp>
+#include <HY_PointHydroNexus.hpp>
 
 #include "NGenConfig.h"
 #include "tshirt_params.h"
 
 #include <FileChecker.h>
+#include <ThreadPool.hpp>
+#include <AsyncOutputWriter.hpp>
+#include <WavefrontScheduler.hpp>
+#include <AsyncDataProvider.hpp>
+#include <IdSelector.hpp>
+#include <ChannelRouting.hpp>
+#include <NexusOutputWriterFactory.hpp>
+#include <NexusInflowMatrix.hpp>
+#include <FeatureCache.hpp>
+#include <RemoteObject.hpp>
+#include <Checkpoint.hpp>
+#include <SpinUp.hpp>
+#include <TimeBlock.hpp>
+#include <CatchmentFlow.hpp>
+#include <Profiler.hpp>
+#include <StartupProfile.hpp>
+#include <MemoryReport.hpp>
+#include <CapacityEstimate.hpp>
+#include <StepArena.hpp>
+#include <Logger.hpp>
+#include <RunProgress.hpp>
+#include <StatusDump.hpp>
+#include <Timestamp_Generator.h>
+#include <CatchmentOutputWriter.hpp>
+#include <ParquetCatchmentOutputWriter.hpp>
 #include <boost/algorithm/string.hpp>
+#include "core/AutoTune.hpp"
 
-#ifdef WRITE_PID_FILE_FOR_GDB_SERVER
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <fcntl.h>
+#include <ftw.h>
+#include <spawn.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
 #include <unistd.h>
-#endif // WRITE_PID_FILE_FOR_GDB_SERVER
+
+extern char **environ;
 
 #ifdef ACTIVATE_PYTHON
 #include "python/InterpreterUtil.hpp"
+#include "Python_Worker_Pool.hpp"
 #endif // ACTIVATE_PYTHON
     
 #ifdef NGEN_ROUTING_ACTIVE
 #include "routing/Routing_Py_Adapter.hpp"
+#include "routing/Routing_Pipeline.hpp"
 #endif // NGEN_ROUTING_ACTIVE
 
+#ifdef NGEN_LSTM_TORCH_LIB_ACTIVE
+#include "LSTM.h"
+#endif // NGEN_LSTM_TORCH_LIB_ACTIVE
+
 std::string catchmentDataFile = "";
 std::string nexusDataFile = "";
 std::string REALIZATION_CONFIG_PATH = "";
 bool is_subdivided_hydrofabric_wanted = false;
+bool is_hydrofabric_cache_wanted = false;
+bool is_slim_hydrofabric_wanted = false;
+bool is_cycle_mode_wanted = false;
+std::string RESTART_PATH = "";
+std::string CATCHMENT_COSTS_PATH = "";
+std::string DRY_RUN_COEFFICIENTS_PATH = "";
+
+#ifndef HF_CACHE_CLI_FLAG
+#define HF_CACHE_CLI_FLAG "--hydrofabric-cache"
+#endif
+
+#ifndef HF_SLIM_CLI_FLAG
+#define HF_SLIM_CLI_FLAG "--slim-hydrofabric"
+#endif
+
+#ifndef RESTART_CLI_OPTION
+#define RESTART_CLI_OPTION "--restart"
+#endif
+
+#ifndef CYCLES_CLI_FLAG
+#define CYCLES_CLI_FLAG "--cycles"
+#endif
+
+#ifndef CATCHMENT_COSTS_CLI_OPTION
+#define CATCHMENT_COSTS_CLI_OPTION "--catchment-costs"
+#endif
+
+#ifndef DRY_RUN_CLI_OPTION
+#define DRY_RUN_CLI_OPTION "--dry-run"
+#endif
+
+#ifndef TARGET_NEXUS_CLI_OPTION
+#define TARGET_NEXUS_CLI_OPTION "--target-nexus"
+#endif
+
+#ifndef AUTOTUNE_CLI_OPTION
+#define AUTOTUNE_CLI_OPTION "--autotune"
+#endif
+
+#ifndef AUTOTUNE_STEPS_CLI_OPTION
+#define AUTOTUNE_STEPS_CLI_OPTION "--autotune-steps"
+#endif
 
 #ifdef NGEN_MPI_ACTIVE
 
@@ -36,17 +127,30 @@ bool is_subdivided_hydrofabric_wanted = false;
 #define MPI_HF_SUB_CLI_FLAG "--subdivided-hydrofabric"
 #endif
 
+#ifndef MPI_HF_SHARED_CLI_FLAG
+#define MPI_HF_SHARED_CLI_FLAG "--node-shared-hydrofabric"
+#endif
+
+#ifndef MPI_HF_COLLECTIVE_CLI_FLAG
+#define MPI_HF_COLLECTIVE_CLI_FLAG "--collective-hydrofabric"
+#endif
+
 #include <mpi.h>
 #include "parallel_utils.h"
 #include "core/Partition_Parser.hpp"
 #include <HY_Features_MPI.hpp>
+#include <NexusReduceScatter.hpp>
 
 std::string PARTITION_PATH = "";
 int mpi_rank;
 int mpi_num_procs;
+//The thread support of the MPI library, which must be at least MPI_THREAD_FUNNELED to run catchment threads
+int mpi_thread_support;
+bool is_node_shared_hydrofabric_wanted = false;
+bool is_collective_hydrofabric_wanted = false;
 #endif
 
-std::unordered_map<std::string, std::ofstream> nexus_outfiles;
+std::unique_ptr<nexus_output::NexusOutputWriter> nexus_writer;
 
 //Note: Use below if developing in-memory transfer of nexus flows to routing
 //std::unordered_map<std::string, std::vector<double>> nexus_flows;
@@ -63,7 +167,656 @@ pdm03_struct get_et_params() {
     return pdm_et_data;
 }
 
+/**
+ * Remove an optional flag, given in any position, from the command line args.
+ *
+ * @return Whether the flag was given.
+ */
+bool take_cli_flag(int& argc, char* argv[], const char* flag) {
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], flag) == 0) {
+            std::copy(argv + i + 1, argv + argc, argv + i);
+            --argc;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Remove an optional option and its value, given in any position, from the command line args.
+ *
+ * @param value Set to the option's value, if it was given.
+ * @return Whether the option was given.
+ */
+bool take_cli_option(int& argc, char* argv[], const char* option, std::string& value) {
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], option) == 0) {
+            if (i + 1 >= argc) {
+                std::cout << "Missing value for option " << option << std::endl;
+                exit(-1);
+            }
+            value = argv[i + 1];
+            std::copy(argv + i + 2, argv + argc, argv + i);
+            argc -= 2;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Wait for the end time of the next warm-started cycle, given as a line of standard input.
+ *
+ * Each line holds the end time of the next cycle, formatted as in the realization config, e.g.
+ * ``2015-12-31 05:00:00``; ``quit`` or the end of input ends the run.  Before waiting, a ``Ready for next cycle``
+ * line is written to standard output, once the outputs of the last cycle are complete.  Under MPI, rank 0 reads the
+ * line and shares it with the other ranks.
+ *
+ * @param end_time Set to the epoch time of the end of the next cycle.
+ * @return Whether there is a next cycle.
+ */
+bool read_next_cycle_end(time_t& end_time) {
+    std::string line;
+    bool more = true;
+    #ifdef NGEN_MPI_ACTIVE
+    if (mpi_rank == 0) {
+    #endif
+    std::cout << "Ready for next cycle" << std::endl;
+    //Blank lines are skipped
+    while ((more = static_cast<bool>(std::getline(std::cin, line)))) {
+        boost::trim(line);
+        if (!line.empty()) {
+            break;
+        }
+    }
+    more = more && line != "quit";
+    #ifdef NGEN_MPI_ACTIVE
+    }
+    int length = more ? static_cast<int>(line.size()) : -1;
+    MPI_Bcast(&length, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    more = length >= 0;
+    if (more) {
+        line.resize(length);
+        MPI_Bcast(&line[0], length, MPI_CHAR, 0, MPI_COMM_WORLD);
+    }
+    #endif
+    if (!more) {
+        return false;
+    }
+    struct tm end_tm = tm();
+    if (strptime(line.c_str(), "%Y-%m-%d %H:%M:%S", &end_tm) == nullptr) {
+        throw std::invalid_argument("Cannot parse cycle end time '" + line + "'; expected e.g. 2015-12-31 05:00:00");
+    }
+    end_time = timegm(&end_tm);
+    return true;
+}
+
+/**
+ * Write the timing profile of the run, under the output config's ``profile_path``.
+ *
+ * The summary table is printed and written to ``profile_summary.txt``, and as JSON to ``profile_summary.json``, for
+ * comparing runs; under MPI, rank 0 gathers the statistics of every rank into them.  Each rank writes its own timeline, if one was recorded.
+ */
+void write_profile(const output_params& params) {
+    utils::Profiler::summary_t summary = utils::Profiler::collect();
+    int processes = 1;
+    int rank = 0;
+    std::string trace_tag = "";
+    #ifdef NGEN_MPI_ACTIVE
+    processes = mpi_num_procs;
+    rank = mpi_rank;
+    trace_tag = "_rank_" + std::to_string(mpi_rank);
+    std::string serialized = utils::Profiler::serialize(summary);
+    std::vector<int> offsets;
+    std::vector<char> gathered = parallel::gather_to_rank_zero(serialized.data(), serialized.size(), MPI_CHAR, mpi_rank,
+                                                               mpi_num_procs, offsets);
+    if(mpi_rank == 0) {
+      summary.clear();
+      for(int r = 0; r < mpi_num_procs; ++r) {
+        utils::Profiler::merge_serialized(std::string(gathered.data() + offsets[r], offsets[r + 1] - offsets[r]),
+                                          summary);
+      }
+    }
+    #endif
+
+    if(rank == 0) {
+      std::cout<<"Profile of "<<processes<<(processes > 1 ? " processes:" : " process:")<<std::endl;
+      utils::Profiler::write_summary(std::cout, summary, processes);
+      std::string summary_path = params.profile_path + "profile_summary.txt";
+      std::ofstream summary_file(summary_path, std::ios::trunc);
+      utils::Profiler::write_summary(summary_file, summary, processes);
+      if(!summary_file) {
+        std::cerr<<"WARNING: could not write profile summary "<<summary_path<<std::endl;
+      }
+      std::string json_path = params.profile_path + "profile_summary.json";
+      std::ofstream json_file(json_path, std::ios::trunc);
+      utils::Profiler::write_summary_json(json_file, summary, processes);
+      if(!json_file) {
+        std::cerr<<"WARNING: could not write profile summary "<<json_path<<std::endl;
+      }
+    }
+    if(params.profile_trace) {
+      std::string trace_path = params.profile_path + "profile_trace" + trace_tag + ".json";
+      if(!utils::Profiler::write_trace(trace_path, rank)) {
+        std::cerr<<"WARNING: could not write profile trace "<<trace_path<<std::endl;
+      }
+    }
+}
+
+/**
+ * Print the startup profile, the time and memory growth of each phase of startup before the models run.
+ *
+ * Under MPI, rank 0 gathers the phases of every rank and prints the average and largest of any one rank, and which
+ * rank that was, with the largest peak resident memory of any rank.
+ */
+void write_startup_profile() {
+    utils::StartupProfile::summary_t summary = utils::StartupProfile::collect();
+    int processes = 1;
+    double peak_memory_mb = utils::StartupProfile::get_peak_memory_mb();
+    #ifdef NGEN_MPI_ACTIVE
+    processes = mpi_num_procs;
+    double local_peak_memory_mb = peak_memory_mb;
+    MPI_Reduce(&local_peak_memory_mb, &peak_memory_mb, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    std::string serialized = utils::StartupProfile::serialize(summary);
+    std::vector<int> offsets;
+    std::vector<char> gathered = parallel::gather_to_rank_zero(serialized.data(), serialized.size(), MPI_CHAR, mpi_rank,
+                                                               mpi_num_procs, offsets);
+    if(mpi_rank != 0) {
+      return;
+    }
+    summary.clear();
+    for(int r = 0; r < mpi_num_procs; ++r) {
+      utils::StartupProfile::merge_serialized(std::string(gathered.data() + offsets[r], offsets[r + 1] - offsets[r]), r,
+                                              summary);
+    }
+    #endif
+
+    std::cout<<"Startup of "<<processes<<(processes > 1 ? " processes" : " process")<<", with a peak resident memory of "
+             <<std::fixed<<std::setprecision(1)<<peak_memory_mb<<" MB"<<(processes > 1 ? " on the largest rank:" : ":")
+             <<std::defaultfloat<<std::endl;
+    utils::StartupProfile::write_summary(std::cout, summary, processes);
+}
+
+/**
+ * Print the memory report of a point in the run, the bytes held by each of its major structures, with the resident
+ * and peak resident memory of the process.
+ *
+ * Under MPI, rank 0 gathers the reports of every rank and prints the smallest, mean and largest of any one rank.
+ *
+ * @param when The point in the run, e.g. "startup".
+ * @param report The structures of this process.
+ */
+void write_memory_report(const std::string& when, utils::MemoryReport report) {
+    const double mb = 1024.0 * 1024.0;
+    report.add("resident memory", utils::StartupProfile::get_resident_memory_mb() * mb);
+    report.add("peak resident memory", utils::StartupProfile::get_peak_memory_mb() * mb);
+    utils::MemoryReport::summary_t summary = report.get_summary();
+    int processes = 1;
+    #ifdef NGEN_MPI_ACTIVE
+    processes = mpi_num_procs;
+    std::string serialized = utils::MemoryReport::serialize(summary);
+    std::vector<int> offsets;
+    std::vector<char> gathered = parallel::gather_to_rank_zero(serialized.data(), serialized.size(), MPI_CHAR, mpi_rank,
+                                                               mpi_num_procs, offsets);
+    if(mpi_rank != 0) {
+      return;
+    }
+    summary.clear();
+    for(int r = 0; r < mpi_num_procs; ++r) {
+      utils::MemoryReport::merge_serialized(std::string(gathered.data() + offsets[r], offsets[r + 1] - offsets[r]),
+                                            summary);
+    }
+    #endif
+
+    std::cout<<"Memory at "<<when<<(processes > 1 ? ", per rank:" : ":")<<std::endl;
+    utils::MemoryReport::write_summary(std::cout, summary, processes);
+}
+
+/**
+ * Write the estimated sizing of the run, for a dry run: the memory of each rank, with the formulations it would
+ * construct estimated from their coefficients, then its compute time per output time step and the flows it would
+ * exchange with other ranks, as a recommendation of what to request for the run.
+ *
+ * Under MPI, rank 0 combines the estimates of every rank.
+ *
+ * @param estimate The estimate of the catchments, and remote connections, of this process.
+ * @param threads The number of catchment threads.
+ * @param time_steps The number of output time steps of the run.
+ * @param report The structures already read by this process, e.g. the hydrofabric.
+ */
+void write_dry_run_estimate(const utils::CapacityEstimate& estimate, int threads, long time_steps,
+                            utils::MemoryReport report) {
+    double formulation_bytes = 0.0;
+    for(const auto& type : estimate.get_formulation_bytes()) {
+      report.add("formulations/" + type.first, type.second);
+      formulation_bytes += type.second;
+    }
+    report.add("mpi buffers", estimate.get_boundary_bytes_per_step());
+    write_memory_report("the dry run, with the formulations estimated", report);
+
+    utils::CapacityEstimate::Totals totals;
+    totals.processes = 1;
+    totals.threads = threads;
+    totals.time_steps = time_steps;
+    //What a rank holds once it has read its hydrofabric is already resident; only its formulations are estimated
+    double local_max[4] = {estimate.get_seconds_per_step(threads), estimate.get_max_catchment_seconds_per_step(),
+                           utils::StartupProfile::get_resident_memory_mb() * 1024.0 * 1024.0 + formulation_bytes,
+                           estimate.get_boundary_bytes_per_step()};
+    double local_sum[4] = {local_max[0], estimate.get_total_seconds_per_step(), local_max[3],
+                           static_cast<double>(estimate.get_defaulted_catchment_count())};
+    double max[4], sum[4];
+    std::copy(local_max, local_max + 4, max);
+    std::copy(local_sum, local_sum + 4, sum);
+    #ifdef NGEN_MPI_ACTIVE
+    totals.processes = mpi_num_procs;
+    MPI_Reduce(local_max, max, 4, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    MPI_Reduce(local_sum, sum, 4, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    if(mpi_rank != 0) {
+      return;
+    }
+    #endif
+    totals.max_seconds_per_step = max[0];
+    totals.max_catchment_seconds_per_step = max[1];
+    totals.max_bytes = max[2];
+    totals.max_boundary_bytes_per_step = max[3];
+    totals.total_seconds_per_step = sum[0];
+    totals.serial_seconds_per_step = sum[1];
+    totals.total_boundary_bytes_per_step = sum[2];
+    if(sum[3] > 0) {
+      std::cout<<"WARN: "<<static_cast<long>(sum[3])<<" catchments have no cost coefficients of their own or of their"
+               <<" formulation type, and are estimated with the default ones"<<std::endl;
+    }
+    utils::CapacityEstimate::write_recommendation(std::cout, totals);
+    std::cout<<std::flush;
+}
+
+/**
+ * Write the cost of each catchment, the average wall time in seconds its formulation took per output time step, as
+ * the ``cat-id,weight`` lines partitionGenerator reads as catchment weights.
+ *
+ * Under MPI, rank 0 gathers the costs of every rank into the one file.
+ *
+ * @param path The path of the file to write.
+ * @param ids The id of each catchment.
+ * @param seconds The total wall time the formulation of each catchment took.
+ * @param steps The number of output time steps each catchment was run for.
+ */
+void write_catchment_costs(const std::string& path, const std::vector<std::string>& ids,
+                           const std::vector<double>& seconds, const std::vector<long>& steps) {
+    std::ostringstream lines;
+    for(std::size_t i = 0; i < ids.size(); ++i) {
+      lines<<ids[i]<<","<<(steps[i] > 0 ? seconds[i] / steps[i] : 0.0)<<"\n";
+    }
+    std::string costs = lines.str();
+    #ifdef NGEN_MPI_ACTIVE
+    std::vector<int> offsets;
+    std::vector<char> gathered = parallel::gather_to_rank_zero(costs.data(), costs.size(), MPI_CHAR, mpi_rank,
+                                                               mpi_num_procs, offsets);
+    if(mpi_rank != 0) {
+      return;
+    }
+    costs.assign(gathered.begin(), gathered.end());
+    #endif
+    std::ofstream file(path, std::ios::trunc);
+    file<<"# catchment id, average seconds per output time step\n"<<costs;
+    if(!file) {
+      std::cerr<<"WARNING: could not write catchment costs "<<path<<std::endl;
+    }
+    else {
+      std::cout<<"Wrote catchment costs to "<<path<<std::endl;
+    }
+}
+
+/**
+ * Remove a directory and everything in it, as nftw visits it.
+ */
+int remove_visited(const char* path, const struct stat*, int, struct FTW*) {
+    return ::remove(path);
+}
+
+/**
+ * The command line of an autotuning run: the arguments this run was given, with every option but the autotuning ones,
+ * and the realization config replaced by @p trial_config_path.
+ *
+ * The realization config is the fifth positional argument, counted past the options, each followed by its value, and
+ * the flags, which all start with "--", given before it.
+ *
+ * @param args The arguments of this run, before any option was taken from them.
+ * @param executable The path of the executable to run.
+ * @param trial_config_path The realization config of the run.
+ */
+std::vector<std::string> autotune_trial_args(const std::vector<std::string>& args, const std::string& executable,
+                                             const std::string& trial_config_path) {
+    const std::vector<std::string> value_options = {RESTART_CLI_OPTION, CATCHMENT_COSTS_CLI_OPTION, TARGET_NEXUS_CLI_OPTION,
+                                                    DRY_RUN_CLI_OPTION, AUTOTUNE_CLI_OPTION, AUTOTUNE_STEPS_CLI_OPTION};
+    std::vector<std::string> trial_args = {executable};
+    int positional = 0;
+    for(std::size_t i = 1; i < args.size(); ++i) {
+      if(std::find(value_options.begin(), value_options.end(), args[i]) != value_options.end() && i + 1 < args.size()) {
+        if(args[i] != AUTOTUNE_CLI_OPTION && args[i] != AUTOTUNE_STEPS_CLI_OPTION) {
+          trial_args.push_back(args[i]);
+          trial_args.push_back(args[i + 1]);
+        }
+        ++i;
+      }
+      else if(args[i].compare(0, 2, "--") != 0 && ++positional == 5) {
+        trial_args.push_back(trial_config_path);
+      }
+      else {
+        trial_args.push_back(args[i]);
+      }
+    }
+    return trial_args;
+}
+
+/**
+ * Tune the settings of the realization config for this host and domain, writing the fastest found to a tuning file.
+ *
+ * Each candidate of an autotune::Coordinate_Sweep of the autotune::default_knobs is timed by a run of this
+ * executable, with the same arguments but a realization config of its own (see autotune::trial_config) covering the
+ * first time steps of the config; the time of a run is the total of autotune::TIMED_REGION in its profile.  The runs
+ * write their configs, logs and outputs in a directory next to the tuning file, which is removed once they are done,
+ * so it should be on the filesystem production runs write their outputs to.
+ *
+ * @param args The arguments of this run, as given, before any option was taken from them.
+ * @param tuning_path The path of the tuning file to write.
+ * @param window_steps The number of time steps each run times.
+ * @return The exit status of this run.
+ */
+int run_autotune(const std::vector<std::string>& args, const std::string& tuning_path, long window_steps) {
+    boost::property_tree::ptree config;
+    boost::property_tree::json_parser::read_json(REALIZATION_CONFIG_PATH, config);
+    //Tuning starts from the settings of any tuning file the config already loads
+    autotune::apply_tuning_file(config);
+
+    char executable[PATH_MAX];
+    ssize_t length = readlink("/proc/self/exe", executable, sizeof(executable) - 1);
+    if(length < 0) {
+      std::cerr<<"ERROR: unable to find the ngen executable to tune with: "<<std::strerror(errno)<<std::endl;
+      return -1;
+    }
+    executable[length] = '\0';
+
+    const std::string directory = tuning_path + ".trials/";
+    if(mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST) {
+      std::cerr<<"ERROR: unable to create the autotuning directory "<<directory<<": "<<std::strerror(errno)<<std::endl;
+      return -1;
+    }
+    const std::string trial_config_path = directory + "realization.json";
+    std::vector<std::string> trial_args = autotune_trial_args(args, executable, trial_config_path);
+    std::vector<char*> trial_argv;
+    for(std::string& arg : trial_args) {
+      trial_argv.push_back(&arg[0]);
+    }
+    trial_argv.push_back(nullptr);
+
+    std::vector<int> cpus = utils::ThreadPool::available_cpus();
+    autotune::Coordinate_Sweep sweep(autotune::default_knobs(
+        config, cpus.empty() ? std::thread::hardware_concurrency() : cpus.size(), window_steps));
+    const std::vector<autotune::Knob>& knobs = sweep.get_knobs();
+    std::vector<long> values;
+    std::size_t failures = 0;
+    while(sweep.next(values)) {
+      const std::string trial_log_path = directory + "ngen-" + std::to_string(sweep.get_runs() + 1) + ".log";
+      std::cout<<"Autotuning run "<<sweep.get_runs() + 1<<":";
+      for(std::size_t k = 0; k < knobs.size(); ++k) {
+        std::cout<<" "<<knobs[k].path<<"="<<values[k];
+      }
+      std::cout<<std::flush;
+
+      double seconds = -1;
+      try {
+        boost::property_tree::json_parser::write_json(
+            trial_config_path, autotune::trial_config(config, knobs, values, window_steps, directory));
+        std::remove((directory + "profile_summary.json").c_str());
+
+        //The run's output goes to its log, so a failed run can be looked into
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, trial_log_path.c_str(),
+                                         O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        posix_spawn_file_actions_adddup2(&actions, STDOUT_FILENO, STDERR_FILENO);
+        pid_t pid;
+        int result = posix_spawn(&pid, executable, &actions, nullptr, trial_argv.data(), environ);
+        posix_spawn_file_actions_destroy(&actions);
+        int status = 0;
+        if(result == 0 && waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+          seconds = autotune::read_region_seconds(directory + "profile_summary.json", autotune::TIMED_REGION);
+        }
+      }
+      catch(const std::exception& e) {
+        std::cout<<" ("<<e.what()<<")";
+      }
+      sweep.record(seconds);
+      if(seconds < 0) {
+        std::cout<<" failed, see "<<trial_log_path<<std::endl;
+        ++failures;
+      }
+      else {
+        std::cout<<" took "<<seconds<<" s"<<std::endl;
+      }
+    }
+
+    if(sweep.get_best_seconds() == std::numeric_limits<double>::infinity()) {
+      std::cerr<<"ERROR: no autotuning run succeeded; see the logs in "<<directory<<std::endl;
+      return -1;
+    }
+    //The logs of failed runs are kept to be looked into
+    if(failures == 0) {
+      nftw(directory.c_str(), remove_visited, 16, FTW_DEPTH | FTW_PHYS);
+    }
+    autotune::write_tuning_file(tuning_path, knobs, sweep.get_best_values());
+    std::cout<<"Wrote the fastest of "<<sweep.get_runs()<<" autotuning runs, taking "<<sweep.get_best_seconds()
+             <<" s, to "<<tuning_path<<"; set the execution tuning_file to it to use it"<<std::endl;
+    return 0;
+}
+
+/**
+ * The channel parameters of the flowpath of each catchment, from the ``channel_routing`` config.
+ *
+ * Flowpaths of its ``flowpath_data`` are matched to catchments by their ``realized_catchment``; each of their
+ * ``length_km``, ``slope_percent``, ``n`` (Manning's), ``BtmWdth`` and ``ChSlp`` (side slope) properties is optional,
+ * and the config's defaults are used for whatever is not given, including for catchments without a flowpath.
+ */
+network::ChannelRouting::params_source_t load_channel_params(const channel_routing_params& config) {
+    muskingum_cunge::channel_params defaults{config.length_m, config.slope, config.mannings_n, config.bottom_width_m,
+                                             config.side_slope};
+    auto flowpath_params = std::make_shared<std::unordered_map<std::string, muskingum_cunge::channel_params>>();
+    if(!config.flowpath_data.empty()) {
+      geojson::GeoJSON flowpaths = geojson::read(config.flowpath_data);
+      for(const auto& flowpath : *flowpaths) {
+        if(!flowpath->has_key("realized_catchment")) {
+          continue;
+        }
+        muskingum_cunge::channel_params p = defaults;
+        if(flowpath->has_key("length_km")) {
+          p.length_m = flowpath->get_property("length_km").as_real_number() * 1000.0;
+        }
+        if(flowpath->has_key("slope_percent")) {
+          p.slope = flowpath->get_property("slope_percent").as_real_number() / 100.0;
+        }
+        if(flowpath->has_key("n")) {
+          p.mannings_n = flowpath->get_property("n").as_real_number();
+        }
+        if(flowpath->has_key("BtmWdth")) {
+          p.bottom_width_m = flowpath->get_property("BtmWdth").as_real_number();
+        }
+        if(flowpath->has_key("ChSlp")) {
+          p.side_slope = flowpath->get_property("ChSlp").as_real_number();
+        }
+        (*flowpath_params)[flowpath->get_property("realized_catchment").as_string()] = p;
+      }
+    }
+    return [flowpath_params, defaults](const std::string& catchment_id) {
+        auto it = flowpath_params->find(catchment_id);
+        return it != flowpath_params->end() ? it->second : defaults;
+    };
+}
+
+/**
+ * Read the features of a hydrofabric file with the given ids.
+ *
+ * Under MPI with the MPI_HF_SHARED_CLI_FLAG flag, every rank must call this for the same files at the same time, and
+ * one rank per host reads each file into memory shared by the ranks of the host, for all of them to parse.  Subdivided
+ * hydrofabric files differ by rank, so each rank reads its own.
+ *
+ * A file in object storage is read through the block cache of the node, which the ranks of the host share instead.
+ */
+geojson::GeoJSON read_hydrofabric_file(const std::string& file_path, const std::vector<std::string>& ids,
+                                       const geojson::FeatureLoadOptions& options) {
+    if (data_access::is_remote_path(file_path)) {
+      std::istringstream stream(data_access::RemoteObject(file_path).read_all());
+      return geojson::read_hydrofabric(stream, file_path, ids, options);
+    }
+    #ifdef NGEN_MPI_ACTIVE
+    if (is_node_shared_hydrofabric_wanted && !is_subdivided_hydrofabric_wanted) {
+      parallel::NodeSharedFile contents(file_path);
+      parallel::NodeSharedFile::Stream stream(contents);
+      geojson::GeoJSON features = geojson::read_hydrofabric(stream, file_path, ids, options);
+      // The shared memory is freed collectively, once every rank of the host has parsed its features
+      return features;
+    }
+    #endif // NGEN_MPI_ACTIVE
+    return geojson::read(file_path, ids, options);
+}
+
+/**
+ * Find the catchments and nexuses of the basins draining to target nexuses, for running just those basins.
+ *
+ * Only the ids and ``toid`` links of the hydrofabric are read to find them, without geometries or other properties,
+ * and the closure upstream of the targets is then loaded as the subset to run.
+ *
+ * @param target_ids The nexuses to run the basins of.
+ * @param catchment_ids Set to the catchments upstream of any of @p target_ids.
+ * @param nexus_ids Set to @p target_ids and the nexuses upstream of any of them.
+ * @throws std::invalid_argument If one of @p target_ids is not a nexus of the hydrofabric.
+ */
+void subset_upstream_of(const std::vector<std::string>& target_ids, std::vector<std::string>& catchment_ids,
+                        std::vector<std::string>& nexus_ids) {
+    geojson::FeatureLoadOptions link_options;
+    link_options.include_geometry = false;
+    link_options.properties = {"toid"};
+    geojson::GeoJSON links = is_hydrofabric_cache_wanted
+            ? geojson::read_cached(nexusDataFile, {}, true, link_options)
+            : read_hydrofabric_file(nexusDataFile, {}, link_options);
+    for(const std::string& id : target_ids) {
+      if(links->find(id) == -1) {
+        throw std::invalid_argument("Target nexus " + id + " is not in " + nexusDataFile);
+      }
+    }
+    geojson::GeoJSON catchments = is_hydrofabric_cache_wanted
+            ? geojson::read_cached(catchmentDataFile, {}, true, link_options)
+            : read_hydrofabric_file(catchmentDataFile, {}, link_options);
+    std::unordered_set<std::string> all_catchment_ids;
+    for(auto& feature : *catchments) {
+      all_catchment_ids.insert(feature->get_id());
+      links->add_feature(feature);
+    }
+
+    std::string link_key = "toid";
+    network::Network network(links, &link_key);
+    catchment_ids.clear();
+    nexus_ids.clear();
+    for(const std::string& id : network.get_upstream_ids(target_ids)) {
+      if(all_catchment_ids.count(id) != 0) {
+        catchment_ids.push_back(id);
+      }
+      else {
+        nexus_ids.push_back(id);
+      }
+    }
+}
+
+#ifdef NGEN_ROUTING_ACTIVE
+/**
+ * Hand nexus flows, kept nexus major, to routing.
+ *
+ * With MPI, every rank must call this for the same time steps, and the flows of all ranks are gathered to rank 0,
+ * which is the only rank with a router.
+ *
+ * @param local_ids The ids of this rank's nexuses.
+ * @param flows The flows, with those of nexus ``n`` at the ``s``-th step at ``flows[n * row_stride + s]``.
+ * @param row_stride The distance between the flows of consecutive nexuses.
+ * @param kept_steps The number of steps of @p flows, which must be those of @p timestamps.
+ * @param timestamps The timestamps of the kept steps.
+ * @param router The router, which may be null on ranks other than 0.
+ * @param pipeline The pipeline routing the flows as they are handed over, or null to only hand them to @p router, to
+ *                 be routed at the end of the run.
+ */
+void hand_flows_to_routing(const std::vector<std::string>& local_ids, const double* flows, std::size_t row_stride,
+                           std::size_t kept_steps, const std::vector<std::string>& timestamps,
+                           routing_py_adapter::Routing_Py_Adapter* router,
+                           routing_py_adapter::Routing_Pipeline* pipeline) {
+    std::size_t steps = timestamps.size();
+    if(!local_ids.empty() && kept_steps != steps) {
+      throw std::runtime_error("Nexus flows for routing cover " + std::to_string(kept_steps)
+                               + " time steps rather than " + std::to_string(steps) + ".");
+    }
+    #ifdef NGEN_MPI_ACTIVE
+    //Gather the ids, each ending with a newline, and the flows of each rank's nexuses, packed to rows of steps
+    std::string local_id_chars;
+    for(const auto& id : local_ids) {
+      local_id_chars += id + "\n";
+    }
+    std::vector<double> local_flows(local_ids.size() * steps);
+    for(std::size_t n = 0; n < local_ids.size(); ++n) {
+      std::copy(flows + n * row_stride, flows + n * row_stride + steps, local_flows.begin() + n * steps);
+    }
+    std::vector<int> char_offsets, flow_offsets;
+    std::vector<char> all_id_chars = parallel::gather_to_rank_zero(local_id_chars.data(), local_id_chars.size(),
+                                                                   MPI_CHAR, mpi_rank, mpi_num_procs, char_offsets);
+    std::vector<double> all_flows = parallel::gather_to_rank_zero(local_flows.data(), local_flows.size(), MPI_DOUBLE,
+                                                                  mpi_rank, mpi_num_procs, flow_offsets);
+    if(mpi_rank == 0 && steps > 0) {
+      std::vector<std::string> all_ids;
+      std::size_t start = 0;
+      for(std::size_t i = 0; i < all_id_chars.size(); ++i) {
+        if(all_id_chars[i] == '\n') {
+          all_ids.emplace_back(all_id_chars.data() + start, i - start);
+          start = i + 1;
+        }
+      }
+      if(pipeline != nullptr) {
+        pipeline->submit(all_ids, timestamps, all_flows.data(), steps);
+      }
+      else {
+        router->receive_flows(all_ids, timestamps, all_flows.data(), steps);
+      }
+    }
+    #else
+    if(steps > 0) {
+      if(pipeline != nullptr) {
+        pipeline->submit(local_ids, timestamps, flows, row_stride);
+      }
+      else {
+        router->receive_flows(local_ids, timestamps, flows, row_stride);
+      }
+    }
+    #endif
+}
+
+/**
+ * Hand the flows kept by an in memory nexus writer to routing, as for the flows of any nexus major layout.
+ *
+ * @param flows The writer, which must keep exactly the steps of @p timestamps for each of its nexuses.
+ */
+void hand_flows_to_routing(const nexus_output::MemoryNexusOutputWriter& flows, const std::vector<std::string>& timestamps,
+                           routing_py_adapter::Routing_Py_Adapter* router,
+                           routing_py_adapter::Routing_Pipeline* pipeline) {
+    hand_flows_to_routing(flows.get_nexus_ids(), flows.get_flows(), flows.get_row_stride(), flows.get_timestamps().size(),
+                          timestamps, router, pipeline);
+}
+#endif // NGEN_ROUTING_ACTIVE
+
 int main(int argc, char *argv[]) {
+    #ifdef ACTIVATE_PYTHON
+    //Workers hosting Python BMI models run this executable too, but only serve the models of the process starting them
+    if(argc == 4 && std::string(argv[1]) == PYTHON_BMI_WORKER_CLI_OPTION) {
+      return models::bmi::run_python_bmi_worker(std::stoi(argv[2]), std::stoull(argv[3]));
+    }
+    #endif // ACTIVATE_PYTHON
+
     std::cout << "NGen Framework " << ngen_VERSION_MAJOR << "."
               << ngen_VERSION_MINOR << "."
               << ngen_VERSION_PATCH << std::endl;
@@ -88,6 +841,49 @@ int main(int argc, char *argv[]) {
     //arg 5 is realization config path
     //arg 7 is the partition file path
     //arg 8 is an optional flag that driver should, if not already preprocessed this way, subdivided the hydrofabric
+    //the optional flag HF_CACHE_CLI_FLAG, given in any position, loads the hydrofabric through binary caches kept
+    //next to the GeoJSON files, see geojson::read_cached
+    //the optional flag HF_SLIM_CLI_FLAG, given in any position, loads the hydrofabric without geometries and with
+    //only the properties the driver uses
+    //the optional RESTART_CLI_OPTION followed by a checkpoint file path, given in any position, restarts the run from
+    //that checkpoint (see checkpoint_interval in the execution config)
+    //the optional flag CYCLES_CLI_FLAG, given in any position, keeps the driver running after the configured time
+    //period, reading a new end time for the next cycle from each line of standard input, see read_next_cycle_end
+    //the optional CATCHMENT_COSTS_CLI_OPTION followed by a file path, given in any position, times each catchment's
+    //formulation and writes its average cost per output time step there, for partitionGenerator to weight it by
+    //under MPI, the optional flag MPI_HF_SHARED_CLI_FLAG, given in any position, has one rank per host read each
+    //hydrofabric file into memory shared by the ranks of the host, see parallel::NodeSharedFile
+    //under MPI, the optional flag MPI_HF_COLLECTIVE_CLI_FLAG, given in any position, has rank 0 alone parse each
+    //hydrofabric file and scatter to every rank the features of its partition, see parallel::scatter_hydrofabric_file
+    //the optional TARGET_NEXUS_CLI_OPTION followed by comma separated nexus ids, given in any position, runs only the
+    //catchments and nexuses upstream of those nexuses, in place of the subset ids, see subset_upstream_of
+    //the optional DRY_RUN_CLI_OPTION followed by a file path of cost coefficients, or an empty string for the default
+    //ones, given in any position, reads the hydrofabric, partition and realization config but constructs no
+    //formulation, and writes an estimate of the memory, time and communication the run would take instead of running
+    //it, see utils::CapacityEstimate
+    //the optional AUTOTUNE_CLI_OPTION followed by a file path, given in any position, runs the first time steps of the
+    //realization config over and over, sweeping the settings that affect performance, and writes the fastest found
+    //to the file for later runs to load as their execution tuning_file instead of running the config, see
+    //run_autotune; the optional AUTOTUNE_STEPS_CLI_OPTION followed by a number sets how many time steps (default 48)
+
+    //Autotuning runs are given the options of this run, so they time the run being tuned
+    const std::vector<std::string> cli_args(argv, argv + argc);
+    is_hydrofabric_cache_wanted = take_cli_flag(argc, argv, HF_CACHE_CLI_FLAG);
+    is_slim_hydrofabric_wanted = take_cli_flag(argc, argv, HF_SLIM_CLI_FLAG);
+    is_cycle_mode_wanted = take_cli_flag(argc, argv, CYCLES_CLI_FLAG);
+    take_cli_option(argc, argv, RESTART_CLI_OPTION, RESTART_PATH);
+    take_cli_option(argc, argv, CATCHMENT_COSTS_CLI_OPTION, CATCHMENT_COSTS_PATH);
+    std::string target_nexus_ids;
+    bool is_target_nexus_wanted = take_cli_option(argc, argv, TARGET_NEXUS_CLI_OPTION, target_nexus_ids);
+    bool is_dry_run_wanted = take_cli_option(argc, argv, DRY_RUN_CLI_OPTION, DRY_RUN_COEFFICIENTS_PATH);
+    std::string autotune_path;
+    std::string autotune_steps = "48";
+    bool is_autotune_wanted = take_cli_option(argc, argv, AUTOTUNE_CLI_OPTION, autotune_path);
+    take_cli_option(argc, argv, AUTOTUNE_STEPS_CLI_OPTION, autotune_steps);
+    #ifdef NGEN_MPI_ACTIVE
+    is_node_shared_hydrofabric_wanted = take_cli_flag(argc, argv, MPI_HF_SHARED_CLI_FLAG);
+    is_collective_hydrofabric_wanted = take_cli_flag(argc, argv, MPI_HF_COLLECTIVE_CLI_FLAG);
+    #endif // NGEN_MPI_ACTIVE
 
     std::vector<string> catchment_subset_ids;
     std::vector<string> nexus_subset_ids;
@@ -127,13 +923,18 @@ int main(int argc, char *argv[]) {
             }
         }
 
-        // Initalize MPI
-        MPI_Init(NULL, NULL);
+        // Initalize MPI; catchment threads only run formulations, and every MPI call, including all remote nexus
+        // traffic, is funneled through this main thread
+        MPI_Init_thread(NULL, NULL, MPI_THREAD_FUNNELED, &mpi_thread_support);
         MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank);
         MPI_Comm_size(MPI_COMM_WORLD, &mpi_num_procs);
         
         #endif // NGEN_MPI_ACTIVE
 
+        // SIGUSR1 asks for a report of where the run is, written at its next time step (see write_status), rather
+        // than ending the process; with MPI initialized, so this replaces any handler the MPI library installed
+        utils::StatusDump::install();
+
         #ifdef WRITE_PID_FILE_FOR_GDB_SERVER
         std::string pid_file_name = "./.ngen_pid";
         #ifdef NGEN_MPI_ACTIVE
@@ -150,8 +951,34 @@ int main(int argc, char *argv[]) {
         }
         #endif // WRITE_PID_FILE_FOR_GDB_SERVER
 
-        bool error = !utils::FileChecker::file_is_readable(catchmentDataFile, "Catchment data") ||
-                !utils::FileChecker::file_is_readable(nexusDataFile, "Nexus data") ||
+        // Hydrofabric files in object storage are read through the block cache, with nothing written next to them
+        if (data_access::is_remote_path(catchmentDataFile) || data_access::is_remote_path(nexusDataFile)) {
+            if (is_hydrofabric_cache_wanted) {
+                std::cout << "WARN: " << HF_CACHE_CLI_FLAG << " is ignored for hydrofabric files in object storage." << std::endl;
+                is_hydrofabric_cache_wanted = false;
+            }
+            #ifdef NGEN_MPI_ACTIVE
+            if (is_subdivided_hydrofabric_wanted) {
+                std::cout << "WARN: " << MPI_HF_SUB_CLI_FLAG << " is ignored for hydrofabric files in object storage." << std::endl;
+                is_subdivided_hydrofabric_wanted = false;
+            }
+            #endif // NGEN_MPI_ACTIVE
+        }
+
+        #ifdef NGEN_MPI_ACTIVE
+        // Subdivided files are already one per rank, and a collective load reads each file on one rank only
+        if (is_collective_hydrofabric_wanted && is_subdivided_hydrofabric_wanted) {
+            std::cout << "WARN: " << MPI_HF_COLLECTIVE_CLI_FLAG << " is ignored with " << MPI_HF_SUB_CLI_FLAG << "." << std::endl;
+            is_collective_hydrofabric_wanted = false;
+        }
+        if (is_collective_hydrofabric_wanted && is_node_shared_hydrofabric_wanted) {
+            std::cout << "WARN: " << MPI_HF_SHARED_CLI_FLAG << " is ignored with " << MPI_HF_COLLECTIVE_CLI_FLAG << "." << std::endl;
+            is_node_shared_hydrofabric_wanted = false;
+        }
+        #endif // NGEN_MPI_ACTIVE
+
+        bool error = !(data_access::is_remote_path(catchmentDataFile) || utils::FileChecker::file_is_readable(catchmentDataFile, "Catchment data")) ||
+                !(data_access::is_remote_path(nexusDataFile) || utils::FileChecker::file_is_readable(nexusDataFile, "Nexus data")) ||
                 !utils::FileChecker::file_is_readable(REALIZATION_CONFIG_PATH, "Realization config");
 
         #ifdef NGEN_MPI_ACTIVE
@@ -179,6 +1006,30 @@ int main(int argc, char *argv[]) {
 
         if(error) exit(-1);
 
+        //An autotuning run runs copies of itself, each timing a candidate, rather than the realization config
+        if(is_autotune_wanted) {
+          bool is_single_process = true;
+          #ifdef NGEN_MPI_ACTIVE
+          is_single_process = mpi_num_procs == 1;
+          #endif // NGEN_MPI_ACTIVE
+          long window_steps = std::strtol(autotune_steps.c_str(), nullptr, 10);
+          int status = -1;
+          if(!is_single_process) {
+            std::cerr<<"ERROR: "<<AUTOTUNE_CLI_OPTION<<" tunes the run of a single process; run it without mpirun"
+                     <<std::endl;
+          }
+          else if(window_steps < 1) {
+            std::cerr<<"ERROR: "<<AUTOTUNE_STEPS_CLI_OPTION<<" must be a number of time steps of at least 1"<<std::endl;
+          }
+          else {
+            status = run_autotune(cli_args, autotune_path, window_steps);
+          }
+          #ifdef NGEN_MPI_ACTIVE
+          MPI_Finalize();
+          #endif // NGEN_MPI_ACTIVE
+          return status;
+        }
+
         //split the subset strings into vectors
         boost::split(catchment_subset_ids, argv[2], [](char c){return c == ','; } );
         if( catchment_subset_ids.size() == 1 && catchment_subset_ids[0] == "all")
@@ -190,34 +1041,108 @@ int main(int argc, char *argv[]) {
         //if we get an empy string, pop it from the subset list.
         if(nexus_subset_ids.size() == 1 && nexus_subset_ids[0] == "") nexus_subset_ids.pop_back();
         if(catchment_subset_ids.size() == 1 && catchment_subset_ids[0] == "") catchment_subset_ids.pop_back();
+
+        #ifndef NGEN_MPI_ACTIVE
+        if(is_target_nexus_wanted) {
+          if(!catchment_subset_ids.empty() || !nexus_subset_ids.empty()) {
+            std::cerr << "Warning: CLI provided subsets will be ignored when using " << TARGET_NEXUS_CLI_OPTION << std::endl;
+          }
+          std::vector<std::string> target_ids;
+          boost::split(target_ids, target_nexus_ids, [](char c){return c == ','; } );
+          subset_upstream_of(target_ids, catchment_subset_ids, nexus_subset_ids);
+          std::cout << "Running the " << catchment_subset_ids.size() << " catchments upstream of "
+                    << target_nexus_ids << std::endl;
+        }
+        #endif // NGEN_MPI_ACTIVE
     } // end else if (argc < 6)
 
     //Read the collection of nexus
     std::cout << "Building Nexus collection" << std::endl;
+    utils::StartupTimer startup("hydrofabric/nexuses");
     
     #ifdef NGEN_MPI_ACTIVE
     Partitions_Parser partition_parser(PARTITION_PATH);
     // TODO: add something here to make sure this step worked for every rank, and maybe to checksum the file
-    partition_parser.parse_partition_file();
-    
-    std::vector<PartitionData> &partitions = partition_parser.partition_ranks;
-    PartitionData &local_data = partitions[mpi_rank];
+    // Only this rank's own partition is needed
+    PartitionData local_data = partition_parser.parse_partition(mpi_rank);
     if (!nexus_subset_ids.empty()) {
         std::cerr << "Warning: CLI provided nexus subset will be ignored when using partition config";
     }
     if (!catchment_subset_ids.empty()) {
         std::cerr << "Warning: CLI provided catchment subset will be ignored when using partition config";
     }
+    if (is_target_nexus_wanted) {
+        std::cerr << "Warning: " << TARGET_NEXUS_CLI_OPTION << " will be ignored when using partition config";
+    }
     nexus_subset_ids = std::vector<std::string>(local_data.nexus_ids.begin(), local_data.nexus_ids.end());
     catchment_subset_ids = std::vector<std::string>(local_data.catchment_ids.begin(), local_data.catchment_ids.end());
     #endif // NGEN_MPI_ACTIVE
 
+    // The driver itself only uses ids, the links between features and catchment areas; the rest can be left out
+    geojson::FeatureLoadOptions nexus_load_options;
+    geojson::FeatureLoadOptions catchment_load_options;
+    // Features are built on every CPU the process may run on, i.e. those an MPI launcher bound the rank to
+    nexus_load_options.threads = 0;
+    catchment_load_options.threads = 0;
+    if (is_slim_hydrofabric_wanted) {
+        nexus_load_options.include_geometry = false;
+        nexus_load_options.properties = {"toid"};
+        catchment_load_options.include_geometry = false;
+        catchment_load_options.properties = {"toid", "areasqkm", "area_sqkm"};
+    }
+
+    // Whether to trust the caches without hashing the GeoJSON files again
+    bool trust_hydrofabric_cache = false;
+    #ifdef NGEN_MPI_ACTIVE
+    if (is_hydrofabric_cache_wanted && !is_subdivided_hydrofabric_wanted) {
+        // All ranks share the same files, so have one rank bring the caches up to date for the others
+        if (mpi_rank == 0) {
+            geojson::update_feature_cache(nexusDataFile, nexus_load_options.include_geometry);
+            geojson::update_feature_cache(catchmentDataFile, catchment_load_options.include_geometry);
+        }
+        MPI_Barrier(MPI_COMM_WORLD);
+        trust_hydrofabric_cache = true;
+    }
+    #endif // NGEN_MPI_ACTIVE
+
+    // Read the features of a hydrofabric file with the given ids, or under MPI with MPI_HF_COLLECTIVE_CLI_FLAG, have
+    // rank 0 read the file and send every rank the features of its partition
+    #ifdef NGEN_MPI_ACTIVE
+    std::vector<PartitionData> all_partitions;
+    #endif // NGEN_MPI_ACTIVE
+    auto load_hydrofabric_file = [&](const std::string& file_path, const std::vector<std::string>& ids,
+                                     const geojson::FeatureLoadOptions& options, bool is_nexus_file) {
+        auto read = [&](const std::vector<std::string>& read_ids) {
+            return is_hydrofabric_cache_wanted
+                ? geojson::read_cached(file_path, read_ids, !trust_hydrofabric_cache, options)
+                : read_hydrofabric_file(file_path, read_ids, options);
+        };
+        #ifdef NGEN_MPI_ACTIVE
+        if (is_collective_hydrofabric_wanted) {
+            auto ids_of_rank = [&](int rank) {
+                if (all_partitions.empty()) {
+                    for (int i = 0; i < mpi_num_procs; ++i) {
+                        all_partitions.push_back(partition_parser.parse_partition(i));
+                    }
+                }
+                const auto& partition_ids = is_nexus_file ? all_partitions[rank].nexus_ids : all_partitions[rank].catchment_ids;
+                return std::vector<std::string>(partition_ids.begin(), partition_ids.end());
+            };
+            return parallel::scatter_hydrofabric_file([&]() { return read({}); }, ids_of_rank,
+                                                      options.include_geometry, file_path);
+        }
+        #endif // NGEN_MPI_ACTIVE
+        return read(ids);
+    };
+
     // TODO: Instead of iterating through a collection of FeatureBase objects mapping to nexi, we instead want to iterate through HY_HydroLocation objects
-    geojson::GeoJSON nexus_collection = geojson::read(nexusDataFile, nexus_subset_ids);
+    geojson::GeoJSON nexus_collection = load_hydrofabric_file(nexusDataFile, nexus_subset_ids, nexus_load_options, true);
     std::cout << "Building Catchment collection" << std::endl;
+    startup.next("hydrofabric/catchments");
 
     // TODO: Instead of iterating through a collection of FeatureBase objects mapping to catchments, we instead want to iterate through HY_Catchment objects
-    geojson::GeoJSON catchment_collection = geojson::read(catchmentDataFile, catchment_subset_ids);
+    geojson::GeoJSON catchment_collection = load_hydrofabric_file(catchmentDataFile, catchment_subset_ids,
+                                                                  catchment_load_options, false);
     
     for(auto& feature: *catchment_collection)
     {
@@ -226,12 +1151,55 @@ int main(int argc, char *argv[]) {
         //std::cout<<"Catchment "<<feature->get_id()<<" -> Nexus "<<feature->get_property("toID").as_string()<<std::endl;
     }
 
-    std::shared_ptr<realization::Formulation_Manager> manager = std::make_shared<realization::Formulation_Manager>(REALIZATION_CONFIG_PATH);
+    //When only a subset or partition of the catchments is run, only read the config of those catchments
+    startup.next("realization/config");
+    std::shared_ptr<realization::Formulation_Manager> manager;
+    if (!catchment_subset_ids.empty()) {
+      std::unordered_set<std::string> local_catchment_ids;
+      for (auto& feature : *catchment_collection) {
+        local_catchment_ids.insert(feature->get_id());
+      }
+      manager = std::make_shared<realization::Formulation_Manager>(REALIZATION_CONFIG_PATH, local_catchment_ids);
+    }
+    else {
+      manager = std::make_shared<realization::Formulation_Manager>(REALIZATION_CONFIG_PATH);
+    }
+    //Cached responses only cover the time steps of a whole run from its start
+    if (!RESTART_PATH.empty() || is_cycle_mode_wanted) {
+      manager->disallow_response_cache();
+    }
+
+    //A dry run stops short of constructing the formulations, estimating them from their coefficients instead
+    if (is_dry_run_wanted) {
+      startup.stop();
+      utils::CapacityEstimate estimate;
+      if (!DRY_RUN_COEFFICIENTS_PATH.empty()) {
+        estimate.read_coefficients(DRY_RUN_COEFFICIENTS_PATH);
+      }
+      for (auto& feature : *catchment_collection) {
+        estimate.add_catchment(feature->get_id(), manager->get_formulation_type(feature->get_id()));
+      }
+      #ifdef NGEN_MPI_ACTIVE
+      for (const auto& connection : local_data.remote_connections) {
+        estimate.add_remote_connection(std::get<0>(connection));
+      }
+      #endif // NGEN_MPI_ACTIVE
+      utils::MemoryReport report;
+      report.add("hydrofabric/features", catchment_collection->get_memory_bytes());
+      write_dry_run_estimate(estimate, manager->get_catchment_threads_config(),
+                             Simulation_Time(manager->get_simulation_time_config()).get_total_output_times(), report);
+      #ifdef NGEN_MPI_ACTIVE
+      MPI_Finalize();
+      #endif // NGEN_MPI_ACTIVE
+      return 0;
+    }
+    startup.next("realization/formulations");
     manager->read(catchment_collection, utils::getStdOut());
 
     //TODO refactor manager->read so certain configs can be queried before the entire
     //realization collection is created
     #ifdef NGEN_ROUTING_ACTIVE
+    startup.next("routing/initialize");
     std::unique_ptr<routing_py_adapter::Routing_Py_Adapter> router;
     #ifdef NGEN_MPI_ACTIVE
     //If rank == 0, do routing
@@ -251,8 +1219,19 @@ int main(int argc, char *argv[]) {
     #endif //NGEN_MPI_ACTIVE
     #endif //NGEN_ROUTING_ACTIVE
 
+    startup.next("features/link");
     std::string link_key = "toid";
     #ifdef NGEN_MPI_ACTIVE
+    //With the reduce_scatter transport, every rank sums the flows of its own catchments into its own copy of each
+    //nexus they drain to, and the copies are summed onto their owners, so no nexus is connected to other ranks
+    bool is_nexus_reduced = manager->get_execution_params().remote_transport == "reduce_scatter";
+    if(is_nexus_reduced && manager->get_using_routing()) {
+      std::cerr<<"WARNING: the reduce_scatter remote_transport is not supported with routing, using neighbor_collective"<<std::endl;
+      is_nexus_reduced = false;
+    }
+    if(is_nexus_reduced) {
+      local_data.remote_connections.clear();
+    }
     nexus_collection->link_features_from_property(nullptr, &link_key);
     hy_features::HY_Features_MPI features = hy_features::HY_Features_MPI(local_data, nexus_collection, manager, mpi_rank, mpi_num_procs);
     #else
@@ -262,95 +1241,1596 @@ int main(int argc, char *argv[]) {
     //validate dendridic connections
     features.validate_dendridic();
     //TODO don't really need catchment_collection once catchments are added to nexus collection
-    //Still using  catchments for geometry at the moment, fix this later
+    //Still using  catchments for geometry at the moment, fix this later (HF_SLIM_CLI_FLAG leaves the geometry out)
     //catchment_collection.reset();
     nexus_collection.reset();
 
-    //Still hacking nexus output for the moment
+    //Set up the nexus output for every nexus this process reports the flow of
+    startup.next("output/nexuses");
+    std::vector<std::string> output_nexus_ids;
     for(const auto& id : features.nexuses()) {
         #ifdef NGEN_MPI_ACTIVE
         if (!features.is_remote_sender_nexus(id)) {
-          nexus_outfiles[id].open("./"+id+"_output.csv", std::ios::trunc);
+          output_nexus_ids.push_back(id);
         }
         #else
-        nexus_outfiles[id].open("./"+id+"_output.csv", std::ios::trunc);
+        output_nexus_ids.push_back(id);
         #endif
     }
+    //Of those, only the flows of the nexuses the output config selects are written to files
+    utils::IdSelector nexus_output_selector(manager->get_output_params().nexus_selection);
+    const bool is_terminal_nexus_output_only = manager->get_output_params().terminal_nexuses_only;
+    std::vector<std::string> written_nexus_ids;
+    for(const auto& id : output_nexus_ids) {
+        if(nexus_output_selector.matches(id) && (!is_terminal_nexus_output_only
+                                                 || features.nexus_at(features.handle_of(id))->get_receiving_catchments().empty())) {
+          written_nexus_ids.push_back(id);
+        }
+    }
+    #ifdef NGEN_MPI_ACTIVE
+    //Each rank only holds the part of a reduced nexus's flow from its own catchments, so every rank's nexuses are
+    //summed onto, and written by, the rank owning each of them
+    std::unique_ptr<NexusReduceScatter> nexus_reduction;
+    if(is_nexus_reduced) {
+      nexus_reduction = std::unique_ptr<NexusReduceScatter>(new NexusReduceScatter(
+          output_nexus_ids, manager->get_execution_params().reduce_scatter_steps, MPI_COMM_WORLD));
+      if(is_terminal_nexus_output_only) {
+        std::cerr<<"WARNING: terminal_nexuses_only is ignored with the reduce_scatter remote_transport, since a rank "
+                 <<"may own nexuses it holds no copy of"<<std::endl;
+      }
+      written_nexus_ids.clear();
+      for(const auto& id : nexus_reduction->owned_nexus_ids()) {
+        if(nexus_output_selector.matches(id)) {
+          written_nexus_ids.push_back(id);
+        }
+      }
+      std::cout<<"Summing the flows of "<<output_nexus_ids.size()<<" nexuses onto their owners every "
+               <<nexus_reduction->chunk_steps()<<" time steps, writing "<<written_nexus_ids.size()<<" of the "
+               <<nexus_reduction->owned_nexus_ids().size()<<" this rank owns"<<std::endl;
+    }
+    else
+    #endif
+    if(written_nexus_ids.size() < output_nexus_ids.size()) {
+      std::cout<<"Writing the flows of "<<written_nexus_ids.size()<<" of "<<output_nexus_ids.size()<<" nexuses"<<std::endl;
+    }
+    std::string nexus_output_tag = "";
+    #ifdef NGEN_MPI_ACTIVE
+    nexus_output_tag = "_rank_" + std::to_string(mpi_rank);
+    #endif
+    #ifdef NGEN_ROUTING_ACTIVE
+    //With in memory flows, the nexus output is kept for routing rather than written to files
+    routing_params routing_config = manager->get_routing_params();
+    #ifdef NGEN_MPI_ACTIVE
+    //Only rank 0 routes, so unless the config says otherwise, gather the flows of every rank to it with MPI rather than
+    //through the per nexus files of a shared filesystem, whenever the installed t-route can receive them in memory
+    if(manager->get_using_routing() && !routing_config.in_memory_flows_given) {
+      int supported = mpi_rank == 0 && router->supports_in_memory_flows() ? 1 : 0;
+      MPI_Bcast(&supported, 1, MPI_INT, 0, MPI_COMM_WORLD);
+      routing_config.in_memory_flows = supported != 0;
+      if(mpi_rank == 0) {
+        std::cout<<"Routing gathers nexus flows "<<(supported ? "in memory" : "from nexus output files")<<std::endl;
+      }
+    }
+    #endif
+    //With pipelined routing, rank 0 routes each chunk of flows on a worker thread as soon as it has them, overlapping
+    //routing with the rest of the simulation, rather than routing the whole run once it is done.  Runs restarted from a
+    //checkpoint, or ended early to rebalance, are routed at the end, since t-route's routing state is not checkpointed.
+    std::unique_ptr<routing_py_adapter::Routing_Pipeline> routing_pipeline;
+    bool is_routing_pipelined = false;
+    if(manager->get_using_routing() && routing_config.pipelined && router) {
+      if(!RESTART_PATH.empty() || manager->get_execution_params().rebalance_threshold > 0) {
+        std::cerr<<"WARNING: routing is not pipelined in runs that restart or rebalance; routing at the end instead"<<std::endl;
+      }
+      else if(!router->supports_chunked_routing()) {
+        std::cerr<<"WARNING: the t-route module has no route_flow_values function for pipelined routing; routing at the "
+                 <<"end instead"<<std::endl;
+      }
+      else {
+        int delta_time = manager->Simulation_Time_Object->get_output_interval_seconds();
+        routing_py_adapter::Routing_Py_Adapter* chunk_router = router.get();
+        routing_pipeline = make_unique<routing_py_adapter::Routing_Pipeline>(
+            [chunk_router, delta_time](const std::vector<std::string>& ids, const std::vector<std::string>& chunk_timestamps,
+                                       const double* flows, std::size_t row_stride) {
+                chunk_router->receive_flows(ids, chunk_timestamps, flows, row_stride);
+                chunk_router->route_received_flows(chunk_timestamps.size(), delta_time);
+            });
+        is_routing_pipelined = true;
+        std::cout<<"Routing each "<<routing_config.flow_chunk_steps<<" time steps during the run"<<std::endl;
+      }
+    }
+    nexus_output::MemoryNexusOutputWriter* routing_flows = nullptr;
+    //With the mapped nexus format, routing at the end reads the flows of the whole run in place from each rank's file,
+    //which the kernel pages, rather than keeping them in memory; a restarted run keeps those of the steps before it
+    nexus_output::MappedNexusOutputWriter* routing_history = nullptr;
+    int first_unrouted_time_index = 0;
+    if(manager->get_using_routing() && routing_config.in_memory_flows && routing_config.flow_chunk_steps == 0
+       && manager->get_output_params().nexus_format == "mapped") {
+      routing_history = new nexus_output::MappedNexusOutputWriter(output_nexus_ids,
+          manager->get_output_params().nexus_path + "nexus_output" + nexus_output_tag + ".flows",
+          manager->Simulation_Time_Object->get_total_output_times(), !RESTART_PATH.empty());
+      nexus_writer.reset(routing_history);
+      written_nexus_ids = output_nexus_ids;
+    }
+    else if(manager->get_using_routing() && routing_config.in_memory_flows) {
+      std::size_t total_steps = manager->Simulation_Time_Object->get_total_output_times();
+      #ifdef NGEN_MPI_ACTIVE
+      //Gathering flows is collective, so chunks are handed over from the time step loop, where every rank is at the
+      //same step, rather than as each rank's writer fills them
+      routing_flows = new nexus_output::MemoryNexusOutputWriter(output_nexus_ids, 0,
+          nexus_output::MemoryNexusOutputWriter::chunk_handler_t(),
+          routing_config.flow_chunk_steps > 0 ? routing_config.flow_chunk_steps : total_steps);
+      #else
+      routing_flows = new nexus_output::MemoryNexusOutputWriter(output_nexus_ids, routing_config.flow_chunk_steps,
+          [&router, &routing_pipeline](const nexus_output::MemoryNexusOutputWriter& flows) {
+              hand_flows_to_routing(flows, flows.get_timestamps(), router.get(), routing_pipeline.get());
+          }, total_steps);
+      #endif
+      nexus_writer.reset(routing_flows);
+      //Routing takes the flow of every nexus, and none are written to files
+      written_nexus_ids = output_nexus_ids;
+    }
+    else {
+      nexus_writer = nexus_output::make_nexus_output_writer(manager->get_output_params(), written_nexus_ids, nexus_output_tag,
+                                                            manager->Simulation_Time_Object->get_total_output_times(),
+                                                            !RESTART_PATH.empty());
+      if(manager->get_using_routing() && written_nexus_ids.size() < output_nexus_ids.size()) {
+        std::cerr<<"WARNING: routing reads the csv output of every nexus, but the output config only selects "
+                 <<written_nexus_ids.size()<<" of "<<output_nexus_ids.size()<<std::endl;
+      }
+      if(manager->get_using_routing() && manager->get_output_params().nexus_format != "csv") {
+        std::cerr<<"WARNING: routing reads per nexus csv output, but the nexus output format is "
+                 <<manager->get_output_params().nexus_format<<std::endl;
+      }
+      else if(manager->get_using_routing() && manager->get_output_params().csv_compression != "none") {
+        std::cerr<<"WARNING: routing reads uncompressed per nexus csv output, but the csv output is compressed with "
+                 <<manager->get_output_params().csv_compression<<std::endl;
+      }
+    }
+    #else
+    nexus_writer = nexus_output::make_nexus_output_writer(manager->get_output_params(), written_nexus_ids, nexus_output_tag,
+                                                          manager->Simulation_Time_Object->get_total_output_times(),
+                                                          !RESTART_PATH.empty());
+    #endif
+
+    startup.stop();
+    write_startup_profile();
+
+    //The bytes held by the major structures of the run, at startup and again at its end
+    auto collect_memory_report = [&]() {
+        utils::MemoryReport report;
+        report.add("hydrofabric/features", catchment_collection->get_memory_bytes());
+        report.add("network", features.get_network().get_memory_bytes());
+        //Models are opaque, so what each type of formulation takes is the growth of resident memory while they were
+        //constructed, which is only sampled per type when they were constructed one at a time
+        bool is_formulation_memory_sampled = false;
+        double formulations_mb = 0.0;
+        for(const auto& phase : utils::StartupProfile::collect()) {
+          if(phase.first == "realization/formulations") {
+            formulations_mb = phase.second.memory_mb;
+          }
+          else if(phase.first.compare(0, 13, "formulations/") == 0 && phase.second.is_memory_sampled) {
+            report.add(phase.first.substr(0, phase.first.rfind('/')), std::max(phase.second.memory_mb, 0.0) * 1024.0 * 1024.0);
+            is_formulation_memory_sampled = true;
+          }
+        }
+        if(!is_formulation_memory_sampled) {
+          report.add("formulations", std::max(formulations_mb, 0.0) * 1024.0 * 1024.0);
+        }
+        //Catchments may share a forcing provider, which is only counted once
+        std::unordered_set<data_access::GenericDataProvider*> seen_providers;
+        report.add("forcing", 0);
+        for(const auto& id : features.catchments()) {
+          auto realization = features.catchment_at(id);
+          const auto& provider = realization ? realization->get_forcing_provider() : nullptr;
+          if(provider && seen_providers.insert(provider.get()).second) {
+            report.add("forcing", provider->get_memory_bytes());
+          }
+        }
+        report.add("nexus flows", 0);
+        for(const auto& id : features.nexuses()) {
+          if(auto nexus = features.nexus_at(id)) {
+            report.add("nexus flows", nexus->get_memory_bytes());
+          }
+        }
+        #ifdef NGEN_MPI_ACTIVE
+        report.add("mpi buffers", features.get_remote_exchange_memory_bytes());
+        if(nexus_reduction) {
+          report.add("mpi buffers", nexus_reduction->get_memory_bytes());
+        }
+        #endif
+        return report;
+    };
+    write_memory_report("startup", collect_memory_report());
 
     std::cout<<"Running Models"<<std::endl;
 
+    if(!manager->get_output_params().profile_path.empty()) {
+      utils::Profiler::enable(manager->get_output_params().profile_trace);
+      if(manager->get_output_params().profile_counters && !utils::Profiler::enable_counters()) {
+        std::cerr<<"WARNING: hardware performance counters are not available (see kernel.perf_event_paranoid), so "
+                 <<"the profile only times its regions"<<std::endl;
+      }
+    }
+
     std::shared_ptr<pdm03_struct> pdm_et_data = std::make_shared<pdm03_struct>(get_et_params());
 
-    //Now loop some time, iterate catchments, do stuff for total number of output times
-    for(int output_time_index = 0; output_time_index < manager->Simulation_Time_Object->get_total_output_times(); output_time_index++) {
-      //std::cout<<"Output Time Index: "<<output_time_index<<std::endl;
-      if(output_time_index%100 == 0) std::cout<<"Running timestep "<<output_time_index<<std::endl;
-      std::string current_timestamp = manager->Simulation_Time_Object->get_timestamp(output_time_index);
-      for(const auto& id : features.catchments()) {
-        //std::cout<<"Running cat "<<id<<std::endl;
-        auto r = features.catchment_at(id);
-        //TODO redesign to avoid this cast
-        auto r_c = dynamic_pointer_cast<realization::Catchment_Formulation>(r);
-        r_c->set_et_params(pdm_et_data);
-        double response = r_c->get_response(output_time_index, 3600.0);
-        std::string output = std::to_string(output_time_index)+","+current_timestamp+","+
-                             r_c->get_output_line_for_timestep(output_time_index)+"\n";
-        r_c->write_output(output);
-        //TODO put this somewhere else.  For now, just trying to ensure we get m^3/s into nexus output
-        try{
-          response *= (catchment_collection->get_feature(id)->get_property("areasqkm").as_real_number() * 1000000);
-        }catch(std::invalid_argument &e)
-        {
-          response *= (catchment_collection->get_feature(id)->get_property("area_sqkm").as_real_number() * 1000000);
-        }
-        //TODO put this somewhere else as well, for now, an implicit assumption is that a modules get_response returns
-        //m/timestep
-        //since we are operating on a 1 hour (3600s) dt, we need to scale the output appropriately
-        //so no response is m^2/hr...m^2/hr * 1hr/3600s = m^3/hr
-        response /= 3600.0;
-        //update the nexus with this flow
-        for(auto& nexus : features.destination_nexuses(id)) {
+    //Resolve the catchments once up front, so worker threads only touch their own formulation each time step,
+    //and the time loop indexes vectors rather than looking features up by id
+    std::vector<std::string> catchment_ids;
+    for(const auto& id : features.catchments()) {
+      catchment_ids.push_back(id);
+    }
+    std::vector<std::shared_ptr<HY_CatchmentRealization>> catchment_realizations;
+    //The formulation of each catchment, and the tag its time steps are dispatched on, by its concrete type
+    std::vector<realization::Catchment_Formulation*> catchment_formulations;
+    std::vector<int> catchment_formulation_tags;
+    //The factor taking each catchment's response, summed over a formulation time step, to m^3/s
+    std::vector<double> catchment_flow_factors;
+    //Each formulation steps at its own time step, which is a whole number of output intervals (the step multiple),
+    //or a whole fraction of one (run as that many substeps per output interval)
+    const long output_interval_seconds = manager->Simulation_Time_Object->get_output_interval_seconds();
+    std::vector<int> catchment_step_multiples;
+    std::vector<int> catchment_substeps;
+    //The flow of each catchment's last formulation time step in m^3/s, held for each output time step it spans
+    std::vector<double> catchment_held_flows;
+    //The nexus each catchment contributes its flow to, if any
+    std::vector<std::shared_ptr<HY_HydroNexus>> catchment_destinations;
+    //The profiler region of each catchment's responses, timed by formulation type
+    std::vector<int> catchment_response_regions;
+    //When catchment costs are wanted, for the costs file or to rebalance by, the wall time each catchment's
+    //formulation took, and the output time steps it was run for
+    const double rebalance_threshold = manager->get_execution_params().rebalance_threshold;
+    const bool is_catchment_costs_wanted = !CATCHMENT_COSTS_PATH.empty() || rebalance_threshold > 0;
+    std::vector<double> catchment_cost_seconds;
+    std::vector<long> catchment_cost_steps;
+    //The order catchments are run in within a time step, and the order their flows are contributed in
+    std::vector<std::size_t> catchment_run_order;
+    std::vector<std::size_t> catchment_contribution_order;
+    //The catchments draining to nexuses that send to other ranks, which lead both orders
+    std::size_t boundary_catchment_count = 0;
+    //With device_overlap, the group each catchment's formulation is computed in on an accelerator, if any, and the
+    //first catchment of each group, which starts the group's time steps
+    const bool is_device_overlapped = manager->get_execution_params().device_overlap;
+    std::vector<const void*> catchment_device_groups;
+    std::vector<std::size_t> device_group_leaders;
+    auto resolve_catchments = [&]() {
+        catchment_realizations.clear();
+        catchment_formulations.clear();
+        catchment_formulation_tags.clear();
+        catchment_flow_factors.clear();
+        catchment_destinations.clear();
+        catchment_response_regions.clear();
+        catchment_step_multiples.clear();
+        catchment_substeps.clear();
+        catchment_device_groups.clear();
+        device_group_leaders.clear();
+        std::unordered_set<const void*> seen_device_groups;
+        for(const auto& id : catchment_ids) {
+          auto handle = features.handle_of(id);
+          catchment_realizations.push_back(features.catchment_at(handle));
+          realization::Catchment_Formulation* formulation = features.formulation_at(handle);
+          catchment_formulations.push_back(formulation);
+          catchment_formulation_tags.push_back(formulation ? realization::get_native_formulation_tag(*formulation)
+                                                           : realization::native_formulations::size);
+          catchment_response_regions.push_back(utils::Profiler::region(
+              "get_response/" + (formulation ? formulation->get_formulation_type() : std::string("unknown"))));
+          const void* device_group = formulation && is_device_overlapped ? formulation->get_device_group() : nullptr;
+          catchment_device_groups.push_back(device_group);
+          if(device_group && seen_device_groups.insert(device_group).second) {
+            device_group_leaders.push_back(catchment_device_groups.size() - 1);
+          }
+          long time_step_seconds = formulation ? formulation->get_time_step_seconds() : 0;
+          if(time_step_seconds == 0 || time_step_seconds == output_interval_seconds) {
+            catchment_step_multiples.push_back(1);
+            catchment_substeps.push_back(1);
+          }
+          else if(time_step_seconds > output_interval_seconds && time_step_seconds % output_interval_seconds == 0) {
+            catchment_step_multiples.push_back(time_step_seconds / output_interval_seconds);
+            catchment_substeps.push_back(1);
+          }
+          else if(time_step_seconds < output_interval_seconds && output_interval_seconds % time_step_seconds == 0) {
+            catchment_step_multiples.push_back(1);
+            catchment_substeps.push_back(output_interval_seconds / time_step_seconds);
+          }
+          else {
+            throw std::runtime_error("The time step of " + std::to_string(time_step_seconds) + " seconds of the formulation of "
+                                     + id + " is neither a multiple nor a divisor of the output interval of "
+                                     + std::to_string(output_interval_seconds) + " seconds.");
+          }
+          catchment_flow_factors.push_back(ngen::catchment_flow_factor(
+              ngen::catchment_area_m2(catchment_collection->get_feature(id), id), catchment_step_multiples.back(),
+              output_interval_seconds));
           //TODO in a DENDRIDIC network, only one destination nexus per catchment
           //If there is more than one, some form of catchment partitioning will be required.
           //for now, only contribute to the first one in the list
-          nexus->add_upstream_flow(response, id, output_time_index);
-	        break;
+          const auto& destinations = features.destination_nexuses(handle);
+          catchment_destinations.push_back(destinations.empty() ? nullptr : destinations[0]);
         }
-      } //done catchments
-      //At this point, could make an internal routing pass, extracting flows from nexuses and routing
-      //across the flowpath to the next nexus.
-      //Once everything is updated for this timestep, dump the nexus output
-      for(const auto& id : features.nexuses()) {
-  #ifdef NGEN_MPI_ACTIVE
-        if (!features.is_remote_sender_nexus(id)) { //Ensures only one side of the dual sided remote nexus actually doing this...
-  #endif
-          //Get the correct "requesting" id for downstream_flow
-	        const auto& nexus = features.nexus_at(id);
-          const auto& cat_ids = nexus->get_receiving_catchments();
-          std::string cat_id;
-          if( cat_ids.size() > 0 ) {
-            //Assumes dendridic, e.g. only a single downstream...it will consume 100%  of the available flow
-            cat_id = cat_ids[0];
+        //The catchments of a time step are independent of each other, so run them grouped by formulation type, so
+        //consecutive catchments take the same statically dispatched path, and within each group in the order their
+        //formulations lie in memory, which is the order they were created in, so each time step sweeps the heap mostly
+        //forwards rather than chasing formulations across it in network order.  Flows are still contributed in
+        //network order.  Catchments computed on an accelerator run last, so the host ones run while their groups do.
+        catchment_run_order.resize(catchment_ids.size());
+        std::iota(catchment_run_order.begin(), catchment_run_order.end(), 0);
+        std::sort(catchment_run_order.begin(), catchment_run_order.end(), [&](std::size_t a, std::size_t b) {
+            if((catchment_device_groups[a] != nullptr) != (catchment_device_groups[b] != nullptr)) {
+              return catchment_device_groups[a] == nullptr;
+            }
+            if(catchment_formulation_tags[a] != catchment_formulation_tags[b]) {
+              return catchment_formulation_tags[a] < catchment_formulation_tags[b];
+            }
+            return std::less<const HY_CatchmentRealization*>()(catchment_realizations[a].get(), catchment_realizations[b].get());
+        });
+        catchment_contribution_order.resize(catchment_ids.size());
+        std::iota(catchment_contribution_order.begin(), catchment_contribution_order.end(), 0);
+        #ifdef NGEN_MPI_ACTIVE
+        //Catchments feeding other ranks run first, so their flows are sent while the others run; every contributor
+        //of a nexus is on the same side, so each nexus still sums its flows in network order
+        auto is_boundary = [&](std::size_t i) {
+            return catchment_destinations[i] && features.is_remote_sender_nexus(catchment_destinations[i]->get_id());
+        };
+        std::stable_partition(catchment_run_order.begin(), catchment_run_order.end(), is_boundary);
+        boundary_catchment_count = std::stable_partition(catchment_contribution_order.begin(),
+                                                         catchment_contribution_order.end(), is_boundary)
+                                   - catchment_contribution_order.begin();
+        #endif
+    };
+    resolve_catchments();
+    //The flows into nexuses that only this rank's catchments contribute to are summed for all of a nexus's catchments
+    //at once, as a sparse matrix-vector product, and added to the nexus as one flow.  Remote nexuses are still
+    //contributed to one catchment at a time, since they send or receive once each of its catchments contributed.
+    nexus_output::NexusInflowMatrix nexus_inflows;
+    std::vector<std::shared_ptr<HY_HydroNexus>> inflow_nexuses;
+    std::vector<double> nexus_inflow_sums;
+    //Whether each catchment's flow is summed by nexus_inflows, rather than contributed on its own
+    std::vector<char> catchment_inflow_summed;
+    auto resolve_nexus_inflows = [&]() {
+        std::unordered_map<HY_HydroNexus*, long> nexus_rows;
+        std::vector<long> catchment_rows(catchment_ids.size(), -1);
+        inflow_nexuses.clear();
+        catchment_inflow_summed.assign(catchment_ids.size(), 0);
+        for(std::size_t i = 0; i < catchment_ids.size(); ++i) {
+          const auto& nexus = catchment_destinations[i];
+          if(!nexus) {
+            continue;
           }
-          else {
-            //This is a terminal node, SHOULDN'T be remote, so ID shouldn't matter too much
-            cat_id = "terminal";
+          #ifdef NGEN_MPI_ACTIVE
+          auto remote = dynamic_cast<HY_PointHydroNexusRemote*>(nexus.get());
+          if(remote && remote->get_communicator_type() != HY_PointHydroNexusRemote::local) {
+            continue;
           }
-          double contribution_at_t = features.nexus_at(id)->get_downstream_flow(cat_id, output_time_index, 100.0);
-          if(nexus_outfiles[id].is_open()) {
-            nexus_outfiles[id] << output_time_index << ", " << current_timestamp << ", " << contribution_at_t << std::endl;
+          #endif
+          auto row = nexus_rows.emplace(nexus.get(), inflow_nexuses.size());
+          if(row.second) {
+            inflow_nexuses.push_back(nexus);
           }
-  #ifdef NGEN_MPI_ACTIVE
+          catchment_rows[i] = row.first->second;
+          catchment_inflow_summed[i] = 1;
+        }
+        //Contributions are in catchment order, so each row sums its catchments in the same order as ever
+        nexus_inflows = nexus_output::NexusInflowMatrix(catchment_rows, inflow_nexuses.size());
+        nexus_inflows.set_exact_summation(manager->get_execution_params().exact_flow_sums);
+        nexus_inflow_sums.assign(inflow_nexuses.size(), 0.0);
+    };
+    resolve_nexus_inflows();
+    //Every formulation shares the same ET parameters, so they are bound once rather than at each time step
+    features.set_et_params(pdm_et_data);
+    std::vector<double> catchment_flows(catchment_ids.size(), 0.0);
+    catchment_held_flows.assign(catchment_ids.size(), 0.0);
+    catchment_cost_seconds.assign(catchment_ids.size(), 0.0);
+    catchment_cost_steps.assign(catchment_ids.size(), 0);
+
+    int catchment_threads = manager->get_execution_params().catchment_threads;
+    #ifdef NGEN_MPI_ACTIVE
+    if(catchment_threads != 1 && mpi_thread_support < MPI_THREAD_FUNNELED) {
+      std::cerr<<"WARNING: the MPI library does not support threads, catchments will run on one thread"<<std::endl;
+      catchment_threads = 1;
+    }
+    #endif
+    utils::ThreadPool catchment_pool(catchment_threads, manager->get_execution_params().pin_threads);
+    if(catchment_pool.size() > 1) {
+      std::cout<<"Running catchments with "<<catchment_pool.size()<<" threads"<<std::endl;
+    }
+    #ifdef NGEN_LSTM_TORCH_LIB_ACTIVE
+    //LibTorch's thread pools share the process's CPUs with the catchment threads, rather than each taking them all
+    lstm::match_torch_threads(catchment_pool.size());
+    #endif
+
+    //Formulations start from the end states of their spin-up, unless restarted from a checkpoint's states
+    if(manager->get_spinup_params().enabled && RESTART_PATH.empty()) {
+      std::shared_ptr<realization::Formulation_Manager> spinup_manager = manager->make_spinup_manager();
+      spinup_manager->read(catchment_collection, utils::getStdOut());
+      #ifdef ACTIVATE_PYTHON
+      std::unique_ptr<py::gil_scoped_release> spinup_gil_release;
+      if(catchment_pool.size() > 1) {
+        spinup_gil_release = std::unique_ptr<py::gil_scoped_release>(new py::gil_scoped_release());
+      }
+      #endif // ACTIVATE_PYTHON
+      std::size_t cached_count = spinup::spin_up(*manager, *spinup_manager, pdm_et_data, catchment_pool);
+      std::cout<<"Spun up from "<<manager->get_spinup_params().start_time<<", with the end states of "<<cached_count
+               <<" of "<<manager->get_size()<<" catchments from "<<manager->get_spinup_params().cache_path<<std::endl;
+    }
+
+    //Built-in channel routing of every catchment's flowpath, taking the catchment flows of each time step as lateral
+    //inflow, with the routed nexus flows written to their own nexus output, prefixed with routed_
+    const channel_routing_params& channel_config = manager->get_channel_routing_params();
+    std::unique_ptr<network::ChannelRouting> channel_routing;
+    std::unique_ptr<nexus_output::NexusOutputWriter> routed_nexus_writer;
+    //The reach of each catchment, and the lateral inflow of each reach
+    std::vector<std::size_t> catchment_reaches;
+    std::vector<double> lateral_inflows;
+    if(channel_config.enabled) {
+      #ifdef NGEN_MPI_ACTIVE
+      //Reaches would take inflow across partition boundaries, which the remote nexuses only exchange unrouted
+      std::cerr<<"WARNING: channel routing is not supported with MPI, channels will not be routed"<<std::endl;
+      #else
+      channel_routing = std::unique_ptr<network::ChannelRouting>(new network::ChannelRouting(
+          features.get_network(), load_channel_params(channel_config), channel_config.substeps));
+      for(const auto& id : catchment_ids) {
+        catchment_reaches.push_back(channel_routing->reach_index(id));
+      }
+      lateral_inflows.assign(catchment_ids.size(), 0.0);
+      output_params routed_output_config = manager->get_output_params();
+      routed_output_config.nexus_path += "routed_";
+      routed_nexus_writer = nexus_output::make_nexus_output_writer(routed_output_config, channel_routing->nexus_ids(), "",
+                                                                   manager->Simulation_Time_Object->get_total_output_times(),
+                                                                   !RESTART_PATH.empty());
+      std::cout<<"Routing "<<catchment_ids.size()<<" channels in "<<channel_routing->num_levels()<<" levels"<<std::endl;
+      #endif
+    }
+
+    //Timestamps are formatted once up front, stepping through the output times, and shared by every output row
+    int total_output_times = manager->Simulation_Time_Object->get_total_output_times();
+    std::vector<std::string> timestamps;
+    timestamps.reserve(total_output_times);
+    Timestamp_Generator timestamp_generator(manager->Simulation_Time_Object->get_start_time(),
+                                            manager->Simulation_Time_Object->get_output_interval_seconds());
+    for(int output_time_index = 0; output_time_index < total_output_times; output_time_index++) {
+      timestamps.push_back(timestamp_generator.str());
+      timestamp_generator.advance();
+    }
+
+    //Catchment output is reduced to the selected variables, aggregated over periods of output time steps, before
+    //anything is formatted or written
+    const output_params& output_config = manager->get_output_params();
+    std::vector<std::vector<std::string>> catchment_variable_names;
+    for(const auto& r : catchment_realizations) {
+      auto r_c = dynamic_pointer_cast<realization::Catchment_Formulation>(r);
+      catchment_variable_names.push_back(
+          catchment_output::CatchmentOutputAggregator::split_names(r_c->get_output_header_line(",")));
+    }
+    std::unique_ptr<catchment_output::CatchmentOutputAggregator> catchment_aggregator;
+    if(output_config.catchment_aggregation_steps > 1 || !output_config.catchment_variables.empty()) {
+      catchment_aggregator = std::unique_ptr<catchment_output::CatchmentOutputAggregator>(
+          new catchment_output::CatchmentOutputAggregator(catchment_ids, catchment_variable_names,
+                                                          catchment_step_multiples, output_config.catchment_variables,
+                                                          output_config.catchment_aggregation_steps));
+      for(std::size_t i = 0; i < catchment_ids.size(); ++i) {
+        catchment_variable_names[i] = catchment_aggregator->get_variable_names(catchment_ids[i]);
+      }
+    }
+
+    //Only the selected catchments have their output written; the others still run, and contribute their flows
+    utils::IdSelector catchment_output_selector(output_config.catchment_selection);
+    std::vector<bool> catchment_output_selected(catchment_ids.size());
+    std::vector<std::string> output_catchment_ids;
+    std::vector<std::vector<std::string>> output_catchment_variable_names;
+    for(std::size_t i = 0; i < catchment_ids.size(); ++i) {
+      catchment_output_selected[i] = catchment_output_selector.matches(catchment_ids[i]);
+      if(catchment_output_selected[i]) {
+        output_catchment_ids.push_back(catchment_ids[i]);
+        output_catchment_variable_names.push_back(catchment_variable_names[i]);
+      }
+    }
+    if(output_catchment_ids.size() < catchment_ids.size()) {
+      std::cout<<"Writing the output of "<<output_catchment_ids.size()<<" of "<<catchment_ids.size()<<" catchments"<<std::endl;
+    }
+
+    //With the binary and parquet catchment output formats, every local catchment's output goes to one file for this
+    //process, rather than each catchment keeping its own csv file open; with the stream format, it is published on a
+    //socket
+    std::unique_ptr<catchment_output::CatchmentOutputWriter> catchment_writer;
+    if(output_config.catchment_format == "binary") {
+      catchment_writer = std::unique_ptr<catchment_output::CatchmentOutputWriter>(
+          new catchment_output::BinaryCatchmentOutputWriter(
+              output_catchment_ids, output_catchment_variable_names,
+              output_config.catchment_path + "catchment_output" + nexus_output_tag + ".bin",
+              static_cast<std::size_t>(output_config.catchment_buffer_mb) * 1024 * 1024));
+    }
+    else if(output_config.catchment_format == "stream") {
+      catchment_writer = std::unique_ptr<catchment_output::CatchmentOutputWriter>(
+          new catchment_output::StreamCatchmentOutputWriter(
+              output_catchment_ids, output_catchment_variable_names,
+              output_config.catchment_path + "catchment_output" + nexus_output_tag + ".sock",
+              static_cast<std::size_t>(output_config.catchment_buffer_mb) * 1024 * 1024,
+              output_config.stream_subscribers));
+    }
+    else if(output_config.catchment_format == "parquet") {
+    #ifdef NGEN_PARQUET_ACTIVE
+      catchment_writer = std::unique_ptr<catchment_output::CatchmentOutputWriter>(
+          new catchment_output::ParquetCatchmentOutputWriter(
+              output_catchment_ids, output_catchment_variable_names,
+              output_config.catchment_path + "catchment_output" + nexus_output_tag + ".parquet",
+              static_cast<std::size_t>(output_config.catchment_buffer_mb) * 1024 * 1024));
+    #else
+      throw std::runtime_error("Catchment output format 'parquet' requires Arrow and Parquet support, which is not enabled in this build.");
+    #endif
+    }
+
+    //Catchment output rows are formatted and written by a background thread, unless the queue is disabled
+    struct CatchmentOutputRecord {
+      //Only the output stream of the formulation is used by the output thread, which alone writes to it while running
+      realization::Catchment_Formulation* formulation = nullptr;
+      const std::string* catchment_id = nullptr;
+      int output_time_index = 0;
+      //Formulations that provide numeric output are only formatted as text on the output thread, in the format they
+      //had when the values were taken, so no formulation state is read there
+      bool is_numeric = false;
+      realization::Formulation::OutputFormat format;
+      std::vector<double> values;
+      std::string line;
+    };
+    //With a response cache, the responses and outputs of each catchment whose formulation runs at the output interval
+    //are recorded, to be cached at the end of the run for reruns to replay
+    const std::shared_ptr<realization::Response_Cache>& response_cache = manager->get_response_cache();
+    std::vector<std::unique_ptr<realization::Response_Cache::Entry>> catchment_response_entries(catchment_ids.size());
+    if(response_cache) {
+      std::size_t cached_count = 0;
+      for(std::size_t i = 0; i < catchment_ids.size(); ++i) {
+        if(dynamic_cast<realization::Cached_Response_Formulation*>(catchment_formulations[i])) {
+          ++cached_count;
+        }
+        else if(catchment_formulations[i] && catchment_step_multiples[i] == 1 && catchment_substeps[i] == 1) {
+          catchment_response_entries[i] = response_cache->start_entry(
+              catchment_ids[i], catchment_output::CatchmentOutputAggregator::split_names(
+                  catchment_formulations[i]->get_output_header_line(",")));
+        }
+      }
+      std::cout<<"Replaying the cached responses of "<<cached_count<<" of "<<catchment_ids.size()<<" catchments"<<std::endl;
+    }
+
+    auto write_catchment_row = [&](CatchmentOutputRecord& record) {
+        if(catchment_writer) {
+          time_t time = manager->Simulation_Time_Object->get_start_time()
+                        + static_cast<time_t>(record.output_time_index) * output_interval_seconds;
+          catchment_writer->write(*record.catchment_id, record.output_time_index, time,
+                                  record.is_numeric ? record.values
+                                                    : catchment_output::BinaryCatchmentOutputWriter::parse_values(record.line));
+          return;
         }
-  #endif
-        //std::cout<<"\tNexus "<<id<<" has "<<contribution_at_t<<" m^3/s"<<std::endl;
+        std::string row = std::to_string(record.output_time_index);
+        row.append(",").append(timestamps[record.output_time_index]).append(",")
+           .append(record.is_numeric ? record.format.format(record.values) : record.line)
+           .append("\n");
+        record.formulation->write_output(row);
+    };
+    auto write_catchment_output = [&](CatchmentOutputRecord& record) {
+        NGEN_PROFILE_SCOPE("output/catchment_write");
+        utils::StepArena::Scope arena_scope;
+        if(catchment_aggregator) {
+          std::vector<double> values = record.is_numeric ? std::move(record.values)
+                                                         : catchment_output::BinaryCatchmentOutputWriter::parse_values(record.line);
+          long period_time_index;
+          if(!catchment_aggregator->add(*record.catchment_id, record.output_time_index, values, period_time_index,
+                                        record.values)) {
+            return;
+          }
+          record.output_time_index = period_time_index;
+          record.is_numeric = true;
+        }
+        write_catchment_row(record);
+    };
+    std::unique_ptr<utils::AsyncOutputWriter<CatchmentOutputRecord>> catchment_output;
+    if(manager->get_output_params().catchment_queue_size > 0) {
+      catchment_output = std::unique_ptr<utils::AsyncOutputWriter<CatchmentOutputRecord>>(
+          new utils::AsyncOutputWriter<CatchmentOutputRecord>(manager->get_output_params().catchment_queue_size,
+                                                              write_catchment_output));
+    }
+
+    //Run the formulation of catchment i for an output time step, returning its flow contribution in m^3/s.
+    //A formulation with a longer time step only runs at the first output time step its step spans, and contributes
+    //the same flow, the average over its step, for each of them; one with a shorter time step runs each of its
+    //substeps, and contributes the average flow over them.  Either way the volume of the nexus flows is conserved.
+    auto run_catchment = [&](std::size_t i, int output_time_index) -> double {
+        const int step_multiple = catchment_step_multiples[i];
+        if(is_catchment_costs_wanted) {
+          ++catchment_cost_steps[i];
+        }
+        if(output_time_index % step_multiple != 0) {
+          return catchment_held_flows[i];
+        }
+        //Transient allocations of the catchment's step come from this thread's arena, released when the step ends
+        utils::StepArena::Scope arena_scope;
+        //std::cout<<"Running cat "<<catchment_ids[i]<<std::endl;
+        realization::Catchment_Formulation* r_c = catchment_formulations[i];
+        const int substeps = catchment_substeps[i];
+        const long time_step_seconds = output_interval_seconds * step_multiple / substeps;
+        //The index of the first time step to run, in the formulation's own time steps
+        const int first_formulation_time_index = output_time_index / step_multiple * substeps;
+        double response = 0.0;
+        {
+          utils::ScopedTimer timer(catchment_response_regions[i]);
+          std::chrono::steady_clock::time_point start;
+          if(is_catchment_costs_wanted) {
+            start = std::chrono::steady_clock::now();
+          }
+          response = realization::run_formulation_steps(catchment_formulation_tags[i], *r_c,
+                                                        first_formulation_time_index, substeps, time_step_seconds);
+          if(is_catchment_costs_wanted) {
+            catchment_cost_seconds[i] += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+          }
+        }
+        catchment_held_flows[i] = response * catchment_flow_factors[i];
+        if(!catchment_output_selected[i] && !catchment_response_entries[i]) {
+          return catchment_held_flows[i];
+        }
+        //Output is of the last time step run
+        const int formulation_time_index = first_formulation_time_index + substeps - 1;
+        CatchmentOutputRecord record;
+        record.formulation = r_c;
+        record.catchment_id = &catchment_ids[i];
+        record.output_time_index = output_time_index;
+        record.is_numeric = r_c->get_output_values_for_timestep(formulation_time_index, record.values);
+        record.format = r_c->get_output_format();
+        if(!record.is_numeric) {
+          record.line = r_c->get_output_line_for_timestep(formulation_time_index);
+        }
+        if(catchment_response_entries[i]) {
+          //Outputs only formatted as text are cached as the values of the text, and replayed as numbers
+          catchment_response_entries[i]->record(formulation_time_index, response, record.is_numeric ? record.values
+              : catchment_output::BinaryCatchmentOutputWriter::parse_values(record.line));
+        }
+        if(!catchment_output_selected[i]) {
+          return catchment_held_flows[i];
+        }
+        if(catchment_output) {
+          catchment_output->push(record);
+        }
+        else {
+          write_catchment_output(record);
+        }
+        return catchment_held_flows[i];
+    };
+
+    //A nexus this process writes the output of, resolved once so writing it is free of id lookups
+    struct NexusOutput {
+      std::string id;
+      std::shared_ptr<HY_HydroNexus> nexus;
+      //The "requesting" id for downstream_flow
+      std::string cat_id;
+      //Whether the output config selects the nexus's flows to be written
+      bool is_written = true;
+      #ifdef NGEN_MPI_ACTIVE
+      //The index of the nexus in the nexus reduction, if its flows are reduced onto the rank owning it
+      std::size_t reduction_index = 0;
+      #endif
+    };
+    auto resolve_nexus_output = [&](const std::string& id) {
+        NexusOutput output;
+        output.id = id;
+        output.nexus = features.nexus_at(features.handle_of(id));
+        const auto& cat_ids = output.nexus->get_receiving_catchments();
+        if( cat_ids.size() > 0 ) {
+          //Assumes dendridic, e.g. only a single downstream...it will consume 100%  of the available flow
+          output.cat_id = cat_ids[0];
+        }
+        else {
+          //This is a terminal node, SHOULDN'T be remote, so ID shouldn't matter too much
+          output.cat_id = "terminal";
+        }
+        output.is_written = std::binary_search(written_nexus_ids.begin(), written_nexus_ids.end(), id);
+        return output;
+    };
+    //output_nexus_ids already leaves out the remote sender nexuses, so only one side of the dual sided remote nexus
+    //writes its output; the nexuses that are not written still take their flows, so their time steps are released
+    std::sort(written_nexus_ids.begin(), written_nexus_ids.end());
+    std::vector<NexusOutput> output_nexuses;
+    for(const auto& id : output_nexus_ids) {
+      output_nexuses.push_back(resolve_nexus_output(id));
+      #ifdef NGEN_MPI_ACTIVE
+      output_nexuses.back().reduction_index = output_nexuses.size() - 1;
+      #endif
+    }
+    #ifdef NGEN_MPI_ACTIVE
+    //The time step the chunk being added to the nexus reduction starts at, and which of the nexuses this rank owns
+    //the output config selects
+    int reduction_first_time_index = 0;
+    std::vector<bool> is_owned_nexus_written;
+    if(nexus_reduction) {
+      for(const auto& id : nexus_reduction->owned_nexus_ids()) {
+        is_owned_nexus_written.push_back(std::binary_search(written_nexus_ids.begin(), written_nexus_ids.end(), id));
+      }
+    }
+    #endif
+
+    //Take the downstream flow of a nexus for a time step, and dump it to the nexus output
+    auto write_nexus = [&](const NexusOutput& output, int output_time_index, const std::string& current_timestamp) {
+        NGEN_PROFILE_SCOPE("output/nexus_write");
+        #ifdef NGEN_MPI_ACTIVE
+        if(nexus_reduction) {
+          //A rank's copy of a nexus has no flow if none of the rank's catchments drain to it
+          double partial_flow = output.nexus->inspect_upstream_flows(output_time_index).second > 0
+              ? output.nexus->get_downstream_flow(output.cat_id, output_time_index, 100.0) : 0.0;
+          nexus_reduction->add(output.reduction_index, output_time_index - reduction_first_time_index, partial_flow);
+          return;
+        }
+        #endif
+        double contribution_at_t = output.nexus->get_downstream_flow(output.cat_id, output_time_index, 100.0);
+        if(!output.is_written) {
+          return;
+        }
+        nexus_writer->write(output.id, output_time_index, current_timestamp, contribution_at_t);
+        //std::cout<<"\tNexus "<<output.id<<" has "<<contribution_at_t<<" m^3/s"<<std::endl;
 
         //Note: Use below if developing in-memory transfer of nexus flows to routing
         //If using below, then another single time vector would be needed to hold the timestamp
         //nexus_flows[id].push_back(contribution_at_t); 
-      } //done nexuses
-    } //done time
-    std::cout<<"Finished "<<manager->Simulation_Time_Object->get_total_output_times()<<" timesteps."<<std::endl;
+    };
+
+    #ifdef ACTIVATE_PYTHON
+    //Python formulations take the GIL for each of their steps, so this thread must not hold it while other threads
+    //run catchments, or while pipelined routing does
+    std::unique_ptr<py::gil_scoped_release> python_gil_release;
+    bool is_gil_shared = catchment_pool.size() > 1;
+    #ifdef NGEN_ROUTING_ACTIVE
+    is_gil_shared = is_gil_shared || routing_pipeline;
+    #endif // NGEN_ROUTING_ACTIVE
+    if(is_gil_shared) {
+      python_gil_release = std::unique_ptr<py::gil_scoped_release>(new py::gil_scoped_release());
+    }
+    #endif // ACTIVATE_PYTHON
+
+    long lookahead = manager->get_execution_params().lookahead;
+    #ifdef NGEN_MPI_ACTIVE
+    if(lookahead > 0) {
+      //Remote nexuses exchange flows with blocking pairs of messages, which requires every rank to visit its
+      //nexuses in the same time step order
+      std::cerr<<"WARNING: execution lookahead is not supported with MPI, running one time step at a time"<<std::endl;
+      lookahead = 0;
+    }
+    #endif
+
+    //Checkpoints save the state of every catchment formulation between time steps of the lockstep loop, where every
+    //feature has finished the same time step and no nexus holds flow that is yet to be taken downstream
+    long checkpoint_interval = manager->get_execution_params().checkpoint_interval;
+    std::string checkpoint_path = manager->get_execution_params().checkpoint_path;
+    std::string restart_path = RESTART_PATH;
+    #ifdef NGEN_MPI_ACTIVE
+    checkpoint_path = utils::CheckpointFile::rank_path(checkpoint_path, mpi_rank, mpi_num_procs);
+    if(!restart_path.empty()) {
+      restart_path = utils::CheckpointFile::rank_path(restart_path, mpi_rank, mpi_num_procs);
+    }
+    #endif
+    if(lookahead > 0 && (checkpoint_interval > 0 || !restart_path.empty())) {
+      std::cerr<<"WARNING: checkpoints are not supported with execution lookahead, running one time step at a time"<<std::endl;
+      lookahead = 0;
+    }
+    if(lookahead > 0 && is_cycle_mode_wanted) {
+      std::cerr<<"WARNING: cycles are not supported with execution lookahead, running one time step at a time"<<std::endl;
+      lookahead = 0;
+    }
+    if(lookahead > 0 && channel_routing) {
+      //Reaches are routed level by level once every catchment has finished the time step
+      std::cerr<<"WARNING: channel routing is not supported with execution lookahead, running one time step at a time"<<std::endl;
+      lookahead = 0;
+    }
+    //With a page_block, the models of all but a block of catchments at a time are paged out of memory
+    const std::shared_ptr<realization::Catchment_State_Pager>& state_pager = manager->get_state_pager();
+    if(lookahead > 0 && state_pager) {
+      //Blocks of catchments run through each block of time steps in turn
+      std::cerr<<"WARNING: execution page_block is not supported with execution lookahead, running one time step at a time"<<std::endl;
+      lookahead = 0;
+    }
+    //Catchments depend only on their forcings, so each may run a block of time steps before the nexuses take its flows
+    long time_block = manager->get_execution_params().time_block;
+    if(time_block > 1 && lookahead > 0) {
+      std::cerr<<"WARNING: the execution time_block has no effect with execution lookahead"<<std::endl;
+      time_block = 1;
+    }
+    const bool is_time_blocked = time_block > 1 || state_pager;
+    #ifdef NGEN_MPI_ACTIVE
+    //Flows only go downstream, and other ranks' flows are only needed for the nexus output, so ranks may run a chunk of
+    //time steps before exchanging their boundary flows and writing their nexuses; the time step the chunk in progress
+    //starts at.  Reduced nexuses have no boundary flows to exchange.
+    const long remote_chunk_steps = nexus_reduction ? 1 : manager->get_execution_params().remote_chunk_steps;
+    int remote_chunk_first_time_index = 0;
+    #endif
+    ngen::TimeBlock block_flows(is_time_blocked ? catchment_ids.size() : 0, time_block, checkpoint_interval);
+    auto save_catchment_states = [&](utils::CheckpointFile::states_t& states) {
+        for(std::size_t i = 0; i < catchment_ids.size(); ++i) {
+          auto r_c = dynamic_pointer_cast<realization::Catchment_Formulation>(catchment_realizations[i]);
+          utils::StateWriter out;
+          if(state_pager) {
+            state_pager->save_state(*r_c, out);
+          }
+          else {
+            r_c->save_state(out);
+          }
+          states[catchment_ids[i]] = out.get_bytes();
+        }
+        if(channel_routing) {
+          utils::StateWriter out;
+          channel_routing->save_state(out);
+          states["channel_routing"] = out.get_bytes();
+        }
+    };
+    //Checkpoints are written while the run continues, so it only stops to save the states
+    utils::CheckpointWriter checkpoint_writer(checkpoint_path, manager->get_execution_params().checkpoint_incremental);
+    auto write_checkpoint = [&](int next_output_time_index) {
+        //Outputs of the steps before the checkpoint are written first, so a restart never leaves a gap in them
+        if(catchment_output) {
+          catchment_output->flush();
+        }
+        if(catchment_writer) {
+          catchment_writer->flush();
+        }
+        nexus_writer->flush();
+        if(routed_nexus_writer) {
+          routed_nexus_writer->flush();
+        }
+        utils::CheckpointFile::states_t states;
+        save_catchment_states(states);
+        checkpoint_writer.write(next_output_time_index, states);
+        std::cout<<"Writing checkpoint before timestep "<<next_output_time_index<<" to "<<checkpoint_path<<std::endl;
+    };
+    if(checkpoint_interval > 0) {
+      //Checkpoints fall between the time steps of every formulation, so none needs its held flow saved
+      for(std::size_t i = 0; i < catchment_ids.size(); ++i) {
+        if(checkpoint_interval % catchment_step_multiples[i] != 0) {
+          throw std::runtime_error("The checkpoint_interval is not a whole number of the time steps of the formulation of "
+                                   + catchment_ids[i] + ".");
+        }
+      }
+      //Fail now, rather than at the first checkpoint, if any formulation can't save its state
+      utils::CheckpointFile::states_t states;
+      save_catchment_states(states);
+    }
+
+    int first_output_time_index = 0;
+    if(!restart_path.empty()) {
+      utils::CheckpointFile::states_t states;
+      first_output_time_index = utils::CheckpointFile::read(restart_path, states);
+      #ifdef NGEN_MPI_ACTIVE
+      //After repartitioning (see rebalance_threshold), some of this rank's catchments were checkpointed by others
+      bool is_state_missing = false;
+      for(const auto& id : catchment_ids) {
+        is_state_missing = is_state_missing || states.find(id) == states.end();
+      }
+      for(int r = 0; is_state_missing && r < mpi_num_procs; ++r) {
+        std::string other_path = utils::CheckpointFile::rank_path(RESTART_PATH, r, mpi_num_procs);
+        if(r == mpi_rank || !utils::FileChecker::file_is_readable(other_path)) {
+          continue;
+        }
+        utils::CheckpointFile::states_t other_states;
+        if(utils::CheckpointFile::read(other_path, other_states) != first_output_time_index) {
+          throw std::runtime_error("Checkpoint " + other_path + " is not of the same time step as " + restart_path + ".");
+        }
+        for(const auto& id : catchment_ids) {
+          auto state = other_states.find(id);
+          if(state != other_states.end() && states.find(id) == states.end()) {
+            states.insert(std::move(*state));
+          }
+        }
+        is_state_missing = false;
+        for(const auto& id : catchment_ids) {
+          is_state_missing = is_state_missing || states.find(id) == states.end();
+        }
+      }
+      #endif
+      for(std::size_t i = 0; i < catchment_ids.size(); ++i) {
+        auto state = states.find(catchment_ids[i]);
+        if(state == states.end()) {
+          throw std::runtime_error("Checkpoint " + restart_path + " has no state for catchment " + catchment_ids[i] + ".");
+        }
+        if(first_output_time_index % catchment_step_multiples[i] != 0) {
+          throw std::runtime_error("Checkpoint " + restart_path + " is not at the start of a time step of the formulation of "
+                                   + catchment_ids[i] + ".");
+        }
+        auto r_c = dynamic_pointer_cast<realization::Catchment_Formulation>(catchment_realizations[i]);
+        if(state_pager) {
+          state_pager->load_state(*r_c, state->second);
+        }
+        else {
+          utils::StateReader in(state->second);
+          r_c->load_state(in);
+        }
+      }
+      if(channel_routing) {
+        auto state = states.find("channel_routing");
+        if(state == states.end()) {
+          throw std::runtime_error("Checkpoint " + restart_path + " has no state for channel routing.");
+        }
+        utils::StateReader in(state->second);
+        channel_routing->load_state(in);
+      }
+      //Nexuses recycle the bookkeeping of completed time steps from the first one on, which is now the restart's
+      for(const auto& id : features.nexuses()) {
+        if(auto nexus = features.nexus_at(id)) {
+          nexus->set_mintime(first_output_time_index);
+        }
+      }
+      std::cout<<"Restarting from timestep "<<first_output_time_index<<" of checkpoint "<<restart_path<<std::endl;
+      #ifdef NGEN_ROUTING_ACTIVE
+      first_unrouted_time_index = first_output_time_index;
+      if(routing_history != nullptr) {
+        //The steps before the checkpoint are routed too if every rank kept them from the run it restarts
+        int is_history_kept = routing_history->was_reopened()
+                              && routing_history->get_completed_steps() >= std::size_t(first_output_time_index) ? 1 : 0;
+        #ifdef NGEN_MPI_ACTIVE
+        MPI_Allreduce(MPI_IN_PLACE, &is_history_kept, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+        #endif
+        if(is_history_kept) {
+          first_unrouted_time_index = 0;
+        }
+        else {
+          std::cerr<<"WARNING: the mapped nexus output of the run restarted from was not kept on every rank; routing "
+                   <<"only the steps from timestep "<<first_output_time_index<<std::endl;
+        }
+      }
+      #endif
+    }
+
+    //Rebalancing compares the loads of the ranks over the time steps since the last checkpoint, and when they are too
+    //uneven, ends the run at the next checkpoint, with the measured costs written out to repartition by
+    std::string rebalance_costs_path = manager->get_execution_params().checkpoint_path + ".costs";
+    std::vector<double> rebalance_cost_seconds(catchment_ids.size(), 0.0);
+    std::vector<long> rebalance_cost_steps(catchment_ids.size(), 0);
+    int rebalance_time_index = -1;
+    #ifdef NGEN_MPI_ACTIVE
+    if(rebalance_threshold > 0 && checkpoint_interval == 0) {
+      std::cerr<<"WARNING: rebalancing requires a checkpoint_interval, so the run will not be rebalanced"<<std::endl;
+    }
+    //Whether the heaviest load since the last checkpoint is too far over the mean, which every rank must ask together
+    auto is_rebalance_needed = [&]() {
+        double load = 0.0;
+        for(std::size_t i = 0; i < catchment_ids.size(); ++i) {
+          load += catchment_cost_seconds[i] - rebalance_cost_seconds[i];
+        }
+        double max_load = 0.0;
+        double total_load = 0.0;
+        MPI_Allreduce(&load, &max_load, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+        MPI_Allreduce(&load, &total_load, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+        double mean_load = total_load / mpi_num_procs;
+        bool is_needed = mean_load > 0 && max_load > rebalance_threshold * mean_load;
+        if(is_needed && mpi_rank == 0) {
+          std::cout<<"The heaviest rank load since the last checkpoint is "<<max_load / mean_load
+                   <<" times the mean; ending the run at the checkpoint to rebalance"<<std::endl;
+        }
+        if(!is_needed) {
+          rebalance_cost_seconds = catchment_cost_seconds;
+          rebalance_cost_steps = catchment_cost_steps;
+        }
+        return is_needed;
+    };
+    #else
+    if(rebalance_threshold > 0) {
+      std::cerr<<"WARNING: rebalancing is only done between MPI ranks, so the run will not be rebalanced"<<std::endl;
+    }
+    #endif
+
+    //Progress reports, every progress_interval time steps, of the rate, estimated time to completion and where the
+    //time went, which rank 0 prints for all ranks
+    utils::RunProgress progress(output_config.progress_interval, first_output_time_index);
+    auto print_progress = [&](const std::vector<double>& samples, int processes) {
+        std::cout<<utils::RunProgress::format_report(samples, processes, total_output_times)<<std::endl;
+        if(!output_config.metrics_path.empty() &&
+           !utils::RunProgress::write_metrics(output_config.metrics_path, samples, processes, total_output_times)) {
+          std::cerr<<"WARNING: could not write the run metrics to "<<output_config.metrics_path<<std::endl;
+        }
+    };
+    #ifdef NGEN_MPI_ACTIVE
+    //Each report's samples are gathered without holding up the run, and printed once the next report is due, so
+    //rank 0 never waits on the slowest rank to report
+    std::vector<double> progress_sample;
+    std::vector<double> progress_samples(mpi_rank == 0 ? mpi_num_procs * utils::RunProgress::SAMPLE_SIZE : 0);
+    MPI_Request progress_request = MPI_REQUEST_NULL;
+    auto complete_progress_gather = [&]() {
+        if(progress_request != MPI_REQUEST_NULL) {
+          MPI_Wait(&progress_request, MPI_STATUS_IGNORE);
+          if(mpi_rank == 0) {
+            print_progress(progress_samples, mpi_num_procs);
+          }
+        }
+    };
+    #endif
+    auto report_progress = [&](int completed_steps) {
+        #ifdef NGEN_MPI_ACTIVE
+        complete_progress_gather();
+        progress_sample = progress.sample(completed_steps);
+        MPI_Igather(progress_sample.data(), utils::RunProgress::SAMPLE_SIZE, MPI_DOUBLE, progress_samples.data(),
+                    utils::RunProgress::SAMPLE_SIZE, MPI_DOUBLE, 0, MPI_COMM_WORLD, &progress_request);
+        #else
+        print_progress(progress.sample(completed_steps), 1);
+        #endif
+    };
+
+    //The report of where this rank is that SIGUSR1 asks for, written between time steps so everything it reads is
+    //consistent, without any communication with other ranks, since the rank may be asked while the others are stuck
+    std::string status_tag = "";
+    int status_rank = 0;
+    #ifdef NGEN_MPI_ACTIVE
+    status_tag = "_rank_" + std::to_string(mpi_rank);
+    status_rank = mpi_rank;
+    #endif
+    const std::string status_report_path = output_config.status_path + "ngen_status" + status_tag + ".txt";
+    auto write_status = [&](int completed_steps) {
+        bool is_written = utils::StatusDump::write(status_report_path, [&](std::ostream& out) {
+            out<<"rank "<<status_rank<<"\n";
+            out<<"completed_steps "<<completed_steps<<" of "<<total_output_times<<"\n";
+            if(completed_steps > 0) {
+              out<<"last_timestamp "<<timestamps[completed_steps - 1]<<"\n";
+            }
+            out<<"elapsed_seconds "<<progress.get_elapsed_seconds()<<"\n";
+            out<<"compute_seconds "<<progress.get_phase_seconds(utils::RunProgress::COMPUTE)<<"\n";
+            out<<"communication_seconds "<<progress.get_phase_seconds(utils::RunProgress::COMMUNICATION)<<"\n";
+            out<<"output_seconds "<<progress.get_phase_seconds(utils::RunProgress::OUTPUT)<<"\n";
+            out<<"catchment_output_queued "<<(catchment_output ? catchment_output->get_queued_count() : 0)<<"\n";
+            #ifdef NGEN_ROUTING_ACTIVE
+            out<<"routing_pending_chunks "<<(routing_pipeline ? routing_pipeline->get_pending_chunks() : 0)<<"\n";
+            #endif
+            #ifdef NGEN_MPI_ACTIVE
+            features.write_remote_status(out);
+            #endif
+            if(utils::Profiler::is_enabled()) {
+              out<<"profile\n";
+              utils::Profiler::write_summary(out, utils::Profiler::collect());
+            }
+        });
+        if(is_written) {
+          std::cout<<"Wrote status report "<<status_report_path<<" after timestep "<<completed_steps<<std::endl;
+        }
+        else {
+          std::cerr<<"WARNING: could not write status report "<<status_report_path<<std::endl;
+        }
+    };
+
+    //Start the time steps from block_start up to block_end of every group of formulations computed on an accelerator,
+    //on a thread of its own, so they run while the host formulations do; the groups' catchments then take the results
+    auto start_device_steps = [&](int block_start, int block_end) {
+        if(device_group_leaders.empty()) {
+          return std::future<void>();
+        }
+        return std::async(std::launch::async, [&, block_start, block_end]() {
+            NGEN_PROFILE_SCOPE("main/device_steps");
+            for(int t = block_start; t < block_end; ++t) {
+              for(std::size_t i : device_group_leaders) {
+                const int step_multiple = catchment_step_multiples[i];
+                if(t % step_multiple != 0) {
+                  continue;
+                }
+                const int substeps = catchment_substeps[i];
+                const long time_step_seconds = output_interval_seconds * step_multiple / substeps;
+                const int first_formulation_time_index = t / step_multiple * substeps;
+                for(int s = 0; s < substeps; ++s) {
+                  catchment_formulations[i]->run_device_step(first_formulation_time_index + s, time_step_seconds);
+                }
+              }
+            }
+        });
+    };
+    //Wait for the time steps started by start_device_steps, if any, passing on any exception they threw
+    auto finish_device_steps = [](std::future<void>& device_steps) {
+        if(device_steps.valid()) {
+          device_steps.get();
+        }
+    };
+    if(!device_group_leaders.empty() && lookahead == 0 && !state_pager) {
+      std::cout<<"Overlapping "<<device_group_leaders.size()<<" accelerator group(s) of catchments with the others"<<std::endl;
+    }
+
+    //Run the catchments at positions first up to last of the run order through the time steps of the current block
+    auto run_catchment_block = [&](std::size_t first, std::size_t last, int block_start, int block_end) {
+        catchment_pool.parallel_for(last - first, [&](std::size_t k) {
+          const std::size_t i = catchment_run_order[first + k];
+          for(int t = block_start; t < block_end; ++t) {
+            block_flows.flow(i, t) = run_catchment(i, t);
+          }
+        });
+    };
+    //Paged models are constructed and finalized on other threads than the main one only if their BMI Initialize is
+    //safe to run concurrently (see init_threads), in which case the next page block is paged in while one runs
+    const bool is_paging_concurrent = manager->get_execution_params().init_threads != 1;
+    auto page_catchment_block = [&](std::size_t first, std::size_t last, bool is_in) {
+        auto page = [&](std::size_t k) {
+          realization::Catchment_Formulation* r_c = catchment_formulations[catchment_run_order[first + k]];
+          if(r_c && is_in) {
+            state_pager->page_in(*r_c);
+          }
+          else if(r_c) {
+            state_pager->page_out(*r_c);
+          }
+        };
+        if(is_paging_concurrent && !is_in) {
+          catchment_pool.parallel_for(last - first, page);
+        }
+        else {
+          for(std::size_t k = 0; k < last - first; ++k) {
+            page(k);
+          }
+        }
+    };
+    //Run every catchment through the time steps of the current block, a page block of them at a time, with the models
+    //of each paged in for the block and out again after it
+    auto run_paged_catchment_blocks = [&](int block_start, int block_end) {
+        const std::size_t count = catchment_ids.size();
+        const std::size_t page_block = static_cast<std::size_t>(state_pager->get_block_size());
+        //Start reading the states of the page block from first, while the one before it runs
+        auto prefetch_page_block = [&](std::size_t first) {
+          for(std::size_t k = first; k < std::min(count, first + page_block); ++k) {
+            if(catchment_formulations[catchment_run_order[k]]) {
+              state_pager->prefetch(*catchment_formulations[catchment_run_order[k]]);
+            }
+          }
+        };
+        std::future<void> next_page_in;
+        auto start_page_in = [&](std::size_t first) {
+          prefetch_page_block(first);
+          next_page_in = std::async(std::launch::async, page_catchment_block, first, std::min(count, first + page_block),
+                                    true);
+        };
+        if(is_paging_concurrent) {
+          start_page_in(0);
+        }
+        for(std::size_t first = 0; first < count; first += page_block) {
+          const std::size_t last = std::min(count, first + page_block);
+          if(is_paging_concurrent) {
+            next_page_in.get();
+            if(last < count) {
+              start_page_in(last);
+            }
+          }
+          else {
+            page_catchment_block(first, last, true);
+            prefetch_page_block(last);
+          }
+          run_catchment_block(first, last, block_start, block_end);
+          page_catchment_block(first, last, false);
+        }
+    };
+
+    #ifdef NGEN_MPI_ACTIVE
+    //Sum the flows of the time steps from the start of the reduction's chunk up to, but not including, end onto the
+    //ranks owning the nexuses, and write those of the nexuses this rank owns
+    auto write_reduced_nexuses = [&](int end) {
+        nexus_reduction->reduce();
+        const std::vector<std::string>& owned_ids = nexus_reduction->owned_nexus_ids();
+        NGEN_PROFILE_SCOPE("output/nexus_write");
+        for(int t = reduction_first_time_index; t < end; ++t) {
+          const double* flows = nexus_reduction->owned_flows(t - reduction_first_time_index);
+          for(std::size_t j = 0; j < owned_ids.size(); ++j) {
+            if(is_owned_nexus_written[j]) {
+              nexus_writer->write(owned_ids[j], t, timestamps[t], flows[j]);
+            }
+          }
+          nexus_writer->complete_time_step(t, timestamps[t]);
+        }
+        reduction_first_time_index = end;
+    };
+    #endif
+
+    //Now loop some time, iterate catchments, do stuff for the output times from first up to, but not including, last
+    auto run_time_steps = [&](int first, int last) {
+      #ifdef NGEN_MPI_ACTIVE
+      reduction_first_time_index = first;
+      remote_chunk_first_time_index = first;
+      #endif
+      //No block of a time_block greater than 1 has run yet
+      block_flows.reset(first);
+      for(int output_time_index = first; output_time_index < last; output_time_index++) {
+        //std::cout<<"Output Time Index: "<<output_time_index<<std::endl;
+        NGEN_PROFILE_SCOPE("main/time_step");
+        const std::string& current_timestamp = timestamps[output_time_index];
+        //Contribute to the nexuses on this thread, in catchment order, since remote nexuses stage flows for MPI
+        //when flows are added, and a fixed order keeps the summed nexus flows reproducible across thread counts
+        auto contribute = [&](std::size_t first, std::size_t last) {
+          for(std::size_t k = first; k < last; ++k) {
+            const std::size_t i = catchment_contribution_order[k];
+            //update the nexus with this flow
+            if(catchment_destinations[i] && !catchment_inflow_summed[i]) {
+              catchment_destinations[i]->add_upstream_flow(catchment_flows[i], catchment_ids[i], output_time_index);
+            }
+          }
+        };
+        //Add the summed flows of the nexuses in nexus_inflows, in chunks of rows in parallel
+        auto add_nexus_inflows = [&]() {
+          NGEN_PROFILE_SCOPE("main/nexus_inflows");
+          const std::size_t rows = nexus_inflows.rows();
+          const std::size_t chunks = std::min(catchment_pool.size(), (rows + 1023) / 1024);
+          catchment_pool.parallel_for(chunks, [&](std::size_t chunk) {
+            const std::size_t first_row = rows * chunk / chunks;
+            const std::size_t last_row = rows * (chunk + 1) / chunks;
+            nexus_inflows.multiply(catchment_flows.data(), nexus_inflow_sums.data(), first_row, last_row);
+            for(std::size_t r = first_row; r < last_row; ++r) {
+              //Recorded as the flow of the first of the nexus's catchments
+              inflow_nexuses[r]->add_upstream_flow(nexus_inflow_sums[r], catchment_ids[*nexus_inflows.row_begin(r)],
+                                                   output_time_index);
+            }
+          });
+        };
+        if(is_time_blocked) {
+          if(block_flows.is_due(output_time_index)) {
+            //Run each catchment through every time step of the next block, up to the next checkpoint, while its
+            //model state is in cache
+            NGEN_PROFILE_SCOPE("main/time_block");
+            block_flows.start(output_time_index, last);
+            if(state_pager) {
+              run_paged_catchment_blocks(block_flows.get_start(), block_flows.get_end());
+            }
+            else {
+              std::future<void> device_steps = start_device_steps(block_flows.get_start(), block_flows.get_end());
+              run_catchment_block(0, catchment_ids.size(), block_flows.get_start(), block_flows.get_end());
+              finish_device_steps(device_steps);
+            }
+          }
+          for(std::size_t i = 0; i < catchment_ids.size(); ++i) {
+            catchment_flows[i] = block_flows.flow(i, output_time_index);
+          }
+          contribute(0, catchment_ids.size());
+          add_nexus_inflows();
+        }
+        else {
+          //The boundary catchments first, whose contributions send this rank's flows to its neighbors, so the
+          //messages are in flight while the rest run
+          std::future<void> device_steps = start_device_steps(output_time_index, output_time_index + 1);
+          catchment_pool.parallel_for(boundary_catchment_count, [&](std::size_t k) {
+            const std::size_t i = catchment_run_order[k];
+            catchment_flows[i] = run_catchment(i, output_time_index);
+          });
+          contribute(0, boundary_catchment_count);
+          catchment_pool.parallel_for(catchment_ids.size() - boundary_catchment_count, [&](std::size_t k) {
+            const std::size_t i = catchment_run_order[boundary_catchment_count + k];
+            catchment_flows[i] = run_catchment(i, output_time_index);
+          }); //done catchments
+          finish_device_steps(device_steps);
+          contribute(boundary_catchment_count, catchment_ids.size());
+          add_nexus_inflows();
+        }
+        progress.lap(utils::RunProgress::COMPUTE);
+        const bool is_checkpoint_due = checkpoint_interval > 0 && (output_time_index + 1) % checkpoint_interval == 0 &&
+                                       output_time_index + 1 < last;
+        bool is_rebalance_due = false;
+        //The nexus output is written for the time steps from this one, if it is due
+        int nexus_output_first_time_index = output_time_index;
+        bool is_nexus_output_due = true;
+        #ifdef NGEN_MPI_ACTIVE
+        //Decided before the exchange, so no receives are posted for a time step that will not be run
+        is_rebalance_due = is_checkpoint_due && rebalance_threshold > 0 && is_rebalance_needed();
+        //A chunk ends early at a checkpoint, so no nexus holds flows of a time step before it
+        is_nexus_output_due = output_time_index + 1 - remote_chunk_first_time_index >= remote_chunk_steps
+                              || output_time_index + 1 == last || is_checkpoint_due;
+        if(is_nexus_output_due) {
+          //Complete the flows of this rank's boundary nexuses, and receive those of its neighbors, then post the
+          //receives of the next chunk so its flows arrive during its catchments
+          features.exchange_remote_chunk(remote_chunk_first_time_index,
+                                         output_time_index + 1 - remote_chunk_first_time_index,
+                                         output_time_index + 1 < last && !is_rebalance_due);
+          nexus_output_first_time_index = remote_chunk_first_time_index;
+          remote_chunk_first_time_index = output_time_index + 1;
+        }
+        progress.lap(utils::RunProgress::COMMUNICATION);
+        #endif
+        //At this point, could make an internal routing pass, extracting flows from nexuses and routing
+        //across the flowpath to the next nexus.
+        //Once everything is updated for this timestep, or chunk of them, dump the nexus output
+        for(int t = nexus_output_first_time_index; is_nexus_output_due && t <= output_time_index; ++t) {
+          for(const auto& output : output_nexuses) {
+            write_nexus(output, t, timestamps[t]);
+          } //done nexuses
+          #ifdef NGEN_MPI_ACTIVE
+          if(nexus_reduction) {
+            //Reduced once a chunk is full, and before the run stops for a checkpoint, so every time step up to it is
+            //written by then
+            if(t + 1 - reduction_first_time_index >= static_cast<long>(nexus_reduction->chunk_steps())
+               || (t == output_time_index && (t + 1 == last || is_checkpoint_due || is_rebalance_due))) {
+              write_reduced_nexuses(t + 1);
+            }
+            continue;
+          }
+          #endif
+          nexus_writer->complete_time_step(t, timestamps[t]);
+        }
+        progress.lap(utils::RunProgress::OUTPUT);
+        if(channel_routing) {
+          NGEN_PROFILE_SCOPE("routing/channel");
+          for(std::size_t i = 0; i < catchment_ids.size(); ++i) {
+            lateral_inflows[catchment_reaches[i]] = catchment_flows[i];
+          }
+          channel_routing->route(lateral_inflows, manager->Simulation_Time_Object->get_output_interval_seconds(),
+                                 &catchment_pool);
+          const std::vector<std::string>& routed_nexus_ids = channel_routing->nexus_ids();
+          for(std::size_t n = 0; n < routed_nexus_ids.size(); ++n) {
+            routed_nexus_writer->write(routed_nexus_ids[n], output_time_index, current_timestamp,
+                                       channel_routing->nexus_flow(n));
+          }
+          routed_nexus_writer->complete_time_step(output_time_index, current_timestamp);
+          progress.lap(utils::RunProgress::COMPUTE);
+        }
+        #if defined(NGEN_ROUTING_ACTIVE) && defined(NGEN_MPI_ACTIVE)
+        if(routing_flows != nullptr && routing_config.flow_chunk_steps > 0 && is_nexus_output_due &&
+           output_time_index + 1 - first_unrouted_time_index >= routing_config.flow_chunk_steps) {
+          hand_flows_to_routing(*routing_flows, std::vector<std::string>(timestamps.begin() + first_unrouted_time_index,
+                                timestamps.begin() + output_time_index + 1), router.get(), routing_pipeline.get());
+          routing_flows->clear();
+          first_unrouted_time_index = output_time_index + 1;
+        }
+        #endif
+        if(is_checkpoint_due) {
+          write_checkpoint(output_time_index + 1);
+        }
+        progress.lap(utils::RunProgress::OUTPUT);
+        if(progress.is_report_due(output_time_index)) {
+          report_progress(output_time_index + 1);
+        }
+        if(utils::StatusDump::take_request()) {
+          write_status(output_time_index + 1);
+        }
+        if(is_rebalance_due) {
+          std::vector<double> seconds(catchment_ids.size());
+          std::vector<long> steps(catchment_ids.size());
+          for(std::size_t i = 0; i < catchment_ids.size(); ++i) {
+            seconds[i] = catchment_cost_seconds[i] - rebalance_cost_seconds[i];
+            steps[i] = catchment_cost_steps[i] - rebalance_cost_steps[i];
+          }
+          write_catchment_costs(rebalance_costs_path, catchment_ids, seconds, steps);
+          rebalance_time_index = output_time_index + 1;
+          break;
+        }
+      } //done time
+    };
+
+    if(lookahead == 0) {
+      run_time_steps(first_output_time_index, total_output_times);
+    }
+    #ifndef NGEN_MPI_ACTIVE
+    else {
+      //Wavefront execution: each catchment and nexus runs a time step as soon as its upstream features finish it,
+      //so headwaters may run up to lookahead time steps ahead of the features downstream of them.
+      std::cout<<"Running with a lookahead of "<<lookahead<<" time steps"<<std::endl;
+      network::WavefrontScheduler scheduler(features.get_network(), total_output_times, lookahead);
+      //The scheduler orders catchments by its own index, so resolve realizations in that order;
+      //a catchment cannot get more than lookahead+1 steps ahead of its nexus, so that many flows are kept for each
+      catchment_ids = scheduler.catchment_ids();
+      resolve_catchments();
+      resolve_nexus_inflows();
+      catchment_held_flows.assign(catchment_ids.size(), 0.0);
+      catchment_cost_seconds.assign(catchment_ids.size(), 0.0);
+      catchment_cost_steps.assign(catchment_ids.size(), 0);
+      std::vector<NexusOutput> wavefront_nexuses;
+      for(const auto& id : scheduler.nexus_ids()) {
+        wavefront_nexuses.push_back(resolve_nexus_output(id));
+      }
+      std::size_t window = lookahead + 1;
+      std::vector<double> wavefront_flows(catchment_ids.size() * window, 0.0);
+
+      //Catchment steps whose forcing is read asynchronously (e.g. NetCDF with prefetch_blocks) wait for it to be read,
+      //requesting it when first checked, while the threads run any other steps that are ready
+      using AsyncForcingProvider = data_access::AsyncDataProvider<double, CatchmentAggrDataSelector,
+                                                                  data_access::GenericDataProvider>;
+      std::vector<AsyncForcingProvider*> catchment_async_forcing(catchment_ids.size(), nullptr);
+      bool is_forcing_async = false;
+      for(std::size_t i = 0; i < catchment_ids.size(); ++i) {
+        if(catchment_formulations[i]) {
+          catchment_async_forcing[i] = dynamic_cast<AsyncForcingProvider*>(catchment_formulations[i]->get_forcing_provider().get());
+          is_forcing_async = is_forcing_async || catchment_async_forcing[i] != nullptr;
+        }
+      }
+      if(is_forcing_async) {
+        scheduler.set_readiness_check([&](const network::WavefrontScheduler::Task& task) {
+          AsyncForcingProvider* provider = task.kind == network::WavefrontScheduler::CATCHMENT
+                                           ? catchment_async_forcing[task.index] : nullptr;
+          const int step_multiple = provider ? catchment_step_multiples[task.index] : 1;
+          if(provider == nullptr || task.time_step % step_multiple != 0) {
+            return true;
+          }
+          bool is_ready = true;
+          for(const std::string& variable : provider->get_avaliable_variable_names()) {
+            CatchmentAggrDataSelector selector(catchment_ids[task.index], variable,
+                                               manager->Simulation_Time_Object->get_start_time()
+                                                   + static_cast<time_t>(task.time_step) * output_interval_seconds,
+                                               output_interval_seconds * step_multiple, "");
+            if(!provider->value_ready(selector)) {
+              provider->request_value(selector);
+              is_ready = false;
+            }
+          }
+          return is_ready;
+        });
+      }
+
+      auto worker = [&](std::size_t) {
+        network::WavefrontScheduler::Task task;
+        while(scheduler.acquire(task)) {
+          int output_time_index = task.time_step;
+          try {
+            if(task.kind == network::WavefrontScheduler::CATCHMENT) {
+              wavefront_flows[task.index * window + output_time_index % window] =
+                  run_catchment(task.index, output_time_index);
+              //Reported as the first catchment completes each time step, which none of the others are far from
+              if(task.index == 0 && progress.is_report_due(output_time_index)) {
+                progress.lap(utils::RunProgress::COMPUTE);
+                report_progress(output_time_index + 1);
+              }
+              //Likewise for status reports, which only the thread of the first catchment writes
+              if(task.index == 0 && utils::StatusDump::take_request()) {
+                write_status(output_time_index + 1);
+              }
+            }
+            else {
+              const NexusOutput& output = wavefront_nexuses[task.index];
+              //Contribute in a fixed catchment order, so the summed nexus flows are reproducible
+              for(std::size_t c : scheduler.nexus_contributors(task.index)) {
+                output.nexus->add_upstream_flow(wavefront_flows[c * window + output_time_index % window],
+                                                catchment_ids[c], output_time_index);
+              }
+              write_nexus(output, output_time_index, timestamps[output_time_index]);
+            }
+          }
+          catch(...) {
+            scheduler.abort();
+            throw;
+          }
+          scheduler.complete(task);
+        }
+      };
+      catchment_pool.parallel_for(catchment_pool.size(), worker);
+    }
+    #endif
+
+    //Warm-started cycles: the hydrofabric, formulations and model states stay resident, and each cycle runs the
+    //time steps up to its new end time, continuing from where the last cycle ended
+    if(is_cycle_mode_wanted && rebalance_time_index < 0) {
+      std::vector<std::shared_ptr<data_access::GenericDataProvider>> forcing_providers;
+      std::unordered_set<data_access::GenericDataProvider*> seen_providers;
+      for(const auto& r : catchment_realizations) {
+        const auto& provider = r->get_forcing_provider();
+        if(provider && seen_providers.insert(provider.get()).second) {
+          forcing_providers.push_back(provider);
+        }
+      }
+      time_t cycle_end;
+      while(read_next_cycle_end(cycle_end)) {
+        //Outputs of the last cycle are complete before its end is reported
+        if(catchment_output) {
+          catchment_output->flush();
+        }
+        if(catchment_writer) {
+          catchment_writer->flush();
+        }
+        nexus_writer->flush();
+        if(routed_nexus_writer) {
+          routed_nexus_writer->flush();
+        }
+        if(checkpoint_interval > 0) {
+          write_checkpoint(total_output_times);
+        }
+        int first_cycle_time_index = total_output_times;
+        total_output_times = manager->Simulation_Time_Object->extend_end_time(cycle_end);
+        for(int output_time_index = first_cycle_time_index; output_time_index < total_output_times; output_time_index++) {
+          timestamps.push_back(timestamp_generator.str());
+          timestamp_generator.advance();
+        }
+        for(const auto& provider : forcing_providers) {
+          provider->extend_to(cycle_end);
+        }
+        std::cout<<"Running cycle to timestep "<<total_output_times - 1<<std::endl;
+        run_time_steps(first_cycle_time_index, total_output_times);
+        if(rebalance_time_index >= 0) {
+          break;
+        }
+      }
+    }
+
+    //A failure to write the last checkpoint fails the run
+    checkpoint_writer.wait();
+
+    //The last progress report, of the end of the run
+    if(progress.get_interval() > 0) {
+      int completed_steps = rebalance_time_index >= 0 ? rebalance_time_index : total_output_times;
+      if(completed_steps % progress.get_interval() != 0) {
+        report_progress(completed_steps);
+      }
+      #ifdef NGEN_MPI_ACTIVE
+      complete_progress_gather();
+      #endif
+    }
+
+    #if defined(ACTIVATE_PYTHON) && defined(NGEN_ROUTING_ACTIVE)
+    //Pipelined routing takes the GIL until its last chunk is routed
+    if(!routing_pipeline) {
+      python_gil_release.reset();
+    }
+    #elif defined(ACTIVATE_PYTHON)
+    python_gil_release.reset();
+    #endif // ACTIVATE_PYTHON
+    //Make sure all output is written before anything (e.g., routing) reads it
+    if(catchment_output) {
+      catchment_output->flush();
+      catchment_output.reset();
+    }
+    if(catchment_aggregator) {
+      //Write the periods the run ended part way through
+      for(std::size_t i = 0; i < catchment_ids.size(); ++i) {
+        CatchmentOutputRecord record;
+        record.formulation = dynamic_pointer_cast<realization::Catchment_Formulation>(catchment_realizations[i]).get();
+        record.catchment_id = &catchment_ids[i];
+        record.is_numeric = true;
+        record.format = record.formulation->get_output_format();
+        long period_time_index;
+        if(catchment_aggregator->flush(catchment_ids[i], period_time_index, record.values)) {
+          record.output_time_index = period_time_index;
+          write_catchment_row(record);
+        }
+      }
+    }
+    if(catchment_writer) {
+      catchment_writer->flush();
+    }
+    //Closed together by every rank, as the parallel NetCDF output is finished collectively
+    nexus_writer->close();
+    if(routed_nexus_writer) {
+      routed_nexus_writer->close();
+    }
+    #ifdef NGEN_MPI_ACTIVE
+    //Complete every remote nexus's communications together now, rather than one by one as the features are destroyed
+    if(!features.drain_remote_communications()) {
+      std::cerr << "Rank " << mpi_rank << " could not complete its remote nexus communications; aborting." << std::endl;
+      MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    #endif //NGEN_MPI_ACTIVE
+    #ifdef NGEN_ROUTING_ACTIVE
+    //Hand over whatever flows routing has not yet received, before MPI finishes
+    if(routing_history != nullptr && rebalance_time_index < 0) {
+      std::size_t unrouted_steps = timestamps.size() - first_unrouted_time_index;
+      hand_flows_to_routing(output_nexus_ids, routing_history->get_flows() + first_unrouted_time_index,
+                            routing_history->get_row_stride(),
+                            std::min(routing_history->get_completed_steps() - first_unrouted_time_index, unrouted_steps),
+                            std::vector<std::string>(timestamps.begin() + first_unrouted_time_index, timestamps.end()),
+                            router.get(), routing_pipeline.get());
+    }
+    if(routing_flows != nullptr) {
+      #ifdef NGEN_MPI_ACTIVE
+      hand_flows_to_routing(*routing_flows, std::vector<std::string>(timestamps.begin() + first_unrouted_time_index,
+                            timestamps.end()), router.get(), routing_pipeline.get());
+      #else
+      hand_flows_to_routing(*routing_flows, routing_flows->get_timestamps(), router.get(), routing_pipeline.get());
+      #endif
+    }
+    if(routing_pipeline) {
+      routing_pipeline->finish();
+      std::cout<<"Finished routing "<<routing_pipeline->get_routed_steps()<<" timesteps"<<std::endl;
+      routing_pipeline.reset();
+      #ifdef ACTIVATE_PYTHON
+      python_gil_release.reset();
+      #endif // ACTIVATE_PYTHON
+    }
+    #endif
+    if(rebalance_time_index >= 0) {
+      std::cout<<"Ended at the checkpoint before timestep "<<rebalance_time_index<<" to rebalance; repartition with "
+               <<"partitionGenerator, using "<<rebalance_costs_path<<" as the catchment weights, and restart with "
+               <<RESTART_CLI_OPTION<<" "<<manager->get_execution_params().checkpoint_path<<std::endl;
+    }
+    else {
+      std::cout<<"Finished "<<manager->Simulation_Time_Object->get_total_output_times()<<" timesteps."<<std::endl;
+    }
+    //Only the responses of a whole run are cached, so a run ended early to rebalance caches none
+    if(response_cache && rebalance_time_index < 0) {
+      for(std::size_t i = 0; i < catchment_ids.size(); ++i) {
+        const auto& entry = catchment_response_entries[i];
+        if(entry && entry->is_valid && entry->size() == static_cast<std::size_t>(total_output_times)) {
+          response_cache->store(catchment_ids[i], *entry);
+        }
+      }
+    }
+    if(!CATCHMENT_COSTS_PATH.empty()) {
+      write_catchment_costs(CATCHMENT_COSTS_PATH, catchment_ids, catchment_cost_seconds, catchment_cost_steps);
+    }
+    if(utils::Profiler::is_enabled()) {
+      write_profile(manager->get_output_params());
+    }
+    write_memory_report("the end of the run", collect_memory_report());
+    //Write what was logged by the run, with how many repeated messages were left out, before routing starts
+    utils::Logger::flush();
 
 
   #ifdef NGEN_ROUTING_ACTIVE
@@ -362,7 +2842,8 @@ int main(int argc, char *argv[]) {
     if( mpi_rank == 0 )
     { // Run t-route from single process
   #endif //NGEN_MPI_ACTIVE
-        if(manager->get_using_routing()) {
+        //A run ended early to rebalance is routed once its restart has finished, and a pipelined run is already routed
+        if(manager->get_using_routing() && rebalance_time_index < 0 && !is_routing_pipelined) {
           //Note: Currently, delta_time is set in the t-route yaml configuration file, and the
           //number_of_timesteps is determined from the total number of nexus outputs in t-route.
           //It is recommended to still pass these values to the routing_py_adapter object in
@@ -0,0 +1,199 @@
+#include "ChannelRouting.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+using namespace network;
+
+namespace {
+    /** The number of reaches of a level routed by each task, when a level is spread over a pool. */
+    const std::size_t REACH_BLOCK_SIZE = 256;
+}
+
+ChannelRouting::ChannelRouting(Network& network, const params_source_t& params_of, int substeps)
+    : substeps(substeps)
+{
+    if (substeps < 1) {
+        throw std::invalid_argument("ChannelRouting: there must be at least one routing substep per time step.");
+    }
+
+    const std::vector<std::string>& catchments = network.filter("cat");
+    std::unordered_map<std::string, std::size_t> catchment_index;
+    for (std::size_t c = 0; c < catchments.size(); ++c) {
+        catchment_index.emplace(catchments[c], c);
+    }
+    nexus_id_list = network.filter("nex");
+    std::vector<std::vector<std::size_t>> nexus_contributors(nexus_id_list.size());
+    for (std::size_t n = 0; n < nexus_id_list.size(); ++n) {
+        nexus_lookup.emplace(nexus_id_list[n], n);
+        for (const auto& id : network.get_origination_ids(nexus_id_list[n])) {
+            auto it = catchment_index.find(id);
+            if (it != catchment_index.end()) {
+                nexus_contributors[n].push_back(it->second);
+            }
+        }
+    }
+
+    // Catchment -> upstream catchments, through its origination nexuses
+    std::vector<std::vector<std::size_t>> upstream(catchments.size());
+    std::vector<std::vector<std::size_t>> downstream(catchments.size());
+    for (std::size_t c = 0; c < catchments.size(); ++c) {
+        for (const auto& id : network.get_origination_ids(catchments[c])) {
+            auto it = nexus_lookup.find(id);
+            if (it != nexus_lookup.end()) {
+                for (std::size_t u : nexus_contributors[it->second]) {
+                    upstream[c].push_back(u);
+                    downstream[u].push_back(c);
+                }
+            }
+        }
+    }
+
+    // Levels, from headwaters down, by repeatedly taking the catchments with no unleveled upstream catchments
+    std::vector<std::size_t> level(catchments.size(), 0);
+    std::vector<std::size_t> remaining(catchments.size());
+    std::vector<std::size_t> ready;
+    for (std::size_t c = 0; c < catchments.size(); ++c) {
+        remaining[c] = upstream[c].size();
+        if (remaining[c] == 0) {
+            ready.push_back(c);
+        }
+    }
+    std::size_t leveled = 0;
+    while (leveled < ready.size()) {
+        std::size_t c = ready[leveled++];
+        for (std::size_t d : downstream[c]) {
+            level[d] = std::max(level[d], level[c] + 1);
+            if (--remaining[d] == 0) {
+                ready.push_back(d);
+            }
+        }
+    }
+    if (ready.size() != catchments.size()) {
+        throw std::invalid_argument("ChannelRouting: the catchments of the network do not form a tree.");
+    }
+
+    // Routing order: by level, then in the network's topological order
+    std::vector<std::size_t> order(catchments.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&level](std::size_t a, std::size_t b) { return level[a] < level[b]; });
+    std::vector<std::size_t> reach_of(catchments.size());
+    for (std::size_t r = 0; r < order.size(); ++r) {
+        reach_of[order[r]] = r;
+        reach_ids.push_back(catchments[order[r]]);
+        reach_lookup.emplace(catchments[order[r]], r);
+        params.push_back(params_of(catchments[order[r]]));
+        if (r == 0 || level[order[r]] != level[order[r - 1]]) {
+            level_offsets.push_back(r);
+        }
+    }
+    level_offsets.push_back(order.size());
+
+    upstream_offsets.push_back(0);
+    for (std::size_t r = 0; r < order.size(); ++r) {
+        for (std::size_t u : upstream[order[r]]) {
+            upstream_reaches.push_back(reach_of[u]);
+        }
+        upstream_offsets.push_back(upstream_reaches.size());
+    }
+    nexus_offsets.push_back(0);
+    for (const auto& contributors : nexus_contributors) {
+        for (std::size_t c : contributors) {
+            nexus_reaches.push_back(reach_of[c]);
+        }
+        nexus_offsets.push_back(nexus_reaches.size());
+    }
+
+    inflows.assign(order.size(), 0.0);
+    outflows.assign(order.size(), 0.0);
+    storages.assign(order.size(), 0.0);
+}
+
+std::size_t ChannelRouting::reach_index(const std::string& catchment_id) const
+{
+    auto it = reach_lookup.find(catchment_id);
+    if (it == reach_lookup.end()) {
+        throw std::invalid_argument("ChannelRouting: no reach is routed for catchment " + catchment_id);
+    }
+    return it->second;
+}
+
+std::size_t ChannelRouting::nexus_index(const std::string& nexus_id) const
+{
+    auto it = nexus_lookup.find(nexus_id);
+    if (it == nexus_lookup.end()) {
+        throw std::invalid_argument("ChannelRouting: no routed flow is kept for nexus " + nexus_id);
+    }
+    return it->second;
+}
+
+void ChannelRouting::route(const std::vector<double>& lateral_inflows, double dt_seconds, utils::ThreadPool* pool)
+{
+    if (lateral_inflows.size() != reach_ids.size()) {
+        throw std::invalid_argument("ChannelRouting: expected " + std::to_string(reach_ids.size())
+                                    + " lateral inflows, but was given " + std::to_string(lateral_inflows.size()));
+    }
+    double dt_substep = dt_seconds / substeps;
+    for (int s = 0; s < substeps; ++s) {
+        for (std::size_t l = 0; l + 1 < level_offsets.size(); ++l) {
+            std::size_t begin = level_offsets[l];
+            std::size_t end = level_offsets[l + 1];
+            if (pool == nullptr || pool->size() < 2 || end - begin < 2 * REACH_BLOCK_SIZE) {
+                route_reaches(begin, end, lateral_inflows, dt_substep);
+                continue;
+            }
+            std::size_t blocks = (end - begin + REACH_BLOCK_SIZE - 1) / REACH_BLOCK_SIZE;
+            pool->parallel_for(blocks, [&](std::size_t b) {
+                std::size_t block_begin = begin + b * REACH_BLOCK_SIZE;
+                route_reaches(block_begin, std::min(block_begin + REACH_BLOCK_SIZE, end), lateral_inflows, dt_substep);
+            });
+        }
+    }
+}
+
+void ChannelRouting::route_reaches(std::size_t begin, std::size_t end, const std::vector<double>& lateral_inflows,
+                                   double dt_seconds)
+{
+    // Upstream reaches are all of earlier levels, so have already been routed this step
+    for (std::size_t r = begin; r < end; ++r) {
+        double inflow = 0.0;
+        for (std::size_t u = upstream_offsets[r]; u < upstream_offsets[r + 1]; ++u) {
+            inflow += outflows[upstream_reaches[u]];
+        }
+        outflows[r] = muskingum_cunge::route(params[r], dt_seconds, inflows[r], inflow, outflows[r],
+                                             lateral_inflows[r], storages[r]);
+        inflows[r] = inflow;
+    }
+}
+
+double ChannelRouting::nexus_flow(std::size_t nexus) const
+{
+    double flow = 0.0;
+    for (std::size_t i = nexus_offsets[nexus]; i < nexus_offsets[nexus + 1]; ++i) {
+        flow += outflows[nexus_reaches[i]];
+    }
+    return flow;
+}
+
+void ChannelRouting::save_state(utils::StateWriter& out) const
+{
+    out.write(inflows);
+    out.write(outflows);
+    out.write(storages);
+}
+
+void ChannelRouting::load_state(utils::StateReader& in)
+{
+    std::vector<double> saved_inflows = in.read_vector<double>();
+    std::vector<double> saved_outflows = in.read_vector<double>();
+    std::vector<double> saved_storages = in.read_vector<double>();
+    if (saved_inflows.size() != reach_ids.size() || saved_outflows.size() != reach_ids.size()
+        || saved_storages.size() != reach_ids.size()) {
+        throw std::runtime_error("ChannelRouting: saved state is of " + std::to_string(saved_outflows.size())
+                                 + " reaches, but " + std::to_string(reach_ids.size()) + " are routed.");
+    }
+    inflows.swap(saved_inflows);
+    outflows.swap(saved_outflows);
+    storages.swap(saved_storages);
+}
@@ -1,5 +1,10 @@
 #include <HY_Features.hpp>
+#include <algorithm>
+#include <HY_DendriticNexus.hpp>
 #include <HY_PointHydroNexus.hpp>
+#include <CatchmentOutputAggregator.hpp>
+#include <IdSelector.hpp>
+#include <ThreadPool.hpp>
 
 using namespace hy_features;
 
@@ -15,44 +20,112 @@ HY_Features::HY_Features( geojson::GeoJSON fabric, std::shared_ptr<Formulation_M
 HY_Features::HY_Features(network::Network network, std::shared_ptr<Formulation_Manager> formulations)
   :network(network), formulations(formulations)
 {
-      std::string feat_id;
-      std::string feat_type;
-      std::vector<std::string> origins, destinations;
-
-      for(const auto& feat_idx : network){
-        feat_id = network.get_id(feat_idx);//feature->get_id();
-        feat_type = feat_id.substr(0, 3);
-
-        destinations  = network.get_destination_ids(feat_id);
-        if(feat_type == "cat")
-        {
-          //Find and prepare formulation
-          auto formulation = formulations->get_formulation(feat_id);
-          formulation->set_output_stream(feat_id+".csv");
-          // TODO: add command line or config option to have this be omitted
-          //FIXME why isn't default param working here??? get_output_header_line() fails.
-          formulation->write_output("Time Step,""Time,"+formulation->get_output_header_line(",")+"\n");
-          //Find upstream nexus ids
-          origins = network.get_origination_ids(feat_id);
-          //Create the HY_Catchment with the formulation realization
-          std::shared_ptr<HY_Catchment> c = std::make_shared<HY_Catchment>(
-              HY_Catchment(feat_id, origins, destinations, formulation)
-            );
-
-          _catchments.emplace(feat_id, c);
+      const std::size_t feature_count = network.size();
+      _catchments.resize(feature_count);
+      _formulations.resize(feature_count, nullptr);
+      _nexuses.resize(feature_count);
+      _destinations.resize(feature_count);
+
+      //Catchments whose output isn't selected get no csv file
+      utils::IdSelector catchment_output_selector(formulations->get_output_params().catchment_selection);
+      const bool is_csv_output = formulations->get_output_params().catchment_format == "csv";
+      const utils::Compression csv_compression = utils::parse_compression(formulations->get_output_params().csv_compression);
+      //Uncompressed csv files share the configured buffer between the catchments
+      std::size_t catchment_count = 0;
+      for(std::size_t feat_idx = 0; feat_idx < feature_count; ++feat_idx) {
+        if(network.get_id(feat_idx).compare(0, 3, "cat") == 0) {
+          ++catchment_count;
         }
-        else if(feat_type == "nex" || feat_type == "tnx")
-        {
-            _nexuses.emplace(feat_id, std::make_unique<HY_PointHydroNexus>(
-                                          HY_PointHydroNexus(feat_id, destinations) ));
+      }
+      const std::size_t csv_buffer_bytes = utils::file_buffer_share(
+          static_cast<std::size_t>(formulations->get_output_params().csv_buffer_mb) * 1024 * 1024, catchment_count);
+
+      //Each feature only sets the entries of its own handle, so the features are constructed concurrently, a block of
+      //handles at a time; the warnings and topology errors found are kept by handle, to be reported in order
+      std::vector<std::string> feature_warnings(feature_count);
+      std::vector<std::string> topology_errors(feature_count);
+      utils::ThreadPool construction_pool(formulations->get_execution_params().init_threads);
+      #ifdef ACTIVATE_PYTHON
+      //Python formulations take the GIL for their output headers, so this thread must not hold it meanwhile
+      std::unique_ptr<pybind11::gil_scoped_release> python_gil_release;
+      if (construction_pool.size() > 1 && Py_IsInitialized() && PyGILState_Check()) {
+          python_gil_release = std::unique_ptr<pybind11::gil_scoped_release>(new pybind11::gil_scoped_release());
+      }
+      #endif // ACTIVATE_PYTHON
+      const std::size_t blocks = (feature_count + CONSTRUCTION_BLOCK_SIZE - 1) / CONSTRUCTION_BLOCK_SIZE;
+
+      construction_pool.parallel_for(blocks, [&](std::size_t b) {
+        const std::size_t block_end = std::min((b + 1) * CONSTRUCTION_BLOCK_SIZE, feature_count);
+        for(std::size_t feat_idx = b * CONSTRUCTION_BLOCK_SIZE; feat_idx < block_end; ++feat_idx){
+          std::string feat_id = network.get_id(feat_idx);//feature->get_id();
+          std::string feat_type = feat_id.substr(0, 3);
+
+          std::vector<std::string> destinations = network.get_destination_ids(feat_id);
+          if(feat_type == "cat")
+          {
+            topology_errors[feat_idx] = dendritic_error(feat_id, destinations);
+            //Find and prepare formulation
+            auto formulation = formulations->get_formulation(feat_id);
+            //Other catchment output formats write every catchment to one file, rather than one for each
+            if(is_csv_output && catchment_output_selector.matches(feat_id)) {
+              formulation->set_output_stream(feat_id+".csv", csv_compression,
+                                             formulations->get_output_params().csv_compression_level, csv_buffer_bytes);
+              // TODO: add command line or config option to have this be omitted
+              //FIXME why isn't default param working here??? get_output_header_line() fails.
+              formulation->write_output("Time Step,""Time,"+catchment_output::CatchmentOutputAggregator::select_header(
+                  formulations->get_output_params().catchment_variables, formulation->get_output_header_line(","))+"\n");
+            }
+            //Find upstream nexus ids
+            std::vector<std::string> origins = network.get_origination_ids(feat_id);
+            //Create the HY_Catchment with the formulation realization
+            std::shared_ptr<HY_Catchment> c = std::make_shared<HY_Catchment>(
+                HY_Catchment(feat_id, origins, destinations, formulation)
+              );
+
+            _catchments[feat_idx] = c;
+            _formulations[feat_idx] = formulation.get();
+          }
+          else if(feat_type == "nex" || feat_type == "tnx")
+          {
+              //Nexuses with at most one receiver don't need to record who contributed or requested their flows
+              if(destinations.size() <= 1 && !formulations->get_execution_params().exact_flow_sums) {
+                _nexuses[feat_idx] = std::make_shared<HY_DendriticNexus>(feat_id, destinations);
+              }
+              else {
+                auto nexus = std::make_shared<HY_PointHydroNexus>(feat_id, destinations);
+                nexus->set_exact_summation(formulations->get_execution_params().exact_flow_sums);
+                _nexuses[feat_idx] = nexus;
+              }
+          }
+          else
+          {
+            feature_warnings[feat_idx] = "HY_Features::HY_Features unknown feature identifier type "+feat_type
+                                         +" for feature id."+feat_id+" Skipping feature";
+          }
+        }
+      });
+
+      for(std::size_t feat_idx = 0; feat_idx < feature_count; ++feat_idx){
+        if( !feature_warnings[feat_idx].empty() ) {
+          std::cerr<<feature_warnings[feat_idx]<<std::endl;
         }
-        else
-        {
-          std::cerr<<"HY_Features::HY_Features unknown feature identifier type "<<feat_type<<" for feature id."<<feat_id
-                   <<" Skipping feature"<<std::endl;
+        if( !topology_errors[feat_idx].empty() ) {
+          dendritic_errors.push_back(std::move(topology_errors[feat_idx]));
         }
       }
 
+      //Resolve each catchment's downstream nexuses once, now that every nexus exists
+      construction_pool.parallel_for(blocks, [&](std::size_t b) {
+        const std::size_t block_end = std::min((b + 1) * CONSTRUCTION_BLOCK_SIZE, feature_count);
+        for(std::size_t feat_idx = b * CONSTRUCTION_BLOCK_SIZE; feat_idx < block_end; ++feat_idx){
+          if( _catchments[feat_idx] ) {
+            for(const auto& nex_idx : network.get_destination_handles(feat_idx)) {
+              _destinations[feat_idx].push_back(_nexuses[nex_idx]);
+            }
+          }
+        }
+      });
+
 }
 
 HY_Features::HY_Features( geojson::GeoJSON catchments, std::string* link_key, std::shared_ptr<Formulation_Manager> formulations):
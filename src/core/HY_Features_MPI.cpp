@@ -1,5 +1,9 @@
 #include <HY_Features_MPI.hpp>
 #include <HY_PointHydroNexusRemote.hpp>
+#include <CatchmentOutputAggregator.hpp>
+#include <IdSelector.hpp>
+#include <ThreadPool.hpp>
+#include <algorithm>
 
 #ifdef NGEN_MPI_ACTIVE
 
@@ -8,52 +12,109 @@ using namespace hy_features;
 HY_Features_MPI::HY_Features_MPI( PartitionData partition_data, geojson::GeoJSON linked_hydro_fabric, std::shared_ptr<Formulation_Manager> formulations, int mpi_rank, int mpi_num_procs) :
       network(linked_hydro_fabric), formulations(formulations), mpi_rank(mpi_rank), mpi_num_procs(mpi_num_procs)
 { 
-      std::string feat_id;
-      std::string feat_type;
-      std::vector<std::string> origins, destinations;
-      
-      std::unordered_map<std::string, HY_PointHydroNexusRemote::catcment_location_map_t> remote_connections;
+      std::vector<std::pair<std::string, long>> remote_locations;
       using DirectionMap = std::unordered_map<std::string, std::map<std::string, std::string> >;
       DirectionMap remote_connection_direction;
 
-      // loop through the partiton data remote arrays and make a map of catchment location maps
+      // loop through the partiton data remote arrays and index the rank of every remote catchment once, for all the
+      // remote nexuses to share
+      remote_locations.reserve(partition_data.remote_connections.size());
       for( int i = 0; i < partition_data.remote_connections.size(); ++i )
       {
-        std::tuple<int, std::string, std::string, std::string> remote_tuple = (partition_data.remote_connections)[i];
+        const std::tuple<int, std::string, std::string, std::string>& remote_tuple = (partition_data.remote_connections)[i];
         int remote_mpi_ranks = std::get<0>(remote_tuple);
-        std::string remote_nexi = std::get<1>(remote_tuple);
-        std::string remote_catchments = std::get<2>(remote_tuple);
-        remote_connections[remote_nexi][remote_catchments] = remote_mpi_ranks;
+        const std::string& remote_nexi = std::get<1>(remote_tuple);
+        const std::string& remote_catchments = std::get<2>(remote_tuple);
+        remote_locations.emplace_back(remote_catchments, remote_mpi_ranks);
         remote_connection_direction[remote_nexi][remote_catchments] = std::get<3>(remote_tuple);
       }
+      const HY_PointHydroNexusRemote::location_index_t remote_location_index = RemoteLocationIndex::make(remote_locations);
 
-      for(const auto& feat_idx : network){
-        feat_id = network.get_id(feat_idx);//feature->get_id();
-        feat_type = feat_id.substr(0, 3);
+      const std::size_t feature_count = network.size();
+      _catchments.resize(feature_count);
+      _formulations.resize(feature_count, nullptr);
+      _nexuses.resize(feature_count);
+      _destinations.resize(feature_count);
 
-        destinations  = network.get_destination_ids(feat_id);
-        //Find upstream ids
-        origins = network.get_origination_ids(feat_id);
-        if(feat_type == "cat")
-        {
+      //Catchments whose output isn't selected get no csv file
+      utils::IdSelector catchment_output_selector(formulations->get_output_params().catchment_selection);
+      const bool is_csv_output = formulations->get_output_params().catchment_format == "csv";
+      const utils::Compression csv_compression = utils::parse_compression(formulations->get_output_params().csv_compression);
+      //Uncompressed csv files share the configured buffer between the catchments
+      std::size_t catchment_count = 0;
+      for(std::size_t feat_idx = 0; feat_idx < feature_count; ++feat_idx) {
+        if(network.get_id(feat_idx).compare(0, 3, "cat") == 0) {
+          ++catchment_count;
+        }
+      }
+      const std::size_t csv_buffer_bytes = utils::file_buffer_share(
+          static_cast<std::size_t>(formulations->get_output_params().csv_buffer_mb) * 1024 * 1024, catchment_count);
+
+      //Each catchment only sets the entries of its own handle, so the catchments are constructed concurrently, a block
+      //of handles at a time, with the topology errors found kept by handle to be reported in order.  The remote
+      //nexuses communicate as they are constructed, and MPI is only used from this thread, so they are then
+      //constructed here
+      std::vector<std::string> topology_errors(feature_count);
+      utils::ThreadPool construction_pool(formulations->get_execution_params().init_threads);
+      #ifdef ACTIVATE_PYTHON
+      //Python formulations take the GIL for their output headers, so this thread must not hold it meanwhile
+      std::unique_ptr<pybind11::gil_scoped_release> python_gil_release;
+      if (construction_pool.size() > 1 && Py_IsInitialized() && PyGILState_Check()) {
+          python_gil_release = std::unique_ptr<pybind11::gil_scoped_release>(new pybind11::gil_scoped_release());
+      }
+      #endif // ACTIVATE_PYTHON
+      const std::size_t blocks = (feature_count + CONSTRUCTION_BLOCK_SIZE - 1) / CONSTRUCTION_BLOCK_SIZE;
+
+      construction_pool.parallel_for(blocks, [&](std::size_t b) {
+        const std::size_t block_end = std::min((b + 1) * CONSTRUCTION_BLOCK_SIZE, feature_count);
+        for(std::size_t feat_idx = b * CONSTRUCTION_BLOCK_SIZE; feat_idx < block_end; ++feat_idx){
+          std::string feat_id = network.get_id(feat_idx);//feature->get_id();
+          if(feat_id.compare(0, 3, "cat") != 0)
+          {
+            continue;
+          }
+          std::vector<std::string> destinations = network.get_destination_ids(feat_id);
+          //Find upstream ids
+          std::vector<std::string> origins = network.get_origination_ids(feat_id);
+          topology_errors[feat_idx] = dendritic_error(feat_id, destinations);
           //Find and prepare formulation
           auto formulation = formulations->get_formulation(feat_id);
-          formulation->set_output_stream(feat_id+".csv");
-          // TODO: add command line or config option to have this be omitted
-          //FIXME why isn't default param working here??? get_output_header_line() fails.
-          formulation->write_output("Time Step,""Time,"+formulation->get_output_header_line(",")+"\n");
+          //Other catchment output formats write every catchment to one file, rather than one for each
+          if(is_csv_output && catchment_output_selector.matches(feat_id)) {
+            formulation->set_output_stream(feat_id+".csv", csv_compression,
+                                           formulations->get_output_params().csv_compression_level, csv_buffer_bytes);
+            // TODO: add command line or config option to have this be omitted
+            //FIXME why isn't default param working here??? get_output_header_line() fails.
+            formulation->write_output("Time Step,""Time,"+catchment_output::CatchmentOutputAggregator::select_header(
+                formulations->get_output_params().catchment_variables, formulation->get_output_header_line(","))+"\n");
+          }
           //Create the HY_Catchment with the formulation realization
           std::shared_ptr<HY_Catchment> c = std::make_shared<HY_Catchment>(
               HY_Catchment(feat_id, origins, destinations, formulation)
             );
 
-          _catchments.emplace(feat_id, c);
+          _catchments[feat_idx] = c;
+          _formulations[feat_idx] = formulation.get();
+        }
+      });
+
+      for(std::size_t feat_idx = 0; feat_idx < feature_count; ++feat_idx){
+        if( !topology_errors[feat_idx].empty() ) {
+          dendritic_errors.push_back(std::move(topology_errors[feat_idx]));
+        }
+        std::string feat_id = network.get_id(feat_idx);//feature->get_id();
+        std::string feat_type = feat_id.substr(0, 3);
+        if(feat_type == "cat")
+        {
+          continue;
         }
         else if(feat_type == "nex" || feat_type == "tnx")
         {   //origins only contains LOCAL origin features (catchments) as read from
             //the geojson/partition subset.  We need to make sure `origins` passed to remote nexus
             //contain IDS of ALL upstream features, including those in remote partitions
             //The same applies to destinations as well.
+            std::vector<std::string> destinations = network.get_destination_ids(feat_id);
+            std::vector<std::string> origins = network.get_origination_ids(feat_id);
             //Find all remote catchments related to this feature
             for(auto& catchment_direction : remote_connection_direction[feat_id])
             { //Determine how it is related to the nexus.  This helps determine which side is a "sender"
@@ -65,13 +126,38 @@ HY_Features_MPI::HY_Features_MPI( PartitionData partition_data, geojson::GeoJSON
                 origins.push_back(catchment_direction.first);
               }
             }
-            _nexuses.emplace(feat_id, std::make_unique<HY_PointHydroNexusRemote>(feat_id, destinations, origins, remote_connections[feat_id]) );
+            _nexuses[feat_idx] = std::make_shared<HY_PointHydroNexusRemote>(feat_id, destinations, origins, remote_location_index);
+            _nexuses[feat_idx]->set_exact_summation(formulations->get_execution_params().exact_flow_sums);
         }
         else
         {
           std::cerr<<"HY_Features::HY_Features unknown feature identifier type "<<feat_type<<" for feature id."<<feat_id
                    <<" Skipping feature"<<std::endl;
         }
-      }	
+      }
+
+      //Resolve each catchment's downstream nexuses once, now that every nexus exists
+      construction_pool.parallel_for(blocks, [&](std::size_t b) {
+        const std::size_t block_end = std::min((b + 1) * CONSTRUCTION_BLOCK_SIZE, feature_count);
+        for(std::size_t feat_idx = b * CONSTRUCTION_BLOCK_SIZE; feat_idx < block_end; ++feat_idx){
+          if( _catchments[feat_idx] ) {
+            for(const auto& nex_idx : network.get_destination_handles(feat_idx)) {
+              _destinations[feat_idx].push_back(_nexuses[nex_idx]);
+            }
+          }
+        }
+      });
+
+      //Batch the communication of every remote nexus into one exchange per time step
+      std::vector<std::shared_ptr<HY_PointHydroNexusRemote>> remote_nexuses;
+      for(const auto& nexus : _nexuses){
+        if( nexus ) {
+          remote_nexuses.push_back(nexus);
+        }
+      }
+      RemoteNexusExchange::Transport transport = formulations->get_execution_params().remote_transport == "one_sided"
+          ? RemoteNexusExchange::Transport::one_sided : RemoteNexusExchange::Transport::neighbor_collective;
+      remote_exchange = std::unique_ptr<RemoteNexusExchange>(new RemoteNexusExchange(remote_nexuses, MPI_COMM_WORLD, transport,
+                                                                                     formulations->get_execution_params().remote_chunk_steps));
 }
 #endif //NGEN_MPI_ACTIVE
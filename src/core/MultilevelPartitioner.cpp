@@ -0,0 +1,844 @@
+#include "MultilevelPartitioner.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <fstream>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+#ifdef NGEN_METIS_ACTIVE
+#include <metis.h>
+#endif
+
+using namespace network;
+
+namespace {
+
+    using Graph = MultilevelPartitioner::Graph;
+
+    const std::size_t NONE = std::numeric_limits<std::size_t>::max();
+    // Coarsening stops once the graph has no more than this many vertices per partition
+    const std::size_t COARSEST_VERTICES_PER_PARTITION = 20;
+    const std::size_t COARSEST_VERTICES_MIN = 100;
+    // ...or once a round of matching no longer shrinks it by at least 5%
+    const double MIN_COARSENING_RATIO = 0.95;
+    const int REFINEMENT_PASSES = 8;
+    // Fixed seed, so the same inputs always produce the same partitioning
+    const unsigned int SEED = 5489u;
+
+    /**
+     * Build a graph from an undirected edge list, summing the weights of duplicate edges.
+     */
+    Graph make_graph(std::vector<double> vwgt, std::vector<std::pair<std::size_t, std::size_t>>& edges)
+    {
+        std::vector<std::pair<std::size_t, std::size_t>> arcs;
+        arcs.reserve(edges.size() * 2);
+        for (const auto& e : edges) {
+            if (e.first != e.second) {
+                arcs.emplace_back(e.first, e.second);
+                arcs.emplace_back(e.second, e.first);
+            }
+        }
+        std::sort(arcs.begin(), arcs.end());
+
+        Graph g;
+        g.vwgt = std::move(vwgt);
+        g.xadj.assign(g.vwgt.size() + 1, 0);
+        for (std::size_t i = 0; i < arcs.size(); ++i) {
+            if (i > 0 && arcs[i] == arcs[i - 1]) {
+                g.adjwgt.back() += 1.0;
+                continue;
+            }
+            g.adjncy.push_back(arcs[i].second);
+            g.adjwgt.push_back(1.0);
+            ++g.xadj[arcs[i].first + 1];
+        }
+        std::partial_sum(g.xadj.begin(), g.xadj.end(), g.xadj.begin());
+        return g;
+    }
+
+    /**
+     * The subgraph of some vertices of a graph and the edges between them, with the vertices in the given order.
+     */
+    Graph induced_subgraph(const Graph& g, const std::vector<std::size_t>& vertices)
+    {
+        std::vector<std::size_t> index(g.size(), NONE);
+        for (std::size_t i = 0; i < vertices.size(); ++i) {
+            index[vertices[i]] = i;
+        }
+        Graph sub;
+        sub.xadj.push_back(0);
+        for (std::size_t v : vertices) {
+            for (std::size_t i = g.xadj[v]; i < g.xadj[v + 1]; ++i) {
+                if (index[g.adjncy[i]] != NONE) {
+                    sub.adjncy.push_back(index[g.adjncy[i]]);
+                    sub.adjwgt.push_back(g.adjwgt[i]);
+                }
+            }
+            sub.xadj.push_back(sub.adjncy.size());
+            sub.vwgt.push_back(g.vwgt[v]);
+        }
+        return sub;
+    }
+
+    /**
+     * Collapse a heavy edge matching of @p g, recording the coarse vertex of each vertex in @p cmap.
+     */
+    Graph coarsen(const Graph& g, double max_vertex_weight, std::mt19937& rng, std::vector<std::size_t>& cmap)
+    {
+        std::size_t n = g.size();
+        std::vector<std::size_t> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        std::shuffle(order.begin(), order.end(), rng);
+
+        std::vector<std::size_t> match(n, NONE);
+        for (std::size_t v : order) {
+            if (match[v] != NONE) {
+                continue;
+            }
+            std::size_t best = v;
+            double best_weight = -1.0;
+            for (std::size_t i = g.xadj[v]; i < g.xadj[v + 1]; ++i) {
+                std::size_t u = g.adjncy[i];
+                if (match[u] == NONE && g.vwgt[v] + g.vwgt[u] <= max_vertex_weight && g.adjwgt[i] > best_weight) {
+                    best = u;
+                    best_weight = g.adjwgt[i];
+                }
+            }
+            match[v] = best;
+            match[best] = v;
+        }
+
+        cmap.assign(n, NONE);
+        std::vector<std::size_t> representative;
+        for (std::size_t v = 0; v < n; ++v) {
+            if (cmap[v] == NONE) {
+                cmap[v] = cmap[match[v]] = representative.size();
+                representative.push_back(v);
+            }
+        }
+
+        std::size_t nc = representative.size();
+        Graph c;
+        c.vwgt.assign(nc, 0.0);
+        c.xadj.reserve(nc + 1);
+        c.xadj.push_back(0);
+        std::vector<std::size_t> slot(nc, NONE);
+        for (std::size_t cv = 0; cv < nc; ++cv) {
+            std::size_t start = c.adjncy.size();
+            std::size_t members[2] = {representative[cv], match[representative[cv]]};
+            for (int m = 0; m < (members[0] == members[1] ? 1 : 2); ++m) {
+                std::size_t v = members[m];
+                c.vwgt[cv] += g.vwgt[v];
+                for (std::size_t i = g.xadj[v]; i < g.xadj[v + 1]; ++i) {
+                    std::size_t cu = cmap[g.adjncy[i]];
+                    if (cu == cv) {
+                        continue;
+                    }
+                    if (slot[cu] == NONE) {
+                        slot[cu] = c.adjncy.size();
+                        c.adjncy.push_back(cu);
+                        c.adjwgt.push_back(g.adjwgt[i]);
+                    }
+                    else {
+                        c.adjwgt[slot[cu]] += g.adjwgt[i];
+                    }
+                }
+            }
+            for (std::size_t i = start; i < c.adjncy.size(); ++i) {
+                slot[c.adjncy[i]] = NONE;
+            }
+            c.xadj.push_back(c.adjncy.size());
+        }
+        return c;
+    }
+
+    /**
+     * Split @p vertices into @p num_parts partitions numbered from @p first_part, by recursive bisection.
+     *
+     * Each bisection grows the first half breadth first from a pseudo-peripheral vertex until it holds its share of
+     * the weight, so each half tends to be a connected piece of the network.
+     */
+    void bisect(const Graph& g, const std::vector<std::size_t>& vertices, int num_parts, int first_part,
+                std::vector<int>& parts)
+    {
+        if (num_parts == 1) {
+            for (std::size_t v : vertices) {
+                parts[v] = first_part;
+            }
+            return;
+        }
+
+        int first_parts = num_parts / 2;
+        double total = 0.0;
+        for (std::size_t v : vertices) {
+            total += g.vwgt[v];
+        }
+        double target = total * first_parts / num_parts;
+
+        // 0 = not in this subset, 1 = in the subset, 2 = visited
+        std::vector<char> state(g.size(), 0);
+        auto reset = [&]() {
+            for (std::size_t v : vertices) {
+                state[v] = 1;
+            }
+        };
+        auto visit = [&](std::queue<std::size_t>& queue, std::size_t v) {
+            state[v] = 2;
+            queue.push(v);
+        };
+        auto expand = [&](std::queue<std::size_t>& queue, std::size_t v) {
+            for (std::size_t i = g.xadj[v]; i < g.xadj[v + 1]; ++i) {
+                if (state[g.adjncy[i]] == 1) {
+                    visit(queue, g.adjncy[i]);
+                }
+            }
+        };
+
+        // The last vertex reached by a breadth first search is far from the others
+        reset();
+        std::queue<std::size_t> queue;
+        std::size_t start = vertices[0];
+        visit(queue, start);
+        while (!queue.empty()) {
+            start = queue.front();
+            queue.pop();
+            expand(queue, start);
+        }
+
+        reset();
+        std::vector<std::size_t> first, second;
+        std::size_t max_first = vertices.size() - (num_parts - first_parts);
+        std::size_t next_seed = 0;
+        double grown = 0.0;
+        visit(queue, start);
+        while (first.size() < max_first) {
+            if (queue.empty()) {
+                // Disconnected subset; continue from another component
+                while (state[vertices[next_seed]] != 1) {
+                    ++next_seed;
+                }
+                visit(queue, vertices[next_seed]);
+            }
+            std::size_t v = queue.front();
+            // Stop at whichever side of the target is closer
+            if (first.size() >= (std::size_t)first_parts && grown + g.vwgt[v] - target > target - grown) {
+                break;
+            }
+            queue.pop();
+            first.push_back(v);
+            grown += g.vwgt[v];
+            expand(queue, v);
+        }
+
+        std::vector<char> in_first(g.size(), 0);
+        for (std::size_t v : first) {
+            in_first[v] = 1;
+        }
+        for (std::size_t v : vertices) {
+            if (!in_first[v]) {
+                second.push_back(v);
+            }
+        }
+
+        bisect(g, first, first_parts, first_part, parts);
+        bisect(g, second, num_parts - first_parts, first_part + first_parts, parts);
+    }
+
+    /**
+     * Move vertices out of partitions heavier than @p max_weight, preferring neighboring partitions.
+     */
+    void balance(const Graph& g, std::vector<int>& parts, int num_parts, double max_weight)
+    {
+        std::vector<double> weights = MultilevelPartitioner::partition_weights(g, parts, num_parts);
+        std::vector<std::size_t> counts(num_parts, 0);
+        for (int p : parts) {
+            ++counts[p];
+        }
+
+        std::vector<double> conn(num_parts, 0.0);
+        std::vector<int> touched;
+        for (int sweep = 0; sweep < 2; ++sweep) {
+            if (*std::max_element(weights.begin(), weights.end()) <= max_weight) {
+                return;
+            }
+            for (std::size_t v = 0; v < g.size(); ++v) {
+                int from = parts[v];
+                if (weights[from] <= max_weight || counts[from] == 1) {
+                    continue;
+                }
+                touched.clear();
+                for (std::size_t i = g.xadj[v]; i < g.xadj[v + 1]; ++i) {
+                    int p = parts[g.adjncy[i]];
+                    if (conn[p] == 0.0) {
+                        touched.push_back(p);
+                    }
+                    conn[p] += g.adjwgt[i];
+                }
+                int to = -1;
+                for (int p : touched) {
+                    if (p != from && weights[p] + g.vwgt[v] <= max_weight && (to < 0 || conn[p] > conn[to])) {
+                        to = p;
+                    }
+                    conn[p] = 0.0;
+                }
+                if (to < 0) {
+                    to = (int)(std::min_element(weights.begin(), weights.end()) - weights.begin());
+                    if (weights[to] + g.vwgt[v] > max_weight) {
+                        continue;
+                    }
+                }
+                parts[v] = to;
+                weights[from] -= g.vwgt[v];
+                weights[to] += g.vwgt[v];
+                --counts[from];
+                ++counts[to];
+            }
+        }
+    }
+
+    /**
+     * Greedily move boundary vertices to the neighboring partition that most reduces the edge cut.
+     *
+     * Moves that leave the cut unchanged are taken if they improve the balance; no move may take a partition above
+     * @p max_weight, or leave a partition empty.
+     */
+    void refine(const Graph& g, std::vector<int>& parts, int num_parts, double max_weight, std::mt19937& rng)
+    {
+        std::vector<double> weights = MultilevelPartitioner::partition_weights(g, parts, num_parts);
+        std::vector<std::size_t> counts(num_parts, 0);
+        for (int p : parts) {
+            ++counts[p];
+        }
+
+        std::vector<std::size_t> order(g.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::vector<double> conn(num_parts, 0.0);
+        std::vector<int> touched;
+        for (int pass = 0; pass < REFINEMENT_PASSES; ++pass) {
+            std::shuffle(order.begin(), order.end(), rng);
+            std::size_t moved = 0;
+            for (std::size_t v : order) {
+                int from = parts[v];
+                if (counts[from] == 1) {
+                    continue;
+                }
+                touched.clear();
+                for (std::size_t i = g.xadj[v]; i < g.xadj[v + 1]; ++i) {
+                    int p = parts[g.adjncy[i]];
+                    if (conn[p] == 0.0) {
+                        touched.push_back(p);
+                    }
+                    conn[p] += g.adjwgt[i];
+                }
+                int to = -1;
+                double best_gain = 0.0;
+                for (int p : touched) {
+                    if (p == from || weights[p] + g.vwgt[v] > max_weight) {
+                        continue;
+                    }
+                    double gain = conn[p] - conn[from];
+                    if (gain > best_gain || (gain == best_gain && weights[p] + g.vwgt[v] < weights[from]
+                                             && (to < 0 || weights[p] < weights[to]))) {
+                        to = p;
+                        best_gain = gain;
+                    }
+                }
+                for (int p : touched) {
+                    conn[p] = 0.0;
+                }
+                if (to < 0) {
+                    continue;
+                }
+                parts[v] = to;
+                weights[from] -= g.vwgt[v];
+                weights[to] += g.vwgt[v];
+                --counts[from];
+                ++counts[to];
+                ++moved;
+            }
+            if (moved == 0) {
+                break;
+            }
+        }
+    }
+}
+
+MultilevelPartitioner::MultilevelPartitioner(Network& network, const std::unordered_map<std::string, double>& weights,
+                                             double default_weight)
+{
+    std::unordered_map<std::string, std::size_t> catchment_index;
+    std::vector<double> vwgt;
+    for (const auto& id : network.filter("cat")) {
+        auto it = weights.find(id);
+        double weight = it == weights.end() ? default_weight : it->second;
+        if (!(weight > 0.0) || !std::isfinite(weight)) {
+            throw std::invalid_argument("MultilevelPartitioner: weight of catchment " + id + " must be positive.");
+        }
+        catchment_index.emplace(id, catchment_id_list.size());
+        catchment_id_list.push_back(id);
+        vwgt.push_back(weight);
+    }
+
+    auto catchments_of = [&catchment_index](const std::vector<std::string>& ids) {
+        std::vector<std::size_t> found;
+        for (const auto& id : ids) {
+            auto it = catchment_index.find(id);
+            if (it != catchment_index.end()) {
+                found.push_back(it->second);
+            }
+        }
+        return found;
+    };
+
+    std::vector<std::pair<std::size_t, std::size_t>> edges;
+    for (const auto& feat_idx : network) {
+        std::string id = network.get_id(feat_idx);
+        auto self = catchment_index.find(id);
+        std::vector<std::size_t> destinations = catchments_of(network.get_destination_ids(id));
+        if (self != catchment_index.end()) {
+            // Catchments flowing directly into catchments
+            for (std::size_t d : destinations) {
+                edges.emplace_back(self->second, d);
+            }
+            continue;
+        }
+
+        std::vector<std::size_t> origins = catchments_of(network.get_origination_ids(id));
+        if (!origins.empty() && !destinations.empty()) {
+            for (std::size_t o : origins) {
+                for (std::size_t d : destinations) {
+                    edges.emplace_back(o, d);
+                }
+            }
+        }
+        else {
+            // A terminal (or source) nexus still couples the catchments on its one side
+            std::vector<std::size_t>& side = origins.empty() ? destinations : origins;
+            for (std::size_t i = 1; i < side.size(); ++i) {
+                edges.emplace_back(side[0], side[i]);
+            }
+        }
+
+        origins.insert(origins.end(), destinations.begin(), destinations.end());
+        if (origins.size() > 1) {
+            nexus_catchments.push_back(std::move(origins));
+        }
+    }
+
+    graph = make_graph(std::move(vwgt), edges);
+}
+
+std::vector<int> MultilevelPartitioner::partition(int num_partitions, double imbalance, bool use_metis) const
+{
+    return partition_graph_with(graph, num_partitions, imbalance, use_metis);
+}
+
+std::vector<int> MultilevelPartitioner::partition_hierarchical(int num_nodes, int parts_per_node, double imbalance,
+                                                               bool use_metis) const
+{
+    if (parts_per_node < 1) {
+        throw std::invalid_argument("MultilevelPartitioner: cannot partition nodes into "
+                                    + std::to_string(parts_per_node) + " partitions.");
+    }
+    std::vector<int> nodes = partition_graph_with(graph, num_nodes, imbalance, use_metis);
+    std::vector<std::vector<std::size_t>> node_vertices(num_nodes);
+    for (std::size_t v = 0; v < graph.size(); ++v) {
+        node_vertices[nodes[v]].push_back(v);
+    }
+    std::vector<int> parts(graph.size());
+    for (int node = 0; node < num_nodes; ++node) {
+        std::vector<int> node_parts = partition_graph_with(induced_subgraph(graph, node_vertices[node]),
+                                                           parts_per_node, imbalance, use_metis);
+        for (std::size_t i = 0; i < node_vertices[node].size(); ++i) {
+            parts[node_vertices[node][i]] = node * parts_per_node + node_parts[i];
+        }
+    }
+    return parts;
+}
+
+std::vector<int> MultilevelPartitioner::partition_graph_with(const Graph& graph, int num_partitions, double imbalance,
+                                                             bool use_metis)
+{
+    if (use_metis) {
+#ifdef NGEN_METIS_ACTIVE
+        if (num_partitions < 1 || (std::size_t)num_partitions > graph.size()) {
+            throw std::invalid_argument("MultilevelPartitioner: cannot partition " + std::to_string(graph.size())
+                                        + " catchments into " + std::to_string(num_partitions) + " partitions.");
+        }
+        return num_partitions == 1 ? std::vector<int>(graph.size(), 0)
+                                   : partition_graph_metis(graph, num_partitions, imbalance);
+#else
+        throw std::invalid_argument("MultilevelPartitioner: METIS partitioning requested, but ngen was built "
+                                    "without METIS support.");
+#endif
+    }
+    return partition_graph(graph, num_partitions, imbalance);
+}
+
+std::size_t MultilevelPartitioner::count_boundary_nexuses(const std::vector<int>& parts) const
+{
+    std::size_t boundary = 0;
+    for (const auto& catchments : nexus_catchments) {
+        int part = parts[catchments[0]];
+        for (std::size_t c : catchments) {
+            if (parts[c] != part) {
+                ++boundary;
+                break;
+            }
+        }
+    }
+    return boundary;
+}
+
+void MultilevelPartitioner::add_order_edges(const std::vector<std::string>& order, double weight)
+{
+    if (!(weight > 0.0) || !std::isfinite(weight)) {
+        throw std::invalid_argument("MultilevelPartitioner: weight of storage order edges must be positive.");
+    }
+    std::unordered_map<std::string, std::size_t> catchment_index;
+    for (std::size_t i = 0; i < catchment_id_list.size(); ++i) {
+        catchment_index.emplace(catchment_id_list[i], i);
+    }
+
+    // Every existing arc, and both arcs of each added edge, merged by sorting
+    std::vector<std::pair<std::pair<std::size_t, std::size_t>, double>> arcs;
+    arcs.reserve(graph.adjncy.size() + 2 * order.size());
+    for (std::size_t v = 0; v < graph.size(); ++v) {
+        for (std::size_t i = graph.xadj[v]; i < graph.xadj[v + 1]; ++i) {
+            arcs.push_back({{v, graph.adjncy[i]}, graph.adjwgt[i]});
+        }
+    }
+    std::size_t previous = NONE;
+    for (const auto& id : order) {
+        auto it = catchment_index.find(id);
+        if (it == catchment_index.end()) {
+            continue;
+        }
+        if (previous != NONE && previous != it->second) {
+            arcs.push_back({{previous, it->second}, weight});
+            arcs.push_back({{it->second, previous}, weight});
+        }
+        previous = it->second;
+    }
+    std::sort(arcs.begin(), arcs.end(), [](const std::pair<std::pair<std::size_t, std::size_t>, double>& a,
+                                           const std::pair<std::pair<std::size_t, std::size_t>, double>& b) {
+        return a.first < b.first;
+    });
+
+    graph.xadj.assign(graph.size() + 1, 0);
+    graph.adjncy.clear();
+    graph.adjwgt.clear();
+    for (std::size_t i = 0; i < arcs.size(); ++i) {
+        if (i > 0 && arcs[i].first == arcs[i - 1].first) {
+            graph.adjwgt.back() += arcs[i].second;
+            continue;
+        }
+        graph.adjncy.push_back(arcs[i].first.second);
+        graph.adjwgt.push_back(arcs[i].second);
+        ++graph.xadj[arcs[i].first.first + 1];
+    }
+    std::partial_sum(graph.xadj.begin(), graph.xadj.end(), graph.xadj.begin());
+}
+
+std::size_t MultilevelPartitioner::count_order_runs(const std::vector<int>& parts,
+                                                    const std::vector<std::string>& order) const
+{
+    std::unordered_map<std::string, std::size_t> catchment_index;
+    for (std::size_t i = 0; i < catchment_id_list.size(); ++i) {
+        catchment_index.emplace(catchment_id_list[i], i);
+    }
+    std::size_t runs = 0;
+    int previous_part = -1;
+    for (const auto& id : order) {
+        auto it = catchment_index.find(id);
+        if (it == catchment_index.end()) {
+            continue;
+        }
+        if (runs == 0 || parts[it->second] != previous_part) {
+            ++runs;
+        }
+        previous_part = parts[it->second];
+    }
+    return runs;
+}
+
+std::vector<int> MultilevelPartitioner::partition_graph(const Graph& graph, int num_partitions, double imbalance)
+{
+    if (num_partitions < 1 || (std::size_t)num_partitions > graph.size()) {
+        throw std::invalid_argument("MultilevelPartitioner: cannot partition " + std::to_string(graph.size())
+                                    + " vertices into " + std::to_string(num_partitions) + " partitions.");
+    }
+    if (num_partitions == 1) {
+        return std::vector<int>(graph.size(), 0);
+    }
+
+    double total = std::accumulate(graph.vwgt.begin(), graph.vwgt.end(), 0.0);
+    double heaviest = *std::max_element(graph.vwgt.begin(), graph.vwgt.end());
+    double average = total / num_partitions;
+    // A single catchment heavier than the limit still needs a partition of its own
+    double max_weight = std::max(average * (1.0 + imbalance), heaviest);
+
+    std::mt19937 rng(SEED);
+    std::size_t coarsest = std::max(COARSEST_VERTICES_PER_PARTITION * num_partitions, COARSEST_VERTICES_MIN);
+    double max_vertex_weight = 1.5 * total / coarsest;
+
+    // Coarsening; a deque keeps references to earlier levels valid
+    std::deque<Graph> levels;
+    std::vector<std::vector<std::size_t>> cmaps;
+    const Graph* current = &graph;
+    while (current->size() > coarsest) {
+        std::vector<std::size_t> cmap;
+        Graph coarse = coarsen(*current, max_vertex_weight, rng, cmap);
+        if (coarse.size() > MIN_COARSENING_RATIO * current->size()) {
+            break;
+        }
+        levels.push_back(std::move(coarse));
+        cmaps.push_back(std::move(cmap));
+        current = &levels.back();
+    }
+
+    // Initial partitioning of the coarsest graph
+    std::vector<int> parts(current->size(), -1);
+    std::vector<std::size_t> vertices(current->size());
+    std::iota(vertices.begin(), vertices.end(), 0);
+    bisect(*current, vertices, num_partitions, 0, parts);
+    balance(*current, parts, num_partitions, max_weight);
+    refine(*current, parts, num_partitions, max_weight, rng);
+
+    // Uncoarsening
+    for (std::size_t level = levels.size(); level > 0; --level) {
+        const Graph& fine = level == 1 ? graph : levels[level - 2];
+        const std::vector<std::size_t>& cmap = cmaps[level - 1];
+        std::vector<int> fine_parts(fine.size());
+        for (std::size_t v = 0; v < fine.size(); ++v) {
+            fine_parts[v] = parts[cmap[v]];
+        }
+        parts = std::move(fine_parts);
+        balance(fine, parts, num_partitions, max_weight);
+        refine(fine, parts, num_partitions, max_weight, rng);
+    }
+    return parts;
+}
+
+std::vector<double> MultilevelPartitioner::partition_weights(const Graph& graph, const std::vector<int>& parts,
+                                                             int num_partitions)
+{
+    std::vector<double> weights(num_partitions, 0.0);
+    for (std::size_t v = 0; v < graph.size(); ++v) {
+        weights[parts[v]] += graph.vwgt[v];
+    }
+    return weights;
+}
+
+double MultilevelPartitioner::edge_cut(const Graph& graph, const std::vector<int>& parts)
+{
+    double cut = 0.0;
+    for (std::size_t v = 0; v < graph.size(); ++v) {
+        for (std::size_t i = graph.xadj[v]; i < graph.xadj[v + 1]; ++i) {
+            if (parts[v] != parts[graph.adjncy[i]]) {
+                cut += graph.adjwgt[i];
+            }
+        }
+    }
+    // Every edge was counted from both ends
+    return cut / 2.0;
+}
+
+std::vector<int> MultilevelPartitioner::place_on_nodes(std::size_t num_partitions,
+                                                       std::vector<std::pair<std::size_t, std::size_t>> links,
+                                                       std::size_t ranks_per_node)
+{
+    if (ranks_per_node == 0) {
+        throw std::invalid_argument("MultilevelPartitioner: cannot place partitions on nodes of 0 ranks.");
+    }
+    for (const auto& link : links) {
+        if (link.first >= num_partitions || link.second >= num_partitions) {
+            throw std::invalid_argument("MultilevelPartitioner: a remote connection is not between two of the "
+                                        + std::to_string(num_partitions) + " partitions.");
+        }
+    }
+    // Partitions shared by one remote connection are linked by an edge of unit weight
+    Graph g = make_graph(std::vector<double>(num_partitions, 1.0), links);
+    std::size_t num_nodes = (num_partitions + ranks_per_node - 1) / ranks_per_node;
+    std::vector<double> traffic(num_partitions, 0.0);
+    for (std::size_t v = 0; v < num_partitions; ++v) {
+        traffic[v] = std::accumulate(g.adjwgt.begin() + g.xadj[v], g.adjwgt.begin() + g.xadj[v + 1], 0.0);
+    }
+
+    // Fill each node in turn with the partitions most connected to those already on it
+    std::vector<int> node_of(num_partitions, -1);
+    std::vector<std::vector<std::size_t>> members(num_nodes);
+    std::vector<double> to_node(num_partitions, 0.0);
+    for (std::size_t node = 0; node < num_nodes; ++node) {
+        std::fill(to_node.begin(), to_node.end(), 0.0);
+        std::size_t capacity = std::min(ranks_per_node, num_partitions - node * ranks_per_node);
+        while (members[node].size() < capacity) {
+            std::size_t best = NONE;
+            for (std::size_t v = 0; v < num_partitions; ++v) {
+                if (node_of[v] < 0 && (best == NONE || to_node[v] > to_node[best]
+                                       || (to_node[v] == to_node[best] && traffic[v] > traffic[best]))) {
+                    best = v;
+                }
+            }
+            node_of[best] = (int)node;
+            members[node].push_back(best);
+            for (std::size_t i = g.xadj[best]; i < g.xadj[best + 1]; ++i) {
+                to_node[g.adjncy[i]] += g.adjwgt[i];
+            }
+        }
+    }
+
+    // Swap partitions between nodes while that lowers the traffic between them
+    std::vector<std::unordered_map<int, double>> node_traffic(num_partitions);
+    for (std::size_t v = 0; v < num_partitions; ++v) {
+        for (std::size_t i = g.xadj[v]; i < g.xadj[v + 1]; ++i) {
+            node_traffic[v][node_of[g.adjncy[i]]] += g.adjwgt[i];
+        }
+    }
+    auto traffic_of = [&node_traffic](std::size_t v, int node) {
+        auto found = node_traffic[v].find(node);
+        return found == node_traffic[v].end() ? 0.0 : found->second;
+    };
+    auto move = [&](std::size_t v, int from, int to) {
+        for (std::size_t i = g.xadj[v]; i < g.xadj[v + 1]; ++i) {
+            node_traffic[g.adjncy[i]][from] -= g.adjwgt[i];
+            node_traffic[g.adjncy[i]][to] += g.adjwgt[i];
+        }
+        node_of[v] = to;
+    };
+    for (int pass = 0; pass < REFINEMENT_PASSES && num_nodes > 1; ++pass) {
+        bool is_improved = false;
+        for (std::size_t u = 0; u < num_partitions; ++u) {
+            const int a = node_of[u];
+            double best_gain = 1.0e-9;
+            std::size_t best = NONE;
+            for (const auto& other : node_traffic[u]) {
+                const int b = other.first;
+                if (b == a || other.second <= 0.0) {
+                    continue;
+                }
+                for (std::size_t w : members[b]) {
+                    double between = 0.0;
+                    for (std::size_t i = g.xadj[u]; i < g.xadj[u + 1]; ++i) {
+                        between += g.adjncy[i] == w ? g.adjwgt[i] : 0.0;
+                    }
+                    double gain = other.second - traffic_of(u, a) + traffic_of(w, a) - traffic_of(w, b) - 2.0 * between;
+                    if (gain > best_gain) {
+                        best_gain = gain;
+                        best = w;
+                    }
+                }
+            }
+            if (best != NONE) {
+                const int b = node_of[best];
+                move(u, a, b);
+                move(best, b, a);
+                *std::find(members[a].begin(), members[a].end(), u) = best;
+                *std::find(members[b].begin(), members[b].end(), best) = u;
+                is_improved = true;
+            }
+        }
+        if (!is_improved) {
+            break;
+        }
+    }
+
+    // Number the partitions of each node in their own order
+    std::vector<int> rank_of(num_partitions);
+    for (std::size_t node = 0; node < num_nodes; ++node) {
+        std::sort(members[node].begin(), members[node].end());
+        for (std::size_t i = 0; i < members[node].size(); ++i) {
+            rank_of[members[node][i]] = (int)(node * ranks_per_node + i);
+        }
+    }
+    return rank_of;
+}
+
+#ifdef NGEN_METIS_ACTIVE
+std::vector<int> MultilevelPartitioner::partition_graph_metis(const Graph& graph, int num_partitions,
+                                                              double imbalance)
+{
+    // METIS requires integer weights; scale vertex weights so the average catchment weighs 1000
+    double total = std::accumulate(graph.vwgt.begin(), graph.vwgt.end(), 0.0);
+    double scale = 1000.0 * graph.size() / total;
+
+    idx_t nvtxs = graph.size();
+    idx_t ncon = 1;
+    idx_t nparts = num_partitions;
+    std::vector<idx_t> xadj(graph.xadj.begin(), graph.xadj.end());
+    std::vector<idx_t> adjncy(graph.adjncy.begin(), graph.adjncy.end());
+    std::vector<idx_t> vwgt(graph.size()), adjwgt(graph.adjwgt.size());
+    for (std::size_t v = 0; v < graph.size(); ++v) {
+        vwgt[v] = std::max<idx_t>(1, std::llround(graph.vwgt[v] * scale));
+    }
+    for (std::size_t i = 0; i < graph.adjwgt.size(); ++i) {
+        adjwgt[i] = std::max<idx_t>(1, std::llround(graph.adjwgt[i]));
+    }
+    real_t ubvec = 1.0 + imbalance;
+    idx_t options[METIS_NOPTIONS];
+    METIS_SetDefaultOptions(options);
+    options[METIS_OPTION_SEED] = SEED;
+
+    idx_t objval;
+    std::vector<idx_t> part(graph.size());
+    int status = METIS_PartGraphKway(&nvtxs, &ncon, xadj.data(), adjncy.data(), vwgt.data(), nullptr, adjwgt.data(),
+                                     &nparts, nullptr, &ubvec, options, &objval, part.data());
+    if (status != METIS_OK) {
+        throw std::runtime_error("MultilevelPartitioner: METIS_PartGraphKway failed with status "
+                                 + std::to_string(status));
+    }
+    return std::vector<int>(part.begin(), part.end());
+}
+#endif
+
+std::unordered_map<std::string, double> network::read_catchment_weights(const std::string& path)
+{
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("read_catchment_weights: cannot read catchment weights file " + path);
+    }
+    std::unordered_map<std::string, double> weights;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::replace(line.begin(), line.end(), ',', ' ');
+        std::istringstream fields(line);
+        std::string id;
+        double weight;
+        if (fields >> id >> weight) {
+            weights[id] = weight;
+        }
+    }
+    return weights;
+}
+
+std::vector<std::string> network::read_catchment_order(const std::string& path)
+{
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("read_catchment_order: cannot read catchment order file " + path);
+    }
+    std::vector<std::string> order;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::replace(line.begin(), line.end(), ',', ' ');
+        std::istringstream fields(line);
+        std::string id;
+        if (fields >> id) {
+            order.push_back(id);
+        }
+    }
+    return order;
+}
@@ -0,0 +1,278 @@
+#include "WavefrontScheduler.hpp"
+
+#include <stdexcept>
+#include <unordered_map>
+
+using namespace network;
+
+WavefrontScheduler::WavefrontScheduler(Network& network, long total_steps, long lookahead)
+    : floor_step(0), total_steps(total_steps), lookahead(lookahead), aborted(false),
+      poll_interval(std::chrono::microseconds(500)), max_wait(std::chrono::microseconds(1000000))
+{
+    if (lookahead < 0) {
+        throw std::invalid_argument("WavefrontScheduler: lookahead window must not be negative.");
+    }
+
+    std::unordered_map<std::string, std::size_t> catchment_index, nexus_index;
+    for (const auto& id : network.filter("cat")) {
+        catchment_index.emplace(id, catchment_id_list.size());
+        catchment_id_list.push_back(id);
+    }
+    for (const auto& id : network.filter("nex")) {
+        nexus_index.emplace(id, nexus_id_list.size());
+        nexus_id_list.push_back(id);
+    }
+
+    std::size_t num_catchments = catchment_id_list.size();
+    std::size_t num_nexuses = nexus_id_list.size();
+
+    // Nexus -> contributing catchments, and nexus -> receiving catchments
+    nexus_upstream_catchments.resize(num_nexuses);
+    std::vector<std::vector<std::size_t>> nexus_downstream_catchments(num_nexuses);
+    for (std::size_t n = 0; n < num_nexuses; ++n) {
+        for (const auto& id : network.get_origination_ids(nexus_id_list[n])) {
+            auto it = catchment_index.find(id);
+            if (it != catchment_index.end()) {
+                nexus_upstream_catchments[n].push_back(it->second);
+            }
+        }
+        for (const auto& id : network.get_destination_ids(nexus_id_list[n])) {
+            auto it = catchment_index.find(id);
+            if (it != catchment_index.end()) {
+                nexus_downstream_catchments[n].push_back(it->second);
+            }
+        }
+    }
+
+    catchment_upstream_catchments.resize(num_catchments);
+    catchment_downstream_catchments.resize(num_catchments);
+    catchment_downstream_nexus.assign(num_catchments, -1);
+    for (std::size_t c = 0; c < num_catchments; ++c) {
+        for (const auto& id : network.get_origination_ids(catchment_id_list[c])) {
+            auto it = nexus_index.find(id);
+            if (it != nexus_index.end()) {
+                const auto& upstream = nexus_upstream_catchments[it->second];
+                catchment_upstream_catchments[c].insert(catchment_upstream_catchments[c].end(),
+                                                        upstream.begin(), upstream.end());
+            }
+        }
+        for (const auto& id : network.get_destination_ids(catchment_id_list[c])) {
+            auto it = nexus_index.find(id);
+            if (it != nexus_index.end()) {
+                // In a dendritic network there is only one destination, and flow only goes to the first one anyway
+                catchment_downstream_nexus[c] = it->second;
+                catchment_downstream_catchments[c] = nexus_downstream_catchments[it->second];
+                break;
+            }
+        }
+    }
+
+    catchment_next_step.assign(num_catchments, 0);
+    catchment_done_steps.assign(num_catchments, 0);
+    catchment_busy.assign(num_catchments, false);
+    nexus_next_step.assign(num_nexuses, 0);
+    nexus_done_steps.assign(num_nexuses, 0);
+    nexus_busy.assign(num_nexuses, false);
+
+    std::size_t tasks_per_step = num_catchments + num_nexuses;
+    pending_per_step.assign(total_steps > 0 ? total_steps : 0, tasks_per_step);
+    remaining_tasks = tasks_per_step * pending_per_step.size();
+
+    if (tasks_per_step == 0) {
+        floor_step = total_steps;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (std::size_t c = 0; c < num_catchments; ++c) {
+        try_release_catchment(c);
+    }
+    for (std::size_t n = 0; n < num_nexuses; ++n) {
+        try_release_nexus(n);
+    }
+}
+
+void WavefrontScheduler::set_readiness_check(ReadinessCheck check, std::chrono::microseconds poll_interval,
+                                             std::chrono::microseconds max_wait)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    readiness = std::move(check);
+    this->poll_interval = poll_interval;
+    this->max_wait = max_wait;
+}
+
+bool WavefrontScheduler::acquire(Task& task)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        if (aborted) {
+            return false;
+        }
+        if (!ready.empty()) {
+            task = ready.top();
+            ready.pop();
+            if (!readiness) {
+                return true;
+            }
+            lock.unlock();
+            bool is_ready = readiness(task);
+            lock.lock();
+            if (is_ready) {
+                return true;
+            }
+            waiting.push_back(WaitingTask{task, std::chrono::steady_clock::now()});
+            continue;
+        }
+        if (waiting.empty()) {
+            if (remaining_tasks == 0) {
+                return false;
+            }
+            work_available.wait(lock);
+        }
+        else if (is_polling || !poll_waiting(lock, task)) {
+            work_available.wait_for(lock, poll_interval);
+        }
+        else {
+            return true;
+        }
+    }
+}
+
+bool WavefrontScheduler::poll_waiting(std::unique_lock<std::mutex>& lock, Task& task)
+{
+    std::vector<WaitingTask> polled;
+    polled.swap(waiting);
+    is_polling = true;
+    lock.unlock();
+
+    std::size_t taken = polled.size();
+    std::vector<WaitingTask> not_ready;
+    std::vector<Task> now_ready;
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < polled.size(); ++i) {
+        if (now - polled[i].since >= max_wait || readiness(polled[i].task)) {
+            if (taken == polled.size()) {
+                taken = i;
+            }
+            else {
+                now_ready.push_back(polled[i].task);
+            }
+        }
+        else {
+            not_ready.push_back(polled[i]);
+        }
+    }
+
+    lock.lock();
+    is_polling = false;
+    waiting.insert(waiting.end(), not_ready.begin(), not_ready.end());
+    for (const Task& t : now_ready) {
+        ready.push(t);
+    }
+    if (!now_ready.empty()) {
+        work_available.notify_all();
+    }
+    // The rest of the tasks found ready are checked again as they are acquired, which is cheap once they are
+    if (taken == polled.size() || aborted) {
+        return false;
+    }
+    task = polled[taken].task;
+    return true;
+}
+
+void WavefrontScheduler::complete(const Task& task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (task.kind == CATCHMENT) {
+            catchment_done_steps[task.index] = task.time_step + 1;
+            catchment_busy[task.index] = false;
+        }
+        else {
+            nexus_done_steps[task.index] = task.time_step + 1;
+            nexus_busy[task.index] = false;
+        }
+        --pending_per_step[task.time_step];
+        --remaining_tasks;
+
+        if (task.kind == CATCHMENT) {
+            try_release_catchment(task.index);
+            for (std::size_t d : catchment_downstream_catchments[task.index]) {
+                try_release_catchment(d);
+            }
+            long n = catchment_downstream_nexus[task.index];
+            if (n >= 0) {
+                try_release_nexus(n);
+            }
+        }
+        else {
+            try_release_nexus(task.index);
+        }
+        advance_floor();
+    }
+    work_available.notify_all();
+}
+
+void WavefrontScheduler::abort()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        aborted = true;
+    }
+    work_available.notify_all();
+}
+
+void WavefrontScheduler::try_release_catchment(std::size_t c)
+{
+    if (catchment_busy[c] || catchment_next_step[c] >= total_steps) {
+        return;
+    }
+    long t = catchment_next_step[c];
+    if (t > floor_step + lookahead) {
+        return;
+    }
+    for (std::size_t u : catchment_upstream_catchments[c]) {
+        if (catchment_done_steps[u] <= t) {
+            return;
+        }
+    }
+    catchment_busy[c] = true;
+    catchment_next_step[c] = t + 1;
+    ready.push(Task{CATCHMENT, c, t});
+}
+
+void WavefrontScheduler::try_release_nexus(std::size_t n)
+{
+    if (nexus_busy[n] || nexus_next_step[n] >= total_steps) {
+        return;
+    }
+    long t = nexus_next_step[n];
+    if (t > floor_step + lookahead) {
+        return;
+    }
+    for (std::size_t u : nexus_upstream_catchments[n]) {
+        if (catchment_done_steps[u] <= t) {
+            return;
+        }
+    }
+    nexus_busy[n] = true;
+    nexus_next_step[n] = t + 1;
+    ready.push(Task{NEXUS, n, t});
+}
+
+void WavefrontScheduler::advance_floor()
+{
+    long previous_floor = floor_step;
+    while (floor_step < total_steps && pending_per_step[floor_step] == 0) {
+        ++floor_step;
+    }
+    if (floor_step == previous_floor) {
+        return;
+    }
+    // Anything that was only held back by the window may now go
+    for (std::size_t c = 0; c < catchment_id_list.size(); ++c) {
+        try_release_catchment(c);
+    }
+    for (std::size_t n = 0; n < nexus_id_list.size(); ++n) {
+        try_release_nexus(n);
+    }
+}
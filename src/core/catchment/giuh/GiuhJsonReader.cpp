@@ -2,14 +2,27 @@
 
 using namespace giuh;
 
+std::map<std::pair<std::string, std::string>, std::shared_ptr<GiuhJsonReader>> GiuhJsonReader::shared_readers;
+std::mutex GiuhJsonReader::shared_readers_mutex;
+
+std::shared_ptr<GiuhJsonReader> GiuhJsonReader::get_shared_reader(const std::string &data_file_path,
+                                                                  const std::string &id_map_path) {
+    const std::lock_guard<std::mutex> lock(shared_readers_mutex);
+    std::shared_ptr<GiuhJsonReader> &reader = shared_readers[std::make_pair(data_file_path, id_map_path)];
+    if (reader == nullptr) {
+        reader = std::make_shared<GiuhJsonReader>(data_file_path, id_map_path);
+    }
+    return reader;
+}
+
 std::shared_ptr<giuh_kernel_impl> GiuhJsonReader::build_giuh_kernel(std::string catchment_id, std::string comid,
-                                                                    ptree catchment_data_node) {
+                                                                    const ptree &catchment_data_node) {
     // Get times and freqs and convert to vectors
     std::vector<double> cdf_times;
     std::vector<double> cumulative_freqs = extract_cumulative_frequency_ordinates(catchment_data_node);
 
     // TODO: account for error condition of unmatching JSON structure for times
-    for (ptree::value_type times : catchment_data_node.get_child("CDF.Time")) {
+    for (const ptree::value_type &times : catchment_data_node.get_child("CDF.Time")) {
         cdf_times.push_back(times.second.get_value<double>());
     }
 
@@ -18,11 +31,11 @@ std::shared_ptr<giuh_kernel_impl> GiuhJsonReader::build_giuh_kernel(std::string
 
 std::vector<double> GiuhJsonReader::extract_cumulative_frequency_ordinates(std::string catchment_id) {
     std::string associated_comid = get_associated_comid(std::move(catchment_id));
-    std::unique_ptr<ptree> data_node_ptr = find_data_node_for_comid(associated_comid);
+    const ptree *data_node_ptr = find_data_node_for_comid(associated_comid);
     return extract_cumulative_frequency_ordinates(*data_node_ptr);
 }
 
-std::vector<double> GiuhJsonReader::extract_cumulative_frequency_ordinates(ptree catchment_data_node) {
+std::vector<double> GiuhJsonReader::extract_cumulative_frequency_ordinates(const ptree &catchment_data_node) {
     std::vector<double> cumulative_freqs;
 
     // TODO: account for error condition of unmatching JSON structure for freqs
@@ -36,7 +49,7 @@ std::vector<double> GiuhJsonReader::extract_cumulative_frequency_ordinates(ptree
         throw std::runtime_error("Unable to find GIUH cumulative frequencies data node in parsed GIUH JSON");
     }
 
-    for (ptree::value_type freqs : catchment_data_node.get_child(freq_node_name)) {
+    for (const ptree::value_type &freqs : catchment_data_node.get_child(freq_node_name)) {
         cumulative_freqs.push_back(freqs.second.get_value<double>());
     }
     double eps = 0.0001;
@@ -48,17 +61,9 @@ std::vector<double> GiuhJsonReader::extract_cumulative_frequency_ordinates(ptree
     return cumulative_freqs;
 }
 
-std::unique_ptr<ptree> GiuhJsonReader::find_data_node_for_comid(std::string comid) {
-    // Traverse tree until finding node with correct id
-    for (ptree::iterator pos = data_json_tree->begin(); pos != data_json_tree->end(); ++pos) {
-        // TODO: confirm this logic is correct, with respect to iterator members and what they retrieve
-        // When the right node is found, use it to build a referenced kernel, and return the reference
-        auto first = pos->first;
-        if (pos->first == comid) {
-            return std::make_unique<ptree>(pos->second);
-        }
-    }
-    return nullptr;
+const ptree *GiuhJsonReader::find_data_node_for_comid(const std::string &comid) const {
+    auto indexed = data_node_index.find(comid);
+    return indexed == data_node_index.end() ? nullptr : indexed->second;
 }
 
 std::string GiuhJsonReader::get_associated_comid(std::string catchment_id) {
@@ -73,8 +78,7 @@ std::shared_ptr<giuh_kernel_impl> GiuhJsonReader::get_giuh_kernel_for_id(std::st
     if (comid == "") {
         return nullptr;
     }
-    // Traverse tree until finding node with correct id
-    std::unique_ptr<ptree> data_node = find_data_node_for_comid(comid);
+    const ptree *data_node = find_data_node_for_comid(comid);
     return data_node == nullptr ? nullptr : build_giuh_kernel(catchment_id, comid, *data_node);
 }
 
@@ -86,15 +90,16 @@ bool GiuhJsonReader::is_giuh_kernel_for_id_exists(std::string catchment_id) {
     if (comid == "") {
         return false;
     }
-    // Traverse tree until finding node with correct id
-    for (ptree::iterator pos = data_json_tree->begin(); pos != data_json_tree->end(); ++pos) {
-        // TODO: confirm this logic is correct, with respect to iterator members and what they retrieve
-        // When the right node is found, use it to build a referenced kernel, and return the reference
-        if (pos->first == comid) {
-            return true;
-        }
+    return find_data_node_for_comid(comid) != nullptr;
+}
+
+void GiuhJsonReader::index_data_nodes() {
+    data_node_index.clear();
+    data_node_index.reserve(data_json_tree->size());
+    for (const ptree::value_type &node : *data_json_tree) {
+        // Keeps the first node for any repeated COMID
+        data_node_index.emplace(node.first, &node.second);
     }
-    return false;
 }
 
 bool GiuhJsonReader::is_data_json_file_readable() {
@@ -0,0 +1,78 @@
+#include "giuh_convolution.hpp"
+
+#include <algorithm>
+#include <utility>
+
+using namespace giuh;
+
+giuh_convolution::giuh_convolution(std::vector<double> ordinates)
+{
+    set_ordinates(std::move(ordinates));
+}
+
+giuh_convolution::giuh_convolution(std::shared_ptr<const std::vector<double>> ordinates)
+{
+    set_ordinates(std::move(ordinates));
+}
+
+void giuh_convolution::add(double input, std::size_t first_ordinate_index)
+{
+    if (first_ordinate_index >= ordinates->size()) {
+        return;
+    }
+    const std::size_t count = ordinates->size() - first_ordinate_index;
+    const double *from = ordinates->data() + first_ordinate_index;
+    double *to = pending.data();
+
+    // The intervals run from head to the end of the buffer, then wrap around to its start; add to each contiguous part
+    const std::size_t before_wrap = std::min(count, pending.size() - head);
+    #pragma omp simd
+    for (std::size_t i = 0; i < before_wrap; ++i) {
+        to[head + i] += input * from[i];
+    }
+    #pragma omp simd
+    for (std::size_t i = before_wrap; i < count; ++i) {
+        to[i - before_wrap] += input * from[i];
+    }
+}
+
+double giuh_convolution::get_pending_total() const
+{
+    double total = 0.0;
+    for (double amount : pending) {
+        total += amount;
+    }
+    return total;
+}
+
+double giuh_convolution::release(std::size_t intervals)
+{
+    if (pending.empty()) {
+        return 0.0;
+    }
+    double released = 0.0;
+    const std::size_t count = std::min(intervals, pending.size());
+    for (std::size_t i = 0; i < count; ++i) {
+        released += pending[head];
+        pending[head] = 0.0;
+        head = head + 1 == pending.size() ? 0 : head + 1;
+    }
+    return released;
+}
+
+void giuh_convolution::set_ordinates(std::vector<double> ordinates)
+{
+    set_ordinates(std::make_shared<const std::vector<double>>(std::move(ordinates)));
+}
+
+void giuh_convolution::set_ordinates(std::shared_ptr<const std::vector<double>> ordinates)
+{
+    this->ordinates = ordinates != nullptr ? std::move(ordinates) : std::make_shared<const std::vector<double>>();
+    pending.assign(this->ordinates->size(), 0.0);
+    head = 0;
+}
+
+std::size_t giuh_convolution::size() const
+{
+    return ordinates->size();
+}
@@ -0,0 +1,111 @@
+#include "giuh_ordinate_table.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <utility>
+
+using namespace giuh;
+
+std::mutex giuh_ordinate_table::table_mutex;
+std::unordered_multimap<std::uint64_t, std::weak_ptr<const std::vector<double>>> giuh_ordinate_table::vectors;
+std::map<std::tuple<const void *, const void *, unsigned int>, std::weak_ptr<const giuh_regularized_ordinates>>
+        giuh_ordinate_table::regularized;
+std::size_t giuh_ordinate_table::sweep_size = 64;
+
+giuh_ordinate_table::ordinates_ptr giuh_ordinate_table::intern(std::vector<double> values)
+{
+    const std::uint64_t key = hash(values);
+    std::lock_guard<std::mutex> lock(table_mutex);
+    auto range = vectors.equal_range(key);
+    for (auto it = range.first; it != range.second; ++it) {
+        ordinates_ptr existing = it->second.lock();
+        // Compared by their bytes, as they were hashed
+        if (existing && existing->size() == values.size()
+            && (values.empty() || std::memcmp(existing->data(), values.data(), values.size() * sizeof(double)) == 0)) {
+            return existing;
+        }
+    }
+    ordinates_ptr interned = std::make_shared<const std::vector<double>>(std::move(values));
+    vectors.emplace(key, interned);
+    sweep_if_grown();
+    return interned;
+}
+
+std::shared_ptr<const giuh_regularized_ordinates> giuh_ordinate_table::get_regularized(
+        const ordinates_ptr &cdf_times,
+        const ordinates_ptr &cdf_cumulative_freqs,
+        unsigned int regularity_seconds,
+        const std::function<giuh_regularized_ordinates()> &interpolate)
+{
+    const auto key = std::make_tuple(static_cast<const void *>(cdf_times.get()),
+                                     static_cast<const void *>(cdf_cumulative_freqs.get()), regularity_seconds);
+    {
+        std::lock_guard<std::mutex> lock(table_mutex);
+        auto found = regularized.find(key);
+        if (found != regularized.end()) {
+            std::shared_ptr<const giuh_regularized_ordinates> existing = found->second.lock();
+            if (existing) {
+                return existing;
+            }
+        }
+    }
+
+    // Interpolated without the lock, so kernels of other CDFs aren't held up; should two kernels of this one race
+    // here, the first to finish is kept
+    giuh_regularized_ordinates ordinates = interpolate();
+    ordinates.cdf_times = cdf_times;
+    ordinates.cdf_cumulative_freqs = cdf_cumulative_freqs;
+    const std::vector<double> &incremental = ordinates.interpolated_incremental_runoff;
+    ordinates.convolution_ordinates = intern(incremental.empty() ? std::vector<double>()
+                                             : std::vector<double>(incremental.begin() + 1, incremental.end()));
+    auto computed = std::make_shared<const giuh_regularized_ordinates>(std::move(ordinates));
+
+    std::lock_guard<std::mutex> lock(table_mutex);
+    std::weak_ptr<const giuh_regularized_ordinates> &entry = regularized[key];
+    std::shared_ptr<const giuh_regularized_ordinates> existing = entry.lock();
+    if (existing) {
+        return existing;
+    }
+    entry = computed;
+    sweep_if_grown();
+    return computed;
+}
+
+std::size_t giuh_ordinate_table::size()
+{
+    std::lock_guard<std::mutex> lock(table_mutex);
+    std::size_t live = 0;
+    for (const auto &entry : vectors) {
+        if (!entry.second.expired()) {
+            ++live;
+        }
+    }
+    return live;
+}
+
+std::uint64_t giuh_ordinate_table::hash(const std::vector<double> &values)
+{
+    // FNV-1a, over the bytes of the values
+    std::uint64_t h = 14695981039346656037ULL;
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(values.data());
+    for (std::size_t i = 0; i < values.size() * sizeof(double); ++i) {
+        h ^= bytes[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+void giuh_ordinate_table::sweep_if_grown()
+{
+    if (vectors.size() + regularized.size() < sweep_size) {
+        return;
+    }
+    for (auto it = vectors.begin(); it != vectors.end(); ) {
+        it = it->second.expired() ? vectors.erase(it) : std::next(it);
+    }
+    for (auto it = regularized.begin(); it != regularized.end(); ) {
+        it = it->second.expired() ? regularized.erase(it) : std::next(it);
+    }
+    sweep_size = std::max<std::size_t>(64, 2 * (vectors.size() + regularized.size()));
+}
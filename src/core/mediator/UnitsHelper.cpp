@@ -1,6 +1,8 @@
 #include "UnitsHelper.hpp"
+#include "utilities/Profiler.hpp"
 #include <cstring>
 #include <mutex>
+#include <vector>
 
 ut_system* UnitsHelper::unit_system;
 std::once_flag UnitsHelper::unit_system_inited;
@@ -55,17 +57,52 @@ std::shared_ptr<cv_converter> UnitsHelper::get_converter(const std::string& in_u
     }
 }
 
-double UnitsHelper::get_converted_value(const std::string &in_units, const double &value, const std::string &out_units)
+UnitsHelper::Converter UnitsHelper::get_units_converter(const std::string &in_units, const std::string &out_units)
 {
     if(in_units == out_units){
-        return value; // Early-out optimization
+        return Converter();
     }
     std::call_once(unit_system_inited, init_unit_system);
 
-    auto converter = get_converter(in_units, out_units);
+    return Converter(get_converter(in_units, out_units));
+}
+
+const UnitsHelper::Converter& UnitsHelper::get_recent_converter(const std::string& in_units, const std::string& out_units)
+{
+    // Callers typically alternate between a few pairs of units, e.g. one per forcing variable, so a short list
+    // searched without locking spares most calls the lock and the lookup of the shared converters
+    struct RecentConverter {
+        std::string in_units;
+        std::string out_units;
+        Converter converter;
+    };
+    static constexpr size_t RECENT_CONVERTERS = 16;
+    thread_local std::vector<RecentConverter> recent;
+    thread_local size_t next_replaced = 0;
 
-    double r = cv_convert_double(converter.get(), value);
-    return r;
+    for(const auto& r : recent){
+        if(r.in_units == in_units && r.out_units == out_units){
+            return r.converter;
+        }
+    }
+    Converter converter = get_units_converter(in_units, out_units);
+    if(recent.size() < RECENT_CONVERTERS){
+        recent.push_back(RecentConverter{in_units, out_units, std::move(converter)});
+        return recent.back().converter;
+    }
+    RecentConverter& replaced = recent[next_replaced];
+    next_replaced = (next_replaced + 1) % RECENT_CONVERTERS;
+    replaced = RecentConverter{in_units, out_units, std::move(converter)};
+    return replaced.converter;
+}
+
+double UnitsHelper::get_converted_value(const std::string &in_units, const double &value, const std::string &out_units)
+{
+    if(in_units == out_units){
+        return value; // Early-out optimization
+    }
+    NGEN_PROFILE_SCOPE("units/convert");
+    return get_recent_converter(in_units, out_units).convert(value);
 }
 
 double* UnitsHelper::convert_values(const std::string &in_units, double* in_values, const std::string &out_units, double* out_values, const size_t& count)
@@ -79,12 +116,6 @@ double* UnitsHelper::convert_values(const std::string &in_units, double* in_valu
             return out_values;
         }
     }
-    std::call_once(unit_system_inited, init_unit_system);
-    
-    auto converter = get_converter(in_units, out_units);
-
-    cv_convert_doubles(converter.get(), in_values, count, out_values);
-
-    return out_values;
+    NGEN_PROFILE_SCOPE("units/convert");
+    return get_recent_converter(in_units, out_units).convert(in_values, out_values, count);
 }
-
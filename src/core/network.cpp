@@ -6,6 +6,8 @@
 
 using namespace network;
 
+constexpr IdTable::handle_t IdTable::npos;
+
 /*
 template < typename OutputIterator >
 struct preorder_visitor : public boost::dfs_visitor<>
@@ -33,30 +35,12 @@ Network::Network( geojson::GeoJSON fabric ){
   for(auto& feature: *fabric)
   {
     feature_id = feature->get_id();
-    if( this->descriptor_map.find( feature_id ) == this->descriptor_map.end() )
-    {
-      //Haven't visited this feature yet, add it to graph
-      //get feature id and add vertex to graph
-      v1 = add_vertex( feature_id, this->graph );
-      this->descriptor_map.emplace( feature_id, v1);
-    }
-    else{
-      v1 = this->descriptor_map[ feature_id];
-    }
+    v1 = vertex_for( feature_id );
     //Add the downstream features/edges
     for( auto& downstream: feature->destination_features() )
     {
       downstream_id = downstream->get_id();
-      if( this->descriptor_map.find(downstream_id) != this->descriptor_map.end() )
-      {
-        //Use existing vertex
-        v2 = this->descriptor_map[ downstream_id ];
-      }
-      else {
-        //Create new vertex
-        v2 = add_vertex( downstream_id, this->graph );
-        this->descriptor_map.emplace( downstream_id, v2 );
-      }
+      v2 = vertex_for( downstream_id );
       //Add the edge
       add_edge(v1, v2, this->graph);
       //std::cout<<"Added edge: "<<feature_id<<" -> "<<downstream_id<<std::endl;
@@ -83,6 +67,81 @@ void Network::init_indicies(){
 
   boost::topological_sort(this->graph, std::back_inserter(this->topo_order),
                    boost::vertex_index_map(get(boost::vertex_index, this->graph)));
+
+  //The driver walks these every time step
+  get_typed_index("cat", SortOrder::Topological);
+  get_typed_index("nex", SortOrder::Topological);
+
+  init_reach_groups();
+}
+
+void Network::init_reach_groups(){
+  this->reach_groups_idx.clear();
+  this->reach_group_of_idx.assign(num_vertices(this->graph), 0);
+  //A feature continues the group of its only origination if that is its origination's only destination
+  auto continues_group = [this](Graph::vertex_descriptor v){
+    if( boost::in_degree(v, this->graph) != 1 ){
+      return false;
+    }
+    Graph::in_edge_iterator in, in_end;
+    boost::tie(in, in_end) = boost::in_edges(v, this->graph);
+    return boost::out_degree(boost::source(*in, this->graph), this->graph) == 1;
+  };
+  //topo_order is downstream first, so walk it backwards to start the groups in topological order
+  for(auto it = this->topo_order.rbegin(); it != this->topo_order.rend(); ++it)
+  {
+    if( continues_group(*it) ){
+      continue;
+    }
+    std::size_t group = this->reach_groups_idx.size();
+    this->reach_groups_idx.emplace_back();
+    NetworkIndexT& members = this->reach_groups_idx.back();
+    Graph::vertex_descriptor v = *it;
+    while( true ){
+      members.push_back(v);
+      this->reach_group_of_idx[v] = group;
+      if( boost::out_degree(v, this->graph) != 1 ){
+        break;
+      }
+      Graph::out_edge_iterator out, out_end;
+      boost::tie(out, out_end) = boost::out_edges(v, this->graph);
+      Graph::vertex_descriptor next = boost::target(*out, this->graph);
+      if( boost::in_degree(next, this->graph) != 1 ){
+        break;
+      }
+      v = next;
+    }
+  }
+}
+
+const Network::TypedIndex& Network::get_typed_index(const std::string& type, SortOrder order){
+  //std::map never moves its elements, so the list returned stays valid as other lists are added
+  std::lock_guard<std::mutex> lock(this->typed_indices_mutex.mutex);
+  auto key = std::make_pair(type, order);
+  auto found = this->typed_indices.find(key);
+  if( found != this->typed_indices.end() )
+  {
+    return found->second;
+  }
+
+  //todo need to worry about validating input???
+  //if type isn't found as a prefix, the lists are empty, which is a reasonable semantic
+  TypedIndex& index = this->typed_indices[key];
+  const NetworkIndexT& sorted = get_sorted_index(order);
+  for(auto it = sorted.rbegin(); it != sorted.rend(); ++it)
+  {
+    const std::string& id = get(boost::vertex_name, this->graph)[*it];
+    bool matches = id.compare(0, 3, type) == 0;
+    if( type == "nex" && !matches ){
+      matches = id.compare(0, 3, "tnx") == 0;
+    }
+    if( matches )
+    {
+      index.handles.push_back(*it);
+      index.ids.push_back(id);
+    }
+  }
+  return index;
 }
 
 Network::Network( geojson::GeoJSON features, std::string* link_key = nullptr ){
@@ -94,28 +153,12 @@ Network::Network( geojson::GeoJSON features, std::string* link_key = nullptr ){
   for(auto& feature: *features)
   {
     feature_id = feature->get_id();
-    if( this->descriptor_map.find( feature_id ) == this->descriptor_map.end() )
-    {
-      //Haven't visited this feature yet, add it to graph
-      //add vertex to graph
-      v1 = add_vertex( feature_id, this->graph );
-      this->descriptor_map.emplace( feature_id, v1 );
-    }
-    else{
-      v1 = this->descriptor_map[ feature_id ];
-    }
+    v1 = vertex_for( feature_id );
 
       if (link_key != nullptr and feature->has_property(*link_key)) {
 
           downstream_id = feature->get_property(*link_key).as_string();
-          if( this->descriptor_map.find(downstream_id) != this->descriptor_map.end() )
-          {
-            v2 = this->descriptor_map[ downstream_id ];
-          }
-          else {
-            v2 = add_vertex( downstream_id, this->graph );
-            this->descriptor_map.emplace( downstream_id, v2 );
-          }
+          v2 = vertex_for( downstream_id );
             add_edge(v1, v2, this->graph);
       }
   }
@@ -154,29 +197,123 @@ std::size_t Network::size(){
   return num_vertices(this->graph);
 }
 
+std::size_t Network::get_memory_bytes() const{
+  std::lock_guard<std::mutex> lock(this->typed_indices_mutex.mutex);
+  //Each vertex holds its properties and edge sets, and each edge a node in the out edges of its source and in the in
+  //edges of its target
+  std::size_t bytes = num_vertices(this->graph) * sizeof(Graph::stored_vertex)
+                    + num_edges(this->graph) * 2 * (sizeof(Graph::vertex_descriptor) + 4 * sizeof(void*));
+  for(Graph::vertex_descriptor v = 0; v < num_vertices(this->graph); ++v){
+    const std::string& id = boost::get(boost::vertex_name, this->graph, v);
+    bytes += id.capacity() > std::string().capacity() ? id.capacity() + 1 : 0;
+  }
+  std::size_t index_handles = topo_order.capacity() + tdfp_order.capacity() + headwaters_idx.capacity()
+                            + tailwaters_idx.capacity() + reach_group_of_idx.capacity();
+  for(const NetworkIndexT& group : reach_groups_idx){
+    index_handles += group.capacity();
+  }
+  bytes += index_handles * sizeof(Graph::vertex_descriptor) + ids.get_memory_bytes();
+  for(const auto& typed : typed_indices){
+    bytes += typed.second.handles.capacity() * sizeof(Graph::vertex_descriptor)
+           + typed.second.ids.capacity() * sizeof(std::string);
+    for(const std::string& id : typed.second.ids){
+      bytes += id.capacity() > std::string().capacity() ? id.capacity() + 1 : 0;
+    }
+  }
+  return bytes;
+}
+
+Graph::vertex_descriptor Network::vertex_for(const std::string& id){
+  Graph::vertex_descriptor v = this->ids.find( id );
+  if( v == IdTable::npos )
+  {
+    //Haven't visited this feature yet, add it to graph
+    //vertices are numbered in the order they are added, just as the id table numbers handles
+    v = add_vertex( id, this->graph );
+    this->ids.intern( id );
+  }
+  return v;
+}
+
 std::vector<std::string> Network::get_origination_ids(std::string id){
-  Graph::in_edge_iterator begin, end;
-  boost::tie(begin, end) = boost::in_edges (this->descriptor_map[id], this->graph);
   std::vector<std::string> ids;
-  for(auto it = begin; it != end; ++it)
+  Graph::vertex_descriptor v = this->ids.find( id );
+  if( v == IdTable::npos )
+  {
+    return ids;
+  }
+  for(const auto& handle : get_origination_handles( v ))
   {
-    ids.push_back( get_id(boost::source(*it, this->graph)) );
+    ids.push_back( get_id( handle ) );
   }
   return ids;
 }
 
+std::vector<std::string> Network::get_upstream_ids(const std::vector<std::string>& ids){
+  std::vector<bool> reached(boost::num_vertices(this->graph), false);
+  NetworkIndexT pending;
+  for(const std::string& id : ids)
+  {
+    Graph::vertex_descriptor v = this->ids.find( id );
+    if( v != IdTable::npos && !reached[v] )
+    {
+      reached[v] = true;
+      pending.push_back( v );
+    }
+  }
+  std::vector<std::string> upstream_ids;
+  for(std::size_t i = 0; i < pending.size(); ++i)
+  {
+    upstream_ids.push_back( get_id( pending[i] ) );
+    for(const auto& handle : get_origination_handles( pending[i] ))
+    {
+      if( !reached[handle] )
+      {
+        reached[handle] = true;
+        pending.push_back( handle );
+      }
+    }
+  }
+  return upstream_ids;
+}
+
 std::vector<std::string> Network::get_destination_ids(std::string id){
-  Graph::out_edge_iterator begin, end;
-  boost::tie(begin, end) = boost::out_edges (this->descriptor_map[id], this->graph);
   std::vector<std::string> ids;
-  for(auto it = begin; it != end; ++it)
+  Graph::vertex_descriptor v = this->ids.find( id );
+  if( v == IdTable::npos )
   {
-    ids.push_back( get_id(boost::target(*it, this->graph)) );
+    return ids;
+  }
+  for(const auto& handle : get_destination_handles( v ))
+  {
+    ids.push_back( get_id( handle ) );
   }
 
   return ids;
 }
 
+NetworkIndexT Network::get_origination_handles(Graph::vertex_descriptor handle) const{
+  Graph::in_edge_iterator begin, end;
+  boost::tie(begin, end) = boost::in_edges (handle, this->graph);
+  NetworkIndexT handles;
+  for(auto it = begin; it != end; ++it)
+  {
+    handles.push_back( boost::source(*it, this->graph) );
+  }
+  return handles;
+}
+
+NetworkIndexT Network::get_destination_handles(Graph::vertex_descriptor handle) const{
+  Graph::out_edge_iterator begin, end;
+  boost::tie(begin, end) = boost::out_edges (handle, this->graph);
+  NetworkIndexT handles;
+  for(auto it = begin; it != end; ++it)
+  {
+    handles.push_back( boost::target(*it, this->graph) );
+  }
+  return handles;
+}
+
 const NetworkIndexT& Network::get_sorted_index(SortOrder order, bool cache){
   if (order == SortOrder::TransposedDepthFirstPreorder) {
     if (!this->tdfp_order.empty()){
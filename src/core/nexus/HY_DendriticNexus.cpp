@@ -0,0 +1,121 @@
+#include "HY_DendriticNexus.hpp"
+
+#include <boost/exception/all.hpp>
+#include <MemoryReport.hpp>
+
+namespace {
+    struct invalid_downstream_request : public boost::exception, public std::exception
+    {
+      const char *what() const noexcept { return "All downstream catchments can not request more than 100% of flux in total"; }
+    };
+
+    struct add_to_summed_nexus : public boost::exception, public std::exception
+    {
+      const char *what() const noexcept { return "Can not add water to a summed point nexus"; }
+    };
+
+    struct request_from_empty_nexus : public boost::exception, public std::exception
+    {
+      const char *what() const noexcept { return "Can not release water from an empty nexus"; }
+    };
+
+    struct completed_time_step : public boost::exception, public std::exception
+    {
+      const char *what() const noexcept { return "Can not operate on a completed time step"; }
+    };
+
+    struct invalid_time_step : public boost::exception, public std::exception
+    {
+      const char *what() const noexcept { return "Time step before minimum time step requested"; }
+    };
+}
+
+HY_DendriticNexus::HY_DendriticNexus(std::string nexus_id, Catchments receiving_catchments) : HY_HydroNexus( nexus_id, receiving_catchments)
+{
+
+}
+
+HY_DendriticNexus::~HY_DendriticNexus()
+{
+    //dtor
+}
+
+double HY_DendriticNexus::get_downstream_flow(std::string /*catchment_id*/, time_step_t t, double percent_flow)
+{
+    std::lock_guard<std::mutex> lock(bookkeeping_mutex);
+
+    if ( t < slots.get_mintime() ) BOOST_THROW_EXCEPTION(invalid_time_step());
+    if ( slots.is_completed(t) ) BOOST_THROW_EXCEPTION(completed_time_step());
+    if ( percent_flow > 100.0 ) BOOST_THROW_EXCEPTION(invalid_downstream_request());
+
+    TimeStepSlot* slot = slots.find(t);
+    if ( slot == nullptr ) BOOST_THROW_EXCEPTION(request_from_empty_nexus());
+    if ( slot->num_requests > 0 && slot->total_request + percent_flow > 100.0 )
+    {
+        BOOST_THROW_EXCEPTION(invalid_downstream_request());
+    }
+
+    slot->total_request += percent_flow;
+    ++slot->num_requests;
+
+    double released_flux = slot->summed_flow * (percent_flow / 100.0);
+
+    if ( 100.0 - slot->total_request < 0.00005 )
+    {
+        slots.complete(*slot);
+    }
+
+    return released_flux;
+}
+
+void HY_DendriticNexus::add_upstream_flow(double val, std::string /*catchment_id*/, time_step_t t)
+{
+    std::lock_guard<std::mutex> lock(bookkeeping_mutex);
+    if ( t < slots.get_mintime() ) BOOST_THROW_EXCEPTION(invalid_time_step());
+    if ( slots.is_completed(t) ) BOOST_THROW_EXCEPTION(completed_time_step());
+
+    TimeStepSlot& slot = slots.claim(t);
+    if ( slot.num_requests > 0 ) BOOST_THROW_EXCEPTION(add_to_summed_nexus());
+
+    slot.summed_flow += val;
+    ++slot.num_upstream;
+}
+
+std::pair<double, int> HY_DendriticNexus::inspect_upstream_flows(time_step_t t)
+{
+    std::lock_guard<std::mutex> lock(bookkeeping_mutex);
+    TimeStepSlot* slot = slots.find(t);
+    if ( slot == nullptr || slot->state != TimeStepSlot::OPEN )
+    {
+        return std::pair<double, int>(0.0, 0);
+    }
+    return std::pair<double, int>(slot->summed_flow, slot->num_upstream);
+}
+
+std::pair<double, int> HY_DendriticNexus::inspect_downstream_requests(time_step_t t)
+{
+    std::lock_guard<std::mutex> lock(bookkeeping_mutex);
+    TimeStepSlot* slot = slots.find(t);
+    if ( slot == nullptr || slot->state != TimeStepSlot::OPEN || slot->num_requests == 0 )
+    {
+        return std::pair<double, int>(0.0, 0);
+    }
+    return std::pair<double, int>(slot->total_request, slot->num_requests);
+}
+
+std::string HY_DendriticNexus::get_flow_units()
+{
+    return std::string("m3/s");
+}
+
+void HY_DendriticNexus::set_mintime(time_step_t t)
+{
+    std::lock_guard<std::mutex> lock(bookkeeping_mutex);
+    slots.set_mintime(t);
+}
+
+std::size_t HY_DendriticNexus::get_memory_bytes()
+{
+    std::lock_guard<std::mutex> lock(bookkeeping_mutex);
+    return sizeof(*this) + utils::MemoryReport::bytes_of(slots.get_slots());
+}
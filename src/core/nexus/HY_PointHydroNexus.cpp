@@ -1,6 +1,7 @@
 #include "HY_PointHydroNexus.hpp"
 
 #include <boost/exception/all.hpp>
+#include <MemoryReport.hpp>
 
 typedef boost::error_info<struct tag_errmsg, std::string> errmsg_info;
 
@@ -29,12 +30,19 @@ struct invalid_time_step : public boost::exception, public std::exception
   const char *what() const noexcept { return "Time step before minimum time step requested"; }
 };
 
-HY_PointHydroNexus::HY_PointHydroNexus(std::string nexus_id, Catchments receiving_catchments) : HY_HydroNexus( nexus_id, receiving_catchments), upstream_flows()
+namespace {
+    /** Slots in a new ring; enough for the time steps in progress at once when running one step at a time. */
+    const std::size_t INITIAL_SLOTS = 4;
+}
+
+HY_PointHydroNexus::HY_PointHydroNexus(std::string nexus_id, Catchments receiving_catchments) : HY_HydroNexus( nexus_id, receiving_catchments), slots(INITIAL_SLOTS)
 {
 
 }
 
-HY_PointHydroNexus::HY_PointHydroNexus(std::string nexus_id, Catchments receiving_catchments, Catchments contributing_catchments) : HY_HydroNexus( nexus_id, receiving_catchments, contributing_catchments), upstream_flows()
+HY_PointHydroNexus::HY_PointHydroNexus(std::string nexus_id, Catchments receiving_catchments, Catchments contributing_catchments) : HY_HydroNexus( nexus_id, receiving_catchments, contributing_catchments),
+    // Contributors are known up front, so size each slot for them before the first time step
+    slots(INITIAL_SLOTS, TimeStepFlows{flow_vector(contributing_catchments.size())})
 {
 
 }
@@ -44,13 +52,50 @@ HY_PointHydroNexus::~HY_PointHydroNexus()
     //dtor
 }
 
+bool HY_PointHydroNexus::has_upstream_flows_from(const Catchments& catchment_ids, time_step_t t)
+{
+    std::lock_guard<std::mutex> lock(bookkeeping_mutex);
+    TimeStepSlot* slot = slots.find(t);
+    for ( auto& id : catchment_ids )
+    {
+        bool found = false;
+        for ( std::size_t i = 0; slot != nullptr && i < slot->num_upstream && !found; ++i )
+        {
+            found = slot->upstream[i].first == id;
+        }
+        if ( !found ) return false;
+    }
+    return true;
+}
+
+double HY_PointHydroNexus::sum_upstream_flows(const TimeStepSlot& slot)
+{
+    if ( is_exact_summation )
+    {
+        exact_sum.clear();
+        for ( std::size_t i = 0; i < slot.num_upstream; ++i )
+        {
+            exact_sum.add(slot.upstream[i].second);
+        }
+        return exact_sum.get_sum();
+    }
+
+    double sum {};
+    for ( std::size_t i = 0; i < slot.num_upstream; ++i )
+    {
+        sum += slot.upstream[i].second;
+    }
+    return sum;
+}
+
 double HY_PointHydroNexus::get_downstream_flow(std::string catchment_id, time_step_t t, double percent_flow)
 {
+    std::lock_guard<std::mutex> lock(bookkeeping_mutex);
 
-    if ( t < min_timestep ) BOOST_THROW_EXCEPTION(invalid_time_step());
-    if ( completed.find(t) != completed.end() ) BOOST_THROW_EXCEPTION(completed_time_step());
+    if ( t < slots.get_mintime() ) BOOST_THROW_EXCEPTION(invalid_time_step());
+    if ( slots.is_completed(t) ) BOOST_THROW_EXCEPTION(completed_time_step());
 
-    auto s1 = upstream_flows.find(t);
+    TimeStepSlot* slot = slots.find(t);
 
     if ( percent_flow > 100.0)
     {
@@ -58,157 +103,113 @@ double HY_PointHydroNexus::get_downstream_flow(std::string catchment_id, time_st
 
         BOOST_THROW_EXCEPTION(invalid_downstream_request());
     }
-    else if ( s1 == upstream_flows.end() )
+    else if ( slot == nullptr )
     {
         // there are no recorded flows for this time.
         // throw exception
 
         BOOST_THROW_EXCEPTION(request_from_empty_nexus() );
     }
-    else
-    {
-        auto s2 = summed_flows.find(t);
 
-        if ( s2 == summed_flows.end() )
-        {
-            // the flows have not been summed calculate the sum
-            // and store it into summed_flows
-            double sum {};
-            for(auto& n : s1->second )
-            {
-                sum += n.second;
-            }
-
-            summed_flows[t] = sum;
+    if ( !slot->summed )
+    {
+        // the flows have not been summed calculate the sum
+        // and store it into the slot
+        slot->summed_flow = sum_upstream_flows(*slot);
+        slot->summed = true;
+    }
+    else if ( slot->total_request + percent_flow > 100.0 )
+    {
+        // flows have been summed so some water has allready been release
+        // if the amount of flow allready released plus the amount
+        // of this release is greater than 100 throw an error
+        BOOST_THROW_EXCEPTION(invalid_downstream_request());
+    }
 
-            // mark downstream request with the amount of flow requested
-            // and the catchment making the request
+    // update the total_request for this timestep
+    slot->total_request += percent_flow;
 
-            flow_vector v;
-            v.push_back(flows(catchment_id,percent_flow));
-            downstream_requests[t] = v;
+    // mark downstream request with the amount of flow requested
+    // and the catchment making the request
+    if ( slot->num_requests < slot->requests.size() )
+    {
+        slot->requests[slot->num_requests].first.assign(catchment_id);
+        slot->requests[slot->num_requests].second = percent_flow;
+    }
+    else
+    {
+        slot->requests.emplace_back(catchment_id, percent_flow);
+    }
+    ++slot->num_requests;
 
-            // record the total requests for this time
-            total_requests[t] = percent_flow;
+    // release flux
+    double released_flux = slot->summed_flow * (percent_flow / 100.0);
 
-            // release flux
-            return sum * (percent_flow / 100);
-        }
-        else
-        {
-            // flows have been summed so some water has allready been release
-
-            if ( total_requests[t] + percent_flow > 100.0 )
-            {
-                    // if the amount of flow allready released plus the amount
-                    // of this release is greater than 100 throw an error
-                    BOOST_THROW_EXCEPTION(invalid_downstream_request());
-            }
-            else
-            {
-                // update the total_request for this timesteo
-                total_requests[t] += percent_flow;
-
-                // add this request to recorded downstream requests
-                downstream_requests[t].push_back(flows(catchment_id,percent_flow));
-
-                double released_flux = summed_flows[t] * (percent_flow / 100.0);
-
-                if (100.0 - total_requests[t] < 0.00005 )
-                {
-                    // all water has been requested remove bookeeping
-
-                    upstream_flows.erase(upstream_flows.find(t));
-                    downstream_requests.erase(downstream_requests.find(t));
-                    summed_flows.erase(summed_flows.find(t));
-                    total_requests.erase(total_requests.find(t));
-
-                    completed.emplace(t);
-                }
-
-                return released_flux;
-            }
-        }
+    if (100.0 - slot->total_request < 0.00005 )
+    {
+        // all water has been requested remove bookeeping
+        slots.complete(*slot);
     }
+
+    return released_flux;
 }
 
 void HY_PointHydroNexus::add_upstream_flow(double val, std::string catchment_id, time_step_t t)
 {
-     if ( t < min_timestep ) BOOST_THROW_EXCEPTION(invalid_time_step());
-    if ( completed.find(t) != completed.end() ) BOOST_THROW_EXCEPTION(completed_time_step());
+    std::lock_guard<std::mutex> lock(bookkeeping_mutex);
+    if ( t < slots.get_mintime() ) BOOST_THROW_EXCEPTION(invalid_time_step());
+    if ( slots.is_completed(t) ) BOOST_THROW_EXCEPTION(completed_time_step());
 
-    auto s1 = upstream_flows.find(t);
-    if (  s1 == upstream_flows.end() )
+    TimeStepSlot& slot = slots.claim(t);
+    if ( slot.summed )
     {
-        // case 1 there are no upstream flow for this time
-        // create a new vector of flow id pairs and add the current flow
-        // and catchment id to the vector then insert the vector
+        // summed flows exist we can not add water for a time step when
+        // one or more catchments have made downstream requests
 
-        flow_vector v;
-        v.push_back(flows(catchment_id,val));
-         upstream_flows[t] = v;
+        BOOST_THROW_EXCEPTION(add_to_summed_nexus());
+    }
+
+    // there have been no downstream request and we can add water
+    if ( slot.num_upstream < slot.upstream.size() )
+    {
+        slot.upstream[slot.num_upstream].first.assign(catchment_id);
+        slot.upstream[slot.num_upstream].second = val;
     }
     else
     {
-        auto s2 = summed_flows.find(t);
-
-        if ( s2 == summed_flows.end() )
-        {
-            // case 2 there are no summed flow for the time
-            // this means there have been no downstream request and we can add water
-
-             s1->second.push_back(flows(catchment_id,val));
-        }
-        else
-        {
-            // case 3 summed flows exist we can not add water for a time step when
-            // one or more catchments have made downstream requests
-
-             BOOST_THROW_EXCEPTION(add_to_summed_nexus());
-         }
+        slot.upstream.emplace_back(catchment_id, val);
     }
+    ++slot.num_upstream;
 }
 
 std::pair<double, int> HY_PointHydroNexus::inspect_upstream_flows(time_step_t t)
 {
-    auto s1 = upstream_flows.find(t);
-    if ( s1 == upstream_flows.end() )
+    std::lock_guard<std::mutex> lock(bookkeeping_mutex);
+    TimeStepSlot* slot = slots.find(t);
+    if ( slot == nullptr || slot->state != TimeStepSlot::OPEN )
     {
         return std::pair<double,long>(0.0, 0);
     }
-    else
-    {
-        double total_upstream_flows = 0.0;
 
-        auto& id_flow_vector = s1->second;
-        for (auto& p : id_flow_vector )
-        {
-            total_upstream_flows += p.second;
-        }
-
-        return std::pair<double, long>(total_upstream_flows, id_flow_vector.size() );
-    }
+    return std::pair<double, long>(sum_upstream_flows(*slot), slot->num_upstream );
 }
 
 std::pair<double, int> HY_PointHydroNexus::inspect_downstream_requests(time_step_t t)
 {
-    auto s1 = downstream_requests.find(t);
-    if ( s1 == downstream_requests.end() )
+    std::lock_guard<std::mutex> lock(bookkeeping_mutex);
+    TimeStepSlot* slot = slots.find(t);
+    if ( slot == nullptr || slot->state != TimeStepSlot::OPEN || slot->num_requests == 0 )
     {
         return std::pair<double,long>(0.0, 0);
     }
-    else
-    {
-        double total_downstream_requests = 0.0;
 
-        auto& id_request_vector = s1->second;
-        for (auto& p : id_request_vector )
-        {
-            total_downstream_requests += p.second;
-        }
-
-        return std::pair<double, long>(total_downstream_requests, id_request_vector.size() );
+    double total_downstream_requests = 0.0;
+    for ( std::size_t i = 0; i < slot->num_requests; ++i )
+    {
+        total_downstream_requests += slot->requests[i].second;
     }
+
+    return std::pair<double, long>(total_downstream_requests, slot->num_requests );
 }
 
 std::string HY_PointHydroNexus::get_flow_units()
@@ -218,45 +219,31 @@ std::string HY_PointHydroNexus::get_flow_units()
 
 void HY_PointHydroNexus::set_mintime(time_step_t t)
 {
-    min_timestep = t;
+    std::lock_guard<std::mutex> lock(bookkeeping_mutex);
+    slots.set_mintime(t);
+}
 
-    // remove expired time steps from completed
-    for( auto& t: completed)
-    {
-        if ( t < min_timestep )
-        {
-            completed.erase(t);
-        }
-    }
+void HY_PointHydroNexus::set_exact_summation(bool is_exact)
+{
+    std::lock_guard<std::mutex> lock(bookkeeping_mutex);
+    is_exact_summation = is_exact;
+}
 
-    // C++ 2014 would allow this do be done with a single lambda
-    auto l1 = [](int min_v, std::unordered_map<long,flow_vector>& v)
+std::size_t HY_PointHydroNexus::get_memory_bytes()
+{
+    std::lock_guard<std::mutex> lock(bookkeeping_mutex);
+    std::size_t bytes = sizeof(*this) + utils::MemoryReport::bytes_of(slots.get_slots());
+    for ( const auto& slot : slots.get_slots() )
     {
-        for( auto& t: v)
+        bytes += utils::MemoryReport::bytes_of(slot.upstream) + utils::MemoryReport::bytes_of(slot.requests);
+        for ( const auto& flow : slot.upstream )
         {
-            if ( t.first < min_v )
-            {
-                v.erase(t.first);
-            }
+            bytes += utils::MemoryReport::bytes_of(flow.first);
         }
-    };
-
-    // C++ 2014 would allow this do be done with a single lambda
-    auto l2 = [](int min_v, std::unordered_map<long,double>& v)
-    {
-        for( auto& t: v)
+        for ( const auto& flow : slot.requests )
         {
-            if ( t.first < min_v )
-            {
-                v.erase(t.first);
-            }
+            bytes += utils::MemoryReport::bytes_of(flow.first);
         }
-    };
-
-    // remove expired time steps from all maps
-    l1(min_timestep,downstream_requests);
-    l1(min_timestep,upstream_flows);
-    l2(min_timestep,summed_flows);
-    l2(min_timestep,total_requests);
-
+    }
+    return bytes;
 }
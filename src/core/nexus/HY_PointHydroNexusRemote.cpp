@@ -5,7 +5,9 @@
 #ifdef NGEN_MPI_ACTIVE
 
 #include <chrono>
+#include <iostream>
 #include <thread>
+#include <utility>
 
 // TODO add loggin to this function
 
@@ -21,19 +23,27 @@ void MPI_Handle_Error(int status)
     }
 }
 
-HY_PointHydroNexusRemote::HY_PointHydroNexusRemote(std::string nexus_id, Catchments receiving_catchments, Catchments contributing_catchments, catcment_location_map_t loc_map)
-    : HY_PointHydroNexus(nexus_id, receiving_catchments, contributing_catchments),
-        catchment_id_to_mpi_rank(loc_map)
+MPI_Datatype HY_PointHydroNexusRemote::get_time_step_and_flow_type()
 {
-   int count = 3;
-   const int array_of_blocklengths[3] = { 1, 1, 1};
-   const MPI_Aint array_of_displacements[3] = { 0, sizeof(long), sizeof(long) + sizeof(long) };
-   const MPI_Datatype array_of_types[3] = { MPI_LONG, MPI_LONG, MPI_DOUBLE };
-
-   MPI_Type_create_struct(count, array_of_blocklengths, array_of_displacements, array_of_types, &time_step_and_flow_type);
-
-   MPI_Type_commit(&time_step_and_flow_type);
+   // Created and committed once, on first use, and shared by every nexus
+   static const MPI_Datatype time_step_and_flow_type = []() {
+      int count = 3;
+      const int array_of_blocklengths[3] = { 1, 1, 1};
+      const MPI_Aint array_of_displacements[3] = { 0, sizeof(long), sizeof(long) + sizeof(long) };
+      const MPI_Datatype array_of_types[3] = { MPI_LONG, MPI_LONG, MPI_DOUBLE };
+
+      MPI_Datatype type;
+      MPI_Type_create_struct(count, array_of_blocklengths, array_of_displacements, array_of_types, &type);
+      MPI_Type_commit(&type);
+      return type;
+   }();
+   return time_step_and_flow_type;
+}
 
+HY_PointHydroNexusRemote::HY_PointHydroNexusRemote(std::string nexus_id, Catchments receiving_catchments, Catchments contributing_catchments, location_index_t loc_index)
+    : HY_PointHydroNexus(nexus_id, receiving_catchments, contributing_catchments),
+        catchment_id_to_mpi_rank(std::move(loc_index))
+{
    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
 
    bool is_sender = false;
@@ -41,31 +51,27 @@ HY_PointHydroNexusRemote::HY_PointHydroNexusRemote(std::string nexus_id, Catchme
    //Establish the communication pattern required for this nexus
    //Sender
    for(auto receiver : get_receiving_catchments()){
-       //Loop through all downstream catchments, see if they are in the remote map
-       try{
-            auto& remote_rank = catchment_id_to_mpi_rank.at(receiver);
-            downstream_ranks.insert(remote_rank);
-            remote_receivers.push_back(receiver);
-            is_sender = true;
-       }
-       catch( std::out_of_range &e ){
+       //Loop through all downstream catchments, see if they are in the remote index
+       auto handle = catchment_id_to_mpi_rank->find(receiver);
+       if( handle == RemoteLocationIndex::npos ){
            local_receivers.push_back(receiver);
            continue; //receiver not found, go to next
        }
+       downstream_ranks.insert(catchment_id_to_mpi_rank->rank_at(handle));
+       remote_receivers.push_back(receiver);
+       is_sender = true;
     }
 
     for(auto contributer : get_contributing_catchments()){
-        //Loop through all upstream catchments, see if they are in the remote map
-        try{
-            auto& remote_rank = catchment_id_to_mpi_rank.at(contributer);
-            upstream_ranks.insert(remote_rank);
-            remote_contributers.push_back(contributer);
-            is_receiver = true;
-        }
-        catch( std::out_of_range &e ){
+        //Loop through all upstream catchments, see if they are in the remote index
+        auto handle = catchment_id_to_mpi_rank->find(contributer);
+        if( handle == RemoteLocationIndex::npos ){
             local_contributers.push_back(contributer);
             continue; //contributer not found, go to next
         }
+        upstream_ranks.insert(catchment_id_to_mpi_rank->rank_at(handle));
+        remote_contributers.push_back(contributer);
+        is_receiver = true;
     }
 
     if( is_sender && !is_receiver ){
@@ -83,37 +89,106 @@ HY_PointHydroNexusRemote::HY_PointHydroNexusRemote(std::string nexus_id, Catchme
 
 }
 
-HY_PointHydroNexusRemote::HY_PointHydroNexusRemote(std::string nexus_id, Catchments receiving_catchments, catcment_location_map_t loc_map)
-    : HY_PointHydroNexusRemote(nexus_id, receiving_catchments, Catchments(), loc_map)
+HY_PointHydroNexusRemote::HY_PointHydroNexusRemote(std::string nexus_id, Catchments receiving_catchments, location_index_t loc_index)
+    : HY_PointHydroNexusRemote(nexus_id, receiving_catchments, Catchments(), std::move(loc_index))
 {
    
 }
 
-HY_PointHydroNexusRemote::~HY_PointHydroNexusRemote()
+HY_PointHydroNexusRemote::HY_PointHydroNexusRemote(std::string nexus_id, Catchments receiving_catchments, Catchments contributing_catchments, const catcment_location_map_t& loc_map)
+    : HY_PointHydroNexusRemote(nexus_id, receiving_catchments, contributing_catchments, RemoteLocationIndex::make(loc_map))
+{
+
+}
+
+HY_PointHydroNexusRemote::HY_PointHydroNexusRemote(std::string nexus_id, Catchments receiving_catchments, const catcment_location_map_t& loc_map)
+    : HY_PointHydroNexusRemote(nexus_id, receiving_catchments, Catchments(), RemoteLocationIndex::make(loc_map))
 {
-    long wait_time = 0;
 
+}
+
+HY_PointHydroNexusRemote::~HY_PointHydroNexusRemote()
+{
     // This destructore might be called after MPI_Finalize so do not attempt communication if
     // this has occured
     int mpi_finalized;
     MPI_Finalized(&mpi_finalized);
 
-    while ( (stored_recieves.size() > 0 || stored_sends.size() > 0) && !mpi_finalized )
+    // Normally everything was already drained at the end of the run; don't wait again on what a drain gave up on
+    if ( (stored_recieves.size() > 0 || stored_sends.size() > 0) && !mpi_finalized && !drain_timed_out )
     {
-        //std::cerr << "Neuxs with rank " << id << " has pending communications\n";
+        drain_communications({this});
+    }
+}
 
-        process_communications();
+bool HY_PointHydroNexusRemote::drain_communications(const std::vector<HY_PointHydroNexusRemote*>& nexuses,
+                                                    std::chrono::milliseconds timeout)
+{
+    // Gather the requests of every nexus into one set, remembering where each came from so completed ones can be
+    // handed back to their nexus
+    std::vector<MPI_Request> requests;
+    std::vector<MPI_Request*> origins;
+    for ( HY_PointHydroNexusRemote* nexus : nexuses )
+    {
+        for ( auto& request : nexus->stored_recieves )
+        {
+            requests.push_back(request.mpi_request);
+            origins.push_back(&request.mpi_request);
+        }
+        for ( auto& request : nexus->stored_sends )
+        {
+            requests.push_back(request.mpi_request);
+            origins.push_back(&request.mpi_request);
+        }
+    }
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    // MPI_Waitall can't be bounded, so progress the whole set with MPI_Testsome until it is done or time is up
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    std::vector<int> completed(requests.size());
+    int outcount = 0;
+    while ( !requests.empty() )
+    {
+        MPI_Handle_Error( MPI_Testsome(requests.size(), requests.data(), &outcount, completed.data(), MPI_STATUSES_IGNORE) );
+        if ( outcount == MPI_UNDEFINED || std::chrono::steady_clock::now() >= deadline )
+        {
+            break;
+        }
+        if ( outcount == 0 )
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
 
-        wait_time += 1;
+    // Completed requests are now null, which process_communications takes as complete, adding any received flows
+    for ( std::size_t i = 0; i < requests.size(); ++i )
+    {
+        *origins[i] = requests[i];
+    }
 
-        if ( wait_time > 120000 )
+    bool all_completed = true;
+    for ( HY_PointHydroNexusRemote* nexus : nexuses )
+    {
+        nexus->process_communications();
+        if ( nexus->stored_recieves.empty() && nexus->stored_sends.empty() )
         {
-            // TODO log warning message that some comunications could not complete
-
+            continue;
         }
+        all_completed = false;
+        nexus->drain_timed_out = true;
+        std::cerr << "Nexus " << nexus->id << " on rank " << nexus->world_rank << " did not complete its communications within "
+                  << timeout.count() << " ms: " << nexus->stored_recieves.size() << " receive(s) from rank(s)";
+        for ( int rank : nexus->upstream_ranks )
+        {
+            std::cerr << " " << rank;
+        }
+        std::cerr << ", " << nexus->stored_sends.size() << " send(s) to rank(s)";
+        for ( int rank : nexus->downstream_ranks )
+        {
+            std::cerr << " " << rank;
+        }
+        std::cerr << std::endl;
     }
+    return all_completed;
 }
 
 double HY_PointHydroNexusRemote::get_downstream_flow(std::string catchment_id, time_step_t t, double percent_flow)
@@ -127,7 +202,7 @@ double HY_PointHydroNexusRemote::get_downstream_flow(std::string catchment_id, t
         std::string msg = "Nexus "+id+" attempted to get_downstream_flow, but its communicator type is sender only.";
         throw std::runtime_error(msg);
     }
-    else if ( type == receiver || type == sender_receiver )
+    else if ( exchange == nullptr && ( type == receiver || type == sender_receiver ) )
     {
     	for ( int rank : upstream_ranks )
     	{
@@ -142,7 +217,7 @@ double HY_PointHydroNexusRemote::get_downstream_flow(std::string catchment_id, t
        		status = MPI_Irecv(
           		stored_recieves.back().buffer.get(),
           		1,
-          		time_step_and_flow_type,
+          		get_time_step_and_flow_type(),
           		rank,
           		tag,
           		MPI_COMM_WORLD,
@@ -172,23 +247,17 @@ void HY_PointHydroNexusRemote::add_upstream_flow(double val, std::string catchme
 	// if we are a sender check to see if all of our upstreams have been added for the indicated time step
 	if ( type == sender || type  == sender_receiver )
 	{
-		auto& flows_for_timestep = upstream_flows[t];
-		bool all_found = true;
-		
 		// check for stored data for each contributer
-		for ( auto& id : get_local_contributing_catchments() )
+		bool all_found = has_upstream_flows_from(get_local_contributing_catchments(), t);
+		
+		// if we have all of our upstreams for this time step, and the data is batched, just stage it
+		if ( all_found && exchange != nullptr )
 		{
-			auto pos = std::find_if(flows_for_timestep.begin(), flows_for_timestep.end(), [&id] (flows& v) { return v.first == id; } );
-			
-			if ( pos == flows_for_timestep.end() )
-			{
-				all_found = false;
-				break;
-			}
+		    // get the correct amount of flow using the inherted function this means are local bookkeeping is accurate
+		    exchange->stage_flow(id, t, HY_PointHydroNexus::get_downstream_flow(id, t, 100.0));
 		}
-		
-		// if we have all of our upstreams for this time step send the data
-		if ( all_found )
+		// otherwise if we have all of our upstreams for this time step send the data
+		else if ( all_found )
 		{
 		    // allocate the message buffer
 		    stored_sends.resize(stored_sends.size() + 1);
@@ -207,7 +276,7 @@ void HY_PointHydroNexusRemote::add_upstream_flow(double val, std::string catchme
 		    MPI_Isend(
 		        stored_sends.back().buffer.get(),
 		        1,
-		        time_step_and_flow_type,
+		        get_time_step_and_flow_type(),
 		        *downstream_ranks.begin(), //TODO currently only support a SINGLE downstream message pairing
 		        tag,
 		        MPI_COMM_WORLD,
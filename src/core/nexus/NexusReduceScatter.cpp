@@ -0,0 +1,99 @@
+#include "NexusReduceScatter.hpp"
+
+#ifdef NGEN_MPI_ACTIVE
+
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+NexusReduceScatter::NexusReduceScatter(const std::vector<std::string>& local_nexus_ids, std::size_t chunk_steps,
+                                       MPI_Comm comm) : steps(chunk_steps)
+{
+    if (chunk_steps < 1) {
+        throw std::invalid_argument("A nexus reduction needs at least one time step per chunk");
+    }
+    MPI_Comm_dup(comm, &this->comm);
+    int rank, num_procs;
+    MPI_Comm_rank(this->comm, &rank);
+    MPI_Comm_size(this->comm, &num_procs);
+
+    // Gather the nexus ids of every rank, each ended by a '\0', so every rank indexes the same sorted set of them
+    std::string local_chars;
+    for (const std::string& id : local_nexus_ids) {
+        local_chars += id;
+        local_chars.push_back('\0');
+    }
+    int local_length = static_cast<int>(local_chars.size());
+    std::vector<int> lengths(num_procs), offsets(num_procs, 0);
+    MPI_Allgather(&local_length, 1, MPI_INT, lengths.data(), 1, MPI_INT, this->comm);
+    long total_length = 0;
+    for (int r = 0; r < num_procs; ++r) {
+        offsets[r] = static_cast<int>(total_length);
+        total_length += lengths[r];
+    }
+    if (total_length > std::numeric_limits<int>::max()) {
+        throw std::runtime_error("The nexus ids of all ranks are too long to gather for a nexus reduction");
+    }
+    std::vector<char> all_chars(total_length);
+    MPI_Allgatherv(local_chars.data(), local_length, MPI_CHAR, all_chars.data(), lengths.data(), offsets.data(),
+                   MPI_CHAR, this->comm);
+
+    std::vector<std::string> all_ids;
+    for (long start = 0; start < total_length; ) {
+        all_ids.emplace_back(all_chars.data() + start);
+        start += all_ids.back().size() + 1;
+    }
+    std::sort(all_ids.begin(), all_ids.end());
+    all_ids.erase(std::unique(all_ids.begin(), all_ids.end()), all_ids.end());
+
+    // Rank r owns the nexuses [block_starts[r], block_starts[r + 1]), and its block of the send buffer is their flows
+    // for every step of a chunk
+    const std::size_t count = all_ids.size();
+    std::vector<std::size_t> block_starts(num_procs + 1);
+    for (int r = 0; r <= num_procs; ++r) {
+        block_starts[r] = count * r / num_procs;
+    }
+    recv_counts.resize(num_procs);
+    for (int r = 0; r < num_procs; ++r) {
+        std::size_t block_size = (block_starts[r + 1] - block_starts[r]) * steps;
+        if (block_size > static_cast<std::size_t>(std::numeric_limits<int>::max())) {
+            throw std::runtime_error("A rank owns too many nexus flows per chunk for a nexus reduction; use fewer "
+                                     "time steps per chunk");
+        }
+        recv_counts[r] = static_cast<int>(block_size);
+    }
+    owned_ids.assign(all_ids.begin() + block_starts[rank], all_ids.begin() + block_starts[rank + 1]);
+    send_buffer.assign(count * steps, 0.0);
+    recv_buffer.assign(recv_counts[rank], 0.0);
+
+    local_bases.reserve(local_nexus_ids.size());
+    local_strides.reserve(local_nexus_ids.size());
+    for (const std::string& id : local_nexus_ids) {
+        std::size_t g = std::lower_bound(all_ids.begin(), all_ids.end(), id) - all_ids.begin();
+        std::size_t owner = std::upper_bound(block_starts.begin(), block_starts.end(), g) - block_starts.begin() - 1;
+        local_bases.push_back(block_starts[owner] * steps + (g - block_starts[owner]));
+        local_strides.push_back(block_starts[owner + 1] - block_starts[owner]);
+    }
+}
+
+NexusReduceScatter::~NexusReduceScatter()
+{
+    // This destructor might be called after MPI_Finalize so do not attempt to free anything if this has occurred
+    int mpi_finalized;
+    MPI_Finalized(&mpi_finalized);
+    if (mpi_finalized) {
+        return;
+    }
+    MPI_Comm_free(&comm);
+}
+
+void NexusReduceScatter::reduce()
+{
+    NGEN_PROFILE_SCOPE("nexus/mpi_reduce_scatter");
+    MPI_Reduce_scatter(send_buffer.data(), recv_buffer.data(), recv_counts.data(), MPI_DOUBLE, MPI_SUM, comm);
+    std::fill(send_buffer.begin(), send_buffer.end(), 0.0);
+}
+
+#endif // NGEN_MPI_ACTIVE
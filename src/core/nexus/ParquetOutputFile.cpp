@@ -0,0 +1,142 @@
+#ifdef NGEN_PARQUET_ACTIVE
+#include "ParquetOutputFile.hpp"
+
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+#include <arrow/api.h>
+#include <arrow/io/file.h>
+#include <arrow/util/compression.h>
+#include <parquet/arrow/writer.h>
+#include <parquet/properties.h>
+
+using namespace output;
+
+namespace
+{
+    void check(const arrow::Status& status, const std::string& path)
+    {
+        if (!status.ok()) {
+            throw std::runtime_error("ParquetOutputFile: unable to write " + path + ": " + status.ToString());
+        }
+    }
+
+    template<typename T>
+    T check(arrow::Result<T> result, const std::string& path)
+    {
+        check(result.status(), path);
+        return std::move(result).ValueOrDie();
+    }
+
+    template<typename Builder, typename T>
+    std::shared_ptr<arrow::Array> make_array(Builder& builder, const std::vector<T>& values, const std::string& path)
+    {
+        check(builder.AppendValues(values), path);
+        return check(builder.Finish(), path);
+    }
+
+    std::shared_ptr<arrow::DataType> dictionary_type()
+    {
+        return arrow::dictionary(arrow::int32(), arrow::utf8());
+    }
+
+    std::shared_ptr<arrow::DataType> time_type()
+    {
+        return arrow::timestamp(arrow::TimeUnit::SECOND, "UTC");
+    }
+}
+
+class ParquetOutputFile::Impl
+{
+  public:
+
+    std::string path;
+    std::shared_ptr<arrow::Schema> schema;
+    std::shared_ptr<arrow::Array> ids;
+    std::shared_ptr<arrow::Array> variables;
+    std::unique_ptr<parquet::arrow::FileWriter> writer;
+};
+
+ParquetOutputFile::ParquetOutputFile(const std::string& path, const std::vector<std::string>& ids,
+                                     const std::vector<std::string>& variables)
+    : impl(new Impl())
+{
+    impl->path = path;
+    impl->schema = arrow::schema({
+        arrow::field("id", dictionary_type(), false),
+        arrow::field("time_index", arrow::int64(), false),
+        arrow::field("time", time_type(), false),
+        arrow::field("variable", dictionary_type(), false),
+        arrow::field("value", arrow::float64())
+    });
+    arrow::StringBuilder id_builder, variable_builder;
+    impl->ids = make_array(id_builder, ids, path);
+    impl->variables = make_array(variable_builder, variables, path);
+
+    parquet::WriterProperties::Builder properties;
+    if (arrow::util::Codec::IsAvailable(arrow::Compression::SNAPPY)) {
+        properties.compression(arrow::Compression::SNAPPY);
+    }
+    std::shared_ptr<arrow::io::FileOutputStream> sink = check(arrow::io::FileOutputStream::Open(path), path);
+    impl->writer = check(parquet::arrow::FileWriter::Open(*impl->schema, arrow::default_memory_pool(), sink,
+                                                          properties.build(),
+                                                          parquet::ArrowWriterProperties::Builder().store_schema()->build()),
+                         path);
+}
+
+ParquetOutputFile::~ParquetOutputFile()
+{
+    try {
+        close();
+    }
+    catch (const std::exception& e) {
+        std::cerr << "WARN: " << e.what() << std::endl;
+    }
+}
+
+void ParquetOutputFile::write_row_group()
+{
+    if (value_column.empty()) {
+        return;
+    }
+    if (!impl->writer) {
+        throw std::runtime_error("ParquetOutputFile: " + impl->path + " is already closed");
+    }
+    const std::string& path = impl->path;
+    int64_t rows = value_column.size();
+
+    arrow::Int32Builder id_builder, variable_builder;
+    arrow::Int64Builder time_index_builder;
+    arrow::TimestampBuilder time_builder(time_type(), arrow::default_memory_pool());
+    arrow::DoubleBuilder value_builder;
+    std::vector<std::shared_ptr<arrow::Array>> columns = {
+        check(arrow::DictionaryArray::FromArrays(dictionary_type(), make_array(id_builder, id_column, path),
+                                                 impl->ids), path),
+        make_array(time_index_builder, time_index_column, path),
+        make_array(time_builder, time_column, path),
+        check(arrow::DictionaryArray::FromArrays(dictionary_type(), make_array(variable_builder, variable_column, path),
+                                                 impl->variables), path),
+        make_array(value_builder, value_column, path)
+    };
+    std::shared_ptr<arrow::Table> table = arrow::Table::Make(impl->schema, columns, rows);
+    check(impl->writer->WriteTable(*table, rows), path);
+
+    id_column.clear();
+    time_index_column.clear();
+    time_column.clear();
+    variable_column.clear();
+    value_column.clear();
+}
+
+void ParquetOutputFile::close()
+{
+    if (!impl->writer) {
+        return;
+    }
+    write_row_group();
+    std::unique_ptr<parquet::arrow::FileWriter> writer = std::move(impl->writer);
+    check(writer->Close(), impl->path);
+}
+
+#endif //NGEN_PARQUET_ACTIVE
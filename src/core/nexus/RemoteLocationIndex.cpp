@@ -0,0 +1,3 @@
+#include "RemoteLocationIndex.hpp"
+
+constexpr RemoteLocationIndex::handle_t RemoteLocationIndex::npos;
@@ -0,0 +1,299 @@
+#include "RemoteNexusExchange.hpp"
+
+#ifdef NGEN_MPI_ACTIVE
+
+#include "HY_PointHydroNexusRemote.hpp"
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+
+namespace {
+    // The only point-to-point messages on the exchange's communicator are the window offsets of the one-sided transport
+    const int OFFSET_TAG = 0;
+
+    // Each block starts with the first time step and the length of its chunk
+    const int BLOCK_HEADER = 2;
+}
+
+RemoteNexusExchange::RemoteNexusExchange(const std::vector<std::shared_ptr<HY_PointHydroNexusRemote>>& nexuses,
+                                         MPI_Comm comm, Transport transport, std::size_t chunk_steps)
+    : transport(transport), chunk_steps(chunk_steps)
+{
+    if (chunk_steps < 1) {
+        throw std::invalid_argument("RemoteNexusExchange: chunks need at least one time step");
+    }
+    // Group nexuses by neighbor rank, with ids sorted so both sides agree on the layout of each block
+    std::map<int, std::map<std::string, HY_PointHydroNexusRemote*>> sends, recvs;
+    for (const auto& nexus : nexuses) {
+        if (nexus->is_remote_sender()) {
+            //TODO currently only support a SINGLE downstream message pairing
+            sends[*nexus->get_downstream_ranks().begin()][nexus->get_id()] = nexus.get();
+        }
+        auto type = nexus->get_communicator_type();
+        if (type == HY_PointHydroNexusRemote::receiver || type == HY_PointHydroNexusRemote::sender_receiver) {
+            for (int rank : nexus->get_upstream_ranks()) {
+                recvs[rank][nexus->get_id()] = nexus.get();
+            }
+        }
+    }
+
+    auto make_channels = [chunk_steps](const std::map<int, std::map<std::string, HY_PointHydroNexusRemote*>>& by_rank,
+                            std::vector<Channel>& channels, std::vector<int>& counts, std::vector<int>& offsets,
+                            std::vector<double>& buffer) {
+        int offset = 0;
+        for (const auto& neighbor : by_rank) {
+            Channel channel;
+            channel.rank = neighbor.first;
+            for (const auto& nexus : neighbor.second) {
+                channel.nexus_ids.push_back(nexus.first);
+                channel.nexuses.push_back(nexus.second);
+            }
+            channel.offset = offset;
+            channel.staged_steps.assign(channel.nexuses.size(), -1);
+            counts.push_back(channel.nexuses.size() * chunk_steps + BLOCK_HEADER);
+            offsets.push_back(offset);
+            offset += counts.back();
+            channels.push_back(std::move(channel));
+        }
+        buffer.assign(offset, 0.0);
+    };
+    make_channels(sends, send_channels, send_counts, send_offsets, send_buffer);
+    make_channels(recvs, recv_channels, recv_counts, recv_offsets, recv_buffer);
+
+    for (std::size_t c = 0; c < send_channels.size(); ++c) {
+        for (std::size_t s = 0; s < send_channels[c].nexus_ids.size(); ++s) {
+            send_slots[send_channels[c].nexus_ids[s]] = std::make_pair(c, s);
+        }
+    }
+
+    // Each edge of the graph is weighted by the number of nexuses carried along it
+    std::vector<int> sources, source_weights, destinations, destination_weights;
+    for (const auto& channel : recv_channels) {
+        sources.push_back(channel.rank);
+        source_weights.push_back(channel.nexuses.size());
+    }
+    for (const auto& channel : send_channels) {
+        destinations.push_back(channel.rank);
+        destination_weights.push_back(channel.nexuses.size());
+    }
+    // A rank without neighbors on one side still declares that it weights its edges, with MPI_WEIGHTS_EMPTY
+    MPI_Dist_graph_create_adjacent(comm, sources.size(), sources.data(),
+                                   sources.empty() ? MPI_WEIGHTS_EMPTY : source_weights.data(),
+                                   destinations.size(), destinations.data(),
+                                   destinations.empty() ? MPI_WEIGHTS_EMPTY : destination_weights.data(),
+                                   MPI_INFO_NULL, 0, &this->comm);
+    if (transport == Transport::one_sided) {
+        init_one_sided();
+    }
+
+    for (const auto& nexus : nexuses) {
+        nexus->set_exchange(this);
+    }
+}
+
+RemoteNexusExchange::~RemoteNexusExchange()
+{
+    // This destructor might be called after MPI_Finalize so do not attempt to free anything if this has occurred
+    int mpi_finalized;
+    MPI_Finalized(&mpi_finalized);
+    if (mpi_finalized) {
+        return;
+    }
+    if (window != MPI_WIN_NULL) {
+        MPI_Win_free(&window);
+        MPI_Group_free(&source_group);
+        MPI_Group_free(&destination_group);
+    }
+    MPI_Comm_free(&comm);
+}
+
+void RemoteNexusExchange::init_one_sided()
+{
+    MPI_Win_create(recv_buffer.data(), recv_buffer.size() * sizeof(double), sizeof(double), MPI_INFO_NULL, comm,
+                   &window);
+
+    // Each rank tells its upstream neighbors where their blocks go in its window
+    std::vector<MPI_Request> offset_requests;
+    std::vector<int> received_offsets(send_channels.size());
+    offset_requests.reserve(recv_channels.size() + send_channels.size());
+    for (const auto& channel : recv_channels) {
+        offset_requests.emplace_back();
+        MPI_Isend(&channel.offset, 1, MPI_INT, channel.rank, OFFSET_TAG, comm, &offset_requests.back());
+    }
+    for (std::size_t c = 0; c < send_channels.size(); ++c) {
+        offset_requests.emplace_back();
+        MPI_Irecv(&received_offsets[c], 1, MPI_INT, send_channels[c].rank, OFFSET_TAG, comm, &offset_requests.back());
+    }
+    MPI_Waitall(offset_requests.size(), offset_requests.data(), MPI_STATUSES_IGNORE);
+    target_offsets.assign(received_offsets.begin(), received_offsets.end());
+
+    MPI_Group comm_group;
+    MPI_Comm_group(comm, &comm_group);
+    std::vector<int> ranks;
+    for (const auto& channel : recv_channels) {
+        ranks.push_back(channel.rank);
+    }
+    MPI_Group_incl(comm_group, ranks.size(), ranks.data(), &source_group);
+    ranks.clear();
+    for (const auto& channel : send_channels) {
+        ranks.push_back(channel.rank);
+    }
+    MPI_Group_incl(comm_group, ranks.size(), ranks.data(), &destination_group);
+    MPI_Group_free(&comm_group);
+}
+
+void RemoteNexusExchange::stage_flow(const std::string& nexus_id, long t, double flow)
+{
+    auto it = send_slots.find(nexus_id);
+    if (it == send_slots.end()) {
+        throw std::runtime_error("RemoteNexusExchange: nexus " + nexus_id + " does not send to a remote rank");
+    }
+    std::size_t c = it->second.first;
+    std::size_t s = it->second.second;
+    Channel& channel = send_channels[c];
+    if (chunk_first < 0) {
+        chunk_first = t;
+    }
+    const long step = t - chunk_first;
+    if (step < 0 || step >= static_cast<long>(chunk_steps)
+        || (step > 0 && channel.staged_steps[s] != t && channel.staged_steps[s] != t - 1)) {
+        throw std::runtime_error("RemoteNexusExchange: nexus " + nexus_id + " staged a flow for time step "
+                                 + std::to_string(t) + " out of order in the chunk from time step "
+                                 + std::to_string(chunk_first));
+    }
+    if (started_step == chunk_first) {
+        throw std::runtime_error("RemoteNexusExchange: nexus " + nexus_id + " staged a flow for time step "
+                                 + std::to_string(t) + " after its exchange started");
+    }
+    send_buffer[channel.offset + BLOCK_HEADER + step * channel.nexuses.size() + s] = flow;
+    if (channel.staged_steps[s] != t) {
+        channel.staged_steps[s] = t;
+        if (step + 1 == static_cast<long>(chunk_steps)) {
+            if (completing_step != chunk_first) {
+                completing_step = chunk_first;
+                complete_nexuses = 0;
+            }
+            ++complete_nexuses;
+        }
+    }
+
+    // Start the exchange as soon as everything to send is staged, rather than waiting for the exchange call.  Puts may
+    // wait on the neighbors opening their windows, so they only start early once this rank has opened its own window
+    // for the chunk; otherwise two ranks putting to each other could each wait on the other.
+    if (completing_step == chunk_first && complete_nexuses == send_slots.size()
+        && (transport == Transport::neighbor_collective || posted_step == chunk_first)) {
+        start(chunk_first, chunk_steps);
+    }
+}
+
+void RemoteNexusExchange::post_receives(long t)
+{
+    if (posted_step == t) {
+        return;
+    }
+    posted_step = t;
+    if (chunk_first < 0) {
+        chunk_first = t;
+    }
+    if (transport == Transport::one_sided) {
+        if (!recv_channels.empty()) {
+            MPI_Win_post(source_group, 0, window);
+        }
+    }
+    else if (send_channels.empty()) {
+        // With nothing to send, the length of the chunk is not part of any block
+        start(t, chunk_steps);
+    }
+}
+
+void RemoteNexusExchange::start(long first, long count)
+{
+    if (started_step == first) {
+        return;
+    }
+    started_step = first;
+    for (auto& channel : send_channels) {
+        send_buffer[channel.offset] = first;
+        send_buffer[channel.offset + 1] = count;
+    }
+    if (transport == Transport::neighbor_collective) {
+        MPI_Ineighbor_alltoallv(send_buffer.data(), send_counts.data(), send_offsets.data(), MPI_DOUBLE,
+                                recv_buffer.data(), recv_counts.data(), recv_offsets.data(), MPI_DOUBLE, comm,
+                                &request);
+    }
+    else if (!send_channels.empty()) {
+        MPI_Win_start(destination_group, 0, window);
+        for (std::size_t c = 0; c < send_channels.size(); ++c) {
+            MPI_Put(send_buffer.data() + send_offsets[c], send_counts[c], MPI_DOUBLE, send_channels[c].rank,
+                    target_offsets[c], send_counts[c], MPI_DOUBLE, window);
+        }
+    }
+}
+
+void RemoteNexusExchange::exchange_chunk(long first, long count, bool post_next)
+{
+    if (count < 1 || count > static_cast<long>(chunk_steps)) {
+        throw std::invalid_argument("RemoteNexusExchange: a chunk of " + std::to_string(count)
+                                    + " time steps is not between 1 and " + std::to_string(chunk_steps));
+    }
+    if (chunk_first >= 0 && chunk_first != first) {
+        throw std::runtime_error("RemoteNexusExchange: flows were staged for the chunk from time step "
+                                 + std::to_string(chunk_first) + ", not " + std::to_string(first));
+    }
+    chunk_first = first;
+    post_receives(first);
+    const long last = first + count - 1;
+    if (started_step != first) {
+        for (auto& channel : send_channels) {
+            for (std::size_t s = 0; s < channel.nexus_ids.size(); ++s) {
+                if (channel.staged_steps[s] != last) {
+                    throw std::runtime_error("RemoteNexusExchange: nexus " + channel.nexus_ids[s]
+                                             + " has no flow to send for time step " + std::to_string(last));
+                }
+            }
+        }
+        start(first, count);
+    }
+
+    {
+        NGEN_PROFILE_SCOPE("nexus/mpi_wait");
+        if (transport == Transport::neighbor_collective) {
+            MPI_Wait(&request, MPI_STATUS_IGNORE);
+        }
+        else {
+            // Complete this rank's puts, then wait for those of its upstream neighbors
+            if (!send_channels.empty()) {
+                MPI_Win_complete(window);
+            }
+            if (!recv_channels.empty()) {
+                MPI_Win_wait(window);
+            }
+        }
+    }
+
+    for (auto& channel : recv_channels) {
+        const double* block = recv_buffer.data() + channel.offset;
+        if (block[0] != first || block[1] != count) {
+            throw std::runtime_error("RemoteNexusExchange: expected flows for time steps " + std::to_string(first)
+                                     + " to " + std::to_string(last) + " from rank " + std::to_string(channel.rank)
+                                     + ", but received " + std::to_string((long)block[1]) + " from time step "
+                                     + std::to_string((long)block[0]));
+        }
+        const double* flows = block + BLOCK_HEADER;
+        for (long step = 0; step < count; ++step) {
+            for (std::size_t s = 0; s < channel.nexuses.size(); ++s) {
+                channel.nexuses[s]->add_remote_flow(*flows++, first + step);
+            }
+        }
+    }
+
+    // The flows are out of the receive buffer, so it can take the next chunk's
+    chunk_first = -1;
+    if (post_next) {
+        post_receives(first + count);
+    }
+}
+
+#endif // NGEN_MPI_ACTIVE
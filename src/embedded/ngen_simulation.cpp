@@ -0,0 +1,149 @@
+#include "ngen_simulation.h"
+
+#include <exception>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "PushedForcingDataProvider.hpp"
+#include "Simulation.hpp"
+
+struct ngen_simulation {
+    std::unique_ptr<ngen::Simulation> simulation;
+};
+
+namespace {
+    thread_local std::string last_error;
+
+    int fail(const std::exception& e)
+    {
+        last_error = e.what();
+        return -1;
+    }
+}
+
+ngen_simulation* ngen_simulation_create(const char* catchment_path, const char* realization_path, size_t threads)
+{
+    last_error.clear();
+    try {
+        std::unique_ptr<ngen_simulation> handle(new ngen_simulation());
+        handle->simulation = ngen::Simulation::from_files(catchment_path, realization_path, threads);
+        return handle.release();
+    }
+    catch (const std::exception& e) {
+        fail(e);
+        return nullptr;
+    }
+}
+
+void ngen_simulation_destroy(ngen_simulation* simulation)
+{
+    delete simulation;
+}
+
+int ngen_simulation_step(ngen_simulation* simulation, int steps, int* steps_run)
+{
+    last_error.clear();
+    try {
+        int count = simulation->simulation->step(steps);
+        if (steps_run != nullptr) {
+            *steps_run = count;
+        }
+        return 0;
+    }
+    catch (const std::exception& e) {
+        return fail(e);
+    }
+}
+
+int ngen_simulation_time_index(const ngen_simulation* simulation)
+{
+    return simulation->simulation->get_time_index();
+}
+
+int ngen_simulation_total_steps(const ngen_simulation* simulation)
+{
+    return simulation->simulation->get_total_steps();
+}
+
+size_t ngen_simulation_nexus_count(const ngen_simulation* simulation)
+{
+    return simulation->simulation->get_nexus_ids().size();
+}
+
+const char* ngen_simulation_nexus_id(const ngen_simulation* simulation, size_t index)
+{
+    const auto& ids = simulation->simulation->get_nexus_ids();
+    return index < ids.size() ? ids[index].c_str() : nullptr;
+}
+
+const double* ngen_simulation_nexus_flows(const ngen_simulation* simulation, size_t* steps)
+{
+    ngen::FlowView flows = simulation->simulation->nexus_flows();
+    if (steps != nullptr) {
+        *steps = flows.steps;
+    }
+    return flows.data;
+}
+
+size_t ngen_simulation_catchment_count(const ngen_simulation* simulation)
+{
+    return simulation->simulation->get_catchment_ids().size();
+}
+
+const char* ngen_simulation_catchment_id(const ngen_simulation* simulation, size_t index)
+{
+    const auto& ids = simulation->simulation->get_catchment_ids();
+    return index < ids.size() ? ids[index].c_str() : nullptr;
+}
+
+const double* ngen_simulation_catchment_flows(const ngen_simulation* simulation, size_t* steps)
+{
+    ngen::FlowView flows = simulation->simulation->catchment_flows();
+    if (steps != nullptr) {
+        *steps = flows.steps;
+    }
+    return flows.data;
+}
+
+int ngen_forcing_create(const char* name, const char* const* ids, size_t id_count, const char* const* variables,
+                        const char* const* units, size_t variable_count, long start_time, long time_step,
+                        double wait_seconds)
+{
+    last_error.clear();
+    try {
+        std::vector<std::string> id_list(ids, ids + id_count);
+        std::vector<data_access::PushedForcingDataProvider::variable_t> variable_list;
+        for (size_t v = 0; v < variable_count; ++v) {
+            variable_list.emplace_back(variables[v], units[v]);
+        }
+        data_access::PushedForcingDataProvider::create(name, std::move(id_list), variable_list, start_time,
+                                                       time_step, wait_seconds);
+        return 0;
+    }
+    catch (const std::exception& e) {
+        return fail(e);
+    }
+}
+
+int ngen_forcing_push(const char* name, size_t time_index, const double* values)
+{
+    last_error.clear();
+    try {
+        data_access::PushedForcingDataProvider::get_shared_provider(name)->push(time_index, values);
+        return 0;
+    }
+    catch (const std::exception& e) {
+        return fail(e);
+    }
+}
+
+void ngen_forcing_release(const char* name)
+{
+    data_access::PushedForcingDataProvider::release(name);
+}
+
+const char* ngen_simulation_last_error(void)
+{
+    return last_error.c_str();
+}
@@ -0,0 +1,72 @@
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include "PushedForcingDataProvider.hpp"
+#include "Simulation.hpp"
+
+namespace py = pybind11;
+
+namespace {
+    /**
+     * A read only, step by feature array over flows of a simulation, without copying them; the array keeps the
+     * simulation alive, though its values change as the simulation steps.
+     */
+    py::array_t<double> to_array(const ngen::FlowView& flows, py::handle owner)
+    {
+        py::array_t<double> array({flows.steps, flows.features},
+                                  {flows.features * sizeof(double), sizeof(double)},
+                                  flows.data, owner);
+        array.attr("setflags")(py::arg("write") = false);
+        return array;
+    }
+}
+
+PYBIND11_MODULE(ngen_simulation, m) {
+    m.doc() = "Run ngen simulations in the calling process, reading their flows as NumPy arrays.";
+
+    py::class_<ngen::Simulation, std::unique_ptr<ngen::Simulation>>(m, "Simulation")
+        .def(py::init(&ngen::Simulation::from_files), py::arg("catchment_path"), py::arg("realization_path"),
+             py::arg("threads") = 1)
+        .def("step", &ngen::Simulation::step, py::arg("steps") = 1, py::call_guard<py::gil_scoped_release>(),
+             "Run the next time steps, returning the number run.")
+        .def("nexus_flows", [](py::object self) {
+                return to_array(self.cast<ngen::Simulation&>().nexus_flows(), self);
+            }, "The flows of each nexus at each of the steps last run, in m^3/s.")
+        .def("catchment_flows", [](py::object self) {
+                return to_array(self.cast<ngen::Simulation&>().catchment_flows(), self);
+            }, "The flows each catchment contributed at each of the steps last run, in m^3/s.")
+        .def_property_readonly("nexus_ids", &ngen::Simulation::get_nexus_ids)
+        .def_property_readonly("catchment_ids", &ngen::Simulation::get_catchment_ids)
+        .def_property_readonly("time_index", &ngen::Simulation::get_time_index)
+        .def_property_readonly("first_step_index", &ngen::Simulation::get_first_step_index)
+        .def_property_readonly("total_steps", &ngen::Simulation::get_total_steps)
+        .def_property_readonly("output_interval_seconds", &ngen::Simulation::get_output_interval_seconds)
+        .def("timestamp", &ngen::Simulation::get_timestamp, py::arg("time_index"))
+        .def("finalize", &ngen::Simulation::finalize);
+
+    py::class_<data_access::PushedForcingDataProvider, std::shared_ptr<data_access::PushedForcingDataProvider>>(
+            m, "PushedForcing", "Forcing pushed a time step at a time, for formulations with \"provider\": \"Pushed\".")
+        .def(py::init(&data_access::PushedForcingDataProvider::create), py::arg("name"), py::arg("ids"),
+             py::arg("variables"), py::arg("start_time"), py::arg("time_step"), py::arg("wait_seconds") = 0.0,
+             "Create the forcing of a name, with (name, units) pairs of its variables.")
+        .def("push", [](data_access::PushedForcingDataProvider& forcing, std::size_t time_index,
+                        py::array_t<double, py::array::c_style | py::array::forcecast> values) {
+                const std::size_t expected = forcing.get_ids().size() * forcing.get_variable_count();
+                if (static_cast<std::size_t>(values.size()) != expected) {
+                    throw std::invalid_argument("Pushed forcing needs " + std::to_string(expected) + " values, a "
+                                                "catchment by variable array.");
+                }
+                forcing.push(time_index, values.data());
+            }, py::arg("time_index"), py::arg("values"), py::call_guard<py::gil_scoped_release>(),
+            "Push the catchment by variable values of the next time step.")
+        .def_property_readonly("pushed_count", &data_access::PushedForcingDataProvider::get_pushed_count)
+        .def_static("release", &data_access::PushedForcingDataProvider::release, py::arg("name"));
+}
@@ -0,0 +1,4 @@
+#include "CsvPerFeatureForcingProvider.hpp"
+
+std::mutex CsvPerFeatureForcingProvider::shared_providers_mutex;
+std::map<std::tuple<std::string, time_t, time_t>, std::shared_ptr<CsvPerFeatureForcingProvider::shared_provider>> CsvPerFeatureForcingProvider::shared_providers;
@@ -0,0 +1,6 @@
+#include "DerivedForcingDataProvider.hpp"
+
+constexpr const char* data_access::DerivedForcingDataProvider::DERIVED_UNITS;
+std::mutex data_access::DerivedForcingDataProvider::shared_providers_mutex;
+std::map<std::tuple<data_access::GenericDataProvider*, std::vector<std::string>, const std::vector<std::string>*>,
+         std::shared_ptr<data_access::DerivedForcingDataProvider>> data_access::DerivedForcingDataProvider::shared_providers;
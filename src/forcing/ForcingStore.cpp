@@ -0,0 +1,530 @@
+#include "ForcingStore.hpp"
+#include "AorcForcing.hpp"
+#include "MappedCsvReader.hpp"
+#include "RemoteObject.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace data_access
+{
+    constexpr char ForcingStore::MAGIC[8];
+    constexpr std::uint32_t ForcingStore::VERSION;
+    constexpr std::uint32_t ForcingStore::BYTE_ORDER_MARK;
+
+    namespace
+    {
+        constexpr std::uint64_t PAGE_ALIGNMENT = 4096;
+
+        void append_string(std::vector<char>& bytes, const std::string& s)
+        {
+            std::uint32_t length = s.size();
+            const char* l = reinterpret_cast<const char*>(&length);
+            bytes.insert(bytes.end(), l, l + sizeof(length));
+            bytes.insert(bytes.end(), s.begin(), s.end());
+        }
+
+        std::string read_string(const char*& c, const char* end, const std::string& path)
+        {
+            std::uint32_t length;
+            if( end - c < static_cast<std::ptrdiff_t>(sizeof(length)) ) {
+                throw std::runtime_error("Forcing store " + path + " is truncated.");
+            }
+            std::memcpy(&length, c, sizeof(length));
+            c += sizeof(length);
+            if( end - c < static_cast<std::ptrdiff_t>(length) ) {
+                throw std::runtime_error("Forcing store " + path + " is truncated.");
+            }
+            std::string s(c, length);
+            c += length;
+            return s;
+        }
+
+        void write_fully(int fd, const char* bytes, std::size_t count, std::uint64_t offset, const std::string& path)
+        {
+            while( count > 0 ) {
+                ssize_t written = ::pwrite(fd, bytes, count, offset);
+                if( written < 0 ) {
+                    if( errno == EINTR ) continue;
+                    throw std::runtime_error("Unable to write forcing store " + path + ": " + std::strerror(errno));
+                }
+                bytes += written;
+                count -= written;
+                offset += written;
+            }
+        }
+
+        time_t parse_time(const utils::MappedCsvReader::Field& field)
+        {
+            time_t epoch_time;
+            if( !utils::MappedCsvReader::parse_datetime(field, epoch_time) ) {
+                struct tm time_utc = tm();
+                strptime(field.str().c_str(), "%Y-%m-%d %H:%M:%S", &time_utc);
+                epoch_time = timegm(&time_utc);
+            }
+            return epoch_time;
+        }
+
+        /** The column layout and times of a CSV forcing file. */
+        struct CsvLayout
+        {
+            std::vector<std::string> header;
+            std::size_t time_col = 0;
+            std::vector<time_t> times;
+        };
+
+        CsvLayout read_csv_layout(const std::string& file_name)
+        {
+            CsvLayout layout;
+            utils::MappedCsvReader reader(file_name);
+            std::vector<utils::MappedCsvReader::Field> row;
+            if( !reader.next_row(row) ) {
+                throw std::runtime_error("Error: Forcing data " + file_name + " is empty.");
+            }
+            for( std::size_t c = 0; c < row.size(); ++c ) {
+                layout.header.push_back(row[c].str());
+                if( row[c] == "Time" || row[c] == "time" ) {
+                    layout.time_col = c;
+                }
+            }
+            while( reader.next_row(row) ) {
+                if( layout.time_col >= row.size() ) {
+                    throw std::runtime_error("Error: Forcing data " + file_name + " has a row without a time.");
+                }
+                layout.times.push_back(parse_time(row[layout.time_col]));
+            }
+            return layout;
+        }
+    }
+
+    /** The state of a store in object storage: which of its time steps are in memory, and the fetches under way. */
+    class ForcingStore::Remote
+    {
+        public:
+
+        /** The most groups of time steps either side of the last fetched kept in memory. */
+        static constexpr std::size_t RETAINED_GROUPS = 4;
+
+        Remote(std::shared_ptr<RemoteObject> object, std::size_t record_bytes, std::size_t value_bytes, std::size_t num_times)
+            : object(std::move(object)), record_bytes(record_bytes), value_bytes(value_bytes),
+              // time steps are fetched about a block of the cache at a time
+              steps_per_group(std::max<std::size_t>(1, RemoteObject::DEFAULT_BLOCK_SIZE / record_bytes)),
+              fetched(new std::atomic<bool>[(num_times + steps_per_group - 1) / steps_per_group])
+        {
+            for( std::size_t g = 0; g < (num_times + steps_per_group - 1) / steps_per_group; ++g ) {
+                fetched[g].store(false, std::memory_order_relaxed);
+            }
+        }
+
+        /**
+         * Run a fetch in the background, unless it is done or an earlier one is still running.  A failed fetch is
+         * not reported here, but by the fetch of the records when they are read.
+         */
+        void prefetch(std::function<void()> task, bool done)
+        {
+            if( done ) {
+                return;
+            }
+            std::lock_guard<std::mutex> lock(prefetch_mutex);
+            if( pending.valid() ) {
+                if( pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready ) {
+                    return;
+                }
+                try {
+                    pending.get();
+                }
+                catch( ... ) {
+                }
+            }
+            pending = std::async(std::launch::async, std::move(task));
+        }
+
+        void wait_for_prefetch()
+        {
+            std::lock_guard<std::mutex> lock(prefetch_mutex);
+            if( pending.valid() ) {
+                try {
+                    pending.get();
+                }
+                catch( ... ) {
+                }
+            }
+        }
+
+        std::shared_ptr<RemoteObject> object;
+        std::size_t record_bytes;
+        std::size_t value_bytes;
+        std::size_t steps_per_group;
+        std::unique_ptr<std::atomic<bool>[]> fetched;   // of each group of time steps
+        std::set<std::size_t> resident;                   // the groups in memory
+        std::mutex mutex;                                 // held by a fetch
+
+        private:
+
+        std::mutex prefetch_mutex;
+        std::future<void> pending;
+    };
+
+    constexpr std::size_t ForcingStore::Remote::RETAINED_GROUPS;
+
+    ForcingStore::ForcingStore(const std::string& path)
+    {
+        if( is_remote_path(path) ) {
+            open_remote(std::make_shared<RemoteObject>(path), path);
+            return;
+        }
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if( fd < 0 ) {
+            throw std::runtime_error("Unable to open forcing store " + path + ": " + std::strerror(errno));
+        }
+        struct stat st;
+        if( ::fstat(fd, &st) != 0 ) {
+            ::close(fd);
+            throw std::runtime_error("Unable to read the size of forcing store " + path + ".");
+        }
+        size = static_cast<std::size_t>(st.st_size);
+        if( size < sizeof(Header) ) {
+            ::close(fd);
+            throw std::runtime_error("File " + path + " is not a forcing store.");
+        }
+        void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if( mapped == MAP_FAILED ) {
+            throw std::runtime_error("Unable to map forcing store " + path + " into memory.");
+        }
+        data = static_cast<const char*>(mapped);
+
+        try {
+            std::memcpy(&header, data, sizeof(Header));
+            check_header(path);
+            read_names(data + sizeof(Header), data + header.data_offset, path);
+        }
+        catch( ... ) {
+            ::munmap(const_cast<char*>(data), size);
+            throw;
+        }
+        values = reinterpret_cast<const double*>(data + header.data_offset);
+    }
+
+    ForcingStore::ForcingStore(std::shared_ptr<RemoteObject> object)
+    {
+        const std::string path = object->get_url();
+        open_remote(std::move(object), path);
+    }
+
+    ForcingStore::~ForcingStore()
+    {
+        if( remote ) {
+            remote->wait_for_prefetch();
+            ::munmap(const_cast<double*>(values), remote->value_bytes);
+        }
+        else {
+            ::munmap(const_cast<char*>(data), size);
+        }
+    }
+
+    void ForcingStore::check_header(const std::string& path) const
+    {
+        if( std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ) {
+            throw std::runtime_error("File " + path + " is not a forcing store.");
+        }
+        if( header.byte_order != BYTE_ORDER_MARK ) {
+            throw std::runtime_error("Forcing store " + path + " was written on a machine of different byte order.");
+        }
+        if( header.version != VERSION ) {
+            throw std::runtime_error("Forcing store " + path + " has unsupported version " + std::to_string(header.version) + ".");
+        }
+        if( header.num_ids == 0 || header.num_variables == 0 || header.num_times == 0 || header.time_step <= 0 ) {
+            throw std::runtime_error("Forcing store " + path + " holds no values.");
+        }
+        const std::uint64_t num_values = header.num_ids * header.num_variables * header.num_times;
+        if( header.data_offset % sizeof(double) != 0 || header.data_offset < sizeof(Header) || header.data_offset > size
+            || (size - header.data_offset) / sizeof(double) < num_values ) {
+            throw std::runtime_error("Forcing store " + path + " is truncated.");
+        }
+    }
+
+    void ForcingStore::read_names(const char* c, const char* names_end, const std::string& path)
+    {
+        for( std::size_t i = 0; i < header.num_ids; ++i ) {
+            ids.push_back(read_string(c, names_end, path));
+            id_index.emplace(ids.back(), i);
+        }
+        for( std::size_t i = 0; i < header.num_variables; ++i ) {
+            variable_names.push_back(read_string(c, names_end, path));
+            variable_units.push_back(read_string(c, names_end, path));
+            variable_index.emplace(variable_names.back(), i);
+        }
+    }
+
+    void ForcingStore::open_remote(std::shared_ptr<RemoteObject> object, const std::string& path)
+    {
+        size = object->size();
+        if( size < sizeof(Header) ) {
+            throw std::runtime_error("File " + path + " is not a forcing store.");
+        }
+        object->read(0, sizeof(Header), reinterpret_cast<char*>(&header));
+        check_header(path);
+        std::vector<char> names(header.data_offset - sizeof(Header));
+        object->read(sizeof(Header), names.size(), names.data());
+        read_names(names.data(), names.data() + names.size(), path);
+
+        // address space for every value, of which only the pages of the time steps fetched are ever committed
+        const std::size_t record_bytes = header.num_variables * header.num_ids * sizeof(double);
+        const std::size_t value_bytes = record_bytes * header.num_times;
+        void* mapped = ::mmap(nullptr, value_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if( mapped == MAP_FAILED ) {
+            throw std::runtime_error("Unable to reserve memory for the values of forcing store " + path + ".");
+        }
+        values = static_cast<const double*>(mapped);
+        remote.reset(new Remote(std::move(object), record_bytes, value_bytes, header.num_times));
+    }
+
+    void ForcingStore::fetch(std::size_t t) const
+    {
+        const std::size_t group = t / remote->steps_per_group;
+        if( remote->fetched[group].load(std::memory_order_acquire) ) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(remote->mutex);
+        if( remote->fetched[group].load(std::memory_order_relaxed) ) {
+            return;
+        }
+        char* base = reinterpret_cast<char*>(const_cast<double*>(values));
+        const std::size_t first = group * remote->steps_per_group;
+        const std::size_t steps = std::min<std::size_t>(remote->steps_per_group, header.num_times - first);
+        remote->object->read(header.data_offset + first * remote->record_bytes, steps * remote->record_bytes,
+                             base + first * remote->record_bytes);
+        remote->fetched[group].store(true, std::memory_order_release);
+
+        // give back the memory of groups far from this one, which are fetched again if they are wanted again
+        std::set<std::size_t>& resident = remote->resident;
+        resident.insert(group);
+        for( auto it = resident.begin(); it != resident.end(); ) {
+            const std::size_t other = *it;
+            if( other + Remote::RETAINED_GROUPS < group || other > group + Remote::RETAINED_GROUPS ) {
+                remote->fetched[other].store(false, std::memory_order_release);
+                const std::size_t other_first = other * remote->steps_per_group;
+                const std::size_t other_steps = std::min<std::size_t>(remote->steps_per_group, header.num_times - other_first);
+                // only whole pages inside the group can be given back
+                std::uintptr_t begin = reinterpret_cast<std::uintptr_t>(base + other_first * remote->record_bytes);
+                std::uintptr_t end = begin + other_steps * remote->record_bytes;
+                begin = (begin + PAGE_ALIGNMENT - 1) / PAGE_ALIGNMENT * PAGE_ALIGNMENT;
+                end = end / PAGE_ALIGNMENT * PAGE_ALIGNMENT;
+                if( end > begin ) {
+                    ::madvise(reinterpret_cast<void*>(begin), end - begin, MADV_DONTNEED);
+                }
+                it = resident.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+
+    std::size_t ForcingStore::get_id_index(const std::string& id) const
+    {
+        auto found = id_index.find(id);
+        if( found == id_index.end() ) {
+            throw std::out_of_range("Forcing store has no catchment " + id);
+        }
+        return found->second;
+    }
+
+    std::size_t ForcingStore::get_variable_index(const std::string& name) const
+    {
+        auto found = variable_index.find(name);
+        if( found == variable_index.end() ) {
+            throw std::out_of_range("Forcing store has no variable " + name);
+        }
+        return found->second;
+    }
+
+    void ForcingStore::will_need(std::size_t t) const
+    {
+        if( t >= header.num_times ) {
+            return;
+        }
+        if( remote ) {
+            remote->prefetch([this, t]() { fetch(t); }, remote->fetched[t / remote->steps_per_group].load(std::memory_order_acquire));
+            return;
+        }
+        const std::uint64_t record_bytes = header.num_variables * header.num_ids * sizeof(double);
+        const std::uint64_t begin = header.data_offset + t * record_bytes;
+        const std::uint64_t page_begin = begin - begin % PAGE_ALIGNMENT;
+        ::madvise(const_cast<char*>(data) + page_begin, begin + record_bytes - page_begin, MADV_WILLNEED);
+    }
+
+    ForcingStoreWriter::ForcingStoreWriter(const std::string& path, const std::vector<std::string>& ids,
+                                           const std::vector<std::pair<std::string, std::string>>& variables,
+                                           time_t start_time, long time_step, std::size_t num_times)
+        : path(path), num_ids(ids.size()), num_variables(variables.size()), num_times(num_times)
+    {
+        ForcingStore::Header header;
+        std::memcpy(header.magic, ForcingStore::MAGIC, sizeof(header.magic));
+        header.byte_order = ForcingStore::BYTE_ORDER_MARK;
+        header.version = ForcingStore::VERSION;
+        header.num_ids = num_ids;
+        header.num_variables = num_variables;
+        header.num_times = num_times;
+        header.start_time = start_time;
+        header.time_step = time_step;
+
+        const char* h = reinterpret_cast<const char*>(&header);
+        std::vector<char> bytes(h, h + sizeof(header));
+        for( const auto& id : ids ) {
+            append_string(bytes, id);
+        }
+        for( const auto& variable : variables ) {
+            append_string(bytes, variable.first);
+            append_string(bytes, variable.second);
+        }
+        data_offset = (bytes.size() + PAGE_ALIGNMENT - 1) / PAGE_ALIGNMENT * PAGE_ALIGNMENT;
+        reinterpret_cast<ForcingStore::Header*>(bytes.data())->data_offset = data_offset;
+
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if( fd < 0 ) {
+            throw std::runtime_error("Unable to create forcing store " + path + ": " + std::strerror(errno));
+        }
+        try {
+            write_fully(fd, bytes.data(), bytes.size(), 0, path);
+            if( ::ftruncate(fd, data_offset + num_ids * num_variables * num_times * sizeof(double)) != 0 ) {
+                throw std::runtime_error("Unable to size forcing store " + path + ": " + std::strerror(errno));
+            }
+        }
+        catch( ... ) {
+            ::close(fd);
+            throw;
+        }
+    }
+
+    ForcingStoreWriter::~ForcingStoreWriter()
+    {
+        if( fd >= 0 ) {
+            ::close(fd);
+        }
+    }
+
+    void ForcingStoreWriter::write_catchments(std::size_t first_id, std::size_t count, const double* batch)
+    {
+        if( fd < 0 ) {
+            throw std::runtime_error("Forcing store " + path + " is closed.");
+        }
+        if( first_id + count > num_ids ) {
+            throw std::out_of_range("Forcing store " + path + " has no catchment " + std::to_string(first_id + count - 1));
+        }
+        // each time step and variable of the batch is one contiguous run of the record
+        for( std::size_t r = 0; r < num_times * num_variables; ++r ) {
+            write_fully(fd, reinterpret_cast<const char*>(batch + r * count), count * sizeof(double),
+                        data_offset + (r * num_ids + first_id) * sizeof(double), path);
+        }
+    }
+
+    void ForcingStoreWriter::close()
+    {
+        if( fd >= 0 ) {
+            int result = ::close(fd);
+            fd = -1;
+            if( result != 0 ) {
+                throw std::runtime_error("Unable to write forcing store " + path + ": " + std::strerror(errno));
+            }
+        }
+    }
+
+    void convert_csv_forcing(const std::vector<std::pair<std::string, std::string>>& id_files, const std::string& path,
+                             std::size_t memory_mb)
+    {
+        if( id_files.empty() ) {
+            throw std::runtime_error("No forcing files to convert to " + path + ".");
+        }
+
+        // the first file sets the variables and times every file must have
+        const std::string& first_file = id_files[0].second;
+        CsvLayout layout = read_csv_layout(first_file);
+        const std::vector<time_t>& times = layout.times;
+        if( times.size() < 2 ) {
+            throw std::runtime_error("Error: Forcing data " + first_file + " needs at least two time steps.");
+        }
+        const long time_step = times[1] - times[0];
+        for( std::size_t i = 1; i < times.size(); ++i ) {
+            if( times[i] - times[i - 1] != time_step || time_step <= 0 ) {
+                throw std::runtime_error("Error: Time intervals in forcing data " + first_file + " are not constant.");
+            }
+        }
+
+        std::vector<std::pair<std::string, std::string>> variables;
+        std::vector<std::size_t> var_cols;
+        for( std::size_t c = 0; c < layout.header.size(); ++c ) {
+            if( c == layout.time_col ) continue;
+            const std::string& name = layout.header[c];
+            auto wkf = WellKnownFields.find(name);
+            variables.emplace_back(name, wkf != WellKnownFields.end() ? std::get<1>(wkf->second) : "");
+            var_cols.push_back(c);
+        }
+
+        std::vector<std::string> ids;
+        for( const auto& id_file : id_files ) {
+            ids.push_back(id_file.first);
+        }
+
+        const std::size_t num_times = times.size();
+        const std::size_t num_vars = variables.size();
+        const std::size_t catchment_bytes = num_times * num_vars * sizeof(double);
+        const std::size_t batch_size = std::max<std::size_t>(1, (memory_mb << 20) / std::max<std::size_t>(1, catchment_bytes));
+
+        ForcingStoreWriter writer(path, ids, variables, times[0], time_step, num_times);
+        std::vector<double> batch;
+        std::vector<utils::MappedCsvReader::Field> row;
+        for( std::size_t first = 0; first < ids.size(); first += batch_size ) {
+            const std::size_t count = std::min(batch_size, ids.size() - first);
+            batch.assign(num_times * num_vars * count, 0.0);
+            for( std::size_t j = 0; j < count; ++j ) {
+                const std::string& file_name = id_files[first + j].second;
+                utils::MappedCsvReader reader(file_name);
+                bool same_header = reader.next_row(row) && row.size() == layout.header.size();
+                for( std::size_t c = 0; same_header && c < row.size(); ++c ) {
+                    same_header = row[c] == layout.header[c].c_str();
+                }
+                if( !same_header ) {
+                    throw std::runtime_error("Error: Forcing data " + file_name + " does not have the columns of " + first_file + ".");
+                }
+                std::size_t t = 0;
+                for( ; reader.next_row(row); ++t ) {
+                    if( t >= num_times || layout.time_col >= row.size() || parse_time(row[layout.time_col]) != times[t] ) {
+                        throw std::runtime_error("Error: Forcing data " + file_name + " does not have the times of " + first_file + ".");
+                    }
+                    for( std::size_t v = 0; v < num_vars; ++v ) {
+                        if( var_cols[v] >= row.size() ) {
+                            throw std::runtime_error("Error: Forcing data " + file_name + " is missing a value in row " + std::to_string(t + 1) + ".");
+                        }
+                        try {
+                            batch[(t * num_vars + v) * count + j] = utils::MappedCsvReader::parse_double(row[var_cols[v]]);
+                        }
+                        catch( const std::invalid_argument& e ) {
+                            throw std::runtime_error("Error: Forcing data " + file_name + " has an invalid value in row " + std::to_string(t + 1) + ": " + e.what());
+                        }
+                    }
+                }
+                if( t != num_times ) {
+                    throw std::runtime_error("Error: Forcing data " + file_name + " does not have the times of " + first_file + ".");
+                }
+            }
+            writer.write_catchments(first, count, batch.data());
+        }
+        writer.close();
+    }
+}
@@ -0,0 +1,4 @@
+#include "ForcingStoreDataProvider.hpp"
+
+std::mutex data_access::ForcingStoreDataProvider::shared_providers_mutex;
+std::map<std::string, std::shared_ptr<data_access::ForcingStoreDataProvider>> data_access::ForcingStoreDataProvider::shared_providers;
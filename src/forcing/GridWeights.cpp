@@ -0,0 +1,286 @@
+#include "GridWeights.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+#include <boost/geometry.hpp>
+
+namespace bg = boost::geometry;
+
+namespace data_access
+{
+    constexpr char GridWeights::MAGIC[8];
+    constexpr std::uint32_t GridWeights::VERSION;
+
+    namespace
+    {
+        typedef bg::model::box<GridWeights::point_t> box_t;
+
+        template<typename T>
+        void put(std::ostream& out, T value)
+        {
+            out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        template<typename T>
+        T get(std::istream& in, const std::string& path)
+        {
+            T value;
+            if( !in.read(reinterpret_cast<char*>(&value), sizeof(T)) ) {
+                throw std::runtime_error("Grid weights file " + path + " is truncated.");
+            }
+            return value;
+        }
+
+        template<typename T>
+        void put_vector(std::ostream& out, const std::vector<T>& values)
+        {
+            out.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+        }
+
+        template<typename T>
+        void get_vector(std::istream& in, std::vector<T>& values, std::size_t count, const std::string& path)
+        {
+            values.resize(count);
+            if( !in.read(reinterpret_cast<char*>(values.data()), count * sizeof(T)) ) {
+                throw std::runtime_error("Grid weights file " + path + " is truncated.");
+            }
+        }
+
+        /**
+         * The first and last index of the cells along one axis of a grid overlapping a range of coordinates, clamped
+         * to the grid; returns false if the range is outside of the grid.
+         */
+        bool cell_range(double low, double high, double first, double spacing, std::size_t count, std::size_t& first_cell, std::size_t& last_cell)
+        {
+            // the edge of the first cell, on the side away from the second
+            const double edge = first - spacing / 2.0;
+            double a = std::floor((low - edge) / spacing);
+            double b = std::floor((high - edge) / spacing);
+            if( a > b ) {
+                std::swap(a, b);
+            }
+            if( b < 0.0 || a >= static_cast<double>(count) ) {
+                return false;
+            }
+            first_cell = static_cast<std::size_t>(std::max(a, 0.0));
+            last_cell = static_cast<std::size_t>(std::min(b, static_cast<double>(count - 1)));
+            return true;
+        }
+
+        box_t cell_box(const GridSpec& grid, std::size_t row, std::size_t column)
+        {
+            const double x = grid.x_first + column * grid.dx;
+            const double y = grid.y_first + row * grid.dy;
+            const double half_x = std::abs(grid.dx) / 2.0;
+            const double half_y = std::abs(grid.dy) / 2.0;
+            return box_t(GridWeights::point_t(x - half_x, y - half_y), GridWeights::point_t(x + half_x, y + half_y));
+        }
+    }
+
+    GridWeights GridWeights::compute(const GridSpec& grid, const std::vector<std::pair<std::string, multipolygon_t>>& catchments)
+    {
+        struct Overlap
+        {
+            std::size_t row;
+            std::size_t column;
+            double area;
+        };
+
+        GridWeights result;
+        result.grid = grid;
+        const double cell_area = std::abs(grid.dx * grid.dy);
+        std::vector<std::vector<Overlap>> overlaps(catchments.size());
+        std::size_t min_row = std::numeric_limits<std::size_t>::max(), max_row = 0;
+        std::size_t min_column = std::numeric_limits<std::size_t>::max(), max_column = 0;
+
+        for( std::size_t i = 0; i < catchments.size(); ++i ) {
+            result.ids.push_back(catchments[i].first);
+            // GeoJSON rings wind counterclockwise, the reverse of the polygons' default
+            multipolygon_t shape = catchments[i].second;
+            bg::correct(shape);
+            if( bg::is_empty(shape) || grid.nx == 0 || grid.ny == 0 ) {
+                continue;
+            }
+            box_t envelope;
+            bg::envelope(shape, envelope);
+            std::size_t row1, row2, column1, column2;
+            if( !cell_range(envelope.min_corner().y(), envelope.max_corner().y(), grid.y_first, grid.dy, grid.ny, row1, row2)
+                || !cell_range(envelope.min_corner().x(), envelope.max_corner().x(), grid.x_first, grid.dx, grid.nx, column1, column2) ) {
+                continue;
+            }
+            for( std::size_t row = row1; row <= row2; ++row ) {
+                for( std::size_t column = column1; column <= column2; ++column ) {
+                    GridWeights::polygon_t cell;
+                    bg::convert(cell_box(grid, row, column), cell);
+                    double area;
+                    if( bg::within(cell, shape) ) {
+                        area = cell_area;
+                    }
+                    else {
+                        multipolygon_t inside;
+                        bg::intersection(cell, shape, inside);
+                        area = bg::area(inside);
+                    }
+                    if( area > 0.0 ) {
+                        overlaps[i].push_back({row, column, area});
+                        min_row = std::min(min_row, row);
+                        max_row = std::max(max_row, row);
+                        min_column = std::min(min_column, column);
+                        max_column = std::max(max_column, column);
+                    }
+                }
+            }
+        }
+
+        if( min_row <= max_row ) {
+            result.window_row = min_row;
+            result.window_column = min_column;
+            result.window_rows = max_row - min_row + 1;
+            result.window_columns = max_column - min_column + 1;
+        }
+        if( result.window_rows * result.window_columns > std::numeric_limits<std::uint32_t>::max() ) {
+            throw std::runtime_error("The catchments overlap a window of the forcing grid too large to weight.");
+        }
+        for( const auto& catchment : overlaps ) {
+            double total = 0.0;
+            for( const Overlap& overlap : catchment ) {
+                total += overlap.area;
+            }
+            for( const Overlap& overlap : catchment ) {
+                result.cells.push_back((overlap.row - result.window_row) * result.window_columns + overlap.column - result.window_column);
+                result.weights.push_back(overlap.area / total);
+            }
+            result.row_start.push_back(result.cells.size());
+        }
+        result.index_ids();
+        return result;
+    }
+
+    GridWeights GridWeights::subset(const std::vector<std::string>& subset_ids) const
+    {
+        std::vector<std::size_t> rows;
+        std::size_t min_row = std::numeric_limits<std::size_t>::max(), max_row = 0;
+        std::size_t min_column = std::numeric_limits<std::size_t>::max(), max_column = 0;
+        for( const std::string& id : subset_ids ) {
+            const std::size_t row = get_index(id);
+            if( row == ids.size() ) {
+                throw std::out_of_range("Catchment " + id + " has no grid weights.");
+            }
+            rows.push_back(row);
+            for( std::uint64_t k = row_start[row]; k < row_start[row + 1]; ++k ) {
+                min_row = std::min<std::size_t>(min_row, cells[k] / window_columns);
+                max_row = std::max<std::size_t>(max_row, cells[k] / window_columns);
+                min_column = std::min<std::size_t>(min_column, cells[k] % window_columns);
+                max_column = std::max<std::size_t>(max_column, cells[k] % window_columns);
+            }
+        }
+
+        GridWeights result;
+        result.grid = grid;
+        if( min_row <= max_row ) {
+            result.window_row = window_row + min_row;
+            result.window_column = window_column + min_column;
+            result.window_rows = max_row - min_row + 1;
+            result.window_columns = max_column - min_column + 1;
+        }
+        for( std::size_t row : rows ) {
+            result.ids.push_back(ids[row]);
+            for( std::uint64_t k = row_start[row]; k < row_start[row + 1]; ++k ) {
+                const std::size_t cell_row = cells[k] / window_columns - min_row;
+                const std::size_t cell_column = cells[k] % window_columns - min_column;
+                result.cells.push_back(cell_row * result.window_columns + cell_column);
+                result.weights.push_back(weights[k]);
+            }
+            result.row_start.push_back(result.cells.size());
+        }
+        result.index_ids();
+        return result;
+    }
+
+    GridWeights GridWeights::read(const std::string& path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        if( !in ) {
+            throw std::runtime_error("Unable to open grid weights file " + path);
+        }
+        char magic[sizeof(MAGIC)];
+        if( !in.read(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 ) {
+            throw std::runtime_error(path + " is not a grid weights file.");
+        }
+        if( get<std::uint32_t>(in, path) != VERSION ) {
+            throw std::runtime_error("Grid weights file " + path + " is of a version this build cannot read.");
+        }
+        GridWeights result;
+        result.grid.x_first = get<double>(in, path);
+        result.grid.y_first = get<double>(in, path);
+        result.grid.dx = get<double>(in, path);
+        result.grid.dy = get<double>(in, path);
+        result.grid.nx = get<std::uint64_t>(in, path);
+        result.grid.ny = get<std::uint64_t>(in, path);
+        result.window_row = get<std::uint64_t>(in, path);
+        result.window_column = get<std::uint64_t>(in, path);
+        result.window_rows = get<std::uint64_t>(in, path);
+        result.window_columns = get<std::uint64_t>(in, path);
+        const std::uint64_t num_ids = get<std::uint64_t>(in, path);
+        for( std::uint64_t i = 0; i < num_ids; ++i ) {
+            std::string id(get<std::uint32_t>(in, path), '\0');
+            if( !in.read(&id[0], id.size()) ) {
+                throw std::runtime_error("Grid weights file " + path + " is truncated.");
+            }
+            result.ids.push_back(std::move(id));
+        }
+        get_vector(in, result.row_start, num_ids + 1, path);
+        get_vector(in, result.cells, result.row_start.back(), path);
+        get_vector(in, result.weights, result.row_start.back(), path);
+        result.index_ids();
+        return result;
+    }
+
+    void GridWeights::write(const std::string& path) const
+    {
+        const std::string temporary_path = path + ".tmp";
+        {
+            std::ofstream out(temporary_path, std::ios::binary | std::ios::trunc);
+            out.write(MAGIC, sizeof(MAGIC));
+            put(out, VERSION);
+            put(out, grid.x_first);
+            put(out, grid.y_first);
+            put(out, grid.dx);
+            put(out, grid.dy);
+            put<std::uint64_t>(out, grid.nx);
+            put<std::uint64_t>(out, grid.ny);
+            put<std::uint64_t>(out, window_row);
+            put<std::uint64_t>(out, window_column);
+            put<std::uint64_t>(out, window_rows);
+            put<std::uint64_t>(out, window_columns);
+            put<std::uint64_t>(out, ids.size());
+            for( const std::string& id : ids ) {
+                put<std::uint32_t>(out, id.size());
+                out.write(id.data(), id.size());
+            }
+            put_vector(out, row_start);
+            put_vector(out, cells);
+            put_vector(out, weights);
+            if( !out ) {
+                throw std::runtime_error("Unable to write grid weights file " + temporary_path);
+            }
+        }
+        if( std::rename(temporary_path.c_str(), path.c_str()) != 0 ) {
+            throw std::runtime_error("Unable to replace grid weights file " + path);
+        }
+    }
+
+    void GridWeights::index_ids()
+    {
+        index.clear();
+        for( std::size_t i = 0; i < ids.size(); ++i ) {
+            index[ids[i]] = i;
+        }
+    }
+}
@@ -0,0 +1,9 @@
+#ifdef NETCDF_ACTIVE
+#include "NetCDFGriddedDataProvider.hpp"
+
+std::mutex data_access::NetCDFGriddedDataProvider::shared_providers_mutex;
+std::map<std::string, std::shared_ptr<data_access::NetCDFGriddedDataProvider>> data_access::NetCDFGriddedDataProvider::shared_providers;
+constexpr size_t data_access::NetCDFGriddedDataProvider::DEFAULT_CACHE_SIZE_MB;
+constexpr size_t data_access::NetCDFGriddedDataProvider::DEFAULT_CACHE_TIME_BLOCK;
+
+#endif
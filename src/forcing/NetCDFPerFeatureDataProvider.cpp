@@ -3,5 +3,9 @@
 
 std::mutex data_access::NetCDFPerFeatureDataProvider::shared_providers_mutex;
 std::map<std::string, std::shared_ptr<data_access::NetCDFPerFeatureDataProvider>> data_access::NetCDFPerFeatureDataProvider::shared_providers;
+constexpr size_t data_access::NetCDFPerFeatureDataProvider::DEFAULT_CACHE_SIZE_MB;
+constexpr size_t data_access::NetCDFPerFeatureDataProvider::DEFAULT_CACHE_TIME_BLOCK;
+constexpr size_t data_access::NetCDFPerFeatureDataProvider::DEFAULT_PREFETCH_BLOCKS;
+constexpr size_t data_access::NetCDFPerFeatureDataProvider::NO_BATCH_SLOT;
 
 #endif
@@ -0,0 +1,4 @@
+#include "PushedForcingDataProvider.hpp"
+
+std::mutex data_access::PushedForcingDataProvider::shared_providers_mutex;
+std::map<std::string, std::shared_ptr<data_access::PushedForcingDataProvider>> data_access::PushedForcingDataProvider::shared_providers;
@@ -0,0 +1,417 @@
+#include "RemoteObject.hpp"
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef NGEN_CURL_ACTIVE
+#include <curl/curl.h>
+#endif
+
+namespace data_access
+{
+    constexpr std::uint64_t BlockCache::DEFAULT_CAPACITY_MB;
+    constexpr std::size_t RemoteObject::DEFAULT_BLOCK_SIZE;
+    constexpr std::size_t RemoteObject::DEFAULT_CONCURRENCY;
+
+    namespace
+    {
+        /** The FNV-1a hash of some text, in hexadecimal. */
+        std::string hash_hex(const std::string& text)
+        {
+            std::uint64_t hash = 14695981039346656037ULL;
+            for( unsigned char c : text ) {
+                hash = (hash ^ c) * 1099511628211ULL;
+            }
+            char hex[17];
+            std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(hash));
+            return hex;
+        }
+
+        bool starts_with(const std::string& s, const std::string& prefix)
+        {
+            return s.compare(0, prefix.size(), prefix) == 0;
+        }
+
+        void make_directories(const std::string& directory)
+        {
+            for( std::size_t slash = directory.find('/', 1); ; slash = directory.find('/', slash + 1) ) {
+                const std::string part = directory.substr(0, slash);
+                if( ::mkdir(part.c_str(), 0777) != 0 && errno != EEXIST ) {
+                    throw std::runtime_error("Unable to create block cache directory " + part + ": " + std::strerror(errno));
+                }
+                if( slash == std::string::npos ) {
+                    break;
+                }
+            }
+        }
+
+        #ifdef NGEN_CURL_ACTIVE
+        /** The failures worth trying again: those of the connection, throttling and errors of the server. */
+        bool is_transient(CURLcode code, long status)
+        {
+            return code == CURLE_COULDNT_CONNECT || code == CURLE_OPERATION_TIMEDOUT || code == CURLE_RECV_ERROR
+                   || code == CURLE_SEND_ERROR || code == CURLE_GOT_NOTHING || code == CURLE_PARTIAL_FILE
+                   || (code == CURLE_OK && (status == 429 || status >= 500));
+        }
+
+        size_t append_body(char* data, size_t size, size_t count, void* body)
+        {
+            static_cast<std::string*>(body)->append(data, size * count);
+            return size * count;
+        }
+
+        size_t find_etag(char* data, size_t size, size_t count, void* etag)
+        {
+            std::string header(data, size * count);
+            if( header.size() > 5 && strncasecmp(header.c_str(), "etag:", 5) == 0 ) {
+                const std::size_t begin = header.find_first_not_of(" \t", 5);
+                const std::size_t end = header.find_last_not_of(" \t\r\n");
+                *static_cast<std::string*>(etag) = begin <= end ? header.substr(begin, end - begin + 1) : "";
+            }
+            return size * count;
+        }
+
+        /**
+         * Perform a request, trying transient failures again a few times with a growing delay.
+         *
+         * @param configure Sets the options of the request on a fresh handle.
+         * @param inspect Reads what it needs of the response from the handle, once the request succeeds.
+         * @return The HTTP status.
+         */
+        long perform(const std::string& url, const std::function<void(CURL*)>& configure,
+                     const std::function<void(CURL*)>& inspect = nullptr)
+        {
+            static std::once_flag initialized;
+            std::call_once(initialized, [] { curl_global_init(CURL_GLOBAL_DEFAULT); });
+            const int attempts = 4;
+            for( int attempt = 1; ; ++attempt ) {
+                std::unique_ptr<CURL, decltype(&curl_easy_cleanup)> curl(curl_easy_init(), &curl_easy_cleanup);
+                if( !curl ) {
+                    throw std::runtime_error("Unable to start a request for " + url);
+                }
+                curl_easy_setopt(curl.get(), CURLOPT_URL, url.c_str());
+                curl_easy_setopt(curl.get(), CURLOPT_FOLLOWLOCATION, 1L);
+                curl_easy_setopt(curl.get(), CURLOPT_NOSIGNAL, 1L);
+                curl_easy_setopt(curl.get(), CURLOPT_CONNECTTIMEOUT, 30L);
+                configure(curl.get());
+                const CURLcode code = curl_easy_perform(curl.get());
+                long status = 0;
+                curl_easy_getinfo(curl.get(), CURLINFO_RESPONSE_CODE, &status);
+                if( code == CURLE_OK && status < 400 ) {
+                    if( inspect ) {
+                        inspect(curl.get());
+                    }
+                    return status;
+                }
+                if( attempt == attempts || !is_transient(code, status) ) {
+                    throw std::runtime_error("Unable to read " + url + ": "
+                                             + (code == CURLE_OK ? "HTTP status " + std::to_string(status) : curl_easy_strerror(code)));
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(250 << attempt));
+            }
+        }
+        #endif // NGEN_CURL_ACTIVE
+    }
+
+    bool is_remote_path(const std::string& path)
+    {
+        return starts_with(path, "http://") || starts_with(path, "https://") || starts_with(path, "s3://");
+    }
+
+    std::string remote_url(const std::string& path)
+    {
+        if( !starts_with(path, "s3://") ) {
+            return path;
+        }
+        const std::string location = path.substr(5);
+        const std::size_t slash = location.find('/');
+        if( slash == std::string::npos || slash == 0 ) {
+            throw std::invalid_argument("S3 path " + path + " has no bucket and key.");
+        }
+        const char* endpoint = std::getenv("AWS_ENDPOINT_URL");
+        if( endpoint != nullptr && *endpoint != '\0' ) {
+            std::string base(endpoint);
+            while( !base.empty() && base.back() == '/' ) {
+                base.pop_back();
+            }
+            return base + "/" + location;
+        }
+        return "https://" + location.substr(0, slash) + ".s3.amazonaws.com" + location.substr(slash);
+    }
+
+    std::string netcdf_path(const std::string& path)
+    {
+        if( !is_remote_path(path) || path.find("#mode=") != std::string::npos ) {
+            return path;
+        }
+        return remote_url(path) + "#mode=bytes";
+    }
+
+    BlockCache::BlockCache(std::string directory, std::uint64_t capacity_bytes)
+        : directory(std::move(directory)), capacity(capacity_bytes)
+    {
+        while( this->directory.size() > 1 && this->directory.back() == '/' ) {
+            this->directory.pop_back();
+        }
+        make_directories(this->directory);
+    }
+
+    std::shared_ptr<BlockCache> BlockCache::get_default()
+    {
+        static std::shared_ptr<BlockCache> cache = [] {
+            std::string directory;
+            if( const char* configured = std::getenv("NGEN_BLOCK_CACHE_DIR") ) {
+                directory = configured;
+            }
+            if( directory.empty() ) {
+                const char* tmp = std::getenv("TMPDIR");
+                directory = std::string(tmp != nullptr && *tmp != '\0' ? tmp : "/tmp") + "/ngen-block-cache";
+            }
+            std::uint64_t capacity_mb = DEFAULT_CAPACITY_MB;
+            if( const char* configured = std::getenv("NGEN_BLOCK_CACHE_MB") ) {
+                capacity_mb = std::strtoull(configured, nullptr, 10);
+            }
+            return std::make_shared<BlockCache>(directory, capacity_mb << 20);
+        }();
+        return cache;
+    }
+
+    std::string BlockCache::block_path(const std::string& key) const
+    {
+        return directory + "/" + key;
+    }
+
+    bool BlockCache::get(const std::string& key, std::string& block) const
+    {
+        const std::string path = block_path(key);
+        std::ifstream in(path, std::ios::binary);
+        if( !in ) {
+            return false;
+        }
+        std::ostringstream contents;
+        contents << in.rdbuf();
+        if( !in && !in.eof() ) {
+            return false;
+        }
+        block = contents.str();
+        // the modification time orders the blocks for eviction
+        ::utimensat(AT_FDCWD, path.c_str(), nullptr, 0);
+        return true;
+    }
+
+    void BlockCache::put(const std::string& key, const std::string& block)
+    {
+        const std::string path = block_path(key);
+        std::ostringstream temporary;
+        temporary << path << "." << ::getpid() << "." << std::hash<std::thread::id>()(std::this_thread::get_id()) << ".tmp";
+        {
+            std::ofstream out(temporary.str(), std::ios::binary | std::ios::trunc);
+            out.write(block.data(), block.size());
+            if( !out ) {
+                out.close();
+                std::remove(temporary.str().c_str());
+                return;
+            }
+        }
+        if( std::rename(temporary.str().c_str(), path.c_str()) != 0 ) {
+            std::remove(temporary.str().c_str());
+            return;
+        }
+        if( capacity > 0 && (written += block.size()) > capacity / 8 ) {
+            evict();
+        }
+    }
+
+    void BlockCache::evict()
+    {
+        std::unique_lock<std::mutex> lock(eviction_mutex, std::try_to_lock);
+        if( !lock.owns_lock() ) {
+            return;
+        }
+        written = 0;
+
+        struct Entry
+        {
+            std::string path;
+            std::uint64_t size;
+            struct timespec modified;
+        };
+        std::vector<Entry> entries;
+        std::uint64_t total = 0;
+        DIR* dir = ::opendir(directory.c_str());
+        if( dir == nullptr ) {
+            return;
+        }
+        while( struct dirent* entry = ::readdir(dir) ) {
+            const std::string name = entry->d_name;
+            // blocks being written by other processes are theirs to finish
+            if( name == "." || name == ".." || (name.size() > 4 && name.compare(name.size() - 4, 4, ".tmp") == 0) ) {
+                continue;
+            }
+            struct stat st;
+            const std::string path = block_path(name);
+            if( ::stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode) ) {
+                entries.push_back({path, static_cast<std::uint64_t>(st.st_size), st.st_mtim});
+                total += st.st_size;
+            }
+        }
+        ::closedir(dir);
+        if( total <= capacity ) {
+            return;
+        }
+        std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+            return a.modified.tv_sec != b.modified.tv_sec ? a.modified.tv_sec < b.modified.tv_sec : a.modified.tv_nsec < b.modified.tv_nsec;
+        });
+        for( const Entry& entry : entries ) {
+            if( total <= capacity ) {
+                break;
+            }
+            // another process may have removed it already
+            if( std::remove(entry.path.c_str()) == 0 || errno == ENOENT ) {
+                total -= entry.size;
+            }
+        }
+    }
+
+    class RemoteObject::Pool
+    {
+        public:
+
+        explicit Pool(std::size_t threads) : threads(threads) {}
+
+        utils::ThreadPool threads;
+        std::mutex mutex;       // a pool runs one loop at a time
+    };
+
+    RemoteObject::Fetcher RemoteObject::http_fetcher()
+    {
+        Fetcher fetcher;
+        #ifdef NGEN_CURL_ACTIVE
+        fetcher.stat = [](const std::string& url) {
+            Info info;
+            curl_off_t length = -1;
+            perform(url, [&info](CURL* curl) {
+                info.etag.clear();
+                curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+                curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, &find_etag);
+                curl_easy_setopt(curl, CURLOPT_HEADERDATA, &info.etag);
+            }, [&length](CURL* curl) {
+                // the length of a HEAD response is that of the object
+                curl_easy_getinfo(curl, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &length);
+            });
+            if( length < 0 ) {
+                throw std::runtime_error("Unable to find the size of " + url);
+            }
+            info.size = static_cast<std::uint64_t>(length);
+            return info;
+        };
+        fetcher.range = [](const std::string& url, std::uint64_t offset, std::uint64_t length) {
+            std::string body;
+            if( length == 0 ) {
+                return body;
+            }
+            body.reserve(length);
+            const std::string range = std::to_string(offset) + "-" + std::to_string(offset + length - 1);
+            const long status = perform(url, [&body, &range](CURL* curl) {
+                body.clear();
+                curl_easy_setopt(curl, CURLOPT_RANGE, range.c_str());
+                curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, &append_body);
+                curl_easy_setopt(curl, CURLOPT_WRITEDATA, &body);
+            });
+            // a server ignoring the range sends the whole object
+            if( status == 200 && body.size() > length ) {
+                body = body.substr(offset, length);
+            }
+            return body;
+        };
+        #else
+        fetcher.stat = [](const std::string& url) -> Info {
+            throw std::runtime_error("Unable to read " + url + ": this build of ngen cannot read object storage; build it with -DCURL_ACTIVE=ON.");
+        };
+        fetcher.range = [](const std::string& url, std::uint64_t, std::uint64_t) -> std::string {
+            throw std::runtime_error("Unable to read " + url + ": this build of ngen cannot read object storage; build it with -DCURL_ACTIVE=ON.");
+        };
+        #endif // NGEN_CURL_ACTIVE
+        return fetcher;
+    }
+
+    RemoteObject::RemoteObject(const std::string& path, Fetcher fetcher, std::shared_ptr<BlockCache> cache,
+                               std::size_t block_size, std::size_t concurrency)
+        : url(is_remote_path(path) ? remote_url(path) : path), fetcher(std::move(fetcher)), cache(std::move(cache)),
+          block_size(std::max<std::size_t>(block_size, 1)), pool(new Pool(std::max<std::size_t>(concurrency, 1)))
+    {
+        info = this->fetcher.stat(url);
+        key_prefix = hash_hex(url) + "-" + hash_hex(info.etag + "/" + std::to_string(info.size) + "/" + std::to_string(this->block_size));
+    }
+
+    RemoteObject::~RemoteObject() = default;
+
+    std::string RemoteObject::block(std::uint64_t index) const
+    {
+        const std::string key = key_prefix + "." + std::to_string(index);
+        std::string contents;
+        const std::uint64_t offset = index * block_size;
+        const std::uint64_t length = std::min<std::uint64_t>(block_size, info.size - offset);
+        if( cache && cache->get(key, contents) && contents.size() == length ) {
+            return contents;
+        }
+        contents = fetcher.range(url, offset, length);
+        if( contents.size() != length ) {
+            throw std::runtime_error("Read " + std::to_string(contents.size()) + " bytes rather than " + std::to_string(length)
+                                     + " at " + std::to_string(offset) + " of " + url);
+        }
+        if( cache ) {
+            cache->put(key, contents);
+        }
+        return contents;
+    }
+
+    void RemoteObject::read(std::uint64_t offset, std::size_t length, char* out) const
+    {
+        if( offset > info.size || length > info.size - offset ) {
+            throw std::out_of_range("Read past the end of " + url);
+        }
+        if( length == 0 ) {
+            return;
+        }
+        const std::uint64_t first = offset / block_size;
+        const std::uint64_t last = (offset + length - 1) / block_size;
+        auto copy = [&](std::uint64_t index, const std::string& contents) {
+            const std::uint64_t begin = std::max<std::uint64_t>(offset, index * block_size);
+            const std::uint64_t end = std::min<std::uint64_t>(offset + length, index * block_size + contents.size());
+            std::memcpy(out + (begin - offset), contents.data() + (begin - index * block_size), end - begin);
+        };
+        if( first == last ) {
+            copy(first, block(first));
+            return;
+        }
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        pool->threads.parallel_for(last - first + 1, [&](std::size_t i) {
+            copy(first + i, block(first + i));
+        });
+    }
+
+    std::string RemoteObject::read_all() const
+    {
+        std::string contents(info.size, '\0');
+        read(0, contents.size(), &contents[0]);
+        return contents;
+    }
+}
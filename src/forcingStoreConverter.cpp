@@ -0,0 +1,117 @@
+#include <FileChecker.h>
+#include <boost/lexical_cast.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <algorithm>
+#include <iostream>
+#include <regex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <dirent.h>
+
+#include "ForcingStore.hpp"
+
+/**
+ * @brief List the per catchment CSV forcing files in a directory, with the catchment id taken from each file name
+ *
+ * File names starting with a ``cat-<number>`` id (e.g. ``cat-27_forcing.csv``) use that id, other files their name
+ * without the ``.csv`` extension.  Files are listed by name.
+ */
+std::vector<std::pair<std::string, std::string>> list_forcing_files(const std::string& dir_name)
+{
+    DIR* dir = opendir(dir_name.c_str());
+    if( dir == nullptr ) {
+        throw std::runtime_error("Unable to read forcing directory " + dir_name);
+    }
+    std::vector<std::string> names;
+    while( struct dirent* entry = readdir(dir) ) {
+        std::string name = entry->d_name;
+        if( name.size() > 4 && name.compare(name.size() - 4, 4, ".csv") == 0 ) {
+            names.push_back(name);
+        }
+    }
+    closedir(dir);
+    std::sort(names.begin(), names.end());
+
+    const std::regex cat_id("^(cat-[0-9]+).*");
+    std::vector<std::pair<std::string, std::string>> id_files;
+    for( const auto& name : names ) {
+        std::smatch match;
+        std::string id = std::regex_match(name, match, cat_id) ? match[1].str() : name.substr(0, name.size() - 4);
+        id_files.emplace_back(id, dir_name + "/" + name);
+    }
+    return id_files;
+}
+
+/**
+ * @brief Reorder catchments so the catchments of each partition of a partition config are stored next to each other
+ *
+ * Catchments keep their relative order within a partition; catchments in no partition go last.
+ */
+void order_by_partition(std::vector<std::pair<std::string, std::string>>& id_files, const std::string& partition_file)
+{
+    boost::property_tree::ptree tree;
+    boost::property_tree::json_parser::read_json(partition_file, tree);
+    std::unordered_map<std::string, size_t> partition_of;
+    size_t partition = 0;
+    for( auto& part : tree.get_child("partitions") ) {
+        for( auto& cat_id : part.second.get_child("cat-ids") ) {
+            partition_of.emplace(cat_id.second.get_value<std::string>(), partition);
+        }
+        ++partition;
+    }
+    std::stable_sort(id_files.begin(), id_files.end(), [&](const std::pair<std::string, std::string>& a, const std::pair<std::string, std::string>& b)
+    {
+        auto pa = partition_of.find(a.first);
+        auto pb = partition_of.find(b.first);
+        return (pa != partition_of.end() ? pa->second : partition) < (pb != partition_of.end() ? pb->second : partition);
+    });
+}
+
+int main(int argc, char* argv[])
+{
+    if( argc < 3 ){
+        std::cout << "Missing required args:" << std::endl;
+        std::cout << argv[0] << " <csv_forcing_directory> <forcing_store_output_name> [partition_config] [memory_mb]" << std::endl;
+        std::cout << "Converts the per catchment CSV forcing files of a directory into a single forcing store file, read with the"<<std::endl;
+        std::cout << "\"ForcingStore\" forcing provider.  Every file must have the same columns and times."<<std::endl;
+        std::cout << "Given a partition config (see partitionGenerator), the catchments of each partition are stored next to each other."<<std::endl;
+        std::cout << "memory_mb (default 1024) bounds the memory used to hold catchments while they are written."<<std::endl;
+        exit(-1);
+    }
+
+    std::string partition_file = argc > 3 ? argv[3] : "";
+    size_t memory_mb = 1024;
+    if( partition_file != "" && !utils::FileChecker::file_is_readable(partition_file) ) {
+        std::cout<<"partition config path "<<partition_file<<" not readable"<<std::endl;
+        exit(-1);
+    }
+    if( argc > 4 ){
+        try {
+            memory_mb = boost::lexical_cast<size_t>(argv[4]);
+            if(memory_mb == 0) throw boost::bad_lexical_cast();
+        }
+        catch(boost::bad_lexical_cast &e) {
+            std::cout<<"memory_mb must be a postive integer."<<std::endl;
+            exit(-1);
+        }
+    }
+
+    try {
+        std::vector<std::pair<std::string, std::string>> id_files = list_forcing_files(argv[1]);
+        if( partition_file != "" ) {
+            order_by_partition(id_files, partition_file);
+        }
+        std::cout<<"Converting "<<id_files.size()<<" forcing files to "<<argv[2]<<std::endl;
+        data_access::convert_csv_forcing(id_files, argv[2], memory_mb);
+    }
+    catch(const std::exception& e) {
+        std::cerr<<e.what()<<std::endl;
+        exit(-1);
+    }
+    return 0;
+}
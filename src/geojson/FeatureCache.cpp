@@ -0,0 +1,614 @@
+#include "FeatureCache.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_set>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    using namespace geojson;
+
+    const char MAGIC[8] = {'N', 'G', 'E', 'N', 'H', 'F', 'C', '1'};
+    // Written natively; a cache from a machine of different endianness reads this back differently
+    const std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+    const std::uint32_t FLAG_GEOMETRY = 1;
+
+    struct Header {
+        char magic[8];
+        std::uint32_t byte_order;
+        std::uint32_t flags;
+        std::uint64_t source_size;
+        std::uint64_t source_hash;
+        std::uint64_t feature_count;
+        std::uint64_t index_offset;
+    };
+
+    /**
+     * Buffered binary writer of the cache format.
+     */
+    class Writer {
+        public:
+            explicit Writer(std::ostream& stream) : stream(stream) {}
+
+            template <typename T>
+            void put(const T& value) {
+                stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+            }
+
+            void put_string(const std::string& value) {
+                put<std::uint32_t>(value.size());
+                stream.write(value.data(), value.size());
+            }
+
+            void put_doubles(const std::vector<double>& values) {
+                put<std::uint32_t>(values.size());
+                stream.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(double));
+            }
+
+            void put_point(const coordinate_t& point) {
+                put<double>(point.get<0>());
+                put<double>(point.get<1>());
+            }
+
+            template <typename Points>
+            void put_points(const Points& points) {
+                put<std::uint32_t>(points.size());
+                for (const auto& point : points) {
+                    put_point(point);
+                }
+            }
+
+            void put_polygon(const polygon_t& polygon) {
+                put<std::uint32_t>(polygon.inners().size());
+                put_points(polygon.outer());
+                for (const auto& inner : polygon.inners()) {
+                    put_points(inner);
+                }
+            }
+
+            void put_property(const JSONProperty& property) {
+                PropertyType type = property.get_type();
+                put<std::uint8_t>(static_cast<std::uint8_t>(type));
+                switch (type) {
+                    case PropertyType::Natural:
+                        put<std::int64_t>(property.as_natural_number());
+                        break;
+                    case PropertyType::Real:
+                        put<double>(property.as_real_number());
+                        break;
+                    case PropertyType::Boolean:
+                        put<std::uint8_t>(property.as_boolean());
+                        break;
+                    case PropertyType::String:
+                        put_string(property.as_string());
+                        break;
+                    case PropertyType::List: {
+                        std::vector<JSONProperty> values = property.as_list();
+                        put<std::uint32_t>(values.size());
+                        for (const auto& value : values) {
+                            put_property(value);
+                        }
+                        break;
+                    }
+                    case PropertyType::Object:
+                        put_properties(property.get_values());
+                        break;
+                }
+            }
+
+            void put_properties(const PropertyMap& properties) {
+                put<std::uint32_t>(properties.size());
+                for (const auto& property : properties) {
+                    put_string(property.first);
+                    put_property(property.second);
+                }
+            }
+
+            void put_geometry(const geometry& geom) {
+                put<std::uint8_t>(geom.which());
+                switch (geom.which()) {
+                    case 0:
+                        put_point(boost::get<coordinate_t>(geom));
+                        break;
+                    case 1:
+                        put_points(boost::get<linestring_t>(geom));
+                        break;
+                    case 2:
+                        put_polygon(boost::get<polygon_t>(geom));
+                        break;
+                    case 3:
+                        put_points(boost::get<multipoint_t>(geom));
+                        break;
+                    case 4: {
+                        const multilinestring_t& lines = boost::get<multilinestring_t>(geom);
+                        put<std::uint32_t>(lines.size());
+                        for (const auto& line : lines) {
+                            put_points(line);
+                        }
+                        break;
+                    }
+                    case 5: {
+                        const multipolygon_t& polygons = boost::get<multipolygon_t>(geom);
+                        put<std::uint32_t>(polygons.size());
+                        for (const auto& polygon : polygons) {
+                            put_polygon(polygon);
+                        }
+                        break;
+                    }
+                }
+            }
+
+            void put_feature(const FeatureBase& feature, bool include_geometry) {
+                put<std::uint8_t>(static_cast<std::uint8_t>(feature.get_type()));
+                put_string(feature.get_id());
+                std::vector<double> bounding_box = feature.get_bounding_box();
+                if (!include_geometry && bounding_box.empty()) {
+                    // Keep the extent of the geometry that is left out, as a slim load would
+                    BoundsVisitor visitor(bounding_box);
+                    if (feature.get_type() == FeatureType::GeometryCollection) {
+                        for (const auto& geom : feature.get_geometry_collection()) {
+                            boost::apply_visitor(visitor, geom);
+                        }
+                    }
+                    else if (feature.get_type() != FeatureType::None) {
+                        boost::apply_visitor(visitor, feature.geometry());
+                    }
+                }
+                put_doubles(bounding_box);
+                put_properties(feature.get_properties());
+                PropertyMap foreign_members;
+                for (const auto& key : feature.keys()) {
+                    foreign_members.emplace(key, feature.get(key));
+                }
+                put_properties(foreign_members);
+                if (!include_geometry) {
+                    return;
+                }
+                if (feature.get_type() == FeatureType::GeometryCollection || feature.get_type() == FeatureType::None) {
+                    std::vector<geometry> geometries = feature.get_type() == FeatureType::GeometryCollection
+                                                       ? feature.get_geometry_collection() : std::vector<geometry>();
+                    put<std::uint32_t>(geometries.size());
+                    for (const auto& geom : geometries) {
+                        put_geometry(geom);
+                    }
+                }
+                else {
+                    put_geometry(feature.geometry());
+                }
+            }
+
+        private:
+            std::ostream& stream;
+    };
+
+    /**
+     * Read only memory mapping of a whole file.
+     */
+    class MappedFile {
+        public:
+            explicit MappedFile(const std::string& path) {
+                int fd = ::open(path.c_str(), O_RDONLY);
+                if (fd < 0) {
+                    throw std::runtime_error("Cannot open feature cache " + path);
+                }
+                struct stat info;
+                if (::fstat(fd, &info) != 0) {
+                    ::close(fd);
+                    throw std::runtime_error("Cannot stat feature cache " + path);
+                }
+                size = info.st_size;
+                if (size > 0) {
+                    void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                    if (mapped == MAP_FAILED) {
+                        ::close(fd);
+                        throw std::runtime_error("Cannot map feature cache " + path);
+                    }
+                    data = static_cast<const char*>(mapped);
+                }
+                ::close(fd);
+            }
+
+            ~MappedFile() {
+                if (data != nullptr) {
+                    ::munmap(const_cast<char*>(data), size);
+                }
+            }
+
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+
+            const char* data = nullptr;
+            std::size_t size = 0;
+    };
+
+    /**
+     * Bounds checked decoder of the cache format.
+     */
+    class Reader {
+        public:
+            Reader(const char* data, std::size_t size, std::size_t position = 0)
+                : data(data), size(size), position(position) {}
+
+            template <typename T>
+            T get() {
+                T value;
+                std::memcpy(&value, take(sizeof(T)), sizeof(T));
+                return value;
+            }
+
+            std::string get_string() {
+                std::uint32_t length = get<std::uint32_t>();
+                return std::string(take(length), length);
+            }
+
+            std::vector<double> get_doubles() {
+                std::uint32_t count = get<std::uint32_t>();
+                std::vector<double> values(count);
+                std::memcpy(values.data(), take(count * sizeof(double)), count * sizeof(double));
+                return values;
+            }
+
+            coordinate_t get_point() {
+                double x = get<double>();
+                double y = get<double>();
+                return coordinate_t(x, y);
+            }
+
+            template <typename Points>
+            Points get_points() {
+                Points points;
+                std::uint32_t count = get<std::uint32_t>();
+                points.reserve(count);
+                for (std::uint32_t i = 0; i < count; ++i) {
+                    points.push_back(get_point());
+                }
+                return points;
+            }
+
+            polygon_t get_polygon() {
+                polygon_t polygon;
+                std::uint32_t inners = get<std::uint32_t>();
+                polygon.outer() = get_points<polygon_t::ring_type>();
+                polygon.inners().resize(inners);
+                for (auto& inner : polygon.inners()) {
+                    inner = get_points<polygon_t::ring_type>();
+                }
+                return polygon;
+            }
+
+            JSONProperty get_property(const std::string& key) {
+                switch (static_cast<PropertyType>(get<std::uint8_t>())) {
+                    case PropertyType::Natural:
+                        return JSONProperty(key, (long)get<std::int64_t>());
+                    case PropertyType::Real:
+                        return JSONProperty(key, get<double>());
+                    case PropertyType::Boolean:
+                        return JSONProperty(key, get<std::uint8_t>() != 0);
+                    case PropertyType::String:
+                        // Not the std::string constructor, which would re-infer the type from the text
+                        return JSONProperty(key, get_string().c_str());
+                    case PropertyType::List: {
+                        std::uint32_t count = get<std::uint32_t>();
+                        std::vector<JSONProperty> values;
+                        values.reserve(count);
+                        for (std::uint32_t i = 0; i < count; ++i) {
+                            values.push_back(get_property(key));
+                        }
+                        return JSONProperty(key, std::move(values));
+                    }
+                    case PropertyType::Object: {
+                        PropertyMap values = get_properties();
+                        return JSONProperty(key, values);
+                    }
+                }
+                throw std::runtime_error("Malformed feature cache: unknown property type");
+            }
+
+            PropertyMap get_properties() {
+                PropertyMap properties;
+                std::uint32_t count = get<std::uint32_t>();
+                for (std::uint32_t i = 0; i < count; ++i) {
+                    std::string key = get_string();
+                    properties.emplace(key, get_property(key));
+                }
+                return properties;
+            }
+
+            geometry get_geometry() {
+                switch (get<std::uint8_t>()) {
+                    case 0:
+                        return get_point();
+                    case 1:
+                        return get_points<linestring_t>();
+                    case 2:
+                        return get_polygon();
+                    case 3:
+                        return get_points<multipoint_t>();
+                    case 4: {
+                        multilinestring_t lines;
+                        lines.resize(get<std::uint32_t>());
+                        for (auto& line : lines) {
+                            line = get_points<linestring_t>();
+                        }
+                        return lines;
+                    }
+                    case 5: {
+                        multipolygon_t polygons;
+                        polygons.resize(get<std::uint32_t>());
+                        for (auto& polygon : polygons) {
+                            polygon = get_polygon();
+                        }
+                        return polygons;
+                    }
+                }
+                throw std::runtime_error("Malformed feature cache: unknown geometry type");
+            }
+
+            Feature get_feature(bool has_geometry, const FeatureLoadOptions& options) {
+                FeatureType type = static_cast<FeatureType>(get<std::uint8_t>());
+                std::string id = get_string();
+                std::vector<double> bounding_box = get_doubles();
+                PropertyMap properties = get_properties();
+                PropertyMap foreign_members = get_properties();
+
+                geometry geometry_object = empty_geometry(type);
+                std::vector<geometry> geometry_collection;
+                if (has_geometry) {
+                    if (type == FeatureType::GeometryCollection || type == FeatureType::None) {
+                        std::uint32_t count = get<std::uint32_t>();
+                        for (std::uint32_t i = 0; i < count; ++i) {
+                            geometry_collection.push_back(get_geometry());
+                        }
+                    }
+                    else {
+                        geometry_object = get_geometry();
+                    }
+                }
+                apply_load_options(options, type, geometry_object, geometry_collection, properties, bounding_box);
+                return build_feature(type, std::move(geometry_object), std::move(geometry_collection), std::move(id),
+                                     std::move(properties), std::move(bounding_box), std::move(foreign_members));
+            }
+
+            std::size_t get_position() const { return position; }
+
+        private:
+            const char* take(std::size_t count) {
+                if (count > size - position) {
+                    throw std::runtime_error("Malformed feature cache: unexpected end of file");
+                }
+                const char* start = data + position;
+                position += count;
+                return start;
+            }
+
+            const char* data;
+            std::size_t size;
+            std::size_t position;
+    };
+
+    bool read_header(const std::string& cache_path, Header& header) {
+        std::ifstream stream(cache_path, std::ios::binary);
+        if (!stream.read(reinterpret_cast<char*>(&header), sizeof(Header))) {
+            return false;
+        }
+        return std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 && header.byte_order == BYTE_ORDER_MARK;
+    }
+
+    GeoJSON make_collection(std::vector<Feature>& features, std::vector<double>& bbox_values) {
+        GeoJSON collection = std::make_shared<FeatureCollection>(FeatureCollection(std::move(features), std::move(bbox_values)));
+        for (Feature feature : *collection) {
+            if (feature->get_id() != "") {
+                collection->add_feature_id(feature->get_id(), feature);
+            }
+        }
+        return collection;
+    }
+
+    std::uint64_t file_size(const std::string& file_path) {
+        struct stat info;
+        if (::stat(file_path.c_str(), &info) != 0) {
+            throw std::runtime_error("Cannot stat " + file_path);
+        }
+        return info.st_size;
+    }
+
+    /**
+     * Write the cache format of a collection to a stream positioned at its start.
+     */
+    void write_features(std::ostream& stream, const FeatureCollection& collection, const SourceDigest& source,
+                        bool include_geometry) {
+        Header header;
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.byte_order = BYTE_ORDER_MARK;
+        header.flags = include_geometry ? FLAG_GEOMETRY : 0;
+        header.source_size = source.size;
+        header.source_hash = source.hash;
+        header.feature_count = 0;
+        header.index_offset = 0;
+
+        Writer writer(stream);
+        writer.put(header);
+        writer.put_doubles(collection.get_bounding_box());
+
+        std::vector<std::pair<std::string, std::uint64_t>> index;
+        for (const Feature& feature : collection) {
+            index.emplace_back(feature->get_id(), (std::uint64_t)stream.tellp());
+            writer.put_feature(*feature, include_geometry);
+        }
+
+        header.feature_count = index.size();
+        header.index_offset = stream.tellp();
+        for (const auto& entry : index) {
+            writer.put_string(entry.first);
+            writer.put(entry.second);
+        }
+        std::streampos end = stream.tellp();
+        stream.seekp(0);
+        writer.put(header);
+        stream.seekp(end);
+    }
+
+    /**
+     * Decode a collection, or the subset of it with the given ids, from the cache format held in memory.
+     */
+    GeoJSON read_features(const char* data, std::size_t size, const std::string& description,
+                          const std::vector<std::string>& ids, const FeatureLoadOptions& options) {
+        Reader reader(data, size);
+        Header header = reader.get<Header>();
+        if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.byte_order != BYTE_ORDER_MARK) {
+            throw std::runtime_error(description + " is not a feature cache");
+        }
+        bool has_geometry = (header.flags & FLAG_GEOMETRY) != 0;
+
+        std::vector<double> bbox_values = reader.get_doubles();
+        std::vector<Feature> features;
+        if (ids.empty()) {
+            features.reserve(header.feature_count);
+            for (std::uint64_t i = 0; i < header.feature_count; ++i) {
+                features.push_back(reader.get_feature(has_geometry, options));
+            }
+        }
+        else {
+            // Only decode the requested features, located through the index
+            const std::unordered_set<std::string> subset(ids.begin(), ids.end());
+            Reader index(data, size, header.index_offset);
+            for (std::uint64_t i = 0; i < header.feature_count; ++i) {
+                std::string id = index.get_string();
+                std::uint64_t offset = index.get<std::uint64_t>();
+                if (subset.find(id) != subset.end()) {
+                    Reader record(data, size, offset);
+                    features.push_back(record.get_feature(has_geometry, options));
+                }
+            }
+        }
+        return make_collection(features, bbox_values);
+    }
+}
+
+SourceDigest geojson::digest_file(const std::string& file_path)
+{
+    std::ifstream stream(file_path, std::ios::binary);
+    if (!stream) {
+        throw std::runtime_error("Cannot read " + file_path);
+    }
+
+    // FNV-1a, applied to 64 bit words rather than bytes to keep up with the disk
+    const std::uint64_t prime = 1099511628211ULL;
+    SourceDigest digest;
+    digest.hash = 14695981039346656037ULL;
+    std::vector<char> buffer(1 << 20);
+    while (stream) {
+        stream.read(buffer.data(), buffer.size());
+        std::size_t count = stream.gcount();
+        std::size_t words = count / sizeof(std::uint64_t);
+        for (std::size_t i = 0; i < words; ++i) {
+            std::uint64_t word;
+            std::memcpy(&word, buffer.data() + i * sizeof(word), sizeof(word));
+            digest.hash = (digest.hash ^ word) * prime;
+        }
+        for (std::size_t i = words * sizeof(std::uint64_t); i < count; ++i) {
+            digest.hash = (digest.hash ^ (unsigned char)buffer[i]) * prime;
+        }
+        digest.size += count;
+    }
+    return digest;
+}
+
+void geojson::write_feature_cache(const FeatureCollection& collection, const SourceDigest& source,
+                                  const std::string& cache_path, bool include_geometry)
+{
+    std::string temp_path = cache_path + ".tmp." + std::to_string(::getpid());
+    std::ofstream stream(temp_path, std::ios::binary | std::ios::trunc);
+    if (!stream) {
+        throw std::runtime_error("Cannot write feature cache " + temp_path);
+    }
+    write_features(stream, collection, source, include_geometry);
+    stream.close();
+    if (!stream) {
+        std::remove(temp_path.c_str());
+        throw std::runtime_error("Failed writing feature cache " + temp_path);
+    }
+    if (std::rename(temp_path.c_str(), cache_path.c_str()) != 0) {
+        std::remove(temp_path.c_str());
+        throw std::runtime_error("Cannot move feature cache into place at " + cache_path);
+    }
+}
+
+std::string geojson::serialize_features(const FeatureCollection& collection, bool include_geometry)
+{
+    std::ostringstream stream(std::ios::binary);
+    write_features(stream, collection, SourceDigest(), include_geometry);
+    return stream.str();
+}
+
+GeoJSON geojson::deserialize_features(const char* data, std::size_t size, const std::vector<std::string>& ids,
+                                      const FeatureLoadOptions& options)
+{
+    return read_features(data, size, "Serialized feature data", ids, options);
+}
+
+bool geojson::feature_cache_matches(const std::string& cache_path, const SourceDigest& source)
+{
+    Header header;
+    return read_header(cache_path, header) && header.source_size == source.size && header.source_hash == source.hash;
+}
+
+GeoJSON geojson::read_feature_cache(const std::string& cache_path, const std::vector<std::string>& ids,
+                                    const FeatureLoadOptions& options)
+{
+    MappedFile file(cache_path);
+    return read_features(file.data, file.size, cache_path, ids, options);
+}
+
+bool geojson::update_feature_cache(const std::string& file_path, bool include_geometry)
+{
+    std::string cache_path = file_path + FEATURE_CACHE_EXTENSION;
+    SourceDigest digest = digest_file(file_path);
+    Header header;
+    if (feature_cache_matches(cache_path, digest) && read_header(cache_path, header)
+        && (!include_geometry || (header.flags & FLAG_GEOMETRY) != 0)) {
+        return false;
+    }
+    FeatureLoadOptions options;
+    options.include_geometry = include_geometry;
+    GeoJSON collection = read(file_path, {}, options);
+    write_feature_cache(*collection, digest, cache_path, include_geometry);
+    return true;
+}
+
+GeoJSON geojson::read_cached(const std::string& file_path, const std::vector<std::string>& ids, bool verify,
+                             const FeatureLoadOptions& options)
+{
+    std::string cache_path = file_path + FEATURE_CACHE_EXTENSION;
+    Header header;
+    bool usable = read_header(cache_path, header)
+                  && (!options.include_geometry || (header.flags & FLAG_GEOMETRY) != 0);
+    if (usable && !verify && header.source_size == file_size(file_path)) {
+        return read_feature_cache(cache_path, ids, options);
+    }
+
+    SourceDigest digest = digest_file(file_path);
+    if (usable && header.source_size == digest.size && header.source_hash == digest.hash) {
+        return read_feature_cache(cache_path, ids, options);
+    }
+
+    // The cache keeps every property, so the same cache serves loads with any property selection
+    FeatureLoadOptions full;
+    full.include_geometry = options.include_geometry;
+    GeoJSON collection = read(file_path, {}, full);
+    write_feature_cache(*collection, digest, cache_path, options.include_geometry);
+    if (!options.properties.empty()) {
+        return read_feature_cache(cache_path, ids, options);
+    }
+    if (ids.empty()) {
+        return collection;
+    }
+    return std::make_shared<FeatureCollection>(*collection, ids);
+}
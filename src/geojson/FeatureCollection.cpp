@@ -66,6 +66,17 @@ int FeatureCollection::get_size() {
     return features.size();
 };
 
+std::size_t FeatureCollection::get_memory_bytes() const {
+    std::size_t bytes = sizeof(FeatureCollection) + features.capacity() * sizeof(Feature)
+                      + bounding_box.capacity() * sizeof(double)
+                      + feature_by_id.bucket_count() * sizeof(void*)
+                      + feature_by_id.size() * (sizeof(std::pair<const std::string, Feature>) + 2 * sizeof(void*));
+    for (const Feature& feature : features) {
+        bytes += feature->get_memory_bytes();
+    }
+    return bytes;
+}
+
 bool FeatureCollection::is_empty() {
     return features.size() == 0;
 }
@@ -131,21 +142,28 @@ void FeatureCollection::set(std::string key, JSONProperty& property) {
 int FeatureCollection::link_features_from_property(std::string* from_property, std::string* to_property) {
     int links_found = 0;
 
-    for (Feature feature : features) {
-        if (from_property != nullptr and feature->has_property(*from_property)) {
-            std::string from_id = feature->get_property(*from_property).as_string();
-            
-            if (feature_by_id.find(from_id) != feature_by_id.end()) {
-                feature->add_origination_feature(feature_by_id[from_id].get());
+    // The feature named by a property, with a single lookup of the id
+    auto linked_feature = [this](const FeatureBase& feature, const std::string& property) -> FeatureBase* {
+        if (!feature.has_property(property)) {
+            return nullptr;
+        }
+        auto found = feature_by_id.find(feature.get_property(property).as_string());
+        return found == feature_by_id.end() ? nullptr : found->second.get();
+    };
+
+    for (const Feature& feature : features) {
+        if (from_property != nullptr) {
+            FeatureBase* origin = linked_feature(*feature, *from_property);
+            if (origin != nullptr) {
+                feature->add_origination_feature(origin);
                 links_found++;
             }
         }
 
-        if (to_property != nullptr and feature->has_property(*to_property)) {
-            std::string to_id = feature->get_property(*to_property).as_string();
-
-            if (feature_by_id.find(to_id) != feature_by_id.end()) {
-                feature->add_destination_feature(feature_by_id[to_id].get());
+        if (to_property != nullptr) {
+            FeatureBase* destination = linked_feature(*feature, *to_property);
+            if (destination != nullptr) {
+                feature->add_destination_feature(destination);
                 links_found++;
             }
         }
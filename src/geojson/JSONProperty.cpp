@@ -1,5 +1,7 @@
 #include "JSONProperty.hpp"
 
+#include <boost/functional/hash.hpp>
+
 using namespace geojson;
 
 /**
@@ -179,3 +181,39 @@ bool JSONProperty::has_key(std::string key) const {
 std::string JSONProperty::get_key() const {
     return key;
 }
+
+std::size_t PropertyMapHash::operator()(const PropertyMap& properties) const {
+    std::size_t seed = properties.size();
+    for (const auto &pair : properties) {
+        boost::hash_combine(seed, pair.first);
+        boost::hash_combine(seed, (*this)(pair.second));
+    }
+    return seed;
+}
+
+std::size_t PropertyMapHash::operator()(const JSONProperty& property) const {
+    std::size_t seed = static_cast<std::size_t>(property.get_type());
+    switch (property.get_type()) {
+        case PropertyType::Natural:
+            boost::hash_combine(seed, property.as_natural_number());
+            break;
+        case PropertyType::Real:
+            boost::hash_combine(seed, property.as_real_number());
+            break;
+        case PropertyType::String:
+            boost::hash_combine(seed, property.as_string());
+            break;
+        case PropertyType::Boolean:
+            boost::hash_combine(seed, property.as_boolean());
+            break;
+        case PropertyType::List:
+            for (const JSONProperty &value : property.as_list()) {
+                boost::hash_combine(seed, (*this)(value));
+            }
+            break;
+        case PropertyType::Object:
+            boost::hash_combine(seed, (*this)(property.get_values()));
+            break;
+    }
+    return seed;
+}
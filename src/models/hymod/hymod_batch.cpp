@@ -0,0 +1,183 @@
+#include "hymod_batch.h"
+#include "HymodErrorCodes.h"
+#include "RunoffPartitioningBatch.hpp"
+#include "reservoir/Reservoir_Batch.hpp"
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+using Reservoir::Explicit_Time::batch::fill_reservoir;
+using Reservoir::Explicit_Time::batch::drain_reservoir;
+using Reservoir::Explicit_Time::batch::linear_outlet_velocity;
+
+std::size_t hymod_batch::add_member(const hymod_params& params, const hymod_state& initial_state)
+{
+    if (params.n < 0) {
+        throw std::invalid_argument("Nash Cascade size parameter in hymod batch member is negative ("
+                                    + std::to_string(params.n) + ")");
+    }
+
+    std::size_t member = size();
+    min_storage_m.push_back(params.min_storage_meters);
+    gw_max_storage_m.push_back(params.gw_max_storage_meters);
+    nash_max_storage_m.push_back(params.nash_max_storage_meters);
+    nash_activation_threshold_m.push_back(params.activation_threshold_meters_nash_cascade_reservoir);
+    gw_activation_threshold_m.push_back(params.activation_threshold_meters_groundwater_reservoir);
+    max_velocity_m_per_s.push_back(params.reservoir_max_velocity_meters_per_second);
+    smax.push_back(params.smax);
+    a.push_back(params.a);
+    b.push_back(params.b);
+    Ks.push_back(params.Ks);
+    Kq.push_back(params.Kq);
+    n.push_back(params.n);
+
+    storage_m.push_back(initial_state.storage_meters);
+    groundwater_storage_m.push_back(initial_state.groundwater_storage_meters);
+    while (nash_storage_m.size() < (std::size_t) params.n) {
+        nash_storage_m.emplace_back(member, 0.0);
+    }
+    for (std::size_t i = 0; i < nash_storage_m.size(); ++i) {
+        bool has_reservoir = initial_state.Sr != nullptr && (int) i < params.n;
+        nash_storage_m[i].push_back(has_reservoir ? initial_state.Sr[i] : 0.0);
+    }
+
+    slow_flow_m_per_s.push_back(0.0);
+    runoff_m_per_s.push_back(0.0);
+    et_loss_m.push_back(0.0);
+    mass_check_results.push_back(NO_ERROR);
+    return member;
+}
+
+std::size_t hymod_batch::size() const
+{
+    return storage_m.size();
+}
+
+std::size_t hymod_batch::run(double dt, const std::vector<double>& input_storage_m,
+                             const std::vector<std::shared_ptr<pdm03_struct>>& et_params)
+{
+    const std::size_t members = size();
+    if (input_storage_m.size() != members || et_params.size() != members) {
+        throw std::invalid_argument("Hymod batch of " + std::to_string(members) + " members run with inputs for "
+                                    + std::to_string(input_storage_m.size()) + " and ET params for "
+                                    + std::to_string(et_params.size()));
+    }
+    // As in hymod_kernel::run, the reservoirs take whole seconds
+    const double delta_time_s = (int) dt;
+
+    // The storage function, splitting the storage (with this time step's input) between the soil, the quick flow
+    // and the slow flow; the mass before the step, for the mass check, is from the storage with the input
+    std::vector<double> initial_mass_m(members);
+    std::vector<double> soil_m(members);
+    std::vector<double> slow_flow_in_m_per_s(members);
+    #pragma omp simd
+    for (std::size_t m = 0; m < members; ++m) {
+        double storage = storage_m[m] + input_storage_m[m];
+        initial_mass_m[m] = storage + groundwater_storage_m[m];
+        double storage_function_value = storage * (1.0 - pow((1.0 - storage / smax[m]), b[m]));
+        runoff_m_per_s[m] = (storage_function_value * a[m]) / dt;
+        slow_flow_in_m_per_s[m] = (storage_function_value * (1.0 - a[m])) / dt;
+        soil_m[m] = storage - storage_function_value;
+    }
+    for (std::size_t i = 0; i < nash_storage_m.size(); ++i) {
+        const double *nash_storage = nash_storage_m[i].data();
+        #pragma omp simd
+        for (std::size_t m = 0; m < members; ++m) {
+            initial_mass_m[m] += nash_storage[m];
+        }
+    }
+
+    // ET from the soil, with the PDM of every member run at once between gathering the members' ET params and
+    // passing its outputs back to them
+    runoff::batch::pdm03_arrays pdm(members);
+    for (std::size_t m = 0; m < members; ++m) {
+        et_params[m]->final_height_reservoir = soil_m[m];
+        pdm.set(m, *et_params[m]);
+    }
+    runoff::batch::pdm03(pdm);
+    for (std::size_t m = 0; m < members; ++m) {
+        pdm.get_outputs(m, *et_params[m]);
+        et_loss_m[m] = pdm.final_height_reservoir[m] - soil_m[m];
+    }
+
+    // The groundwater reservoir, with its linear outlet, whose excess is added to the quick flow
+    #pragma omp simd
+    for (std::size_t m = 0; m < members; ++m) {
+        double storage = groundwater_storage_m[m];
+        double groundwater_excess_m;
+        fill_reservoir(slow_flow_in_m_per_s[m], delta_time_s, gw_max_storage_m[m], storage, groundwater_excess_m);
+        double velocity = linear_outlet_velocity(Ks[m], gw_activation_threshold_m[m], max_velocity_m_per_s[m],
+                                                 gw_max_storage_m[m], storage);
+        velocity = drain_reservoir(velocity, delta_time_s, min_storage_m[m], gw_max_storage_m[m], storage,
+                                   groundwater_excess_m);
+
+        groundwater_storage_m[m] = storage;
+        slow_flow_m_per_s[m] = velocity;
+        runoff_m_per_s[m] += groundwater_excess_m / dt;
+    }
+
+    // Each reservoir of the quick flow Nash cascades, in every member that has it
+    for (std::size_t i = 0; i < nash_storage_m.size(); ++i) {
+        double *nash_storage = nash_storage_m[i].data();
+        #pragma omp simd
+        for (std::size_t m = 0; m < members; ++m) {
+            double storage = nash_storage[m];
+            double excess_water_m;
+            double runoff = runoff_m_per_s[m];
+            fill_reservoir(runoff, delta_time_s, nash_max_storage_m[m], storage, excess_water_m);
+            double velocity = linear_outlet_velocity(Kq[m], nash_activation_threshold_m[m], max_velocity_m_per_s[m],
+                                                     nash_max_storage_m[m], storage);
+            velocity = drain_reservoir(velocity, delta_time_s, min_storage_m[m], nash_max_storage_m[m], storage,
+                                       excess_water_m);
+
+            bool has_reservoir = (int) i < n[m];
+            nash_storage[m] = has_reservoir ? storage : nash_storage[m];
+            runoff_m_per_s[m] = has_reservoir ? velocity + excess_water_m / dt : runoff;
+        }
+    }
+
+    // The new soil storage, and the mass check, as hymod_kernel::mass_check
+    std::vector<double> final_mass_m(members);
+    #pragma omp simd
+    for (std::size_t m = 0; m < members; ++m) {
+        storage_m[m] = soil_m[m] - et_loss_m[m];
+        final_mass_m[m] = storage_m[m] + groundwater_storage_m[m];
+    }
+    for (std::size_t i = 0; i < nash_storage_m.size(); ++i) {
+        const double *nash_storage = nash_storage_m[i].data();
+        #pragma omp simd
+        for (std::size_t m = 0; m < members; ++m) {
+            final_mass_m[m] += nash_storage[m];
+        }
+    }
+
+    std::size_t failures = 0;
+    #pragma omp simd reduction(+:failures)
+    for (std::size_t m = 0; m < members; ++m) {
+        double final_m = final_mass_m[m]
+                         + (et_loss_m[m] + runoff_m_per_s[m] * dt + slow_flow_m_per_s[m] * dt);
+        bool failed = fabs(initial_mass_m[m] - final_m) > mass_check_error_bound;
+        mass_check_results[m] = failed ? MASS_BALANCE_ERROR : NO_ERROR;
+        failures += failed ? 1 : 0;
+    }
+    return failures;
+}
+
+hymod_state hymod_batch::get_state(std::size_t member, std::vector<double>& nash_storage) const
+{
+    nash_storage.resize(n.at(member));
+    for (std::size_t i = 0; i < nash_storage.size(); ++i) {
+        nash_storage[i] = nash_storage_m[i][member];
+    }
+    return hymod_state(storage_m[member], groundwater_storage_m[member], nash_storage.data());
+}
+
+hymod_fluxes hymod_batch::get_fluxes(std::size_t member) const
+{
+    return hymod_fluxes(slow_flow_m_per_s.at(member), runoff_m_per_s[member], et_loss_m[member]);
+}
+
+int hymod_batch::get_mass_check_result(std::size_t member) const
+{
+    return mass_check_results.at(member);
+}
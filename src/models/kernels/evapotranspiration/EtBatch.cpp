@@ -0,0 +1,214 @@
+#include <cmath>
+#include "EtCalcProperty.hpp"
+#include "EtBatch.hpp"
+
+// The loops over catchments below have no dependencies between iterations, and select defaulted values rather than
+// branching, so that each is vectorized (with vectorized exp and log, where -fopenmp-simd is given).
+
+void et::batch::evapotranspiration_forcing_arrays::resize(std::size_t n) {
+    net_radiation_W_per_sq_m.resize(n);
+    air_temperature_C.resize(n);
+    relative_humidity_percent.resize(n);
+    specific_humidity_2m_kg_per_kg.resize(n);
+    air_pressure_Pa.resize(n);
+    wind_speed_m_per_s.resize(n);
+    canopy_resistance_sec_per_m.resize(n);
+    water_temperature_C.resize(n);
+    ground_heat_flux_W_per_sq_m.resize(n);
+}
+
+void et::batch::evapotranspiration_params_arrays::resize(std::size_t n) {
+    wind_speed_measurement_height_m.resize(n);
+    humidity_measurement_height_m.resize(n);
+    vegetation_height_m.resize(n);
+    zero_plane_displacement_height_m.resize(n);
+    momentum_transfer_roughness_length_m.resize(n);
+    heat_transfer_roughness_length_m.resize(n);
+}
+
+void et::batch::intermediate_vars_arrays::resize(std::size_t n) {
+    liquid_water_density_kg_per_m3.resize(n);
+    water_latent_heat_of_vaporization_J_per_kg.resize(n);
+    air_saturation_vapor_pressure_Pa.resize(n);
+    air_actual_vapor_pressure_Pa.resize(n);
+    vapor_pressure_deficit_Pa.resize(n);
+    moist_air_gas_constant_J_per_kg_K.resize(n);
+    moist_air_density_kg_per_m3.resize(n);
+    slope_sat_vap_press_curve_Pa_s.resize(n);
+    psychrometric_constant_Pa_per_C.resize(n);
+}
+
+void et::batch::calculate_intermediate_variables(const evapotranspiration_params_arrays &params,
+                                                 const evapotranspiration_forcing_arrays &forcing,
+                                                 intermediate_vars_arrays &inter_vars) {
+    const std::size_t n = forcing.size();
+    inter_vars.resize(n);
+
+    const double *air_temperature_C = forcing.air_temperature_C.data();
+    const double *relative_humidity_percent = forcing.relative_humidity_percent.data();
+    const double *specific_humidity_kg_per_kg = forcing.specific_humidity_2m_kg_per_kg.data();
+    const double *air_pressure_Pa = forcing.air_pressure_Pa.data();
+    const double *water_temperature_C = forcing.water_temperature_C.data();
+    const double *heat_roughness_m = params.heat_transfer_roughness_length_m.data();
+    const double *momentum_roughness_m = params.momentum_transfer_roughness_length_m.data();
+
+    double *rho_w = inter_vars.liquid_water_density_kg_per_m3.data();
+    double *lambda = inter_vars.water_latent_heat_of_vaporization_J_per_kg.data();
+    double *e_sat = inter_vars.air_saturation_vapor_pressure_Pa.data();
+    double *e_act = inter_vars.air_actual_vapor_pressure_Pa.data();
+    double *vpd = inter_vars.vapor_pressure_deficit_Pa.data();
+    double *r_a = inter_vars.moist_air_gas_constant_J_per_kg_K.data();
+    double *rho_a = inter_vars.moist_air_density_kg_per_m3.data();
+    double *delta = inter_vars.slope_sat_vap_press_curve_Pa_s.data();
+    double *gamma = inter_vars.psychrometric_constant_Pa_per_C.data();
+
+    #pragma omp simd
+    for (std::size_t i = 0; i < n; ++i) {
+        // IF SOIL WATER TEMPERATURE NOT PROVIDED, USE A SANE VALUE
+        double water_T = (100.0 > water_temperature_C[i]) ? 22.0 : water_temperature_C[i];
+
+        // rho_w, as calc_liquid_water_density_kg_per_m3()
+        double water_density = 1.0 / (0.0009998492 + 4.9716595e-09 * water_T * water_T);
+        rho_w[i] = (1000.0 < water_density) ? 1000.0 : water_density;
+
+        lambda[i] = 2.501e+06 - 2370.0 * water_T;  // eqn 2.7.6 Chow etal.
+
+        // IF HEAT/MOMENTUM ROUGHNESS LENGTHS NOT GIVEN, USE DEFAULTS SO THAT THEIR RATIO IS EQUAL TO 1.
+        bool roughness_given = !((1.0e-06 > heat_roughness_m[i]) || (1.0e-06 > momentum_roughness_m[i]));
+        double zoh = roughness_given ? heat_roughness_m[i] : 1.0;
+
+        double T = air_temperature_C[i];
+        e_sat[i] = 611.0 * exp(17.27 * T / (237.3 + T));
+
+        // meaningful relative humidity value provided, or else specific humidity, limited to below saturation
+        bool rh_given = (0.0 < relative_humidity_percent[i]) && (100.0 >= relative_humidity_percent[i]);
+        double e_from_rh = relative_humidity_percent[i] / 100.0 * e_sat[i];
+        double e_from_q = specific_humidity_kg_per_kg[i] * air_pressure_Pa[i] / 0.622;
+        e_from_q = (e_from_q > e_sat[i]) ? 0.65 * e_sat[i] : e_from_q;
+        e_act[i] = rh_given ? e_from_rh : e_from_q;
+        double q = rh_given ? 0.622 * e_from_rh / air_pressure_Pa[i] : specific_humidity_kg_per_kg[i];
+
+        vpd[i] = e_sat[i] - e_act[i];
+        r_a[i] = 287.0 * (1.0 + 0.608 * q);
+        rho_a[i] = air_pressure_Pa[i] / (r_a[i] * (T + TK));
+        delta[i] = 4098.0 * e_sat[i] / ((237.3 + T) * (237.3 + T));
+        gamma[i] = CP * air_pressure_Pa[i] * zoh / (0.622 * lambda[i]);
+    }
+}
+
+void et::batch::evapotranspiration_energy_balance_method(const evapotranspiration_forcing_arrays &forcing,
+                                                         const intermediate_vars_arrays &inter_vars,
+                                                         std::vector<double> &et_rate_m_per_s) {
+    const std::size_t n = forcing.size();
+    et_rate_m_per_s.resize(n);
+    const double *net_radiation = forcing.net_radiation_W_per_sq_m.data();
+    const double *rho_w = inter_vars.liquid_water_density_kg_per_m3.data();
+    const double *lambda = inter_vars.water_latent_heat_of_vaporization_J_per_kg.data();
+    double *rate = et_rate_m_per_s.data();
+
+    #pragma omp simd
+    for (std::size_t i = 0; i < n; ++i) {
+        rate[i] = net_radiation[i] / (rho_w[i] * lambda[i]);
+    }
+}
+
+void et::batch::evapotranspiration_aerodynamic_method(const evapotranspiration_params_arrays &params,
+                                                      const evapotranspiration_forcing_arrays &forcing,
+                                                      const intermediate_vars_arrays &inter_vars,
+                                                      std::vector<double> &et_rate_m_per_s) {
+    const std::size_t n = forcing.size();
+    et_rate_m_per_s.resize(n);
+    const double *zm = params.wind_speed_measurement_height_m.data();
+    const double *d = params.zero_plane_displacement_height_m.data();
+    const double *wind_speed = forcing.wind_speed_m_per_s.data();
+    const double *air_pressure = forcing.air_pressure_Pa.data();
+    const double *rho_w = inter_vars.liquid_water_density_kg_per_m3.data();
+    const double *rho_a = inter_vars.moist_air_density_kg_per_m3.data();
+    const double *vpd = inter_vars.vapor_pressure_deficit_Pa.data();
+    double *rate = et_rate_m_per_s.data();
+
+    #pragma omp simd
+    for (std::size_t i = 0; i < n; ++i) {
+        double log_height_ratio = log(zm[i] / d[i]);
+        double mass_flux = 0.622 * KV2 * rho_a[i] * vpd[i] * wind_speed[i] /
+                           (air_pressure[i] * log_height_ratio * log_height_ratio);  // kg per sq. meter per sec.
+        rate[i] = mass_flux / rho_w[i];
+    }
+}
+
+void et::batch::evapotranspiration_combination_method(const evapotranspiration_params_arrays &params,
+                                                      const evapotranspiration_forcing_arrays &forcing,
+                                                      const intermediate_vars_arrays &inter_vars,
+                                                      std::vector<double> &et_rate_m_per_s) {
+    const std::size_t n = forcing.size();
+    // The radiation balance rate, then replaced by the combined rate
+    evapotranspiration_energy_balance_method(forcing, inter_vars, et_rate_m_per_s);
+    std::vector<double> aerodynamic_rate_m_per_s;
+    evapotranspiration_aerodynamic_method(params, forcing, inter_vars, aerodynamic_rate_m_per_s);
+
+    const double *delta = inter_vars.slope_sat_vap_press_curve_Pa_s.data();
+    const double *gamma = inter_vars.psychrometric_constant_Pa_per_C.data();
+    const double *aerodynamic_rate = aerodynamic_rate_m_per_s.data();
+    double *rate = et_rate_m_per_s.data();
+
+    #pragma omp simd
+    for (std::size_t i = 0; i < n; ++i) {
+        rate[i] = delta[i] / (delta[i] + gamma[i]) * rate[i] +
+                  gamma[i] / (delta[i] + gamma[i]) * aerodynamic_rate[i];
+    }
+}
+
+void et::batch::evapotranspiration_priestley_taylor_method(const evapotranspiration_forcing_arrays &forcing,
+                                                           const intermediate_vars_arrays &inter_vars,
+                                                           std::vector<double> &et_rate_m_per_s) {
+    const std::size_t n = forcing.size();
+    evapotranspiration_energy_balance_method(forcing, inter_vars, et_rate_m_per_s);
+
+    const double *delta = inter_vars.slope_sat_vap_press_curve_Pa_s.data();
+    const double *gamma = inter_vars.psychrometric_constant_Pa_per_C.data();
+    double *rate = et_rate_m_per_s.data();
+
+    #pragma omp simd
+    for (std::size_t i = 0; i < n; ++i) {
+        rate[i] = 1.3 * delta[i] / (delta[i] + gamma[i]) * rate[i];
+    }
+}
+
+void et::batch::evapotranspiration_penman_monteith_method(const evapotranspiration_params_arrays &params,
+                                                          const evapotranspiration_forcing_arrays &forcing,
+                                                          const intermediate_vars_arrays &inter_vars,
+                                                          std::vector<double> &et_rate_m_per_s) {
+    const std::size_t n = forcing.size();
+    et_rate_m_per_s.resize(n);
+    const double *wind_height = params.wind_speed_measurement_height_m.data();
+    const double *humidity_height = params.humidity_measurement_height_m.data();
+    const double *vegetation_height = params.vegetation_height_m.data();
+    const double *net_radiation = forcing.net_radiation_W_per_sq_m.data();
+    const double *ground_heat_flux = forcing.ground_heat_flux_W_per_sq_m.data();
+    const double *wind_speed = forcing.wind_speed_m_per_s.data();
+    const double *canopy_resistance = forcing.canopy_resistance_sec_per_m.data();
+    const double *rho_w = inter_vars.liquid_water_density_kg_per_m3.data();
+    const double *lambda = inter_vars.water_latent_heat_of_vaporization_J_per_kg.data();
+    const double *rho_a = inter_vars.moist_air_density_kg_per_m3.data();
+    const double *vpd = inter_vars.vapor_pressure_deficit_Pa.data();
+    const double *delta = inter_vars.slope_sat_vap_press_curve_Pa_s.data();
+    const double *gamma = inter_vars.psychrometric_constant_Pa_per_C.data();
+    double *rate = et_rate_m_per_s.data();
+
+    #pragma omp simd
+    for (std::size_t i = 0; i < n; ++i) {
+        // use approximations from UN FAO: http://www.fao.org/3/X0490E/x0490e06.htm#aerodynamic%20resistance%20(ra)
+        double h = (fabs(vegetation_height[i]) < 1.0e-06) ? 0.5 : vegetation_height[i];
+        double d = 2.0 / 3.0 * h;
+        double zom = 0.123 * h;
+        double zoh = 0.1 * h;
+        // as calculate_aerodynamic_resistance()
+        double zm = (1.0e-06 >= wind_height[i]) ? 2.0 : wind_height[i];
+        double zh = (1.0e-06 >= humidity_height[i]) ? 2.0 : humidity_height[i];
+        double ra = log((zm - d) / zom) * log((zh - d) / zoh) / (KV2 * wind_speed[i]);
+
+        double numerator = delta[i] * (net_radiation[i] - ground_heat_flux[i]) + rho_a[i] * CP * vpd[i] / ra;
+        double denominator = delta[i] + gamma[i] * (1.0 + canopy_resistance[i] / ra);
+        rate[i] = numerator / denominator / (rho_w[i] * lambda[i]);
+    }
+}
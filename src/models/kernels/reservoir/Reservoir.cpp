@@ -1,4 +1,5 @@
 #include "Reservoir.hpp"
+#include "Logger.hpp"
 
 using namespace std;
 
@@ -110,6 +111,137 @@ namespace Reservoir{
          */
         double Reservoir::response_meters_per_second(double in_flux_meters_per_second, int delta_time_seconds,
                                                                double &excess_water_meters)
+        {
+            if (parameters.solver == reservoir_solver::adaptive && delta_time_seconds > 1 && !outlets.empty()) {
+                return adaptive_response_meters_per_second(in_flux_meters_per_second, delta_time_seconds,
+                                                           excess_water_meters);
+            }
+            return step_response_meters_per_second(in_flux_meters_per_second, delta_time_seconds, excess_water_meters);
+        }
+
+        /**
+         * @brief Set how the reservoir solves for its storage over each time step of response_meters_per_second.
+         *
+         * @param solver The solver to use.
+         * @param tolerance_meters For the adaptive solver, the largest acceptable estimated error of a sub-step's
+         *                         storage, in meters.
+         * @param max_substeps For the adaptive solver, the number of sub-steps of the smallest allowed sub-step.
+         */
+        void Reservoir::set_solver(reservoir_solver solver, double tolerance_meters, int max_substeps)
+        {
+            parameters.solver = solver;
+            parameters.solver_tolerance_meters = tolerance_meters;
+            parameters.solver_max_substeps = max_substeps;
+        }
+
+        /**
+         * @brief Set the largest acceptable error of the velocities that outlets able to tabulate them read from a table
+         * over the storage range, building the tables of the current outlets.
+         *
+         * @param tolerance_meters_per_second The largest acceptable velocity error, in meters per second.
+         */
+        void Reservoir::set_outlet_table_tolerance(double tolerance_meters_per_second)
+        {
+            parameters.outlet_table_tolerance_meters_per_second = tolerance_meters_per_second;
+            for (auto &outlet : outlets) {
+                outlet->tabulate(parameters);
+            }
+        }
+
+        /**
+         * @brief Update the storage and return the mean response over the time step, with adaptive sub-steps.
+         *
+         * Each sub-step is compared with two half sub-steps from the same storage.  If their storages (and excess water)
+         * differ by more than the tolerance, the sub-step is halved and tried again; otherwise the two half sub-steps are
+         * kept, and the next sub-step is twice as long.  Sub-steps are never shorter than the time step divided by the
+         * maximum number of sub-steps (or a second), at which size they are kept regardless of the estimated error.
+         *
+         * @param in_flux_meters_per_second influx in meters per second
+         * @param delta_time_seconds delta time in seconds
+         * @param excess_water_meters Reference to the total excess water in meters over the sub-steps.
+         * @return The mean sum of the outlet velocities over the time step, in meters per second
+         */
+        double Reservoir::adaptive_response_meters_per_second(double in_flux_meters_per_second, int delta_time_seconds,
+                                                              double &excess_water_meters)
+        {
+            excess_water_meters = 0.0;
+            outlet_volumes_meters.assign(outlets.size(), 0.0);
+            half_substep_velocities_meters_per_second.resize(outlets.size());
+
+            const int min_substep_seconds = std::max(1, delta_time_seconds / std::max(1, parameters.solver_max_substeps));
+            int remaining_seconds = delta_time_seconds;
+            int substep_seconds = delta_time_seconds;
+
+            while (remaining_seconds > 0) {
+                substep_seconds = std::min(substep_seconds, remaining_seconds);
+                double substep_excess_meters;
+
+                if (substep_seconds <= min_substep_seconds || substep_seconds < 2) {
+                    // Too short to halve, so keep the sub-step as is
+                    step_response_meters_per_second(in_flux_meters_per_second, substep_seconds, substep_excess_meters);
+                    for (unsigned i = 0; i < outlets.size(); ++i) {
+                        outlet_volumes_meters[i] +=
+                                outlets[i]->get_previously_calculated_velocity_meters_per_second() * substep_seconds;
+                    }
+                    excess_water_meters += substep_excess_meters;
+                    remaining_seconds -= substep_seconds;
+                    continue;
+                }
+
+                double start_storage_meters = state.current_storage_height_meters;
+                step_response_meters_per_second(in_flux_meters_per_second, substep_seconds, substep_excess_meters);
+                double full_storage_meters = state.current_storage_height_meters;
+                state.current_storage_height_meters = start_storage_meters;
+
+                int first_half_seconds = substep_seconds / 2;
+                int second_half_seconds = substep_seconds - first_half_seconds;
+                double first_half_excess_meters, second_half_excess_meters;
+                step_response_meters_per_second(in_flux_meters_per_second, first_half_seconds, first_half_excess_meters);
+                for (unsigned i = 0; i < outlets.size(); ++i) {
+                    half_substep_velocities_meters_per_second[i] =
+                            outlets[i]->get_previously_calculated_velocity_meters_per_second();
+                }
+                step_response_meters_per_second(in_flux_meters_per_second, second_half_seconds, second_half_excess_meters);
+
+                double error_meters = std::fabs(state.current_storage_height_meters - full_storage_meters) +
+                        std::fabs(first_half_excess_meters + second_half_excess_meters - substep_excess_meters);
+                if (error_meters > parameters.solver_tolerance_meters) {
+                    // Try again from the start of the sub-step, with half the sub-step
+                    state.current_storage_height_meters = start_storage_meters;
+                    substep_seconds = std::max(min_substep_seconds, first_half_seconds);
+                    continue;
+                }
+
+                // Keep the two half sub-steps
+                for (unsigned i = 0; i < outlets.size(); ++i) {
+                    outlet_volumes_meters[i] += half_substep_velocities_meters_per_second[i] * first_half_seconds +
+                            outlets[i]->get_previously_calculated_velocity_meters_per_second() * second_half_seconds;
+                }
+                excess_water_meters += first_half_excess_meters + second_half_excess_meters;
+                remaining_seconds -= substep_seconds;
+                substep_seconds *= 2;
+            }
+
+            // Report the mean velocity of each outlet over the whole time step
+            double sum_of_outlet_velocities_meters_per_second = 0.0;
+            for (unsigned i = 0; i < outlets.size(); ++i) {
+                double mean_velocity_meters_per_second = outlet_volumes_meters[i] / delta_time_seconds;
+                outlets[i]->adjust_velocity(mean_velocity_meters_per_second);
+                sum_of_outlet_velocities_meters_per_second += mean_velocity_meters_per_second;
+            }
+            return sum_of_outlet_velocities_meters_per_second;
+        }
+
+        /**
+         * @brief Update the storage and return the response over one explicit step.
+         *
+         * @param in_flux_meters_per_second influx in meters per second
+         * @param delta_time_seconds delta time in seconds
+         * @param excess_water_meters Reference to an amount of excess water in meters, after considering input and max storage.
+         * @return sum_of_outlet_velocities_meters_per_second sum of the outlet velocities in meters per second
+         */
+        double Reservoir::step_response_meters_per_second(double in_flux_meters_per_second, int delta_time_seconds,
+                                                          double &excess_water_meters)
         {
             double outlet_velocity_meters_per_second = 0;
             double sum_of_outlet_velocities_meters_per_second = 0;
@@ -122,7 +254,7 @@ namespace Reservoir{
             if (state.current_storage_height_meters > parameters.maximum_storage_meters)
             {
                 /// \todo TODO: Return appropriate warning
-                cout << "WARNING: Reservoir calculated a storage above the maximum storage."  << endl;
+                NGEN_LOG_WARNING("Reservoir calculated a storage above the maximum storage.");
                 excess_water_meters = state.current_storage_height_meters - parameters.maximum_storage_meters;
                 state.current_storage_height_meters = parameters.maximum_storage_meters;
             }
@@ -196,6 +328,7 @@ namespace Reservoir{
         {
             //Add outlet to end of outlet vector
             this->outlets.push_back(outlet);
+            outlet->tabulate(parameters);
 
             //Call fuction to ensure that reservoir outlet activation thresholds are sorted from least to greatest height
             sort_outlets();
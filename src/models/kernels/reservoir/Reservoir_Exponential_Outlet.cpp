@@ -28,6 +28,18 @@ namespace Reservoir{
 
         }
 
+        /**
+         * @brief Build the table of velocities over the reservoir's storage range if the parameters have an
+         * outlet_table_tolerance_meters_per_second, or drop it if not.
+         *
+         * @param parameters_struct reservoir parameters struct
+         */
+        void Reservoir_Exponential_Outlet::tabulate(const reservoir_parameters &parameters_struct)
+        {
+            table.build(c, expon, parameters_struct.maximum_storage_meters,
+                        parameters_struct.outlet_table_tolerance_meters_per_second);
+        }
+
         /**
          * @brief Calculate outlet discharge velocity in meters per second.
          *
@@ -46,6 +58,9 @@ namespace Reservoir{
         double Reservoir_Exponential_Outlet::calc_velocity_meters_per_second_local(reservoir_parameters &parameters_struct,
                                                                                    reservoir_state &storage_struct)
         {
+            if (table.covers(storage_struct.current_storage_height_meters)) {
+                return table.velocity_meters_per_second(storage_struct.current_storage_height_meters);
+            }
             return c * (exp(expon * storage_struct.current_storage_height_meters /
                             parameters_struct.maximum_storage_meters) - 1);
         }
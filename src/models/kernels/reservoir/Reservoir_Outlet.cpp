@@ -1,5 +1,6 @@
 #include <iostream>
 #include "Reservoir_Outlet.hpp"
+#include "Logger.hpp"
 
 namespace Reservoir{
     namespace Explicit_Time{
@@ -84,6 +85,16 @@ namespace Reservoir{
             return velocity_meters_per_second_local;
         };
 
+        /**
+         * @brief Prepare the outlet to calculate velocities with the given reservoir parameters.
+         *
+         * @param parameters_struct reservoir parameters struct
+         */
+        void Reservoir_Outlet::tabulate(const reservoir_parameters &parameters_struct)
+        {
+
+        }
+
         /**
          * @brief Function to update and return the velocity in meters per second of the discharge through the outlet.
          *
@@ -116,10 +127,8 @@ namespace Reservoir{
                 velocity_meters_per_second_local = max_velocity_meters_per_second;
 
                 //TODO: Return appropriate warning
-                std::cout
-                        << "WARNING: Reservoir calculated an outlet velocity over max velocity, and therefore "
-                        << "set the outlet velocity to max velocity."
-                        << std::endl;
+                NGEN_LOG_WARNING("Reservoir calculated an outlet velocity over max velocity, and therefore "
+                                 << "set the outlet velocity to max velocity.");
             }
 
             //Return the velocity in meters per second of the discharge through the outlet
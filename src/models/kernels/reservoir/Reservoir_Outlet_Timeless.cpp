@@ -1,5 +1,6 @@
 #include <iostream>
 #include "Reservoir_Outlet_Timeless.hpp"
+#include "Logger.hpp"
 
 namespace Reservoir{
     namespace Implicit_Time{
@@ -116,10 +117,8 @@ namespace Reservoir{
                 flux_meters_local = max_flux_meters;
 
                 //TODO: Return appropriate warning
-                std::cout
-                        << "WARNING: Reservoir calculated an outlet flux over max flux, and therefore "
-                        << "set the outlet flux to max flux."
-                        << std::endl;
+                NGEN_LOG_WARNING("Reservoir calculated an outlet flux over max flux, and therefore "
+                                 << "set the outlet flux to max flux.");
             }
 
             //Return the flux in meters of the discharge through the outlet
@@ -1,4 +1,5 @@
 #include "Reservoir_Timeless.hpp"
+#include "Logger.hpp"
 
 using namespace std;
 
@@ -120,7 +121,7 @@ namespace Reservoir{
             if (state.current_storage_height_meters > parameters.maximum_storage_meters)
             {
                 /// \todo TODO: Return appropriate warning
-                cout << "WARNING: Reservoir calculated a storage above the maximum storage."  << endl;
+                NGEN_LOG_WARNING("Reservoir calculated a storage above the maximum storage.");
                 excess_water_meters = state.current_storage_height_meters - parameters.maximum_storage_meters;
                 state.current_storage_height_meters = parameters.maximum_storage_meters;
             }
@@ -4,8 +4,16 @@
 #include "lstm_fluxes.h"
 #include "lstm_state.h"
 #include "CSV_Reader.h"
+#include "ThreadPool.hpp"
+#include "Logger.hpp"
+#include <algorithm>
 #include <iostream>
 #include <fstream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <torch/version.h>
 
 using namespace std;
 
@@ -37,6 +45,19 @@ ScaleParams read_scale_params(std::string path)
 
 namespace lstm {
 
+    namespace {
+        /** @return A scaling parameter of a variable, or 0 if there is none for it. */
+        double scale_param(const ScaleParams& scale, const std::string& variable, const std::string& param)
+        {
+            auto var = scale.find(variable);
+            if (var == scale.end()) {
+                return 0.0;
+            }
+            auto value = var->second.find(param);
+            return value == var->second.end() ? 0.0 : value->second;
+        }
+    }
+
     /** @TODO: Make option to construct model without an initial state.
      *  Consider initializing the empty state with: 
      *  lstm_model(config, model_params, make_shared<lstm_state>(lstm_state())) {}     
@@ -64,34 +85,28 @@ namespace lstm {
 
         //std::cout<<"model_params.pytorch_model_path: " << config.pytorch_model_path;
 
-        model = torch::jit::load(config.pytorch_model_path);
-        model.to( device );
-        // Set to `eval` model (just like Python)
-        model.eval();
+        //Catchments with the same trained model share one loaded copy of it, and of its normalization
+        shared = shared_model(config, device);
+        model = shared->model;
 
         //no_grad disables gradient calculations on the tensors.
         //Since gradient calculations are not needed on the forward pass,
         //no_grad reduces memory consumption.
         torch::NoGradGuard no_grad_;
 
-        this->scale = read_scale_params(config.normalization_path);
+        this->scaling = shared->scaling;
         this->fluxes = std::make_shared<lstm::lstm_fluxes>(lstm::lstm_fluxes());
 
+        //Inputs are normalized into the same (pinned, on a GPU) host buffer each time step, then copied to the device
+        host_inputs = make_host_inputs(1, device);
+        if (device.is_cuda()) {
+            device_inputs = torch::empty({1, NUM_INPUTS}, torch::TensorOptions().dtype(torch::kFloat32).device(device));
+        }
+
     }
 
-    /**
-     * Initialize LSTM Model State.
-     * Reads the initial state from a specified CSV file. This function
-     * might need to change if there is an option to initialize a blank
-     * state.
-     * @param initial_state_path 
-     * @return
-     */
-    void lstm_model::initialize_state(std::string initial_state_path)
+    void read_initial_state(const std::string& initial_state_path, std::vector<double>& h, std::vector<double>& c)
     {
-
-        vector<double> h_vec;
-        vector<double> c_vec;
         CSVReader reader(initial_state_path);
         auto data = reader.getData();
         std::vector<std::string> header = data[0];
@@ -106,11 +121,165 @@ namespace lstm {
             throw std::runtime_error("ERROR: LSTM Model requires two columns for the initial states input.");
         }
 
+        h.clear();
+        c.clear();
         for(; row != data.end(); ++row)
         {
-            h_vec.push_back( std::strtof( (*row)[0].c_str(), NULL ) );
-            c_vec.push_back( std::strtof( (*row)[1].c_str(), NULL ) );  
+            h.push_back( std::strtof( (*row)[0].c_str(), NULL ) );
+            c.push_back( std::strtof( (*row)[1].c_str(), NULL ) );  
         }
+    }
+
+    lstm_scaling::lstm_scaling() : output_mean(0.0), output_std_dev(1.0)
+    {
+        std::fill(input_means, input_means + NUM_INPUTS, 0.0);
+        std::fill(input_std_devs, input_std_devs + NUM_INPUTS, 1.0);
+    }
+
+    lstm_scaling::lstm_scaling(ScaleParams& scale)
+    {
+        //The scaling variables of the inputs, in the model's input order
+        static const char* const input_names[NUM_INPUTS] = {
+            "Precip_rate",
+            "SPFH_2maboveground_kg_per_kg",
+            "TMP_2maboveground_K",
+            "DLWRF_surface_W_per_meters_squared",
+            "DSWRF_surface_W_per_meters_squared",
+            "PRES_surface_Pa",
+            "UGRD_10maboveground_meters_per_second",
+            "VGRD_10maboveground_meters_per_second",
+            "Area_Square_km",
+            "Latitude",
+            "Longitude"
+        };
+        for (int i = 0; i < NUM_INPUTS; ++i) {
+            input_means[i] = scale[input_names[i]]["mean"];
+            input_std_devs[i] = scale[input_names[i]]["std_dev"];
+        }
+        output_mean = scale["obs"]["mean"];
+        output_std_dev = scale["obs"]["std_dev"];
+    }
+
+    void normalize_inputs(const lstm_scaling& scaling, const double* forcings, const lstm_params& params, float* inputs)
+    {
+        //The forcings, from the order of lstm_model::run to the model's input order, then the catchment's parameters
+        const double values[NUM_INPUTS] = {
+            forcings[3], forcings[2], forcings[5], forcings[0], forcings[4], forcings[1], forcings[6], forcings[7],
+            params.area, params.latitude, params.longitude
+        };
+        for (int i = 0; i < NUM_INPUTS; ++i) {
+            inputs[i] = (values[i] - scaling.input_means[i]) / scaling.input_std_devs[i];
+        }
+    }
+
+    torch::Tensor make_host_inputs(long rows, torch::Device device)
+    {
+        return torch::zeros({rows, NUM_INPUTS}, torch::TensorOptions().dtype(torch::kFloat32).pinned_memory(device.is_cuda()));
+    }
+
+    torch::jit::script::Module load_model(const lstm_config& config, torch::Device device)
+    {
+        set_torch_threads(config.torch_threads, config.torch_interop_threads);
+
+        torch::jit::script::Module model = torch::jit::load(config.pytorch_model_path);
+        model.to(device);
+        // Set to `eval` model (just like Python)
+        model.eval();
+        if (config.optimize_for_inference) {
+            #if defined(TORCH_VERSION_MAJOR) && (TORCH_VERSION_MAJOR > 1 || TORCH_VERSION_MINOR >= 10)
+            model = torch::jit::optimize_for_inference(model);
+            #else
+            throw std::runtime_error("ERROR: optimizing LSTM model " + config.pytorch_model_path
+                                     + " for inference requires LibTorch 1.10 or later.");
+            #endif
+        }
+        return model;
+    }
+
+    std::shared_ptr<const lstm_shared_model> shared_model(const lstm_config& config, torch::Device device)
+    {
+        typedef std::tuple<std::string, std::string, std::string, bool> model_key_t;
+        static std::mutex models_mutex;
+        static std::map<model_key_t, std::weak_ptr<const lstm_shared_model>> models;
+
+        //Loads hold the lock, so catchments constructed concurrently wait for the first to load their model
+        std::lock_guard<std::mutex> lock(models_mutex);
+        model_key_t key(config.pytorch_model_path, config.normalization_path, device.str(),
+                        config.optimize_for_inference);
+        std::shared_ptr<const lstm_shared_model> shared = models[key].lock();
+        if (shared) {
+            set_torch_threads(config.torch_threads, config.torch_interop_threads);
+            return shared;
+        }
+        auto loaded = std::make_shared<lstm_shared_model>();
+        loaded->model = load_model(config, device);
+        loaded->scale = read_scale_params(config.normalization_path);
+        loaded->scaling = lstm_scaling(loaded->scale);
+        models[key] = loaded;
+        return loaded;
+    }
+
+    namespace {
+        std::mutex torch_threads_mutex;
+        /** Whether each of LibTorch's thread pools has been sized, by a model's config or otherwise. */
+        bool intra_op_threads_set = false;
+        bool inter_op_threads_set = false;
+    }
+
+    void set_torch_threads(int intra_op_threads, int inter_op_threads)
+    {
+        std::lock_guard<std::mutex> lock(torch_threads_mutex);
+        if (intra_op_threads > 0) {
+            at::set_num_threads(intra_op_threads);
+            intra_op_threads_set = true;
+        }
+        if (inter_op_threads > 0) {
+            if (!inter_op_threads_set) {
+                try {
+                    at::set_num_interop_threads(inter_op_threads);
+                }
+                catch (const c10::Error& e) {
+                    NGEN_LOG_WARNING("LibTorch inter-op threads could not be set: " << e.what_without_backtrace());
+                }
+                inter_op_threads_set = true;
+            }
+            else if (at::get_num_interop_threads() != inter_op_threads) {
+                NGEN_LOG_WARNING("LibTorch inter-op threads already set to " << at::get_num_interop_threads()
+                                 << ", so cannot be set to " << inter_op_threads);
+            }
+        }
+    }
+
+    void match_torch_threads(std::size_t catchment_threads)
+    {
+        std::size_t cpus = utils::ThreadPool::available_cpus().size();
+        if (cpus == 0) {
+            cpus = std::thread::hardware_concurrency();
+        }
+        int threads = int(std::max<std::size_t>(1, cpus / std::max<std::size_t>(1, catchment_threads)));
+        bool set_intra_op, set_inter_op;
+        {
+            std::lock_guard<std::mutex> lock(torch_threads_mutex);
+            set_intra_op = !intra_op_threads_set;
+            set_inter_op = !inter_op_threads_set;
+        }
+        set_torch_threads(set_intra_op ? threads : 0, set_inter_op ? threads : 0);
+    }
+
+    /**
+     * Initialize LSTM Model State.
+     * Reads the initial state from a specified CSV file. This function
+     * might need to change if there is an option to initialize a blank
+     * state.
+     * @param initial_state_path 
+     * @return
+     */
+    void lstm_model::initialize_state(std::string initial_state_path)
+    {
+
+        vector<double> h_vec;
+        vector<double> c_vec;
+        read_initial_state(initial_state_path, h_vec, c_vec);
 
         current_state = std::make_shared<lstm_state>(lstm_state(h_vec, c_vec));
         previous_state = std::make_shared<lstm_state>(lstm_state(h_vec, c_vec));
@@ -164,33 +333,35 @@ namespace lstm {
 
         manage_state_before_next_time_step_run();
 
-        std::vector<torch::jit::IValue> inputs;
-        torch::Tensor forcing = torch::zeros({1, 11});
-
-        forcing[0][0] = lstm_model::normalize("Precip_rate", precip_meters_per_second);
-        forcing[0][1] = lstm_model::normalize("SPFH_2maboveground_kg_per_kg", SPFH_2maboveground_kg_per_kg);
-        forcing[0][2] = lstm_model::normalize("TMP_2maboveground_K", TMP_2maboveground_K);
-        forcing[0][3] = lstm_model::normalize("DLWRF_surface_W_per_meters_squared", DLWRF_surface_W_per_meters_squared);
-        forcing[0][4] = lstm_model::normalize("DSWRF_surface_W_per_meters_squared", DSWRF_surface_W_per_meters_squared);
-        forcing[0][5] = lstm_model::normalize("PRES_surface_Pa", PRES_surface_Pa);
-        forcing[0][6] = lstm_model::normalize("UGRD_10maboveground_meters_per_second", UGRD_10maboveground_meters_per_second);
-        forcing[0][7] = lstm_model::normalize("VGRD_10maboveground_meters_per_second", VGRD_10maboveground_meters_per_second);
-        forcing[0][8] = lstm_model::normalize("Area_Square_km", model_params.area);
-        forcing[0][9] = lstm_model::normalize("Latitude", model_params.latitude);
-        forcing[0][10] = lstm_model::normalize("Longitude", model_params.longitude);
+        torch::NoGradGuard no_grad_;
+
+        const double forcings[] = {
+            DLWRF_surface_W_per_meters_squared, PRES_surface_Pa, SPFH_2maboveground_kg_per_kg,
+            precip_meters_per_second, DSWRF_surface_W_per_meters_squared, TMP_2maboveground_K,
+            UGRD_10maboveground_meters_per_second, VGRD_10maboveground_meters_per_second
+        };
+        //The copy of the last step's inputs to the device has finished, since its flow was read back
+        normalize_inputs(scaling, forcings, model_params, host_inputs.data_ptr<float>());
 
         // Create the model input for one time step
-      	inputs.push_back(forcing.to(device));
+        std::vector<torch::jit::IValue> inputs;
+        if (device.is_cuda()) {
+            device_inputs.copy_(host_inputs, /*non_blocking=*/true);
+            inputs.push_back(device_inputs);
+        }
+        else {
+            inputs.push_back(host_inputs);
+        }
         inputs.push_back(previous_state->h_t);
         inputs.push_back(previous_state->c_t);
       	// Run the model
         auto output = model.forward(inputs).toTuple()->elements();
       	//Get the outputs
-        double out_flow = lstm_model::denormalize( "obs", output[0].toTensor().item<double>() );
-        out_flow = out_flow * 0.028316847; //convert cfs to cms
-        fluxes = std::make_shared<lstm_fluxes>( lstm_fluxes( out_flow ) ) ;
+        double out_flow = output[0].toTensor().item<double>() * scaling.output_std_dev + scaling.output_mean;
+        fluxes->flow = out_flow * 0.028316847; //convert cfs to cms
 
-        current_state = std::make_shared<lstm_state>( lstm_state(output[1].toTensor(), output[2].toTensor()) );
+        current_state->h_t = output[1].toTensor();
+        current_state->c_t = output[2].toTensor();
 
         return 0;
     }
@@ -204,9 +375,8 @@ namespace lstm {
      */
     double lstm_model::denormalize(std::string forcing_variable_string, double normalized_output)
     {
-        double mean, std_dev;
-        mean = this->scale[ forcing_variable_string ]["mean"];
-        std_dev = this->scale[ forcing_variable_string ]["std_dev"];
+        double mean = scale_param(shared->scale, forcing_variable_string, "mean");
+        double std_dev = scale_param(shared->scale, forcing_variable_string, "std_dev");
         return (normalized_output * std_dev) + mean;
     }
 
@@ -219,9 +389,8 @@ namespace lstm {
      */
     double lstm_model::normalize(std::string forcing_variable_string, double forcing_variable)
     {
-        double mean, std_dev;
-        mean = this->scale[ forcing_variable_string ]["mean"];
-        std_dev = this->scale[ forcing_variable_string ]["std_dev"];
+        double mean = scale_param(shared->scale, forcing_variable_string, "mean");
+        double std_dev = scale_param(shared->scale, forcing_variable_string, "std_dev");
         return  (forcing_variable - mean) / std_dev;
     }
 
@@ -233,12 +402,12 @@ namespace lstm {
      * performs three housekeeping tasks needed before running the next group of time step modeling operations:
      *
      *      * the initial maintained `current_state` is moved to `previous_state`
-     *      * a new `current_state` is created
-     *      * a new `fluxes` is created
+     *      * the state objects are swapped, so the last `previous_state` is reused for the new `current_state`
+     *      * `fluxes` is kept, and overwritten by the run
      */
     void lstm_model::manage_state_before_next_time_step_run()
     {
-        previous_state = current_state;
+        std::swap(previous_state, current_state);
     }
 
 }
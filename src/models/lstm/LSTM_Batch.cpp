@@ -0,0 +1,171 @@
+#ifdef NGEN_LSTM_TORCH_LIB_ACTIVE
+
+#include "lstm_batch.h"
+#include <algorithm>
+#include <map>
+#include <tuple>
+
+namespace lstm {
+
+    std::shared_ptr<lstm_batch> lstm_batch::shared(const lstm_config& config)
+    {
+        typedef std::tuple<std::string, std::string, bool, bool> batch_key_t;
+        static std::mutex batches_mutex;
+        static std::map<batch_key_t, std::weak_ptr<lstm_batch>> batches;
+
+        std::lock_guard<std::mutex> lock(batches_mutex);
+        batch_key_t key(config.pytorch_model_path, config.normalization_path, config.useGPU,
+                        config.optimize_for_inference);
+        std::shared_ptr<lstm_batch> batch = batches[key].lock();
+        if (!batch || batch->is_started()) {
+            batch = std::make_shared<lstm_batch>(config);
+            batches[key] = batch;
+        }
+        return batch;
+    }
+
+    lstm_batch::lstm_batch(const lstm_config& config)
+            : config(config), device(torch::Device(torch::kCPU))
+    {
+        device = torch::Device(config.useGPU && torch::cuda::is_available() ? torch::kCUDA : torch::kCPU);
+        shared = shared_model(config, device);
+        model = shared->model;
+        scaling = shared->scaling;
+    }
+
+    std::size_t lstm_batch::add_member(const lstm_params& params, const std::string& initial_state_path,
+                                       forcing_source_t source)
+    {
+        std::vector<double> h;
+        std::vector<double> c;
+        read_initial_state(initial_state_path, h, c);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (h_t.defined()) {
+            throw std::runtime_error("ERROR: LSTM catchments cannot join a batch that has already run.");
+        }
+        if (!members.empty() && h.size() != hidden_size) {
+            throw std::runtime_error("ERROR: LSTM initial state " + initial_state_path + " has " + std::to_string(h.size())
+                                     + " values, but the other catchments of its batch have " + std::to_string(hidden_size));
+        }
+        hidden_size = h.size();
+        initial_h.insert(initial_h.end(), h.begin(), h.end());
+        initial_c.insert(initial_c.end(), c.begin(), c.end());
+        members.push_back(params);
+        sources.push_back(std::move(source));
+        last_taken_steps.push_back(-1);
+        return members.size() - 1;
+    }
+
+    std::size_t lstm_batch::size()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return members.size();
+    }
+
+    bool lstm_batch::is_started()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return h_t.defined();
+    }
+
+    void lstm_batch::start(long t_index)
+    {
+        if (h_t.defined()) {
+            return;
+        }
+        auto options = torch::TensorOptions().dtype(torch::kFloat64);
+        long n = members.size();
+        h_t = torch::from_blob(initial_h.data(), {1, n, long(hidden_size)}, options).clone().to(device);
+        c_t = torch::from_blob(initial_c.data(), {1, n, long(hidden_size)}, options).clone().to(device);
+        initial_h = std::vector<double>();
+        initial_c = std::vector<double>();
+        host_inputs = make_host_inputs(n, device);
+        if (device.is_cuda()) {
+            device_inputs = torch::empty({n, NUM_INPUTS}, torch::TensorOptions().dtype(torch::kFloat32).device(device));
+        }
+        first_kept_step = t_index;
+    }
+
+    double lstm_batch::get_flow(std::size_t member, long t_index, long t_delta_s)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        start(t_index);
+        if (t_index < first_kept_step) {
+            throw std::runtime_error("ERROR: LSTM batch no longer has the flows of time step " + std::to_string(t_index));
+        }
+        while (t_index >= first_kept_step + long(kept_flows.size())) {
+            run_step(first_kept_step + kept_flows.size(), t_delta_s);
+        }
+        double flow = kept_flows[t_index - first_kept_step][member];
+        last_taken_steps[member] = std::max(last_taken_steps[member], t_index);
+        drop_taken_steps();
+        return flow;
+    }
+
+    void lstm_batch::run_to_step(long t_index, long t_delta_s)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        start(t_index);
+        while (t_index >= first_kept_step + long(kept_flows.size())) {
+            run_step(first_kept_step + kept_flows.size(), t_delta_s);
+        }
+    }
+
+    bool lstm_batch::is_on_gpu() const
+    {
+        return device.is_cuda();
+    }
+
+    void lstm_batch::run_step(long t_index, long t_delta_s)
+    {
+        torch::NoGradGuard no_grad_;
+
+        std::size_t n = members.size();
+        //The copy of the last step's inputs to the device has finished, since its flows were read back
+        float* inputs = host_inputs.data_ptr<float>();
+        double forcings[NUM_FORCINGS];
+        for (std::size_t m = 0; m < n; ++m) {
+            sources[m](t_index, t_delta_s, forcings);
+            normalize_inputs(scaling, forcings, members[m], inputs + m * NUM_INPUTS);
+        }
+
+        std::vector<torch::jit::IValue> model_inputs;
+        if (device.is_cuda()) {
+            device_inputs.copy_(host_inputs, /*non_blocking=*/true);
+            model_inputs.push_back(device_inputs);
+        }
+        else {
+            model_inputs.push_back(host_inputs);
+        }
+        model_inputs.push_back(h_t);
+        model_inputs.push_back(c_t);
+        auto output = model.forward(model_inputs).toTuple()->elements();
+        h_t = output[1].toTensor();
+        c_t = output[2].toTensor();
+
+        torch::Tensor flows = output[0].toTensor().reshape({-1}).to(torch::kCPU, torch::kFloat64).contiguous();
+        if (std::size_t(flows.numel()) != n) {
+            throw std::runtime_error("ERROR: LSTM model gave " + std::to_string(flows.numel()) + " flows for a batch of "
+                                     + std::to_string(n) + " catchments.");
+        }
+        const double* normalized = flows.data_ptr<double>();
+        std::vector<double> step_flows(n);
+        for (std::size_t m = 0; m < n; ++m) {
+            //Denormalized, and converted from cfs to cms
+            step_flows[m] = (normalized[m] * scaling.output_std_dev + scaling.output_mean) * 0.028316847;
+        }
+        kept_flows.push_back(std::move(step_flows));
+    }
+
+    void lstm_batch::drop_taken_steps()
+    {
+        long oldest_needed = *std::min_element(last_taken_steps.begin(), last_taken_steps.end()) + 1;
+        while (!kept_flows.empty() && first_kept_step < oldest_needed) {
+            kept_flows.pop_front();
+            ++first_kept_step;
+        }
+    }
+}
+
+#endif //NGEN_LSTM_TORCH_LIB_ACTIVE
@@ -3,6 +3,7 @@
 #include "tshirt_fluxes.h"
 #include "tshirt_state.h"
 #include "Constants.h"
+#include "Logger.hpp"
 #include <cmath>
 
 namespace tshirt {
@@ -71,9 +72,8 @@ namespace tshirt {
                 }
             }
             else {
-                cerr << "ERROR: Nash Cascade size parameter in tshirt model init doesn't match storage vector size "
-                     << "in state parameter"
-                     << endl;
+                NGEN_LOG_ERROR("Nash Cascade size parameter in tshirt model init doesn't match storage vector size "
+                               << "in state parameter");
                 // TODO: return error of some kind here
             }
         }
@@ -82,16 +82,16 @@ namespace tshirt {
     /**
      * Initialize the subsurface groundwater reservoir for the model, in the `groundwater_reservoir` member field.
      *
-     * Initialize the subsurface groundwater reservoir for the model as a Reservoir object, creating the
-     * reservoir with a single outlet.  In particular, this is a Reservoir_Exponential_Outlet object, since the outlet
+     * Initialize the subsurface groundwater reservoir for the model as an Inline_Reservoir object, creating the
+     * reservoir with a single outlet.  In particular, this is an Inline_Exponential_Outlet object, since the outlet
      * requires the following be used to calculate discharge flow:
      *
      *      Cgw * ( exp(expon * S / S_max) - 1 );
      *
      * Note that this function should only be used during object construction.
      *
-     * @see Reservoir
-     * @see Reservoir_Exponential_Outlet
+     * @see Inline_Reservoir
+     * @see Inline_Exponential_Outlet
      */
     void tshirt_model::initialize_groundwater_reservoir()
     {
@@ -99,20 +99,16 @@ namespace tshirt {
         // TODO: (i.e., S == S_max, thus maximizing the term passed to the exp() function, and thereby the equation)
         double max_gw_velocity = std::numeric_limits<double>::max();
 
-        // Build vector of pointers to outlets to pass the custom exponential outlet through
-        vector<std::shared_ptr<Reservoir::Explicit_Time::Reservoir_Outlet>> gw_outlets_vector(1);
         // TODO: verify activation threshold
-        gw_outlets_vector[0] = make_shared<Reservoir::Explicit_Time::Reservoir_Exponential_Outlet>(
-                Reservoir::Explicit_Time::Reservoir_Exponential_Outlet(model_params.Cgw, model_params.expon, 0.0, max_gw_velocity));
-        // Create the reservoir, passing the outlet via the vector argument
-        groundwater_reservoir = Reservoir::Explicit_Time::Reservoir(0.0, model_params.max_groundwater_storage_meters,
-                                                    previous_state->groundwater_storage_meters, gw_outlets_vector);
+        groundwater_reservoir = decltype(groundwater_reservoir)(
+                0.0, model_params.max_groundwater_storage_meters, previous_state->groundwater_storage_meters,
+                Reservoir::Explicit_Time::Inline_Exponential_Outlet(model_params.Cgw, model_params.expon, 0.0, max_gw_velocity));
     }
 
     /**
      * Initialize the subsurface soil reservoir for the model, in the `soil_reservoir` member field.
      *
-     * Initialize the subsurface soil reservoir for the model as a Reservoir object, creating the reservoir
+     * Initialize the subsurface soil reservoir for the model as an Inline_Reservoir object, creating the reservoir
      * with outlets for both the subsurface lateral flow and the percolation flow.  This should only be used during
      * object construction.
      *
@@ -121,44 +117,42 @@ namespace tshirt {
      * for the lateral flow and percolation flow outlets are maintained this class within the lf_outlet_index and
      * perc_outlet_index member variables respectively.
      *
-     * @see Reservoir
+     * @see Inline_Reservoir
      */
     void tshirt_model::initialize_soil_reservoir()
     {
-        // Build the vector of pointers to reservoir outlets
-        vector<std::shared_ptr<Reservoir::Explicit_Time::Reservoir_Outlet>> soil_res_outlets(2);
-
-        // init subsurface lateral flow linear outlet
-        soil_res_outlets[lf_outlet_index] = std::make_shared<Reservoir::Explicit_Time::Reservoir_Linear_Outlet>(
-                Reservoir::Explicit_Time::Reservoir_Linear_Outlet(model_params.Klf, soil_field_capacity_storage_threshold, model_params.max_lateral_flow));
-
-        // init subsurface percolation flow linear outlet
-        // The max perc flow should be equal to the params.satdk value
-        soil_res_outlets[perc_outlet_index] = std::make_shared<Reservoir::Explicit_Time::Reservoir_Linear_Outlet>(
-                Reservoir::Explicit_Time::Reservoir_Linear_Outlet(model_params.satdk * model_params.slope, soil_field_capacity_storage_threshold,
-                                 std::numeric_limits<double>::max()));
-        // Create the reservoir, included the created vector of outlet pointers
-        soil_reservoir = Reservoir::Explicit_Time::Reservoir(0.0, model_params.max_soil_storage_meters,
-                                             previous_state->soil_storage_meters, soil_res_outlets);
+        // Create the reservoir with its outlets in index order: percolation (perc_outlet_index) then lateral flow
+        // (lf_outlet_index), with both activated at the soil field capacity
+        soil_reservoir = decltype(soil_reservoir)(
+                0.0, model_params.max_soil_storage_meters, previous_state->soil_storage_meters,
+                // init subsurface percolation flow linear outlet
+                // The max perc flow should be equal to the params.satdk value
+                Reservoir::Explicit_Time::Inline_Linear_Outlet(model_params.satdk * model_params.slope,
+                                                               soil_field_capacity_storage_threshold,
+                                                               std::numeric_limits<double>::max()),
+                // init subsurface lateral flow linear outlet
+                Reservoir::Explicit_Time::Inline_Linear_Outlet(model_params.Klf, soil_field_capacity_storage_threshold,
+                                                               model_params.max_lateral_flow));
     }
 
     /**
      * Initialize the Nash Cascade reservoirs applied to the subsurface soil reservoir's lateral flow outlet.
      *
-     * Initialize the soil_lf_nash_res member, containing the collection of Reservoir objects used to create
+     * Initialize the soil_lf_nash_res member, containing the collection of Inline_Reservoir objects used to create
      * the Nash Cascade for soil_reservoir lateral flow outlet.  The analogous values for Nash Cascade storage from
      * previous_state are used for current storage of reservoirs at each given index.
      */
     void tshirt_model::initialize_subsurface_lateral_flow_nash_cascade()
     {
-        soil_lf_nash_res.resize(model_params.nash_n);
+        soil_lf_nash_res.clear();
+        soil_lf_nash_res.reserve(model_params.nash_n);
         // TODO: verify correctness of activation_threshold (Sfc) and max_velocity (max_lateral_flow) arg values
-        for (unsigned long i = 0; i < soil_lf_nash_res.size(); ++i) {
+        for (int i = 0; i < model_params.nash_n; ++i) {
             //construct a single linear outlet reservoir
-            soil_lf_nash_res[i] = make_unique<Reservoir::Explicit_Time::Reservoir>(
-                    Reservoir::Explicit_Time::Reservoir(0.0, model_params.max_soil_storage_meters,
-                                        previous_state->nash_cascade_storeage_meters[i], model_params.Kn,
-                                        0.0, model_params.max_lateral_flow));
+            soil_lf_nash_res.emplace_back(0.0, model_params.max_soil_storage_meters,
+                                          previous_state->nash_cascade_storeage_meters[i],
+                                          Reservoir::Explicit_Time::Inline_Linear_Outlet(model_params.Kn, 0.0,
+                                                                                         model_params.max_lateral_flow));
         }
     }
 
@@ -182,6 +176,17 @@ namespace tshirt {
      * @return The calculated soil field capacity storage.
      */
     double tshirt_model::calc_soil_field_capacity_storage_threshold()
+    {
+        return calc_soil_field_capacity_storage_threshold(model_params);
+    }
+
+    /**
+     * Calculate the soil field capacity storage threshold (i.e., "Sfc") of a model with the given parameters.
+     *
+     * @param model_params Model parameters tshirt_params struct.
+     * @return The calculated soil field capacity storage.
+     */
+    double tshirt_model::calc_soil_field_capacity_storage_threshold(const tshirt_params& model_params)
     {
         // Calculate the suction head above water table (Hwt)
         double head_above_water_table =
@@ -297,10 +302,10 @@ namespace tshirt {
         soil_reservoir.response_meters_per_second(mean_timestep_infiltration_m_per_s, (int)dt, subsurface_excess);
 
         // lateral subsurface flow
-        double Qlf = soil_reservoir.velocity_meters_per_second_for_outlet(lf_outlet_index);
+        double Qlf = soil_reservoir.velocity_meters_per_second_for_outlet<lf_outlet_index>();
 
         // percolation flow
-        double Qperc = soil_reservoir.velocity_meters_per_second_for_outlet(perc_outlet_index);
+        double Qperc = soil_reservoir.velocity_meters_per_second_for_outlet<perc_outlet_index>();
 
         // TODO: make sure ET doesn't need to be taken out sooner
         // Get new soil storage amount calculated by reservoir
@@ -314,10 +319,10 @@ namespace tshirt {
         // loop essentially copied from Hymod logic, but with different variable names
         for (unsigned long int i = 0; i < soil_lf_nash_res.size(); ++i) {
             // get response water velocity of reservoir
-            Qlf = soil_lf_nash_res[i]->response_meters_per_second(Qlf, dt, nash_subsurface_excess);
+            Qlf = soil_lf_nash_res[i].response_meters_per_second(Qlf, dt, nash_subsurface_excess);
             // TODO: confirm this is correct
             Qlf += nash_subsurface_excess / dt;
-            current_state->nash_cascade_storeage_meters[i] = soil_lf_nash_res[i]->get_storage_height_meters();
+            current_state->nash_cascade_storeage_meters[i] = soil_lf_nash_res[i].get_storage_height_meters();
         }
 
         // Get response and update gw res state
@@ -336,7 +341,79 @@ namespace tshirt {
         fluxes->surface_runoff_meters_per_second = surface_runoff + (subsurface_excess / dt) + (excess_gw_water / dt);
         //fluxes->surface_runoff_meters_per_second = surface_runoff_depth_m;
 
-        return mass_check(input_storage_m, dt);
+        if (mass_check_interval == 1) {
+            return mass_check(input_storage_m, dt);
+        }
+        // Otherwise, only account for the water of this time step, leaving the check to the end of the period
+        mass_check_period_input_m += input_storage_m;
+        mass_check_period_outflow_m += fluxes->et_loss_meters
+                                       + (fluxes->surface_runoff_meters_per_second
+                                          + fluxes->soil_lateral_flow_meters_per_second
+                                          + fluxes->groundwater_flow_meters_per_second) * dt;
+        return ++steps_since_mass_check == mass_check_interval ? check_accumulated_mass_balance()
+                                                               : tshirt::TSHIRT_NO_ERROR;
+    }
+
+    /**
+     * Set how many time steps each mass check covers, and start a new period of accounting from the current state.
+     *
+     * @param interval The number of time steps each mass check covers, or ``0`` to only check when asked.
+     * @see tshirt_model::check_accumulated_mass_balance
+     */
+    void tshirt_model::set_mass_check_interval(unsigned int interval) {
+        mass_check_interval = interval;
+        steps_since_mass_check = 0;
+        mass_check_period_start_storage_m = calc_total_storage_meters(*current_state);
+        mass_check_period_input_m = 0.0;
+        mass_check_period_outflow_m = 0.0;
+    }
+
+    unsigned int tshirt_model::get_mass_check_interval() {
+        return mass_check_interval;
+    }
+
+    /**
+     * Set the largest acceptable error of the groundwater outlet velocity, read from a table built now.
+     *
+     * @param tolerance_meters_per_second The largest acceptable velocity error, in meters per second, or ``0`` to
+     *                                    compute every velocity.
+     * @see Exponential_Outlet_Table
+     */
+    void tshirt_model::set_groundwater_table_tolerance(double tolerance_meters_per_second) {
+        groundwater_reservoir.set_outlet_table_tolerance(tolerance_meters_per_second);
+    }
+
+    /**
+     * Check that mass was conserved over the time steps since the last check, and start a new period of accounting.
+     *
+     * @return The appropriate code value indicating whether mass was conserved over the period.
+     */
+    int tshirt_model::check_accumulated_mass_balance() {
+        double current_storage_m = calc_total_storage_meters(*current_state);
+        double abs_mass_diff_meters = abs((mass_check_period_start_storage_m + mass_check_period_input_m)
+                                          - (current_storage_m + mass_check_period_outflow_m));
+
+        steps_since_mass_check = 0;
+        mass_check_period_start_storage_m = current_storage_m;
+        mass_check_period_input_m = 0.0;
+        mass_check_period_outflow_m = 0.0;
+
+        return abs_mass_diff_meters > get_mass_check_error_bound() ? tshirt::TSHIRT_MASS_BALANCE_ERROR
+                                                                   : tshirt::TSHIRT_NO_ERROR;
+    }
+
+    /**
+     * Get the total storage of a state, across the soil, the groundwater and the Nash Cascade reservoirs.
+     *
+     * @param state The state for which to get the total storage.
+     * @return The total storage, in meters.
+     */
+    double tshirt_model::calc_total_storage_meters(const tshirt_state &state) {
+        double storage_m = state.soil_storage_meters + state.groundwater_storage_meters;
+        for (double nash_storage_m : state.nash_cascade_storeage_meters) {
+            storage_m += nash_storage_m;
+        }
+        return storage_m;
     }
 
     /**
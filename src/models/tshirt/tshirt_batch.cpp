@@ -0,0 +1,335 @@
+#include "tshirt_batch.h"
+#include "TshirtErrorCodes.h"
+#include "RunoffPartitioningBatch.hpp"
+#include "reservoir/Reservoir_Batch.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace tshirt {
+
+    using Reservoir::Explicit_Time::batch::fill_reservoir;
+    using Reservoir::Explicit_Time::batch::drain_reservoir;
+    using Reservoir::Explicit_Time::batch::linear_outlet_velocity;
+
+    template <typename Real>
+    std::size_t basic_tshirt_batch<Real>::add_member(const tshirt_params& model_params,
+                                                     const tshirt_state& initial_state)
+    {
+        std::vector<double> nash_storage = initial_state.nash_cascade_storeage_meters;
+        if (nash_storage.empty()) {
+            nash_storage.resize(model_params.nash_n, 0.0);
+        }
+        if (nash_storage.size() != model_params.nash_n) {
+            throw std::invalid_argument("Nash Cascade size parameter in tshirt batch member doesn't match storage "
+                                        "vector size in state parameter (" + std::to_string(model_params.nash_n)
+                                        + " != " + std::to_string(nash_storage.size()) + ")");
+        }
+
+        std::size_t member = size();
+        schaake_constant.push_back(model_params.Cschaake);
+        max_soil_storage_m.push_back(model_params.max_soil_storage_meters);
+        soil_field_capacity_m.push_back(tshirt_model::calc_soil_field_capacity_storage_threshold(model_params));
+        lateral_flow_coefficient.push_back(model_params.Klf);
+        percolation_coefficient.push_back(model_params.satdk * model_params.slope);
+        max_lateral_flow.push_back(model_params.max_lateral_flow);
+        nash_coefficient.push_back(model_params.Kn);
+        nash_n.push_back(model_params.nash_n);
+        groundwater_coefficient.push_back(model_params.Cgw);
+        groundwater_expon.push_back(model_params.expon);
+        max_groundwater_storage_m.push_back(model_params.max_groundwater_storage_meters);
+
+        soil_storage_m.push_back(initial_state.soil_storage_meters);
+        soil_reservoir_storage_m.push_back(initial_state.soil_storage_meters);
+        groundwater_storage_m.push_back(initial_state.groundwater_storage_meters);
+        while (nash_storage_m.size() < nash_storage.size()) {
+            nash_storage_m.emplace_back(member, 0.0);
+        }
+        for (std::size_t i = 0; i < nash_storage_m.size(); ++i) {
+            nash_storage_m[i].push_back(i < nash_storage.size() ? nash_storage[i] : 0.0);
+        }
+        previous_storage_m.push_back(0.0);
+
+        surface_runoff_m_per_s.push_back(0.0);
+        groundwater_flow_m_per_s.push_back(0.0);
+        percolation_flow_m_per_s.push_back(0.0);
+        lateral_flow_m_per_s.push_back(0.0);
+        et_loss_m.push_back(0.0);
+        mass_check_results.push_back(TSHIRT_NO_ERROR);
+
+        // From the stored values, which in single precision are rounded from those of the state
+        double total_storage_m = (double) soil_storage_m[member] + (double) groundwater_storage_m[member];
+        for (std::size_t i = 0; i < nash_storage_m.size(); ++i) {
+            total_storage_m += nash_storage_m[i][member];
+        }
+        mass_check_period_start_storage_m.push_back(total_storage_m);
+        mass_check_period_input_m.push_back(0.0);
+        mass_check_period_outflow_m.push_back(0.0);
+        return member;
+    }
+
+    template <typename Real>
+    std::size_t basic_tshirt_batch<Real>::size() const
+    {
+        return soil_storage_m.size();
+    }
+
+    template <typename Real>
+    std::size_t basic_tshirt_batch<Real>::run(double dt, const std::vector<Real>& input_storage_m,
+                                              const std::vector<std::shared_ptr<pdm03_struct>>& et_params)
+    {
+        const std::size_t n = size();
+        if (input_storage_m.size() != n || et_params.size() != n) {
+            throw std::invalid_argument("Tshirt batch of " + std::to_string(n) + " members run with inputs for "
+                                        + std::to_string(input_storage_m.size()) + " and ET params for "
+                                        + std::to_string(et_params.size()));
+        }
+        // As in tshirt_model::run, the reservoirs take whole seconds
+        const Real delta_time_s = (Real) (int) dt;
+        const Real dt_s = (Real) dt;
+
+        // Total storage before the step, for the mass check, unless the check covers more than this step
+        const bool checks_each_step = mass_check_interval == 1;
+        if (checks_each_step) {
+            #pragma omp simd
+            for (std::size_t m = 0; m < n; ++m) {
+                previous_storage_m[m] = (double) soil_storage_m[m] + (double) groundwater_storage_m[m];
+            }
+            for (std::size_t i = 0; i < nash_storage_m.size(); ++i) {
+                const Real *nash_storage = nash_storage_m[i].data();
+                #pragma omp simd
+                for (std::size_t m = 0; m < n; ++m) {
+                    previous_storage_m[m] += nash_storage[m];
+                }
+            }
+        }
+
+        // Schaake partitioning, in double
+        std::vector<double> soil_column_moisture_deficit_m(n);
+        std::vector<double> water_input_m(n);
+        #pragma omp simd
+        for (std::size_t m = 0; m < n; ++m) {
+            soil_column_moisture_deficit_m[m] = (double) max_soil_storage_m[m] - (double) soil_storage_m[m];
+            water_input_m[m] = input_storage_m[m];
+        }
+        std::vector<double> surface_runoff_m(n);
+        std::vector<double> subsurface_infiltration_m(n);
+        runoff::batch::schaake_partitioning_scheme(n, dt, schaake_constant.data(),
+                                                   soil_column_moisture_deficit_m.data(), water_input_m.data(),
+                                                   surface_runoff_m.data(), subsurface_infiltration_m.data());
+
+        // The soil reservoir, with its percolation outlet then its lateral flow outlet (in the order the outlets of
+        // tshirt_model's soil reservoir are sorted into)
+        std::vector<Real> excess_m(n);
+        #pragma omp simd
+        for (std::size_t m = 0; m < n; ++m) {
+            Real storage = soil_reservoir_storage_m[m];
+            Real excess;
+            fill_reservoir((Real) (subsurface_infiltration_m[m] / dt), delta_time_s, max_soil_storage_m[m], storage,
+                           excess);
+            Real Qperc = linear_outlet_velocity(percolation_coefficient[m], soil_field_capacity_m[m],
+                                                std::numeric_limits<Real>::max(), max_soil_storage_m[m], storage);
+            Qperc = drain_reservoir(Qperc, delta_time_s, Real(0), max_soil_storage_m[m], storage, excess);
+            Real Qlf = linear_outlet_velocity(lateral_flow_coefficient[m], soil_field_capacity_m[m],
+                                              max_lateral_flow[m], max_soil_storage_m[m], storage);
+            Qlf = drain_reservoir(Qlf, delta_time_s, Real(0), max_soil_storage_m[m], storage, excess);
+
+            soil_reservoir_storage_m[m] = storage;
+            percolation_flow_m_per_s[m] = Qperc;
+            lateral_flow_m_per_s[m] = Qlf;
+            // The surface runoff, to which the soil and groundwater excess is added
+            surface_runoff_m_per_s[m] = (Real) surface_runoff_m[m];
+            excess_m[m] = excess;
+        }
+
+        // ET, which the soil reservoir itself keeps (as in tshirt_model), with the PDM of every member run at once
+        // between gathering the members' ET params and passing its outputs back to them
+        runoff::batch::pdm03_arrays pdm(n);
+        for (std::size_t m = 0; m < n; ++m) {
+            et_params[m]->final_height_reservoir = soil_reservoir_storage_m[m];
+            pdm.set(m, *et_params[m]);
+        }
+        runoff::batch::pdm03(pdm);
+        for (std::size_t m = 0; m < n; ++m) {
+            pdm.get_outputs(m, *et_params[m]);
+            double new_soil_storage_m = soil_reservoir_storage_m[m];
+            double et_loss = pdm.final_height_reservoir[m] - new_soil_storage_m;
+            et_loss_m[m] = (Real) et_loss;
+            soil_storage_m[m] = (Real) (new_soil_storage_m - et_loss);
+        }
+
+        // Each reservoir of the lateral flow Nash cascades, in every member that has it
+        for (std::size_t i = 0; i < nash_storage_m.size(); ++i) {
+            Real *nash_storage = nash_storage_m[i].data();
+            #pragma omp simd
+            for (std::size_t m = 0; m < n; ++m) {
+                Real storage = nash_storage[m];
+                Real nash_excess;
+                Real Qlf = lateral_flow_m_per_s[m];
+                fill_reservoir(Qlf, delta_time_s, max_soil_storage_m[m], storage, nash_excess);
+                Real velocity = linear_outlet_velocity(nash_coefficient[m], Real(0), max_lateral_flow[m],
+                                                       max_soil_storage_m[m], storage);
+                velocity = drain_reservoir(velocity, delta_time_s, Real(0), max_soil_storage_m[m], storage,
+                                           nash_excess);
+
+                bool has_reservoir = (int) i < nash_n[m];
+                nash_storage[m] = has_reservoir ? storage : nash_storage[m];
+                lateral_flow_m_per_s[m] = has_reservoir ? velocity + nash_excess / dt_s : Qlf;
+            }
+        }
+
+        // The groundwater reservoir, with its exponential outlet
+        #pragma omp simd
+        for (std::size_t m = 0; m < n; ++m) {
+            Real storage = groundwater_storage_m[m];
+            Real excess_gw_water;
+            fill_reservoir(percolation_flow_m_per_s[m], delta_time_s, max_groundwater_storage_m[m], storage,
+                           excess_gw_water);
+            Real velocity = groundwater_coefficient[m]
+                            * (std::exp(groundwater_expon[m] * storage / max_groundwater_storage_m[m]) - 1);
+            velocity = (storage <= 0) ? Real(0) : velocity;
+            velocity = drain_reservoir(velocity, delta_time_s, Real(0), max_groundwater_storage_m[m], storage,
+                                       excess_gw_water);
+
+            groundwater_storage_m[m] = storage;
+            groundwater_flow_m_per_s[m] = velocity;
+            surface_runoff_m_per_s[m] = surface_runoff_m_per_s[m] + (excess_m[m] / dt_s) + (excess_gw_water / dt_s);
+        }
+
+        if (checks_each_step) {
+            return mass_check(dt, input_storage_m);
+        }
+        // Otherwise, only account for the water of this time step, leaving the check to the end of the period
+        #pragma omp simd
+        for (std::size_t m = 0; m < n; ++m) {
+            mass_check_period_input_m[m] += input_storage_m[m];
+            mass_check_period_outflow_m[m] += (double) et_loss_m[m]
+                                              + ((double) surface_runoff_m_per_s[m] + (double) lateral_flow_m_per_s[m]
+                                                 + (double) groundwater_flow_m_per_s[m]) * dt;
+        }
+        return ++steps_since_mass_check == mass_check_interval ? check_accumulated_mass_balance() : 0;
+    }
+
+    template <typename Real>
+    std::vector<double> basic_tshirt_batch<Real>::calc_total_storage_m() const
+    {
+        const std::size_t n = size();
+        std::vector<double> total_storage_m(n);
+        #pragma omp simd
+        for (std::size_t m = 0; m < n; ++m) {
+            total_storage_m[m] = (double) soil_storage_m[m] + (double) groundwater_storage_m[m];
+        }
+        for (std::size_t i = 0; i < nash_storage_m.size(); ++i) {
+            const Real *nash_storage = nash_storage_m[i].data();
+            #pragma omp simd
+            for (std::size_t m = 0; m < n; ++m) {
+                total_storage_m[m] += nash_storage[m];
+            }
+        }
+        return total_storage_m;
+    }
+
+    template <typename Real>
+    std::size_t basic_tshirt_batch<Real>::mass_check(double dt, const std::vector<Real>& input_storage_m)
+    {
+        const std::size_t n = size();
+        std::vector<double> current_storage_m = calc_total_storage_m();
+
+        std::size_t failures = 0;
+        #pragma omp simd reduction(+:failures)
+        for (std::size_t m = 0; m < n; ++m) {
+            double previous_m = previous_storage_m[m] + input_storage_m[m];
+            // Increase final mass by calculated fluxes that leave the system (i.e., not the percolation flow)
+            double current_m = current_storage_m[m];
+            current_m += et_loss_m[m];
+            current_m += (double) surface_runoff_m_per_s[m] * dt;
+            current_m += (double) lateral_flow_m_per_s[m] * dt;
+            current_m += (double) groundwater_flow_m_per_s[m] * dt;
+
+            bool failed = std::abs(previous_m - current_m) > mass_check_error_bound;
+            mass_check_results[m] = failed ? TSHIRT_MASS_BALANCE_ERROR : TSHIRT_NO_ERROR;
+            failures += failed ? 1 : 0;
+        }
+        return failures;
+    }
+
+    template <typename Real>
+    std::size_t basic_tshirt_batch<Real>::check_accumulated_mass_balance()
+    {
+        const std::size_t n = size();
+        std::vector<double> current_storage_m = calc_total_storage_m();
+
+        std::size_t failures = 0;
+        #pragma omp simd reduction(+:failures)
+        for (std::size_t m = 0; m < n; ++m) {
+            double previous_m = mass_check_period_start_storage_m[m] + mass_check_period_input_m[m];
+            double current_m = current_storage_m[m] + mass_check_period_outflow_m[m];
+
+            bool failed = std::abs(previous_m - current_m) > mass_check_error_bound;
+            mass_check_results[m] = failed ? TSHIRT_MASS_BALANCE_ERROR : TSHIRT_NO_ERROR;
+            failures += failed ? 1 : 0;
+
+            mass_check_period_start_storage_m[m] = current_storage_m[m];
+            mass_check_period_input_m[m] = 0.0;
+            mass_check_period_outflow_m[m] = 0.0;
+        }
+        steps_since_mass_check = 0;
+        return failures;
+    }
+
+    template <typename Real>
+    void basic_tshirt_batch<Real>::set_mass_check_interval(unsigned int interval)
+    {
+        mass_check_interval = interval;
+        steps_since_mass_check = 0;
+        mass_check_period_start_storage_m = calc_total_storage_m();
+        std::fill(mass_check_period_input_m.begin(), mass_check_period_input_m.end(), 0.0);
+        std::fill(mass_check_period_outflow_m.begin(), mass_check_period_outflow_m.end(), 0.0);
+    }
+
+    template <typename Real>
+    unsigned int basic_tshirt_batch<Real>::get_mass_check_interval() const
+    {
+        return mass_check_interval;
+    }
+
+    template <typename Real>
+    tshirt_state basic_tshirt_batch<Real>::get_state(std::size_t member) const
+    {
+        std::vector<double> nash_storage(nash_n.at(member));
+        for (std::size_t i = 0; i < nash_storage.size(); ++i) {
+            nash_storage[i] = nash_storage_m[i][member];
+        }
+        return tshirt_state(soil_storage_m[member], groundwater_storage_m[member], std::move(nash_storage));
+    }
+
+    template <typename Real>
+    tshirt_fluxes basic_tshirt_batch<Real>::get_fluxes(std::size_t member) const
+    {
+        tshirt_fluxes fluxes;
+        fluxes.surface_runoff_meters_per_second = surface_runoff_m_per_s.at(member);
+        fluxes.groundwater_flow_meters_per_second = groundwater_flow_m_per_s[member];
+        fluxes.soil_percolation_flow_meters_per_second = percolation_flow_m_per_s[member];
+        fluxes.soil_lateral_flow_meters_per_second = lateral_flow_m_per_s[member];
+        fluxes.et_loss_meters = et_loss_m[member];
+        return fluxes;
+    }
+
+    template <typename Real>
+    int basic_tshirt_batch<Real>::get_mass_check_result(std::size_t member) const
+    {
+        return mass_check_results.at(member);
+    }
+
+    template <typename Real>
+    double basic_tshirt_batch<Real>::get_mass_check_error_bound() const
+    {
+        return mass_check_error_bound;
+    }
+
+    // The precisions the batch is built in, as its definitions are not in the header
+    template class basic_tshirt_batch<double>;
+    template class basic_tshirt_batch<float>;
+}
@@ -49,7 +49,7 @@ extern double nash_cascade(double flux_lat_m, int num_lateral_flow_nash_reservoi
  * @return The calculated amount for current GIUH runoff in meters.
  */
 extern double convolution_integral(double runoff_m, int num_giuh_ordinates,
-                                   double *giuh_ordinates, double *runoff_queue_m_per_timestep) {
+                                   const double *giuh_ordinates, double *runoff_queue_m_per_timestep) {
     //##############################################################
     // This function solves the convolution integral involving N
     //  GIUH ordinates.
@@ -265,7 +265,7 @@ extern int run(NWM_soil_parameters& NWM_soil_params,
                conceptual_reservoir& gw_reservoir,
                conceptual_reservoir& soil_reservoir,
                int num_timesteps,
-               double* giuh_ordinates,
+               const double* giuh_ordinates,
                int num_giuh_ordinates,
                double *runoff_queue_m_per_timestep,
                double field_capacity_atm_press_fraction,
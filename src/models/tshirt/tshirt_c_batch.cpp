@@ -0,0 +1,236 @@
+#include "tshirt_c_batch.h"
+#include "RunoffPartitioningBatch.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+std::size_t tshirt_c_batch::add_member(const NWM_soil_parameters& NWM_soil_params,
+                                       const conceptual_reservoir& gw_reservoir,
+                                       const conceptual_reservoir& soil_reservoir,
+                                       const std::vector<double>& giuh_ordinates,
+                                       double Schaake_adjusted_magic_constant_by_soil_type,
+                                       double K_nash,
+                                       int num_lateral_flow_nash_reservoirs,
+                                       const std::vector<double>& nash_storage)
+{
+    if (num_lateral_flow_nash_reservoirs < 0 || num_lateral_flow_nash_reservoirs > MAX_NUM_NASH_CASCADE) {
+        throw std::invalid_argument("Number of Nash Cascade linear reservoirs (" +
+                                    std::to_string(num_lateral_flow_nash_reservoirs) +
+                                    ") is negative or greater than MAX_NUM_NASH_CASCADE.");
+    }
+    if (!nash_storage.empty() && nash_storage.size() != (std::size_t) num_lateral_flow_nash_reservoirs) {
+        throw std::invalid_argument("Nash Cascade storage of size " + std::to_string(nash_storage.size()) +
+                                    " given for " + std::to_string(num_lateral_flow_nash_reservoirs) + " reservoirs.");
+    }
+    if (soil_reservoir.is_exponential == TRUE || gw_reservoir.is_exponential != TRUE) {
+        throw std::invalid_argument("Batched Tshirt C members need a non-exponential soil reservoir and an exponential"
+                                    " groundwater reservoir.");
+    }
+
+    std::size_t member = size();
+    soil_water_capacity_m.push_back(NWM_soil_params.smcmax * NWM_soil_params.D);
+    schaake_constant.push_back(Schaake_adjusted_magic_constant_by_soil_type);
+    soil_storage_max_m.push_back(soil_reservoir.storage_max_m);
+    soil_coeff_primary.push_back(soil_reservoir.coeff_primary);
+    soil_exponent_primary.push_back(soil_reservoir.exponent_primary);
+    soil_storage_threshold_primary_m.push_back(soil_reservoir.storage_threshold_primary_m);
+    soil_coeff_secondary.push_back(soil_reservoir.coeff_secondary);
+    soil_exponent_secondary.push_back(soil_reservoir.exponent_secondary);
+    soil_storage_threshold_secondary_m.push_back(soil_reservoir.storage_threshold_secondary_m);
+    gw_storage_max_m.push_back(gw_reservoir.storage_max_m);
+    gw_coeff_primary.push_back(gw_reservoir.coeff_primary);
+    gw_exponent_primary.push_back(gw_reservoir.exponent_primary);
+    this->K_nash.push_back(K_nash);
+    num_nash_reservoirs.push_back(num_lateral_flow_nash_reservoirs);
+    num_giuh_ordinates.push_back((int) giuh_ordinates.size());
+
+    // Add arrays for any ordinates (and queue entries) the members so far do not have, then this member's values
+    while (this->giuh_ordinates.size() < giuh_ordinates.size()) {
+        this->giuh_ordinates.emplace_back(member, 0.0);
+        giuh_runoff_queue_m.emplace_back(member, 0.0);
+    }
+    for (std::size_t i = 0; i < this->giuh_ordinates.size(); ++i) {
+        this->giuh_ordinates[i].push_back(i < giuh_ordinates.size() ? giuh_ordinates[i] : 0.0);
+        giuh_runoff_queue_m[i].push_back(0.0);
+    }
+    while (nash_storage_m.size() < (std::size_t) num_lateral_flow_nash_reservoirs) {
+        nash_storage_m.emplace_back(member, 0.0);
+    }
+    for (std::size_t i = 0; i < nash_storage_m.size(); ++i) {
+        nash_storage_m[i].push_back(i < nash_storage.size() ? nash_storage[i] : 0.0);
+    }
+
+    soil_storage_m.push_back(soil_reservoir.storage_m);
+    gw_storage_m.push_back(gw_reservoir.storage_m);
+
+    timestep_rainfall_input_m.push_back(0.0);
+    Schaake_output_runoff_m.push_back(0.0);
+    giuh_runoff_m.push_back(0.0);
+    nash_lateral_runoff_m.push_back(0.0);
+    flux_from_deep_gw_to_chan_m.push_back(0.0);
+    Qout_m.push_back(0.0);
+    return member;
+}
+
+std::size_t tshirt_c_batch::size() const
+{
+    return soil_storage_m.size();
+}
+
+void tshirt_c_batch::run(const std::vector<double>& rainfall_input_m)
+{
+    const std::size_t members = size();
+    if (rainfall_input_m.size() != members) {
+        throw std::invalid_argument("Tshirt C batch of " + std::to_string(members) + " members run with inputs for "
+                                    + std::to_string(rainfall_input_m.size()));
+    }
+
+    // Partition rainfall using the Schaake function, on each member's soil reservoir deficit
+    std::vector<double> soil_reservoir_storage_deficit_m(members);
+    std::vector<double> infiltration_depth_m(members);
+    #pragma omp simd
+    for (std::size_t m = 0; m < members; ++m) {
+        timestep_rainfall_input_m[m] = rainfall_input_m[m];
+        soil_reservoir_storage_deficit_m[m] = soil_water_capacity_m[m] - soil_storage_m[m];
+    }
+    runoff::batch::schaake_partitioning_scheme(members, TSHIRT_C_FIXED_TIMESTEP_SIZE_S, schaake_constant.data(),
+                                               soil_reservoir_storage_deficit_m.data(), rainfall_input_m.data(),
+                                               Schaake_output_runoff_m.data(), infiltration_depth_m.data());
+
+    // The soil reservoir, with its percolation and lateral flow outlets, and the groundwater reservoir it percolates to
+    std::vector<double> flux_lat_m(members);
+    #pragma omp simd
+    for (std::size_t m = 0; m < members; ++m) {
+        // Put what won't fit in the soil back into runoff.  As ``run`` is only ever called for one time step, its
+        // second such check, on the percolation of the previous step, never changes anything, so is left out.
+        double deficit_m = soil_reservoir_storage_deficit_m[m];
+        double infiltration_m = infiltration_depth_m[m];
+        bool overfills = deficit_m < infiltration_m;
+        Schaake_output_runoff_m[m] += overfills ? infiltration_m - deficit_m : 0.0;
+        infiltration_m = overfills ? deficit_m : infiltration_m;
+        double soil_m = (overfills ? soil_storage_max_m[m] : soil_storage_m[m]) + infiltration_m;
+
+        // As conceptual_reservoir_flux_calc, for the two outlets
+        double above_primary_m = soil_m - soil_storage_threshold_primary_m[m];
+        double percolation_m = soil_coeff_primary[m] *
+                               pow((above_primary_m > 0.0 ? above_primary_m : 0.0) /
+                                   (soil_storage_max_m[m] - soil_storage_threshold_primary_m[m]),
+                                   soil_exponent_primary[m]);
+        percolation_m = (percolation_m > above_primary_m) ? above_primary_m : percolation_m;
+        percolation_m = (above_primary_m > 0.0) ? percolation_m : 0.0;
+
+        double above_secondary_m = soil_m - soil_storage_threshold_secondary_m[m];
+        double lateral_m = soil_coeff_secondary[m] *
+                           pow((above_secondary_m > 0.0 ? above_secondary_m : 0.0) /
+                               (soil_storage_max_m[m] - soil_storage_threshold_secondary_m[m]),
+                               soil_exponent_secondary[m]);
+        lateral_m = (lateral_m > (above_secondary_m - percolation_m)) ? above_secondary_m - percolation_m : lateral_m;
+        lateral_m = (above_secondary_m > 0.0) ? lateral_m : 0.0;
+
+        // Limit percolation to what the groundwater reservoir has room for
+        double gw_m = gw_storage_m[m];
+        double gw_reservoir_storage_deficit_m = gw_storage_max_m[m] - gw_m;
+        percolation_m = (percolation_m > gw_reservoir_storage_deficit_m) ? gw_reservoir_storage_deficit_m
+                                                                         : percolation_m;
+        gw_m += percolation_m;
+        soil_m -= percolation_m;
+        soil_m -= lateral_m;
+
+        // Base flow, from the exponential groundwater outlet
+        double base_flow_m = gw_coeff_primary[m] * (exp(gw_exponent_primary[m] * gw_m / gw_storage_max_m[m]) - 1.0);
+        gw_m -= base_flow_m;
+
+        soil_storage_m[m] = soil_m;
+        gw_storage_m[m] = gw_m;
+        flux_lat_m[m] = lateral_m;
+        flux_from_deep_gw_to_chan_m[m] = base_flow_m;
+    }
+
+    // The GIUH convolution, as convolution_integral, one ordinate index at a time, leaving the last entry of each
+    // member's queue empty for the next time step
+    const std::size_t num_ordinates = giuh_ordinates.size();
+    for (std::size_t i = 0; i < num_ordinates; ++i) {
+        const double *ordinates = giuh_ordinates[i].data();
+        double *queue = giuh_runoff_queue_m[i].data();
+        #pragma omp simd
+        for (std::size_t m = 0; m < members; ++m) {
+            queue[m] += ordinates[m] * Schaake_output_runoff_m[m];
+        }
+    }
+    if (num_ordinates > 0) {
+        giuh_runoff_m = giuh_runoff_queue_m[0];
+        for (std::size_t i = 0; i + 1 < num_ordinates; ++i) {
+            giuh_runoff_queue_m[i].swap(giuh_runoff_queue_m[i + 1]);
+        }
+        std::fill(giuh_runoff_queue_m[num_ordinates - 1].begin(), giuh_runoff_queue_m[num_ordinates - 1].end(), 0.0);
+    }
+    else {
+        std::fill(giuh_runoff_m.begin(), giuh_runoff_m.end(), 0.0);
+    }
+
+    // Each reservoir of the lateral flow Nash cascades, as nash_cascade, in every member that has it
+    nash_lateral_runoff_m = flux_lat_m;
+    for (std::size_t i = 0; i < nash_storage_m.size(); ++i) {
+        double *nash_storage = nash_storage_m[i].data();
+        #pragma omp simd
+        for (std::size_t m = 0; m < members; ++m) {
+            double inflow_m = nash_lateral_runoff_m[m];
+            double outflow_m = K_nash[m] * nash_storage[m];
+            bool has_reservoir = (int) i < num_nash_reservoirs[m];
+            nash_storage[m] = has_reservoir ? (nash_storage[m] - outflow_m) + inflow_m : nash_storage[m];
+            nash_lateral_runoff_m[m] = has_reservoir ? outflow_m : inflow_m;
+        }
+    }
+
+    #pragma omp simd
+    for (std::size_t m = 0; m < members; ++m) {
+        Qout_m[m] = giuh_runoff_m[m] + nash_lateral_runoff_m[m] + flux_from_deep_gw_to_chan_m[m];
+    }
+}
+
+void tshirt_c_batch::get_state(std::size_t member, conceptual_reservoir& gw_reservoir,
+                               conceptual_reservoir& soil_reservoir, std::vector<double>& nash_storage,
+                               std::vector<double>& giuh_runoff_queue_m) const
+{
+    gw_reservoir.is_exponential = TRUE;
+    gw_reservoir.storage_max_m = gw_storage_max_m.at(member);
+    gw_reservoir.storage_m = gw_storage_m[member];
+    gw_reservoir.coeff_primary = gw_coeff_primary[member];
+    gw_reservoir.exponent_primary = gw_exponent_primary[member];
+    gw_reservoir.storage_threshold_primary_m = 0.0;
+    gw_reservoir.storage_threshold_secondary_m = 0.0;
+    gw_reservoir.coeff_secondary = 0.0;
+    gw_reservoir.exponent_secondary = 1.0;
+
+    soil_reservoir.is_exponential = FALSE;
+    soil_reservoir.storage_max_m = soil_storage_max_m[member];
+    soil_reservoir.storage_m = soil_storage_m[member];
+    soil_reservoir.coeff_primary = soil_coeff_primary[member];
+    soil_reservoir.exponent_primary = soil_exponent_primary[member];
+    soil_reservoir.storage_threshold_primary_m = soil_storage_threshold_primary_m[member];
+    soil_reservoir.storage_threshold_secondary_m = soil_storage_threshold_secondary_m[member];
+    soil_reservoir.coeff_secondary = soil_coeff_secondary[member];
+    soil_reservoir.exponent_secondary = soil_exponent_secondary[member];
+
+    nash_storage.resize(num_nash_reservoirs[member]);
+    for (std::size_t i = 0; i < nash_storage.size(); ++i) {
+        nash_storage[i] = nash_storage_m[i][member];
+    }
+    giuh_runoff_queue_m.assign(num_giuh_ordinates[member] + 1, 0.0);
+    for (int i = 0; i < num_giuh_ordinates[member]; ++i) {
+        giuh_runoff_queue_m[i] = this->giuh_runoff_queue_m[i][member];
+    }
+}
+
+tshirt_c_result_fluxes tshirt_c_batch::get_fluxes(std::size_t member) const
+{
+    tshirt_c_result_fluxes fluxes;
+    fluxes.timestep_rainfall_input_m = timestep_rainfall_input_m.at(member);
+    fluxes.Schaake_output_runoff_m = Schaake_output_runoff_m[member];
+    fluxes.giuh_runoff_m = giuh_runoff_m[member];
+    fluxes.nash_lateral_runoff_m = nash_lateral_runoff_m[member];
+    fluxes.flux_from_deep_gw_to_chan_m = flux_from_deep_gw_to_chan_m[member];
+    fluxes.Qout_m = Qout_m[member];
+    return fluxes;
+}
@@ -0,0 +1,262 @@
+#include "tshirt_c_device_batch.h"
+#include "RunoffPartitioningBatch.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+tshirt_c_device_batch::tshirt_c_device_batch(const tshirt_c_batch& batch)
+    : members(batch.size()), num_ordinates(batch.giuh_ordinates.size()), num_nash(batch.nash_storage_m.size()),
+      values((num_fields + 2 * num_ordinates + num_nash) * members), num_nash_reservoirs(batch.num_nash_reservoirs)
+{
+    const std::vector<double>* fields[num_fields] = {
+            &batch.soil_water_capacity_m, &batch.schaake_constant, &batch.soil_storage_max_m,
+            &batch.soil_coeff_primary, &batch.soil_exponent_primary, &batch.soil_storage_threshold_primary_m,
+            &batch.soil_coeff_secondary, &batch.soil_exponent_secondary, &batch.soil_storage_threshold_secondary_m,
+            &batch.gw_storage_max_m, &batch.gw_coeff_primary, &batch.gw_exponent_primary, &batch.K_nash,
+            &batch.soil_storage_m, &batch.gw_storage_m, &batch.timestep_rainfall_input_m,
+            &batch.Schaake_output_runoff_m, &batch.giuh_runoff_m, &batch.nash_lateral_runoff_m,
+            &batch.flux_from_deep_gw_to_chan_m, &batch.Qout_m};
+    for (int f = 0; f < num_fields; ++f) {
+        std::copy(fields[f]->begin(), fields[f]->end(), values.begin() + offset((field) f));
+    }
+    for (std::size_t i = 0; i < num_ordinates; ++i) {
+        std::copy(batch.giuh_ordinates[i].begin(), batch.giuh_ordinates[i].end(),
+                  values.begin() + (num_fields + i) * members);
+        std::copy(batch.giuh_runoff_queue_m[i].begin(), batch.giuh_runoff_queue_m[i].end(),
+                  values.begin() + queue_offset(i));
+    }
+    for (std::size_t i = 0; i < num_nash; ++i) {
+        std::copy(batch.nash_storage_m[i].begin(), batch.nash_storage_m[i].end(),
+                  values.begin() + (num_fields + 2 * num_ordinates + i) * members);
+    }
+
+    if (members > 0) {
+        double *v = values.data();
+        const std::size_t num_values = values.size();
+        int *nash_n = num_nash_reservoirs.data();
+        #pragma omp target enter data map(to: v[0:num_values], nash_n[0:members])
+    }
+}
+
+tshirt_c_device_batch::~tshirt_c_device_batch()
+{
+    if (members > 0) {
+        double *v = values.data();
+        const std::size_t num_values = values.size();
+        int *nash_n = num_nash_reservoirs.data();
+        #pragma omp target exit data map(delete: v[0:num_values], nash_n[0:members])
+        if (forcing_steps > 0) {
+            double *f = forcing.data();
+            const std::size_t num_forcing = forcing.size();
+            #pragma omp target exit data map(delete: f[0:num_forcing])
+        }
+    }
+}
+
+std::size_t tshirt_c_device_batch::queue_offset(std::size_t i) const
+{
+    return (num_fields + num_ordinates + (queue_head + i) % num_ordinates) * members;
+}
+
+void tshirt_c_device_batch::set_forcing(const std::vector<double>& rainfall_input_m, std::size_t steps)
+{
+    if (rainfall_input_m.size() != steps * members) {
+        throw std::invalid_argument("Tshirt C device batch of " + std::to_string(members) + " members given "
+                                    + std::to_string(rainfall_input_m.size()) + " inputs for "
+                                    + std::to_string(steps) + " time steps");
+    }
+    if (members > 0 && forcing_steps > 0) {
+        double *f = forcing.data();
+        const std::size_t num_forcing = forcing.size();
+        #pragma omp target exit data map(delete: f[0:num_forcing])
+    }
+    forcing = rainfall_input_m;
+    forcing_steps = steps;
+    if (members > 0 && forcing_steps > 0) {
+        double *f = forcing.data();
+        const std::size_t num_forcing = forcing.size();
+        #pragma omp target enter data map(to: f[0:num_forcing])
+    }
+}
+
+std::size_t tshirt_c_device_batch::get_forcing_steps() const
+{
+    return forcing_steps;
+}
+
+void tshirt_c_device_batch::run(std::size_t step)
+{
+    if (step >= forcing_steps) {
+        throw std::out_of_range("Tshirt C device batch run at time step " + std::to_string(step) + " of forcing for "
+                                + std::to_string(forcing_steps));
+    }
+    if (members == 0) {
+        return;
+    }
+
+    const std::size_t n = members;
+    const std::size_t n_ordinates = num_ordinates;
+    const std::size_t n_nash = num_nash;
+    const std::size_t head = queue_head;
+    const std::size_t ordinates_base = num_fields * n;
+    const std::size_t queues_base = (num_fields + n_ordinates) * n;
+    const std::size_t nash_base = (num_fields + 2 * n_ordinates) * n;
+    const std::size_t forcing_base = step * n;
+    const double timestep_d = TSHIRT_C_FIXED_TIMESTEP_SIZE_S / 86400.0;
+    double *v = values.data();
+    const std::size_t num_values = values.size();
+    const int *nash_n = num_nash_reservoirs.data();
+    const double *f = forcing.data();
+    const std::size_t num_forcing = forcing.size();
+
+    // As tshirt_c_batch::run, but with the stages of each member in one iteration; the data is already on the device,
+    // so the mapping only finds it there
+    #pragma omp target teams distribute parallel for simd map(alloc: v[0:num_values], nash_n[0:n], f[0:num_forcing])
+    for (std::size_t m = 0; m < n; ++m) {
+        const double rainfall_m = f[forcing_base + m];
+        v[timestep_rainfall_input_m * n + m] = rainfall_m;
+
+        // Partition rainfall using the Schaake function, on the soil reservoir deficit
+        double deficit_m = v[soil_water_capacity_m * n + m] - v[soil_storage_m * n + m];
+        double runoff_m, infiltration_m;
+        runoff::batch::schaake_partition(timestep_d, v[schaake_constant * n + m], deficit_m, rainfall_m, runoff_m,
+                                         infiltration_m);
+
+        // The soil reservoir, with its percolation and lateral flow outlets, and the groundwater reservoir it
+        // percolates to
+        bool overfills = deficit_m < infiltration_m;
+        runoff_m += overfills ? infiltration_m - deficit_m : 0.0;
+        infiltration_m = overfills ? deficit_m : infiltration_m;
+        const double soil_max_m = v[soil_storage_max_m * n + m];
+        double soil_m = (overfills ? soil_max_m : v[soil_storage_m * n + m]) + infiltration_m;
+
+        const double threshold_primary_m = v[soil_storage_threshold_primary_m * n + m];
+        double above_primary_m = soil_m - threshold_primary_m;
+        double percolation_m = v[soil_coeff_primary * n + m] *
+                               pow((above_primary_m > 0.0 ? above_primary_m : 0.0) /
+                                   (soil_max_m - threshold_primary_m),
+                                   v[soil_exponent_primary * n + m]);
+        percolation_m = (percolation_m > above_primary_m) ? above_primary_m : percolation_m;
+        percolation_m = (above_primary_m > 0.0) ? percolation_m : 0.0;
+
+        const double threshold_secondary_m = v[soil_storage_threshold_secondary_m * n + m];
+        double above_secondary_m = soil_m - threshold_secondary_m;
+        double lateral_m = v[soil_coeff_secondary * n + m] *
+                           pow((above_secondary_m > 0.0 ? above_secondary_m : 0.0) /
+                               (soil_max_m - threshold_secondary_m),
+                               v[soil_exponent_secondary * n + m]);
+        lateral_m = (lateral_m > (above_secondary_m - percolation_m)) ? above_secondary_m - percolation_m : lateral_m;
+        lateral_m = (above_secondary_m > 0.0) ? lateral_m : 0.0;
+
+        const double gw_max_m = v[gw_storage_max_m * n + m];
+        double gw_m = v[gw_storage_m * n + m];
+        double gw_reservoir_storage_deficit_m = gw_max_m - gw_m;
+        percolation_m = (percolation_m > gw_reservoir_storage_deficit_m) ? gw_reservoir_storage_deficit_m
+                                                                         : percolation_m;
+        gw_m += percolation_m;
+        soil_m -= percolation_m;
+        soil_m -= lateral_m;
+
+        double base_flow_m = v[gw_coeff_primary * n + m] * (exp(v[gw_exponent_primary * n + m] * gw_m / gw_max_m)
+                                                            - 1.0);
+        gw_m -= base_flow_m;
+
+        v[soil_storage_m * n + m] = soil_m;
+        v[gw_storage_m * n + m] = gw_m;
+        v[Schaake_output_runoff_m * n + m] = runoff_m;
+        v[flux_from_deep_gw_to_chan_m * n + m] = base_flow_m;
+
+        // The GIUH convolution, into the circular queue, taking and emptying its head for the next time step
+        double giuh_m = 0.0;
+        for (std::size_t i = 0; i < n_ordinates; ++i) {
+            std::size_t slot = head + i < n_ordinates ? head + i : head + i - n_ordinates;
+            v[queues_base + slot * n + m] += v[ordinates_base + i * n + m] * runoff_m;
+        }
+        if (n_ordinates > 0) {
+            giuh_m = v[queues_base + head * n + m];
+            v[queues_base + head * n + m] = 0.0;
+        }
+        v[giuh_runoff_m * n + m] = giuh_m;
+
+        // The lateral flow Nash cascade
+        const double K_m = v[K_nash * n + m];
+        double nash_runoff_m = lateral_m;
+        for (std::size_t i = 0; i < n_nash; ++i) {
+            double *nash_storage = &v[nash_base + i * n + m];
+            double outflow_m = K_m * *nash_storage;
+            bool has_reservoir = (int) i < nash_n[m];
+            *nash_storage = has_reservoir ? (*nash_storage - outflow_m) + nash_runoff_m : *nash_storage;
+            nash_runoff_m = has_reservoir ? outflow_m : nash_runoff_m;
+        }
+        v[nash_lateral_runoff_m * n + m] = nash_runoff_m;
+
+        v[Qout_m * n + m] = giuh_m + nash_runoff_m + base_flow_m;
+    }
+
+    queue_head = n_ordinates > 0 ? (head + 1) % n_ordinates : 0;
+}
+
+void tshirt_c_device_batch::get_Qout(std::vector<double>& outflow_m) const
+{
+    outflow_m.resize(members);
+    if (members == 0) {
+        return;
+    }
+    const double *q = values.data() + offset(Qout_m);
+    const std::size_t n = members;
+    #pragma omp target update from(q[0:n])
+    std::copy(q, q + n, outflow_m.begin());
+}
+
+void tshirt_c_device_batch::copy_to(tshirt_c_batch& batch) const
+{
+    if (batch.size() != members || batch.giuh_ordinates.size() != num_ordinates
+        || batch.nash_storage_m.size() != num_nash) {
+        throw std::invalid_argument("Tshirt C device batch of " + std::to_string(members)
+                                    + " members copied to a batch of " + std::to_string(batch.size()));
+    }
+    if (members == 0) {
+        return;
+    }
+    const double *v = values.data();
+    const std::size_t num_values = values.size();
+    #pragma omp target update from(v[0:num_values])
+
+    std::vector<double>* fields[] = {
+            &batch.soil_storage_m, &batch.gw_storage_m, &batch.timestep_rainfall_input_m,
+            &batch.Schaake_output_runoff_m, &batch.giuh_runoff_m, &batch.nash_lateral_runoff_m,
+            &batch.flux_from_deep_gw_to_chan_m, &batch.Qout_m};
+    for (int f = soil_storage_m; f < num_fields; ++f) {
+        std::size_t start = offset((field) f);
+        fields[f - soil_storage_m]->assign(v + start, v + start + members);
+    }
+    for (std::size_t i = 0; i < num_ordinates; ++i) {
+        std::size_t start = queue_offset(i);
+        batch.giuh_runoff_queue_m[i].assign(v + start, v + start + members);
+    }
+    for (std::size_t i = 0; i < num_nash; ++i) {
+        std::size_t start = (num_fields + 2 * num_ordinates + i) * members;
+        batch.nash_storage_m[i].assign(v + start, v + start + members);
+    }
+}
+
+std::size_t tshirt_c_device_batch::size() const
+{
+    return members;
+}
+
+bool tshirt_c_device_batch::is_offloaded()
+{
+    bool is_on_host = true;
+#ifdef _OPENMP
+    #pragma omp target map(from: is_on_host)
+    {
+        is_on_host = omp_is_initial_device();
+    }
+#endif
+    return !is_on_host;
+}
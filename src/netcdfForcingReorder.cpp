@@ -0,0 +1,299 @@
+#include <FileChecker.h>
+#include <boost/lexical_cast.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <netcdf.h>
+
+/**
+ * @brief Throw if a NetCDF call failed
+ */
+void check(int status, const std::string& what)
+{
+    if( status != NC_NOERR ) {
+        throw std::runtime_error(what + ": " + nc_strerror(status));
+    }
+}
+
+/**
+ * @brief Read the catchment ids of a NetCDF forcing file, from its ``ids`` variable, in the order they are stored
+ *
+ * @param ids_var Set to the id of the ``ids`` variable.
+ * @param id_dim Set to the id of the dimension of the ``ids`` variable.
+ */
+std::vector<std::string> read_ids(int ncid, int& ids_var, int& id_dim)
+{
+    check(nc_inq_varid(ncid, "ids", &ids_var), "ids variable");
+    nc_type type;
+    int ndims;
+    check(nc_inq_var(ncid, ids_var, nullptr, &type, &ndims, nullptr, nullptr), "ids variable");
+    if( ndims != 1 || type != NC_STRING ) {
+        throw std::runtime_error("The \"ids\" variable of a NetCDF forcing file must be one dimensional strings");
+    }
+    check(nc_inq_vardimid(ncid, ids_var, &id_dim), "ids variable");
+    size_t count;
+    check(nc_inq_dimlen(ncid, id_dim, &count), "ids dimension");
+    std::vector<char*> raw(count);
+    std::vector<std::string> ids;
+    if( count > 0 ) {
+        check(nc_get_var_string(ncid, ids_var, raw.data()), "ids variable");
+        ids.assign(raw.begin(), raw.end());
+        nc_free_string(count, raw.data());
+    }
+    return ids;
+}
+
+/**
+ * @brief The order to store catchments in so the catchments of each partition of a partition config are next to each other
+ *
+ * Catchments keep their relative order within a partition; catchments in no partition go last.
+ *
+ * @return The position in @p ids of each catchment, in the order to store them in.
+ */
+std::vector<size_t> order_by_partition(const std::vector<std::string>& ids, const std::string& partition_file)
+{
+    boost::property_tree::ptree tree;
+    boost::property_tree::json_parser::read_json(partition_file, tree);
+    std::unordered_map<std::string, size_t> partition_of;
+    size_t partition = 0;
+    for( auto& part : tree.get_child("partitions") ) {
+        for( auto& cat_id : part.second.get_child("cat-ids") ) {
+            partition_of.emplace(cat_id.second.get_value<std::string>(), partition);
+        }
+        ++partition;
+    }
+    std::vector<size_t> order(ids.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b)
+    {
+        auto pa = partition_of.find(ids[a]);
+        auto pb = partition_of.find(ids[b]);
+        return (pa != partition_of.end() ? pa->second : partition) < (pb != partition_of.end() ? pb->second : partition);
+    });
+    return order;
+}
+
+/**
+ * @brief Copy the values of a variable, moving the rows along the ids dimension into the given order
+ *
+ * Rows that stay next to each other are copied together, as many at a time as fit in @p max_bytes.
+ *
+ * @param order The input row of each output row, when the variable's first dimension is the ids dimension.
+ */
+void copy_values(int in, int in_var, int out, int out_var, int id_dim, const std::vector<size_t>& order, size_t max_bytes)
+{
+    char name[NC_MAX_NAME + 1];
+    nc_type type;
+    int ndims;
+    int dims[NC_MAX_VAR_DIMS];
+    check(nc_inq_var(in, in_var, name, &type, &ndims, dims, nullptr), "variable");
+    size_t value_size;
+    check(nc_inq_type(in, type, nullptr, &value_size), name);
+
+    std::vector<size_t> lengths(std::max(ndims, 1), 1);
+    for( int d = 0; d < ndims; ++d ) {
+        check(nc_inq_dimlen(in, dims[d], &lengths[d]), name);
+        if( d > 0 && dims[d] == id_dim ) {
+            throw std::runtime_error(std::string("Variable ") + name + " has the ids dimension after its first");
+        }
+    }
+    const bool is_reordered = ndims > 0 && dims[0] == id_dim;
+    size_t row_values = 1;
+    for( int d = 1; d < ndims; ++d ) {
+        row_values *= lengths[d];
+    }
+    const size_t rows = ndims > 0 ? lengths[0] : 1;
+    const size_t block_rows = std::max<size_t>(1, max_bytes / std::max<size_t>(1, row_values * value_size));
+    std::vector<char> buffer;
+
+    std::vector<size_t> in_start(std::max(ndims, 1), 0), out_start(std::max(ndims, 1), 0);
+    std::vector<size_t> count(lengths);
+    for( size_t row = 0; row < rows; ) {
+        // The longest run of rows that are next to each other in the input too, up to a block
+        size_t first = is_reordered ? order[row] : row;
+        size_t run = 1;
+        while( row + run < rows && run < block_rows && (is_reordered ? order[row + run] : row + run) == first + run ) {
+            ++run;
+        }
+        in_start[0] = first;
+        out_start[0] = row;
+        count[0] = ndims > 0 ? run : 1;
+        buffer.resize(run * row_values * value_size);
+        check(nc_get_vara(in, in_var, in_start.data(), count.data(), buffer.data()), name);
+        check(nc_put_vara(out, out_var, out_start.data(), count.data(), buffer.data()), name);
+        if( type == NC_STRING ) {
+            nc_free_string(run * row_values, reinterpret_cast<char**>(buffer.data()));
+        }
+        row += run;
+    }
+}
+
+/**
+ * @brief Copy the attributes of a variable, or the global attributes
+ */
+void copy_attributes(int in, int in_var, int out, int out_var)
+{
+    int natts;
+    check(nc_inq_varnatts(in, in_var, &natts), "attributes");
+    for( int a = 0; a < natts; ++a ) {
+        char name[NC_MAX_NAME + 1];
+        check(nc_inq_attname(in, in_var, a, name), "attribute");
+        check(nc_copy_att(in, in_var, name, out, out_var), name);
+    }
+}
+
+/**
+ * @brief Write a copy of a NetCDF forcing file with its catchments stored in the given order
+ *
+ * Every dimension, variable and attribute is copied, along with the storage settings of NetCDF-4 variables; the
+ * rows of the ``ids`` variable, and of every variable whose first dimension is that of ``ids``, are reordered.
+ */
+void reorder_forcing(const std::string& input_path, const std::string& output_path, const std::string& partition_file,
+                     size_t max_bytes)
+{
+    int in, out;
+    check(nc_open(input_path.c_str(), NC_NOWRITE, &in), input_path);
+    int ids_var, id_dim;
+    std::vector<std::string> ids = read_ids(in, ids_var, id_dim);
+    std::vector<size_t> order = order_by_partition(ids, partition_file);
+    int format;
+    check(nc_inq_format(in, &format), input_path);
+    const bool is_netcdf4 = format == NC_FORMAT_NETCDF4 || format == NC_FORMAT_NETCDF4_CLASSIC;
+
+    check(nc_create(output_path.c_str(), NC_NETCDF4 | NC_CLOBBER, &out), output_path);
+
+    int ndims;
+    check(nc_inq_dimids(in, &ndims, nullptr, 0), input_path);
+    std::vector<int> dim_ids(ndims);
+    check(nc_inq_dimids(in, &ndims, dim_ids.data(), 0), input_path);
+    int nunlimited;
+    check(nc_inq_unlimdims(in, &nunlimited, nullptr), input_path);
+    std::vector<int> unlimited(nunlimited);
+    check(nc_inq_unlimdims(in, &nunlimited, unlimited.data()), input_path);
+    std::unordered_map<int, int> out_dims;
+    for( int dim : dim_ids ) {
+        char name[NC_MAX_NAME + 1];
+        size_t length;
+        check(nc_inq_dim(in, dim, name, &length), input_path);
+        bool is_unlimited = std::find(unlimited.begin(), unlimited.end(), dim) != unlimited.end();
+        check(nc_def_dim(out, name, is_unlimited ? NC_UNLIMITED : length, &out_dims[dim]), name);
+    }
+
+    int nvars;
+    check(nc_inq_nvars(in, &nvars), input_path);
+    std::vector<int> out_vars(nvars);
+    for( int v = 0; v < nvars; ++v ) {
+        char name[NC_MAX_NAME + 1];
+        nc_type type;
+        int var_ndims;
+        int dims[NC_MAX_VAR_DIMS];
+        check(nc_inq_var(in, v, name, &type, &var_ndims, dims, nullptr), input_path);
+        if( type > NC_MAX_ATOMIC_TYPE ) {
+            throw std::runtime_error(std::string("Variable ") + name + " has a user defined type, which is not supported");
+        }
+        for( int d = 0; d < var_ndims; ++d ) {
+            dims[d] = out_dims.at(dims[d]);
+        }
+        check(nc_def_var(out, name, type, var_ndims, dims, &out_vars[v]), name);
+        if( is_netcdf4 && var_ndims > 0 ) {
+            int storage;
+            size_t chunks[NC_MAX_VAR_DIMS];
+            check(nc_inq_var_chunking(in, v, &storage, chunks), name);
+            if( storage == NC_CHUNKED ) {
+                check(nc_def_var_chunking(out, out_vars[v], storage, chunks), name);
+            }
+            int shuffle, deflate, level;
+            check(nc_inq_var_deflate(in, v, &shuffle, &deflate, &level), name);
+            if( deflate ) {
+                check(nc_def_var_deflate(out, out_vars[v], shuffle, deflate, level), name);
+            }
+        }
+        copy_attributes(in, v, out, out_vars[v]);
+    }
+    copy_attributes(in, NC_GLOBAL, out, NC_GLOBAL);
+    check(nc_enddef(out), output_path);
+
+    for( int v = 0; v < nvars; ++v ) {
+        if( v == ids_var ) {
+            std::vector<const char*> ordered(ids.size());
+            for( size_t i = 0; i < ids.size(); ++i ) {
+                ordered[i] = ids[order[i]].c_str();
+            }
+            if( !ordered.empty() ) {
+                check(nc_put_var_string(out, out_vars[v], ordered.data()), "ids variable");
+            }
+        }
+        else {
+            copy_values(in, v, out, out_vars[v], id_dim, order, max_bytes);
+        }
+    }
+    check(nc_close(out), output_path);
+    nc_close(in);
+}
+
+int main(int argc, char* argv[])
+{
+    if( argc == 3 && std::string(argv[1]) == "--list-ids" ) {
+        try {
+            int ncid, ids_var, id_dim;
+            check(nc_open(argv[2], NC_NOWRITE, &ncid), argv[2]);
+            for( const auto& id : read_ids(ncid, ids_var, id_dim) ) {
+                std::cout << id << "\n";
+            }
+            nc_close(ncid);
+        }
+        catch(const std::exception& e) {
+            std::cerr<<e.what()<<std::endl;
+            exit(-1);
+        }
+        return 0;
+    }
+    if( argc < 4 ){
+        std::cout << "Missing required args:" << std::endl;
+        std::cout << argv[0] << " <netcdf_forcing_path> <netcdf_forcing_output_name> <partition_config> [memory_mb]" << std::endl;
+        std::cout << "Rewrites a NetCDF forcing file, read with the \"NetCDF\" forcing provider, with the catchments of each partition"<<std::endl;
+        std::cout << "of a partition config (see partitionGenerator) stored next to each other, so each process reads one range of it."<<std::endl;
+        std::cout << "memory_mb (default 1024) bounds the memory used to hold values while they are copied."<<std::endl;
+        std::cout << argv[0] << " --list-ids <netcdf_forcing_path>" << std::endl;
+        std::cout << "Lists the catchment ids of a NetCDF forcing file in the order they are stored, one per line, as the"<<std::endl;
+        std::cout << "forcing order partitionGenerator can keep partitions contiguous in."<<std::endl;
+        exit(-1);
+    }
+
+    if( !utils::FileChecker::file_is_readable(argv[1]) ) {
+        std::cout<<"NetCDF forcing path "<<argv[1]<<" not readable"<<std::endl;
+        exit(-1);
+    }
+    if( !utils::FileChecker::file_is_readable(argv[3]) ) {
+        std::cout<<"partition config path "<<argv[3]<<" not readable"<<std::endl;
+        exit(-1);
+    }
+    size_t memory_mb = 1024;
+    if( argc > 4 ){
+        try {
+            memory_mb = boost::lexical_cast<size_t>(argv[4]);
+            if(memory_mb == 0) throw boost::bad_lexical_cast();
+        }
+        catch(boost::bad_lexical_cast &e) {
+            std::cout<<"memory_mb must be a postive integer."<<std::endl;
+            exit(-1);
+        }
+    }
+
+    try {
+        std::cout<<"Reordering the catchments of "<<argv[1]<<" into "<<argv[2]<<std::endl;
+        reorder_forcing(argv[1], argv[2], argv[3], memory_mb * 1024 * 1024);
+    }
+    catch(const std::exception& e) {
+        std::cerr<<e.what()<<std::endl;
+        exit(-1);
+    }
+    return 0;
+}
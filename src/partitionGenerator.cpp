@@ -8,10 +8,16 @@
 
 #include <boost/algorithm/string.hpp>
 #include <vector>
+#include <unordered_map>
 #include <unordered_set>
 #include <tuple>
+#include <numeric>
+#include <algorithm>
 
 #include "core/Partition_Parser.hpp"
+#include "core/Partition_Binary.hpp"
+#include "MultilevelPartitioner.hpp"
+#include "ThreadPool.hpp"
 
 using PartitionVSet = std::vector<std::unordered_set<std::string> >;
 /**
@@ -282,34 +288,121 @@ void generate_partitions(network::Network& network, const int& num_partitions, c
 }
 
 /**
- * @brief Find the remote rank of a given feature in the partitions
- * 
- * @param id feature id to find in the partitions
+ * @brief Generate a vector of PartitionVSets with the weighted, graph aware network::MultilevelPartitioner.
+ *
+ * Partitions are balanced by the total cost weight of their catchments rather than their number, and the number of
+ * nexuses connecting catchments in different partitions is kept low.
+ *
+ * @param network
+ * @param num_partitions
+ * @param catchment_weights cost weight of each catchment, by id; catchments without one have a weight of 1
+ * @param use_metis whether to partition with METIS rather than the built in partitioner
+ * @param forcing_order catchment ids in the order of the forcing file, whose neighbors are kept in one partition
+ *        where that costs little, so each partition reads few ranges of the file; empty to ignore
+ * @param ranks_per_node if the partitions fill nodes of this many, partition first into nodes and then the catchments
+ *        of each node into its partitions, numbered in blocks of this many (see
+ *        network::MultilevelPartitioner::partition_hierarchical); 0 to partition in one level
+ * @param catchment_part
+ * @param nexus_part
+ * @return whether the partitions were partitioned by node
+ */
+bool generate_weighted_partitions(network::Network& network, const int& num_partitions,
+     const std::unordered_map<std::string, double>& catchment_weights, bool use_metis,
+     const std::vector<std::string>& forcing_order, int ranks_per_node, PartitionVSet& catchment_part, PartitionVSet& nexus_part)
+{
+    network::MultilevelPartitioner partitioner(network, catchment_weights);
+    if (!forcing_order.empty()) {
+        partitioner.add_order_edges(forcing_order);
+    }
+    bool is_by_node = ranks_per_node > 0 && ranks_per_node < num_partitions && num_partitions % ranks_per_node == 0;
+    std::vector<int> parts = is_by_node
+        ? partitioner.partition_hierarchical(num_partitions / ranks_per_node, ranks_per_node, 0.03, use_metis)
+        : partitioner.partition(num_partitions, 0.03, use_metis);
+
+    catchment_part.assign(num_partitions, std::unordered_set<std::string>());
+    nexus_part.assign(num_partitions, std::unordered_set<std::string>());
+    const std::vector<std::string>& catchments = partitioner.catchment_ids();
+    for (std::size_t i = 0; i < catchments.size(); ++i)
+    {
+        const std::string& catchment = catchments[i];
+        //As in generate_partitions, every nexus a catchment touches is required by its partition,
+        //some of which will end up being "remote"
+        std::vector<std::string> destinations = network.get_destination_ids(catchment);
+        if(destinations.size() == 0){
+            std::cerr<<"Error: Catchment "<<catchment<<" has no destination nexus.\n";
+            exit(1);
+        }
+        for( auto downstream : destinations ){
+            nexus_part[parts[i]].emplace(downstream);
+        }
+        for( auto upstream : network.get_origination_ids(catchment) ){
+            nexus_part[parts[i]].emplace(upstream);
+        }
+        catchment_part[parts[i]].emplace(catchment);
+    }
+
+    std::vector<double> weights = network::MultilevelPartitioner::partition_weights(partitioner.get_graph(), parts, num_partitions);
+    double total = std::accumulate(weights.begin(), weights.end(), 0.0);
+    double heaviest = *std::max_element(weights.begin(), weights.end());
+    std::cout << "Partition weights: total " << total << ", heaviest " << heaviest
+              << " (" << heaviest / (total / num_partitions) << "x the average)" << std::endl;
+    std::cout << "Boundary nexuses: " << partitioner.count_boundary_nexuses(parts);
+    if (is_by_node) {
+        std::vector<int> nodes(parts.size());
+        std::transform(parts.begin(), parts.end(), nodes.begin(), [ranks_per_node](int part) { return part / ranks_per_node; });
+        std::cout << ", of which " << partitioner.count_boundary_nexuses(nodes) << " are between the "
+                  << num_partitions / ranks_per_node << " nodes";
+    }
+    std::cout << std::endl;
+    if (!forcing_order.empty()) {
+        std::cout << "Forcing file ranges: " << partitioner.count_order_runs(parts, forcing_order)
+                  << " (at least " << num_partitions << ")" << std::endl;
+    }
+    return is_by_node;
+}
+
+/**
+ * @brief Map each catchment id in the partitions to the number of the partition containing it
+ *
  * @param catchment_partitions The global set of partitions
- * @return int partition number containing the id
- * 
- * @throws runtime_error if no partition contains the requested id
+ * @return The partition number of each catchment id
  */
-int find_remote_rank(const std::string& id, const PartitionVSet& catchment_partitions)
+std::unordered_map<std::string, int> index_partitions(const PartitionVSet& catchment_partitions)
 {
-    int pos = -1;
+    std::unordered_map<std::string, int> partition_of;
+    std::size_t total = 0;
+    for ( const auto& partition : catchment_partitions )
+    {
+        total += partition.size();
+    }
+    partition_of.reserve(total);
     for ( int i = 0; i < catchment_partitions.size(); ++i )
     {
-        // this iterate through the unordered_set
-        auto iter = std::find(catchment_partitions[i].begin(), catchment_partitions[i].end(), id);
-        
-        // if we find a match then we have found the target partition containing this id
-        if ( iter != catchment_partitions[i].end() )
+        for ( const auto& id : catchment_partitions[i] )
         {
-            pos = i;
-            break;
+            partition_of.emplace(id, i);
         }
     }
-    if(pos < 0){
+    return partition_of;
+}
+
+/**
+ * @brief Find the remote rank of a given feature in the partitions
+ * 
+ * @param id feature id to find in the partitions
+ * @param partition_of The partition number of each catchment id, from index_partitions
+ * @return int partition number containing the id
+ * 
+ * @throws runtime_error if no partition contains the requested id
+ */
+int find_remote_rank(const std::string& id, const std::unordered_map<std::string, int>& partition_of)
+{
+    auto iter = partition_of.find(id);
+    if(iter == partition_of.end()){
         std::string msg = "find_remote_rank: Could not find feature id "+id+" in any partition";
         throw std::runtime_error(msg);
     }
-    return pos;
+    return iter->second;
 }
 
 /**
@@ -333,6 +426,7 @@ int find_remote_rank(const std::string& id, const PartitionVSet& catchment_parti
  *
  * @param nexus The nexus to identify remote connections for
  * @param catchment_partitions The global set of partitions
+ * @param partition_of The partition number of each catchment id, from index_partitions
  * @param partition_number The partition to consider local
  * @param origin_ids_to_find The origin (upstream) ids connected to @p nexus to search on
  * @param destination_ids_to_find The destination (downstream) ids connected to @p nexus to search on
@@ -341,7 +435,7 @@ int find_remote_rank(const std::string& id, const PartitionVSet& catchment_parti
  * 
  * @throws invalid_argument if the partition_number is not in the range of valid partition numbers (size of catchment_partitions)
  */
-int find_partition_connections(const std::string& nexus, const PartitionVSet& catchment_partitions, const int& partition_number,  const std::vector<std::string>& origin_ids_to_find, const std::vector<std::string>& destination_ids_to_find, RemoteConnectionVec& remote_connections )
+int find_partition_connections(const std::string& nexus, const PartitionVSet& catchment_partitions, const std::unordered_map<std::string, int>& partition_of, const int& partition_number,  const std::vector<std::string>& origin_ids_to_find, const std::vector<std::string>& destination_ids_to_find, RemoteConnectionVec& remote_connections )
 {
 
     const static std::string origination_cat_to_nex = "orig_cat-to-nex";
@@ -357,12 +451,12 @@ int find_partition_connections(const std::string& nexus, const PartitionVSet& ca
     //Find senders
     for( auto id : destination_ids_to_find )
     {
-        auto iter = std::find(catchments.begin(), catchments.end(), id);
+        auto iter = catchments.find(id);
         if ( iter == catchments.end() )
         {
             //we do not operate the receiving end of this nexus, it must be remote
             //so we need to indicate the need to send
-            int pos = find_remote_rank(id, catchment_partitions);
+            int pos = find_remote_rank(id, partition_of);
             remote_connections.push_back(std::make_tuple(pos, nexus, id, nex_to_destination_cat));
             ++remote_catchments;
         }
@@ -378,7 +472,7 @@ int find_partition_connections(const std::string& nexus, const PartitionVSet& ca
     //Find receivers
     for( auto id : origin_ids_to_find )
     {
-        auto iter = std::find(catchments.begin(), catchments.end(), id);
+        auto iter = catchments.find(id);
         if ( iter == catchments.end() )
         {
             //These are remotes I need establish connection with only if I operate the receiving end of the remote pairs
@@ -387,13 +481,13 @@ int find_partition_connections(const std::string& nexus, const PartitionVSet& ca
             //the appropriate sending tag should have been set in the previous destination_ids loop on appropriate partition
             for(auto did : destination_ids_to_find )
             {
-                auto dest_iter = std::find(catchments.begin(), catchments.end(), did);
+                auto dest_iter = catchments.find(did);
                 if( dest_iter != catchments.end() )
                 {
                     //We operate the receving end of this remote nexus for the communiction pair
                     // (id -> N) (N -> did)
                     //map that relationship
-                    int pos = find_remote_rank(id, catchment_partitions);
+                    int pos = find_remote_rank(id, partition_of);
                     remote_connections.push_back(std::make_tuple(pos, nexus, id, origination_cat_to_nex));
                     ++remote_catchments;
                 }
@@ -417,13 +511,27 @@ int main(int argc, char* argv[])
     using network::Network;
     std::string catchmentDataFile, nexusDataFile;
     std::string partitionOutFile;
+    std::string catchmentWeightsFile;
+    std::string forcingOrderFile;
+    std::string partition_method = "dfs";
     int num_partitions = 0;
+    int ranks_per_node = 0;
     bool  error;
     if( argc < 7 ){
         std::cout << "Missing required args:" << std::endl;
         std::cout << argv[0] << " <catchment_data_path> <nexus_data_path> <partition_output_name> <number of partitions> <catchment_subset_ids> <nexus_subset_ids> " << std::endl;
         std::cout << "Use empty strings for subset_ids for no subsetting, e.g ''\nUse \'cat-X,cat-Y\', \'nex-X,nex-Y\' to partition only the defined catchment and nexus"<<std::endl;
         std::cout << "Note the use of single quotes, and no spaces between the ids.  (no quotes will also work, but  \"\" will not."<<std::endl;
+        std::cout << "Optionally followed by <partition_method> [catchment_weights_path] [forcing_order_path] [ranks_per_node], where partition_method is one of"<<std::endl;
+        std::cout << "  dfs        (default) split the depth first ordered catchments into partitions of equal catchment count"<<std::endl;
+        std::cout << "  multilevel balance partitions by catchment cost weight while minimizing remote nexuses"<<std::endl;
+        std::cout << "  metis      as multilevel, but partitioned with METIS (if ngen was built with METIS support)"<<std::endl;
+        std::cout << "catchment_weights_path is a file of 'cat-id,weight' lines; unlisted catchments have a weight of 1 (or '' for none)."<<std::endl;
+        std::cout << "and forcing_order_path is a file of the catchment ids of the forcing file in order, one per line (e.g. from"<<std::endl;
+        std::cout << "'netcdfForcingReorder --list-ids'), whose neighbors are kept together so each partition reads few ranges of it (or '' for none)."<<std::endl;
+        std::cout << "ranks_per_node numbers the partitions so those sharing the most remote nexuses go to the same node, when ngen's ranks"<<std::endl;
+        std::cout << "are placed on nodes that many at a time, in order (the default block mapping of MPI launchers)."<<std::endl;
+        std::cout << "A partition_output_name ending in .bin writes an indexed binary config, from which each ngen rank reads only its own partition."<<std::endl;
         error = true;
     }
     else {
@@ -454,7 +562,46 @@ int main(int argc, char* argv[])
             std::cout<<"number of partitions must be a postive integer."<<std::endl;
             error = true;
         }
-        
+
+        if( argc > 7 ){
+            partition_method = argv[7];
+            if( partition_method != "dfs" && partition_method != "multilevel" && partition_method != "metis" ){
+                std::cout<<"unknown partition method "<<partition_method<<", expected dfs, multilevel, or metis"<<std::endl;
+                error = true;
+            }
+        }
+        if( argc > 8 && std::string(argv[8]) != "" ){
+            if( !utils::FileChecker::file_is_readable(argv[8]) ) {
+                std::cout<<"catchment weights path "<<argv[8]<<" not readable"<<std::endl;
+                error = true;
+            }
+            else if( partition_method == "dfs" ) {
+                std::cout<<"catchment weights are only used by the multilevel and metis partition methods"<<std::endl;
+                error = true;
+            }
+            else{ catchmentWeightsFile = argv[8]; }
+        }
+        if( argc > 9 && std::string(argv[9]) != "" ){
+            if( !utils::FileChecker::file_is_readable(argv[9]) ) {
+                std::cout<<"forcing order path "<<argv[9]<<" not readable"<<std::endl;
+                error = true;
+            }
+            else if( partition_method == "dfs" ) {
+                std::cout<<"the forcing order is only used by the multilevel and metis partition methods"<<std::endl;
+                error = true;
+            }
+            else{ forcingOrderFile = argv[9]; }
+        }
+        if( argc > 10 ){
+            try {
+                ranks_per_node = boost::lexical_cast<int>(argv[10]);
+                if(ranks_per_node < 1) throw boost::bad_lexical_cast();
+            }
+            catch(boost::bad_lexical_cast &e) {
+                std::cout<<"ranks per node must be a positive integer."<<std::endl;
+                error = true;
+            }
+        }
     }
     if(error) exit(-1);
 
@@ -469,9 +616,6 @@ int main(int argc, char* argv[])
     if(nexus_subset_ids.size() == 1 && nexus_subset_ids[0] == "") nexus_subset_ids.pop_back();
     if(catchment_subset_ids.size() == 1 && catchment_subset_ids[0] == "") catchment_subset_ids.pop_back();
 
-    std::ofstream outFile;
-    outFile.open(partitionOutFile, std::ios::trunc);
-
     //Get the feature collecion for the given hydrofabric
     geojson::GeoJSON catchment_collection = std::move( geojson::read(catchmentDataFile, catchment_subset_ids) );
     int num_catchments = catchment_collection->get_size();
@@ -503,66 +647,119 @@ int main(int argc, char* argv[])
     Network global_network(global_nexus_collection);
 
     //Generate the partitioning
-    generate_partitions(global_network, num_partitions, num_catchments, catchment_part, nexus_part);
+    bool is_placed = false;
+    if( partition_method == "dfs" ){
+        generate_partitions(global_network, num_partitions, num_catchments, catchment_part, nexus_part);
+    }
+    else{
+        std::unordered_map<std::string, double> catchment_weights;
+        if( !catchmentWeightsFile.empty() ){
+            catchment_weights = network::read_catchment_weights(catchmentWeightsFile);
+            std::cout<<"Read cost weights for "<<catchment_weights.size()<<" catchments."<<std::endl;
+        }
+        std::vector<std::string> forcing_order;
+        if( !forcingOrderFile.empty() ){
+            forcing_order = network::read_catchment_order(forcingOrderFile);
+            std::cout<<"Read the forcing order of "<<forcing_order.size()<<" catchments."<<std::endl;
+        }
+        is_placed = generate_weighted_partitions(global_network, num_partitions, catchment_weights, partition_method == "metis",
+                                                 forcing_order, ranks_per_node, catchment_part, nexus_part);
+    }
 
     //global_network.print_network();
 
     //The container holding all remote_connections
-    std::vector<RemoteConnectionVec> remote_connections_vec;
-
-    int total_remotes = 0;
-    // loop over all partitions by partition id
-    for (int ipart=0; ipart < catchment_part.size(); ++ipart)
-    //for (int ipart=0; ipart < 2; ++ipart) // for a quick test
-    {
-        // declare and initialize remote_connections
-        RemoteConnectionVec remote_connections;
-
-        //std::vector<std::string> local_cat_ids = catchment_part[ipart]["cat-ids"];
-        std::unordered_set<std::string> & local_cat_set = catchment_part[ipart];
-        std::unordered_set<std::string> & local_nex_set = nexus_part[ipart];
-        std::unordered_set<std::string> local_node_set;
-        
-        std::merge(local_cat_set.begin(), local_cat_set.end(),
-                local_nex_set.begin(), local_nex_set.end(),
-                std::inserter(local_node_set, local_node_set.begin()));
-
-        geojson::GeoJSON local_catchment_collection = std::make_shared<geojson::FeatureCollection>(*global_nexus_collection, local_node_set);
-
-        // make a local network
-        Network local_network(local_catchment_collection, &link_key);
-        //NOTE: This doesn't include nexi in the network... if you check, this results in a difference of 1
-        // local nexus in roughly half the cases between nexus_part[i] and local_nexuses... this doesn't *seem*
-        // to have any practical effect on remote nexus determination, but it's still a mismatch.
-        
-        // test each nexus in the local network to make sure its upstream and downstream exist in the local network
-        auto local_cats = local_network.filter("cat");
-        auto local_nexuses = local_network.filter("nex");
+    std::vector<RemoteConnectionVec> remote_connections_vec(catchment_part.size());
+    std::vector<int> partition_remotes(catchment_part.size(), 0);
 
+    //Look partitions up by catchment id, rather than searching every partition for each connected catchment
+    const std::unordered_map<std::string, int> partition_of = index_partitions(catchment_part);
 
-        int remote_catchments = 0;
-
-        for ( const auto& n : local_nexuses )
+    //Partitions are independent, and the global network is only read, so find their remote connections in parallel
+    utils::ThreadPool pool(0);
+    pool.parallel_for(catchment_part.size(), [&](std::size_t ipart)
+    {
+        // test each nexus of the partition to make sure its upstream and downstream are in the partition
+        for ( const auto& n : nexus_part[ipart] )
         {
             //Find upstream connections
             auto orgin_ids = global_network.get_origination_ids(n);
             //Find downstream connections
             auto dest_ids = global_network.get_destination_ids(n);
-            remote_catchments += find_partition_connections(n, catchment_part, ipart, orgin_ids, dest_ids, remote_connections );
+            partition_remotes[ipart] += find_partition_connections(n, catchment_part, partition_of, ipart, orgin_ids, dest_ids, remote_connections_vec[ipart] );
         }
+    });
 
-        remote_connections_vec.push_back(remote_connections);
-        
-        //std::cout << "local network size: " << local_network.size() << "\n";
-        //std::cout << "global network size " << global_network.size() << "\n";
-        std::cout << "Found " << remote_catchments << " remotes in partition "<<ipart<<"\n";
-        total_remotes += remote_catchments;
+    //Unless already partitioned by node, number the partitions so those exchanging the most remote nexus flows are
+    //placed on the same node
+    if( ranks_per_node > 0 && ranks_per_node < catchment_part.size() ){
+        std::vector<std::pair<std::size_t, std::size_t>> links;
+        for (int ipart=0; ipart < catchment_part.size(); ++ipart)
+        {
+            for ( const auto& conn : remote_connections_vec[ipart] )
+            {
+                links.emplace_back(ipart, std::get<0>(conn));
+            }
+        }
+        auto count_between_nodes = [&links, ranks_per_node](const std::vector<int>& rank_of) {
+            std::size_t count = 0;
+            for ( const auto& link : links ) count += rank_of[link.first] / ranks_per_node != rank_of[link.second] / ranks_per_node;
+            return count;
+        };
+        std::vector<int> rank_of(catchment_part.size());
+        std::iota(rank_of.begin(), rank_of.end(), 0);
+        if( is_placed ){
+            std::cout << "With " << ranks_per_node << " partitions per node, " << count_between_nodes(rank_of)
+                      << " of " << links.size() << " remote connections are between nodes" << std::endl;
+        }
+        else{
+            std::size_t in_order_count = count_between_nodes(rank_of);
+            rank_of = network::MultilevelPartitioner::place_on_nodes(catchment_part.size(), links, ranks_per_node);
+            std::cout << "Placing " << ranks_per_node << " partitions per node leaves " << count_between_nodes(rank_of)
+                      << " of " << links.size() << " remote connections between nodes, rather than "
+                      << in_order_count << std::endl;
+
+            PartitionVSet placed_catchments(catchment_part.size()), placed_nexuses(nexus_part.size());
+            std::vector<RemoteConnectionVec> placed_connections(remote_connections_vec.size());
+            std::vector<int> placed_remotes(partition_remotes.size());
+            for (int ipart=0; ipart < catchment_part.size(); ++ipart)
+            {
+                placed_catchments[rank_of[ipart]] = std::move(catchment_part[ipart]);
+                placed_nexuses[rank_of[ipart]] = std::move(nexus_part[ipart]);
+                placed_remotes[rank_of[ipart]] = partition_remotes[ipart];
+                for ( auto& conn : remote_connections_vec[ipart] )
+                {
+                    std::get<0>(conn) = rank_of[std::get<0>(conn)];
+                }
+                placed_connections[rank_of[ipart]] = std::move(remote_connections_vec[ipart]);
+            }
+            catchment_part = std::move(placed_catchments);
+            nexus_part = std::move(placed_nexuses);
+            remote_connections_vec = std::move(placed_connections);
+            partition_remotes = std::move(placed_remotes);
+        }
     }
-    std::cout << "Found " << total_remotes << " total remotes (average of approximately " << (total_remotes/num_partitions) << " remotes per partition)" << std::endl;
 
-    write_remote_connections(catchment_part, nexus_part, remote_connections_vec, num_partitions, outFile);
+    int total_remotes = 0;
+    for (int ipart=0; ipart < catchment_part.size(); ++ipart)
+    {
+        std::cout << "Found " << partition_remotes[ipart] << " remotes in partition "<<ipart<<"\n";
+        total_remotes += partition_remotes[ipart];
+    }
+    std::cout << "Found " << total_remotes << " total remotes (average of approximately " << (total_remotes/num_partitions) << " remotes per partition)" << std::endl;
 
-    outFile.close();
+    //An output name ending in .bin selects the indexed binary format, from which each rank reads just its own partition
+    const std::string binary_suffix = ".bin";
+    if( partitionOutFile.size() > binary_suffix.size()
+        && partitionOutFile.compare(partitionOutFile.size() - binary_suffix.size(), binary_suffix.size(), binary_suffix) == 0 ){
+        partition_binary::write_partitions(catchment_part, nexus_part, remote_connections_vec, partitionOutFile);
+    }
+    else{
+        std::ofstream outFile;
+        outFile.open(partitionOutFile, std::ios::trunc);
+        write_remote_connections(catchment_part, nexus_part, remote_connections_vec, num_partitions, outFile);
+        outFile.close();
+    }
         
     return 0;
 }
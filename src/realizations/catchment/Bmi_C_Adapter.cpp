@@ -79,6 +79,7 @@ Bmi_C_Adapter::Bmi_C_Adapter(const string &type_name, std::string library_file_p
             // Make sure this is set to 'true' after this function call finishes
             model_initialized = true;
             acquire_time_conversion_factor(bmi_model_time_convert_factor);
+            snapshot_variable_metadata();
         }
         // Record the exception message before re-throwing to handle subsequent function calls properly
         catch( models::external::State_Exception& e)
@@ -210,6 +211,10 @@ void Bmi_C_Adapter::GetValueAtIndices(std::string name, void *dest, int *inds, i
 }
 
 int Bmi_C_Adapter::GetVarItemsize(std::string name) {
+    const Variable_Metadata *metadata = find_variable_metadata(name);
+    if (metadata != nullptr && metadata->has_itemsize) {
+        return metadata->itemsize;
+    }
     int size;
     int success = bmi_model->get_var_itemsize(bmi_model.get(), name.c_str(), &size);
     if (success != BMI_SUCCESS) {
@@ -219,6 +224,10 @@ int Bmi_C_Adapter::GetVarItemsize(std::string name) {
 }
 
 int Bmi_C_Adapter::GetVarNbytes(std::string name) {
+    const Variable_Metadata *metadata = find_variable_metadata(name);
+    if (metadata != nullptr && metadata->has_nbytes) {
+        return metadata->nbytes;
+    }
     int size;
     int success = bmi_model->get_var_nbytes(bmi_model.get(), name.c_str(), &size);
     if (success != BMI_SUCCESS) {
@@ -228,6 +237,10 @@ int Bmi_C_Adapter::GetVarNbytes(std::string name) {
 }
 
 std::string Bmi_C_Adapter::GetVarType(std::string name) {
+    const Variable_Metadata *metadata = find_variable_metadata(name);
+    if (metadata != nullptr && metadata->has_type) {
+        return metadata->type;
+    }
     char type_c_str[BMI_MAX_TYPE_NAME];
     int success = bmi_model->get_var_type(bmi_model.get(), name.c_str(), type_c_str);
     if (success != BMI_SUCCESS) {
@@ -237,6 +250,10 @@ std::string Bmi_C_Adapter::GetVarType(std::string name) {
 }
 
 std::string Bmi_C_Adapter::GetVarUnits(std::string name) {
+    const Variable_Metadata *metadata = find_variable_metadata(name);
+    if (metadata != nullptr && metadata->has_units) {
+        return metadata->units;
+    }
     char units_c_str[BMI_MAX_UNITS_NAME];
     int success = bmi_model->get_var_units(bmi_model.get(), name.c_str(), units_c_str);
     if (success != BMI_SUCCESS) {
@@ -255,6 +272,10 @@ std::string Bmi_C_Adapter::GetVarLocation(std::string name) {
 }
 
 int Bmi_C_Adapter::GetVarGrid(std::string name) {
+    const Variable_Metadata *metadata = find_variable_metadata(name);
+    if (metadata != nullptr && metadata->has_grid) {
+        return metadata->grid;
+    }
     int grid;
     int success = bmi_model->get_var_grid(bmi_model.get(), name.c_str(), &grid);
     if (success != BMI_SUCCESS) {
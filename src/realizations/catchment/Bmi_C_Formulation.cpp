@@ -16,14 +16,15 @@ std::string Bmi_C_Formulation::get_formulation_type() {
  * @return A shared pointer to a newly constructed model adapter object.
  */
 std::shared_ptr<Bmi_C_Adapter> Bmi_C_Formulation::construct_model(const geojson::PropertyMap& properties) {
-    auto library_file_iter = properties.find(BMI_REALIZATION_CFG_PARAM_OPT__LIB_FILE);
-    if (library_file_iter == properties.end()) {
-        throw std::runtime_error("BMI C formulation requires path to library file, but none provided in config");
-    }
-    std::string lib_file = library_file_iter->second.as_string();
     auto reg_func_itr = properties.find(BMI_REALIZATION_CFG_PARAM_OPT__REGISTRATION_FUNC);
     std::string reg_func =
             reg_func_itr == properties.end() ? BMI_C_DEFAULT_REGISTRATION_FUNC : reg_func_itr->second.as_string();
+    auto library_file_iter = properties.find(BMI_REALIZATION_CFG_PARAM_OPT__LIB_FILE);
+    // Modules linked into the executable have no library file to load
+    if (library_file_iter == properties.end() && find_static_bmi_c_module(reg_func) == nullptr) {
+        throw std::runtime_error("BMI C formulation requires path to library file, but none provided in config");
+    }
+    std::string lib_file = library_file_iter == properties.end() ? "" : library_file_iter->second.as_string();
     return std::make_shared<Bmi_C_Adapter>(
             Bmi_C_Adapter(
                     get_model_type_name(),
@@ -41,28 +42,24 @@ std::string Bmi_C_Formulation::get_output_header_line(std::string delimiter) {
 }
 
 std::string Bmi_C_Formulation::get_output_line_for_timestep(int timestep, std::string delimiter) {
+    std::vector<double> values;
+    get_output_values_for_timestep(timestep, values);
+    return format_output_values(values, delimiter);
+}
+
+bool Bmi_C_Formulation::get_output_values_for_timestep(int timestep, std::vector<double> &values) {
     // TODO: something must be added to store values if more than the current time step is wanted
     // TODO: if such a thing is added, it should probably be configurable to turn it off
     if (timestep != (next_time_step_index - 1)) {
         throw std::invalid_argument("Only current time step valid when getting output for BMI C formulation");
     }
 
-    // TODO: see Github issue 355: this design (and formulation output handling in general) needs to be reworked
-    // Clear anything currently in there
-    output_text_stream->str(std::string());
-
     const std::vector<std::string> &output_var_names = get_output_variable_names();
-    // This probably should never happen, but just to be safe ...
-    if (output_var_names.empty()) { return ""; }
-
-    // Do the first separately, without the leading comma
-    *output_text_stream << get_var_value_as_double(output_var_names[0]);
-
-    // Do the rest with a leading comma
-    for (int i = 1; i < output_var_names.size(); ++i) {
-        *output_text_stream << "," << get_var_value_as_double(output_var_names[i]);
+    values.resize(output_var_names.size());
+    for (std::size_t i = 0; i < output_var_names.size(); ++i) {
+        values[i] = get_var_value_as_double(output_var_names[i]);
     }
-    return output_text_stream->str();
+    return true;
 }
 
 /**
@@ -132,6 +129,7 @@ double Bmi_C_Formulation::get_response(time_step_t t_index, time_step_t t_delta)
             get_bmi_model()->Update();
         else
             get_bmi_model()->UpdateUntil(model_initial_time + t_delta_model_units);
+        mark_outputs_updated();
         // TODO: again, consider whether we should store any historic response, ts_delta, or other var values
         next_time_step_index++;
     }
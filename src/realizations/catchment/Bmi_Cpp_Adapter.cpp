@@ -89,7 +89,11 @@ Bmi_Cpp_Adapter::Bmi_Cpp_Adapter(Bmi_Cpp_Adapter &adapter) : model_name(adapter.
 Bmi_Cpp_Adapter::Bmi_Cpp_Adapter(Bmi_Cpp_Adapter &&adapter) noexcept : 
     AbstractCLibBmiAdapter<Cpp_Bmi>(std::move(adapter)),
     model_create_fname(std::move(adapter.model_create_fname)),
-    model_destroy_fname(std::move(adapter.model_destroy_fname)) { }
+    model_destroy_fname(std::move(adapter.model_destroy_fname)),
+    indexed_model(adapter.indexed_model)
+{
+    adapter.indexed_model = nullptr;
+}
 
 std::string Bmi_Cpp_Adapter::GetComponentName() {
     return bmi_model->GetComponentName();
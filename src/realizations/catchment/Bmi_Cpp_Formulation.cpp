@@ -1,4 +1,5 @@
 #include "Bmi_Cpp_Formulation.hpp"
+#include "NumberFormat.hpp"
 using namespace realization;
 using namespace models::bmi;
 
@@ -51,17 +52,30 @@ std::string Bmi_Cpp_Formulation::get_output_header_line(std::string delimiter) {
 }
 
 std::string Bmi_Cpp_Formulation::get_output_line_for_timestep(int timestep, std::string delimiter) {
+    std::vector<double> values;
+    get_output_values_for_timestep(timestep, values);
+    return format_output_values(values, delimiter);
+}
+
+bool Bmi_Cpp_Formulation::get_output_values_for_timestep(int timestep, std::vector<double> &values) {
     // TODO: something must be added to store values if more than the current time step is wanted
     // TODO: if such a thing is added, it should probably be configurable to turn it off
     if (timestep != (next_time_step_index - 1)) {
         throw std::invalid_argument("Only current time step valid when getting output for BMI C++ formulation");
     }
-    std::string output_str;
 
-    for (const std::string& name : get_output_variable_names()) {
-        output_str += (output_str.empty() ? "" : ",") + std::to_string(get_var_value_as_double(name));
+    const std::vector<std::string> &output_var_names = get_output_variable_names();
+    values.resize(output_var_names.size());
+    for (std::size_t i = 0; i < output_var_names.size(); ++i) {
+        values[i] = get_var_value_as_double(output_var_names[i]);
     }
-    return output_str;
+    return true;
+}
+
+Formulation::OutputFormat Bmi_Cpp_Formulation::get_output_format() const {
+    OutputFormat format;
+    format.precision = 6;
+    return format;
 }
 
 /**
@@ -131,6 +145,7 @@ double Bmi_Cpp_Formulation::get_response(time_step_t t_index, time_step_t t_delt
             get_bmi_model()->Update();
         else
             get_bmi_model()->UpdateUntil(model_initial_time + t_delta_model_units);
+        mark_outputs_updated();
         // TODO: again, consider whether we should store any historic response, ts_delta, or other var values
         next_time_step_index++;
     }
@@ -142,44 +157,37 @@ double Bmi_Cpp_Formulation::get_var_value_as_double(const std::string& var_name)
 }
 
 double Bmi_Cpp_Formulation::get_var_value_as_double(const int& index, const std::string& var_name) {
+    // Resolved once, so each read is only a pointer from the model, by handle where the model has them
+    const VarReader &reader = get_var_reader(var_name);
+    const void *values = get_model_values_ptr(reader.var_index, var_name);
+    if (reader.is_long_double)
+        return (double) static_cast<const long double *>(values)[index];
+    return read_value_as_double(reader.type, values, index);
+}
+
+const Bmi_Cpp_Formulation::VarReader &Bmi_Cpp_Formulation::get_var_reader(const std::string &var_name) {
+    auto found = var_readers.find(var_name);
+    if (found != var_readers.end()) {
+        return found->second;
+    }
     // TODO: consider different way of handling (and how to document) cases like long double or unsigned long long that
     //  don't fit or might convert inappropriately
+    VarReader reader;
     std::string type = get_bmi_model()->GetVarType(var_name);
-    if (type == "long double")
-        return (double) (get_bmi_model()->GetValuePtr<long double>(var_name))[index];
-
-    if (type == "double")
-        return (double) (get_bmi_model()->GetValuePtr<double>(var_name))[index];
-
-    if (type == "float")
-        return (double) (get_bmi_model()->GetValuePtr<float>(var_name))[index];
-
-    if (type == "short" || type == "short int" || type == "signed short" || type == "signed short int")
-        return (double) (get_bmi_model()->GetValuePtr<short>(var_name))[index];
-
-    if (type == "unsigned short" || type == "unsigned short int")
-        return (double) (get_bmi_model()->GetValuePtr<unsigned short>(var_name))[index];
-
-    if (type == "int" || type == "signed" || type == "signed int")
-        return (double) (get_bmi_model()->GetValuePtr<int>(var_name))[index];
-
-    if (type == "unsigned" || type == "unsigned int")
-        return (double) (get_bmi_model()->GetValuePtr<unsigned int>(var_name))[index];
-
-    if (type == "long" || type == "long int" || type == "signed long" || type == "signed long int")
-        return (double) (get_bmi_model()->GetValuePtr<long>(var_name))[index];
-
-    if (type == "unsigned long" || type == "unsigned long int")
-        return (double) (get_bmi_model()->GetValuePtr<unsigned long>(var_name))[index];
-
-    if (type == "long long" || type == "long long int" || type == "signed long long" || type == "signed long long int")
-        return (double) (get_bmi_model()->GetValuePtr<long long>(var_name))[index];
-
-    if (type == "unsigned long long" || type == "unsigned long long int")
-        return (double) (get_bmi_model()->GetValuePtr<unsigned long long>(var_name))[index];
-
-    throw std::runtime_error("Unable to get value of variable " + var_name + " from " + get_model_type_name() +
-                             " as double: no logic for converting variable type " + type);
+    if (type == "long double") {
+        reader.is_long_double = true;
+    }
+    else {
+        try {
+            reader.type = get_input_value_type(type);
+        }
+        catch (const std::runtime_error &e) {
+            throw std::runtime_error("Unable to get value of variable " + var_name + " from " + get_model_type_name() +
+                                     " as double: no logic for converting variable type " + type);
+        }
+    }
+    reader.var_index = get_bmi_model()->GetVarIndex(var_name);
+    return var_readers.emplace(var_name, reader).first->second;
 }
 
 bool Bmi_Cpp_Formulation::is_bmi_input_variable(const std::string &var_name) {
@@ -80,6 +80,10 @@ void Bmi_Fortran_Adapter::GetValueAtIndices(std::string name, void *dest, int *i
 }
 
 int Bmi_Fortran_Adapter::GetVarItemsize(std::string name) {
+    const Variable_Metadata *metadata = find_variable_metadata(name);
+    if (metadata != nullptr && metadata->has_itemsize) {
+        return metadata->itemsize;
+    }
     int size;
     if (get_var_itemsize(&bmi_model->handle, name.c_str(), &size) != BMI_SUCCESS) {
         throw std::runtime_error(model_name + " failed to get variable item size for " + name + ".");
@@ -88,6 +92,10 @@ int Bmi_Fortran_Adapter::GetVarItemsize(std::string name) {
 }
 
 int Bmi_Fortran_Adapter::GetVarNbytes(std::string name) {
+    const Variable_Metadata *metadata = find_variable_metadata(name);
+    if (metadata != nullptr && metadata->has_nbytes) {
+        return metadata->nbytes;
+    }
     int size;
     if (get_var_nbytes(&bmi_model->handle, name.c_str(), &size) != BMI_SUCCESS) {
         throw std::runtime_error(model_name + " failed to get variable array size (i.e., nbytes) for " + name + ".");
@@ -96,10 +104,18 @@ int Bmi_Fortran_Adapter::GetVarNbytes(std::string name) {
 }
 
 std::string Bmi_Fortran_Adapter::GetVarType(std::string name) {
+    const Variable_Metadata *metadata = find_variable_metadata(name);
+    if (metadata != nullptr && metadata->has_type) {
+        return metadata->type;
+    }
     return inner_get_var_type(name);
 }
 
 std::string Bmi_Fortran_Adapter::GetVarUnits(std::string name) {
+    const Variable_Metadata *metadata = find_variable_metadata(name);
+    if (metadata != nullptr && metadata->has_units) {
+        return metadata->units;
+    }
     char units_c_str[BMI_MAX_UNITS_NAME];
     if (get_var_units(&bmi_model->handle, name.c_str(), units_c_str) != BMI_SUCCESS) {
         throw std::runtime_error(model_name + " failed to get variable units for " + name + ".");
@@ -116,6 +132,10 @@ std::string Bmi_Fortran_Adapter::GetVarLocation(std::string name) {
 }
 
 int Bmi_Fortran_Adapter::GetVarGrid(std::string name) {
+    const Variable_Metadata *metadata = find_variable_metadata(name);
+    if (metadata != nullptr && metadata->has_grid) {
+        return metadata->grid;
+    }
     int grid;
     if (get_var_grid(&bmi_model->handle, name.c_str(), &grid) != BMI_SUCCESS) {
         throw std::runtime_error(model_name + " failed to get variable grid for " + name + ".");
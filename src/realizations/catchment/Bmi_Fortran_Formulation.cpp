@@ -50,68 +50,39 @@ double Bmi_Fortran_Formulation::get_var_value_as_double(const string &var_name)
 }
 
 double Bmi_Fortran_Formulation::get_var_value_as_double(const int &index, const string &var_name) {
-    // TODO: consider different way of handling (and how to document) cases like long double or unsigned long long that
-    //  don't fit or might convert inappropriately
-    std::string type = get_bmi_model()->GetVarType(var_name);
-    if (type == "long double")
-        return (double) (models::bmi::GetValue<long double>(*get_bmi_model(), var_name))[index];
-
-    if (type == "double" || type == "double precision")
-        return (double) (models::bmi::GetValue<double>(*get_bmi_model(), var_name))[index];
-
-    if (type == "float" || type == "real")
-        return (double) (models::bmi::GetValue<float>(*get_bmi_model(), var_name))[index];
-
-    if (type == "short" || type == "short int" || type == "signed short" || type == "signed short int")
-        return (double) (models::bmi::GetValue<short>(*get_bmi_model(), var_name))[index];
-
-    if (type == "unsigned short" || type == "unsigned short int")
-        return (double) (models::bmi::GetValue<unsigned short>(*get_bmi_model(), var_name))[index];
-
-    if (type == "int" || type == "signed" || type == "signed int" || type == "integer")
-        return (double) (models::bmi::GetValue<int>(*get_bmi_model(), var_name))[index];
-
-    if (type == "unsigned" || type == "unsigned int")
-        return (double) (models::bmi::GetValue<unsigned int>(*get_bmi_model(), var_name))[index];
-
-    if (type == "long" || type == "long int" || type == "signed long" || type == "signed long int")
-        return (double) (models::bmi::GetValue<long>(*get_bmi_model(), var_name))[index];
-
-    if (type == "unsigned long" || type == "unsigned long int")
-        return (double) (models::bmi::GetValue<unsigned long>(*get_bmi_model(), var_name))[index];
-
-    if (type == "long long" || type == "long long int" || type == "signed long long" || type == "signed long long int")
-        return (double) (models::bmi::GetValue<long long>(*get_bmi_model(), var_name))[index];
-
-    if (type == "unsigned long long" || type == "unsigned long long int")
-        return (double) (models::bmi::GetValue<unsigned long long>(*get_bmi_model(), var_name))[index];
+    // The module only has int, real and double precision getters, each of which the adapter converts from in bulk
+    std::vector<double> values;
+    get_var_values_as_double(var_name, values);
+    return values[index];
+}
 
-    throw std::runtime_error("Unable to get value of variable " + var_name + " from " + get_model_type_name() +
-    " as double: no logic for converting variable type " + type);
+void Bmi_Fortran_Formulation::get_var_values_as_double(const std::string &var_name, std::vector<double> &values) {
+    std::string bmi_var_name;
+    get_bmi_output_var_name(var_name, bmi_var_name);
+    const std::string &name = bmi_var_name.empty() ? var_name : bmi_var_name;
+    std::shared_ptr<Bmi_Fortran_Adapter> model = get_bmi_model();
+    int item_size = model->GetVarItemsize(name);
+    values.resize(item_size > 0 ? model->GetVarNbytes(name) / item_size : 0);
+    model->get_values_as(name, values.data(), values.size());
 }
 
 string Bmi_Fortran_Formulation::get_output_line_for_timestep(int timestep, std::string delimiter) {
+    std::vector<double> values;
+    get_output_values_for_timestep(timestep, values);
+    return format_output_values(values, delimiter);
+}
+
+bool Bmi_Fortran_Formulation::get_output_values_for_timestep(int timestep, std::vector<double> &values) {
     // TODO: something must be added to store values if more than the current time step is wanted
     // TODO: if such a thing is added, it should probably be configurable to turn it off
-
     // TODO: for now, just get current value, and ignore the timestep param
 
-    // TODO: see Github issue 355: this design (and formulation output handling in general) needs to be reworked
-    // Clear anything currently in there
-    output_text_stream->str(std::string());
-
     const std::vector<std::string> &output_var_names = get_output_variable_names();
-    // This probably should never happen, but just to be safe ...
-    if (output_var_names.empty()) { return ""; }
-
-    // Do the first separately, without the leading comma
-    *output_text_stream << get_var_value_as_double(output_var_names[0]);
-
-    // Do the rest with a leading comma
-    for (int i = 1; i < output_var_names.size(); ++i) {
-        *output_text_stream << "," << get_var_value_as_double(output_var_names[i]);
+    values.resize(output_var_names.size());
+    for (std::size_t i = 0; i < output_var_names.size(); ++i) {
+        values[i] = get_var_value_as_double(output_var_names[i]);
     }
-    return output_text_stream->str();
+    return true;
 }
 
 /**
@@ -181,6 +152,7 @@ double Bmi_Fortran_Formulation::get_response(time_step_t t_index, time_step_t t_
             get_bmi_model()->Update();
         else
             get_bmi_model()->UpdateUntil(model_initial_time + t_delta_model_units);
+        mark_outputs_updated();
         // TODO: again, consider whether we should store any historic response, ts_delta, or other var values
         next_time_step_index++;
     }
@@ -3,7 +3,10 @@
 #include "Bmi_Formulation.hpp"
 #include <iostream>
 #include "Bmi_Py_Formulation.hpp"
+#include "Bmi_Py_Worker_Formulation.hpp"
 #include <WrappedDataProvider.hpp>
+#include <ForcingFrameDataProvider.hpp>
+#include <Logger.hpp>
 
 using namespace realization;
 
@@ -15,7 +18,8 @@ void Bmi_Multi_Formulation::create_multi_formulation(geojson::PropertyMap proper
     set_bmi_main_output_var(properties.at(BMI_REALIZATION_CFG_PARAM_REQ__MAIN_OUT_VAR).as_string());
     set_model_type_name(properties.at(BMI_REALIZATION_CFG_PARAM_REQ__MODEL_TYPE).as_string());
 
-    std::shared_ptr<data_access::WrappedDataProvider> forcing_provider = std::make_shared<data_access::WrappedDataProvider>(forcing.get());
+    // The nested modules all take the catchment's forcing from its frame, so each value is fetched once each time step
+    std::shared_ptr<data_access::WrappedDataProvider> forcing_provider = std::make_shared<data_access::ForcingFrameDataProvider>(forcing.get());
     for (const std::string &forcing_name_or_alias : forcing->get_avaliable_variable_names()) {
         availableData[forcing_name_or_alias] = forcing_provider;
     }
@@ -68,7 +72,12 @@ void Bmi_Multi_Formulation::create_multi_formulation(geojson::PropertyMap proper
         }
         if (type_name == "bmi_python") {
             #ifdef ACTIVATE_PYTHON
-            module = init_nested_module<Bmi_Py_Formulation>(i, identifier, formulation_config.at("params").get_values());
+            if (models::bmi::Python_Worker_Pool::get_instance().is_enabled()) {
+                module = init_nested_module<Bmi_Py_Worker_Formulation>(i, identifier, formulation_config.at("params").get_values());
+            }
+            else {
+                module = init_nested_module<Bmi_Py_Formulation>(i, identifier, formulation_config.at("params").get_values());
+            }
             #else // ACTIVATE_PYTHON
             inactive_type_requested = true;
             #endif // ACTIVATE_PYTHON
@@ -123,8 +132,8 @@ void Bmi_Multi_Formulation::create_multi_formulation(geojson::PropertyMap proper
             set_output_header_fields(out_headers);
         }
         else {
-            std::cerr << "WARN: configured output headers have " << out_headers.size() << " fields, but there are "
-                      << get_output_variable_names().size() << " variables in the output" << std::endl;
+            NGEN_LOG_WARNING("configured output headers have " << out_headers.size() << " fields, but there are "
+                             << get_output_variable_names().size() << " variables in the output");
             set_output_header_fields(get_output_variable_names());
         }
     }
@@ -283,6 +292,12 @@ const string &Bmi_Multi_Formulation::get_forcing_file_path() const {
 }
 
 string Bmi_Multi_Formulation::get_output_line_for_timestep(int timestep, std::string delimiter) {
+    std::vector<double> values;
+    get_output_values_for_timestep(timestep, values);
+    return format_output_values(values, delimiter);
+}
+
+bool Bmi_Multi_Formulation::get_output_values_for_timestep(int timestep, std::vector<double> &values) {
     // TODO: have to do some figuring out to make sure this isn't ambiguous (i.e., same output var name from two modules)
     // TODO: need to verify that output variable names are valid, or else warn and return default
 
@@ -294,37 +309,32 @@ string Bmi_Multi_Formulation::get_output_line_for_timestep(int timestep, std::st
 
     // Start by first checking whether we are NOT just using the last module's values
     if (!is_out_vars_from_last_mod) {
-
-        // TODO: see Github issue 355: this design (and formulation output handling in general) needs to be reworked
-        // Clear anything currently in the multi formulation's stream buffer
-        output_text_stream->str(std::string());
-
         const std::vector<std::string> &output_var_names = get_output_variable_names();
-        // This almost certainly should never happen, but just to be safe ...
-        if (output_var_names.empty()) { return ""; }
-
         try {
-            // Do the first separately, without the leading comma
-            auto output_data_provider_iter = availableData.find(output_var_names[0]);
-            *output_text_stream << get_var_value_as_double(output_var_names[0]);
-
-            // Do the rest with a leading comma
-            for (int i = 1; i < output_var_names.size(); ++i) {
-                *output_text_stream << "," << get_var_value_as_double(output_var_names[i]);
+            values.resize(output_var_names.size());
+            for (std::size_t i = 0; i < output_var_names.size(); ++i) {
+                values[i] = get_var_value_as_double(output_var_names[i]);
             }
-            return output_text_stream->str();
+            return true;
         }
         catch (const std::exception &e) {
-            std::cerr << "WARN: " << e.what()
-                      << "; reverting to default behavior for multi-BMI formulation type (using last module)";
-            output_text_stream->str(std::string()); // ... clear any output contents being staged ...
-            is_out_vars_from_last_mod = true;          // ... revert to default behavior (just use last nested module)
+            NGEN_LOG_WARNING(e.what()
+                             << "; reverting to default behavior for multi-BMI formulation type (using last module)");
+            values.clear();                   // ... clear any output contents being staged ...
+            is_out_vars_from_last_mod = true; // ... revert to default behavior (just use last nested module)
         }
     }
     // Otherwise, use the default behavior, which means we either
     //   - were originally set to use the default of getting the output of the last module
     //   - tried a more complex config, but ran into an error, and are needing to revert to the default
-    return modules.back()->get_output_line_for_timestep(timestep, delimiter);
+    return modules.back()->get_output_values_for_timestep(timestep, values);
+}
+
+Formulation::OutputFormat Bmi_Multi_Formulation::get_output_format() const {
+    if (is_out_vars_from_last_mod) {
+        return modules.back()->get_output_format();
+    }
+    return Bmi_Formulation::get_output_format();
 }
 
 double Bmi_Multi_Formulation::get_response(time_step_t t_index, time_step_t t_delta) {
@@ -378,13 +388,13 @@ double Bmi_Multi_Formulation::get_response(time_step_t t_index, time_step_t t_de
     }
     // Find the right module for the main output, checking primary first
     int index = get_index_for_primary_module();
-    std::vector<std::string> out_var_names = modules[index]->get_output_variable_names();
+    const std::vector<std::string>* out_var_names = &modules[index]->get_output_variable_names();
     // If we don't find it there, look through the others
-    if (std::find(out_var_names.begin(), out_var_names.end(), get_bmi_main_output_var()) == out_var_names.end()) {
+    if (std::find(out_var_names->begin(), out_var_names->end(), get_bmi_main_output_var()) == out_var_names->end()) {
         for (int i = 0; i < modules.size(); ++i) {
             if (i == index) continue;
-            out_var_names = modules[i]->get_output_variable_names();
-            if (std::find(out_var_names.begin(), out_var_names.end(), get_bmi_main_output_var()) != out_var_names.end()) {
+            out_var_names = &modules[i]->get_output_variable_names();
+            if (std::find(out_var_names->begin(), out_var_names->end(), get_bmi_main_output_var()) != out_var_names->end()) {
                 index = i;
                 break;
             }
@@ -406,6 +416,9 @@ double Bmi_Multi_Formulation::get_response(time_step_t t_index, time_step_t t_de
     #endif // NGEN_BMI_FORTRAN_ACTIVE
     #ifdef ACTIVATE_PYTHON
     if (module_types[index] == "bmi_python") {
+        if (std::dynamic_pointer_cast<Bmi_Py_Worker_Formulation>(modules[index]) != nullptr) {
+            return get_module_var_value_as_double<Bmi_Py_Worker_Formulation>(get_bmi_main_output_var(), modules[index]);
+        }
         return get_module_var_value_as_double<Bmi_Py_Formulation>(get_bmi_main_output_var(), modules[index]);
     }
     #endif // ACTIVATE_PYTHON
@@ -432,8 +445,9 @@ bool Bmi_Multi_Formulation::is_bmi_using_forcing_file() const {
 }
 
 bool Bmi_Multi_Formulation::is_model_initialized() {
+    // Nested modules query this, through their forcing, while later modules are not yet created
     return std::all_of(modules.cbegin(), modules.cend(),
-                       [](const std::shared_ptr<Bmi_Formulation>& m) { return m->is_model_initialized(); });
+                       [](const std::shared_ptr<Bmi_Formulation>& m) { return m != nullptr && m->is_model_initialized(); });
 }
 
 /**
@@ -42,24 +42,29 @@ Bmi_Py_Adapter::Bmi_Py_Adapter(const string &type_name, string bmi_init_config,
 }
 
 string Bmi_Py_Adapter::GetComponentName() {
+    py::gil_scoped_acquire gil;
     return py::str(bmi_model->attr("get_component_name")());
 }
 
 double Bmi_Py_Adapter::GetCurrentTime() {
+    py::gil_scoped_acquire gil;
     // TODO: will need to verify the implicit casting for this works as expected
     return py::float_(bmi_model->attr("get_current_time")());
 }
 
 double Bmi_Py_Adapter::GetEndTime() {
+    py::gil_scoped_acquire gil;
     // TODO: will need to verify the implicit casting for this works as expected
     return py::float_(bmi_model->attr("get_end_time")());
 }
 
 int Bmi_Py_Adapter::GetInputItemCount() {
+    py::gil_scoped_acquire gil;
     return py::int_(bmi_model->attr("get_input_item_count")());
 }
 
 vector<string> Bmi_Py_Adapter::GetInputVarNames() {
+    py::gil_scoped_acquire gil;
     vector<string> in_var_names(GetInputItemCount());
     py::tuple in_var_names_tuple = bmi_model->attr("get_input_var_names")();
     int i = 0;
@@ -71,10 +76,12 @@ vector<string> Bmi_Py_Adapter::GetInputVarNames() {
 }
 
 int Bmi_Py_Adapter::GetOutputItemCount() {
+    py::gil_scoped_acquire gil;
     return py::int_(bmi_model->attr("get_output_item_count")());
 }
 
 vector<string> Bmi_Py_Adapter::GetOutputVarNames() {
+    py::gil_scoped_acquire gil;
     vector<string> out_var_names(GetOutputItemCount());
     py::tuple out_var_names_tuple = bmi_model->attr("get_output_var_names")();
     int i = 0;
@@ -86,22 +93,26 @@ vector<string> Bmi_Py_Adapter::GetOutputVarNames() {
 }
 
 double Bmi_Py_Adapter::GetStartTime() {
+    py::gil_scoped_acquire gil;
     // TODO: will need to verify the implicit casting for this works as expected
     return py::float_(bmi_model->attr("get_start_time")());
 }
 
 string Bmi_Py_Adapter::GetTimeUnits() {
+    py::gil_scoped_acquire gil;
     return py::str(bmi_model->attr("get_time_units")());
 }
 
 double Bmi_Py_Adapter::GetTimeStep() {
+    py::gil_scoped_acquire gil;
     return py::float_(bmi_model->attr("get_time_step")());
 }
 
 void Bmi_Py_Adapter::GetValue(string name, void *dest) {
+    py::gil_scoped_acquire gil;
     string cxx_type;
     try {
-        cxx_type = get_analogous_cxx_type(GetVarType(name), GetVarItemsize(name));
+        cxx_type = get_var_info(name).cxx_type;
     }
     catch (runtime_error &e) {
         string msg = "Encountered error getting C++ type during call to GetValue: \n";
@@ -130,38 +141,44 @@ void Bmi_Py_Adapter::GetValue(string name, void *dest) {
 }
 
 void Bmi_Py_Adapter::GetValueAtIndices(std::string name, void *dest, int *inds, int count) {
-    string val_type = GetVarType(name);
-    vector<string> in_v = GetInputVarNames();
+    py::gil_scoped_acquire gil;
     int var_total_items = GetVarNbytes(name) / GetVarItemsize(name);
     get_value_at_indices(name, dest, inds, count, count == var_total_items);
 }
 
 void *Bmi_Py_Adapter::GetValuePtr(std::string name) {
-    auto ptr_array = bmi_model->attr("get_value_ptr")(name);
+    py::gil_scoped_acquire gil;
+    auto ptr_array = py_get_value_ptr(get_var_info(name).py_name);
     return ((py::array)ptr_array).request().ptr;
 }
 
 int Bmi_Py_Adapter::GetVarGrid(std::string name) {
+    py::gil_scoped_acquire gil;
     return py::int_(bmi_model->attr("get_var_grid")(name));
 }
 
 int Bmi_Py_Adapter::GetVarItemsize(std::string name) {
-    return py::int_(bmi_model->attr("get_var_itemsize")(name));
+    py::gil_scoped_acquire gil;
+    return get_var_info(name).item_size;
 }
 
 string Bmi_Py_Adapter::GetVarLocation(std::string name) {
+    py::gil_scoped_acquire gil;
     return py::str(bmi_model->attr("get_var_location")(name));
 }
 
 int Bmi_Py_Adapter::GetVarNbytes(std::string name) {
-    return py::int_(bmi_model->attr("get_var_nbytes")(name));
+    py::gil_scoped_acquire gil;
+    return get_var_info(name).nbytes;
 }
 
 string Bmi_Py_Adapter::GetVarType(std::string name) {
-    return py::str(bmi_model->attr("get_var_type")(name));
+    py::gil_scoped_acquire gil;
+    return get_var_info(name).py_type;
 }
 
 string Bmi_Py_Adapter::GetVarUnits(std::string name) {
+    py::gil_scoped_acquire gil;
     return py::str(bmi_model->attr("get_var_units")(name));
 }
 
@@ -191,8 +208,10 @@ std::string Bmi_Py_Adapter::get_bmi_type_simple_name() const {
  * @see set_value_at_indices
  */
 void Bmi_Py_Adapter::SetValueAtIndices(std::string name, int *inds, int count, void *src) {
-    string val_type = GetVarType(name);
-    size_t val_item_size = (size_t)GetVarItemsize(name);
+    py::gil_scoped_acquire gil;
+    VarInfo &info = get_var_info(name);
+    const string &val_type = info.py_type;
+    size_t val_item_size = (size_t)info.item_size;
 
     // The available types and how they are handled here should match what is in get_value_at_indices
     if (val_type == "int" && val_item_size == sizeof(short)) {
@@ -220,11 +239,13 @@ void Bmi_Py_Adapter::SetValueAtIndices(std::string name, int *inds, int count, v
 }
 
 void Bmi_Py_Adapter::Update() {
-    bmi_model->attr("update")();
+    py::gil_scoped_acquire gil;
+    py_update();
 }
 
 void Bmi_Py_Adapter::UpdateUntil(double time) {
-    bmi_model->attr("update_until")(time);
+    py::gil_scoped_acquire gil;
+    py_update_until(time);
 }
 
 #endif //ACTIVATE_PYTHON
@@ -11,6 +11,8 @@ Bmi_Py_Formulation::Bmi_Py_Formulation(std::string id, std::shared_ptr<data_acce
 : Bmi_Module_Formulation<models::bmi::Bmi_Py_Adapter>(id, std::move(forcing), output_stream) { }
 
 shared_ptr<Bmi_Py_Adapter> Bmi_Py_Formulation::construct_model(const geojson::PropertyMap &properties) {
+    // Formulations may be constructed on several threads, and the model is initialized as the adapter is constructed
+    py::gil_scoped_acquire gil;
     auto python_type_name_iter = properties.find(BMI_REALIZATION_CFG_PARAM_OPT__PYTHON_TYPE_NAME);
     if (python_type_name_iter == properties.end()) {
         throw std::runtime_error("BMI Python formulation requires Python model class type, but none given in config");
@@ -49,31 +51,30 @@ std::string Bmi_Py_Formulation::get_formulation_type() {
 }
 
 string Bmi_Py_Formulation::get_output_line_for_timestep(int timestep, std::string delimiter) {
+    std::vector<double> values;
+    get_output_values_for_timestep(timestep, values);
+    return format_output_values(values, delimiter);
+}
+
+bool Bmi_Py_Formulation::get_output_values_for_timestep(int timestep, std::vector<double> &values) {
+    py::gil_scoped_acquire gil;
     // TODO: something must be added to store values if more than the current time step is wanted
     // TODO: if such a thing is added, it should probably be configurable to turn it off
     if (timestep != (next_time_step_index - 1)) {
         throw std::invalid_argument("Only current time step valid when getting output for BMI Python formulation");
     }
 
-    // TODO: see Github issue 355: this design (and formulation output handling in general) needs to be reworked
-    // Clear anything currently in there
-    output_text_stream->str(std::string());
-
     const std::vector<std::string> &output_var_names = get_output_variable_names();
-    // This probably should never happen, but just to be safe ...
-    if (output_var_names.empty()) { return ""; }
-
-    // Do the first separately, without the leading comma
-    *output_text_stream << get_var_value_as_double(output_var_names[0]);
-
-    // Do the rest with a leading comma
-    for (int i = 1; i < output_var_names.size(); ++i) {
-        *output_text_stream << "," << get_var_value_as_double(output_var_names[i]);
+    values.resize(output_var_names.size());
+    for (std::size_t i = 0; i < output_var_names.size(); ++i) {
+        values[i] = get_var_value_as_double(output_var_names[i]);
     }
-    return output_text_stream->str();
+    return true;
 }
 
 double Bmi_Py_Formulation::get_response(time_step_t t_index, time_step_t t_delta) {
+    // Hold the GIL for the whole sequence of setting inputs, updating and getting the response
+    py::gil_scoped_acquire gil;
     if (get_bmi_model() == nullptr) {
         throw std::runtime_error("Trying to process response of improperly created BMI Python formulation.");
     }
@@ -107,6 +108,7 @@ double Bmi_Py_Formulation::get_response(time_step_t t_index, time_step_t t_delta
             get_bmi_model()->Update();
         else
             get_bmi_model()->UpdateUntil(model_initial_time + t_delta_model_units);
+        mark_outputs_updated();
         // TODO: again, consider whether we should store any historic response, ts_delta, or other var values
         next_time_step_index++;
     }
@@ -118,8 +120,11 @@ double Bmi_Py_Formulation::get_var_value_as_double(const string &var_name) {
 }
 
 double Bmi_Py_Formulation::get_var_value_as_double(const int &index, const string &var_name) {
+    py::gil_scoped_acquire gil;
     string val_type = get_bmi_model()->GetVarType(var_name);
     size_t val_item_size = (size_t)get_bmi_model()->GetVarItemsize(var_name);
+    // A single valued variable is read with get_value, into an array kept for it, rather than get_value_at_indices
+    bool is_all_indices = index == 0 && get_bmi_model()->GetVarNbytes(var_name) == (int)val_item_size;
 
     //void *dest;
     int indices[1];
@@ -128,38 +133,38 @@ double Bmi_Py_Formulation::get_var_value_as_double(const int &index, const strin
     // The available types and how they are handled here should match what is in SetValueAtIndices
     if (val_type == "int" && val_item_size == sizeof(short)) {
         short dest;
-        get_bmi_model()->get_value_at_indices(var_name, &dest, indices, 1, false);
+        get_bmi_model()->get_value_at_indices(var_name, &dest, indices, 1, is_all_indices);
         return (double)dest;
     }
     if (val_type == "int" && val_item_size == sizeof(int)) {
         int dest;
-        get_bmi_model()->get_value_at_indices(var_name, &dest, indices, 1, false);
+        get_bmi_model()->get_value_at_indices(var_name, &dest, indices, 1, is_all_indices);
         return (double)dest;
     }
     if (val_type == "int" && val_item_size == sizeof(long)) {
         long dest;
-        get_bmi_model()->get_value_at_indices(var_name, &dest, indices, 1, false);
+        get_bmi_model()->get_value_at_indices(var_name, &dest, indices, 1, is_all_indices);
         return (double)dest;
     }
     if (val_type == "int" && val_item_size == sizeof(long long)) {
         long long dest;
-        get_bmi_model()->get_value_at_indices(var_name, &dest, indices, 1, false);
+        get_bmi_model()->get_value_at_indices(var_name, &dest, indices, 1, is_all_indices);
         return (double)dest;
     }
     if (val_type == "float" || val_type == "float16" || val_type == "float32" || val_type == "float64") {
         if (val_item_size == sizeof(float)) {
             float dest;
-            get_bmi_model()->get_value_at_indices(var_name, &dest, indices, 1, false);
+            get_bmi_model()->get_value_at_indices(var_name, &dest, indices, 1, is_all_indices);
             return (double) dest;
         }
         if (val_item_size == sizeof(double)) {
             double dest;
-            get_bmi_model()->get_value_at_indices(var_name, &dest, indices, 1, false);
+            get_bmi_model()->get_value_at_indices(var_name, &dest, indices, 1, is_all_indices);
             return dest;
         }
         if (val_item_size == sizeof(long double)) {
             long double dest;
-            get_bmi_model()->get_value_at_indices(var_name, &dest, indices, 1, false);
+            get_bmi_model()->get_value_at_indices(var_name, &dest, indices, 1, is_all_indices);
             return (double) dest;
         }
     }
@@ -0,0 +1,269 @@
+#ifdef ACTIVATE_PYTHON
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <utility>
+#include "Bmi_Py_Worker_Adapter.hpp"
+
+using namespace models::bmi;
+using namespace std;
+
+namespace {
+    /** Read a list of strings written as a count followed by each string. */
+    vector<string> read_strings(utils::StateReader &in) {
+        vector<string> values(in.read<uint64_t>());
+        for (string &value : values) {
+            value = in.read_string();
+        }
+        return values;
+    }
+}
+
+Bmi_Py_Worker_Adapter::Bmi_Py_Worker_Adapter(const string &type_name, string bmi_init_config,
+                                             const string &bmi_python_type, string python_module_path,
+                                             bool allow_exceed_end, bool has_fixed_time_step,
+                                             utils::StreamHandler output)
+        : Bmi_Adapter<Python_Worker>(type_name + " (BMI Py worker)", move(bmi_init_config), "", allow_exceed_end,
+                                     has_fixed_time_step, output),
+          bmi_python_type(bmi_python_type),
+          python_module_path(move(python_module_path))
+{
+    try {
+        construct_and_init_backing_model();
+        // Make sure this is set to 'true' after this function call finishes
+        model_initialized = true;
+        acquire_time_conversion_factor(bmi_model_time_convert_factor);
+    }
+    catch (std::exception &e) {
+        model_initialized = true;
+        init_exception_msg = e.what();
+        throw std::runtime_error(init_exception_msg);
+    }
+}
+
+Bmi_Py_Worker_Adapter::~Bmi_Py_Worker_Adapter() {
+    if (bmi_model == nullptr || handle < 0) {
+        return;
+    }
+    try {
+        bmi_model->send(command(Python_Worker_Command::DESTROY));
+    }
+    catch (const std::exception &e) {
+        // The worker has already gone, taking the model with it
+    }
+}
+
+void Bmi_Py_Worker_Adapter::construct_and_init_backing_model() {
+    if (model_initialized) {
+        return;
+    }
+    bmi_model = Python_Worker_Pool::get_instance().assign(handle);
+    utils::StateWriter create = command(Python_Worker_Command::CREATE);
+    create.write(model_name);
+    create.write(bmi_init_config);
+    create.write(bmi_python_type);
+    create.write(python_module_path);
+    create.write<uint8_t>(allow_model_exceed_end_time);
+    create.write<uint8_t>(bmi_model_has_fixed_time_step);
+    std::vector<char> reply = bmi_model->call(create);
+    utils::StateReader in(reply);
+    component_name = in.read_string();
+    input_var_names = std::make_shared<vector<string>>(read_strings(in));
+    output_var_names = std::make_shared<vector<string>>(read_strings(in));
+    time_units = in.read_string();
+    start_time = in.read<double>();
+    end_time = in.read<double>();
+    time_step = in.read<double>();
+    current_time = in.read<double>();
+    is_current_time_known = true;
+}
+
+utils::StateWriter Bmi_Py_Worker_Adapter::command(Python_Worker_Command command_type) const {
+    utils::StateWriter out;
+    out.write<int32_t>(static_cast<int32_t>(command_type));
+    out.write<int32_t>(handle);
+    return out;
+}
+
+const Bmi_Py_Worker_Adapter::Var_Info &Bmi_Py_Worker_Adapter::get_var_info(const string &name) {
+    auto it = var_info.find(name);
+    if (it != var_info.end()) {
+        return it->second;
+    }
+    utils::StateWriter query = command(Python_Worker_Command::GET_VAR_INFO);
+    query.write(name);
+    std::vector<char> reply = bmi_model->call(query);
+    utils::StateReader in(reply);
+    Var_Info info;
+    info.type = in.read_string();
+    info.units = in.read_string();
+    info.item_size = in.read<int32_t>();
+    info.nbytes = in.read<int32_t>();
+    info.has_location = in.read<uint8_t>() != 0;
+    info.location = in.read_string();
+    info.grid = in.read<int32_t>();
+    info.grid_error = in.read_string();
+    return var_info.emplace(name, std::move(info)).first->second;
+}
+
+void Bmi_Py_Worker_Adapter::fetch_outputs() {
+    if (are_output_values_current) {
+        return;
+    }
+    utils::StateWriter query = command(Python_Worker_Command::GET_OUTPUTS);
+    query.write<uint64_t>(output_var_names->size());
+    for (const string &name : *output_var_names) {
+        query.write(name);
+    }
+    std::vector<char> reply = bmi_model->call(query);
+    utils::StateReader in(reply);
+    current_time = in.read<double>();
+    is_current_time_known = true;
+    for (const string &name : *output_var_names) {
+        output_values[name] = in.read_vector<char>();
+    }
+    are_output_values_current = true;
+}
+
+void Bmi_Py_Worker_Adapter::model_changed(bool time_changed) {
+    are_output_values_current = false;
+    if (time_changed) {
+        is_current_time_known = false;
+    }
+}
+
+void Bmi_Py_Worker_Adapter::Finalize() {
+    bmi_model->send(command(Python_Worker_Command::FINALIZE));
+    model_changed(true);
+}
+
+double Bmi_Py_Worker_Adapter::GetCurrentTime() {
+    if (!is_current_time_known) {
+        std::vector<char> reply = bmi_model->call(command(Python_Worker_Command::GET_CURRENT_TIME));
+        utils::StateReader in(reply);
+        current_time = in.read<double>();
+        is_current_time_known = true;
+    }
+    return current_time;
+}
+
+void Bmi_Py_Worker_Adapter::GetValue(string name, void *dest) {
+    if (std::find(output_var_names->begin(), output_var_names->end(), name) != output_var_names->end()) {
+        fetch_outputs();
+        const std::vector<char> &values = output_values[name];
+        std::memcpy(dest, values.data(), values.size());
+        return;
+    }
+    utils::StateWriter query = command(Python_Worker_Command::GET_VALUE);
+    query.write(name);
+    std::vector<char> reply = bmi_model->call(query);
+    utils::StateReader in(reply);
+    std::vector<char> values = in.read_vector<char>();
+    std::memcpy(dest, values.data(), values.size());
+}
+
+void Bmi_Py_Worker_Adapter::GetValueAtIndices(string name, void *dest, int *inds, int count) {
+    if (count <= 0) {
+        return;
+    }
+    if (std::find(output_var_names->begin(), output_var_names->end(), name) != output_var_names->end()) {
+        fetch_outputs();
+        const std::vector<char> &values = output_values[name];
+        size_t item_size = (size_t) GetVarItemsize(name);
+        char *destination = static_cast<char *>(dest);
+        for (int i = 0; i < count; ++i) {
+            if (inds[i] < 0 || (inds[i] + 1) * item_size > values.size()) {
+                throw std::out_of_range("Index " + std::to_string(inds[i]) + " is out of range for variable " + name +
+                                        " of " + model_name);
+            }
+            std::memcpy(destination + i * item_size, values.data() + inds[i] * item_size, item_size);
+        }
+        return;
+    }
+    utils::StateWriter query = command(Python_Worker_Command::GET_VALUE_AT_INDICES);
+    query.write(name);
+    query.write(std::vector<int32_t>(inds, inds + count));
+    std::vector<char> reply = bmi_model->call(query);
+    utils::StateReader in(reply);
+    std::vector<char> values = in.read_vector<char>();
+    std::memcpy(dest, values.data(), values.size());
+}
+
+int Bmi_Py_Worker_Adapter::GetVarGrid(string name) {
+    const Var_Info &info = get_var_info(name);
+    if (!info.grid_error.empty()) {
+        throw runtime_error(info.grid_error);
+    }
+    return info.grid;
+}
+
+string Bmi_Py_Worker_Adapter::GetVarLocation(string name) {
+    const Var_Info &info = get_var_info(name);
+    if (!info.has_location) {
+        throw runtime_error(info.location);
+    }
+    return info.location;
+}
+
+void Bmi_Py_Worker_Adapter::SetValue(string name, void *src) {
+    utils::StateWriter queued = command(Python_Worker_Command::SET_VALUE);
+    queued.write(name);
+    int nbytes = GetVarNbytes(name);
+    queued.write<uint64_t>(nbytes);
+    queued.write_bytes(src, nbytes);
+    bmi_model->send(queued);
+    model_changed(false);
+}
+
+void Bmi_Py_Worker_Adapter::SetValueAtIndices(string name, int *inds, int count, void *src) {
+    utils::StateWriter queued = command(Python_Worker_Command::SET_VALUE_AT_INDICES);
+    queued.write(name);
+    queued.write(std::vector<int32_t>(inds, inds + count));
+    size_t nbytes = (size_t) count * GetVarItemsize(name);
+    queued.write<uint64_t>(nbytes);
+    queued.write_bytes(src, nbytes);
+    bmi_model->send(queued);
+    model_changed(false);
+}
+
+void Bmi_Py_Worker_Adapter::Update() {
+    bmi_model->send(command(Python_Worker_Command::UPDATE));
+    model_changed(true);
+}
+
+void Bmi_Py_Worker_Adapter::UpdateUntil(double time) {
+    utils::StateWriter queued = command(Python_Worker_Command::UPDATE_UNTIL);
+    queued.write<double>(time);
+    bmi_model->send(queued);
+    model_changed(true);
+}
+
+string Bmi_Py_Worker_Adapter::GetGridType(const int grid) {
+    utils::StateWriter query = command(Python_Worker_Command::GET_GRID_TYPE);
+    query.write<int32_t>(grid);
+    std::vector<char> reply = bmi_model->call(query);
+    utils::StateReader in(reply);
+    return in.read_string();
+}
+
+int Bmi_Py_Worker_Adapter::get_grid_int(Python_Worker_Grid_Int function, int grid) {
+    utils::StateWriter query = command(Python_Worker_Command::GET_GRID_INT);
+    query.write<int32_t>(static_cast<int32_t>(function));
+    query.write<int32_t>(grid);
+    std::vector<char> reply = bmi_model->call(query);
+    utils::StateReader in(reply);
+    return in.read<int32_t>();
+}
+
+void Bmi_Py_Worker_Adapter::get_grid_array(Python_Worker_Grid_Array function, int grid, void *dest) {
+    utils::StateWriter query = command(Python_Worker_Command::GET_GRID_ARRAY);
+    query.write<int32_t>(static_cast<int32_t>(function));
+    query.write<int32_t>(grid);
+    std::vector<char> reply = bmi_model->call(query);
+    utils::StateReader in(reply);
+    std::vector<char> values = in.read_vector<char>();
+    std::memcpy(dest, values.data(), values.size());
+}
+
+#endif //ACTIVATE_PYTHON
@@ -0,0 +1,151 @@
+#include "Init_Config_Template.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+
+#include <unistd.h>
+
+namespace realization {
+
+    namespace {
+        const std::string PLACEHOLDER_OPEN = "{{";
+        const std::string PLACEHOLDER_CLOSE = "}}";
+
+        bool is_writable_directory(const char *directory) {
+            return directory != nullptr && *directory != '\0' && access(directory, W_OK | X_OK) == 0;
+        }
+
+        /** The shortest of 15 to 17 significant digits that reads back as the same double. */
+        void append_number(std::string &out, double value) {
+            char buffer[32];
+            for (int digits = 15; digits <= 17; ++digits) {
+                std::snprintf(buffer, sizeof(buffer), "%.*g", digits, value);
+                if (std::strtod(buffer, nullptr) == value) {
+                    break;
+                }
+            }
+            out += buffer;
+        }
+
+        void append_value(std::string &out, const geojson::JSONProperty &value) {
+            switch (value.get_type()) {
+                case geojson::PropertyType::Natural:
+                    out += std::to_string(value.as_natural_number());
+                    break;
+                case geojson::PropertyType::Real:
+                    append_number(out, value.as_real_number());
+                    break;
+                case geojson::PropertyType::Boolean:
+                    out += value.as_boolean() ? "1" : "0";
+                    break;
+                case geojson::PropertyType::List: {
+                    bool first = true;
+                    for (const geojson::JSONProperty &element : value.as_list()) {
+                        if (!first) {
+                            out += ',';
+                        }
+                        append_value(out, element);
+                        first = false;
+                    }
+                    break;
+                }
+                default:
+                    out += value.as_string();
+            }
+        }
+    }
+
+    std::shared_ptr<const Init_Config_Template> Init_Config_Template::get_shared(const std::string &path) {
+        static std::mutex shared_templates_mutex;
+        static std::map<std::string, std::shared_ptr<const Init_Config_Template>> shared_templates;
+
+        const std::lock_guard<std::mutex> lock(shared_templates_mutex);
+        std::shared_ptr<const Init_Config_Template> &shared = shared_templates[path];
+        if (shared == nullptr) {
+            shared = std::make_shared<const Init_Config_Template>(path);
+        }
+        return shared;
+    }
+
+    std::string Init_Config_Template::default_directory() {
+        if (is_writable_directory("/dev/shm")) {
+            return "/dev/shm";
+        }
+        const char *tmpdir = std::getenv("TMPDIR");
+        return is_writable_directory(tmpdir) ? tmpdir : "/tmp";
+    }
+
+    Init_Config_Template::Init_Config_Template(const std::string &path) : path(path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            throw std::runtime_error("Cannot read BMI init config template '" + path + "'");
+        }
+        std::stringstream contents;
+        contents << file.rdbuf();
+        const std::string text = contents.str();
+
+        std::size_t begin = 0;
+        for (std::size_t open = text.find(PLACEHOLDER_OPEN); open != std::string::npos;
+             open = text.find(PLACEHOLDER_OPEN, begin)) {
+            const std::size_t close = text.find(PLACEHOLDER_CLOSE, open + PLACEHOLDER_OPEN.size());
+            if (close == std::string::npos) {
+                throw std::runtime_error("BMI init config template '" + path + "' has an unterminated placeholder");
+            }
+            const std::string name = text.substr(open + PLACEHOLDER_OPEN.size(),
+                                                 close - open - PLACEHOLDER_OPEN.size());
+            literals.push_back(text.substr(begin, open - begin));
+            placeholders.push_back(name);
+            if (name != "id" && std::find(parameter_names.begin(), parameter_names.end(), name) == parameter_names.end()) {
+                parameter_names.push_back(name);
+            }
+            begin = close + PLACEHOLDER_CLOSE.size();
+        }
+        literals.push_back(text.substr(begin));
+    }
+
+    std::string Init_Config_Template::render(const std::string &id, const geojson::PropertyMap &params) const {
+        std::string rendered = literals[0];
+        for (std::size_t i = 0; i < placeholders.size(); ++i) {
+            if (placeholders[i] == "id") {
+                rendered += id;
+            }
+            else {
+                auto value = params.find(placeholders[i]);
+                if (value == params.end()) {
+                    throw std::runtime_error("BMI init config template '" + path + "' has no value for {{"
+                                             + placeholders[i] + "}} for catchment " + id);
+                }
+                append_value(rendered, value->second);
+            }
+            rendered += literals[i + 1];
+        }
+        return rendered;
+    }
+
+    std::string Init_Config_Template::write_rendered(const std::string &directory, const std::string &id,
+                                                     const geojson::PropertyMap &params) const {
+        static std::atomic<unsigned long> count{0};
+
+        const std::string rendered = render(id, params);
+        const std::size_t slash = path.find_last_of('/');
+        const std::string file_path = directory + "/ngen-" + std::to_string(getpid()) + "-"
+                                      + std::to_string(count++) + "-"
+                                      + (slash == std::string::npos ? path : path.substr(slash + 1));
+        std::ofstream file(file_path, std::ios::binary | std::ios::trunc);
+        file << rendered;
+        file.close();
+        if (!file) {
+            std::remove(file_path.c_str());
+            throw std::runtime_error("Cannot write BMI init config '" + file_path + "' of catchment " + id);
+        }
+        return file_path;
+    }
+
+}
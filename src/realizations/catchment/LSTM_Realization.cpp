@@ -1,6 +1,7 @@
 #include "LSTM_Realization.hpp"
 #include "Catchment_Formulation.hpp"
 #include "CSV_Reader.h"
+#include "NumberFormat.hpp"
 
 #ifdef NGEN_LSTM_TORCH_LIB_ACTIVE
 
@@ -38,6 +39,20 @@ LSTM_Realization::LSTM_Realization(
  * @return The total discharge for this time step.
  */
 double LSTM_Realization::get_response(time_step_t t_index, time_step_t t_delta_s) {
+    if (batch) {
+        batch_flow = batch->get_flow(batch_member, t_index, t_delta_s);
+        return batch_flow;
+    }
+
+    double forcings[lstm::lstm_batch::NUM_FORCINGS];
+    read_forcings(t_index, t_delta_s, forcings);
+    int error = model->run(t_delta_s, forcings[0], forcings[1], forcings[2], forcings[3], forcings[4], forcings[5],
+                           forcings[6], forcings[7]);
+
+    return model->get_fluxes()->flow;
+}
+
+void LSTM_Realization::read_forcings(time_step_t t_index, time_step_t t_delta_s, double* forcings) {
 
     //Checking the time step used is consistent with that provided in forcing data
     time_t t_delta = this->forcing->record_duration();
@@ -56,18 +71,14 @@ double LSTM_Realization::get_response(time_step_t t_index, time_step_t t_delta_s
         throw std::invalid_argument("Getting response beyond time with available forcing.");
     }
 
-    int error = model->run(t_delta_s, 
-        this->forcing->get_value(CatchmentAggrDataSelector(this->catchment_id, CSDMS_STD_NAME_SOLAR_LONGWAVE, t_current, t_delta_s, ""), data_access::MEAN), 
-        this->forcing->get_value(CatchmentAggrDataSelector(this->catchment_id, CSDMS_STD_NAME_SURFACE_AIR_PRESSURE, t_current, t_delta_s, ""), data_access::MEAN), 
-        this->forcing->get_value(CatchmentAggrDataSelector(this->catchment_id, NGEN_STD_NAME_SPECIFIC_HUMIDITY, t_current, t_delta_s, ""), data_access::MEAN), 
-        this->forcing->get_value(CatchmentAggrDataSelector(this->catchment_id, CSDMS_STD_NAME_LIQUID_EQ_PRECIP_RATE, t_current, t_delta_s, ""), data_access::SUM),
-        this->forcing->get_value(CatchmentAggrDataSelector(this->catchment_id, CSDMS_STD_NAME_SOLAR_SHORTWAVE, t_current, t_delta_s, ""), data_access::MEAN), 
-        this->forcing->get_value(CatchmentAggrDataSelector(this->catchment_id, CSDMS_STD_NAME_SURFACE_TEMP, t_current, t_delta_s, ""), data_access::MEAN), 
-        this->forcing->get_value(CatchmentAggrDataSelector(this->catchment_id, CSDMS_STD_NAME_WIND_U_X, t_current, t_delta_s, ""), data_access::MEAN), 
-        this->forcing->get_value(CatchmentAggrDataSelector(this->catchment_id, CSDMS_STD_NAME_WIND_V_Y, t_current, t_delta_s, ""), data_access::MEAN)
-        );
-
-    return model->get_fluxes()->flow;
+    forcings[0] = this->forcing->get_value(CatchmentAggrDataSelector(this->catchment_id, CSDMS_STD_NAME_SOLAR_LONGWAVE, t_current, t_delta_s, ""), data_access::MEAN);
+    forcings[1] = this->forcing->get_value(CatchmentAggrDataSelector(this->catchment_id, CSDMS_STD_NAME_SURFACE_AIR_PRESSURE, t_current, t_delta_s, ""), data_access::MEAN);
+    forcings[2] = this->forcing->get_value(CatchmentAggrDataSelector(this->catchment_id, NGEN_STD_NAME_SPECIFIC_HUMIDITY, t_current, t_delta_s, ""), data_access::MEAN);
+    forcings[3] = this->forcing->get_value(CatchmentAggrDataSelector(this->catchment_id, CSDMS_STD_NAME_LIQUID_EQ_PRECIP_RATE, t_current, t_delta_s, ""), data_access::SUM);
+    forcings[4] = this->forcing->get_value(CatchmentAggrDataSelector(this->catchment_id, CSDMS_STD_NAME_SOLAR_SHORTWAVE, t_current, t_delta_s, ""), data_access::MEAN);
+    forcings[5] = this->forcing->get_value(CatchmentAggrDataSelector(this->catchment_id, CSDMS_STD_NAME_SURFACE_TEMP, t_current, t_delta_s, ""), data_access::MEAN);
+    forcings[6] = this->forcing->get_value(CatchmentAggrDataSelector(this->catchment_id, CSDMS_STD_NAME_WIND_U_X, t_current, t_delta_s, ""), data_access::MEAN);
+    forcings[7] = this->forcing->get_value(CatchmentAggrDataSelector(this->catchment_id, CSDMS_STD_NAME_WIND_V_Y, t_current, t_delta_s, ""), data_access::MEAN);
 }
 
 /** @TODO: Consider updating the below function to match the Tshirt realization and be able to return the
@@ -96,7 +107,7 @@ double LSTM_Realization::get_response(time_step_t t_index, time_step_t t_delta_s
  * @return A delimited string with all the output variable values for the given time step.
  */
 std::string LSTM_Realization::get_output_line_for_timestep(int timestep, std::string delimiter) {
-    return std::to_string(model->get_fluxes()->flow);
+    return utils::number_format::to_fixed(batch ? batch_flow : model->get_fluxes()->flow);
 }
 
 void LSTM_Realization::create_formulation(geojson::PropertyMap properties) {
@@ -117,9 +128,29 @@ void LSTM_Realization::create_formulation(geojson::PropertyMap properties) {
       properties.at("useGPU").as_boolean()
     };
 
+    if (properties.count("optimize_for_inference") == 1) {
+        config.optimize_for_inference = properties.at("optimize_for_inference").as_boolean();
+    }
+    if (properties.count("torch_threads") == 1) {
+        config.torch_threads = static_cast<int>(properties.at("torch_threads").as_natural_number());
+    }
+    if (properties.count("torch_interop_threads") == 1) {
+        config.torch_interop_threads = static_cast<int>(properties.at("torch_interop_threads").as_natural_number());
+    }
+
     this->params = lstm_params;
     this->config = config;
-    this->model = make_unique<lstm::lstm_model>(lstm::lstm_model(config, lstm_params));
+    //Batched catchments share one model, run once per time step for all of them
+    if (properties.count("batch") == 1 && properties.at("batch").as_boolean()) {
+        this->batch = lstm::lstm_batch::shared(config);
+        this->batch_member = this->batch->add_member(lstm_params, config.initial_state_path,
+            [this](long t_index, long t_delta_s, double* forcings) { read_forcings(t_index, t_delta_s, forcings); });
+        this->model.reset();
+    }
+    else {
+        this->batch.reset();
+        this->model = make_unique<lstm::lstm_model>(lstm::lstm_model(config, lstm_params));
+    }
 }
 
 void LSTM_Realization::create_formulation(boost::property_tree::ptree &config, geojson::PropertyMap *global) {
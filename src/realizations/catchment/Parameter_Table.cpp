@@ -0,0 +1,176 @@
+#include "Parameter_Table.hpp"
+
+#include <MappedCsvReader.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+#ifdef NETCDF_ACTIVE
+#include <netcdf>
+#endif
+
+namespace realization {
+
+    namespace {
+        bool has_extension(const std::string &path, const std::string &extension) {
+            return path.size() >= extension.size()
+                   && std::equal(extension.rbegin(), extension.rend(), path.rbegin(),
+                                 [](char e, char c) { return e == std::tolower(static_cast<unsigned char>(c)); });
+        }
+    }
+
+    std::shared_ptr<const Parameter_Table> Parameter_Table::get_shared(const std::string &path,
+                                                                       const std::string &id_column,
+                                                                       const std::vector<std::string> &columns) {
+        static std::mutex shared_tables_mutex;
+        static std::map<std::pair<std::string, std::string>, std::shared_ptr<const Parameter_Table>> shared_tables;
+
+        const std::lock_guard<std::mutex> lock(shared_tables_mutex);
+        std::shared_ptr<const Parameter_Table> &table = shared_tables[std::make_pair(path, id_column)];
+        std::vector<std::string> needed;
+        if (table != nullptr) {
+            needed = table->column_names;
+        }
+        bool is_missing_columns = table == nullptr;
+        for (const std::string &column : columns) {
+            if (std::find(needed.begin(), needed.end(), column) == needed.end()) {
+                needed.push_back(column);
+                is_missing_columns = true;
+            }
+        }
+        if (is_missing_columns) {
+            table = std::make_shared<const Parameter_Table>(path, id_column, std::move(needed));
+        }
+        return table;
+    }
+
+    Parameter_Table::Parameter_Table(const std::string &path, const std::string &id_column,
+                                     std::vector<std::string> columns)
+            : path(path), column_names(std::move(columns)), columns(column_names.size()) {
+        if (has_extension(path, ".csv")) {
+            read_csv(id_column);
+        }
+#ifdef NETCDF_ACTIVE
+        else if (has_extension(path, ".nc")) {
+            read_netcdf(id_column);
+        }
+#endif
+#ifdef NGEN_PARQUET_ACTIVE
+        else if (has_extension(path, ".parquet")) {
+            read_parquet(id_column);
+        }
+#endif
+        else {
+            throw std::runtime_error("Parameter table " + path + " is not of a format supported by this build");
+        }
+    }
+
+    void Parameter_Table::add_row(const std::string &id) {
+        if (!row_indexes.emplace(id, row_indexes.size()).second) {
+            throw std::runtime_error("Parameter table " + path + " has more than one row for catchment " + id);
+        }
+    }
+
+    void Parameter_Table::read_csv(const std::string &id_column) {
+        utils::MappedCsvReader reader(path);
+        std::vector<utils::MappedCsvReader::Field> row;
+        if (!reader.next_row(row)) {
+            throw std::runtime_error("Parameter table " + path + " has no header row");
+        }
+
+        long id_field = -1;
+        std::vector<long> fields(column_names.size(), -1);
+        for (std::size_t f = 0; f < row.size(); ++f) {
+            if (row[f] == id_column.c_str()) {
+                id_field = static_cast<long>(f);
+            }
+            for (std::size_t c = 0; c < column_names.size(); ++c) {
+                if (row[f] == column_names[c].c_str()) {
+                    fields[c] = static_cast<long>(f);
+                }
+            }
+        }
+        if (id_field < 0) {
+            throw std::runtime_error("Parameter table " + path + " has no id column " + id_column);
+        }
+        for (std::size_t c = 0; c < column_names.size(); ++c) {
+            if (fields[c] < 0) {
+                throw std::runtime_error("Parameter table " + path + " has no column " + column_names[c]);
+            }
+        }
+
+        const double missing = std::numeric_limits<double>::quiet_NaN();
+        while (reader.next_row(row)) {
+            if (row.size() <= static_cast<std::size_t>(id_field)) {
+                throw std::runtime_error("Parameter table " + path + " has a row without an id");
+            }
+            const std::string id = row[id_field].str();
+            add_row(id);
+            for (std::size_t c = 0; c < column_names.size(); ++c) {
+                const std::size_t f = static_cast<std::size_t>(fields[c]);
+                if (f >= row.size() || row[f].begin == row[f].end) {
+                    columns[c].push_back(missing);
+                    continue;
+                }
+                try {
+                    columns[c].push_back(utils::MappedCsvReader::parse_double(row[f]));
+                }
+                catch (const std::invalid_argument &) {
+                    throw std::runtime_error("Parameter table " + path + " has a value of " + column_names[c]
+                                             + " for catchment " + id + " that is not a number: " + row[f].str());
+                }
+            }
+        }
+    }
+
+#ifdef NETCDF_ACTIVE
+    void Parameter_Table::read_netcdf(const std::string &id_column) {
+        netCDF::NcFile nc_file(path, netCDF::NcFile::read);
+
+        netCDF::NcVar ids = nc_file.getVar(id_column);
+        if (ids.isNull() || ids.getDimCount() != 1) {
+            throw std::runtime_error("Parameter table " + path + " has no one dimensional id variable " + id_column);
+        }
+        const std::size_t num_ids = ids.getDim(0).getSize();
+        std::vector<char *> id_strings(num_ids);
+        if (num_ids > 0) {
+            ids.getVar(id_strings.data());
+        }
+        for (char *id : id_strings) {
+            add_row(id);
+        }
+        if (num_ids > 0) {
+            ids.freeString(num_ids, id_strings.data());
+        }
+
+        for (std::size_t c = 0; c < column_names.size(); ++c) {
+            netCDF::NcVar var = nc_file.getVar(column_names[c]);
+            if (var.isNull() || var.getDimCount() != 1 || var.getDim(0) != ids.getDim(0)) {
+                throw std::runtime_error("Parameter table " + path + " has no variable " + column_names[c]
+                                         + " along the dimension of " + id_column);
+            }
+            columns[c].resize(num_ids);
+            if (num_ids > 0) {
+                var.getVar(columns[c].data());
+            }
+            netCDF::NcVarAtt fill_att;
+            try {
+                fill_att = var.getAtt("_FillValue");
+            }
+            catch (const netCDF::exceptions::NcException &) {
+                continue;
+            }
+            double fill_value;
+            fill_att.getValues(&fill_value);
+            std::replace(columns[c].begin(), columns[c].end(), fill_value,
+                         std::numeric_limits<double>::quiet_NaN());
+        }
+    }
+#endif
+
+}
@@ -0,0 +1,125 @@
+#ifdef NGEN_PARQUET_ACTIVE
+#include "Parameter_Table.hpp"
+
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include <arrow/api.h>
+#include <arrow/io/file.h>
+#include <parquet/arrow/reader.h>
+
+namespace realization {
+
+    namespace {
+        void check(const arrow::Status &status, const std::string &path) {
+            if (!status.ok()) {
+                throw std::runtime_error("Parameter table " + path + " could not be read: " + status.ToString());
+            }
+        }
+
+        template<typename T>
+        T check(arrow::Result<T> result, const std::string &path) {
+            check(result.status(), path);
+            return std::move(result).ValueOrDie();
+        }
+
+        template<typename ArrayType>
+        bool append_numbers(const arrow::Array &chunk, std::vector<double> &values) {
+            const auto *numbers = dynamic_cast<const ArrayType *>(&chunk);
+            if (numbers == nullptr) {
+                return false;
+            }
+            for (int64_t i = 0; i < numbers->length(); ++i) {
+                values.push_back(numbers->IsNull(i) ? std::numeric_limits<double>::quiet_NaN()
+                                                    : static_cast<double>(numbers->Value(i)));
+            }
+            return true;
+        }
+
+        template<typename ArrayType>
+        bool append_ids(const arrow::Array &chunk, std::vector<std::string> &ids) {
+            const auto *id_array = dynamic_cast<const ArrayType *>(&chunk);
+            if (id_array == nullptr) {
+                return false;
+            }
+            for (int64_t i = 0; i < id_array->length(); ++i) {
+                if (id_array->IsNull(i)) {
+                    return false;
+                }
+                ids.push_back(id_array->GetString(i));
+            }
+            return true;
+        }
+
+        template<typename ArrayType>
+        bool append_integer_ids(const arrow::Array &chunk, std::vector<std::string> &ids) {
+            const auto *id_array = dynamic_cast<const ArrayType *>(&chunk);
+            if (id_array == nullptr) {
+                return false;
+            }
+            for (int64_t i = 0; i < id_array->length(); ++i) {
+                if (id_array->IsNull(i)) {
+                    return false;
+                }
+                ids.push_back(std::to_string(id_array->Value(i)));
+            }
+            return true;
+        }
+    }
+
+    void Parameter_Table::read_parquet(const std::string &id_column) {
+        std::shared_ptr<arrow::io::ReadableFile> file = check(arrow::io::ReadableFile::Open(path), path);
+        std::unique_ptr<parquet::arrow::FileReader> reader;
+        check(parquet::arrow::OpenFile(file, arrow::default_memory_pool(), &reader), path);
+        std::shared_ptr<arrow::Schema> schema;
+        check(reader->GetSchema(&schema), path);
+
+        // Only the id column and those asked for are read, as attribute tables may have hundreds of columns
+        const int id_index = schema->GetFieldIndex(id_column);
+        if (id_index < 0) {
+            throw std::runtime_error("Parameter table " + path + " has no id column " + id_column);
+        }
+        std::vector<int> indexes{id_index};
+        for (const std::string &name : column_names) {
+            const int index = schema->GetFieldIndex(name);
+            if (index < 0) {
+                throw std::runtime_error("Parameter table " + path + " has no column " + name);
+            }
+            indexes.push_back(index);
+        }
+        std::shared_ptr<arrow::Table> table;
+        check(reader->ReadTable(indexes, &table), path);
+
+        std::vector<std::string> ids;
+        for (const std::shared_ptr<arrow::Array> &chunk : table->column(0)->chunks()) {
+            if (!append_ids<arrow::StringArray>(*chunk, ids) && !append_ids<arrow::LargeStringArray>(*chunk, ids)
+                && !append_integer_ids<arrow::Int64Array>(*chunk, ids)
+                && !append_integer_ids<arrow::Int32Array>(*chunk, ids)) {
+                throw std::runtime_error("Parameter table " + path + " has an id column " + id_column
+                                         + " that is not of non-null strings or integers");
+            }
+        }
+        for (const std::string &id : ids) {
+            add_row(id);
+        }
+
+        for (std::size_t c = 0; c < column_names.size(); ++c) {
+            columns[c].reserve(ids.size());
+            for (const std::shared_ptr<arrow::Array> &chunk : table->column(static_cast<int>(c + 1))->chunks()) {
+                if (!append_numbers<arrow::DoubleArray>(*chunk, columns[c])
+                    && !append_numbers<arrow::FloatArray>(*chunk, columns[c])
+                    && !append_numbers<arrow::Int64Array>(*chunk, columns[c])
+                    && !append_numbers<arrow::Int32Array>(*chunk, columns[c])
+                    && !append_numbers<arrow::Int16Array>(*chunk, columns[c])
+                    && !append_numbers<arrow::Int8Array>(*chunk, columns[c])) {
+                    throw std::runtime_error("Parameter table " + path + " has a column " + column_names[c]
+                                             + " that is not numeric");
+                }
+            }
+        }
+    }
+
+}
+
+#endif // NGEN_PARQUET_ACTIVE
@@ -0,0 +1,160 @@
+#ifdef ACTIVATE_PYTHON
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "Python_Worker_Pool.hpp"
+
+extern char **environ;
+
+using namespace models::bmi;
+
+namespace {
+    /** The descriptor workers are given their shared memory at, unless that is the descriptor it already has. */
+    const int WORKER_SHARED_MEMORY_FD = 3;
+}
+
+Python_Worker::Python_Worker(const std::string &executable, std::size_t ring_bytes) {
+    // Each ring's data starts on a cache line of its own
+    std::size_t capacity = (ring_bytes + 63) / 64 * 64;
+    std::size_t ring_region_bytes = utils::SharedMemoryRing::region_bytes(capacity);
+    region.reset(new utils::SharedMemoryRegion(2 * ring_region_bytes));
+    char *memory = static_cast<char *>(region->data());
+    utils::SharedMemoryRing::create(memory, capacity);
+    utils::SharedMemoryRing::create(memory + ring_region_bytes, capacity);
+    commands.reset(new utils::SharedMemoryRing(memory, [this]() { return is_running(); }));
+    replies.reset(new utils::SharedMemoryRing(memory + ring_region_bytes, [this]() { return is_running(); }));
+
+    int worker_fd = region->get_fd() == WORKER_SHARED_MEMORY_FD ? WORKER_SHARED_MEMORY_FD + 1 : WORKER_SHARED_MEMORY_FD;
+    std::string fd_arg = std::to_string(worker_fd);
+    std::string bytes_arg = std::to_string(region->size());
+    std::string option_arg = PYTHON_BMI_WORKER_CLI_OPTION;
+    std::vector<char *> argv = {const_cast<char *>(executable.c_str()), &option_arg[0], &fd_arg[0], &bytes_arg[0],
+                                nullptr};
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, region->get_fd(), worker_fd);
+    int result = posix_spawn(&pid, executable.c_str(), &actions, nullptr, argv.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    if (result != 0) {
+        throw std::runtime_error("Unable to start a Python BMI worker from " + executable + ": " + std::strerror(result));
+    }
+}
+
+Python_Worker::~Python_Worker() {
+    try {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!exited) {
+            utils::StateWriter shutdown;
+            shutdown.write<int32_t>(static_cast<int32_t>(Python_Worker_Command::SHUTDOWN));
+            write_message(shutdown.get_bytes());
+        }
+    }
+    catch (const std::exception &e) {
+        // The worker has already exited
+    }
+    if (!exited) {
+        waitpid(pid, nullptr, 0);
+    }
+}
+
+int32_t Python_Worker::new_model_handle() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return next_handle++;
+}
+
+std::size_t Python_Worker::get_model_count() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return (std::size_t) next_handle;
+}
+
+bool Python_Worker::is_running() {
+    if (!exited && waitpid(pid, nullptr, WNOHANG) != 0) {
+        exited = true;
+    }
+    return !exited;
+}
+
+void Python_Worker::write_message(const std::vector<char> &bytes) {
+    uint64_t length = bytes.size();
+    commands->write(&length, sizeof(length));
+    commands->write(bytes.data(), bytes.size());
+}
+
+void Python_Worker::send(const utils::StateWriter &command) {
+    std::lock_guard<std::mutex> lock(mutex);
+    try {
+        write_message(command.get_bytes());
+    }
+    catch (const std::runtime_error &e) {
+        throw std::runtime_error("Python BMI worker " + std::to_string(pid) + " exited before taking a command: "
+                                 + e.what());
+    }
+}
+
+std::vector<char> Python_Worker::call(const utils::StateWriter &command) {
+    std::vector<char> reply;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        try {
+            write_message(command.get_bytes());
+            uint64_t length;
+            replies->read(&length, sizeof(length));
+            reply.resize(length);
+            replies->read(reply.data(), reply.size());
+        }
+        catch (const std::runtime_error &e) {
+            throw std::runtime_error("Python BMI worker " + std::to_string(pid) + " exited before replying: "
+                                     + e.what());
+        }
+    }
+    utils::StateReader in(reply);
+    int32_t status = in.read<int32_t>();
+    if (status != 0) {
+        throw std::runtime_error(in.read_string());
+    }
+    return std::vector<char>(reply.begin() + sizeof(status), reply.end());
+}
+
+Python_Worker_Pool &Python_Worker_Pool::get_instance() {
+    static Python_Worker_Pool instance;
+    return instance;
+}
+
+std::shared_ptr<Python_Worker> Python_Worker_Pool::assign(int32_t &handle) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (size == 0) {
+        throw std::runtime_error("Python BMI models can only be assigned to workers when python_workers is set.");
+    }
+    std::shared_ptr<Python_Worker> worker;
+    if (workers.size() < size) {
+        // Workers run the ngen executable itself, in its worker mode
+        char executable[PATH_MAX];
+        ssize_t length = readlink("/proc/self/exe", executable, sizeof(executable) - 1);
+        if (length < 0) {
+            throw std::runtime_error(std::string("Unable to find the ngen executable to start a Python BMI worker: ")
+                                     + std::strerror(errno));
+        }
+        executable[length] = '\0';
+        worker = std::make_shared<Python_Worker>(executable);
+        workers.push_back(worker);
+    }
+    else {
+        worker = *std::min_element(workers.begin(), workers.end(),
+                                   [](const std::shared_ptr<Python_Worker> &a, const std::shared_ptr<Python_Worker> &b) {
+                                       return a->get_model_count() < b->get_model_count();
+                                   });
+    }
+    handle = worker->new_model_handle();
+    return worker;
+}
+
+#endif //ACTIVATE_PYTHON
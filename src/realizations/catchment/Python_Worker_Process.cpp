@@ -0,0 +1,334 @@
+#ifdef ACTIVATE_PYTHON
+
+#include <iostream>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <csignal>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif
+
+#include "Bmi_Py_Adapter.hpp"
+#include "Python_Worker_Pool.hpp"
+#include "python/InterpreterUtil.hpp"
+
+using namespace models::bmi;
+
+namespace {
+
+    /**
+     * The models of a Python BMI worker, and the commands run on them.
+     */
+    class Python_Worker_Host {
+
+    public:
+
+        /**
+         * Run a command for a model, writing its results to @p out.
+         *
+         * @throws std::exception If the command fails.
+         */
+        void run(Python_Worker_Command command, int32_t handle, utils::StateReader &in, utils::StateWriter &out) {
+            switch (command) {
+                case Python_Worker_Command::CREATE:
+                    create(handle, in, out);
+                    return;
+                case Python_Worker_Command::DESTROY:
+                    models.erase(handle);
+                    return;
+                case Python_Worker_Command::SET_VALUE: {
+                    std::string name = in.read_string();
+                    std::vector<char> values = in.read_vector<char>();
+                    model(handle).SetValue(name, values.data());
+                    return;
+                }
+                case Python_Worker_Command::SET_VALUE_AT_INDICES: {
+                    std::string name = in.read_string();
+                    std::vector<int32_t> indices = in.read_vector<int32_t>();
+                    std::vector<char> values = in.read_vector<char>();
+                    model(handle).SetValueAtIndices(name, indices.data(), (int) indices.size(), values.data());
+                    return;
+                }
+                case Python_Worker_Command::UPDATE:
+                    model(handle).Update();
+                    return;
+                case Python_Worker_Command::UPDATE_UNTIL:
+                    model(handle).UpdateUntil(in.read<double>());
+                    return;
+                case Python_Worker_Command::FINALIZE:
+                    model(handle).Finalize();
+                    return;
+                case Python_Worker_Command::GET_OUTPUTS: {
+                    Bmi_Py_Adapter &adapter = model(handle);
+                    out.write<double>(adapter.GetCurrentTime());
+                    uint64_t count = in.read<uint64_t>();
+                    for (uint64_t i = 0; i < count; ++i) {
+                        write_value(adapter, in.read_string(), out);
+                    }
+                    return;
+                }
+                case Python_Worker_Command::GET_VALUE:
+                    write_value(model(handle), in.read_string(), out);
+                    return;
+                case Python_Worker_Command::GET_VALUE_AT_INDICES: {
+                    Bmi_Py_Adapter &adapter = model(handle);
+                    std::string name = in.read_string();
+                    std::vector<int32_t> indices = in.read_vector<int32_t>();
+                    std::vector<char> values(indices.size() * adapter.GetVarItemsize(name));
+                    adapter.GetValueAtIndices(name, values.data(), indices.data(), (int) indices.size());
+                    out.write(values);
+                    return;
+                }
+                case Python_Worker_Command::GET_VAR_INFO:
+                    write_var_info(model(handle), in.read_string(), out);
+                    return;
+                case Python_Worker_Command::GET_CURRENT_TIME:
+                    out.write<double>(model(handle).GetCurrentTime());
+                    return;
+                case Python_Worker_Command::GET_GRID_INT: {
+                    auto function = static_cast<Python_Worker_Grid_Int>(in.read<int32_t>());
+                    out.write<int32_t>(get_grid_int(model(handle), function, in.read<int32_t>()));
+                    return;
+                }
+                case Python_Worker_Command::GET_GRID_TYPE:
+                    out.write(model(handle).GetGridType(in.read<int32_t>()));
+                    return;
+                case Python_Worker_Command::GET_GRID_ARRAY: {
+                    auto function = static_cast<Python_Worker_Grid_Array>(in.read<int32_t>());
+                    out.write(get_grid_array(model(handle), function, in.read<int32_t>()));
+                    return;
+                }
+                default:
+                    throw std::invalid_argument("Unknown Python BMI worker command " +
+                                                std::to_string(static_cast<int32_t>(command)));
+            }
+        }
+
+    private:
+
+        Bmi_Py_Adapter &model(int32_t handle) {
+            auto it = models.find(handle);
+            if (it == models.end()) {
+                throw std::invalid_argument("No Python BMI model " + std::to_string(handle) + " in this worker");
+            }
+            return *it->second;
+        }
+
+        void create(int32_t handle, utils::StateReader &in, utils::StateWriter &out) {
+            std::string type_name = in.read_string();
+            std::string init_config = in.read_string();
+            std::string python_type = in.read_string();
+            std::string module_path = in.read_string();
+            bool allow_exceed_end = in.read<uint8_t>() != 0;
+            bool has_fixed_time_step = in.read<uint8_t>() != 0;
+            if (!module_path.empty()) {
+                utils::ngenPy::InterpreterUtil::addToPyPath(module_path);
+            }
+            std::unique_ptr<Bmi_Py_Adapter> adapter(new Bmi_Py_Adapter(type_name, init_config, python_type,
+                                                                        allow_exceed_end, has_fixed_time_step,
+                                                                        utils::StreamHandler()));
+            out.write(adapter->GetComponentName());
+            write_strings(adapter->GetInputVarNames(), out);
+            write_strings(adapter->GetOutputVarNames(), out);
+            out.write(adapter->GetTimeUnits());
+            out.write<double>(adapter->GetStartTime());
+            out.write<double>(adapter->GetEndTime());
+            out.write<double>(adapter->GetTimeStep());
+            out.write<double>(adapter->GetCurrentTime());
+            models[handle] = std::move(adapter);
+        }
+
+        static void write_strings(const std::vector<std::string> &values, utils::StateWriter &out) {
+            out.write<uint64_t>(values.size());
+            for (const std::string &value : values) {
+                out.write(value);
+            }
+        }
+
+        static void write_value(Bmi_Py_Adapter &adapter, const std::string &name, utils::StateWriter &out) {
+            std::vector<char> values(adapter.GetVarNbytes(name));
+            adapter.GetValue(name, values.data());
+            out.write(values);
+        }
+
+        /** Write the metadata of a variable, with why the location or grid could not be had in their place. */
+        static void write_var_info(Bmi_Py_Adapter &adapter, const std::string &name, utils::StateWriter &out) {
+            out.write(adapter.GetVarType(name));
+            out.write(adapter.GetVarUnits(name));
+            out.write<int32_t>(adapter.GetVarItemsize(name));
+            out.write<int32_t>(adapter.GetVarNbytes(name));
+            try {
+                std::string location = adapter.GetVarLocation(name);
+                out.write<uint8_t>(1);
+                out.write(location);
+            }
+            catch (const std::exception &e) {
+                out.write<uint8_t>(0);
+                out.write(std::string(e.what()));
+            }
+            try {
+                int32_t grid = adapter.GetVarGrid(name);
+                out.write<int32_t>(grid);
+                out.write(std::string());
+            }
+            catch (const std::exception &e) {
+                out.write<int32_t>(-1);
+                out.write(std::string(e.what()));
+            }
+        }
+
+        static int32_t get_grid_int(Bmi_Py_Adapter &adapter, Python_Worker_Grid_Int function, int grid) {
+            switch (function) {
+                case Python_Worker_Grid_Int::RANK:
+                    return adapter.GetGridRank(grid);
+                case Python_Worker_Grid_Int::SIZE:
+                    return adapter.GetGridSize(grid);
+                case Python_Worker_Grid_Int::NODE_COUNT:
+                    return adapter.GetGridNodeCount(grid);
+                case Python_Worker_Grid_Int::EDGE_COUNT:
+                    return adapter.GetGridEdgeCount(grid);
+                case Python_Worker_Grid_Int::FACE_COUNT:
+                    return adapter.GetGridFaceCount(grid);
+            }
+            throw std::invalid_argument("Unknown Python BMI worker grid function");
+        }
+
+        /** Get the values of an array grid function, sized as the BMI spec sizes each of them. */
+        static std::vector<char> get_grid_array(Bmi_Py_Adapter &adapter, Python_Worker_Grid_Array function, int grid) {
+            std::vector<int> ints;
+            std::vector<double> doubles;
+            switch (function) {
+                case Python_Worker_Grid_Array::SHAPE:
+                    ints.resize(adapter.GetGridRank(grid));
+                    adapter.GetGridShape(grid, ints.data());
+                    break;
+                case Python_Worker_Grid_Array::SPACING:
+                    doubles.resize(adapter.GetGridRank(grid));
+                    adapter.GetGridSpacing(grid, doubles.data());
+                    break;
+                case Python_Worker_Grid_Array::ORIGIN:
+                    doubles.resize(adapter.GetGridRank(grid));
+                    adapter.GetGridOrigin(grid, doubles.data());
+                    break;
+                case Python_Worker_Grid_Array::X:
+                    doubles.resize(adapter.get_grid_coordinate_count(grid, 0));
+                    adapter.GetGridX(grid, doubles.data());
+                    break;
+                case Python_Worker_Grid_Array::Y:
+                    doubles.resize(adapter.get_grid_coordinate_count(grid, 1));
+                    adapter.GetGridY(grid, doubles.data());
+                    break;
+                case Python_Worker_Grid_Array::Z:
+                    doubles.resize(adapter.get_grid_coordinate_count(grid, 2));
+                    adapter.GetGridZ(grid, doubles.data());
+                    break;
+                case Python_Worker_Grid_Array::EDGE_NODES:
+                    ints.resize(2 * adapter.GetGridEdgeCount(grid));
+                    adapter.GetGridEdgeNodes(grid, ints.data());
+                    break;
+                case Python_Worker_Grid_Array::NODES_PER_FACE:
+                    ints.resize(adapter.GetGridFaceCount(grid));
+                    adapter.GetGridNodesPerFace(grid, ints.data());
+                    break;
+                case Python_Worker_Grid_Array::FACE_EDGES:
+                case Python_Worker_Grid_Array::FACE_NODES: {
+                    std::vector<int> nodes_per_face(adapter.GetGridFaceCount(grid));
+                    adapter.GetGridNodesPerFace(grid, nodes_per_face.data());
+                    ints.resize(std::accumulate(nodes_per_face.begin(), nodes_per_face.end(), 0));
+                    if (function == Python_Worker_Grid_Array::FACE_EDGES) {
+                        adapter.GetGridFaceEdges(grid, ints.data());
+                    }
+                    else {
+                        adapter.GetGridFaceNodes(grid, ints.data());
+                    }
+                    break;
+                }
+            }
+            const char *begin = ints.empty() ? reinterpret_cast<const char *>(doubles.data())
+                                             : reinterpret_cast<const char *>(ints.data());
+            std::size_t bytes = ints.size() * sizeof(int) + doubles.size() * sizeof(double);
+            return std::vector<char>(begin, begin + bytes);
+        }
+
+        std::map<int32_t, std::unique_ptr<Bmi_Py_Adapter>> models;
+    };
+
+    void write_reply(utils::SharedMemoryRing &replies, const utils::StateWriter &reply) {
+        uint64_t length = reply.get_bytes().size();
+        replies.write(&length, sizeof(length));
+        replies.write(reply.get_bytes().data(), length);
+    }
+}
+
+int models::bmi::run_python_bmi_worker(int fd, std::size_t bytes) {
+    #ifdef __linux__
+    // Don't outlive the ngen process, even if it is killed before it can shut the worker down
+    prctl(PR_SET_PDEATHSIG, SIGKILL);
+    #endif
+    pid_t parent = getppid();
+    auto parent_alive = [parent]() { return getppid() == parent; };
+    utils::SharedMemoryRegion region(fd, bytes);
+    char *memory = static_cast<char *>(region.data());
+    utils::SharedMemoryRing commands(memory, parent_alive);
+    utils::SharedMemoryRing replies(memory + bytes / 2, parent_alive);
+
+    // Declared first so the models are destroyed while the interpreter is still running
+    auto interpreter = utils::ngenPy::InterpreterUtil::getInstance();
+    Python_Worker_Host host;
+    // The first failure of a queued command of each model, reported by the model's next command with a reply
+    std::map<int32_t, std::string> queued_failures;
+    std::vector<char> message;
+    try {
+        while (true) {
+            uint64_t length;
+            commands.read(&length, sizeof(length));
+            message.resize(length);
+            commands.read(message.data(), message.size());
+            utils::StateReader in(message);
+            auto command = static_cast<Python_Worker_Command>(in.read<int32_t>());
+            if (command == Python_Worker_Command::SHUTDOWN) {
+                return 0;
+            }
+            int32_t handle = in.read<int32_t>();
+            bool is_queued = command <= Python_Worker_Command::FINALIZE;
+            utils::StateWriter reply;
+            reply.write<int32_t>(0);
+            try {
+                auto failure = queued_failures.find(handle);
+                if (command == Python_Worker_Command::DESTROY) {
+                    queued_failures.erase(handle);
+                }
+                else if (failure != queued_failures.end()) {
+                    // Later commands would run on a model left part way through an earlier one
+                    throw std::runtime_error(failure->second);
+                }
+                host.run(command, handle, in, reply);
+            }
+            catch (const std::exception &e) {
+                if (is_queued) {
+                    queued_failures.emplace(handle, std::string("An earlier command of the Python BMI model failed: ")
+                                                    + e.what());
+                    continue;
+                }
+                reply = utils::StateWriter();
+                reply.write<int32_t>(1);
+                reply.write(std::string(e.what()));
+            }
+            if (!is_queued) {
+                write_reply(replies, reply);
+            }
+        }
+    }
+    catch (const std::runtime_error &e) {
+        std::cerr << "Python BMI worker " << getpid() << " stopping: " << e.what() << std::endl;
+        return 1;
+    }
+}
+
+#endif //ACTIVATE_PYTHON
@@ -1,5 +1,7 @@
 #include "Simple_Lumped_Model_Realization.hpp"
+#include "NumberFormat.hpp"
 
+#include <algorithm>
 #include <cmath>
 
 /*
@@ -54,7 +56,8 @@ state( std::move(other.state) ), realization::Catchment_Formulation(other.get_id
 Simple_Lumped_Model_Realization::Simple_Lumped_Model_Realization(const Simple_Lumped_Model_Realization & other)
 :fluxes( other.fluxes ), params( other.params),
 cascade_backing_storage( other.cascade_backing_storage ),
-state( other.state ), realization::Catchment_Formulation(other.get_id())
+state( other.state ), quiescent_threshold_meters( other.quiescent_threshold_meters ),
+realization::Catchment_Formulation(other.get_id())
 {
   //rehook state.Sr* -> cascade_backing_storage
   for(auto &s : state)
@@ -83,6 +86,61 @@ void Simple_Lumped_Model_Realization::add_time(time_t t, double n)
     }
 }
 
+/**
+ * Save the model state at the start of the next time step, i.e. the state of the latest time step.
+ *
+ * Only this state is saved, not the states and fluxes of earlier time steps, so a restored formulation can only
+ * produce output from the time step after the checkpoint onward.
+ */
+void Simple_Lumped_Model_Realization::save_state(utils::StateWriter &out)
+{
+    time_step_t latest = 0;
+    for (const auto &s : state) {
+        latest = std::max(latest, s.first);
+    }
+    const hymod_state &latest_state = state.at(latest);
+    out.write<int64_t>(latest);
+    out.write<double>(latest_state.storage_meters);
+    out.write<double>(latest_state.groundwater_storage_meters);
+    out.write(cascade_backing_storage.at(latest));
+}
+
+void Simple_Lumped_Model_Realization::load_state(utils::StateReader &in)
+{
+    time_step_t latest = static_cast<time_step_t>(in.read<int64_t>());
+    restore_state(latest, in);
+}
+
+/**
+ * Restore the model state saved at the end of another run as the state of the first time step.
+ */
+void Simple_Lumped_Model_Realization::load_initial_state(utils::StateReader &in)
+{
+    in.read<int64_t>();
+    restore_state(0, in);
+}
+
+void Simple_Lumped_Model_Realization::restore_state(time_step_t t, utils::StateReader &in)
+{
+    double storage_meters = in.read<double>();
+    double groundwater_storage_meters = in.read<double>();
+    std::vector<double> cascade_storage = in.read_vector<double>();
+    if (cascade_storage.size() != static_cast<size_t>(params.n)) {
+        throw std::runtime_error("Cannot restore simple_lumped formulation of " + get_id() + ": saved state has " +
+                                 std::to_string(cascade_storage.size()) + " Nash cascade reservoirs, but it has " +
+                                 std::to_string(params.n) + ".");
+    }
+
+    state.clear();
+    fluxes.clear();
+    cascade_backing_storage.clear();
+    add_time(t, params.n);
+    cascade_backing_storage[t] = std::move(cascade_storage);
+    state[t].Sr = cascade_backing_storage[t].data();
+    state[t].storage_meters = storage_meters;
+    state[t].groundwater_storage_meters = groundwater_storage_meters;
+}
+
 double Simple_Lumped_Model_Realization::calc_et()
 {
     return 0.0;
@@ -115,6 +173,13 @@ double Simple_Lumped_Model_Realization::get_response(time_step_t t, time_step_t
     //Do we keep an "internal dt" i.e. this->dt and reconcile with t?
     //hymod_kernel::run(68400.0, params, state[t], state[t+1], fluxes[t], precip, et_params);
 
+    // through dry periods, skip partitioning the soil and computing et, and just drain the reservoirs
+    double input_meters = precip * dt;
+    if (input_meters <= quiescent_threshold_meters && state[t].storage_meters <= quiescent_threshold_meters) {
+        hymod_kernel::run_recession(dt, params, state[t], state[t+1], fluxes[t], input_meters);
+        return fluxes[t].slow_flow_meters_per_second + fluxes[t].runoff_meters_per_second;
+    }
+
     pdm03_struct params_copy = get_et_params();
     hymod_kernel::run(dt, params, state[t], state[t+1], fluxes[t], precip*dt, &params_copy);
     return fluxes[t].slow_flow_meters_per_second + fluxes[t].runoff_meters_per_second;
@@ -142,11 +207,11 @@ double Simple_Lumped_Model_Realization::get_response(time_step_t t, time_step_t
  * @return A delimited string with all the output variable values for the given time step.
  */
 std::string Simple_Lumped_Model_Realization::get_output_line_for_timestep(int timestep, std::string delimiter) {
-    if (timestep >= fluxes.size()) {
+    if (fluxes.find(timestep) == fluxes.end()) {
         return "";
     }
     double discharge = fluxes[timestep].slow_flow_meters_per_second + fluxes[timestep].runoff_meters_per_second;
-    return std::to_string(discharge);
+    return utils::number_format::to_fixed(discharge);
 }
 
 void Simple_Lumped_Model_Realization::create_formulation(geojson::PropertyMap properties) {
@@ -179,6 +244,10 @@ void Simple_Lumped_Model_Realization::create_formulation(geojson::PropertyMap pr
     params.Kq = Kq;
     params.n = n;
 
+    if (properties.count("quiescent_threshold") > 0) {
+        quiescent_threshold_meters = properties.at("quiescent_threshold").as_real_number();
+    }
+
     //Init the first time explicity using passed in data
     fluxes[0] = hymod_fluxes();
 
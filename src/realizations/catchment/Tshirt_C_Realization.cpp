@@ -1,5 +1,6 @@
 #include "Tshirt_C_Realization.hpp"
 #include "Constants.h"
+#include "NumberFormat.hpp"
 #include <utility>
 #include "tshirt_c.h"
 #include "GIUH.hpp"
@@ -38,8 +39,8 @@ Tshirt_C_Realization::Tshirt_C_Realization(forcing_params forcing_config,
                                            tshirt::tshirt_params params,
                                            const std::vector<double> &nash_storage)
         //: Catchment_Formulation(catchment_id, std::move(std::make_unique<Forcing>(forcing_config)), output_stream), catchment_id(std::move(catchment_id)),
-        : Catchment_Formulation(catchment_id, std::move(std::make_unique<CsvPerFeatureForcingProvider>(forcing_config)), output_stream), catchment_id(std::move(catchment_id)),
-          giuh_cdf_ordinates(std::move(giuh_ordinates)), params(std::make_shared<tshirt_params>(params)), nash_storage(nash_storage), c_soil_params(NWM_soil_parameters()),
+        : Catchment_Formulation(catchment_id, CsvPerFeatureForcingProvider::get_shared_provider(forcing_config), output_stream), catchment_id(std::move(catchment_id)),
+          giuh_cdf_ordinates(giuh::giuh_ordinate_table::intern(std::move(giuh_ordinates))), params(std::make_shared<tshirt_params>(params)), nash_storage(nash_storage), c_soil_params(NWM_soil_parameters()),
           groundwater_conceptual_reservoir(conceptual_reservoir()), soil_conceptual_reservoir(conceptual_reservoir()),
           c_aorc_params(aorc_forcing_data())
 {
@@ -51,10 +52,7 @@ Tshirt_C_Realization::Tshirt_C_Realization(forcing_params forcing_config,
     }
 
     // Create this with 0 values initially
-    giuh_runoff_queue_per_timestep = std::vector<double>(giuh_cdf_ordinates.size() + 1);
-    for (int i = 0; i < giuh_cdf_ordinates.size() + 1; i++) {
-        giuh_runoff_queue_per_timestep.push_back(0.0);
-    }
+    giuh_runoff_queue_per_timestep = std::vector<double>(giuh_cdf_ordinates->size() + 1, 0.0);
 
     fluxes = std::vector<std::shared_ptr<tshirt_c_result_fluxes>>();
 
@@ -105,7 +103,7 @@ Tshirt_C_Realization::Tshirt_C_Realization(
         forcing_params forcing_config,
         utils::StreamHandler output_stream
 //) : Catchment_Formulation(std::move(id), std::move(std::make_unique<Forcing>(forcing_config)), output_stream) {
-) : Catchment_Formulation(std::move(id), std::move(std::make_unique<CsvPerFeatureForcingProvider>(forcing_config)), output_stream) {
+) : Catchment_Formulation(std::move(id), CsvPerFeatureForcingProvider::get_shared_provider(forcing_config), output_stream) {
     fluxes = std::vector<std::shared_ptr<tshirt_c_result_fluxes>>();
 }
 
@@ -173,7 +171,7 @@ void Tshirt_C_Realization::create_formulation(geojson::PropertyMap properties) {
     // Since this implementation really just cares about the ordinates, allow them to be passed directly here, or read
     // from a separate file
     if (giuh.has_key("cdf_ordinates")) {
-        giuh_cdf_ordinates = giuh.at("cdf_ordinates").as_real_vector();
+        giuh_cdf_ordinates = giuh::giuh_ordinate_table::intern(giuh.at("cdf_ordinates").as_real_vector());
     }
     else {
         std::vector<std::string> missing_parameters;
@@ -197,24 +195,18 @@ void Tshirt_C_Realization::create_formulation(geojson::PropertyMap properties) {
             throw std::runtime_error(message);
         }
 
-        std::unique_ptr<giuh::GiuhJsonReader> giuh_reader = std::make_unique<giuh::GiuhJsonReader>(
+        std::shared_ptr<giuh::GiuhJsonReader> giuh_reader = giuh::GiuhJsonReader::get_shared_reader(
                 giuh.at("giuh_path").as_string(),
                 giuh.at("crosswalk_path").as_string()
         );
 
         std::shared_ptr<giuh::giuh_kernel_impl> giuh_kernel = giuh_reader->get_giuh_kernel_for_id(catchment_id);
         giuh_kernel->set_interpolation_regularity_seconds(3600);
-        // This needs to have all but the first interpolated incremental value (which is always 0 from the kernel), so
-        giuh_cdf_ordinates = std::vector<double>(giuh_kernel->get_interpolated_incremental_runoff().size() - 1);
-        for (int i = 0; i < giuh_cdf_ordinates.size(); ++ i) {
-            giuh_cdf_ordinates[i] = giuh_kernel->get_interpolated_incremental_runoff()[i + 1];
-        }
+        // This needs to have all but the first interpolated incremental value (which is always 0 from the kernel)
+        giuh_cdf_ordinates = giuh_kernel->get_convolution_ordinates();
     }
     // Create this with 0 values initially
-    giuh_runoff_queue_per_timestep = std::vector<double>(giuh_cdf_ordinates.size() + 1);
-    for (int i = 0; i < giuh_cdf_ordinates.size() + 1; i++) {
-        giuh_runoff_queue_per_timestep.push_back(0.0);
-    }
+    giuh_runoff_queue_per_timestep = std::vector<double>(giuh_cdf_ordinates->size() + 1, 0.0);
 }
 
 void Tshirt_C_Realization::create_formulation(boost::property_tree::ptree &config, geojson::PropertyMap *global) {
@@ -262,7 +254,7 @@ void Tshirt_C_Realization::create_formulation(boost::property_tree::ptree &confi
     // Since this implementation really just cares about the ordinates, allow them to be passed directly here, or read
     // from a separate file
     if (giuh.has_key("cdf_ordinates")) {
-        giuh_cdf_ordinates = giuh.at("cdf_ordinates").as_real_vector();
+        giuh_cdf_ordinates = giuh::giuh_ordinate_table::intern(giuh.at("cdf_ordinates").as_real_vector());
     }
     else {
         std::vector<std::string> missing_parameters;
@@ -286,7 +278,7 @@ void Tshirt_C_Realization::create_formulation(boost::property_tree::ptree &confi
             throw std::runtime_error(message);
         }
 
-        std::unique_ptr<giuh::GiuhJsonReader> giuh_reader = std::make_unique<giuh::GiuhJsonReader>(
+        std::shared_ptr<giuh::GiuhJsonReader> giuh_reader = giuh::GiuhJsonReader::get_shared_reader(
                 giuh.at("giuh_path").as_string(),
                 giuh.at("crosswalk_path").as_string()
         );
@@ -294,17 +286,11 @@ void Tshirt_C_Realization::create_formulation(boost::property_tree::ptree &confi
 
         std::shared_ptr<giuh::giuh_kernel_impl> giuh_kernel = giuh_reader->get_giuh_kernel_for_id(catchment_id);
         giuh_kernel->set_interpolation_regularity_seconds(3600);
-        // This needs to have all but the first interpolated incremental value (which is always 0 from the kernel), so
-        giuh_cdf_ordinates = std::vector<double>(giuh_kernel->get_interpolated_incremental_runoff().size() - 1);
-        for (int i = 0; i < giuh_cdf_ordinates.size(); ++ i) {
-            giuh_cdf_ordinates[i] = giuh_kernel->get_interpolated_incremental_runoff()[i + 1];
-        }
+        // This needs to have all but the first interpolated incremental value (which is always 0 from the kernel)
+        giuh_cdf_ordinates = giuh_kernel->get_convolution_ordinates();
     }
     // Create this with 0 values initially
-    giuh_runoff_queue_per_timestep = std::vector<double>(giuh_cdf_ordinates.size() + 1);
-    for (int i = 0; i < giuh_cdf_ordinates.size() + 1; i++) {
-        giuh_runoff_queue_per_timestep.push_back(0.0);
-    }
+    giuh_runoff_queue_per_timestep = std::vector<double>(giuh_cdf_ordinates->size() + 1, 0.0);
 
 }
 
@@ -390,7 +376,10 @@ std::string Tshirt_C_Realization::get_output_line_for_timestep(int timestep, std
         // Get a lambda that takes a fluxes struct and returns the right (double) member value from it from the name
         std::function<double(tshirt_c_result_fluxes)> get_val_func = get_output_var_flux_extraction_func(name);
         double output_var_value = get_val_func(flux_for_timestep);
-        output_str += output_str.empty() ? std::to_string(output_var_value) : "," + std::to_string(output_var_value);
+        if (!output_str.empty()) {
+            output_str.push_back(',');
+        }
+        utils::number_format::append_fixed(output_str, output_var_value);
     }
     return output_str;
 }
@@ -407,6 +396,26 @@ const std::vector<std::string> &Tshirt_C_Realization::get_output_var_names() {
 // TODO: don't care for this, as it could have the reference locations accidentally altered (also, raw pointer => bad)
 //@robertbartel is this TODO resolved with these changes?
 const std::vector<std::string>& Tshirt_C_Realization::get_required_parameters() {
+    static const std::vector<std::string> REQUIRED_PARAMETERS = {
+        "maxsmc",
+        "wltsmc",
+        "satdk",
+        "satpsi",
+        "slope",
+        "scaled_distribution_fn_shape_parameter",
+        "multiplier",
+        "alpha_fc",
+        "Klf",
+        "Kn",
+        "nash_n",
+        "Cgw",
+        "expon",
+        "max_groundwater_storage_meters",
+        "nash_storage",
+        "soil_storage_percentage",
+        "groundwater_storage_percentage",
+        "giuh"
+    };
     return REQUIRED_PARAMETERS;
 }
 
@@ -533,7 +542,7 @@ int Tshirt_C_Realization::run_formulation_for_timesteps(std::vector<double> inpu
 
     // TODO: need some kind of guarantee that the vectors won't be resized and current buffer arrays won't be changed or
     //  removed (before the below "run" call finishes)
-    double* giuh_ordinates = &giuh_cdf_ordinates[0];
+    const double* giuh_ordinates = giuh_cdf_ordinates->data();
     double* giuh_runoff_queue = &giuh_runoff_queue_per_timestep[0];
 
     //aorc_forcing_data empty_forcing[num_timesteps];
@@ -557,7 +566,7 @@ int Tshirt_C_Realization::run_formulation_for_timesteps(std::vector<double> inpu
                      soil_conceptual_reservoir,
                      num_timesteps,
                      giuh_ordinates,
-                     (int)giuh_cdf_ordinates.size(),
+                     (int)giuh_cdf_ordinates->size(),
                      giuh_runoff_queue,
                      params->alpha_fc,
                      assumed_near_channel_water_table_slope,
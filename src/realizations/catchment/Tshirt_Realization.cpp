@@ -2,6 +2,8 @@
 #include "Tshirt_Realization.hpp"
 #include "TshirtErrorCodes.h"
 #include "Catchment_Formulation.hpp"
+#include "Logger.hpp"
+#include "NumberFormat.hpp"
 using namespace realization;
 
 /*
@@ -73,6 +75,15 @@ Tshirt_Realization::Tshirt_Realization(
 }
 */
 
+Tshirt_Realization::~Tshirt_Realization() {
+    // With a mass check interval, the time steps since the last check (the whole run, with an interval of 0) are
+    // only checked now
+    if (model != nullptr && model->get_mass_check_interval() != 1
+        && model->check_accumulated_mass_balance() == tshirt::TSHIRT_MASS_BALANCE_ERROR) {
+        NGEN_LOG_WARNING("Tshirt_Realization::model mass balance error");
+    }
+}
+
 double Tshirt_Realization::calc_et() {
     return 0;
 }
@@ -114,7 +125,7 @@ double Tshirt_Realization::get_response(time_step_t t_index, time_step_t t_delta
     //Do we keep an "internal dt" i.e. this->dt and reconcile with t?
     int error = model->run(t_index, precip * t_delta_s / 1000, get_et_params_ptr());
     if(error == tshirt::TSHIRT_MASS_BALANCE_ERROR){
-      std::cout<<"WARNING Tshirt_Realization::model mass balance error"<<std::endl;
+      NGEN_LOG_WARNING("Tshirt_Realization::model mass balance error");
     }
     state[t_index + 1] = model->get_current_state();
     fluxes[t_index] = model->get_fluxes();
@@ -151,7 +162,7 @@ std::string Tshirt_Realization::get_output_line_for_timestep(int timestep, std::
     double discharge = fluxes[timestep]->soil_lateral_flow_meters_per_second +
                        fluxes[timestep]->groundwater_flow_meters_per_second +
                        giuh_kernel->calc_giuh_output(timestep, fluxes[timestep]->surface_runoff_meters_per_second);
-    return std::to_string(discharge);
+    return utils::number_format::to_fixed(discharge);
 }
 
 void Tshirt_Realization::create_formulation(geojson::PropertyMap properties) {
@@ -192,6 +203,12 @@ void Tshirt_Realization::create_formulation(geojson::PropertyMap properties) {
     }
 
     this->model = make_unique<tshirt::tshirt_model>(tshirt::tshirt_model(tshirt_params, this->state[0]));
+    if (properties.count("mass_check_interval") > 0) {
+        this->model->set_mass_check_interval(properties.at("mass_check_interval").as_natural_number());
+    }
+    if (properties.count("groundwater_table_tolerance") > 0) {
+        this->model->set_groundwater_table_tolerance(properties.at("groundwater_table_tolerance").as_real_number());
+    }
 
     geojson::JSONProperty giuh = properties.at("giuh");
 
@@ -219,7 +236,7 @@ void Tshirt_Realization::create_formulation(geojson::PropertyMap properties) {
         throw std::runtime_error(message);
     }
 
-    std::unique_ptr<giuh::GiuhJsonReader> giuh_reader = std::make_unique<giuh::GiuhJsonReader>(
+    std::shared_ptr<giuh::GiuhJsonReader> giuh_reader = giuh::GiuhJsonReader::get_shared_reader(
         giuh.at("giuh_path").as_string(),
         giuh.at("crosswalk_path").as_string()
     );
@@ -275,6 +292,9 @@ void Tshirt_Realization::create_formulation(boost::property_tree::ptree &config,
     }
 
     this->model = make_unique<tshirt::tshirt_model>(tshirt::tshirt_model(tshirt_params, this->state[0]));
+    if (options.count("mass_check_interval") > 0) {
+        this->model->set_mass_check_interval(options.at("mass_check_interval").as_natural_number());
+    }
 
     geojson::JSONProperty giuh = options.at("giuh");
 
@@ -302,7 +322,7 @@ void Tshirt_Realization::create_formulation(boost::property_tree::ptree &config,
         throw std::runtime_error(message);
     }
 
-    std::unique_ptr<giuh::GiuhJsonReader> giuh_reader = std::make_unique<giuh::GiuhJsonReader>(
+    std::shared_ptr<giuh::GiuhJsonReader> giuh_reader = giuh::GiuhJsonReader::get_shared_reader(
         giuh.at("giuh_path").as_string(),
         giuh.at("crosswalk_path").as_string()
     );
@@ -16,10 +16,45 @@ Routing_Py_Adapter::Routing_Py_Adapter(std::string t_route_config_file_with_path
   this->t_route_module = utils::ngenPy::InterpreterUtil::getPyModule("ngen_routing.ngen_main");
   }
 
-void Routing_Py_Adapter::route(int number_of_timesteps, int delta_time,
-                          const std::vector<double> &flow_vector){
-  throw "Routing_Py_Adapter::route overload with flow_vector unimplemented.";
-};
+bool Routing_Py_Adapter::supports_in_memory_flows()
+{
+  py::gil_scoped_acquire gil;
+  return py::hasattr(t_route_module, "receive_flow_values");
+}
+
+void Routing_Py_Adapter::receive_flows(const std::vector<std::string> &nexus_ids,
+                                       const std::vector<std::string> &timestamps,
+                                       const double *flows, std::size_t row_stride)
+{
+  py::gil_scoped_acquire gil;
+
+  //View the flows without copying them; the capsule stands in for an owner, so numpy neither copies nor frees them
+  py::capsule no_owner(flows, [](void *) {});
+  py::array_t<double> flow_array({nexus_ids.size(), timestamps.size()},
+                                 {row_stride * sizeof(double), sizeof(double)},
+                                 flows, no_owner);
+  //The array points at ngen's buffer, so don't let t-route write through it
+  flow_array.attr("setflags")(py::arg("write") = false);
+
+  //Call receive_flow_values subroutine
+  py::object receive_flow_values = t_route_module.attr("receive_flow_values");
+  receive_flow_values(py::cast(nexus_ids), py::cast(timestamps), flow_array);
+}
+
+bool Routing_Py_Adapter::supports_chunked_routing()
+{
+  py::gil_scoped_acquire gil;
+  return py::hasattr(t_route_module, "route_flow_values");
+}
+
+void Routing_Py_Adapter::route_received_flows(int number_of_timesteps, int delta_time)
+{
+  py::gil_scoped_acquire gil;
+
+  //Call route_flow_values subroutine
+  py::object route_flow_values = t_route_module.attr("route_flow_values");
+  route_flow_values(number_of_timesteps, delta_time);
+}
 
 void Routing_Py_Adapter::route(int number_of_timesteps, int delta_time)
 {
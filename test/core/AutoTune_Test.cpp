@@ -0,0 +1,125 @@
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "core/AutoTune.hpp"
+
+namespace {
+    boost::property_tree::ptree parse(const std::string& json) {
+        std::stringstream data(json);
+        boost::property_tree::ptree tree;
+        boost::property_tree::json_parser::read_json(data, tree);
+        return tree;
+    }
+}
+
+//! Test that each knob is swept in turn from the best values so far, without timing any candidate twice.
+TEST(AutoTuneTest, TestCoordinateSweep) {
+    autotune::Coordinate_Sweep sweep({{"a", 2, {1, 2, 4}}, {"b", 8, {8, 16}}});
+    //The time of each candidate
+    auto time = [](const std::vector<long>& values) {
+        return values[0] == 4 ? 1.0 : (values[1] == 16 ? 3.0 : 2.0 + values[0]);
+    };
+
+    std::vector<std::vector<long>> candidates;
+    std::vector<long> values;
+    while (sweep.next(values)) {
+        candidates.push_back(values);
+        sweep.record(values == std::vector<long>{1, 8} ? -1.0 : time(values));
+    }
+    EXPECT_EQ(candidates, (std::vector<std::vector<long>>{{2, 8}, {1, 8}, {4, 8}, {4, 16}}));
+    EXPECT_EQ(sweep.get_best_values(), (std::vector<long>{4, 8}));
+    EXPECT_DOUBLE_EQ(sweep.get_best_seconds(), 1.0);
+    EXPECT_EQ(sweep.get_runs(), 4);
+}
+
+//! Test that a candidate's time must be recorded before the next one is asked for.
+TEST(AutoTuneTest, TestRecordOrder) {
+    autotune::Coordinate_Sweep sweep({{"a", 1, {1, 2}}});
+    std::vector<long> values;
+    EXPECT_THROW(sweep.record(1.0), std::logic_error);
+    ASSERT_TRUE(sweep.next(values));
+    EXPECT_THROW(sweep.next(values), std::logic_error);
+}
+
+//! Test that only the knobs that can make a difference to a config are tuned.
+TEST(AutoTuneTest, TestDefaultKnobs) {
+    auto knobs = autotune::default_knobs(parse(R"({"execution": {"catchment_threads": 0},
+                                                   "global": {"forcing": {"provider": "NetCDF"}},
+                                                   "output": {"catchment_format": "binary"}})"), 6, 10);
+    ASSERT_EQ(knobs.size(), 5);
+    EXPECT_EQ(knobs[0].path, "execution.catchment_threads");
+    EXPECT_EQ(knobs[0].initial, 6);
+    EXPECT_EQ(knobs[0].values, (std::vector<long>{1, 2, 4, 6}));
+    EXPECT_EQ(knobs[1].path, "execution.time_block");
+    EXPECT_EQ(knobs[1].values, (std::vector<long>{1, 2, 4, 8}));
+    EXPECT_EQ(knobs[2].path, "global.forcing.cache_size_mb");
+    EXPECT_EQ(knobs[2].initial, 256);
+    EXPECT_EQ(knobs[3].path, "output.nexus_buffer_steps");
+    EXPECT_EQ(knobs[4].path, "output.catchment_buffer_mb");
+
+    knobs = autotune::default_knobs(parse(R"({"execution": {"lookahead": 4}})"), 1, 10);
+    ASSERT_EQ(knobs.size(), 1);
+    EXPECT_EQ(knobs[0].path, "output.nexus_buffer_steps");
+}
+
+//! Test that a candidate's config runs only the first time steps, writing only into its own directory.
+TEST(AutoTuneTest, TestTrialConfig) {
+    auto config = parse(R"({"time": {"start_time": "2015-12-01 00:00:00", "end_time": "2015-12-30 23:00:00",
+                                     "output_interval": 3600},
+                            "execution": {"response_cache": "./cache", "tuning_file": "./tuning.json",
+                                          "checkpoint_interval": 24},
+                            "output": {"catchment_format": "stream", "nexus_path": "./out/"}})");
+    std::vector<autotune::Knob> knobs = {{"execution.time_block", 1, {1, 2}}};
+    auto trial = autotune::trial_config(config, knobs, {2}, 48, "/tmp/trials/");
+    EXPECT_EQ(trial.get<long>("execution.time_block"), 2);
+    EXPECT_EQ(trial.get<std::string>("time.end_time"), "2015-12-03 00:00:00");
+    EXPECT_EQ(trial.get<std::string>("time.start_time"), "2015-12-01 00:00:00");
+    EXPECT_EQ(trial.get<std::string>("output.nexus_path"), "/tmp/trials/");
+    EXPECT_EQ(trial.get<std::string>("output.profile_path"), "/tmp/trials/");
+    EXPECT_EQ(trial.get<std::string>("output.catchment_format"), "binary");
+    EXPECT_EQ(trial.get<long>("execution.checkpoint_interval"), 0);
+    EXPECT_FALSE(trial.get_optional<std::string>("execution.response_cache"));
+    EXPECT_FALSE(trial.get_optional<std::string>("execution.tuning_file"));
+
+    //A window past the end of the config keeps its end
+    trial = autotune::trial_config(config, knobs, {2}, 10000, "/tmp/trials/");
+    EXPECT_EQ(trial.get<std::string>("time.end_time"), "2015-12-30 23:00:00");
+}
+
+//! Test that a tuning file written for some knobs sets their values in a config that loads it.
+TEST(AutoTuneTest, TestTuningFile) {
+    std::string path = testing::TempDir() + "auto_tune_test.json";
+    std::vector<autotune::Knob> knobs = {{"execution.catchment_threads", 1, {}},
+                                         {"global.forcing.cache_size_mb", 256, {}}};
+    autotune::write_tuning_file(path, knobs, {4, 1024});
+
+    auto config = parse(R"({"execution": {"catchment_threads": 2, "tuning_file": ")" + path + R"("},
+                            "global": {"forcing": {"provider": "NetCDF"}}})");
+    autotune::apply_tuning_file(config);
+    std::remove(path.c_str());
+    EXPECT_EQ(config.get<long>("execution.catchment_threads"), 4);
+    EXPECT_EQ(config.get<long>("global.forcing.cache_size_mb"), 1024);
+    EXPECT_EQ(config.get<std::string>("global.forcing.provider"), "NetCDF");
+
+    EXPECT_THROW(autotune::apply_tuning_file(config), std::runtime_error);
+}
+
+//! Test that the time of a region is read from a profile summary.
+TEST(AutoTuneTest, TestReadRegionSeconds) {
+    std::string path = testing::TempDir() + "auto_tune_test_profile.json";
+    {
+        std::ofstream file(path);
+        file << "{\"processes\":1,\"regions\":[\n"
+             << "{\"name\":\"main/nexus_inflows\",\"calls\":4,\"total_seconds\":0.5},\n"
+             << "{\"name\":\"main/time_step\",\"calls\":4,\"total_seconds\":2.25}\n]}\n";
+    }
+    EXPECT_DOUBLE_EQ(autotune::read_region_seconds(path, autotune::TIMED_REGION), 2.25);
+    EXPECT_THROW(autotune::read_region_seconds(path, "main/time_block"), std::runtime_error);
+    std::remove(path.c_str());
+    EXPECT_THROW(autotune::read_region_seconds(path, autotune::TIMED_REGION), std::runtime_error);
+}
@@ -0,0 +1,85 @@
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "core/CatchmentFlow.hpp"
+#include "core/nexus/HY_PointHydroNexus.hpp"
+
+#include <features/Features.hpp>
+#include <JSONProperty.hpp>
+
+namespace {
+    //! A catchment feature with its area under the property @p area_property, in km^2.
+    geojson::Feature make_catchment(const std::string& id, const std::string& area_property, double area_sqkm)
+    {
+        geojson::PropertyMap properties;
+        properties.emplace(area_property, geojson::JSONProperty(area_property, area_sqkm));
+        return std::make_shared<geojson::PointFeature>(geojson::coordinate_t(0.0, 0.0), id, properties);
+    }
+
+    //! The area of @p catchment in m^2, looked up the way each time step looked it up before it was cached.
+    double area_m2_of_step(const geojson::Feature& catchment)
+    {
+        const char* name = catchment->has_property("areasqkm") ? "areasqkm" : "area_sqkm";
+        return catchment->get_property(name).as_real_number() * 1000000;
+    }
+
+    //! The response of catchment @p i at output time step @p t, in m per formulation time step.
+    double response(std::size_t i, int t)
+    {
+        return 0.001 * (i + 1) + 0.0003 * (t % 5);
+    }
+}
+
+//! Test that the flow factors resolved once per catchment give the nexuses the flows of the per-step area lookup.
+TEST(CatchmentFlowTest, TestCachedFactorsMatchPerStepLookup)
+{
+    const long output_interval_seconds = 3600;
+    const std::vector<std::string> catchment_ids = {"cat-0", "cat-1", "cat-2"};
+    const std::vector<geojson::Feature> catchments = {
+        make_catchment("cat-0", "areasqkm", 2.5),
+        make_catchment("cat-1", "area_sqkm", 0.75),
+        make_catchment("cat-2", "areasqkm", 13.1)
+    };
+    const std::vector<long> step_multiples = {1, 3, 24};
+    const std::vector<std::size_t> downstream = {0, 0, 1};
+    std::vector<std::shared_ptr<HY_PointHydroNexus>> cached_nexuses, per_step_nexuses;
+    for (auto* nexuses : {&cached_nexuses, &per_step_nexuses}) {
+        nexuses->push_back(std::make_shared<HY_PointHydroNexus>("nex-0", HY_PointHydroNexus::Catchments{"cat-3"},
+                                                                HY_PointHydroNexus::Catchments{"cat-0", "cat-1"}));
+        nexuses->push_back(std::make_shared<HY_PointHydroNexus>("nex-1", HY_PointHydroNexus::Catchments{"cat-3"},
+                                                                HY_PointHydroNexus::Catchments{"cat-2"}));
+    }
+
+    std::vector<double> flow_factors;
+    for (std::size_t i = 0; i < catchments.size(); ++i) {
+        flow_factors.push_back(ngen::catchment_flow_factor(ngen::catchment_area_m2(catchments[i], catchment_ids[i]),
+                                                           step_multiples[i], output_interval_seconds));
+    }
+
+    for (int t = 0; t < 48; ++t) {
+        for (std::size_t i = 0; i < catchments.size(); ++i) {
+            double cached = response(i, t) * flow_factors[i];
+            double per_step = response(i, t) * area_m2_of_step(catchments[i]);
+            per_step /= static_cast<double>(step_multiples[i] * output_interval_seconds);
+            cached_nexuses[downstream[i]]->add_upstream_flow(cached, catchment_ids[i], t);
+            per_step_nexuses[downstream[i]]->add_upstream_flow(per_step, catchment_ids[i], t);
+        }
+        for (std::size_t n = 0; n < cached_nexuses.size(); ++n) {
+            EXPECT_DOUBLE_EQ(cached_nexuses[n]->get_downstream_flow("cat-3", t, 100.0),
+                             per_step_nexuses[n]->get_downstream_flow("cat-3", t, 100.0));
+        }
+    }
+}
+
+//! Test that the area is read from either spelling of its property, and that a catchment with neither is an error.
+TEST(CatchmentFlowTest, TestAreaProperties)
+{
+    ASSERT_DOUBLE_EQ(ngen::catchment_area_m2(make_catchment("cat-0", "areasqkm", 2.5), "cat-0"), 2500000.0);
+    ASSERT_DOUBLE_EQ(ngen::catchment_area_m2(make_catchment("cat-1", "area_sqkm", 0.75), "cat-1"), 750000.0);
+    ASSERT_THROW(ngen::catchment_area_m2(make_catchment("cat-2", "area", 1.0), "cat-2"), std::runtime_error);
+    ASSERT_THROW(ngen::catchment_area_m2(nullptr, "cat-3"), std::runtime_error);
+}
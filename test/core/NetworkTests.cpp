@@ -6,6 +6,18 @@
 #include <JSONProperty.hpp>
 
 #include "network.hpp"
+#include "WavefrontScheduler.hpp"
+#include "MultilevelPartitioner.hpp"
+#include "ChannelRouting.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <set>
+#include <thread>
 
 using namespace network;
 
@@ -145,6 +157,18 @@ public:
   }
 };
 
+class Network_TestPath : public Network_Test, public ::testing::Test{
+public:
+  Network_TestPath(){}
+  void SetUp(){
+    this->add_catchment("cat-a", "nex-a");
+    this->add_nexus("nex-a", "cat-b");
+    this->add_catchment("cat-b", "nex-b");
+    this->add_nexus("nex-b");
+    n =  Network(this->get_fabric());
+  }
+};
+
 //! Test that a network can be created.
 TEST_P(Network_Test1, TestNetworkConstructionNumberOfNodes)
 {
@@ -267,6 +291,23 @@ TEST_F(Network_Test2, test_get_origination_ids)
   ASSERT_FALSE( std::find(ids.begin(), ids.end(), "cat-4") == ids.end() );
 }
 
+TEST_F(Network_Test2, test_get_upstream_ids)
+{
+  std::vector<std::string> ids = n.get_upstream_ids({"nex-0"});
+  ASSERT_EQ( ids.size(), 3);
+  ASSERT_EQ( ids[0], "nex-0");
+  ASSERT_FALSE( std::find(ids.begin(), ids.end(), "cat-0") == ids.end() );
+  ASSERT_FALSE( std::find(ids.begin(), ids.end(), "cat-1") == ids.end() );
+
+  //Everything is upstream of the outlet, and ids reached twice or not in the network are listed once or not at all
+  ids = n.get_upstream_ids({"nex-1", "cat-2", "nex-9"});
+  ASSERT_EQ( ids.size(), 7);
+  ASSERT_EQ( ids[0], "nex-1");
+  ASSERT_EQ( ids[1], "cat-2");
+  std::sort(ids.begin(), ids.end());
+  ASSERT_TRUE( std::unique(ids.begin(), ids.end()) == ids.end() );
+}
+
 TEST_F(Network_Test2, test_get_destination_ids)
 {
   std::vector<std::string> ids = n.get_destination_ids("nex-1");
@@ -289,6 +330,76 @@ TEST_F(Network_Test2, test_get_destination_ids2)
   ASSERT_FALSE( std::find(ids.begin(), ids.end(), "nex-1") == ids.end() );
 }
 
+TEST_F(Network_Test2, test_handles)
+{
+  //Every feature has a dense handle, which round trips through its id
+  std::vector<bool> seen(n.size(), false);
+  for(auto it = n.begin(); it != n.end(); ++it)
+  {
+    Graph::vertex_descriptor handle = n.get_handle( n.get_id(*it) );
+    ASSERT_EQ( handle, *it );
+    ASSERT_LT( handle, n.size() );
+    seen[handle] = true;
+  }
+  ASSERT_EQ( std::count(seen.begin(), seen.end(), true), n.size() );
+  ASSERT_EQ( n.id_table().size(), n.size() );
+  ASSERT_EQ( n.get_handle("cat-42"), IdTable::npos );
+  ASSERT_TRUE( n.get_origination_ids("cat-42").empty() );
+
+  NetworkIndexT origins = n.get_origination_handles( n.get_handle("nex-1") );
+  ASSERT_EQ( origins.size(), 3 );
+  for(const auto& handle : origins)
+  {
+    NetworkIndexT destinations = n.get_destination_handles(handle);
+    ASSERT_EQ( destinations.size(), 1 );
+    ASSERT_EQ( n.get_id(destinations[0]), "nex-1" );
+  }
+}
+
+TEST_F(Network_Test2, test_reach_groups)
+{
+  //The confluences at nex-0 and nex-1 break the network into groups; only nex-0 -> cat-2 is a chain
+  const std::vector<NetworkIndexT>& groups = n.reach_groups();
+  ASSERT_EQ( groups.size(), 6 );
+  std::map<std::string, std::size_t> group_of;
+  std::size_t features = 0;
+  for(std::size_t g = 0; g < groups.size(); ++g)
+  {
+    for(const auto& handle : groups[g])
+    {
+      ASSERT_EQ( n.reach_group_of(handle), g );
+      group_of[n.get_id(handle)] = g;
+      ++features;
+    }
+  }
+  ASSERT_EQ( features, n.size() );
+
+  const NetworkIndexT& chain = groups[group_of["nex-0"]];
+  ASSERT_EQ( chain.size(), 2 );
+  ASSERT_EQ( n.get_id(chain[0]), "nex-0" );
+  ASSERT_EQ( n.get_id(chain[1]), "cat-2" );
+  ASSERT_EQ( groups[group_of["nex-1"]].size(), 1 );
+
+  //Groups come after the groups they take flow from
+  ASSERT_LT( group_of["cat-0"], group_of["nex-0"] );
+  ASSERT_LT( group_of["cat-1"], group_of["nex-0"] );
+  ASSERT_LT( group_of["cat-2"], group_of["nex-1"] );
+  ASSERT_LT( group_of["cat-4"], group_of["nex-1"] );
+
+}
+
+TEST_F(Network_TestPath, test_reach_groups_path)
+{
+  //An unbranched path is a single group, upstream first
+  ASSERT_EQ( n.reach_groups().size(), 1 );
+  std::vector<std::string> ids;
+  for(const auto& handle : n.reach_groups()[0])
+  {
+    ids.push_back(n.get_id(handle));
+  }
+  ASSERT_EQ( ids, std::vector<std::string>({"cat-a", "nex-a", "cat-b", "nex-b"}) );
+}
+
 TEST_F(Network_Test2, test_catchments_filter)
 {
   //This order IS IMPORTANT, it should be the topological order of catchments.  Note that the order isn't
@@ -324,6 +435,63 @@ TEST_F(Network_Test2, test_nexus_filter)
   }
 }
 
+TEST_F(Network_Test2, test_filter_cached)
+{
+  //The typed lists are built once, and the handles line up with the ids
+  const std::vector<std::string>& catchments = n.filter("cat");
+  ASSERT_EQ( &catchments, &n.filter("cat") );
+  ASSERT_EQ( catchments.size(), 5 );
+  const NetworkIndexT& handles = n.filter_handles("cat");
+  ASSERT_EQ( handles.size(), catchments.size() );
+  for(std::size_t i = 0; i < handles.size(); ++i)
+  {
+    ASSERT_EQ( n.get_id(handles[i]), catchments[i] );
+  }
+
+  const std::vector<std::string>& preorder = n.filter("cat", network::SortOrder::TransposedDepthFirstPreorder);
+  ASSERT_EQ( &preorder, &n.filter("cat", network::SortOrder::TransposedDepthFirstPreorder) );
+  ASSERT_TRUE( std::is_permutation(preorder.begin(), preorder.end(), catchments.begin()) );
+}
+
+TEST_F(Network_Test2, test_filter_concurrent)
+{
+  //Threads first requesting the same and different lists at once each get the one list built for each
+  const std::vector<std::pair<std::string, network::SortOrder>> requests = {
+    {"cat", network::SortOrder::TransposedDepthFirstPreorder},
+    {"nex", network::SortOrder::TransposedDepthFirstPreorder},
+    {"wb", network::SortOrder::Topological},
+    {"cat", network::SortOrder::Topological}
+  };
+  const int thread_count = 8;
+  std::vector<std::vector<const std::vector<std::string>*>> found(thread_count);
+  std::atomic<int> waiting(thread_count);
+  std::vector<std::thread> threads;
+  for( int i = 0; i < thread_count; ++i ){
+    threads.emplace_back([&, i]() {
+      --waiting;
+      while( waiting.load() > 0 ){}
+      for( std::size_t r = 0; r < requests.size(); ++r ){
+        const auto& request = requests[(r + i) % requests.size()];
+        found[i].push_back(&n.filter(request.first, request.second));
+        n.filter_handles(request.first, request.second);
+      }
+    });
+  }
+  for( auto& t : threads ) t.join();
+
+  for( int i = 0; i < thread_count; ++i ){
+    for( std::size_t r = 0; r < requests.size(); ++r ){
+      const auto& request = requests[(r + i) % requests.size()];
+      ASSERT_EQ( found[i][r], &n.filter(request.first, request.second) );
+    }
+  }
+  ASSERT_EQ( n.filter("cat", network::SortOrder::TransposedDepthFirstPreorder).size(), 5 );
+  ASSERT_TRUE( std::is_permutation(n.filter("nex", network::SortOrder::TransposedDepthFirstPreorder).begin(),
+                                   n.filter("nex", network::SortOrder::TransposedDepthFirstPreorder).end(),
+                                   n.filter("nex").begin()) );
+  ASSERT_TRUE( n.filter("wb").empty() );
+}
+
 TEST_F(Network_Test2, test_bad_filter)
 {
   //Test a bad prefix gives no results
@@ -355,3 +523,342 @@ TEST_F(Network_Test2, test_dfr_filter)
   //ASSERT_FALSE( std::distance(cat0_it, cat2_it) > 0 );
 }
 
+
+TEST_F(Network_Test2, test_wavefront_dependencies)
+{
+  //Drain the schedule serially, checking the dependency order of every executed task
+  const long steps = 5;
+  const long lookahead = 2;
+  WavefrontScheduler scheduler(n, steps, lookahead);
+  ASSERT_EQ( scheduler.catchment_ids().size(), 5 );
+  ASSERT_EQ( scheduler.nexus_ids().size(), 2 );
+
+  std::map<std::string, long> done;
+  long executed = 0;
+  WavefrontScheduler::Task task;
+  while( scheduler.acquire(task) )
+  {
+    std::string id;
+    if( task.kind == WavefrontScheduler::CATCHMENT ){
+      id = scheduler.catchment_ids()[task.index];
+      //cat-2 is downstream of cat-0 and cat-1 (through nex-0)
+      if( id == "cat-2" ){
+        ASSERT_TRUE( done["cat-0"] > task.time_step );
+        ASSERT_TRUE( done["cat-1"] > task.time_step );
+      }
+    }
+    else {
+      id = scheduler.nexus_ids()[task.index];
+      for( auto c : scheduler.nexus_contributors(task.index) ){
+        ASSERT_TRUE( done[scheduler.catchment_ids()[c]] > task.time_step );
+      }
+    }
+    //Each feature runs its time steps in order
+    ASSERT_EQ( done[id], task.time_step );
+    //Nothing runs further ahead than the window allows
+    for( const auto& feature : done ){
+      ASSERT_TRUE( task.time_step - feature.second <= lookahead + 1 );
+    }
+    done[id] = task.time_step + 1;
+    scheduler.complete(task);
+    ++executed;
+  }
+  ASSERT_EQ( executed, 7 * steps );
+  for( const auto& feature : done ){
+    ASSERT_EQ( feature.second, steps );
+  }
+}
+
+TEST_F(Network_Test2, test_wavefront_threads)
+{
+  //Drain the schedule from several threads, and ensure each task executes exactly once
+  const long steps = 50;
+  WavefrontScheduler scheduler(n, steps, 3);
+  std::vector<std::atomic<long>> catchment_counts(scheduler.catchment_ids().size());
+  std::vector<std::atomic<long>> nexus_counts(scheduler.nexus_ids().size());
+  for( auto& c : catchment_counts ) c.store(0);
+  for( auto& c : nexus_counts ) c.store(0);
+
+  auto worker = [&]() {
+    WavefrontScheduler::Task task;
+    while( scheduler.acquire(task) ){
+      if( task.kind == WavefrontScheduler::CATCHMENT ) catchment_counts[task.index]++;
+      else nexus_counts[task.index]++;
+      scheduler.complete(task);
+    }
+  };
+  std::vector<std::thread> threads;
+  for( int i = 0; i < 4; ++i ) threads.emplace_back(worker);
+  for( auto& t : threads ) t.join();
+
+  for( auto& c : catchment_counts ) ASSERT_EQ( c.load(), steps );
+  for( auto& c : nexus_counts ) ASSERT_EQ( c.load(), steps );
+}
+
+TEST_F(Network_Test2, test_wavefront_readiness)
+{
+  //Catchment steps whose inputs are not ready on the first check are set aside, while other work runs
+  const long steps = 20;
+  WavefrontScheduler scheduler(n, steps, 2);
+  std::mutex checked_mutex;
+  std::set<std::pair<std::size_t, long>> checked;
+  scheduler.set_readiness_check([&](const WavefrontScheduler::Task& task) {
+    if( task.kind != WavefrontScheduler::CATCHMENT ) return true;
+    std::lock_guard<std::mutex> lock(checked_mutex);
+    return !checked.insert(std::make_pair(task.index, task.time_step)).second;
+  }, std::chrono::microseconds(100));
+  std::vector<std::atomic<long>> catchment_next(scheduler.catchment_ids().size());
+  std::vector<std::atomic<long>> nexus_counts(scheduler.nexus_ids().size());
+  for( auto& c : catchment_next ) c.store(0);
+  for( auto& c : nexus_counts ) c.store(0);
+  std::atomic<bool> in_order(true);
+
+  auto worker = [&]() {
+    WavefrontScheduler::Task task;
+    while( scheduler.acquire(task) ){
+      if( task.kind == WavefrontScheduler::CATCHMENT ){
+        if( catchment_next[task.index].fetch_add(1) != task.time_step ) in_order = false;
+      }
+      else nexus_counts[task.index]++;
+      scheduler.complete(task);
+    }
+  };
+  std::vector<std::thread> threads;
+  for( int i = 0; i < 3; ++i ) threads.emplace_back(worker);
+  for( auto& t : threads ) t.join();
+
+  ASSERT_TRUE( in_order.load() );
+  ASSERT_EQ( checked.size(), 5 * steps );
+  for( auto& c : catchment_next ) ASSERT_EQ( c.load(), steps );
+  for( auto& c : nexus_counts ) ASSERT_EQ( c.load(), steps );
+}
+
+TEST_F(Network_Test2, test_wavefront_readiness_timeout)
+{
+  //Tasks whose inputs never become ready are released once they have waited long enough
+  const long steps = 3;
+  WavefrontScheduler scheduler(n, steps, 1);
+  scheduler.set_readiness_check([](const WavefrontScheduler::Task&) { return false; },
+                                std::chrono::microseconds(50), std::chrono::microseconds(200));
+  long executed = 0;
+  WavefrontScheduler::Task task;
+  while( scheduler.acquire(task) ){
+    scheduler.complete(task);
+    ++executed;
+  }
+  ASSERT_EQ( executed, 7 * steps );
+}
+
+TEST_F(Network_Test2, test_partitioner_graph)
+{
+  MultilevelPartitioner partitioner(n, {{"cat-2", 3.0}});
+  const MultilevelPartitioner::Graph& graph = partitioner.get_graph();
+  ASSERT_EQ( partitioner.catchment_ids().size(), 5 );
+  ASSERT_EQ( graph.size(), 5 );
+  //cat-0 and cat-1 flow into cat-2, and cat-2, cat-3 and cat-4 share the terminal nex-1
+  ASSERT_EQ( graph.adjncy.size(), 8 );
+
+  std::vector<int> parts = partitioner.partition(2);
+  ASSERT_EQ( parts.size(), 5 );
+  std::vector<double> weights = MultilevelPartitioner::partition_weights(graph, parts, 2);
+  ASSERT_GT( weights[0], 0 );
+  ASSERT_GT( weights[1], 0 );
+  ASSERT_DOUBLE_EQ( weights[0] + weights[1], 7.0 );
+  //Any split of this network makes at least one, and at most both, nexuses remote
+  ASSERT_GE( partitioner.count_boundary_nexuses(parts), 1 );
+  ASSERT_LE( partitioner.count_boundary_nexuses(parts), 2 );
+  ASSERT_EQ( partitioner.count_boundary_nexuses(std::vector<int>(5, 0)), 0 );
+
+  ASSERT_THROW( partitioner.partition(6), std::invalid_argument );
+  ASSERT_THROW( MultilevelPartitioner(n, {{"cat-2", 0.0}}), std::invalid_argument );
+}
+
+TEST_F(Network_Test2, test_partitioner_order_edges)
+{
+  MultilevelPartitioner partitioner(n);
+  const MultilevelPartitioner::Graph& graph = partitioner.get_graph();
+  std::size_t arcs = graph.adjncy.size();
+  double arc_weight = std::accumulate(graph.adjwgt.begin(), graph.adjwgt.end(), 0.0);
+  //cat-0 and cat-1 are not yet connected; ids that are not partitioned are skipped, and the two pairs of cat-0 and
+  //cat-1 merge into one edge
+  std::vector<std::string> order = {"cat-0", "cat-1", "cat-99", "cat-0"};
+  partitioner.add_order_edges(order);
+  ASSERT_EQ( graph.adjncy.size(), arcs + 2 );
+  ASSERT_DOUBLE_EQ( std::accumulate(graph.adjwgt.begin(), graph.adjwgt.end(), 0.0), arc_weight + 2.0 );
+  ASSERT_EQ( graph.xadj.back(), graph.adjncy.size() );
+
+  const std::vector<std::string>& ids = partitioner.catchment_ids();
+  std::vector<int> parts(ids.size(), 0);
+  ASSERT_EQ( partitioner.count_order_runs(parts, order), 1 );
+  parts[std::find(ids.begin(), ids.end(), "cat-1") - ids.begin()] = 1;
+  ASSERT_EQ( partitioner.count_order_runs(parts, order), 3 );
+
+  ASSERT_THROW( partitioner.add_order_edges(order, 0.0), std::invalid_argument );
+}
+
+TEST_F(Network_Test2, test_partitioner_weighted_chain)
+{
+  //A long chain of catchments, the first quarter of which are 10x as costly as the rest
+  const std::size_t length = 4000;
+  const int num_partitions = 8;
+  MultilevelPartitioner::Graph graph;
+  graph.xadj.push_back(0);
+  for( std::size_t v = 0; v < length; ++v ){
+    if( v > 0 ){
+      graph.adjncy.push_back(v - 1);
+      graph.adjwgt.push_back(1.0);
+    }
+    if( v + 1 < length ){
+      graph.adjncy.push_back(v + 1);
+      graph.adjwgt.push_back(1.0);
+    }
+    graph.xadj.push_back(graph.adjncy.size());
+    graph.vwgt.push_back(v < length / 4 ? 10.0 : 1.0);
+  }
+
+  std::vector<int> parts = MultilevelPartitioner::partition_graph(graph, num_partitions, 0.05);
+  std::vector<double> weights = MultilevelPartitioner::partition_weights(graph, parts, num_partitions);
+  double average = (length / 4 * 10.0 + length * 3 / 4) / num_partitions;
+  for( double w : weights ){
+    ASSERT_LE( w, average * 1.05 );
+    ASSERT_GT( w, 0 );
+  }
+  //Cutting a chain into 8 contiguous pieces cuts 7 edges; allow some slack for the heuristics
+  ASSERT_LE( MultilevelPartitioner::edge_cut(graph, parts), 3 * (num_partitions - 1) );
+  //The result is deterministic
+  ASSERT_EQ( parts, MultilevelPartitioner::partition_graph(graph, num_partitions, 0.05) );
+}
+
+TEST_F(Network_Test2, test_partitioner_hierarchical)
+{
+  MultilevelPartitioner partitioner(n);
+  //Two nodes of two partitions each, numbered by node
+  std::vector<int> parts = partitioner.partition_hierarchical(2, 2, 0.5);
+  ASSERT_EQ( parts.size(), 5 );
+  std::vector<int> counts(4, 0);
+  for( int p : parts ){
+    ASSERT_GE( p, 0 );
+    ASSERT_LT( p, 4 );
+    counts[p]++;
+  }
+  for( int c : counts ) ASSERT_GT( c, 0 );
+  //The nodes are partitioned as if by one level, so cut the network no more than it
+  std::vector<int> nodes(parts.size());
+  std::transform(parts.begin(), parts.end(), nodes.begin(), [](int p) { return p / 2; });
+  ASSERT_EQ( partitioner.count_boundary_nexuses(nodes), partitioner.count_boundary_nexuses(partitioner.partition(2, 0.5)) );
+  ASSERT_LE( partitioner.count_boundary_nexuses(nodes), partitioner.count_boundary_nexuses(parts) );
+
+  ASSERT_THROW( partitioner.partition_hierarchical(2, 0), std::invalid_argument );
+  ASSERT_THROW( partitioner.partition_hierarchical(2, 3), std::invalid_argument );
+}
+
+TEST_F(Network_Test2, test_partitioner_place_on_nodes)
+{
+  //Two rings of 4 partitions, interleaved in partition order, are placed on a node each
+  std::vector<std::pair<std::size_t, std::size_t>> links;
+  for( std::size_t i = 0; i < 4; ++i ){
+    for( int k = 0; k < 3; ++k ){
+      links.emplace_back(2 * i, 2 * ((i + 1) % 4));
+      links.emplace_back(2 * i + 1, 2 * ((i + 1) % 4) + 1);
+    }
+  }
+  //...with a single connection between them
+  links.emplace_back(0, 1);
+  std::vector<int> ranks = MultilevelPartitioner::place_on_nodes(8, links, 4);
+  ASSERT_EQ( ranks.size(), 8 );
+  std::vector<int> sorted = ranks;
+  std::sort(sorted.begin(), sorted.end());
+  for( int r = 0; r < 8; ++r ) ASSERT_EQ( sorted[r], r );
+  for( std::size_t p = 0; p < 8; ++p ){
+    ASSERT_EQ( ranks[p] / 4, ranks[p % 2] / 4 );
+  }
+  //Partitions keep their order within a node
+  ASSERT_LT( ranks[0], ranks[2] );
+  ASSERT_LT( ranks[2], ranks[4] );
+
+  //A last node may hold fewer partitions, and a single node keeps every partition in place
+  ranks = MultilevelPartitioner::place_on_nodes(5, {{0, 4}, {0, 4}, {1, 2}}, 2);
+  ASSERT_EQ( ranks[0] / 2, ranks[4] / 2 );
+  ASSERT_EQ( ranks[1] / 2, ranks[2] / 2 );
+  ASSERT_EQ( MultilevelPartitioner::place_on_nodes(3, {{0, 2}}, 4), (std::vector<int>{0, 1, 2}) );
+
+  ASSERT_THROW( MultilevelPartitioner::place_on_nodes(3, {}, 0), std::invalid_argument );
+  ASSERT_THROW( MultilevelPartitioner::place_on_nodes(3, {{0, 3}}, 2), std::invalid_argument );
+}
+
+TEST_F(Network_Test2, test_channel_routing_levels)
+{
+  ChannelRouting routing(n, [](const std::string&) {
+    return muskingum_cunge::channel_params{2000.0, 0.002, 0.05, 5.0, 1.0};
+  });
+  ASSERT_EQ( routing.catchment_ids().size(), 5 );
+  ASSERT_EQ( routing.num_levels(), 2 );
+  //cat-2 is downstream of cat-0 and cat-1, so is routed after every headwater
+  ASSERT_EQ( routing.reach_index("cat-2"), 4 );
+  ASSERT_THROW( routing.reach_index("cat-9"), std::invalid_argument );
+  ASSERT_THROW( routing.route(std::vector<double>(4, 0.0), 3600.0), std::invalid_argument );
+}
+
+TEST_F(Network_Test2, test_channel_routing_steady_and_pulse)
+{
+  ChannelRouting routing(n, [](const std::string&) {
+    return muskingum_cunge::channel_params{5000.0, 0.001, 0.05, 5.0, 1.0};
+  }, 6);
+  std::size_t outlet = routing.nexus_index("nex-1");
+
+  //A steady lateral inflow comes out of the outlet in full
+  std::vector<double> lateral(5, 2.0);
+  for( int t = 0; t < 200; ++t ){
+    routing.route(lateral, 3600.0);
+  }
+  ASSERT_NEAR( routing.nexus_flow(outlet), 10.0, 1.0e-6 );
+  ASSERT_NEAR( routing.nexus_flow(routing.nexus_index("nex-0")), 4.0, 1.0e-6 );
+
+  //A pulse into a headwater, over a base flow, reaches the outlet later and attenuated, with its volume kept
+  std::size_t headwater = routing.reach_index("cat-0");
+  for( int t = 0; t < 100; ++t ){
+    routing.route(lateral, 3600.0);
+  }
+  double peak = 0.0, volume = 0.0;
+  int peak_step = 0;
+  for( int t = 0; t < 500; ++t ){
+    lateral[headwater] = t < 2 ? 52.0 : 2.0;
+    routing.route(lateral, 600.0);
+    double excess = routing.nexus_flow(outlet) - 10.0;
+    if( excess > peak ){
+      peak = excess;
+      peak_step = t;
+    }
+    volume += excess * 600.0;
+  }
+  ASSERT_LT( peak, 50.0 );
+  ASSERT_GT( peak_step, 1 );
+  ASSERT_NEAR( volume, 50.0 * 1200.0, 0.01 * 50.0 * 1200.0 );
+}
+
+TEST_F(Network_Test2, test_channel_routing_threads_and_state)
+{
+  auto params = [](const std::string& id) {
+    return muskingum_cunge::channel_params{1000.0 + 100.0 * id.back(), 0.002, 0.04, 4.0, 2.0};
+  };
+  ChannelRouting serial(n, params, 3);
+  ChannelRouting threaded(n, params, 3);
+  utils::ThreadPool pool(4);
+  std::vector<double> lateral = {1.0, 2.0, 3.0, 4.0, 5.0};
+  for( int t = 0; t < 10; ++t ){
+    serial.route(lateral, 3600.0);
+    threaded.route(lateral, 3600.0, &pool);
+  }
+  utils::StateWriter out;
+  serial.save_state(out);
+  ChannelRouting restored(n, params, 3);
+  utils::StateReader in(out.get_bytes());
+  restored.load_state(in);
+  serial.route(lateral, 3600.0);
+  threaded.route(lateral, 3600.0, &pool);
+  restored.route(lateral, 3600.0);
+  for( std::size_t r = 0; r < lateral.size(); ++r ){
+    ASSERT_EQ( serial.outflow(r), threaded.outflow(r) );
+    ASSERT_EQ( serial.outflow(r), restored.outflow(r) );
+  }
+}
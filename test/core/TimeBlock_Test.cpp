@@ -0,0 +1,138 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "core/TimeBlock.hpp"
+#include "core/nexus/HY_PointHydroNexus.hpp"
+
+namespace {
+    //! A linear reservoir per catchment, whose outflow depends on the state left by its earlier time steps.
+    struct TestCatchments {
+        explicit TestCatchments(std::size_t count) : storage(count, 1.0), outputs(count) {}
+
+        double run(std::size_t i, int t)
+        {
+            storage[i] += 0.5 * (i + 1) + (t % 3);
+            double outflow = 0.2 * storage[i];
+            storage[i] -= outflow;
+            outputs[i].push_back(outflow);
+            return outflow;
+        }
+
+        std::vector<double> storage;
+        //! The output each catchment wrote, in the order it wrote it.
+        std::vector<std::vector<double>> outputs;
+    };
+
+    //! The outputs of a run of three catchments into two nexuses, as NGen gives the catchment flows to them.
+    struct RunResult {
+        std::vector<std::vector<double>> catchment_outputs;
+        std::vector<std::vector<double>> nexus_flows;
+        //! The catchment storage at each checkpoint, i.e., the state that would be saved there.
+        std::vector<std::vector<double>> checkpoint_states;
+        //! The first and end time step of each block run.
+        std::vector<std::pair<int, int>> blocks;
+    };
+
+    /**
+     * Run time steps @p first up to @p last, one step at a time if @p time_block is 1, else in blocks of it, as
+     * run_time_steps of NGen.cpp does.
+     */
+    RunResult run(int first, int last, long time_block, long checkpoint_interval)
+    {
+        const std::vector<std::string> catchment_ids = {"cat-0", "cat-1", "cat-2"};
+        const std::vector<std::size_t> downstream = {0, 0, 1};
+        std::vector<std::shared_ptr<HY_PointHydroNexus>> nexuses = {
+            std::make_shared<HY_PointHydroNexus>("nex-0", HY_PointHydroNexus::Catchments{"cat-3"},
+                                                 HY_PointHydroNexus::Catchments{"cat-0", "cat-1"}),
+            std::make_shared<HY_PointHydroNexus>("nex-1", HY_PointHydroNexus::Catchments{"cat-3"},
+                                                 HY_PointHydroNexus::Catchments{"cat-2"})
+        };
+        TestCatchments catchments(catchment_ids.size());
+        RunResult result;
+        result.nexus_flows.resize(nexuses.size());
+        std::vector<double> catchment_flows(catchment_ids.size());
+
+        ngen::TimeBlock block_flows(time_block > 1 ? catchment_ids.size() : 0, time_block, checkpoint_interval);
+        block_flows.reset(first);
+        for (int t = first; t < last; ++t) {
+            if (checkpoint_interval > 0 && t > first && t % checkpoint_interval == 0) {
+                result.checkpoint_states.push_back(catchments.storage);
+            }
+            if (time_block > 1) {
+                if (block_flows.is_due(t)) {
+                    block_flows.start(t, last);
+                    result.blocks.emplace_back(block_flows.get_start(), block_flows.get_end());
+                    for (std::size_t i = 0; i < catchment_ids.size(); ++i) {
+                        for (int s = block_flows.get_start(); s < block_flows.get_end(); ++s) {
+                            block_flows.flow(i, s) = catchments.run(i, s);
+                        }
+                    }
+                }
+                for (std::size_t i = 0; i < catchment_ids.size(); ++i) {
+                    catchment_flows[i] = block_flows.flow(i, t);
+                }
+            }
+            else {
+                for (std::size_t i = 0; i < catchment_ids.size(); ++i) {
+                    catchment_flows[i] = catchments.run(i, t);
+                }
+            }
+            for (std::size_t i = 0; i < catchment_ids.size(); ++i) {
+                nexuses[downstream[i]]->add_upstream_flow(catchment_flows[i], catchment_ids[i], t);
+            }
+            for (std::size_t n = 0; n < nexuses.size(); ++n) {
+                result.nexus_flows[n].push_back(nexuses[n]->get_downstream_flow("cat-3", t, 100.0));
+            }
+        }
+        result.catchment_outputs = catchments.outputs;
+        return result;
+    }
+
+    void expect_same_outputs(const RunResult& blocked, const RunResult& per_step)
+    {
+        ASSERT_EQ(blocked.catchment_outputs, per_step.catchment_outputs);
+        ASSERT_EQ(blocked.nexus_flows, per_step.nexus_flows);
+        ASSERT_EQ(blocked.checkpoint_states, per_step.checkpoint_states);
+    }
+}
+
+//! Test that running the catchments in blocks gives the per-step outputs, when the run ends within a block.
+TEST(TimeBlockTest, TestBlocksMatchPerStep)
+{
+    RunResult per_step = run(0, 10, 1, 0);
+    RunResult blocked = run(0, 10, 4, 0);
+
+    expect_same_outputs(blocked, per_step);
+    std::vector<std::pair<int, int>> expected = {{0, 4}, {4, 8}, {8, 10}};
+    ASSERT_EQ(blocked.blocks, expected);
+}
+
+//! Test that blocks end at each checkpoint, so the state saved there is that of the per-step run.
+TEST(TimeBlockTest, TestBlocksEndAtCheckpoints)
+{
+    RunResult per_step = run(0, 10, 1, 3);
+    RunResult blocked = run(0, 10, 4, 3);
+
+    expect_same_outputs(blocked, per_step);
+    ASSERT_EQ(blocked.checkpoint_states.size(), 3);
+    std::vector<std::pair<int, int>> expected = {{0, 3}, {3, 6}, {6, 9}, {9, 10}};
+    ASSERT_EQ(blocked.blocks, expected);
+}
+
+//! Test blocks of a run restarted at a later time step, and of one longer than the run.
+TEST(TimeBlockTest, TestBlocksOfRestartedRun)
+{
+    RunResult per_step = run(5, 12, 1, 0);
+    RunResult blocked = run(5, 12, 3, 0);
+    expect_same_outputs(blocked, per_step);
+    std::vector<std::pair<int, int>> expected = {{5, 8}, {8, 11}, {11, 12}};
+    ASSERT_EQ(blocked.blocks, expected);
+
+    RunResult single_block = run(5, 12, 20, 0);
+    expect_same_outputs(single_block, per_step);
+    expected = {{5, 12}};
+    ASSERT_EQ(single_block.blocks, expected);
+}
@@ -0,0 +1,93 @@
+#include "gtest/gtest.h"
+
+#include "CatchmentOutputAggregator.hpp"
+
+#include <string>
+#include <vector>
+
+using namespace catchment_output;
+
+class CatchmentOutputAggregator_Test : public ::testing::Test {
+
+protected:
+
+    void SetUp() override;
+
+    void TearDown() override;
+
+    std::vector<std::string> catchment_ids;
+    std::vector<std::vector<std::string>> variable_names;
+
+};
+
+void CatchmentOutputAggregator_Test::SetUp() {
+    catchment_ids = {"cat-1", "cat-2"};
+    variable_names = {{"RAIN_RATE", "Q_OUT", "SOIL_STORAGE"}, {"Q_OUT"}};
+}
+
+void CatchmentOutputAggregator_Test::TearDown() {
+
+}
+
+// Make sure the selected variables are aggregated each with its own method, over each period of time steps.
+TEST_F(CatchmentOutputAggregator_Test, TestAggregatePeriods) {
+    CatchmentOutputAggregator::variables_t variables = {
+            {"Q_OUT", "mean"}, {"RAIN_RATE", "sum"}, {"SOIL_STORAGE", "instantaneous"}, {"ET", "max"}};
+    CatchmentOutputAggregator aggregator(catchment_ids, variable_names, {1, 1}, variables, 4);
+
+    ASSERT_EQ(aggregator.get_variable_names("cat-1"), std::vector<std::string>({"Q_OUT", "RAIN_RATE", "SOIL_STORAGE"}));
+    ASSERT_EQ(aggregator.get_variable_names("cat-2"), std::vector<std::string>({"Q_OUT"}));
+
+    long period_time_index;
+    std::vector<double> period_values;
+    for (long t = 0; t < 8; ++t) {
+        bool complete = aggregator.add("cat-1", t, {1.0 * t, 10.0 * t, 100.0 * t}, period_time_index, period_values);
+        ASSERT_EQ(complete, t % 4 == 3);
+        if (complete) {
+            long first = t - 3;
+            EXPECT_EQ(period_time_index, first);
+            ASSERT_EQ(period_values.size(), 3u);
+            EXPECT_DOUBLE_EQ(period_values[0], 10.0 * (first + 1.5));
+            EXPECT_DOUBLE_EQ(period_values[1], 1.0 * (4 * first + 6));
+            EXPECT_DOUBLE_EQ(period_values[2], 100.0 * t);
+        }
+    }
+    EXPECT_FALSE(aggregator.flush("cat-1", period_time_index, period_values));
+}
+
+// Make sure every variable is kept when none are selected, and an incomplete period is written on flush.
+TEST_F(CatchmentOutputAggregator_Test, TestFlushIncompletePeriod) {
+    CatchmentOutputAggregator aggregator(catchment_ids, variable_names, {1, 1},
+                                         CatchmentOutputAggregator::variables_t(), 24, "min");
+    ASSERT_EQ(aggregator.get_variable_names("cat-1"), variable_names[0]);
+
+    long period_time_index;
+    std::vector<double> period_values;
+    ASSERT_FALSE(aggregator.add("cat-2", 24, {5.0}, period_time_index, period_values));
+    ASSERT_FALSE(aggregator.add("cat-2", 25, {3.0}, period_time_index, period_values));
+    ASSERT_FALSE(aggregator.add("cat-2", 26, {4.0}, period_time_index, period_values));
+    ASSERT_TRUE(aggregator.flush("cat-2", period_time_index, period_values));
+    EXPECT_EQ(period_time_index, 24);
+    EXPECT_EQ(period_values, std::vector<double>({3.0}));
+    EXPECT_FALSE(aggregator.flush("cat-2", period_time_index, period_values));
+}
+
+// Make sure a catchment with rows several time steps apart completes each period at its last row.
+TEST_F(CatchmentOutputAggregator_Test, TestRowSpacing) {
+    CatchmentOutputAggregator aggregator(catchment_ids, variable_names, {1, 3},
+                                         CatchmentOutputAggregator::variables_t({{"Q_OUT", "mean"}}), 6);
+    long period_time_index;
+    std::vector<double> period_values;
+    ASSERT_FALSE(aggregator.add("cat-2", 0, {2.0}, period_time_index, period_values));
+    ASSERT_TRUE(aggregator.add("cat-2", 3, {4.0}, period_time_index, period_values));
+    EXPECT_EQ(period_time_index, 0);
+    EXPECT_EQ(period_values, std::vector<double>({3.0}));
+}
+
+// Make sure the header of a catchment only has its selected variables.
+TEST_F(CatchmentOutputAggregator_Test, TestSelectHeader) {
+    CatchmentOutputAggregator::variables_t variables = {{"Q_OUT", "mean"}, {"RAIN_RATE", "sum"}};
+    EXPECT_EQ(CatchmentOutputAggregator::select_header(variables, "RAIN_RATE,Q_OUT,SOIL_STORAGE"), "Q_OUT,RAIN_RATE");
+    EXPECT_EQ(CatchmentOutputAggregator::select_header(CatchmentOutputAggregator::variables_t(), "A,B"), "A,B");
+    EXPECT_THROW(CatchmentOutputAggregator::parse_method("median"), std::invalid_argument);
+}
@@ -0,0 +1,176 @@
+#include "gtest/gtest.h"
+
+#include "CatchmentOutputWriter.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace catchment_output;
+
+class CatchmentOutputWriter_Test : public ::testing::Test {
+
+protected:
+
+    void SetUp() override;
+
+    void TearDown() override;
+
+    template<typename T>
+    static T read_value(std::ifstream& input);
+
+    static std::string read_string(std::ifstream& input);
+
+    std::vector<std::string> catchment_ids;
+    std::vector<std::vector<std::string>> variable_names;
+    std::string path;
+
+};
+
+void CatchmentOutputWriter_Test::SetUp() {
+    catchment_ids = {"cat-1", "cat-2"};
+    variable_names = {{"RAIN_RATE", "Q_OUT"}, {"Q_OUT"}};
+    path = "./catchment_output_test.bin";
+}
+
+void CatchmentOutputWriter_Test::TearDown() {
+    std::remove(path.c_str());
+}
+
+template<typename T>
+T CatchmentOutputWriter_Test::read_value(std::ifstream& input) {
+    T value;
+    input.read(reinterpret_cast<char*>(&value), sizeof(T));
+    return value;
+}
+
+std::string CatchmentOutputWriter_Test::read_string(std::ifstream& input) {
+    uint32_t length = read_value<uint32_t>(input);
+    std::string value(length, ' ');
+    input.read(&value[0], length);
+    return value;
+}
+
+TEST_F(CatchmentOutputWriter_Test, TestBinaryLayout) {
+    {
+        // A buffer smaller than a record, so each record is written as it arrives
+        BinaryCatchmentOutputWriter writer(catchment_ids, variable_names, path, 16);
+        for (long t = 0; t < 3; ++t) {
+            writer.write("cat-2", t, 1000 + t * 3600, {t * 10.0});
+            writer.write("cat-1", t, 1000 + t * 3600, {t * 1.0, t * 2.0});
+        }
+        EXPECT_THROW(writer.write("cat-3", 0, 1000, {0.0}), std::invalid_argument);
+        // the destructor writes anything still buffered
+    }
+
+    std::ifstream input(path, std::ios::binary);
+    char magic[8];
+    input.read(magic, 8);
+    ASSERT_EQ(std::string(magic, 8), "NGENCAT1");
+    ASSERT_EQ(read_value<uint64_t>(input), catchment_ids.size());
+    for (std::size_t c = 0; c < catchment_ids.size(); ++c) {
+        ASSERT_EQ(read_string(input), catchment_ids[c]);
+        ASSERT_EQ(read_value<uint32_t>(input), variable_names[c].size());
+        for (const auto& name : variable_names[c]) {
+            ASSERT_EQ(read_string(input), name);
+        }
+    }
+    for (long t = 0; t < 3; ++t) {
+        ASSERT_EQ(read_value<uint32_t>(input), 1u);
+        ASSERT_EQ(read_value<int64_t>(input), t);
+        ASSERT_EQ(read_value<int64_t>(input), 1000 + t * 3600);
+        ASSERT_EQ(read_value<uint32_t>(input), 1u);
+        ASSERT_EQ(read_value<double>(input), t * 10.0);
+
+        ASSERT_EQ(read_value<uint32_t>(input), 0u);
+        ASSERT_EQ(read_value<int64_t>(input), t);
+        ASSERT_EQ(read_value<int64_t>(input), 1000 + t * 3600);
+        ASSERT_EQ(read_value<uint32_t>(input), 2u);
+        ASSERT_EQ(read_value<double>(input), t * 1.0);
+        ASSERT_EQ(read_value<double>(input), t * 2.0);
+    }
+    input.peek();
+    ASSERT_TRUE(input.eof());
+}
+
+TEST_F(CatchmentOutputWriter_Test, TestFlushWritesBufferedRows) {
+    BinaryCatchmentOutputWriter writer(catchment_ids, variable_names, path, 1024 * 1024);
+    std::ifstream::pos_type header_size = std::ifstream(path, std::ios::binary | std::ios::ate).tellg();
+
+    writer.write("cat-1", 0, 0, {1.0, 2.0});
+    ASSERT_EQ(std::ifstream(path, std::ios::binary | std::ios::ate).tellg(), header_size);
+
+    writer.flush();
+    ASSERT_EQ(std::ifstream(path, std::ios::binary | std::ios::ate).tellg(),
+              header_size + std::ifstream::pos_type(4 + 8 + 8 + 4 + 2 * sizeof(double)));
+}
+
+TEST_F(CatchmentOutputWriter_Test, TestStreamFramesMatchFile) {
+    std::string socket_path = "./catchment_output_test.sock";
+    std::vector<std::string> frames;
+    std::thread subscriber([&] {
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        std::strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+        int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        while (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        std::string received;
+        char bytes[4096];
+        ssize_t got;
+        while ((got = ::recv(fd, bytes, sizeof(bytes), 0)) > 0) {
+            received.append(bytes, got);
+        }
+        ::close(fd);
+        for (std::size_t offset = 0; offset + sizeof(uint32_t) <= received.size();) {
+            uint32_t length;
+            std::memcpy(&length, received.data() + offset, sizeof(length));
+            frames.push_back(received.substr(offset + sizeof(length), length));
+            offset += sizeof(length) + length;
+        }
+    });
+    {
+        BinaryCatchmentOutputWriter file_writer(catchment_ids, variable_names, path, 64);
+        StreamCatchmentOutputWriter stream_writer(catchment_ids, variable_names, socket_path, 64, 1);
+        for (long t = 0; t < 3; ++t) {
+            file_writer.write("cat-2", t, 1000 + t * 3600, {t * 10.0});
+            stream_writer.write("cat-2", t, 1000 + t * 3600, {t * 10.0});
+            file_writer.write("cat-1", t, 1000 + t * 3600, {t * 1.0, t * 2.0});
+            stream_writer.write("cat-1", t, 1000 + t * 3600, {t * 1.0, t * 2.0});
+        }
+    }
+    subscriber.join();
+
+    // the greeting is the header of the file, and the frames after it hold the rest
+    ASSERT_GT(frames.size(), 2);
+    std::stringstream file_contents;
+    file_contents << std::ifstream(path, std::ios::binary).rdbuf();
+    std::string streamed;
+    for (const auto& frame : frames) {
+        streamed += frame;
+    }
+    EXPECT_EQ(streamed, file_contents.str());
+    EXPECT_EQ(frames[0].substr(0, 8), "NGENCAT1");
+}
+
+TEST_F(CatchmentOutputWriter_Test, TestParseValues) {
+    std::vector<double> values = BinaryCatchmentOutputWriter::parse_values("1.5,-2e-3,,abc,4");
+    ASSERT_EQ(values.size(), 5u);
+    EXPECT_EQ(values[0], 1.5);
+    EXPECT_EQ(values[1], -2e-3);
+    EXPECT_TRUE(std::isnan(values[2]));
+    EXPECT_TRUE(std::isnan(values[3]));
+    EXPECT_EQ(values[4], 4.0);
+}
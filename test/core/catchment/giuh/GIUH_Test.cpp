@@ -73,6 +73,24 @@ TEST_F(GIUH_Test, TestInit0)
     ASSERT_TRUE(kernel_obj != nullptr);
 }
 
+//! Test that shared readers are shared per pair of files, and find kernels as an unshared reader does.
+TEST_F(GIUH_Test, TestSharedReader0)
+{
+    std::shared_ptr<giuh::GiuhJsonReader> reader = giuh::GiuhJsonReader::get_shared_reader(complete_json_file,
+                                                                                           id_map_json_file);
+    ASSERT_TRUE(reader != nullptr);
+    ASSERT_EQ(reader, giuh::GiuhJsonReader::get_shared_reader(complete_json_file, id_map_json_file));
+    ASSERT_NE(reader, giuh::GiuhJsonReader::get_shared_reader(abridged_json_file, id_map_json_file));
+
+    giuh::GiuhJsonReader unshared_reader(complete_json_file, id_map_json_file);
+    ASSERT_TRUE(reader->is_giuh_kernel_for_id_exists("cat-67"));
+    ASSERT_FALSE(reader->is_giuh_kernel_for_id_exists("cat-does-not-exist"));
+    ASSERT_EQ(reader->extract_cumulative_frequency_ordinates("cat-67"),
+              unshared_reader.extract_cumulative_frequency_ordinates("cat-67"));
+    ASSERT_EQ(reader->get_giuh_kernel_for_id("cat-67")->get_interpolated_regularized_cdf(),
+              unshared_reader.get_giuh_kernel_for_id("cat-67")->get_interpolated_regularized_cdf());
+}
+
 //! Test that giuh_kernel objects output properly.
 TEST_F(GIUH_Test, TestOutput0)
 {
@@ -232,3 +250,64 @@ TEST_F(GIUH_Test, TestOutput2) {
         EXPECT_LE(diff_abs, leaway);
     }
 }
+
+//! Test that a giuh_convolution outputs each input over its ordinates, one interval per step.
+TEST_F(GIUH_Test, TestConvolution0) {
+    giuh::giuh_convolution convolution(std::vector<double>{0.06, 0.51, 0.28, 0.12, 0.03});
+    ASSERT_EQ(convolution.size(), 5);
+
+    std::vector<double> inputs {1.0, 0.0, 2.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    std::vector<double> expected {0.06, 0.51, 0.28 + 0.12, 0.12 + 1.02, 0.03 + 0.56, 0.24, 0.06, 0.0};
+
+    for (unsigned int i = 0; i < inputs.size(); ++i) {
+        convolution.add(inputs[i], 0);
+        EXPECT_NEAR(convolution.release(1), expected[i], 1.0e-12);
+    }
+    EXPECT_NEAR(convolution.get_pending_total(), 0.0, 1.0e-12);
+}
+
+//! Test that a giuh_convolution holds what it has not released, including inputs added from later ordinates.
+TEST_F(GIUH_Test, TestConvolution1) {
+    giuh::giuh_convolution convolution(std::vector<double>{0.06, 0.51, 0.28, 0.12, 0.03});
+
+    convolution.add(1.0, 2);
+    EXPECT_NEAR(convolution.get_pending_total(), 0.43, 1.0e-12);
+    EXPECT_NEAR(convolution.release(1), 0.28, 1.0e-12);
+    convolution.add(1.0, 0);
+    EXPECT_NEAR(convolution.release(2), 0.12 + 0.06 + 0.03 + 0.51, 1.0e-12);
+    // Releasing more intervals than there are ordinates releases everything
+    EXPECT_NEAR(convolution.release(10), 0.28 + 0.12 + 0.03, 1.0e-12);
+    EXPECT_NEAR(convolution.get_pending_total(), 0.0, 1.0e-12);
+}
+
+//! Test that equal ordinate vectors are interned as one, and different ones are not.
+TEST_F(GIUH_Test, TestOrdinateTable0) {
+    giuh::giuh_ordinate_table::ordinates_ptr first = giuh::giuh_ordinate_table::intern({0.06, 0.51, 0.28, 0.12, 0.03});
+    giuh::giuh_ordinate_table::ordinates_ptr second = giuh::giuh_ordinate_table::intern({0.06, 0.51, 0.28, 0.12, 0.03});
+    giuh::giuh_ordinate_table::ordinates_ptr other = giuh::giuh_ordinate_table::intern({0.06, 0.51, 0.28, 0.15});
+    EXPECT_EQ(first, second);
+    EXPECT_NE(first, other);
+    EXPECT_EQ(*other, std::vector<double>({0.06, 0.51, 0.28, 0.15}));
+}
+
+//! Test that kernels of the same CDF share their ordinates, but each convolves its own inputs.
+TEST_F(GIUH_Test, TestSharedOrdinates0) {
+    std::vector<double> cdf_times {0, 3600, 7200, 10800, 14400};
+    std::vector<double> cdf_freqs {0.06, 0.57, 0.85, 0.97, 1.0};
+
+    giuh::giuh_kernel_impl kernel_1("cat-1", "none", cdf_times, cdf_freqs, 3600);
+    giuh::giuh_kernel_impl kernel_2("cat-2", "none", cdf_times, cdf_freqs, 3600);
+    giuh::giuh_kernel_impl unshared("cat-3", "none", cdf_times, cdf_freqs, 1800);
+    EXPECT_EQ(kernel_1.get_convolution_ordinates(), kernel_2.get_convolution_ordinates());
+    EXPECT_NE(kernel_1.get_convolution_ordinates(), unshared.get_convolution_ordinates());
+    EXPECT_EQ(kernel_1.get_interpolated_regularized_cdf(), kernel_2.get_interpolated_regularized_cdf());
+
+    // Changing the regularity of one to that of the other then shares the other's
+    unshared.set_interpolation_regularity_seconds(3600);
+    EXPECT_EQ(kernel_1.get_convolution_ordinates(), unshared.get_convolution_ordinates());
+
+    double first_output = kernel_1.calc_giuh_output(3600, 1.0);
+    EXPECT_NEAR(kernel_2.calc_giuh_output(3600, 0.0), 0.0, 1.0e-12);
+    EXPECT_NEAR(first_output, 0.57, 1.0e-12);
+    EXPECT_NEAR(kernel_1.calc_giuh_output(3600, 0.0) + first_output, 0.85, 1.0e-12);
+}
@@ -61,3 +61,59 @@ TEST_F(UnitsHelper_Test, TestConvertArrayDontModifyInputNoOp){
     ASSERT_EQ( expected,  data2);
     ASSERT_EQ( data.at(2), 3);
 }
+
+TEST_F(UnitsHelper_Test, TestConverterHandle){
+    UnitsHelper::Converter to_mm = UnitsHelper::get_units_converter("m", "mm");
+    ASSERT_FALSE(to_mm.is_identity());
+    ASSERT_NEAR(2500.0, to_mm.convert(2.5), 0.000000001);
+
+    std::vector<double> data = {1,2,3,4};
+    std::vector<double> converted(4);
+    std::vector<double> expected = {1000, 2000, 3000, 4000};
+    to_mm.convert(data.data(), converted.data(), data.size());
+    ASSERT_EQ( expected, converted );
+    ASSERT_EQ( data.at(2), 3);
+    //Convert in place
+    to_mm.convert(data.data(), data.data(), data.size());
+    ASSERT_EQ( expected, data );
+}
+
+TEST_F(UnitsHelper_Test, TestConverterHandleNoOp){
+    UnitsHelper::Converter same = UnitsHelper::get_units_converter("m", "m");
+    ASSERT_TRUE(same.is_identity());
+    ASSERT_TRUE(UnitsHelper::Converter().is_identity());
+
+    std::vector<double> data = {1,2,3,4};
+    std::vector<double> data2 = {2,4,6,8};
+    same.convert(data.data(), data2.data(), data.size());
+    ASSERT_EQ( data, data2 );
+    ASSERT_EQ( 7.0, same.convert(7.0) );
+}
+
+TEST_F(UnitsHelper_Test, TestConverterHandleInvalid){
+    ASSERT_THROW(UnitsHelper::get_units_converter("m", "degC"), std::runtime_error);
+    ASSERT_THROW(UnitsHelper::get_units_converter("", "m"), std::runtime_error);
+    //A failed conversion is not remembered as a valid one
+    ASSERT_THROW(UnitsHelper::get_converted_value("m", 1.0, "degC"), std::runtime_error);
+    ASSERT_THROW(UnitsHelper::get_converted_value("m", 1.0, "degC"), std::runtime_error);
+}
+
+TEST_F(UnitsHelper_Test, TestManyUnitPairs){
+    //More pairs of units than are remembered per thread, alternating, still convert correctly
+    const std::vector<std::string> units = {"m", "mm", "cm", "km", "ft", "in", "s", "min", "h", "d", "degC", "degF", "K"};
+    for(int pass = 0; pass < 3; ++pass){
+        for(const auto& in : units){
+            for(const auto& out : units){
+                double expected;
+                try {
+                    expected = UnitsHelper::get_units_converter(in, out).convert(3.0);
+                }
+                catch (const std::runtime_error& e){
+                    ASSERT_THROW(UnitsHelper::get_converted_value(in, 3.0, out), std::runtime_error);
+                    continue;
+                }
+                ASSERT_NEAR(expected, UnitsHelper::get_converted_value(in, 3.0, out), 0.000000001);
+            }
+        }
+    }
+}
@@ -0,0 +1,437 @@
+#include "gtest/gtest.h"
+
+#include "NexusOutputWriter.hpp"
+#include "MappedNexusOutputWriter.hpp"
+#include "NexusOutputWriterFactory.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace nexus_output;
+
+class NexusOutputWriter_Test : public ::testing::Test {
+
+protected:
+
+    void SetUp() override;
+
+    void TearDown() override;
+
+    std::vector<std::string> read_lines(const std::string& path);
+
+    std::vector<std::string> nexus_ids;
+    std::string path_prefix;
+    std::vector<std::string> created_files;
+
+};
+
+void NexusOutputWriter_Test::SetUp() {
+    nexus_ids = {"nex-1", "nex-2", "nex-3"};
+    path_prefix = "./nexus_output_test_";
+}
+
+void NexusOutputWriter_Test::TearDown() {
+    for (const auto& path : created_files) {
+        std::remove(path.c_str());
+    }
+}
+
+std::vector<std::string> NexusOutputWriter_Test::read_lines(const std::string& path) {
+    std::ifstream input(path);
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(input, line)) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+/**
+ * A small test subclass that just keeps the blocks it is asked to write.
+ */
+class RecordingNexusOutputWriter : public BufferedNexusOutputWriter {
+  public:
+    RecordingNexusOutputWriter(const std::vector<std::string>& ids, std::size_t buffer_steps)
+        : BufferedNexusOutputWriter(ids, buffer_steps) {}
+
+    std::vector<std::vector<long>> blocks;
+    std::vector<std::string> timestamps;
+    std::vector<double> flows;
+
+  protected:
+    void write_block(const std::vector<long>& time_indices, const std::vector<std::string>& block_timestamps,
+                     const std::vector<double>& block_flows) override {
+        blocks.push_back(time_indices);
+        timestamps.insert(timestamps.end(), block_timestamps.begin(), block_timestamps.end());
+        flows.insert(flows.end(), block_flows.begin(), block_flows.end());
+    }
+};
+
+TEST_F(NexusOutputWriter_Test, TestCsvPerNexusRows) {
+    {
+        CsvPerNexusOutputWriter writer(nexus_ids, path_prefix);
+        for (const auto& id : nexus_ids) {
+            created_files.push_back(path_prefix + id + "_output.csv");
+        }
+        writer.write("nex-2", 0, "2015-12-01 00:00:00", 1.5);
+        writer.write("nex-2", 1, "2015-12-01 01:00:00", 2.5);
+        writer.flush();
+    }
+    std::vector<std::string> lines = read_lines(path_prefix + "nex-2_output.csv");
+    ASSERT_EQ(lines.size(), 2);
+    EXPECT_EQ(lines[0], "0, 2015-12-01 00:00:00, 1.5");
+    EXPECT_EQ(lines[1], "1, 2015-12-01 01:00:00, 2.5");
+    EXPECT_TRUE(read_lines(path_prefix + "nex-1_output.csv").empty());
+}
+
+TEST_F(NexusOutputWriter_Test, TestCsvPerNexusBufferedRows) {
+    std::stringstream expected;
+    {
+        // A buffer smaller than some rows, so rows are both gathered and written past it
+        CsvPerNexusOutputWriter writer(nexus_ids, path_prefix, utils::Compression::none, -1, 40);
+        for (const auto& id : nexus_ids) {
+            created_files.push_back(path_prefix + id + "_output.csv");
+        }
+        for (long t = 0; t < 1000; ++t) {
+            writer.write("nex-2", t, "2015-12-01 00:00:00", 0.5 * t);
+            expected << t << ", 2015-12-01 00:00:00, " << 0.5 * t << "\n";
+        }
+    }
+    std::ifstream input(path_prefix + "nex-2_output.csv");
+    std::stringstream text;
+    text << input.rdbuf();
+    EXPECT_EQ(text.str(), expected.str());
+
+    // Rows are held until the buffer fills or the writer is flushed
+    CsvPerNexusOutputWriter writer(nexus_ids, path_prefix, utils::Compression::none, -1, 1024 * 1024);
+    writer.write("nex-2", 0, "2015-12-01 00:00:00", 1.5);
+    EXPECT_TRUE(read_lines(path_prefix + "nex-2_output.csv").empty());
+    writer.flush();
+    std::vector<std::string> lines = read_lines(path_prefix + "nex-2_output.csv");
+    ASSERT_EQ(lines.size(), 1);
+    EXPECT_EQ(lines[0], "0, 2015-12-01 00:00:00, 1.5");
+}
+
+#ifdef NGEN_ZLIB_ACTIVE
+TEST_F(NexusOutputWriter_Test, TestCsvPerNexusGzipRows) {
+    {
+        CsvPerNexusOutputWriter writer(nexus_ids, path_prefix, utils::Compression::gzip, 9);
+        for (const auto& id : nexus_ids) {
+            created_files.push_back(path_prefix + id + "_output.csv.gz");
+        }
+        for (long t = 0; t < 1000; ++t) {
+            writer.write("nex-2", t, "2015-12-01 00:00:00", 0.5 * t);
+        }
+        writer.flush();
+    }
+    gzFile input = gzopen((path_prefix + "nex-2_output.csv.gz").c_str(), "rb");
+    ASSERT_NE(input, nullptr);
+    std::string text;
+    char chunk[4096];
+    int length;
+    while ((length = gzread(input, chunk, sizeof(chunk))) > 0) {
+        text.append(chunk, length);
+    }
+    gzclose(input);
+    std::stringstream expected;
+    for (long t = 0; t < 1000; ++t) {
+        expected << t << ", 2015-12-01 00:00:00, " << 0.5 * t << "\n";
+    }
+    EXPECT_EQ(text, expected.str());
+    // The repeated text compresses to a small part of its size
+    std::ifstream compressed(path_prefix + "nex-2_output.csv.gz", std::ios::binary | std::ios::ate);
+    EXPECT_LT(static_cast<std::size_t>(compressed.tellg()), text.size() / 4);
+}
+#endif
+
+TEST_F(NexusOutputWriter_Test, TestUnknownNexusThrows) {
+    RecordingNexusOutputWriter writer(nexus_ids, 2);
+    EXPECT_THROW(writer.write("nex-9", 0, "", 1.0), std::invalid_argument);
+}
+
+TEST_F(NexusOutputWriter_Test, TestBufferedWritesCompleteSteps) {
+    RecordingNexusOutputWriter writer(nexus_ids, 2);
+    // Step 1 completes before step 0, so nothing can be written until step 0 does
+    for (const auto& id : nexus_ids) {
+        writer.write(id, 1, "t1", 10.0);
+    }
+    writer.write("nex-3", 0, "t0", 3.0);
+    writer.write("nex-1", 0, "t0", 1.0);
+    ASSERT_TRUE(writer.blocks.empty());
+    writer.write("nex-2", 0, "t0", 2.0);
+    ASSERT_EQ(writer.blocks.size(), 1);
+    EXPECT_EQ(writer.blocks[0], std::vector<long>({0, 1}));
+    EXPECT_EQ(writer.timestamps, std::vector<std::string>({"t0", "t1"}));
+    EXPECT_EQ(writer.flows, std::vector<double>({1.0, 2.0, 3.0, 10.0, 10.0, 10.0}));
+
+    // Writing a step that was already written is an error
+    EXPECT_THROW(writer.write("nex-1", 1, "t1", 1.0), std::runtime_error);
+}
+
+TEST_F(NexusOutputWriter_Test, TestBufferedFlushPartial) {
+    RecordingNexusOutputWriter writer(nexus_ids, 10);
+    for (const auto& id : nexus_ids) {
+        writer.write(id, 0, "t0", 1.0);
+    }
+    writer.write("nex-1", 1, "t1", 4.0);
+    ASSERT_TRUE(writer.blocks.empty());
+    writer.flush();
+    ASSERT_EQ(writer.blocks.size(), 1);
+    EXPECT_EQ(writer.blocks[0], std::vector<long>({0, 1}));
+    ASSERT_EQ(writer.flows.size(), 6);
+    EXPECT_EQ(writer.flows[3], 4.0);
+    EXPECT_TRUE(std::isnan(writer.flows[4]));
+    EXPECT_TRUE(std::isnan(writer.flows[5]));
+}
+
+TEST_F(NexusOutputWriter_Test, TestBinaryLayout) {
+    std::string path = path_prefix + "flows.bin";
+    created_files.push_back(path);
+    {
+        BinaryNexusOutputWriter writer(nexus_ids, path, 4);
+        for (long t = 0; t < 3; ++t) {
+            for (std::size_t n = 0; n < nexus_ids.size(); ++n) {
+                writer.write(nexus_ids[n], t, "t" + std::to_string(t), t * 10.0 + n);
+            }
+        }
+        // the destructor writes the remaining buffered steps
+    }
+
+    std::ifstream input(path, std::ios::binary);
+    char magic[8];
+    input.read(magic, 8);
+    ASSERT_EQ(std::string(magic, 8), "NGENNEX1");
+    uint64_t count;
+    input.read(reinterpret_cast<char*>(&count), sizeof(count));
+    ASSERT_EQ(count, nexus_ids.size());
+    for (const auto& id : nexus_ids) {
+        uint32_t length;
+        input.read(reinterpret_cast<char*>(&length), sizeof(length));
+        std::string value(length, ' ');
+        input.read(&value[0], length);
+        ASSERT_EQ(value, id);
+    }
+    for (long t = 0; t < 3; ++t) {
+        int64_t time_index;
+        input.read(reinterpret_cast<char*>(&time_index), sizeof(time_index));
+        ASSERT_EQ(time_index, t);
+        uint32_t length;
+        input.read(reinterpret_cast<char*>(&length), sizeof(length));
+        std::string timestamp(length, ' ');
+        input.read(&timestamp[0], length);
+        ASSERT_EQ(timestamp, "t" + std::to_string(t));
+        for (std::size_t n = 0; n < nexus_ids.size(); ++n) {
+            double flow;
+            input.read(reinterpret_cast<char*>(&flow), sizeof(flow));
+            ASSERT_EQ(flow, t * 10.0 + n);
+        }
+    }
+    input.peek();
+    ASSERT_TRUE(input.eof());
+}
+
+/**
+ * Read every frame published on a socket until the publisher closes it, connecting once the socket exists.
+ */
+static std::vector<std::string> read_frames(const std::string& socket_path) {
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    while (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    auto read_fully = [fd](char* out, std::size_t size) {
+        while (size > 0) {
+            ssize_t got = ::recv(fd, out, size, 0);
+            if (got <= 0) {
+                return false;
+            }
+            out += got;
+            size -= got;
+        }
+        return true;
+    };
+    std::vector<std::string> frames;
+    uint32_t length;
+    while (read_fully(reinterpret_cast<char*>(&length), sizeof(length))) {
+        std::string frame(length, ' ');
+        if (!read_fully(&frame[0], length)) {
+            break;
+        }
+        frames.push_back(frame);
+    }
+    ::close(fd);
+    return frames;
+}
+
+TEST_F(NexusOutputWriter_Test, TestStreamFrames) {
+    std::string socket_path = path_prefix + "flows.sock";
+    std::vector<std::string> frames;
+    std::thread subscriber([&] { frames = read_frames(socket_path); });
+    {
+        // returns once the subscriber is connected, so it is sent every frame
+        StreamNexusOutputWriter writer(nexus_ids, socket_path, 2, 1);
+        for (long t = 0; t < 3; ++t) {
+            for (std::size_t n = 0; n < nexus_ids.size(); ++n) {
+                writer.write(nexus_ids[n], t, "t" + std::to_string(t), t * 10.0 + n);
+            }
+        }
+    }
+    subscriber.join();
+
+    // the header of the binary format, then the records of each block of steps
+    ASSERT_EQ(frames.size(), 3);
+    EXPECT_EQ(frames[0], BinaryNexusOutputWriter::encode_header(nexus_ids));
+    EXPECT_EQ(frames[1], BinaryNexusOutputWriter::encode_records(nexus_ids.size(), {0, 1}, {"t0", "t1"},
+                                                                 {0.0, 1.0, 2.0, 10.0, 11.0, 12.0}));
+    EXPECT_EQ(frames[2], BinaryNexusOutputWriter::encode_records(nexus_ids.size(), {2}, {"t2"}, {20.0, 21.0, 22.0}));
+    EXPECT_FALSE(std::ifstream(socket_path).good());
+}
+
+TEST_F(NexusOutputWriter_Test, TestFactory) {
+    output_params params("binary", path_prefix, 8);
+    created_files.push_back(path_prefix + "nexus_output_rank_0.bin");
+    auto writer = make_nexus_output_writer(params, nexus_ids, "_rank_0");
+    ASSERT_NE(dynamic_cast<BinaryNexusOutputWriter*>(writer.get()), nullptr);
+    ASSERT_EQ(writer->get_nexus_ids(), nexus_ids);
+    writer.reset();
+    ASSERT_TRUE(std::ifstream(path_prefix + "nexus_output_rank_0.bin").good());
+
+    params.nexus_format = "zarr";
+    EXPECT_THROW(make_nexus_output_writer(params, nexus_ids), std::runtime_error);
+
+    params.nexus_format = "csv";
+    params.csv_compression = "lz4";
+    EXPECT_THROW(make_nexus_output_writer(params, nexus_ids), std::runtime_error);
+}
+
+TEST_F(NexusOutputWriter_Test, TestMemoryKeepsNexusMajorFlows) {
+    MemoryNexusOutputWriter writer(nexus_ids, 0, MemoryNexusOutputWriter::chunk_handler_t(), 2);
+    // Out of order, and run past the reserved steps so the rows must grow
+    for (long t = 0; t < 5; ++t) {
+        for (std::size_t n = nexus_ids.size(); n-- > 0;) {
+            writer.write(nexus_ids[n], t, "ts" + std::to_string(t), t * 10.0 + n);
+        }
+    }
+    ASSERT_EQ(writer.get_time_indices(), std::vector<long>({0, 1, 2, 3, 4}));
+    ASSERT_EQ(writer.get_timestamps()[3], "ts3");
+    ASSERT_GE(writer.get_row_stride(), 5u);
+    for (std::size_t n = 0; n < nexus_ids.size(); ++n) {
+        for (long t = 0; t < 5; ++t) {
+            ASSERT_EQ(writer.get_flows()[n * writer.get_row_stride() + t], t * 10.0 + n);
+        }
+    }
+
+    // Flushing keeps every step when there are no chunks
+    writer.flush();
+    ASSERT_EQ(writer.get_time_indices().size(), 5u);
+    writer.clear();
+    ASSERT_TRUE(writer.get_time_indices().empty());
+}
+
+TEST_F(NexusOutputWriter_Test, TestMemoryChunks) {
+    std::vector<std::vector<long>> chunk_steps;
+    std::vector<double> last_nexus_flows;
+    MemoryNexusOutputWriter writer(nexus_ids, 2, [&](const MemoryNexusOutputWriter& chunk) {
+        chunk_steps.push_back(chunk.get_time_indices());
+        for (std::size_t s = 0; s < chunk.get_time_indices().size(); ++s) {
+            last_nexus_flows.push_back(chunk.get_flows()[2 * chunk.get_row_stride() + s]);
+        }
+    });
+    for (long t = 0; t < 5; ++t) {
+        for (std::size_t n = 0; n < nexus_ids.size(); ++n) {
+            writer.write(nexus_ids[n], t, "ts", t * 10.0 + n);
+        }
+    }
+    ASSERT_EQ(chunk_steps.size(), 2u);
+    ASSERT_EQ(writer.get_time_indices(), std::vector<long>({4}));
+
+    // The last, partial chunk is handed over on flush
+    writer.flush();
+    ASSERT_EQ(chunk_steps.size(), 3u);
+    ASSERT_EQ(chunk_steps[1], std::vector<long>({2, 3}));
+    ASSERT_EQ(chunk_steps[2], std::vector<long>({4}));
+    ASSERT_EQ(last_nexus_flows, std::vector<double>({2.0, 12.0, 22.0, 32.0, 42.0}));
+    ASSERT_TRUE(writer.get_time_indices().empty());
+
+    EXPECT_THROW(MemoryNexusOutputWriter(nexus_ids, 2), std::invalid_argument);
+}
+
+TEST_F(NexusOutputWriter_Test, TestMappedKeepsFlowsAlongTheRun) {
+    std::string path = path_prefix + "nexus_output.flows";
+    created_files.push_back(path);
+    {
+        MappedNexusOutputWriter writer(nexus_ids, path, 4);
+        ASSERT_FALSE(writer.was_reopened());
+        for (long t = 0; t < 2; ++t) {
+            for (std::size_t n = nexus_ids.size(); n-- > 0;) {
+                writer.write(nexus_ids[n], t, "ts" + std::to_string(t), t * 10.0 + n);
+            }
+            writer.complete_time_step(t, "ts" + std::to_string(t));
+        }
+        writer.flush();
+        ASSERT_EQ(writer.get_row_stride(), 4u);
+        ASSERT_EQ(writer.get_completed_steps(), 2u);
+        ASSERT_EQ(writer.get_flows()[2 * 4 + 1], 12.0);
+        ASSERT_EQ(writer.get_flows()[2 * 4 + 2], 0.0);
+        EXPECT_THROW(writer.write("nex-1", 4, "ts4", 1.0), std::out_of_range);
+    }
+
+    // The header, then the flows nexus major from the first page boundary after it
+    std::ifstream file(path, std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::string header = MappedNexusOutputWriter::encode_header(nexus_ids, 4);
+    uint64_t values[4];
+    std::memcpy(values, bytes.data() + 8, sizeof(values));
+    ASSERT_EQ(bytes.compare(0, 8, "NGENMAP1"), 0);
+    ASSERT_EQ(values[0], 3u);
+    ASSERT_EQ(values[1], 4u);
+    ASSERT_EQ(values[2], 2u);
+    ASSERT_EQ(values[3] % sysconf(_SC_PAGESIZE), 0u);
+    ASSERT_EQ(bytes.compare(40, header.size() - 40, header, 40, header.size() - 40), 0);
+    ASSERT_EQ(bytes.size(), values[3] + 3 * 4 * sizeof(double));
+    double flow;
+    std::memcpy(&flow, bytes.data() + values[3] + (1 * 4 + 1) * sizeof(double), sizeof(double));
+    ASSERT_EQ(flow, 11.0);
+
+    // A restarted run keeps the steps before it, while one with other nexuses or steps starts over
+    {
+        MappedNexusOutputWriter writer(nexus_ids, path, 4, true);
+        ASSERT_TRUE(writer.was_reopened());
+        ASSERT_EQ(writer.get_completed_steps(), 2u);
+        writer.write("nex-1", 2, "ts2", 20.0);
+        writer.complete_time_step(2, "ts2");
+        ASSERT_EQ(writer.get_flows()[1], 10.0);
+        ASSERT_EQ(writer.get_flows()[2], 20.0);
+    }
+    {
+        MappedNexusOutputWriter writer(nexus_ids, path, 5, true);
+        ASSERT_FALSE(writer.was_reopened());
+        ASSERT_EQ(writer.get_completed_steps(), 0u);
+        ASSERT_EQ(writer.get_flows()[1], 0.0);
+    }
+    {
+        MappedNexusOutputWriter writer(nexus_ids, path, 5);
+        ASSERT_FALSE(writer.was_reopened());
+    }
+
+    output_params params("mapped", path_prefix, 8);
+    EXPECT_THROW(make_nexus_output_writer(params, nexus_ids), std::runtime_error);
+    auto made = make_nexus_output_writer(params, nexus_ids, "", 5, true);
+    ASSERT_NE(dynamic_cast<MappedNexusOutputWriter*>(made.get()), nullptr);
+    ASSERT_TRUE(dynamic_cast<MappedNexusOutputWriter*>(made.get())->was_reopened());
+}
@@ -2,8 +2,12 @@
 
 #include "gtest/gtest.h"
 #include "HY_PointHydroNexusRemote.hpp"
+#include "RemoteNexusExchange.hpp"
+#include "NexusReduceScatter.hpp"
 
 
+#include <algorithm>
+#include <chrono>
 #include <vector>
 #include <memory>
 
@@ -458,6 +462,38 @@ TEST_F(Nexus_Remote_Test, TestDeadlock1)
     MPI_Barrier(MPI_COMM_WORLD);
 }
 
+//Make sure draining remote nexuses at the end of a run finishes at once when their communications have completed.
+TEST_F(Nexus_Remote_Test, TestDrainCommunications)
+{
+    HY_PointHydroNexusRemote::catcment_location_map_t loc_map;
+    std::shared_ptr<HY_PointHydroNexusRemote> nexus;
+    long ts = 0;
+
+    if ( mpi_rank == 0 )
+    {
+        loc_map["cat-27"] = 1;
+        nexus = std::make_shared<HY_PointHydroNexusRemote>("nex-26", std::vector<std::string>{"cat-27"},
+                                                           std::vector<std::string>{"cat-26"}, loc_map);
+        nexus->add_upstream_flow(200.0, "cat-26", ts);
+    }
+    else if ( mpi_rank == 1 )
+    {
+        loc_map["cat-26"] = 0;
+        nexus = std::make_shared<HY_PointHydroNexusRemote>("nex-26", std::vector<std::string>{"cat-27"},
+                                                           std::vector<std::string>{"cat-26"}, loc_map);
+        ASSERT_EQ(200.0, nexus->get_downstream_flow("cat-27", ts, 100));
+    }
+
+    if ( nexus )
+    {
+        auto start = std::chrono::steady_clock::now();
+        ASSERT_TRUE(HY_PointHydroNexusRemote::drain_communications({nexus.get()}, std::chrono::milliseconds(1000)));
+        ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(1000));
+    }
+
+    MPI_Barrier(MPI_COMM_WORLD);
+}
+
 TEST_F(Nexus_Remote_Test, DISABLED_TestTree1)
 {
     int tree_height = 2;
@@ -675,4 +711,452 @@ TEST_F(Nexus_Remote_Test, DISABLED_TestTree1)
 }
 
 
+//Test sending the flows of two remote nexi from one rank to another
+//as a single batched exchange per time step.
+TEST_F(Nexus_Remote_Test, TestBatchedExchange)
+{
+    if ( mpi_num_procs < 2 )
+    {
+    	GTEST_SKIP();
+    }
+
+    std::vector<std::shared_ptr<HY_PointHydroNexusRemote>> nexuses;
+    std::vector<std::string> nexus_ids = {"nex-26", "nex-36"};
+    for ( int i = 0; i < 2; ++i )
+    {
+        HY_PointHydroNexusRemote::catcment_location_map_t loc_map;
+        std::string upstream = "cat-" + std::to_string(26 + 10*i);
+        std::string downstream = "cat-" + std::to_string(27 + 10*i);
+        if ( mpi_rank == 0 )
+        {
+            loc_map[downstream] = 1;
+        }
+        else if ( mpi_rank == 1 )
+        {
+            loc_map[upstream] = 0;
+        }
+        if ( mpi_rank < 2 )
+        {
+            nexuses.push_back(std::make_shared<HY_PointHydroNexusRemote>(nexus_ids[i], std::vector<std::string>{downstream},
+                                                                         std::vector<std::string>{upstream}, loc_map));
+        }
+    }
+
+    RemoteNexusExchange exchange(nexuses);
+    auto neighbors = exchange.get_neighbor_counts();
+    if ( mpi_rank == 0 )
+    {
+        ASSERT_EQ(neighbors.first, 1);
+        ASSERT_EQ(neighbors.second, 0);
+    }
+    else if ( mpi_rank == 1 )
+    {
+        ASSERT_EQ(neighbors.first, 0);
+        ASSERT_EQ(neighbors.second, 1);
+    }
+
+    long ts = 0;
+    for ( auto discharge : stored_discharge)
+    {
+        if ( mpi_rank == 0 )
+        {
+            nexuses[0]->add_upstream_flow(discharge, "cat-26", ts);
+            nexuses[1]->add_upstream_flow(2*discharge, "cat-36", ts);
+        }
+
+        // Receives of the next step are posted early, other than after the last
+        exchange.exchange(ts, ts + 1 < (long)stored_discharge.size());
+
+        if ( mpi_rank == 1 )
+        {
+            ASSERT_EQ(discharge, nexuses[0]->get_downstream_flow("cat-27", ts, 100));
+            ASSERT_EQ(2*discharge, nexuses[1]->get_downstream_flow("cat-37", ts, 100));
+        }
+
+        ++ts;
+    }
+
+    MPI_Barrier(MPI_COMM_WORLD);
+}
+
+//Test the batched exchange with flows put one-sided into the window of the
+//receiving rank.
+TEST_F(Nexus_Remote_Test, TestOneSidedExchange)
+{
+    if ( mpi_num_procs < 2 )
+    {
+    	GTEST_SKIP();
+    }
+
+    std::vector<std::shared_ptr<HY_PointHydroNexusRemote>> nexuses;
+    std::vector<std::string> nexus_ids = {"nex-26", "nex-36"};
+    for ( int i = 0; i < 2; ++i )
+    {
+        HY_PointHydroNexusRemote::catcment_location_map_t loc_map;
+        std::string upstream = "cat-" + std::to_string(26 + 10*i);
+        std::string downstream = "cat-" + std::to_string(27 + 10*i);
+        if ( mpi_rank == 0 )
+        {
+            loc_map[downstream] = 1;
+        }
+        else if ( mpi_rank == 1 )
+        {
+            loc_map[upstream] = 0;
+        }
+        if ( mpi_rank < 2 )
+        {
+            nexuses.push_back(std::make_shared<HY_PointHydroNexusRemote>(nexus_ids[i], std::vector<std::string>{downstream},
+                                                                         std::vector<std::string>{upstream}, loc_map));
+        }
+    }
+
+    RemoteNexusExchange exchange(nexuses, MPI_COMM_WORLD, RemoteNexusExchange::Transport::one_sided);
+    auto neighbors = exchange.get_neighbor_counts();
+    if ( mpi_rank == 0 )
+    {
+        ASSERT_EQ(neighbors.first, 1);
+        ASSERT_EQ(neighbors.second, 0);
+    }
+    else if ( mpi_rank == 1 )
+    {
+        ASSERT_EQ(neighbors.first, 0);
+        ASSERT_EQ(neighbors.second, 1);
+    }
+
+    long ts = 0;
+    for ( auto discharge : stored_discharge)
+    {
+        if ( mpi_rank == 0 )
+        {
+            nexuses[0]->add_upstream_flow(discharge, "cat-26", ts);
+            nexuses[1]->add_upstream_flow(2*discharge, "cat-36", ts);
+        }
+
+        // Receives of the next step are posted early, other than after the last
+        exchange.exchange(ts, ts + 1 < (long)stored_discharge.size());
+
+        if ( mpi_rank == 1 )
+        {
+            ASSERT_EQ(discharge, nexuses[0]->get_downstream_flow("cat-27", ts, 100));
+            ASSERT_EQ(2*discharge, nexuses[1]->get_downstream_flow("cat-37", ts, 100));
+        }
+
+        ++ts;
+    }
+
+    MPI_Barrier(MPI_COMM_WORLD);
+}
+
+//Test the batched exchange of chunks of time steps, with a last chunk shorter than the rest, over both transports
+TEST_F(Nexus_Remote_Test, TestChunkedExchange)
+{
+    if ( mpi_num_procs < 2 )
+    {
+    	GTEST_SKIP();
+    }
+
+    for ( auto transport : {RemoteNexusExchange::Transport::neighbor_collective, RemoteNexusExchange::Transport::one_sided} )
+    {
+        std::vector<std::shared_ptr<HY_PointHydroNexusRemote>> nexuses;
+        std::vector<std::string> nexus_ids = {"nex-26", "nex-36"};
+        for ( int i = 0; i < 2; ++i )
+        {
+            HY_PointHydroNexusRemote::catcment_location_map_t loc_map;
+            std::string upstream = "cat-" + std::to_string(26 + 10*i);
+            std::string downstream = "cat-" + std::to_string(27 + 10*i);
+            if ( mpi_rank == 0 )
+            {
+                loc_map[downstream] = 1;
+            }
+            else if ( mpi_rank == 1 )
+            {
+                loc_map[upstream] = 0;
+            }
+            if ( mpi_rank < 2 )
+            {
+                nexuses.push_back(std::make_shared<HY_PointHydroNexusRemote>(nexus_ids[i], std::vector<std::string>{downstream},
+                                                                             std::vector<std::string>{upstream}, loc_map));
+            }
+        }
+
+        const long chunk_steps = 3;
+        const long total_steps = 7;
+        RemoteNexusExchange exchange(nexuses, MPI_COMM_WORLD, transport, chunk_steps);
+        ASSERT_EQ(exchange.get_chunk_steps(), chunk_steps);
+
+        for ( long first = 0; first < total_steps; first += chunk_steps )
+        {
+            long count = std::min(chunk_steps, total_steps - first);
+            if ( mpi_rank == 0 )
+            {
+                for ( long ts = first; ts < first + count; ++ts )
+                {
+                    nexuses[0]->add_upstream_flow(1.0 + ts, "cat-26", ts);
+                    nexuses[1]->add_upstream_flow(2.0 * ts, "cat-36", ts);
+                }
+                // a flow past the end of the chunk has nowhere to go
+                if ( count == chunk_steps )
+                {
+                    EXPECT_THROW(exchange.stage_flow("nex-26", first + count, 0.0), std::runtime_error);
+                }
+            }
+
+            exchange.exchange_chunk(first, count, first + count < total_steps);
+
+            if ( mpi_rank == 1 )
+            {
+                for ( long ts = first; ts < first + count; ++ts )
+                {
+                    ASSERT_EQ(1.0 + ts, nexuses[0]->get_downstream_flow("cat-27", ts, 100));
+                    ASSERT_EQ(2.0 * ts, nexuses[1]->get_downstream_flow("cat-37", ts, 100));
+                }
+            }
+        }
+        EXPECT_THROW(exchange.exchange_chunk(total_steps, chunk_steps + 1), std::invalid_argument);
+    }
+
+    MPI_Barrier(MPI_COMM_WORLD);
+}
+
+//The remote nexuses of rank r in a chain of all ranks, where each rank sends to the next: nex-<r> receiving from cat-<10r>
+//on rank r - 1 into cat-<10r+1>, unless r is the first rank, then nex-<r+1> sending from cat-<10(r+1)> to rank r + 1,
+//unless r is the last rank
+static std::vector<std::shared_ptr<HY_PointHydroNexusRemote>> make_chain_nexuses(int rank, int num_procs)
+{
+    std::vector<std::shared_ptr<HY_PointHydroNexusRemote>> nexuses;
+    for ( int n = rank; n <= rank + 1; ++n )
+    {
+        if ( n == 0 || n == num_procs )
+        {
+            continue;
+        }
+        HY_PointHydroNexusRemote::catcment_location_map_t loc_map;
+        std::string upstream = "cat-" + std::to_string(10*n);
+        std::string downstream = "cat-" + std::to_string(10*n + 1);
+        if ( n == rank )
+        {
+            loc_map[upstream] = rank - 1;
+        }
+        else
+        {
+            loc_map[downstream] = rank + 1;
+        }
+        nexuses.push_back(std::make_shared<HY_PointHydroNexusRemote>("nex-" + std::to_string(n),
+                                                                     std::vector<std::string>{downstream},
+                                                                     std::vector<std::string>{upstream}, loc_map));
+    }
+    return nexuses;
+}
+
+//The flow rank r sends downstream at time step ts
+static double chain_flow(int rank, long ts)
+{
+    return 100.0 * rank + ts + 1.0;
+}
+
+//Test the exchange along a chain of ranks, whose first rank only sends and whose last rank only receives, over both
+//transports, with and without posting the receives of each step early
+TEST_F(Nexus_Remote_Test, TestExchangeAlongChain)
+{
+    if ( mpi_num_procs < 2 )
+    {
+    	GTEST_SKIP();
+    }
+
+    for ( auto transport : {RemoteNexusExchange::Transport::neighbor_collective, RemoteNexusExchange::Transport::one_sided} )
+    {
+        for ( bool post_next : {true, false} )
+        {
+            auto nexuses = make_chain_nexuses(mpi_rank, mpi_num_procs);
+            bool is_receiver = mpi_rank > 0;
+            bool is_sender = mpi_rank + 1 < mpi_num_procs;
+            std::string receiving_catchment = "cat-" + std::to_string(10*mpi_rank + 1);
+            std::string sending_catchment = "cat-" + std::to_string(10*(mpi_rank + 1));
+
+            RemoteNexusExchange exchange(nexuses, MPI_COMM_WORLD, transport);
+            auto neighbors = exchange.get_neighbor_counts();
+            ASSERT_EQ(neighbors.first, is_sender ? 1 : 0);
+            ASSERT_EQ(neighbors.second, is_receiver ? 1 : 0);
+
+            for ( long ts = 0; ts < (long)stored_discharge.size(); ++ts )
+            {
+                if ( is_sender )
+                {
+                    nexuses.back()->add_upstream_flow(chain_flow(mpi_rank, ts), sending_catchment, ts);
+                }
+
+                exchange.exchange(ts, post_next && ts + 1 < (long)stored_discharge.size());
+
+                if ( is_receiver )
+                {
+                    ASSERT_EQ(chain_flow(mpi_rank - 1, ts), nexuses.front()->get_downstream_flow(receiving_catchment, ts, 100));
+                }
+            }
+        }
+    }
+
+    MPI_Barrier(MPI_COMM_WORLD);
+}
+
+//Test that a flow staged again once the exchange of its chunk has started, as soon as every flow to send was staged,
+//is rejected rather than lost, and the one staged first is received
+TEST_F(Nexus_Remote_Test, TestStageAfterExchangeStarted)
+{
+    if ( mpi_num_procs < 2 )
+    {
+    	GTEST_SKIP();
+    }
+
+    for ( auto transport : {RemoteNexusExchange::Transport::neighbor_collective, RemoteNexusExchange::Transport::one_sided} )
+    {
+        auto nexuses = make_chain_nexuses(mpi_rank, mpi_num_procs);
+        bool is_receiver = mpi_rank > 0;
+        bool is_sender = mpi_rank + 1 < mpi_num_procs;
+        std::string sending_nexus = "nex-" + std::to_string(mpi_rank + 1);
+        std::string receiving_catchment = "cat-" + std::to_string(10*mpi_rank + 1);
+        std::string sending_catchment = "cat-" + std::to_string(10*(mpi_rank + 1));
+
+        const long chunk_steps = 2;
+        const long total_steps = 6;
+        RemoteNexusExchange exchange(nexuses, MPI_COMM_WORLD, transport, chunk_steps);
+        // Puts only start before the exchange call once this rank's window is open for the chunk
+        exchange.post_receives(0);
+
+        for ( long first = 0; first < total_steps; first += chunk_steps )
+        {
+            if ( is_sender )
+            {
+                for ( long ts = first; ts < first + chunk_steps; ++ts )
+                {
+                    nexuses.back()->add_upstream_flow(chain_flow(mpi_rank, ts), sending_catchment, ts);
+                }
+                EXPECT_THROW(exchange.stage_flow(sending_nexus, first + chunk_steps - 1, -1.0), std::runtime_error);
+                EXPECT_THROW(exchange.stage_flow(sending_nexus, first, -1.0), std::runtime_error);
+            }
+
+            exchange.exchange_chunk(first, chunk_steps, first + chunk_steps < total_steps);
+
+            if ( is_receiver )
+            {
+                for ( long ts = first; ts < first + chunk_steps; ++ts )
+                {
+                    ASSERT_EQ(chain_flow(mpi_rank - 1, ts), nexuses.front()->get_downstream_flow(receiving_catchment, ts, 100));
+                }
+            }
+        }
+    }
+
+    MPI_Barrier(MPI_COMM_WORLD);
+}
+
+//Test chunks cut short at each checkpoint and at the end of the run, as the run loop of NGen.cpp exchanges them,
+//along a chain of ranks and over both transports
+TEST_F(Nexus_Remote_Test, TestShortChunksAtCheckpointsAndEnd)
+{
+    if ( mpi_num_procs < 2 )
+    {
+    	GTEST_SKIP();
+    }
+
+    for ( auto transport : {RemoteNexusExchange::Transport::neighbor_collective, RemoteNexusExchange::Transport::one_sided} )
+    {
+        auto nexuses = make_chain_nexuses(mpi_rank, mpi_num_procs);
+        bool is_receiver = mpi_rank > 0;
+        bool is_sender = mpi_rank + 1 < mpi_num_procs;
+        std::string receiving_catchment = "cat-" + std::to_string(10*mpi_rank + 1);
+        std::string sending_catchment = "cat-" + std::to_string(10*(mpi_rank + 1));
+
+        const long chunk_steps = 3;
+        const long checkpoint_interval = 4;
+        const long total_steps = 10;
+        RemoteNexusExchange exchange(nexuses, MPI_COMM_WORLD, transport, chunk_steps);
+
+        std::vector<std::pair<long, long>> chunks;
+        long chunk_first = 0;
+        for ( long ts = 0; ts < total_steps; ++ts )
+        {
+            if ( is_sender )
+            {
+                nexuses.back()->add_upstream_flow(chain_flow(mpi_rank, ts), sending_catchment, ts);
+            }
+
+            bool is_checkpoint_due = (ts + 1) % checkpoint_interval == 0 && ts + 1 < total_steps;
+            if ( ts + 1 - chunk_first < chunk_steps && ts + 1 < total_steps && !is_checkpoint_due )
+            {
+                continue;
+            }
+            exchange.exchange_chunk(chunk_first, ts + 1 - chunk_first, ts + 1 < total_steps);
+            chunks.emplace_back(chunk_first, ts + 1 - chunk_first);
+
+            if ( is_receiver )
+            {
+                for ( long t = chunk_first; t <= ts; ++t )
+                {
+                    ASSERT_EQ(chain_flow(mpi_rank - 1, t), nexuses.front()->get_downstream_flow(receiving_catchment, t, 100));
+                }
+            }
+            chunk_first = ts + 1;
+        }
+
+        std::vector<std::pair<long, long>> expected = {{0, 3}, {3, 1}, {4, 3}, {7, 1}, {8, 2}};
+        ASSERT_EQ(chunks, expected);
+    }
+
+    MPI_Barrier(MPI_COMM_WORLD);
+}
+
+//Every rank contributes to every nexus, so each nexus's total over a chunk is the sum over the ranks, on its owner
+TEST_F(Nexus_Remote_Test, TestReduceScatterSumsOntoOwners)
+{
+    //Each rank adds to its own nexus as well as to the nexuses shared by all, listed in a different order on each
+    std::vector<std::string> local_ids = {"nex-" + std::to_string(100 + mpi_rank), "nex-2", "nex-1"};
+    if ( mpi_rank % 2 == 1 )
+    {
+        std::swap(local_ids[1], local_ids[2]);
+    }
+    NexusReduceScatter reduction(local_ids, 3, MPI_COMM_WORLD);
+    ASSERT_EQ(reduction.chunk_steps(), 3);
+
+    //The flow of rank r to nexus nex-<n> at step s
+    auto flow = [](int r, int n, std::size_t s) { return 1000.0 * s + 10.0 * n + r; };
+    auto nexus_number = [](const std::string& id) { return std::stoi(id.substr(4)); };
+
+    std::size_t owned_total = reduction.owned_nexus_ids().size();
+    MPI_Allreduce(MPI_IN_PLACE, &owned_total, 1, MPI_UNSIGNED_LONG, MPI_SUM, MPI_COMM_WORLD);
+    ASSERT_EQ(owned_total, 2 + mpi_num_procs);
+    ASSERT_TRUE(std::is_sorted(reduction.owned_nexus_ids().begin(), reduction.owned_nexus_ids().end()));
+
+    for ( int chunk = 0; chunk < 2; ++chunk )
+    {
+        for ( std::size_t s = 0; s < reduction.chunk_steps(); ++s )
+        {
+            for ( std::size_t i = 0; i < local_ids.size(); ++i )
+            {
+                reduction.add(i, s, flow(mpi_rank, nexus_number(local_ids[i]), s + chunk));
+            }
+        }
+        reduction.reduce();
+
+        for ( std::size_t s = 0; s < reduction.chunk_steps(); ++s )
+        {
+            const double* flows = reduction.owned_flows(s);
+            for ( std::size_t j = 0; j < reduction.owned_nexus_ids().size(); ++j )
+            {
+                int n = nexus_number(reduction.owned_nexus_ids()[j]);
+                double expected = 0.0;
+                for ( int r = 0; r < mpi_num_procs; ++r )
+                {
+                    if ( n < 100 || n == 100 + r )
+                    {
+                        expected += flow(r, n, s + chunk);
+                    }
+                }
+                ASSERT_DOUBLE_EQ(flows[j], expected);
+            }
+        }
+    }
+
+    MPI_Barrier(MPI_COMM_WORLD);
+}
+
 //#endif  // NGEN_MPI_TESTS_ACTIVE
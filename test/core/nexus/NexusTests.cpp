@@ -1,6 +1,10 @@
 #include "gtest/gtest.h"
 
+#include "HY_DendriticNexus.hpp"
 #include "HY_PointHydroNexus.hpp"
+#include "NexusInflowMatrix.hpp"
+#include "RemoteLocationIndex.hpp"
+#include "TimeStepRing.hpp"
 #include "HY_HydroLocation.hpp"
 #include "HY_IndirectPosition.hpp"
 
@@ -52,3 +56,218 @@ TEST_F(Nexus_Test, TestInit0)
     HY_PointHydroNexus("nex-0", contrib);
     ASSERT_TRUE( true );
 }
+
+//! Test that flows over many time steps are released correctly when the bookkeeping of completed steps is reused.
+TEST_F(Nexus_Test, TestManyTimeSteps)
+{
+    HY_PointHydroNexus nexus("nex-0", {"cat-2"}, {"cat-0", "cat-1"});
+
+    for ( long t = 0; t < 100; ++t )
+    {
+        nexus.add_upstream_flow(1.0 * t, "cat-0", t);
+        nexus.add_upstream_flow(2.0, "cat-1", t);
+        ASSERT_EQ(nexus.inspect_upstream_flows(t).second, 2);
+        ASSERT_DOUBLE_EQ(nexus.get_downstream_flow("cat-2", t, 100.0), 1.0 * t + 2.0);
+    }
+
+    // completed time steps can no longer be added to or requested from
+    ASSERT_THROW(nexus.add_upstream_flow(1.0, "cat-0", 3), std::exception);
+    ASSERT_THROW(nexus.get_downstream_flow("cat-2", 99, 10.0), std::exception);
+}
+
+//! Test that time steps completed out of order keep their own flows.
+TEST_F(Nexus_Test, TestOutOfOrderTimeSteps)
+{
+    HY_PointHydroNexus nexus("nex-0", {"cat-2"}, {"cat-0"});
+
+    for ( long t = 0; t < 20; ++t )
+    {
+        nexus.add_upstream_flow(1.0 + t, "cat-0", t);
+    }
+    for ( long t = 19; t > 0; t -= 2 )
+    {
+        ASSERT_DOUBLE_EQ(nexus.get_downstream_flow("cat-2", t, 100.0), 1.0 + t);
+    }
+    for ( long t = 0; t < 20; t += 2 )
+    {
+        ASSERT_DOUBLE_EQ(nexus.get_downstream_flow("cat-2", t, 40.0), 0.4 * (1.0 + t));
+        ASSERT_DOUBLE_EQ(nexus.inspect_downstream_requests(t).first, 40.0);
+        ASSERT_DOUBLE_EQ(nexus.get_downstream_flow("cat-2", t, 60.0), 0.6 * (1.0 + t));
+    }
+    ASSERT_THROW(nexus.get_downstream_flow("cat-2", 7, 10.0), std::exception);
+}
+
+//! Test that a nexus first used at a later time step, as in a restarted run, keeps reusing the same few slots.
+TEST_F(Nexus_Test, TestLaterFirstTimeStep)
+{
+    HY_PointHydroNexus point("nex-0", {"cat-2"}, {"cat-0", "cat-1"});
+    HY_DendriticNexus dendritic("nex-0", {"cat-2"});
+    std::vector<HY_HydroNexus*> nexuses{&point, &dendritic};
+    for ( HY_HydroNexus* nexus : nexuses )
+    {
+        nexus->set_mintime(1000);
+    }
+
+    std::size_t warm_point_bytes = 0, warm_dendritic_bytes = 0;
+    for ( long t = 1000; t < 3000; ++t )
+    {
+        for ( HY_HydroNexus* nexus : nexuses )
+        {
+            nexus->add_upstream_flow(1.0, "cat-0", t);
+            nexus->add_upstream_flow(2.0, "cat-1", t);
+            ASSERT_DOUBLE_EQ(nexus->get_downstream_flow("cat-2", t, 100.0), 3.0);
+        }
+        if ( t == 1010 )
+        {
+            warm_point_bytes = point.get_memory_bytes();
+            warm_dendritic_bytes = dendritic.get_memory_bytes();
+        }
+    }
+    ASSERT_EQ(point.get_memory_bytes(), warm_point_bytes);
+    ASSERT_EQ(dendritic.get_memory_bytes(), warm_dendritic_bytes);
+    ASSERT_THROW(point.add_upstream_flow(1.0, "cat-0", 999), std::exception);
+}
+
+//! Test that a dendritic nexus releases the same flows as a point nexus, and refuses the same operations.
+TEST_F(Nexus_Test, TestDendriticNexusMatchesPointNexus)
+{
+    HY_PointHydroNexus point("nex-0", {"cat-2"}, {"cat-0", "cat-1"});
+    HY_DendriticNexus dendritic("nex-0", {"cat-2"});
+
+    // several time steps in progress at once, completed out of order
+    for ( long t = 0; t < 40; ++t )
+    {
+        for ( HY_HydroNexus* nexus : std::vector<HY_HydroNexus*>{&point, &dendritic} )
+        {
+            nexus->add_upstream_flow(0.1 * t, "cat-0", t);
+            nexus->add_upstream_flow(0.7, "cat-1", t);
+        }
+        ASSERT_EQ(dendritic.inspect_upstream_flows(t), point.inspect_upstream_flows(t));
+    }
+    for ( long t = 39; t >= 0; t -= 3 )
+    {
+        ASSERT_EQ(dendritic.get_downstream_flow("cat-2", t, 100.0), point.get_downstream_flow("cat-2", t, 100.0));
+    }
+    for ( long t = 0; t < 40; ++t )
+    {
+        if ( t % 3 == 0 ) continue;
+        ASSERT_EQ(dendritic.get_downstream_flow("cat-2", t, 30.0), point.get_downstream_flow("cat-2", t, 30.0));
+        ASSERT_EQ(dendritic.inspect_downstream_requests(t), point.inspect_downstream_requests(t));
+        ASSERT_THROW(dendritic.add_upstream_flow(1.0, "cat-0", t), std::exception);
+        ASSERT_THROW(dendritic.get_downstream_flow("cat-2", t, 80.0), std::exception);
+        ASSERT_EQ(dendritic.get_downstream_flow("cat-2", t, 70.0), point.get_downstream_flow("cat-2", t, 70.0));
+    }
+
+    ASSERT_THROW(dendritic.add_upstream_flow(1.0, "cat-0", 5), std::exception);
+    ASSERT_THROW(dendritic.get_downstream_flow("cat-2", 39, 10.0), std::exception);
+    ASSERT_THROW(dendritic.get_downstream_flow("cat-2", 40, 100.0), std::exception);
+    dendritic.set_mintime(50);
+    ASSERT_THROW(dendritic.add_upstream_flow(1.0, "cat-0", 45), std::exception);
+}
+
+//! Test that the time step ring grows only while time steps are in progress, keeping their bookkeeping.
+TEST_F(Nexus_Test, TestTimeStepRing)
+{
+    struct Count {
+        int value{0};
+        void reset() { value = 0; }
+    };
+    TimeStepRing<Count> ring(2);
+
+    for ( long t = 0; t < 5; ++t )
+    {
+        ring.claim(t).value = 10 + t;
+    }
+    ASSERT_EQ(ring.get_slots().size(), 8u);
+    for ( long t = 0; t < 5; ++t )
+    {
+        ASSERT_EQ(ring.find(t)->value, 10 + t);
+    }
+
+    // completing out of order only frees a step once every one before it has completed
+    ring.complete(*ring.find(1));
+    ASSERT_TRUE(ring.is_completed(1));
+    ASSERT_FALSE(ring.is_completed(0));
+    ring.complete(*ring.find(0));
+    ASSERT_EQ(ring.find(1), nullptr);
+    for ( long t = 2; t < 1000; ++t )
+    {
+        ring.complete(*ring.find(t));
+        ring.claim(t + 3).value = 1;
+    }
+    ASSERT_EQ(ring.get_slots().size(), 8u);
+    ASSERT_EQ(ring.find(1002)->value, 1);
+
+    ring.set_mintime(2000);
+    ASSERT_EQ(ring.find(1002), nullptr);
+    ASSERT_TRUE(ring.is_completed(1999));
+    ASSERT_EQ(ring.claim(2000).value, 0);
+}
+
+//! Test that summing catchment flows with the inflow matrix gives each nexus the same flow as contributing them one at a time.
+TEST_F(Nexus_Test, TestInflowMatrix)
+{
+    // catchments 0, 2 and 3 drain to nexus 0, catchment 1 to nexus 1, and catchment 4 to no nexus
+    nexus_output::NexusInflowMatrix matrix({0, 1, 0, 0, -1}, 2);
+    ASSERT_EQ(matrix.rows(), 2);
+    ASSERT_EQ(std::vector<std::size_t>(matrix.row_begin(0), matrix.row_end(0)), std::vector<std::size_t>({0, 2, 3}));
+
+    std::vector<double> flows = {0.1, 5.0, 0.2, 0.3, 7.0};
+    std::vector<double> sums(2, -1.0);
+    matrix.multiply(flows.data(), sums.data(), 0, 2);
+
+    HY_PointHydroNexus nexus("nex-0", {"cat-9"}, {"cat-0", "cat-2", "cat-3"});
+    nexus.add_upstream_flow(flows[0], "cat-0", 0);
+    nexus.add_upstream_flow(flows[2], "cat-2", 0);
+    nexus.add_upstream_flow(flows[3], "cat-3", 0);
+    // Summed in the same order, so exactly equal
+    ASSERT_EQ(sums[0], nexus.get_downstream_flow("cat-9", 0, 100.0));
+    ASSERT_EQ(sums[1], 5.0);
+
+    ASSERT_THROW(nexus_output::NexusInflowMatrix({0, 2}, 2), std::out_of_range);
+}
+
+//! Test that exactly summed flows are the same whatever order they are added in, by a nexus or the inflow matrix.
+TEST_F(Nexus_Test, TestExactSummation)
+{
+    // Summed in this order, 1e16 absorbs the 1.0 flows before -1e16 cancels it
+    std::vector<double> flows = {1e16, 1.0, 1.0, -1e16, 0.1};
+    const double exact = 2.1;
+
+    HY_PointHydroNexus ordered("nex-0", {"cat-9"}, {"cat-0", "cat-1", "cat-2", "cat-3", "cat-4"});
+    HY_PointHydroNexus reversed("nex-1", {"cat-9"}, {"cat-0", "cat-1", "cat-2", "cat-3", "cat-4"});
+    ordered.set_exact_summation(true);
+    reversed.set_exact_summation(true);
+    for ( std::size_t i = 0; i < flows.size(); ++i )
+    {
+        ordered.add_upstream_flow(flows[i], "cat-" + std::to_string(i), 0);
+        reversed.add_upstream_flow(flows[flows.size() - 1 - i], "cat-" + std::to_string(flows.size() - 1 - i), 0);
+    }
+    ASSERT_EQ(ordered.inspect_upstream_flows(0).first, exact);
+    ASSERT_EQ(ordered.get_downstream_flow("cat-9", 0, 100.0), exact);
+    ASSERT_EQ(reversed.get_downstream_flow("cat-9", 0, 100.0), exact);
+
+    nexus_output::NexusInflowMatrix matrix({0, 0, 0, 0, 0}, 1);
+    double sum = 0.0;
+    matrix.multiply(flows.data(), &sum, 0, 1);
+    ASSERT_NE(sum, exact);
+    matrix.set_exact_summation(true);
+    matrix.multiply(flows.data(), &sum, 0, 1);
+    ASSERT_EQ(sum, exact);
+}
+
+//! Test that the remote location index finds the rank of each remote catchment by its handle, and no local ones.
+TEST_F(Nexus_Test, TestRemoteLocationIndex)
+{
+    std::vector<std::pair<std::string, long>> locations{{"cat-26", 1}, {"cat-27", 2}, {"cat-26", 1}};
+    std::shared_ptr<const RemoteLocationIndex> index = RemoteLocationIndex::make(locations);
+    ASSERT_EQ(index->size(), 2);
+
+    RemoteLocationIndex::handle_t cat = index->find("cat-27");
+    ASSERT_NE(cat, RemoteLocationIndex::npos);
+    EXPECT_EQ(index->rank_at(cat), 2);
+    EXPECT_EQ(index->id(cat), "cat-27");
+    EXPECT_EQ(index->rank_at(index->find("cat-26")), 1);
+    EXPECT_EQ(index->find("cat-25"), RemoteLocationIndex::npos);
+    EXPECT_GT(index->get_memory_bytes(), 0);
+}
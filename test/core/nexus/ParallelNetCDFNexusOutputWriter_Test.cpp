@@ -0,0 +1,180 @@
+#ifdef NETCDF_PARALLEL_ACTIVE
+
+#include "gtest/gtest.h"
+
+#include "ParallelNetCDFNexusOutputWriter.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <mpi.h>
+#include <netcdf.h>
+
+using namespace nexus_output;
+
+class ParallelNetCDFNexusOutputWriter_Test : public ::testing::Test {
+
+protected:
+
+    static void SetUpTestSuite()
+    {
+        MPI_Init(NULL, NULL);
+        MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank);
+        MPI_Comm_size(MPI_COMM_WORLD, &mpi_num_procs);
+    }
+
+    static void TearDownTestSuite()
+    {
+        MPI_Finalize();
+    }
+
+    void SetUp() override;
+
+    void TearDown() override;
+
+    /** The ids of the nexuses of a rank, which has none when its rank is one less than a multiple of 3. */
+    static std::vector<std::string> rank_nexus_ids(int rank);
+
+    /** The flow written for the nexus at an index of the whole file, at a time step. */
+    static double expected_flow(std::size_t nexus, long time_index);
+
+    static std::string timestamp_of(long time_index);
+
+    static int mpi_rank;
+    static int mpi_num_procs;
+
+    std::string path;
+
+};
+
+int ParallelNetCDFNexusOutputWriter_Test::mpi_rank;
+int ParallelNetCDFNexusOutputWriter_Test::mpi_num_procs;
+
+void ParallelNetCDFNexusOutputWriter_Test::SetUp() {
+    path = "./parallel_nexus_output_test.nc";
+}
+
+void ParallelNetCDFNexusOutputWriter_Test::TearDown() {
+    MPI_Barrier(MPI_COMM_WORLD);
+    if (mpi_rank == 0) {
+        std::remove(path.c_str());
+    }
+}
+
+std::vector<std::string> ParallelNetCDFNexusOutputWriter_Test::rank_nexus_ids(int rank) {
+    std::vector<std::string> ids;
+    for (int i = 0; i < (rank + 1) % 3; ++i) {
+        ids.push_back("nex-" + std::to_string(rank) + "-" + std::to_string(i));
+    }
+    return ids;
+}
+
+double ParallelNetCDFNexusOutputWriter_Test::expected_flow(std::size_t nexus, long time_index) {
+    return 10.0 * nexus + 0.5 * time_index;
+}
+
+std::string ParallelNetCDFNexusOutputWriter_Test::timestamp_of(long time_index) {
+    return "2015-12-01 0" + std::to_string(time_index) + ":00:00";
+}
+
+/**
+ * Test that the nexuses of every rank, including those with none, are written to one file, with the steps left over
+ * from the last full buffer written when the writer is closed.
+ */
+TEST_F(ParallelNetCDFNexusOutputWriter_Test, TestCloseWritesEveryRank) {
+    std::vector<std::string> ids = rank_nexus_ids(mpi_rank);
+    std::size_t offset = 0;
+    for (int r = 0; r < mpi_rank; ++r) {
+        offset += rank_nexus_ids(r).size();
+    }
+    const long steps = 5;
+
+    ParallelNetCDFNexusOutputWriter writer(ids, path, 2);
+    for (long t = 0; t < steps; ++t) {
+        for (std::size_t i = 0; i < ids.size(); ++i) {
+            writer.write(ids[i], t, timestamp_of(t), expected_flow(offset + i, t));
+        }
+        writer.complete_time_step(t, timestamp_of(t));
+    }
+    writer.close();
+    // Closing again, and flushing once closed, do nothing
+    writer.close();
+    writer.flush();
+    ASSERT_THROW(writer.complete_time_step(steps, timestamp_of(steps)), std::runtime_error);
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    if (mpi_rank != 0) {
+        return;
+    }
+    std::vector<std::string> all_ids;
+    for (int r = 0; r < mpi_num_procs; ++r) {
+        std::vector<std::string> r_ids = rank_nexus_ids(r);
+        all_ids.insert(all_ids.end(), r_ids.begin(), r_ids.end());
+    }
+
+    int ncid, dim, var;
+    std::size_t nexus_count, time_count, id_length;
+    ASSERT_EQ(nc_open(path.c_str(), NC_NOWRITE, &ncid), NC_NOERR);
+    ASSERT_EQ(nc_inq_dimid(ncid, "nexus", &dim), NC_NOERR);
+    ASSERT_EQ(nc_inq_dimlen(ncid, dim, &nexus_count), NC_NOERR);
+    ASSERT_EQ(nc_inq_dimid(ncid, "time", &dim), NC_NOERR);
+    ASSERT_EQ(nc_inq_dimlen(ncid, dim, &time_count), NC_NOERR);
+    ASSERT_EQ(nc_inq_dimid(ncid, "id_length", &dim), NC_NOERR);
+    ASSERT_EQ(nc_inq_dimlen(ncid, dim, &id_length), NC_NOERR);
+    ASSERT_EQ(nexus_count, all_ids.size());
+    ASSERT_EQ(time_count, steps);
+
+    std::vector<char> id_chars(nexus_count * id_length);
+    ASSERT_EQ(nc_inq_varid(ncid, "ids", &var), NC_NOERR);
+    ASSERT_EQ(nc_get_var_text(ncid, var, id_chars.data()), NC_NOERR);
+    for (std::size_t n = 0; n < nexus_count; ++n) {
+        const char* id = id_chars.data() + n * id_length;
+        EXPECT_EQ(std::string(id, strnlen(id, id_length)), all_ids[n]);
+    }
+
+    std::vector<long long> time_indices(time_count);
+    ASSERT_EQ(nc_inq_varid(ncid, "time_index", &var), NC_NOERR);
+    ASSERT_EQ(nc_get_var_longlong(ncid, var, time_indices.data()), NC_NOERR);
+    std::vector<char> timestamps(time_count * 19);
+    ASSERT_EQ(nc_inq_varid(ncid, "timestamp", &var), NC_NOERR);
+    ASSERT_EQ(nc_get_var_text(ncid, var, timestamps.data()), NC_NOERR);
+    for (long t = 0; t < steps; ++t) {
+        EXPECT_EQ(time_indices[t], t);
+        EXPECT_EQ(std::string(timestamps.data() + t * 19, 19), timestamp_of(t));
+    }
+
+    std::vector<double> flows(nexus_count * time_count);
+    ASSERT_EQ(nc_inq_varid(ncid, "flow", &var), NC_NOERR);
+    ASSERT_EQ(nc_get_var_double(ncid, var, flows.data()), NC_NOERR);
+    for (std::size_t n = 0; n < nexus_count; ++n) {
+        for (long t = 0; t < steps; ++t) {
+            EXPECT_DOUBLE_EQ(flows[n * time_count + t], expected_flow(n, t));
+        }
+    }
+    nc_close(ncid);
+}
+
+/**
+ * Test that destroying a writer that was not closed makes no collective call, so one rank unwinding from an error
+ * before the others reach the end of the run does not leave it waiting on them.
+ */
+TEST_F(ParallelNetCDFNexusOutputWriter_Test, TestDestroyWithoutCloseIsLocal) {
+    std::vector<std::string> ids = rank_nexus_ids(mpi_rank);
+    std::unique_ptr<ParallelNetCDFNexusOutputWriter> writer(new ParallelNetCDFNexusOutputWriter(ids, path, 4));
+    for (const auto& id : ids) {
+        writer->write(id, 0, timestamp_of(0), 1.0);
+    }
+    writer->complete_time_step(0, timestamp_of(0));
+
+    // The first rank is destroyed while the others wait for it, which only completes if destroying it is local
+    if (mpi_rank == 0) {
+        ASSERT_NO_THROW(writer.reset());
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+    ASSERT_NO_THROW(writer.reset());
+}
+
+#endif // NETCDF_PARALLEL_ACTIVE
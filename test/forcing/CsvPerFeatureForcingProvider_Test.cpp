@@ -1,6 +1,7 @@
 #include <vector>
 #include "gtest/gtest.h"
 #include "CsvPerFeatureForcingProvider.hpp"
+#include "CsvForcingPreloader.hpp"
 #include "FileChecker.h"
 #include <memory>
 #include <vector>
@@ -10,6 +11,8 @@
 #include <limits.h>
 #include <ctime>
 #include <time.h>
+#include <cstdlib>
+#include <fstream>
 
 class CsvPerFeatureForcingProviderTest : public ::testing::Test {
 
@@ -164,3 +167,143 @@ TEST_F(CsvPerFeatureForcingProviderTest, TestGetAvailableForcingOutputs)
 
 }
 
+
+///Test sharing providers of the same forcing file and simulation period
+TEST_F(CsvPerFeatureForcingProviderTest, TestSharedProvider)
+{
+    std::vector<std::string> forcing_file_names = {
+        "test/data/forcing/cat-10_2015-12-01 00_00_00_2015-12-30 23_00_00.csv",
+        "../test/data/forcing/cat-10_2015-12-01 00_00_00_2015-12-30 23_00_00.csv",
+        "../../test/data/forcing/cat-10_2015-12-01 00_00_00_2015-12-30 23_00_00.csv"
+        };
+    std::string forcing_file_name = utils::FileChecker::find_first_readable(forcing_file_names);
+
+    forcing_params forcing_p(forcing_file_name, "CsvPerFeature", "2015-12-14 21:00:00", "2015-12-30 23:00:00");
+    forcing_params later_p(forcing_file_name, "CsvPerFeature", "2015-12-20 00:00:00", "2015-12-30 23:00:00");
+
+    auto shared = CsvPerFeatureForcingProvider::get_shared_provider(forcing_p);
+    EXPECT_EQ(CsvPerFeatureForcingProvider::get_shared_provider(forcing_p), shared);
+    auto later = CsvPerFeatureForcingProvider::get_shared_provider(later_p);
+    EXPECT_NE(later, shared);
+    EXPECT_EQ(later->get_data_start_time(), later_p.simulation_start_t);
+
+    time_t begin = shared->get_data_start_time();
+    CSVDataSelector selector(CSDMS_STD_NAME_SURFACE_TEMP, begin + 3600, 3600, "K");
+    EXPECT_DOUBLE_EQ(shared->get_value(selector, data_access::MEAN), Forcing_Object->get_value(selector, data_access::MEAN));
+}
+
+///Test that preloaded forcing files are shared with later requests, and that files failing to read are skipped
+TEST_F(CsvPerFeatureForcingProviderTest, TestPreload)
+{
+    std::vector<std::string> forcing_file_names = {
+        "test/data/forcing/cat-89_2015-12-01 00_00_00_2015-12-30 23_00_00.csv",
+        "../test/data/forcing/cat-89_2015-12-01 00_00_00_2015-12-30 23_00_00.csv",
+        "../../test/data/forcing/cat-89_2015-12-01 00_00_00_2015-12-30 23_00_00.csv"
+        };
+    std::string forcing_file_name = utils::FileChecker::find_first_readable(forcing_file_names);
+
+    forcing_params forcing_p(forcing_file_name, "CsvPerFeature", "2015-12-02 00:00:00", "2015-12-30 23:00:00");
+    forcing_params missing_p(forcing_file_name + ".missing", "CsvPerFeature", "2015-12-02 00:00:00", "2015-12-30 23:00:00");
+
+    CsvForcingPreloader preloader({missing_p, forcing_p}, 2);
+    preloader.wait();
+
+    auto shared = CsvPerFeatureForcingProvider::get_shared_provider(forcing_p);
+    EXPECT_EQ(CsvPerFeatureForcingProvider::get_shared_provider(forcing_p), shared);
+    EXPECT_EQ(shared->get_data_start_time(), forcing_p.simulation_start_t);
+    EXPECT_THROW(CsvPerFeatureForcingProvider::get_shared_provider(missing_p), std::runtime_error);
+}
+
+///Test keeping only a window of the time steps of a forcing file in memory
+TEST_F(CsvPerFeatureForcingProviderTest, TestStreamingWindow)
+{
+    std::vector<std::string> forcing_file_names = {
+        "test/data/forcing/cat-10_2015-12-01 00_00_00_2015-12-30 23_00_00.csv",
+        "../test/data/forcing/cat-10_2015-12-01 00_00_00_2015-12-30 23_00_00.csv",
+        "../../test/data/forcing/cat-10_2015-12-01 00_00_00_2015-12-30 23_00_00.csv"
+        };
+    std::string forcing_file_name = utils::FileChecker::find_first_readable(forcing_file_names);
+
+    forcing_params forcing_p(forcing_file_name, "CsvPerFeature", "2015-12-14 21:00:00", "2015-12-30 23:00:00");
+    forcing_p.stream_window_steps = 5;
+    CsvPerFeatureForcingProvider streaming(forcing_p);
+
+    time_t begin = Forcing_Object->get_data_start_time();
+    EXPECT_EQ(streaming.record_duration(), Forcing_Object->record_duration());
+    for (int i = 0; i < 390; i += 3) {
+        // periods of one time step, and of several running across the end of a window
+        for (long duration : {3600L, 3600L * 4}) {
+            CSVDataSelector selector(CSDMS_STD_NAME_LIQUID_EQ_PRECIP_RATE, begin + i * 3600, duration, "");
+            EXPECT_DOUBLE_EQ(streaming.get_value(selector, data_access::SUM), Forcing_Object->get_value(selector, data_access::SUM));
+        }
+    }
+
+    // a time before the window reads the file again
+    CSVDataSelector first(CSDMS_STD_NAME_LIQUID_EQ_PRECIP_RATE, begin, 3600, "");
+    EXPECT_DOUBLE_EQ(streaming.get_value(first, data_access::SUM), Forcing_Object->get_value(first, data_access::SUM));
+}
+
+///Test resampling forcing with a time step other than an hour, to periods both shorter and longer than it
+TEST_F(CsvPerFeatureForcingProviderTest, TestSubHourlyForcing)
+{
+    // 30 minute forcing, with a temperature and a rain rate that are the time step's index
+    char forcing_file_name[] = "/tmp/ngen_subhourly_forcing_XXXXXX";
+    int fd = mkstemp(forcing_file_name);
+    ASSERT_NE(fd, -1);
+    close(fd);
+    {
+        std::ofstream file(forcing_file_name);
+        file << "time,TMP_2maboveground,precip_rate\n";
+        for (int i = 0; i < 8; ++i) {
+            file << "2015-12-01 0" << i / 2 << ":" << (i % 2 == 0 ? "00" : "30") << ":00," << i << "," << i << "\n";
+        }
+    }
+    forcing_params forcing_p(forcing_file_name, "CsvPerFeature", "2015-12-01 00:00:00", "2015-12-01 03:30:00");
+    CsvPerFeatureForcingProvider forcing(forcing_p);
+    time_t begin = forcing.get_data_start_time();
+    EXPECT_EQ(forcing.record_duration(), 1800);
+
+    // a quarter of a time step, a time step, and an hour from the middle of one time step to the middle of another
+    EXPECT_DOUBLE_EQ(forcing.get_value(CSVDataSelector(CSDMS_STD_NAME_SURFACE_TEMP, begin + 1800, 450, ""), data_access::MEAN), 1.0);
+    EXPECT_DOUBLE_EQ(forcing.get_value(CSVDataSelector(CSDMS_STD_NAME_SURFACE_TEMP, begin + 3600, 1800, ""), data_access::MEAN), 2.0);
+    EXPECT_DOUBLE_EQ(forcing.get_value(CSVDataSelector(CSDMS_STD_NAME_SURFACE_TEMP, begin + 2700, 3600, ""), data_access::MEAN), 0.25 * 1.0 + 0.5 * 2.0 + 0.25 * 3.0);
+    // sums over a time step are summed over the period, in proportion to how much of each time step is in it
+    EXPECT_DOUBLE_EQ(forcing.get_value(CSVDataSelector(CSDMS_STD_NAME_LIQUID_EQ_PRECIP_RATE, begin + 2700, 3600, ""), data_access::SUM), 0.5 * 1.0 + 2.0 + 0.5 * 3.0);
+
+    std::remove(forcing_file_name);
+}
+
+///Test that later windows of a streaming provider keep the forcing's own time step, and that a forcing file ending
+///within a requested period holds its last time step for the rest of it
+TEST_F(CsvPerFeatureForcingProviderTest, TestStreamingSubHourlyForcingEnd)
+{
+    // 30 minute forcing, with a temperature and a rain rate that are the time step's index, ending before the model does
+    char forcing_file_name[] = "/tmp/ngen_short_forcing_XXXXXX";
+    int fd = mkstemp(forcing_file_name);
+    ASSERT_NE(fd, -1);
+    close(fd);
+    {
+        std::ofstream file(forcing_file_name);
+        file << "time,TMP_2maboveground,precip_rate\n";
+        for (int i = 0; i < 7; ++i) {
+            file << "2015-12-01 0" << i / 2 << ":" << (i % 2 == 0 ? "00" : "30") << ":00," << i << "," << i << "\n";
+        }
+    }
+    forcing_params forcing_p(forcing_file_name, "CsvPerFeature", "2015-12-01 00:00:00", "2015-12-01 05:00:00");
+    CsvPerFeatureForcingProvider forcing(forcing_p);
+    forcing_p.stream_window_steps = 2;
+    CsvPerFeatureForcingProvider streaming(forcing_p);
+    time_t begin = forcing.get_data_start_time();
+
+    for (CsvPerFeatureForcingProvider* provider : {&forcing, &streaming}) {
+        // the last time step of the file, then from within it past the end of the file
+        EXPECT_DOUBLE_EQ(provider->get_value(CSVDataSelector(CSDMS_STD_NAME_SURFACE_TEMP, begin + 1800 * 5, 3600, ""), data_access::MEAN), 0.5 * 5.0 + 0.5 * 6.0);
+        EXPECT_DOUBLE_EQ(provider->get_value(CSVDataSelector(CSDMS_STD_NAME_SURFACE_TEMP, begin + 1800 * 6, 5400, ""), data_access::MEAN), 6.0);
+        EXPECT_DOUBLE_EQ(provider->get_value(CSVDataSelector(CSDMS_STD_NAME_LIQUID_EQ_PRECIP_RATE, begin + 1800 * 5, 5400, ""), data_access::SUM), 5.0 + 6.0 + 6.0);
+        // a time before the window reads the file again, from its first window on
+        EXPECT_DOUBLE_EQ(provider->get_value(CSVDataSelector(CSDMS_STD_NAME_SURFACE_TEMP, begin + 2700, 3600, ""), data_access::MEAN), 0.25 * 1.0 + 0.5 * 2.0 + 0.25 * 3.0);
+        EXPECT_EQ(provider->record_duration(), 1800);
+    }
+
+    std::remove(forcing_file_name);
+}
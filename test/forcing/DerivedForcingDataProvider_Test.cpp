@@ -0,0 +1,153 @@
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "TrivialForcingProvider.hpp"
+#include "DerivedForcingDataProvider.hpp"
+#include "EtCalcProperty.hpp"
+#include "EtCombinationMethod.hpp"
+
+using namespace data_access;
+
+/**
+ * A trivial provider of the AORC forcing of a few catchments, counting the batches of values it is asked for.
+ */
+class AorcForcingProvider : public test::TrivialForcingProvider {
+public:
+
+    double get_value(const CatchmentAggrDataSelector& selector, data_access::ReSampleMethod m) override {
+        ++requests;
+        const std::string& name = selector.get_variable_name();
+        // The last digit of the id, and the hour, vary the forcing of catchments and time steps
+        double i = selector.get_id().back() - '0' + selector.get_init_time() / 3600;
+        if (name == CSDMS_STD_NAME_SURFACE_TEMP) return 285.0 + i;
+        if (name == NGEN_STD_NAME_SPECIFIC_HUMIDITY) return 0.006 + 0.001 * i;
+        if (name == CSDMS_STD_NAME_SURFACE_AIR_PRESSURE) return 101325.0 - 100.0 * i;
+        if (name == CSDMS_STD_NAME_WIND_U_X) return 3.0;
+        if (name == CSDMS_STD_NAME_WIND_V_Y) return -4.0 * i;
+        if (name == CSDMS_STD_NAME_SOLAR_SHORTWAVE) return 400.0 + 50.0 * i;
+        if (name == CSDMS_STD_NAME_SOLAR_LONGWAVE) return 300.0 + 10.0 * i;
+        return test::TrivialForcingProvider::get_value(selector, m);
+    }
+
+    void get_values_for_ids(const std::vector<std::string>& ids, const CatchmentAggrDataSelector& selector, ReSampleMethod m, double* values) override {
+        ++batches;
+        GenericDataProvider::get_values_for_ids(ids, selector, m, values);
+    }
+
+    int requests = 0;
+    int batches = 0;
+};
+
+class DerivedForcingDataProvider_Test : public ::testing::Test {
+protected:
+
+    /** The potential ET of some AORC forcing, as Bmi_Module_Formulation::calc_et computes it for one catchment. */
+    static double calc_et(AorcForcingProvider& provider, const std::string& id, time_t init_time);
+
+    std::shared_ptr<AorcForcingProvider> backingProvider = std::make_shared<AorcForcingProvider>();
+    std::shared_ptr<const std::vector<std::string>> catchmentIds =
+            std::make_shared<const std::vector<std::string>>(std::vector<std::string>{"cat-1", "cat-2", "cat-3"});
+
+};
+
+double DerivedForcingDataProvider_Test::calc_et(AorcForcingProvider& provider, const std::string& id, time_t init_time) {
+    auto get = [&](const char* name) {
+        return provider.get_value(CatchmentAggrDataSelector(id, name, init_time, 3600, ""), MEAN);
+    };
+    struct et::evapotranspiration_options et_options;
+    et_options.yes_aorc = TRUE;
+    et_options.use_energy_balance_method = FALSE;
+    et_options.use_aerodynamic_method = FALSE;
+    et_options.use_combination_method = TRUE;
+    et_options.use_priestley_taylor_method = FALSE;
+    et_options.use_penman_monteith_method = FALSE;
+
+    struct et::evapotranspiration_forcing et_forcing;
+    et_forcing.air_temperature_C = get(CSDMS_STD_NAME_SURFACE_TEMP) - TK;
+    et_forcing.relative_humidity_percent = -99.9;
+    et_forcing.specific_humidity_2m_kg_per_kg = get(NGEN_STD_NAME_SPECIFIC_HUMIDITY);
+    et_forcing.air_pressure_Pa = get(CSDMS_STD_NAME_SURFACE_AIR_PRESSURE);
+    et_forcing.wind_speed_m_per_s = hypot(get(CSDMS_STD_NAME_WIND_U_X), get(CSDMS_STD_NAME_WIND_V_Y))
+                                    * log(2.0 / 0.0003) / log(10.0 / 0.0003);
+    et_forcing.canopy_resistance_sec_per_m = 50.0;
+    et_forcing.water_temperature_C = 15.5;
+    et_forcing.ground_heat_flux_W_per_sq_m = -10.0;
+
+    struct et::evapotranspiration_params et_params;
+    et_params.vegetation_height_m = 0.12;
+    et_params.zero_plane_displacement_height_m = 0.0003;
+    et_params.momentum_transfer_roughness_length_m = 0.0;
+    et_params.heat_transfer_roughness_length_m = 0.0;
+    et_params.wind_speed_measurement_height_m = 2.0;
+    et_params.humidity_measurement_height_m = 2.0;
+
+    struct et::surface_radiation_params surf_rad_params;
+    surf_rad_params.surface_longwave_emissivity = 1.0;
+    surf_rad_params.surface_shortwave_albedo = 0.22;
+    struct et::surface_radiation_forcing surf_rad_forcing;
+    surf_rad_forcing.incoming_shortwave_radiation_W_per_sq_m = get(CSDMS_STD_NAME_SOLAR_SHORTWAVE);
+    surf_rad_forcing.incoming_longwave_radiation_W_per_sq_m = get(CSDMS_STD_NAME_SOLAR_LONGWAVE);
+    surf_rad_forcing.air_temperature_C = et_forcing.air_temperature_C;
+    surf_rad_forcing.relative_humidity_percent = 100.0 * et_forcing.specific_humidity_2m_kg_per_kg
+            * et_forcing.air_pressure_Pa / 0.622 / et::calc_air_saturation_vapor_pressure_Pa(et_forcing.air_temperature_C);
+    if (100.0 < surf_rad_forcing.relative_humidity_percent) {
+        surf_rad_forcing.relative_humidity_percent = 99.0;
+    }
+    surf_rad_forcing.surface_skin_temperature_C = 12.0;
+    et_forcing.net_radiation_W_per_sq_m = et::calculate_net_radiation_W_per_sq_m(&et_options, &surf_rad_params,
+                                                                                 &surf_rad_forcing);
+    struct et::intermediate_vars inter_vars;
+    return et::combined::evapotranspiration_combination_method(&et_options, &et_params, &et_forcing, &inter_vars);
+}
+
+/**
+ * Test that derived wind speed and potential ET are those formulations compute, and that other properties are passed
+ * through.
+ */
+TEST_F(DerivedForcingDataProvider_Test, TestDerivedValues) {
+    DerivedForcingDataProvider provider(backingProvider, {NGEN_STD_NAME_WIND_SPEED, NGEN_STD_NAME_POTENTIAL_ET_FOR_TIME_STEP},
+                                        catchmentIds);
+    for (time_t t = 0; t < 3 * 3600; t += 3600) {
+        for (const std::string& id : *catchmentIds) {
+            double i = id.back() - '0' + t / 3600;
+            EXPECT_DOUBLE_EQ(provider.get_value(CatchmentAggrDataSelector(id, NGEN_STD_NAME_WIND_SPEED, t, 3600, "m s^-1"), MEAN),
+                             hypot(3.0, 4.0 * i));
+            double expected_et = calc_et(*backingProvider, id, t);
+            EXPECT_NEAR(provider.get_value(CatchmentAggrDataSelector(id, NGEN_STD_NAME_POTENTIAL_ET_FOR_TIME_STEP, t, 3600, "m s^-1"), MEAN),
+                        expected_et, std::fabs(expected_et) * 1e-12);
+            EXPECT_EQ(provider.get_value(CatchmentAggrDataSelector(id, CSDMS_STD_NAME_POTENTIAL_ET, t, 3600, "m s^-1"), MEAN),
+                      provider.get_value(CatchmentAggrDataSelector(id, NGEN_STD_NAME_POTENTIAL_ET_FOR_TIME_STEP, t, 3600, "m s^-1"), MEAN));
+        }
+    }
+    EXPECT_EQ(provider.get_value(CatchmentAggrDataSelector("cat-1", OUTPUT_NAME_1, 0, 3600, "m"), SUM), OUTPUT_VALUE_1);
+    EXPECT_THROW(DerivedForcingDataProvider(backingProvider, {OUTPUT_NAME_1}), std::invalid_argument);
+}
+
+/**
+ * Test that the derived properties of every catchment are computed at once, a batch of raw values per input and time
+ * step, however many times or for whichever catchment they are requested.
+ */
+TEST_F(DerivedForcingDataProvider_Test, TestComputedOncePerTimeStep) {
+    DerivedForcingDataProvider provider(backingProvider, {NGEN_STD_NAME_POTENTIAL_ET_FOR_TIME_STEP}, catchmentIds);
+    std::vector<double> values(catchmentIds->size());
+    provider.get_values_for_ids(*catchmentIds, CatchmentAggrDataSelector("", NGEN_STD_NAME_POTENTIAL_ET_FOR_TIME_STEP, 0, 3600, "m s^-1"), MEAN, values.data());
+    for (const std::string& id : *catchmentIds) {
+        provider.get_value(CatchmentAggrDataSelector(id, NGEN_STD_NAME_POTENTIAL_ET_FOR_TIME_STEP, 0, 3600, "m s^-1"), MEAN);
+    }
+    // the seven inputs, each for the three catchments
+    EXPECT_EQ(backingProvider->batches, 7);
+    EXPECT_EQ(backingProvider->requests, 21);
+
+    // a catchment of none of the batches is computed on its own
+    provider.get_value(CatchmentAggrDataSelector("cat-4", NGEN_STD_NAME_POTENTIAL_ET_FOR_TIME_STEP, 0, 3600, "m s^-1"), MEAN);
+    EXPECT_EQ(backingProvider->batches, 14);
+    EXPECT_EQ(backingProvider->requests, 28);
+
+    // and then with the others in the next time step
+    provider.get_value(CatchmentAggrDataSelector("cat-2", NGEN_STD_NAME_POTENTIAL_ET_FOR_TIME_STEP, 3600, 3600, "m s^-1"), MEAN);
+    EXPECT_EQ(backingProvider->batches, 21);
+    EXPECT_EQ(backingProvider->requests, 56);
+    EXPECT_EQ(values[1], provider.get_value(CatchmentAggrDataSelector("cat-2", NGEN_STD_NAME_POTENTIAL_ET_FOR_TIME_STEP, 0, 3600, "m s^-1"), MEAN));
+}
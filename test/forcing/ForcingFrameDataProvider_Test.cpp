@@ -0,0 +1,59 @@
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "TrivialForcingProvider.hpp"
+#include "ForcingFrameDataProvider.hpp"
+
+using namespace data_access;
+
+/**
+ * A trivial provider counting the values it is asked for, whose values differ by time period and units.
+ */
+class CountingForcingProvider : public test::TrivialForcingProvider {
+public:
+
+    double get_value(const CatchmentAggrDataSelector& selector, data_access::ReSampleMethod m) override {
+        ++requests;
+        double value = test::TrivialForcingProvider::get_value(selector, m) + selector.get_init_time();
+        return selector.get_output_units() == "mm" ? value * 1000.0 : value;
+    }
+
+    int requests = 0;
+};
+
+class ForcingFrameDataProvider_Test : public ::testing::Test {
+protected:
+
+    CountingForcingProvider backingProvider;
+
+};
+
+/**
+ * Test that a value requested by several consumers in a time step is fetched once.
+ */
+TEST_F(ForcingFrameDataProvider_Test, TestValueFetchedOncePerTimeStep) {
+    ForcingFrameDataProvider frame(&backingProvider);
+    for (int consumer = 0; consumer < 3; ++consumer) {
+        EXPECT_EQ(frame.get_value(CatchmentAggrDataSelector("cat-1", OUTPUT_NAME_1, 0, 3600, "m"), SUM), OUTPUT_VALUE_1);
+    }
+    EXPECT_EQ(backingProvider.requests, 1);
+    EXPECT_EQ(frame.get_frame_size(), 1);
+}
+
+/**
+ * Test that values in other units, resampled otherwise or for another time period are fetched on their own.
+ */
+TEST_F(ForcingFrameDataProvider_Test, TestFrameKeys) {
+    ForcingFrameDataProvider frame(&backingProvider);
+    EXPECT_EQ(frame.get_value(CatchmentAggrDataSelector("cat-1", OUTPUT_NAME_1, 0, 3600, "m"), SUM), OUTPUT_VALUE_1);
+    EXPECT_EQ(frame.get_value(CatchmentAggrDataSelector("cat-1", OUTPUT_NAME_1, 0, 3600, "mm"), SUM), OUTPUT_VALUE_1 * 1000.0);
+    frame.get_value(CatchmentAggrDataSelector("cat-1", OUTPUT_NAME_1, 0, 3600, "m"), MEAN);
+    EXPECT_EQ(backingProvider.requests, 3);
+    EXPECT_EQ(frame.get_frame_size(), 3);
+
+    // the next time step starts a new frame
+    EXPECT_EQ(frame.get_value(CatchmentAggrDataSelector("cat-1", OUTPUT_NAME_1, 3600, 3600, "m"), SUM), OUTPUT_VALUE_1 + 3600);
+    EXPECT_EQ(frame.get_value(CatchmentAggrDataSelector("cat-1", OUTPUT_NAME_1, 3600, 3600, "m"), SUM), OUTPUT_VALUE_1 + 3600);
+    EXPECT_EQ(backingProvider.requests, 4);
+    EXPECT_EQ(frame.get_frame_size(), 1);
+}
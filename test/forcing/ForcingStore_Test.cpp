@@ -0,0 +1,213 @@
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "ForcingStore.hpp"
+#include "ForcingStoreDataProvider.hpp"
+#include "CsvPerFeatureForcingProvider.hpp"
+#include "FileChecker.h"
+#include "RemoteObject.hpp"
+
+using data_access::ForcingStore;
+using data_access::ForcingStoreWriter;
+using data_access::ForcingStoreDataProvider;
+
+class ForcingStoreTest : public ::testing::Test {
+
+    protected:
+
+    ForcingStoreTest() {
+
+    }
+
+    ~ForcingStoreTest() override {
+
+    }
+
+    void SetUp() override {
+        store_path = "forcing_store_test_" + std::to_string(::getpid()) + ".ngenf";
+    }
+
+    void TearDown() override {
+        std::remove(store_path.c_str());
+    }
+
+    //! Write a store of 3 catchments, 2 variables and 4 hourly time steps, valued ``t * 100 + v * 10 + id``.
+    void write_store() {
+        ForcingStoreWriter writer(store_path, {"cat-1", "cat-2", "cat-3"}, {{"A", "m"}, {"B", ""}}, start, 3600, 4);
+        // the first catchment alone, then the other two in a batch
+        std::vector<double> first, rest;
+        for( size_t t = 0; t < 4; ++t ) {
+            for( size_t v = 0; v < 2; ++v ) {
+                first.push_back(t * 100.0 + v * 10.0);
+                rest.push_back(t * 100.0 + v * 10.0 + 1);
+                rest.push_back(t * 100.0 + v * 10.0 + 2);
+            }
+        }
+        writer.write_catchments(0, 1, first.data());
+        writer.write_catchments(1, 2, rest.data());
+        writer.close();
+    }
+
+    static std::string find_forcing_file(const std::string& name) {
+        return utils::FileChecker::find_first_readable({
+            "test/data/forcing/" + name,
+            "../test/data/forcing/" + name,
+            "../../test/data/forcing/" + name
+        });
+    }
+
+    std::string store_path;
+    const time_t start = 1448928000; // 2015-12-01 00:00:00
+};
+
+//! Test that written values are stored by time step, variable and catchment.
+TEST_F(ForcingStoreTest, TestWriteAndRead) {
+    write_store();
+    ForcingStore store(store_path);
+
+    ASSERT_EQ(store.get_ids(), std::vector<std::string>({"cat-1", "cat-2", "cat-3"}));
+    ASSERT_EQ(store.get_variable_names(), std::vector<std::string>({"A", "B"}));
+    ASSERT_EQ(store.get_variable_units(), std::vector<std::string>({"m", ""}));
+    ASSERT_EQ(store.get_num_times(), 4);
+    ASSERT_EQ(store.get_start_time(), start);
+    ASSERT_EQ(store.get_time_step(), 3600);
+
+    for( size_t t = 0; t < 4; ++t ) {
+        for( size_t v = 0; v < 2; ++v ) {
+            const double* record = store.record(t, v);
+            for( size_t i = 0; i < 3; ++i ) {
+                EXPECT_EQ(record[i], t * 100.0 + v * 10.0 + i);
+            }
+        }
+        store.will_need(t);
+    }
+    EXPECT_EQ(store.get_id_index("cat-3"), 2);
+    EXPECT_EQ(store.get_variable_index("B"), 1);
+    EXPECT_THROW(store.get_id_index("cat-4"), std::out_of_range);
+    EXPECT_THROW(store.get_variable_index("C"), std::out_of_range);
+}
+
+//! Test that a store in object storage is read as the same store on disk.
+TEST_F(ForcingStoreTest, TestReadRemote) {
+    write_store();
+    std::string contents;
+    {
+        std::ifstream in(store_path, std::ios::binary);
+        contents.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    data_access::RemoteObject::Fetcher fetcher;
+    fetcher.stat = [&contents](const std::string&) {
+        data_access::RemoteObject::Info info;
+        info.size = contents.size();
+        return info;
+    };
+    fetcher.range = [&contents](const std::string&, std::uint64_t offset, std::uint64_t length) {
+        return contents.substr(offset, length);
+    };
+    ForcingStore store(std::make_shared<data_access::RemoteObject>("s3://bucket/forcing.ngenf", fetcher, nullptr, 1024, 2));
+
+    ASSERT_EQ(store.get_ids(), std::vector<std::string>({"cat-1", "cat-2", "cat-3"}));
+    ASSERT_EQ(store.get_variable_units(), std::vector<std::string>({"m", ""}));
+    ASSERT_EQ(store.get_num_times(), 4);
+    store.will_need(2);
+    for( size_t t : {3, 0, 2, 1} ) {
+        for( size_t v = 0; v < 2; ++v ) {
+            const double* record = store.record(t, v);
+            for( size_t i = 0; i < 3; ++i ) {
+                EXPECT_EQ(record[i], t * 100.0 + v * 10.0 + i);
+            }
+        }
+    }
+}
+
+//! Test that other files are rejected.
+TEST_F(ForcingStoreTest, TestNotAStore) {
+    {
+        std::ofstream out(store_path);
+        out << "Time,A\n2015-12-01 00:00:00,1.0\n";
+    }
+    EXPECT_THROW(ForcingStore store(store_path), std::runtime_error);
+    EXPECT_THROW(ForcingStore store("no_such_forcing_store.ngenf"), std::runtime_error);
+}
+
+//! Test that the provider weights the time steps partly in a period by their overlap.
+TEST_F(ForcingStoreTest, TestProviderResampling) {
+    write_store();
+    ForcingStoreDataProvider provider(store_path, start, start + 4 * 3600);
+
+    EXPECT_EQ(provider.record_duration(), 3600);
+    EXPECT_EQ(provider.get_ts_index_for_time(start + 3599), 0);
+    EXPECT_EQ(provider.get_ts_index_for_time(start + 3600), 1);
+    EXPECT_THROW(provider.get_ts_index_for_time(start + 4 * 3600), std::out_of_range);
+
+    // an aligned time step
+    EXPECT_DOUBLE_EQ(provider.get_value(CatchmentAggrDataSelector("cat-2", "B", start + 3600, 3600, ""), data_access::SUM), 111.0);
+    EXPECT_DOUBLE_EQ(provider.get_value(CatchmentAggrDataSelector("cat-2", "B", start + 3600, 3600, ""), data_access::MEAN), 111.0);
+    // half of each of two time steps
+    EXPECT_DOUBLE_EQ(provider.get_value(CatchmentAggrDataSelector("cat-3", "B", start + 1800, 3600, ""), data_access::SUM), 62.0);
+    EXPECT_DOUBLE_EQ(provider.get_value(CatchmentAggrDataSelector("cat-3", "B", start + 1800, 3600, ""), data_access::MEAN), 62.0);
+    // two whole time steps
+    EXPECT_DOUBLE_EQ(provider.get_value(CatchmentAggrDataSelector("cat-1", "B", start, 7200, ""), data_access::SUM), 120.0);
+    EXPECT_DOUBLE_EQ(provider.get_value(CatchmentAggrDataSelector("cat-1", "B", start, 7200, ""), data_access::MEAN), 60.0);
+    // a quarter of a time step
+    EXPECT_DOUBLE_EQ(provider.get_value(CatchmentAggrDataSelector("cat-1", "B", start + 900, 900, ""), data_access::SUM), 2.5);
+    EXPECT_DOUBLE_EQ(provider.get_value(CatchmentAggrDataSelector("cat-1", "B", start + 900, 900, ""), data_access::MEAN), 10.0);
+
+    EXPECT_THROW(provider.get_value(CatchmentAggrDataSelector("cat-9", "B", start, 3600, ""), data_access::SUM), std::out_of_range);
+    EXPECT_THROW(provider.get_value(CatchmentAggrDataSelector("cat-1", "B", start - 1, 3600, ""), data_access::SUM), std::out_of_range);
+}
+
+//! Test that a store converted from CSV forcing gives the values of the CSV provider, for one or many catchments.
+TEST_F(ForcingStoreTest, TestConvertCsvForcing) {
+    std::string cat_10 = find_forcing_file("cat-10_2015-12-01 00_00_00_2015-12-30 23_00_00.csv");
+    std::string cat_89 = find_forcing_file("cat-89_2015-12-01 00_00_00_2015-12-30 23_00_00.csv");
+    ASSERT_FALSE(cat_10.empty());
+    ASSERT_FALSE(cat_89.empty());
+
+    // a budget under one catchment still converts, one catchment at a time
+    data_access::convert_csv_forcing({{"cat-89", cat_89}, {"cat-10", cat_10}}, store_path, 0);
+
+    forcing_params params_10(cat_10, "CsvPerFeature", "2015-12-01 00:00:00", "2015-12-30 23:00:00");
+    forcing_params params_89(cat_89, "CsvPerFeature", "2015-12-01 00:00:00", "2015-12-30 23:00:00");
+    CsvPerFeatureForcingProvider csv_10(params_10);
+    CsvPerFeatureForcingProvider csv_89(params_89);
+    ForcingStoreDataProvider provider(store_path, params_10.simulation_start_t, params_10.simulation_end_t);
+
+    ASSERT_EQ(provider.get_ids(), std::vector<std::string>({"cat-89", "cat-10"}));
+    const std::vector<std::string>& names = provider.get_avaliable_variable_names();
+    EXPECT_TRUE(std::find(names.begin(), names.end(), "APCP_surface") != names.end());
+    EXPECT_TRUE(std::find(names.begin(), names.end(), CSDMS_STD_NAME_SURFACE_TEMP) != names.end());
+
+    const time_t begin = params_10.simulation_start_t;
+    for( int i : {0, 65, 400, 719} ) {
+        for( const std::string& name : {std::string("TMP_2maboveground"), std::string(CSDMS_STD_NAME_LIQUID_EQ_PRECIP_RATE)} ) {
+            CatchmentAggrDataSelector selector("", name, begin + i * 3600, 3600, "");
+            double expected_10 = csv_10.get_value(selector, data_access::SUM);
+            double expected_89 = csv_89.get_value(selector, data_access::SUM);
+            EXPECT_DOUBLE_EQ(provider.get_value(CatchmentAggrDataSelector("cat-10", name, begin + i * 3600, 3600, ""), data_access::SUM), expected_10);
+
+            double values[2];
+            provider.get_values_for_ids({"cat-10", "cat-89"}, selector, data_access::SUM, values);
+            EXPECT_DOUBLE_EQ(values[0], expected_10);
+            EXPECT_DOUBLE_EQ(values[1], expected_89);
+        }
+    }
+}
+
+//! Test that files not matching the first file are rejected.
+TEST_F(ForcingStoreTest, TestConvertMismatchedCsvForcing) {
+    std::string cat_10 = find_forcing_file("cat-10_2015-12-01 00_00_00_2015-12-30 23_00_00.csv");
+    std::string other = find_forcing_file("cat-27115-nwm-aorc-variant-derived-format.csv");
+    ASSERT_FALSE(cat_10.empty());
+    ASSERT_FALSE(other.empty());
+
+    EXPECT_THROW(data_access::convert_csv_forcing({{"cat-10", cat_10}, {"cat-27115", other}}, store_path), std::runtime_error);
+    EXPECT_THROW(data_access::convert_csv_forcing({}, store_path), std::runtime_error);
+}
@@ -0,0 +1,173 @@
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+
+#include <boost/geometry.hpp>
+
+#include "GridWeights.hpp"
+
+using data_access::GridSpec;
+using data_access::GridWeights;
+
+class GridWeightsTest : public ::testing::Test {
+
+    protected:
+
+    void SetUp() override {
+        weights_path = "grid_weights_test_" + std::to_string(::getpid()) + ".ngenw";
+        // 4 x 3 cells of 1 x 1, rows from north to south, the centers of the first at (0.5, 2.5)
+        grid.x_first = 0.5;
+        grid.y_first = 2.5;
+        grid.dx = 1.0;
+        grid.dy = -1.0;
+        grid.nx = 4;
+        grid.ny = 3;
+    }
+
+    void TearDown() override {
+        std::remove(weights_path.c_str());
+    }
+
+    //! A square, wound counterclockwise as in GeoJSON.
+    static GridWeights::multipolygon_t square(double x1, double y1, double x2, double y2) {
+        GridWeights::polygon_t polygon;
+        boost::geometry::append(polygon, GridWeights::point_t(x1, y1));
+        boost::geometry::append(polygon, GridWeights::point_t(x2, y1));
+        boost::geometry::append(polygon, GridWeights::point_t(x2, y2));
+        boost::geometry::append(polygon, GridWeights::point_t(x1, y2));
+        boost::geometry::append(polygon, GridWeights::point_t(x1, y1));
+        return GridWeights::multipolygon_t{polygon};
+    }
+
+    //! The cells of the grid valued ``row * 10 + column``, row after row.
+    std::vector<double> grid_values() const {
+        std::vector<double> values;
+        for( size_t row = 0; row < grid.ny; ++row ) {
+            for( size_t column = 0; column < grid.nx; ++column ) {
+                values.push_back(row * 10.0 + column);
+            }
+        }
+        return values;
+    }
+
+    //! The values of the cells of the window of @p weights.
+    std::vector<double> window_values(const GridWeights& weights, const std::vector<double>& values) const {
+        std::vector<double> window;
+        for( size_t row = 0; row < weights.get_window_rows(); ++row ) {
+            for( size_t column = 0; column < weights.get_window_columns(); ++column ) {
+                window.push_back(values[(weights.get_window_row() + row) * grid.nx + weights.get_window_column() + column]);
+            }
+        }
+        return window;
+    }
+
+    GridSpec grid;
+    std::string weights_path;
+};
+
+//! Catchments get the area weighted mean of the cells they overlap, out of the window of every overlapped cell.
+TEST_F(GridWeightsTest, TestAreaWeightedMean) {
+    GridWeights weights = GridWeights::compute(grid, {
+        // all of the cell at row 0, column 1
+        {"cat-1", square(1.0, 2.0, 2.0, 3.0)},
+        // half of each of the cells at row 1, columns 1 and 2
+        {"cat-2", square(1.5, 1.0, 2.5, 2.0)},
+        // outside of the grid
+        {"cat-3", square(10.0, 10.0, 11.0, 11.0)}
+    });
+
+    ASSERT_EQ(weights.size(), 3);
+    EXPECT_EQ(weights.get_window_row(), 0);
+    EXPECT_EQ(weights.get_window_column(), 1);
+    EXPECT_EQ(weights.get_window_rows(), 2);
+    EXPECT_EQ(weights.get_window_columns(), 2);
+    EXPECT_EQ(weights.nonzeros(), 3);
+    EXPECT_TRUE(weights.has_cells(weights.get_index("cat-1")));
+    EXPECT_FALSE(weights.has_cells(weights.get_index("cat-3")));
+    EXPECT_EQ(weights.get_index("cat-4"), weights.size());
+
+    std::vector<double> window = window_values(weights, grid_values());
+    std::vector<double> values(weights.size());
+    weights.apply(window.data(), values.data());
+    EXPECT_DOUBLE_EQ(values[0], 1.0);
+    EXPECT_DOUBLE_EQ(values[1], 11.5);
+    EXPECT_TRUE(std::isnan(values[2]));
+}
+
+//! Missing cell values are left out of the mean of the others.
+TEST_F(GridWeightsTest, TestMissingValues) {
+    GridWeights weights = GridWeights::compute(grid, {{"cat-1", square(0.0, 0.0, 1.0, 2.0)}});
+    std::vector<double> window = window_values(weights, grid_values());
+    ASSERT_EQ(window.size(), 2);
+
+    double value;
+    weights.apply(window.data(), &value);
+    EXPECT_DOUBLE_EQ(value, 15.0);
+
+    window[1] = std::nan("");
+    weights.apply(window.data(), &value);
+    EXPECT_DOUBLE_EQ(value, 10.0);
+}
+
+//! Weights read back from a file are those written.
+TEST_F(GridWeightsTest, TestWriteRead) {
+    GridWeights weights = GridWeights::compute(grid, {
+        {"cat-1", square(0.25, 0.25, 3.0, 2.0)},
+        {"cat-2", square(2.5, 1.5, 4.0, 3.0)}
+    });
+    weights.write(weights_path);
+    GridWeights read = GridWeights::read(weights_path);
+
+    EXPECT_TRUE(read.get_grid() == grid);
+    EXPECT_EQ(read.get_ids(), weights.get_ids());
+    EXPECT_EQ(read.nonzeros(), weights.nonzeros());
+    EXPECT_EQ(read.get_window_rows(), weights.get_window_rows());
+    EXPECT_EQ(read.get_window_columns(), weights.get_window_columns());
+
+    std::vector<double> window = window_values(weights, grid_values());
+    std::vector<double> expected(2), values(2);
+    weights.apply(window.data(), expected.data());
+    read.apply(window.data(), values.data());
+    EXPECT_EQ(values, expected);
+}
+
+//! The weights of some catchments keep their values, over the window of just their cells.
+TEST_F(GridWeightsTest, TestSubset) {
+    GridWeights weights = GridWeights::compute(grid, {
+        {"cat-1", square(0.0, 2.0, 1.0, 3.0)},
+        {"cat-2", square(2.5, 0.0, 4.0, 2.0)},
+        {"cat-3", square(1.0, 0.5, 2.0, 1.5)}
+    });
+    GridWeights subset = weights.subset({"cat-3", "cat-2"});
+
+    ASSERT_EQ(subset.size(), 2);
+    EXPECT_EQ(subset.get_index("cat-1"), subset.size());
+    EXPECT_EQ(subset.get_window_row(), 1);
+    EXPECT_EQ(subset.get_window_column(), 1);
+    EXPECT_EQ(subset.get_window_rows(), 2);
+    EXPECT_EQ(subset.get_window_columns(), 3);
+
+    std::vector<double> all_values(3), values(2);
+    std::vector<double> window = window_values(weights, grid_values());
+    weights.apply(window.data(), all_values.data());
+    window = window_values(subset, grid_values());
+    subset.apply(window.data(), values.data());
+    EXPECT_DOUBLE_EQ(values[0], all_values[2]);
+    EXPECT_DOUBLE_EQ(values[1], all_values[1]);
+
+    EXPECT_THROW(weights.subset({"cat-4"}), std::out_of_range);
+}
+
+//! Files that are not weights are refused.
+TEST_F(GridWeightsTest, TestReadNotWeights) {
+    FILE* file = std::fopen(weights_path.c_str(), "w");
+    std::fputs("not weights", file);
+    std::fclose(file);
+    EXPECT_THROW(GridWeights::read(weights_path), std::runtime_error);
+}
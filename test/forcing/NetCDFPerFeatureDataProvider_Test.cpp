@@ -12,6 +12,8 @@
 #include <limits.h>
 #include <ctime>
 #include <time.h>
+#include <chrono>
+#include <thread>
 
 
 using data_access::NetCDFPerFeatureDataProvider;
@@ -28,6 +30,12 @@ class NetCDFPerFeatureDataProviderTest : public ::testing::Test {
 
     std::shared_ptr<data_access::NetCDFPerFeatureDataProvider> nc_provider;
 
+    std::string forcing_file_name;
+
+    time_t sim_start;
+
+    time_t sim_end;
+
     typedef struct tm time_type;
 
     std::shared_ptr<time_type> start_date_time;
@@ -56,12 +64,14 @@ void NetCDFPerFeatureDataProviderTest::setupForcing()
         "../data/forcing/cats-27_52_67-2015_12_01-2015_12_30.nc",
         "../../data/forcing/cats-27_52_67-2015_12_01-2015_12_30.nc"
         };
-    std::string forcing_file_name = utils::FileChecker::find_first_readable(forcing_file_names);
+    forcing_file_name = utils::FileChecker::find_first_readable(forcing_file_names);
 
     // Using this to compute epoch times... this is what's done in Formulation_Constructors.hpp, FWIW...
     forcing_params forcing_p(forcing_file_name, "NetCDF", "2015-12-01 00:00:00", "2015-12-30 23:00:00");
 
-    nc_provider = std::make_shared<data_access::NetCDFPerFeatureDataProvider>(forcing_file_name, forcing_p.simulation_start_t, forcing_p.simulation_end_t, utils::getStdErr() );
+    sim_start = forcing_p.simulation_start_t;
+    sim_end = forcing_p.simulation_end_t;
+    nc_provider = std::make_shared<data_access::NetCDFPerFeatureDataProvider>(forcing_file_name, sim_start, sim_end, utils::getStdErr() );
     start_date_time = std::make_shared<time_type>();
     end_date_time = std::make_shared<time_type>();
 }
@@ -112,4 +122,141 @@ TEST_F(NetCDFPerFeatureDataProviderTest, TestForcingDataRead)
         std::runtime_error);
     
 }
+///Test reading values ahead of their use
+TEST_F(NetCDFPerFeatureDataProviderTest, TestRequestValue)
+{
+    auto start_time = nc_provider->get_data_start_time();
+    auto ids = nc_provider->get_ids();
+    auto duration = nc_provider->record_duration();
+
+    // the first value of a later day, so it is not read on a previous request
+    NetCDFDataSelector selector(ids[1], CSDMS_STD_NAME_SURFACE_TEMP, start_time + duration * 24 * 10, duration, "K");
+    double expected = nc_provider->get_value(selector, data_access::MEAN);
+
+    auto reader = std::make_shared<data_access::NetCDFPerFeatureDataProvider>(forcing_file_name, sim_start, sim_end, utils::getStdErr());
+    reader->request_value(selector);
+    for( int i = 0; i < 1000 && !reader->value_ready(selector); ++i ) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_TRUE(reader->value_ready(selector));
+    EXPECT_DOUBLE_EQ(reader->get_value(selector, data_access::MEAN), expected);
+
+    // the block after the one just used is read in the background
+    NetCDFDataSelector next(ids[1], CSDMS_STD_NAME_SURFACE_TEMP, start_time + duration * 24 * 11, duration, "K");
+    for( int i = 0; i < 1000 && !reader->value_ready(next); ++i ) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_TRUE(reader->value_ready(next));
+
+    // without read ahead, requested values are read before returning
+    auto on_demand = std::make_shared<data_access::NetCDFPerFeatureDataProvider>(forcing_file_name, sim_start, sim_end, utils::getStdErr(), 0, 0);
+    ASSERT_FALSE(on_demand->value_ready(selector));
+    on_demand->request_value(selector);
+    ASSERT_TRUE(on_demand->value_ready(selector));
+}
+///Test that threads reading the same and different variables concurrently get the values of a single reader
+TEST_F(NetCDFPerFeatureDataProviderTest, TestConcurrentReads)
+{
+    auto start_time = nc_provider->get_data_start_time();
+    auto ids = nc_provider->get_ids();
+    auto duration = nc_provider->record_duration();
+    const std::vector<std::string> variables = {CSDMS_STD_NAME_SURFACE_TEMP, CSDMS_STD_NAME_SURFACE_AIR_PRESSURE};
+    const std::vector<std::string> units = {"K", "Pa"};
+    const int steps = 24 * 5;
+
+    auto expected_value = [&](size_t thread, int step) {
+        size_t v = thread % variables.size();
+        NetCDFDataSelector selector(ids[thread % ids.size()], variables[v], start_time + duration * step, duration, units[v]);
+        return nc_provider->get_value(selector, data_access::MEAN);
+    };
+    const size_t thread_count = 8;
+    std::vector<std::vector<double>> expected(thread_count);
+    for( size_t t = 0; t < thread_count; ++t ) {
+        for( int step = 0; step < steps; ++step ) {
+            expected[t].push_back(expected_value(t, step));
+        }
+    }
+
+    // a new provider, so the threads race to read each slab, with some reading ahead in the background meanwhile
+    auto shared = std::make_shared<data_access::NetCDFPerFeatureDataProvider>(forcing_file_name, sim_start, sim_end, utils::getStdErr());
+    std::vector<std::vector<double>> actual(thread_count);
+    std::vector<std::thread> threads;
+    for( size_t t = 0; t < thread_count; ++t ) {
+        threads.emplace_back([&, t]() {
+            size_t v = t % variables.size();
+            for( int step = 0; step < steps; ++step ) {
+                NetCDFDataSelector selector(ids[t % ids.size()], variables[v], start_time + duration * step, duration, units[v]);
+                actual[t].push_back(shared->get_value(selector, data_access::MEAN));
+            }
+        });
+    }
+    for( auto& thread : threads ) {
+        thread.join();
+    }
+    for( size_t t = 0; t < thread_count; ++t ) {
+        ASSERT_EQ(actual[t].size(), expected[t].size());
+        for( int step = 0; step < steps; ++step ) {
+            EXPECT_DOUBLE_EQ(actual[t][step], expected[t][step]);
+        }
+    }
+}
+///Test reading values for all catchments at once
+TEST_F(NetCDFPerFeatureDataProviderTest, TestValuesForIds)
+{
+    auto start_time = nc_provider->get_data_start_time();
+    auto ids = nc_provider->get_ids();
+    auto duration = nc_provider->record_duration();
+
+    NetCDFDataSelector selector(ids[0], CSDMS_STD_NAME_SURFACE_TEMP, start_time + duration * 3, duration * 4, "K");
+    std::vector<double> values(ids.size());
+    nc_provider->get_values_for_ids(ids, selector, data_access::MEAN, values.data());
+
+    for( size_t i = 0; i < ids.size(); ++i ) {
+        NetCDFDataSelector single(ids[i], CSDMS_STD_NAME_SURFACE_TEMP, start_time + duration * 3, duration * 4, "K");
+        EXPECT_DOUBLE_EQ(values[i], nc_provider->get_value(single, data_access::MEAN));
+    }
+
+    EXPECT_THROW(nc_provider->get_values_for_ids({"cat-does-not-exist"}, selector, data_access::MEAN, values.data()), std::out_of_range);
+}
+///Test reading only the rows of a subset of the catchments
+TEST_F(NetCDFPerFeatureDataProviderTest, TestFeatureSubset)
+{
+    auto start_time = nc_provider->get_data_start_time();
+    auto ids = nc_provider->get_ids();
+    auto duration = nc_provider->record_duration();
+    ASSERT_GE(ids.size(), 3);
+
+    // rows that are not neighbors in the file, which are read as separate runs
+    auto feature_ids = std::make_shared<const std::vector<std::string>>(std::vector<std::string>{ids[2], ids[0], "cat-does-not-exist"});
+    auto subset = std::make_shared<data_access::NetCDFPerFeatureDataProvider>(forcing_file_name, sim_start, sim_end, utils::getStdErr(), 0, 1, feature_ids);
+    ASSERT_EQ(subset->get_ids(), ids);
+
+    for( size_t i : {0, 2} ) {
+        NetCDFDataSelector selector(ids[i], CSDMS_STD_NAME_SURFACE_TEMP, start_time + duration * 3, duration * 4, "K");
+        EXPECT_DOUBLE_EQ(subset->get_value(selector, data_access::MEAN), nc_provider->get_value(selector, data_access::MEAN));
+    }
+
+    NetCDFDataSelector outside(ids[1], CSDMS_STD_NAME_SURFACE_TEMP, start_time, duration, "K");
+    EXPECT_THROW(subset->get_value(outside, data_access::MEAN), std::out_of_range);
+}
+///Test values for periods at the end of the data, and for one period resampled differently
+TEST_F(NetCDFPerFeatureDataProviderTest, TestWindowAtDataEnd)
+{
+    auto ids = nc_provider->get_ids();
+    auto duration = nc_provider->record_duration();
+    auto last_start = nc_provider->get_data_stop_time() - duration;
+
+    // a period running past the last time step ends at it
+    NetCDFDataSelector last(ids[0], CSDMS_STD_NAME_SURFACE_TEMP, last_start, duration, "K");
+    NetCDFDataSelector past_end(ids[0], CSDMS_STD_NAME_SURFACE_TEMP, last_start, duration * 4, "K");
+    double last_sum = nc_provider->get_value(last, data_access::SUM);
+    EXPECT_DOUBLE_EQ(nc_provider->get_value(past_end, data_access::SUM), last_sum);
+
+    // the same period for every catchment, and the same period resampled with another method
+    for( size_t i = 0; i < ids.size(); ++i ) {
+        NetCDFDataSelector single(ids[i], CSDMS_STD_NAME_SURFACE_TEMP, last_start, duration, "K");
+        EXPECT_DOUBLE_EQ(nc_provider->get_value(single, data_access::MEAN), nc_provider->get_value(single, data_access::SUM));
+    }
+    EXPECT_DOUBLE_EQ(nc_provider->get_value(last, data_access::MEAN), last_sum);
+}
 #endif
@@ -161,6 +161,27 @@ TEST_F(OptionalWrappedDataProvider_Test, test_get_value_1_a) {
     ASSERT_EQ(value, OUTPUT_VALUE_1);
 }
 
+/**
+ * Test when default is provided and 1 override wait is set, for several calls after the wait has passed.
+ */
+TEST_F(OptionalWrappedDataProvider_Test, test_get_value_1_b) {
+    int example_index = 1;
+
+    OptionalWrappedDataProvider &optProvider = providers[example_index];
+    optProvider.setWrappedProvider(&backingProvider);
+    // Args don't really matter (apart from the name) for backing trivial item
+    double value = optProvider.get_value(CatchmentAggrDataSelector("", OUTPUT_NAME_1, 0, 10, "m"), data_access::SUM);
+    ASSERT_EQ(value, OUTPUT_DEFAULT_1);
+
+    for (int i = 0; i < 10; ++i) {
+        value = optProvider.get_value(CatchmentAggrDataSelector("", OUTPUT_NAME_1, 0, 10, "m"), data_access::SUM);
+        ASSERT_EQ(value, OUTPUT_VALUE_1);
+    }
+    // Unknown outputs are still rejected once values are forwarded
+    ASSERT_THROW(optProvider.get_value(CatchmentAggrDataSelector("", "unknown", 0, 10, "m"), data_access::SUM),
+                 std::runtime_error);
+}
+
 /**
  * Test when default is provided and 2 override waits are set.
  */
@@ -0,0 +1,99 @@
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "PushedForcingDataProvider.hpp"
+
+using data_access::PushedForcingDataProvider;
+
+class PushedForcingDataProviderTest : public ::testing::Test {
+
+    protected:
+
+    void TearDown() override {
+        PushedForcingDataProvider::release("pushed_test");
+    }
+
+    //! The values of time step ``t``, valued ``t * 100 + v * 10 + c`` for variable ``v`` of catchment ``c``.
+    static std::vector<double> step_values(size_t t) {
+        std::vector<double> values;
+        for( size_t c = 0; c < 3; ++c ) {
+            for( size_t v = 0; v < 2; ++v ) {
+                values.push_back(t * 100.0 + v * 10.0 + c);
+            }
+        }
+        return values;
+    }
+
+    CatchmentAggrDataSelector selector(const std::string& id, const std::string& variable, size_t t, long duration = 3600) {
+        return CatchmentAggrDataSelector(id, variable, start + time_t(t) * 3600, duration, "");
+    }
+
+    const time_t start = 1448928000; // 2015-12-01 00:00:00
+};
+
+//! Test that formulations read the values of the time steps as they are pushed, from a shared provider of a name.
+TEST_F(PushedForcingDataProviderTest, TestPushAndRead) {
+    auto created = PushedForcingDataProvider::create("pushed_test", {"cat-1", "cat-2", "cat-3"}, {{"A", ""}, {"B", ""}},
+                                                     start, 3600);
+    auto provider = PushedForcingDataProvider::get_shared_provider("pushed_test");
+    ASSERT_EQ(provider, created);
+    EXPECT_THROW(PushedForcingDataProvider::get_shared_provider("not_pushed"), std::runtime_error);
+
+    EXPECT_EQ(provider->get_variable_count(), 2);
+    EXPECT_EQ(provider->record_duration(), 3600);
+    EXPECT_EQ(provider->get_data_start_time(), start);
+
+    for( size_t t = 0; t < 5; ++t ) {
+        std::vector<double> values = step_values(t);
+        provider->push(t, values.data());
+        EXPECT_EQ(provider->get_pushed_count(), t + 1);
+        EXPECT_DOUBLE_EQ(provider->get_value(selector("cat-2", "B", t), data_access::SUM), t * 100.0 + 11.0);
+
+        std::vector<double> many(2);
+        provider->get_values_for_ids({"cat-3", "cat-1"}, selector("", "A", t), data_access::SUM, many.data());
+        EXPECT_DOUBLE_EQ(many[0], t * 100.0 + 2.0);
+        EXPECT_DOUBLE_EQ(many[1], t * 100.0);
+    }
+
+    // the last two time steps are held, so a period over both of them is read, but not one before them
+    EXPECT_DOUBLE_EQ(provider->get_value(selector("cat-1", "B", 3, 7200), data_access::MEAN), 360.0);
+    EXPECT_THROW(provider->get_value(selector("cat-1", "B", 2), data_access::SUM), std::out_of_range);
+    // a time step not pushed yet isn't waited for
+    EXPECT_THROW(provider->get_value(selector("cat-1", "B", 5), data_access::SUM), std::out_of_range);
+    EXPECT_THROW(provider->get_value(selector("cat-9", "B", 4), data_access::SUM), std::out_of_range);
+}
+
+//! Test that steps are pushed in order, and not over a step still being read.
+TEST_F(PushedForcingDataProviderTest, TestPushOrder) {
+    auto provider = PushedForcingDataProvider::create("pushed_test", {"cat-1", "cat-2", "cat-3"}, {{"A", ""}, {"B", ""}},
+                                                      start, 3600);
+    std::vector<double> values = step_values(0);
+    EXPECT_THROW(provider->push(1, values.data()), std::invalid_argument);
+    provider->push(0, values.data());
+    provider->push(1, values.data());
+    // step 0 has not been read past, so its buffer can't be pushed into
+    EXPECT_THROW(provider->push(2, values.data()), std::runtime_error);
+    provider->get_value(selector("cat-1", "A", 1), data_access::SUM);
+    provider->push(2, values.data());
+}
+
+//! Test that with a wait, a read waits for its time step to be pushed by another thread.
+TEST_F(PushedForcingDataProviderTest, TestReadWaitsForPush) {
+    auto provider = PushedForcingDataProvider::create("pushed_test", {"cat-1", "cat-2", "cat-3"}, {{"A", ""}, {"B", ""}},
+                                                      start, 3600, 30.0);
+    std::thread pusher([&provider]() {
+        for( size_t t = 0; t < 20; ++t ) {
+            std::vector<double> values = step_values(t);
+            provider->push(t, values.data());
+        }
+    });
+    for( size_t t = 0; t < 20; ++t ) {
+        EXPECT_DOUBLE_EQ(provider->get_value(selector("cat-3", "A", t), data_access::SUM), t * 100.0 + 2.0);
+    }
+    pusher.join();
+}
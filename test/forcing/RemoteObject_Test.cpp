@@ -0,0 +1,136 @@
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+
+#include "RemoteObject.hpp"
+
+using data_access::BlockCache;
+using data_access::RemoteObject;
+
+class RemoteObjectTest : public ::testing::Test {
+
+    protected:
+
+    void SetUp() override {
+        cache_dir = "remote_object_test_" + std::to_string(::getpid());
+        for( int i = 0; i < 1000; ++i ) {
+            contents.push_back(static_cast<char>('a' + i % 26));
+        }
+        etag = "\"1\"";
+        fetches = 0;
+    }
+
+    void TearDown() override {
+        for( const std::string& name : cache_files() ) {
+            std::remove((cache_dir + "/" + name).c_str());
+        }
+        ::rmdir(cache_dir.c_str());
+    }
+
+    //! A fetcher of ``contents``, counting its range requests.
+    RemoteObject::Fetcher fetcher() {
+        RemoteObject::Fetcher f;
+        f.stat = [this](const std::string&) {
+            RemoteObject::Info info;
+            info.size = contents.size();
+            info.etag = etag;
+            return info;
+        };
+        f.range = [this](const std::string&, std::uint64_t offset, std::uint64_t length) {
+            ++fetches;
+            return contents.substr(offset, length);
+        };
+        return f;
+    }
+
+    std::vector<std::string> cache_files() const {
+        std::vector<std::string> names;
+        DIR* dir = ::opendir(cache_dir.c_str());
+        if( dir == nullptr ) {
+            return names;
+        }
+        while( struct dirent* entry = ::readdir(dir) ) {
+            if( std::string(entry->d_name) != "." && std::string(entry->d_name) != ".." ) {
+                names.push_back(entry->d_name);
+            }
+        }
+        ::closedir(dir);
+        return names;
+    }
+
+    std::string cache_dir;
+    std::string contents;
+    std::string etag;
+    std::atomic<int> fetches;
+};
+
+//! Reads spanning several blocks get the bytes of the object, and reads past its end are refused.
+TEST_F(RemoteObjectTest, TestReadAcrossBlocks) {
+    RemoteObject object("https://example.com/data.bin", fetcher(), nullptr, 64, 4);
+    ASSERT_EQ(object.size(), 1000);
+
+    std::vector<char> out(300);
+    object.read(50, out.size(), out.data());
+    EXPECT_EQ(std::string(out.begin(), out.end()), contents.substr(50, 300));
+    // the 6 blocks from 0 to 383
+    EXPECT_EQ(fetches, 6);
+
+    out.resize(10);
+    object.read(990, out.size(), out.data());
+    EXPECT_EQ(std::string(out.begin(), out.end()), contents.substr(990));
+    EXPECT_EQ(object.read_all(), contents);
+    EXPECT_THROW(object.read(995, 10, out.data()), std::out_of_range);
+}
+
+//! Blocks fetched by one reader of an object are read from the cache by the next.
+TEST_F(RemoteObjectTest, TestSharedCache) {
+    auto cache = std::make_shared<BlockCache>(cache_dir, 0);
+    RemoteObject first("https://example.com/data.bin", fetcher(), cache, 100, 4);
+    EXPECT_EQ(first.read_all(), contents);
+    EXPECT_EQ(fetches, 10);
+    EXPECT_EQ(cache_files().size(), 10);
+
+    RemoteObject second("https://example.com/data.bin", fetcher(), std::make_shared<BlockCache>(cache_dir, 0), 100, 4);
+    EXPECT_EQ(second.read_all(), contents);
+    EXPECT_EQ(fetches, 10);
+
+    // a changed object is not read from the blocks of the old one
+    contents[0] = 'z';
+    etag = "\"2\"";
+    RemoteObject changed("https://example.com/data.bin", fetcher(), cache, 100, 4);
+    EXPECT_EQ(changed.read_all(), contents);
+    EXPECT_EQ(fetches, 20);
+}
+
+//! The least recently read blocks are removed to keep the cache within its capacity.
+TEST_F(RemoteObjectTest, TestEviction) {
+    auto cache = std::make_shared<BlockCache>(cache_dir, 400);
+    RemoteObject object("https://example.com/data.bin", fetcher(), cache, 100, 1);
+    EXPECT_EQ(object.read_all(), contents);
+    EXPECT_LE(cache_files().size(), 4);
+}
+
+//! S3 paths are read from the default endpoint, or that of AWS_ENDPOINT_URL.
+TEST_F(RemoteObjectTest, TestRemoteUrl) {
+    EXPECT_TRUE(data_access::is_remote_path("s3://bucket/forcing.ngenf"));
+    EXPECT_TRUE(data_access::is_remote_path("https://example.com/forcing.ngenf"));
+    EXPECT_FALSE(data_access::is_remote_path("data/forcing.ngenf"));
+
+    ::unsetenv("AWS_ENDPOINT_URL");
+    EXPECT_EQ(data_access::remote_url("s3://bucket/a/forcing.ngenf"), "https://bucket.s3.amazonaws.com/a/forcing.ngenf");
+    ::setenv("AWS_ENDPOINT_URL", "http://localhost:9000/", 1);
+    EXPECT_EQ(data_access::remote_url("s3://bucket/a/forcing.ngenf"), "http://localhost:9000/bucket/a/forcing.ngenf");
+    ::unsetenv("AWS_ENDPOINT_URL");
+    EXPECT_EQ(data_access::netcdf_path("https://example.com/forcing.nc"), "https://example.com/forcing.nc#mode=bytes");
+    EXPECT_EQ(data_access::netcdf_path("s3://bucket/forcing.zarr#mode=zarr,s3"), "s3://bucket/forcing.zarr#mode=zarr,s3");
+    EXPECT_THROW(data_access::remote_url("s3://bucket"), std::invalid_argument);
+}
@@ -0,0 +1,88 @@
+#include <stdexcept>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "SlabCache.hpp"
+
+using data_access::SlabCache;
+
+class SlabCacheTest : public ::testing::Test {
+
+    protected:
+
+    SlabCacheTest() {
+
+    }
+
+    ~SlabCacheTest() override {
+
+    }
+
+    //! Get a slab whose values are ``var * 100 + block`` and count the loads.
+    const std::vector<double>& get(SlabCache& cache, std::size_t var, std::size_t block, std::size_t size = 3) {
+        return cache.get(var, block, size, [&](double* values) {
+            ++loads;
+            for( std::size_t i = 0; i < size; ++i ) {
+                values[i] = var * 100.0 + block;
+            }
+        });
+    }
+
+    int loads = 0;
+
+};
+
+//! Test that slabs are loaded once and then served from the cache.
+TEST_F(SlabCacheTest, TestHitAfterLoad) {
+    SlabCache cache(4);
+
+    ASSERT_EQ(get(cache, 1, 2)[0], 102.0);
+    ASSERT_EQ(get(cache, 0, 2)[2], 2.0);
+    ASSERT_EQ(get(cache, 1, 2).size(), 3);
+    ASSERT_EQ(get(cache, 0, 2)[1], 2.0);
+
+    ASSERT_EQ(loads, 2);
+    ASSERT_EQ(cache.hits(), 2);
+    ASSERT_EQ(cache.misses(), 2);
+}
+
+//! Test that the least recently used slab is the one evicted when the cache is full.
+TEST_F(SlabCacheTest, TestEvictsLeastRecentlyUsed) {
+    SlabCache cache(2);
+
+    get(cache, 0, 0);
+    get(cache, 0, 1);
+    get(cache, 0, 0);
+    get(cache, 0, 2);   // evicts block 1
+    ASSERT_EQ(loads, 3);
+
+    get(cache, 0, 0);
+    ASSERT_EQ(loads, 3);
+    ASSERT_EQ(get(cache, 0, 1)[0], 1.0);
+    ASSERT_EQ(loads, 4);
+}
+
+//! Test that a slab whose load fails is not cached.
+TEST_F(SlabCacheTest, TestFailedLoad) {
+    SlabCache cache(2);
+
+    ASSERT_THROW(cache.get(0, 0, 3, [](double*) { throw std::runtime_error("read failed"); }), std::runtime_error);
+    ASSERT_EQ(get(cache, 0, 0, 5).size(), 5);
+    ASSERT_EQ(loads, 1);
+}
+
+//! Test that finding a slab counts as a use of it, and never loads one.
+TEST_F(SlabCacheTest, TestFind) {
+    SlabCache cache(2);
+
+    ASSERT_EQ(cache.find(0, 0), nullptr);
+    get(cache, 0, 0);
+    get(cache, 0, 1);
+    ASSERT_EQ((*cache.find(0, 0))[0], 0.0);
+    get(cache, 0, 2);   // evicts block 1, as block 0 was used since
+    ASSERT_NE(cache.find(0, 0), nullptr);
+    ASSERT_EQ(cache.find(0, 1), nullptr);
+    ASSERT_EQ(loads, 3);
+    ASSERT_EQ(cache.hits(), 2);
+}
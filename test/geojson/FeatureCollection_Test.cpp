@@ -2,9 +2,13 @@
 #include <FeatureCollection.hpp>
 #include <features/Features.hpp>
 #include <FeatureBuilder.hpp>
+#include <FeatureCache.hpp>
 #include <FeatureVisitor.hpp>
 #include <vector>
 #include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
 
 class FeatureCollection_Test : public ::testing::Test {
 
@@ -332,3 +336,338 @@ TEST_F(FeatureCollection_Test, copy_filter_test) {
 
     ASSERT_EQ(visitor.get(0), "LineStringFeature");
 }
+
+TEST_F(FeatureCollection_Test, stream_subset_property_id_test) {
+    //Ids under "properties", and strings that look like JSON structure, as the streaming reader must skip them
+    std::string data = "{ "
+        "\"type\": \"FeatureCollection\", "
+        "\"name\": \"a [tricky] {name}\\\" , \", "
+        "\"features\": [ "
+            "{ "
+                "\"type\": \"Feature\", "
+                "\"properties\": { \"id\": \"cat-1\", \"toid\": \"nex-1\", \"note\": \"}]\\\\\" }, "
+                "\"geometry\": { "
+                "    \"type\": \"Point\", "
+                "    \"coordinates\": [102.0, 0.5] "
+                "} "
+            "}, "
+            "{ "
+                "\"type\": \"Feature\", "
+                "\"properties\": { \"nested\": { \"id\": \"cat-1\" }, \"id\": \"cat-2\", \"toid\": \"nex-1\" }, "
+                "\"geometry\": { "
+                "    \"type\": \"Point\", "
+                "    \"coordinates\": [103.0, 1.5] "
+                "} "
+            "}, "
+            "{ "
+                "\"type\": \"Feature\", "
+                "\"properties\": { \"id\": \"cat-3\" }, "
+                "\"geometry\": { "
+                "    \"type\": \"Point\", "
+                "    \"coordinates\": [104.0, 2.5] "
+                "} "
+            "} "
+        "] "
+        "}";
+
+    std::stringstream stream;
+    stream << data;
+    geojson::GeoJSON collection = geojson::read(stream, {"cat-2", "cat-3"});
+
+    ASSERT_EQ(2, collection->get_size());
+    ASSERT_EQ(collection->get_feature("cat-1"), nullptr);
+    ASSERT_NE(collection->get_feature("cat-2"), nullptr);
+    ASSERT_EQ(collection->get_feature("cat-2")->get_property("toid").as_string(), "nex-1");
+    ASSERT_NE(collection->get_feature("cat-3"), nullptr);
+    ASSERT_EQ(collection->get_bounding_box().size(), 0);
+
+    std::stringstream all_stream;
+    all_stream << data;
+    geojson::GeoJSON all = geojson::read(all_stream);
+    ASSERT_EQ(3, all->get_size());
+    ASSERT_EQ(all->get_feature("cat-1")->get_property("note").as_string(), "}]\\");
+}
+
+TEST_F(FeatureCollection_Test, stream_write_subset_test) {
+    std::string data = "{ "
+        "\"type\": \"FeatureCollection\", "
+        "\"name\": \"a [tricky] {name}\\\" , \", "
+        "\"features\": [ "
+            "{ \"type\": \"Feature\", \"id\": \"nex-1\", \"properties\": { \"toid\": \"tnx-1\" }, "
+            "  \"geometry\": { \"type\": \"Point\", \"coordinates\": [102.0, 0.5] } }, "
+            "{ \"type\": \"Feature\", \"properties\": { \"id\": \"cat-2\", \"note\": \"}]\\\\\" }, "
+            "  \"geometry\": { \"type\": \"Point\", \"coordinates\": [103.0, 1.5] } }, "
+            "{ \"type\": \"Feature\", \"properties\": { \"id\": \"cat-3\" }, "
+            "  \"geometry\": { \"type\": \"Point\", \"coordinates\": [104.0, 2.5] } } "
+        "] "
+        "}";
+
+    std::stringstream in;
+    in << data;
+    std::stringstream out;
+    ASSERT_EQ(geojson::write_subset(in, out, {"nex-1", "cat-2", "cat-does-not-exist"}), 2);
+
+    //The subset reads back as the features would have been read from the whole collection
+    geojson::GeoJSON subset = geojson::read(out);
+    ASSERT_EQ(2, subset->get_size());
+    ASSERT_NE(subset->get_feature("nex-1"), nullptr);
+    ASSERT_EQ(subset->get_feature("nex-1")->get_property("toid").as_string(), "tnx-1");
+    ASSERT_EQ(subset->get_feature("cat-2")->get_property("note").as_string(), "}]\\");
+    ASSERT_EQ(subset->get_feature("cat-3"), nullptr);
+    ASSERT_NE(out.str().find("\"name\": \"a [tricky] {name}\\\" , \""), std::string::npos);
+
+    std::stringstream none_in;
+    none_in << data;
+    std::stringstream none_out;
+    ASSERT_EQ(geojson::write_subset(none_in, none_out, {}), 0);
+    ASSERT_EQ(geojson::read(none_out)->get_size(), 0);
+}
+
+TEST_F(FeatureCollection_Test, stream_malformed_test) {
+    std::stringstream truncated;
+    truncated << "{ \"type\": \"FeatureCollection\", \"features\": [ { \"type\": \"Feature\", \"id\": \"First\" ";
+    ASSERT_THROW(geojson::read(truncated), boost::property_tree::json_parser_error);
+
+    std::stringstream mismatched;
+    mismatched << "{ \"features\": [ { \"id\": \"First\" ] }";
+    ASSERT_THROW(geojson::read(mismatched), boost::property_tree::json_parser_error);
+
+    ASSERT_THROW(geojson::read(std::string("/nonexistent/catchment_data.geojson")), boost::property_tree::json_parser_error);
+}
+
+TEST_F(FeatureCollection_Test, feature_cache_round_trip_test) {
+    std::string data = "{ "
+        "\"type\": \"FeatureCollection\", "
+        "\"bbox\": [100.0, 0.0, 105.0, 3.0], "
+        "\"features\": [ "
+            "{ "
+                "\"type\": \"Feature\", \"id\": \"cat-1\", \"foreign\": 7, "
+                "\"properties\": { \"toid\": \"nex-1\", \"area\": 12.5, \"order\": 3, \"code\": \"0042\", "
+                "                  \"flags\": [true, false], \"meta\": { \"source\": \"test\" } }, "
+                "\"geometry\": { \"type\": \"Polygon\", "
+                "    \"coordinates\": [ [ [100.0, 0.0], [101.0, 0.0], [101.0, 1.0], [100.0, 0.0] ] ] } "
+            "}, "
+            "{ "
+                "\"type\": \"Feature\", \"id\": \"nex-1\", "
+                "\"properties\": { \"toid\": \"\" }, "
+                "\"geometry\": { \"type\": \"Point\", \"coordinates\": [104.0, 2.5] } "
+            "} "
+        "] "
+        "}";
+
+    std::string source_path = testing::TempDir() + "feature_cache_round_trip.geojson";
+    std::string cache_path = source_path + geojson::FEATURE_CACHE_EXTENSION;
+    std::ofstream(source_path) << data;
+    std::remove(cache_path.c_str());
+
+    geojson::GeoJSON parsed = geojson::read_cached(source_path);
+    ASSERT_EQ(2, parsed->get_size());
+    ASSERT_TRUE(geojson::feature_cache_matches(cache_path, geojson::digest_file(source_path)));
+
+    geojson::GeoJSON cached = geojson::read_feature_cache(cache_path);
+    ASSERT_EQ(2, cached->get_size());
+    ASSERT_EQ(cached->get_bounding_box(), parsed->get_bounding_box());
+    geojson::Feature catchment = cached->get_feature("cat-1");
+    ASSERT_NE(catchment, nullptr);
+    ASSERT_EQ(catchment->get_type(), geojson::FeatureType::Polygon);
+    ASSERT_EQ(catchment->get_property("toid").as_string(), "nex-1");
+    ASSERT_EQ(catchment->get_property("area").as_real_number(), 12.5);
+    ASSERT_EQ(catchment->get_property("order").as_natural_number(), 3);
+    ASSERT_EQ(catchment->get_property("code").get_type(), parsed->get_feature("cat-1")->get_property("code").get_type());
+    ASSERT_EQ(catchment->get_property("flags").as_boolean_vector(), std::vector<bool>({true, false}));
+    ASSERT_EQ(catchment->get_property("meta").get_values().at("source").as_string(), "test");
+    ASSERT_EQ(catchment->get("foreign").as_natural_number(), 7);
+    ASSERT_EQ(catchment->geometry<geojson::polygon_t>().outer().size(), 4);
+    ASSERT_EQ(catchment->geometry<geojson::polygon_t>().outer()[1].get<0>(), 101.0);
+    ASSERT_EQ(cached->get_feature("nex-1")->geometry<geojson::coordinate_t>().get<1>(), 2.5);
+
+    geojson::GeoJSON subset = geojson::read_cached(source_path, {"nex-1"});
+    ASSERT_EQ(1, subset->get_size());
+    ASSERT_NE(subset->get_feature("nex-1"), nullptr);
+    ASSERT_EQ(subset->get_feature("cat-1"), nullptr);
+
+    // A changed source invalidates the cache, which is then rebuilt
+    std::ofstream(source_path, std::ios::app) << " ";
+    ASSERT_FALSE(geojson::feature_cache_matches(cache_path, geojson::digest_file(source_path)));
+    ASSERT_TRUE(geojson::update_feature_cache(source_path));
+    ASSERT_FALSE(geojson::update_feature_cache(source_path));
+
+    std::ofstream(cache_path, std::ios::trunc) << "NGENHFC1";
+    ASSERT_THROW(geojson::read_feature_cache(cache_path), std::runtime_error);
+
+    std::remove(cache_path.c_str());
+    std::remove(source_path.c_str());
+}
+
+TEST_F(FeatureCollection_Test, serialized_features_test) {
+    std::stringstream data("{ "
+        "\"type\": \"FeatureCollection\", "
+        "\"features\": [ "
+            "{ \"type\": \"Feature\", \"id\": \"cat-1\", \"properties\": { \"toid\": \"nex-1\", \"area\": 12.5 }, "
+            "  \"geometry\": { \"type\": \"LineString\", \"coordinates\": [ [100.0, 0.0], [101.0, 1.0] ] } }, "
+            "{ \"type\": \"Feature\", \"id\": \"nex-1\", \"properties\": { \"toid\": \"\" }, "
+            "  \"geometry\": { \"type\": \"Point\", \"coordinates\": [104.0, 2.5] } } "
+        "] "
+        "}");
+    geojson::GeoJSON parsed = geojson::read(data);
+
+    // Serialized partitions of the collection, as moved between ranks, load as the features they were made from
+    std::string whole = geojson::serialize_features(*parsed);
+    geojson::GeoJSON loaded = geojson::deserialize_features(whole.data(), whole.size());
+    ASSERT_EQ(2, loaded->get_size());
+    ASSERT_EQ(loaded->get_feature("cat-1")->get_property("area").as_real_number(), 12.5);
+    ASSERT_EQ(loaded->get_feature("cat-1")->geometry<geojson::linestring_t>()[1].get<0>(), 101.0);
+
+    std::vector<std::string> partition_ids{"nex-1"};
+    std::string partition = geojson::serialize_features(geojson::FeatureCollection(*parsed, partition_ids), false);
+    geojson::GeoJSON nexuses = geojson::deserialize_features(partition.data(), partition.size());
+    ASSERT_EQ(1, nexuses->get_size());
+    ASSERT_EQ(nexuses->get_feature("cat-1"), nullptr);
+    ASSERT_EQ(nexuses->get_feature("nex-1")->get_property("toid").as_string(), "");
+    ASSERT_LT(partition.size(), whole.size());
+
+    geojson::GeoJSON subset = geojson::deserialize_features(whole.data(), whole.size(), {"cat-1"});
+    ASSERT_EQ(1, subset->get_size());
+    ASSERT_NE(subset->get_feature("cat-1"), nullptr);
+
+    ASSERT_THROW(geojson::deserialize_features(whole.data(), 12), std::runtime_error);
+}
+
+TEST_F(FeatureCollection_Test, slim_load_test) {
+    std::string data = "{ "
+        "\"type\": \"FeatureCollection\", "
+        "\"features\": [ "
+            "{ "
+                "\"type\": \"Feature\", "
+                "\"properties\": { \"id\": \"cat-1\", \"toid\": \"nex-1\", \"areasqkm\": 4.5, \"name\": \"first\" }, "
+                "\"geometry\": { \"type\": \"Polygon\", "
+                "    \"coordinates\": [ [ [100.0, 0.0], [101.0, 0.5], [100.5, 1.0], [100.0, 0.0] ] ] } "
+            "}, "
+            "{ "
+                "\"type\": \"Feature\", \"id\": \"cat-2\", \"bbox\": [0.0, 0.0, 1.0, 1.0], "
+                "\"properties\": { \"toid\": \"nex-1\" }, "
+                "\"geometry\": { \"type\": \"Point\", \"coordinates\": [104.0, 2.5] } "
+            "} "
+        "] "
+        "}";
+
+    geojson::FeatureLoadOptions options;
+    options.include_geometry = false;
+    options.properties = {"toid", "areasqkm"};
+
+    std::stringstream stream;
+    stream << data;
+    geojson::GeoJSON collection = geojson::read(stream, {}, "", options);
+    ASSERT_EQ(2, collection->get_size());
+
+    geojson::Feature first = collection->get_feature("cat-1");
+    ASSERT_NE(first, nullptr);
+    ASSERT_EQ(first->get_type(), geojson::FeatureType::Polygon);
+    ASSERT_TRUE(first->geometry<geojson::polygon_t>().outer().empty());
+    ASSERT_EQ(first->get_bounding_box(), std::vector<double>({100.0, 0.0, 101.0, 1.0}));
+    ASSERT_EQ(first->get_property("toid").as_string(), "nex-1");
+    ASSERT_EQ(first->get_property("areasqkm").as_real_number(), 4.5);
+    ASSERT_TRUE(first->has_property("id"));
+    ASSERT_FALSE(first->has_property("name"));
+
+    // A bounding box given in the GeoJSON is kept as is
+    ASSERT_EQ(collection->get_feature("cat-2")->get_bounding_box(), std::vector<double>({0.0, 0.0, 1.0, 1.0}));
+
+    // Slim loads through the cache build a cache without geometry, which a full load then replaces
+    std::string source_path = testing::TempDir() + "slim_load.geojson";
+    std::string cache_path = source_path + geojson::FEATURE_CACHE_EXTENSION;
+    std::ofstream(source_path) << data;
+    std::remove(cache_path.c_str());
+
+    geojson::read_cached(source_path, {}, true, options);
+    geojson::GeoJSON cached = geojson::read_feature_cache(cache_path, {"cat-1"}, options);
+    ASSERT_EQ(1, cached->get_size());
+    ASSERT_EQ(cached->get_feature("cat-1")->get_bounding_box(), std::vector<double>({100.0, 0.0, 101.0, 1.0}));
+    ASSERT_FALSE(cached->get_feature("cat-1")->has_property("name"));
+    ASSERT_TRUE(geojson::read_feature_cache(cache_path)->get_feature("cat-1")->has_property("name"));
+
+    geojson::GeoJSON full = geojson::read_cached(source_path);
+    ASSERT_EQ(full->get_feature("cat-1")->geometry<geojson::polygon_t>().outer().size(), 4);
+    ASSERT_FALSE(geojson::update_feature_cache(source_path));
+
+    std::remove(cache_path.c_str());
+    std::remove(source_path.c_str());
+}
+
+TEST_F(FeatureCollection_Test, edge_list_test) {
+    std::string json_edges = "[{\"id\": \"cat-1\", \"toid\": \"nex-1\"}, {\"id\": \"cat-2\", \"toid\": \"nex-1\"},\n"
+                             " {\"id\": \"nex-1\", \"toid\": null}]";
+    std::string csv_edges = "areasqkm,id,toid\r\n4.5,\"cat-1\",nex-1\r\n1.0,cat-2,nex-1\r\n\r\n2.0,nex-1,\r\n";
+
+    std::string json_path = testing::TempDir() + "edge_list.json";
+    std::string csv_path = testing::TempDir() + "edge_list.csv";
+    std::ofstream(json_path) << "\n  " << json_edges;
+    std::ofstream(csv_path) << csv_edges;
+
+    for (const std::string& path : {json_path, csv_path}) {
+        geojson::GeoJSON collection = geojson::read(path);
+        ASSERT_EQ(3, collection->get_size());
+        ASSERT_EQ(collection->get_feature("cat-1")->get_property("toid").as_string(), "nex-1");
+        ASSERT_EQ(collection->get_feature("cat-2")->get_property("toid").as_string(), "nex-1");
+        ASSERT_FALSE(collection->get_feature("nex-1")->has_property("toid"));
+        // Only the topology is kept
+        ASSERT_FALSE(collection->get_feature("cat-1")->has_property("areasqkm"));
+
+        geojson::GeoJSON subset = geojson::read(path, {"cat-2"});
+        ASSERT_EQ(1, subset->get_size());
+        ASSERT_NE(subset->get_feature("cat-2"), nullptr);
+
+        std::string link_key = "toid";
+        collection->link_features_from_property(nullptr, &link_key);
+        ASSERT_EQ(collection->get_feature("nex-1")->get_number_of_origination_features(), 2);
+    }
+
+    std::stringstream no_id;
+    no_id << "[{\"toid\": \"nex-1\"}]";
+    ASSERT_THROW(geojson::read_edge_list(no_id), std::runtime_error);
+
+    std::remove(json_path.c_str());
+    std::remove(csv_path.c_str());
+}
+
+TEST_F(FeatureCollection_Test, multithreaded_read_test) {
+    // Enough features for several batches, of which one is only partly full
+    std::string data = "{ \"type\": \"FeatureCollection\", \"features\": [ ";
+    const int feature_count = 2500;
+    for (int i = 0; i < feature_count; ++i) {
+        std::string id = std::to_string(i);
+        data += (i > 0 ? ", " : "");
+        data += "{ \"type\": \"Feature\", \"id\": \"cat-" + id + "\", "
+                "\"properties\": { \"toid\": \"nex-" + id + "\", \"areasqkm\": " + id + ".5 }, "
+                "\"geometry\": { \"type\": \"Point\", \"coordinates\": [" + id + ".0, 1.0] } }";
+    }
+    data += " ] }";
+
+    geojson::FeatureLoadOptions options;
+    options.threads = 4;
+
+    std::stringstream serial_stream(data);
+    std::stringstream threaded_stream(data);
+    geojson::GeoJSON serial = geojson::read(serial_stream);
+    geojson::GeoJSON threaded = geojson::read(threaded_stream, {}, "", options);
+    ASSERT_EQ(feature_count, threaded->get_size());
+    for (int i = 0; i < feature_count; ++i) {
+        // Features are in the order of the document, as when read on one thread
+        ASSERT_EQ(threaded->get_feature(i)->get_id(), serial->get_feature(i)->get_id());
+        ASSERT_EQ(threaded->get_feature(i)->get_property("toid").as_string(), "nex-" + std::to_string(i));
+        ASSERT_EQ(threaded->get_feature(i)->get_property("areasqkm").as_real_number(), i + 0.5);
+        ASSERT_EQ(threaded->get_feature(i)->geometry<geojson::coordinate_t>().get<0>(), i);
+    }
+    ASSERT_EQ(threaded->get_feature("cat-2499")->get_id(), "cat-2499");
+
+    std::vector<std::string> ids = {"cat-2000", "cat-7"};
+    std::stringstream subset_stream(data);
+    geojson::GeoJSON subset = geojson::read(subset_stream, ids, "", options);
+    ASSERT_EQ(2, subset->get_size());
+    ASSERT_EQ(subset->get_feature(0)->get_id(), "cat-7");
+    ASSERT_EQ(subset->get_feature(1)->get_id(), "cat-2000");
+
+    // A malformed feature fails the read, whichever thread builds it
+    std::stringstream bad_stream(data.substr(0, data.size() - 4) + ", { \"type\": \"Feature\", \"geometry\": 5 } ] }");
+    ASSERT_ANY_THROW(geojson::read(bad_stream, {}, "", options));
+}
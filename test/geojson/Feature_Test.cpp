@@ -1011,4 +1011,47 @@ TEST_F(Feature_Test, ptree_test) {
     ASSERT_EQ(feature->get("foreign_1").as_string(), "member");
     ASSERT_EQ(feature->get("foreign_2").as_natural_number(), 2);
     ASSERT_EQ(feature->get("foreign_3").as_boolean(), true);
-}
\ No newline at end of file
+}
+TEST_F(Feature_Test, compact_properties_test) {
+    std::vector<geojson::JSONProperty> flags{geojson::JSONProperty("flags", true), geojson::JSONProperty("flags", false)};
+    geojson::PropertyMap nested{{"source", geojson::JSONProperty("source", "test")}};
+    geojson::PropertyMap properties{
+        {"toid", geojson::JSONProperty("toid", "nex-1")},
+        {"code", geojson::JSONProperty("code", "0042")},
+        {"empty", geojson::JSONProperty("empty", "")},
+        {"order", geojson::JSONProperty("order", 3)},
+        {"area", geojson::JSONProperty("area", 12.5)},
+        {"outlet", geojson::JSONProperty("outlet", true)},
+        {"flags", geojson::JSONProperty("flags", flags)},
+        {"meta", geojson::JSONProperty("meta", nested)}
+    };
+
+    geojson::PointFeature first(geojson::coordinate_t(1.0, 2.0), "first", properties);
+    geojson::PointFeature second(geojson::coordinate_t(3.0, 4.0), "second", properties);
+
+    // Every property comes back with the type and value it was stored with
+    ASSERT_EQ(first.get_properties().size(), properties.size());
+    ASSERT_EQ(first.get_properties().at("toid"), properties.at("toid"));
+    ASSERT_EQ(first.get_property("code").get_type(), geojson::PropertyType::String);
+    ASSERT_EQ(first.get_property("code").as_string(), "0042");
+    ASSERT_EQ(first.get_property("empty").as_string(), "");
+    ASSERT_EQ(first.get_property("order").as_natural_number(), 3);
+    ASSERT_EQ(first.get_property("area").as_real_number(), 12.5);
+    ASSERT_TRUE(first.get_property("outlet").as_boolean());
+    ASSERT_EQ(first.get_property("flags").as_boolean_vector(), std::vector<bool>({true, false}));
+    ASSERT_EQ(first.get_property("meta").get_values().at("source").as_string(), "test");
+    ASSERT_EQ(first.get_property("toid").get_key(), "toid");
+
+    ASSERT_TRUE(first.has_property("area"));
+    ASSERT_FALSE(first.has_property("are"));
+    ASSERT_THROW(first.get_property("missing"), std::invalid_argument);
+    ASSERT_EQ(first.property_keys(), std::vector<std::string>({"area", "code", "empty", "flags", "meta", "order", "outlet", "toid"}));
+
+    // Features with the same property names share the one interned copy of each name
+    ASSERT_EQ(geojson::intern_property_key("toid"), geojson::intern_property_key(std::string("toid")));
+
+    geojson::PointFeature copy(second);
+    ASSERT_EQ(copy.property_keys(), second.property_keys());
+    ASSERT_EQ(copy.get_property("area"), second.get_property("area"));
+    ASSERT_EQ(copy.get_property("meta").get_values().at("source").as_string(), "test");
+}
@@ -0,0 +1,250 @@
+#include "gtest/gtest.h"
+#include <cmath>
+#include <vector>
+#include "kernels/evapotranspiration/EtBatch.hpp"
+#include "kernels/evapotranspiration/EtCalcProperty.hpp"
+#include "kernels/evapotranspiration/EtCombinationMethod.hpp"
+
+// The single catchment methods other than the combination method are defined in their headers, outside the namespace
+using namespace et;
+#include "kernels/evapotranspiration/EtEnergyBalanceMethod.hpp"
+#include "kernels/evapotranspiration/EtAerodynamicMethod.hpp"
+#include "kernels/evapotranspiration/EtPriestleyTaylorMethod.hpp"
+#include "kernels/evapotranspiration/EtPenmanMonteithMethod.hpp"
+
+class EtBatchTest : public ::testing::Test {
+
+    protected:
+
+    EtBatchTest() {
+
+    }
+
+    ~EtBatchTest() override {
+
+    }
+
+    void SetUp() override;
+
+    void TearDown() override;
+
+    /** Add a catchment to the block, with the given forcing and params. */
+    void add_catchment(const et::evapotranspiration_forcing &forcing, const et::evapotranspiration_params &params);
+
+    /** The options selecting the given single catchment method, with every other method unselected. */
+    static et::evapotranspiration_options options_for(int et::evapotranspiration_options::*method);
+
+    /** Expect a batched value to be the single catchment one, within a relative tolerance for vectorized exp and log. */
+    static void expect_close(double expected, double actual, std::size_t catchment);
+
+    std::vector<et::evapotranspiration_forcing> forcings;
+    std::vector<et::evapotranspiration_params> params;
+    et::batch::evapotranspiration_forcing_arrays forcing_arrays;
+    et::batch::evapotranspiration_params_arrays params_arrays;
+
+};
+
+void EtBatchTest::SetUp() {
+    et::evapotranspiration_forcing forcing{};
+    forcing.net_radiation_W_per_sq_m = 400.0;
+    forcing.air_temperature_C = 25.0;
+    forcing.relative_humidity_percent = 60.0;
+    forcing.specific_humidity_2m_kg_per_kg = -1.0;
+    forcing.air_pressure_Pa = 101300.0;
+    forcing.wind_speed_m_per_s = 3.0;
+    forcing.canopy_resistance_sec_per_m = 50.0;
+    forcing.water_temperature_C = 150.0;
+    forcing.ground_heat_flux_W_per_sq_m = 10.0;
+
+    et::evapotranspiration_params param{};
+    param.wind_speed_measurement_height_m = 10.0;
+    param.humidity_measurement_height_m = 2.0;
+    param.vegetation_height_m = 0.3;
+    param.zero_plane_displacement_height_m = 0.2;
+    param.momentum_transfer_roughness_length_m = 0.05;
+    param.heat_transfer_roughness_length_m = 0.005;
+
+    // A typical catchment, with relative humidity and a given water temperature
+    add_catchment(forcing, param);
+
+    // Specific humidity instead of relative humidity, and the water temperature defaulted
+    forcing.relative_humidity_percent = -1.0;
+    forcing.specific_humidity_2m_kg_per_kg = 0.008;
+    forcing.water_temperature_C = 15.0;
+    add_catchment(forcing, param);
+
+    // Specific humidity above saturation, which limits the vapor pressure, at a below freezing temperature
+    forcing.air_temperature_C = -10.0;
+    forcing.specific_humidity_2m_kg_per_kg = 0.02;
+    forcing.net_radiation_W_per_sq_m = -50.0;
+    add_catchment(forcing, param);
+
+    // Saturated air, with 100 percent relative humidity
+    forcing.air_temperature_C = 10.0;
+    forcing.relative_humidity_percent = 100.0;
+    forcing.net_radiation_W_per_sq_m = 150.0;
+    add_catchment(forcing, param);
+
+    // A zero relative humidity is not given, so specific humidity is used
+    forcing.relative_humidity_percent = 0.0;
+    forcing.specific_humidity_2m_kg_per_kg = 0.004;
+    add_catchment(forcing, param);
+
+    // Roughness lengths and vegetation height not given, so defaulted
+    forcing.relative_humidity_percent = 30.0;
+    forcing.air_temperature_C = 35.0;
+    forcing.wind_speed_m_per_s = 0.5;
+    param.momentum_transfer_roughness_length_m = 0.0;
+    param.heat_transfer_roughness_length_m = 0.0;
+    param.vegetation_height_m = 0.0;
+    add_catchment(forcing, param);
+
+    // Only the heat transfer roughness length given, so both are still defaulted
+    param.heat_transfer_roughness_length_m = 0.01;
+    param.vegetation_height_m = 2.0;
+    forcing.wind_speed_m_per_s = 8.0;
+    add_catchment(forcing, param);
+}
+
+void EtBatchTest::TearDown() {
+
+}
+
+void EtBatchTest::add_catchment(const et::evapotranspiration_forcing &forcing, const et::evapotranspiration_params &param) {
+    forcings.push_back(forcing);
+    params.push_back(param);
+    std::size_t i = forcing_arrays.size();
+    forcing_arrays.resize(i + 1);
+    forcing_arrays.net_radiation_W_per_sq_m[i] = forcing.net_radiation_W_per_sq_m;
+    forcing_arrays.air_temperature_C[i] = forcing.air_temperature_C;
+    forcing_arrays.relative_humidity_percent[i] = forcing.relative_humidity_percent;
+    forcing_arrays.specific_humidity_2m_kg_per_kg[i] = forcing.specific_humidity_2m_kg_per_kg;
+    forcing_arrays.air_pressure_Pa[i] = forcing.air_pressure_Pa;
+    forcing_arrays.wind_speed_m_per_s[i] = forcing.wind_speed_m_per_s;
+    forcing_arrays.canopy_resistance_sec_per_m[i] = forcing.canopy_resistance_sec_per_m;
+    forcing_arrays.water_temperature_C[i] = forcing.water_temperature_C;
+    forcing_arrays.ground_heat_flux_W_per_sq_m[i] = forcing.ground_heat_flux_W_per_sq_m;
+    params_arrays.resize(i + 1);
+    params_arrays.wind_speed_measurement_height_m[i] = param.wind_speed_measurement_height_m;
+    params_arrays.humidity_measurement_height_m[i] = param.humidity_measurement_height_m;
+    params_arrays.vegetation_height_m[i] = param.vegetation_height_m;
+    params_arrays.zero_plane_displacement_height_m[i] = param.zero_plane_displacement_height_m;
+    params_arrays.momentum_transfer_roughness_length_m[i] = param.momentum_transfer_roughness_length_m;
+    params_arrays.heat_transfer_roughness_length_m[i] = param.heat_transfer_roughness_length_m;
+}
+
+et::evapotranspiration_options EtBatchTest::options_for(int et::evapotranspiration_options::*method) {
+    et::evapotranspiration_options options{};
+    options.yes_aorc = FALSE;
+    options.use_energy_balance_method = FALSE;
+    options.use_aerodynamic_method = FALSE;
+    options.use_combination_method = FALSE;
+    options.use_priestley_taylor_method = FALSE;
+    options.use_penman_monteith_method = FALSE;
+    options.*method = TRUE;
+    return options;
+}
+
+void EtBatchTest::expect_close(double expected, double actual, std::size_t catchment) {
+    EXPECT_NEAR(expected, actual, 1.0e-10 * std::fabs(expected) + 1.0e-300) << "catchment " << catchment;
+}
+
+// Make sure the intermediate variables of each catchment are those of et::calculate_intermediate_variables.
+TEST_F(EtBatchTest, TestIntermediateVariablesMatchSingle) {
+    et::batch::intermediate_vars_arrays inter_vars;
+    et::batch::calculate_intermediate_variables(params_arrays, forcing_arrays, inter_vars);
+    for (std::size_t i = 0; i < forcings.size(); ++i) {
+        et::evapotranspiration_options options = options_for(&et::evapotranspiration_options::use_combination_method);
+        et::evapotranspiration_forcing forcing = forcings[i];
+        et::evapotranspiration_params param = params[i];
+        et::intermediate_vars expected{};
+        et::calculate_intermediate_variables(&options, &param, &forcing, &expected);
+        expect_close(expected.liquid_water_density_kg_per_m3, inter_vars.liquid_water_density_kg_per_m3[i], i);
+        expect_close(expected.water_latent_heat_of_vaporization_J_per_kg,
+                     inter_vars.water_latent_heat_of_vaporization_J_per_kg[i], i);
+        expect_close(expected.air_saturation_vapor_pressure_Pa, inter_vars.air_saturation_vapor_pressure_Pa[i], i);
+        expect_close(expected.air_actual_vapor_pressure_Pa, inter_vars.air_actual_vapor_pressure_Pa[i], i);
+        expect_close(expected.vapor_pressure_deficit_Pa, inter_vars.vapor_pressure_deficit_Pa[i], i);
+        expect_close(expected.moist_air_gas_constant_J_per_kg_K, inter_vars.moist_air_gas_constant_J_per_kg_K[i], i);
+        expect_close(expected.moist_air_density_kg_per_m3, inter_vars.moist_air_density_kg_per_m3[i], i);
+        expect_close(expected.slope_sat_vap_press_curve_Pa_s, inter_vars.slope_sat_vap_press_curve_Pa_s[i], i);
+        expect_close(expected.psychrometric_constant_Pa_per_C, inter_vars.psychrometric_constant_Pa_per_C[i], i);
+    }
+
+    // Unlike the single catchment method, the inputs are left as they were
+    ASSERT_EQ(forcing_arrays.water_temperature_C[1], 15.0);
+    ASSERT_EQ(params_arrays.heat_transfer_roughness_length_m[5], 0.0);
+}
+
+// Make sure the rate of each catchment of every batched method is that of the single catchment method.
+TEST_F(EtBatchTest, TestMethodsMatchSingle) {
+    et::batch::intermediate_vars_arrays inter_vars;
+    et::batch::calculate_intermediate_variables(params_arrays, forcing_arrays, inter_vars);
+    std::vector<double> energy_balance, aerodynamic, combination, priestley_taylor, penman_monteith;
+    et::batch::evapotranspiration_energy_balance_method(forcing_arrays, inter_vars, energy_balance);
+    et::batch::evapotranspiration_aerodynamic_method(params_arrays, forcing_arrays, inter_vars, aerodynamic);
+    et::batch::evapotranspiration_combination_method(params_arrays, forcing_arrays, inter_vars, combination);
+    et::batch::evapotranspiration_priestley_taylor_method(forcing_arrays, inter_vars, priestley_taylor);
+    et::batch::evapotranspiration_penman_monteith_method(params_arrays, forcing_arrays, inter_vars, penman_monteith);
+    ASSERT_EQ(energy_balance.size(), forcings.size());
+    ASSERT_EQ(aerodynamic.size(), forcings.size());
+    ASSERT_EQ(combination.size(), forcings.size());
+    ASSERT_EQ(priestley_taylor.size(), forcings.size());
+    ASSERT_EQ(penman_monteith.size(), forcings.size());
+
+    for (std::size_t i = 0; i < forcings.size(); ++i) {
+        // The single catchment methods modify their inputs, so each gets its own copies
+        et::intermediate_vars scalar_inter_vars{};
+        et::evapotranspiration_options options = options_for(&et::evapotranspiration_options::use_energy_balance_method);
+        et::evapotranspiration_forcing forcing = forcings[i];
+        et::evapotranspiration_params param = params[i];
+        expect_close(evapotranspiration_energy_balance_method(&options, &param, &forcing), energy_balance[i], i);
+
+        options = options_for(&et::evapotranspiration_options::use_aerodynamic_method);
+        forcing = forcings[i];
+        param = params[i];
+        expect_close(evapotranspiration_aerodynamic_method(&options, &param, &forcing, &scalar_inter_vars),
+                     aerodynamic[i], i);
+
+        options = options_for(&et::evapotranspiration_options::use_combination_method);
+        forcing = forcings[i];
+        param = params[i];
+        expect_close(et::combined::evapotranspiration_combination_method(&options, &param, &forcing, &scalar_inter_vars),
+                     combination[i], i);
+
+        options = options_for(&et::evapotranspiration_options::use_priestley_taylor_method);
+        forcing = forcings[i];
+        param = params[i];
+        expect_close(evapotranspiration_priestley_taylor_method(&options, &param, &forcing, &scalar_inter_vars),
+                     priestley_taylor[i], i);
+
+        options = options_for(&et::evapotranspiration_options::use_penman_monteith_method);
+        forcing = forcings[i];
+        param = params[i];
+        expect_close(evapotranspiration_penman_monteith_method(&options, &param, &forcing, &scalar_inter_vars),
+                     penman_monteith[i], i);
+    }
+}
+
+// Make sure blocks of any size, including those not a multiple of the SIMD lanes, get the same rate for each catchment.
+TEST_F(EtBatchTest, TestBlockSizes) {
+    et::batch::intermediate_vars_arrays inter_vars;
+    et::batch::calculate_intermediate_variables(params_arrays, forcing_arrays, inter_vars);
+    std::vector<double> full_block;
+    et::batch::evapotranspiration_penman_monteith_method(params_arrays, forcing_arrays, inter_vars, full_block);
+
+    for (std::size_t n = 0; n <= forcings.size(); ++n) {
+        et::batch::evapotranspiration_forcing_arrays block_forcing = forcing_arrays;
+        et::batch::evapotranspiration_params_arrays block_params = params_arrays;
+        block_forcing.resize(n);
+        block_params.resize(n);
+        et::batch::intermediate_vars_arrays block_inter_vars;
+        std::vector<double> block;
+        et::batch::calculate_intermediate_variables(block_params, block_forcing, block_inter_vars);
+        et::batch::evapotranspiration_penman_monteith_method(block_params, block_forcing, block_inter_vars, block);
+        ASSERT_EQ(block.size(), n);
+        for (std::size_t i = 0; i < n; ++i) {
+            expect_close(full_block[i], block[i], i);
+        }
+    }
+}
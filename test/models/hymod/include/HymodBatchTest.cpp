@@ -0,0 +1,149 @@
+#include "gtest/gtest.h"
+#include "hymod/include/Hymod.h"
+#include "hymod/include/hymod_batch.h"
+#include <memory>
+#include <vector>
+
+class HymodBatchTest : public ::testing::Test {
+
+protected:
+
+    HymodBatchTest() {
+
+    }
+
+    ~HymodBatchTest() override {
+
+    }
+
+    void SetUp() override;
+
+    void TearDown() override;
+
+    /** ET params of a PDM with a storage tank of the given height. */
+    static std::shared_ptr<pdm03_struct> make_et_params(double max_height_m);
+
+    std::vector<hymod_params> params;
+    std::vector<hymod_state> states;
+    std::vector<std::vector<double>> cascade_storage;
+
+};
+
+void HymodBatchTest::SetUp() {
+    // Varied enough to both fill the reservoirs past their maximum and drain them below their minimum
+    params.push_back(hymod_params{0.0, 400.0, 1.0, 0.0, 0.0, 100.0, 1.0, 0.5, 0.2, 0.02, 0.5, 3});
+    params.push_back(hymod_params{0.0, 0.05, 0.02, 0.0, 0.0, 100.0, 0.5, 0.3, 1.5, 1.0e-04, 1.0e-03, 2});
+    params.push_back(hymod_params{0.01, 2.0, 0.5, 0.05, 0.1, 1.0e-05, 2.0, 0.8, 0.5, 0.9, 0.9, 0});
+    params.push_back(hymod_params{0.0, 10.0, 0.2, 0.0, 0.0, 100.0, 0.8, 0.1, 1.0, 0.05, 0.2, 1});
+
+    cascade_storage.push_back(std::vector<double>{0.0, 0.0, 0.0});
+    cascade_storage.push_back(std::vector<double>{0.01, 0.02});
+    cascade_storage.push_back(std::vector<double>());
+    cascade_storage.push_back(std::vector<double>{0.1});
+
+    states.push_back(hymod_state(0.9, 0.0, cascade_storage[0].data()));
+    states.push_back(hymod_state(0.2, 0.04, cascade_storage[1].data()));
+    states.push_back(hymod_state(0.5, 0.5, nullptr));
+    states.push_back(hymod_state(0.1, 1.0, cascade_storage[3].data()));
+}
+
+void HymodBatchTest::TearDown() {
+
+}
+
+std::shared_ptr<pdm03_struct> HymodBatchTest::make_et_params(double max_height_m) {
+    std::shared_ptr<pdm03_struct> et_params = std::make_shared<pdm03_struct>(pdm03_struct());
+    et_params->scaled_distribution_fn_shape_parameter = 1.3;
+    et_params->vegetation_adjustment = 0.99;
+    et_params->max_height_soil_moisture_storerage_tank = max_height_m;
+    et_params->maximum_combined_contents = max_height_m / (1.0 + et_params->scaled_distribution_fn_shape_parameter);
+    et_params->potential_et = 1.0e-04;
+    return et_params;
+}
+
+// Make sure each member of a batch runs exactly as hymod_kernel::run would for it, over a wet then dry period.
+TEST_F(HymodBatchTest, TestRunMatchesKernel) {
+    hymod_batch batch;
+    std::vector<hymod_state> kernel_states;
+    std::vector<std::vector<double>> kernel_cascade_storage;
+    std::vector<std::shared_ptr<pdm03_struct>> kernel_et_params;
+    std::vector<std::shared_ptr<pdm03_struct>> batch_et_params;
+    for (std::size_t m = 0; m < params.size(); ++m) {
+        ASSERT_EQ(batch.add_member(params[m], states[m]), m);
+        kernel_cascade_storage.push_back(cascade_storage[m]);
+        kernel_cascade_storage[m].resize(params[m].n, 0.0);
+        kernel_et_params.push_back(make_et_params(1.0));
+        batch_et_params.push_back(make_et_params(1.0));
+    }
+    for (std::size_t m = 0; m < params.size(); ++m) {
+        kernel_states.push_back(hymod_state(states[m].storage_meters, states[m].groundwater_storage_meters,
+                                            kernel_cascade_storage[m].data()));
+    }
+    ASSERT_EQ(batch.size(), params.size());
+
+    for (int t = 0; t < 48; ++t) {
+        std::vector<double> input_storage_m(params.size());
+        std::vector<int> kernel_results(params.size());
+        std::vector<hymod_fluxes> kernel_fluxes(params.size());
+        for (std::size_t m = 0; m < params.size(); ++m) {
+            input_storage_m[m] = t < 12 ? 0.01 * (m + 1) : 0.0;
+            std::vector<double> new_cascade_storage(params[m].n, 0.0);
+            hymod_state new_state(0.0, 0.0, new_cascade_storage.data());
+            kernel_results[m] = hymod_kernel::run(3600.0, params[m], kernel_states[m], new_state, kernel_fluxes[m],
+                                                  input_storage_m[m], kernel_et_params[m].get());
+            kernel_cascade_storage[m] = new_cascade_storage;
+            kernel_states[m] = hymod_state(new_state.storage_meters, new_state.groundwater_storage_meters,
+                                           kernel_cascade_storage[m].data());
+        }
+        batch.run(3600.0, input_storage_m, batch_et_params);
+
+        for (std::size_t m = 0; m < params.size(); ++m) {
+            std::vector<double> batch_cascade_storage;
+            hymod_state batch_state = batch.get_state(m, batch_cascade_storage);
+            EXPECT_DOUBLE_EQ(batch_state.storage_meters, kernel_states[m].storage_meters);
+            EXPECT_DOUBLE_EQ(batch_state.groundwater_storage_meters, kernel_states[m].groundwater_storage_meters);
+            ASSERT_EQ(batch_cascade_storage.size(), kernel_cascade_storage[m].size());
+            for (std::size_t i = 0; i < batch_cascade_storage.size(); ++i) {
+                EXPECT_DOUBLE_EQ(batch_state.Sr[i], kernel_cascade_storage[m][i]);
+            }
+
+            hymod_fluxes batch_fluxes = batch.get_fluxes(m);
+            EXPECT_DOUBLE_EQ(batch_fluxes.slow_flow_meters_per_second, kernel_fluxes[m].slow_flow_meters_per_second);
+            EXPECT_DOUBLE_EQ(batch_fluxes.runoff_meters_per_second, kernel_fluxes[m].runoff_meters_per_second);
+            EXPECT_DOUBLE_EQ(batch_fluxes.et_loss_meters, kernel_fluxes[m].et_loss_meters);
+            EXPECT_EQ(batch.get_mass_check_result(m), kernel_results[m]);
+            EXPECT_DOUBLE_EQ(batch_et_params[m]->actual_et, kernel_et_params[m]->actual_et);
+        }
+    }
+}
+
+// Make sure the batch mass check counts the members that fail it.
+TEST_F(HymodBatchTest, TestRunMassCheck) {
+    hymod_batch batch;
+    std::vector<std::shared_ptr<pdm03_struct>> et_params;
+    for (std::size_t m = 0; m < params.size(); ++m) {
+        batch.add_member(params[m], states[m]);
+        et_params.push_back(make_et_params(1.0));
+    }
+    std::vector<double> input_storage_m{0.01, 0.02, 0.0, 0.05};
+    std::size_t failures = batch.run(3600.0, input_storage_m, et_params);
+    std::size_t failed_members = 0;
+    for (std::size_t m = 0; m < params.size(); ++m) {
+        failed_members += batch.get_mass_check_result(m) == MASS_BALANCE_ERROR ? 1 : 0;
+    }
+    EXPECT_EQ(failures, failed_members);
+}
+
+// Make sure a member with a negative Nash cascade size, or a batch run with inputs for the wrong number of members, is
+// rejected.
+TEST_F(HymodBatchTest, TestInvalidArguments) {
+    hymod_batch batch;
+    hymod_params negative = params[0];
+    negative.n = -1;
+    EXPECT_THROW(batch.add_member(negative), std::invalid_argument);
+    EXPECT_EQ(batch.size(), 0);
+
+    batch.add_member(params[0], states[0]);
+    std::vector<std::shared_ptr<pdm03_struct>> et_params{make_et_params(1.0)};
+    EXPECT_THROW(batch.run(3600.0, std::vector<double>{0.0, 0.0}, et_params), std::invalid_argument);
+}
@@ -194,3 +194,42 @@ TEST_F(HymodKernelTest, TestCalcET0) {
 */
 
 
+
+//! Test that, with an empty soil and no input, a recession step gives the same state and fluxes as a full one.
+TEST_F(HymodKernelTest, TestRecessionMatchesRunWhenDry)
+{
+    hymod_params params{0.0, 10.0, 10.0, 0.0, 0.0, 100.0, 400.0, 0.5, 1.0, 0.00001, 0.00002, 3};
+
+    std::vector<double> sr{0.3, 0.2, 0.1};
+    hymod_state state(0.0, 0.8, sr.data());
+
+    pdm03_struct pdm_et_data;
+    pdm_et_data.scaled_distribution_fn_shape_parameter = 1.3;
+    pdm_et_data.vegetation_adjustment = 0.99;
+    pdm_et_data.model_time_step = 0.0;
+    pdm_et_data.max_height_soil_moisture_storerage_tank = 400.0;
+    pdm_et_data.maximum_combined_contents = pdm_et_data.max_height_soil_moisture_storerage_tank /
+                                            (1.0 + pdm_et_data.scaled_distribution_fn_shape_parameter);
+    pdm_et_data.potential_et = 0.005;
+
+    std::vector<double> full_sr(3), recession_sr(3);
+    hymod_state full_state(0.0, 0.0, full_sr.data()), recession_state(0.0, 0.0, recession_sr.data());
+    hymod_fluxes full_fluxes, recession_fluxes;
+
+    ASSERT_EQ(hymod_kernel::run(3600.0, params, state, full_state, full_fluxes, 0.0, &pdm_et_data), NO_ERROR);
+    ASSERT_EQ(hymod_kernel::run_recession(3600.0, params, state, recession_state, recession_fluxes, 0.0), NO_ERROR);
+
+    EXPECT_DOUBLE_EQ(recession_state.storage_meters, full_state.storage_meters);
+    EXPECT_DOUBLE_EQ(recession_state.groundwater_storage_meters, full_state.groundwater_storage_meters);
+    for (int i = 0; i < params.n; ++i) {
+        EXPECT_DOUBLE_EQ(recession_sr[i], full_sr[i]);
+    }
+    EXPECT_DOUBLE_EQ(recession_fluxes.slow_flow_meters_per_second, full_fluxes.slow_flow_meters_per_second);
+    EXPECT_DOUBLE_EQ(recession_fluxes.runoff_meters_per_second, full_fluxes.runoff_meters_per_second);
+    EXPECT_DOUBLE_EQ(recession_fluxes.et_loss_meters, full_fluxes.et_loss_meters);
+    EXPECT_LT(recession_state.groundwater_storage_meters, state.groundwater_storage_meters);
+
+    // water entering a dry soil is held there, and the step still balances
+    ASSERT_EQ(hymod_kernel::run_recession(3600.0, params, state, recession_state, recession_fluxes, 0.0001), NO_ERROR);
+    EXPECT_DOUBLE_EQ(recession_state.storage_meters, 0.0001);
+}
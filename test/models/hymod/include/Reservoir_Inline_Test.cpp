@@ -0,0 +1,142 @@
+#include <limits>
+#include <memory>
+#include <vector>
+#include "gtest/gtest.h"
+#include "reservoir/Reservoir.hpp"
+#include "reservoir/Reservoir_Inline.hpp"
+
+using namespace Reservoir::Explicit_Time;
+
+//This class contains unit tests comparing the Inline_Reservoir to the equivalent Reservoir
+class ReservoirInlineKernelTest : public ::testing::Test {
+
+    protected:
+
+    void SetUp() override;
+
+    void TearDown() override;
+
+    /** Influxes that both overfill and drain the reservoirs, in meters per second. */
+    std::vector<double> in_fluxes;
+
+    int delta_time_seconds = 3600;
+
+};
+
+void ReservoirInlineKernelTest::SetUp() {
+    in_fluxes = {0.0, 1.0e-05, 5.0e-04, 2.0e-03, 0.0, 0.0, 1.0e-06, 0.0, 0.0, 0.0, 0.0, 0.0};
+}
+
+void ReservoirInlineKernelTest::TearDown() {
+
+}
+
+//Test that an inline reservoir with a single standard outlet responds as the equivalent reservoir does.
+TEST_F(ReservoirInlineKernelTest, TestStandardOutletMatchesReservoir) {
+    Reservoir::Explicit_Time::Reservoir reservoir(0.0, 2.0, 0.5, 1.0e-04, 2.0, 0.1, 1.0e-03);
+    Inline_Reservoir<Inline_Outlet> inline_reservoir(0.0, 2.0, 0.5, Inline_Outlet(1.0e-04, 2.0, 0.1, 1.0e-03));
+
+    for (double in_flux : in_fluxes) {
+        double excess, inline_excess;
+        double response = reservoir.response_meters_per_second(in_flux, delta_time_seconds, excess);
+        double inline_response = inline_reservoir.response_meters_per_second(in_flux, delta_time_seconds, inline_excess);
+        EXPECT_DOUBLE_EQ(inline_response, response);
+        EXPECT_DOUBLE_EQ(inline_excess, excess);
+        EXPECT_DOUBLE_EQ(inline_reservoir.get_storage_height_meters(), reservoir.get_storage_height_meters());
+    }
+}
+
+//Test that an inline reservoir with two linear outlets responds, and reports each outlet velocity, as the equivalent
+//reservoir does.
+TEST_F(ReservoirInlineKernelTest, TestMultipleLinearOutletsMatchReservoir) {
+    std::vector<std::shared_ptr<Reservoir_Outlet>> outlets;
+    outlets.push_back(std::make_shared<Reservoir_Linear_Outlet>(3.0e-04, 0.2, std::numeric_limits<double>::max()));
+    outlets.push_back(std::make_shared<Reservoir_Linear_Outlet>(1.0e-04, 0.5, 5.0e-05));
+    Reservoir::Explicit_Time::Reservoir reservoir(0.0, 1.5, 0.3, outlets);
+    Inline_Reservoir<Inline_Linear_Outlet, Inline_Linear_Outlet> inline_reservoir(
+            0.0, 1.5, 0.3,
+            Inline_Linear_Outlet(3.0e-04, 0.2, std::numeric_limits<double>::max()),
+            Inline_Linear_Outlet(1.0e-04, 0.5, 5.0e-05));
+
+    for (double in_flux : in_fluxes) {
+        double excess, inline_excess;
+        double response = reservoir.response_meters_per_second(in_flux, delta_time_seconds, excess);
+        double inline_response = inline_reservoir.response_meters_per_second(in_flux, delta_time_seconds, inline_excess);
+        EXPECT_DOUBLE_EQ(inline_response, response);
+        EXPECT_DOUBLE_EQ(inline_excess, excess);
+        EXPECT_DOUBLE_EQ(inline_reservoir.get_storage_height_meters(), reservoir.get_storage_height_meters());
+        EXPECT_DOUBLE_EQ(inline_reservoir.velocity_meters_per_second_for_outlet<0>(),
+                         reservoir.velocity_meters_per_second_for_outlet(0));
+        EXPECT_DOUBLE_EQ(inline_reservoir.velocity_meters_per_second_for_outlet<1>(),
+                         reservoir.velocity_meters_per_second_for_outlet(1));
+    }
+}
+
+//Test that an inline reservoir with an exponential outlet responds as the equivalent reservoir does.
+TEST_F(ReservoirInlineKernelTest, TestExponentialOutletMatchesReservoir) {
+    std::vector<std::shared_ptr<Reservoir_Outlet>> outlets;
+    outlets.push_back(std::make_shared<Reservoir_Exponential_Outlet>(1.0e-06, 6.0, 0.0,
+                                                                     std::numeric_limits<double>::max()));
+    Reservoir::Explicit_Time::Reservoir reservoir(0.0, 16.0, 1.0, outlets);
+    Inline_Reservoir<Inline_Exponential_Outlet> inline_reservoir(
+            0.0, 16.0, 1.0, Inline_Exponential_Outlet(1.0e-06, 6.0, 0.0, std::numeric_limits<double>::max()));
+
+    for (double in_flux : in_fluxes) {
+        double excess, inline_excess;
+        double response = reservoir.response_meters_per_second(in_flux, delta_time_seconds, excess);
+        double inline_response = inline_reservoir.response_meters_per_second(in_flux, delta_time_seconds, inline_excess);
+        EXPECT_DOUBLE_EQ(inline_response, response);
+        EXPECT_DOUBLE_EQ(inline_reservoir.get_storage_height_meters(), reservoir.get_storage_height_meters());
+    }
+}
+
+//Test that exponential outlet velocities read from a table are within its tolerance, and are the same inline or not.
+TEST_F(ReservoirInlineKernelTest, TestTabulatedExponentialOutlet) {
+    double tolerance = 1.0e-09;
+    for (double storage = 0.0; storage <= 16.0; storage += 0.37) {
+        std::vector<std::shared_ptr<Reservoir_Outlet>> outlets;
+        outlets.push_back(std::make_shared<Reservoir_Exponential_Outlet>(1.0e-06, 6.0, 0.0,
+                                                                         std::numeric_limits<double>::max()));
+        Reservoir::Explicit_Time::Reservoir reservoir(0.0, 16.0, storage, outlets);
+        reservoir.set_outlet_table_tolerance(tolerance);
+        Inline_Reservoir<Inline_Exponential_Outlet> exact_reservoir(
+                0.0, 16.0, storage, Inline_Exponential_Outlet(1.0e-06, 6.0, 0.0, std::numeric_limits<double>::max()));
+        Inline_Reservoir<Inline_Exponential_Outlet> inline_reservoir(exact_reservoir);
+        inline_reservoir.set_outlet_table_tolerance(tolerance);
+
+        double excess;
+        double exact = exact_reservoir.response_meters_per_second(0.0, 1, excess);
+        double tabulated = inline_reservoir.response_meters_per_second(0.0, 1, excess);
+        EXPECT_NEAR(tabulated, exact, tolerance);
+        EXPECT_DOUBLE_EQ(reservoir.response_meters_per_second(0.0, 1, excess), tabulated);
+    }
+}
+
+//Test that a tolerance of 0 drops an outlet's table, computing its velocities again.
+TEST_F(ReservoirInlineKernelTest, TestUntabulatedExponentialOutlet) {
+    Inline_Reservoir<Inline_Exponential_Outlet> exact_reservoir(
+            0.0, 16.0, 3.3, Inline_Exponential_Outlet(1.0e-06, 6.0, 0.0, std::numeric_limits<double>::max()));
+    Inline_Reservoir<Inline_Exponential_Outlet> inline_reservoir(exact_reservoir);
+    inline_reservoir.set_outlet_table_tolerance(1.0e-03);
+    inline_reservoir.set_outlet_table_tolerance(0.0);
+
+    double excess;
+    EXPECT_EQ(inline_reservoir.response_meters_per_second(0.0, 1, excess),
+              exact_reservoir.response_meters_per_second(0.0, 1, excess));
+}
+
+//Test that an inline reservoir with no outlets only stores its influx.
+TEST_F(ReservoirInlineKernelTest, TestNoOutlets) {
+    Inline_Reservoir<> inline_reservoir(0.0, 8.0, 2.0);
+    double excess;
+    EXPECT_DOUBLE_EQ(inline_reservoir.response_meters_per_second(1.0e-04, delta_time_seconds, excess), 0.0);
+    EXPECT_DOUBLE_EQ(excess, 0.0);
+    EXPECT_DOUBLE_EQ(inline_reservoir.get_storage_height_meters(), 2.36);
+}
+
+//Test that inline reservoir outlets out of order of activation threshold are an error.
+TEST_F(ReservoirInlineKernelTest, TestOutOfOrderOutletsExit) {
+    ASSERT_DEATH((Inline_Reservoir<Inline_Linear_Outlet, Inline_Linear_Outlet>(
+            0.0, 1.0, 0.5, Inline_Linear_Outlet(1.0e-04, 0.5, 1.0), Inline_Linear_Outlet(1.0e-04, 0.2, 1.0))),
+                 "ERROR: The outlets of an inline reservoir are not in order of activation threshold.");
+}
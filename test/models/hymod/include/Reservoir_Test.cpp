@@ -4,6 +4,7 @@
 #include "reservoir/Reservoir_Outlet.hpp"
 #include "reservoir/Reservoir_Linear_Outlet.hpp"
 #include "reservoir/Reservoir_Exponential_Outlet.hpp"
+#include <limits>
 #include <memory>
 
 //This class contains unit tests for the Reservoir
@@ -575,3 +576,52 @@ TEST_F(ReservoirKernelTest, TestMultipleOutletReservoirTooLargeActivationThresho
 }
 
 
+//Test that the adaptive solver follows a stiff exponential outlet reservoir, which a single explicit step overshoots
+TEST_F(ReservoirKernelTest, TestAdaptiveSolverExponentialOutletReservoir)
+{
+    double excess_water_meters;
+    std::vector<std::shared_ptr<Reservoir::Explicit_Time::Reservoir_Outlet>> outlets(1);
+    outlets[0] = std::make_shared<Reservoir::Explicit_Time::Reservoir_Exponential_Outlet>(
+            1.0e-4, 6.0, 0.0, std::numeric_limits<double>::max());
+
+    Reservoir::Explicit_Time::Reservoir fixed_step_reservoir(0.0, 16.0, 8.0, outlets);
+    fixed_step_reservoir.response_meters_per_second(1.0e-5, 3600, excess_water_meters);
+
+    // A reference of many short explicit steps
+    outlets[0] = std::make_shared<Reservoir::Explicit_Time::Reservoir_Exponential_Outlet>(
+            1.0e-4, 6.0, 0.0, std::numeric_limits<double>::max());
+    Reservoir::Explicit_Time::Reservoir reference_reservoir(0.0, 16.0, 8.0, outlets);
+    for (int i = 0; i < 3600; ++i) {
+        reference_reservoir.response_meters_per_second(1.0e-5, 1, excess_water_meters);
+    }
+
+    outlets[0] = std::make_shared<Reservoir::Explicit_Time::Reservoir_Exponential_Outlet>(
+            1.0e-4, 6.0, 0.0, std::numeric_limits<double>::max());
+    Reservoir::Explicit_Time::Reservoir adaptive_reservoir(0.0, 16.0, 8.0, outlets);
+    adaptive_reservoir.set_solver(reservoir_solver::adaptive, 1.0e-4, 3600);
+    double mean_velocity = adaptive_reservoir.response_meters_per_second(1.0e-5, 3600, excess_water_meters);
+
+    EXPECT_GT(std::fabs(fixed_step_reservoir.get_storage_height_meters() - reference_reservoir.get_storage_height_meters()), 1.0);
+    EXPECT_NEAR(adaptive_reservoir.get_storage_height_meters(), reference_reservoir.get_storage_height_meters(), 0.01);
+
+    // The mean velocity accounts for all the water leaving the reservoir over the time step
+    EXPECT_DOUBLE_EQ(excess_water_meters, 0.0);
+    EXPECT_NEAR(8.0 + (1.0e-5 - mean_velocity) * 3600, adaptive_reservoir.get_storage_height_meters(), 1.0e-9);
+    EXPECT_DOUBLE_EQ(adaptive_reservoir.velocity_meters_per_second_for_outlet(0), mean_velocity);
+}
+
+//Test that the adaptive solver agrees with a single explicit step, to within its tolerance, when that is accurate enough
+TEST_F(ReservoirKernelTest, TestAdaptiveSolverLinearOutletReservoir)
+{
+    double excess_water_meters, adaptive_excess_water_meters;
+    Reservoir::Explicit_Time::Reservoir fixed_step_reservoir(0.0, 8.0, 2.0, 1.0e-6, 0.0, 100.0);
+    Reservoir::Explicit_Time::Reservoir adaptive_reservoir(0.0, 8.0, 2.0, 1.0e-6, 0.0, 100.0);
+    adaptive_reservoir.set_solver(reservoir_solver::adaptive, 1.0e-3);
+
+    double velocity = fixed_step_reservoir.response_meters_per_second(1.0e-6, 3600, excess_water_meters);
+    double adaptive_velocity = adaptive_reservoir.response_meters_per_second(1.0e-6, 3600, adaptive_excess_water_meters);
+
+    EXPECT_NEAR(adaptive_velocity * 3600, velocity * 3600, 1.0e-3);
+    EXPECT_NEAR(adaptive_reservoir.get_storage_height_meters(), fixed_step_reservoir.get_storage_height_meters(), 1.0e-3);
+    EXPECT_DOUBLE_EQ(adaptive_excess_water_meters, excess_water_meters);
+}
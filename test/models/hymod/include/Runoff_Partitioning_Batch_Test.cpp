@@ -0,0 +1,107 @@
+#include "gtest/gtest.h"
+#include "kernels/schaake_partitioning.hpp"
+#include "kernels/Pdm03.h"
+#include "kernels/RunoffPartitioningBatch.hpp"
+#include <vector>
+
+class RunoffPartitioningBatchTest : public ::testing::Test {
+
+protected:
+
+    RunoffPartitioningBatchTest() {
+
+    }
+
+    ~RunoffPartitioningBatchTest() override {
+
+    }
+
+    void SetUp() override;
+
+    void TearDown() override;
+
+    std::vector<pdm03_struct> pdm_catchments;
+
+};
+
+void RunoffPartitioningBatchTest::SetUp() {
+    // Stores both filled by the precipitation and left with room, and with and without ET
+    double cpar[] = {40.0, 10.0, 0.3, 5.0, 100.0};
+    double b[] = {1.0, 0.5, 0.0, 2.0, 1.5};
+    double xhuz[] = {0.0, 3.0, 0.15, 4.9, 20.0};
+    double huz[] = {20.0, 15.0, 0.3, 5.0, 150.0};
+    double precipitation[] = {50.0, 1.0, 0.0, 10.0, 0.5};
+    double potential_et[] = {4.927084, 0.5, 1.0e-04, 0.0, 3.0};
+    double kv[] = {5.0, 1.0, 1.0, 1.0, 0.8};
+    for (int i = 0; i < 5; ++i) {
+        pdm03_struct pdm = pdm03_struct();
+        pdm.maximum_combined_contents = cpar[i];
+        pdm.scaled_distribution_fn_shape_parameter = b[i];
+        pdm.final_height_reservoir = xhuz[i];
+        pdm.max_height_soil_moisture_storerage_tank = huz[i];
+        pdm.precipitation = precipitation[i];
+        pdm.potential_et = potential_et[i];
+        pdm.vegetation_adjustment = kv[i];
+        pdm_catchments.push_back(pdm);
+    }
+}
+
+void RunoffPartitioningBatchTest::TearDown() {
+
+}
+
+// Make sure the batched Schaake partitioning gives what the single catchment function does for each catchment,
+// including those with no (or a negative) input and with a negative deficit.
+TEST_F(RunoffPartitioningBatchTest, TestSchaakePartitioningMatchesScalar) {
+    std::vector<double> schaake_constant{0.439, 0.439, 3.0, 1.0e-04, 0.6, 0.439, 0.439, 0.439};
+    std::vector<double> deficit_m{0.2, 0.0, 0.5, 0.3, -0.1, 0.4, 0.0, 0.2};
+    std::vector<double> input_m{0.01, 0.02, 0.1, 0.05, 0.03, 0.0, 0.0, -0.01};
+    const std::size_t n = input_m.size();
+    std::vector<double> runoff_m(n), infiltration_m(n);
+
+    runoff::batch::schaake_partitioning_scheme(n, 3600.0, schaake_constant.data(), deficit_m.data(), input_m.data(),
+                                               runoff_m.data(), infiltration_m.data());
+
+    for (std::size_t i = 0; i < n; ++i) {
+        double expected_runoff_m, expected_infiltration_m;
+        Schaake_partitioning_scheme_cpp(3600.0, schaake_constant[i], deficit_m[i], input_m[i], &expected_runoff_m,
+                                        &expected_infiltration_m);
+        EXPECT_DOUBLE_EQ(runoff_m[i], expected_runoff_m);
+        EXPECT_DOUBLE_EQ(infiltration_m[i], expected_infiltration_m);
+    }
+}
+
+// Make sure the batched PDM gives what pdm03_wrapper does for each catchment.
+TEST_F(RunoffPartitioningBatchTest, TestPdm03MatchesScalar) {
+    runoff::batch::pdm03_arrays pdm(pdm_catchments.size());
+    ASSERT_EQ(pdm.size(), pdm_catchments.size());
+    for (std::size_t i = 0; i < pdm_catchments.size(); ++i) {
+        pdm.set(i, pdm_catchments[i]);
+    }
+
+    runoff::batch::pdm03(pdm);
+
+    for (std::size_t i = 0; i < pdm_catchments.size(); ++i) {
+        pdm03_struct expected = pdm_catchments[i];
+        pdm03_wrapper(&expected);
+        pdm03_struct batched = pdm_catchments[i];
+        pdm.get_outputs(i, batched);
+        EXPECT_DOUBLE_EQ(batched.total_effective_rainfall, expected.total_effective_rainfall);
+        EXPECT_DOUBLE_EQ(batched.actual_et, expected.actual_et);
+        EXPECT_DOUBLE_EQ(batched.final_storage_upper_zone, expected.final_storage_upper_zone);
+        EXPECT_DOUBLE_EQ(batched.final_height_reservoir, expected.final_height_reservoir);
+    }
+}
+
+// Make sure the batched PDM gives the known results of the single catchment test.
+TEST_F(RunoffPartitioningBatchTest, TestPdm03Known) {
+    runoff::batch::pdm03_arrays pdm(1);
+    pdm.set(0, pdm_catchments[0]);
+
+    runoff::batch::pdm03(pdm);
+
+    EXPECT_DOUBLE_EQ(30.0, pdm.total_effective_rainfall[0]);
+    EXPECT_DOUBLE_EQ(24.635420, pdm.actual_et[0]);
+    EXPECT_DOUBLE_EQ(15.364580, pdm.final_storage_upper_zone[0]);
+    EXPECT_DOUBLE_EQ(4.3043254366051542, pdm.final_height_reservoir[0]);
+}
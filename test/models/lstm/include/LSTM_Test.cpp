@@ -4,6 +4,7 @@
 #include "lstm/include/LSTM.h"
 #include "lstm/include/lstm_params.h"
 #include "lstm/include/lstm_config.h"
+#include "lstm/include/lstm_batch.h"
 
 class LSTMModelTest : public ::testing::Test {
 
@@ -66,4 +67,83 @@ TEST_F(LSTMModelTest, TestLSTMModel)
     ASSERT_TRUE(true);
 }
 
+/** Test that a batch of one catchment gives the flow of the model run alone, and takes no more catchments once run. */
+TEST_F(LSTMModelTest, TestLSTMBatch)
+{
+    lstm::lstm_config config{
+      "./test/data/model/lstm/sugar_creek_trained.pt",
+      "./test/data/model/lstm/input_scaling.csv",
+      "./test/data/model/lstm/initial_states.csv",
+      false
+    };
+    lstm::lstm_params params{35.2607453, -80.84020072, 15.617167};
+    auto forcings = [](long t_index, long t_delta_s, double* values) {
+        double step[] = {369.20001220703125, 99870.0, 0.009800000116229057, 9.493307095661946e-08, 0.0, 287.0,
+                         -1.7000000476837158, 3.4000000953674316};
+        std::copy(step, step + lstm::lstm_batch::NUM_FORCINGS, values);
+    };
+
+    std::shared_ptr<lstm::lstm_batch> batch = lstm::lstm_batch::shared(config);
+    std::size_t member = batch->add_member(params, config.initial_state_path, forcings);
+    ASSERT_EQ(batch, lstm::lstm_batch::shared(config));
+
+    model->run(3600.0, 369.20001220703125, 99870.0, 0.009800000116229057,
+               9.493307095661946e-08, 0.0, 287.0, -1.7000000476837158, 3.4000000953674316);
+    EXPECT_NEAR(model->get_fluxes()->flow, batch->get_flow(member, 0, 3600), 1.0e-6);
+    //Flows are only kept until every catchment has taken them
+    ASSERT_THROW(batch->get_flow(member, 0, 3600), std::runtime_error);
+
+    ASSERT_THROW(batch->add_member(params, config.initial_state_path, forcings), std::runtime_error);
+    ASSERT_NE(batch, lstm::lstm_batch::shared(config));
+}
+
+/** Test that the model frozen and optimized for inference, on a single intra-op thread, gives the same flow. */
+TEST_F(LSTMModelTest, TestLSTMModelOptimizedForInference)
+{
+    lstm::lstm_config config{
+      "./test/data/model/lstm/sugar_creek_trained.pt",
+      "./test/data/model/lstm/input_scaling.csv",
+      "./test/data/model/lstm/initial_states.csv",
+      false
+    };
+    config.optimize_for_inference = true;
+    config.torch_threads = 1;
+    lstm::lstm_params params{35.2607453, -80.84020072, 15.617167};
+    lstm::lstm_model optimized(config, params);
+    EXPECT_EQ(1, at::get_num_threads());
+
+    optimized.run(3600.0, 369.20001220703125, 99870.0, 0.009800000116229057,
+                  9.493307095661946e-08, 0.0, 287.0, -1.7000000476837158, 3.4000000953674316);
+    model->run(3600.0, 369.20001220703125, 99870.0, 0.009800000116229057,
+               9.493307095661946e-08, 0.0, 287.0, -1.7000000476837158, 3.4000000953674316);
+    EXPECT_NEAR(model->get_fluxes()->flow, optimized.get_fluxes()->flow, 1.0e-6);
+}
+
+/** Test that models of the same trained model share its loaded copy, and still each keep their own state. */
+TEST_F(LSTMModelTest, TestSharedModel)
+{
+    lstm::lstm_config config{
+      "./test/data/model/lstm/sugar_creek_trained.pt",
+      "./test/data/model/lstm/input_scaling.csv",
+      "./test/data/model/lstm/initial_states.csv",
+      false
+    };
+    std::shared_ptr<const lstm::lstm_shared_model> shared = lstm::shared_model(config, torch::Device(torch::kCPU));
+    EXPECT_EQ(shared, lstm::shared_model(config, torch::Device(torch::kCPU)));
+    config.optimize_for_inference = true;
+    EXPECT_NE(shared, lstm::shared_model(config, torch::Device(torch::kCPU)));
+    config.optimize_for_inference = false;
+
+    //The fixture's model runs a second step before the other runs its first
+    lstm::lstm_params params{35.2607453, -80.84020072, 15.617167};
+    lstm::lstm_model other(config, params);
+    for (int step = 0; step < 2; ++step) {
+        model->run(3600.0, 369.20001220703125, 99870.0, 0.009800000116229057,
+                   9.493307095661946e-08, 0.0, 287.0, -1.7000000476837158, 3.4000000953674316);
+    }
+    other.run(3600.0, 369.20001220703125, 99870.0, 0.009800000116229057,
+              9.493307095661946e-08, 0.0, 287.0, -1.7000000476837158, 3.4000000953674316);
+    EXPECT_DOUBLE_EQ(0.17238743535773413, other.get_fluxes()->flow);
+}
+
 #endif  // LSTM_TORCH_LIB_TESTS_ACTIVE
@@ -0,0 +1,224 @@
+#include "gtest/gtest.h"
+#include "tshirt/include/Tshirt.h"
+#include "tshirt/include/tshirt_batch.h"
+#include "tshirt/include/tshirt_params.h"
+#include "TshirtErrorCodes.h"
+
+class TshirtBatchTest : public ::testing::Test {
+
+protected:
+
+    TshirtBatchTest() {
+
+    }
+
+    ~TshirtBatchTest() override {
+
+    }
+
+    void SetUp() override;
+
+    void TearDown() override;
+
+    /** ET params of a PDM with a storage tank of the given height. */
+    static shared_ptr<pdm03_struct> make_et_params(double max_height_m);
+
+    std::vector<tshirt::tshirt_params> params;
+    std::vector<tshirt::tshirt_state> states;
+
+};
+
+void TshirtBatchTest::SetUp() {
+    // Varied enough to both fill the soil reservoirs past their maximum and drain them through their outlets
+    params.push_back(tshirt::tshirt_params{0.439, 0.066, 3.38e-06, 0.355, 1.0, 4.05, 0.0, 0.33, 1.0e-05, 0.03, 2, 1.0e-06, 6.0, 16.0});
+    params.push_back(tshirt::tshirt_params{0.439, 0.066, 3.38e-06, 0.355, 1.0, 4.05, 0.0, 0.33, 0.5, 0.5, 3, 1.0e-05, 3.0, 1.0});
+    params.push_back(tshirt::tshirt_params{0.3, 0.05, 1.0e-05, 0.2, 0.5, 3.0, 0.0, 0.33, 1.0e-04, 0.01, 0, 1.0e-06, 6.0, 4.0});
+    params.push_back(tshirt::tshirt_params{0.45, 0.1, 2.0e-06, 0.5, 0.8, 5.0, 0.0, 0.33, 1.0e-06, 0.1, 1, 3.0e-07, 1.0, 10.0});
+
+    states.push_back(tshirt::tshirt_state(0.5, 1.0));
+    states.push_back(tshirt::tshirt_state(0.8, 0.2, vector<double>{0.01, 0.02, 0.0}));
+    states.push_back(tshirt::tshirt_state(0.1, 0.0));
+    states.push_back(tshirt::tshirt_state(0.3, 2.0, vector<double>{0.05}));
+}
+
+void TshirtBatchTest::TearDown() {
+
+}
+
+shared_ptr<pdm03_struct> TshirtBatchTest::make_et_params(double max_height_m) {
+    shared_ptr<pdm03_struct> et_params = make_shared<pdm03_struct>(pdm03_struct());
+    et_params->scaled_distribution_fn_shape_parameter = 0.5;
+    et_params->max_height_soil_moisture_storerage_tank = max_height_m;
+    et_params->maximum_combined_contents = max_height_m / 1.5;
+    et_params->potential_et = 1.0e-04;
+    et_params->vegetation_adjustment = 1.0;
+    return et_params;
+}
+
+// Make sure each member of a batch runs exactly as its own tshirt_model would, over a wet then dry period.
+TEST_F(TshirtBatchTest, TestRunMatchesModels) {
+    tshirt::tshirt_batch batch;
+    std::vector<std::unique_ptr<tshirt::tshirt_model>> models;
+    std::vector<shared_ptr<pdm03_struct>> model_et_params;
+    std::vector<shared_ptr<pdm03_struct>> batch_et_params;
+    for (std::size_t m = 0; m < params.size(); ++m) {
+        ASSERT_EQ(batch.add_member(params[m], states[m]), m);
+        models.emplace_back(new tshirt::tshirt_model(params[m], make_shared<tshirt::tshirt_state>(states[m])));
+        model_et_params.push_back(make_et_params(params[m].max_soil_storage_meters));
+        batch_et_params.push_back(make_et_params(params[m].max_soil_storage_meters));
+    }
+    ASSERT_EQ(batch.size(), params.size());
+
+    for (int t = 0; t < 48; ++t) {
+        std::vector<double> input_storage_m(params.size());
+        std::vector<int> model_results(params.size());
+        for (std::size_t m = 0; m < params.size(); ++m) {
+            input_storage_m[m] = t < 12 ? 0.01 * (m + 1) : 0.0;
+            model_results[m] = models[m]->run(3600.0, input_storage_m[m], model_et_params[m]);
+        }
+        batch.run(3600.0, input_storage_m, batch_et_params);
+
+        for (std::size_t m = 0; m < params.size(); ++m) {
+            shared_ptr<tshirt::tshirt_state> model_state = models[m]->get_current_state();
+            tshirt::tshirt_state batch_state = batch.get_state(m);
+            EXPECT_DOUBLE_EQ(batch_state.soil_storage_meters, model_state->soil_storage_meters);
+            EXPECT_DOUBLE_EQ(batch_state.groundwater_storage_meters, model_state->groundwater_storage_meters);
+            ASSERT_EQ(batch_state.nash_cascade_storeage_meters.size(), model_state->nash_cascade_storeage_meters.size());
+            for (std::size_t i = 0; i < batch_state.nash_cascade_storeage_meters.size(); ++i) {
+                EXPECT_DOUBLE_EQ(batch_state.nash_cascade_storeage_meters[i], model_state->nash_cascade_storeage_meters[i]);
+            }
+
+            shared_ptr<tshirt::tshirt_fluxes> model_fluxes = models[m]->get_fluxes();
+            tshirt::tshirt_fluxes batch_fluxes = batch.get_fluxes(m);
+            EXPECT_DOUBLE_EQ(batch_fluxes.surface_runoff_meters_per_second, model_fluxes->surface_runoff_meters_per_second);
+            EXPECT_DOUBLE_EQ(batch_fluxes.groundwater_flow_meters_per_second, model_fluxes->groundwater_flow_meters_per_second);
+            EXPECT_DOUBLE_EQ(batch_fluxes.soil_percolation_flow_meters_per_second, model_fluxes->soil_percolation_flow_meters_per_second);
+            EXPECT_DOUBLE_EQ(batch_fluxes.soil_lateral_flow_meters_per_second, model_fluxes->soil_lateral_flow_meters_per_second);
+            EXPECT_DOUBLE_EQ(batch_fluxes.et_loss_meters, model_fluxes->et_loss_meters);
+            EXPECT_EQ(batch.get_mass_check_result(m), model_results[m]);
+        }
+    }
+}
+
+// Make sure the batch mass check counts the members that fail it.
+TEST_F(TshirtBatchTest, TestRunMassCheck) {
+    tshirt::tshirt_batch batch;
+    std::vector<shared_ptr<pdm03_struct>> et_params;
+    for (std::size_t m = 0; m < params.size(); ++m) {
+        batch.add_member(params[m], states[m]);
+        et_params.push_back(make_et_params(params[m].max_soil_storage_meters));
+    }
+    EXPECT_EQ(batch.run(3600.0, std::vector<double>(params.size(), 0.0), et_params), 0);
+    for (std::size_t m = 0; m < params.size(); ++m) {
+        EXPECT_EQ(batch.get_mass_check_result(m), tshirt::TSHIRT_NO_ERROR);
+    }
+
+    // As with tshirt_model, the surface runoff of an input does not balance
+    std::size_t failures = batch.run(3600.0, std::vector<double>{0.01, 0.0, 0.0, 0.0}, et_params);
+    EXPECT_EQ(batch.get_mass_check_result(0), tshirt::TSHIRT_MASS_BALANCE_ERROR);
+    std::size_t failed_members = 0;
+    for (std::size_t m = 0; m < params.size(); ++m) {
+        failed_members += batch.get_mass_check_result(m) == tshirt::TSHIRT_MASS_BALANCE_ERROR ? 1 : 0;
+    }
+    EXPECT_EQ(failures, failed_members);
+}
+
+// Make sure a batch checking mass balance over several time steps only checks at the end of each period, as the
+// models of its members would.
+TEST_F(TshirtBatchTest, TestRunMassCheckInterval) {
+    tshirt::tshirt_batch batch;
+    batch.set_mass_check_interval(3);
+    ASSERT_EQ(batch.get_mass_check_interval(), 3);
+    std::vector<std::unique_ptr<tshirt::tshirt_model>> models;
+    std::vector<shared_ptr<pdm03_struct>> model_et_params;
+    std::vector<shared_ptr<pdm03_struct>> batch_et_params;
+    for (std::size_t m = 0; m < params.size(); ++m) {
+        batch.add_member(params[m], states[m]);
+        models.emplace_back(new tshirt::tshirt_model(params[m], make_shared<tshirt::tshirt_state>(states[m])));
+        models[m]->set_mass_check_interval(3);
+        model_et_params.push_back(make_et_params(params[m].max_soil_storage_meters));
+        batch_et_params.push_back(make_et_params(params[m].max_soil_storage_meters));
+    }
+
+    // As with tshirt_model, the surface runoff of an input does not balance
+    std::vector<double> input_storage_m{0.01, 0.0, 0.0, 0.0};
+    for (int t = 0; t < 6; ++t) {
+        std::size_t model_failures = 0;
+        for (std::size_t m = 0; m < params.size(); ++m) {
+            int result = models[m]->run(3600.0, input_storage_m[m], model_et_params[m]);
+            model_failures += result == tshirt::TSHIRT_MASS_BALANCE_ERROR ? 1 : 0;
+        }
+        std::size_t failures = batch.run(3600.0, input_storage_m, batch_et_params);
+        EXPECT_EQ(failures, model_failures);
+        if (t % 3 != 2) {
+            EXPECT_EQ(failures, 0);
+        }
+        else {
+            EXPECT_EQ(batch.get_mass_check_result(0), tshirt::TSHIRT_MASS_BALANCE_ERROR);
+        }
+    }
+
+    // A period left unchecked is checked when asked, as for the models
+    std::size_t model_failures = 0;
+    for (std::size_t m = 0; m < params.size(); ++m) {
+        models[m]->run(3600.0, 0.0, model_et_params[m]);
+        int result = models[m]->check_accumulated_mass_balance();
+        model_failures += result == tshirt::TSHIRT_MASS_BALANCE_ERROR ? 1 : 0;
+    }
+    EXPECT_EQ(batch.run(3600.0, std::vector<double>(params.size(), 0.0), batch_et_params), 0);
+    EXPECT_EQ(batch.check_accumulated_mass_balance(), model_failures);
+}
+
+// Make sure a batch in single precision stays close to one in double precision, over a wet then dry period.
+TEST_F(TshirtBatchTest, TestRunFloatMatchesDouble) {
+    tshirt::tshirt_batch batch;
+    tshirt::tshirt_batch_float float_batch;
+    std::vector<shared_ptr<pdm03_struct>> et_params;
+    std::vector<shared_ptr<pdm03_struct>> float_et_params;
+    for (std::size_t m = 0; m < params.size(); ++m) {
+        batch.add_member(params[m], states[m]);
+        float_batch.add_member(params[m], states[m]);
+        et_params.push_back(make_et_params(params[m].max_soil_storage_meters));
+        float_et_params.push_back(make_et_params(params[m].max_soil_storage_meters));
+    }
+    EXPECT_GT(float_batch.get_mass_check_error_bound(), batch.get_mass_check_error_bound());
+
+    for (int t = 0; t < 48; ++t) {
+        std::vector<double> input_storage_m(params.size());
+        std::vector<float> float_input_storage_m(params.size());
+        for (std::size_t m = 0; m < params.size(); ++m) {
+            input_storage_m[m] = t < 12 ? 0.01 * (m + 1) : 0.0;
+            float_input_storage_m[m] = (float) input_storage_m[m];
+        }
+        batch.run(3600.0, input_storage_m, et_params);
+        float_batch.run(3600.0, float_input_storage_m, float_et_params);
+
+        for (std::size_t m = 0; m < params.size(); ++m) {
+            tshirt::tshirt_state state = batch.get_state(m);
+            tshirt::tshirt_state float_state = float_batch.get_state(m);
+            EXPECT_NEAR(float_state.soil_storage_meters, state.soil_storage_meters, 1.0e-5);
+            EXPECT_NEAR(float_state.groundwater_storage_meters, state.groundwater_storage_meters, 1.0e-5);
+            for (std::size_t i = 0; i < state.nash_cascade_storeage_meters.size(); ++i) {
+                EXPECT_NEAR(float_state.nash_cascade_storeage_meters[i], state.nash_cascade_storeage_meters[i], 1.0e-5);
+            }
+
+            // Fluxes are rates, so are compared relative to their size
+            tshirt::tshirt_fluxes fluxes = batch.get_fluxes(m);
+            tshirt::tshirt_fluxes float_fluxes = float_batch.get_fluxes(m);
+            EXPECT_NEAR(float_fluxes.surface_runoff_meters_per_second, fluxes.surface_runoff_meters_per_second,
+                        1.0e-4 * std::abs(fluxes.surface_runoff_meters_per_second) + 1.0e-11);
+            EXPECT_NEAR(float_fluxes.groundwater_flow_meters_per_second, fluxes.groundwater_flow_meters_per_second,
+                        1.0e-4 * std::abs(fluxes.groundwater_flow_meters_per_second) + 1.0e-11);
+            EXPECT_NEAR(float_fluxes.soil_lateral_flow_meters_per_second, fluxes.soil_lateral_flow_meters_per_second,
+                        1.0e-4 * std::abs(fluxes.soil_lateral_flow_meters_per_second) + 1.0e-11);
+            EXPECT_NEAR(float_fluxes.et_loss_meters, fluxes.et_loss_meters, 1.0e-5);
+        }
+    }
+}
+
+// Make sure a member with a Nash cascade storage of the wrong size is rejected.
+TEST_F(TshirtBatchTest, TestAddMemberMismatchedNash) {
+    tshirt::tshirt_batch batch;
+    EXPECT_THROW(batch.add_member(params[0], tshirt::tshirt_state(0.5, 1.0, vector<double>{0.0})), std::invalid_argument);
+    EXPECT_EQ(batch.size(), 0);
+}
@@ -0,0 +1,257 @@
+#include "gtest/gtest.h"
+#include "Constants.h"
+#include "tshirt/include/tshirt_c.h"
+#include "tshirt/include/tshirt_c_batch.h"
+#include "tshirt/include/tshirt_c_device_batch.h"
+#include <cmath>
+#include <vector>
+
+class TshirtCBatchTest : public ::testing::Test {
+
+protected:
+
+    TshirtCBatchTest() {
+
+    }
+
+    ~TshirtCBatchTest() override {
+
+    }
+
+    void SetUp() override;
+
+    void TearDown() override;
+
+    /** Set up the soil and groundwater reservoirs of a catchment as Tshirt_C_Realization does. */
+    static void init_reservoirs(const NWM_soil_parameters& soil_params, double alpha_fc, double Klf, double Cgw,
+                                double expon, double max_gw_storage_m, double soil_storage_m, double gw_storage_m,
+                                conceptual_reservoir& soil_reservoir, conceptual_reservoir& gw_reservoir);
+
+    std::vector<NWM_soil_parameters> soil_params;
+    std::vector<conceptual_reservoir> soil_reservoirs;
+    std::vector<conceptual_reservoir> gw_reservoirs;
+    std::vector<std::vector<double>> giuh_ordinates;
+    std::vector<double> schaake_constant;
+    std::vector<double> K_nash;
+    std::vector<int> nash_n;
+    std::vector<std::vector<double>> nash_storage;
+
+};
+
+void TshirtCBatchTest::SetUp() {
+    // Soils starting both nearly full (so infiltration overfills them) and nearly empty, with GIUHs and Nash cascades
+    // of different lengths
+    double smcmax[] = {0.439, 0.3, 0.5, 0.439};
+    double satpsi[] = {0.355, 0.2, 0.5, 0.355};
+    double bb[] = {4.05, 3.0, 6.0, 4.05};
+    double satdk[] = {3.38e-06, 1.0e-05, 1.0e-06, 3.38e-06};
+    double soil_storage_m[] = {0.85, 0.1, 0.9, 0.5};
+    double gw_storage_m[] = {0.01, 0.5, 0.0, 0.016};
+
+    giuh_ordinates.push_back(std::vector<double>{0.06, 0.51, 0.28, 0.12, 0.03});
+    giuh_ordinates.push_back(std::vector<double>{0.5, 0.5});
+    giuh_ordinates.push_back(std::vector<double>());
+    giuh_ordinates.push_back(std::vector<double>{0.1, 0.2, 0.3, 0.2, 0.1, 0.05, 0.05});
+
+    nash_n = {2, 3, 1, 1};
+    nash_storage.push_back(std::vector<double>{0.0, 0.0});
+    nash_storage.push_back(std::vector<double>{0.01, 0.02, 0.005});
+    nash_storage.push_back(std::vector<double>());
+    nash_storage.push_back(std::vector<double>());
+
+    for (int m = 0; m < 4; ++m) {
+        NWM_soil_parameters soil = NWM_soil_parameters();
+        soil.smcmax = smcmax[m];
+        soil.wltsmc = 0.066;
+        soil.satdk = satdk[m];
+        soil.satpsi = satpsi[m];
+        soil.bb = bb[m];
+        soil.mult = 1000.0;
+        soil.slop = 1.0;
+        soil.D = 2.0;
+        soil_params.push_back(soil);
+
+        conceptual_reservoir soil_reservoir, gw_reservoir;
+        init_reservoirs(soil, 0.33, 0.01 * (m + 1), 0.01, 6.0, 1.0, soil_storage_m[m], gw_storage_m[m],
+                        soil_reservoir, gw_reservoir);
+        soil_reservoirs.push_back(soil_reservoir);
+        gw_reservoirs.push_back(gw_reservoir);
+
+        schaake_constant.push_back(m == 2 ? 3.0 : 0.263);
+        K_nash.push_back(0.03 * (m + 1));
+    }
+}
+
+void TshirtCBatchTest::TearDown() {
+
+}
+
+void TshirtCBatchTest::init_reservoirs(const NWM_soil_parameters& soil_params, double alpha_fc, double Klf,
+                                       double Cgw, double expon, double max_gw_storage_m, double soil_storage_m,
+                                       double gw_storage_m, conceptual_reservoir& soil_reservoir,
+                                       conceptual_reservoir& gw_reservoir) {
+    gw_reservoir.is_exponential = TRUE;
+    gw_reservoir.storage_max_m = max_gw_storage_m;
+    gw_reservoir.coeff_primary = Cgw;
+    gw_reservoir.exponent_primary = expon;
+    gw_reservoir.storage_threshold_primary_m = 0.0;
+    gw_reservoir.storage_threshold_secondary_m = 0.0;
+    gw_reservoir.coeff_secondary = 0.0;
+    gw_reservoir.exponent_secondary = 1.0;
+    gw_reservoir.storage_m = gw_storage_m;
+
+    double H_water_table_m = alpha_fc * STANDARD_ATMOSPHERIC_PRESSURE_PASCALS / WATER_SPECIFIC_WEIGHT;
+    double Omega = H_water_table_m - 0.5;
+    double lower_lim = pow(Omega, (1.0 - 1.0 / soil_params.bb)) / (1.0 - 1.0 / soil_params.bb);
+    double upper_lim = pow(Omega + soil_params.D, (1.0 - 1.0 / soil_params.bb)) / (1.0 - 1.0 / soil_params.bb);
+    double field_capacity_storage_threshold_m =
+            soil_params.smcmax * pow(1.0 / soil_params.satpsi, (-1.0 / soil_params.bb)) * (upper_lim - lower_lim);
+
+    soil_reservoir.is_exponential = FALSE;
+    soil_reservoir.storage_max_m = soil_params.smcmax * soil_params.D;
+    soil_reservoir.coeff_primary = soil_params.satdk * soil_params.slop * 3600.0;
+    soil_reservoir.exponent_primary = 1.0;
+    soil_reservoir.storage_threshold_primary_m = field_capacity_storage_threshold_m;
+    soil_reservoir.coeff_secondary = Klf;
+    soil_reservoir.exponent_secondary = 1.0;
+    soil_reservoir.storage_threshold_secondary_m = field_capacity_storage_threshold_m;
+    soil_reservoir.storage_m = soil_storage_m;
+}
+
+// Make sure each member of a batch runs exactly as one time step calls to run would for it, over a wet then dry
+// period, with its GIUH queue of the size run expects.
+TEST_F(TshirtCBatchTest, TestRunMatchesC) {
+    tshirt_c_batch batch;
+    std::vector<std::vector<double>> runoff_queues;
+    std::vector<std::vector<double>> c_nash_storage;
+    for (std::size_t m = 0; m < soil_params.size(); ++m) {
+        ASSERT_EQ(batch.add_member(soil_params[m], gw_reservoirs[m], soil_reservoirs[m], giuh_ordinates[m],
+                                   schaake_constant[m], K_nash[m], nash_n[m], nash_storage[m]), m);
+        runoff_queues.emplace_back(giuh_ordinates[m].size() + 1, 0.0);
+        c_nash_storage.push_back(nash_storage[m]);
+        c_nash_storage[m].resize(nash_n[m], 0.0);
+    }
+    ASSERT_EQ(batch.size(), soil_params.size());
+
+    for (int t = 0; t < 48; ++t) {
+        std::vector<double> rain_m(soil_params.size());
+        std::vector<tshirt_c_result_fluxes> c_fluxes(soil_params.size());
+        for (std::size_t m = 0; m < soil_params.size(); ++m) {
+            rain_m[m] = t < 12 ? 0.005 * (m + 1) : 0.0;
+            double rain_rate[] = {rain_m[m]};
+            aorc_forcing_data empty_forcing[1];
+            int num_added_fluxes = 0;
+            ASSERT_EQ(run(soil_params[m], gw_reservoirs[m], soil_reservoirs[m], 1, giuh_ordinates[m].data(),
+                          (int) giuh_ordinates[m].size(), runoff_queues[m].data(), 0.33, 0.01, schaake_constant[m],
+                          0.01 * (m + 1), K_nash[m], nash_n[m], c_nash_storage[m].data(), FALSE, empty_forcing,
+                          rain_rate, num_added_fluxes, &c_fluxes[m]), 0);
+        }
+        batch.run(rain_m);
+
+        for (std::size_t m = 0; m < soil_params.size(); ++m) {
+            conceptual_reservoir gw_reservoir, soil_reservoir;
+            std::vector<double> batch_nash_storage, batch_runoff_queue;
+            batch.get_state(m, gw_reservoir, soil_reservoir, batch_nash_storage, batch_runoff_queue);
+            EXPECT_DOUBLE_EQ(soil_reservoir.storage_m, soil_reservoirs[m].storage_m);
+            EXPECT_DOUBLE_EQ(gw_reservoir.storage_m, gw_reservoirs[m].storage_m);
+            ASSERT_EQ(batch_nash_storage.size(), c_nash_storage[m].size());
+            for (std::size_t i = 0; i < batch_nash_storage.size(); ++i) {
+                EXPECT_DOUBLE_EQ(batch_nash_storage[i], c_nash_storage[m][i]);
+            }
+            ASSERT_EQ(batch_runoff_queue.size(), runoff_queues[m].size());
+            for (std::size_t i = 0; i < batch_runoff_queue.size(); ++i) {
+                EXPECT_DOUBLE_EQ(batch_runoff_queue[i], runoff_queues[m][i]);
+            }
+
+            tshirt_c_result_fluxes batch_fluxes = batch.get_fluxes(m);
+            EXPECT_DOUBLE_EQ(batch_fluxes.timestep_rainfall_input_m, c_fluxes[m].timestep_rainfall_input_m);
+            EXPECT_DOUBLE_EQ(batch_fluxes.Schaake_output_runoff_m, c_fluxes[m].Schaake_output_runoff_m);
+            EXPECT_DOUBLE_EQ(batch_fluxes.giuh_runoff_m, c_fluxes[m].giuh_runoff_m);
+            EXPECT_DOUBLE_EQ(batch_fluxes.nash_lateral_runoff_m, c_fluxes[m].nash_lateral_runoff_m);
+            EXPECT_DOUBLE_EQ(batch_fluxes.flux_from_deep_gw_to_chan_m, c_fluxes[m].flux_from_deep_gw_to_chan_m);
+            EXPECT_DOUBLE_EQ(batch_fluxes.Qout_m, c_fluxes[m].Qout_m);
+        }
+    }
+}
+
+// Make sure members with too many Nash cascade reservoirs, mismatched cascade storage, or the wrong kinds of
+// reservoirs, or a batch run with inputs for the wrong number of members, are rejected.
+TEST_F(TshirtCBatchTest, TestInvalidArguments) {
+    tshirt_c_batch batch;
+    EXPECT_THROW(batch.add_member(soil_params[0], gw_reservoirs[0], soil_reservoirs[0], giuh_ordinates[0],
+                                  schaake_constant[0], K_nash[0], MAX_NUM_NASH_CASCADE + 1), std::invalid_argument);
+    EXPECT_THROW(batch.add_member(soil_params[0], gw_reservoirs[0], soil_reservoirs[0], giuh_ordinates[0],
+                                  schaake_constant[0], K_nash[0], 2, std::vector<double>{0.0}), std::invalid_argument);
+    EXPECT_THROW(batch.add_member(soil_params[0], soil_reservoirs[0], gw_reservoirs[0], giuh_ordinates[0],
+                                  schaake_constant[0], K_nash[0], 2), std::invalid_argument);
+    EXPECT_EQ(batch.size(), 0);
+
+    batch.add_member(soil_params[0], gw_reservoirs[0], soil_reservoirs[0], giuh_ordinates[0], schaake_constant[0],
+                     K_nash[0], nash_n[0]);
+    EXPECT_THROW(batch.run(std::vector<double>{0.0, 0.0}), std::invalid_argument);
+}
+
+// Make sure a device batch of the members runs exactly as the batch does, over a wet then dry period with its forcing
+// set at once, giving the same outflows each step and, copied back, the same state and fluxes.
+TEST_F(TshirtCBatchTest, TestDeviceRunMatchesBatch) {
+    tshirt_c_batch batch, device_source;
+    for (std::size_t m = 0; m < soil_params.size(); ++m) {
+        batch.add_member(soil_params[m], gw_reservoirs[m], soil_reservoirs[m], giuh_ordinates[m], schaake_constant[m],
+                         K_nash[m], nash_n[m], nash_storage[m]);
+        device_source.add_member(soil_params[m], gw_reservoirs[m], soil_reservoirs[m], giuh_ordinates[m],
+                                 schaake_constant[m], K_nash[m], nash_n[m], nash_storage[m]);
+    }
+    tshirt_c_device_batch device_batch(device_source);
+    ASSERT_EQ(device_batch.size(), soil_params.size());
+
+    const std::size_t steps = 48;
+    std::vector<double> rain_m(steps * soil_params.size());
+    for (std::size_t t = 0; t < steps; ++t) {
+        for (std::size_t m = 0; m < soil_params.size(); ++m) {
+            rain_m[t * soil_params.size() + m] = t < 12 ? 0.005 * (m + 1) : 0.0;
+        }
+    }
+    device_batch.set_forcing(rain_m, steps);
+    ASSERT_EQ(device_batch.get_forcing_steps(), steps);
+
+    std::vector<double> Qout_m;
+    for (std::size_t t = 0; t < steps; ++t) {
+        batch.run(std::vector<double>(rain_m.begin() + t * soil_params.size(),
+                                      rain_m.begin() + (t + 1) * soil_params.size()));
+        device_batch.run(t);
+        device_batch.get_Qout(Qout_m);
+        ASSERT_EQ(Qout_m.size(), soil_params.size());
+        for (std::size_t m = 0; m < soil_params.size(); ++m) {
+            EXPECT_DOUBLE_EQ(Qout_m[m], batch.get_fluxes(m).Qout_m);
+        }
+    }
+
+    device_batch.copy_to(device_source);
+    for (std::size_t m = 0; m < soil_params.size(); ++m) {
+        conceptual_reservoir gw_reservoir, soil_reservoir, device_gw_reservoir, device_soil_reservoir;
+        std::vector<double> nash, runoff_queue, device_nash, device_runoff_queue;
+        batch.get_state(m, gw_reservoir, soil_reservoir, nash, runoff_queue);
+        device_source.get_state(m, device_gw_reservoir, device_soil_reservoir, device_nash, device_runoff_queue);
+        EXPECT_DOUBLE_EQ(device_soil_reservoir.storage_m, soil_reservoir.storage_m);
+        EXPECT_DOUBLE_EQ(device_gw_reservoir.storage_m, gw_reservoir.storage_m);
+        ASSERT_EQ(device_nash.size(), nash.size());
+        for (std::size_t i = 0; i < nash.size(); ++i) {
+            EXPECT_DOUBLE_EQ(device_nash[i], nash[i]);
+        }
+        ASSERT_EQ(device_runoff_queue.size(), runoff_queue.size());
+        for (std::size_t i = 0; i < runoff_queue.size(); ++i) {
+            EXPECT_DOUBLE_EQ(device_runoff_queue[i], runoff_queue[i]);
+        }
+
+        tshirt_c_result_fluxes fluxes = batch.get_fluxes(m);
+        tshirt_c_result_fluxes device_fluxes = device_source.get_fluxes(m);
+        EXPECT_DOUBLE_EQ(device_fluxes.timestep_rainfall_input_m, fluxes.timestep_rainfall_input_m);
+        EXPECT_DOUBLE_EQ(device_fluxes.Schaake_output_runoff_m, fluxes.Schaake_output_runoff_m);
+        EXPECT_DOUBLE_EQ(device_fluxes.giuh_runoff_m, fluxes.giuh_runoff_m);
+        EXPECT_DOUBLE_EQ(device_fluxes.nash_lateral_runoff_m, fluxes.nash_lateral_runoff_m);
+        EXPECT_DOUBLE_EQ(device_fluxes.flux_from_deep_gw_to_chan_m, fluxes.flux_from_deep_gw_to_chan_m);
+    }
+
+    EXPECT_THROW(device_batch.run(steps), std::out_of_range);
+    EXPECT_THROW(device_batch.set_forcing(std::vector<double>{0.0}, 1), std::invalid_argument);
+}
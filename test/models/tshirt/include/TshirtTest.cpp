@@ -2,6 +2,7 @@
 #include "tshirt/include/Tshirt.h"
 #include "tshirt/include/tshirt_params.h"
 #include "GIUH.hpp"
+#include "TshirtErrorCodes.h"
 
 class TshirtModelTest : public ::testing::Test {
 
@@ -61,3 +62,26 @@ TEST_F(TshirtModelTest, TestRun0) {
 
 }
 
+
+// Make sure mass balance checked over several time steps only checks at the end of each period, and still balances.
+TEST_F(TshirtModelTest, TestRunMassCheckInterval) {
+    tshirt::tshirt_params params{1000.0, 1.0, 10.0, 0.1, 0.01, 3, 1.0, 1.0, 1.0, 1.0, 8, 1.0, 1.0, 100.0};
+    double input_flux = 10.0;
+
+    tshirt::tshirt_model model(params, make_shared<tshirt::tshirt_state>(tshirt::tshirt_state(1.0, 1.0)));
+    model.set_mass_check_interval(4);
+    ASSERT_EQ(model.get_mass_check_interval(), 4);
+    shared_ptr<pdm03_struct> et_params = make_shared<pdm03_struct>(pdm03_struct());
+    for (int t = 0; t < 8; ++t) {
+        EXPECT_EQ(model.run(86400.0, input_flux, et_params), tshirt::TSHIRT_NO_ERROR);
+    }
+
+    // With no interval, checks are only made when asked
+    tshirt::tshirt_model end_checked_model(params, make_shared<tshirt::tshirt_state>(tshirt::tshirt_state(1.0, 1.0)));
+    end_checked_model.set_mass_check_interval(0);
+    shared_ptr<pdm03_struct> end_checked_et_params = make_shared<pdm03_struct>(pdm03_struct());
+    for (int t = 0; t < 8; ++t) {
+        EXPECT_EQ(end_checked_model.run(86400.0, input_flux, end_checked_et_params), tshirt::TSHIRT_NO_ERROR);
+    }
+    EXPECT_EQ(end_checked_model.check_accumulated_mass_balance(), tshirt::TSHIRT_NO_ERROR);
+}
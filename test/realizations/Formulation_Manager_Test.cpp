@@ -1,11 +1,16 @@
 #include "gtest/gtest.h"
 #include <Formulation_Manager.hpp>
 #include <Catchment_Formulation.hpp>
+#include <CalibrationRun.hpp>
+#include <Simulation.hpp>
+#include <SpinUp.hpp>
+#include "core/catchment/CatchmentOutputWriter.hpp"
 
 #include <features/Features.hpp>
 #include <JSONGeometry.hpp>
 #include <JSONProperty.hpp>
 
+#include <cstring>
 #include <iostream>
 #include <memory>
 
@@ -14,6 +19,120 @@
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/json_parser.hpp>
 
+/**
+ * A BMI formulation of a simple linear reservoir fed by a forcing, run for each cell of a 1-D unstructured grid, so it can
+ * be run for a batch of catchments (see realization::Bmi_Batch), or unbatched for a single one.
+ */
+class Test_Grid_Formulation : public realization::Bmi_Formulation {
+
+    public:
+
+    Test_Grid_Formulation(std::string id, std::shared_ptr<data_access::GenericDataProvider> forcing, utils::StreamHandler output_stream)
+        : Bmi_Formulation(std::move(id), forcing, output_stream) { }
+
+    std::string get_formulation_type() override {
+        return "test_grid";
+    }
+
+    void create_formulation(boost::property_tree::ptree &config, geojson::PropertyMap *global = nullptr) override {
+        create_formulation(interpret_parameters(config, global));
+    }
+
+    void create_formulation(geojson::PropertyMap properties) override {
+        rate = properties.at("rate").as_real_number();
+        set_model_type_name("test_grid");
+        set_bmi_main_output_var("RESPONSE");
+        set_output_variable_names({"RESPONSE", "STORAGE"});
+        set_output_header_fields({"RESPONSE", "STORAGE"});
+        set_batch_members({get_catchment_id()}, {forcing});
+    }
+
+    void set_batch_members(const std::vector<std::string> &catchment_ids,
+                           const std::vector<std::shared_ptr<data_access::GenericDataProvider>> &forcings) override {
+        member_ids = catchment_ids;
+        member_forcings = forcings;
+        responses.assign(catchment_ids.size(), 0.0);
+        storages.assign(catchment_ids.size(), 0.0);
+    }
+
+    double get_response(time_step_t t_index, time_step_t t_delta) override {
+        for (size_t i = 0; i < member_ids.size(); ++i) {
+            time_t start = member_forcings[i]->get_data_start_time() + t_index * t_delta;
+            storages[i] += member_forcings[i]->get_value(
+                    CatchmentAggrDataSelector(member_ids[i], "DSWRF_surface", start, t_delta, "W m-2"), data_access::MEAN);
+            responses[i] = rate * storages[i];
+            storages[i] -= responses[i];
+        }
+        ++updates;
+        return responses[0];
+    }
+
+    void get_var_values_as_double(const std::string &var_name, std::vector<double> &values) override {
+        values = var_name == "RESPONSE" ? responses : storages;
+    }
+
+    bool get_output_values_for_timestep(int timestep, std::vector<double> &values) override {
+        values = {responses[0], storages[0]};
+        return true;
+    }
+
+    std::string get_output_line_for_timestep(int timestep, std::string delimiter) override {
+        std::vector<double> values;
+        get_output_values_for_timestep(timestep, values);
+        return format_output_values(values, delimiter);
+    }
+
+    const std::vector<std::string> &get_required_parameters() override {
+        static const std::vector<std::string> REQUIRED_PARAMETERS = {"rate"};
+        return REQUIRED_PARAMETERS;
+    }
+
+    double calc_et() override { return 0.0; }
+
+    /** @return How many times the model was updated, for all the cells at once. */
+    int get_updates() const { return updates; }
+
+    time_t convert_model_time(const double &model_time) override { return (time_t)model_time; }
+    const bool &get_allow_model_exceed_end_time() const override { return allow_exceed_end_time; }
+    const std::vector<std::string> get_bmi_input_variables() override { return {"DSWRF_surface"}; }
+    const time_t &get_bmi_model_start_time_forcing_offset_s() override { return start_time_offset; }
+    const std::vector<std::string> get_bmi_output_variables() override { return {"RESPONSE", "STORAGE"}; }
+    const std::string &get_config_mapped_variable_name(const std::string &model_var_name) override { return model_var_name; }
+    const double get_model_current_time() override { return updates; }
+    const double get_model_end_time() override { return 0.0; }
+    const std::string &get_forcing_file_path() const override { return forcing_file_path; }
+    bool is_bmi_input_variable(const std::string &var_name) override { return var_name == "DSWRF_surface"; }
+    bool is_bmi_model_time_step_fixed() override { return true; }
+    bool is_bmi_output_variable(const std::string &var_name) override { return var_name == "RESPONSE" || var_name == "STORAGE"; }
+    bool is_bmi_using_forcing_file() const override { return false; }
+    bool is_model_initialized() override { return true; }
+
+    const std::vector<std::string> &get_avaliable_variable_names() override { return output_names; }
+    long get_data_start_time() override { return 0; }
+    long get_data_stop_time() override { return 0; }
+    long record_duration() override { return 3600; }
+    size_t get_ts_index_for_time(const time_t &epoch_time) override { return 0; }
+    double get_value(const CatchmentAggrDataSelector &selector, data_access::ReSampleMethod m) override {
+        throw std::runtime_error("Test_Grid_Formulation does not provide values.");
+    }
+    std::vector<double> get_values(const CatchmentAggrDataSelector &selector, data_access::ReSampleMethod m) override {
+        throw std::runtime_error("Test_Grid_Formulation does not provide values.");
+    }
+
+    private:
+
+    double rate = 0.0;
+    std::vector<std::string> member_ids;
+    std::vector<std::shared_ptr<data_access::GenericDataProvider>> member_forcings;
+    std::vector<double> responses;
+    std::vector<double> storages;
+    int updates = 0;
+    bool allow_exceed_end_time = false;
+    time_t start_time_offset = 0;
+    std::string forcing_file_path;
+    std::vector<std::string> output_names = {"RESPONSE", "STORAGE"};
+};
+
 class Formulation_Manager_Test : public ::testing::Test {
 
     protected:
@@ -659,6 +778,392 @@ TEST_F(Formulation_Manager_Test, basic_reading_2) {
     ASSERT_TRUE(manager.contains("cat-67"));
 }
 
+TEST_F(Formulation_Manager_Test, parallel_reading_1) {
+    std::stringstream stream;
+    // Construct the formulations on several threads
+    stream << "{ \"execution\": { \"init_threads\": 2 }, " << fix_paths(EXAMPLE_1).substr(2);
+
+    std::ostream* raw_pointer = &std::cout;
+    std::shared_ptr<std::ostream> s_ptr(raw_pointer, [](void*) {});
+    utils::StreamHandler catchment_output(s_ptr);
+
+    realization::Formulation_Manager manager = realization::Formulation_Manager(stream);
+
+    this->add_feature("cat-52");
+    this->add_feature("cat-67");
+    manager.read(this->fabric, catchment_output);
+
+    ASSERT_EQ(manager.get_execution_params().init_threads, 2);
+    ASSERT_EQ(manager.get_size(), 2);
+
+    ASSERT_TRUE(manager.contains("cat-52"));
+    ASSERT_TRUE(manager.contains("cat-67"));
+}
+
+TEST_F(Formulation_Manager_Test, config_without_reading) {
+    std::stringstream stream;
+    // What a dry run needs of the config, with no formulation constructed
+    stream << "{ \"execution\": { \"catchment_threads\": 4 }, " << fix_paths(EXAMPLE_1).substr(2);
+
+    realization::Formulation_Manager manager = realization::Formulation_Manager(stream);
+
+    ASSERT_EQ(manager.get_formulation_type("cat-52"), "simple_lumped");
+    ASSERT_EQ(manager.get_formulation_type("cat-67"), "tshirt");
+    // Catchments without their own config have the global formulation
+    ASSERT_EQ(manager.get_formulation_type("cat-27"), "tshirt");
+    ASSERT_EQ(manager.get_catchment_threads_config(), 4);
+
+    simulation_time_params time_config = manager.get_simulation_time_config();
+    ASSERT_EQ(time_config.output_interval, 3600);
+    ASSERT_EQ(Simulation_Time(time_config).get_total_output_times(), 720);
+    ASSERT_EQ(manager.get_size(), 0);
+}
+
+TEST_F(Formulation_Manager_Test, formulation_time_step) {
+    std::stringstream stream;
+    // Step the simple lumped formulation of cat-52 daily, and the global formulation of cat-67 half-hourly
+    std::string config = fix_paths(EXAMPLE_1);
+    const std::string lumped_name = "\"name\": \"simple_lumped\", ";
+    config.replace(config.find(lumped_name), lumped_name.size(), lumped_name + "\"time_step\": 86400, ");
+    const std::string global_name = "\"name\": \"tshirt\", ";
+    config.replace(config.find(global_name), global_name.size(), global_name + "\"time_step\": 1800, ");
+    // Leave cat-67 to the global formulation
+    config = config.substr(0, config.find(", \"cat-67\"")) + " } }";
+    stream << config;
+
+    std::ostream* raw_pointer = &std::cout;
+    std::shared_ptr<std::ostream> s_ptr(raw_pointer, [](void*) {});
+    utils::StreamHandler catchment_output(s_ptr);
+
+    realization::Formulation_Manager manager = realization::Formulation_Manager(stream);
+
+    this->add_feature("cat-52");
+    this->add_feature("cat-67");
+    manager.read(this->fabric, catchment_output);
+
+    ASSERT_EQ(manager.get_size(), 2);
+    ASSERT_EQ(manager.get_formulation("cat-52")->get_time_step_seconds(), 86400);
+    ASSERT_EQ(manager.get_formulation("cat-67")->get_time_step_seconds(), 1800);
+}
+
+TEST_F(Formulation_Manager_Test, ensemble_members) {
+    std::stringstream stream;
+    // Run the simple lumped formulation of cat-52 as an ensemble of its config and one with a faster ground water
+    std::string config = fix_paths(EXAMPLE_1);
+    config = config.substr(0, config.find(", \"cat-67\"")) + " } }";
+    std::string ensemble_config = config;
+    const std::string lumped_name = "\"name\": \"simple_lumped\", \"params\": {";
+    const std::size_t lumped_start = ensemble_config.find(lumped_name);
+    const std::size_t lumped_end = ensemble_config.find("} ", ensemble_config.find("\"t\": 0", lumped_start)) + 1;
+    ensemble_config.replace(lumped_end, 0, "}, \"members\": [ {}, { \"Ks\": 0.5 } ] }");
+    ensemble_config.replace(lumped_start, 0, "\"name\": \"ensemble\", \"params\": { \"formulation\": { ");
+    stream << ensemble_config;
+
+    std::ostream* raw_pointer = &std::cout;
+    std::shared_ptr<std::ostream> s_ptr(raw_pointer, [](void*) {});
+    utils::StreamHandler catchment_output(s_ptr);
+
+    realization::Formulation_Manager manager = realization::Formulation_Manager(stream);
+    this->add_feature("cat-52");
+    manager.read(this->fabric, catchment_output);
+
+    auto ensemble = std::dynamic_pointer_cast<realization::Ensemble_Formulation>(manager.get_formulation("cat-52"));
+    ASSERT_NE(ensemble, nullptr);
+    ASSERT_EQ(ensemble->get_members().size(), 2);
+    ASSERT_EQ(ensemble->get_output_header_line(","), "ensemble_mean,member_0,member_1");
+
+    // The first member is the formulation of the config
+    std::stringstream single_stream;
+    single_stream << config;
+    realization::Formulation_Manager single_manager = realization::Formulation_Manager(single_stream);
+    single_manager.read(this->fabric, catchment_output);
+    auto single = single_manager.get_formulation("cat-52");
+
+    pdm03_struct pdm_et_data = pdm03_struct();
+    pdm_et_data.scaled_distribution_fn_shape_parameter = 1.3;
+    pdm_et_data.vegetation_adjustment = 0.99;
+    pdm_et_data.model_time_step = 0.0;
+    pdm_et_data.max_height_soil_moisture_storerage_tank = 400.0;
+    pdm_et_data.maximum_combined_contents = pdm_et_data.max_height_soil_moisture_storerage_tank / (1.0+pdm_et_data.scaled_distribution_fn_shape_parameter);
+    std::shared_ptr<pdm03_struct> et_params_ptr = std::make_shared<pdm03_struct>(pdm_et_data);
+    ensemble->set_et_params(et_params_ptr);
+    single->set_et_params(et_params_ptr);
+
+    std::vector<double> values;
+    for (long t = 0; t < 24; t++) {
+        double mean = ensemble->get_response(t, 3600);
+        double expected = single->get_response(t, 3600);
+        ASSERT_TRUE(ensemble->get_output_values_for_timestep(t, values));
+        ASSERT_EQ(values.size(), 3);
+        ASSERT_DOUBLE_EQ(values[1], expected);
+        ASSERT_DOUBLE_EQ(mean, (values[1] + values[2]) / 2);
+        ASSERT_DOUBLE_EQ(values[0], mean);
+    }
+}
+
+TEST_F(Formulation_Manager_Test, calibration_run) {
+    // Calibrate the simple lumped formulation of cat-52 against its nexus, with its own Kq and a faster one
+    std::string config_json = fix_paths(EXAMPLE_1);
+    config_json = config_json.substr(0, config_json.find(", \"cat-67\"")) + " } }";
+    std::stringstream config_stream(config_json);
+    boost::property_tree::ptree config;
+    boost::property_tree::json_parser::read_json(config_stream, config);
+
+    const double area_sqkm = 21.67825320610988;
+    geojson::PropertyMap properties{
+        {"areasqkm", geojson::JSONProperty("areasqkm", area_sqkm)},
+        {"toid", geojson::JSONProperty("toid", std::string("nex-34"))}
+    };
+    geojson::GeoJSON catchments = std::make_shared<geojson::FeatureCollection>();
+    catchments->add_feature(std::make_shared<geojson::PointFeature>(
+        geojson::PointFeature(geojson::coordinate_t(0.0, 0.0), "cat-52", properties)));
+
+    calibration::ParameterSets sets;
+    sets.names = {"Kq"};
+    sets.values = {{0.01}, {0.5}};
+
+    pdm03_struct pdm_et_data = pdm03_struct();
+    pdm_et_data.scaled_distribution_fn_shape_parameter = 1.3;
+    pdm_et_data.vegetation_adjustment = 0.99;
+    pdm_et_data.model_time_step = 0.0;
+    pdm_et_data.max_height_soil_moisture_storerage_tank = 400.0;
+    pdm_et_data.maximum_combined_contents = pdm_et_data.max_height_soil_moisture_storerage_tank / (1.0+pdm_et_data.scaled_distribution_fn_shape_parameter);
+    std::shared_ptr<pdm03_struct> et_params_ptr = std::make_shared<pdm03_struct>(pdm_et_data);
+
+    calibration::CalibrationRun calibration_run(config, catchments, sets, et_params_ptr);
+    ASSERT_EQ(calibration_run.size(), 2);
+    ASSERT_THROW(calibration_run.run({"nex-1"}), std::invalid_argument);
+    std::vector<calibration::CalibrationRun::gauge_flows_t> flows = calibration_run.run({"nex-34"});
+    ASSERT_EQ(flows.size(), 1);
+    ASSERT_EQ(flows[0].size(), 2);
+    ASSERT_EQ(flows[0][0].size(), 720);
+
+    // The first set is the formulation of the config, whose responses the gauge receives in m^3/s
+    std::stringstream stream(config_json);
+    std::ostream* raw_pointer = &std::cout;
+    std::shared_ptr<std::ostream> s_ptr(raw_pointer, [](void*) {});
+    utils::StreamHandler catchment_output(s_ptr);
+    realization::Formulation_Manager manager = realization::Formulation_Manager(stream);
+    this->add_feature("cat-52");
+    manager.read(this->fabric, catchment_output);
+    auto single = manager.get_formulation("cat-52");
+    single->set_et_params(et_params_ptr);
+
+    bool sets_differ = false;
+    for (long t = 0; t < 720; t++) {
+        ASSERT_NEAR(flows[0][0][t], single->get_response(t, 3600) * area_sqkm * 1000000 / 3600, EPSILON);
+        sets_differ = sets_differ || flows[0][1][t] != flows[0][0][t];
+    }
+    ASSERT_TRUE(sets_differ);
+}
+
+TEST_F(Formulation_Manager_Test, simulation) {
+    // Step the simple lumped formulation of cat-52 in chunks, reading the flows of its nexus from memory
+    std::string config_json = fix_paths(EXAMPLE_1);
+    config_json = config_json.substr(0, config_json.find(", \"cat-67\"")) + " } }";
+    std::stringstream config_stream(config_json);
+    boost::property_tree::ptree config;
+    boost::property_tree::json_parser::read_json(config_stream, config);
+
+    const double area_sqkm = 21.67825320610988;
+    geojson::PropertyMap properties{
+        {"areasqkm", geojson::JSONProperty("areasqkm", area_sqkm)},
+        {"toid", geojson::JSONProperty("toid", std::string("nex-34"))}
+    };
+    geojson::GeoJSON catchments = std::make_shared<geojson::FeatureCollection>();
+    catchments->add_feature(std::make_shared<geojson::PointFeature>(
+        geojson::PointFeature(geojson::coordinate_t(0.0, 0.0), "cat-52", properties)));
+
+    pdm03_struct pdm_et_data = pdm03_struct();
+    pdm_et_data.scaled_distribution_fn_shape_parameter = 1.3;
+    pdm_et_data.vegetation_adjustment = 0.99;
+    pdm_et_data.model_time_step = 0.0;
+    pdm_et_data.max_height_soil_moisture_storerage_tank = 400.0;
+    pdm_et_data.maximum_combined_contents = pdm_et_data.max_height_soil_moisture_storerage_tank / (1.0+pdm_et_data.scaled_distribution_fn_shape_parameter);
+    std::shared_ptr<pdm03_struct> et_params_ptr = std::make_shared<pdm03_struct>(pdm_et_data);
+
+    ngen::Simulation simulation(config, catchments, 2, et_params_ptr);
+    ASSERT_EQ(simulation.get_total_steps(), 720);
+    ASSERT_EQ(simulation.get_catchment_ids(), std::vector<std::string>{"cat-52"});
+    ASSERT_EQ(simulation.get_nexus_ids(), std::vector<std::string>{"nex-34"});
+
+    // The same formulation run on its own, for the flows the nexus should receive
+    std::stringstream stream(config_json);
+    std::ostream* raw_pointer = &std::cout;
+    std::shared_ptr<std::ostream> s_ptr(raw_pointer, [](void*) {});
+    utils::StreamHandler catchment_output(s_ptr);
+    realization::Formulation_Manager manager = realization::Formulation_Manager(stream);
+    this->add_feature("cat-52");
+    manager.read(this->fabric, catchment_output);
+    auto single = manager.get_formulation("cat-52");
+    single->set_et_params(et_params_ptr);
+
+    long t = 0;
+    for (int chunk : {1, 100, 1000}) {
+        const int steps = simulation.step(chunk);
+        ASSERT_EQ(steps, std::min<long>(chunk, 720 - t));
+        ASSERT_EQ(simulation.get_first_step_index(), t);
+        ngen::FlowView nexus_flows = simulation.nexus_flows();
+        ngen::FlowView catchment_flows = simulation.catchment_flows();
+        ASSERT_EQ(nexus_flows.steps, steps);
+        ASSERT_EQ(nexus_flows.features, 1);
+        for (int s = 0; s < steps; ++s, ++t) {
+            const double expected = single->get_response(t, 3600) * area_sqkm * 1000000 / 3600;
+            ASSERT_NEAR(catchment_flows.at(s, 0), expected, EPSILON);
+            ASSERT_NEAR(nexus_flows.at(s, 0), expected, EPSILON);
+        }
+    }
+    ASSERT_EQ(simulation.get_time_index(), 720);
+    ASSERT_EQ(simulation.step(1), 0);
+    ASSERT_EQ(simulation.nexus_flows().steps, 0);
+
+    simulation.finalize();
+    ASSERT_THROW(simulation.step(1), std::logic_error);
+}
+
+TEST_F(Formulation_Manager_Test, response_cache) {
+    // cat-52 has its own simple lumped formulation, and cat-67 the global one
+    char cache_dir[] = "/tmp/ngen_response_cache_XXXXXX";
+    ASSERT_NE(mkdtemp(cache_dir), nullptr);
+    std::string config = fix_paths(EXAMPLE_1);
+    config = "{ \"execution\": { \"response_cache\": \"" + std::string(cache_dir) + "\" }, "
+             + config.substr(2, config.find(", \"cat-67\"") - 2) + " } }";
+
+    std::ostream* raw_pointer = &std::cout;
+    std::shared_ptr<std::ostream> s_ptr(raw_pointer, [](void*) {});
+    utils::StreamHandler catchment_output(s_ptr);
+
+    pdm03_struct pdm_et_data = pdm03_struct();
+    pdm_et_data.scaled_distribution_fn_shape_parameter = 1.3;
+    pdm_et_data.vegetation_adjustment = 0.99;
+    pdm_et_data.model_time_step = 0.0;
+    pdm_et_data.max_height_soil_moisture_storerage_tank = 400.0;
+    pdm_et_data.maximum_combined_contents = pdm_et_data.max_height_soil_moisture_storerage_tank / (1.0+pdm_et_data.scaled_distribution_fn_shape_parameter);
+    std::shared_ptr<pdm03_struct> et_params_ptr = std::make_shared<pdm03_struct>(pdm_et_data);
+
+    this->add_feature("cat-52");
+    this->add_feature("cat-67");
+
+    // The first run has nothing cached, so runs both formulations and caches their responses
+    std::stringstream first_stream(config);
+    realization::Formulation_Manager first_manager = realization::Formulation_Manager(first_stream);
+    first_manager.read(this->fabric, catchment_output);
+    ASSERT_NE(first_manager.get_response_cache(), nullptr);
+    std::map<std::string, std::vector<double>> responses;
+    for (const std::string id : {"cat-52", "cat-67"}) {
+        auto formulation = first_manager.get_formulation(id);
+        ASSERT_NE(formulation->get_formulation_type(), "cached_response");
+        formulation->set_et_params(et_params_ptr);
+        auto entry = first_manager.get_response_cache()->start_entry(
+            id, catchment_output::CatchmentOutputAggregator::split_names(formulation->get_output_header_line(",")));
+        ASSERT_NE(entry, nullptr);
+        std::vector<double> values;
+        for (long t = 0; t < 24; t++) {
+            responses[id].push_back(formulation->get_response(t, 3600));
+            if (!formulation->get_output_values_for_timestep(t, values)) {
+                values = catchment_output::BinaryCatchmentOutputWriter::parse_values(
+                    formulation->get_output_line_for_timestep(t, ","));
+            }
+            entry->record(t, responses[id].back(), values);
+        }
+        ASSERT_TRUE(entry->is_valid);
+        first_manager.get_response_cache()->store(id, *entry);
+    }
+
+    // A rerun of the same config replays both
+    std::stringstream second_stream(config);
+    realization::Formulation_Manager second_manager = realization::Formulation_Manager(second_stream);
+    second_manager.read(this->fabric, catchment_output);
+    for (const std::string id : {"cat-52", "cat-67"}) {
+        auto formulation = second_manager.get_formulation(id);
+        ASSERT_EQ(formulation->get_formulation_type(), "cached_response");
+        ASSERT_EQ(formulation->get_output_header_line(","), first_manager.get_formulation(id)->get_output_header_line(","));
+        for (long t = 0; t < 24; t++) {
+            // Replayed exactly, even a NaN response
+            double response = formulation->get_response(t, 3600);
+            ASSERT_EQ(0, std::memcmp(&response, &responses[id][t], sizeof(double))) << id << " at " << t;
+        }
+        ASSERT_THROW(formulation->get_response(24, 3600), std::out_of_range);
+    }
+
+    // Changing the parameters of cat-52 leaves only cat-67 to replay
+    std::string changed_config = config;
+    const std::string kq = "\"Kq\": 0.01";
+    changed_config.replace(changed_config.find(kq), kq.size(), "\"Kq\": 0.02");
+    std::stringstream changed_stream(changed_config);
+    realization::Formulation_Manager changed_manager = realization::Formulation_Manager(changed_stream);
+    changed_manager.read(this->fabric, catchment_output);
+    ASSERT_NE(changed_manager.get_formulation("cat-52")->get_formulation_type(), "cached_response");
+    ASSERT_EQ(changed_manager.get_formulation("cat-67")->get_formulation_type(), "cached_response");
+
+    for (const std::string id : {"cat-52", "cat-67"}) {
+        std::remove((std::string(cache_dir) + "/" + id + realization::RESPONSE_CACHE_EXTENSION).c_str());
+    }
+    rmdir(cache_dir);
+}
+
+TEST_F(Formulation_Manager_Test, spin_up) {
+    // Spin cat-52 up over the first 10 days, then run the rest of the month from its spun up state
+    char cache_dir[] = "/tmp/ngen_spinup_XXXXXX";
+    ASSERT_NE(mkdtemp(cache_dir), nullptr);
+    std::string full_config = fix_paths(EXAMPLE_1);
+    full_config = full_config.substr(0, full_config.find(", \"cat-67\"")) + " } }";
+    std::string config = full_config;
+    const std::string start_time = "\"start_time\": \"2015-12-01 00:00:00\"";
+    config.replace(config.find(start_time), start_time.size(), "\"start_time\": \"2015-12-11 00:00:00\"");
+    config = "{ \"spinup\": { " + start_time + ", \"cache\": \"" + std::string(cache_dir) + "\" }, "
+             + config.substr(2);
+
+    std::ostream* raw_pointer = &std::cout;
+    std::shared_ptr<std::ostream> s_ptr(raw_pointer, [](void*) {});
+    utils::StreamHandler catchment_output(s_ptr);
+
+    pdm03_struct pdm_et_data = pdm03_struct();
+    pdm_et_data.scaled_distribution_fn_shape_parameter = 1.3;
+    pdm_et_data.vegetation_adjustment = 0.99;
+    pdm_et_data.model_time_step = 0.0;
+    pdm_et_data.max_height_soil_moisture_storerage_tank = 400.0;
+    pdm_et_data.maximum_combined_contents = pdm_et_data.max_height_soil_moisture_storerage_tank / (1.0+pdm_et_data.scaled_distribution_fn_shape_parameter);
+    std::shared_ptr<pdm03_struct> et_params_ptr = std::make_shared<pdm03_struct>(pdm_et_data);
+
+    this->add_feature("cat-52");
+    utils::ThreadPool pool(1);
+
+    // The run continues where a run over the whole month is after the spin-up
+    std::stringstream full_stream(full_config);
+    realization::Formulation_Manager full_manager = realization::Formulation_Manager(full_stream);
+    full_manager.read(this->fabric, catchment_output);
+    auto full = full_manager.get_formulation("cat-52");
+    full->set_et_params(et_params_ptr);
+    std::vector<double> full_responses;
+    for (long t = 0; t < 264; t++) {
+        full_responses.push_back(full->get_response(t, 3600));
+    }
+
+    std::uint64_t signature = 0;
+    for (std::size_t expected_cached : {0, 1}) {
+        std::stringstream stream(config);
+        realization::Formulation_Manager manager = realization::Formulation_Manager(stream);
+        manager.read(this->fabric, catchment_output);
+        ASSERT_TRUE(manager.get_spinup_params().enabled);
+        std::shared_ptr<realization::Formulation_Manager> spinup_manager = manager.make_spinup_manager();
+        spinup_manager->read(this->fabric, catchment_output);
+        ASSERT_EQ(spinup_manager->Simulation_Time_Object->get_total_output_times(), 240);
+        signature = spinup_manager->get_signature("cat-52");
+
+        // The second run takes the end state from the cache
+        ASSERT_EQ(spinup::spin_up(manager, *spinup_manager, et_params_ptr, pool), expected_cached);
+        auto formulation = manager.get_formulation("cat-52");
+        formulation->set_et_params(et_params_ptr);
+        for (long t = 0; t < 24; t++) {
+            ASSERT_NEAR(formulation->get_response(t, 3600), full_responses[240 + t], EPSILON);
+        }
+    }
+
+    std::remove(spinup::state_path(cache_dir, "cat-52", signature).c_str());
+    rmdir(cache_dir);
+}
+
 TEST_F(Formulation_Manager_Test, basic_run_1) {
     std::stringstream stream;
     stream << fix_paths(EXAMPLE_1);
@@ -741,6 +1246,34 @@ TEST_F(Formulation_Manager_Test, basic_run_3) {
     }
 }
 
+/** Test that native formulations run their time steps statically dispatched, with the same responses. */
+TEST_F(Formulation_Manager_Test, native_formulation_dispatch) {
+    std::ostream* raw_pointer = &std::cout;
+    std::shared_ptr<std::ostream> s_ptr(raw_pointer, [](void*) {});
+    utils::StreamHandler catchment_output(s_ptr);
+
+    this->add_feature("cat-67");
+    std::stringstream stream_1;
+    stream_1 << fix_paths(EXAMPLE_3);
+    realization::Formulation_Manager manager_1 = realization::Formulation_Manager(stream_1);
+    manager_1.read(this->fabric, catchment_output);
+    std::stringstream stream_2;
+    stream_2 << fix_paths(EXAMPLE_3);
+    realization::Formulation_Manager manager_2 = realization::Formulation_Manager(stream_2);
+    manager_2.read(this->fabric, catchment_output);
+
+    std::shared_ptr<realization::Catchment_Formulation> virtual_run = manager_1.get_formulation("cat-67");
+    std::shared_ptr<realization::Catchment_Formulation> static_run = manager_2.get_formulation("cat-67");
+    int tag = realization::get_native_formulation_tag(*static_run);
+    ASSERT_LT(tag, (int) realization::native_formulations::size);
+
+    double expected = 0.0;
+    for (int i = 0; i < 3; i++) {
+        expected += virtual_run->get_response(i, 3600);
+    }
+    ASSERT_EQ(realization::run_formulation_steps(tag, *static_run, 0, 3, 3600), expected);
+}
+
 TEST_F(Formulation_Manager_Test, read_extra) {
     std::stringstream stream;
     stream << fix_paths(EXAMPLE_3);
@@ -804,3 +1337,155 @@ TEST_F(Formulation_Manager_Test, forcing_provider_specification) {
     }
 }
 
+
+/**
+ * Config of the global test_grid formulation for every catchment, with the given extra formulation params.
+ */
+std::string grid_example(const std::string &extra_params) {
+    return "{ "
+        "\"global\": { "
+          "\"formulations\": [ "
+            "{ "
+              "\"name\": \"test_grid\", "
+              "\"params\": { " + extra_params + "\"rate\": 0.25 } "
+            "} "
+          "], "
+          "\"forcing\": { "
+              "\"file_pattern\": \".*{{id}}.*.csv\", "
+              "\"path\": \"./data/forcing/\", "
+              "\"provider\": \"CsvPerFeature\" "
+          "} "
+        "}, "
+        "\"time\": { "
+            "\"start_time\": \"2015-12-01 00:00:00\", "
+            "\"end_time\": \"2015-12-30 23:00:00\", "
+            "\"output_interval\": 3600 "
+        "} "
+    "}";
+}
+
+TEST_F(Formulation_Manager_Test, batch_grouping) {
+    realization::formulations.emplace("test_grid", realization::create_formulation_constructor<Test_Grid_Formulation>());
+    std::stringstream stream(grid_example("\"batch_size\": 2, "));
+
+    std::ostream* raw_pointer = &std::cout;
+    std::shared_ptr<std::ostream> s_ptr(raw_pointer, [](void*) {});
+    utils::StreamHandler catchment_output(s_ptr);
+
+    realization::Formulation_Manager manager = realization::Formulation_Manager(stream);
+    this->add_feature("cat-27");
+    this->add_feature("cat-52");
+    this->add_feature("cat-67");
+    manager.read(this->fabric, catchment_output);
+
+    ASSERT_EQ(manager.get_size(), 3);
+    std::map<std::string, std::shared_ptr<realization::Bmi_Batched_Formulation>> batched;
+    for (const std::string id : {"cat-27", "cat-52", "cat-67"}) {
+        batched[id] = std::dynamic_pointer_cast<realization::Bmi_Batched_Formulation>(manager.get_formulation(id));
+        ASSERT_NE(batched[id], nullptr);
+    }
+
+    // Catchments are batched in hydrofabric order, the last batch holding those left over
+    const std::shared_ptr<realization::Bmi_Batch> &first = batched["cat-27"]->get_batch();
+    ASSERT_EQ(batched["cat-52"]->get_batch(), first);
+    ASSERT_EQ(first->get_catchment_ids(), std::vector<std::string>({"cat-27", "cat-52"}));
+    ASSERT_EQ(batched["cat-27"]->get_batch_index(), 0);
+    ASSERT_EQ(batched["cat-52"]->get_batch_index(), 1);
+
+    const std::shared_ptr<realization::Bmi_Batch> &last = batched["cat-67"]->get_batch();
+    ASSERT_NE(last, first);
+    ASSERT_EQ(last->get_catchment_ids(), std::vector<std::string>({"cat-67"}));
+    ASSERT_EQ(batched["cat-67"]->get_batch_index(), 0);
+
+    // Each batch runs a single model, created like that of its first catchment
+    ASSERT_NE(first->get_formulation(), last->get_formulation());
+    ASSERT_EQ(first->get_formulation()->get_id(), "cat-27");
+    ASSERT_EQ(batched["cat-52"]->get_output_header_line(","), "RESPONSE,STORAGE");
+}
+
+TEST_F(Formulation_Manager_Test, batch_members_match_unbatched) {
+    realization::formulations.emplace("test_grid", realization::create_formulation_constructor<Test_Grid_Formulation>());
+    std::stringstream batched_stream(grid_example("\"batch_size\": 2, "));
+    std::stringstream unbatched_stream(grid_example(""));
+
+    std::ostream* raw_pointer = &std::cout;
+    std::shared_ptr<std::ostream> s_ptr(raw_pointer, [](void*) {});
+    utils::StreamHandler catchment_output(s_ptr);
+
+    this->add_feature("cat-27");
+    this->add_feature("cat-52");
+    this->add_feature("cat-67");
+    realization::Formulation_Manager batched_manager = realization::Formulation_Manager(batched_stream);
+    batched_manager.read(this->fabric, catchment_output);
+    realization::Formulation_Manager unbatched_manager = realization::Formulation_Manager(unbatched_stream);
+    unbatched_manager.read(this->fabric, catchment_output);
+
+    // Run each catchment to the end before the next, so the batch keeps the values of every time step a catchment
+    // of it has yet to reach
+    const int steps = 48;
+    for (const std::string id : {"cat-27", "cat-52", "cat-67"}) {
+        std::shared_ptr<realization::Catchment_Formulation> batched = batched_manager.get_formulation(id);
+        std::shared_ptr<realization::Catchment_Formulation> unbatched = unbatched_manager.get_formulation(id);
+        ASSERT_NE(std::dynamic_pointer_cast<Test_Grid_Formulation>(unbatched), nullptr);
+        std::vector<double> batched_values;
+        std::vector<double> unbatched_values;
+        for (int t = 0; t < steps; ++t) {
+            ASSERT_DOUBLE_EQ(batched->get_response(t, 3600), unbatched->get_response(t, 3600)) << id << " at " << t;
+            ASSERT_TRUE(batched->get_output_values_for_timestep(t, batched_values));
+            ASSERT_TRUE(unbatched->get_output_values_for_timestep(t, unbatched_values));
+            ASSERT_EQ(batched_values.size(), 2);
+            ASSERT_DOUBLE_EQ(batched_values[0], unbatched_values[0]);
+            ASSERT_DOUBLE_EQ(batched_values[1], unbatched_values[1]);
+            ASSERT_EQ(batched->get_output_line_for_timestep(t, ","), unbatched->get_output_line_for_timestep(t, ","));
+        }
+        // Daylight reaches the reservoir during the first day
+        ASSERT_GT(batched_values[1], 0.0);
+    }
+
+    // The model of a batch is updated once per time step for all its catchments
+    std::shared_ptr<realization::Bmi_Batched_Formulation> member =
+            std::dynamic_pointer_cast<realization::Bmi_Batched_Formulation>(batched_manager.get_formulation("cat-52"));
+    std::shared_ptr<Test_Grid_Formulation> model =
+            std::dynamic_pointer_cast<Test_Grid_Formulation>(member->get_batch()->get_formulation());
+    ASSERT_EQ(model->get_updates(), steps);
+}
+
+TEST_F(Formulation_Manager_Test, batch_releases_steps) {
+    realization::formulations.emplace("test_grid", realization::create_formulation_constructor<Test_Grid_Formulation>());
+    std::stringstream stream(grid_example("\"batch_size\": 2, "));
+
+    std::ostream* raw_pointer = &std::cout;
+    std::shared_ptr<std::ostream> s_ptr(raw_pointer, [](void*) {});
+    utils::StreamHandler catchment_output(s_ptr);
+
+    realization::Formulation_Manager manager = realization::Formulation_Manager(stream);
+    this->add_feature("cat-27");
+    this->add_feature("cat-52");
+    manager.read(this->fabric, catchment_output);
+
+    std::shared_ptr<realization::Catchment_Formulation> ahead = manager.get_formulation("cat-27");
+    std::shared_ptr<realization::Catchment_Formulation> behind = manager.get_formulation("cat-52");
+    std::vector<double> values;
+
+    for (int t = 0; t < 4; ++t) {
+        ahead->get_response(t, 3600);
+    }
+    behind->get_response(0, 3600);
+
+    // Time step 0 is kept until every catchment of the batch has moved past it
+    ASSERT_TRUE(ahead->get_output_values_for_timestep(0, values));
+    ASSERT_TRUE(behind->get_output_values_for_timestep(3, values));
+
+    behind->get_response(1, 3600);
+    ASSERT_THROW(ahead->get_output_values_for_timestep(0, values), std::invalid_argument);
+    ASSERT_THROW(behind->get_output_values_for_timestep(0, values), std::invalid_argument);
+    ASSERT_THROW(behind->get_response(0, 3600), std::invalid_argument);
+    ASSERT_TRUE(ahead->get_output_values_for_timestep(1, values));
+
+    // Time steps not yet run have no values
+    ASSERT_THROW(ahead->get_output_values_for_timestep(4, values), std::invalid_argument);
+
+    behind->get_response(3, 3600);
+    ASSERT_THROW(ahead->get_output_values_for_timestep(2, values), std::invalid_argument);
+    ASSERT_TRUE(ahead->get_output_values_for_timestep(3, values));
+}
@@ -53,6 +53,10 @@ protected:
         return (model_data*) adapter->bmi_model->data;
     }
 
+    static Bmi* friend_get_bmi_struct(Bmi_C_Adapter *adapter) {
+        return adapter->bmi_model.get();
+    }
+
     std::string config_file_name_0;
     std::string lib_file_name_0;
     std::string forcing_file_name_0;
@@ -605,6 +609,25 @@ TEST_F(Bmi_C_Adapter_Test, GetVarNbytes_0_a) {
         throw e;
     }
 }
+/** Test variable metadata is served from the table taken after initialization, without calling into the model. */
+TEST_F(Bmi_C_Adapter_Test, GetVarMetadata_0_a) {
+    std::string variable_name = adapter->GetOutputVarNames()[0];
+
+    // Any further metadata request that reaches the model now fails
+    Bmi *model = friend_get_bmi_struct(adapter.get());
+    model->get_var_type = [](Bmi *, const char *, char *) { return BMI_FAILURE; };
+    model->get_var_units = [](Bmi *, const char *, char *) { return BMI_FAILURE; };
+    model->get_var_itemsize = [](Bmi *, const char *, int *) { return BMI_FAILURE; };
+    model->get_var_nbytes = [](Bmi *, const char *, int *) { return BMI_FAILURE; };
+
+    ASSERT_EQ(adapter->GetVarType(variable_name), expected_output_var_types[0]);
+    ASSERT_EQ(adapter->GetVarUnits(variable_name), expected_output_var_units[0]);
+    ASSERT_EQ(adapter->GetVarItemsize(variable_name), expected_var_nbytes);
+    ASSERT_EQ(adapter->GetVarNbytes(variable_name), expected_var_nbytes);
+    // Variables the model doesn't have are still asked of it
+    ASSERT_THROW(adapter->GetVarNbytes("NOT_A_VARIABLE"), std::runtime_error);
+}
+
 // Test model GetVarGrid() function is disabled currently.  Suggest disabling test until fully implemented.
 /** Test grid type can be retrieved for output 1 */
 TEST_F(Bmi_C_Adapter_Test, DISABLED_GetGridType_0_a) {
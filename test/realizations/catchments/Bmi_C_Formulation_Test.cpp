@@ -17,6 +17,8 @@
 #include "Bmi_C_Formulation.hpp"
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"
+#include <cstdio>
+#include <fstream>
 #include <iostream>
 #include <vector>
 #include <boost/property_tree/ptree.hpp>
@@ -285,6 +287,62 @@ TEST_F(Bmi_C_Formulation_Test, set_initial_parameters_0_a) {
     ASSERT_EQ(param3[1], 2.0);
 }
 
+/** Test of initial parameters taken from a parameter table, with those of model_params taking precedence. */
+TEST_F(Bmi_C_Formulation_Test, set_initial_parameters_table_0_a) {
+    int ex_index = 0;
+    const std::string table_file = "bmi_c_formulation_test_params.csv";
+    {
+        std::ofstream table(table_file);
+        table << "divide_id,p1,p2,p3_a,p3_b\ncat-1,1,1.1,1,1\n" << catchment_ids[ex_index] << ",7,0.7,8,9\n";
+    }
+    boost::property_tree::ptree config = config_prop_ptree[ex_index];
+    config.get_child("model_params").erase("PARAM_VAR_2");
+    config.get_child("model_params").erase("PARAM_VAR_3");
+    std::stringstream table_json;
+    table_json << "{\"path\": \"" << table_file << "\", \"id_column\": \"divide_id\", \"params\": "
+               << "{\"PARAM_VAR_1\": \"p1\", \"PARAM_VAR_2\": \"p2\", \"PARAM_VAR_3\": [\"p3_a\", \"p3_b\"]}}";
+    boost::property_tree::ptree table_config;
+    boost::property_tree::json_parser::read_json(table_json, table_config);
+    config.put_child(BMI_REALIZATION_CFG_PARAM_OPT__PARAMS_TABLE, table_config);
+
+    Bmi_C_Formulation formulation(catchment_ids[ex_index], std::make_shared<CsvPerFeatureForcingProvider>(*forcing_params_examples[ex_index]), utils::StreamHandler());
+    formulation.create_formulation(config);
+    std::remove(table_file.c_str());
+
+    std::shared_ptr<models::bmi::Bmi_C_Adapter> bmi_c_adapter = get_friend_bmi_model(formulation);
+    ASSERT_EQ(models::bmi::GetValue<int>(*bmi_c_adapter, "PARAM_VAR_1")[0], 42);
+    ASSERT_EQ(models::bmi::GetValue<double>(*bmi_c_adapter, "PARAM_VAR_2")[0], 0.7);
+    std::vector<double> param3 = models::bmi::GetValue<double>(*bmi_c_adapter, "PARAM_VAR_3");
+    ASSERT_EQ(param3.size(), 2);
+    ASSERT_EQ(param3[0], 8.0);
+    ASSERT_EQ(param3[1], 9.0);
+}
+
+/** Test of initializing a model from its rendering of a templated init config, which is removed again. */
+TEST_F(Bmi_C_Formulation_Test, init_config_template_0_a) {
+    int ex_index = 0;
+    const std::string template_file = "bmi_c_formulation_test_config.template";
+    {
+        std::ofstream config(template_file);
+        config << "epoch_start_time=1448949600\nnum_time_steps={{PARAM_VAR_1}}\n";
+    }
+    boost::property_tree::ptree config = config_prop_ptree[ex_index];
+    config.put(BMI_REALIZATION_CFG_PARAM_REQ__INIT_CONFIG, template_file);
+    config.put(BMI_REALIZATION_CFG_PARAM_OPT__INIT_CONFIG_TEMPLATE, true);
+    config.put(BMI_REALIZATION_CFG_PARAM_OPT__INIT_CONFIG_DIR, ".");
+
+    Bmi_C_Formulation formulation(catchment_ids[ex_index], std::make_shared<CsvPerFeatureForcingProvider>(*forcing_params_examples[ex_index]), utils::StreamHandler());
+    formulation.create_formulation(config);
+    std::remove(template_file.c_str());
+
+    ASSERT_EQ(get_friend_bmi_init_config(formulation), template_file);
+    std::shared_ptr<models::bmi::Bmi_C_Adapter> bmi_c_adapter = get_friend_bmi_model(formulation);
+    ASSERT_EQ(bmi_c_adapter->GetEndTime() - bmi_c_adapter->GetStartTime(), 42 * bmi_c_adapter->GetTimeStep());
+    // The parameter filled a placeholder, so was not also set in the model
+    ASSERT_NE(models::bmi::GetValue<int>(*bmi_c_adapter, "PARAM_VAR_1")[0], 42);
+    ASSERT_EQ(models::bmi::GetValue<double>(*bmi_c_adapter, "PARAM_VAR_2")[0], 4.2);
+}
+
 /** Test of get response after several iterations. */
 TEST_F(Bmi_C_Formulation_Test, GetResponse_0_b) {
     int ex_index = 0;
@@ -300,6 +358,29 @@ TEST_F(Bmi_C_Formulation_Test, GetResponse_0_b) {
     ASSERT_EQ(expected, response);
 }
 
+/** Test that output values read through the formulation follow the model as it updates, in any requested type. */
+TEST_F(Bmi_C_Formulation_Test, GetValue_0_a) {
+    int ex_index = 0;
+
+    Bmi_C_Formulation formulation(catchment_ids[ex_index], std::make_shared<CsvPerFeatureForcingProvider>(*forcing_params_examples[ex_index]), utils::StreamHandler());
+    formulation.create_formulation(config_prop_ptree[ex_index]);
+
+    std::string units = get_friend_bmi_model(formulation)->GetVarUnits("OUTPUT_VAR_1");
+    CatchmentAggrDataSelector selector(catchment_ids[ex_index], "OUTPUT_VAR_1", 0, 3600, units);
+    for (int i = 0; i < 39; i++) {
+        formulation.get_response(i, 3600);
+        double expected = get_friend_var_value_as_double(formulation, "OUTPUT_VAR_1");
+        ASSERT_EQ(formulation.get_value(selector, data_access::SUM), expected);
+        ASSERT_EQ(formulation.get_values(selector, data_access::SUM), std::vector<double>({expected}));
+        float typed[2] = {-1.0f, -1.0f};
+        ASSERT_EQ(formulation.get_values_into(selector, data_access::SUM, data_access::ValueType::FLOAT, typed, 2), 1);
+        ASSERT_EQ(typed[0], (float) expected);
+        ASSERT_EQ(typed[1], -1.0f);
+    }
+    CatchmentAggrDataSelector invalid(catchment_ids[ex_index], "NOT_AN_OUTPUT", 0, 3600, units);
+    ASSERT_THROW(formulation.get_value(invalid, data_access::SUM), std::runtime_error);
+}
+
 /** Test to make sure we can execute multiple model instances with dynamic loading. */
 TEST_F(Bmi_C_Formulation_Test, GetResponse_1_a) {
     Bmi_C_Formulation form_1(catchment_ids[0], std::make_shared<CsvPerFeatureForcingProvider>(*forcing_params_examples[0]), utils::StreamHandler());
@@ -317,6 +398,31 @@ TEST_F(Bmi_C_Formulation_Test, GetResponse_1_a) {
     }
 }
 
+/** Test that a formulation created from a configured prototype matches one created from its config. */
+TEST_F(Bmi_C_Formulation_Test, create_from_prototype_1_a) {
+    int ex_index = 1;
+
+    geojson::PropertyMap properties;
+    for (auto &param : config_prop_ptree[ex_index]) {
+        properties.emplace(param.first, geojson::JSONProperty(param.first, param.second));
+    }
+    Bmi_C_Formulation prototype("prototype", nullptr, utils::StreamHandler());
+    ASSERT_TRUE(prototype.configure_prototype(properties));
+
+    Bmi_C_Formulation formulation(catchment_ids[ex_index], std::make_shared<CsvPerFeatureForcingProvider>(*forcing_params_examples[ex_index]), utils::StreamHandler());
+    ASSERT_TRUE(formulation.create_from_prototype(prototype, properties));
+
+    Bmi_C_Formulation expected(catchment_ids[ex_index], std::make_shared<CsvPerFeatureForcingProvider>(*forcing_params_examples[ex_index]), utils::StreamHandler());
+    expected.create_formulation(config_prop_ptree[ex_index]);
+
+    ASSERT_EQ(get_friend_bmi_init_config(formulation), get_friend_bmi_init_config(expected));
+    ASSERT_EQ(formulation.get_output_header_line(","), expected.get_output_header_line(","));
+    for (int i = 0; i < 545; ++i) {
+        ASSERT_EQ(formulation.get_response(i, 3600), expected.get_response(i, 3600));
+        ASSERT_EQ(formulation.get_output_line_for_timestep(i, ","), expected.get_output_line_for_timestep(i, ","));
+    }
+}
+
 /** Simple test of output. */
 TEST_F(Bmi_C_Formulation_Test, GetOutputLineForTimestep_0_a) {
     int ex_index = 0;
@@ -360,6 +466,62 @@ TEST_F(Bmi_C_Formulation_Test, GetOutputLineForTimestep_1_b) {
     EXPECT_THAT(output, MatchesRegex("0.000000,0.000001"));
 }
 
+/** Test that a formulation restored from saved state continues with the same response. */
+TEST_F(Bmi_C_Formulation_Test, save_and_load_state_0_a) {
+    int ex_index = 0;
+
+    boost::property_tree::ptree config = config_prop_ptree[ex_index];
+    boost::property_tree::ptree checkpoint_vars, checkpoint_var;
+    checkpoint_var.put("", "OUTPUT_VAR_1");
+    checkpoint_vars.push_back(std::make_pair("", checkpoint_var));
+    config.add_child(BMI_REALIZATION_CFG_PARAM_OPT__CHECKPOINT_VARS, checkpoint_vars);
+
+    Bmi_C_Formulation formulation(catchment_ids[ex_index], std::make_shared<CsvPerFeatureForcingProvider>(*forcing_params_examples[ex_index]), utils::StreamHandler());
+    formulation.create_formulation(config);
+    for (int i = 0; i < 5; i++) {
+        formulation.get_response(i, 3600);
+    }
+    utils::StateWriter out;
+    formulation.save_state(out);
+    double expected = formulation.get_response(5, 3600);
+
+    Bmi_C_Formulation restored(catchment_ids[ex_index], std::make_shared<CsvPerFeatureForcingProvider>(*forcing_params_examples[ex_index]), utils::StreamHandler());
+    restored.create_formulation(config);
+    utils::StateReader in(out.get_bytes());
+    restored.load_state(in);
+    ASSERT_TRUE(in.at_end());
+    ASSERT_EQ(restored.get_response(5, 3600), expected);
+}
+
+/** Test that saving state requires the state variables to be configured. */
+TEST_F(Bmi_C_Formulation_Test, save_and_load_state_0_b) {
+    int ex_index = 0;
+
+    Bmi_C_Formulation formulation(catchment_ids[ex_index], std::make_shared<CsvPerFeatureForcingProvider>(*forcing_params_examples[ex_index]), utils::StreamHandler());
+    formulation.create_formulation(config_prop_ptree[ex_index]);
+
+    utils::StateWriter out;
+    ASSERT_THROW(formulation.save_state(out), std::runtime_error);
+}
+
+/** Test that numeric output values match, and format to, the output line. */
+TEST_F(Bmi_C_Formulation_Test, GetOutputValuesForTimestep_1_b) {
+    int ex_index = 1;
+
+    Bmi_C_Formulation formulation(catchment_ids[ex_index], std::make_shared<CsvPerFeatureForcingProvider>(*forcing_params_examples[ex_index]), utils::StreamHandler());
+    formulation.create_formulation(config_prop_ptree[ex_index]);
+
+    int i = 0;
+    while (i < 542)
+        formulation.get_response(i++, 3600);
+    formulation.get_response(i, 3600);
+    std::vector<double> values;
+    ASSERT_TRUE(formulation.get_output_values_for_timestep(i, values));
+    ASSERT_EQ(values.size(), formulation.get_output_variable_names().size());
+    ASSERT_EQ(formulation.format_output_values(values, ","), formulation.get_output_line_for_timestep(i, ","));
+    ASSERT_THROW(formulation.get_output_values_for_timestep(i - 1, values), std::invalid_argument);
+}
+
 TEST_F(Bmi_C_Formulation_Test, determine_model_time_offset_0_a) {
     int ex_index = 0;
 
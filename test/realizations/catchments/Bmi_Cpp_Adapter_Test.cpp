@@ -232,6 +232,35 @@ TEST_F(Bmi_Cpp_Adapter_Test, SetValue_0_c) {
 }
 
 
+/** Test that the test model's variables have handles, which reach the same values as their names. */
+TEST_F(Bmi_Cpp_Adapter_Test, GetVarIndex_0_a) {
+    adapter->Initialize();
+    ASSERT_TRUE(adapter->is_indexed());
+    int in_1_index = adapter->GetVarIndex("INPUT_VAR_1");
+    int out_1_index = adapter->GetVarIndex("OUTPUT_VAR_1");
+    ASSERT_GE(in_1_index, 0);
+    ASSERT_GE(out_1_index, 0);
+    ASSERT_NE(in_1_index, out_1_index);
+    ASSERT_EQ(adapter->GetVarIndex("NOT_A_VAR"), -1);
+    EXPECT_EQ(adapter->GetValuePtrByIndex(in_1_index), adapter->GetValuePtr("INPUT_VAR_1"));
+    EXPECT_EQ(adapter->GetValuePtrByIndex(out_1_index), adapter->GetValuePtr("OUTPUT_VAR_1"));
+    adapter->Finalize();
+}
+
+/** Test that setting a value by handle sets it as by name. */
+TEST_F(Bmi_Cpp_Adapter_Test, SetValueByIndex_0_a) {
+    adapter->Initialize();
+    double value = 8.0;
+    adapter->SetValueByIndex(adapter->GetVarIndex("INPUT_VAR_2"), &value);
+    double retrieved;
+    adapter->GetValue("INPUT_VAR_2", &retrieved);
+    double retrieved_by_index;
+    adapter->GetValueByIndex(adapter->GetVarIndex("INPUT_VAR_2"), &retrieved_by_index);
+    adapter->Finalize();
+    ASSERT_EQ(value, retrieved);
+    ASSERT_EQ(value, retrieved_by_index);
+}
+
 
 //Everything below this line is identical to Bmi_C_Adapter_Test.cpp ... 
 // possible to extract a common test suite for at least these two?
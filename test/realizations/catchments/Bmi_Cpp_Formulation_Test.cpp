@@ -337,6 +337,24 @@ TEST_F(Bmi_Cpp_Formulation_Test, GetOutputLineForTimestep_1_b) {
     ASSERT_EQ(output, "0.000000,0.000001");
 }
 
+/** Test that numeric output values match, and format to, the output line. */
+TEST_F(Bmi_Cpp_Formulation_Test, GetOutputValuesForTimestep_1_b) {
+    int ex_index = 1;
+
+    Bmi_Cpp_Formulation formulation(catchment_ids[ex_index], std::make_unique<CsvPerFeatureForcingProvider>(*forcing_params_examples[ex_index]), utils::StreamHandler());
+    formulation.create_formulation(config_prop_ptree[ex_index]);
+
+    int i = 0;
+    while (i < 542)
+        formulation.get_response(i++, 3600);
+    formulation.get_response(i, 3600);
+    std::vector<double> values;
+    ASSERT_TRUE(formulation.get_output_values_for_timestep(i, values));
+    ASSERT_EQ(values.size(), formulation.get_output_variable_names().size());
+    ASSERT_EQ(formulation.format_output_values(values, ","), formulation.get_output_line_for_timestep(i, ","));
+    ASSERT_THROW(formulation.get_output_values_for_timestep(i - 1, values), std::invalid_argument);
+}
+
 TEST_F(Bmi_Cpp_Formulation_Test, determine_model_time_offset_0_a) {
     int ex_index = 0;
 
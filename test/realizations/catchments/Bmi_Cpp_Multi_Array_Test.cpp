@@ -115,9 +115,58 @@ protected:
     /** Collections of names of the registrations config files names for nested modules of each example, in the order of the nested modules. */
     std::vector<std::vector<std::string>> nested_registration_function_lists;
     std::vector<bool> uses_forcing_file;
+    /** Whether the nested modules of the examples write their inputs in place. */
+    bool inputs_in_place = false;
     std::vector<std::shared_ptr<forcing_params>> forcing_params_examples;
     std::vector<boost::property_tree::ptree> config_prop_ptree;
 
+    inline void buildExampleConfig(const int ex_index) {
+        std::string config =
+                "{\n"
+                "    \"global\": {},\n"
+                "    \"catchments\": {\n"
+                "        \"" + catchment_ids[ex_index] + "\": {\n"
+                "            \"formulations\": [\n"
+                "                {\n"
+                "                    \"name\": \"" + std::string(BMI_MULTI_TYPE) + "\",\n"
+                "                    \"params\": {\n"
+                "                        \"model_type_name\": \"bmi_multi_test\",\n"
+                "                        \"forcing_file\": \"\",\n"
+                "                        \"init_config\": \"\",\n"
+                "                        \"allow_exceed_end_time\": true,\n"
+                "                        \"main_output_variable\": \"" + main_output_variables[ex_index] + "\",\n"
+                "                        \"modules\": [\n"
+                + buildNested(ex_index, 0) + ",\n"
+                + buildNested(ex_index, 1) + "\n"
+                "                        ],\n"
+                "                        \"uses_forcing_file\": false\n"
+                "                    }\n"
+                "                }\n"
+                "            ],\n"
+                "            \"forcing\": {\n"
+                "                \"path\": \"" + example_forcing_files[ex_index] + "\",\n"
+                "                \"provider\": \"CsvPerFeature\"\n"
+                "            }\n"
+                "        }\n"
+                "    },\n"
+                "    \"time\": {\n"
+                "        \"start_time\": \"2012-05-01 00:00:00\",\n"
+                "        \"end_time\": \"2012-05-31 23:00:00\",\n"
+                "        \"output_interval\": 3600\n"
+                "    }\n"
+                "}";
+
+        config_json[ex_index] = config;
+
+        std::stringstream stream;
+        stream << config_json[ex_index];
+
+        boost::property_tree::ptree loaded_tree;
+        boost::property_tree::json_parser::read_json(stream, loaded_tree);
+        config_prop_ptree[ex_index] = loaded_tree.get_child("catchments").get_child(catchment_ids[ex_index]).get_child(
+                "formulations").begin()->second.get_child("params");
+    }
+
 private:
 
     /**
@@ -164,6 +213,7 @@ private:
                 "                                \"allow_exceed_end_time\": true,\n"
                 "                                \"main_output_variable\": \"" + nested_module_main_output_variables[ex_index][nested_index] + "\",\n"
                 "                                \"" + BMI_REALIZATION_CFG_PARAM_OPT__OUTPUT_PRECISION + "\": 6,\n"
+                "                                \"" + BMI_REALIZATION_CFG_PARAM_OPT__INPUTS_IN_PLACE + "\": " + (inputs_in_place ? "true" : "false") + ",\n"
 
                 "                                \"library_file\": \"" + nested_module_file_lists[ex_index][nested_index] + "\",\n"
                 "                                \"registration_function\": \"" + nested_registration_function_lists[ex_index][nested_index] + "\",\n"
@@ -208,53 +258,6 @@ private:
         }
     }
 
-    inline void buildExampleConfig(const int ex_index) {
-        std::string config =
-                "{\n"
-                "    \"global\": {},\n"
-                "    \"catchments\": {\n"
-                "        \"" + catchment_ids[ex_index] + "\": {\n"
-                "            \"formulations\": [\n"
-                "                {\n"
-                "                    \"name\": \"" + std::string(BMI_MULTI_TYPE) + "\",\n"
-                "                    \"params\": {\n"
-                "                        \"model_type_name\": \"bmi_multi_test\",\n"
-                "                        \"forcing_file\": \"\",\n"
-                "                        \"init_config\": \"\",\n"
-                "                        \"allow_exceed_end_time\": true,\n"
-                "                        \"main_output_variable\": \"" + main_output_variables[ex_index] + "\",\n"
-                "                        \"modules\": [\n"
-                + buildNested(ex_index, 0) + ",\n"
-                + buildNested(ex_index, 1) + "\n"
-                "                        ],\n"
-                "                        \"uses_forcing_file\": false\n"
-                "                    }\n"
-                "                }\n"
-                "            ],\n"
-                "            \"forcing\": {\n"
-                "                \"path\": \"" + example_forcing_files[ex_index] + "\",\n"
-                "                \"provider\": \"CsvPerFeature\"\n"
-                "            }\n"
-                "        }\n"
-                "    },\n"
-                "    \"time\": {\n"
-                "        \"start_time\": \"2012-05-01 00:00:00\",\n"
-                "        \"end_time\": \"2012-05-31 23:00:00\",\n"
-                "        \"output_interval\": 3600\n"
-                "    }\n"
-                "}";
-
-        config_json[ex_index] = config;
-
-        std::stringstream stream;
-        stream << config_json[ex_index];
-
-        boost::property_tree::ptree loaded_tree;
-        boost::property_tree::json_parser::read_json(stream, loaded_tree);
-        config_prop_ptree[ex_index] = loaded_tree.get_child("catchments").get_child(catchment_ids[ex_index]).get_child(
-                "formulations").begin()->second.get_child("params");
-    }
-
     inline void initializeTestExample(const int ex_index, const std::string &cat_id,
                                       const std::vector<std::string> &nested_types) {
         catchment_ids[ex_index] = cat_id;
@@ -375,6 +378,22 @@ TEST_F(Bmi_Cpp_Multi_Array_Test, Pass_Bmi_Array_0) {
     ASSERT_EQ(data,  expected);
 }
 
+/** Test that the value array passes from one module into the next just the same when written in place. */
+TEST_F(Bmi_Cpp_Multi_Array_Test, Pass_Bmi_Array_In_Place_0) {
+    int ex_index = 0;
+    inputs_in_place = true;
+    buildExampleConfig(ex_index);
+
+    Bmi_Multi_Formulation formulation(catchment_ids[ex_index], std::make_unique<CsvPerFeatureForcingProvider>(*forcing_params_examples[ex_index]), utils::StreamHandler());
+    formulation.create_formulation(config_prop_ptree[ex_index]);
+
+    formulation.get_response(0, 3600);
+
+    std::vector<double> expected = {1000, 2000, 3000};
+    auto data = get_friend_nested_var_values<models::bmi::Bmi_Cpp_Adapter, Bmi_Cpp_Formulation>(formulation, 1, "INPUT_VAR_3");
+    ASSERT_EQ(data,  expected);
+}
+
 /**
  * Simple test of output for example 0.
  */
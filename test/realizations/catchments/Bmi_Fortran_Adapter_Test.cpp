@@ -964,6 +964,28 @@ TEST_F(Bmi_Fortran_Adapter_Test, Update_until_0_b) {
     adapter->Finalize();
 }
 
+/** Test that bulk transfers pass matching types straight through, and convert the others. */
+TEST_F(Bmi_Fortran_Adapter_Test, BulkValues_0_a) {
+    adapter->Initialize();
+    double value1 = 5.0;
+    adapter->set_values_from("INPUT_VAR_1", &value1, 1);
+    double value2 = 6.0;
+    adapter->set_values_from("INPUT_VAR_2", &value2, 1);
+    double value3 = 7.0;
+    adapter->set_values_from("INPUT_VAR_3", &value3, 1);
+    double retrieved[3];
+    adapter->get_values_as("INPUT_VAR_1", &retrieved[0], 1);
+    adapter->get_values_as("INPUT_VAR_2", &retrieved[1], 1);
+    adapter->get_values_as("INPUT_VAR_3", &retrieved[2], 1);
+    ASSERT_EQ(GetValue<float>(*adapter, "INPUT_VAR_2")[0], 6.0f);
+    ASSERT_EQ(GetValue<int>(*adapter, "INPUT_VAR_3")[0], 7);
+    ASSERT_THROW(adapter->get_values_as("INPUT_VAR_1", &retrieved[0], 2), std::runtime_error);
+    adapter->Finalize();
+    ASSERT_EQ(retrieved[0], value1);
+    ASSERT_EQ(retrieved[1], value2);
+    ASSERT_EQ(retrieved[2], value3);
+}
+
 /* Tests  dependent on Update() */
 /** Test that both the get value function works for output 1. */
 TEST_F(Bmi_Fortran_Adapter_Test, GetValue_0_d) {
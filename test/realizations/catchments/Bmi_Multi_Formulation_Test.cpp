@@ -801,6 +801,48 @@ TEST_F(Bmi_Multi_Formulation_Test, GetOutputLineForTimestep_3_a) {
     ASSERT_EQ(output, "0.000001112,199280.000000000,199240.000000000,199280.000000000,0.000000000,0.000001001");
 }
 
+/**
+ * Test that the output format taken along with the output values of example 0, which are those of the last module,
+ * formats them as the output line, without the formulation.
+ */
+TEST_F(Bmi_Multi_Formulation_Test, GetOutputFormat_0_b) {
+    int ex_index = 0;
+
+    Bmi_Multi_Formulation formulation(catchment_ids[ex_index], std::make_unique<CsvPerFeatureForcingProvider>(*forcing_params_examples[ex_index]), utils::StreamHandler());
+    formulation.create_formulation(config_prop_ptree[ex_index]);
+
+    int i = 0;
+    while (i < 542)
+        formulation.get_response(i++, 3600);
+    formulation.get_response(i, 3600);
+    std::vector<double> values;
+    ASSERT_TRUE(formulation.get_output_values_for_timestep(i, values));
+    Formulation::OutputFormat format = formulation.get_output_format();
+    ASSERT_EQ(format.format(values, ","), "0.000001,199280.000000");
+}
+
+/**
+ * Test that the output format taken along with the output values of example 3, from multiple BMI modules, formats them
+ * as the output line, without the formulation.
+ */
+TEST_F(Bmi_Multi_Formulation_Test, GetOutputFormat_3_a) {
+    int ex_index = 3;
+
+    Bmi_Multi_Formulation formulation(catchment_ids[ex_index], std::make_unique<CsvPerFeatureForcingProvider>(*forcing_params_examples[ex_index]), utils::StreamHandler());
+    formulation.create_formulation(config_prop_ptree[ex_index]);
+
+    int i = 0;
+    while (i < 542)
+        formulation.get_response(i++, 3600);
+    formulation.get_response(i, 3600);
+    std::vector<double> values;
+    ASSERT_TRUE(formulation.get_output_values_for_timestep(i, values));
+    Formulation::OutputFormat format = formulation.get_output_format();
+    ASSERT_EQ(format.format(values, ","), formulation.get_output_line_for_timestep(i, ","));
+    ASSERT_EQ(format.format(values, ","),
+              "0.000001112,199280.000000000,199240.000000000,199280.000000000,0.000000000,0.000001001");
+}
+
 /**
  * Test if Catchment Ids of submodules correctly trim any suffix
  */
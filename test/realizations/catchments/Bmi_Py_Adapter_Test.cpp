@@ -845,27 +845,45 @@ TEST_F(Bmi_Py_Adapter_Test, DISABLED_GetGridOrigin_0_a) {
 }
 
 /**
- * Test the function for getting the location of grid nodes in the first dimension for the grid of output variable 1.
+ * Test the function for getting the location of grid nodes in the first dimension for the grid of output variable 1,
+ * which is a scalar grid, without coordinate arrays.
  */
-TEST_F(Bmi_Py_Adapter_Test, DISABLED_GetGridX_0_a) {
-    // TODO: requires model support
-    ASSERT_TRUE(false);
+TEST_F(Bmi_Py_Adapter_Test, GetGridX_0_a) {
+    size_t ex_index = 0;
+
+    std::string var_name = "OUTPUT_VAR_1";
+    examples[ex_index].adapter->Initialize();
+    int grid_id = examples[ex_index].adapter->GetVarGrid(var_name);
+    double coordinates[10];
+    ASSERT_THROW(examples[ex_index].adapter->GetGridX(grid_id, coordinates), std::runtime_error);
 }
 
 /**
- * Test the function for getting the location of grid nodes in the second dimension for the grid of output variable 1.
+ * Test the function for getting the location of grid nodes in the second dimension for the grid of output variable 1,
+ * which is a scalar grid, without coordinate arrays.
  */
-TEST_F(Bmi_Py_Adapter_Test, DISABLED_GetGridY_0_a) {
-    // TODO: requires model support
-    ASSERT_TRUE(false);
+TEST_F(Bmi_Py_Adapter_Test, GetGridY_0_a) {
+    size_t ex_index = 0;
+
+    std::string var_name = "OUTPUT_VAR_1";
+    examples[ex_index].adapter->Initialize();
+    int grid_id = examples[ex_index].adapter->GetVarGrid(var_name);
+    double coordinates[10];
+    ASSERT_THROW(examples[ex_index].adapter->GetGridY(grid_id, coordinates), std::runtime_error);
 }
 
 /**
- * Test the function for getting the location of grid nodes in the third dimension for the grid of output variable 1.
+ * Test the function for getting the location of grid nodes in the third dimension for the grid of output variable 1,
+ * which is a scalar grid, without coordinate arrays.
  */
-TEST_F(Bmi_Py_Adapter_Test, DISABLED_GetGridZ_0_a) {
-    // TODO: requires model support
-    ASSERT_TRUE(false);
+TEST_F(Bmi_Py_Adapter_Test, GetGridZ_0_a) {
+    size_t ex_index = 0;
+
+    std::string var_name = "OUTPUT_VAR_1";
+    examples[ex_index].adapter->Initialize();
+    int grid_id = examples[ex_index].adapter->GetVarGrid(var_name);
+    double coordinates[10];
+    ASSERT_THROW(examples[ex_index].adapter->GetGridZ(grid_id, coordinates), std::runtime_error);
 }
 
 /**
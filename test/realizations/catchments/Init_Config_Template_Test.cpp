@@ -0,0 +1,75 @@
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "Init_Config_Template.hpp"
+
+using realization::Init_Config_Template;
+
+class Init_Config_Template_Test : public ::testing::Test {
+
+    protected:
+
+    ~Init_Config_Template_Test() override {
+        std::remove(file_name.c_str());
+    }
+
+    //! Write a temporary template file with the given contents.
+    void write(const std::string& contents) {
+        std::ofstream out(file_name, std::ios::binary);
+        out << contents;
+    }
+
+    static std::string read(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        std::stringstream contents;
+        contents << in.rdbuf();
+        return contents.str();
+    }
+
+    std::string file_name = "init_config_template_test.config";
+
+};
+
+//! Test that placeholders are filled with the id and parameter values, numbers in their shortest exact form.
+TEST_F(Init_Config_Template_Test, TestRender) {
+    write("id={{id}}\nKn={{Kn}}\nn={{nash_n}}\nsoil={{soil}}\nagain={{Kn}}");
+    Init_Config_Template config(file_name);
+    ASSERT_EQ(config.get_parameter_names(), std::vector<std::string>({"Kn", "nash_n", "soil"}));
+
+    geojson::PropertyMap params;
+    params.emplace("Kn", geojson::JSONProperty("Kn", 0.1));
+    params.emplace("nash_n", geojson::JSONProperty("nash_n", 2L));
+    params.emplace("soil", geojson::JSONProperty("soil", std::vector<geojson::JSONProperty>{
+            geojson::JSONProperty("soil", 0.25), geojson::JSONProperty("soil", 1.0 / 3)}));
+    EXPECT_EQ(config.render("cat-1", params),
+              "id=cat-1\nKn=0.1\nn=2\nsoil=0.25,0.3333333333333333\nagain=0.1");
+
+    params.erase("soil");
+    EXPECT_THROW(config.render("cat-1", params), std::runtime_error);
+}
+
+//! Test that a rendered config is written to a new file in the given directory.
+TEST_F(Init_Config_Template_Test, TestWriteRendered) {
+    write("id={{id}}\n");
+    Init_Config_Template config(file_name);
+    std::string first = config.write_rendered(".", "cat-1", geojson::PropertyMap());
+    std::string second = config.write_rendered(".", "cat-1", geojson::PropertyMap());
+    EXPECT_NE(first, second);
+    EXPECT_EQ(read(first), "id=cat-1\n");
+    std::remove(first.c_str());
+    std::remove(second.c_str());
+
+    EXPECT_THROW(config.write_rendered("./missing_directory", "cat-1", geojson::PropertyMap()), std::runtime_error);
+}
+
+//! Test that templates without a closing brace pair are rejected.
+TEST_F(Init_Config_Template_Test, TestUnterminatedPlaceholder) {
+    write("id={{id\n");
+    EXPECT_THROW(Init_Config_Template config(file_name), std::runtime_error);
+}
@@ -0,0 +1,72 @@
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "Parameter_Table.hpp"
+
+using realization::Parameter_Table;
+
+class Parameter_Table_Test : public ::testing::Test {
+
+    protected:
+
+    ~Parameter_Table_Test() override {
+        std::remove(file_name.c_str());
+    }
+
+    //! Write a temporary table file with the given contents.
+    void write(const std::string& contents) {
+        std::ofstream out(file_name, std::ios::binary);
+        out << contents;
+    }
+
+    std::string file_name = "parameter_table_test.csv";
+
+};
+
+//! Test that only the columns asked for are read, by catchment, with empty fields missing.
+TEST_F(Parameter_Table_Test, TestReadsColumnsByCatchment) {
+    write("divide_id,area,Kn,nash_n\ncat-1,1.5,0.03,2\ncat-2,2.5,,3\n");
+    Parameter_Table table(file_name, "divide_id", {"nash_n", "Kn"});
+
+    ASSERT_EQ(table.size(), 2);
+    EXPECT_EQ(table.column_index("nash_n"), 0);
+    EXPECT_EQ(table.column_index("Kn"), 1);
+    EXPECT_EQ(table.column_index("area"), -1);
+    EXPECT_EQ(table.row_index("cat-3"), -1);
+
+    long row = table.row_index("cat-2");
+    ASSERT_GE(row, 0);
+    EXPECT_EQ(table.get_value(0, row), 3.0);
+    EXPECT_TRUE(std::isnan(table.get_value(1, row)));
+    EXPECT_EQ(table.get_value(1, table.row_index("cat-1")), 0.03);
+}
+
+//! Test that tables lacking a column asked for, or with a catchment twice, are rejected.
+TEST_F(Parameter_Table_Test, TestRejectsInvalidTables) {
+    write("divide_id,Kn\ncat-1,0.03\ncat-1,0.04\n");
+    EXPECT_THROW(Parameter_Table(file_name, "divide_id", {"Kn"}), std::runtime_error);
+    EXPECT_THROW(Parameter_Table(file_name, "id", {"Kn"}), std::runtime_error);
+
+    write("divide_id,Kn\ncat-1,0.03\n");
+    EXPECT_THROW(Parameter_Table(file_name, "divide_id", {"Klf"}), std::runtime_error);
+    EXPECT_THROW(Parameter_Table("parameter_table_test.txt", "divide_id", {"Kn"}), std::runtime_error);
+}
+
+//! Test that a shared table is reused when it has every column asked for, and read again with them when not.
+TEST_F(Parameter_Table_Test, TestSharedTables) {
+    write("divide_id,Kn,Klf\ncat-1,0.03,0.5\n");
+    auto first = Parameter_Table::get_shared(file_name, "divide_id", {"Kn"});
+    EXPECT_EQ(Parameter_Table::get_shared(file_name, "divide_id", {"Kn"}), first);
+
+    auto second = Parameter_Table::get_shared(file_name, "divide_id", {"Klf"});
+    EXPECT_NE(second, first);
+    EXPECT_GE(second->column_index("Kn"), 0);
+    EXPECT_EQ(second->get_value(second->column_index("Klf"), 0), 0.5);
+    EXPECT_EQ(Parameter_Table::get_shared(file_name, "divide_id", {"Kn", "Klf"}), second);
+}
@@ -0,0 +1,89 @@
+#include "gtest/gtest.h"
+#include "Routing_Pipeline.hpp"
+
+#include <atomic>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using routing_py_adapter::Routing_Pipeline;
+
+class RoutingPipelineTest : public ::testing::Test {
+
+protected:
+
+    std::vector<std::string> nexus_ids = {"nex-1", "nex-2"};
+};
+
+//! Chunks are routed in order, from copies of the flows they were submitted with.
+TEST_F(RoutingPipelineTest, TestChunksRoutedInOrder)
+{
+    std::vector<std::vector<std::string>> routed_timestamps;
+    std::vector<std::vector<double>> routed_flows;
+    Routing_Pipeline pipeline([&](const std::vector<std::string>& ids, const std::vector<std::string>& timestamps,
+                                  const double* flows, std::size_t row_stride) {
+        ASSERT_EQ(ids.size(), 2);
+        routed_timestamps.push_back(timestamps);
+        std::vector<double> rows;
+        for (std::size_t n = 0; n < ids.size(); ++n) {
+            rows.insert(rows.end(), flows + n * row_stride, flows + n * row_stride + timestamps.size());
+        }
+        routed_flows.push_back(rows);
+    });
+
+    // the rows of a buffer four steps wide, of which the first two are handed over
+    std::vector<double> flows = {1.0, 2.0, -1.0, -1.0, 3.0, 4.0, -1.0, -1.0};
+    pipeline.submit(nexus_ids, {"t0", "t1"}, flows.data(), 4);
+    flows = {5.0, -1.0, -1.0, -1.0, 6.0, -1.0, -1.0, -1.0};
+    pipeline.submit(nexus_ids, {"t2"}, flows.data(), 4);
+    pipeline.finish();
+
+    ASSERT_EQ(routed_timestamps.size(), 2);
+    EXPECT_EQ(routed_timestamps[0], std::vector<std::string>({"t0", "t1"}));
+    EXPECT_EQ(routed_flows[0], std::vector<double>({1.0, 2.0, 3.0, 4.0}));
+    EXPECT_EQ(routed_timestamps[1], std::vector<std::string>({"t2"}));
+    EXPECT_EQ(routed_flows[1], std::vector<double>({5.0, 6.0}));
+    EXPECT_EQ(pipeline.get_routed_steps(), 3);
+}
+
+//! The next chunk is handed over while one is being routed.
+TEST_F(RoutingPipelineTest, TestSubmitOverlapsRouting)
+{
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::atomic<int> started{0};
+    Routing_Pipeline pipeline([&](const std::vector<std::string>&, const std::vector<std::string>&,
+                                  const double*, std::size_t) {
+        ++started;
+        released.wait();
+    });
+
+    std::vector<double> flows = {1.0, 2.0};
+    pipeline.submit(nexus_ids, {"t0"}, flows.data(), 1);
+    pipeline.submit(nexus_ids, {"t1"}, flows.data(), 1);
+    // both returned with the first chunk still being routed
+    EXPECT_EQ(pipeline.get_routed_steps(), 0);
+    release.set_value();
+    pipeline.finish();
+    EXPECT_EQ(started, 2);
+    EXPECT_EQ(pipeline.get_routed_steps(), 2);
+}
+
+//! A failure to route a chunk is raised by the next call, and no later chunk is routed.
+TEST_F(RoutingPipelineTest, TestFailureStopsRouting)
+{
+    std::atomic<int> calls{0};
+    Routing_Pipeline pipeline([&](const std::vector<std::string>&, const std::vector<std::string>&,
+                                  const double*, std::size_t) {
+        ++calls;
+        throw std::runtime_error("t-route failed");
+    });
+
+    std::vector<double> flows = {1.0, 2.0};
+    pipeline.submit(nexus_ids, {"t0"}, flows.data(), 1);
+    EXPECT_THROW(pipeline.finish(), std::runtime_error);
+    EXPECT_THROW(pipeline.submit(nexus_ids, {"t1"}, flows.data(), 1), std::runtime_error);
+    EXPECT_EQ(calls, 1);
+    EXPECT_EQ(pipeline.get_routed_steps(), 0);
+}
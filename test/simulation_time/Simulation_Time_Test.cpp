@@ -1,5 +1,6 @@
 #include "gtest/gtest.h"
 #include "Simulation_Time.h"
+#include "Timestamp_Generator.h"
 #include <memory>
 #include <vector>
 #include <string>
@@ -71,3 +72,50 @@ TEST_F(SimulationTimeTest, TestSimulationTime)
 }
 
 
+
+///Test extending the end of the simulation, as a warm-started cycle does
+TEST_F(SimulationTimeTest, TestExtendEndTime)
+{
+    simulation_time_params next_cycle_p("2015-12-14 21:00:00", "2015-12-31 05:00:00", 3600);
+
+    EXPECT_EQ(393, Simulation_Time_Object1->extend_end_time(next_cycle_p.end_t));
+
+    EXPECT_EQ(393, Simulation_Time_Object1->get_total_output_times());
+
+    EXPECT_EQ(next_cycle_p.end_t, Simulation_Time_Object1->get_end_time());
+
+    EXPECT_EQ(Simulation_Time_Object1->get_timestamp(392), "2015-12-31 05:00:00");
+
+    EXPECT_THROW(Simulation_Time_Object1->extend_end_time(next_cycle_p.start_t), std::invalid_argument);
+}
+
+///Test stepping timestamps forward matches formatting each time with gmtime, across days, months and leap years
+TEST_F(SimulationTimeTest, TestTimestampGenerator)
+{
+    simulation_time_params leap_p("2015-12-31 21:00:00", "2016-03-01 02:00:00", 3600);
+    std::vector<long> intervals = {1, 900, 3600, 5400, 86400, 7 * 86400};
+
+    for (long interval : intervals) {
+        Timestamp_Generator generator(leap_p.start_t, interval);
+        for (int step = 0; step < 20000; ++step) {
+            time_t t = leap_p.start_t + step * interval;
+            char expected[20];
+            strftime(expected, sizeof(expected), "%Y-%m-%d %T", gmtime(&t));
+            ASSERT_EQ(generator.str(), std::string(expected));
+            ASSERT_EQ(generator.get_epoch_time(), t);
+            generator.advance();
+        }
+    }
+
+    Timestamp_Generator generator(leap_p.start_t, 3600);
+    generator.seek(leap_p.end_t);
+    EXPECT_STREQ(generator.c_str(), "2016-03-01 02:00:00");
+    generator.advance();
+    EXPECT_EQ(generator.str(), "2016-03-01 03:00:00");
+
+    // Before the epoch
+    generator.seek(-1);
+    EXPECT_EQ(generator.str(), "1969-12-31 23:59:59");
+
+    EXPECT_THROW(Timestamp_Generator(leap_p.start_t, 0), std::invalid_argument);
+}
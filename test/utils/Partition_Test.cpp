@@ -109,3 +109,34 @@ TEST_F(PartitionsParserTest, DisplayPartitionData)
   ASSERT_TRUE(true);
   
 }
+
+TEST_F(PartitionsParserTest, BinaryPartitionsMatchJson)
+{
+  const std::string file_path = file_search(data_paths,"simple_partition8.json");
+  Partitions_Parser json_parser = Partitions_Parser(file_path);
+  json_parser.parse_partition_file();
+
+  std::vector<std::unordered_set<std::string>> catchment_part, nexus_part;
+  std::vector<std::vector<Tuple>> remote_connections;
+  for (const PartitionData& part : json_parser.partition_ranks) {
+    catchment_part.push_back(part.catchment_ids);
+    nexus_part.push_back(part.nexus_ids);
+    remote_connections.push_back(part.remote_connections);
+  }
+  const std::string binary_path = testing::TempDir() + "simple_partition8.bin";
+  partition_binary::write_partitions(catchment_part, nexus_part, remote_connections, binary_path);
+
+  Partitions_Parser binary_parser = Partitions_Parser(binary_path);
+  ASSERT_EQ(binary_parser.get_num_partitions(), json_parser.get_num_partitions());
+  // Read out of order, as each rank reads just its own
+  for (int i = binary_parser.get_num_partitions() - 1; i >= 0; --i) {
+    PartitionData part = binary_parser.parse_partition(i);
+    const PartitionData& expected = json_parser.partition_ranks[i];
+    EXPECT_EQ(part.mpi_world_rank, expected.mpi_world_rank);
+    EXPECT_EQ(part.catchment_ids, expected.catchment_ids);
+    EXPECT_EQ(part.nexus_ids, expected.nexus_ids);
+    EXPECT_EQ(part.remote_connections, expected.remote_connections);
+  }
+  ASSERT_THROW(binary_parser.parse_partition(binary_parser.get_num_partitions()), std::out_of_range);
+  std::remove(binary_path.c_str());
+}
@@ -0,0 +1,117 @@
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "utilities/BoundedQueue.hpp"
+#include "utilities/AsyncOutputWriter.hpp"
+
+class AsyncOutputWriterTest : public ::testing::Test {
+
+    protected:
+
+    AsyncOutputWriterTest() {
+
+    }
+
+    ~AsyncOutputWriterTest() override {
+
+    }
+
+    struct Row {
+        int producer = 0;
+        int step = 0;
+        std::string text;
+    };
+
+};
+
+//! Test that the queue is FIFO, and refuses pushes when it is full.
+TEST_F(AsyncOutputWriterTest, TestQueueCapacity) {
+    utils::BoundedQueue<std::string> queue(3);
+    ASSERT_EQ(queue.capacity(), 4);
+
+    for (int i = 0; i < 4; ++i) {
+        std::string value = std::to_string(i);
+        ASSERT_TRUE(queue.try_push(value));
+    }
+    std::string extra = "extra";
+    ASSERT_FALSE(queue.try_push(extra));
+    ASSERT_EQ(extra, "extra");
+
+    std::string value;
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(queue.try_pop(value));
+        ASSERT_EQ(value, std::to_string(i));
+    }
+    ASSERT_FALSE(queue.try_pop(value));
+}
+
+//! Test that every row is written, and the rows from each producer stay in order, with a small queue.
+TEST_F(AsyncOutputWriterTest, TestConcurrentProducers) {
+    const int producers = 4;
+    const int steps = 2000;
+    std::vector<std::vector<int>> written(producers);
+    {
+        utils::AsyncOutputWriter<Row> writer(8, [&written](Row& row) {
+            written[row.producer].push_back(row.step);
+        });
+
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; ++p) {
+            threads.emplace_back([&writer, p]() {
+                for (int s = 0; s < steps; ++s) {
+                    Row row;
+                    row.producer = p;
+                    row.step = s;
+                    writer.push(row);
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        writer.flush();
+        for (int p = 0; p < producers; ++p) {
+            ASSERT_EQ(written[p].size(), steps);
+        }
+    }
+    for (int p = 0; p < producers; ++p) {
+        for (int s = 0; s < steps; ++s) {
+            ASSERT_EQ(written[p][s], s);
+        }
+    }
+}
+
+//! Test that destroying the writer writes anything still queued.
+TEST_F(AsyncOutputWriterTest, TestDrainOnDestruction) {
+    std::vector<std::string> written;
+    {
+        utils::AsyncOutputWriter<Row> writer(16, [&written](Row& row) { written.push_back(row.text); });
+        for (int i = 0; i < 10; ++i) {
+            Row row;
+            row.text = "row " + std::to_string(i);
+            writer.push(row);
+        }
+    }
+    ASSERT_EQ(written.size(), 10);
+    ASSERT_EQ(written[9], "row 9");
+}
+
+//! Test that an exception raised while writing is rethrown by flush.
+TEST_F(AsyncOutputWriterTest, TestSinkFailure) {
+    utils::AsyncOutputWriter<Row> writer(4, [](Row& row) {
+        if (row.step == 2) {
+            throw std::runtime_error("disk full");
+        }
+    });
+    for (int i = 0; i < 5; ++i) {
+        Row row;
+        row.step = i;
+        writer.push(row);
+    }
+    ASSERT_THROW(writer.flush(), std::runtime_error);
+}
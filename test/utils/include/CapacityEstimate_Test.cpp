@@ -0,0 +1,103 @@
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "utilities/CapacityEstimate.hpp"
+
+//! Test that a catchment's time and memory are each those of its id, else of its type, else the default ones.
+TEST(CapacityEstimateTest, TestCoefficientLookup) {
+    std::string path = testing::TempDir() + "capacity_estimate_test.csv";
+    {
+        std::ofstream file(path);
+        file << "# catchment id, average seconds per output time step\n"
+             << "cat-1,0.5\n"
+             << "\n"
+             << "  bmi_c , 0.01, 2\n"
+             << "default,0.001,1\n";
+    }
+    utils::CapacityEstimate estimate;
+    estimate.read_coefficients(path);
+    std::remove(path.c_str());
+
+    estimate.add_catchment("cat-1", "bmi_c");
+    estimate.add_catchment("cat-2", "bmi_c");
+    estimate.add_catchment("cat-3", "bmi_fortran");
+    EXPECT_EQ(estimate.get_catchment_count(), 3);
+    EXPECT_EQ(estimate.get_defaulted_catchment_count(), 1);
+    EXPECT_DOUBLE_EQ(estimate.get_total_seconds_per_step(), 0.511);
+    EXPECT_DOUBLE_EQ(estimate.get_max_catchment_seconds_per_step(), 0.5);
+
+    auto bytes = estimate.get_formulation_bytes();
+    ASSERT_EQ(bytes.size(), 2);
+    EXPECT_EQ(bytes[0].first, "bmi_c");
+    EXPECT_DOUBLE_EQ(bytes[0].second, 4.0 * 1024 * 1024);
+    EXPECT_EQ(bytes[1].first, "bmi_fortran");
+    EXPECT_DOUBLE_EQ(bytes[1].second, 1.0 * 1024 * 1024);
+
+    EXPECT_THROW(estimate.read_coefficients(path), std::runtime_error);
+    {
+        std::ofstream file(path);
+        file << "cat-1,fast\n";
+    }
+    EXPECT_THROW(estimate.read_coefficients(path), std::runtime_error);
+    std::remove(path.c_str());
+}
+
+//! Test that a time step takes the catchments' time split over the threads, but no less than the costliest one's.
+TEST(CapacityEstimateTest, TestSecondsPerStep) {
+    utils::CapacityEstimate estimate;
+    estimate.set_coefficients("default", {0.1, 0.0});
+    estimate.set_coefficients("cat-big", {0.4, 0.0});
+    for (int i = 0; i < 8; ++i) {
+        estimate.add_catchment("cat-" + std::to_string(i), "bmi_c");
+    }
+    EXPECT_DOUBLE_EQ(estimate.get_seconds_per_step(1), 0.8);
+    EXPECT_DOUBLE_EQ(estimate.get_seconds_per_step(4), 0.2);
+    estimate.add_catchment("cat-big", "bmi_c");
+    EXPECT_DOUBLE_EQ(estimate.get_seconds_per_step(1), 1.2);
+    EXPECT_DOUBLE_EQ(estimate.get_seconds_per_step(8), 0.4);
+}
+
+//! Test that boundary flows count per remote connection, with a block per neighboring process.
+TEST(CapacityEstimateTest, TestBoundaryBytes) {
+    utils::CapacityEstimate estimate;
+    EXPECT_DOUBLE_EQ(estimate.get_boundary_bytes_per_step(), 0.0);
+    estimate.add_remote_connection(1);
+    estimate.add_remote_connection(1);
+    estimate.add_remote_connection(3);
+    EXPECT_EQ(estimate.get_neighbor_count(), 2);
+    EXPECT_DOUBLE_EQ(estimate.get_boundary_bytes_per_step(),
+                     3 * utils::CapacityEstimate::BYTES_PER_REMOTE_FLOW + 2 * utils::CapacityEstimate::BYTES_PER_NEIGHBOR);
+}
+
+//! Test that the recommendation gives the run time, memory with headroom, and flags imbalanced ranks.
+TEST(CapacityEstimateTest, TestRecommendation) {
+    utils::CapacityEstimate::Totals totals;
+    totals.processes = 4;
+    totals.threads = 2;
+    totals.time_steps = 7200;
+    totals.max_seconds_per_step = 1.0;
+    totals.total_seconds_per_step = 2.0;
+    totals.serial_seconds_per_step = 4.0;
+    totals.max_catchment_seconds_per_step = 0.25;
+    totals.max_bytes = 1000.0 * 1024 * 1024;
+    totals.max_boundary_bytes_per_step = 2048.0;
+    totals.total_boundary_bytes_per_step = 4096.0;
+    std::ostringstream out;
+    utils::CapacityEstimate::write_recommendation(out, totals);
+    std::string text = out.str();
+    EXPECT_NE(text.find("4 ranks of 2 catchment threads over 7200 output time steps"), std::string::npos) << text;
+    EXPECT_NE(text.find("2.00 h of compute"), std::string::npos) << text;
+    EXPECT_NE(text.find("2.00 KB on the busiest rank"), std::string::npos) << text;
+    EXPECT_NE(text.find("request at least 1250 MB per rank"), std::string::npos) << text;
+    EXPECT_NE(text.find("up to 8 before"), std::string::npos) << text;
+    EXPECT_NE(text.find("repartition"), std::string::npos) << text;
+
+    totals.max_seconds_per_step = 0.5;
+    std::ostringstream balanced;
+    utils::CapacityEstimate::write_recommendation(balanced, totals);
+    EXPECT_EQ(balanced.str().find("repartition"), std::string::npos) << balanced.str();
+}
@@ -0,0 +1,156 @@
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "utilities/Checkpoint.hpp"
+
+using utils::CheckpointFile;
+using utils::CheckpointWriter;
+using utils::StateReader;
+using utils::StateWriter;
+
+class CheckpointTest : public ::testing::Test {
+
+    protected:
+
+    void TearDown() override {
+        std::remove(path.c_str());
+        std::remove((path + ".tmp").c_str());
+        std::remove(CheckpointFile::journal_path(path).c_str());
+    }
+
+    std::string path = "checkpoint_test.ckpt";
+};
+
+TEST_F(CheckpointTest, reads_back_written_values) {
+    StateWriter out;
+    out.write<int>(42);
+    out.write(std::string("storage"));
+    out.write(std::vector<double>{1.5, 2.5, 3.5});
+    out.write<double>(0.25);
+
+    StateReader in(out.get_bytes());
+    EXPECT_EQ(in.read<int>(), 42);
+    EXPECT_EQ(in.read_string(), "storage");
+    EXPECT_EQ(in.read_vector<double>(), (std::vector<double>{1.5, 2.5, 3.5}));
+    EXPECT_EQ(in.read<double>(), 0.25);
+    EXPECT_TRUE(in.at_end());
+}
+
+TEST_F(CheckpointTest, throws_reading_past_end) {
+    StateWriter out;
+    out.write<int>(1);
+
+    StateReader in(out.get_bytes());
+    EXPECT_THROW(in.read<double>(), std::runtime_error);
+}
+
+TEST_F(CheckpointTest, throws_on_truncated_vector) {
+    StateWriter out;
+    out.write(std::vector<double>{1.0, 2.0});
+    std::vector<char> bytes = out.get_bytes();
+    bytes.resize(bytes.size() - 1);
+
+    StateReader in(bytes);
+    EXPECT_THROW(in.read_vector<double>(), std::runtime_error);
+}
+
+TEST_F(CheckpointTest, reads_back_written_file) {
+    CheckpointFile::states_t states;
+    states["cat-1"] = {'a', 'b'};
+    states["cat-2"] = {};
+    CheckpointFile::write(path, 24, states);
+
+    CheckpointFile::states_t read_states;
+    EXPECT_EQ(CheckpointFile::read(path, read_states), 24);
+    EXPECT_EQ(read_states, states);
+}
+
+TEST_F(CheckpointTest, rejects_other_files) {
+    {
+        std::ofstream file(path);
+        file << "cat-1,0.5\n";
+    }
+    CheckpointFile::states_t states;
+    EXPECT_THROW(CheckpointFile::read(path, states), std::runtime_error);
+}
+
+TEST_F(CheckpointTest, appends_rank_to_path) {
+    EXPECT_EQ(CheckpointFile::rank_path("run.ckpt", 0, 1), "run.ckpt");
+    EXPECT_EQ(CheckpointFile::rank_path("run.ckpt", 3, 4), "run.ckpt.3");
+}
+
+TEST_F(CheckpointTest, writes_in_background) {
+    CheckpointWriter writer(path, false);
+    CheckpointFile::states_t states;
+    states["cat-1"] = {'a', 'b'};
+    writer.write(12, states);
+    EXPECT_TRUE(states.empty());
+    writer.wait();
+
+    CheckpointFile::states_t read_states;
+    EXPECT_EQ(CheckpointFile::read(path, read_states), 12);
+    EXPECT_EQ(read_states.at("cat-1"), (std::vector<char>{'a', 'b'}));
+}
+
+TEST_F(CheckpointTest, appends_changed_states_incrementally) {
+    CheckpointWriter writer(path, true);
+    CheckpointFile::states_t states;
+    states["cat-1"] = std::vector<char>(64, 'a');
+    states["cat-2"] = std::vector<char>(64, 'b');
+    writer.write(10, states);
+    writer.wait();
+
+    states["cat-1"] = std::vector<char>(64, 'a');
+    states["cat-2"] = std::vector<char>(64, 'c');
+    writer.write(20, states);
+    writer.wait();
+    // Only the changed state was added, to the journal
+    std::ifstream journal(CheckpointFile::journal_path(path), std::ios::binary | std::ios::ate);
+    ASSERT_TRUE(journal.good());
+    EXPECT_LT(journal.tellg(), 150);
+    journal.close();
+
+    CheckpointFile::states_t read_states;
+    EXPECT_EQ(CheckpointFile::read(path, read_states), 20);
+    EXPECT_EQ(read_states.at("cat-1"), std::vector<char>(64, 'a'));
+    EXPECT_EQ(read_states.at("cat-2"), std::vector<char>(64, 'c'));
+
+    // Once the journal would outgrow the checkpoint, it is written in full again
+    states["cat-1"] = std::vector<char>(64, 'd');
+    states["cat-2"] = std::vector<char>(64, 'e');
+    writer.write(30, states);
+    writer.wait();
+    EXPECT_FALSE(std::ifstream(CheckpointFile::journal_path(path)).good());
+    EXPECT_EQ(CheckpointFile::read(path, read_states), 30);
+    EXPECT_EQ(read_states.at("cat-1"), std::vector<char>(64, 'd'));
+}
+
+TEST_F(CheckpointTest, ignores_interrupted_journal_record) {
+    CheckpointFile::states_t states;
+    states["cat-1"] = {'a'};
+    CheckpointFile::write(path, 5, states);
+    CheckpointFile::append(path, 5, 6, {{"cat-1", {'b'}}});
+    size_t size = CheckpointFile::append(path, 5, 7, {{"cat-1", {'c'}}});
+    {
+        std::ifstream journal(CheckpointFile::journal_path(path), std::ios::binary);
+        std::vector<char> bytes((std::istreambuf_iterator<char>(journal)), std::istreambuf_iterator<char>());
+        ASSERT_EQ(bytes.size(), size);
+        bytes.resize(size - 1);
+        std::ofstream(CheckpointFile::journal_path(path), std::ios::binary | std::ios::trunc).write(bytes.data(), bytes.size());
+    }
+    CheckpointFile::states_t read_states;
+    EXPECT_EQ(CheckpointFile::read(path, read_states), 6);
+    EXPECT_EQ(read_states.at("cat-1"), std::vector<char>{'b'});
+
+    // A journal of an earlier checkpoint than the file is not applied
+    CheckpointFile::write(path, 9, states);
+    CheckpointFile::append(path, 5, 10, {{"cat-1", {'d'}}});
+    EXPECT_EQ(CheckpointFile::read(path, read_states), 9);
+    EXPECT_EQ(read_states.at("cat-1"), std::vector<char>{'a'});
+}
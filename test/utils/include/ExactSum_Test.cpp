@@ -0,0 +1,62 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "utilities/ExactSum.hpp"
+
+//! Test that sums are exact until rounded once, to the nearest double.
+TEST(ExactSumTest, TestExact) {
+    utils::ExactSum sum;
+    EXPECT_EQ(sum.get_sum(), 0.0);
+    for (int i = 0; i < 10; ++i) {
+        sum.add(0.1);
+    }
+    EXPECT_EQ(sum.get_sum(), 1.0);
+
+    sum.clear();
+    sum.add(1e100);
+    sum.add(1.0);
+    sum.add(-1e100);
+    EXPECT_EQ(sum.get_sum(), 1.0);
+
+    // Exactly halfway between two doubles, broken towards the rest of the sum
+    sum.clear();
+    sum.add(1.0);
+    sum.add(std::ldexp(1.0, -53));
+    sum.add(std::ldexp(1.0, -106));
+    EXPECT_EQ(sum.get_sum(), 1.0 + std::ldexp(1.0, -52));
+
+    sum.clear();
+    sum.add(1.0);
+    sum.add(std::numeric_limits<double>::infinity());
+    EXPECT_EQ(sum.get_sum(), std::numeric_limits<double>::infinity());
+    sum.clear();
+    sum.add(2.5);
+    EXPECT_EQ(sum.get_sum(), 2.5);
+}
+
+//! Test that the sum does not depend on the order values are added in.
+TEST(ExactSumTest, TestOrderIndependent) {
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> exponents(-20.0, 20.0);
+    std::vector<double> values;
+    for (int i = 0; i < 1000; ++i) {
+        values.push_back((i % 2 == 0 ? 1.0 : -1.0) * std::pow(10.0, exponents(generator)));
+    }
+    utils::ExactSum reference;
+    for (double value : values) {
+        reference.add(value);
+    }
+    for (int shuffle = 0; shuffle < 10; ++shuffle) {
+        std::shuffle(values.begin(), values.end(), generator);
+        utils::ExactSum sum;
+        for (double value : values) {
+            sum.add(value);
+        }
+        ASSERT_EQ(sum.get_sum(), reference.get_sum());
+    }
+}
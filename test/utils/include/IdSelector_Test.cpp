@@ -0,0 +1,53 @@
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "utilities/IdSelector.hpp"
+
+//! Test that an empty selection selects every id.
+TEST(IdSelectorTest, TestEmptySelectsAll) {
+    utils::IdSelector selector;
+    EXPECT_TRUE(selector.is_all());
+    EXPECT_TRUE(selector.matches("cat-27"));
+    EXPECT_TRUE(utils::IdSelector(std::vector<std::string>()).matches("nex-26"));
+}
+
+//! Test that exact ids and wildcard patterns select only the ids they match.
+TEST(IdSelectorTest, TestIdsAndPatterns) {
+    utils::IdSelector selector({"nex-26", "nex-3?", "wb-*", "cat-[12]"});
+    EXPECT_FALSE(selector.is_all());
+    EXPECT_TRUE(selector.matches("nex-26"));
+    EXPECT_FALSE(selector.matches("nex-2"));
+    EXPECT_FALSE(selector.matches("nex-260"));
+    EXPECT_TRUE(selector.matches("nex-31"));
+    EXPECT_FALSE(selector.matches("nex-311"));
+    EXPECT_TRUE(selector.matches("wb-"));
+    EXPECT_TRUE(selector.matches("wb-1234"));
+    EXPECT_TRUE(selector.matches("cat-2"));
+    EXPECT_FALSE(selector.matches("cat-3"));
+}
+
+//! Test that selection files are read a trimmed entry per line, skipping blank lines and comments.
+TEST(IdSelectorTest, TestReadEntries) {
+    std::string path = testing::TempDir() + "id_selector_test.txt";
+    {
+        std::ofstream file(path);
+        file << "# Gauged nexuses\n"
+             << "nex-26\n"
+             << "\n"
+             << "  nex-3*\t\r\n"
+             << "   # indented comment\n"
+             << "nex-41";
+    }
+    std::vector<std::string> entries = utils::IdSelector::read_entries(path);
+    std::remove(path.c_str());
+    ASSERT_EQ(entries.size(), 3);
+    EXPECT_EQ(entries[0], "nex-26");
+    EXPECT_EQ(entries[1], "nex-3*");
+    EXPECT_EQ(entries[2], "nex-41");
+
+    EXPECT_THROW(utils::IdSelector::read_entries(path), std::runtime_error);
+}
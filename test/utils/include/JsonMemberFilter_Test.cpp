@@ -0,0 +1,60 @@
+#include <sstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "utilities/JsonMemberFilter.hpp"
+
+using utils::JsonMemberFilter;
+
+class JsonMemberFilterTest : public ::testing::Test {
+
+    protected:
+
+    JsonMemberFilterTest() : filter("catchments", [](const std::string& id) { return id == "cat-1" || id == "cat-3"; }) {
+
+    }
+
+    //! Filter the given text, asserting that it could be filtered.
+    std::string filtered(const std::string& text) {
+        std::stringstream in(text);
+        std::string out;
+        EXPECT_TRUE(filter.filter(in, out));
+        return out;
+    }
+
+    JsonMemberFilter filter;
+};
+
+TEST_F(JsonMemberFilterTest, keeps_wanted_members) {
+    std::string text = "{\"time\": {\"start\": 1}, \"catchments\": {"
+                       "\"cat-1\": {\"a\": [1, {\"b\": \"}\"}]}, "
+                       "\"cat-2\": {\"a\": \"x\\\"}\"}, "
+                       "\"cat-3\": 2.5"
+                       "}, \"output\": \"cat-2\"}";
+    ASSERT_EQ(filtered(text), "{\"time\": {\"start\": 1}, \"catchments\": {"
+                              "\"cat-1\": {\"a\": [1, {\"b\": \"}\"}]},"
+                              "\"cat-3\": 2.5"
+                              "}, \"output\": \"cat-2\"}");
+}
+
+TEST_F(JsonMemberFilterTest, drops_all_members) {
+    ASSERT_EQ(filtered("{ \"catchments\" : { \"cat-2\": {} } }"), "{ \"catchments\" : {} }");
+}
+
+TEST_F(JsonMemberFilterTest, copies_without_filtered_object) {
+    std::string text = "{\n  \"global\": {\"catchments\": {\"cat-2\": null}},\n  \"flag\": true\n}";
+    ASSERT_EQ(filtered(text), text);
+}
+
+TEST_F(JsonMemberFilterTest, rejects_non_object) {
+    std::stringstream in("[1, 2]");
+    std::string out;
+    ASSERT_FALSE(filter.filter(in, out));
+}
+
+TEST_F(JsonMemberFilterTest, rejects_truncated_object) {
+    std::stringstream in("{\"catchments\": {\"cat-1\": {\"a\": 1}");
+    std::string out;
+    ASSERT_FALSE(filter.filter(in, out));
+}
@@ -0,0 +1,105 @@
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "utilities/Logger.hpp"
+
+class LoggerTest : public ::testing::Test {
+
+    protected:
+
+    void SetUp() override {
+        // Write out what earlier tests logged, and forget their counts, so no test depends on those before it
+        utils::Logger::flush();
+        utils::Logger::reset_counts();
+        utils::Logger::set_sink([this](utils::LogLevel level, const std::string& message) {
+            std::lock_guard<std::mutex> lock(mutex);
+            messages.push_back(utils::Logger::get_prefix(level) + message);
+        });
+        utils::Logger::set_level(utils::LOG_LEVEL_INFO);
+        utils::Logger::set_site_limit(3);
+    }
+
+    void TearDown() override {
+        utils::Logger::flush();
+        utils::Logger::set_sink(nullptr);
+        utils::Logger::set_site_limit(10);
+    }
+
+    /** The messages written so far, after waiting for those logged. */
+    std::vector<std::string> written() {
+        utils::Logger::flush();
+        std::lock_guard<std::mutex> lock(mutex);
+        return messages;
+    }
+
+    std::mutex mutex;
+    std::vector<std::string> messages;
+
+};
+
+//! Test that messages are written in order with their level, and that less severe levels than set are left out.
+TEST_F(LoggerTest, TestLevels) {
+    NGEN_LOG_WARNING("value " << 1.5);
+    NGEN_LOG_DEBUG("not written");
+    NGEN_LOG_ERROR("failed");
+    utils::Logger::set_level(utils::LOG_LEVEL_ERROR);
+    NGEN_LOG_INFO("not written either");
+
+    std::vector<std::string> lines = written();
+    ASSERT_EQ(lines.size(), 2);
+    EXPECT_EQ(lines[0], "WARN: value 1.5");
+    EXPECT_EQ(lines[1], "ERROR: failed");
+    EXPECT_FALSE(utils::Logger::is_enabled(utils::LOG_LEVEL_WARNING));
+}
+
+//! Test that a call site repeated beyond its limit is left out, without its message being formatted, and reported.
+TEST_F(LoggerTest, TestSiteLimit) {
+    int formatted = 0;
+    auto format = [&formatted](int i) { ++formatted; return i; };
+    for (int i = 0; i < 10; ++i) {
+        NGEN_LOG_WARNING("repeated " << format(i));
+    }
+    EXPECT_EQ(formatted, 4);
+
+    std::vector<std::string> lines = written();
+    ASSERT_EQ(lines.size(), 5);
+    EXPECT_EQ(lines[0], "WARN: repeated 0");
+    EXPECT_EQ(lines[2], "WARN: repeated 2");
+    EXPECT_EQ(lines[3].find("WARN: repeated 3 (further messages from "), 0);
+    EXPECT_NE(lines[4].find("6 messages from "), std::string::npos);
+
+    // Only what was left out since the last flush is reported
+    NGEN_LOG_WARNING("another");
+    EXPECT_EQ(written().size(), 6);
+}
+
+//! Test that messages of several threads are all written, each thread's in its own order.
+TEST_F(LoggerTest, TestThreads) {
+    utils::Logger::set_site_limit(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([t]() {
+            for (int i = 0; i < 100; ++i) {
+                NGEN_LOG_INFO(t << " " << i);
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    std::vector<std::string> lines = written();
+    ASSERT_EQ(lines.size() + utils::Logger::get_dropped_count(), 400);
+    std::vector<int> last(4, -1);
+    for (const std::string& line : lines) {
+        int t = 0, i = 0;
+        ASSERT_EQ(sscanf(line.c_str(), "INFO: %d %d", &t, &i), 2);
+        EXPECT_GT(i, last[t]);
+        last[t] = i;
+    }
+}
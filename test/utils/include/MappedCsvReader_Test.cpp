@@ -0,0 +1,111 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "utilities/MappedCsvReader.hpp"
+
+using utils::MappedCsvReader;
+
+class MappedCsvReaderTest : public ::testing::Test {
+
+    protected:
+
+    MappedCsvReaderTest() {
+
+    }
+
+    ~MappedCsvReaderTest() override {
+        std::remove(file_name.c_str());
+    }
+
+    //! Write a temporary file with the given contents.
+    void write(const std::string& contents) {
+        std::ofstream out(file_name, std::ios::binary);
+        out << contents;
+    }
+
+    //! Parse a number through a field over a copy of the text, which is not terminated.
+    static double parse(const std::string& text) {
+        std::vector<char> chars(text.begin(), text.end());
+        chars.push_back('9');
+        return MappedCsvReader::parse_double(MappedCsvReader::Field{chars.data(), chars.data() + text.size()});
+    }
+
+    std::string file_name = "mapped_csv_reader_test.csv";
+
+};
+
+//! Test that rows and trimmed fields are read, skipping blank lines and handling CRLF and a missing final newline.
+TEST_F(MappedCsvReaderTest, TestRows) {
+    write("time, a ,b\r\n2015-12-01 00:00:00,1.5,-2\r\n\n2015-12-01 01:00:00,,3e2");
+    MappedCsvReader reader(file_name);
+    std::vector<MappedCsvReader::Field> row;
+
+    ASSERT_TRUE(reader.next_row(row));
+    ASSERT_EQ(row.size(), 3);
+    ASSERT_TRUE(row[0] == "time");
+    ASSERT_EQ(row[1].str(), "a");
+    ASSERT_EQ(row[2].str(), "b");
+
+    ASSERT_TRUE(reader.next_row(row));
+    ASSERT_EQ(MappedCsvReader::parse_double(row[1]), 1.5);
+    ASSERT_EQ(MappedCsvReader::parse_double(row[2]), -2.0);
+
+    ASSERT_TRUE(reader.next_row(row));
+    ASSERT_EQ(row.size(), 3);
+    ASSERT_EQ(row[1].str(), "");
+    ASSERT_EQ(MappedCsvReader::parse_double(row[2]), 300.0);
+
+    ASSERT_FALSE(reader.next_row(row));
+}
+
+//! Test that an empty file has no rows and a missing file is reported.
+TEST_F(MappedCsvReaderTest, TestEmptyAndMissing) {
+    write("");
+    MappedCsvReader reader(file_name);
+    std::vector<MappedCsvReader::Field> row;
+    ASSERT_FALSE(reader.next_row(row));
+
+    ASSERT_THROW(MappedCsvReader("does_not_exist.csv"), std::runtime_error);
+}
+
+//! Test that numbers parse to exactly the value strtod gives, on both the direct and the fallback path.
+TEST_F(MappedCsvReaderTest, TestParseDouble) {
+    for (const std::string text : {"0", "0.0", "-0.30000001192092896", "361.3000183105469", "0.00930000003427267",
+                                   "100310.0", "1e-5", "2.5E+10", ".5", "5.", "+7", "123456789012345678901234",
+                                   "1e300", "4.9e-324", "nan", "inf"}) {
+        double expected = std::strtod(text.c_str(), nullptr);
+        double value = parse(text);
+        if (std::isnan(expected)) {
+            ASSERT_TRUE(std::isnan(value)) << text;
+        } else {
+            ASSERT_EQ(value, expected) << text;
+        }
+    }
+    ASSERT_THROW(parse(""), std::invalid_argument);
+    ASSERT_THROW(parse("-"), std::invalid_argument);
+    ASSERT_THROW(parse("1.5x"), std::invalid_argument);
+}
+
+//! Test that date times parse to the same epoch time as strptime and timegm.
+TEST_F(MappedCsvReaderTest, TestParseDatetime) {
+    for (const std::string text : {"1970-01-01 00:00:00", "2015-12-01 23:59:59", "2000-02-29 12:00:00",
+                                   "2100-03-01 00:00:01", "1969-12-31 23:00:00"}) {
+        struct tm tm_value = tm();
+        strptime(text.c_str(), "%Y-%m-%d %H:%M:%S", &tm_value);
+        time_t epoch_time;
+        ASSERT_TRUE(MappedCsvReader::parse_datetime(MappedCsvReader::Field{text.data(), text.data() + text.size()}, epoch_time)) << text;
+        ASSERT_EQ(epoch_time, timegm(&tm_value)) << text;
+    }
+
+    std::string lenient = "2015-12-1 0:00:00";
+    time_t epoch_time;
+    ASSERT_FALSE(MappedCsvReader::parse_datetime(MappedCsvReader::Field{lenient.data(), lenient.data() + lenient.size()}, epoch_time));
+}
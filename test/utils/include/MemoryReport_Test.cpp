@@ -0,0 +1,70 @@
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "utilities/MemoryReport.hpp"
+
+//! Test that the bytes of a structure are totalled, and structures kept in the order they were first added.
+TEST(MemoryReportTest, TestAdd) {
+    utils::MemoryReport report;
+    report.add("network", 100);
+    report.add("forcing", 20);
+    report.add("network", 50);
+    const utils::MemoryReport::summary_t& summary = report.get_summary();
+    ASSERT_EQ(summary.size(), 2);
+    EXPECT_EQ(summary[0].first, "network");
+    EXPECT_EQ(summary[0].second.total_bytes, 150);
+    EXPECT_EQ(summary[0].second.max_bytes, 150);
+    EXPECT_EQ(summary[1].first, "forcing");
+
+    std::vector<double> values(1000);
+    EXPECT_GE(utils::MemoryReport::bytes_of(values), 1000 * sizeof(double));
+    std::vector<std::string> ids(10, std::string(100, 'x'));
+    EXPECT_GE(utils::MemoryReport::bytes_of(ids), 10 * (sizeof(std::string) + 100));
+    std::unordered_map<int, double> map;
+    for (int i = 0; i < 100; ++i) {
+        map[i] = i;
+    }
+    EXPECT_GE(utils::MemoryReport::bytes_of(map), 100 * sizeof(std::pair<const int, double>));
+}
+
+//! Test that the reports of several processes combine into the smallest, mean and largest of any one.
+TEST(MemoryReportTest, TestMergeProcesses) {
+    utils::MemoryReport first;
+    first.add("network", 1024.0 * 1024.0);
+    first.add("mpi buffers", 3 * 1024.0 * 1024.0);
+    utils::MemoryReport second;
+    second.add("network", 3 * 1024.0 * 1024.0);
+
+    utils::MemoryReport::summary_t summary;
+    utils::MemoryReport::merge_serialized(utils::MemoryReport::serialize(first.get_summary()), summary);
+    utils::MemoryReport::merge_serialized(utils::MemoryReport::serialize(second.get_summary()), summary);
+    ASSERT_EQ(summary.size(), 2);
+    EXPECT_EQ(summary[0].second.processes, 2);
+    EXPECT_EQ(summary[0].second.min_bytes, 1024.0 * 1024.0);
+    EXPECT_EQ(summary[0].second.max_bytes, 3 * 1024.0 * 1024.0);
+    EXPECT_EQ(summary[1].second.processes, 1);
+
+    std::ostringstream out;
+    utils::MemoryReport::write_summary(out, summary, 2);
+    std::istringstream lines(out.str());
+    std::string line;
+    std::getline(lines, line);
+    EXPECT_NE(line.find("Mean (MB)"), std::string::npos);
+    //The network averages 2 MB, and the buffers of the one rank that has them 1.5 MB over both, with none the least
+    std::string name, buffers;
+    double min_mb, mean_mb, max_mb;
+    lines >> name >> min_mb >> mean_mb >> max_mb;
+    EXPECT_EQ(name, "network");
+    EXPECT_DOUBLE_EQ(min_mb, 1.0);
+    EXPECT_DOUBLE_EQ(mean_mb, 2.0);
+    EXPECT_DOUBLE_EQ(max_mb, 3.0);
+    lines >> name >> buffers >> min_mb >> mean_mb >> max_mb;
+    EXPECT_EQ(name + " " + buffers, "mpi buffers");
+    EXPECT_DOUBLE_EQ(min_mb, 0.0);
+    EXPECT_DOUBLE_EQ(mean_mb, 1.5);
+    EXPECT_DOUBLE_EQ(max_mb, 3.0);
+}
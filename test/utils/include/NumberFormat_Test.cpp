@@ -0,0 +1,79 @@
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "utilities/NumberFormat.hpp"
+
+namespace {
+    std::string printf_format(const char* format, int precision, double value)
+    {
+        char buffer[512];
+        std::snprintf(buffer, sizeof(buffer), format, precision, value);
+        return buffer;
+    }
+
+    std::vector<double> sample_values()
+    {
+        std::vector<double> values{0.0, -0.0, 0.5, 1.5, 2.5, -2.5, 0.125, 0.375, 1e-7, 5e-7, 4.9999995e-7, 999999.5,
+                                   9.9999995, 0.000099999995, 123456789.0, 1e15, 1e16, 1e17, 1e22, 1e300, 1e-300,
+                                   5e-324, std::numeric_limits<double>::max(), std::numeric_limits<double>::min(),
+                                   0.1, 0.2, 0.3, 1.0 / 3.0, 2.0 / 3.0, 18446744073709551615.0,
+                                   std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(),
+                                   std::numeric_limits<double>::quiet_NaN()};
+        std::mt19937_64 generator(20);
+        std::uniform_real_distribution<double> exponents(-12.0, 12.0);
+        std::uniform_int_distribution<std::uint64_t> bits;
+        for (int i = 0; i < 20000; ++i) {
+            double value = std::pow(10.0, exponents(generator));
+            values.push_back(i % 2 == 0 ? value : -value);
+        }
+        for (int i = 0; i < 5000; ++i) {
+            std::uint64_t pattern = bits(generator);
+            double value;
+            std::memcpy(&value, &pattern, sizeof(value));
+            values.push_back(value);
+        }
+        return values;
+    }
+}
+
+//! Test that fixed formatting gives the text printf gives, for every precision outputs are written with.
+TEST(NumberFormatTest, TestFixedMatchesPrintf) {
+    for (double value : sample_values()) {
+        for (int precision : {0, 1, 2, 3, 6, 9, 12, 17, 20}) {
+            ASSERT_EQ(utils::number_format::to_fixed(value, precision), printf_format("%.*f", precision, value))
+                << "of " << printf_format("%.*g", 17, value) << " with precision " << precision;
+        }
+    }
+}
+
+//! Test that general formatting gives the text printf gives, for every precision outputs are written with.
+TEST(NumberFormatTest, TestGeneralMatchesPrintf) {
+    for (double value : sample_values()) {
+        for (int precision : {0, 1, 3, 6, 9, 15, 17, 19, 21}) {
+            ASSERT_EQ(utils::number_format::to_general(value, precision), printf_format("%.*g", precision, value))
+                << "of " << printf_format("%.*g", 17, value) << " with precision " << precision;
+        }
+    }
+}
+
+//! Test that the defaults give the text of std::to_string and of a stream's default format.
+TEST(NumberFormatTest, TestDefaults) {
+    for (double value : {0.0, 1.0, -3.25, 1.1e-05, 123456.789, 7.0e12}) {
+        std::ostringstream stream;
+        stream << value;
+        EXPECT_EQ(utils::number_format::to_fixed(value), std::to_string(value));
+        EXPECT_EQ(utils::number_format::to_general(value), stream.str());
+    }
+    std::string line("flow,");
+    utils::number_format::append_fixed(line, 0.125, 2).append(",");
+    EXPECT_EQ(utils::number_format::append_general(line, 1.5e-05), "flow,0.12,1.5e-05");
+}
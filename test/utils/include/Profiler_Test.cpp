@@ -0,0 +1,192 @@
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#include "utilities/Profiler.hpp"
+
+using utils::Profiler;
+using utils::ScopedTimer;
+
+class ProfilerTest : public ::testing::Test {
+
+    protected:
+
+    void TearDown() override {
+        Profiler::disable();
+        std::remove(trace_path.c_str());
+    }
+
+    /** Record an interval of @p ns nanoseconds for @p region on this thread. */
+    static void record_ns(int region, long ns) {
+        Profiler::clock::time_point start = Profiler::clock::now();
+        Profiler::record(region, start, start + std::chrono::nanoseconds(ns));
+    }
+
+    std::string trace_path = "profiler_test_trace.json";
+};
+
+TEST_F(ProfilerTest, interns_region_names) {
+    int first = Profiler::region("profiler_test/interned_a");
+    EXPECT_EQ(first, Profiler::region("profiler_test/interned_a"));
+    EXPECT_NE(first, Profiler::region("profiler_test/interned_b"));
+}
+
+TEST_F(ProfilerTest, times_nothing_while_disabled) {
+    int region = Profiler::region("profiler_test/disabled");
+    {
+        ScopedTimer timer(region);
+    }
+    EXPECT_EQ(Profiler::collect().count("profiler_test/disabled"), 0);
+}
+
+TEST_F(ProfilerTest, times_scopes_while_enabled) {
+    Profiler::enable();
+    for (int i = 0; i < 3; ++i) {
+        NGEN_PROFILE_SCOPE("profiler_test/scoped");
+    }
+    Profiler::summary_t summary = Profiler::collect();
+    ASSERT_EQ(summary.count("profiler_test/scoped"), 1);
+    EXPECT_EQ(summary["profiler_test/scoped"].count, 3);
+}
+
+TEST_F(ProfilerTest, combines_threads) {
+    Profiler::enable();
+    int region = Profiler::region("profiler_test/threads");
+    record_ns(region, 1000);
+    std::thread other([region]() {
+        record_ns(region, 3000);
+        record_ns(region, 2000);
+    });
+    other.join();
+
+    Profiler::RegionStats stats = Profiler::collect()["profiler_test/threads"];
+    EXPECT_EQ(stats.count, 3);
+    EXPECT_EQ(stats.total_ns, 6000);
+    EXPECT_EQ(stats.min_ns, 1000);
+    EXPECT_EQ(stats.max_ns, 3000);
+    EXPECT_EQ(stats.max_process_total_ns, 6000);
+}
+
+TEST_F(ProfilerTest, combines_serialized_processes) {
+    Profiler::summary_t first;
+    first["region"].add(4000);
+    first["region"].max_process_total_ns = 4000;
+    Profiler::summary_t second;
+    second["region"].add(1000);
+    second["region"].add(2000);
+    second["region"].max_process_total_ns = 3000;
+
+    Profiler::summary_t combined;
+    Profiler::merge_serialized(Profiler::serialize(first), combined);
+    Profiler::merge_serialized(Profiler::serialize(second), combined);
+    const Profiler::RegionStats& stats = combined["region"];
+    EXPECT_EQ(stats.count, 3);
+    EXPECT_EQ(stats.total_ns, 7000);
+    EXPECT_EQ(stats.min_ns, 1000);
+    EXPECT_EQ(stats.max_ns, 4000);
+    EXPECT_EQ(stats.max_process_total_ns, 4000);
+}
+
+TEST_F(ProfilerTest, writes_summary_by_total_time) {
+    Profiler::summary_t summary;
+    summary["short"].add(1000);
+    summary["long"].add(5000);
+    std::ostringstream out;
+    Profiler::write_summary(out, summary);
+    std::string table = out.str();
+    ASSERT_NE(table.find("long"), std::string::npos);
+    ASSERT_NE(table.find("short"), std::string::npos);
+    EXPECT_LT(table.find("long"), table.find("short"));
+}
+
+TEST_F(ProfilerTest, writes_summary_json) {
+    Profiler::summary_t summary;
+    summary["region"].add(1000);
+    summary["region"].add(3000);
+    summary["region"].max_process_total_ns = 3000;
+    summary["counted"];
+    std::ostringstream out;
+    Profiler::write_summary_json(out, summary, 2);
+    std::string text = out.str();
+    EXPECT_EQ(text.find("{\"processes\":2,\"regions\":["), 0);
+    EXPECT_NE(text.find("{\"name\":\"region\",\"calls\":2,\"total_seconds\":4e-06,\"mean_us\":2,\"min_us\":1,"
+                        "\"max_us\":3,\"rank_mean_seconds\":2e-06,\"max_rank_seconds\":3e-06}"), std::string::npos);
+    EXPECT_NE(text.find("{\"name\":\"counted\",\"calls\":0,\"total_seconds\":0,\"mean_us\":0,\"min_us\":0,"), std::string::npos);
+}
+
+TEST_F(ProfilerTest, combines_and_writes_hardware_counters) {
+    utils::HardwareCounters::Values counters{};
+    counters.counts[utils::HardwareCounters::CYCLES] = 4000;
+    counters.counts[utils::HardwareCounters::INSTRUCTIONS] = 8000;
+    counters.counts[utils::HardwareCounters::CACHE_REFERENCES] = 100;
+    counters.counts[utils::HardwareCounters::CACHE_MISSES] = 25;
+    counters.counts[utils::HardwareCounters::BRANCH_MISSES] = 16;
+    Profiler::summary_t first;
+    first["region"].add(4000);
+    first["region"].add_counters(counters);
+    first["uncounted"].add(1000);
+
+    Profiler::summary_t combined;
+    Profiler::merge_serialized(Profiler::serialize(first), combined);
+    Profiler::merge_serialized(Profiler::serialize(first), combined);
+    EXPECT_EQ(combined["region"].counters.counts[utils::HardwareCounters::CYCLES], 8000);
+    EXPECT_EQ(combined["region"].counters.counts[utils::HardwareCounters::BRANCH_MISSES], 32);
+    EXPECT_FALSE(combined["uncounted"].has_counters());
+
+    std::ostringstream table;
+    Profiler::write_summary(table, combined);
+    // IPC, cache miss share, and cache and branch misses per thousand instructions
+    EXPECT_NE(table.str().find("IPC"), std::string::npos);
+    EXPECT_NE(table.str().find("2.000          25.000             3.125               2.000"), std::string::npos);
+
+    std::ostringstream json;
+    Profiler::write_summary_json(json, combined);
+    EXPECT_NE(json.str().find(",\"counters\":{\"cycles\":8000,\"instructions\":16000,\"cache_references\":200,"
+                              "\"cache_misses\":50,\"branch_misses\":32}}"), std::string::npos);
+    EXPECT_EQ(json.str().find("\"name\":\"uncounted\",\"calls\":2,\"total_seconds\":2e-06,\"mean_us\":1,\"min_us\":1,"
+                              "\"max_us\":1,\"rank_mean_seconds\":2e-06,\"max_rank_seconds\":2e-06,\"counters\""),
+              std::string::npos);
+}
+
+TEST_F(ProfilerTest, counts_hardware_events_where_available) {
+    Profiler::enable();
+    if (!Profiler::enable_counters()) {
+        // Without counters, intervals are still timed
+        EXPECT_FALSE(Profiler::is_counting());
+        {
+            NGEN_PROFILE_SCOPE("profiler_test/uncounted");
+        }
+        Profiler::summary_t summary = Profiler::collect();
+        EXPECT_EQ(summary["profiler_test/uncounted"].count, 1);
+        EXPECT_FALSE(summary["profiler_test/uncounted"].has_counters());
+        GTEST_SKIP();
+    }
+    volatile double sum = 0.0;
+    {
+        NGEN_PROFILE_SCOPE("profiler_test/counted");
+        for (int i = 0; i < 100000; ++i) {
+            sum = sum + i;
+        }
+    }
+    Profiler::summary_t summary = Profiler::collect();
+    EXPECT_TRUE(summary["profiler_test/counted"].has_counters());
+    EXPECT_GT(summary["profiler_test/counted"].counters.counts[utils::HardwareCounters::INSTRUCTIONS], 100000);
+}
+
+TEST_F(ProfilerTest, writes_trace_events) {
+    Profiler::enable(true);
+    record_ns(Profiler::region("profiler_test/traced"), 2000);
+    ASSERT_TRUE(Profiler::write_trace(trace_path, 3));
+
+    std::ifstream in(trace_path);
+    std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(text.find("{\"traceEvents\":["), 0);
+    EXPECT_NE(text.find("{\"name\":\"profiler_test/traced\",\"ph\":\"X\",\"pid\":3,"), std::string::npos);
+    EXPECT_NE(text.find("\"dur\":2.000}"), std::string::npos);
+}
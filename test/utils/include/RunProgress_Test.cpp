@@ -0,0 +1,70 @@
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "utilities/RunProgress.hpp"
+
+//! Test that samples attribute the time of each lap to its phase, and start the interval of the next sample.
+TEST(RunProgressTest, TestSample) {
+    utils::RunProgress progress(10, 20);
+    EXPECT_FALSE(progress.is_report_due(20));
+    EXPECT_TRUE(progress.is_report_due(29));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    progress.lap(utils::RunProgress::COMPUTE);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    progress.lap(utils::RunProgress::OUTPUT);
+
+    std::vector<double> sample = progress.sample(30);
+    ASSERT_EQ(sample.size(), static_cast<std::size_t>(utils::RunProgress::SAMPLE_SIZE));
+    EXPECT_EQ(sample[utils::RunProgress::COMPLETED_STEPS], 30);
+    EXPECT_EQ(sample[utils::RunProgress::INTERVAL_STEPS], 10);
+    EXPECT_GE(sample[utils::RunProgress::INTERVAL_COMPUTE], 0.02);
+    EXPECT_EQ(sample[utils::RunProgress::INTERVAL_COMMUNICATION], 0.0);
+    EXPECT_GE(sample[utils::RunProgress::INTERVAL_OUTPUT], 0.01);
+    EXPECT_GE(sample[utils::RunProgress::INTERVAL_SECONDS],
+              sample[utils::RunProgress::INTERVAL_COMPUTE] + sample[utils::RunProgress::INTERVAL_OUTPUT]);
+
+    progress.lap(utils::RunProgress::COMMUNICATION);
+    std::vector<double> next = progress.sample(40);
+    EXPECT_EQ(next[utils::RunProgress::INTERVAL_STEPS], 10);
+    EXPECT_LT(next[utils::RunProgress::INTERVAL_COMPUTE], 1e-9);
+    EXPECT_EQ(next[utils::RunProgress::TOTAL_COMPUTE], sample[utils::RunProgress::TOTAL_COMPUTE]);
+    EXPECT_GE(next[utils::RunProgress::TOTAL_SECONDS], sample[utils::RunProgress::TOTAL_SECONDS]);
+}
+
+//! Test the report and metrics of gathered samples, with the slowest ranks those that computed longest.
+TEST(RunProgressTest, TestReport) {
+    const int size = utils::RunProgress::SAMPLE_SIZE;
+    std::vector<double> samples(2 * size, 0.0);
+    for (int r = 0; r < 2; ++r) {
+        double* sample = samples.data() + r * size;
+        sample[utils::RunProgress::COMPLETED_STEPS] = 100;
+        sample[utils::RunProgress::INTERVAL_STEPS] = 100;
+        sample[utils::RunProgress::INTERVAL_SECONDS] = 10;
+        sample[utils::RunProgress::INTERVAL_COMPUTE] = r == 0 ? 4 : 8;
+        sample[utils::RunProgress::INTERVAL_COMMUNICATION] = r == 0 ? 5 : 1;
+        sample[utils::RunProgress::INTERVAL_OUTPUT] = 1;
+        sample[utils::RunProgress::TOTAL_COMPUTE] = r == 0 ? 4 : 8;
+    }
+    std::string report = utils::RunProgress::format_report(samples, 2, 400);
+    EXPECT_EQ(report, "Completed 100 of 400 timesteps (25.0%): 10.0 steps/s, ETA 30s; compute 60%, communication 30%, "
+                      "output 10%; slowest ranks 1 (1.33x mean compute), 0 (0.67x mean compute)");
+
+    std::string path = "RunProgress_Test.prom";
+    ASSERT_TRUE(utils::RunProgress::write_metrics(path, samples, 2, 400));
+    std::ifstream file(path);
+    std::stringstream text;
+    text << file.rdbuf();
+    EXPECT_NE(text.str().find("ngen_time_steps_completed 100\n"), std::string::npos);
+    EXPECT_NE(text.str().find("ngen_eta_seconds 30\n"), std::string::npos);
+    EXPECT_NE(text.str().find("ngen_phase_seconds_total{rank=\"1\",phase=\"compute\"} 8\n"), std::string::npos);
+    std::remove(path.c_str());
+
+    EXPECT_EQ(utils::RunProgress::format_duration(3725.2), "1h02m05s");
+    EXPECT_EQ(utils::RunProgress::format_duration(61), "1m01s");
+}
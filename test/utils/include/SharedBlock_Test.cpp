@@ -0,0 +1,70 @@
+#include <map>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "JSONProperty.hpp"
+#include "utilities/SharedBlock.hpp"
+
+//! Test that equal blocks share one copy, while unequal ones don't.
+TEST(SharedBlockTest, TestInterning) {
+    typedef utils::SharedBlock<std::map<std::string, std::string>> names_block;
+    names_block first(std::map<std::string, std::string>{{"Q_OUT", "streamflow"}, {"ET", "evapotranspiration"}});
+    names_block second(std::map<std::string, std::string>{{"ET", "evapotranspiration"}, {"Q_OUT", "streamflow"}});
+    names_block other(std::map<std::string, std::string>{{"Q_OUT", "runoff"}});
+    EXPECT_TRUE(first.shares_with(second));
+    EXPECT_FALSE(first.shares_with(other));
+    EXPECT_EQ(first->at("Q_OUT"), "streamflow");
+    EXPECT_EQ(&first->at("Q_OUT"), &second->at("Q_OUT"));
+    EXPECT_TRUE(names_block().shares_with(names_block()));
+}
+
+//! Test that modifying a block changes only a copy of it, leaving its other holders as they were.
+TEST(SharedBlockTest, TestCopyOnWrite) {
+    typedef utils::SharedBlock<std::vector<std::string>> names_block;
+    names_block first(std::vector<std::string>{"Q_OUT"});
+    names_block second = first;
+    second.modify([](std::vector<std::string> &names) { names.push_back("ET"); });
+    ASSERT_EQ(first->size(), 1);
+    ASSERT_EQ(second->size(), 2);
+    EXPECT_FALSE(first.shares_with(second));
+
+    // Changed back, it is the first's again
+    second.modify([](std::vector<std::string> &names) { names.pop_back(); });
+    EXPECT_TRUE(first.shares_with(second));
+}
+
+//! Test that a block is freed once nothing references it.
+TEST(SharedBlockTest, TestExpiry) {
+    typedef utils::SharedBlock<std::vector<std::string>> names_block;
+    std::size_t before = names_block::size();
+    {
+        names_block block(std::vector<std::string>{"shared_block_test_expiry"});
+        names_block copy(std::vector<std::string>{"shared_block_test_expiry"});
+        EXPECT_EQ(names_block::size(), before + 1);
+    }
+    EXPECT_EQ(names_block::size(), before);
+}
+
+//! Test that formulation properties configured alike share one copy, however their values are nested.
+TEST(SharedBlockTest, TestPropertyMaps) {
+    typedef utils::SharedBlock<geojson::PropertyMap, geojson::PropertyMapHash> properties_block;
+    auto make_properties = [](double area) {
+        geojson::PropertyMap names;
+        names.emplace("Q_OUT", geojson::JSONProperty("Q_OUT", "streamflow"));
+        geojson::PropertyMap properties;
+        properties.emplace("model_type_name", geojson::JSONProperty("model_type_name", "bmi_c_cfe"));
+        properties.emplace("uses_forcing_file", geojson::JSONProperty("uses_forcing_file", false));
+        properties.emplace("area", geojson::JSONProperty("area", area));
+        properties.emplace("variables_names_map", geojson::JSONProperty("variables_names_map", names));
+        return properties;
+    };
+    properties_block first(make_properties(1.5));
+    properties_block second(make_properties(1.5));
+    properties_block other(make_properties(2.5));
+    EXPECT_EQ(geojson::PropertyMapHash()(*first), geojson::PropertyMapHash()(make_properties(1.5)));
+    EXPECT_TRUE(first.shares_with(second));
+    EXPECT_FALSE(first.shares_with(other));
+    EXPECT_EQ(first->at("model_type_name").as_string(), "bmi_c_cfe");
+}
@@ -0,0 +1,98 @@
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+
+#include "utilities/SharedMemoryRing.hpp"
+
+class SharedMemoryRingTest : public ::testing::Test {
+
+    protected:
+
+    static constexpr std::size_t CAPACITY = 64;
+
+    SharedMemoryRingTest() : region(utils::SharedMemoryRing::region_bytes(CAPACITY)) {
+        utils::SharedMemoryRing::create(region.data(), CAPACITY);
+    }
+
+    utils::SharedMemoryRegion region;
+
+};
+
+//! Test that a write of many times the ring's capacity is passed through in order as the reader takes it.
+TEST_F(SharedMemoryRingTest, TestWriteLargerThanRing) {
+    std::vector<uint32_t> sent(1000);
+    std::iota(sent.begin(), sent.end(), 0);
+    std::thread writer([&]() {
+        utils::SharedMemoryRing ring(region.data());
+        ring.write(sent.data(), sent.size() * sizeof(uint32_t));
+    });
+
+    utils::SharedMemoryRing ring(region.data());
+    std::vector<uint32_t> received(sent.size());
+    // read in pieces that don't line up with the ring's capacity, so reads wrap around its end
+    for (std::size_t i = 0; i < received.size(); i += 7) {
+        std::size_t count = std::min<std::size_t>(7, received.size() - i);
+        ring.read(&received[i], count * sizeof(uint32_t));
+    }
+    writer.join();
+    ASSERT_EQ(received, sent);
+}
+
+//! Test that a child process reads what its parent wrote to the ring, and answers through a second ring.
+TEST_F(SharedMemoryRingTest, TestAcrossProcesses) {
+    utils::SharedMemoryRegion reply_region(utils::SharedMemoryRing::region_bytes(CAPACITY));
+    utils::SharedMemoryRing::create(reply_region.data(), CAPACITY);
+    pid_t child = fork();
+    ASSERT_GE(child, 0);
+    if (child == 0) {
+        utils::SharedMemoryRing requests(region.data());
+        utils::SharedMemoryRing replies(reply_region.data());
+        double sum = 0.0;
+        for (int i = 0; i < 100; ++i) {
+            double value;
+            requests.read(&value, sizeof(value));
+            sum += value;
+        }
+        replies.write(&sum, sizeof(sum));
+        _exit(0);
+    }
+
+    auto child_alive = [child]() { return waitpid(child, nullptr, WNOHANG) == 0; };
+    utils::SharedMemoryRing requests(region.data(), child_alive);
+    utils::SharedMemoryRing replies(reply_region.data(), child_alive);
+    for (int i = 0; i < 100; ++i) {
+        double value = i;
+        requests.write(&value, sizeof(value));
+    }
+    double sum = 0.0;
+    replies.read(&sum, sizeof(sum));
+    ASSERT_EQ(sum, 4950.0);
+    waitpid(child, nullptr, 0);
+}
+
+//! Test that a reader waiting on a writer that has gone is told so, rather than waiting forever.
+TEST_F(SharedMemoryRingTest, TestPeerGone) {
+    utils::SharedMemoryRing ring(region.data(), []() { return false; });
+    char byte;
+    ASSERT_THROW(ring.read(&byte, 1), std::runtime_error);
+}
+
+//! Test that bytes written before the ring closed can still be read, but nothing after them.
+TEST_F(SharedMemoryRingTest, TestReadAfterClose) {
+    utils::SharedMemoryRing ring(region.data());
+    int32_t value = 42;
+    ring.write(&value, sizeof(value));
+    ring.close();
+    ASSERT_THROW(ring.write(&value, sizeof(value)), std::runtime_error);
+    int32_t read_value = 0;
+    ring.read(&read_value, sizeof(read_value));
+    ASSERT_EQ(read_value, 42);
+    ASSERT_THROW(ring.read(&read_value, sizeof(read_value)), std::runtime_error);
+}
@@ -0,0 +1,69 @@
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "utilities/StartupProfile.hpp"
+
+//! Test that phases are kept in the order they started, with repeated phases totalled.
+TEST(StartupProfileTest, TestPhases) {
+    utils::StartupProfile::clear();
+    {
+        utils::StartupTimer startup("first");
+        std::vector<char> grown(64 * 1024 * 1024, 1);
+        startup.next("second");
+        for (int i = 0; i < 3; ++i) {
+            utils::StartupTimer nested("second/nested", false);
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }
+    utils::StartupProfile::summary_t summary = utils::StartupProfile::collect();
+    ASSERT_EQ(summary.size(), 3);
+    EXPECT_EQ(summary[0].first, "first");
+    EXPECT_EQ(summary[1].first, "second");
+    EXPECT_EQ(summary[2].first, "second/nested");
+    EXPECT_EQ(summary[0].second.count, 1);
+    EXPECT_TRUE(summary[0].second.is_memory_sampled);
+    EXPECT_GT(summary[0].second.memory_mb, 32.0);
+    EXPECT_EQ(summary[2].second.count, 3);
+    EXPECT_FALSE(summary[2].second.is_memory_sampled);
+    EXPECT_GE(summary[2].second.seconds, 0.015);
+    EXPECT_GE(summary[1].second.seconds, summary[2].second.seconds);
+    EXPECT_GT(utils::StartupProfile::get_peak_memory_mb(), 0.0);
+}
+
+//! Test that the summaries of several processes combine into the mean and the largest of any one.
+TEST(StartupProfileTest, TestMergeProcesses) {
+    utils::StartupProfile::clear();
+    utils::StartupProfile::record("read", 2.0, 10.0, true);
+    utils::StartupProfile::record("initialize", 1.0);
+    std::string first = utils::StartupProfile::serialize(utils::StartupProfile::collect());
+    utils::StartupProfile::clear();
+    utils::StartupProfile::record("read", 6.0, 30.0, true);
+    utils::StartupProfile::record("link", 0.5);
+    std::string second = utils::StartupProfile::serialize(utils::StartupProfile::collect());
+    utils::StartupProfile::clear();
+
+    utils::StartupProfile::summary_t summary;
+    utils::StartupProfile::merge_serialized(first, 0, summary);
+    utils::StartupProfile::merge_serialized(second, 1, summary);
+    ASSERT_EQ(summary.size(), 3);
+    EXPECT_EQ(summary[0].first, "read");
+    EXPECT_EQ(summary[1].first, "initialize");
+    EXPECT_EQ(summary[2].first, "link");
+    EXPECT_EQ(summary[0].second.count, 2);
+    EXPECT_DOUBLE_EQ(summary[0].second.seconds, 8.0);
+    EXPECT_DOUBLE_EQ(summary[0].second.max_seconds, 6.0);
+    EXPECT_EQ(summary[0].second.max_process, 1);
+    EXPECT_DOUBLE_EQ(summary[0].second.max_memory_mb, 30.0);
+    EXPECT_EQ(summary[1].second.max_process, 0);
+    EXPECT_EQ(summary[2].second.max_process, 1);
+
+    std::ostringstream table;
+    utils::StartupProfile::write_summary(table, summary, 2);
+    EXPECT_NE(table.str().find("read"), std::string::npos);
+    EXPECT_NE(table.str().find("4.000"), std::string::npos);
+    EXPECT_NE(table.str().find("20.0"), std::string::npos);
+}
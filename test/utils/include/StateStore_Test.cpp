@@ -0,0 +1,80 @@
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "utilities/StateStore.hpp"
+
+//! Test that states are read back as put, including after being replaced by larger and smaller ones.
+TEST(StateStoreTest, TestPutGet) {
+    utils::StateStore store(".");
+    std::vector<char> first(100, 'a');
+    std::vector<char> second(10000, 'b');
+    store.put(0, first);
+    store.put(3, second);
+    EXPECT_TRUE(store.contains(0));
+    EXPECT_FALSE(store.contains(1));
+    EXPECT_TRUE(store.contains(3));
+
+    std::vector<char> state;
+    store.get(0, state);
+    EXPECT_EQ(state, first);
+    store.get(3, state);
+    EXPECT_EQ(state, second);
+    // Read again, after its pages were dropped from the mapping
+    store.get(3, state);
+    EXPECT_EQ(state, second);
+
+    std::size_t file_size = store.get_file_size();
+    store.put(3, first);
+    EXPECT_EQ(store.get_file_size(), file_size);
+    store.get(3, state);
+    EXPECT_EQ(state, first);
+
+    std::vector<char> larger(100000, 'c');
+    store.put(0, larger);
+    store.prefetch(0);
+    store.get(0, state);
+    EXPECT_EQ(state, larger);
+    store.get(3, state);
+    EXPECT_EQ(state, first);
+
+    store.put(1, std::vector<char>());
+    store.get(1, state);
+    EXPECT_TRUE(state.empty());
+}
+
+//! Test that reading a slot without a state throws.
+TEST(StateStoreTest, TestMissing) {
+    utils::StateStore store(".");
+    std::vector<char> state;
+    EXPECT_THROW(store.get(0, state), std::out_of_range);
+    EXPECT_THROW(utils::StateStore("./no/such/directory"), std::runtime_error);
+}
+
+//! Test that threads may put and get their own slots at once, while the file grows.
+TEST(StateStoreTest, TestThreads) {
+    utils::StateStore store(".");
+    std::vector<std::thread> threads;
+    std::vector<int> matched(4, 1);
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&store, &matched, t]() {
+            std::vector<char> state;
+            for (int i = 0; i < 50; ++i) {
+                std::size_t slot = t * 50 + i;
+                std::vector<char> bytes(1000 * (i + 1), static_cast<char>(slot));
+                store.put(slot, bytes);
+                store.get(slot, state);
+                matched[t] = matched[t] && state == bytes;
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    for (int t = 0; t < 4; ++t) {
+        EXPECT_TRUE(matched[t]);
+    }
+}
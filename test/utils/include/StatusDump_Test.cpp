@@ -0,0 +1,41 @@
+#include <csignal>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "utilities/StatusDump.hpp"
+
+//! Test that a request, by the signal or not, is taken once.
+TEST(StatusDumpTest, TestRequest) {
+    EXPECT_FALSE(utils::StatusDump::take_request());
+    utils::StatusDump::request();
+    EXPECT_TRUE(utils::StatusDump::take_request());
+    EXPECT_FALSE(utils::StatusDump::take_request());
+
+    #ifdef SIGUSR1
+    ASSERT_TRUE(utils::StatusDump::install());
+    std::raise(SIGUSR1);
+    EXPECT_TRUE(utils::StatusDump::take_request());
+    EXPECT_FALSE(utils::StatusDump::take_request());
+    std::signal(SIGUSR1, SIG_DFL);
+    #endif
+}
+
+//! Test that a report replaces the last one whole, leaving no temporary file behind.
+TEST(StatusDumpTest, TestWrite) {
+    std::string path = testing::TempDir() + "status_dump_test.txt";
+    ASSERT_TRUE(utils::StatusDump::write(path, [](std::ostream& out) { out << "completed_steps 1\n"; }));
+    ASSERT_TRUE(utils::StatusDump::write(path, [](std::ostream& out) { out << "completed_steps 2\n"; }));
+    std::ifstream in(path);
+    std::stringstream content;
+    content << in.rdbuf();
+    EXPECT_EQ(content.str(), "completed_steps 2\n");
+    EXPECT_FALSE(std::ifstream(path + ".tmp").good());
+
+    EXPECT_FALSE(utils::StatusDump::write(testing::TempDir() + "no_such_directory/status.txt",
+                                          [](std::ostream& out) { out << "completed_steps 3\n"; }));
+    std::remove(path.c_str());
+}
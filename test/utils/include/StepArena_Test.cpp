@@ -0,0 +1,75 @@
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "utilities/StepArena.hpp"
+
+//! Test that containers allocate from the arena only within a scope, and that the outermost scope resets it.
+TEST(StepArenaTest, TestScopes) {
+    utils::arena_vector<double> outside(10, 1.0);
+    EXPECT_FALSE(utils::StepArena::owns(outside.data()));
+
+    const double* first;
+    {
+        utils::StepArena::Scope step;
+        utils::arena_vector<double> values(100, 2.0);
+        first = values.data();
+        EXPECT_TRUE(utils::StepArena::owns(first));
+        {
+            utils::StepArena::Scope nested;
+            utils::arena_vector<double> more(100, 3.0);
+            EXPECT_TRUE(utils::StepArena::owns(more.data()));
+        }
+        // Not reset by the nested scope, freed or not
+        EXPECT_EQ(values[99], 2.0);
+        outside.clear();
+        outside.shrink_to_fit();
+    }
+    EXPECT_FALSE(utils::StepArena::is_active());
+
+    // The next step reuses the same memory
+    utils::StepArena::Scope step;
+    utils::arena_vector<double> values(100, 4.0);
+    EXPECT_EQ(values.data(), first);
+}
+
+//! Test that allocations are aligned, that the arena grows past its first block, and is one block once reset.
+TEST(StepArenaTest, TestGrowth) {
+    {
+        utils::StepArena::Scope step;
+        utils::arena_string text("not in the small string buffer of an implementation");
+        std::vector<utils::arena_vector<double>> buffers;
+        for (int i = 0; i < 100; ++i) {
+            buffers.emplace_back(1000, i);
+            EXPECT_EQ(reinterpret_cast<std::uintptr_t>(buffers.back().data()) % alignof(double), 0);
+        }
+        for (int i = 0; i < 100; ++i) {
+            ASSERT_EQ(buffers[i][999], i);
+        }
+        EXPECT_EQ(text, "not in the small string buffer of an implementation");
+        EXPECT_GE(utils::StepArena::get_capacity(), 100 * 1000 * sizeof(double));
+    }
+    std::size_t capacity = utils::StepArena::get_capacity();
+    utils::StepArena::Scope step;
+    utils::arena_vector<char> all(capacity);
+    EXPECT_TRUE(utils::StepArena::owns(&all.back()));
+    EXPECT_EQ(utils::StepArena::get_capacity(), capacity);
+}
+
+//! Test that each thread has its own arena.
+TEST(StepArenaTest, TestThreads) {
+    utils::StepArena::Scope step;
+    utils::arena_vector<int> values(10, 1);
+    bool owned_by_other = true;
+    std::thread other([&]() {
+        utils::StepArena::Scope other_step;
+        utils::arena_vector<int> other_values(10, 2);
+        owned_by_other = utils::StepArena::owns(values.data());
+        EXPECT_TRUE(utils::StepArena::owns(other_values.data()));
+    });
+    other.join();
+    EXPECT_FALSE(owned_by_other);
+}
@@ -0,0 +1,92 @@
+#include <atomic>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "utilities/ThreadPool.hpp"
+
+class ThreadPoolTest : public ::testing::Test {
+
+    protected:
+
+    ThreadPoolTest() {
+
+    }
+
+    ~ThreadPoolTest() override {
+
+    }
+
+};
+
+//! Test that a single thread pool runs every item, in order, on the calling thread.
+TEST_F(ThreadPoolTest, TestSerialOrder) {
+    utils::ThreadPool pool(1);
+    ASSERT_EQ(pool.size(), 1);
+
+    std::vector<std::size_t> visited;
+    pool.parallel_for(10, [&visited](std::size_t i) { visited.push_back(i); });
+
+    std::vector<std::size_t> expected(10);
+    std::iota(expected.begin(), expected.end(), 0);
+    ASSERT_EQ(visited, expected);
+}
+
+//! Test that a multi-threaded pool runs every item exactly once, across repeated loops.
+TEST_F(ThreadPoolTest, TestEachItemOnce) {
+    utils::ThreadPool pool(4);
+    ASSERT_EQ(pool.size(), 4);
+
+    for (int round = 0; round < 5; ++round) {
+        std::vector<std::atomic<int>> counts(1000);
+        for (auto& c : counts) {
+            c.store(0);
+        }
+        pool.parallel_for(counts.size(), [&counts](std::size_t i) { counts[i]++; });
+        for (std::size_t i = 0; i < counts.size(); ++i) {
+            ASSERT_EQ(counts[i].load(), 1) << "item " << i << " on round " << round;
+        }
+    }
+}
+
+//! Test that an exception in a work item is rethrown to the caller, and the pool remains usable.
+TEST_F(ThreadPoolTest, TestExceptionPropagation) {
+    utils::ThreadPool pool(3);
+
+    ASSERT_THROW(pool.parallel_for(100, [](std::size_t i) {
+        if (i == 42) {
+            throw std::runtime_error("failed item");
+        }
+    }), std::runtime_error);
+
+    std::atomic<std::size_t> total{0};
+    pool.parallel_for(100, [&total](std::size_t i) { total += i; });
+    ASSERT_EQ(total.load(), 4950);
+}
+
+//! Test that a pool sized from the available CPUs, with pinned threads, still runs every item.
+TEST_F(ThreadPoolTest, TestPinnedThreads) {
+    std::vector<int> cpus = utils::ThreadPool::available_cpus();
+    {
+        utils::ThreadPool pool(0, true);
+        if (!cpus.empty()) {
+            ASSERT_EQ(pool.size(), cpus.size());
+        }
+        std::atomic<std::size_t> total{0};
+        pool.parallel_for(100, [&total](std::size_t i) { total += i; });
+        ASSERT_EQ(total.load(), 4950);
+    }
+    // The calling thread was pinned too, so free it again for the other tests
+    #ifdef __linux__
+    if (!cpus.empty()) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : cpus) {
+            CPU_SET(cpu, &set);
+        }
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+    #endif
+}
@@ -0,0 +1,209 @@
+#!/usr/bin/env python3
+"""
+Compare the performance reports of a baseline and a candidate version of ngen, and flag regressions.
+
+Each side is given as one or more report files, one per repeated run, so each measurement has a sample of values on
+either side.  Measurements are matched by name between the sides, and one is flagged as a regression when the
+candidate's mean is slower than the baseline's by more than the threshold and, where both sides have repeated runs,
+by more than their noise: Welch's t statistic of the difference must also exceed --t-threshold.  With a single run on
+a side, only the threshold applies, so repeat runs to tell real changes from noise.
+
+Reports read, by their content:
+
+    Google Benchmark JSON   the --benchmark_out files of the benchmark executables, e.g. benchmark_bmi; each
+                            benchmark's real time per iteration, and each repetition of it is a run
+    ngen profile JSON       the profile_summary.json written under the output config's profile_path; each region's
+                            mean total time per rank
+    ngen scaling CSV        the --results of utilities/scaling/ngen_scaling.py run; the wall, setup and simulation
+                            times of each rank count, and each repeat is a run
+    remote nexus CSV        the --csv of benchmark_remote_nexus; the mean communication time per time step of each
+                            configuration
+
+Examples:
+
+    # Five repetitions of the BMI benchmarks with each version
+    ./baseline/benchmarks/benchmark_bmi --benchmark_repetitions=5 --benchmark_out=baseline.json
+    ./candidate/benchmarks/benchmark_bmi --benchmark_repetitions=5 --benchmark_out=candidate.json
+    python compare_reports.py --baseline baseline.json --candidate candidate.json
+
+    # Profiles of three runs with each version, ignoring regions under 10 ms
+    python compare_reports.py --baseline base_*/profile_summary.json --candidate cand_*/profile_summary.json \\
+        --min-seconds 0.01
+
+The exit code is 1 if any measurement regressed, so the comparison can gate a CI job.
+"""
+
+import argparse
+import csv
+import json
+import math
+import sys
+
+# Google Benchmark time units, in seconds
+TIME_UNITS = {"ns": 1e-9, "us": 1e-6, "ms": 1e-3, "s": 1.0}
+
+# The key and timed columns of the CSV reports, by a column only each has
+SCALING_KEYS = ["mode", "ranks", "catchments"]
+SCALING_TIMES = ["wall_s", "setup_s", "simulation_s"]
+REMOTE_NEXUS_KEYS = ["ranks", "nexuses", "transport", "ring", "compute_us"]
+REMOTE_NEXUS_TIMES = [("mean_us", 1e-6), ("max_us", 1e-6)]
+
+
+def read_google_benchmark(report):
+    """Each benchmark's seconds per iteration, from its iterations, or from its mean if only aggregates were kept."""
+    samples = {}
+    means = {}
+    for benchmark in report.get("benchmarks", []):
+        if benchmark.get("error_occurred"):
+            continue
+        name = benchmark.get("run_name", benchmark["name"])
+        seconds = benchmark["real_time"] * TIME_UNITS[benchmark.get("time_unit", "ns")]
+        if benchmark.get("run_type") == "aggregate":
+            if benchmark.get("aggregate_name") == "mean":
+                means[name] = seconds
+        else:
+            samples.setdefault(name, []).append(seconds)
+    for name, seconds in means.items():
+        samples.setdefault(name, [seconds])
+    return samples
+
+
+def read_profile(report):
+    """Each region's mean total seconds per rank."""
+    return {region["name"]: [region["rank_mean_seconds"]] for region in report["regions"]
+            if region["total_seconds"] > 0}
+
+
+def read_csv_report(path):
+    """The timed columns of each row of a scaling or remote nexus CSV report, by the row's key columns."""
+    samples = {}
+    with open(path, newline="") as report:
+        rows = list(csv.DictReader(report))
+    if not rows:
+        return samples
+    if "wall_s" in rows[0]:
+        keys, times = SCALING_KEYS, [(column, 1.0) for column in SCALING_TIMES]
+    elif "mean_us" in rows[0]:
+        keys, times = REMOTE_NEXUS_KEYS, REMOTE_NEXUS_TIMES
+    else:
+        raise ValueError("{} is not a scaling or remote nexus report".format(path))
+    for row in rows:
+        if row.get("exit_code", "0") != "0":
+            continue
+        key = " ".join("{}={}".format(column, row[column]) for column in keys)
+        for column, scale in times:
+            value = float(row[column])
+            if not math.isnan(value):
+                samples.setdefault("{} {}".format(key, column), []).append(value * scale)
+    return samples
+
+
+def read_report(path):
+    """The samples of every measurement of a report, in seconds, by name."""
+    if path.endswith(".csv"):
+        return read_csv_report(path)
+    with open(path) as report_file:
+        report = json.load(report_file)
+    if "benchmarks" in report:
+        return read_google_benchmark(report)
+    if "regions" in report:
+        return read_profile(report)
+    raise ValueError("{} is not a Google Benchmark or ngen profile report".format(path))
+
+
+def read_side(paths):
+    """The samples of every measurement, over all the reports of one side."""
+    samples = {}
+    for path in paths:
+        for name, values in read_report(path).items():
+            samples.setdefault(name, []).extend(values)
+    return samples
+
+
+def mean_and_variance(values):
+    mean = sum(values) / len(values)
+    if len(values) < 2:
+        return mean, 0.0
+    return mean, sum((v - mean) ** 2 for v in values) / (len(values) - 1)
+
+
+def compare(baseline, candidate, threshold, t_threshold, min_seconds):
+    """
+    Rows of (name, baseline mean, candidate mean, relative change, t statistic or None, verdict) for the measurements
+    of both sides, with the largest slowdowns first.
+    """
+    rows = []
+    for name in baseline.keys() & candidate.keys():
+        base_mean, base_var = mean_and_variance(baseline[name])
+        cand_mean, cand_var = mean_and_variance(candidate[name])
+        if max(base_mean, cand_mean) < min_seconds or base_mean <= 0:
+            continue
+        change = cand_mean / base_mean - 1.0
+        t = None
+        if len(baseline[name]) > 1 and len(candidate[name]) > 1:
+            error = math.sqrt(base_var / len(baseline[name]) + cand_var / len(candidate[name]))
+            if error > 0:
+                t = (cand_mean - base_mean) / error
+            else:
+                t = 0.0 if cand_mean == base_mean else math.copysign(math.inf, cand_mean - base_mean)
+        is_significant = t is None or abs(t) > t_threshold
+        if change > threshold and is_significant:
+            verdict = "REGRESSION"
+        elif change < -threshold and is_significant:
+            verdict = "improvement"
+        else:
+            verdict = ""
+        rows.append((name, base_mean, cand_mean, change, t, verdict))
+    rows.sort(key=lambda row: -row[3])
+    return rows
+
+
+def format_seconds(seconds):
+    for unit, scale in (("s", 1.0), ("ms", 1e-3), ("us", 1e-6)):
+        if seconds >= scale:
+            return "{:.3f} {}".format(seconds / scale, unit)
+    return "{:.1f} ns".format(seconds / 1e-9)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[1],
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--baseline", nargs="+", required=True, help="reports of the baseline, one per run")
+    parser.add_argument("--candidate", nargs="+", required=True, help="reports of the candidate, one per run")
+    parser.add_argument("--threshold", type=float, default=0.05,
+                        help="the relative slowdown beyond which a measurement regressed (default 0.05)")
+    parser.add_argument("--t-threshold", type=float, default=2.0,
+                        help="the Welch t statistic a change must exceed, with repeated runs (default 2.0)")
+    parser.add_argument("--min-seconds", type=float, default=0.0,
+                        help="ignore measurements taking less than this on both sides")
+    parser.add_argument("--filter", default="", help="only compare measurements whose names contain this")
+    args = parser.parse_args()
+
+    baseline = read_side(args.baseline)
+    candidate = read_side(args.candidate)
+    if args.filter:
+        baseline = {name: values for name, values in baseline.items() if args.filter in name}
+        candidate = {name: values for name, values in candidate.items() if args.filter in name}
+    rows = compare(baseline, candidate, args.threshold, args.t_threshold, args.min_seconds)
+
+    name_width = max([len("Measurement")] + [len(row[0]) for row in rows])
+    print("{:<{w}} {:>14} {:>14} {:>9} {:>8}  {}".format("Measurement", "Baseline", "Candidate", "Change", "t", "",
+                                                         w=name_width))
+    for name, base_mean, cand_mean, change, t, verdict in rows:
+        print("{:<{w}} {:>14} {:>14} {:>+8.1f}% {:>8}  {}".format(
+            name, format_seconds(base_mean), format_seconds(cand_mean), change * 100.0,
+            "-" if t is None else "{:.1f}".format(t), verdict, w=name_width))
+    only_baseline = sorted(baseline.keys() - candidate.keys())
+    only_candidate = sorted(candidate.keys() - baseline.keys())
+    if only_baseline:
+        print("Only in the baseline: " + ", ".join(only_baseline))
+    if only_candidate:
+        print("Only in the candidate: " + ", ".join(only_candidate))
+
+    regressions = sum(1 for row in rows if row[5] == "REGRESSION")
+    print("{} of {} measurements regressed by more than {:.0f}%".format(regressions, len(rows), args.threshold * 100))
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
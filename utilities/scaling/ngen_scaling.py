@@ -0,0 +1,444 @@
+#!/usr/bin/env python3
+"""
+Scaling benchmarks of ngen on synthetic domains.
+
+Generates synthetic dendritic hydrofabrics of any size and branching, with a matching realization config and forcing,
+and runs ngen (and partitionGenerator) on them across MPI rank counts, recording the wall time, the time of the main
+phases of each run, and the peak resident memory of its largest process.
+
+Subcommands:
+
+    generate  write a synthetic domain to a directory
+    run       generate domains as needed, run ngen on them for each rank count, and write the results as CSV
+
+Examples:
+
+    # A domain of 10000 catchments, each with 1 to 3 upstream catchments, in 4 separate basins
+    python ngen_scaling.py generate -o ./domain_10k --catchments 10000 --branching 3 --outlets 4
+
+    # Strong scaling of a 20000 catchment domain over 1 to 8 ranks
+    python ngen_scaling.py run --ngen ./cmake_build/ngen --partition-generator ./cmake_build/partitionGenerator \\
+        --mode strong --catchments 20000 --ranks 1,2,4,8 --results strong.csv
+
+    # Weak scaling, with 5000 catchments per rank
+    python ngen_scaling.py run --ngen ./cmake_build/ngen --partition-generator ./cmake_build/partitionGenerator \\
+        --mode weak --catchments 5000 --ranks 1,2,4,8 --results weak.csv
+
+NetCDF forcing requires the netCDF4 package; CSV forcing needs only the standard library.
+"""
+
+import argparse
+import csv
+import datetime
+import json
+import math
+import os
+import random
+import shutil
+import subprocess
+import sys
+import time
+
+# Columns of CSV forcing files, as in AORC derived per catchment forcings, and their NetCDF units
+FORCING_FIELDS = [
+    ("APCP_surface", "kg m^-2"),
+    ("DLWRF_surface", "W m^-2"),
+    ("DSWRF_surface", "W m^-2"),
+    ("PRES_surface", "Pa"),
+    ("SPFH_2maboveground", "kg kg^-1"),
+    ("TMP_2maboveground", "K"),
+    ("UGRD_10maboveground", "m s^-1"),
+    ("VGRD_10maboveground", "m s^-1"),
+    ("precip_rate", "mm s^-1"),
+]
+
+# Distinct forcing series written for CSV forcing; the files of other catchments link to one of these
+CSV_FORCING_VARIANTS = 16
+
+# The formulation of every catchment unless a template is given; it needs no external model libraries
+DEFAULT_FORMULATION = {
+    "name": "simple_lumped",
+    "params": {
+        "sr": [1.0, 1.0, 1.0],
+        "storage": 1.0,
+        "gw_storage": 1.0,
+        "gw_max_storage": 10.0,
+        "nash_max_storage": 2.0,
+        "smax": 5,
+        "a": 1.0,
+        "b": 10.0,
+        "Ks": 0.1,
+        "Kq": 0.01,
+        "n": 3,
+        "t": 0
+    }
+}
+
+TIME_FORMAT = "%Y-%m-%d %H:%M:%S"
+
+# Lines ngen writes to standard output at the boundaries of the phases of a run
+PHASE_MARKERS = [
+    ("setup", "Running Models"),
+    ("simulation", "Finished "),
+]
+
+
+def generate_network(catchments, branching, outlets, seed):
+    """
+    Generate a random dendritic network.
+
+    Each of ``outlets`` basins drains to its own terminal nexus.  Catchments are added breadth first from the
+    outlets, each receiving between 1 and ``branching`` upstream catchments through the nexus at its upstream end,
+    until there are ``catchments`` in all; ``branching`` 1 gives single chains, the deepest possible networks.
+
+    :return: A list of ``(catchment_id, nexus_id)`` pairs, where the catchment drains to the nexus, and a dict of
+             each nexus id to the catchment it drains to, or ``None`` for terminal nexuses.
+    """
+    rng = random.Random(seed)
+    outlets = max(1, min(outlets, catchments))
+    links = []
+    nexus_to = {}
+    frontier = []
+    for o in range(outlets):
+        cat_id = "cat-{}".format(len(links) + 1)
+        nex_id = "tnx-{}".format(o + 1)
+        nexus_to[nex_id] = None
+        links.append((cat_id, nex_id))
+        frontier.append(cat_id)
+    head = 0
+    while len(links) < catchments:
+        downstream = frontier[head]
+        head += 1
+        nex_id = "nex-" + downstream.split("-", 1)[1]
+        nexus_to[nex_id] = downstream
+        for _ in range(min(rng.randint(1, branching), catchments - len(links))):
+            cat_id = "cat-{}".format(len(links) + 1)
+            links.append((cat_id, nex_id))
+            frontier.append(cat_id)
+    return links, nexus_to
+
+
+def write_hydrofabric(out_dir, links, nexus_to, cell_degrees=0.05):
+    """Write catchment and nexus GeoJSON, laying catchments out as squares of a grid."""
+    width = int(math.ceil(math.sqrt(len(links))))
+    area_sqkm = (cell_degrees * 111.0) ** 2
+    corner = {}
+
+    catchment_path = os.path.join(out_dir, "catchment_data.geojson")
+    with open(catchment_path, "w") as f:
+        f.write('{"type": "FeatureCollection", "name": "catchment_data", "features": [\n')
+        for i, (cat_id, nex_id) in enumerate(links):
+            x0 = -100.0 + (i % width) * cell_degrees
+            y0 = 35.0 + (i // width) * cell_degrees
+            corner[cat_id] = (x0, y0)
+            ring = [[x0, y0], [x0 + cell_degrees, y0], [x0 + cell_degrees, y0 + cell_degrees],
+                    [x0, y0 + cell_degrees], [x0, y0]]
+            feature = {"type": "Feature", "id": cat_id, "properties": {"areasqkm": area_sqkm, "toid": nex_id},
+                       "geometry": {"type": "Polygon", "coordinates": [ring]}}
+            f.write((",\n" if i > 0 else "") + json.dumps(feature))
+        f.write("\n]}\n")
+
+    # Nexuses sit at the corner of the catchment draining to them
+    drained_by = {}
+    for cat_id, nex_id in links:
+        drained_by.setdefault(nex_id, cat_id)
+    nexus_path = os.path.join(out_dir, "nexus_data.geojson")
+    with open(nexus_path, "w") as f:
+        f.write('{"type": "FeatureCollection", "name": "nexus_data", "features": [\n')
+        for i, (nex_id, to_cat) in enumerate(nexus_to.items()):
+            x, y = corner[drained_by[nex_id]]
+            properties = {"toid": to_cat} if to_cat is not None else {}
+            feature = {"type": "Feature", "id": nex_id, "properties": properties,
+                       "geometry": {"type": "Point", "coordinates": [x, y]}}
+            f.write((",\n" if i > 0 else "") + json.dumps(feature))
+        f.write("\n]}\n")
+    return catchment_path, nexus_path
+
+
+def forcing_values(variant, step):
+    """Synthetic hourly forcing values for a time step: a daily cycle, with storms recurring by variant."""
+    hour = step % 24
+    daylight = max(0.0, math.sin(math.pi * (hour - 6) / 12.0))
+    storm = ((step + 7 * variant) % 97) < 6
+    precip_rate = 0.002 * (1 + variant % 3) if storm else 0.0
+    return [
+        precip_rate * 3600.0,
+        300.0 + 40.0 * daylight,
+        600.0 * daylight,
+        100000.0 - 50.0 * variant,
+        0.008,
+        280.0 + 8.0 * daylight,
+        1.5,
+        -0.5,
+        precip_rate,
+    ]
+
+
+def write_csv_forcing(out_dir, cat_ids, start, steps):
+    """Write a CSV forcing file per catchment, linking most of them to a few distinct series to save space."""
+    forcing_dir = os.path.join(out_dir, "forcing")
+    os.makedirs(forcing_dir, exist_ok=True)
+    variants = []
+    for v in range(min(CSV_FORCING_VARIANTS, len(cat_ids))):
+        path = os.path.join(forcing_dir, "variant-{}.series".format(v))
+        with open(path, "w", newline="") as f:
+            writer = csv.writer(f)
+            writer.writerow(["time"] + [name for name, _ in FORCING_FIELDS])
+            for step in range(steps):
+                timestamp = (start + datetime.timedelta(hours=step)).strftime(TIME_FORMAT)
+                writer.writerow([timestamp] + forcing_values(v, step))
+        variants.append(path)
+    for i, cat_id in enumerate(cat_ids):
+        link = os.path.join(forcing_dir, cat_id + ".csv")
+        if os.path.lexists(link):
+            os.remove(link)
+        try:
+            os.symlink(os.path.basename(variants[i % len(variants)]), link)
+        except OSError:
+            shutil.copyfile(variants[i % len(variants)], link)
+    return {"file_pattern": "{{id}}.csv", "path": forcing_dir + "/", "provider": "CsvPerFeature"}
+
+
+def write_netcdf_forcing(out_dir, cat_ids, start, steps):
+    """Write a single NetCDF forcing file of all catchments, in the layout NetCDFPerFeatureDataProvider reads."""
+    try:
+        import netCDF4
+        import numpy as np
+    except ImportError:
+        sys.exit("NetCDF forcing requires the netCDF4 and numpy packages")
+    path = os.path.join(out_dir, "forcing.nc")
+    epoch = datetime.datetime(1970, 1, 1)
+    times = np.array([(start + datetime.timedelta(hours=s) - epoch).total_seconds() for s in range(steps)])
+    series = [np.array([forcing_values(v, s) for s in range(steps)])
+              for v in range(min(CSV_FORCING_VARIANTS, len(cat_ids)))]
+    with netCDF4.Dataset(path, "w", format="NETCDF4") as ds:
+        ds.createDimension("catchment-id", len(cat_ids))
+        ds.createDimension("time", steps)
+        ids = ds.createVariable("ids", str, ("catchment-id",))
+        time_var = ds.createVariable("Time", "f8", ("catchment-id", "time"))
+        time_var.units = "s"
+        variables = []
+        for name, units in FORCING_FIELDS:
+            var = ds.createVariable(name, "f4", ("catchment-id", "time"),
+                                    chunksizes=(min(len(cat_ids), 1024), min(steps, 24)))
+            var.units = units
+            variables.append(var)
+        for i, cat_id in enumerate(cat_ids):
+            ids[i] = cat_id
+            time_var[i, :] = times
+            values = series[i % len(series)]
+            for f, var in enumerate(variables):
+                var[i, :] = values[:, f]
+    return {"path": path, "provider": "NetCDF"}
+
+
+def generate_domain(out_dir, catchments, branching=2, outlets=1, seed=0, start_time="2015-12-01 00:00:00",
+                    time_steps=720, forcing="csv", formulation=None, profile=False):
+    """
+    Write a synthetic domain: hydrofabric, forcing and a realization config running every catchment with the
+    same formulation.
+
+    :return: The paths of the catchment data, nexus data and realization config.
+    """
+    out_dir = os.path.abspath(out_dir)
+    os.makedirs(out_dir, exist_ok=True)
+    links, nexus_to = generate_network(catchments, branching, outlets, seed)
+    catchment_path, nexus_path = write_hydrofabric(out_dir, links, nexus_to)
+
+    start = datetime.datetime.strptime(start_time, TIME_FORMAT)
+    cat_ids = [cat_id for cat_id, _ in links]
+    if forcing == "netcdf":
+        forcing_config = write_netcdf_forcing(out_dir, cat_ids, start, time_steps)
+    else:
+        forcing_config = write_csv_forcing(out_dir, cat_ids, start, time_steps)
+
+    output_dir = os.path.join(out_dir, "output")
+    os.makedirs(output_dir, exist_ok=True)
+    realization = {
+        "global": {
+            "formulations": [formulation if formulation is not None else DEFAULT_FORMULATION],
+            "forcing": forcing_config
+        },
+        "time": {
+            "start_time": start_time,
+            "end_time": (start + datetime.timedelta(hours=time_steps - 1)).strftime(TIME_FORMAT),
+            "output_interval": 3600
+        },
+        "output": {
+            "nexus_path": output_dir + "/"
+        }
+    }
+    if profile:
+        realization["output"]["profile_path"] = output_dir + "/"
+    realization_path = os.path.join(out_dir, "realization.json")
+    with open(realization_path, "w") as f:
+        json.dump(realization, f, indent=2)
+    return catchment_path, nexus_path, realization_path
+
+
+def run_timed(command, cwd, log_path):
+    """
+    Run a command, logging its output, and time the phases marked by its output lines.
+
+    :return: The exit code, the wall time in seconds, the time of each phase, and the peak resident memory of the
+             largest of the command's processes, in MiB.
+    """
+    start = time.monotonic()
+    marks = {}
+    with open(log_path, "w") as log:
+        log.write(" ".join(command) + "\n")
+        proc = subprocess.Popen(command, cwd=cwd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                                universal_newlines=True, bufsize=1)
+        for line in proc.stdout:
+            log.write(line)
+            now = time.monotonic()
+            for phase, marker in PHASE_MARKERS:
+                # The first rank to start a phase, and the last to end the simulation, bound the phases
+                if line.startswith(marker) and (phase not in marks or phase == "simulation"):
+                    marks[phase] = now
+        _, status, usage = os.wait4(proc.pid, 0)
+        proc.returncode = os.waitstatus_to_exitcode(status) if hasattr(os, "waitstatus_to_exitcode") else status
+    end = time.monotonic()
+
+    phases = {}
+    previous = start
+    for phase, _ in PHASE_MARKERS:
+        if phase in marks:
+            phases[phase] = marks[phase] - previous
+            previous = marks[phase]
+    phases["finalize"] = end - previous
+    # ru_maxrss is in KiB on Linux, but in bytes on macOS
+    peak_rss_mb = usage.ru_maxrss / (1024.0 * 1024.0 if sys.platform == "darwin" else 1024.0)
+    return proc.returncode, end - start, phases, peak_rss_mb
+
+
+def parse_ranks(text):
+    ranks = [int(r) for r in text.split(",") if r.strip()]
+    if not ranks or min(ranks) < 1:
+        raise argparse.ArgumentTypeError("rank counts must be a comma separated list of positive integers")
+    return ranks
+
+
+def load_formulation(path):
+    if path is None:
+        return None
+    with open(path) as f:
+        return json.load(f)
+
+
+def command_generate(args):
+    paths = generate_domain(args.output, args.catchments, args.branching, args.outlets, args.seed, args.start_time,
+                            args.time_steps, args.forcing, load_formulation(args.formulation_template),
+                            args.profile)
+    print("Wrote " + ", ".join(paths))
+
+
+def command_run(args):
+    work_dir = os.path.abspath(args.work_dir)
+    os.makedirs(work_dir, exist_ok=True)
+    formulation = load_formulation(args.formulation_template)
+    fields = ["mode", "ranks", "catchments", "repeat", "exit_code", "partition_s", "wall_s", "setup_s",
+              "simulation_s", "finalize_s", "peak_rss_mb"]
+    with open(args.results, "w", newline="") as results_file:
+        results = csv.DictWriter(results_file, fieldnames=fields)
+        results.writeheader()
+        for ranks in args.ranks:
+            catchments = args.catchments * ranks if args.mode == "weak" else args.catchments
+            domain_dir = os.path.join(work_dir, "domain_{}".format(catchments))
+            catchment_path = os.path.join(domain_dir, "catchment_data.geojson")
+            nexus_path = os.path.join(domain_dir, "nexus_data.geojson")
+            realization_path = os.path.join(domain_dir, "realization.json")
+            if not os.path.exists(realization_path):
+                print("Generating a domain of {} catchments".format(catchments))
+                generate_domain(domain_dir, catchments, args.branching, args.outlets, args.seed, args.start_time,
+                                args.time_steps, args.forcing, formulation, args.profile)
+
+            partition_s = 0.0
+            command = [os.path.abspath(args.ngen), catchment_path, "", nexus_path, "", realization_path]
+            if ranks > 1 or args.always_mpi:
+                partition_path = os.path.join(domain_dir, "partitions_{}.json".format(ranks))
+                if ranks > 1:
+                    if not os.path.exists(partition_path):
+                        started = time.monotonic()
+                        subprocess.check_call([os.path.abspath(args.partition_generator), catchment_path, nexus_path,
+                                               partition_path, str(ranks), "", ""], cwd=domain_dir,
+                                              stdout=subprocess.DEVNULL)
+                        partition_s = time.monotonic() - started
+                    command.append(partition_path)
+                command = args.mpirun.split() + ["-n", str(ranks)] + command
+
+            for repeat in range(args.repeat):
+                log_path = os.path.join(domain_dir, "ngen_{}_ranks_{}.log".format(ranks, repeat))
+                print("Running {} catchments on {} rank(s), repeat {}".format(catchments, ranks, repeat))
+                code, wall, phases, peak_rss_mb = run_timed(command, domain_dir, log_path)
+                if code != 0:
+                    print("  ngen exited with {}; see {}".format(code, log_path))
+                if args.profile:
+                    for extension in ("txt", "json"):
+                        summary = os.path.join(domain_dir, "output", "profile_summary." + extension)
+                        if os.path.exists(summary):
+                            shutil.copyfile(summary, os.path.join(
+                                domain_dir, "profile_summary_{}_ranks_{}.{}".format(ranks, repeat, extension)))
+                results.writerow({
+                    "mode": args.mode, "ranks": ranks, "catchments": catchments, "repeat": repeat,
+                    "exit_code": code, "partition_s": "{:.3f}".format(partition_s), "wall_s": "{:.3f}".format(wall),
+                    "setup_s": "{:.3f}".format(phases.get("setup", float("nan"))),
+                    "simulation_s": "{:.3f}".format(phases.get("simulation", float("nan"))),
+                    "finalize_s": "{:.3f}".format(phases["finalize"]),
+                    "peak_rss_mb": "{:.1f}".format(peak_rss_mb)
+                })
+                results_file.flush()
+                print("  {:.2f} s wall, {:.0f} MiB peak RSS".format(wall, peak_rss_mb))
+
+
+def add_domain_arguments(parser):
+    parser.add_argument("--catchments", type=int, required=True,
+                        help="number of catchments; per rank in the weak scaling mode of the run command")
+    parser.add_argument("--branching", type=int, default=2,
+                        help="most upstream catchments of a catchment; 1 makes single chains (default: 2)")
+    parser.add_argument("--outlets", type=int, default=1, help="number of separate basins (default: 1)")
+    parser.add_argument("--seed", type=int, default=0, help="random seed of the network (default: 0)")
+    parser.add_argument("--start-time", default="2015-12-01 00:00:00",
+                        help="start of the simulation (default: 2015-12-01 00:00:00)")
+    parser.add_argument("--time-steps", type=int, default=720, help="hourly time steps to run (default: 720)")
+    parser.add_argument("--forcing", choices=["csv", "netcdf"], default="csv",
+                        help="forcing format (default: csv); the default simple_lumped formulation reads only csv")
+    parser.add_argument("--formulation-template",
+                        help="JSON file of the formulation to run every catchment with, as an entry of a realization "
+                             "config's formulations list (default: a simple_lumped formulation)")
+    parser.add_argument("--profile", action="store_true",
+                        help="enable ngen's profile of its main loop, written under the domain's output directory")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[1],
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    subparsers = parser.add_subparsers(dest="command")
+    subparsers.required = True
+
+    generate = subparsers.add_parser("generate", help="write a synthetic domain")
+    generate.add_argument("-o", "--output", required=True, help="directory to write the domain to")
+    add_domain_arguments(generate)
+    generate.set_defaults(func=command_generate)
+
+    run = subparsers.add_parser("run", help="run ngen on synthetic domains across rank counts")
+    add_domain_arguments(run)
+    run.add_argument("--ngen", required=True, help="path of the ngen executable")
+    run.add_argument("--partition-generator", default="partitionGenerator",
+                     help="path of the partitionGenerator executable, for rank counts over 1")
+    run.add_argument("--mpirun", default="mpirun", help="MPI launcher command (default: mpirun)")
+    run.add_argument("--ranks", type=parse_ranks, default=[1], help="comma separated rank counts (default: 1)")
+    run.add_argument("--mode", choices=["strong", "weak"], default="strong",
+                     help="strong: the same domain for every rank count; weak: catchments per rank (default: strong)")
+    run.add_argument("--repeat", type=int, default=1, help="runs of each rank count (default: 1)")
+    run.add_argument("--always-mpi", action="store_true", help="launch single rank runs with the MPI launcher too")
+    run.add_argument("--work-dir", default="./scaling_work", help="directory for domains and logs")
+    run.add_argument("--results", default="scaling_results.csv", help="CSV file of results to write")
+    run.set_defaults(func=command_run)
+
+    args = parser.parse_args()
+    args.func(args)
+
+
+if __name__ == "__main__":
+    main()